@@ -230,8 +230,8 @@ int main(int argc, char **argv) {
     // 3. Apply trigger selection via TriggerManager.
     //
     //    applyAllTriggers() performs three steps internally:
-    //      a) Defines "allTriggersPassVector" (RVec<bool> of each HLT path).
-    //      b) Defines "pass_applyTrigger" (bool OR across paths).
+    //      a) Defines "<group>_triggerMask" (uint64_t, one bit per HLT path).
+    //      b) Defines "pass_applyTrigger" (any bit set, no veto bit set).
     //      c) Applies a filter on "pass_applyTrigger" on the main dataframe.
     //
     //    The trigger filter runs BEFORE CutflowManager cuts so that the
@@ -0,0 +1,23 @@
+# CompiledExpressions.cmake
+# Compiles the string expressions of an analysis into its executable.
+#
+# A job run with `jitExportFile=<file>.cc` writes every string expression it
+# defined as typed C++ that registers itself with JitCache at start-up.
+# Adding those files to the analysis executable lets the compiler optimise
+# them with the rest of the analysis, and keeps them away from Cling at run
+# time.  Files that do not exist yet are skipped, so the analysis builds
+# before the first export; re-run CMake after the first export.
+#
+#   rdf_add_compiled_expressions(<target> <file>...)
+
+function(rdf_add_compiled_expressions target)
+    foreach(expressions_file ${ARGN})
+        if(NOT IS_ABSOLUTE "${expressions_file}")
+            set(expressions_file "${CMAKE_CURRENT_SOURCE_DIR}/${expressions_file}")
+        endif()
+        if(EXISTS "${expressions_file}")
+            message(STATUS "${target}: compiling expressions from ${expressions_file}")
+            target_sources(${target} PRIVATE "${expressions_file}")
+        endif()
+    endforeach()
+endfunction()
@@ -0,0 +1,23 @@
+# SetupBenchmark.cmake
+# Provides benchmark::benchmark and benchmark::benchmark_main for the
+# microbenchmarks in core/benchmarks.  This module is only included when the
+# top-level CMakeLists.txt sees BUILD_BENCHMARKS set to ON.
+
+set(BENCHMARK_GIT_TAG "v1.8.3" CACHE STRING "Git tag or branch to checkout for Google Benchmark")
+
+# Prefer a system installation; otherwise fetch a copy so the build is
+# self-contained.
+find_package(benchmark QUIET)
+if(NOT benchmark_FOUND)
+    message(STATUS "Google Benchmark not found on system - fetching a copy via FetchContent")
+    include(FetchContent)
+    set(BENCHMARK_ENABLE_TESTING OFF CACHE BOOL "Disable Google Benchmark self-tests in fetched dependency" FORCE)
+    set(BENCHMARK_ENABLE_GTEST_TESTS OFF CACHE BOOL "Disable Google Benchmark gtest targets in fetched dependency" FORCE)
+    set(BENCHMARK_ENABLE_INSTALL OFF CACHE BOOL "Disable Google Benchmark install rules in fetched dependency" FORCE)
+    FetchContent_Declare(
+        benchmark
+        GIT_REPOSITORY https://github.com/google/benchmark.git
+        GIT_TAG ${BENCHMARK_GIT_TAG}
+    )
+    FetchContent_MakeAvailable(benchmark)
+endif()
@@ -0,0 +1,40 @@
+/**
+ * @file benchCorrections.cc
+ * @brief evaluateVectorCorrection for state.range(0) objects per event.
+ */
+
+#include "bench_util.h"
+
+#include <CorrectionManager.h>
+
+#include <benchmark/benchmark.h>
+
+#include <correction.h>
+
+namespace {
+
+/// test_correction of aux/correction.json: category (string) -> category
+/// (int) -> binning (real), two numeric inputs per object.
+void BM_EvaluateVectorCorrection(benchmark::State &state) {
+  bench::useTestInputs();
+  const auto set = correction::CorrectionSet::from_file("aux/correction.json");
+  const correction::Correction::Ref correction = set->at("test_correction");
+  const std::vector<std::string> stringArgs{"A"};
+
+  const auto nObjects = static_cast<std::size_t>(state.range(0));
+  const auto values = bench::uniform(nObjects, 0.0f, 2.0f);
+  ROOT::VecOps::RVec<double> flat;
+  flat.reserve(2 * nObjects);
+  for (std::size_t i = 0; i < nObjects; ++i) {
+    flat.push_back(values[i]);
+    flat.push_back(i % 2 == 0 ? 1.0 : 2.0);
+  }
+  for (auto _ : state) {
+    auto result = evaluateVectorCorrection(correction, stringArgs, flat, 2);
+    benchmark::DoNotOptimize(result);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_EvaluateVectorCorrection)->RangeMultiplier(4)->Range(1, 64);
+
+} // namespace
@@ -0,0 +1,42 @@
+/**
+ * @file benchDataManager.cc
+ * @brief Event loop cost of a DataManager::DefineVector column packing
+ *        state.range(0) scalar Float_t columns.
+ *
+ * Up to 32 inputs use the precompiled kernel; 33 exercises the JIT-compiled
+ * fallback.
+ */
+
+#include "bench_util.h"
+
+#include <ROOT/RVec.hxx>
+
+#include <benchmark/benchmark.h>
+
+namespace {
+
+constexpr std::size_t kEntries = 10000;
+
+void BM_DefineVector(benchmark::State &state) {
+  bench::PluginContext context("cfg/test_data_config_minimal.txt", kEntries);
+  const auto nColumns = static_cast<std::size_t>(state.range(0));
+  std::vector<std::string> columns;
+  for (std::size_t i = 0; i < nColumns; ++i) {
+    columns.push_back("x" + std::to_string(i));
+    context.defineCycling(columns.back(),
+                          bench::uniform(256, 0.0f, 1.0f, bench::kSeed + i));
+  }
+  context.data->DefineVector("packed", columns, "Float_t", context.systematics);
+
+  auto df = context.data->getDataFrame().Define(
+      "packedSum", [](const ROOT::VecOps::RVec<float> &v) { return ROOT::VecOps::Sum(v); },
+      {"packed"});
+  for (auto _ : state) {
+    auto sum = df.Sum<float>("packedSum");
+    benchmark::DoNotOptimize(sum.GetValue());
+  }
+  state.SetItemsProcessed(state.iterations() * kEntries);
+}
+BENCHMARK(BM_DefineVector)->Arg(2)->Arg(8)->Arg(32)->Arg(33)->Unit(benchmark::kMillisecond);
+
+} // namespace
@@ -0,0 +1,74 @@
+/**
+ * @file benchGoldenJson.cc
+ * @brief GoldenJsonManager::isValid against a golden JSON of
+ *        state.range(0) runs.
+ */
+
+#include "bench_util.h"
+
+#include <GoldenJsonManager.h>
+
+#include <benchmark/benchmark.h>
+
+#include <filesystem>
+#include <fstream>
+
+namespace {
+
+constexpr unsigned int kFirstRun = 355000;
+/// Certified lumi ranges per run; sections [10k+1, 10k+8] for k < 20.
+constexpr unsigned int kRangesPerRun = 20;
+
+/// Write a golden JSON of @p nRuns runs and the configuration reading it.
+std::string writeGoldenJson(std::size_t nRuns) {
+  const auto dir = std::filesystem::temp_directory_path() /
+                   ("rdf_bench_golden_" + std::to_string(getpid()));
+  std::filesystem::create_directories(dir);
+  const auto json = dir / "golden.json";
+  {
+    std::ofstream out(json);
+    out << "{";
+    for (std::size_t r = 0; r < nRuns; ++r) {
+      out << (r ? ", " : "") << '"' << kFirstRun + r << "\": [";
+      for (unsigned int k = 0; k < kRangesPerRun; ++k) {
+        out << (k ? ", " : "") << '[' << 10 * k + 1 << ", " << 10 * k + 8 << ']';
+      }
+      out << "]";
+    }
+    out << "}\n";
+  }
+  std::ofstream(dir / "files.txt") << json.string() << "\n";
+  const auto config = dir / "config.txt";
+  std::ofstream(config) << "type=data\ngoldenJsonConfig=" << (dir / "files.txt").string()
+                        << "\n";
+  return config.string();
+}
+
+void BM_GoldenJsonIsValid(benchmark::State &state) {
+  const auto nRuns = static_cast<std::size_t>(state.range(0));
+  bench::PluginContext context(writeGoldenJson(nRuns), 1);
+  GoldenJsonManager manager;
+  manager.setContext(context.ctx);
+  manager.setupFromConfigFile();
+
+  // Lookups spread over the runs, inside and between the certified ranges,
+  // plus runs that are not in the JSON.
+  constexpr std::size_t kLookups = 1024;
+  const auto draws = bench::uniform(2 * kLookups, 0.0f, 1.0f);
+  std::vector<std::pair<unsigned int, unsigned int>> lookups(kLookups);
+  for (std::size_t i = 0; i < kLookups; ++i) {
+    lookups[i] = {kFirstRun + static_cast<unsigned int>(draws[2 * i] * 1.1f * nRuns),
+                  1 + static_cast<unsigned int>(draws[2 * i + 1] * 10 * kRangesPerRun)};
+  }
+  for (auto _ : state) {
+    std::size_t valid = 0;
+    for (const auto &[run, lumi] : lookups) {
+      valid += manager.isValid(run, lumi);
+    }
+    benchmark::DoNotOptimize(valid);
+  }
+  state.SetItemsProcessed(state.iterations() * kLookups);
+}
+BENCHMARK(BM_GoldenJsonIsValid)->RangeMultiplier(8)->Range(8, 4096);
+
+} // namespace
@@ -0,0 +1,141 @@
+/**
+ * @file benchHistogramFill.cc
+ * @brief Fill kernels of THnMulti (dense and sparse accumulators, the
+ *        scalar, multi-fill, systematic and weight-vector layouts) and of
+ *        BHnMulti.
+ *
+ * Every iteration fills kEntries entries from precomputed inputs, so the
+ * reported items per second are entries per second.
+ */
+
+#include "bench_util.h"
+
+#include <plots.h>
+
+#include <benchmark/benchmark.h>
+
+#include <ROOT/RVec.hxx>
+
+namespace {
+
+constexpr std::size_t kEntries = 1024;
+
+/// Five-axis layout of NDHistogramManager: channel, control region, sample
+/// category, systematic and value axes.  A large value axis makes the
+/// accumulator sparse.
+histFillInfo fillInfo(Int_t valueBins, Int_t systematicBins = 1) {
+  histFillInfo info;
+  info.name = "bench";
+  info.title = "bench";
+  info.nSlots = 1;
+  const bool sparse = valueBins > 1000;
+  const Int_t categoryBins = sparse ? 200 : 2;
+  info.nbins = {categoryBins, categoryBins, categoryBins, systematicBins, valueBins};
+  info.xmin = {0.0, 0.0, 0.0, 0.0, 0.0};
+  info.xmax = {static_cast<Double_t>(categoryBins), static_cast<Double_t>(categoryBins),
+               static_cast<Double_t>(categoryBins), static_cast<Double_t>(systematicBins),
+               static_cast<Double_t>(valueBins)};
+  return info;
+}
+
+void BM_THnMultiScalar(benchmark::State &state) {
+  auto info = fillInfo(static_cast<Int_t>(state.range(0)));
+  THnMulti action(info);
+  const auto values = bench::uniform(kEntries, 0.0f, static_cast<float>(state.range(0)));
+  const auto weights = bench::uniform(kEntries, 0.5f, 1.5f, bench::kSeed + 1);
+  for (auto _ : state) {
+    for (std::size_t i = 0; i < kEntries; ++i) {
+      action.Exec(0, values[i], weights[i], 0.5f, 0.5f, 0.5f);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * kEntries);
+  state.SetLabel(info.nbins[0] > 2 ? "sparse" : "dense");
+}
+BENCHMARK(BM_THnMultiScalar)->Arg(10)->Arg(1000)->Arg(100000);
+
+/// One fill per object (e.g. jet pT), each with its own weight.
+void BM_THnMultiMultiFill(benchmark::State &state) {
+  auto info = fillInfo(100);
+  info.weight_hasMultiFill = true;
+  info.hasMultiFill = true;
+  THnMulti action(info);
+  const std::size_t nObjects = static_cast<std::size_t>(state.range(0));
+  const auto raw = bench::uniform(nObjects * kEntries, 0.0f, 100.0f);
+  std::vector<ROOT::VecOps::RVec<Float_t>> values(kEntries);
+  for (std::size_t i = 0; i < kEntries; ++i) {
+    values[i].assign(raw.begin() + i * nObjects, raw.begin() + (i + 1) * nObjects);
+  }
+  const ROOT::VecOps::RVec<Float_t> weights(nObjects, 1.0f);
+  const ROOT::VecOps::RVec<Float_t> nominal{0.0f};
+  const ROOT::VecOps::RVec<Float_t> category{0.5f};
+  const ROOT::VecOps::RVec<Int_t> nFills{static_cast<Int_t>(nObjects)};
+  for (auto _ : state) {
+    for (std::size_t i = 0; i < kEntries; ++i) {
+      action.Exec(0, values[i], weights, nominal, category, category, category, nFills);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * kEntries);
+}
+BENCHMARK(BM_THnMultiMultiFill)->RangeMultiplier(4)->Range(1, 64);
+
+/// One fill per systematic variation, with a weight per variation.
+void BM_THnMultiSystematics(benchmark::State &state) {
+  const auto nSystematics = static_cast<Int_t>(state.range(0));
+  auto info = fillInfo(100, nSystematics);
+  info.weight_hasSystematic = true;
+  info.hasSystematic = true;
+  info.systematic_hasMultiFill = true;
+  THnMulti action(info);
+  ROOT::VecOps::RVec<Float_t> variations(nSystematics);
+  for (Int_t s = 0; s < nSystematics; ++s) {
+    variations[s] = static_cast<Float_t>(s) + 0.5f;
+  }
+  const auto weightValues = bench::uniform(nSystematics, 0.9f, 1.1f);
+  const ROOT::VecOps::RVec<Float_t> weights(weightValues.begin(), weightValues.end());
+  const auto values = bench::uniform(kEntries, 0.0f, 100.0f);
+  const ROOT::VecOps::RVec<Float_t> category{0.5f};
+  const ROOT::VecOps::RVec<Int_t> nFills(nSystematics, 1);
+  ROOT::VecOps::RVec<Float_t> value(1);
+  for (auto _ : state) {
+    for (std::size_t i = 0; i < kEntries; ++i) {
+      value[0] = values[i];
+      action.Exec(0, value, weights, variations, category, category, category, nFills);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * kEntries);
+}
+BENCHMARK(BM_THnMultiSystematics)->Arg(1)->Arg(10)->Arg(100);
+
+/// A vector of weights (scale or PDF variations) on the systematic axis.
+void BM_THnMultiWeightVector(benchmark::State &state) {
+  const auto nWeights = static_cast<Int_t>(state.range(0));
+  auto info = fillInfo(100, nWeights);
+  info.weightVector = true;
+  THnMulti action(info);
+  const auto weightValues = bench::uniform(nWeights, 0.9f, 1.1f);
+  const ROOT::VecOps::RVec<Float_t> weights(weightValues.begin(), weightValues.end());
+  const auto values = bench::uniform(kEntries, 0.0f, 100.0f);
+  for (auto _ : state) {
+    for (std::size_t i = 0; i < kEntries; ++i) {
+      action.Exec(0, values[i], weights, 0.5f, 0.5f, 0.5f);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * kEntries);
+}
+BENCHMARK(BM_THnMultiWeightVector)->Arg(9)->Arg(103);
+
+void BM_BHnMultiScalar(benchmark::State &state) {
+  auto info = fillInfo(static_cast<Int_t>(state.range(0)));
+  BHnMulti action(info);
+  const auto values = bench::uniform(kEntries, 0.0f, static_cast<float>(state.range(0)));
+  const auto weights = bench::uniform(kEntries, 0.5f, 1.5f, bench::kSeed + 1);
+  for (auto _ : state) {
+    for (std::size_t i = 0; i < kEntries; ++i) {
+      action.Exec(0, values[i], weights[i], 0.5f, 0.5f, 0.5f);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * kEntries);
+}
+BENCHMARK(BM_BHnMultiScalar)->Arg(10)->Arg(1000);
+
+} // namespace
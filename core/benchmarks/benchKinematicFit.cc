@@ -0,0 +1,38 @@
+/**
+ * @file benchKinematicFit.cc
+ * @brief KinematicFit::fit with one to three mass constraints.
+ */
+
+#include "bench_util.h"
+
+#include <KinematicFit.h>
+
+#include <benchmark/benchmark.h>
+
+namespace {
+
+/// state.range(0) constraints: Z -> ll, then H -> bb, then a three-body
+/// soft top-like constraint on two jets and a lepton.
+void BM_KinematicFit(benchmark::State &state) {
+  const int nConstraints = static_cast<int>(state.range(0));
+  KinematicFit fitter;
+  const int l1 = fitter.addParticle({45.0, 0.3, 0.1, 0.106, 0.02, 0.001, 0.001});
+  const int l2 = fitter.addParticle({40.0, -0.5, 2.9, 0.106, 0.02, 0.001, 0.001});
+  fitter.addMassConstraint(l1, l2, 91.2);
+  if (nConstraints >= 2) {
+    const int j1 = fitter.addParticle({70.0, 1.1, -1.2, 4.8, 0.10, 0.05, 0.05});
+    const int j2 = fitter.addParticle({55.0, -0.2, 1.9, 4.8, 0.10, 0.05, 0.05});
+    fitter.addMassConstraint(j1, j2, 125.0);
+    if (nConstraints >= 3) {
+      fitter.addThreeBodyMassConstraint(j1, j2, l1, 173.3, 1.4);
+    }
+  }
+  for (auto _ : state) {
+    auto result = fitter.fit();
+    benchmark::DoNotOptimize(result);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_KinematicFit)->DenseRange(1, 3);
+
+} // namespace
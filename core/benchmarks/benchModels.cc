@@ -0,0 +1,102 @@
+/**
+ * @file benchModels.cc
+ * @brief Per-event inference of the BDT, ONNX and SOFIE managers.
+ *
+ * The models are applied once; every iteration books a new Sum of the
+ * output column and runs the event loop over state.range(0) entries, so the
+ * measured time is the inference lambda plus the (constant) loop overhead
+ * of the feature columns.
+ */
+
+#include "bench_util.h"
+
+#include <BDTManager.h>
+#include <OnnxManager.h>
+#include <SofieManager.h>
+
+#include <benchmark/benchmark.h>
+
+namespace {
+
+/// feature1..3 and the run variable of the test models.
+void defineModelInputs(bench::PluginContext &context) {
+  context.defineCycling("feature1", bench::uniform(1024, 0.0f, 2.0f, bench::kSeed));
+  context.defineCycling("feature2", bench::uniform(1024, 0.0f, 2.0f, bench::kSeed + 1));
+  context.defineCycling("feature3", bench::uniform(1024, 0.0f, 2.0f, bench::kSeed + 2));
+  context.data->Define(
+      "run_number", [](ULong64_t) -> bool { return true; }, {"rdfentry_"},
+      context.systematics);
+}
+
+void runLoop(benchmark::State &state, bench::PluginContext &context,
+             const std::string &output) {
+  for (auto _ : state) {
+    auto sum = context.data->getDataFrame().Sum<float>(output);
+    benchmark::DoNotOptimize(sum.GetValue());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void BM_BDTInference(benchmark::State &state) {
+  bench::PluginContext context("cfg/test_data_config.txt",
+                               static_cast<std::size_t>(state.range(0)));
+  BDTManager manager(*context.config);
+  manager.setContext(context.ctx);
+  defineModelInputs(context);
+  manager.applyBDT("test_bdt");
+  runLoop(state, context, "test_bdt");
+}
+BENCHMARK(BM_BDTInference)->Arg(1000)->Arg(10000)->Unit(benchmark::kMillisecond);
+
+void BM_OnnxInference(benchmark::State &state) {
+  bench::PluginContext context("cfg/test_data_config.txt",
+                               static_cast<std::size_t>(state.range(0)));
+  OnnxManager manager(*context.config);
+  manager.setContext(context.ctx);
+  defineModelInputs(context);
+  manager.applyModel("test_model");
+  runLoop(state, context, "test_model");
+}
+BENCHMARK(BM_OnnxInference)->Arg(1000)->Arg(10000)->Unit(benchmark::kMillisecond);
+
+/// Sum of the features: isolates the SofieManager plumbing (feature
+/// gathering, slot-local sessions) from the generated model code.
+class SumSession : public SofieSession {
+public:
+  void infer(const float *input, float *output) override {
+    output[0] = input[0] + input[1] + input[2];
+  }
+};
+
+void BM_SofieFunctionInference(benchmark::State &state) {
+  bench::PluginContext context("cfg/test_data_config_minimal.txt",
+                               static_cast<std::size_t>(state.range(0)));
+  SofieManager manager(*context.config);
+  manager.setContext(context.ctx);
+  manager.registerModel(
+      "bench_sofie",
+      std::make_shared<SofieInferenceFunction>([](const std::vector<float> &input) {
+        return std::vector<float>{input[0] + input[1] + input[2]};
+      }),
+      {"feature1", "feature2", "feature3"}, "run_number");
+  defineModelInputs(context);
+  manager.applyModel("bench_sofie");
+  runLoop(state, context, "bench_sofie");
+}
+BENCHMARK(BM_SofieFunctionInference)->Arg(1000)->Arg(10000)->Unit(benchmark::kMillisecond);
+
+void BM_SofieSessionInference(benchmark::State &state) {
+  bench::PluginContext context("cfg/test_data_config_minimal.txt",
+                               static_cast<std::size_t>(state.range(0)));
+  SofieManager manager(*context.config);
+  manager.setContext(context.ctx);
+  manager.registerSessionModel(
+      "bench_sofie", [] { return std::make_unique<SumSession>(); },
+      {"feature1", "feature2", "feature3"}, "run_number");
+  defineModelInputs(context);
+  manager.applyModel("bench_sofie");
+  runLoop(state, context, "bench_sofie");
+}
+BENCHMARK(BM_SofieSessionInference)->Arg(1000)->Arg(10000)->Unit(benchmark::kMillisecond);
+
+} // namespace
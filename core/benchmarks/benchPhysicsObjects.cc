@@ -0,0 +1,115 @@
+/**
+ * @file benchPhysicsObjects.cc
+ * @brief PhysicsObjectCollection construction, filtering, overlap removal
+ *        and combinatorics for collections of state.range(0) objects.
+ */
+
+#include "bench_util.h"
+
+#include <PhysicsObjectCollection.h>
+
+#include <benchmark/benchmark.h>
+
+#include <ROOT/RVec.hxx>
+
+namespace {
+
+/// Kinematics of one event's full object collection.
+struct Columns {
+  explicit Columns(std::size_t n, std::uint32_t seed = bench::kSeed) {
+    const auto ptValues = bench::uniform(n, 20.0f, 200.0f, seed);
+    const auto etaValues = bench::uniform(n, -2.5f, 2.5f, seed + 1);
+    const auto phiValues = bench::uniform(n, -3.14159f, 3.14159f, seed + 2);
+    pt.assign(ptValues.begin(), ptValues.end());
+    eta.assign(etaValues.begin(), etaValues.end());
+    phi.assign(phiValues.begin(), phiValues.end());
+    mass = ROOT::VecOps::RVec<Float_t>(n, 5.0f);
+    mask = pt > 30.0f;
+    charge.resize(n);
+    for (std::size_t i = 0; i < n; ++i) {
+      charge[i] = i % 2 == 0 ? 1 : -1;
+    }
+  }
+
+  PhysicsObjectCollection all() const {
+    return PhysicsObjectCollection(pt, eta, phi, mass, ROOT::VecOps::RVec<bool>(pt.size(), true));
+  }
+
+  ROOT::VecOps::RVec<Float_t> pt, eta, phi, mass;
+  ROOT::VecOps::RVec<bool> mask;
+  ROOT::VecOps::RVec<Int_t> charge;
+};
+
+void BM_CollectionFromMask(benchmark::State &state) {
+  const Columns columns(static_cast<std::size_t>(state.range(0)));
+  for (auto _ : state) {
+    PhysicsObjectCollection collection(columns.pt, columns.eta, columns.phi, columns.mass,
+                                       columns.mask);
+    benchmark::DoNotOptimize(collection);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_CollectionFromMask)->RangeMultiplier(4)->Range(4, 256);
+
+void BM_CollectionWithFilter(benchmark::State &state) {
+  const Columns columns(static_cast<std::size_t>(state.range(0)));
+  const auto collection = columns.all();
+  const auto mask = columns.eta > 0.0f;
+  for (auto _ : state) {
+    auto filtered = collection.withFilter(mask);
+    benchmark::DoNotOptimize(filtered);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_CollectionWithFilter)->RangeMultiplier(4)->Range(4, 256);
+
+/// Remove the objects within ΔR 0.4 of an equally large second collection.
+void BM_RemoveOverlap(benchmark::State &state) {
+  const auto n = static_cast<std::size_t>(state.range(0));
+  const auto jets = Columns(n).all();
+  const auto leptons = Columns(n, bench::kSeed + 10).all();
+  for (auto _ : state) {
+    auto cleaned = jets.removeOverlap(leptons, 0.4f);
+    benchmark::DoNotOptimize(cleaned);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_RemoveOverlap)->RangeMultiplier(4)->Range(4, 256);
+
+void BM_MakePairs(benchmark::State &state) {
+  const auto collection = Columns(static_cast<std::size_t>(state.range(0))).all();
+  for (auto _ : state) {
+    auto pairs = makePairs(collection);
+    benchmark::DoNotOptimize(pairs);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_MakePairs)->RangeMultiplier(2)->Range(2, 32);
+
+void BM_MakeTriplets(benchmark::State &state) {
+  const auto collection = Columns(static_cast<std::size_t>(state.range(0))).all();
+  for (auto _ : state) {
+    auto triplets = makeTriplets(collection);
+    benchmark::DoNotOptimize(triplets);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_MakeTriplets)->RangeMultiplier(2)->Range(3, 24);
+
+/// Z candidate: opposite-charge pair with ΔR > 0.2 closest to 91.2 GeV.
+void BM_BestPairByMass(benchmark::State &state) {
+  const Columns columns(static_cast<std::size_t>(state.range(0)));
+  const auto collection = columns.all();
+  CombinatoricCuts cuts;
+  cuts.minDeltaR = 0.2f;
+  cuts.totalCharge = 0;
+  cuts.charges = columns.charge;
+  for (auto _ : state) {
+    auto best = bestPairByMass(collection, 91.2f, cuts);
+    benchmark::DoNotOptimize(best);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_BestPairByMass)->RangeMultiplier(2)->Range(2, 32);
+
+} // namespace
@@ -0,0 +1,82 @@
+/**
+ * @file bench_util.h
+ * @brief Shared setup of the core microbenchmarks.
+ */
+#ifndef BENCH_UTIL_H_INCLUDED
+#define BENCH_UTIL_H_INCLUDED
+
+#include <DataManager.h>
+#include <DefaultLogger.h>
+#include <ManagerFactory.h>
+#include <NullOutputSink.h>
+#include <SystematicManager.h>
+#include <api/ManagerContext.h>
+
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+namespace bench {
+
+/// Seed of every random input, so that runs are comparable.
+constexpr std::uint32_t kSeed = 12345;
+
+/**
+ * @brief Run from the C++ test directory, whose cfg/ and aux/ files (models,
+ *        corrections) the benchmarks reuse.
+ */
+inline void useTestInputs() {
+  if (chdir(BENCHMARK_DATA_DIR) != 0) {
+    throw std::runtime_error(std::string("cannot change to ") + BENCHMARK_DATA_DIR);
+  }
+}
+
+/// @p n values drawn uniformly from [@p low, @p high).
+inline std::vector<float> uniform(std::size_t n, float low, float high,
+                                  std::uint32_t seed = kSeed) {
+  std::mt19937 rng(seed);
+  std::uniform_real_distribution<float> dist(low, high);
+  std::vector<float> values(n);
+  for (auto &value : values) {
+    value = dist(rng);
+  }
+  return values;
+}
+
+/**
+ * @brief Managers of a plugin under test: configuration from @p configFile
+ *        (relative to the test directory) and an empty-source DataManager
+ *        of @p entries entries.
+ */
+struct PluginContext {
+  explicit PluginContext(const std::string &configFile, std::size_t entries)
+      : config((useTestInputs(), ManagerFactory::createConfigurationManager(configFile))),
+        data(std::make_unique<DataManager>(entries)),
+        ctx{*config, *data, systematics, logger, skimSink, metaSink} {}
+
+  std::unique_ptr<IConfigurationProvider> config;
+  SystematicManager systematics;
+  std::unique_ptr<DataManager> data;
+  DefaultLogger logger;
+  NullOutputSink skimSink;
+  NullOutputSink metaSink;
+  ManagerContext ctx;
+
+  /// Define float column @p name cycling through @p values.
+  void defineCycling(const std::string &name, std::vector<float> values) {
+    data->Define(
+        name,
+        [values = std::move(values)](ULong64_t entry) -> float {
+          return values[entry % values.size()];
+        },
+        {"rdfentry_"}, systematics);
+  }
+};
+
+} // namespace bench
+
+#endif // BENCH_UTIL_H_INCLUDED
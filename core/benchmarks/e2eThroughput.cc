@@ -0,0 +1,702 @@
+/**
+ * @file e2eThroughput.cc
+ * @brief End-to-end throughput of a representative analysis on synthetic
+ *        NanoAOD-like events, scanned over thread counts.
+ *
+ * Usage:
+ *   e2eThroughput [--entries N] [--jets MEAN] [--leptons MEAN] [--branches N]
+ *                 [--input memory|disk] [--compression SETTING]
+ *                 [--threads 1,2,4,...] [--workdir DIR] [--out FILE]
+ *
+ * Every event has Poisson-distributed jet and lepton (muon + electron)
+ * multiplicities and --branches extra float branches, drawn from a counter
+ * based generator seeded by the entry number, so the events do not depend on
+ * the thread count or the input mode.  With --input memory the columns are
+ * defined on DataManager(nEntries); with --input disk they are first written
+ * once to <workdir>/synthetic_*.root with the ROOT compression setting
+ * --compression (algorithm * 100 + level, default 505: ZSTD level 5), and
+ * read back through the configured file list.
+ *
+ * The analysis corrects the jets with a correctionlib scale factor (nominal,
+ * up, down), propagates a jet energy scale systematic, builds the nominal and
+ * varied event weights with WeightManager, declares three nested regions,
+ * books the histograms of a histogramConfig bound to the regions and writes a
+ * skim of the preselected events including the extra branches.
+ *
+ * Every thread count runs in a fresh process (ROOT's thread pool cannot be
+ * resized, and peak RSS is per process).  For each point the table and the
+ * JSON file (default <workdir>/e2e_throughput.json) report:
+ *   - startupSeconds: process start until the graph is booked (loading,
+ *     configuration, plugin setup, booking)
+ *   - runSeconds: save(), i.e. jitting, the event loop and writing outputs
+ *   - eventsPerSecond: entries / runSeconds, and the speedup over the first
+ *     point
+ *   - cpuEfficiency: CPU time of save() / (runSeconds * threads)
+ *   - peakRssMB: peak resident memory of the process
+ */
+#include <AsyncLogger.h>
+#include <CorrectionManager.h>
+#include <DataManager.h>
+#include <ManagerFactory.h>
+#include <NDHistogramManager.h>
+#include <RegionManager.h>
+#include <WeightManager.h>
+#include <analyzer.h>
+
+#include <Compression.h>
+#include <Math/Vector4D.h>
+#include <ROOT/RDataFrame.hxx>
+#include <ROOT/RVec.hxx>
+#include <TROOT.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <thread>
+#include <tuple>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+using ROOT::VecOps::RVec;
+using Clock = std::chrono::steady_clock;
+
+constexpr float kPi = 3.14159265f;
+
+struct Options {
+  std::size_t entries = 1000000;
+  double jets = 5.0;
+  double leptons = 2.0;
+  std::size_t branches = 0;
+  std::string input = "memory";
+  int compression = 505;
+  std::vector<unsigned int> threads;
+  std::string workdir = "e2e_throughput";
+  std::string out;
+  /// Set in the child processes: run one point and write its result.
+  unsigned int point = 0;
+  std::string result;
+};
+
+// ---------------------------------------------------------------------------
+// Synthetic events
+// ---------------------------------------------------------------------------
+
+std::uint64_t splitmix64(std::uint64_t x) {
+  x += 0x9e3779b97f4a7c15ULL;
+  x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+  return x ^ (x >> 31);
+}
+
+/// Random stream of one (entry, column) pair.
+class EventRng {
+public:
+  EventRng(ULong64_t entry, std::uint64_t stream)
+      : state_m(splitmix64(entry * 0x100000001b3ULL + stream)) {}
+
+  float uniform(float low, float high) {
+    state_m = splitmix64(state_m);
+    return low + (high - low) * static_cast<float>((state_m >> 40) * 0x1.0p-24);
+  }
+  float exponential(float mean) { return -mean * std::log(1.0f - uniform(0.0f, 1.0f)); }
+  unsigned int poisson(double mean) {
+    const double limit = std::exp(-mean);
+    double product = uniform(0.0f, 1.0f);
+    unsigned int n = 0;
+    while (product > limit) {
+      product *= uniform(0.0f, 1.0f);
+      ++n;
+    }
+    return n;
+  }
+
+private:
+  std::uint64_t state_m;
+};
+
+/// Streams of the generated columns; per-object columns of one collection
+/// share their multiplicity stream.
+enum Stream : std::uint64_t {
+  kNJet = 1, kJetPt, kJetEta, kJetPhi, kJetMass, kJetBtag,
+  kNMuon, kMuonPt, kMuonEta, kMuonPhi, kMuonCharge,
+  kNElectron, kElectronPt, kElectronEta, kElectronPhi, kElectronCharge,
+  kGenWeight, kAux = 100
+};
+
+template <typename T, typename F>
+RVec<T> objects(ULong64_t entry, Stream multiplicity, double mean, Stream stream, F draw) {
+  const unsigned int n = EventRng(entry, multiplicity).poisson(mean);
+  EventRng rng(entry, stream);
+  RVec<T> values(n);
+  for (auto &value : values) {
+    value = draw(rng);
+  }
+  return values;
+}
+
+/**
+ * @brief Define the synthetic event columns through @p define, called as
+ *        define(name, callable, {"rdfentry_"}).
+ */
+template <typename DefineFn>
+void defineSyntheticEvents(const Options &options, DefineFn &&define) {
+  const double jets = options.jets;
+  const double muons = options.leptons / 2;
+  const double electrons = options.leptons / 2;
+  const std::vector<std::string> entry{"rdfentry_"};
+
+  define("run", [](ULong64_t) -> UInt_t { return 1; }, entry);
+  define("luminosityBlock", [](ULong64_t e) -> UInt_t { return 1 + e / 1000; }, entry);
+  define("event", [](ULong64_t e) -> ULong64_t { return e; }, entry);
+  define("genWeight",
+         [](ULong64_t e) -> Float_t {
+           return EventRng(e, kGenWeight).uniform(0.0f, 1.0f) < 0.1f ? -1.0f : 1.0f;
+         },
+         entry);
+
+  define("nJet", [jets](ULong64_t e) -> UInt_t { return EventRng(e, kNJet).poisson(jets); },
+         entry);
+  define("Jet_pt",
+         [jets](ULong64_t e) {
+           return objects<Float_t>(e, kNJet, jets, kJetPt,
+                                   [](EventRng &r) { return 20.0f + r.exponential(40.0f); });
+         },
+         entry);
+  define("Jet_eta",
+         [jets](ULong64_t e) {
+           return objects<Float_t>(e, kNJet, jets, kJetEta,
+                                   [](EventRng &r) { return r.uniform(-4.7f, 4.7f); });
+         },
+         entry);
+  define("Jet_phi",
+         [jets](ULong64_t e) {
+           return objects<Float_t>(e, kNJet, jets, kJetPhi,
+                                   [](EventRng &r) { return r.uniform(-kPi, kPi); });
+         },
+         entry);
+  define("Jet_mass",
+         [jets](ULong64_t e) {
+           return objects<Float_t>(e, kNJet, jets, kJetMass,
+                                   [](EventRng &r) { return 5.0f + r.exponential(10.0f); });
+         },
+         entry);
+  define("Jet_btagDeepFlavB",
+         [jets](ULong64_t e) {
+           return objects<Float_t>(e, kNJet, jets, kJetBtag,
+                                   [](EventRng &r) { return r.uniform(0.0f, 1.0f); });
+         },
+         entry);
+
+  for (const auto &[prefix, mean, base] :
+       {std::make_tuple(std::string("Muon"), muons, kNMuon),
+        std::make_tuple(std::string("Electron"), electrons, kNElectron)}) {
+    const auto count = static_cast<Stream>(base);
+    define("n" + prefix,
+           [count, mean = mean](ULong64_t e) -> UInt_t {
+             return EventRng(e, count).poisson(mean);
+           },
+           entry);
+    define(prefix + "_pt",
+           [count, mean = mean](ULong64_t e) {
+             return objects<Float_t>(e, count, mean, static_cast<Stream>(count + 1),
+                                     [](EventRng &r) { return 10.0f + r.exponential(30.0f); });
+           },
+           entry);
+    define(prefix + "_eta",
+           [count, mean = mean](ULong64_t e) {
+             return objects<Float_t>(e, count, mean, static_cast<Stream>(count + 2),
+                                     [](EventRng &r) { return r.uniform(-2.4f, 2.4f); });
+           },
+           entry);
+    define(prefix + "_phi",
+           [count, mean = mean](ULong64_t e) {
+             return objects<Float_t>(e, count, mean, static_cast<Stream>(count + 3),
+                                     [](EventRng &r) { return r.uniform(-kPi, kPi); });
+           },
+           entry);
+    define(prefix + "_charge",
+           [count, mean = mean](ULong64_t e) {
+             return objects<Int_t>(e, count, mean, static_cast<Stream>(count + 4),
+                                   [](EventRng &r) { return r.uniform(0.0f, 1.0f) < 0.5f ? -1 : 1; });
+           },
+           entry);
+  }
+
+  for (std::size_t i = 0; i < options.branches; ++i) {
+    const std::uint64_t stream = kAux + i;
+    define("Aux_" + std::to_string(i),
+           [stream](ULong64_t e) -> Float_t { return EventRng(e, stream).uniform(0.0f, 1.0f); },
+           entry);
+  }
+}
+
+std::string syntheticFile(const Options &options) {
+  std::ostringstream name;
+  name << "synthetic_" << options.entries << "_j" << options.jets << "_l" << options.leptons
+       << "_b" << options.branches << "_c" << options.compression << ".root";
+  return (std::filesystem::path(options.workdir) / name.str()).string();
+}
+
+/// Write the synthetic events to syntheticFile() unless it already exists.
+void generateInput(const Options &options) {
+  const std::string path = syntheticFile(options);
+  if (std::filesystem::exists(path)) {
+    std::cout << "e2eThroughput: reusing " << path << std::endl;
+    return;
+  }
+  const auto begin = Clock::now();
+  ROOT::RDF::RNode node = ROOT::RDataFrame(options.entries);
+  std::vector<std::string> columns;
+  defineSyntheticEvents(options, [&](const std::string &name, auto f,
+                                     const std::vector<std::string> &inputs) {
+    node = node.Define(name, f, inputs);
+    columns.push_back(name);
+  });
+  ROOT::RDF::RSnapshotOptions snapshotOptions;
+  snapshotOptions.fCompressionAlgorithm =
+      static_cast<ROOT::RCompressionSetting::EAlgorithm::EValues>(options.compression / 100);
+  snapshotOptions.fCompressionLevel = options.compression % 100;
+  const std::string tmpPath = path + ".tmp." + std::to_string(getpid());
+  node.Snapshot("Events", tmpPath, columns, snapshotOptions);
+  std::filesystem::rename(tmpPath, path);
+  std::cout << "e2eThroughput: wrote " << options.entries << " events to " << path << " in "
+            << std::chrono::duration<double>(Clock::now() - begin).count() << " s ("
+            << std::filesystem::file_size(path) / (1024.0 * 1024.0) << " MB)" << std::endl;
+}
+
+// ---------------------------------------------------------------------------
+// Analysis
+// ---------------------------------------------------------------------------
+
+/// correctionlib jet scale factor in (pt, eta) with nominal/up/down.
+void writeCorrection(const std::string &path) {
+  const std::vector<double> ptEdges{20, 30, 50, 80, 120, 200, 400, 1000};
+  const std::vector<double> etaEdges{-4.7, -2.5, -1.5, 0, 1.5, 2.5, 4.7};
+  std::ofstream out(path);
+  out << R"({"schema_version": 2, "corrections": [{"name": "jet_sf", "version": 1,)"
+      << R"( "inputs": [{"name": "pt", "type": "real"}, {"name": "eta", "type": "real"},)"
+      << R"( {"name": "syst", "type": "string"}], "output": {"name": "sf", "type": "real"},)"
+      << R"( "data": {"nodetype": "category", "input": "syst", "content": [)";
+  const std::vector<std::pair<std::string, double>> shifts{
+      {"nominal", 0.0}, {"up", 0.02}, {"down", -0.02}};
+  for (std::size_t s = 0; s < shifts.size(); ++s) {
+    out << (s ? ", " : "") << R"({"key": ")" << shifts[s].first
+        << R"(", "value": {"nodetype": "multibinning", "inputs": ["pt", "eta"], "edges": [[)";
+    for (std::size_t i = 0; i < ptEdges.size(); ++i) {
+      out << (i ? ", " : "") << ptEdges[i];
+    }
+    out << "], [";
+    for (std::size_t i = 0; i < etaEdges.size(); ++i) {
+      out << (i ? ", " : "") << etaEdges[i];
+    }
+    out << "]], \"content\": [";
+    for (std::size_t i = 0; i + 1 < ptEdges.size(); ++i) {
+      for (std::size_t j = 0; j + 1 < etaEdges.size(); ++j) {
+        out << (i || j ? ", " : "") << 0.95 + 0.01 * i - 0.005 * j + shifts[s].second;
+      }
+    }
+    out << R"(], "flow": "clamp"}})";
+  }
+  out << "]}}]}\n";
+}
+
+/// Configuration files shared by all points.
+void writeAnalysisInputs(const Options &options) {
+  const std::filesystem::path dir(options.workdir);
+  writeCorrection((dir / "jet_sf.json").string());
+  std::ofstream(dir / "corrections.txt")
+      << "file=" << (dir / "jet_sf.json").string()
+      << " correctionName=jet_sf name=jet_sf inputVariables=Jet_pt,Jet_eta\n";
+  std::ofstream(dir / "histograms.txt")
+      << "name=HT variable=HT weight=weight_nominal bins=50 lowerBound=0 upperBound=1500\n"
+      << "name=nGoodJet variable=nGoodJet weight=weight_nominal bins=15 lowerBound=0 "
+         "upperBound=15\n"
+      << "name=leadLepPt variable=leadLepPt weight=weight_nominal bins=50 lowerBound=0 "
+         "upperBound=250\n"
+      << "name=mll variable=mll weight=weight_nominal bins=60 lowerBound=0 upperBound=300\n";
+  std::ofstream(dir / "output.txt") << "run\nluminosityBlock\nevent\nnJet\nJet_*\nnGoodJet\nHT\n"
+                                       "leadLepPt\nmll\nweight_nominal\nAux_*\n";
+}
+
+std::string writePointConfig(const Options &options, unsigned int threads) {
+  const std::filesystem::path dir(options.workdir);
+  const std::string tag = std::to_string(threads);
+  const auto path = dir / ("config_" + tag + ".txt");
+  std::ofstream config(path);
+  config << "threads=" << threads << "\n"
+         << "saveFile=" << (dir / ("skim_" + tag + ".root")).string() << "\n"
+         << "metaFile=" << (dir / ("hists_" + tag + ".root")).string() << "\n"
+         << "saveTree=Events\n"
+         << "saveConfig=" << (dir / "output.txt").string() << "\n"
+         << "correctionConfig=" << (dir / "corrections.txt").string() << "\n"
+         << "histogramConfig=" << (dir / "histograms.txt").string() << "\n";
+  if (options.input == "disk") {
+    config << "fileList=" << syntheticFile(options) << "\n"
+           << "treeList=Events\n";
+  }
+  return path.string();
+}
+
+float leadingPt(const RVec<Float_t> &muonPt, const RVec<Float_t> &electronPt) {
+  const float muon = muonPt.empty() ? 0.0f : ROOT::VecOps::Max(muonPt);
+  const float electron = electronPt.empty() ? 0.0f : ROOT::VecOps::Max(electronPt);
+  return std::max(muon, electron);
+}
+
+/// Mass of the two leading muons or, failing that, electrons.
+float dileptonMass(const RVec<Float_t> &muPt, const RVec<Float_t> &muEta,
+                   const RVec<Float_t> &muPhi, const RVec<Float_t> &elPt,
+                   const RVec<Float_t> &elEta, const RVec<Float_t> &elPhi) {
+  using Vector = ROOT::Math::PtEtaPhiMVector;
+  const auto mass = [](const RVec<Float_t> &pt, const RVec<Float_t> &eta,
+                       const RVec<Float_t> &phi) {
+    const auto order = ROOT::VecOps::Reverse(ROOT::VecOps::Argsort(pt));
+    return static_cast<float>((Vector(pt[order[0]], eta[order[0]], phi[order[0]], 0) +
+                               Vector(pt[order[1]], eta[order[1]], phi[order[1]], 0))
+                                  .M());
+  };
+  if (muPt.size() >= 2) {
+    return mass(muPt, muEta, muPhi);
+  }
+  if (elPt.size() >= 2) {
+    return mass(elPt, elEta, elPhi);
+  }
+  return -1.0f;
+}
+
+void bookAnalysis(Analyzer &an) {
+  auto corrections = CorrectionManager::create(an);
+  auto weights = WeightManager::create(an);
+  auto regions = RegionManager::create(an);
+  auto histograms = NDHistogramManager::create(an);
+
+  // Jet energy scale, propagated through everything computed from Jet_pt.
+  an.Define("Jet_pt_jesUp", [](const RVec<Float_t> &pt) { return pt * 1.02f; }, {"Jet_pt"});
+  an.Define("Jet_pt_jesDown", [](const RVec<Float_t> &pt) { return pt * 0.98f; }, {"Jet_pt"});
+  an.getSystematicManager().registerSystematic("jes", {"Jet_pt"});
+
+  for (const std::string syst : {"nominal", "up", "down"}) {
+    corrections->applyCorrectionVec("jet_sf", {syst});
+  }
+
+  an.Define("goodJet",
+            [](const RVec<Float_t> &pt, const RVec<Float_t> &eta) {
+              return pt > 30.0f && abs(eta) < 2.4f;
+            },
+            {"Jet_pt", "Jet_eta"});
+  an.Define("nGoodJet", [](const RVec<int> &good) { return ROOT::VecOps::Sum(good); },
+            {"goodJet"});
+  an.Define("HT",
+            [](const RVec<Float_t> &pt, const RVec<int> &good) {
+              return ROOT::VecOps::Sum(pt[good]);
+            },
+            {"Jet_pt", "goodJet"});
+  for (const std::string syst : {"nominal", "up", "down"}) {
+    an.Define("jetSF_" + syst,
+              [](const RVec<Float_t> &sf, const RVec<int> &good) {
+                return static_cast<Float_t>(ROOT::VecOps::Product(sf[good]));
+              },
+              {"jet_sf_" + syst, "goodJet"});
+  }
+  an.Define("leadLepPt", leadingPt, {"Muon_pt", "Electron_pt"});
+  an.Define("mll", dileptonMass,
+            {"Muon_pt", "Muon_eta", "Muon_phi", "Electron_pt", "Electron_eta", "Electron_phi"});
+
+  weights->addNormalization("lumi", 0.1);
+  weights->addScaleFactor("genWeight", "genWeight");
+  weights->addScaleFactor("jetSF", "jetSF_nominal");
+  weights->addWeightVariation("jetSF", "jetSF", "jetSF_up", "jetSF_down");
+  weights->defineNominalWeight();
+  weights->defineVariedWeight("jetSF", "up", "weight_jetSFUp");
+  weights->defineVariedWeight("jetSF", "down", "weight_jetSFDown");
+
+  an.Define("isPresel",
+            [](int nGoodJet, float leadLepPt) { return nGoodJet >= 2 && leadLepPt > 25.0f; },
+            {"nGoodJet", "leadLepPt"});
+  an.Define("isSignal", [](int nGoodJet, float ht) { return nGoodJet >= 4 && ht > 300.0f; },
+            {"nGoodJet", "HT"});
+  an.Define("isControl", [](int nGoodJet) { return nGoodJet < 4; }, {"nGoodJet"});
+  regions->declareRegion("presel", "isPresel");
+  regions->declareRegion("signal", "isSignal", "presel");
+  regions->declareRegion("control", "isControl", "presel");
+
+  histograms->bindToRegionManager(regions.get());
+  an.bookConfigHistograms();
+
+  an.Filter("skim", [](bool presel) { return presel; }, {"isPresel"});
+}
+
+double cpuSeconds() {
+  rusage usage{};
+  getrusage(RUSAGE_SELF, &usage);
+  return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec +
+         1e-6 * (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec);
+}
+
+double steadySeconds(Clock::time_point time) {
+  return std::chrono::duration<double>(time.time_since_epoch()).count();
+}
+
+/// Child process: run the analysis with options.point threads.
+int runPoint(const Options &options) {
+  const std::string configFile = writePointConfig(options, options.point);
+  std::unique_ptr<Analyzer> an;
+  if (options.input == "memory") {
+    if (options.point > 1) {
+      ROOT::EnableImplicitMT(options.point);
+    }
+    auto config = ManagerFactory::createConfigurationManager(configFile);
+    auto skimSink = ManagerFactory::createOutputSink(*config, OutputChannel::Skim);
+    auto metaSink = ManagerFactory::createOutputSink(*config, OutputChannel::Meta);
+    an = std::make_unique<Analyzer>(
+        std::move(config), std::make_unique<DataManager>(options.entries),
+        std::unordered_map<std::string, std::shared_ptr<IPluggableManager>>{},
+        ManagerFactory::createSystematicManager(), std::make_unique<ProcessLogger>(),
+        std::move(skimSink), std::move(metaSink));
+    defineSyntheticEvents(options, [&](const std::string &name, auto f,
+                                       const std::vector<std::string> &inputs) {
+      an->Define(name, f, inputs);
+    });
+  } else {
+    an = std::make_unique<Analyzer>(configFile);
+  }
+  bookAnalysis(*an);
+  const auto booked = Clock::now();
+
+  const double cpuBegin = cpuSeconds();
+  an->save();
+  const double runSeconds = std::chrono::duration<double>(Clock::now() - booked).count();
+  const double cpu = cpuSeconds() - cpuBegin;
+
+  rusage usage{};
+  getrusage(RUSAGE_SELF, &usage);
+  std::ofstream result(options.result);
+  result << "booked=" << std::setprecision(17) << steadySeconds(booked) << "\n"
+         << "runSeconds=" << runSeconds << "\n"
+         << "cpuSeconds=" << cpu << "\n"
+         << "peakRssKB=" << usage.ru_maxrss << "\n";
+  return result ? 0 : 1;
+}
+
+// ---------------------------------------------------------------------------
+// Driver
+// ---------------------------------------------------------------------------
+
+struct Point {
+  unsigned int threads = 0;
+  double startupSeconds = 0;
+  double runSeconds = 0;
+  double eventsPerSecond = 0;
+  double cpuEfficiency = 0;
+  double peakRssMB = 0;
+};
+
+std::map<std::string, double> readResult(const std::string &path) {
+  std::map<std::string, double> values;
+  std::ifstream in(path);
+  std::string line;
+  while (std::getline(in, line)) {
+    const auto eq = line.find('=');
+    if (eq != std::string::npos) {
+      values[line.substr(0, eq)] = std::stod(line.substr(eq + 1));
+    }
+  }
+  return values;
+}
+
+/// Run one point in a fresh process of this executable.
+Point measure(const Options &options, unsigned int threads, const std::vector<std::string> &args) {
+  const std::string result =
+      (std::filesystem::path(options.workdir) / ("result_" + std::to_string(threads) + ".txt"))
+          .string();
+  std::filesystem::remove(result);
+  std::vector<std::string> childArgs = args;
+  childArgs.insert(childArgs.end(), {"--point", std::to_string(threads), "--result", result});
+  std::vector<char *> argv;
+  for (auto &arg : childArgs) {
+    argv.push_back(arg.data());
+  }
+  argv.push_back(nullptr);
+
+  const auto start = Clock::now();
+  const pid_t pid = fork();
+  if (pid < 0) {
+    throw std::runtime_error("e2eThroughput: fork failed");
+  }
+  if (pid == 0) {
+    execv("/proc/self/exe", argv.data());
+    _exit(127);
+  }
+  int status = 0;
+  waitpid(pid, &status, 0);
+  if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+    throw std::runtime_error("e2eThroughput: the run with " + std::to_string(threads) +
+                             " threads failed");
+  }
+
+  const auto values = readResult(result);
+  Point point;
+  point.threads = threads;
+  point.startupSeconds = values.at("booked") - steadySeconds(start);
+  point.runSeconds = values.at("runSeconds");
+  point.eventsPerSecond = options.entries / point.runSeconds;
+  point.cpuEfficiency = values.at("cpuSeconds") / (point.runSeconds * threads);
+  point.peakRssMB = values.at("peakRssKB") / 1024.0;
+  return point;
+}
+
+void writeReport(const Options &options, const std::vector<Point> &points) {
+  std::ofstream out(options.out);
+  out << std::setprecision(6) << "{\n"
+      << "  \"entries\": " << options.entries << ",\n"
+      << "  \"input\": \"" << options.input << "\",\n"
+      << "  \"jets\": " << options.jets << ",\n"
+      << "  \"leptons\": " << options.leptons << ",\n"
+      << "  \"branches\": " << options.branches << ",\n"
+      << "  \"compression\": " << options.compression << ",\n"
+      << "  \"hardwareThreads\": " << std::thread::hardware_concurrency() << ",\n"
+      << "  \"points\": [";
+  for (std::size_t i = 0; i < points.size(); ++i) {
+    const auto &p = points[i];
+    out << (i ? "," : "") << "\n    {\"threads\": " << p.threads
+        << ", \"startupSeconds\": " << p.startupSeconds << ", \"runSeconds\": " << p.runSeconds
+        << ", \"eventsPerSecond\": " << p.eventsPerSecond
+        << ", \"speedup\": " << p.eventsPerSecond / points.front().eventsPerSecond
+        << ", \"cpuEfficiency\": " << p.cpuEfficiency << ", \"peakRssMB\": " << p.peakRssMB
+        << "}";
+  }
+  out << "\n  ]\n}\n";
+}
+
+std::vector<unsigned int> parseThreads(const std::string &list) {
+  std::vector<unsigned int> threads;
+  std::stringstream stream(list);
+  std::string item;
+  while (std::getline(stream, item, ',')) {
+    threads.push_back(static_cast<unsigned int>(std::stoul(item)));
+  }
+  return threads;
+}
+
+/// Powers of two up to the hardware thread count, at most 128.
+std::vector<unsigned int> defaultThreads() {
+  const unsigned int limit = std::min(128u, std::max(1u, std::thread::hardware_concurrency()));
+  std::vector<unsigned int> threads;
+  for (unsigned int n = 1; n <= limit; n *= 2) {
+    threads.push_back(n);
+  }
+  return threads;
+}
+
+int usage(const char *argv0) {
+  std::cerr << "Usage: " << argv0
+            << " [--entries N] [--jets MEAN] [--leptons MEAN] [--branches N]\n"
+            << "       [--input memory|disk] [--compression SETTING] [--threads 1,2,4,...]\n"
+            << "       [--workdir DIR] [--out FILE]\n";
+  return 2;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  Options options;
+  // Forwarded to the child processes, which only add --point and --result.
+  std::vector<std::string> forwarded{argv[0]};
+  try {
+    for (int i = 1; i < argc; ++i) {
+      const std::string arg = argv[i];
+      if (i + 1 >= argc || arg.rfind("--", 0) != 0) {
+        return usage(argv[0]);
+      }
+      const std::string value = argv[++i];
+      if (arg == "--entries") {
+        options.entries = std::stoull(value);
+      } else if (arg == "--jets") {
+        options.jets = std::stod(value);
+      } else if (arg == "--leptons") {
+        options.leptons = std::stod(value);
+      } else if (arg == "--branches") {
+        options.branches = std::stoull(value);
+      } else if (arg == "--input") {
+        options.input = value;
+      } else if (arg == "--compression") {
+        options.compression = std::stoi(value);
+      } else if (arg == "--threads") {
+        options.threads = parseThreads(value);
+      } else if (arg == "--workdir") {
+        options.workdir = value;
+      } else if (arg == "--out") {
+        options.out = value;
+      } else if (arg == "--point") {
+        options.point = static_cast<unsigned int>(std::stoul(value));
+      } else if (arg == "--result") {
+        options.result = value;
+      } else {
+        return usage(argv[0]);
+      }
+      if (arg != "--threads" && arg != "--out" && arg != "--workdir") {
+        forwarded.insert(forwarded.end(), {arg, value});
+      }
+    }
+  } catch (const std::exception &) {
+    return usage(argv[0]);
+  }
+  if (options.entries == 0 || (options.input != "memory" && options.input != "disk")) {
+    return usage(argv[0]);
+  }
+
+  try {
+    if (options.point > 0) {
+      return runPoint(options);
+    }
+
+    std::filesystem::create_directories(options.workdir);
+    options.workdir = std::filesystem::absolute(options.workdir).string();
+    forwarded.insert(forwarded.end(), {"--workdir", options.workdir});
+    if (options.out.empty()) {
+      options.out = (std::filesystem::path(options.workdir) / "e2e_throughput.json").string();
+    }
+    if (options.threads.empty()) {
+      options.threads = defaultThreads();
+    }
+    writeAnalysisInputs(options);
+    if (options.input == "disk") {
+      generateInput(options);
+    }
+
+    std::vector<Point> points;
+    std::cout << std::fixed << std::setprecision(2) << std::setw(8) << "threads"
+              << std::setw(12) << "startup[s]" << std::setw(10) << "run[s]" << std::setw(14)
+              << "events/s" << std::setw(10) << "speedup" << std::setw(10) << "cpu eff"
+              << std::setw(12) << "RSS[MB]" << std::endl;
+    for (const unsigned int threads : options.threads) {
+      points.push_back(measure(options, threads, forwarded));
+      const auto &p = points.back();
+      std::cout << std::setw(8) << p.threads << std::setw(12) << p.startupSeconds
+                << std::setw(10) << p.runSeconds << std::setw(14) << std::setprecision(0)
+                << p.eventsPerSecond << std::setprecision(2) << std::setw(10)
+                << p.eventsPerSecond / points.front().eventsPerSecond << std::setw(10)
+                << p.cpuEfficiency << std::setw(12) << p.peakRssMB << std::endl;
+    }
+    writeReport(options, points);
+    std::cout << "e2eThroughput: wrote " << options.out << std::endl;
+  } catch (const std::exception &e) {
+    std::cerr << "e2eThroughput: " << e.what() << std::endl;
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,68 @@
+/**
+ * @file AllocationTracker.h
+ * @brief Opt-in count of the heap allocations made by each thread, through
+ *        the replaced global operator new.
+ */
+#ifndef ALLOCATIONTRACKER_H_INCLUDED
+#define ALLOCATIONTRACKER_H_INCLUDED
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @class AllocationTracker
+ * @brief Thread-local allocation and byte counters fed by operator new.
+ *
+ * Built with ``-DPROFILE_ALLOCATIONS=ON`` (which defines
+ * @c HAS_ALLOCATION_TRACKING), core replaces the global operator new (every
+ * form) and delete; otherwise the allocation functions of the process are
+ * left alone and enable() reports that nothing is counted.  While the
+ * tracker is enabled each allocation adds one to the counters of the
+ * calling thread; nothing is shared between threads, so the count scales
+ * with the event loop.  Disabled, which is the default, an allocation costs
+ * one relaxed atomic load on top of malloc.
+ *
+ * The counters only grow.  Callers take threadCounts() before and after a
+ * piece of work on the same thread and attribute the difference: NodeProfiler
+ * does so for every instrumented Define, Redefine and Filter, and for every
+ * event loop task, when ``profileAllocations`` is set.
+ *
+ * The replacement is only in effect in executables that link core; when core
+ * is loaded as part of a shared module (the Python bindings) the operator
+ * new of the process may win, and enable() reports that nothing is counted.
+ */
+class AllocationTracker {
+public:
+  /// Allocations and requested bytes.
+  struct Counts {
+    std::uint64_t allocations = 0;
+    std::uint64_t bytes = 0;
+
+    Counts operator-(const Counts &other) const {
+      return Counts{allocations - other.allocations, bytes - other.bytes};
+    }
+    Counts &operator+=(const Counts &other) {
+      allocations += other.allocations;
+      bytes += other.bytes;
+      return *this;
+    }
+  };
+
+  /**
+   * @brief Start counting.
+   * @return false when the replaced operator new is not the one in effect,
+   *         so that no allocation will be counted.
+   */
+  static bool enable();
+  /// Stop counting; the counters keep their values.
+  static void disable();
+  static bool enabled();
+
+  /// Counters of the calling thread.
+  static Counts threadCounts() noexcept;
+
+  /// Count an allocation of @p bytes on the calling thread (operator new).
+  static void record(std::size_t bytes) noexcept;
+};
+
+#endif // ALLOCATIONTRACKER_H_INCLUDED
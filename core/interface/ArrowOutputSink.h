@@ -0,0 +1,109 @@
+#ifndef ARROWOUTPUTSINK_H_INCLUDED
+#define ARROWOUTPUTSINK_H_INCLUDED
+
+#include "RootOutputSink.h"
+#include "TrainingShuffler.h"
+
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Arrow output settings of ArrowOutputSink.
+ */
+struct ArrowSettings {
+  enum class Format { Parquet, Ipc };
+
+  Format format = Format::Parquet;
+  /// Rows per Parquet row group / Arrow IPC record batch.
+  std::size_t rowGroupSize = 65536;
+  /// Dictionary-encode Parquet column pages.
+  bool dictionary = true;
+  /// Compression codec: zstd, lz4, snappy, gzip or none (IPC: zstd, lz4, none).
+  std::string compression = "zstd";
+  /// Training output: shuffled, optionally class-balanced rows (Parquet only).
+  std::optional<TrainingSettings> training;
+};
+
+/**
+ * @brief Output sink writing skims as Parquet or Arrow IPC files.
+ *
+ * Column selection (saveConfig globs, systematic expansion) and output file
+ * naming are inherited from RootOutputSink.  The output is a dataset
+ * directory named after the output file with a ``.parquet`` or ``.arrow``
+ * extension, holding one ``part-<slot>`` file per processing slot: each
+ * slot writes its own file from the buffers ColumnChunker fills, so slots
+ * never wait for each other.  Numeric scalar columns map to Arrow primitive
+ * arrays, RVec columns to ``large_list`` arrays; other columns are skipped
+ * with a warning.
+ *
+ * With ArrowSettings::training (``skimOutputFormat=training``) the output
+ * is a Parquet dataset for ML training: the saveConfig features plus the
+ * label and weight columns, down-sampled per class and shuffled per slot
+ * by a TrainingShuffler before they are written, so training can stream
+ * the row groups without a separate shuffle job.  RVec columns are skipped.
+ *
+ * Selected with ``skimOutputFormat=parquet``, ``arrow`` or ``training`` (see
+ * ManagerFactory::createOutputSink()).  Writing requires a build with
+ * ``-DUSE_ARROW=ON``; otherwise it throws std::runtime_error.
+ */
+class ArrowOutputSink : public RootOutputSink {
+public:
+  explicit ArrowOutputSink(ArrowSettings settings = {});
+  ~ArrowOutputSink() override;
+
+  /**
+   * @brief Build a sink of @p format ("parquet", "arrow" or "training")
+   *        from the ``arrowRowGroupSize``, ``arrowDictionary`` and
+   *        ``arrowCompression`` config keys, and for "training" the
+   *        ``training*`` keys (see TrainingSettings::fromConfig()).
+   * @throws std::runtime_error for invalid values
+   */
+  static std::unique_ptr<ArrowOutputSink>
+  fromConfig(const IConfigurationProvider& configProvider, const std::string& format);
+
+  /// Dataset directory written for @p outputFile.
+  static std::string datasetPath(const std::string& outputFile, ArrowSettings::Format format);
+
+  const ArrowSettings& arrowSettings() const { return arrowSettings_m; }
+
+  void writeDataFrame(ROOT::RDF::RNode& df, const OutputSpec& spec) override;
+  void writeDataFrame(ROOT::RDF::RNode& df,
+                      const IConfigurationProvider& configProvider,
+                      const IDataFrameProvider* dataFrameProvider,
+                      const ISystematicManager* systematicManager,
+                      OutputChannel channel) override;
+  void bookDataFrame(ROOT::RDF::RNode& df,
+                     const IConfigurationProvider& configProvider,
+                     const IDataFrameProvider* dataFrameProvider,
+                     const ISystematicManager* systematicManager,
+                     OutputChannel channel) override;
+  void bookDataFrame(ROOT::RDF::RNode& df, const OutputSpec& spec) override;
+  void flush() override;
+  bool bookedColumns(std::vector<std::string>& columns) const override;
+
+private:
+  /// Per-slot file writers of one booked output.
+  struct Writers;
+
+  /// A booked output: the chunker that feeds it and its writers.
+  struct PendingWrite {
+    std::string directory;
+    std::unique_ptr<ColumnChunker> chunker;
+    std::shared_ptr<Writers> writers;
+    /// Shuffles the rows on their way to the writers (training output).
+    std::shared_ptr<TrainingShuffler> shuffler;
+    /// Columns of the output spec (empty: every column).
+    std::vector<std::string> columns;
+  };
+
+  PendingWrite book(ROOT::RDF::RNode& df, const OutputSpec& spec);
+  void complete(PendingWrite& pending);
+
+  ArrowSettings arrowSettings_m;
+  std::vector<PendingWrite> pendingWrites_m;
+};
+
+#endif // ARROWOUTPUTSINK_H_INCLUDED
@@ -0,0 +1,209 @@
+/**
+ * @file AsyncLogger.h
+ * @brief Logger whose callers only enqueue messages; a background thread
+ *        writes them.
+ */
+#ifndef ASYNCLOGGER_H_INCLUDED
+#define ASYNCLOGGER_H_INCLUDED
+
+#include "api/ILogger.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/**
+ * Messages below this level (0 = Trace ... 4 = Error) are removed at compile
+ * time by the RDF_LOG_* macros, including the formatting of their arguments.
+ * Set with the RDF_LOG_MIN_LEVEL CMake cache variable.
+ */
+#ifndef RDF_LOG_MIN_LEVEL
+#define RDF_LOG_MIN_LEVEL 0
+#endif
+
+/**
+ * @class AsyncLogger
+ * @brief ILogger backed by a lock-free bounded multi-producer ring buffer
+ *        and one writer thread.
+ *
+ * log() formats nothing and takes no lock: it claims a slot of the ring
+ * with one compare-and-swap and moves the message in, so threads logging
+ * from plugin code do not serialize on the output stream, and slow
+ * terminals or network filesystems only delay the writer.  The writer
+ * drains the ring in batches and writes each batch with one call.
+ *
+ *  - A full ring drops the message rather than block the caller; Warn and
+ *    Error messages are never dropped: they wait for a free slot.
+ *  - An Error message is written before log() returns, so it survives a
+ *    crash that follows it.
+ *  - With a rate limit, Trace to Info messages beyond the limit are
+ *    dropped.  Dropped messages are counted and reported by the writer.
+ *  - The writer sleeps on a condition variable while the ring is empty;
+ *    producers only take its mutex when it is asleep.
+ *  - After stop(), messages are written by the thread logging them.
+ *
+ * The process-wide instance() serves the RDF_LOG_* macros and, through
+ * ProcessLogger, the Analyzer's default logger, so all messages share one
+ * ordered stream.
+ */
+class AsyncLogger : public ILogger {
+public:
+  /// Receives the messages of one batch, in order.
+  using Sink = std::function<void(Level level, const std::string &message)>;
+
+  /// The logger of the process, writing Trace..Info to stdout and Warn and
+  /// Error to stderr.
+  static AsyncLogger &instance();
+
+  /**
+   * @param capacity Ring slots, rounded up to a power of two.
+   * @param sink Destination of the messages (default: stdout / stderr).
+   */
+  explicit AsyncLogger(std::size_t capacity = 8192, Sink sink = {});
+
+  /// Writes the remaining messages and stops the writer.
+  ~AsyncLogger() override;
+
+  /// Writes the remaining messages and stops the writer; later messages
+  /// are written by the thread logging them.
+  void stop();
+
+  AsyncLogger(const AsyncLogger &) = delete;
+  AsyncLogger &operator=(const AsyncLogger &) = delete;
+
+  void log(Level level, const std::string &message) override;
+  void log(Level level, std::string &&message);
+
+  /// Block until every message logged before the call is written.
+  void flush();
+
+  /// Messages below @p level are discarded.
+  void setLevel(Level level) { minLevel_m.store(static_cast<int>(level)); }
+  Level level() const { return static_cast<Level>(minLevel_m.load(std::memory_order_relaxed)); }
+  bool enabled(Level level) const {
+    return static_cast<int>(level) >= minLevel_m.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Accept on average @p perSecond Trace..Info messages per second,
+   *        with bursts of @p burst messages (0 disables the limit).
+   */
+  void setRateLimit(double perSecond, double burst = 100);
+
+  /// Messages dropped by the rate limit or a full ring.
+  std::uint64_t dropped() const { return dropped_m.load(); }
+
+  /**
+   * @brief Parse "trace", "debug", "info", "warn" or "error".
+   * @throws std::invalid_argument for any other value
+   */
+  static Level parseLevel(const std::string &name);
+
+private:
+  struct Cell {
+    std::atomic<std::size_t> sequence{0};
+    Level level = Level::Info;
+    std::string message;
+  };
+
+  bool tryPush(Level level, std::string &message);
+  bool tryPop(Level &level, std::string &message);
+  bool messageReady() const;
+  bool allowedByRateLimit();
+  /// Writes up to one batch of messages, or the drop report when the ring
+  /// is empty.  Returns the number of messages written.  Called by one
+  /// consumer at a time: the writer, or a flush() after stop().
+  std::size_t writeBatch();
+  void writerLoop();
+  void wakeWriter();
+
+  std::unique_ptr<Cell[]> cells_m;
+  std::size_t mask_m;
+  alignas(64) std::atomic<std::size_t> enqueuePos_m{0};
+  /// Only touched by the consumer.
+  alignas(64) std::size_t dequeuePos_m = 0;
+  alignas(64) std::atomic<std::size_t> written_m{0};
+
+  std::atomic<int> minLevel_m{static_cast<int>(Level::Info)};
+  /// Rate limit (GCRA): theoretical arrival time and spacing, in ns.
+  std::atomic<std::int64_t> rateTat_m{0};
+  std::atomic<std::int64_t> rateInterval_m{0};
+  std::atomic<std::int64_t> rateTolerance_m{0};
+  std::atomic<std::uint64_t> dropped_m{0};
+  std::uint64_t droppedReported_m = 0;
+  std::vector<std::pair<Level, std::string>> batch_m;
+
+  Sink sink_m;
+  std::mutex wakeMutex_m;
+  std::condition_variable wakeCv_m;
+  std::condition_variable writtenCv_m;
+  std::atomic<bool> writerSleeping_m{false};
+  std::atomic<bool> stop_m{false};
+  /// Set by the writer, under wakeMutex_m, when it has exited.
+  std::atomic<bool> writerDone_m{false};
+  std::thread writer_m;
+};
+
+/**
+ * @brief ILogger forwarding to AsyncLogger::instance(), for owners of a
+ *        std::unique_ptr<ILogger>.
+ */
+class ProcessLogger : public ILogger {
+public:
+  void log(Level level, const std::string &message) override {
+    AsyncLogger::instance().log(level, message);
+  }
+};
+
+/**
+ * @brief One message built with operator<<, logged when it goes out of
+ *        scope.  Nothing is formatted below the logger's level.
+ */
+class LogLine {
+public:
+  explicit LogLine(ILogger::Level level, AsyncLogger &logger = AsyncLogger::instance())
+      : level_m(level), logger_m(logger), enabled_m(logger.enabled(level)) {}
+  ~LogLine() {
+    if (enabled_m) {
+      logger_m.log(level_m, stream_m.str());
+    }
+  }
+  LogLine(const LogLine &) = delete;
+  LogLine &operator=(const LogLine &) = delete;
+
+  template <typename T> LogLine &operator<<(const T &value) {
+    if (enabled_m) {
+      stream_m << value;
+    }
+    return *this;
+  }
+
+private:
+  ILogger::Level level_m;
+  AsyncLogger &logger_m;
+  bool enabled_m;
+  std::ostringstream stream_m;
+};
+
+#define RDF_LOG_AT(LEVEL, LEVEL_VALUE)                                          \
+  if constexpr ((LEVEL_VALUE) < RDF_LOG_MIN_LEVEL) {                            \
+  } else                                                                        \
+    LogLine(LEVEL)
+
+/// Usage: RDF_LOG_INFO << "read " << n << " files";
+#define RDF_LOG_TRACE RDF_LOG_AT(ILogger::Level::Trace, 0)
+#define RDF_LOG_DEBUG RDF_LOG_AT(ILogger::Level::Debug, 1)
+#define RDF_LOG_INFO RDF_LOG_AT(ILogger::Level::Info, 2)
+#define RDF_LOG_WARN RDF_LOG_AT(ILogger::Level::Warn, 3)
+#define RDF_LOG_ERROR RDF_LOG_AT(ILogger::Level::Error, 4)
+
+#endif // ASYNCLOGGER_H_INCLUDED
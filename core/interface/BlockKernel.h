@@ -0,0 +1,71 @@
+/**
+ * @file BlockKernel.h
+ * @brief Columns computed by columnar kernels that process a block of
+ *        events per call.
+ *
+ * RDataFrame evaluates a Define once per event, so a kernel written for
+ * contiguous arrays (e.g. a numba cfunc from Python) cannot be called from
+ * the event loop directly.  BlockKernel runs a first event loop over the
+ * kernel's input columns with ColumnChunker, calls the kernel once per
+ * block of rows, and defines the column as a lookup of the results by
+ * ``rdfentry_`` for the event loops that follow.
+ *
+ * The results are indexed by ``rdfentry_``, which is the same in every
+ * event loop of the dataframe for TTree/TChain inputs and in-memory
+ * dataframes; they take 8 bytes per entry up to the last one evaluated.
+ */
+#ifndef BLOCKKERNEL_H_INCLUDED
+#define BLOCKKERNEL_H_INCLUDED
+
+#include <ROOT/RDataFrame.hxx>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * @class BlockKernel
+ * @brief Defines columns from kernels over blocks of events.
+ */
+class BlockKernel {
+public:
+  /**
+   * @brief Kernel over a block of @p n events.
+   *
+   * @p inputs holds one array per input column, converted to double: @p n
+   * values for a scalar column, or the flattened values of an RVec column.
+   * @p offsets holds, per column, nullptr for scalars or the @p n + 1
+   * offsets of an RVec column (event ``i`` holds values
+   * ``[offsets[i], offsets[i + 1])``).  The kernel writes @p n values to
+   * @p output.
+   */
+  using Function = void (*)(std::int64_t n, const double *const *inputs,
+                            const std::int64_t *const *offsets, double *output);
+
+  /**
+   * @brief Evaluate @p kernel on @p columns of @p df in blocks of
+   *        @p blockSize events and define @p name from the results.
+   *
+   * @param outputType C++ type of the column: "double", "float", "int" or
+   *                   "bool".
+   * @throws std::runtime_error for an unsupported @p outputType or input
+   *         column (see ColumnChunker).
+   */
+  static ROOT::RDF::RNode define(ROOT::RDF::RNode df, const std::string &name, Function kernel,
+                                 const std::vector<std::string> &columns,
+                                 std::size_t blockSize = 4096,
+                                 const std::string &outputType = "double");
+
+  /**
+   * @brief Run the event loop over @p columns and return the kernel
+   *        results by ``rdfentry_``; entries that were not evaluated hold
+   *        NaN.
+   */
+  static std::shared_ptr<const std::vector<double>>
+  evaluate(ROOT::RDF::RNode df, Function kernel, const std::vector<std::string> &columns,
+           std::size_t blockSize);
+};
+
+#endif // BLOCKKERNEL_H_INCLUDED
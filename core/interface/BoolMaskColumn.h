@@ -0,0 +1,80 @@
+/**
+ * @file BoolMaskColumn.h
+ * @brief Pack boolean columns into one 64-bit mask column.
+ *
+ * Selection bookkeeping (cutflows, region membership) needs the decisions of
+ * many boolean columns per event.  Reading them through one typed Define
+ * that packs them into a mask word costs a single node, whereas a Filter per
+ * decision adds one graph node and one branch per column.
+ */
+#ifndef BOOLMASKCOLUMN_H_INCLUDED
+#define BOOLMASKCOLUMN_H_INCLUDED
+
+#include <ROOT/RDataFrame.hxx>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace BoolMask {
+
+/// Largest number of boolean columns packed into one mask word.
+constexpr std::size_t kMaxColumns = 64;
+
+template <std::size_t>
+using Bit = bool;
+
+/// Typed kernel packing N boolean decisions into one word (bit i = column i).
+template <std::size_t... I>
+auto makeKernel(std::index_sequence<I...>) {
+  return [](Bit<I>... pass) -> std::uint64_t {
+    return (std::uint64_t{0} | ... | (static_cast<std::uint64_t>(pass) << I));
+  };
+}
+
+using Definer = ROOT::RDF::RNode (*)(ROOT::RDF::RNode, const std::string &,
+                                     const std::vector<std::string> &);
+
+template <std::size_t N>
+ROOT::RDF::RNode defineWord(ROOT::RDF::RNode node, const std::string &name,
+                            const std::vector<std::string> &columns) {
+  return node.Define(name, makeKernel(std::make_index_sequence<N>{}), columns);
+}
+
+template <std::size_t... N>
+constexpr std::array<Definer, sizeof...(N)>
+makeDefiners(std::index_sequence<N...>) {
+  return {&defineWord<N + 1>...};
+}
+
+/// definers[n - 1] defines a mask word from exactly n boolean columns.
+inline constexpr auto definers =
+    makeDefiners(std::make_index_sequence<kMaxColumns>{});
+
+} // namespace BoolMask
+
+/**
+ * @brief Define @p name on @p node as the std::uint64_t mask of @p columns.
+ *
+ * Bit i is set when columns[i] is true.  Every column must be a bool column.
+ *
+ * @throws std::runtime_error if @p columns is empty or holds more than
+ *         BoolMask::kMaxColumns columns.
+ */
+inline ROOT::RDF::RNode defineBoolMask(ROOT::RDF::RNode node,
+                                       const std::string &name,
+                                       const std::vector<std::string> &columns) {
+  if (columns.empty() || columns.size() > BoolMask::kMaxColumns) {
+    throw std::runtime_error("defineBoolMask(): '" + name + "' needs 1 to " +
+                             std::to_string(BoolMask::kMaxColumns) +
+                             " columns, got " +
+                             std::to_string(columns.size()) + ".");
+  }
+  return BoolMask::definers[columns.size() - 1](node, name, columns);
+}
+
+#endif // BOOLMASKCOLUMN_H_INCLUDED
@@ -0,0 +1,181 @@
+#ifndef CHECKPOINTSERVICE_H_INCLUDED
+#define CHECKPOINTSERVICE_H_INCLUDED
+
+#include "EntryRangeSet.h"
+#include "api/IAnalysisService.h"
+#include <ROOT/RDataFrame.hxx>
+#include <ROOT/RResultPtr.hxx>
+#include <RtypesCore.h>
+#include <THnSparse.h>
+#include <TObject.h>
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief Analysis service writing periodic checkpoints of booked results.
+ *
+ * Enabled by the ``checkpointFile`` config key.  Every ``checkpointEvery``
+ * entries of a processing slot (default 100000), each watched result hands
+ * its slot accumulator to the service, which keeps the latest copy per slot
+ * together with the entries that slot has processed.  A writer thread merges
+ * the slot copies off the event loop and replaces the checkpoint file at most
+ * every ``checkpointInterval`` seconds (default 300).
+ *
+ * When the checkpoint file already exists at initialize(), its results are
+ * restored: DataManager skips the entries it records, and the participating
+ * plugins (see ICheckpointParticipant) add the restored results to their
+ * own, so a resubmitted job resumes where the preempted one stopped.  The
+ * file is removed once the service is finalized after a complete run.
+ *
+ * Entries are identified by ``rdfentry_``, which is stable between runs of
+ * the same configuration on the same input.
+ */
+class CheckpointService : public IAnalysisService {
+public:
+  /// Key of the processed-entries record in the checkpoint file.
+  static constexpr const char *kEntriesKey = "checkpoint_processedEntries";
+
+  CheckpointService() = default;
+  CheckpointService(const CheckpointService &) = delete;
+  CheckpointService &operator=(const CheckpointService &) = delete;
+  ~CheckpointService() override;
+
+  void initialize(ManagerContext &ctx) override;
+  void finalize(ROOT::RDF::RNode &df) override;
+
+  /**
+   * @brief Snapshot @p result under @p key in every checkpoint.
+   *
+   * @p encode converts the slot accumulator of the result (the value passed
+   * to RResultPtr::OnPartialResultSlot) into a mergeable payload, a THnBase
+   * or a TVectorD.  The result's action must implement PartialUpdate().
+   * Must be called before arm().
+   *
+   * @throws std::runtime_error if @p key is already watched.
+   */
+  template <typename T, typename Encode>
+  void watch(const std::string &key, ROOT::RDF::RResultPtr<T> &result,
+             Encode encode) {
+    if (std::find(watched_m.begin(), watched_m.end(), key) != watched_m.end()) {
+      throw std::runtime_error("CheckpointService: result '" + key +
+                               "' is already watched");
+    }
+    result.OnPartialResultSlot(
+        every_m, [this, key, encode](unsigned int slot, T &partial) {
+          stage(slot, key, encode(partial));
+        });
+    watched_m.push_back(key);
+  }
+
+  /// Snapshot a histogram result (a copy of the slot histogram).
+  void watch(const std::string &key, ROOT::RDF::RResultPtr<THnSparseF> &result);
+
+  /**
+   * @brief Start recording processed entries and writing checkpoints.
+   *
+   * Called by Analyzer::run() after every participant registered its
+   * results, so that a slot's entries are recorded after its results have
+   * been staged for the same entry.
+   *
+   * @throws std::runtime_error if the restored checkpoint holds a result
+   *         that no participant watches.
+   */
+  void arm();
+
+  /// True when a checkpoint was restored at initialize().
+  bool resuming() const { return resuming_m; }
+
+  /// Entries processed by the run that wrote the restored checkpoint.
+  const EntryRangeSet &resumedEntries() const { return resumedEntries_m; }
+
+  /// Restored payload of @p key, or nullptr.
+  const TObject *restored(const std::string &key) const;
+
+  /**
+   * @brief Merge the latest slot snapshots with the restored results and
+   *        replace the checkpoint file.
+   *
+   * The writer thread calls this every ``checkpointInterval`` seconds.  The
+   * file is written next to the checkpoint and renamed over it, so a job
+   * killed while writing keeps the previous checkpoint.
+   */
+  void writeCheckpoint();
+
+  /**
+   * @brief Add payload @p from to @p into.
+   * @throws std::runtime_error if the payloads are not of the same mergeable
+   *         kind (THnBase or TVectorD of equal size).
+   */
+  static void mergePayload(TObject &into, const TObject &from);
+
+  /**
+   * @brief Processed entries recorded in the checkpoint at @p path.
+   * @return An empty set when the file does not exist.
+   * @throws std::runtime_error if the file exists but is not a checkpoint.
+   */
+  static EntryRangeSet readProcessedEntries(const std::string &path);
+
+  /**
+   * @brief Contribute structured provenance metadata for this service.
+   *
+   * Returns:
+   *  - "service.checkpoint.file"            : checkpoint file path
+   *  - "service.checkpoint.every"           : entries per slot between snapshots
+   *  - "service.checkpoint.resumed_entries" : entries skipped on resume
+   */
+  std::unordered_map<std::string, std::string>
+  collectProvenanceEntries() const override;
+
+private:
+  using Payloads = std::map<std::string, std::shared_ptr<const TObject>>;
+
+  /// Latest snapshots of one processing slot.
+  struct SlotState {
+    std::mutex mutex;
+    /// Payloads staged for the checkpoint round in progress (slot thread only).
+    Payloads staged;
+    /// Payloads and entries of the last complete round.
+    Payloads committed;
+    EntryRangeSet entries;
+  };
+
+  void stage(unsigned int slot, const std::string &key,
+             std::unique_ptr<TObject> payload);
+  void commit(unsigned int slot, const EntryRangeSet &entries);
+  void writerLoop();
+  void stopWriter();
+
+  ManagerContext *ctx_m = nullptr;
+  std::string path_m;
+  ULong64_t every_m = 100000;
+  std::chrono::seconds interval_m{300};
+  std::optional<ROOT::RDF::RNode> preFilterDf_m;
+  ROOT::RDF::RResultPtr<EntryRangeSet> entriesResult_m;
+
+  bool resuming_m = false;
+  EntryRangeSet resumedEntries_m;
+  std::map<std::string, std::unique_ptr<TObject>> restored_m;
+  std::vector<std::string> watched_m;
+
+  std::vector<std::unique_ptr<SlotState>> slots_m;
+  std::thread writer_m;
+  std::mutex writerMutex_m;
+  /// Serializes writeCheckpoint() calls.
+  std::mutex writeMutex_m;
+  std::condition_variable writerWake_m;
+  bool dirty_m = false;
+  bool stop_m = false;
+  bool armed_m = false;
+};
+
+#endif // CHECKPOINTSERVICE_H_INCLUDED
@@ -0,0 +1,185 @@
+/**
+ * @file ColumnChunker.h
+ * @brief Streams numeric columns of a dataframe out of the event loop in
+ *        contiguous, typed chunks.
+ *
+ * Each processing slot appends the values of the selected columns to its
+ * own buffers; when a slot has collected the requested number of rows the
+ * buffers are handed to a callback as one Chunk and replaced by new ones.
+ * The buffers are moved, never copied, so a consumer such as the Python
+ * bindings can expose them as NumPy arrays without touching the values
+ * again.  No object is created per event.
+ *
+ * RVec columns are delivered flattened: the values of all rows of the
+ * chunk, and ``rows + 1`` offsets such that row ``i`` holds the values
+ * ``[offsets[i], offsets[i + 1])``.
+ */
+#ifndef COLUMNCHUNKER_H_INCLUDED
+#define COLUMNCHUNKER_H_INCLUDED
+
+#include <ROOT/RDF/RActionImpl.hxx>
+#include <ROOT/RDataFrame.hxx>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <variant>
+#include <vector>
+
+/**
+ * @class ColumnChunker
+ * @brief Event-loop action that collects numeric columns into typed chunks.
+ *
+ * Rows of a chunk come from one slot and are in entry order within it;
+ * with several threads, chunks of different slots interleave.  The callback
+ * is called from the slot threads, by default one call at a time, and the
+ * final partial chunks are delivered on the thread that called run().
+ */
+class ColumnChunker {
+public:
+  /// Values of one column, stored with the width of its NumPy dtype.
+  using Data = std::variant<std::vector<float>, std::vector<double>, std::vector<std::int8_t>,
+                            std::vector<std::uint8_t>, std::vector<std::int16_t>,
+                            std::vector<std::uint16_t>, std::vector<std::int32_t>,
+                            std::vector<std::uint32_t>, std::vector<std::int64_t>,
+                            std::vector<std::uint64_t>>;
+
+  /// Rows of the selected columns collected by one slot.
+  struct Chunk {
+    std::vector<std::string> columns;
+    /// NumPy dtype name of each column ("float32", "int64", "bool", ...).
+    std::vector<std::string> dtypes;
+    std::vector<Data> data;
+    /// Offsets of RVec columns into @c data; empty for scalar columns.
+    std::vector<std::vector<std::int64_t>> offsets;
+    std::size_t rows = 0;
+    /// Processing slot that collected the chunk.
+    unsigned int slot = 0;
+  };
+
+  using Callback = std::function<void(Chunk &&)>;
+
+  /**
+   * @param columns   Scalar or RVec columns to collect (see dtypeOf()).
+   * @param chunkRows Rows per chunk (at least 1).
+   * @param callback  Receives each chunk.
+   * @param serialize Call @p callback one chunk at a time; otherwise slots
+   *                  call it concurrently (never twice for the same slot).
+   * @throws std::runtime_error if a column does not exist or is not of a
+   *         supported numeric type.
+   */
+  ColumnChunker(ROOT::RDF::RNode df, std::vector<std::string> columns, std::size_t chunkRows,
+                Callback callback, bool serialize = true);
+
+  /**
+   * @brief Run the event loop and deliver every row.
+   * @return Number of rows delivered.
+   */
+  std::size_t run();
+
+  /**
+   * @brief NumPy dtype name under which a column of C++ type @p type (or
+   *        the elements of an RVec type) is delivered; empty when the type
+   *        is not supported.
+   */
+  static std::string dtypeOf(const std::string &type);
+
+  /// Whether columns of C++ type @p type are delivered with offsets.
+  static bool isVector(const std::string &type);
+
+  /// Shared state of the per-column actions.
+  struct State;
+
+private:
+  ROOT::RDF::RNode df_m;
+  std::shared_ptr<State> state_m;
+  ROOT::RDF::RResultPtr<ULong64_t> done_m;
+};
+
+struct ColumnChunker::State {
+  State(std::vector<std::string> columns, std::vector<std::string> dtypes,
+        std::vector<bool> vectors, std::size_t chunkRows, unsigned int nSlots, Callback callback,
+        bool serialize);
+
+  /// Append @p value to column @p column of @p slot.
+  template <typename Stored, typename T> void append(unsigned int slot, std::size_t column, const T &value) {
+    std::get<std::vector<Stored>>(slots[slot].data[column]).push_back(static_cast<Stored>(value));
+  }
+
+  /// Append the elements of @p values to RVec column @p column of @p slot.
+  template <typename Stored, typename T>
+  void append(unsigned int slot, std::size_t column, const ROOT::VecOps::RVec<T> &values) {
+    auto &stored = std::get<std::vector<Stored>>(slots[slot].data[column]);
+    stored.insert(stored.end(), values.begin(), values.end());
+    slots[slot].offsets[column].push_back(static_cast<std::int64_t>(stored.size()));
+  }
+
+  /// A full row of @p slot was appended; emits the chunk when complete.
+  void rowDone(unsigned int slot);
+
+  /// Deliver the buffers of @p slot (if any rows) and start new ones.
+  void emit(unsigned int slot);
+
+  struct alignas(64) Slot {
+    std::vector<Data> data;
+    std::vector<std::vector<std::int64_t>> offsets;
+    std::size_t rows = 0;
+  };
+
+  std::vector<std::string> columns;
+  std::vector<std::string> dtypes;
+  std::vector<bool> vectors;
+  std::size_t chunkRows;
+  std::vector<Slot> slots;
+  Callback callback;
+  bool serialize;
+  std::mutex callbackMutex;
+  std::atomic<std::size_t> delivered{0};
+
+private:
+  void reset(Slot &slot);
+};
+
+namespace ColumnChunkerDetail {
+
+/**
+ * @brief Appends one column to the slot buffers; the action of the last
+ *        column completes the row.
+ */
+template <typename T, typename Stored>
+class ColumnAction : public ROOT::Detail::RDF::RActionImpl<ColumnAction<T, Stored>> {
+public:
+  using Result_t = ULong64_t;
+
+  ColumnAction(std::shared_ptr<ColumnChunker::State> state, std::size_t column, bool last)
+      : state_m(std::move(state)), column_m(column), last_m(last),
+        result_m(std::make_shared<ULong64_t>(0)) {}
+  ColumnAction(ColumnAction &&) = default;
+  ColumnAction(const ColumnAction &) = delete;
+
+  std::shared_ptr<ULong64_t> GetResultPtr() const { return result_m; }
+  void Initialize() {}
+  void InitTask(TTreeReader *, unsigned int) {}
+  void Exec(unsigned int slot, const T &value) {
+    state_m->template append<Stored>(slot, column_m, value);
+    if (last_m) {
+      state_m->rowDone(slot);
+    }
+  }
+  void Finalize() { *result_m = state_m->delivered; }
+  std::string GetActionName() const { return "ColumnChunker"; }
+
+private:
+  std::shared_ptr<ColumnChunker::State> state_m;
+  std::size_t column_m;
+  bool last_m;
+  std::shared_ptr<ULong64_t> result_m;
+};
+
+} // namespace ColumnChunkerDetail
+
+#endif // COLUMNCHUNKER_H_INCLUDED
@@ -5,6 +5,7 @@
 
 #include <cstddef>
 #include <string>
+#include <tuple>
 #include <type_traits>
 #include <utility>
 
@@ -12,6 +13,10 @@ namespace rdfanalysis::column {
 
 template <typename SourceT, typename ProjectionT>
 struct ProjectionSpec {
+  using source_type = SourceT;
+  using result_type =
+      std::decay_t<std::invoke_result_t<const ProjectionT &, const SourceT &>>;
+
   std::string name;
   ProjectionT projection;
 };
@@ -58,8 +63,31 @@ void defineProjectedColumn(Analyzer &analyzer, const std::string &sourceColumn,
       {sourceColumn});
 }
 
+template <typename SourceT, typename Tuple, typename... Specs, std::size_t... I>
+void defineFusedProjection(Analyzer &analyzer, const std::string &sourceColumn,
+                           const std::string &packedColumn,
+                           std::index_sequence<I...>, Specs &&...specs) {
+  std::string names[] = {specs.name...};
+  analyzer.Define(
+      packedColumn,
+      [projections = std::make_tuple(std::forward<Specs>(specs).projection...)](
+          const SourceT &source) {
+        return Tuple{std::get<I>(projections)(source)...};
+      },
+      {sourceColumn});
+  (analyzer.Define(
+       std::move(names[I]),
+       [](const Tuple &packed) { return std::get<I>(packed); }, {packedColumn}),
+   ...);
+}
+
 } // namespace detail
 
+/// Packed column type of defineFusedProjection() for @p Specs: one tuple
+/// element per projection, in order.
+template <typename... Specs>
+using FusedProjection = std::tuple<typename std::decay_t<Specs>::result_type...>;
+
 template <typename SourceT, typename... Specs>
 Analyzer *defineProjectedColumns(Analyzer &analyzer,
                                  const std::string &sourceColumn,
@@ -70,6 +98,30 @@ Analyzer *defineProjectedColumns(Analyzer &analyzer,
   return &analyzer;
 }
 
+/**
+ * @brief Evaluate all projections of @p sourceColumn in one pass.
+ *
+ * Defines @p packedColumn as a FusedProjection<Specs...> tuple filled from
+ * one read of the source, then each projection's column as an accessor of
+ * its tuple element.  Unlike defineProjectedColumns(), the source is read
+ * and dispatched once per event however many members are projected;
+ * code that needs several outputs can read @p packedColumn directly with
+ * std::get.
+ */
+template <typename SourceT, typename... Specs>
+Analyzer *defineFusedProjection(Analyzer &analyzer,
+                                const std::string &sourceColumn,
+                                const std::string &packedColumn,
+                                Specs &&...specs) {
+  static_assert(sizeof...(Specs) > 0, "defineFusedProjection needs a projection");
+  static_assert((std::is_same_v<typename std::decay_t<Specs>::source_type, SourceT> && ...),
+                "projections must read SourceT");
+  detail::defineFusedProjection<SourceT, FusedProjection<Specs...>>(
+      analyzer, sourceColumn, packedColumn,
+      std::index_sequence_for<Specs...>{}, std::forward<Specs>(specs)...);
+  return &analyzer;
+}
+
 } // namespace rdfanalysis::column
 
 #endif // COLUMNPROJECTION_H_INCLUDED
\ No newline at end of file
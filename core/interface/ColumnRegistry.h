@@ -0,0 +1,55 @@
+/**
+ * @file ColumnRegistry.h
+ * @brief Hash index of the columns of an RDataFrame node.
+ *
+ * RInterface::GetColumnNames() walks the whole graph and copies every column
+ * name, so checking a column against it before each Define makes graph
+ * construction quadratic in the number of columns.  The registry reads the
+ * names once and is then kept up to date by the provider as columns are
+ * defined, which makes the check O(1).
+ */
+#ifndef COLUMNREGISTRY_H_INCLUDED
+#define COLUMNREGISTRY_H_INCLUDED
+
+#include <ROOT/RDataFrame.hxx>
+
+#include <string>
+#include <unordered_map>
+
+/**
+ * @class ColumnRegistry
+ * @brief Lazily synchronised set of column names with their cached types.
+ *
+ * The registry syncs from the node passed to has() or type() the first time
+ * it is queried after invalidate().  Between syncs the owner reports every
+ * column it defines through add(); any other change of the node (a node set
+ * from outside, bulk definitions) must call invalidate().
+ */
+class ColumnRegistry {
+public:
+  /// True if @p node has column @p name.
+  bool has(const std::string &name, ROOT::RDF::RNode &node);
+
+  /// Type name of column @p name of @p node, cached after the first call.
+  std::string type(const std::string &name, ROOT::RDF::RNode &node);
+
+  /// Record a column defined (or redefined) on the node; its type is
+  /// resolved again on the next type() call.
+  void add(const std::string &name);
+
+  /// Forget all columns; the next query syncs from the node.
+  void invalidate();
+
+  /// Number of syncs from GetColumnNames() so far.
+  std::size_t syncs() const { return syncs_m; }
+
+private:
+  void sync(ROOT::RDF::RNode &node);
+
+  /// Column name -> type name (empty until type() resolved it).
+  std::unordered_map<std::string, std::string> types_m;
+  bool synced_m = false;
+  std::size_t syncs_m = 0;
+};
+
+#endif // COLUMNREGISTRY_H_INCLUDED
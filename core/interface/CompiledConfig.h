@@ -0,0 +1,66 @@
+#ifndef COMPILEDCONFIG_H_INCLUDED
+#define COMPILEDCONFIG_H_INCLUDED
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief Fully resolved configuration of a job in one binary file
+ *        (``.rdfcfg``).
+ *
+ * Written by ConfigurationManager::compile() (the ``rdfconfig`` tool, or
+ * ``validate_config.py --compile`` at submission time): the top-level
+ * key/value map and the parsed contents of every sub-config it references,
+ * directly or through other sub-configs (histogram, correction, ONNX, friend
+ * configs...).  A ConfigurationManager constructed from the file reads it in
+ * one pass and answers the parse calls of the plugins from it, without
+ * touching the text or YAML sources, which need not be shipped with the job.
+ *
+ * Sub-configs are keyed by the path as written in the config, which is the
+ * argument the plugins pass to the parse calls.
+ *
+ * Layout (little-endian):
+ * @code
+ *   char     magic[8]        "RDFCONFG"
+ *   uint32   version         1
+ *   string   source          path of the compiled config
+ *   map      top
+ *   uint32   n, n x { string path, map }                 pair-based configs
+ *   uint32   n, n x { string path, uint32 m, m x map }   multi-key configs
+ *   uint32   n, n x { string path, uint32 m, m x string } vector configs
+ *
+ *   string = uint32 length, char[length]
+ *   map    = uint32 n, n x { string key, string value }, sorted by key
+ * @endcode
+ */
+struct CompiledConfig {
+  using PairConfig = std::unordered_map<std::string, std::string>;
+  using MultiKeyConfig = std::vector<PairConfig>;
+  using VectorConfig = std::vector<std::string>;
+
+  /// Conventional extension of compiled config files.
+  static constexpr const char *kExtension = ".rdfcfg";
+
+  /// Path of the config the file was compiled from.
+  std::string source;
+  /// Top-level key/value map.
+  PairConfig top;
+  /// Sub-configs by path as written, as parsed by each parse call (a file
+  /// read both as pairs and as a vector appears in both).
+  std::unordered_map<std::string, PairConfig> pairs;
+  std::unordered_map<std::string, MultiKeyConfig> multiKeys;
+  std::unordered_map<std::string, VectorConfig> vectors;
+
+  /// Whether @p path starts with the compiled-config magic.
+  static bool isCompiled(const std::string &path);
+
+  /// @throws std::runtime_error if @p path cannot be written.
+  void write(const std::string &path) const;
+
+  /// @throws std::runtime_error if @p path is not a readable compiled
+  ///         config of a supported version.
+  static CompiledConfig read(const std::string &path);
+};
+
+#endif // COMPILEDCONFIG_H_INCLUDED
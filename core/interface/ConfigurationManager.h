@@ -3,6 +3,7 @@
 
 #include <api/IConfigurationProvider.h>
 #include <api/IConfigAdapter.h>
+#include <CompiledConfig.h>
 #include <memory>
 #include <string>
 #include <string_view>
@@ -14,6 +15,13 @@
  * @brief Handles parsing and storing configuration values.
  *
  * Implements IConfigurationProvider interface for better dependency injection.
+ * Sub-config files are parsed once and reused until their size or
+ * modification time changes, so plugins reading the same file share the work.
+ *
+ * A compiled config (see CompiledConfig and compile()) is recognised by its
+ * magic and read instead of the sources: the top-level map and the
+ * sub-configs it holds come from the file, and only sub-configs missing
+ * from it are parsed.
  */
 class ConfigurationManager : public IConfigurationProvider {
 public:
@@ -108,11 +116,32 @@ public:
   std::vector<std::string> splitString(std::string_view input,
                                        std::string_view delimiter) const override;
 
+  /**
+   * @brief Write this configuration as a compiled config to @p outputFile.
+   *
+   * Every value of the top-level map, and of the pair-based sub-configs
+   * reached from it, that names an existing ``.txt``,
+   * ``.yaml``, ``.yml`` or ``.cfg`` file is parsed as a pair-based,
+   * multi-key and vector config; the parses that succeed are stored under
+   * the value as written.
+   *
+   * @return The compiled configuration that was written.
+   * @throws std::runtime_error if @p outputFile cannot be written.
+   */
+  CompiledConfig compile(const std::string &outputFile) const;
+
 private:
+  /// Parsed sub-configs by resolved path (see ConfigurationManager.cc).
+  struct ParseCache;
+
   std::unordered_map<std::string, std::string> configMap_m;
   std::shared_ptr<IConfigAdapter> adapter_m;
   std::string configBasePath_m; // Directory containing the main config file
   std::string configFile_m;     // Path to the main config file
+  /// Shared by copies: entries are keyed by path, size and mtime.
+  std::shared_ptr<ParseCache> parseCache_m;
+  /// Contents of a compiled config file, or nullptr for a source config.
+  std::shared_ptr<const CompiledConfig> compiled_m;
 
   std::string_view trim(std::string_view s) const;
   void processTopLevelConfig(const std::string &configFile);
@@ -2,20 +2,31 @@
 #define COUNTERSERVICE_H_INCLUDED
 
 #include "api/IAnalysisService.h"
+#include <CounterAction.h>
 #include <ROOT/RDataFrame.hxx>
 #include <ROOT/RResultPtr.hxx>
 #include <TH1D.h>
 #include <optional>
 #include <string>
 #include <chrono>
+#include <utility>
+#include <vector>
 
 /**
  * @brief Analysis service for logging per-sample event counts.
  *
- * Total event count and sign-weighted event count are booked during initialize().
- * An integer-branch histogram (e.g. a stitching code) can optionally be booked
- * after the analysis branch is defined by calling bookIntWeightHistogram() before
- * the event loop runs. This ensures the event loop executes only once.
+ * The entry count and the sums of the weight, its sign and its square are
+ * accumulated by one CounterAction booked during initialize(), which also
+ * breaks them down per input file.  An integer-branch histogram (e.g. a
+ * stitching code) can optionally be booked after the analysis branch is
+ * defined by calling bookIntWeightHistogram() before the event loop runs. This
+ * ensures the event loop executes only once.  When counterIntWeightBranch is
+ * already defined at initialize(), the histogram is filled by the same action.
+ *
+ * In a multi-sample job (``sampleConfig``) the per-file totals are also
+ * summed per sample and written as ``counter_weightSum_<sample>`` and
+ * ``counter_weightSignSum_<sample>``; the int-weight histogram covers the
+ * whole job.
  */
 class CounterService : public IAnalysisService {
 public:
@@ -29,7 +40,7 @@ public:
    * Must be called after the relevant branch has been defined on the dataframe
    * and before any action triggers the event loop. The histogram range [low, high)
    * must be known in advance (use nBins bins). If a weight branch was configured,
-   * it is applied; a companion sign-weight histogram is also booked.
+   * it is applied; a companion sign-weight histogram is also filled.
    *
    * A warning is emitted if this is called after filters have been applied,
    * because the counter histograms are intended to run over all events.
@@ -54,22 +65,37 @@ public:
   std::unordered_map<std::string, std::string>
   collectProvenanceEntries() const override;
 
+  /// Weight branch of the sums (``counterWeightBranch``); empty if unset.
+  const std::string& weightBranch() const { return weightBranch_m; }
+
+  /**
+   * @brief Entry count and weight sums of every entry read; valid once the
+   *        event loop has run (runs it otherwise).
+   * @throws std::runtime_error before initialize()
+   */
+  const CounterTotals& totals();
+
 private:
   ManagerContext* ctx_m = nullptr;
   std::string sampleName_m;
   std::string weightBranch_m;
   std::string intWeightBranch_m;
   std::optional<ROOT::RDF::RNode> preFilterDf_m;
-  ROOT::RDF::RResultPtr<ULong64_t> countResult;
-  ROOT::RDF::RResultPtr<Float_t> weightSumResult;
-  ROOT::RDF::RResultPtr<Int_t> weightSignSumResult;
+  ROOT::RDF::RResultPtr<CounterResult> countersResult_m;
   bool filtersApplied_m = false; // set by onPreFilter; used to warn in bookIntWeightHistogram
 
-  // Optional pre-booked int-weight histograms (booked via bookIntWeightHistogram)
-  std::optional<ROOT::RDF::RResultPtr<TH1D>> intWeightHistResult_m;
-  std::optional<ROOT::RDF::RResultPtr<TH1D>> intWeightSignHistResult_m;
+  // Optional int-weight histogram (booked via bookIntWeightHistogram, or
+  // the counters action itself when the branch existed at initialize())
+  std::optional<ROOT::RDF::RResultPtr<CounterResult>> intWeightHistResult_m;
   std::string intWeightHistBranch_m;
 
+  CounterAction::Binning intWeightBinning() const;
+  std::vector<std::pair<std::string, CounterTotals>>
+  totalsPerSample(const CounterResult& counters) const;
+  ROOT::RDF::RResultPtr<CounterResult> bookCounters(ROOT::RDF::RNode df,
+                                                    const std::string& codeBranch,
+                                                    CounterAction::Binning binning);
+
   // start time recorded at initialize(); used to compute processing speed in finalize()
   std::chrono::steady_clock::time_point startTime_m{};
 };
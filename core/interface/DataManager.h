@@ -4,11 +4,28 @@
 #include <api/IConfigurationProvider.h>
 #include <api/IDataFrameProvider.h>
 #include <ROOT/RDataFrame.hxx>
+#include <ColumnRegistry.h>
+#include <EntryRangeSet.h>
+#include <FilePrefetcher.h>
+#include <SampleSet.h>
+#include <InputStagingCache.h>
+#include <JitCache.h>
+#include <NodeProfiler.h>
+#include <SlowSiteMonitor.h>
 #include <SystematicManager.h>
+#include <ThreadPinning.h>
 #include <TChain.h>
+#include <TEntryList.h>
 #include <util.h>
+#include <functional>
+#include <map>
 #include <memory>
+#include <optional>
+#include <stdexcept>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
 #include <vector>
 
 /**
@@ -28,6 +45,14 @@ public:
    * the main TChain *before* the RDataFrame is created so that all friend
    * branches are immediately available.
    *
+   * When ``inputFormat`` is ``rntuple`` (or ``auto`` and the first file holds
+   * an RNTuple), the RDataFrame is built on RNTupleDS from the chain's file
+   * list (ROOT >= 6.34).  Friend trees and multiple ``treeList`` entries are
+   * not supported for RNTuple input and throw std::runtime_error.
+   *
+   * When ``stagingCacheDir`` is set, remote input files are copied to that
+   * node-local cache (see InputStagingCache) and read from there.
+   *
    * @param configProvider Reference to the configuration provider
    */
   DataManager(const IConfigurationProvider &configProvider);
@@ -44,6 +69,20 @@ public:
    */
   ROOT::RDF::RNode getDataFrame() override;
   void setDataFrame(const ROOT::RDF::RNode &node) override;
+  void updateDataFrame(const ROOT::RDF::RNode &node,
+                       const std::vector<std::string> &addedColumns) override;
+
+  /**
+   * @brief Whether the current node has column @p name, answered from a
+   * hash index of the columns (see ColumnRegistry).
+   *
+   * The index is built from GetColumnNames() on first use and kept up to
+   * date by Define(), DefineVector(), updateDataFrame() and the deferred
+   * columns; setDataFrame() rebuilds it on the next query.  A folded
+   * constant (see setFoldConstants()) is defined as a column when asked for.
+   */
+  bool hasColumn(const std::string &name) override;
+  std::string columnType(const std::string &name) override;
 
   /**
    * @brief Get the main TChain pointer
@@ -51,9 +90,25 @@ public:
    */
   TChain *getChain() const;
 
+  /**
+   * @brief Whether the input is read as RNTuple rather than TTree.
+   *
+   * For RNTuple input the main TChain only records the input file list and
+   * must not be used to read entries.
+   */
+  bool isRNTupleInput() const { return rntupleInput_m; }
+
+  /// Samples of a multi-sample job (empty for a single-sample job).
+  const SampleSet &samples() const { return samples_m; }
+
 
   /**
-   * @brief Define a vector variable in the dataframe. If all columns are scalars, creates a vector from them. If all columns are RVecs, concatenates and casts them to the target type. Mixed types are not supported and will throw an error at runtime. Uses a JIT lambda for type deduction and concatenation.
+   * @brief Define a vector variable in the dataframe. If all columns are scalars, creates a vector from them. If all columns are RVecs, concatenates and casts them to the target type. Mixed types are not supported and will throw an error at runtime.
+   *
+   * Column types are resolved once. When all inputs share one element type
+   * among Float_t/Double_t/Int_t/Bool_t, the target type is one of those, and
+   * there are at most 32 scalar or 8 RVec inputs, a precompiled typed kernel is
+   * used. Other combinations fall back to a JIT-compiled expression.
    * @param name Name of the variable
    * @param columns Input columns (scalars or vectors)
    * @param type Data type (default: Float_t)
@@ -64,6 +119,28 @@ public:
                     std::string type,
                     ISystematicManager &systematicManager) override;
 
+  /**
+   * @brief Define the model input @p name as a view or gather of a shared
+   *        feature block.
+   *
+   * The first request builds block ``__features_0``: @p features followed by
+   * every declareFeatures() feature that is a scalar column of the
+   * dataframe.  Later inputs whose features are all in a block read it by
+   * offset: the whole block is aliased, a contiguous run in the block's
+   * order is copied in one pass, anything else is gathered; inputs
+   * needing features outside the blocks get a new block.  Inputs with
+   * RVec features are defined with DefineVector() as before.
+   */
+  void DefineFeatureVector(std::string name, const std::vector<std::string> &features,
+                           ISystematicManager &systematicManager) override;
+
+  void declareFeatures(const std::vector<std::string> &features) override;
+
+  /// Feature blocks defined by DefineFeatureVector(), in order of definition.
+  const std::vector<std::vector<std::string>> &getFeatureBlocks() const {
+    return featureBlocks_m;
+  }
+
   /**
    * @brief Filter the dataframe
    * @param f Filter function
@@ -88,6 +165,7 @@ public:
       name, [value](unsigned int, const ROOT::RDF::RSampleInfo) -> T {
         return value;
       });
+      columns_m.add(name);
   }
 
   /**
@@ -99,11 +177,52 @@ public:
 
   /**
    * @brief Register constant variables from configuration
+   *
+   * In a multi-sample job (``sampleConfig``) every constant is defined per
+   * sample: the sample's own floatConfig/intConfig value, else the value
+   * of the job-wide files.
+   *
    * @param configProvider Reference to the configuration provider
    * @param configKey The key in the configuration for the constants file (default: "floatConfig")
+   * @throws std::runtime_error if a sample has no value for a constant
    */
   void registerConstants(const IConfigurationProvider &configProvider, const std::string& floatConfigKey = "floatConfig", const std::string& intConfigKey = "intConfig");
 
+  /**
+   * @brief Fold config constants into the expressions that read them.
+   *
+   * Set from the ``foldConstants`` config key.  When enabled,
+   * registerConstants() defines no column for a constant with one value in
+   * the whole job.  defineExpression() replaces the constant's name in a
+   * JIT expression by a literal of its type (``Float_t(1.5)``,
+   * ``Int_t(3)``), and typed callables capture getConstant().  The column is
+   * only defined when a Define(), Filter() or DefineVector() input, a
+   * hasColumn() query or a saved column asks for it.  Constants that differ
+   * between samples stay per-sample columns.  Folded constants must not be
+   * redefined.
+   */
+  void setFoldConstants(bool enable) { foldConstants_m = enable; }
+  bool isFoldConstantsEnabled() const { return foldConstants_m; }
+
+  /**
+   * @brief Value of the config constant @p name, for capture by a typed
+   *        callable.
+   * @throws std::runtime_error if @p name is not a constant of
+   *         registerConstants() or differs between samples
+   */
+  template <typename T> T getConstant(const std::string &name) const {
+    const auto it = constants_m.find(name);
+    if (it == constants_m.end()) {
+      throw std::runtime_error("DataManager: no job-wide constant '" + name + "'");
+    }
+    return static_cast<T>(it->second.value);
+  }
+
+  /**
+   * @brief Folded constants that are not defined as columns (yet).
+   */
+  std::vector<std::string> getFoldedConstants() const;
+
   /**
    * @brief Register aliases from configuration
    * @param configProvider Reference to the configuration provider
@@ -165,6 +284,343 @@ public:
    */
   void attachFriendTree(const FriendTreeSpec &spec);
 
+  /**
+   * @brief Attach the base skims of incremental skim inputs as friends.
+   *
+   * Reads the SkimColumnManifest (``<file>.columns.json``) of every input
+   * file and follows the ``base`` links: the bases of the inputs are attached
+   * as friend ``skim_layer1``, their bases as ``skim_layer2`` and so on.
+   * Each layer is matched on the index columns of the input manifests, and a
+   * column resolves to the newest layer that stores it.  Relative base paths
+   * are taken relative to the skim that names them.  Called by the
+   * constructor when @c readSkimLayers is set.
+   *
+   * @return Number of layers attached.
+   * @throws std::runtime_error for RNTuple input, a base chain that loops,
+   *         or a layer in which only some inputs name a base
+   */
+  std::size_t attachSkimLayers();
+
+  /// Skim that the skim of this job extends (``incrementalSkimBase``);
+  /// empty for a complete skim.
+  const std::string &getIncrementalSkimBase() const { return incrementalSkimBase_m; }
+
+  /**
+   * @brief Restrict the event loop to entries in certified luminosity sections.
+   *
+   * Scans only the @p runBranch / @p lumiBranch branches of the input chain,
+   * calls @p isCertified once per contiguous block of entries sharing a
+   * (run, lumi) pair, and attaches a TEntryList of the certified entries to
+   * the main chain.  RDataFrame reads the entry list when the event loop
+   * starts, so uncertified clusters are never decompressed and existing
+   * Define / Filter nodes are preserved.
+   *
+   * When a firstEntry/lastEntry range is configured only that range is
+   * scanned and the mask replaces the range's entry list.
+   *
+   * Pre-skipping is not applied (and -1 is returned) for RNTuple input, when
+   * there is no input chain, or when the run/lumi branches cannot be read.
+   * Callers must keep their per-event filter, which remains correct in all
+   * of these cases.
+   *
+   * @param isCertified Predicate returning true for certified (run, lumi) pairs.
+   * @param runBranch   Name of the run-number branch (default: "run").
+   * @param lumiBranch  Name of the luminosity-section branch
+   *                    (default: "luminosityBlock").
+   * @return Number of entries kept, or -1 if pre-skipping was not applied.
+   */
+  Long64_t applyLumiSectionMask(
+      const std::function<bool(unsigned int, unsigned int)> &isCertified,
+      const std::string &runBranch = "run",
+      const std::string &lumiBranch = "luminosityBlock") override;
+
+  /**
+   * @brief Skip @p entries (by ``rdfentry_``) in the event loop.
+   *
+   * Applied at construction to the entries recorded in ``checkpointFile``,
+   * so that a resubmitted job only processes what its preempted run did not.
+   * Skipped entries are still iterated, but none of their branches is read.
+   */
+  void skipEntries(const EntryRangeSet &entries);
+
+  /**
+   * @brief Restrict the graph from here on to the entries a cached
+   *        preselection kept, or prepare to record them.
+   *
+   * @p key identifies the preselection (see Analyzer::beginPreselection()).
+   * When every file of the main chain has a SelectionBitmap for @p key in
+   * @p directory, taken from a file with the same number of entries, a
+   * Filter on rdfentry_ keeping the cached entries is added to the current
+   * node.  Nodes booked before it still see every entry; after it, columns
+   * are only read for the cached entries, so baskets without one are not
+   * read.  Otherwise the entries reaching the node current at
+   * recordSelectionCache() are recorded, and writeSelectionCache() stores
+   * a bitmap per file after the event loop.
+   *
+   * Call it before applying the preselection filters, and
+   * recordSelectionCache() after them.
+   *
+   * Not used for RNTuple input, with a single-entry in-memory dataframe, or
+   * when an entry range, preview sample, lumi-section mask or checkpoint
+   * already changes the entries read.  Callers keep the preselection
+   * filters in every case, so the results do not depend on the cache.
+   *
+   * @return "applied", "recording", or an empty string when not used
+   */
+  std::string useSelectionCache(const std::string &directory, const std::string &key);
+
+  /// Book the recording prepared by useSelectionCache() on the current
+  /// node (no-op otherwise).
+  void recordSelectionCache();
+
+  /// Write the bitmaps recorded by useSelectionCache() (no-op otherwise).
+  void writeSelectionCache();
+
+  /**
+   * @brief Whether the event loop reads a ``previewFraction`` sample.
+   *
+   * A preview keeps whole clusters of every input file, chosen by
+   * systematic sampling within each file so that every file (and every part
+   * of it) is represented; the choice depends only on the file layout, so
+   * reruns see the same events.  Only applied to TTree input.
+   */
+  bool isPreview() const { return previewTotal_m > 0; }
+  /// Entries kept by the preview sample (0 when not a preview).
+  Long64_t previewSelectedEntries() const { return previewSelected_m; }
+  /// Entries the preview sample was drawn from (0 when not a preview).
+  Long64_t previewTotalEntries() const { return previewTotal_m; }
+  /// Factor scaling preview histograms to full statistics (1 when not a
+  /// preview); counters and cutflows are not scaled.
+  double previewScale() const {
+    return previewSelected_m > 0
+               ? static_cast<double>(previewTotal_m) / static_cast<double>(previewSelected_m)
+               : 1.0;
+  }
+
+  /**
+   * @brief Entries of @p chain in [firstEntry, lastEntry) kept by a preview
+   *        of @p fraction.
+   *
+   * Within each file the clusters are selected at evenly spaced positions,
+   * one in every ``1 / fraction``, and at least one cluster is kept per file.
+   */
+  static EntryRangeSet samplePreviewClusters(TChain &chain, double fraction,
+                                             Long64_t firstEntry, Long64_t lastEntry);
+
+  /**
+   * @brief Close the read monitor and write the slow-site report.
+   *
+   * Only active when ``slowSiteThreshold`` is configured. Call after the
+   * event loop has run; the report lists the slow sites and, for each file
+   * read from them, the URL on the next-ranked redirector.
+   */
+  void reportSlowSites();
+
+  /**
+   * @brief Read monitor of the input files (nullptr when disabled).
+   */
+  const SlowSiteMonitor *getSlowSiteMonitor() const { return slowSiteMonitor_m.get(); }
+
+  /**
+   * @brief Thread pinning of the event loop (nullptr unless ``pinThreads``
+   *        is enabled).
+   */
+  const ThreadPinning *getThreadPinning() const { return threadPinning_m.get(); }
+
+  /**
+   * @brief Give the calling thread back the CPUs it had before the event
+   *        loop pinned it (ThreadPinning::unpin()).
+   *
+   * Call from the thread that ran the event loop, after it has run.
+   */
+  void unpinMainThread();
+
+  /**
+   * @brief Time the callables of every subsequent Define, Redefine and
+   *        Filter (see NodeProfiler).
+   *
+   * Enabled at construction by ``profileNodes=true``; the report path is
+   * ``nodeProfileReport`` (default ``node_profile.json``).  Nodes registered
+   * before this call are not instrumented.
+   */
+  void enableNodeProfiling(const std::string &reportPath = "node_profile.json");
+
+  /**
+   * @brief Also count the heap allocations of every profiled node and of
+   *        every task of the event loop.
+   *
+   * Enables node profiling if needed.  Enabled at construction by
+   * ``profileAllocations=true``; allocations outside the instrumented nodes
+   * (reading, histogram fills, snapshots) are reported under the owner
+   * ``framework``.
+   */
+  void enableAllocationProfiling(const std::string &reportPath = "node_profile.json");
+
+  NodeProfiler *nodeProfiler() override { return nodeProfiler_m.get(); }
+
+  /**
+   * @brief Sets the gate of the columns defined while it is alive and
+   *        restores the previous gate afterwards (see defineGate()).
+   */
+  class GateScope {
+  public:
+    GateScope(DataManager *data, const std::string &gate) : data_m(data) {
+      if (data_m) {
+        previous_m = std::exchange(data_m->gateScope_m, gate);
+      }
+    }
+    ~GateScope() {
+      if (data_m) {
+        data_m->gateScope_m = std::move(previous_m);
+      }
+    }
+    GateScope(const GateScope &) = delete;
+    GateScope &operator=(const GateScope &) = delete;
+
+  private:
+    DataManager *data_m;
+    std::string previous_m;
+  };
+
+  /**
+   * @brief Gate @p columns (and their Up/Down variants) by the boolean
+   *        column @p gate wherever they are defined.
+   *
+   * Analyzer::gatePlugin() registers the produced columns of a gated plugin
+   * here, so columns defined by analysis code calling plugin methods
+   * directly are gated too.  An empty @p gate removes the gate.
+   */
+  void gateColumns(const std::vector<std::string> &columns, const std::string &gate);
+
+  /**
+   * @brief Gate of @p name: its registered gate (see gateColumns()), else
+   *        the gate of the enclosing GateScope.
+   *
+   * A gate that is not (yet) a column of the dataframe is ignored with a
+   * warning, and the column is computed for every entry.
+   */
+  std::string defineGate(const std::string &name) override;
+
+  /**
+   * @brief Write the node profile report.
+   *
+   * Only active when node profiling is enabled. Call after the event loop
+   * has run.  With allocation profiling, the allocations cover the last
+   * event loop, and the task counting is booked again for the next one.
+   */
+  void reportNodeProfile();
+
+  /**
+   * @brief Define string expressions through the JIT cache in @p directory
+   *        (see JitCache).
+   *
+   * Enabled at construction by ``jitCacheDir``; ``jitCacheBuild=true``
+   * lets buildJitCache() add the expressions this job compiled.
+   */
+  void enableJitCache(const std::string &directory, bool build);
+
+  ROOT::RDF::RNode defineExpression(ROOT::RDF::RNode df, const std::string &name,
+                                    const std::string &expression) override;
+
+  /// Compiled through the JIT cache when enabled (see JitCache::function()).
+  void *compileFunction(const std::string &source) override;
+
+  /// JIT cache of the string expressions (nullptr when disabled).
+  const JitCache *getJitCache() const { return jitCache_m.get(); }
+
+  /// String expressions defined through defineExpression() so far.
+  std::size_t getJitExpressionCount() const { return jitExpressionCount_m; }
+
+  /**
+   * @brief Compile the expressions this job JIT-compiled into the cache.
+   *
+   * Only active when the cache was enabled for building. A failed
+   * compilation is reported and leaves the expressions to the JIT compiler.
+   */
+  void buildJitCache();
+
+  /**
+   * @brief Write the string expressions of this job as a translation unit
+   *        to ``jitExportFile``, for compilation into the analysis
+   *        executable (see JitCache::generateTranslationUnit()).
+   */
+  void exportJitExpressions();
+
+  /**
+   * @brief Node-local staging cache of the input files (nullptr when disabled).
+   */
+  const InputStagingCache *getStagingCache() const { return stagingCache_m.get(); }
+
+  /**
+   * @brief Defer systematic-variation columns until a consumer requests them.
+   *
+   * Set from the ``deferVariationColumns`` config key.  When enabled, the
+   * Up/Down variants created by Define() are kept as a dependency graph and
+   * only defined when materializeColumn() is called for them (or for a
+   * column that depends on them).  Variants still pending when the event
+   * loop starts are never added to the dataframe.
+   */
+  void setDeferVariationColumns(bool enable) { deferVariationColumns_m = enable; }
+  bool isDeferVariationColumnsEnabled() const { return deferVariationColumns_m; }
+
+  bool deferColumn(const std::string &name, const std::vector<std::string> &inputs,
+                   std::function<ROOT::RDF::RNode(ROOT::RDF::RNode)> define) override;
+
+  /**
+   * @brief Define a deferred column, after its deferred inputs, or a folded
+   * constant.
+   */
+  void materializeColumn(const std::string &name) override;
+
+  /**
+   * @brief Define every deferred column and folded constant, e.g. before
+   * snapshotting the full dataframe.
+   */
+  void materializeAllColumns();
+
+  /**
+   * @brief Deferred columns that no consumer has requested so far.
+   */
+  std::vector<std::string> getPendingColumns() const;
+
+  /**
+   * @brief Number of columns deferred since construction.
+   */
+  std::size_t getDeferredColumnCount() const { return nDeferredColumns_m; }
+
+  void recordColumnsRead(const std::vector<std::string> &columns) override;
+
+  /**
+   * @brief Input branches of the main chain that the booked graph reads.
+   *
+   * The inputs of every define of the main dataframe (taken from its
+   * column register, so columns defined directly on an RNode count too),
+   * every identifier of a string expression, the targets of read aliases
+   * and the columns reported through recordColumnsRead() (Filter(),
+   * Redefine(), booked consumers) are matched against the top-level
+   * branches of the main chain.  The branches holding the sizes of read
+   * arrays and the ``keepInputBranches`` globs are added.  Sorted.
+   */
+  std::vector<std::string> getReadInputBranches() const;
+
+  /**
+   * @brief Disable the branches of the main chain that
+   *        getReadInputBranches() does not list, so they are never read or
+   *        decompressed.
+   *
+   * Call once every consumer has been booked.  Writes the read branches to
+   * ``inputBranchReport`` when set.  No-op for RNTuple input and without an
+   * input chain.  With implicit multithreading enabled nothing is disabled:
+   * every task reads a chain of its own, built from the file names, whose
+   * readers only read the branches of booked columns.
+   * @return Number of branches disabled.
+   */
+  std::size_t pruneUnreadBranches();
+
+  /// True when ``pruneInputBranches=true`` (the Analyzer then calls
+  /// pruneUnreadBranches() before the event loop).
+  bool isInputBranchPruningEnabled() const { return pruneInputBranches_m; }
+
   /**
    * @brief Finalize setup after all configuration is loaded
    * @param configProvider Reference to the configuration provider
@@ -182,6 +638,207 @@ public:
   virtual ~DataManager();
 
 private:
+  /**
+   * @brief Attach a TEntryList covering [firstEntry, lastEntry) to the main
+   * chain (TTree input only).
+   */
+  void applyEntryRange(Long64_t firstEntry, Long64_t lastEntry);
+
+  /**
+   * @brief Attach a TEntryList of the samplePreviewClusters() of the main
+   * chain (within the configured entry range).
+   */
+  void applyPreviewSampling(double fraction);
+
+  /// Path of the selection bitmap of input file @p file.
+  std::string selectionBitmapPath(const std::string &file) const;
+
+  /**
+   * @brief Set ROOT's tasks-per-worker hint under implicit multi-threading.
+   *
+   * ``tasksPerWorkerHint`` sets it directly.  Otherwise ``taskCostProfile``
+   * names a node profile report of an earlier run on similar input, and the
+   * hint is chosen so that one task takes about ``targetTaskSeconds``
+   * (default 2) at the measured cost per event (see
+   * NodeProfiler::tasksPerWorkerHint()).  Smaller tasks shorten the tail in
+   * which a few slots finish the last expensive clusters of a file.
+   * ``minEntriesPerTask`` then lowers the hint until a task holds at least
+   * that many entries, so cheap events are not split into tasks whose
+   * scheduling and per-task setup outweigh the work.
+   */
+  void configureTaskSplitting(const IConfigurationProvider &configProvider);
+
+  /**
+   * @brief Pin the event-loop threads to CPUs, node by node, when
+   *        ``pinThreads`` is enabled under implicit multi-threading (see
+   *        ThreadPinning).
+   */
+  void configureThreadPinning(const IConfigurationProvider &configProvider);
+
+  /// Book the per-task allocation counting of the next event loop.
+  void bookAllocationTasks();
+
+  /**
+   * @brief Define SampleSet::kIndexColumn from the file each sample of the
+   * event loop comes from.
+   */
+  void defineSampleIndex();
+
+  /// Define config constant @p name, or keep it for folding.
+  void registerConstant(const std::string &name, double value, bool isInt);
+
+  /// Define the folded constant @p name as a column; false if it is none.
+  bool materializeConstant(const std::string &name);
+
+  /// @p expression with every job-wide constant replaced by its literal
+  /// when folding is enabled.
+  std::string foldConstants(const std::string &expression) const;
+
+  /// registerConstants() of a multi-sample job.
+  void registerSampleConstants(const IConfigurationProvider &configProvider,
+                               const std::string &floatConfigKey,
+                               const std::string &intConfigKey);
+
+  /// Index of the sample that @p info (a file of the main chain) belongs to.
+  int sampleOf(const ROOT::RDF::RSampleInfo &info) const;
+
+  /**
+   * @brief Create the slow-site monitor from ``slowSiteThreshold`` and move
+   * files on sites flagged in an earlier report to their failover URL.
+   */
+  void setupSlowSiteMonitor(const IConfigurationProvider &configProvider);
+
+  /**
+   * @brief Feed every sample switch of the event loop to the slow-site
+   * monitor (through a per-sample column).
+   */
+  void monitorSampleReads();
+
+  /**
+   * @brief Point chain files that have not been opened yet and sit on a slow
+   * site to their failover URL.
+   */
+  void failoverUnopenedFiles();
+
+  /**
+   * @brief Create the prefetcher of the next input files from
+   * ``prefetchFiles`` / ``prefetchBytes`` and queue the first window.
+   */
+  void setupFilePrefetcher(const IConfigurationProvider &configProvider);
+
+  /**
+   * @brief Feed every sample switch of the event loop to the file
+   * prefetcher (through a per-sample column).
+   */
+  void prefetchOnSampleSwitch();
+
+  /**
+   * @brief Copy the remote files of the input chains to the staging cache
+   * and point the chains at the local copies.
+   */
+  void stageInputFiles(const IConfigurationProvider &configProvider);
+
+  /// Column index of df_m (see hasColumn()).
+  ColumnRegistry columns_m;
+
+  /// Definition of a column held back by deferColumn().
+  struct DeferredColumn {
+    std::vector<std::string> inputs;
+    std::function<ROOT::RDF::RNode(ROOT::RDF::RNode)> define;
+  };
+  /// True when Define() variants are deferred (``deferVariationColumns``).
+  bool deferVariationColumns_m = false;
+  /// Pending deferred columns, keyed by column name.
+  std::map<std::string, DeferredColumn> deferredColumns_m;
+  std::size_t nDeferredColumns_m = 0;
+
+  /// A job-wide config constant (see registerConstants()).
+  struct ConfigConstant {
+    double value;
+    bool isInt;
+    /// Folded and not defined as a column yet.
+    bool folded;
+  };
+  /// True when constants are folded (``foldConstants``).
+  bool foldConstants_m = false;
+  /// Job-wide constants by name.
+  std::unordered_map<std::string, ConfigConstant> constants_m;
+
+  /// Columns reported read by the graph (see recordColumnsRead()).
+  std::unordered_set<std::string> readColumns_m;
+  /// Features announced by declareFeatures(), in order of first declaration.
+  std::vector<std::string> declaredFeatures_m;
+  /// Features of the shared blocks ``__features_<i>`` (see DefineFeatureVector()).
+  std::vector<std::vector<std::string>> featureBlocks_m;
+  /// Branch pruning settings (``pruneInputBranches``, ``keepInputBranches``,
+  /// ``inputBranchReport``).
+  bool pruneInputBranches_m = false;
+  std::vector<std::string> keepInputBranches_m;
+  std::string inputBranchReport_m;
+
+  /// Staging cache created from ``stagingCacheDir``.
+  std::unique_ptr<InputStagingCache> stagingCache_m;
+  /// Opens the next input files ahead of the loop (``prefetchFiles``).
+  std::unique_ptr<FilePrefetcher> filePrefetcher_m;
+  /// Per-site read monitor (see reportSlowSites()).
+  std::unique_ptr<SlowSiteMonitor> slowSiteMonitor_m;
+  /// Path of the slow-site report.
+  std::string slowSiteReport_m;
+  /// Base skim of an incremental skim (``incrementalSkimBase``).
+  std::string incrementalSkimBase_m;
+  /// Define/Filter timing (see enableNodeProfiling()).
+  std::unique_ptr<NodeProfiler> nodeProfiler_m;
+  /// Path of the node profile report.
+  std::string nodeProfileReport_m;
+  /// Per-task allocation counting (see enableAllocationProfiling()).
+  std::optional<ROOT::RDF::RResultPtr<ULong64_t>> allocationTasks_m;
+  /// Gate of the enclosing GateScope, and gates registered per column.
+  std::string gateScope_m;
+  std::unordered_map<std::string, std::string> columnGates_m;
+  /// Gates already reported as missing.
+  std::unordered_set<std::string> missingGates_m;
+  /// Active thread pinning (see configureThreadPinning()).
+  std::unique_ptr<ThreadPinning> threadPinning_m;
+  /// Precompiled string expressions (see enableJitCache()).
+  std::unique_ptr<JitCache> jitCache_m;
+  bool buildJitCache_m = false;
+  /// Calls of defineExpression() (see getJitExpressionCount()).
+  std::size_t jitExpressionCount_m = 0;
+  /// Translation unit written by exportJitExpressions() (empty: none).
+  std::string jitExportFile_m;
+
+  /// Entry lists installed by applyEntryRange(), applyPreviewSampling() and
+  /// applyLumiSectionMask().  Declared before the chains so that they
+  /// outlive the TChain that points to them.
+  std::unique_ptr<TEntryList> entryRangeList_m;
+  std::unique_ptr<TEntryList> previewEntryList_m;
+  std::unique_ptr<TEntryList> lumiEntryList_m;
+  /// True when the firstEntry/lastEntry restriction was applied.
+  bool entryRangeApplied_m = false;
+  /// Configured entry range (valid when entryRangeApplied_m is true).
+  Long64_t firstEntry_m = 0;
+  Long64_t lastEntry_m = 0;
+  /// Entries kept by the preview sample, and the entries it was drawn from.
+  EntryRangeSet previewEntries_m;
+  Long64_t previewSelected_m = 0;
+  Long64_t previewTotal_m = 0;
+  /// Samples of a multi-sample job and the sample of each input file, by
+  /// URL and by file name.
+  SampleSet samples_m;
+  std::unordered_map<std::string, int> sampleByUrl_m;
+  std::unordered_map<std::string, int> sampleByFileName_m;
+  /// True when skipEntries() dropped entries, or a checkpoint may make a
+  /// later run of this job do so.
+  bool entriesSkipped_m = false;
+  /// Preselection recorded for the selection cache (see useSelectionCache()).
+  std::string selectionCacheDir_m;
+  std::string selectionCacheKey_m;
+  std::optional<ROOT::RDF::RResultPtr<EntryRangeSet>> selectionEntries_m;
+  /// True between useSelectionCache() and recordSelectionCache() when the
+  /// block is recorded rather than read from the cache.
+  bool selectionRecordPending_m = false;
+  /// True when the input files are read as RNTuple (see isRNTupleInput()).
+  bool rntupleInput_m = false;
   /// Owns TChain objects attached as ROOT friend trees.
   /// Must be declared before chain_vec_m so that friend chains are destroyed
   /// AFTER the main TChain (C++ destroys members in reverse declaration order).
@@ -0,0 +1,147 @@
+/**
+ * @file EntryRangeSet.h
+ * @brief Set of input entries stored as sorted, disjoint half-open ranges.
+ *
+ * Event loops visit entries cluster by cluster, so the entries processed by
+ * one slot form a handful of contiguous runs.  Storing the runs instead of
+ * the entries keeps checkpoint bookkeeping small and makes the set cheap to
+ * union across slots and to serialize as text.
+ */
+#ifndef ENTRYRANGESET_H_INCLUDED
+#define ENTRYRANGESET_H_INCLUDED
+
+#include <RtypesCore.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * @class EntryRangeSet
+ * @brief Sorted, disjoint, non-adjacent ranges [first, last) of entries.
+ */
+class EntryRangeSet {
+public:
+    using Range = std::pair<ULong64_t, ULong64_t>;
+
+    /**
+     * @brief Add one entry.
+     *
+     * Appending the entry that follows the last range is O(1), which is the
+     * common case when a slot walks a cluster.
+     */
+    void add(ULong64_t entry) {
+        if (!ranges_m.empty() && ranges_m.back().second == entry) {
+            ++ranges_m.back().second;
+            return;
+        }
+        if (ranges_m.empty() || ranges_m.back().second < entry) {
+            ranges_m.emplace_back(entry, entry + 1);
+            return;
+        }
+        add(entry, entry + 1);
+    }
+
+    /// Add the entries [first, last); empty ranges are ignored.
+    void add(ULong64_t first, ULong64_t last) {
+        if (first >= last) {
+            return;
+        }
+        auto it = std::lower_bound(ranges_m.begin(), ranges_m.end(), first,
+                                   [](const Range &r, ULong64_t x) { return r.second < x; });
+        auto end = it;
+        while (end != ranges_m.end() && end->first <= last) {
+            first = std::min(first, end->first);
+            last = std::max(last, end->second);
+            ++end;
+        }
+        it = ranges_m.erase(it, end);
+        ranges_m.insert(it, Range(first, last));
+    }
+
+    /// Add every range of @p other.
+    void merge(const EntryRangeSet &other) {
+        for (const auto &range : other.ranges_m) {
+            add(range.first, range.second);
+        }
+    }
+
+    /// True when @p entry is in the set.
+    bool contains(ULong64_t entry) const {
+        auto it = std::upper_bound(ranges_m.begin(), ranges_m.end(), entry,
+                                   [](ULong64_t x, const Range &r) { return x < r.first; });
+        return it != ranges_m.begin() && entry < std::prev(it)->second;
+    }
+
+    /// Number of entries in the set.
+    ULong64_t size() const {
+        ULong64_t n = 0;
+        for (const auto &range : ranges_m) {
+            n += range.second - range.first;
+        }
+        return n;
+    }
+
+    bool empty() const { return ranges_m.empty(); }
+
+    void clear() { ranges_m.clear(); }
+
+    /// The ranges, sorted by first entry.
+    const std::vector<Range> &ranges() const { return ranges_m; }
+
+    /// Text form: comma-separated "first-last" ranges, e.g. "0-1000,2000-2500".
+    std::string toString() const {
+        std::ostringstream out;
+        for (std::size_t i = 0; i < ranges_m.size(); ++i) {
+            out << (i == 0 ? "" : ",") << ranges_m[i].first << '-' << ranges_m[i].second;
+        }
+        return out.str();
+    }
+
+    /**
+     * @brief Parse the text form written by toString().
+     * @throws std::runtime_error on malformed input.
+     */
+    static EntryRangeSet fromString(const std::string &text) {
+        EntryRangeSet set;
+        std::istringstream in(text);
+        std::string token;
+        while (std::getline(in, token, ',')) {
+            if (token.empty()) {
+                continue;
+            }
+            const auto dash = token.find('-');
+            std::size_t endFirst = 0;
+            std::size_t endLast = 0;
+            ULong64_t first = 0;
+            ULong64_t last = 0;
+            try {
+                if (dash == std::string::npos) {
+                    throw std::invalid_argument("missing '-'");
+                }
+                const std::string firstText = token.substr(0, dash);
+                const std::string lastText = token.substr(dash + 1);
+                first = std::stoull(firstText, &endFirst);
+                last = std::stoull(lastText, &endLast);
+                if (endFirst != firstText.size() || endLast != lastText.size()) {
+                    throw std::invalid_argument("trailing characters");
+                }
+            } catch (const std::exception &) {
+                throw std::runtime_error("EntryRangeSet::fromString(): malformed range '" +
+                                         token + "'");
+            }
+            set.add(first, last);
+        }
+        return set;
+    }
+
+private:
+    std::vector<Range> ranges_m;
+};
+
+#endif // ENTRYRANGESET_H_INCLUDED
@@ -0,0 +1,60 @@
+/**
+ * @file EntryTrackerAction.h
+ * @brief RDataFrame action recording the entries that reach a node.
+ */
+#ifndef ENTRYTRACKERACTION_H_INCLUDED
+#define ENTRYTRACKERACTION_H_INCLUDED
+
+#include <EntryRangeSet.h>
+#include <ROOT/RDF/RActionImpl.hxx>
+#include <RtypesCore.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+class TTreeReader;
+
+/**
+ * @brief Records the ``rdfentry_`` values processed by every slot.
+ *
+ * Book it with the ``rdfentry_`` column.  PartialUpdate() hands out the
+ * slot's entries so far; the checkpoint service registers its callback on
+ * this action last, after the results whose slot accumulators it snapshots
+ * for the same entry.
+ */
+class EntryTrackerAction
+    : public ROOT::Detail::RDF::RActionImpl<EntryTrackerAction> {
+public:
+  using Result_t = EntryRangeSet;
+
+  explicit EntryTrackerAction(unsigned int nSlots, std::string name = "CheckpointEntries")
+      : slots_m(nSlots), result_m(std::make_shared<Result_t>()), name_m(std::move(name)) {}
+
+  EntryTrackerAction(EntryTrackerAction &&) = default;
+  EntryTrackerAction(const EntryTrackerAction &) = delete;
+
+  std::shared_ptr<Result_t> GetResultPtr() const { return result_m; }
+
+  void Initialize() {}
+  void InitTask(TTreeReader *, unsigned int) {}
+
+  void Exec(unsigned int slot, ULong64_t entry) { slots_m[slot].add(entry); }
+
+  Result_t &PartialUpdate(unsigned int slot) { return slots_m[slot]; }
+
+  void Finalize() {
+    for (const auto &entries : slots_m) {
+      result_m->merge(entries);
+    }
+  }
+
+  std::string GetActionName() const { return name_m; }
+
+private:
+  std::vector<Result_t> slots_m;
+  std::shared_ptr<Result_t> result_m;
+  std::string name_m;
+};
+
+#endif // ENTRYTRACKERACTION_H_INCLUDED
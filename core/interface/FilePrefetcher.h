@@ -0,0 +1,107 @@
+#ifndef FILEPREFETCHER_H_INCLUDED
+#define FILEPREFETCHER_H_INCLUDED
+
+#include <RtypesCore.h>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+class TFile;
+
+/**
+ * @brief Opens the next input files of the event loop ahead of time.
+ *
+ * RDataFrame opens a chain file only when its first cluster is scheduled, so
+ * the open latency of remote files (redirects, authentication) is paid once
+ * per file, in series with the processing. Each time the loop starts a file,
+ * onFileStarted() queues the next @c lookahead remote files. A background
+ * thread then starts their opens with TFile::AsyncOpen(), which the later
+ * TFile::Open() of the same URL picks up. With a positive warm size it first
+ * reads the first bytes of each file (header, streamer info and the leading
+ * baskets), so the data server has them in cache when the loop gets there,
+ * and keeps that file open, with its connection, until the loop starts it.
+ * The open handle is started after the warm-up read, which would otherwise
+ * consume it.
+ *
+ * Local files are skipped. Each file is queued at most once. The constructor
+ * enables ROOT's thread safety for the background opens.
+ */
+class FilePrefetcher {
+public:
+  /**
+   * @param files Files of the input chain, in reading order
+   * @param lookahead Number of files to prefetch beyond the current one
+   * @param warmBytes Bytes read from the start of each prefetched file
+   *        (0: open only)
+   * @param opened Number of leading files whose open was already started
+   *        (``asyncOpenFiles``); they are not queued again
+   */
+  FilePrefetcher(std::vector<std::string> files, unsigned int lookahead,
+                 Long64_t warmBytes, std::size_t opened = 0);
+  virtual ~FilePrefetcher();
+
+  FilePrefetcher(const FilePrefetcher &) = delete;
+  FilePrefetcher &operator=(const FilePrefetcher &) = delete;
+
+  /**
+   * @brief Queue the @c lookahead files after @p url and close the warm-up
+   * file of @p url, which the loop has now opened. Cheap enough to call from
+   * a per-sample callback; unknown URLs are ignored.
+   */
+  void onFileStarted(const std::string &url);
+
+  /// Block until every queued file has been prefetched.
+  void wait();
+
+  /// Number of files prefetched so far.
+  unsigned int prefetched() const;
+  /// Bytes read by warm-up reads so far.
+  Long64_t warmedBytes() const;
+
+protected:
+  /// Start opening @p url so that a later TFile::Open() picks it up.
+  virtual void openAhead(const std::string &url);
+
+  /**
+   * @brief Read the first @p bytes of @p url, keeping the file open until
+   * onFileStarted(@p url).
+   * @return Number of bytes read (0 when the file cannot be opened)
+   */
+  virtual Long64_t warm(const std::string &url, Long64_t bytes);
+
+  /**
+   * @brief Stop the worker thread. Derived classes overriding the hooks call
+   * this from their destructor, before their members are destroyed.
+   */
+  void stop();
+
+private:
+  void run();
+
+  std::vector<std::string> files_m;
+  std::unordered_map<std::string, std::size_t> index_m;
+  unsigned int lookahead_m;
+  Long64_t warmBytes_m;
+  /// Files [0, queuedUpTo_m) have been queued (or opened by asyncOpenFiles).
+  std::size_t queuedUpTo_m;
+
+  std::deque<std::string> queue_m;
+  bool busy_m = false;
+  bool stop_m = false;
+  unsigned int prefetched_m = 0;
+  Long64_t warmedBytes_m = 0;
+  /// Warm-up files, open until the loop starts them.
+  std::unordered_map<std::string, std::unique_ptr<TFile>> warmFiles_m;
+  mutable std::mutex mutex_m;
+  std::condition_variable wake_m;
+  std::condition_variable idle_m;
+  std::thread worker_m;
+};
+
+#endif // FILEPREFETCHER_H_INCLUDED
@@ -0,0 +1,158 @@
+/**
+ * @file FilterProfile.h
+ * @brief Measured cost and selectivity of preselection filters, used to
+ *        order the filters of a preselection block.
+ *
+ * Analyzer::beginPreselection() opens a block of commutative filters.  With
+ * ``filterProfile`` set, every filter of a block is applied through a
+ * callable that counts its calls, passes and time per slot, and the totals
+ * are written to the profile after the event loop.  The next run reads the
+ * profile and applies the block's filters cheapest-to-reject first.
+ */
+#ifndef FILTERPROFILE_H_INCLUDED
+#define FILTERPROFILE_H_INCLUDED
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * @class FilterProfile
+ * @brief Slot-local call, pass and time counters of profiled filters.
+ *
+ * For independent filters, applying them in increasing order of
+ * cost / (1 - pass fraction) minimises the expected time per event, so a
+ * cheap cut that rejects most events runs before an expensive one.  The
+ * pass fraction of a filter is measured on the events that reached it,
+ * which is the conditional selectivity of the order the profile was taken
+ * in; it converges after a run or two as the order settles.
+ *
+ * The time of a filter runs from the previous filter of its block to its
+ * own call.  Columns are computed when first read, so it includes its pass
+ * column and the upstream defines this filter is the first of the block
+ * to read, e.g. an expensive object selection behind a cheap cut.
+ */
+class FilterProfile {
+public:
+  /// Summed counters of one filter.
+  struct Stats {
+    std::uint64_t calls = 0;
+    std::uint64_t passed = 0;
+    std::uint64_t nanoseconds = 0;
+
+    double costNs() const {
+      return calls > 0 ? static_cast<double>(nanoseconds) / calls : 0.0;
+    }
+    double passFraction() const {
+      return calls > 0 ? static_cast<double>(passed) / calls : 1.0;
+    }
+  };
+
+  /// @param nSlots Number of processing slots of the dataframe.
+  explicit FilterProfile(unsigned int nSlots)
+      : nSlots_m(nSlots == 0 ? 1 : nSlots), marks_m(nSlots_m) {}
+
+  FilterProfile(const FilterProfile &) = delete;
+  FilterProfile &operator=(const FilterProfile &) = delete;
+
+  /**
+   * @brief Filter callable starting the time of a block; apply it on
+   *        ``rdfslot_`` right before the first filter of the block.
+   */
+  auto start() {
+    return [this](unsigned int slot) {
+      if (slot < marks_m.size()) {
+        marks_m[slot].time = std::chrono::steady_clock::now();
+      }
+      return true;
+    };
+  }
+
+  /**
+   * @brief Register filter @p name and return a filter callable that
+   *        applies its boolean pass column, counting its calls and passes
+   *        and timing it from the previous filter of the block.
+   *
+   * Apply it on ``rdfslot_`` and the pass column, after start() or the
+   * previous filter of the block.
+   */
+  auto wrap(const std::string &name) {
+    filters_m.push_back(Filter{name, std::vector<SlotCounter>(nSlots_m)});
+    Filter *filter = &filters_m.back();
+    return [this, filter](unsigned int slot, bool pass) {
+      if (slot < filter->slots.size()) {
+        const auto now = std::chrono::steady_clock::now();
+        SlotCounter &counter = filter->slots[slot];
+        ++counter.calls;
+        counter.passed += pass;
+        counter.nanoseconds += static_cast<std::uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(now - marks_m[slot].time)
+                .count());
+        marks_m[slot].time = now;
+      }
+      return pass;
+    };
+  }
+
+  /// Summed counters of every registered filter.
+  std::map<std::string, Stats> measured() const;
+
+  /**
+   * @brief Read a profile written by write().
+   *
+   * A missing file is an empty profile, so the first run of a new profile
+   * keeps the declared order.
+   *
+   * @throws std::runtime_error if @p path exists but cannot be parsed.
+   */
+  static std::map<std::string, Stats> read(const std::string &path);
+
+  /**
+   * @brief Write the measured counters to @p path as JSON.
+   *
+   * Filters of @p previous that were not measured, or never reached, in
+   * this run keep their previous counters.
+   *
+   * @throws std::runtime_error if @p path cannot be written.
+   */
+  void write(const std::string &path, const std::map<std::string, Stats> &previous) const;
+
+  /**
+   * @brief Application order of @p names, as indices into it.
+   *
+   * Filters are ordered by increasing cost / (1 - pass fraction); a filter
+   * that never rejected goes last.  Unless every filter has been reached in
+   * @p profile, the declared order is kept.
+   */
+  static std::vector<std::size_t> order(const std::vector<std::string> &names,
+                                        const std::map<std::string, Stats> &profile);
+
+private:
+  /// Calls, passes and accumulated time of one filter in one slot.
+  struct alignas(64) SlotCounter {
+    std::uint64_t calls = 0;
+    std::uint64_t passed = 0;
+    std::uint64_t nanoseconds = 0;
+  };
+
+  struct Filter {
+    std::string name;
+    std::vector<SlotCounter> slots;
+  };
+
+  /// End of the last filter call of a slot (or of start()).
+  struct alignas(64) SlotMark {
+    std::chrono::steady_clock::time_point time;
+  };
+
+  unsigned int nSlots_m;
+  std::vector<SlotMark> marks_m;
+  /// Deque, so the wrappers' pointers stay valid as filters are added.
+  std::deque<Filter> filters_m;
+};
+
+#endif // FILTERPROFILE_H_INCLUDED
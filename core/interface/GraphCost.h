@@ -0,0 +1,69 @@
+#ifndef GRAPHCOST_H_INCLUDED
+#define GRAPHCOST_H_INCLUDED
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class IConfigurationProvider;
+
+/**
+ * @brief Resources predicted for a computation graph before its event loop
+ *        (``dryRun``, see Analyzer::estimateCost()).
+ *
+ * Counted from the booked graph: the defined columns, the string
+ * expressions the JIT compiler has to compile, the booked histograms with
+ * their bin cells (systematic and region axes included) and the per-slot
+ * accumulator memory they reserve at most, and the ML models evaluated per
+ * event.  Plugins add their share through IPluggableManager::estimateCost().
+ */
+struct GraphCost {
+  /// One booked histogram.
+  struct Histogram {
+    std::string name;
+    /// Bins of all axes, under- and overflow included.
+    std::uint64_t cells = 0;
+    /// Bins of the systematic axis.
+    std::size_t systematics = 0;
+    /// Accumulator bytes per slot; sparse storage is counted at the fill
+    /// fraction ``costSparseFillFraction`` (default 0.1).
+    std::uint64_t bytesPerSlot = 0;
+  };
+
+  std::size_t definedColumns = 0;
+  /// String expressions defined (DefineVector fallbacks, weight products...).
+  std::size_t jitExpressions = 0;
+  /// Those of jitExpressions not found in the JIT cache.
+  std::size_t jitCompiled = 0;
+  std::size_t systematics = 0;
+  unsigned int slots = 1;
+  std::vector<Histogram> histograms;
+  /// ML models (ONNX, BDT, SOFIE) evaluated per event.
+  std::size_t models = 0;
+  /// Budgets exceeded, filled by checkBudgets().
+  std::vector<std::string> warnings;
+
+  std::uint64_t histogramCells() const;
+  std::uint64_t histogramBytesPerSlot() const;
+  /// Accumulator bytes of all slots.
+  std::uint64_t histogramBytes() const;
+
+  /**
+   * @brief Compare the estimate with the budgets of @p config and record a
+   *        warning for each one exceeded.
+   *
+   * Keys (unset or 0 means unlimited): ``costBudgetColumns``,
+   * ``costBudgetJitExpressions``, ``costBudgetHistogramCells``,
+   * ``costBudgetHistogramMB`` (all slots) and ``costBudgetModels``.
+   *
+   * @return True when every budget holds.
+   * @throws std::runtime_error for a budget that is not a number.
+   */
+  bool checkBudgets(const IConfigurationProvider &config);
+
+  /// JSON report of the estimate and its warnings.
+  std::string toJson() const;
+};
+
+#endif // GRAPHCOST_H_INCLUDED
@@ -0,0 +1,47 @@
+/**
+ * @file HistDeviceSink.h
+ * @brief Interface of histogram storage that lives outside the host, such
+ * as a GPU buffer.
+ *
+ * THnMulti fills a histogram with a HistDeviceSink (histFillInfo::deviceSink)
+ * by computing the linear bin index of every fill on the host, staging
+ * (bin index, weight) pairs per slot and handing them to the sink in
+ * batches.  The sink accumulates the interleaved (sum of weights, sum of
+ * squared weights) of each bin and returns them once, when the histogram
+ * is finalized.
+ *
+ * The interface only uses fundamental types, so that implementations can
+ * be compiled by a device compiler without the ROOT headers.
+ */
+#ifndef HISTDEVICESINK_H_INCLUDED
+#define HISTDEVICESINK_H_INCLUDED
+
+#include <cstddef>
+#include <cstdint>
+
+class HistDeviceSink {
+public:
+  virtual ~HistDeviceSink() = default;
+
+  /// Number of bins, under/overflow included, the sink holds.
+  virtual std::size_t cells() const = 0;
+
+  /**
+   * @brief Add @p n weights to the bins @p cells.
+   *
+   * Called concurrently by the slots of the event loop; the arrays may be
+   * reused by the caller as soon as the call returns.
+   */
+  virtual void add(const std::uint64_t *cells, const float *weights, std::size_t n) = 0;
+
+  /**
+   * @brief Copy the accumulated bins to @p interleaved.
+   *
+   * @p interleaved holds 2 * cells() values: sum of weights and sum of
+   * squared weights of each bin.  Every add() that returned before the
+   * call is included.
+   */
+  virtual void download(double *interleaved) = 0;
+};
+
+#endif // HISTDEVICESINK_H_INCLUDED
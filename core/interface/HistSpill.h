@@ -0,0 +1,86 @@
+/**
+ * @file HistSpill.h
+ * @brief Slot-local on-disk runs of histogram bins, for histograms whose
+ * slot accumulators do not fit in memory.
+ *
+ * THnMulti spills a sparse slot accumulator that outgrows its share of
+ * histFillInfo::memoryCeilingBytes to a run (histFillInfo::spillDirectory):
+ * its filled bins, sorted by linear bin index, written to a file of its
+ * own.  Every slot writes only its own runs, so spilling takes no lock.  At
+ * Finalize() the runs of all slots are merged k-way into the result, which
+ * receives each bin once, in index order.  The merge itself reads the runs
+ * in fixed-size chunks, but THnMulti adds the bins to an in-memory
+ * THnSparseF, so the result must still fit in memory.
+ *
+ * Like HistDeviceSink, the interface only uses fundamental types.
+ */
+#ifndef HISTSPILL_H_INCLUDED
+#define HISTSPILL_H_INCLUDED
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+class HistSpillRuns {
+public:
+  /// One filled bin of a run.
+  struct Cell {
+    std::uint64_t index;
+    double sumw;
+    double sumw2;
+  };
+
+  /// Most runs read at once by merge(); more are first merged in passes.
+  static constexpr std::size_t kMaxFanIn = 64;
+
+  /**
+   * @brief Runs of histogram @p name, filled by @p nSlots slots, under
+   *        @p directory (created if missing).
+   *
+   * @throws std::runtime_error if @p directory cannot be created.
+   */
+  HistSpillRuns(const std::string &directory, const std::string &name, unsigned int nSlots);
+
+  /// Removes the run files left.
+  ~HistSpillRuns();
+
+  HistSpillRuns(const HistSpillRuns &) = delete;
+  HistSpillRuns &operator=(const HistSpillRuns &) = delete;
+
+  /**
+   * @brief Sort @p cells by index and write them as a new run of @p slot.
+   *
+   * Only the thread of @p slot may call it; @p cells must not repeat an
+   * index.
+   *
+   * @throws std::runtime_error if the run cannot be written.
+   */
+  void write(unsigned int slot, std::vector<Cell> &cells);
+
+  /**
+   * @brief Merge the runs of all slots and hand every bin to @p emit.
+   *
+   * Bins are emitted once, in increasing index order, with the sums of all
+   * runs holding them.  The runs are removed.
+   *
+   * @throws std::runtime_error if a run cannot be read back.
+   */
+  void merge(const std::function<void(const Cell &)> &emit);
+
+  /// Runs written so far.
+  std::size_t runs() const;
+  /// Bytes written to runs so far.
+  std::uint64_t bytes() const;
+
+private:
+  std::string runPath(unsigned int slot, std::size_t run) const;
+
+  std::string prefix_m;
+  /// Run files of each slot; a slot only touches its own entry.
+  std::vector<std::vector<std::string>> slotRuns_m;
+  std::vector<std::uint64_t> slotBytes_m;
+};
+
+#endif // HISTSPILL_H_INCLUDED
@@ -0,0 +1,125 @@
+#ifndef HISTOGRAMPACK_H_INCLUDED
+#define HISTOGRAMPACK_H_INCLUDED
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class TH1;
+class THnBase;
+class THnSparse;
+
+/**
+ * @brief Flat binary container for the histograms of one job (``.rdfh``).
+ *
+ * An alternative to the ROOT histogram file for merging: every histogram is
+ * stored as three parallel arrays of its filled bins (linear bin index, sum
+ * of weights, sum of squared weights), sorted by bin index, and refers to a
+ * binning in a table of axis schemas shared by all histograms of the file.
+ * Merging two packs is a streaming sorted merge of those arrays, so merging
+ * thousands of job outputs is bound by reading the files rather than by
+ * ROOT deserialization.
+ *
+ * Layout (little-endian, every section 8-byte aligned, so the arrays can be
+ * used in place from a memory map):
+ * @code
+ *   char     magic[8]        "RDFHPACK"
+ *   uint32   version         1
+ *   uint32   schemaCount
+ *   uint64   histogramCount
+ *   schemaCount x {
+ *     uint32 axisCount, uint32 reserved
+ *     axisCount x { uint32 bins, uint32 reserved, float64 edges[bins + 1] }
+ *   }
+ *   histogramCount x {
+ *     uint32 schema, uint32 nameLength, uint64 entries
+ *     char   name[nameLength], zero-padded to a multiple of 8
+ *     uint64 bin[entries], float64 sum[entries], float64 sumw2[entries]
+ *   }
+ * @endcode
+ *
+ * The linear bin index counts under- and overflow bins, with the first axis
+ * running fastest: bin = b0 + (n0 + 2) * (b1 + (n1 + 2) * ...).  For one
+ * axis it is the TH1 bin number.  Histogram names are paths in the
+ * equivalent ROOT file ("dir/name").
+ */
+class HistogramPack {
+public:
+  /// Bin edges of each axis of a binning.
+  using Schema = std::vector<std::vector<double>>;
+
+  /// Filled bins of one histogram.
+  struct Histogram {
+    std::string name;
+    std::uint32_t schema = 0;
+    std::vector<std::uint64_t> bins;
+    std::vector<double> sums;
+    std::vector<double> sumw2;
+  };
+
+  /// Add @p hist (TH1, TH2 or TH3) under @p name; empty bins are skipped.
+  void add(const std::string &name, const TH1 &hist);
+  /// Add @p hist (e.g. a THnSparseF) under @p name; empty bins are skipped.
+  void add(const std::string &name, const THnBase &hist);
+
+  /**
+   * @brief Add @p other bin by bin.
+   *
+   * Histograms are matched by name; those missing here are appended.
+   * @throws std::runtime_error if histograms of the same name have
+   *         different binnings.
+   */
+  void merge(const HistogramPack &other);
+
+  /// Multiply every sum by @p factor and every sum of squares by its square.
+  void scale(double factor);
+
+  const std::vector<Schema> &schemas() const { return schemas_m; }
+  const std::vector<Histogram> &histograms() const { return histograms_m; }
+
+  /// Move the histograms out, leaving the pack without any (schemas stay).
+  std::vector<Histogram> releaseHistograms();
+
+  /// Write the pack to @p path, which is recreated.
+  void write(const std::string &path) const;
+
+  /// @throws std::runtime_error if @p path cannot be read or is not a pack.
+  static HistogramPack read(const std::string &path);
+
+  /**
+   * @brief Merge the packs @p inputs into @p output.
+   *
+   * The inputs are read one at a time.  An @p output ending in ``.root`` is
+   * written as a ROOT file (see writeRoot()).
+   * @throws std::runtime_error if there are no inputs or they cannot be
+   *         merged.
+   */
+  static void mergeFiles(const std::string &output, const std::vector<std::string> &inputs);
+
+  /// One-axis histogram as a TH1F, as NDHistogramManager writes it.
+  std::unique_ptr<TH1> toTH1(const Histogram &hist) const;
+  /// Histogram of any dimension as a THnSparseD.
+  std::unique_ptr<THnSparse> toTHnSparse(const Histogram &hist) const;
+
+  /**
+   * @brief Write every histogram to the ROOT file @p path, which is recreated.
+   *
+   * One-axis histograms become TH1F, the others THnSparseD; the directory
+   * part of each name becomes a directory of the file.
+   */
+  void writeRoot(const std::string &path) const;
+
+private:
+  std::uint32_t schemaIndex(const Schema &schema);
+  void append(Histogram hist);
+
+  std::vector<Schema> schemas_m;
+  std::vector<Histogram> histograms_m;
+  /// Position of each histogram in histograms_m, by name.
+  std::unordered_map<std::string, std::size_t> index_m;
+};
+
+#endif // HISTOGRAMPACK_H_INCLUDED
@@ -0,0 +1,89 @@
+#ifndef INPUTSTAGINGCACHE_H_INCLUDED
+#define INPUTSTAGINGCACHE_H_INCLUDED
+
+#include <RtypesCore.h>
+#include <string>
+#include <unordered_map>
+
+/**
+ * @brief Node-local cache of remote input files.
+ *
+ * Entries are addressed by the TMD5 of the file's logical file name, so the
+ * same file reached through different redirectors is copied once. Logical
+ * file names are write-once, which makes the name a stable content address.
+ *
+ * The cache directory may be shared by concurrent jobs: each entry is copied
+ * under an exclusive flock() of its own lock file, so a second job asking for
+ * the same file waits for the copy instead of starting another one, and
+ * insertion and eviction hold a directory-wide lock. Hits refresh the entry's
+ * modification time; when an insertion would exceed the size limit the least
+ * recently used entries are removed first, together with their lock files.
+ *
+ * Every entry returned by stage() is pinned with a shared flock() until the
+ * cache object is destroyed, so files staged up front stay in place until the
+ * job opens them. Eviction skips pinned entries and entries being staged; when
+ * they leave no room, stage() returns the remote URL.
+ */
+class InputStagingCache {
+public:
+  /**
+   * @param directory Cache directory (created if missing)
+   * @param maxBytes Size limit of all cached entries
+   */
+  InputStagingCache(std::string directory, Long64_t maxBytes);
+  /// Releases the pins of the staged entries.
+  virtual ~InputStagingCache();
+
+  InputStagingCache(const InputStagingCache &) = delete;
+  InputStagingCache &operator=(const InputStagingCache &) = delete;
+
+  /// Whether @p url is read over the network (has a scheme other than file://).
+  static bool isRemote(const std::string &url);
+
+  /// Cache key of @p url (TMD5 of its logical file name).
+  static std::string cacheKey(const std::string &url);
+
+  /// Path of the cache entry for @p url (whether or not it exists).
+  std::string entryPath(const std::string &url) const;
+
+  /**
+   * @brief Return a local copy of @p url, copying it into the cache first when
+   * it is not cached yet.
+   * @return The cache entry, pinned for the lifetime of this object, or
+   *         @p url itself when it could not be staged (copy failure, or no
+   *         room left by the size limit and the pinned entries)
+   */
+  std::string stage(const std::string &url);
+
+  /// Total size of the cached entries in bytes.
+  Long64_t cachedBytes() const;
+
+  /// Number of stage() calls served from an existing entry.
+  unsigned int hits() const { return hits_m; }
+  /// Number of stage() calls that copied the file into the cache.
+  unsigned int misses() const { return misses_m; }
+
+protected:
+  /// Copy @p source to the local path @p destination (TFile::Cp by default).
+  virtual bool copyFile(const std::string &source, const std::string &destination);
+
+private:
+  /**
+   * @brief Remove least recently used entries that are neither pinned nor
+   *        being staged until @p incomingBytes fit.
+   * @return Whether @p incomingBytes fit afterwards
+   */
+  bool evictFor(Long64_t incomingBytes, const std::string &keep);
+
+  /// Hold a shared flock() on @p entry until destruction.
+  void pin(const std::string &entry);
+
+  std::string directory_m;
+  Long64_t maxBytes_m;
+  unsigned int hits_m = 0;
+  unsigned int misses_m = 0;
+  /// Open descriptors of the pinned entries, by entry path.
+  std::unordered_map<std::string, int> pins_m;
+};
+
+#endif // INPUTSTAGINGCACHE_H_INCLUDED
@@ -0,0 +1,219 @@
+/**
+ * @file JitCache.h
+ * @brief Cache of compiled JIT Define expressions shared between jobs.
+ *
+ * Every string expression defined through
+ * IDataFrameProvider::defineExpression() (DefineVector fallbacks,
+ * WeightManager products, region masks, the Python DefineJIT/FilterJIT) is
+ * identified by a hash of its text, its input columns and their types and
+ * the ROOT version.  With ``jitCacheDir`` set, an expression found in the
+ * cache index is defined from a typed lambda in a precompiled library, so
+ * Cling never sees it; other expressions are JIT-compiled as usual and
+ * remembered.  With ``jitCacheBuild=true`` the remembered expressions are
+ * compiled into a new library of the cache at the end of the job.
+ *
+ * A production fills the cache once (for example from its local test job)
+ * and ships the directory with the job sandbox; the batch jobs only read it.
+ *
+ * Ahead of time, ``jitExportFile`` writes the expressions of a job as a C++
+ * translation unit that registers them with registerCompiled(); compiled
+ * into the analysis executable (``rdf_add_compiled_expressions()`` in
+ * CMake) they are optimised with the rest of the analysis and found before
+ * any cache library.
+ *
+ * Generated functions (e.g. the compiled correctionlib kernels of
+ * CorrectionManager) go through the same cache with function(): they are
+ * keyed by a hash of their source and declared to the JIT compiler only
+ * when neither the executable nor the cache has them.
+ */
+#ifndef JITCACHE_H_INCLUDED
+#define JITCACHE_H_INCLUDED
+
+#include <ROOT/RDataFrame.hxx>
+
+#include <cstddef>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+/**
+ * @class JitCache
+ * @brief Index of precompiled Define expressions in a cache directory.
+ */
+class JitCache {
+public:
+  /// Entry point defining one expression on a dataframe under a name.
+  using DefineFn = void (*)(ROOT::RDF::RNode *, const std::string *);
+
+  /// Name of the index file in the cache directory.
+  static constexpr const char *kIndexFile = "index.txt";
+
+  /**
+   * @brief Placeholder name of the entry point in a function() source.
+   *
+   * Every occurrence is replaced by the unique symbol of the source, so
+   * helpers may be named after it (e.g. a namespace
+   * ``rdfjit_function_detail``) without clashing with other functions.
+   */
+  static constexpr const char *kFunctionName = "rdfjit_function";
+
+  /// A string expression with the inputs it reads.
+  struct Expression {
+    std::string expression;
+    /// Columns the expression reads, in order of first use.
+    std::vector<std::string> columns;
+    /// Types of @c columns, as reported by the dataframe.
+    std::vector<std::string> types;
+    /// Content hash identifying the expression in the cache.
+    std::string key;
+  };
+
+  /// A self-contained C++ source defining an ``extern "C"`` function.
+  struct Function {
+    /// Source with the entry point named kFunctionName.
+    std::string source;
+    /// Content hash identifying the function in the cache.
+    std::string key;
+  };
+
+  /**
+   * @param directory Cache directory; created when @p build is set. May be
+   *                  empty to use only the expressions of registerCompiled().
+   * @param build     Whether build() may add a library to the cache.
+   * @throws std::runtime_error if the index exists but cannot be read.
+   */
+  JitCache(std::string directory, bool build);
+
+  JitCache(const JitCache &) = delete;
+  JitCache &operator=(const JitCache &) = delete;
+
+  /**
+   * @brief Define @p name on @p df from @p expression, from the cache when
+   *        it holds the expression and with the JIT compiler otherwise.
+   */
+  ROOT::RDF::RNode define(ROOT::RDF::RNode df, const std::string &name,
+                          const std::string &expression);
+
+  /**
+   * @brief Address of the entry point of @p source (see kFunctionName),
+   *        compiled in, from the cache or declared to the JIT compiler.
+   *
+   * A function missing in the cache is remembered for build() and the
+   * export like a missed expression.
+   *
+   * @return nullptr if the JIT compiler rejects @p source.
+   */
+  void *function(const std::string &source);
+
+  /**
+   * @brief Like function(), for a job without a cache: compiled in or
+   *        declared to the JIT compiler.
+   *
+   * Each source is declared once per process.
+   */
+  static void *declareFunction(const std::string &source);
+
+  /// Expressions and functions defined from the cache.
+  std::size_t hits() const { return hits_m; }
+  /// Expressions that were JIT-compiled, in order of definition (also
+  /// after build() added them to the cache).
+  const std::vector<Expression> &missed() const { return missed_m; }
+  /// Every cacheable expression defined, hit or missed, in order of definition.
+  const std::vector<Expression> &defined() const { return defined_m; }
+  /// Functions that were declared to the JIT compiler.
+  const std::vector<Function> &missedFunctions() const { return missedFunctions_m; }
+
+  /**
+   * @brief Compile the missed expressions and functions not yet in the
+   *        cache into a library of the cache.
+   *
+   * They are compiled together; if that fails (e.g. an expression uses a
+   * function the library cannot see) each is compiled on its own and the
+   * ones that fail are left to the JIT compiler.
+   *
+   * @return Number of expressions and functions added to the cache.
+   * @throws std::runtime_error if the cache was not opened for building.
+   */
+  std::size_t build();
+
+  /**
+   * @brief Columns among @p available that @p expression reads, in order
+   *        of first use.
+   *
+   * Identifiers inside string literals or following ``.``, ``->`` or
+   * ``::`` are not column references.
+   */
+  static std::vector<std::string> inputColumns(const std::string &expression,
+                                               const std::vector<std::string> &available);
+
+  /**
+   * @brief Inputs, types and key of @p expression on @p df.
+   *
+   * @return An expression with an empty key when it cannot be cached
+   *         (it reads columns whose names are not C++ identifiers).
+   */
+  static Expression describe(ROOT::RDF::RNode &df, const std::string &expression);
+
+  /// Key and renamed source of the function() source @p source.
+  static Function describeFunction(const std::string &source);
+
+  /// C++ source of a cache library defining @p expressions and @p functions.
+  static std::string generateSource(const std::vector<Expression> &expressions,
+                                    const std::vector<Function> &functions = {});
+
+  /**
+   * @brief C++ translation unit that defines @p expressions and
+   *        @p functions and registers them with registerCompiled() during
+   *        static initialisation.
+   */
+  static std::string generateTranslationUnit(const std::vector<Expression> &expressions,
+                                             const std::vector<Function> &functions = {});
+
+  /**
+   * @brief Write generateTranslationUnit() of the expressions and functions
+   *        defined by this job to @p path.
+   *
+   * @return Number of expressions and functions written.
+   * @throws std::runtime_error if @p path cannot be written.
+   */
+  std::size_t exportTranslationUnit(const std::string &path) const;
+
+  /// Register the compiled-in entry point of expression @p key.
+  static void registerCompiled(const std::string &key, DefineFn fn);
+  /// Register the compiled-in address of function @p key.
+  static void registerCompiled(const std::string &key, void *function);
+  /// Number of expressions and functions registered with registerCompiled().
+  static std::size_t compiledCount();
+
+private:
+  /// Symbol @p symbol of the cache library holding @p key (loaded on first
+  /// use); nullptr if absent.
+  void *lookupLibrary(const std::string &key, const std::string &symbol);
+  /// Entry point of @p key, compiled in or from a cache library; nullptr
+  /// if absent.
+  DefineFn lookup(const std::string &key);
+  /// Compile @p expressions and @p functions into one library; returns
+  /// false on failure.
+  bool compile(const std::vector<Expression> &expressions,
+               const std::vector<Function> &functions);
+
+  std::string directory_m;
+  bool build_m;
+  /// Expression key -> library file name, from the index.
+  std::map<std::string, std::string> index_m;
+  /// Loaded libraries by file name; never unloaded, as the dataframe keeps
+  /// their callables.
+  std::map<std::string, void *> libraries_m;
+  std::vector<Expression> missed_m;
+  std::vector<Expression> defined_m;
+  std::set<std::string> definedKeys_m;
+  std::set<std::string> missedKeys_m;
+  std::vector<Function> definedFunctions_m;
+  std::vector<Function> missedFunctions_m;
+  std::set<std::string> definedFunctionKeys_m;
+  std::set<std::string> missedFunctionKeys_m;
+  std::size_t hits_m = 0;
+};
+
+#endif // JITCACHE_H_INCLUDED
@@ -0,0 +1,49 @@
+/**
+ * @file JsonString.h
+ * @brief Quoting of strings for the JSON reports written by the services.
+ */
+#ifndef JSONSTRING_H_INCLUDED
+#define JSONSTRING_H_INCLUDED
+
+#include <cstdio>
+#include <string>
+
+/**
+ * @brief @p value as a JSON string literal, quotes included.
+ *
+ * Quotes and backslashes are escaped, newlines and tabs become @c \\n and
+ * @c \\t, and the other control characters @c \\u00XX.
+ */
+inline std::string jsonString(const std::string &value) {
+  std::string out;
+  out.reserve(value.size() + 2);
+  out += '"';
+  for (const char c : value) {
+    switch (c) {
+    case '"':
+      out += "\\\"";
+      break;
+    case '\\':
+      out += "\\\\";
+      break;
+    case '\n':
+      out += "\\n";
+      break;
+    case '\t':
+      out += "\\t";
+      break;
+    default:
+      if (static_cast<unsigned char>(c) < 0x20) {
+        char escaped[7];
+        std::snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned int>(c));
+        out += escaped;
+      } else {
+        out += c;
+      }
+    }
+  }
+  out += '"';
+  return out;
+}
+
+#endif // JSONSTRING_H_INCLUDED
@@ -6,7 +6,9 @@
 
 class IConfigurationProvider;
 class IDataFrameProvider;
+class IOutputSink;
 class ISystematicManager;
+enum class OutputChannel;
 
 /**
  * @brief Factory class for creating manager instances
@@ -33,11 +35,29 @@ public:
 
     /**
      * @brief Create a data manager instance
+     *
+     * With ``mpi=true`` the config is first set up for this MPI rank
+     * (see MpiRuntime::configure()).
+     *
      * @param configProvider Reference to the configuration provider
      * @return Unique pointer to the dataframe provider interface
      */
     static std::unique_ptr<IDataFrameProvider> createDataManager(
         IConfigurationProvider& configProvider);
+
+    /**
+     * @brief Create the output sink for one output channel
+     *
+     * Reads ``skimOutputFormat`` (Skim) or ``metaOutputFormat`` (Meta):
+     * ``root`` (default) creates a RootOutputSink, ``rntuple`` an
+     * RNTupleOutputSink configured from the ``rntupleCompression*`` keys.
+     *
+     * @param configProvider Reference to the configuration provider
+     * @param channel Output channel the sink is used for
+     * @return Unique pointer to the output sink interface
+     */
+    static std::unique_ptr<IOutputSink> createOutputSink(
+        const IConfigurationProvider& configProvider, OutputChannel channel);
 };
 
 #endif // MANAGERFACTORY_H_INCLUDED 
\ No newline at end of file
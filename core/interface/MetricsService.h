@@ -0,0 +1,142 @@
+#ifndef METRICSSERVICE_H_INCLUDED
+#define METRICSSERVICE_H_INCLUDED
+
+#include "api/IAnalysisService.h"
+#include <ROOT/RResultPtr.hxx>
+#include <RtypesCore.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief Analysis service publishing live metrics of the event loop.
+ *
+ * Enabled by the ``metricsFile`` config key.  An action booked before any
+ * filter counts the entries of every slot and records the input file each
+ * slot reads, the same per-slot hook the RDataFrame progress bar uses.  A
+ * writer thread replaces ``metricsFile`` every ``metricsInterval`` seconds
+ * (default 10) with a snapshot of
+ *
+ *  - the entries processed and the event rate, in total and per slot,
+ *  - the input read rate (TFile bytes read),
+ *  - the resident set size of the process,
+ *  - the input file of every slot,
+ *  - the time of the last processed entry,
+ *
+ * as JSON (``metricsFormat=json``, default) or in the Prometheus text
+ * exposition format (``metricsFormat=prometheus``, e.g. for the node
+ * exporter's textfile collector).  The file is written next to its target
+ * and renamed over it, so readers never see a partial snapshot.
+ *
+ * A job whose file stops changing has died; one whose last processed entry
+ * stops moving is stalled.  production_monitor.py's ``live`` command reports
+ * both.
+ */
+class MetricsService : public IAnalysisService {
+public:
+  /// State of the job, as reported in the snapshots.
+  enum class State { Setup, Running, Finished };
+
+  /// One set of metrics, as written to the metrics file.
+  struct Snapshot {
+    State state = State::Setup;
+    /// Unix time of the snapshot and of the last processed entry (0: none).
+    double timestamp = 0.0;
+    double lastProgress = 0.0;
+    /// Seconds since the first entry.
+    double loopSeconds = 0.0;
+    std::uint64_t entries = 0;
+    /// Rates over the interval since the previous snapshot.
+    double eventsPerSecond = 0.0;
+    std::vector<double> slotEventsPerSecond;
+    /// Mean rate since the first entry.
+    double meanEventsPerSecond = 0.0;
+    std::uint64_t bytesRead = 0;
+    double readMBPerSecond = 0.0;
+    double rssMB = 0.0;
+    /// Input file of every slot ("" before its first entry).
+    std::vector<std::string> slotFiles;
+  };
+
+  MetricsService() = default;
+  MetricsService(const MetricsService &) = delete;
+  MetricsService &operator=(const MetricsService &) = delete;
+  ~MetricsService() override;
+
+  /**
+   * @brief Book the loop monitor and start the writer thread.
+   * @throws std::runtime_error if metricsFile is unset, or metricsFormat or
+   *         metricsInterval is invalid
+   */
+  void initialize(ManagerContext &ctx) override;
+
+  /// Stop the writer and write the final snapshot; a write error is logged.
+  void finalize(ROOT::RDF::RNode &df) override;
+
+  /// Take a snapshot now; rates cover the time since the previous one.
+  Snapshot snapshot();
+
+  /// Write @p snapshot to the metrics file in the configured format.
+  void write(const Snapshot &snapshot) const;
+
+  static std::string formatJson(const Snapshot &snapshot);
+  static std::string formatPrometheus(const Snapshot &snapshot);
+
+  /// Current resident set size of the process in MB (0 if unknown).
+  static double currentRssMegabytes();
+
+  /**
+   * @brief Provenance: "service.metrics.file" and "service.metrics.format".
+   */
+  std::unordered_map<std::string, std::string>
+  collectProvenanceEntries() const override;
+
+  /// Progress shared with the booked action.
+  struct Progress {
+    explicit Progress(unsigned int nSlots) : slots(nSlots), files(nSlots) {}
+    /// One cache line per slot; only the slot's thread writes its counter.
+    struct alignas(64) Slot {
+      std::atomic<std::uint64_t> entries{0};
+    };
+    std::vector<Slot> slots;
+    std::mutex filesMutex;
+    std::vector<std::string> files;
+    /// Steady-clock nanoseconds of the start and end of the loop (0: not yet).
+    std::atomic<std::int64_t> startNs{0};
+    std::atomic<std::int64_t> endNs{0};
+  };
+
+private:
+  void writerLoop();
+  void stopWriter();
+
+  ManagerContext *ctx_m = nullptr;
+  std::string path_m;
+  bool prometheus_m = false;
+  std::chrono::milliseconds interval_m{10000};
+  std::shared_ptr<Progress> progress_m;
+  ROOT::RDF::RResultPtr<ULong64_t> result_m;
+
+  /// Values of the previous snapshot, for the interval rates.
+  std::mutex snapshotMutex_m;
+  std::chrono::steady_clock::time_point previousTime_m;
+  std::vector<std::uint64_t> previousSlotEntries_m;
+  Long64_t previousBytes_m = 0;
+  Long64_t bytesAtStart_m = 0;
+  std::uint64_t lastEntries_m = 0;
+  double lastProgress_m = 0.0;
+
+  std::thread writer_m;
+  std::mutex writerMutex_m;
+  std::condition_variable writerWake_m;
+  bool stop_m = false;
+};
+
+#endif // METRICSSERVICE_H_INCLUDED
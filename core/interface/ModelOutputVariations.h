@@ -0,0 +1,103 @@
+#ifndef MODELOUTPUTVARIATIONS_H_INCLUDED
+#define MODELOUTPUTVARIATIONS_H_INCLUDED
+
+#include <api/IDataFrameProvider.h>
+#include <api/ISystematicManager.h>
+
+#include <ROOT/RVec.hxx>
+#include <RtypesCore.h>
+
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Define an ML model output column and its systematic variations,
+ *        reusing the nominal output where the model input is unchanged.
+ *
+ * @p evaluate is called as evaluate(input, runFlag, rdfentry_) and returns
+ * the model output of type @p T.  Only systematics that vary @p inputColumn
+ * or @p runColumn get Up/Down columns; consumers of any other (for example
+ * weight-only) systematic resolve to the nominal output.  A variation column
+ * also reads the nominal input, run flag and output, and returns the nominal
+ * output for events whose varied input and run flag equal the nominal ones,
+ * so the model only runs where the variation actually changes its input.
+ * Variation columns are offered to IDataFrameProvider::deferColumn() like
+ * those of IDataFrameProvider::Define(), and every column goes through
+ * IDataFrameProvider::defineColumn(), so it is gated, timed and reports its
+ * reads.
+ *
+ * @return Number of variation columns declared (Up and Down counted apart).
+ */
+template <typename T, typename F>
+std::size_t defineModelOutput(IDataFrameProvider &dataManager,
+                              ISystematicManager &systematicManager,
+                              const std::string &name, F evaluate,
+                              const std::string &inputColumn,
+                              const std::string &runColumn) {
+  if (dataManager.hasColumn(name)) {
+    return 0;
+  }
+
+  auto nominalLambda = [evaluate](const ROOT::VecOps::RVec<Float_t> &input, bool run,
+                                  ULong64_t entry) -> T {
+    return evaluate(input, run, entry);
+  };
+  dataManager.updateDataFrame(
+      dataManager.defineColumn(dataManager.getDataFrame(), name, nominalLambda,
+                               {inputColumn, runColumn, "rdfentry_"}),
+      {name});
+
+  auto aliasLambda = [evaluate](const ROOT::VecOps::RVec<Float_t> &input, bool run,
+                                const ROOT::VecOps::RVec<Float_t> &nominalInput,
+                                bool nominalRun, const T &nominalOutput,
+                                ULong64_t entry) -> T {
+    if (run == nominalRun && input.size() == nominalInput.size() &&
+        std::memcmp(input.data(), nominalInput.data(),
+                    input.size() * sizeof(Float_t)) == 0) {
+      return nominalOutput;
+    }
+    return evaluate(input, run, entry);
+  };
+
+  std::size_t nVariations = 0;
+  const std::vector<std::string> systList(systematicManager.getSystematics().begin(),
+                                          systematicManager.getSystematics().end());
+  for (const auto &syst : systList) {
+    bool affected = false;
+    std::vector<std::pair<std::string, std::vector<std::string>>> variations;
+    for (const std::string direction : {"Up", "Down"}) {
+      const auto variation = syst + direction;
+      const auto input = systematicManager.resolveVariationColumnName(inputColumn, variation);
+      const auto run = systematicManager.resolveVariationColumnName(runColumn, variation);
+      affected = affected || input != inputColumn || run != runColumn;
+      variations.push_back({name + "_" + variation,
+                            {input, run, inputColumn, runColumn, name, "rdfentry_"}});
+    }
+    if (!affected) {
+      continue;
+    }
+    auto df = dataManager.getDataFrame();
+    std::vector<std::string> added;
+    for (const auto &[variedName, columns] : variations) {
+      if (dataManager.hasColumn(variedName)) {
+        continue;
+      }
+      auto define = [&dataManager, variedName = variedName, columns = columns,
+                     aliasLambda](ROOT::RDF::RNode node) {
+        return dataManager.defineColumn(node, variedName, aliasLambda, columns);
+      };
+      if (!dataManager.deferColumn(variedName, columns, define)) {
+        df = define(df);
+        added.push_back(variedName);
+      }
+      ++nVariations;
+    }
+    dataManager.updateDataFrame(df, added);
+    systematicManager.registerSystematic(syst, {name});
+  }
+  return nVariations;
+}
+
+#endif // MODELOUTPUTVARIATIONS_H_INCLUDED
@@ -0,0 +1,116 @@
+#ifndef MODELREGISTRY_H_INCLUDED
+#define MODELREGISTRY_H_INCLUDED
+
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <typeinfo>
+#include <unordered_map>
+
+/**
+ * @brief Process-wide registry of loaded correction sets and models.
+ *
+ * Plugins that load the same file (CorrectionManager, MuonRochesterManager,
+ * BDTManager, OnnxManager, ...) share one parsed object instead of parsing it
+ * again.  Entries are keyed by the object type, the MD5 digest of the file
+ * contents and a loader-specific variant string (feature list, session
+ * options), so a file rewritten under the same path is reloaded and two
+ * copies of a file under different paths are shared.
+ *
+ * Loaded objects stay in the registry until clear(): plugins often keep only
+ * parts of a set (a correction::Correction::Ref), so the set would otherwise
+ * be parsed again by the next plugin.  Loads run outside the registry lock,
+ * so different objects load concurrently; a second request for an object
+ * being loaded waits for that load, so the file is parsed once.
+ *
+ * Available through ManagerContext::models; plugins constructed before the
+ * context is injected use instance().
+ */
+class ModelRegistry {
+public:
+  /// The registry shared by all plugins of the process.
+  static ModelRegistry &instance();
+
+  /**
+   * @brief Return the object loaded from @p file, loading it with @p load on
+   *        first use.
+   * @param variant Distinguishes objects of the same file built with
+   *        different settings.
+   * @param load Callable returning std::shared_ptr<T> (or std::unique_ptr<T>).
+   *        Files that cannot be read for hashing are loaded uncached, so the
+   *        loader reports the error.
+   */
+  template <typename T, typename Loader>
+  std::shared_ptr<T> get(const std::string &file, const std::string &variant, Loader &&load) {
+    std::unique_lock<std::mutex> lock(mutex_m);
+    const std::string digest = contentHashLocked(file);
+    if (digest.empty()) {
+      lock.unlock();
+      return std::shared_ptr<T>(load());
+    }
+    const std::string key = std::string(typeid(T).name()) + '\n' + digest + '\n' + variant;
+    if (auto it = entries_m.find(key); it != entries_m.end()) {
+      ++hits_m;
+      return std::static_pointer_cast<T>(it->second);
+    }
+    if (auto it = loading_m.find(key); it != loading_m.end()) {
+      ++hits_m;
+      auto pending = it->second;
+      lock.unlock();
+      return std::static_pointer_cast<T>(pending.get());
+    }
+    std::promise<std::shared_ptr<void>> promise;
+    loading_m.emplace(key, promise.get_future().share());
+    lock.unlock();
+
+    std::shared_ptr<T> loaded;
+    try {
+      loaded = std::shared_ptr<T>(load());
+    } catch (...) {
+      lock.lock();
+      loading_m.erase(key);
+      promise.set_exception(std::current_exception());
+      throw;
+    }
+    lock.lock();
+    entries_m[key] = loaded;
+    loading_m.erase(key);
+    ++loads_m;
+    promise.set_value(loaded);
+    return loaded;
+  }
+
+  /// MD5 digest of @p file's contents; empty if it cannot be read.  Cached
+  /// per path until the file's size or modification time changes.
+  std::string contentHash(const std::string &file);
+
+  /// Drop all loaded objects; plugins keep the ones they hold.
+  void clear();
+
+  /// Number of objects loaded / served from the registry so far.
+  std::size_t loads() const;
+  std::size_t hits() const;
+
+private:
+  struct FileDigest {
+    std::uintmax_t size = 0;
+    std::int64_t mtime = 0;
+    std::string digest;
+  };
+
+  std::string contentHashLocked(const std::string &file);
+
+  mutable std::mutex mutex_m;
+  std::unordered_map<std::string, std::shared_ptr<void>> entries_m;
+  /// Objects being loaded, by key.
+  std::unordered_map<std::string, std::shared_future<std::shared_ptr<void>>> loading_m;
+  std::unordered_map<std::string, FileDigest> digests_m;
+  std::size_t loads_m = 0;
+  std::size_t hits_m = 0;
+};
+
+#endif // MODELREGISTRY_H_INCLUDED
@@ -0,0 +1,80 @@
+#ifndef MPIRUNTIME_H_INCLUDED
+#define MPIRUNTIME_H_INCLUDED
+
+#include <cstdint>
+#include <string>
+#include <utility>
+
+class IConfigurationProvider;
+
+/**
+ * @brief Runs one job over the ranks of an MPI launch.
+ *
+ * With ``mpi=true``, ``mpirun -n N <analysis> config.txt`` starts N copies
+ * of the executable that split the job between them:
+ *  - every rank processes a contiguous slice of the input entries (of the
+ *    ``firstEntry``/``lastEntry`` window when the job is already an entry
+ *    range), applied like an entry range by DataManager;
+ *  - every rank writes its meta output (histograms, cutflows, counters,
+ *    provenance) to a node-local scratch file (``mpiScratchDir``, default
+ *    ``$TMPDIR`` or ``/tmp``);
+ *  - at the end of Analyzer::run() the ranks read those files back and
+ *    tree-reduce them over MPI, adding objects key by key as OutputMerger
+ *    does, and only rank 0 writes the configured ``metaFile``.
+ *
+ * Skims are per-event data and are not reduced: each rank writes
+ * ``<saveFile stem>.rank<r>.root``, and ``metaFile`` must then differ from
+ * ``saveFile``.  Only the main thread calls MPI.
+ *
+ * Requires a build with ``-DUSE_MPI=ON`` (``HAS_MPI``); otherwise
+ * ``mpi=true`` throws.  Without ``mpi=true`` nothing changes, and a single
+ * rank behaves like a plain run.
+ */
+class MpiRuntime {
+public:
+  /**
+   * @brief Initialize MPI and redirect the outputs of this rank when
+   *        @p config sets ``mpi=true``.
+   *
+   * Called by ManagerFactory::createDataManager() before the DataManager
+   * reads the config.  MPI is initialized once per process and finalized
+   * at exit, unless the executable initialized it itself.
+   *
+   * @throws std::runtime_error without MPI support, or if a skim would
+   *         share its file with the reduced meta output
+   */
+  static void configure(IConfigurationProvider &config);
+
+  /// True once configure() initialized MPI.
+  static bool active();
+
+  /// Rank of this process (0 unless active).
+  static int rank();
+
+  /// Number of ranks (1 unless active).
+  static int size();
+
+  /**
+   * @brief Slice of ``[first, last)`` processed by @p rank of @p size.
+   *
+   * Slices are contiguous, in rank order, and differ by at most one entry.
+   */
+  static std::pair<std::uint64_t, std::uint64_t>
+  partition(std::uint64_t first, std::uint64_t last, int rank, int size);
+
+  /// @p path with ``.rank<rank>`` inserted before its extension.
+  static std::string rankPath(const std::string &path, int rank);
+
+  /**
+   * @brief Reduce the meta outputs of all ranks into the configured file.
+   *
+   * Collective: every rank must call it, after its outputs are written.
+   * Does nothing when configure() did not distribute @p config.
+   *
+   * @throws std::runtime_error on every rank if any rank fails to read,
+   *         add or write the outputs
+   */
+  static void reduceOutputs(const IConfigurationProvider &config);
+};
+
+#endif // MPIRUNTIME_H_INCLUDED
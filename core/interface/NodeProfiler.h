@@ -0,0 +1,314 @@
+/**
+ * @file NodeProfiler.h
+ * @brief Per-node, per-plugin timing of the Define and Filter callables of
+ *        the event loop.
+ *
+ * With ``profileNodes=true`` every Define, Redefine and Filter registered
+ * through IDataFrameProvider is wrapped in a callable that times each call
+ * and adds the result to a counter of the processing slot.  Nodes are
+ * attributed to the plugin role that registered them (see
+ * NodeProfiler::OwnerScope); nodes defined by analysis code belong to
+ * ``analysis``.  The counters are written to ``nodeProfileReport`` after
+ * the event loop, so that the most expensive nodes of a large graph can be
+ * found without an external profiler.
+ *
+ * With ``profileAllocations=true`` the wrappers also count the heap
+ * allocations of each call (see AllocationTracker), and the allocations of
+ * every event loop task are summed per slot, so that what the nodes do not
+ * account for (actions such as histogram fills and skims, reading, the
+ * RDataFrame machinery) is reported as ``framework``.
+ *
+ * Disabled, the profiler is never created and the registered callables are
+ * passed to RDataFrame unchanged.
+ */
+#ifndef NODEPROFILER_H_INCLUDED
+#define NODEPROFILER_H_INCLUDED
+
+#include <AllocationTracker.h>
+#include <ROOT/TypeTraits.hxx>
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * @class NodeProfiler
+ * @brief Slot-local call and time counters of instrumented dataframe nodes.
+ *
+ * RDataFrame processes an entry of a slot on a single thread, so each slot
+ * updates its own counter without synchronisation; the counters of a node
+ * sit on separate cache lines so that slots do not share them.
+ */
+class NodeProfiler {
+public:
+  /// Owner of nodes registered outside any OwnerScope.
+  static constexpr const char *kDefaultOwner = "analysis";
+
+  /// Calls, accumulated time and allocations of one node in one slot.
+  struct alignas(64) SlotCounter {
+    std::uint64_t calls = 0;
+    std::uint64_t nanoseconds = 0;
+    std::uint64_t allocations = 0;
+    std::uint64_t bytes = 0;
+  };
+
+  /// Entries and allocations of the event loop tasks of one slot.
+  struct alignas(64) SlotTasks {
+    std::uint64_t entries = 0;
+    AllocationTracker::Counts counts;
+  };
+
+  /// One instrumented node.
+  struct Node {
+    std::string name;
+    /// "define", "redefine" or "filter".
+    std::string kind;
+    /// Plugin role (or kDefaultOwner) that registered the node.
+    std::string owner;
+    std::vector<SlotCounter> slots;
+
+    void record(unsigned int slot, std::uint64_t nanoseconds) {
+      if (slot < slots.size()) {
+        ++slots[slot].calls;
+        slots[slot].nanoseconds += nanoseconds;
+      }
+    }
+
+    void recordAllocations(unsigned int slot, const AllocationTracker::Counts &counts) {
+      if (slot < slots.size()) {
+        slots[slot].allocations += counts.allocations;
+        slots[slot].bytes += counts.bytes;
+      }
+    }
+  };
+
+  /// Summed counters of one node, as reported.
+  struct Entry {
+    std::string name;
+    std::string kind;
+    std::string owner;
+    std::uint64_t calls = 0;
+    std::uint64_t nanoseconds = 0;
+    std::uint64_t allocations = 0;
+    std::uint64_t bytes = 0;
+  };
+
+  /**
+   * @brief Sets the owner of the nodes registered while it is alive and
+   *        restores the previous owner afterwards.
+   */
+  class OwnerScope {
+  public:
+    OwnerScope(NodeProfiler *profiler, const std::string &owner) : profiler_m(profiler) {
+      if (profiler_m) {
+        previous_m = std::exchange(profiler_m->owner_m, owner);
+      }
+    }
+    ~OwnerScope() {
+      if (profiler_m) {
+        profiler_m->owner_m = std::move(previous_m);
+      }
+    }
+    OwnerScope(const OwnerScope &) = delete;
+    OwnerScope &operator=(const OwnerScope &) = delete;
+
+  private:
+    NodeProfiler *profiler_m;
+    std::string previous_m;
+  };
+
+  /**
+   * @brief Times one call of a node on a slot, and counts its allocations,
+   *        from construction to destruction.  A null node makes it a no-op.
+   */
+  class Call {
+  public:
+    Call(Node *node, unsigned int slot, bool allocations)
+        : node_m(node), slot_m(slot), allocations_m(node != nullptr && allocations) {
+      if (node_m) {
+        if (allocations_m) {
+          before_m = AllocationTracker::threadCounts();
+        }
+        start_m = std::chrono::steady_clock::now();
+      }
+    }
+    ~Call() {
+      if (node_m) {
+        const auto elapsed = std::chrono::steady_clock::now() - start_m;
+        node_m->record(slot_m, static_cast<std::uint64_t>(
+                                   std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed)
+                                       .count()));
+        if (allocations_m) {
+          node_m->recordAllocations(slot_m, AllocationTracker::threadCounts() - before_m);
+        }
+      }
+    }
+    Call(const Call &) = delete;
+    Call &operator=(const Call &) = delete;
+
+  private:
+    Node *node_m;
+    unsigned int slot_m;
+    bool allocations_m;
+    AllocationTracker::Counts before_m;
+    std::chrono::steady_clock::time_point start_m;
+  };
+
+  /// @param nSlots Number of processing slots of the dataframe.
+  explicit NodeProfiler(unsigned int nSlots)
+      : nSlots_m(nSlots == 0 ? 1 : nSlots), tasks_m(nSlots_m) {}
+
+  NodeProfiler(const NodeProfiler &) = delete;
+  NodeProfiler &operator=(const NodeProfiler &) = delete;
+
+  /// Current owner of newly registered nodes.
+  const std::string &owner() const { return owner_m; }
+
+  /**
+   * @brief Count the allocations of the nodes registered from now on.
+   *
+   * Enables AllocationTracker.
+   * @return false when AllocationTracker cannot count in this process.
+   */
+  bool trackAllocations();
+  bool tracksAllocations() const { return trackAllocations_m; }
+
+  /// Add the entries and allocations of one event loop task of @p slot.
+  void recordTask(unsigned int slot, std::uint64_t entries,
+                  const AllocationTracker::Counts &counts) {
+    if (slot < tasks_m.size()) {
+      tasks_m[slot].entries += entries;
+      tasks_m[slot].counts += counts;
+    }
+  }
+
+  /// Entries and allocations of all recorded tasks.
+  SlotTasks taskTotals() const;
+
+  /// Zero the task counters and the allocation counters of every node, so
+  /// that they cover the next event loop only (call times are kept).
+  void resetAllocations();
+
+  /**
+   * @brief Whether @p F can be wrapped for @p nColumns input columns.
+   *
+   * The wrapper takes the slot from the ``rdfslot_`` column in front of the
+   * inputs, so it needs the columns explicitly: callables that rely on the
+   * dataframe's default columns are not instrumented.
+   */
+  template <typename F> static bool canWrap(std::size_t nColumns) {
+    using Args = typename ROOT::TypeTraits::CallableTraits<F>::arg_types_nodecay;
+    return Args::list_size == nColumns;
+  }
+
+  /**
+   * @brief Register a node and return @p f wrapped to time its calls.
+   *
+   * The wrapper has the signature of @p f with a leading ``unsigned int``
+   * slot; pass ``rdfslot_`` as its first column (see slotColumns()).
+   */
+  template <typename F> auto wrap(const std::string &name, const std::string &kind, F f) {
+    using Traits = ROOT::TypeTraits::CallableTraits<F>;
+    return timed<typename Traits::ret_type>(std::move(f), addNode(name, kind),
+                                            trackAllocations_m,
+                                            typename Traits::arg_types_nodecay());
+  }
+
+  /**
+   * @brief Register a node for callables that time themselves with a Call
+   *        (the precompiled DefineVector kernels).
+   */
+  Node *addNode(const std::string &name, const std::string &kind) {
+    nodes_m.push_back(Node{name, kind, owner_m, std::vector<SlotCounter>(nSlots_m)});
+    return &nodes_m.back();
+  }
+
+  /// @p columns with ``rdfslot_`` in front, the inputs of a wrap() result.
+  static std::vector<std::string> slotColumns(const std::vector<std::string> &columns) {
+    std::vector<std::string> result{"rdfslot_"};
+    result.insert(result.end(), columns.begin(), columns.end());
+    return result;
+  }
+
+  /**
+   * @brief Give the nodes that have the default owner and are named in
+   *        @p columns, or are Up/Down variations of them, to @p owner.
+   *
+   * Attributes columns that analysis code defined by calling plugin methods
+   * directly to the plugin that declares them in getProducedColumns().
+   */
+  void attribute(const std::vector<std::string> &columns, const std::string &owner);
+
+  /// Summed counters of every node, most expensive first.
+  std::vector<Entry> entries() const;
+
+  /// Summed time in nanoseconds per owner.
+  std::map<std::string, std::uint64_t> ownerTotals() const;
+
+  /// Summed allocations per owner; with allocation tracking, the
+  /// allocations of the tasks outside any node are under "framework".
+  std::map<std::string, AllocationTracker::Counts> ownerAllocations() const;
+
+  /// Number of instrumented nodes.
+  std::size_t size() const { return nodes_m.size(); }
+
+  /**
+   * @brief Write the per-node and per-owner counters as JSON to @p path.
+   *
+   * @throws std::runtime_error if @p path cannot be written.
+   */
+  void writeReport(const std::string &path) const;
+
+  /**
+   * @brief Mean time per event in nanoseconds of a report written by
+   *        writeReport(): the summed node time over the largest node call
+   *        count, which is the number of entries the run processed.
+   *
+   * @throws std::runtime_error if @p path cannot be read or parsed.
+   */
+  static double readEventCost(const std::string &path);
+
+  /**
+   * @brief TTreeProcessorMT tasks-per-worker hint for which one task of an
+   *        event loop over @p entries events costing @p eventCostNs each
+   *        takes about @p targetSeconds on @p workers workers.
+   *
+   * Never below ROOT's default of 10, and capped at 100000; a task cannot be
+   * smaller than one TTree cluster in any case.
+   */
+  static unsigned int tasksPerWorkerHint(double eventCostNs, std::uint64_t entries,
+                                         unsigned int workers, double targetSeconds);
+
+  /**
+   * @brief Largest tasks-per-worker hint not above @p hint for which a task
+   *        of an event loop over @p entries events on @p workers workers
+   *        still holds at least @p minEntries events.
+   *
+   * Never below 1; @p hint is returned unchanged when any of @p entries,
+   * @p workers or @p minEntries is 0.
+   */
+  static unsigned int capTasksPerWorker(unsigned int hint, std::uint64_t entries,
+                                        unsigned int workers, std::uint64_t minEntries);
+
+private:
+  template <typename Ret, typename F, typename... Args>
+  static auto timed(F f, Node *node, bool allocations, ROOT::TypeTraits::TypeList<Args...>) {
+    return [f = std::move(f), node, allocations](unsigned int slot, Args... args) mutable -> Ret {
+      Call call(node, slot, allocations);
+      return f(std::forward<Args>(args)...);
+    };
+  }
+
+  unsigned int nSlots_m;
+  std::vector<SlotTasks> tasks_m;
+  bool trackAllocations_m = false;
+  std::string owner_m = kDefaultOwner;
+  /// Deque so that the Node pointers held by the wrappers stay valid.
+  std::deque<Node> nodes_m;
+};
+
+#endif // NODEPROFILER_H_INCLUDED
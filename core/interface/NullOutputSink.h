@@ -14,6 +14,7 @@ public:
                       const IDataFrameProvider*,
                       const ISystematicManager*,
                       OutputChannel) override {}
+  bool bookedColumns(std::vector<std::string>&) const override { return true; }
   std::string resolveOutputFile(const IConfigurationProvider& configProvider,
                                 OutputChannel channel) override {
     if (channel == OutputChannel::Meta) {
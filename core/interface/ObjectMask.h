@@ -0,0 +1,246 @@
+/**
+ * @file ObjectMask.h
+ * @brief Bit-packed per-object selection mask.
+ *
+ * An @c RVec<bool> selection spends a byte per object and, for every cut,
+ * a heap allocation per event.  ObjectMask packs the decisions into 64-bit
+ * words kept inline up to 64 objects, so typical jet and lepton selections
+ * never allocate; combining ID criteria is one AND/OR per word, counting is
+ * a popcount and iterating visits only the set bits.
+ *
+ * @code
+ * auto mask = ObjectMask::above(Jet_pt, 30.f)
+ *           & ObjectMask::absBelow(Jet_eta, 2.4f)
+ *           & ObjectMask::hasBits(Jet_jetId, 2);
+ * PhysicsObjectCollection jets(Jet_pt, Jet_eta, Jet_phi, Jet_mass, mask);
+ * @endcode
+ */
+#ifndef OBJECTMASK_H_INCLUDED
+#define OBJECTMASK_H_INCLUDED
+
+#include <ROOT/RVec.hxx>
+#include <RtypesCore.h>
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+
+/**
+ * @class ObjectMask
+ * @brief Fixed-size bitset with one bit per object of a collection.
+ *
+ * Bits past size() are always clear, so count() and the word-wise
+ * operators need no tail handling.  Binary operators require equal sizes.
+ */
+class ObjectMask {
+public:
+  /// Words stored without a heap allocation (64 objects).
+  static constexpr std::size_t kInlineWords = 1;
+
+  /// Empty mask.
+  ObjectMask() = default;
+
+  /// Mask of @p n objects, all set to @p value.
+  explicit ObjectMask(std::size_t n, bool value = false)
+      : size_m(n), words_m(wordCount(n), value ? ~std::uint64_t{0} : 0) {
+    clearTail();
+  }
+
+  /// Packed copy of a boolean mask.
+  static ObjectMask fromBools(const ROOT::VecOps::RVec<bool> &mask) {
+    return where(mask, [](bool pass) { return pass; });
+  }
+
+  // ------------------------------------------------------------------
+  // Selection helpers
+  // ------------------------------------------------------------------
+
+  /// Value type of the cuts below; not deduced, so @c 30 cuts an RVec<float>.
+  template <typename T> using Threshold = typename ROOT::VecOps::RVec<T>::value_type;
+
+  /**
+   * @brief Mask of the objects of @p values for which @p pass holds.
+   *
+   * The decisions are shifted into the words without a branch per object,
+   * so the loop vectorises for simple predicates.
+   */
+  template <typename T, typename Pred>
+  static ObjectMask where(const ROOT::VecOps::RVec<T> &values, Pred pass) {
+    ObjectMask mask(values.size());
+    const std::size_t n = values.size();
+    for (std::size_t w = 0; w < mask.words_m.size(); ++w) {
+      const std::size_t begin = w * 64;
+      const std::size_t end = begin + 64 < n ? begin + 64 : n;
+      std::uint64_t word = 0;
+      for (std::size_t i = begin; i < end; ++i) {
+        word |= static_cast<std::uint64_t>(static_cast<bool>(pass(values[i]))) << (i - begin);
+      }
+      mask.words_m[w] = word;
+    }
+    return mask;
+  }
+
+  /// Objects with @p values > @p threshold.
+  template <typename T>
+  static ObjectMask above(const ROOT::VecOps::RVec<T> &values, Threshold<T> threshold) {
+    return where(values, [threshold](T v) { return v > threshold; });
+  }
+
+  /// Objects with @p values < @p threshold.
+  template <typename T>
+  static ObjectMask below(const ROOT::VecOps::RVec<T> &values, Threshold<T> threshold) {
+    return where(values, [threshold](T v) { return v < threshold; });
+  }
+
+  /// Objects with |@p values| < @p threshold.
+  template <typename T>
+  static ObjectMask absBelow(const ROOT::VecOps::RVec<T> &values, Threshold<T> threshold) {
+    return where(values, [threshold](T v) { return std::abs(v) < threshold; });
+  }
+
+  /// Objects whose integer flags (e.g. an ID bitfield) have all of @p bits set.
+  template <typename T>
+  static ObjectMask hasBits(const ROOT::VecOps::RVec<T> &flags, Threshold<T> bits) {
+    return where(flags, [bits](T v) { return (v & bits) == bits; });
+  }
+
+  // ------------------------------------------------------------------
+  // Access
+  // ------------------------------------------------------------------
+
+  /// Number of objects (bits).
+  std::size_t size() const { return size_m; }
+
+  /// Number of set bits.
+  std::size_t count() const {
+    std::size_t n = 0;
+    for (const auto word : words_m) {
+      n += static_cast<std::size_t>(__builtin_popcountll(word));
+    }
+    return n;
+  }
+
+  bool any() const {
+    for (const auto word : words_m) {
+      if (word != 0) return true;
+    }
+    return false;
+  }
+
+  bool none() const { return !any(); }
+
+  /**
+   * @brief Bit of object @p i.
+   * @throws std::out_of_range if @p i >= size().
+   */
+  bool test(std::size_t i) const {
+    checkIndex(i);
+    return (words_m[i / 64] >> (i % 64)) & 1u;
+  }
+
+  /**
+   * @brief Set the bit of object @p i to @p value.
+   * @throws std::out_of_range if @p i >= size().
+   */
+  void set(std::size_t i, bool value = true) {
+    checkIndex(i);
+    const std::uint64_t bit = std::uint64_t{1} << (i % 64);
+    words_m[i / 64] = value ? words_m[i / 64] | bit : words_m[i / 64] & ~bit;
+  }
+
+  /// Call @p f(i) for every set bit, in increasing order.
+  template <typename F>
+  void forEach(F &&f) const {
+    for (std::size_t w = 0; w < words_m.size(); ++w) {
+      for (std::uint64_t word = words_m[w]; word != 0; word &= word - 1) {
+        f(w * 64 + static_cast<std::size_t>(__builtin_ctzll(word)));
+      }
+    }
+  }
+
+  /// Positions of the set bits.
+  ROOT::VecOps::RVec<Int_t> indices() const {
+    ROOT::VecOps::RVec<Int_t> out;
+    out.reserve(count());
+    forEach([&out](std::size_t i) { out.push_back(static_cast<Int_t>(i)); });
+    return out;
+  }
+
+  /// Unpacked boolean mask.
+  ROOT::VecOps::RVec<bool> toBools() const {
+    ROOT::VecOps::RVec<bool> out(size_m, false);
+    forEach([&out](std::size_t i) { out[i] = true; });
+    return out;
+  }
+
+  // ------------------------------------------------------------------
+  // Combination
+  // ------------------------------------------------------------------
+
+  ObjectMask &operator&=(const ObjectMask &other) {
+    checkSize(other);
+    for (std::size_t w = 0; w < words_m.size(); ++w) words_m[w] &= other.words_m[w];
+    return *this;
+  }
+
+  ObjectMask &operator|=(const ObjectMask &other) {
+    checkSize(other);
+    for (std::size_t w = 0; w < words_m.size(); ++w) words_m[w] |= other.words_m[w];
+    return *this;
+  }
+
+  ObjectMask &operator^=(const ObjectMask &other) {
+    checkSize(other);
+    for (std::size_t w = 0; w < words_m.size(); ++w) words_m[w] ^= other.words_m[w];
+    return *this;
+  }
+
+  friend ObjectMask operator&(ObjectMask a, const ObjectMask &b) { return a &= b; }
+  friend ObjectMask operator|(ObjectMask a, const ObjectMask &b) { return a |= b; }
+  friend ObjectMask operator^(ObjectMask a, const ObjectMask &b) { return a ^= b; }
+
+  /// Complement; bits past size() stay clear.
+  ObjectMask operator~() const {
+    ObjectMask result(*this);
+    for (auto &word : result.words_m) word = ~word;
+    result.clearTail();
+    return result;
+  }
+
+  bool operator==(const ObjectMask &other) const {
+    if (size_m != other.size_m) return false;
+    for (std::size_t w = 0; w < words_m.size(); ++w) {
+      if (words_m[w] != other.words_m[w]) return false;
+    }
+    return true;
+  }
+
+  bool operator!=(const ObjectMask &other) const { return !(*this == other); }
+
+private:
+  static std::size_t wordCount(std::size_t n) { return (n + 63) / 64; }
+
+  void clearTail() {
+    if (size_m % 64 != 0) {
+      words_m.back() &= (std::uint64_t{1} << (size_m % 64)) - 1;
+    }
+  }
+
+  void checkIndex(std::size_t i) const {
+    if (i >= size_m) {
+      throw std::out_of_range("ObjectMask: index out of range");
+    }
+  }
+
+  void checkSize(const ObjectMask &other) const {
+    if (other.size_m != size_m) {
+      throw std::runtime_error("ObjectMask: size mismatch");
+    }
+  }
+
+  std::size_t size_m = 0;
+  ROOT::VecOps::RVecN<std::uint64_t, kInlineWords> words_m;
+};
+
+#endif // OBJECTMASK_H_INCLUDED
@@ -0,0 +1,85 @@
+#ifndef OUTPUTMERGER_H_INCLUDED
+#define OUTPUTMERGER_H_INCLUDED
+
+#include <TObject.h>
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Parallel merge of per-job histogram, cutflow and meta outputs.
+ *
+ * A replacement for ``hadd`` on the ROOT files written by NDHistogramManager,
+ * CutflowManager, CounterService and ProvenanceService.  The inputs are
+ * striped over a number of independent partial merges, each streaming its
+ * files one at a time, and the partial results are combined with a
+ * pairwise tree reduction (treeReduceSlots).  Under implicit
+ * multi-threading the partial merges run concurrently and the objects of
+ * two partial results are added key by key on the thread pool.
+ *
+ * Objects are matched by their path in the file ("dir/name"):
+ *  - histograms (TH1 and derived) and THnBase (THnSparseF) are added;
+ *  - TVectorD payloads are added element-wise;
+ *  - trees (e.g. CounterService's ``counter_files_<sample>``) are copied
+ *    into memory and concatenated, so they must be small bookkeeping
+ *    trees: skims are merged by SkimMerger;
+ *  - every other object (e.g. the TNamed entries of the ``provenance``
+ *    directory) keeps its copy from the first input.
+ *
+ * When the inputs have a ``provenance`` directory, the output records the
+ * number of merged files as ``provenance/merge.input_files``.
+ */
+class OutputMerger {
+public:
+  /**
+   * @param partialMerges Number of partial merges the inputs are striped
+   *        over; 0 uses the implicit-MT pool size (1 without implicit MT).
+   */
+  explicit OutputMerger(std::size_t partialMerges = 0);
+
+  /**
+   * @brief Merge @p inputs into @p output, which is recreated.
+   *
+   * @throws std::runtime_error if there are no inputs, an input cannot be
+   *         read, or objects at the same path have different types,
+   *         binnings or tree branches.
+   */
+  void merge(const std::string &output, const std::vector<std::string> &inputs) const;
+
+  /**
+   * @brief Output files of @p role listed in OutputManifest YAML files.
+   *
+   * @p role is a manifest section with an ``output_file`` ("histograms",
+   * "cutflow" or "metadata").  Relative paths are resolved against the
+   * manifest directory.  Files are grouped by basename, so that each
+   * systematic variation or region file is merged separately, and sorted
+   * within a group.
+   *
+   * @throws std::runtime_error if a manifest cannot be parsed.
+   */
+  static std::map<std::string, std::vector<std::string>>
+  manifestOutputs(const std::vector<std::string> &manifests, const std::string &role);
+
+  /// Objects of one file or partial merge, keyed by path in the file.
+  using Contents = std::map<std::string, std::unique_ptr<TObject>>;
+
+  /// Read every object of @p path (highest key cycle only).
+  static Contents read(const std::string &path);
+
+  /**
+   * @brief Add @p from into @p into, moving the objects @p into lacks.
+   *
+   * Keys are merged concurrently when implicit multi-threading is enabled.
+   */
+  static void add(Contents &into, Contents &from);
+
+  /// Write @p contents to @p output, which is recreated.
+  static void write(const std::string &output, const Contents &contents);
+
+private:
+  std::size_t partialMerges_m;
+};
+
+#endif // OUTPUTMERGER_H_INCLUDED
@@ -0,0 +1,110 @@
+/**
+ * @file PhaseTimer.h
+ * @brief Wall and CPU time of the phases of a job (configuration, plugin
+ *        setup, histogram writing, ...), recorded in the provenance and,
+ *        when tracing, as spans of the job timeline.
+ */
+#ifndef PHASETIMER_H_INCLUDED
+#define PHASETIMER_H_INCLUDED
+
+#include <TraceRecorder.h>
+
+#include <sys/resource.h>
+
+#include <chrono>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * @class PhaseTimer
+ * @brief Accumulates the wall and process CPU time of named phases.
+ *
+ * CPU time is that of the whole process, summed over all threads, so a
+ * phase that keeps N threads busy reports about N times its wall time.
+ */
+class PhaseTimer {
+public:
+  /// Wall clock and process CPU time at one instant.
+  struct Sample {
+    std::chrono::steady_clock::time_point wall;
+    double cpuSeconds = 0.0;
+
+    static Sample now() { return Sample{std::chrono::steady_clock::now(), cpuTime()}; }
+  };
+
+  /// Accumulated time of one phase.
+  struct Phase {
+    std::string name;
+    double wallSeconds = 0.0;
+    double cpuSeconds = 0.0;
+  };
+
+  /// Adds the time from its construction to its destruction to a phase.
+  class Scope {
+  public:
+    Scope(PhaseTimer &timer, std::string name)
+        : timer_m(timer), name_m(std::move(name)), begin_m(Sample::now()) {}
+    ~Scope() { timer_m.add(name_m, begin_m, Sample::now()); }
+    Scope(const Scope &) = delete;
+    Scope &operator=(const Scope &) = delete;
+
+  private:
+    PhaseTimer &timer_m;
+    std::string name_m;
+    Sample begin_m;
+  };
+
+  PhaseTimer() : mark_m(Sample::now()) {}
+
+  /// Add the time from @p begin to @p end to phase @p name.
+  void add(const std::string &name, const Sample &begin, const Sample &end) {
+    Phase *phase = nullptr;
+    for (auto &existing : phases_m) {
+      if (existing.name == name) {
+        phase = &existing;
+      }
+    }
+    if (!phase) {
+      phase = &phases_m.emplace_back(Phase{name});
+    }
+    phase->wallSeconds += std::chrono::duration<double>(end.wall - begin.wall).count();
+    phase->cpuSeconds += end.cpuSeconds - begin.cpuSeconds;
+    TraceRecorder::instance().record(name, "phase", begin.wall, end.wall);
+  }
+
+  /// Add the time since construction or the previous lap() to phase @p name.
+  void lap(const std::string &name) {
+    const Sample now = Sample::now();
+    add(name, mark_m, now);
+    mark_m = now;
+  }
+
+  /// Phases in the order they were first recorded.
+  const std::vector<Phase> &phases() const { return phases_m; }
+
+  /// User plus system CPU time of the process, in seconds.
+  static double cpuTime() {
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    return seconds(usage.ru_utime) + seconds(usage.ru_stime);
+  }
+
+  /// Peak resident set size of the process, in MB.
+  static double peakRssMegabytes() {
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    // ru_maxrss is in kilobytes on Linux.
+    return static_cast<double>(usage.ru_maxrss) / 1024.0;
+  }
+
+private:
+  static double seconds(const timeval &time) {
+    return static_cast<double>(time.tv_sec) + static_cast<double>(time.tv_usec) * 1e-6;
+  }
+
+  Sample mark_m;
+  std::vector<Phase> phases_m;
+};
+
+#endif // PHASETIMER_H_INCLUDED
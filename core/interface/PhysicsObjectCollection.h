@@ -16,10 +16,28 @@
  *    collection.
  *
  * Combinatoric helpers (@ref makePairs, @ref makeCrossPairs,
- * @ref makeTriplets) build pairs and triplets with their combined 4-vectors.
+ * @ref makeTriplets) build pairs and triplets with their combined 4-vectors;
+ * their @ref SlotArena overloads return per-event temporaries allocated from
+ * the slot arena instead of the heap.  @ref forEachPair, @ref forEachTriplet
+ * and the best-candidate reductions (@ref bestPairByMass, @ref highestPtPair,
+ * ...) enumerate combinations lazily with @ref CombinatoricCuts pre-cuts and
+ * never store the full list.
+ *
+ * Delta propagation of systematic variations: @ref changedObjects flags the
+ * objects a variation moves, @ref withVariedKinematics rebuilds only those,
+ * and the delta @ref makePairs overload and @ref reuseNominalIfUnchanged let
+ * downstream quantities reuse their nominal result where nothing changed.
  *
  * @ref TypedPhysicsObjectCollection<T> extends the base class to additionally
- * store a user-defined object alongside each selected entry.
+ * store a user-defined object alongside each selected entry;
+ * @ref TypedPhysicsObjectView<T> is its non-owning variant, which keeps only
+ * indices into the per-event arrays.
+ *
+ * @ref SoAPhysicsObjectCollection stores the same objects as contiguous
+ * kinematic arrays with an inline small buffer and typed feature slots.
+ *
+ * Every constructor and @c withFilter taking an @c RVec<bool> mask also
+ * takes a bit-packed @ref ObjectMask, which visits only the selected objects.
  *
  * @ref PhysicsObjectVariationMap provides a named map of collections for
  * systematic variations (e.g. "nominal", "JEC_up", "JEC_down").
@@ -52,16 +70,83 @@
 #ifndef PHYSICSOBJECTCOLLECTION_H_INCLUDED
 #define PHYSICSOBJECTCOLLECTION_H_INCLUDED
 
+#include <ObjectMask.h>
+#include <SlotArena.h>
+
 #include <Math/GenVector/LorentzVector.h>
 #include <Math/GenVector/PxPyPzM4D.h>
 #include <ROOT/RVec.hxx>
+#include <algorithm>
 #include <any>
+#include <array>
 #include <cmath>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <optional>
 #include <stdexcept>
 #include <string>
+#include <tuple>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
+template <typename... Features>
+class SoAPhysicsObjectCollection;
+
+namespace physics_object_detail {
+
+/**
+ * @brief Copy-on-write array: copies share one buffer until one of them is
+ *        modified.
+ *
+ * Reads go through the const interface; the mutating members copy the
+ * buffer first when another array still refers to it.
+ */
+template <typename T>
+class SharedArray {
+public:
+    std::size_t size() const { return data_m ? data_m->size() : 0; }
+    bool empty() const { return size() == 0; }
+    const T &operator[](std::size_t i) const { return (*data_m)[i]; }
+    const T &at(std::size_t i) const { return get().at(i); }
+    auto begin() const { return get().begin(); }
+    auto end() const { return get().end(); }
+
+    /// The elements; valid until this array is modified.
+    const std::vector<T> &get() const {
+        static const std::vector<T> empty;
+        return data_m ? *data_m : empty;
+    }
+
+    /// True when @p other refers to the same buffer.
+    bool sharesWith(const SharedArray &other) const {
+        return data_m && data_m == other.data_m;
+    }
+
+    T &operator[](std::size_t i) { return mutableData()[i]; }
+    void push_back(const T &value) { mutableData().push_back(value); }
+    template <typename... Args> void emplace_back(Args &&...args) {
+        mutableData().emplace_back(std::forward<Args>(args)...);
+    }
+    void reserve(std::size_t n) { mutableData().reserve(n); }
+    template <typename It> void assign(It first, It last) { mutableData().assign(first, last); }
+
+private:
+    std::vector<T> &mutableData() {
+        if (!data_m) {
+            data_m = std::make_shared<std::vector<T>>();
+        } else if (data_m.use_count() > 1) {
+            data_m = std::make_shared<std::vector<T>>(*data_m);
+        }
+        return *data_m;
+    }
+
+    std::shared_ptr<std::vector<T>> data_m;
+};
+
+} // namespace physics_object_detail
+
 /**
  * @class PhysicsObjectCollection
  * @brief An event-level collection of physics objects that pass a selection.
@@ -125,6 +210,32 @@ public:
         }
     }
 
+    /**
+     * @brief Build a collection from pt/eta/phi/mass columns and a packed
+     *        selection mask.
+     *
+     * @param mask Packed selection mask (same length as pt).
+     * @throws std::runtime_error if the input vectors have inconsistent sizes.
+     */
+    PhysicsObjectCollection(const ROOT::VecOps::RVec<Float_t> &pt,
+                            const ROOT::VecOps::RVec<Float_t> &eta,
+                            const ROOT::VecOps::RVec<Float_t> &phi,
+                            const ROOT::VecOps::RVec<Float_t> &mass,
+                            const ObjectMask &mask) {
+        const auto n = pt.size();
+        if (eta.size() != n || phi.size() != n || mass.size() != n ||
+            mask.size() != n) {
+            throw std::runtime_error(
+                "PhysicsObjectCollection: input vector size mismatch");
+        }
+        indices_m.reserve(mask.count());
+        vectors_m.reserve(mask.count());
+        mask.forEach([&](std::size_t i) {
+            indices_m.push_back(static_cast<Int_t>(i));
+            vectors_m.push_back(makePtEtaPhiM(pt[i], eta[i], phi[i], mass[i]));
+        });
+    }
+
     /**
      * @brief Build a collection from pt/eta/phi/mass columns and an explicit
      *        list of indices.
@@ -193,7 +304,7 @@ public:
      * @brief Access all 4-vectors.
      * @return Const reference to the internal vector of LorentzVectors.
      */
-    const std::vector<LorentzVec> &vectors() const { return vectors_m; }
+    const std::vector<LorentzVec> &vectors() const { return vectors_m.get(); }
 
     // ------------------------------------------------------------------
     // Index access
@@ -212,7 +323,7 @@ public:
      * @brief Access all original indices.
      * @return Const reference to the internal index vector.
      */
-    const std::vector<Int_t> &indices() const { return indices_m; }
+    const std::vector<Int_t> &indices() const { return indices_m.get(); }
 
     // ------------------------------------------------------------------
     // Feature-branch lookup
@@ -263,7 +374,22 @@ public:
      */
     template <typename T>
     void cacheFeature(const std::string &name, T value) {
-        cachedFeatures_m[name] = std::move(value);
+        cachedFeatures_m[name] = CachedFeature{std::move(value), false};
+    }
+
+    /**
+     * @brief Store a per-object feature that does not depend on the
+     *        kinematics (e.g. tagger scores from @ref getValue).
+     *
+     * Unlike @ref cacheFeature, the entry is kept by the collections that
+     * hold the same objects with other kinematics (@ref withCorrectedPt,
+     * @ref withCorrectedKinematics, @ref withVariedKinematics), so
+     * systematic variations do not recompute it.  Results with another
+     * object selection drop it.
+     */
+    template <typename T>
+    void cacheObjectFeature(const std::string &name, T value) {
+        cachedFeatures_m[name] = CachedFeature{std::move(value), true};
     }
 
     /**
@@ -282,7 +408,7 @@ public:
             throw std::runtime_error(
                 "PhysicsObjectCollection: cached feature not found: " + name);
         }
-        return std::any_cast<const T &>(it->second);
+        return std::any_cast<const T &>(it->second.value);
     }
 
     /**
@@ -298,6 +424,10 @@ public:
     // Overlap removal
     // ------------------------------------------------------------------
 
+    /// Number of object pairs above which @ref removeOverlap sweeps a
+    /// sorted-η window instead of testing every pair.
+    static constexpr std::size_t kOverlapSweepMinPairs = 64;
+
     /**
      * @brief Return a new collection with objects that overlap with @p other
      *        removed.
@@ -306,6 +436,11 @@ public:
      * any object in @p other satisfies ΔR(i, j) < @p deltaRMin.  Overlapping
      * objects are excluded from the returned collection.
      *
+     * Small inputs test every pair.  Above @ref kOverlapSweepMinPairs pairs,
+     * @p other is sorted by η in the slot arena and only objects with
+     * |Δη| < @p deltaRMin are tested, since ΔR ≥ |Δη|; the result is the
+     * same in both cases.
+     *
      * The cached-feature store is *not* propagated to the result because the
      * indices into the original collection change after the removal.
      *
@@ -317,10 +452,46 @@ public:
     PhysicsObjectCollection removeOverlap(const PhysicsObjectCollection &other,
                                           float deltaRMin) const {
         PhysicsObjectCollection result;
+        result.vectors_m.reserve(size());
+        result.indices_m.reserve(size());
+        if (size() * other.size() <= kOverlapSweepMinPairs) {
+            for (std::size_t i = 0; i < size(); ++i) {
+                bool overlaps = false;
+                for (std::size_t j = 0; j < other.size(); ++j) {
+                    if (deltaR(at(i), other.at(j)) < deltaRMin) {
+                        overlaps = true;
+                        break;
+                    }
+                }
+                if (!overlaps) {
+                    result.vectors_m.push_back(vectors_m[i]);
+                    result.indices_m.push_back(indices_m[i]);
+                }
+            }
+            return result;
+        }
+
+        SlotArena::Scope scratch;
+        ArenaVector<std::pair<double, std::size_t>> byEta(
+            scratch.allocator<std::pair<double, std::size_t>>());
+        byEta.reserve(other.size());
+        for (std::size_t j = 0; j < other.size(); ++j) {
+            byEta.emplace_back(other.at(j).Eta(), j);
+        }
+        std::sort(byEta.begin(), byEta.end());
+
+        // Widened so that float rounding in deltaR() cannot drop a candidate.
+        const double window = static_cast<double>(deltaRMin) * (1.0 + 1e-5) + 1e-6;
         for (std::size_t i = 0; i < size(); ++i) {
+            const double eta = at(i).Eta();
+            auto it = std::lower_bound(
+                byEta.begin(), byEta.end(), eta - window,
+                [](const std::pair<double, std::size_t> &entry, double value) {
+                    return entry.first < value;
+                });
             bool overlaps = false;
-            for (std::size_t j = 0; j < other.size(); ++j) {
-                if (deltaR(at(i), other.at(j)) < deltaRMin) {
+            for (; it != byEta.end() && it->first <= eta + window; ++it) {
+                if (deltaR(at(i), other.at(it->second)) < deltaRMin) {
                     overlaps = true;
                     break;
                 }
@@ -388,6 +559,22 @@ public:
         return result;
     }
 
+    /// @copydoc withFilter(const ROOT::VecOps::RVec<bool> &) const
+    PhysicsObjectCollection withFilter(const ObjectMask &mask) const {
+        if (mask.size() != size()) {
+            throw std::runtime_error(
+                "PhysicsObjectCollection::withFilter: mask size mismatch");
+        }
+        PhysicsObjectCollection result;
+        result.vectors_m.reserve(mask.count());
+        result.indices_m.reserve(mask.count());
+        mask.forEach([&](std::size_t i) {
+            result.vectors_m.push_back(vectors_m[i]);
+            result.indices_m.push_back(indices_m[i]);
+        });
+        return result;
+    }
+
     // ------------------------------------------------------------------
     // Correction application
     // ------------------------------------------------------------------
@@ -400,7 +587,8 @@ public:
      * unfiltered) collection — the same indexing used to build this collection.
      * The stored indices are used to look up each object's corrected values.
      *
-     * The cached-feature store is *not* propagated to the result.
+     * Features cached with @ref cacheObjectFeature are kept; other cached
+     * features are dropped.
      *
      * @param correctedPt   Corrected transverse momenta for the full collection.
      * @param correctedEta  Corrected pseudorapidities for the full collection.
@@ -424,7 +612,7 @@ public:
                 "input vector size mismatch");
         }
         PhysicsObjectCollection result;
-        result.indices_m.reserve(size());
+        result.indices_m = indices_m;
         result.vectors_m.reserve(size());
         for (std::size_t i = 0; i < size(); ++i) {
             const auto idx = indices_m[i];
@@ -433,11 +621,11 @@ public:
                     "PhysicsObjectCollection::withCorrectedKinematics: "
                     "index out of range for corrected arrays");
             }
-            result.indices_m.push_back(idx);
             result.vectors_m.push_back(
                 makePtEtaPhiM(correctedPt[idx], correctedEta[idx],
                               correctedPhi[idx], correctedMass[idx]));
         }
+        copyObjectFeatures(result);
         return result;
     }
 
@@ -446,6 +634,7 @@ public:
      *
      * A convenience wrapper around @ref withCorrectedKinematics that replaces
      * only pt; eta, phi, and mass are taken from the existing 4-vectors.
+     * The indices and the @ref cacheObjectFeature entries are shared.
      *
      * @p correctedPt is indexed by position in the *original* (full,
      * unfiltered) collection.
@@ -459,7 +648,7 @@ public:
         const ROOT::VecOps::RVec<Float_t> &correctedPt) const {
         const auto n = correctedPt.size();
         PhysicsObjectCollection result;
-        result.indices_m.reserve(size());
+        result.indices_m = indices_m;
         result.vectors_m.reserve(size());
         for (std::size_t i = 0; i < size(); ++i) {
             const auto idx = indices_m[i];
@@ -472,16 +661,116 @@ public:
             const Float_t eta  = static_cast<Float_t>(old.Eta());
             const Float_t phi  = static_cast<Float_t>(old.Phi());
             const Float_t mass = static_cast<Float_t>(old.M());
-            result.indices_m.push_back(idx);
             result.vectors_m.push_back(
                 makePtEtaPhiM(correctedPt[idx], eta, phi, mass));
         }
+        copyObjectFeatures(result);
+        return result;
+    }
+
+    /**
+     * @brief Flag the stored objects whose kinematics differ between a
+     *        nominal and a varied set of full-collection arrays.
+     *
+     * Used for delta propagation of systematic variations: objects whose pt
+     * (and mass, when both mass arrays are non-empty) are bit-identical in
+     * the nominal and varied arrays are reported as unchanged.
+     *
+     * @param nominalPt   Nominal pt for the full collection.
+     * @param variedPt    Varied pt for the full collection.
+     * @param nominalMass Nominal mass for the full collection (may be empty).
+     * @param variedMass  Varied mass for the full collection (may be empty).
+     * @return One flag per stored object, @c true where the object changed.
+     * @throws std::out_of_range if a stored index is out of range for the
+     *         pt arrays.
+     */
+    ROOT::VecOps::RVec<bool> changedObjects(
+        const ROOT::VecOps::RVec<Float_t> &nominalPt,
+        const ROOT::VecOps::RVec<Float_t> &variedPt,
+        const ROOT::VecOps::RVec<Float_t> &nominalMass = {},
+        const ROOT::VecOps::RVec<Float_t> &variedMass = {}) const {
+        const auto n = std::min(nominalPt.size(), variedPt.size());
+        const bool compareMass = !nominalMass.empty() && !variedMass.empty();
+        ROOT::VecOps::RVec<bool> changed(size(), false);
+        for (std::size_t i = 0; i < size(); ++i) {
+            const auto idx = indices_m[i];
+            if (idx < 0 || static_cast<std::size_t>(idx) >= n) {
+                throw std::out_of_range(
+                    "PhysicsObjectCollection::changedObjects: "
+                    "index out of range for pt arrays");
+            }
+            changed[i] = nominalPt[idx] != variedPt[idx] ||
+                         (compareMass &&
+                          static_cast<std::size_t>(idx) < nominalMass.size() &&
+                          static_cast<std::size_t>(idx) < variedMass.size() &&
+                          nominalMass[idx] != variedMass[idx]);
+        }
+        return changed;
+    }
+
+    /**
+     * @brief Return a varied copy of this (nominal) collection that only
+     *        rebuilds the objects flagged in @p changed.
+     *
+     * Unchanged objects keep their nominal 4-vectors; changed objects are
+     * rebuilt from @p variedPt (and @p variedMass when non-empty) with eta
+     * and phi taken from the nominal 4-vector.  When no object changed the
+     * nominal collection is returned as is.
+     *
+     * The result shares the index array with this collection, and the
+     * 4-vector array too until the first object changes.  Features cached
+     * with @ref cacheObjectFeature are kept; other cached features are
+     * dropped.
+     *
+     * @param changed    Per stored object flags, as from @ref changedObjects.
+     * @param variedPt   Varied pt for the full collection.
+     * @param variedMass Varied mass for the full collection (may be empty).
+     * @return New @c PhysicsObjectCollection with the varied 4-vectors.
+     * @throws std::runtime_error if @p changed does not match size().
+     * @throws std::out_of_range  if a changed object's index is out of range
+     *         for the varied arrays.
+     */
+    PhysicsObjectCollection withVariedKinematics(
+        const ROOT::VecOps::RVec<bool> &changed,
+        const ROOT::VecOps::RVec<Float_t> &variedPt,
+        const ROOT::VecOps::RVec<Float_t> &variedMass = {}) const {
+        if (changed.size() != size()) {
+            throw std::runtime_error(
+                "PhysicsObjectCollection::withVariedKinematics: "
+                "changed mask size does not match collection size");
+        }
+        PhysicsObjectCollection result;
+        result.indices_m = indices_m;
+        result.vectors_m = vectors_m;
+        for (std::size_t i = 0; i < size(); ++i) {
+            if (!changed[i]) {
+                continue;
+            }
+            const auto idx = static_cast<std::size_t>(indices_m[i]);
+            if (idx >= variedPt.size() ||
+                (!variedMass.empty() && idx >= variedMass.size())) {
+                throw std::out_of_range(
+                    "PhysicsObjectCollection::withVariedKinematics: "
+                    "index out of range for varied arrays");
+            }
+            const LorentzVec &old = vectors_m[i];
+            const Float_t mass = variedMass.empty()
+                                     ? static_cast<Float_t>(old.M())
+                                     : variedMass[idx];
+            result.vectors_m[i] = makePtEtaPhiM(
+                variedPt[idx], static_cast<Float_t>(old.Eta()),
+                static_cast<Float_t>(old.Phi()), mass);
+        }
+        copyObjectFeatures(result);
         return result;
     }
 
 protected:
-    std::vector<LorentzVec> vectors_m; ///< 4-vectors of selected objects.
-    std::vector<Int_t>      indices_m; ///< Original indices of selected objects.
+    // Copies of a collection (variation aliases, variation maps) and the
+    // results of withCorrected*/withVariedKinematics share these buffers
+    // until one of them is modified.
+    physics_object_detail::SharedArray<LorentzVec> vectors_m; ///< 4-vectors of selected objects.
+    physics_object_detail::SharedArray<Int_t>      indices_m; ///< Original indices of selected objects.
 
     /// Build a PxPyPzM LorentzVector from pt, eta, phi, mass.
     static LorentzVec makePtEtaPhiM(Float_t pt, Float_t eta, Float_t phi,
@@ -492,9 +781,27 @@ protected:
         return LorentzVec(px, py, pz, mass);
     }
 
+    /// Copy the @ref cacheObjectFeature entries to @p result.
+    void copyObjectFeatures(PhysicsObjectCollection &result) const {
+        for (const auto &[name, feature] : cachedFeatures_m) {
+            if (feature.objectFeature) {
+                result.cachedFeatures_m.emplace(name, feature);
+            }
+        }
+    }
+
 private:
+    template <typename... Features>
+    friend class SoAPhysicsObjectCollection;
+
+    struct CachedFeature {
+        std::any value;
+        /// Independent of the kinematics (see cacheObjectFeature()).
+        bool objectFeature;
+    };
+
     /// Cache of arbitrary derived quantities, keyed by user-defined names.
-    std::unordered_map<std::string, std::any> cachedFeatures_m;
+    std::unordered_map<std::string, CachedFeature> cachedFeatures_m;
 };
 
 // ============================================================================
@@ -542,6 +849,48 @@ struct ObjectTriplet {
 // Combinatoric builders
 // ============================================================================
 
+namespace physics_object_detail {
+
+template <typename PairVector>
+void fillPairs(const PhysicsObjectCollection &col, PairVector &pairs) {
+    const std::size_t n = col.size();
+    pairs.reserve(n * (n - 1) / 2);
+    for (std::size_t i = 0; i < n; ++i) {
+        for (std::size_t j = i + 1; j < n; ++j) {
+            pairs.push_back({col.at(i) + col.at(j), i, j});
+        }
+    }
+}
+
+template <typename PairVector>
+void fillCrossPairs(const PhysicsObjectCollection &col1,
+                    const PhysicsObjectCollection &col2, PairVector &pairs) {
+    pairs.reserve(col1.size() * col2.size());
+    for (std::size_t i = 0; i < col1.size(); ++i) {
+        for (std::size_t j = 0; j < col2.size(); ++j) {
+            pairs.push_back({col1.at(i) + col2.at(j), i, j});
+        }
+    }
+}
+
+template <typename TripletVector>
+void fillTriplets(const PhysicsObjectCollection &col, TripletVector &triplets) {
+    const std::size_t n = col.size();
+    if (n >= 3) {
+        triplets.reserve(n * (n - 1) * (n - 2) / 6);
+    }
+    for (std::size_t i = 0; i < n; ++i) {
+        for (std::size_t j = i + 1; j < n; ++j) {
+            for (std::size_t k = j + 1; k < n; ++k) {
+                triplets.push_back(
+                    {col.at(i) + col.at(j) + col.at(k), i, j, k});
+            }
+        }
+    }
+}
+
+} // namespace physics_object_detail
+
 /**
  * @brief Build all unique same-collection pairs from @p col.
  *
@@ -553,13 +902,25 @@ struct ObjectTriplet {
  */
 inline std::vector<ObjectPair> makePairs(const PhysicsObjectCollection &col) {
     std::vector<ObjectPair> pairs;
-    const std::size_t n = col.size();
-    pairs.reserve(n * (n - 1) / 2);
-    for (std::size_t i = 0; i < n; ++i) {
-        for (std::size_t j = i + 1; j < n; ++j) {
-            pairs.push_back({col.at(i) + col.at(j), i, j});
-        }
-    }
+    physics_object_detail::fillPairs(col, pairs);
+    return pairs;
+}
+
+/**
+ * @brief Arena-backed variant of @ref makePairs for pairs that are consumed
+ *        within the calling Define lambda.
+ *
+ * The result lives in @p arena (typically SlotArena::local()) and must not
+ * be returned as, or stored in, a column value.
+ *
+ * @param col   Source collection.
+ * @param arena Arena to allocate the result from.
+ * @return Vector of all unique pairs, ordered by (i, j) with i < j.
+ */
+inline ArenaVector<ObjectPair> makePairs(const PhysicsObjectCollection &col,
+                                         SlotArena &arena) {
+    ArenaVector<ObjectPair> pairs{SlotArena::Allocator<ObjectPair>(arena)};
+    physics_object_detail::fillPairs(col, pairs);
     return pairs;
 }
 
@@ -576,12 +937,19 @@ inline std::vector<ObjectPair> makePairs(const PhysicsObjectCollection &col) {
 inline std::vector<ObjectPair> makeCrossPairs(const PhysicsObjectCollection &col1,
                                               const PhysicsObjectCollection &col2) {
     std::vector<ObjectPair> pairs;
-    pairs.reserve(col1.size() * col2.size());
-    for (std::size_t i = 0; i < col1.size(); ++i) {
-        for (std::size_t j = 0; j < col2.size(); ++j) {
-            pairs.push_back({col1.at(i) + col2.at(j), i, j});
-        }
-    }
+    physics_object_detail::fillCrossPairs(col1, col2, pairs);
+    return pairs;
+}
+
+/**
+ * @brief Arena-backed variant of @ref makeCrossPairs; see the arena
+ *        overload of @ref makePairs for the lifetime rules.
+ */
+inline ArenaVector<ObjectPair> makeCrossPairs(const PhysicsObjectCollection &col1,
+                                              const PhysicsObjectCollection &col2,
+                                              SlotArena &arena) {
+    ArenaVector<ObjectPair> pairs{SlotArena::Allocator<ObjectPair>(arena)};
+    physics_object_detail::fillCrossPairs(col1, col2, pairs);
     return pairs;
 }
 
@@ -596,107 +964,508 @@ inline std::vector<ObjectPair> makeCrossPairs(const PhysicsObjectCollection &col
 inline std::vector<ObjectTriplet>
 makeTriplets(const PhysicsObjectCollection &col) {
     std::vector<ObjectTriplet> triplets;
-    const std::size_t n = col.size();
-    for (std::size_t i = 0; i < n; ++i) {
-        for (std::size_t j = i + 1; j < n; ++j) {
-            for (std::size_t k = j + 1; k < n; ++k) {
-                triplets.push_back(
-                    {col.at(i) + col.at(j) + col.at(k), i, j, k});
-            }
-        }
-    }
+    physics_object_detail::fillTriplets(col, triplets);
+    return triplets;
+}
+
+/**
+ * @brief Arena-backed variant of @ref makeTriplets; see the arena overload
+ *        of @ref makePairs for the lifetime rules.
+ */
+inline ArenaVector<ObjectTriplet>
+makeTriplets(const PhysicsObjectCollection &col, SlotArena &arena) {
+    ArenaVector<ObjectTriplet> triplets{SlotArena::Allocator<ObjectTriplet>(arena)};
+    physics_object_detail::fillTriplets(col, triplets);
     return triplets;
 }
 
 // ============================================================================
-// TypedPhysicsObjectCollection<T>
+// Lazy combinatorics with pre-cuts
 // ============================================================================
 
 /**
- * @class TypedPhysicsObjectCollection
- * @brief Extends PhysicsObjectCollection to additionally store a
- *        user-defined object of type @p ObjectType for each selected entry.
- *
- * This allows analyses to attach arbitrary per-object data (e.g. custom
- * calibration structs, resolved-object records, or decorated objects) to the
- * standard 4-vector + index representation.
- *
- * @tparam ObjectType  The user-defined type stored per selected object.
- *
- * ### Example
- * @code
- * struct JetInfo { float btagScore; int flavour; };
- *
- * auto col = TypedPhysicsObjectCollection<JetInfo>(
- *     pt, eta, phi, mass, mask,
- *     allJetInfo);   // std::vector<JetInfo> with one entry per jet
+ * @struct CombinatoricCuts
+ * @brief Pre-selection applied while enumerating combinations.
  *
- * JetInfo& info = col.object(0);
- * @endcode
+ * Mass cuts act on the invariant mass of the combination; ΔR cuts on every
+ * pair of objects within it; the charge cut on the sum of @ref charges
+ * (indexed by position in the collection, e.g. from getValue(Muon_charge)).
+ * Default-constructed cuts accept every combination.
  */
-template <typename ObjectType>
-class TypedPhysicsObjectCollection : public PhysicsObjectCollection {
-public:
-    // ------------------------------------------------------------------
-    // Constructors
-    // ------------------------------------------------------------------
+struct CombinatoricCuts {
+    float minMass = 0.f;                                      ///< Lower mass bound.
+    float maxMass = std::numeric_limits<float>::infinity();   ///< Upper mass bound.
+    float minDeltaR = 0.f;                                    ///< Minimum pairwise ΔR.
+    float maxDeltaR = std::numeric_limits<float>::infinity(); ///< Maximum pairwise ΔR.
+    std::optional<Int_t> totalCharge;      ///< Required charge sum, if any.
+    ROOT::VecOps::RVec<Int_t> charges;      ///< Charges of the (first) collection.
+    ROOT::VecOps::RVec<Int_t> otherCharges; ///< Charges of the second collection (cross pairs).
+};
 
-    /**
-     * @brief Default constructor – creates an empty typed collection.
-     */
-    TypedPhysicsObjectCollection() = default;
+namespace physics_object_detail {
 
-    /**
-     * @brief Build from pt/eta/phi/mass, a boolean mask, and a parallel
-     *        vector of user-defined objects.
-     *
-     * The @p objectsAll vector must have the same length as @p pt.  Only
-     * entries where @p mask is @c true are included.
-     *
-     * @param pt         Transverse momenta of all objects.
-     * @param eta        Pseudorapidities of all objects.
-     * @param phi        Azimuthal angles of all objects.
-     * @param mass       Masses of all objects.
-     * @param mask       Boolean selection mask (same length as @p pt).
-     * @param objectsAll Full vector of user objects (same length as @p pt).
-     * @throws std::runtime_error if @p objectsAll has a different size than
-     *         @p pt, or if the pt/eta/phi/mass vectors are inconsistent.
-     */
-    TypedPhysicsObjectCollection(const ROOT::VecOps::RVec<Float_t> &pt,
-                                 const ROOT::VecOps::RVec<Float_t> &eta,
-                                 const ROOT::VecOps::RVec<Float_t> &phi,
-                                 const ROOT::VecOps::RVec<Float_t> &mass,
-                                 const ROOT::VecOps::RVec<bool>    &mask,
-                                 const std::vector<ObjectType>     &objectsAll)
-        : PhysicsObjectCollection(pt, eta, phi, mass, mask) {
-        if (objectsAll.size() != pt.size()) {
-            throw std::runtime_error(
-                "TypedPhysicsObjectCollection: objects size mismatch");
+/// Per-object quantities the pre-cuts need, computed once per enumeration.
+struct CombinatoricInputs {
+    ArenaVector<float> eta;
+    ArenaVector<float> phi;
+
+    CombinatoricInputs(const PhysicsObjectCollection &col, bool needAngles,
+                       SlotArena &arena)
+        : eta(SlotArena::Allocator<float>(arena)),
+          phi(SlotArena::Allocator<float>(arena)) {
+        if (!needAngles) {
+            return;
         }
-        for (std::size_t i = 0; i < mask.size(); ++i) {
-            if (mask[i]) {
-                objects_m.push_back(objectsAll[i]);
-            }
+        eta.reserve(col.size());
+        phi.reserve(col.size());
+        for (std::size_t i = 0; i < col.size(); ++i) {
+            eta.push_back(static_cast<float>(col.at(i).Eta()));
+            phi.push_back(static_cast<float>(col.at(i).Phi()));
         }
     }
+};
 
-    /**
-     * @brief Build from pt/eta/phi/mass, an explicit index list, and a
-     *        parallel vector of user-defined objects.
-     *
-     * The @p objectsAll vector must have the same length as @p pt.  Only
-     * entries at the given @p indices are included; out-of-bounds indices are
-     * silently skipped (consistent with the base-class behaviour).
-     *
-     * @param pt         Transverse momenta of all objects.
-     * @param eta        Pseudorapidities of all objects.
-     * @param phi        Azimuthal angles of all objects.
-     * @param mass       Masses of all objects.
-     * @param indices    Indices into the full collection to include.
-     * @param objectsAll Full vector of user objects (same length as @p pt).
-     * @throws std::runtime_error if @p objectsAll has a different size than
-     *         @p pt, or if the pt/eta/phi/mass vectors are inconsistent.
-     */
+inline bool hasDeltaRCut(const CombinatoricCuts &cuts) {
+    return cuts.minDeltaR > 0.f ||
+           cuts.maxDeltaR != std::numeric_limits<float>::infinity();
+}
+
+inline bool passDeltaR(const CombinatoricInputs &a, std::size_t i,
+                       const CombinatoricInputs &b, std::size_t j,
+                       const CombinatoricCuts &cuts) {
+    if (a.eta.empty()) {
+        return true;
+    }
+    constexpr float kPi = 3.14159265f;
+    const float dEta = a.eta[i] - b.eta[j];
+    float dPhi = a.phi[i] - b.phi[j];
+    while (dPhi >  kPi) dPhi -= 2.f * kPi;
+    while (dPhi < -kPi) dPhi += 2.f * kPi;
+    const float dR2 = dEta * dEta + dPhi * dPhi;
+    return dR2 >= cuts.minDeltaR * cuts.minDeltaR &&
+           dR2 <= cuts.maxDeltaR * cuts.maxDeltaR;
+}
+
+inline bool passMass(const PhysicsObjectCollection::LorentzVec &p4,
+                     const CombinatoricCuts &cuts) {
+    const float m = static_cast<float>(p4.M());
+    return m >= cuts.minMass && m <= cuts.maxMass;
+}
+
+inline void checkCharges(const ROOT::VecOps::RVec<Int_t> &charges,
+                         std::size_t n, const char *what) {
+    if (charges.size() != n) {
+        throw std::runtime_error(
+            std::string("CombinatoricCuts: ") + what +
+            " size does not match the collection size");
+    }
+}
+
+} // namespace physics_object_detail
+
+/**
+ * @brief Visit every same-collection pair passing @p cuts without storing
+ *        any of them.
+ *
+ * ΔR and charge cuts are applied before the pair 4-vector is summed, so
+ * rejected pairs cost no 4-vector arithmetic.  @p visit is called as
+ * visit(const ObjectPair &) in the order of @ref makePairs.
+ *
+ * @throws std::runtime_error if a charge cut is requested and
+ *         @c cuts.charges does not match the collection size.
+ */
+template <typename Visitor>
+void forEachPair(const PhysicsObjectCollection &col, Visitor &&visit,
+                 const CombinatoricCuts &cuts = {}) {
+    using namespace physics_object_detail;
+    const std::size_t n = col.size();
+    if (cuts.totalCharge) {
+        checkCharges(cuts.charges, n, "charges");
+    }
+    SlotArena::Scope scope;
+    const CombinatoricInputs in(col, hasDeltaRCut(cuts), scope.arena());
+    for (std::size_t i = 0; i < n; ++i) {
+        for (std::size_t j = i + 1; j < n; ++j) {
+            if (cuts.totalCharge &&
+                cuts.charges[i] + cuts.charges[j] != *cuts.totalCharge) {
+                continue;
+            }
+            if (!passDeltaR(in, i, in, j, cuts)) {
+                continue;
+            }
+            const ObjectPair pair{col.at(i) + col.at(j), i, j};
+            if (passMass(pair.p4, cuts)) {
+                visit(pair);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Visit every cross-collection pair passing @p cuts without storing
+ *        any of them.
+ *
+ * As @ref forEachPair; the charge cut uses @c cuts.charges for @p col1 and
+ * @c cuts.otherCharges for @p col2.
+ */
+template <typename Visitor>
+void forEachCrossPair(const PhysicsObjectCollection &col1,
+                      const PhysicsObjectCollection &col2, Visitor &&visit,
+                      const CombinatoricCuts &cuts = {}) {
+    using namespace physics_object_detail;
+    if (cuts.totalCharge) {
+        checkCharges(cuts.charges, col1.size(), "charges");
+        checkCharges(cuts.otherCharges, col2.size(), "otherCharges");
+    }
+    SlotArena::Scope scope;
+    const bool angles = hasDeltaRCut(cuts);
+    const CombinatoricInputs in1(col1, angles, scope.arena());
+    const CombinatoricInputs in2(col2, angles, scope.arena());
+    for (std::size_t i = 0; i < col1.size(); ++i) {
+        for (std::size_t j = 0; j < col2.size(); ++j) {
+            if (cuts.totalCharge &&
+                cuts.charges[i] + cuts.otherCharges[j] != *cuts.totalCharge) {
+                continue;
+            }
+            if (!passDeltaR(in1, i, in2, j, cuts)) {
+                continue;
+            }
+            const ObjectPair pair{col1.at(i) + col2.at(j), i, j};
+            if (passMass(pair.p4, cuts)) {
+                visit(pair);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Visit every same-collection triplet passing @p cuts without storing
+ *        any of them.
+ *
+ * Pruning happens at the pair level: a pair (i, j) failing the ΔR cut, or
+ * whose mass already exceeds @c cuts.maxMass, is not extended to any k,
+ * since adding an object never lowers the invariant mass.  The pair sum is
+ * computed once and reused for every k.  @p visit is called as
+ * visit(const ObjectTriplet &) in the order of @ref makeTriplets.
+ *
+ * @throws std::runtime_error if a charge cut is requested and
+ *         @c cuts.charges does not match the collection size.
+ */
+template <typename Visitor>
+void forEachTriplet(const PhysicsObjectCollection &col, Visitor &&visit,
+                    const CombinatoricCuts &cuts = {}) {
+    using namespace physics_object_detail;
+    const std::size_t n = col.size();
+    if (cuts.totalCharge) {
+        checkCharges(cuts.charges, n, "charges");
+    }
+    SlotArena::Scope scope;
+    const CombinatoricInputs in(col, hasDeltaRCut(cuts), scope.arena());
+    for (std::size_t i = 0; i < n; ++i) {
+        for (std::size_t j = i + 1; j < n; ++j) {
+            if (!passDeltaR(in, i, in, j, cuts)) {
+                continue;
+            }
+            const auto pairP4 = col.at(i) + col.at(j);
+            if (static_cast<float>(pairP4.M()) > cuts.maxMass) {
+                continue;
+            }
+            for (std::size_t k = j + 1; k < n; ++k) {
+                if (cuts.totalCharge &&
+                    cuts.charges[i] + cuts.charges[j] + cuts.charges[k] !=
+                        *cuts.totalCharge) {
+                    continue;
+                }
+                if (!passDeltaR(in, i, in, k, cuts) ||
+                    !passDeltaR(in, j, in, k, cuts)) {
+                    continue;
+                }
+                const ObjectTriplet triplet{pairP4 + col.at(k), i, j, k};
+                if (passMass(triplet.p4, cuts)) {
+                    visit(triplet);
+                }
+            }
+        }
+    }
+}
+
+/**
+ * @brief Pair passing @p cuts whose mass is closest to @p targetMass.
+ * @return The best pair, or @c std::nullopt if no pair passes.
+ */
+inline std::optional<ObjectPair>
+bestPairByMass(const PhysicsObjectCollection &col, float targetMass,
+               const CombinatoricCuts &cuts = {}) {
+    std::optional<ObjectPair> best;
+    double bestDistance = 0.0;
+    forEachPair(col, [&](const ObjectPair &pair) {
+        const double distance = std::abs(pair.p4.M() - targetMass);
+        if (!best || distance < bestDistance) {
+            best = pair;
+            bestDistance = distance;
+        }
+    }, cuts);
+    return best;
+}
+
+/**
+ * @brief Cross pair passing @p cuts whose mass is closest to @p targetMass.
+ * @return The best pair, or @c std::nullopt if no pair passes.
+ */
+inline std::optional<ObjectPair>
+bestCrossPairByMass(const PhysicsObjectCollection &col1,
+                    const PhysicsObjectCollection &col2, float targetMass,
+                    const CombinatoricCuts &cuts = {}) {
+    std::optional<ObjectPair> best;
+    double bestDistance = 0.0;
+    forEachCrossPair(col1, col2, [&](const ObjectPair &pair) {
+        const double distance = std::abs(pair.p4.M() - targetMass);
+        if (!best || distance < bestDistance) {
+            best = pair;
+            bestDistance = distance;
+        }
+    }, cuts);
+    return best;
+}
+
+/**
+ * @brief Triplet passing @p cuts whose mass is closest to @p targetMass.
+ * @return The best triplet, or @c std::nullopt if no triplet passes.
+ */
+inline std::optional<ObjectTriplet>
+bestTripletByMass(const PhysicsObjectCollection &col, float targetMass,
+                  const CombinatoricCuts &cuts = {}) {
+    std::optional<ObjectTriplet> best;
+    double bestDistance = 0.0;
+    forEachTriplet(col, [&](const ObjectTriplet &triplet) {
+        const double distance = std::abs(triplet.p4.M() - targetMass);
+        if (!best || distance < bestDistance) {
+            best = triplet;
+            bestDistance = distance;
+        }
+    }, cuts);
+    return best;
+}
+
+/**
+ * @brief Pair passing @p cuts with the largest pT of the summed 4-vector.
+ * @return The best pair, or @c std::nullopt if no pair passes.
+ */
+inline std::optional<ObjectPair>
+highestPtPair(const PhysicsObjectCollection &col,
+              const CombinatoricCuts &cuts = {}) {
+    std::optional<ObjectPair> best;
+    double bestPt = 0.0;
+    forEachPair(col, [&](const ObjectPair &pair) {
+        const double pt = pair.p4.Pt();
+        if (!best || pt > bestPt) {
+            best = pair;
+            bestPt = pt;
+        }
+    }, cuts);
+    return best;
+}
+
+/**
+ * @brief Triplet passing @p cuts with the largest pT of the summed 4-vector.
+ * @return The best triplet, or @c std::nullopt if no triplet passes.
+ */
+inline std::optional<ObjectTriplet>
+highestPtTriplet(const PhysicsObjectCollection &col,
+                 const CombinatoricCuts &cuts = {}) {
+    std::optional<ObjectTriplet> best;
+    double bestPt = 0.0;
+    forEachTriplet(col, [&](const ObjectTriplet &triplet) {
+        const double pt = triplet.p4.Pt();
+        if (!best || pt > bestPt) {
+            best = triplet;
+            bestPt = pt;
+        }
+    }, cuts);
+    return best;
+}
+
+/**
+ * @brief Delta variant of @ref makePairs for a varied collection.
+ *
+ * @p varied must come from @ref PhysicsObjectCollection::withVariedKinematics
+ * on the nominal collection and @p nominalPairs from makePairs() on that
+ * nominal collection, so both share the same object order.  Pairs of two
+ * unchanged objects reuse the nominal 4-vector sum; when no object changed
+ * @p nominalPairs is returned as is.
+ *
+ * @param varied       Varied collection.
+ * @param changed      Per-object change flags of @p varied.
+ * @param nominalPairs makePairs() of the nominal collection.
+ * @return Vector of all unique pairs of @p varied, ordered as in makePairs().
+ * @throws std::runtime_error if the sizes of the inputs are inconsistent.
+ */
+inline std::vector<ObjectPair>
+makePairs(const PhysicsObjectCollection &varied,
+          const ROOT::VecOps::RVec<bool> &changed,
+          const std::vector<ObjectPair> &nominalPairs) {
+    const std::size_t n = varied.size();
+    if (changed.size() != n || nominalPairs.size() != n * (n - 1) / 2) {
+        throw std::runtime_error(
+            "makePairs: changed mask or nominal pairs do not match the "
+            "varied collection");
+    }
+    if (std::none_of(changed.begin(), changed.end(),
+                     [](bool c) { return c; })) {
+        return nominalPairs;
+    }
+    std::vector<ObjectPair> pairs;
+    pairs.reserve(nominalPairs.size());
+    std::size_t k = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+        for (std::size_t j = i + 1; j < n; ++j, ++k) {
+            if (changed[i] || changed[j]) {
+                pairs.push_back({varied.at(i) + varied.at(j), i, j});
+            } else {
+                pairs.push_back(nominalPairs[k]);
+            }
+        }
+    }
+    return pairs;
+}
+
+/**
+ * @brief Return @p nominalResult when a variation moved no object in the
+ *        event, otherwise evaluate @p compute().
+ *
+ * @code
+ * // HT of the varied jets, reusing the nominal HT for untouched events.
+ * float ht = reuseNominalIfUnchanged(changed, nominalHT,
+ *                                    [&] { return computeHT(variedJets); });
+ * @endcode
+ *
+ * @param changed       Per-object change flags of the varied collection.
+ * @param nominalResult Result computed from the nominal collection.
+ * @param compute       Callable computing the result from the varied inputs.
+ */
+template <typename R, typename F>
+R reuseNominalIfUnchanged(const ROOT::VecOps::RVec<bool> &changed,
+                          const R &nominalResult, F &&compute) {
+    if (std::none_of(changed.begin(), changed.end(),
+                     [](bool c) { return c; })) {
+        return nominalResult;
+    }
+    return compute();
+}
+
+// ============================================================================
+// TypedPhysicsObjectCollection<T>
+// ============================================================================
+
+/**
+ * @class TypedPhysicsObjectCollection
+ * @brief Extends PhysicsObjectCollection to additionally store a
+ *        user-defined object of type @p ObjectType for each selected entry.
+ *
+ * This allows analyses to attach arbitrary per-object data (e.g. custom
+ * calibration structs, resolved-object records, or decorated objects) to the
+ * standard 4-vector + index representation.
+ *
+ * @tparam ObjectType  The user-defined type stored per selected object.
+ *
+ * ### Example
+ * @code
+ * struct JetInfo { float btagScore; int flavour; };
+ *
+ * auto col = TypedPhysicsObjectCollection<JetInfo>(
+ *     pt, eta, phi, mass, mask,
+ *     allJetInfo);   // std::vector<JetInfo> with one entry per jet
+ *
+ * JetInfo& info = col.object(0);
+ * @endcode
+ */
+template <typename ObjectType>
+class TypedPhysicsObjectCollection : public PhysicsObjectCollection {
+public:
+    // ------------------------------------------------------------------
+    // Constructors
+    // ------------------------------------------------------------------
+
+    /**
+     * @brief Default constructor – creates an empty typed collection.
+     */
+    TypedPhysicsObjectCollection() = default;
+
+    /**
+     * @brief Build from pt/eta/phi/mass, a boolean mask, and a parallel
+     *        vector of user-defined objects.
+     *
+     * The @p objectsAll vector must have the same length as @p pt.  Only
+     * entries where @p mask is @c true are included.
+     *
+     * @param pt         Transverse momenta of all objects.
+     * @param eta        Pseudorapidities of all objects.
+     * @param phi        Azimuthal angles of all objects.
+     * @param mass       Masses of all objects.
+     * @param mask       Boolean selection mask (same length as @p pt).
+     * @param objectsAll Full vector of user objects (same length as @p pt).
+     * @throws std::runtime_error if @p objectsAll has a different size than
+     *         @p pt, or if the pt/eta/phi/mass vectors are inconsistent.
+     */
+    TypedPhysicsObjectCollection(const ROOT::VecOps::RVec<Float_t> &pt,
+                                 const ROOT::VecOps::RVec<Float_t> &eta,
+                                 const ROOT::VecOps::RVec<Float_t> &phi,
+                                 const ROOT::VecOps::RVec<Float_t> &mass,
+                                 const ROOT::VecOps::RVec<bool>    &mask,
+                                 const std::vector<ObjectType>     &objectsAll)
+        : PhysicsObjectCollection(pt, eta, phi, mass, mask) {
+        if (objectsAll.size() != pt.size()) {
+            throw std::runtime_error(
+                "TypedPhysicsObjectCollection: objects size mismatch");
+        }
+        for (std::size_t i = 0; i < mask.size(); ++i) {
+            if (mask[i]) {
+                objects_m.push_back(objectsAll[i]);
+            }
+        }
+    }
+
+    /**
+     * @brief Build from pt/eta/phi/mass, a packed selection mask, and a
+     *        parallel vector of user-defined objects.
+     *
+     * @param mask       Packed selection mask (same length as @p pt).
+     * @param objectsAll Full vector of user objects (same length as @p pt).
+     * @throws std::runtime_error if @p objectsAll has a different size than
+     *         @p pt, or if the pt/eta/phi/mass vectors are inconsistent.
+     */
+    TypedPhysicsObjectCollection(const ROOT::VecOps::RVec<Float_t> &pt,
+                                 const ROOT::VecOps::RVec<Float_t> &eta,
+                                 const ROOT::VecOps::RVec<Float_t> &phi,
+                                 const ROOT::VecOps::RVec<Float_t> &mass,
+                                 const ObjectMask                  &mask,
+                                 const std::vector<ObjectType>     &objectsAll)
+        : PhysicsObjectCollection(pt, eta, phi, mass, mask) {
+        if (objectsAll.size() != pt.size()) {
+            throw std::runtime_error(
+                "TypedPhysicsObjectCollection: objects size mismatch");
+        }
+        objects_m.reserve(this->size());
+        mask.forEach([&](std::size_t i) { objects_m.push_back(objectsAll[i]); });
+    }
+
+    /**
+     * @brief Build from pt/eta/phi/mass, an explicit index list, and a
+     *        parallel vector of user-defined objects.
+     *
+     * The @p objectsAll vector must have the same length as @p pt.  Only
+     * entries at the given @p indices are included; out-of-bounds indices are
+     * silently skipped (consistent with the base-class behaviour).
+     *
+     * @param pt         Transverse momenta of all objects.
+     * @param eta        Pseudorapidities of all objects.
+     * @param phi        Azimuthal angles of all objects.
+     * @param mass       Masses of all objects.
+     * @param indices    Indices into the full collection to include.
+     * @param objectsAll Full vector of user objects (same length as @p pt).
+     * @throws std::runtime_error if @p objectsAll has a different size than
+     *         @p pt, or if the pt/eta/phi/mass vectors are inconsistent.
+     */
     TypedPhysicsObjectCollection(const ROOT::VecOps::RVec<Float_t> &pt,
                                  const ROOT::VecOps::RVec<Float_t> &eta,
                                  const ROOT::VecOps::RVec<Float_t> &phi,
@@ -732,7 +1501,7 @@ public:
      * @brief Access all stored user-defined objects.
      * @return Const reference to the internal vector of user objects.
      */
-    const std::vector<ObjectType> &objects() const { return objects_m; }
+    const std::vector<ObjectType> &objects() const { return objects_m.get(); }
 
     // ------------------------------------------------------------------
     // Sub-collection filtering (typed override)
@@ -768,6 +1537,26 @@ public:
         return result;
     }
 
+    /// @copydoc withFilter(const ROOT::VecOps::RVec<bool> &) const
+    TypedPhysicsObjectCollection<ObjectType>
+    withFilter(const ObjectMask &mask) const {
+        if (mask.size() != this->size()) {
+            throw std::runtime_error(
+                "TypedPhysicsObjectCollection::withFilter: mask size mismatch");
+        }
+        TypedPhysicsObjectCollection<ObjectType> result;
+        const std::size_t n = mask.count();
+        result.vectors_m.reserve(n);
+        result.indices_m.reserve(n);
+        result.objects_m.reserve(n);
+        mask.forEach([&](std::size_t i) {
+            result.vectors_m.push_back(this->vectors_m[i]);
+            result.indices_m.push_back(this->indices_m[i]);
+            result.objects_m.push_back(objects_m[i]);
+        });
+        return result;
+    }
+
     // ------------------------------------------------------------------
     // Correction application (typed overrides)
     // ------------------------------------------------------------------
@@ -779,7 +1568,8 @@ public:
      * Each input array is indexed by position in the *original* (full,
      * unfiltered) collection.  User-defined objects are carried over
      * unchanged since corrections affect only the 4-momenta.
-     * The cached-feature store is *not* propagated.
+     * The indices, the user objects and the @ref cacheObjectFeature entries
+     * are shared with this collection.
      *
      * @param correctedPt   Corrected pt for the full collection.
      * @param correctedEta  Corrected eta for the full collection.
@@ -803,9 +1593,9 @@ public:
                 "input vector size mismatch");
         }
         TypedPhysicsObjectCollection<ObjectType> result;
-        result.indices_m.reserve(this->size());
+        result.indices_m = this->indices_m;
+        result.objects_m = objects_m;
         result.vectors_m.reserve(this->size());
-        result.objects_m.reserve(this->size());
         for (std::size_t i = 0; i < this->size(); ++i) {
             const auto idx = this->indices_m[i];
             if (idx < 0 || static_cast<std::size_t>(idx) >= n) {
@@ -813,13 +1603,12 @@ public:
                     "TypedPhysicsObjectCollection::withCorrectedKinematics: "
                     "index out of range for corrected arrays");
             }
-            result.indices_m.push_back(idx);
             result.vectors_m.push_back(
                 PhysicsObjectCollection::makePtEtaPhiM(
                     correctedPt[idx], correctedEta[idx],
                     correctedPhi[idx], correctedMass[idx]));
-            result.objects_m.push_back(objects_m[i]);
         }
+        this->copyObjectFeatures(result);
         return result;
     }
 
@@ -839,9 +1628,9 @@ public:
     withCorrectedPt(const ROOT::VecOps::RVec<Float_t> &correctedPt) const {
         const auto n = correctedPt.size();
         TypedPhysicsObjectCollection<ObjectType> result;
-        result.indices_m.reserve(this->size());
+        result.indices_m = this->indices_m;
+        result.objects_m = objects_m;
         result.vectors_m.reserve(this->size());
-        result.objects_m.reserve(this->size());
         for (std::size_t i = 0; i < this->size(); ++i) {
             const auto idx = this->indices_m[i];
             if (idx < 0 || static_cast<std::size_t>(idx) >= n) {
@@ -853,43 +1642,1177 @@ public:
             const Float_t eta  = static_cast<Float_t>(old.Eta());
             const Float_t phi  = static_cast<Float_t>(old.Phi());
             const Float_t mass = static_cast<Float_t>(old.M());
-            result.indices_m.push_back(idx);
             result.vectors_m.push_back(
                 PhysicsObjectCollection::makePtEtaPhiM(
                     correctedPt[idx], eta, phi, mass));
-            result.objects_m.push_back(objects_m[i]);
         }
+        this->copyObjectFeatures(result);
         return result;
     }
 
 private:
-    std::vector<ObjectType> objects_m; ///< User-defined objects for each selected entry.
+    template <typename>
+    friend class TypedPhysicsObjectView;
+
+    /// User-defined objects for each selected entry, shared by the
+    /// corrected copies of the collection.
+    physics_object_detail::SharedArray<ObjectType> objects_m;
 };
 
 // ============================================================================
-// PhysicsObjectVariationMap – systematic variation support
+// TypedPhysicsObjectView<T> – non-owning typed collection
 // ============================================================================
 
 /**
- * @brief A named map of PhysicsObjectCollection instances representing
- *        systematic variations of the same object type.
+ * @class TypedPhysicsObjectView
+ * @brief Non-owning variant of @ref TypedPhysicsObjectCollection that
+ *        stores only the original indices of the selected objects.
  *
- * Typical convention:
- *  - Key @c "nominal" holds the central-value collection.
- *  - Keys like @c "JEC_up", @c "JEC_down" hold the corresponding varied
- *    collections.
+ * The kinematics and user objects are read from the full per-event arrays
+ * the view was built from, so building, filtering and correcting a view copy
+ * no 4-vectors and no user objects: @ref withFilter copies indices and
+ * @ref withCorrectedKinematics / @ref withCorrectedPt only point the view at
+ * the corrected arrays.  Indices are kept in an inline buffer of
+ * @ref kInlineCapacity, so a typical collection does not allocate.
+ *
+ * Kinematics are copy-on-write: @ref setKinematics copies the kinematics of
+ * the selected objects into the view the first time one of them is changed;
+ * the source arrays are never modified.
+ *
+ * The arrays a view refers to must outlive it.  They are normally the column
+ * values of the current RDataFrame entry, so a view must not be kept beyond
+ * the entry it was built for; use @ref toCollection to keep a copy.
+ * Temporaries are rejected at compile time.
+ *
+ * @tparam ObjectType The user-defined type stored per object.
  *
  * ### Example
  * @code
- * PhysicsObjectVariationMap jetVariations;
- * jetVariations["nominal"] = buildJets(pt_nom, eta, phi, mass_nom, mask);
- * jetVariations["JEC_up"]  = buildJets(pt_up,  eta, phi, mass_up,  mask_up);
- * jetVariations["JEC_down"]= buildJets(pt_dn,  eta, phi, mass_dn,  mask_dn);
- *
- * const auto& jets = jetVariations.at("nominal");
+ * auto jets = TypedPhysicsObjectView<JetInfo>(pt, eta, phi, mass, mask, allJetInfo);
+ * auto central = jets.withFilter(jets.getValue(absEta) < 2.4f)
+ *                    .withCorrectedPt(Jet_pt_corrected);
+ * float score = central.object(0).btagScore;
  * @endcode
  */
-using PhysicsObjectVariationMap =
-    std::unordered_map<std::string, PhysicsObjectCollection>;
+template <typename ObjectType>
+class TypedPhysicsObjectView {
+public:
+    /// Number of indices stored without a heap allocation.
+    static constexpr std::size_t kInlineCapacity = 8;
+
+    /// Lorentz-vector type returned by @ref p4 (same as the base class).
+    using LorentzVec = PhysicsObjectCollection::LorentzVec;
+
+    using Floats = ROOT::VecOps::RVec<Float_t>;
+
+    /**
+     * @brief View the objects of the full arrays where @p mask is @c true.
+     * @throws std::runtime_error if the arrays have inconsistent sizes.
+     */
+    TypedPhysicsObjectView(const Floats &pt, const Floats &eta, const Floats &phi,
+                           const Floats &mass, const ROOT::VecOps::RVec<bool> &mask,
+                           const std::vector<ObjectType> &objectsAll)
+        : pt_m(&pt), eta_m(&eta), phi_m(&phi), mass_m(&mass), objects_m(&objectsAll) {
+        checkSources("TypedPhysicsObjectView");
+        if (mask.size() != pt.size()) {
+            throw std::runtime_error("TypedPhysicsObjectView: input vector size mismatch");
+        }
+        for (std::size_t i = 0; i < mask.size(); ++i) {
+            if (mask[i]) {
+                indices_m.push_back(static_cast<Int_t>(i));
+            }
+        }
+    }
+
+    /**
+     * @brief View the objects of the full arrays whose bit of @p mask is set.
+     * @throws std::runtime_error if the arrays have inconsistent sizes.
+     */
+    TypedPhysicsObjectView(const Floats &pt, const Floats &eta, const Floats &phi,
+                           const Floats &mass, const ObjectMask &mask,
+                           const std::vector<ObjectType> &objectsAll)
+        : pt_m(&pt), eta_m(&eta), phi_m(&phi), mass_m(&mass), objects_m(&objectsAll) {
+        checkSources("TypedPhysicsObjectView");
+        if (mask.size() != pt.size()) {
+            throw std::runtime_error("TypedPhysicsObjectView: input vector size mismatch");
+        }
+        mask.forEach([this](std::size_t i) { indices_m.push_back(static_cast<Int_t>(i)); });
+    }
+
+    /**
+     * @brief View the objects of the full arrays at @p indices.
+     *
+     * Out-of-bounds indices are silently skipped, as for
+     * @ref TypedPhysicsObjectCollection.
+     * @throws std::runtime_error if the arrays have inconsistent sizes.
+     */
+    TypedPhysicsObjectView(const Floats &pt, const Floats &eta, const Floats &phi,
+                           const Floats &mass, const ROOT::VecOps::RVec<Int_t> &indices,
+                           const std::vector<ObjectType> &objectsAll)
+        : pt_m(&pt), eta_m(&eta), phi_m(&phi), mass_m(&mass), objects_m(&objectsAll) {
+        checkSources("TypedPhysicsObjectView");
+        for (Int_t idx : indices) {
+            if (idx >= 0 && static_cast<std::size_t>(idx) < pt.size()) {
+                indices_m.push_back(idx);
+            }
+        }
+    }
+
+    // A view must not refer to a temporary.
+    template <typename Selection>
+    TypedPhysicsObjectView(Floats &&, const Floats &, const Floats &, const Floats &,
+                           const Selection &, const std::vector<ObjectType> &) = delete;
+    template <typename Selection>
+    TypedPhysicsObjectView(const Floats &, Floats &&, const Floats &, const Floats &,
+                           const Selection &, const std::vector<ObjectType> &) = delete;
+    template <typename Selection>
+    TypedPhysicsObjectView(const Floats &, const Floats &, Floats &&, const Floats &,
+                           const Selection &, const std::vector<ObjectType> &) = delete;
+    template <typename Selection>
+    TypedPhysicsObjectView(const Floats &, const Floats &, const Floats &, Floats &&,
+                           const Selection &, const std::vector<ObjectType> &) = delete;
+    template <typename Selection>
+    TypedPhysicsObjectView(const Floats &, const Floats &, const Floats &, const Floats &,
+                           const Selection &, std::vector<ObjectType> &&) = delete;
+
+    // ------------------------------------------------------------------
+    // Size / access
+    // ------------------------------------------------------------------
+
+    /// Number of selected objects in this view.
+    std::size_t size() const { return indices_m.size(); }
+
+    /// Returns true if the view contains no objects.
+    bool empty() const { return indices_m.empty(); }
+
+    /// Original indices of the selected objects.
+    const ROOT::VecOps::RVecN<Int_t, kInlineCapacity> &indices() const { return indices_m; }
+
+    /**
+     * @brief Original index of the @p i -th selected object.
+     * @throws std::out_of_range if @p i is out of bounds.
+     */
+    Int_t index(std::size_t i) const {
+        checkIndex(i);
+        return indices_m[i];
+    }
+
+    /**
+     * @brief User object of the @p i -th selected object, in the source array.
+     * @throws std::out_of_range if @p i is out of bounds.
+     */
+    const ObjectType &object(std::size_t i) const {
+        return (*objects_m)[static_cast<std::size_t>(index(i))];
+    }
+
+    /// Transverse momentum of the @p i -th selected object.
+    Float_t pt(std::size_t i) const { return kinematic(i, 0, *pt_m); }
+    /// Pseudorapidity of the @p i -th selected object.
+    Float_t eta(std::size_t i) const { return kinematic(i, 1, *eta_m); }
+    /// Azimuthal angle of the @p i -th selected object.
+    Float_t phi(std::size_t i) const { return kinematic(i, 2, *phi_m); }
+    /// Mass of the @p i -th selected object.
+    Float_t mass(std::size_t i) const { return kinematic(i, 3, *mass_m); }
+
+    /**
+     * @brief 4-vector of the @p i -th selected object.
+     * @throws std::out_of_range if @p i is out of bounds.
+     */
+    LorentzVec p4(std::size_t i) const {
+        return TypedPhysicsObjectCollection<ObjectType>::makePtEtaPhiM(pt(i), eta(i), phi(i),
+                                                                       mass(i));
+    }
+
+    /**
+     * @brief Values of the selected objects in a branch of the full
+     *        collection; @c T(-9999) where the index is outside @p branch.
+     */
+    template <typename T>
+    ROOT::VecOps::RVec<T> getValue(const ROOT::VecOps::RVec<T> &branch) const {
+        ROOT::VecOps::RVec<T> result(size());
+        for (std::size_t i = 0; i < size(); ++i) {
+            const Int_t idx = indices_m[i];
+            result[i] = static_cast<std::size_t>(idx) >= branch.size() ? T(-9999) : branch[idx];
+        }
+        return result;
+    }
+
+    // ------------------------------------------------------------------
+    // Derived views
+    // ------------------------------------------------------------------
+
+    /**
+     * @brief View of the objects where @p mask (indexed by position in this
+     *        view) is @c true.
+     * @throws std::runtime_error if @p mask has a different size than this view.
+     */
+    TypedPhysicsObjectView withFilter(const ROOT::VecOps::RVec<bool> &mask) const {
+        if (mask.size() != size()) {
+            throw std::runtime_error("TypedPhysicsObjectView::withFilter: mask size mismatch");
+        }
+        TypedPhysicsObjectView result(*this, Empty{});
+        for (std::size_t i = 0; i < size(); ++i) {
+            if (!mask[i]) {
+                continue;
+            }
+            result.indices_m.push_back(indices_m[i]);
+            if (owned_m) {
+                for (std::size_t k = 0; k < 4; ++k) {
+                    result.owned_m->values[k].push_back(owned_m->values[k][i]);
+                }
+            }
+        }
+        return result;
+    }
+
+    /// @copydoc withFilter(const ROOT::VecOps::RVec<bool> &) const
+    TypedPhysicsObjectView withFilter(const ObjectMask &mask) const {
+        if (mask.size() != size()) {
+            throw std::runtime_error("TypedPhysicsObjectView::withFilter: mask size mismatch");
+        }
+        TypedPhysicsObjectView result(*this, Empty{});
+        mask.forEach([&](std::size_t i) {
+            result.indices_m.push_back(indices_m[i]);
+            if (owned_m) {
+                for (std::size_t k = 0; k < 4; ++k) {
+                    result.owned_m->values[k].push_back(owned_m->values[k][i]);
+                }
+            }
+        });
+        return result;
+    }
+
+    /**
+     * @brief The same objects with the kinematics of the corrected arrays
+     *        (indexed by original index); user objects are shared.
+     * @throws std::runtime_error if the corrected arrays have inconsistent sizes.
+     * @throws std::out_of_range  if a stored index is out of range.
+     */
+    TypedPhysicsObjectView withCorrectedKinematics(const Floats &correctedPt,
+                                                   const Floats &correctedEta,
+                                                   const Floats &correctedPhi,
+                                                   const Floats &correctedMass) const {
+        TypedPhysicsObjectView result(*this);
+        result.pt_m = &correctedPt;
+        result.eta_m = &correctedEta;
+        result.phi_m = &correctedPhi;
+        result.mass_m = &correctedMass;
+        result.owned_m.reset();
+        result.checkSources("TypedPhysicsObjectView::withCorrectedKinematics");
+        result.checkIndicesIn(correctedPt.size(), "withCorrectedKinematics");
+        return result;
+    }
+    TypedPhysicsObjectView withCorrectedKinematics(Floats &&, const Floats &, const Floats &,
+                                                   const Floats &) const = delete;
+    TypedPhysicsObjectView withCorrectedKinematics(const Floats &, Floats &&, const Floats &,
+                                                   const Floats &) const = delete;
+    TypedPhysicsObjectView withCorrectedKinematics(const Floats &, const Floats &, Floats &&,
+                                                   const Floats &) const = delete;
+    TypedPhysicsObjectView withCorrectedKinematics(const Floats &, const Floats &, const Floats &,
+                                                   Floats &&) const = delete;
+
+    /**
+     * @brief The same objects with corrected transverse momenta (indexed by
+     *        original index); eta, phi and mass are kept.
+     * @throws std::out_of_range if a stored index is out of range.
+     */
+    TypedPhysicsObjectView withCorrectedPt(const Floats &correctedPt) const {
+        TypedPhysicsObjectView result(*this);
+        result.checkIndicesIn(correctedPt.size(), "withCorrectedPt");
+        if (owned_m) {
+            // The other kinematics stay the (changed) copies.
+            result.owned_m = std::make_shared<Kinematics>(*owned_m);
+            for (std::size_t i = 0; i < size(); ++i) {
+                result.owned_m->values[0][i] = correctedPt[indices_m[i]];
+            }
+        } else {
+            result.pt_m = &correctedPt;
+        }
+        return result;
+    }
+    TypedPhysicsObjectView withCorrectedPt(Floats &&) const = delete;
+
+    /**
+     * @brief Change the kinematics of the @p i -th selected object.
+     *
+     * The first change copies the kinematics of the selected objects into
+     * the view; views this one was copied from are not affected.
+     * @throws std::out_of_range if @p i is out of bounds.
+     */
+    void setKinematics(std::size_t i, Float_t pt, Float_t eta, Float_t phi, Float_t mass) {
+        checkIndex(i);
+        if (!owned_m) {
+            owned_m = std::make_shared<Kinematics>();
+            for (std::size_t k = 0; k < size(); ++k) {
+                owned_m->values[0].push_back((*pt_m)[indices_m[k]]);
+                owned_m->values[1].push_back((*eta_m)[indices_m[k]]);
+                owned_m->values[2].push_back((*phi_m)[indices_m[k]]);
+                owned_m->values[3].push_back((*mass_m)[indices_m[k]]);
+            }
+        } else if (owned_m.use_count() > 1) {
+            owned_m = std::make_shared<Kinematics>(*owned_m);
+        }
+        owned_m->values[0][i] = pt;
+        owned_m->values[1][i] = eta;
+        owned_m->values[2][i] = phi;
+        owned_m->values[3][i] = mass;
+    }
+
+    /**
+     * @brief Owning copy, e.g. to keep the objects beyond the current entry.
+     */
+    TypedPhysicsObjectCollection<ObjectType> toCollection() const {
+        TypedPhysicsObjectCollection<ObjectType> result;
+        result.indices_m.assign(indices_m.begin(), indices_m.end());
+        result.vectors_m.reserve(size());
+        result.objects_m.reserve(size());
+        for (std::size_t i = 0; i < size(); ++i) {
+            result.vectors_m.push_back(p4(i));
+            result.objects_m.push_back(object(i));
+        }
+        return result;
+    }
+
+private:
+    /// Changed kinematics of the selected objects (pt, eta, phi, mass).
+    struct Kinematics {
+        std::array<ROOT::VecOps::RVecN<Float_t, kInlineCapacity>, 4> values;
+    };
+    struct Empty {};
+
+    /// Same sources as @p other, no objects.
+    TypedPhysicsObjectView(const TypedPhysicsObjectView &other, Empty)
+        : pt_m(other.pt_m), eta_m(other.eta_m), phi_m(other.phi_m), mass_m(other.mass_m),
+          objects_m(other.objects_m) {
+        if (other.owned_m) {
+            owned_m = std::make_shared<Kinematics>();
+        }
+    }
+
+    Float_t kinematic(std::size_t i, std::size_t k, const Floats &source) const {
+        checkIndex(i);
+        return owned_m ? owned_m->values[k][i] : source[indices_m[i]];
+    }
+
+    void checkIndex(std::size_t i) const {
+        if (i >= size()) {
+            throw std::out_of_range("TypedPhysicsObjectView: object index out of range");
+        }
+    }
+
+    void checkSources(const char *where) const {
+        const auto n = pt_m->size();
+        if (eta_m->size() != n || phi_m->size() != n || mass_m->size() != n ||
+            objects_m->size() != n) {
+            throw std::runtime_error(std::string(where) + ": input vector size mismatch");
+        }
+    }
+
+    void checkIndicesIn(std::size_t n, const char *where) const {
+        for (Int_t idx : indices_m) {
+            if (static_cast<std::size_t>(idx) >= n) {
+                throw std::out_of_range(std::string("TypedPhysicsObjectView::") + where +
+                                        ": index out of range for corrected arrays");
+            }
+        }
+    }
+
+    const Floats *pt_m;
+    const Floats *eta_m;
+    const Floats *phi_m;
+    const Floats *mass_m;
+    const std::vector<ObjectType> *objects_m;
+    ROOT::VecOps::RVecN<Int_t, kInlineCapacity> indices_m; ///< Original indices.
+    std::shared_ptr<Kinematics> owned_m; ///< Set once kinematics were changed.
+};
+
+// ============================================================================
+// SoAPhysicsObjectCollection – structure-of-arrays layout
+// ============================================================================
+
+/**
+ * @class SoAPhysicsObjectCollection
+ * @brief Structure-of-arrays variant of @ref PhysicsObjectCollection with
+ *        typed, compile-time indexed feature slots.
+ *
+ * The selected objects are stored as contiguous pt, eta, phi, mass, px, py,
+ * pz and energy arrays plus their original indices.  Every array keeps up to
+ * @ref kInlineCapacity objects in an inline buffer, so building or filtering
+ * a typical jet or lepton collection does not allocate.  Filtering, overlap
+ * removal and pt corrections work on the arrays directly and only recompute
+ * the Cartesian components of objects whose kinematics change.
+ *
+ * Derived per-collection quantities are stored in typed slots instead of the
+ * name-keyed @c std::any cache of @ref PhysicsObjectCollection: slot @c I has
+ * the @c I -th type of @p Features and is accessed with @ref feature<I>(),
+ * so a lookup is a tuple access checked by the compiler.  Feature slots are
+ * *not* propagated to derived collections, as for the base class.
+ *
+ * @tparam Features Types of the feature slots, in slot order.
+ *
+ * ### Example
+ * @code
+ * enum JetSlot : std::size_t { BTag = 0, NConstituents = 1 };
+ * using Jets = SoAPhysicsObjectCollection<RVec<float>, int>;
+ *
+ * Jets jets(pt, eta, phi, mass, mask);
+ * jets.cacheFeature<BTag>(jets.getValue(Jet_btagScore));
+ * const auto &scores = jets.feature<BTag>();
+ * const float leadPx = jets.px()[0];
+ * @endcode
+ */
+template <typename... Features>
+class SoAPhysicsObjectCollection {
+public:
+    /// Number of objects stored without a heap allocation.
+    static constexpr std::size_t kInlineCapacity = 8;
+
+    /// Contiguous per-object array with an inline small buffer.
+    template <typename T>
+    using Array = ROOT::VecOps::RVecN<T, kInlineCapacity>;
+
+    /// Lorentz-vector type returned by @ref p4 (same as the base class).
+    using LorentzVec = PhysicsObjectCollection::LorentzVec;
+
+    /// Type stored in feature slot @p I.
+    template <std::size_t I>
+    using FeatureType = std::tuple_element_t<I, std::tuple<Features...>>;
+
+    // ------------------------------------------------------------------
+    // Constructors
+    // ------------------------------------------------------------------
+
+    /**
+     * @brief Default constructor – creates an empty collection.
+     */
+    SoAPhysicsObjectCollection() = default;
+
+    /**
+     * @brief Build a collection from pt/eta/phi/mass columns and a boolean
+     *        selection mask.
+     *
+     * @param pt   Transverse momenta of all objects.
+     * @param eta  Pseudorapidities of all objects.
+     * @param phi  Azimuthal angles of all objects.
+     * @param mass Masses of all objects.
+     * @param mask Boolean selection mask (same length as pt).
+     * @throws std::runtime_error if the input vectors have inconsistent sizes.
+     */
+    SoAPhysicsObjectCollection(const ROOT::VecOps::RVec<Float_t> &pt,
+                               const ROOT::VecOps::RVec<Float_t> &eta,
+                               const ROOT::VecOps::RVec<Float_t> &phi,
+                               const ROOT::VecOps::RVec<Float_t> &mass,
+                               const ROOT::VecOps::RVec<bool> &mask) {
+        const auto n = pt.size();
+        if (eta.size() != n || phi.size() != n || mass.size() != n ||
+            mask.size() != n) {
+            throw std::runtime_error(
+                "SoAPhysicsObjectCollection: input vector size mismatch");
+        }
+        for (std::size_t i = 0; i < n; ++i) {
+            if (mask[i]) {
+                append(static_cast<Int_t>(i), pt[i], eta[i], phi[i], mass[i]);
+            }
+        }
+    }
+
+    /**
+     * @brief Build a collection from pt/eta/phi/mass columns and a packed
+     *        selection mask.
+     * @throws std::runtime_error if the input vectors have inconsistent sizes.
+     */
+    SoAPhysicsObjectCollection(const ROOT::VecOps::RVec<Float_t> &pt,
+                               const ROOT::VecOps::RVec<Float_t> &eta,
+                               const ROOT::VecOps::RVec<Float_t> &phi,
+                               const ROOT::VecOps::RVec<Float_t> &mass,
+                               const ObjectMask &mask) {
+        const auto n = pt.size();
+        if (eta.size() != n || phi.size() != n || mass.size() != n ||
+            mask.size() != n) {
+            throw std::runtime_error(
+                "SoAPhysicsObjectCollection: input vector size mismatch");
+        }
+        mask.forEach([&](std::size_t i) {
+            append(static_cast<Int_t>(i), pt[i], eta[i], phi[i], mass[i]);
+        });
+    }
+
+    /**
+     * @brief Build a collection from pt/eta/phi/mass columns and an explicit
+     *        list of indices.
+     *
+     * Indices outside the valid range are silently skipped, as for
+     * @ref PhysicsObjectCollection.
+     *
+     * @param pt      Transverse momenta of all objects.
+     * @param eta     Pseudorapidities of all objects.
+     * @param phi     Azimuthal angles of all objects.
+     * @param mass    Masses of all objects.
+     * @param indices Indices into the full collection to include.
+     * @throws std::runtime_error if the pt/eta/phi/mass vectors have
+     *         inconsistent sizes.
+     */
+    SoAPhysicsObjectCollection(const ROOT::VecOps::RVec<Float_t> &pt,
+                               const ROOT::VecOps::RVec<Float_t> &eta,
+                               const ROOT::VecOps::RVec<Float_t> &phi,
+                               const ROOT::VecOps::RVec<Float_t> &mass,
+                               const ROOT::VecOps::RVec<Int_t> &indices) {
+        const auto n = pt.size();
+        if (eta.size() != n || phi.size() != n || mass.size() != n) {
+            throw std::runtime_error(
+                "SoAPhysicsObjectCollection: input vector size mismatch");
+        }
+        for (Int_t idx : indices) {
+            if (idx < 0 || static_cast<std::size_t>(idx) >= n) {
+                continue;
+            }
+            append(idx, pt[idx], eta[idx], phi[idx], mass[idx]);
+        }
+    }
+
+    /**
+     * @brief Convert an array-of-structures @ref PhysicsObjectCollection.
+     *
+     * The cached-feature store of @p col is not converted.
+     *
+     * @param col Collection to convert.
+     */
+    explicit SoAPhysicsObjectCollection(const PhysicsObjectCollection &col) {
+        for (std::size_t i = 0; i < col.size(); ++i) {
+            const LorentzVec &v = col.at(i);
+            indices_m.push_back(col.index(i));
+            pt_m.push_back(static_cast<Float_t>(v.Pt()));
+            eta_m.push_back(static_cast<Float_t>(v.Eta()));
+            phi_m.push_back(static_cast<Float_t>(v.Phi()));
+            mass_m.push_back(static_cast<Float_t>(v.M()));
+            px_m.push_back(v.Px());
+            py_m.push_back(v.Py());
+            pz_m.push_back(v.Pz());
+            energy_m.push_back(static_cast<Float_t>(v.E()));
+        }
+    }
+
+    /**
+     * @brief Convert to an array-of-structures @ref PhysicsObjectCollection.
+     *
+     * Feature slots are not converted.
+     *
+     * @return Collection with the same objects and original indices.
+     */
+    PhysicsObjectCollection toCollection() const {
+        PhysicsObjectCollection result;
+        result.indices_m.assign(indices_m.begin(), indices_m.end());
+        result.vectors_m.reserve(size());
+        for (std::size_t i = 0; i < size(); ++i) {
+            result.vectors_m.emplace_back(px_m[i], py_m[i], pz_m[i], mass_m[i]);
+        }
+        return result;
+    }
+
+    // ------------------------------------------------------------------
+    // Size / access
+    // ------------------------------------------------------------------
+
+    /// Number of selected objects in this collection.
+    std::size_t size() const { return indices_m.size(); }
+
+    /// Returns true if the collection contains no objects.
+    bool empty() const { return indices_m.empty(); }
+
+    /// Transverse momenta of the selected objects.
+    const Array<Float_t> &pt() const { return pt_m; }
+    /// Pseudorapidities of the selected objects.
+    const Array<Float_t> &eta() const { return eta_m; }
+    /// Azimuthal angles of the selected objects.
+    const Array<Float_t> &phi() const { return phi_m; }
+    /// Masses of the selected objects.
+    const Array<Float_t> &mass() const { return mass_m; }
+    /// x components of the momenta.
+    const Array<Float_t> &px() const { return px_m; }
+    /// y components of the momenta.
+    const Array<Float_t> &py() const { return py_m; }
+    /// z components of the momenta.
+    const Array<Float_t> &pz() const { return pz_m; }
+    /// Energies of the selected objects.
+    const Array<Float_t> &energy() const { return energy_m; }
+    /// Original indices of the selected objects.
+    const Array<Int_t> &indices() const { return indices_m; }
+
+    /**
+     * @brief Original index (in the full collection) of the @p i -th
+     *        selected object.
+     * @throws std::out_of_range if @p i is out of bounds.
+     */
+    Int_t index(std::size_t i) const {
+        checkIndex(i);
+        return indices_m[i];
+    }
+
+    /**
+     * @brief 4-vector of the @p i -th selected object.
+     * @throws std::out_of_range if @p i is out of bounds.
+     */
+    LorentzVec p4(std::size_t i) const {
+        checkIndex(i);
+        return LorentzVec(px_m[i], py_m[i], pz_m[i], mass_m[i]);
+    }
+
+    /**
+     * @brief Extract the values for the selected objects from a feature
+     *        branch of the full collection.
+     *
+     * Entries whose stored index is outside @p branch are replaced with the
+     * sentinel value @c T(-9999).
+     */
+    template <typename T>
+    ROOT::VecOps::RVec<T>
+    getValue(const ROOT::VecOps::RVec<T> &branch) const {
+        ROOT::VecOps::RVec<T> result(size());
+        for (std::size_t i = 0; i < size(); ++i) {
+            const Int_t idx = indices_m[i];
+            result[i] = (idx < 0 || static_cast<std::size_t>(idx) >= branch.size())
+                            ? T(-9999)
+                            : branch[idx];
+        }
+        return result;
+    }
+
+    // ------------------------------------------------------------------
+    // Typed feature slots
+    // ------------------------------------------------------------------
+
+    /**
+     * @brief Store a derived feature in slot @p I.
+     * @param value Value to store; an existing value is overwritten.
+     */
+    template <std::size_t I>
+    void cacheFeature(FeatureType<I> value) {
+        std::get<I>(features_m) = std::move(value);
+        cachedMask_m |= (1ull << I);
+    }
+
+    /**
+     * @brief Retrieve the feature stored in slot @p I.
+     * @throws std::runtime_error if slot @p I was not filled.
+     */
+    template <std::size_t I>
+    const FeatureType<I> &feature() const {
+        if (!hasFeature<I>()) {
+            throw std::runtime_error(
+                "SoAPhysicsObjectCollection: feature slot " +
+                std::to_string(I) + " not cached");
+        }
+        return std::get<I>(features_m);
+    }
+
+    /// Check whether slot @p I has been filled with @ref cacheFeature.
+    template <std::size_t I>
+    bool hasFeature() const {
+        return (cachedMask_m & (1ull << I)) != 0;
+    }
+
+    // ------------------------------------------------------------------
+    // Derived collections
+    // ------------------------------------------------------------------
+
+    /**
+     * @brief Return a new collection containing only the objects where
+     *        @p mask is @c true.
+     *
+     * @param mask Boolean mask of length @ref size().
+     * @throws std::runtime_error if @p mask has a different size.
+     */
+    SoAPhysicsObjectCollection withFilter(const ROOT::VecOps::RVec<bool> &mask) const {
+        if (mask.size() != size()) {
+            throw std::runtime_error(
+                "SoAPhysicsObjectCollection::withFilter: mask size mismatch");
+        }
+        SoAPhysicsObjectCollection result;
+        for (std::size_t i = 0; i < size(); ++i) {
+            if (mask[i]) {
+                result.copyFrom(*this, i);
+            }
+        }
+        return result;
+    }
+
+    /// @copydoc withFilter(const ROOT::VecOps::RVec<bool> &) const
+    SoAPhysicsObjectCollection withFilter(const ObjectMask &mask) const {
+        if (mask.size() != size()) {
+            throw std::runtime_error(
+                "SoAPhysicsObjectCollection::withFilter: mask size mismatch");
+        }
+        SoAPhysicsObjectCollection result;
+        mask.forEach([&](std::size_t i) { result.copyFrom(*this, i); });
+        return result;
+    }
+
+    /**
+     * @brief Return a new collection with objects within ΔR < @p deltaRMin
+     *        of any object in @p other removed.
+     *
+     * ΔR is computed from the stored eta/phi arrays without rebuilding
+     * 4-vectors.
+     */
+    template <typename... OtherFeatures>
+    SoAPhysicsObjectCollection
+    removeOverlap(const SoAPhysicsObjectCollection<OtherFeatures...> &other,
+                  float deltaRMin) const {
+        const float minDR2 = deltaRMin * deltaRMin;
+        SoAPhysicsObjectCollection result;
+        for (std::size_t i = 0; i < size(); ++i) {
+            bool overlaps = false;
+            for (std::size_t j = 0; j < other.size(); ++j) {
+                const float dEta = eta_m[i] - other.eta()[j];
+                const float dPhi = wrapPhi(phi_m[i] - other.phi()[j]);
+                if (dEta * dEta + dPhi * dPhi < minDR2) {
+                    overlaps = true;
+                    break;
+                }
+            }
+            if (!overlaps) {
+                result.copyFrom(*this, i);
+            }
+        }
+        return result;
+    }
+
+    /**
+     * @brief Return a new collection with corrected transverse momenta.
+     *
+     * @p correctedPt is indexed by position in the original collection.
+     * Objects whose pt is unchanged keep their Cartesian components; the
+     * others are rescaled by the pt ratio, so no trigonometric function is
+     * evaluated.
+     *
+     * @throws std::out_of_range if a stored index is out of range for
+     *         @p correctedPt.
+     */
+    SoAPhysicsObjectCollection withCorrectedPt(
+        const ROOT::VecOps::RVec<Float_t> &correctedPt) const {
+        SoAPhysicsObjectCollection result;
+        for (std::size_t i = 0; i < size(); ++i) {
+            const auto idx = indices_m[i];
+            if (idx < 0 || static_cast<std::size_t>(idx) >= correctedPt.size()) {
+                throw std::out_of_range(
+                    "SoAPhysicsObjectCollection::withCorrectedPt: "
+                    "index out of range for correctedPt");
+            }
+            result.copyFrom(*this, i);
+            const Float_t newPt = correctedPt[idx];
+            if (newPt == pt_m[i]) {
+                continue;
+            }
+            const std::size_t k = result.size() - 1;
+            if (pt_m[i] != 0.f) {
+                const Float_t scale = newPt / pt_m[i];
+                result.pt_m[k] = newPt;
+                result.px_m[k] = px_m[i] * scale;
+                result.py_m[k] = py_m[i] * scale;
+                result.pz_m[k] = pz_m[i] * scale;
+                result.energy_m[k] = cartesianEnergy(
+                    result.px_m[k], result.py_m[k], result.pz_m[k], mass_m[i]);
+            } else {
+                result.setKinematics(k, newPt, eta_m[i], phi_m[i], mass_m[i]);
+            }
+        }
+        return result;
+    }
+
+    /**
+     * @brief Return a new collection rebuilt from corrected pt/eta/phi/mass
+     *        arrays indexed by position in the original collection.
+     *
+     * @throws std::runtime_error if the corrected arrays have inconsistent sizes.
+     * @throws std::out_of_range  if a stored index is out of range.
+     */
+    SoAPhysicsObjectCollection withCorrectedKinematics(
+        const ROOT::VecOps::RVec<Float_t> &correctedPt,
+        const ROOT::VecOps::RVec<Float_t> &correctedEta,
+        const ROOT::VecOps::RVec<Float_t> &correctedPhi,
+        const ROOT::VecOps::RVec<Float_t> &correctedMass) const {
+        const auto n = correctedPt.size();
+        if (correctedEta.size() != n || correctedPhi.size() != n ||
+            correctedMass.size() != n) {
+            throw std::runtime_error(
+                "SoAPhysicsObjectCollection::withCorrectedKinematics: "
+                "input vector size mismatch");
+        }
+        SoAPhysicsObjectCollection result;
+        for (std::size_t i = 0; i < size(); ++i) {
+            const auto idx = indices_m[i];
+            if (idx < 0 || static_cast<std::size_t>(idx) >= n) {
+                throw std::out_of_range(
+                    "SoAPhysicsObjectCollection::withCorrectedKinematics: "
+                    "index out of range for corrected arrays");
+            }
+            result.append(idx, correctedPt[idx], correctedEta[idx],
+                          correctedPhi[idx], correctedMass[idx]);
+        }
+        return result;
+    }
+
+private:
+    Array<Int_t>   indices_m; ///< Original indices of selected objects.
+    Array<Float_t> pt_m;      ///< Transverse momenta.
+    Array<Float_t> eta_m;     ///< Pseudorapidities.
+    Array<Float_t> phi_m;     ///< Azimuthal angles.
+    Array<Float_t> mass_m;    ///< Masses.
+    Array<Float_t> px_m;      ///< Momentum x components.
+    Array<Float_t> py_m;      ///< Momentum y components.
+    Array<Float_t> pz_m;      ///< Momentum z components.
+    Array<Float_t> energy_m;  ///< Energies.
+
+    static_assert(sizeof...(Features) <= 64,
+                  "SoAPhysicsObjectCollection supports at most 64 feature slots");
+    std::tuple<Features...> features_m; ///< Typed feature slots.
+    unsigned long long cachedMask_m = 0; ///< Bit I set when slot I is filled.
+
+    void checkIndex(std::size_t i) const {
+        if (i >= size()) {
+            throw std::out_of_range(
+                "SoAPhysicsObjectCollection: object index out of range");
+        }
+    }
+
+    static Float_t wrapPhi(Float_t dPhi) {
+        constexpr float kPi = 3.14159265f;
+        while (dPhi >  kPi) dPhi -= 2.f * kPi;
+        while (dPhi < -kPi) dPhi += 2.f * kPi;
+        return dPhi;
+    }
+
+    static Float_t cartesianEnergy(Float_t px, Float_t py, Float_t pz,
+                                   Float_t mass) {
+        return std::sqrt(px * px + py * py + pz * pz + mass * mass);
+    }
+
+    /// Append one object, computing its Cartesian components.
+    void append(Int_t idx, Float_t pt, Float_t eta, Float_t phi, Float_t mass) {
+        indices_m.push_back(idx);
+        pt_m.push_back(pt);
+        eta_m.push_back(eta);
+        phi_m.push_back(phi);
+        mass_m.push_back(mass);
+        px_m.push_back(0.f);
+        py_m.push_back(0.f);
+        pz_m.push_back(0.f);
+        energy_m.push_back(0.f);
+        setKinematics(size() - 1, pt, eta, phi, mass);
+    }
+
+    /// Overwrite the kinematics of stored object @p k.
+    void setKinematics(std::size_t k, Float_t pt, Float_t eta, Float_t phi,
+                       Float_t mass) {
+        pt_m[k] = pt;
+        eta_m[k] = eta;
+        phi_m[k] = phi;
+        mass_m[k] = mass;
+        px_m[k] = pt * std::cos(phi);
+        py_m[k] = pt * std::sin(phi);
+        pz_m[k] = pt * std::sinh(eta);
+        energy_m[k] = cartesianEnergy(px_m[k], py_m[k], pz_m[k], mass);
+    }
+
+    /// Append object @p i of @p source without recomputing anything.
+    void copyFrom(const SoAPhysicsObjectCollection &source, std::size_t i) {
+        indices_m.push_back(source.indices_m[i]);
+        pt_m.push_back(source.pt_m[i]);
+        eta_m.push_back(source.eta_m[i]);
+        phi_m.push_back(source.phi_m[i]);
+        mass_m.push_back(source.mass_m[i]);
+        px_m.push_back(source.px_m[i]);
+        py_m.push_back(source.py_m[i]);
+        pz_m.push_back(source.pz_m[i]);
+        energy_m.push_back(source.energy_m[i]);
+    }
+};
+
+// ============================================================================
+// PhysicsObjectVariationMap – systematic variation support
+// ============================================================================
+
+/**
+ * @brief A named map of PhysicsObjectCollection instances representing
+ *        systematic variations of the same object type.
+ *
+ * Typical convention:
+ *  - Key @c "nominal" holds the central-value collection.
+ *  - Keys like @c "JEC_up", @c "JEC_down" hold the corresponding varied
+ *    collections.
+ *
+ * The collections are stored contiguously, one slot per variation name.
+ * Names are resolved to slots by a @ref Keys table that is built once and
+ * shared by the maps of all events, so a map built from a @ref Keys table
+ * costs one allocation and reading a variation by slot is array indexing.
+ * Code that reads the same variation in every event should resolve its slot
+ * once with @ref Keys::slot and call @ref get(std::size_t) const.
+ *
+ * The name-based interface (@c operator[], @c at, @c find, @c count and
+ * iteration over (name, collection) pairs) matches the former
+ * @c std::unordered_map alias.  Iteration follows slot order.
+ *
+ * ### Example
+ * @code
+ * PhysicsObjectVariationMap jetVariations;
+ * jetVariations["nominal"] = buildJets(pt_nom, eta, phi, mass_nom, mask);
+ * jetVariations["JEC_up"]  = buildJets(pt_up,  eta, phi, mass_up,  mask_up);
+ * jetVariations["JEC_down"]= buildJets(pt_dn,  eta, phi, mass_dn,  mask_dn);
+ *
+ * const auto& jets = jetVariations.at("nominal");
+ * @endcode
+ */
+class PhysicsObjectVariationMap {
+public:
+    /**
+     * @brief Variation names and their slots.
+     *
+     * Slots are assigned 0, 1, 2, ... in insertion order.
+     */
+    class Keys {
+    public:
+        /// Returned by @ref slot for unknown names.
+        static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+        Keys() = default;
+        explicit Keys(const std::vector<std::string> &names) {
+            for (const auto &name : names) {
+                add(name);
+            }
+        }
+
+        /// Slot of @p name, appending it if new.
+        std::size_t add(const std::string &name) {
+            const auto [it, inserted] = slots_m.emplace(name, names_m.size());
+            if (inserted) {
+                names_m.push_back(name);
+            }
+            return it->second;
+        }
+
+        /// Slot of @p name, or @ref npos.
+        std::size_t slot(const std::string &name) const {
+            const auto it = slots_m.find(name);
+            return it == slots_m.end() ? npos : it->second;
+        }
+
+        const std::string &name(std::size_t slot) const { return names_m.at(slot); }
+        std::size_t size() const { return names_m.size(); }
+
+    private:
+        std::vector<std::string> names_m;
+        std::unordered_map<std::string, std::size_t> slots_m;
+    };
+
+    /// (name, collection) pair produced by iteration.
+    using value_type =
+        std::pair<const std::string &, const PhysicsObjectCollection &>;
+
+    /// Forward iterator over the filled slots.
+    class const_iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = PhysicsObjectVariationMap::value_type;
+        using difference_type = std::ptrdiff_t;
+        using reference = value_type;
+
+        /// Holds the pair returned by @c operator->.
+        struct Arrow {
+            value_type entry;
+            const value_type *operator->() const { return &entry; }
+        };
+
+        const_iterator() = default;
+        const_iterator(const PhysicsObjectVariationMap *map, std::size_t slot)
+            : map_m(map), slot_m(slot) {
+            skipEmpty();
+        }
+
+        value_type operator*() const {
+            return {map_m->keys_m->name(slot_m), map_m->values_m[slot_m]};
+        }
+        Arrow operator->() const { return {**this}; }
+        const_iterator &operator++() {
+            ++slot_m;
+            skipEmpty();
+            return *this;
+        }
+        const_iterator operator++(int) {
+            auto copy = *this;
+            ++*this;
+            return copy;
+        }
+        bool operator==(const const_iterator &other) const {
+            return slot_m == other.slot_m;
+        }
+        bool operator!=(const const_iterator &other) const {
+            return !(*this == other);
+        }
+
+        /// Slot of the current entry.
+        std::size_t slot() const { return slot_m; }
+
+    private:
+        void skipEmpty() {
+            while (slot_m < map_m->filled_m.size() && !map_m->filled_m[slot_m]) {
+                ++slot_m;
+            }
+        }
+
+        const PhysicsObjectVariationMap *map_m = nullptr;
+        std::size_t slot_m = 0;
+    };
+
+    PhysicsObjectVariationMap() = default;
+
+    /**
+     * @brief An empty map with one (unfilled) slot per name in @p keys.
+     * @param keys Shared name table, typically built once per column.
+     */
+    explicit PhysicsObjectVariationMap(std::shared_ptr<const Keys> keys)
+        : keys_m(std::move(keys)) {
+        if (!keys_m) {
+            throw std::runtime_error(
+                "PhysicsObjectVariationMap: null key table");
+        }
+        values_m.resize(keys_m->size());
+        filled_m.resize(keys_m->size(), false);
+    }
+
+    /// Name table of this map (empty for a default-constructed map).
+    const Keys &keys() const {
+        static const Keys empty;
+        return keys_m ? *keys_m : empty;
+    }
+
+    // ------------------------------------------------------------------
+    // Slot access
+    // ------------------------------------------------------------------
+
+    /// @c true if slot @p slot holds a collection.
+    bool contains(std::size_t slot) const {
+        return slot < filled_m.size() && filled_m[slot];
+    }
+
+    /**
+     * @brief The collection in slot @p slot.
+     * @throws std::out_of_range if the slot holds no collection.
+     */
+    const PhysicsObjectCollection &get(std::size_t slot) const {
+        if (!contains(slot)) {
+            throw std::out_of_range(
+                "PhysicsObjectVariationMap: slot " + std::to_string(slot) +
+                " holds no collection");
+        }
+        return values_m[slot];
+    }
+
+    /**
+     * @brief Store @p collection in slot @p slot, replacing any previous one.
+     * @throws std::out_of_range if @p slot is not in the key table.
+     */
+    void set(std::size_t slot, PhysicsObjectCollection collection) {
+        if (slot >= values_m.size()) {
+            throw std::out_of_range(
+                "PhysicsObjectVariationMap: slot " + std::to_string(slot) +
+                " is not in the key table");
+        }
+        values_m[slot] = std::move(collection);
+        if (!filled_m[slot]) {
+            filled_m[slot] = true;
+            ++size_m;
+        }
+    }
+
+    // ------------------------------------------------------------------
+    // Name access
+    // ------------------------------------------------------------------
+
+    std::size_t size() const { return size_m; }
+    bool empty() const { return size_m == 0; }
+
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, values_m.size()); }
+
+    /// Iterator to variation @p name, or @ref end.
+    const_iterator find(const std::string &name) const {
+        const std::size_t slot = keys().slot(name);
+        return contains(slot) ? const_iterator(this, slot) : end();
+    }
+
+    std::size_t count(const std::string &name) const {
+        return contains(keys().slot(name)) ? 1 : 0;
+    }
+
+    /**
+     * @brief The collection of variation @p name.
+     * @throws std::out_of_range if the map holds no such variation.
+     */
+    const PhysicsObjectCollection &at(const std::string &name) const {
+        const std::size_t slot = keys().slot(name);
+        if (!contains(slot)) {
+            throw std::out_of_range(
+                "PhysicsObjectVariationMap: no variation '" + name + "'");
+        }
+        return values_m[slot];
+    }
+
+    /**
+     * @brief The collection of variation @p name, default-constructed and
+     *        added to the key table if absent.
+     *
+     * Adding a name copies the key table if it is shared with other maps,
+     * and invalidates references returned earlier.
+     */
+    PhysicsObjectCollection &operator[](const std::string &name) {
+        const std::size_t slot = addKey(name);
+        if (!filled_m[slot]) {
+            filled_m[slot] = true;
+            ++size_m;
+        }
+        return values_m[slot];
+    }
+
+    /**
+     * @brief Add @p collection as variation @p name unless it is present.
+     * @return Iterator to the entry and whether it was inserted.
+     */
+    std::pair<const_iterator, bool> emplace(const std::string &name,
+                                            PhysicsObjectCollection collection) {
+        const std::size_t slot = addKey(name);
+        if (filled_m[slot]) {
+            return {const_iterator(this, slot), false};
+        }
+        set(slot, std::move(collection));
+        return {const_iterator(this, slot), true};
+    }
+
+private:
+    std::size_t addKey(const std::string &name) {
+        std::size_t slot = keys().slot(name);
+        if (slot != Keys::npos) {
+            return slot;
+        }
+        if (ownKeys_m && keys_m.use_count() == 1) {
+            slot = std::const_pointer_cast<Keys>(keys_m)->add(name);
+        } else {
+            auto table = keys_m ? std::make_shared<Keys>(*keys_m)
+                                : std::make_shared<Keys>();
+            slot = table->add(name);
+            keys_m = std::move(table);
+            ownKeys_m = true;
+        }
+        values_m.resize(keys_m->size());
+        filled_m.resize(keys_m->size(), false);
+        return slot;
+    }
+
+    std::shared_ptr<const Keys> keys_m;
+    /// Set when keys_m was created by this map and may be extended in place.
+    bool ownKeys_m = false;
+    std::vector<PhysicsObjectCollection> values_m;
+    std::vector<bool> filled_m;
+    std::size_t size_m = 0;
+};
 
 #endif // PHYSICSOBJECTCOLLECTION_H_INCLUDED
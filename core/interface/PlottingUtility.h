@@ -2,6 +2,7 @@
 #define PLOTTINGUTILITY_H_INCLUDED
 
 #include <TH1.h>
+#include <cstddef>
 #include <memory>
 #include <string>
 #include <vector>
@@ -32,6 +33,19 @@ struct PlotResult {
   std::string message;
   double mcIntegral = 0.0;
   double dataIntegral = 0.0;
+  /// The output was up to date and not rendered again.
+  bool skipped = false;
+};
+
+/// How PlottingUtility::makeStackPlots() runs a batch of requests.
+struct PlotBatchOptions {
+  /// Render on a pool of worker threads.
+  bool parallel = false;
+  /// Pool size; 0 uses the hardware concurrency.
+  unsigned int maxWorkers = 0;
+  /// Keep outputs whose inputs and style are unchanged since they were
+  /// written (recorded in a ``<outputFile>.hash`` file next to the plot).
+  bool skipUnchanged = false;
 };
 
 struct RatioSummary {
@@ -47,11 +61,58 @@ struct PCAResult {
   std::vector<double> explainedVariance;
 };
 
+class THnSparse;
+
+/**
+ * Streaming accumulator of the PCA envelope of many variations.
+ *
+ * Each variation is folded into a running mean and co-moment matrix
+ * (Welford update), so memory is independent of the number of variations
+ * and no histogram copy is kept.
+ */
+class PCAAccumulator {
+public:
+  explicit PCAAccumulator(int binCount);
+
+  /// Add one variation given as @c binCount contiguous bin contents.
+  void add(const double* contents);
+  /// Add the in-range bins of @p variation; false if its binning differs.
+  bool add(const TH1& variation);
+
+  int binCount() const { return binCount_m; }
+  std::size_t count() const { return count_m; }
+
+  /**
+   * Envelope around the mean of the variations, binned like @p nominal.
+   * @param maxComponents Keep only the leading principal components of the
+   *        bin correlation matrix (truncated decomposition); 0 keeps all.
+   */
+  PCAResult finalize(const TH1D& nominal, const std::string& baseName = "pca",
+                     int maxComponents = 0) const;
+
+private:
+  int binCount_m;
+  std::size_t count_m = 0;
+  std::vector<double> mean_m;
+  /// Sum of outer products of deviations, row-major binCount x binCount.
+  std::vector<double> comoment_m;
+};
+
 class PlottingUtility {
 public:
   PlotResult makeStackPlot(const PlotRequest& request) const;
   std::vector<PlotResult> makeStackPlots(const std::vector<PlotRequest>& requests,
                                          bool parallel = false) const;
+  /**
+   * Every input histogram of the batch is read once, file by file, into a
+   * read-only cache; the plots are then rendered from the cache, on at most
+   * PlotBatchOptions::maxWorkers threads when parallel.
+   */
+  std::vector<PlotResult> makeStackPlots(const std::vector<PlotRequest>& requests,
+                                         const PlotBatchOptions& options) const;
+
+  /// Hash of the style of @p request and the contents of its input histograms.
+  static std::string inputHash(const PlotRequest& request);
 
   static std::unique_ptr<TH1D> computeRatioHistogram(const TH1D& numerator,
                                                      const TH1D& denominator,
@@ -62,7 +123,18 @@ public:
                                           const TH1D* systematic = nullptr);
   static PCAResult computePCAEnvelope(const TH1D& nominal,
                                       const std::vector<const TH1D*>& variations,
-                                      const std::string& baseName = "pca");
+                                      const std::string& baseName = "pca",
+                                      int maxComponents = 0);
+  /**
+   * PCA envelope straight from a merged THnSparse: the contents are summed
+   * over all axes but @p variationAxis and @p observableAxis into one flat
+   * array per variation bin.  Bin @p nominalBin of the variation axis is
+   * the nominal; every other non-empty variation bin is a variation.
+   */
+  static PCAResult computePCAEnvelope(const THnSparse& histogram, int variationAxis,
+                                      int observableAxis, int nominalBin = 1,
+                                      const std::string& baseName = "pca",
+                                      int maxComponents = 0);
 };
 
 #endif // PLOTTINGUTILITY_H_INCLUDED
@@ -2,8 +2,15 @@
 #define PROVENANCESERVICE_H_INCLUDED
 
 #include "api/IAnalysisService.h"
+#include <PhaseTimer.h>
+#include <ROOT/RResultPtr.hxx>
+#include <RtypesCore.h>
+#include <chrono>
+#include <cstdint>
+#include <memory>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 /**
  * @brief Analysis service that collects and writes complete provenance metadata.
@@ -28,12 +35,57 @@
  *                              (empty string if none are set).
  *  - executor.num_threads    : Number of threads in the ROOT implicit MT pool at
  *                              the time finalize() is called (0 = single-threaded).
+ *  - executor.tasks_per_worker / executor.min_entries_per_task :
+ *                              TTreeProcessorMT tasks-per-worker hint in effect,
+ *                              and the minEntriesPerTask key ("default" when
+ *                              not configured).
+ *  - executor.parallel_unzip : Whether the TTreeCache decompresses prefetched
+ *                              baskets on ROOT's thread pool (true/false).
+ *  - executor.plugin_thread_pool : pluginThreadPool key; "separate" when not
+ *                              configured.
  *  - config.hash             : MD5 digest of the serialised configuration map
  *                              (all key=value pairs sorted by key).
- *  - filelist.hash           : MD5 digest of the file referenced by the "fileList"
- *                              configuration key, if present.
+ *  - filelist.hash           : Fingerprint (see hashFile()) of the file
+ *                              referenced by the "fileList" configuration
+ *                              key, if present.
+ *  - file.hash.<key>         : Fingerprint of every configuration value that
+ *                              looks like a file path.
+ *  - file.hash_algorithm     : "xxh3" (default) or "md5", from the
+ *                              provenanceHashAlgorithm configuration key.
  *  - plugin.<role>           : Type name of each registered plugin, keyed by
  *                              its role (e.g. plugin.histogramManager).
+ *  - io.<key>               : Read-ahead settings in effect (treeCacheSize,
+ *                              treeCacheSizeFactor, treeCacheLearnEntries,
+ *                              treeCachePrefetch, asyncOpenFiles; "default"
+ *                              when not configured).
+ *  - io.bytes_read / io.read_calls / io.read_rate_mb_s :
+ *                              Bytes and read calls issued by all TFiles
+ *                              between initialize() and finalize(), and the
+ *                              resulting average rate in MB/s of wall time.
+ *  - env.hostname / env.site : Host the job ran on, and its grid site from
+ *                              CMS_LOCAL_SITE, GLIDEIN_CMSSite, OSG_SITE_NAME
+ *                              or SITE_NAME ("unknown" if none is set).
+ *  - dataset.name            : Sample name from the first non-empty of the
+ *                              sample, name, sample_type, type or process
+ *                              configuration keys ("unknown" otherwise).
+ *  - timing.<phase>.wall_s / timing.<phase>.cpu_s :
+ *                              Wall and process CPU time in seconds of each
+ *                              phase recorded with recordPhase().  The
+ *                              service itself records "jit" (from
+ *                              markEventLoopTrigger() to the start of the
+ *                              event loop) and "event_loop"; the Analyzer
+ *                              adds config, plugin_setup, snapshot,
+ *                              histogram_writing and finalize.  jit and
+ *                              event_loop run inside the phase that triggered
+ *                              the loop.
+ *  - throughput.events / throughput.events_per_s :
+ *                              Entries read by the event loop, and per second
+ *                              of event-loop wall time.
+ *  - executor.slot_entries / executor.load_imbalance :
+ *                              Comma-separated entries processed per slot,
+ *                              and the busiest slot's entries over the mean
+ *                              (1 = perfectly balanced).
+ *  - memory.peak_rss_mb      : Peak resident set size of the process.
  *  - file.hash.<cfg_key>     : MD5 digest of any configuration value that looks
  *                              like a file path with a recognised extension
  *                              (.json, .root, .onnx, .bdt, .pt, .pb, .xml,
@@ -108,6 +160,25 @@ public:
      */
     const std::unordered_map<std::string, std::string>& getProvenance() const;
 
+    /**
+     * @brief Record the wall and CPU time of a phase as
+     *        timing.<name>.wall_s and timing.<name>.cpu_s.
+     */
+    void recordPhase(const std::string& name, double wallSeconds, double cpuSeconds);
+
+    /**
+     * @brief Mark the call that starts the event loop, so that the time to
+     *        its first entry is reported as the "jit" phase.
+     */
+    void markEventLoopTrigger();
+
+    /// Entries and times of the event loop, filled by the loop monitor action.
+    struct LoopStatistics {
+        PhaseTimer::Sample start;
+        PhaseTimer::Sample end;
+        std::vector<std::uint64_t> slotEntries;
+    };
+
     /**
      * @brief Compute MD5 hex digest of an arbitrary string.
      *
@@ -120,15 +191,47 @@ public:
      */
     static std::string hashString(const std::string& data);
 
+    enum class HashAlgorithm { XXH3, MD5 };
+
+    /**
+     * @brief Fingerprint of a file's contents.
+     *
+     * XXH3 fingerprints ("xxh3:" and 16 hex digits) hash 64 MiB blocks of
+     * the file on several threads and then the block digests; they are fast
+     * but not cryptographic.  MD5 gives the 32-digit digest of the whole
+     * file, as written by earlier versions.
+     *
+     * With a non-empty @p cacheFile, fingerprints are memoized there by
+     * (absolute path, size, modification time, algorithm), so unchanged
+     * files are not read again by later jobs.
+     *
+     * @return the fingerprint, "<empty path>" or "<not found>"
+     */
+    static std::string hashFile(const std::string& path, HashAlgorithm algorithm,
+                                const std::string& cacheFile = "");
+
 private:
     ManagerContext* ctx_m = nullptr;
     std::unordered_map<std::string, std::string> provenance_m;
+    /// TFile read counters and time at initialize(), for the read rate.
+    Long64_t bytesReadAtStart_m = 0;
+    Int_t readCallsAtStart_m = 0;
+    std::chrono::steady_clock::time_point startTime_m;
+    /// Booked at initialize(); ready once the event loop has run.
+    ROOT::RDF::RResultPtr<LoopStatistics> loopStatistics_m;
+    PhaseTimer::Sample loopTrigger_m;
+    bool loopTriggerMarked_m = false;
+
+    /// Record the bytes, calls and rate read since initialize().
+    void collectReadStatistics();
+    /// Record the jit and event-loop phases, throughput, slot balance and RSS.
+    void collectLoopStatistics();
 
     void collectBuildInfo();
     void collectRuntimeInfo(const IConfigurationProvider& config);
 
-    /// Compute MD5 hex digest of a file's contents; returns "<not found>" on error.
-    static std::string hashFile(const std::string& path);
+    /// Fingerprint of a file's contents, without the cache.
+    static std::string computeFileHash(const std::string& path, HashAlgorithm algorithm);
     /// Run a shell command and return trimmed stdout; returns "" on failure.
     static std::string runCommand(const std::string& cmd);
     /// Serialise a config map deterministically (sorted keys) for hashing.
@@ -0,0 +1,50 @@
+#ifndef RNTUPLEOUTPUTSINK_H_INCLUDED
+#define RNTUPLEOUTPUTSINK_H_INCLUDED
+
+#include <Compression.h>
+#include "RootOutputSink.h"
+
+/**
+ * @brief Output sink writing skims as RNTuple instead of TTree.
+ *
+ * Column selection (saveConfig globs, systematic expansion) and output file
+ * naming are inherited from RootOutputSink; only the Snapshot output format
+ * and compression differ.  Requires ROOT >= 6.36 (RDataFrame RNTuple
+ * Snapshot); older versions throw std::runtime_error on write.
+ *
+ * Selected with ``skimOutputFormat=rntuple`` or ``metaOutputFormat=rntuple``
+ * (see ManagerFactory::createOutputSink()).
+ */
+class RNTupleOutputSink : public RootOutputSink {
+public:
+  /**
+   * @param algorithm Compression algorithm for the RNTuple pages
+   * @param level     Compression level (0 disables compression)
+   */
+  explicit RNTupleOutputSink(
+      ROOT::RCompressionSetting::EAlgorithm::EValues algorithm =
+          ROOT::RCompressionSetting::EAlgorithm::kZSTD,
+      int level = 5);
+
+  /**
+   * @brief Build a sink from the ``rntupleCompression`` (zstd, lz4, lzma,
+   *        zlib) and ``rntupleCompressionLevel`` config keys.
+   */
+  static std::unique_ptr<RNTupleOutputSink>
+  fromConfig(const IConfigurationProvider& configProvider);
+
+  ROOT::RCompressionSetting::EAlgorithm::EValues compressionAlgorithm() const {
+    return algorithm_m;
+  }
+  int compressionLevel() const { return level_m; }
+
+protected:
+  /// RNTuple output format with this sink's compression settings.
+  ROOT::RDF::RSnapshotOptions makeSnapshotOptions() const override;
+
+private:
+  ROOT::RCompressionSetting::EAlgorithm::EValues algorithm_m;
+  int level_m;
+};
+
+#endif // RNTUPLEOUTPUTSINK_H_INCLUDED
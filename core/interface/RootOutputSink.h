@@ -2,20 +2,162 @@
 #define ROOTOUTPUTSINK_H_INCLUDED
 
 #include "api/IOutputSink.h"
+#include <SkimColumnManifest.h>
+#include <util.h>
+#include <Compression.h>
+#include <ROOT/RResultPtr.hxx>
+#include <ROOT/RSnapshotOptions.hxx>
+#include <RtypesCore.h>
+#include <map>
+#include <optional>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Snapshot tuning for one output channel.
+ *
+ * Defaults reproduce the previous hard-coded behaviour (ZSTD level 5, ROOT
+ * defaults for auto-flush, split level and basket size).
+ */
+struct SnapshotSettings {
+  /// Compression override for the branches matching a glob pattern.
+  struct ColumnCompression {
+    std::string pattern;
+    ROOT::RCompressionSetting::EAlgorithm::EValues algorithm;
+    int level;
+  };
+
+  ROOT::RCompressionSetting::EAlgorithm::EValues compressionAlgorithm =
+      ROOT::RCompressionSetting::EAlgorithm::kZSTD;
+  int compressionLevel = 5;
+  Long64_t autoFlush = 0;   ///< 0 keeps the TTree default
+  int splitLevel = 99;
+  int basketSize = -1;      ///< -1 keeps the TTree default
+  /// Checked in order; the first matching pattern wins.
+  std::vector<ColumnCompression> columnCompression;
+};
 
 /**
  * @brief ROOT-based output sink for writing skims.
  */
 class RootOutputSink : public IOutputSink {
 public:
+  RootOutputSink() = default;
+  explicit RootOutputSink(SnapshotSettings settings);
+
+  /**
+   * @brief Read the Snapshot settings of @p channel from the ``snapshotOptions``
+   *        config file.
+   *
+   * Each entry of the file names a ``channel`` (skim or meta).  Entries
+   * without ``columns`` set the channel-wide ``compression``, ``level``,
+   * ``autoFlush``, ``splitLevel`` and ``basketSize``; entries with a
+   * comma-separated list of ``columns`` globs override ``compression`` and
+   * ``level`` for the matching branches.  Returns the defaults when the key
+   * is absent.
+   */
+  static SnapshotSettings
+  snapshotSettingsFromConfig(const IConfigurationProvider& configProvider,
+                             OutputChannel channel);
+
+  /**
+   * @brief Map a compression name (zstd, lz4, lzma, zlib) to its ROOT value.
+   * @throws std::runtime_error for unknown names
+   */
+  static ROOT::RCompressionSetting::EAlgorithm::EValues
+  parseCompressionAlgorithm(const std::string& name);
+
   void writeDataFrame(ROOT::RDF::RNode& df, const OutputSpec& spec) override;
   void writeDataFrame(ROOT::RDF::RNode& df,
                       const IConfigurationProvider& configProvider,
                       const IDataFrameProvider* dataFrameProvider,
                       const ISystematicManager* systematicManager,
                       OutputChannel channel) override;
+
+  /**
+   * @brief Book the skim as a lazy Snapshot (RSnapshotOptions::fLazy).
+   *
+   * Column selection matches writeDataFrame().  The Snapshot runs in the
+   * next event loop of @p df; flush() completes it.
+   */
+  void bookDataFrame(ROOT::RDF::RNode& df,
+                     const IConfigurationProvider& configProvider,
+                     const IDataFrameProvider* dataFrameProvider,
+                     const ISystematicManager* systematicManager,
+                     OutputChannel channel) override;
+  void bookDataFrame(ROOT::RDF::RNode& df, const OutputSpec& spec) override;
+  void flush() override;
+  bool bookedColumns(std::vector<std::string>& columns) const override;
+
   std::string resolveOutputFile(const IConfigurationProvider& configProvider,
                                 OutputChannel channel) override;
+
+  const SnapshotSettings& snapshotSettings() const { return settings_m; }
+
+  /**
+   * @brief Write a SkimColumnManifest next to each skim of this sink.
+   *
+   * @p manifest lists the producers of the defined columns; saved columns it
+   * does not list are recorded as ``input``.  When its ``base`` is set, only
+   * the index columns and the saved columns whose producer changed with
+   * respect to the base skim's manifest are written.
+   */
+  void setColumnManifest(SkimColumnManifest manifest);
+
+  /// Number of booked Snapshots not yet completed by flush().
+  std::size_t pendingSnapshots() const { return pending_m.size(); }
+
+protected:
+  /**
+   * @brief Options passed to every Snapshot of this sink.
+   *
+   * Derived sinks override this to change the output format.
+   */
+  virtual ROOT::RDF::RSnapshotOptions makeSnapshotOptions() const;
+
+  /// Output file, tree and columns (saveConfig, systematics) of @p channel.
+  OutputSpec resolveSpec(ROOT::RDF::RNode& df,
+                         const IConfigurationProvider& configProvider,
+                         const ISystematicManager* systematicManager,
+                         OutputChannel channel);
+
+private:
+  using SnapshotResult =
+      ROOT::RDF::RResultPtr<ROOT::RDF::RInterface<ROOT::Detail::RDF::RLoopManager>>;
+
+  /// A booked Snapshot and the file it writes before any rewrite pass.
+  struct PendingSnapshot {
+    OutputSpec spec;
+    std::string snapshotFile;
+    SnapshotResult result;
+  };
+
+  PendingSnapshot bookSnapshot(ROOT::RDF::RNode& df, const OutputSpec& spec, bool lazy);
+  void completeSnapshot(PendingSnapshot& pending);
+
+  /**
+   * @brief Restrict @p columns to the columns defined on @p df (plus the
+   *        index columns) and record the friend config of @p outputFile.
+   */
+  std::vector<std::string> applyFriendMode(ROOT::RDF::RNode& df,
+                                           const IConfigurationProvider& configProvider,
+                                           const std::string& outputFile,
+                                           const std::string& treeName,
+                                           std::vector<std::string> columns);
+
+  /// Record the manifest of @p outputFile and return the columns to write.
+  std::vector<std::string> applyColumnManifest(ROOT::RDF::RNode& df,
+                                               const std::string& outputFile,
+                                               const std::string& treeName,
+                                               std::vector<std::string> columns);
+
+  SnapshotSettings settings_m;
+  std::vector<PendingSnapshot> pending_m;
+  std::optional<SkimColumnManifest> columnManifest_m;
+  /// Manifests written once the skim of their output file is complete.
+  std::map<std::string, SkimColumnManifest> pendingManifests_m;
+  /// Friend configs written once the skim of their output file is complete.
+  std::map<std::string, FriendTreeSpec> pendingFriends_m;
 };
 
 #endif // ROOTOUTPUTSINK_H_INCLUDED
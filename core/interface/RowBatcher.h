@@ -0,0 +1,122 @@
+#ifndef ROWBATCHER_H_INCLUDED
+#define ROWBATCHER_H_INCLUDED
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+/**
+ * @brief Evaluates the per-event rows of a model in batches, during the
+ *        event loop.
+ *
+ * A column can only return the value of the entry being processed, so the
+ * rows of one slot cannot wait for its later events.  Instead, the slots
+ * running concurrently append their rows to a shared batch and wait, so a
+ * batch holds at most one row per slot.  The batch is evaluated, on the
+ * thread of the slot that launches it, once it holds as many rows as slots
+ * were seen to take part (at most @c batchSize), once every slot is waiting
+ * on a batch, or when its first row has waited for the timeout.  A timeout
+ * lowers the expected number of rows to that of the batch, so slots that
+ * stop calling (e.g. at the end of the loop) delay one batch only; it is
+ * raised again every kGrowthInterval full batches.  With one slot every
+ * row is evaluated on its own, without waiting.  Slots arriving while a
+ * batch is being evaluated fill the next one.
+ *
+ * Rows handed to the evaluation function are row-major and zero-padded to
+ * @c batchSize rows, so models with a fixed batch dimension can read the
+ * whole buffer.
+ */
+class RowBatcher {
+public:
+  /**
+   * @brief Evaluate @p nRows rows (of a buffer of batchSize rows) and write
+   *        nOutputs values per row to @p outputs.
+   */
+  using Evaluate =
+      std::function<void(const float *rows, std::size_t nRows, float *outputs)>;
+
+  /// Wait of the first row of a batch used by default.
+  static constexpr std::chrono::microseconds kDefaultTimeout{1000};
+  /// Full batches after which one more row per batch is expected.
+  static constexpr std::uint64_t kGrowthInterval = 64;
+
+  /**
+   * @param rowSize Values per row
+   * @param nOutputs Output values per row
+   * @param batchSize Most rows per evaluation
+   * @param nSlots Slots of the event loop
+   * @param evaluate Called with the mutex released; exceptions it throws
+   *        are rethrown to every slot of the batch
+   * @param timeout Longest wait of the first row of a batch
+   */
+  RowBatcher(std::size_t rowSize, std::size_t nOutputs, std::size_t batchSize,
+             std::size_t nSlots, Evaluate evaluate,
+             std::chrono::microseconds timeout = kDefaultTimeout);
+
+  RowBatcher(const RowBatcher &) = delete;
+  RowBatcher &operator=(const RowBatcher &) = delete;
+
+  /**
+   * @brief Evaluate one row of @p size values (at most rowSize, the rest is
+   *        zero) and write its nOutputs values to @p outputs.
+   *
+   * Blocks until the batch holding the row has been evaluated.
+   *
+   * @throws std::invalid_argument if @p size exceeds rowSize.
+   */
+  void infer(const float *row, std::size_t size, float *outputs);
+
+  /// Number of evaluations so far.
+  std::uint64_t batches() const;
+  /// Number of rows evaluated so far.
+  std::uint64_t rows() const;
+
+private:
+  struct Batch {
+    std::vector<float> rows;
+    std::vector<float> outputs;
+    std::size_t size = 0;
+    /// Slots that still have to read their outputs.
+    std::size_t readers = 0;
+    bool launched = false;
+    bool done = false;
+    std::chrono::steady_clock::time_point firstRow;
+    std::exception_ptr error;
+  };
+
+  /// Take @p batch out of filling and evaluate it (lock held on entry and
+  /// exit, released during the evaluation); @p timedOut when its first row
+  /// waited for the timeout.
+  void launch(Batch &batch, std::unique_lock<std::mutex> &lock, bool timedOut);
+
+  /// Batch for the next rows: a free one or a new one (lock held).
+  Batch *nextBatch();
+
+  std::size_t rowSize_m;
+  std::size_t nOutputs_m;
+  std::size_t batchSize_m;
+  std::size_t nSlots_m;
+  /// Rows a batch is launched at, adapted to the slots taking part.
+  std::size_t target_m;
+  std::uint64_t fullBatches_m = 0;
+  Evaluate evaluate_m;
+  std::chrono::microseconds timeout_m;
+
+  mutable std::mutex mutex_m;
+  std::condition_variable done_m;
+  std::vector<std::unique_ptr<Batch>> batches_m;
+  std::vector<Batch *> free_m;
+  Batch *filling_m = nullptr;
+  /// Slots inside infer().
+  std::size_t waiting_m = 0;
+  std::uint64_t launched_m = 0;
+  std::uint64_t evaluatedRows_m = 0;
+};
+
+#endif // ROWBATCHER_H_INCLUDED
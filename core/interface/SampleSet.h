@@ -0,0 +1,77 @@
+#ifndef SAMPLESET_H_INCLUDED
+#define SAMPLESET_H_INCLUDED
+
+#include <map>
+#include <string>
+#include <vector>
+
+class IConfigurationProvider;
+
+/**
+ * @brief One sample of a multi-sample job.
+ */
+struct SampleSpec {
+  std::string name;
+  std::vector<std::string> files;
+  /// Sample constants from the sample's floatConfig / intConfig files.
+  std::map<std::string, float> floatConstants;
+  std::map<std::string, int> intConstants;
+};
+
+/**
+ * @brief Samples processed together by one Analyzer (``sampleConfig``).
+ *
+ * Each line of the sample config describes one sample:
+ *
+ *     name=ttbar fileList=a.root,b.root floatConfig=cfg/ttbar_floats.txt
+ *     name=wjets fileList=c.root intConfig=cfg/wjets_ints.txt
+ *
+ * The files of all samples are chained in sample order, so the computation
+ * graph (corrections, models, histogram bookings) is built once and one
+ * event loop serves every sample.  DataManager defines ``sampleIndex`` per
+ * sample and registerConstants() defines the sample constants per sample;
+ * histograms without a sample category are split by ``sampleIndex``.
+ */
+class SampleSet {
+public:
+  /// Name of the per-sample index column (Float_t, 0 .. size()-1).
+  static constexpr const char *kIndexColumn = "sampleIndex";
+
+  /**
+   * @brief Samples listed in the file of the ``sampleConfig`` key; empty
+   *        when the key is not set.
+   * @throws std::runtime_error for duplicate names, samples without files or
+   *         unreadable constants.
+   */
+  static SampleSet fromConfig(const IConfigurationProvider &configProvider);
+
+  explicit SampleSet(std::vector<SampleSpec> samples = {});
+
+  bool empty() const { return samples_m.empty(); }
+  std::size_t size() const { return samples_m.size(); }
+  const std::vector<SampleSpec> &samples() const { return samples_m; }
+  std::vector<std::string> names() const;
+
+  /// Files of all samples, in sample order.
+  std::vector<std::string> files() const;
+  /// Sample index of each entry of files().
+  std::vector<int> fileSamples() const;
+
+  /**
+   * @brief Index of the sample listing @p url, matched by URL and else by
+   *        file name (staging and failover keep the name); -1 if none.
+   */
+  int sampleOfFile(const std::string &url) const;
+
+  /**
+   * @brief Value of constant @p name, which must be a complete number.
+   * @throws std::runtime_error naming the constant otherwise
+   */
+  static float parseFloat(const std::string &name, const std::string &value);
+  static int parseInt(const std::string &name, const std::string &value);
+
+private:
+  std::vector<SampleSpec> samples_m;
+};
+
+#endif // SAMPLESET_H_INCLUDED
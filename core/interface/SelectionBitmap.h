@@ -0,0 +1,99 @@
+/**
+ * @file SelectionBitmap.h
+ * @brief Compressed bitmap of the entries of one input file that passed a
+ *        preselection.
+ */
+#ifndef SELECTIONBITMAP_H_INCLUDED
+#define SELECTIONBITMAP_H_INCLUDED
+
+#include <EntryRangeSet.h>
+#include <RtypesCore.h>
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+/**
+ * @class SelectionBitmap
+ * @brief Roaring-style bitmap of entry numbers.
+ *
+ * Entries are split into chunks of 2^16 by their high bits.  Each non-empty
+ * chunk is stored in whichever of three containers is smallest:
+ *  - an array of the sorted low 16 bits (2 bytes per entry), for sparse
+ *    chunks,
+ *  - a 8 KiB bitmap, for dense scattered chunks,
+ *  - a list of runs (4 bytes per run), for chunks of contiguous entries.
+ *
+ * A preselection keeping 10 % of uniformly scattered events costs about
+ * 1.6 bits per input entry; one keeping whole lumi sections or clusters
+ * costs a few bytes per run.
+ */
+class SelectionBitmap {
+public:
+  /// Bitmap of the entries of @p entries.
+  static SelectionBitmap fromRanges(const EntryRangeSet &entries);
+
+  /// The entries as ranges.
+  EntryRangeSet toRanges() const;
+
+  bool contains(ULong64_t entry) const;
+
+  /// Number of entries in the bitmap.
+  ULong64_t size() const;
+
+  bool empty() const { return chunks_m.empty(); }
+
+  /**
+   * @brief Binary form, in host byte order.
+   */
+  std::string serialize() const;
+
+  /**
+   * @brief Parse the binary form written by serialize().
+   * @throws std::runtime_error on malformed input
+   */
+  static SelectionBitmap deserialize(const std::string &data);
+
+  /**
+   * @brief Write the bitmap of a file with @p fileEntries entries to @p path.
+   * @throws std::runtime_error if @p path cannot be written
+   */
+  void write(const std::string &path, ULong64_t fileEntries) const;
+
+  /**
+   * @brief Read a bitmap written by write().
+   *
+   * A missing file, or one written for a file with another number of
+   * entries than @p fileEntries, gives no bitmap.
+   *
+   * @throws std::runtime_error if @p path exists but is malformed
+   */
+  static std::optional<SelectionBitmap> read(const std::string &path, ULong64_t fileEntries);
+
+private:
+  enum class Kind : std::uint8_t { Array = 0, Bitmap = 1, Runs = 2 };
+
+  static constexpr std::uint32_t kChunkBits = 16;
+  static constexpr std::uint32_t kBitmapWords = (1u << kChunkBits) / 64;
+
+  struct Chunk {
+    /// Entry >> kChunkBits of every entry of the chunk.
+    std::uint64_t key = 0;
+    Kind kind = Kind::Array;
+    /// Array: sorted low bits.  Runs: first and last low bits of each run.
+    std::vector<std::uint16_t> values;
+    /// Bitmap: kBitmapWords words.
+    std::vector<std::uint64_t> bits;
+
+    std::uint32_t cardinality() const;
+  };
+
+  /// Chunk of the runs [first, last] (inclusive low bits) of one key.
+  static Chunk makeChunk(std::uint64_t key, const std::vector<std::uint16_t> &runs);
+
+  /// Sorted by key.
+  std::vector<Chunk> chunks_m;
+};
+
+#endif // SELECTIONBITMAP_H_INCLUDED
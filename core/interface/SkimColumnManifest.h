@@ -0,0 +1,82 @@
+#ifndef SKIMCOLUMNMANIFEST_H_INCLUDED
+#define SKIMCOLUMNMANIFEST_H_INCLUDED
+
+#include <map>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Column-level provenance of one skim file.
+ *
+ * Records, for every column of the skim, the producer that defined it (a
+ * plugin role, ``analysis`` for columns defined by analysis code or
+ * ``input`` for branches read from the input) and the producer's config
+ * hash (``plugin.<role>.config_hash`` of the provenance metadata).
+ *
+ * An incremental skim names the skim it extends as its ``base`` and only
+ * writes the columns whose producer or hash changed, plus the index
+ * columns used to match its events to the base.  The manifest of an
+ * incremental skim still lists every column of the layered skim, so the
+ * next increment compares against it alone.  Readers walk the ``base``
+ * links and attach each layer as a friend tree.
+ *
+ * The manifest is written next to the skim as ``<skim>.columns.json``:
+ * @code{.json}
+ * {
+ *   "tree": "Events",
+ *   "base": "/store/skims/v1/skim_0.root",
+ *   "index": ["run", "event"],
+ *   "written": ["run", "event", "Muon_pt_corr"],
+ *   "columns": {
+ *     "Muon_pt_corr": {"producer": "muonCorrections", "hash": "9f2c..."},
+ *     "event": {"producer": "input", "hash": ""}
+ *   }
+ * }
+ * @endcode
+ */
+class SkimColumnManifest {
+public:
+  /// Producer of one column.
+  struct Entry {
+    std::string producer;
+    std::string hash;
+
+    bool operator==(const Entry &other) const {
+      return producer == other.producer && hash == other.hash;
+    }
+    bool operator!=(const Entry &other) const { return !(*this == other); }
+  };
+
+  /// Path of the manifest written next to @p skimFile.
+  static std::string pathFor(const std::string &skimFile);
+
+  /**
+   * @brief Read a manifest written by write().
+   * @throws std::runtime_error if the file is missing or malformed
+   */
+  static SkimColumnManifest read(const std::string &path);
+
+  /// Write the manifest as JSON to @p path.
+  void write(const std::string &path) const;
+
+  /**
+   * @brief Columns whose producer or hash differs from @p base, or which
+   *        @p base does not have, in name order.
+   */
+  std::vector<std::string> changedColumns(const SkimColumnManifest &base) const;
+
+  /// Entry of @p column, or nullptr if it is not listed.
+  const Entry *find(const std::string &column) const;
+
+  std::string treeName{"Events"};
+  /// Skim this one extends; empty for a complete skim.
+  std::string base;
+  /// Columns matching the events of this skim to those of @ref base.
+  std::vector<std::string> indexColumns;
+  /// Columns stored in this file.
+  std::vector<std::string> writtenColumns;
+  /// Every column of the layered skim.
+  std::map<std::string, Entry> columns;
+};
+
+#endif // SKIMCOLUMNMANIFEST_H_INCLUDED
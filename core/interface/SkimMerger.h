@@ -0,0 +1,73 @@
+#ifndef SKIMMERGER_H_INCLUDED
+#define SKIMMERGER_H_INCLUDED
+
+#include <Compression.h>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Parallel merge of per-job skim files into outputs of a target size.
+ *
+ * ``hadd -f`` writes with the default compression, so skims snapshotted with
+ * other settings have every basket decompressed and recompressed.  The
+ * SkimMerger writes each output with the compression settings of its first
+ * input and, when all inputs of that output share them, copies the tree
+ * baskets without unzipping them (TTreeCloner fast cloning through
+ * TFileMerger).  Inputs with other settings are merged the slow way.
+ *
+ * The inputs are split, in order, into consecutive parts whose summed file
+ * size stays below the target size; each part becomes one output file.
+ * Inputs are never split, so every output cluster is an input cluster and
+ * the outputs are cluster-aligned.  An input larger than the target is
+ * written on its own.  Under implicit multi-threading the parts are merged
+ * concurrently.
+ *
+ * With more than one part, ``merged.root`` becomes ``merged_0.root``,
+ * ``merged_1.root``, ...
+ */
+class SkimMerger {
+public:
+  /// One output file of a merge.
+  struct Part {
+    std::string output;
+    std::vector<std::string> inputs;
+    /// Sum of the input file sizes in bytes.
+    std::uint64_t inputBytes = 0;
+    /// Compression settings the output is written with.
+    int compression = ROOT::RCompressionSetting::EDefaults::kUseGeneralPurpose;
+    /// True when every input matched @ref compression and was fast-cloned.
+    bool fastCopy = false;
+  };
+
+  /**
+   * @param targetBytes Target output file size; 0 writes one output.
+   */
+  explicit SkimMerger(std::uint64_t targetBytes = 0);
+
+  /**
+   * @brief Merge @p inputs into @p output, or into numbered outputs next to
+   *        it when they exceed the target size.
+   *
+   * @return The parts written, in input order.
+   * @throws std::runtime_error if there are no inputs, an input cannot be
+   *         opened or the merge of a part fails.
+   */
+  std::vector<Part> merge(const std::string &output,
+                          const std::vector<std::string> &inputs) const;
+
+  /**
+   * @brief Split @p inputs into the parts merge() would write, without
+   *        opening them.  @p sizes holds the input file sizes in bytes.
+   */
+  std::vector<Part> plan(const std::string &output, const std::vector<std::string> &inputs,
+                         const std::vector<std::uint64_t> &sizes) const;
+
+private:
+  static void mergePart(Part &part);
+
+  std::uint64_t targetBytes_m;
+};
+
+#endif // SKIMMERGER_H_INCLUDED
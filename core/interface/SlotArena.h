@@ -0,0 +1,288 @@
+/**
+ * @file SlotArena.h
+ * @brief Per-slot bump allocator for per-event temporaries.
+ *
+ * Event-loop code creates many short-lived buffers (fit work matrices,
+ * combinatoric candidates, correction inputs) that never outlive the Define
+ * lambda that created them.  Allocating those from the global heap makes the
+ * threads of a multi-threaded event loop contend in malloc and fragments the
+ * heap of long-running jobs.  A SlotArena hands out memory by bumping an
+ * offset in a chunk owned by the processing slot and releases everything at
+ * once when the entry is done.
+ *
+ * RDataFrame processes an entry of a slot on a single thread, so the arena
+ * returned by @ref SlotArena::local() is the arena of the current slot.
+ *
+ * ### Typical usage inside a Define lambda
+ * @code
+ * [](const RVec<float> &pt, ...) -> float {
+ *     SlotArena::Scope scope;              // released when the lambda returns
+ *     ArenaVector<double> work(n, 0.0, scope.allocator<double>());
+ *     ...
+ *     return result;                        // must not reference `work`
+ * }
+ * @endcode
+ *
+ * Memory handed out by the arena must not escape into a column value: column
+ * values outlive the entry and are read after the scope is released.
+ */
+#ifndef SLOTARENA_H_INCLUDED
+#define SLOTARENA_H_INCLUDED
+
+#include <RtypesCore.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <new>
+#include <vector>
+
+/**
+ * @class SlotArena
+ * @brief Chunked bump allocator that is released per entry.
+ *
+ * Allocations are served from the current chunk; when it is full, a new
+ * chunk at least twice as large is appended.  @ref reset() rewinds the arena
+ * and, when the last entry needed more than one chunk, replaces all chunks by
+ * a single one large enough for that entry, so that the steady state is one
+ * chunk per slot and no heap traffic at all.
+ *
+ * Individual deallocations are no-ops; memory is reclaimed by @ref reset()
+ * or when a @ref Scope closes.
+ */
+class SlotArena {
+public:
+    /// Default size of the first chunk.
+    static constexpr std::size_t kDefaultChunkBytes = 64 * 1024;
+
+    /**
+     * @brief Create an arena whose first chunk holds @p initialBytes.
+     *
+     * The chunk is allocated lazily on the first request.
+     */
+    explicit SlotArena(std::size_t initialBytes = kDefaultChunkBytes)
+        : initialBytes_m(std::max<std::size_t>(initialBytes, 64)) {}
+
+    SlotArena(const SlotArena &) = delete;
+    SlotArena &operator=(const SlotArena &) = delete;
+
+    /**
+     * @brief Arena of the calling thread, i.e. of the slot currently being
+     *        processed.
+     */
+    static SlotArena &local() {
+        thread_local SlotArena arena;
+        return arena;
+    }
+
+    /**
+     * @brief Allocate @p bytes aligned to @p alignment.
+     * @throws std::bad_alloc if the request cannot be satisfied.
+     */
+    void *allocate(std::size_t bytes, std::size_t alignment = alignof(std::max_align_t)) {
+        if (bytes == 0) {
+            bytes = 1;
+        }
+        if (!chunks_m.empty()) {
+            if (void *p = bump(chunks_m.back(), bytes, alignment)) {
+                return p;
+            }
+        }
+        addChunk(bytes + alignment);
+        return bump(chunks_m.back(), bytes, alignment);
+    }
+
+    /**
+     * @brief Release all allocations.
+     *
+     * Chunks are kept; if more than one chunk was in use, they are merged
+     * into a single chunk of the combined size.
+     */
+    void reset() {
+        if (chunks_m.size() > 1) {
+            std::size_t total = 0;
+            for (const auto &chunk : chunks_m) {
+                total += chunk.size;
+            }
+            chunks_m.clear();
+            addChunk(total);
+        }
+        if (!chunks_m.empty()) {
+            chunks_m.back().used = 0;
+        }
+        ++generation_m;
+    }
+
+    /**
+     * @brief Reset the arena if @p entry differs from the entry of the last
+     *        call.
+     *
+     * Lets event-loop code release the previous entry's temporaries lazily,
+     * at the start of the next entry processed by the slot, without a scope.
+     * Must not be called while a @ref Scope of this arena is open.
+     */
+    void beginEntry(ULong64_t entry) {
+        if (!hasEntry_m || entry != currentEntry_m) {
+            reset();
+            currentEntry_m = entry;
+            hasEntry_m = true;
+        }
+    }
+
+    /// Bytes currently handed out (including alignment padding).
+    std::size_t bytesInUse() const {
+        std::size_t used = 0;
+        for (const auto &chunk : chunks_m) {
+            used += chunk.used;
+        }
+        return used;
+    }
+
+    /// Bytes owned by the arena across all chunks.
+    std::size_t capacity() const {
+        std::size_t total = 0;
+        for (const auto &chunk : chunks_m) {
+            total += chunk.size;
+        }
+        return total;
+    }
+
+    /// Number of chunks currently owned.
+    std::size_t chunkCount() const { return chunks_m.size(); }
+
+    /// Number of times the arena has been reset.
+    std::uint64_t generation() const { return generation_m; }
+
+    template <typename T>
+    class Allocator;
+
+    /**
+     * @brief RAII scope for temporaries of one lambda call.
+     *
+     * On destruction the arena is rewound to where it was when the scope
+     * opened, so scopes nest and allocations made before the scope stay
+     * valid.  A scope opened on an empty arena (the usual case at the top of
+     * a Define lambda) resets it instead, merging its chunks.  A helper that
+     * returns arena-backed memory to its caller must not open a scope of its
+     * own.
+     */
+    class Scope {
+    public:
+        explicit Scope(SlotArena &arena = SlotArena::local())
+            : arena_m(arena), chunk_m(arena.chunks_m.size()),
+              used_m(arena.chunks_m.empty() ? 0 : arena.chunks_m.back().used) {}
+
+        Scope(const Scope &) = delete;
+        Scope &operator=(const Scope &) = delete;
+
+        ~Scope() {
+            auto &chunks = arena_m.chunks_m;
+            if (chunk_m == 0 || (chunk_m == 1 && used_m == 0)) {
+                arena_m.reset();
+                return;
+            }
+            // Chunks added inside the scope only held its own temporaries.
+            if (chunks.size() > chunk_m) {
+                chunks.resize(chunk_m);
+            }
+            chunks.back().used = used_m;
+        }
+
+        /// The arena this scope belongs to.
+        SlotArena &arena() const { return arena_m; }
+
+        /// Allocator handing out memory from this scope's arena.
+        template <typename T>
+        Allocator<T> allocator() const {
+            return Allocator<T>(arena_m);
+        }
+
+    private:
+        SlotArena &arena_m;
+        std::size_t chunk_m;
+        std::size_t used_m;
+    };
+
+    /**
+     * @brief Standard allocator backed by a SlotArena.
+     *
+     * Containers using it must not be accessed once the arena is reset; their
+     * destructors may still run afterwards, as deallocation is a no-op.
+     */
+    template <typename T>
+    class Allocator {
+    public:
+        using value_type = T;
+
+        explicit Allocator(SlotArena &arena) noexcept : arena_m(&arena) {}
+
+        template <typename U>
+        Allocator(const Allocator<U> &other) noexcept : arena_m(other.arena_m) {}
+
+        T *allocate(std::size_t n) {
+            if (n > std::numeric_limits<std::size_t>::max() / sizeof(T)) {
+                throw std::bad_alloc();
+            }
+            return static_cast<T *>(arena_m->allocate(n * sizeof(T), alignof(T)));
+        }
+
+        void deallocate(T *, std::size_t) noexcept {}
+
+        template <typename U>
+        bool operator==(const Allocator<U> &other) const noexcept {
+            return arena_m == other.arena_m;
+        }
+        template <typename U>
+        bool operator!=(const Allocator<U> &other) const noexcept {
+            return arena_m != other.arena_m;
+        }
+
+    private:
+        template <typename U>
+        friend class Allocator;
+
+        SlotArena *arena_m;
+    };
+
+private:
+    struct Chunk {
+        std::unique_ptr<std::byte[]> data;
+        std::size_t size = 0;
+        std::size_t used = 0;
+    };
+
+    static void *bump(Chunk &chunk, std::size_t bytes, std::size_t alignment) {
+        const auto base = reinterpret_cast<std::uintptr_t>(chunk.data.get());
+        const std::uintptr_t aligned =
+            (base + chunk.used + alignment - 1) & ~(std::uintptr_t(alignment) - 1);
+        const std::size_t offset = aligned - base;
+        if (offset + bytes > chunk.size) {
+            return nullptr;
+        }
+        chunk.used = offset + bytes;
+        return chunk.data.get() + offset;
+    }
+
+    void addChunk(std::size_t minBytes) {
+        std::size_t size = chunks_m.empty() ? initialBytes_m : chunks_m.back().size * 2;
+        size = std::max(size, minBytes);
+        Chunk chunk;
+        chunk.data.reset(new std::byte[size]);
+        chunk.size = size;
+        chunks_m.push_back(std::move(chunk));
+    }
+
+    std::size_t initialBytes_m;
+    std::vector<Chunk> chunks_m;
+    std::uint64_t generation_m = 0;
+    ULong64_t currentEntry_m = 0;
+    bool hasEntry_m = false;
+};
+
+/// std::vector whose buffer lives in a SlotArena.
+template <typename T>
+using ArenaVector = std::vector<T, SlotArena::Allocator<T>>;
+
+#endif // SLOTARENA_H_INCLUDED
@@ -0,0 +1,137 @@
+#ifndef SLOWSITEMONITOR_H_INCLUDED
+#define SLOWSITEMONITOR_H_INCLUDED
+
+#include <RtypesCore.h>
+#include <mutex>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief Tracks XRootD read throughput per site during the event loop.
+ *
+ * C++ counterpart of ``SlowSiteDetector`` in ``xrootd_site_selector.py``.
+ * Reads are attributed to the redirector of the file they came from
+ * (``root://host/``); local files are ignored. A site is flagged slow once
+ * its rolling throughput (total bytes over total read time) has stayed below
+ * the threshold for at least the window, measured in accumulated read time
+ * so that the decision does not depend on how the loop is scheduled.
+ *
+ * For each file on a slow site, failoverUrl() returns the same logical file
+ * name on the next redirector of its ranked ``site_redirectors.json`` list
+ * that is not itself slow. writeReport() stores the slow sites, the per-site
+ * statistics and these failover URLs so that a resubmitted job can avoid
+ * the slow replicas.
+ */
+class SlowSiteMonitor {
+public:
+  /// Read statistics accumulated for one site.
+  struct SiteStats {
+    Long64_t bytes = 0;
+    double seconds = 0.0;
+    /// Read time accumulated while the rolling throughput was below threshold.
+    double belowSeconds = 0.0;
+    bool slow = false;
+    std::set<std::string> files;
+  };
+
+  /**
+   * @param thresholdMBs Throughput (MB/s) below which a site is considered slow
+   * @param windowSeconds Read time below the threshold before a site is flagged
+   */
+  SlowSiteMonitor(double thresholdMBs, double windowSeconds);
+
+  /**
+   * @brief Redirector part of an XRootD URL (``root://host/``).
+   * @return Empty string for local paths
+   */
+  static std::string siteOf(const std::string &url);
+
+  /**
+   * @brief Logical file name of an XRootD URL (``/store/...``); local paths
+   * are returned unchanged.
+   */
+  static std::string logicalFileName(const std::string &url);
+
+  /**
+   * @brief Load the ranked redirectors per logical file name from a
+   * ``site_redirectors.json`` file. A missing file is not an error.
+   */
+  void loadRedirectors(const std::string &path);
+
+  /// Set the ranked redirectors per logical file name.
+  void setRedirectors(
+      std::unordered_map<std::string, std::vector<std::string>> redirectors);
+
+  /**
+   * @brief Record a completed read of @p bytes taking @p seconds from @p url.
+   * @return false when this read caused the file's site to be flagged slow
+   */
+  bool recordRead(const std::string &url, Long64_t bytes, double seconds);
+
+  /**
+   * @brief Mark the start of a new block of entries read by @p slot.
+   *
+   * Closes the previous block of the slot and records it through
+   * recordRead(). Bytes come from the process-wide TFile counter; while
+   * several slots read concurrently each closed block is credited with an
+   * equal share of the bytes read during it.
+   */
+  void onSample(unsigned int slot, const std::string &url);
+
+  /// onSample() with explicit monotonic time and process-wide byte count.
+  void onSample(unsigned int slot, const std::string &url, double timeSeconds,
+                Long64_t totalBytesRead);
+
+  /// Close the open blocks of all slots (end of the event loop).
+  void closeAll();
+  /// closeAll() with explicit monotonic time and process-wide byte count.
+  void closeAll(double timeSeconds, Long64_t totalBytesRead);
+
+  /// Flag @p site as slow without measurements (e.g. from an earlier report).
+  void markSlow(const std::string &site);
+
+  bool isSlow(const std::string &site) const;
+  std::vector<std::string> slowSites() const;
+
+  /// Rolling throughput of @p site in MB/s, or -1 without measurements.
+  double throughputMBs(const std::string &site) const;
+
+  /**
+   * @brief URL of the same file on the best-ranked redirector that is not
+   * slow.
+   * @return @p url when its site is not slow, an empty string when no
+   *         alternative redirector is known
+   */
+  std::string failoverUrl(const std::string &url) const;
+
+  /// Write the JSON report (slow sites, site statistics, failover URLs).
+  void writeReport(const std::string &path) const;
+
+  /// Slow sites listed in a report written by writeReport() (empty if absent).
+  static std::vector<std::string> readReportedSlowSites(const std::string &path);
+
+private:
+  struct OpenBlock {
+    std::string url;
+    double startSeconds = 0.0;
+    Long64_t startBytes = 0;
+    bool open = false;
+  };
+
+  bool recordReadLocked(const std::string &url, Long64_t bytes, double seconds);
+  void closeBlockLocked(OpenBlock &block, double timeSeconds,
+                        Long64_t totalBytesRead);
+  std::string failoverUrlLocked(const std::string &url) const;
+
+  double thresholdMBs_m;
+  double windowSeconds_m;
+  std::unordered_map<std::string, SiteStats> sites_m;
+  std::unordered_map<std::string, std::vector<std::string>> redirectors_m;
+  std::vector<OpenBlock> blocks_m;
+  unsigned int openBlocks_m = 0;
+  mutable std::mutex mutex_m;
+};
+
+#endif // SLOWSITEMONITOR_H_INCLUDED
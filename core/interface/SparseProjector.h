@@ -0,0 +1,63 @@
+#ifndef SPARSEPROJECTOR_H_INCLUDED
+#define SPARSEPROJECTOR_H_INCLUDED
+
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+class TH1D;
+class THnBase;
+
+/// One 1D projection of an N-dimensional histogram.
+struct SparseProjection {
+  /// Name of the output histogram.
+  std::string name;
+  /// Axis projected onto; its under- and overflow bins are kept.
+  int axis = 0;
+  /// (axis, bin) selections, e.g. the region and systematic bins.  Axes
+  /// without a selection are summed over all their bins, flow bins included.
+  std::vector<std::pair<int, int>> fixedBins;
+};
+
+/**
+ * @brief Projects merged THnSparse outputs into many 1D shapes at once.
+ *
+ * THnBase::Projection() scans every filled bin for each projection, so
+ * shapes for every region, process and systematic cost one scan each.
+ * SparseProjector scans the filled bins of a histogram once: the requested
+ * projections are grouped by projected axis and selected axes, and every
+ * bin is added to the preallocated outputs whose selection it matches
+ * (one hash lookup per group).
+ *
+ * Several histograms are projected in parallel on the implicit-MT pool; each
+ * histogram is scanned by one thread, since reading the bins of a
+ * THnSparse is not thread-safe.
+ */
+class SparseProjector {
+public:
+  /**
+   * @brief The projections @p projections of @p hist, in request order.
+   * @throws std::runtime_error if a projection refers to a missing axis or
+   *         bin, or selects the projected axis.
+   */
+  static std::vector<std::unique_ptr<TH1D>>
+  project(const THnBase &hist, const std::vector<SparseProjection> &projections);
+
+  /// project() of each histogram with its projections, in parallel.
+  static std::vector<std::vector<std::unique_ptr<TH1D>>>
+  project(const std::vector<const THnBase *> &hists,
+          const std::vector<std::vector<SparseProjection>> &projections);
+
+  /**
+   * @brief Read the histograms of @p projections (keyed by path in the file)
+   * from the ROOT file @p path and project them.
+   * @throws std::runtime_error if the file or a histogram cannot be read.
+   */
+  static std::map<std::string, std::vector<std::unique_ptr<TH1D>>>
+  projectFile(const std::string &path,
+              const std::map<std::string, std::vector<SparseProjection>> &projections);
+};
+
+#endif // SPARSEPROJECTOR_H_INCLUDED
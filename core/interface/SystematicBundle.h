@@ -121,6 +121,84 @@ std::vector<SystematicBundleOutputSpec> fanOutMultiOutputResultBundle(
     const std::string &resultBundleColumnName,
     bool registerOutputs);
 
+/**
+ * @brief Return a bundle column for @p variable laid out in @p variationLabels
+ * order, built from the bundle registered with the systematic manager.
+ *
+ * When the registered labels already match, the registered column itself is
+ * returned. Otherwise @p viewColumnName is defined (once) to reorder the
+ * blocks; labels the registered bundle does not contain take the Nominal
+ * block. Returns an empty string when no bundle is registered for
+ * @p variable.
+ *
+ * @throws std::runtime_error if the registered bundle has no Nominal block
+ *         but a requested label is missing from it.
+ */
+std::string defineVariationBundleView(
+    IDataFrameProvider &dataMgr,
+    ISystematicManager &sysMgr,
+    const std::string &variable,
+    const std::vector<std::string> &variationLabels,
+    const std::string &viewColumnName);
+
+/**
+ * @brief Define one column per block of a variation-major vector bundle.
+ *
+ * Output column @c outputColumnNames[k] is defined as block k of
+ * @p bundleColumnName, which must hold @c outputColumnNames.size() blocks of
+ * equal length. Empty names and columns that already exist are skipped.
+ */
+void fanOutVectorResultBundle(
+    IDataFrameProvider &dataMgr,
+    const std::string &bundleColumnName,
+    const std::vector<std::string> &outputColumnNames);
+
+/**
+ * @brief Varied pT (and mass) of a systematic source set, computed from one
+ *        variation-major scale-factor bundle (see the energy-scale
+ *        managers' applySystematicSet()).
+ */
+struct ScaledBundleStep {
+  std::string inputPtColumn;
+  std::string inputMassColumn;   ///< empty = skip mass
+  std::string sfBundleColumn;    ///< {S1Up, S1Down, ...} scale factors
+  std::string ptBundleColumn;    ///< {Nominal, S1Up, S1Down, ...} pT
+  std::string massBundleColumn;  ///< empty = skip mass
+  std::vector<std::string> sources;
+  std::vector<std::string> variationLabels;
+  std::vector<std::string> ptColumns;    ///< fan-out names per block
+  std::vector<std::string> massColumns;  ///< fan-out names per block
+  bool fanOutOutputs = true;
+  /// The SF bundle holds one relative uncertainty block u per source,
+  /// expanded to nominal × (1 + u) and nominal × (1 − u).
+  bool relativeUncertainties = false;
+};
+
+/**
+ * @brief Step with the bundle columns of @p bundle for @p inputPtColumn
+ *        (and @p inputMassColumn unless empty) and the Nominal block.
+ */
+ScaledBundleStep makeScaledBundleStep(const ResolvedSystematicBundleOptions &bundle,
+                                      const std::string &inputPtColumn,
+                                      const std::string &inputMassColumn);
+
+/// Append the up and down blocks of @p source to @p step.
+void addScaledBundleSource(ScaledBundleStep &step, const std::string &source,
+                           const std::string &upPtColumn, const std::string &downPtColumn,
+                           const std::string &upMassColumn, const std::string &downMassColumn);
+
+/**
+ * @brief Define and register the pT (and mass) bundles of @p step from its
+ *        scale-factor bundle.
+ *
+ * With @c fanOutOutputs the per-source columns are defined as bundle slices
+ * (and the caller registers them); otherwise each source is registered as a
+ * systematic of the bundle columns, so no column name is registered that is
+ * never defined.
+ */
+void defineScaledBundles(IDataFrameProvider &dataMgr, ISystematicManager &sysMgr,
+                         const ScaledBundleStep &step);
+
 constexpr const char *SYST_BUNDLE_PREFIX = "__syst_bundle__";
 
 inline std::string makeBundleColumnName(const std::string &tag,
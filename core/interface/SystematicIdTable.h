@@ -0,0 +1,67 @@
+#ifndef SYSTEMATICIDTABLE_H_INCLUDED
+#define SYSTEMATICIDTABLE_H_INCLUDED
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief Dense integer IDs for systematic names, variation labels and
+ * variables.
+ *
+ * Systematics are interned by their normalized name ("jes" for "jesUp" and
+ * "jesDown") and variables by their column name, each with IDs 0, 1, 2, ...
+ * in registration order.  Every interned systematic also registers its
+ * variation labels, so resolving a label such as "jesUp" is one hash lookup
+ * with no string built, instead of stripping the suffix and looking the
+ * result up in a set.  IDs are never reused; dropping a systematic (pruning)
+ * is up to the owner of the table.
+ */
+class SystematicIdTable {
+public:
+  using Id = std::uint32_t;
+  /// Returned for unknown names.
+  static constexpr Id npos = std::numeric_limits<Id>::max();
+
+  /// Direction of a variation label.
+  enum class Direction : std::uint8_t { None, Up, Down };
+
+  /// A variation label resolved to its systematic.
+  struct Variation {
+    Id systematic = npos;
+    Direction direction = Direction::None;
+  };
+
+  /// "jesUp" and "jesDown" become "jes"; other names are returned unchanged.
+  static std::string normalize(const std::string &label);
+
+  /// ID of the systematic normalize(@p name), interning it if new.
+  Id internSystematic(const std::string &name);
+  /// ID of the variable @p name, interning it if new.
+  Id internVariable(const std::string &name);
+
+  /// Systematic and direction of @p label ("jes", "jesUp", "jesDown").
+  Variation variation(const std::string &label) const;
+  /// ID of the systematic normalize(@p name), or npos.
+  Id systematicId(const std::string &name) const;
+  /// variation() of each label, e.g. of a makeSystList() result.
+  std::vector<Variation> variations(const std::vector<std::string> &labels) const;
+  /// ID of the variable @p name, or npos.
+  Id variableId(const std::string &name) const;
+
+  const std::string &systematicName(Id id) const { return systematics_m.at(id); }
+  const std::string &variableName(Id id) const { return variables_m.at(id); }
+  std::size_t systematicCount() const { return systematics_m.size(); }
+  std::size_t variableCount() const { return variables_m.size(); }
+
+private:
+  std::vector<std::string> systematics_m;
+  std::vector<std::string> variables_m;
+  std::unordered_map<std::string, Variation> labels_m;
+  std::unordered_map<std::string, Id> variableIds_m;
+};
+
+#endif // SYSTEMATICIDTABLE_H_INCLUDED
@@ -1,13 +1,29 @@
 #ifndef SYSTEMATICMANAGER_H_INCLUDED
 #define SYSTEMATICMANAGER_H_INCLUDED
 
+#include <functional>
+#include <map>
 #include <set>
 #include <string>
 #include <unordered_map>
 #include <vector>
+#include <SystematicIdTable.h>
 #include <api/IDataFrameProvider.h>
 #include <api/ISystematicManager.h>
 
+/**
+ * @brief Largest effect of a systematic over the histograms it was measured on.
+ *
+ * Both quantities take the larger of the Up and Down variations:
+ *  - normalization: |sum(varied) / sum(nominal) - 1|
+ *  - shape: total-variation distance between the unit-normalised varied and
+ *    nominal histograms, 0.5 * sum_i |v_i / sum(v) - n_i / sum(n)|
+ */
+struct SystematicImpact {
+  double normalization = 0.0;
+  double shape = 0.0;
+};
+
 /**
  * @brief SystematicManager: Handles tracking and applying systematic
  * variations. Implements ISystematicManager.
@@ -30,6 +46,13 @@ public:
                                 const std::string &upColumn,
                                 const std::string &downColumn) override;
 
+  void registerVariationBundle(const std::string &variable,
+                               const std::string &bundleColumn,
+                               const std::vector<std::string> &variationLabels) override;
+
+  const SystematicVariationBundle *
+  getVariationBundle(const std::string &variable) const override;
+
   /**
    * @brief Get the set of all registered systematics
    * @return Reference to the set of systematic names
@@ -52,6 +75,29 @@ public:
   const std::set<std::string> &
   getSystematicsForVariable(const std::string &var) const override;
 
+  /**
+   * @brief Whether @p variable is affected by the systematic of the variation
+   * label @p syst ("jes", "jesUp" or "jesDown").
+   *
+   * Two hash lookups in the interned IDs and a bit test; no string is built.
+   */
+  bool isVariableAffectedBySystematic(const std::string &variable,
+                                      const std::string &syst) const override;
+
+  /// isVariableAffectedBySystematic() on interned IDs (npos: false).
+  bool isVariableAffected(SystematicIdTable::Id variable,
+                          SystematicIdTable::Id systematic) const;
+
+  /**
+   * @brief Interned IDs of the registered systematics and variables.
+   *
+   * Callers that resolve the same labels for many variables (bundles,
+   * plugin variation tables) can resolve the labels once with
+   * SystematicIdTable::variations() and test isVariableAffected() per
+   * variable.
+   */
+  const SystematicIdTable &getSystematicIds() const;
+
   /**
    * @brief Register existing systematics from configuration
    * @param systConfig Vector of systematic names
@@ -83,17 +129,95 @@ public:
    */
   bool isBranchNameMaterialized(const std::string &branchName) const override;
 
+  /**
+   * @brief Resolve the variation column and mark it as consumed.
+   *
+   * When a column materializer is set, a resolved name other than
+   * @p variable is passed to it so that a deferred column is defined before
+   * the caller uses it.
+   */
   std::string getVariationColumnName(const std::string &variable,
                                      const std::string &syst) const override;
 
+  std::string resolveVariationColumnName(const std::string &variable,
+                                         const std::string &syst) const override;
+
+  /**
+   * @brief Set the callback that defines deferred variation columns.
+   *
+   * Installed by the Analyzer when DataManager defers variation columns
+   * (config key @c deferVariationColumns); pass an empty function to clear.
+   */
+  void setColumnMaterializer(std::function<void(const std::string &)> materializer);
+
+  /**
+   * @brief Record the effect of @p syst on one histogram.
+   *
+   * Keeps the largest normalization and shape effect seen for @p syst over
+   * all recorded histograms, so a systematic survives pruning when it
+   * matters in any region.  Histograms with an empty nominal are ignored.
+   */
+  void recordSystematicImpact(const std::string &syst,
+                              const std::vector<double> &nominal,
+                              const std::vector<double> &up,
+                              const std::vector<double> &down) override;
+
+  /// Effect of one Up/Down pair on one histogram.
+  static SystematicImpact measureImpact(const std::vector<double> &nominal,
+                                        const std::vector<double> &up,
+                                        const std::vector<double> &down);
+
+  /// Measured impact of each systematic recorded so far.
+  const std::map<std::string, SystematicImpact> &getSystematicImpacts() const;
+
+  /**
+   * @brief Systematics whose normalization and shape effects are both below
+   *        the thresholds.  Systematics that were never measured are kept.
+   */
+  std::vector<std::string> selectPrunableSystematics(double normThreshold,
+                                                     double shapeThreshold) const;
+
+  /**
+   * @brief Write the pruning decisions of a first pass to @p path (JSON).
+   *
+   * The report lists the thresholds, the measured impact of each systematic,
+   * the pruned systematics and the quadrature sum of their normalization
+   * effects ("merged_normalization"), which can be assigned to a single
+   * normalization nuisance in the fit.
+   */
+  void writePruningReport(const std::string &path, double normThreshold,
+                          double shapeThreshold) const;
+
+  /// Read the pruned systematics of a report; empty when missing or invalid.
+  static std::vector<std::string> readPrunedSystematics(const std::string &path);
+
+  /**
+   * @brief Drop @p systematics from the run.
+   *
+   * Already registered entries are removed and later registrations of these
+   * names are ignored, so no variation columns, Defines or histogram fills
+   * are created for them.  Call before plugins register their variations.
+   */
+  void setPrunedSystematics(const std::vector<std::string> &systematics);
+
+  /// Systematics dropped by setPrunedSystematics().
+  const std::set<std::string> &getPrunedSystematics() const;
+
 private:
   std::set<std::string> systematics_m;
-  std::unordered_map<std::string, std::set<std::string>>
-      systematicToVariableMap_m;
+  SystematicIdTable ids_m;
+  /// Affected variables of each systematic, by systematic ID.
+  std::vector<std::set<std::string>> variablesBySystematic_m;
+  /// affected_m[variable ID][systematic ID]; rows grow on demand.
+  std::vector<std::vector<bool>> affected_m;
   std::unordered_map<std::string, std::set<std::string>>
       variableToSystematicMap_m;
   std::unordered_map<std::string, std::unordered_map<std::string, std::string>>
       variationColumnMap_m;
+  std::unordered_map<std::string, SystematicVariationBundle> variationBundles_m;
+  std::map<std::string, SystematicImpact> impacts_m;
+  std::set<std::string> prunedSystematics_m;
+  std::function<void(const std::string &)> columnMaterializer_m;
   /// Per-branchName cache: maps each materialized branchName to its systList.
   /// Enables multiple callers to safely share or isolate counter namespaces.
   std::unordered_map<std::string, std::vector<std::string>>
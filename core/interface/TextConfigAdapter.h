@@ -6,6 +6,9 @@
 
 /**
  * @brief Default text-based configuration adapter (current behavior).
+ *
+ * Each file is read into one buffer and tokenized in place through
+ * string_views; only keys and values are copied out.
  */
 class TextConfigAdapter : public IConfigAdapter {
 public:
@@ -20,12 +23,9 @@ public:
   parseVectorConfig(const std::string &configFile) const override;
 
 private:
-  std::string stripComment(const std::string &line) const;
   std::string_view trim(std::string_view s) const;
-  std::pair<std::string, std::string> parsePair(const std::string &line,
-                                                bool stripComments) const;
-  std::vector<std::string> splitString(std::string_view input,
-                                       std::string_view delimiter) const;
+  /// Trimmed key and value of a ``key=value`` token; empty without '='.
+  std::pair<std::string_view, std::string_view> parsePair(std::string_view line) const;
 };
 
 #endif // TEXTCONFIGADAPTER_H_INCLUDED
@@ -0,0 +1,69 @@
+/**
+ * @file ThreadLocalPool.h
+ * @brief One lazily created object per worker thread, e.g. an inference
+ *        session of a model.
+ */
+#ifndef THREADLOCALPOOL_H_INCLUDED
+#define THREADLOCALPOOL_H_INCLUDED
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/**
+ * @class ThreadLocalPool
+ * @brief Owns one @p T per thread that asked for one.
+ *
+ * local() is lock-free after the first call on a thread: each thread keeps
+ * a small cache keyed by pool id.  Pool ids are never reused, so entries of
+ * destroyed pools can never match.  Objects live as long as the pool.
+ */
+template <typename T> class ThreadLocalPool {
+public:
+  ThreadLocalPool() {
+    static std::atomic<std::uint64_t> nextId{1};
+    id_m = nextId.fetch_add(1);
+  }
+
+  ThreadLocalPool(const ThreadLocalPool &) = delete;
+  ThreadLocalPool &operator=(const ThreadLocalPool &) = delete;
+
+  /**
+   * @brief Object of the calling thread, created by @p make (returning a
+   *        std::unique_ptr<T>) on the first call of the thread.
+   */
+  template <typename Make> T &local(Make &&make) {
+    thread_local std::vector<std::pair<std::uint64_t, T *>> cache;
+    for (const auto &[id, object] : cache) {
+      if (id == id_m) {
+        return *object;
+      }
+    }
+    std::lock_guard<std::mutex> lock(mutex_m);
+    auto &object = objects_m[std::this_thread::get_id()];
+    if (!object) {
+      object = make();
+    }
+    cache.emplace_back(id_m, object.get());
+    return *object;
+  }
+
+  /// Number of objects created so far.
+  std::size_t size() const {
+    std::lock_guard<std::mutex> lock(mutex_m);
+    return objects_m.size();
+  }
+
+private:
+  std::uint64_t id_m;
+  mutable std::mutex mutex_m;
+  std::unordered_map<std::thread::id, std::unique_ptr<T>> objects_m;
+};
+
+#endif // THREADLOCALPOOL_H_INCLUDED
@@ -0,0 +1,96 @@
+/**
+ * @file ThreadPinning.h
+ * @brief NUMA topology of the host and pinning of event-loop threads to
+ *        CPUs, so that per-slot memory stays on the local NUMA node.
+ */
+#ifndef THREADPINNING_H_INCLUDED
+#define THREADPINNING_H_INCLUDED
+
+#include <atomic>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/**
+ * @class ThreadPinning
+ * @brief Pins the thread processing a slot to a fixed CPU.
+ *
+ * The CPUs the process may run on (its affinity mask, which honours batch
+ * cpusets) are ordered node by node, and slot @c i is pinned to the
+ * @c i-th of them modulo their number.  A job with fewer slots than CPUs
+ * therefore fills one NUMA node before using the next.
+ *
+ * Linux places a page on the node of the thread that first writes it, so
+ * per-slot buffers allocated by the pinned thread (SlotArena chunks, dense
+ * histogram accumulators, see FlatHistAccumulator::place()) end up on the
+ * node that reads them.  Event-loop code calls pinSlot() at the start of
+ * each task; it is a no-op unless a ThreadPinning is active.  The thread
+ * that runs the event loop also processes tasks, so it calls unpin() after
+ * the loop to get back the CPUs it had when the ThreadPinning was created.
+ */
+class ThreadPinning {
+public:
+  /// CPUs of one NUMA node.
+  struct Node {
+    int id = 0;
+    std::vector<int> cpus;
+  };
+
+  /**
+   * @brief NUMA nodes of the host restricted to the CPUs of the process
+   *        affinity mask, read from /sys/devices/system/node.
+   *
+   * Returns one node with every allowed CPU when the kernel exposes no NUMA
+   * information.
+   */
+  static std::vector<Node> readTopology();
+
+  /// Parse a kernel CPU list such as "0-3,8,10-11".
+  static std::vector<int> parseCpuList(const std::string &list);
+
+  explicit ThreadPinning(std::vector<Node> topology);
+  ~ThreadPinning();
+
+  ThreadPinning(const ThreadPinning &) = delete;
+  ThreadPinning &operator=(const ThreadPinning &) = delete;
+
+  /// Make this the instance pinSlot() uses (nullptr disables pinning).
+  static void activate(ThreadPinning *pinning);
+
+  /// Pin the calling thread to the CPU of @p slot, if pinning is active.
+  static void pinSlot(unsigned int slot) {
+    if (ThreadPinning *pinning = active_s.load(std::memory_order_acquire)) {
+      pinning->pin(slot);
+    }
+  }
+
+  /// CPU slot @p slot is pinned to.
+  int cpuOfSlot(unsigned int slot) const { return cpus_m[slot % cpus_m.size()]; }
+
+  /// NUMA node slot @p slot is pinned to.
+  int nodeOfSlot(unsigned int slot) const { return nodes_m[slot % nodes_m.size()]; }
+
+  const std::vector<Node> &topology() const { return topology_m; }
+
+  /// Number of times a thread was moved to the CPU of its slot.
+  std::size_t pinnedThreads() const { return pinned_m.load(std::memory_order_relaxed); }
+
+  /// Give the calling thread, if pinned, the affinity mask of the thread
+  /// that created this instance.
+  void unpin() const;
+
+private:
+  void pin(unsigned int slot);
+
+  static std::atomic<ThreadPinning *> active_s;
+
+  std::vector<Node> topology_m;
+  /// CPUs in pinning order, and the node of each.
+  std::vector<int> cpus_m;
+  std::vector<int> nodes_m;
+  /// Affinity mask of the creating thread.
+  std::vector<int> originalCpus_m;
+  std::atomic<std::size_t> pinned_m{0};
+};
+
+#endif // THREADPINNING_H_INCLUDED
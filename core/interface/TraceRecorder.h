@@ -0,0 +1,135 @@
+/**
+ * @file TraceRecorder.h
+ * @brief Timeline of the spans of a job (phases, plugin hooks, event loop
+ *        tasks), exported in the Chrome trace event format.
+ */
+#ifndef TRACERECORDER_H_INCLUDED
+#define TRACERECORDER_H_INCLUDED
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/**
+ * @class TraceRecorder
+ * @brief Collects timed spans on per-thread and per-slot tracks.
+ *
+ * Spans are coarse (a phase, a plugin hook, one event loop task), so they
+ * are appended to one vector under a mutex; nothing is recorded per entry.
+ * Disabled, which is the default, a Span costs one relaxed atomic load.
+ *
+ * Every thread that records gets its own track ("main" for the thread that
+ * enabled the recorder, "thread N" for the others); the tasks of the event
+ * loop go to one track per RDataFrame slot ("slot N"), so load imbalance
+ * and serial tails show up as gaps.  writeChromeTrace() writes a file that
+ * chrome://tracing and ui.perfetto.dev open directly.
+ *
+ * The process-wide instance() is enabled by the Analyzer when ``traceFile``
+ * is set (see TraceService).
+ */
+class TraceRecorder {
+public:
+  using Clock = std::chrono::steady_clock;
+
+  /// Tracks at and above this id belong to RDataFrame slots.
+  static constexpr std::uint32_t kSlotTrackBase = 1000;
+
+  /// One completed span.
+  struct Event {
+    std::string name;
+    std::string category;
+    std::uint32_t track = 0;
+    Clock::time_point begin;
+    Clock::time_point end;
+    /// Shown in the detail panel of the span.
+    std::vector<std::pair<std::string, std::string>> args;
+  };
+
+  /// Records the time from its construction to its destruction as a span
+  /// on the track of the constructing thread.
+  class Span {
+  public:
+    Span(const char *category, std::string name, TraceRecorder &recorder = instance())
+        : recorder_m(recorder.enabled() ? &recorder : nullptr) {
+      if (recorder_m) {
+        category_m = category;
+        name_m = std::move(name);
+        begin_m = Clock::now();
+      }
+    }
+    ~Span() {
+      if (recorder_m) {
+        recorder_m->record(std::move(name_m), category_m, begin_m, Clock::now());
+      }
+    }
+    Span(const Span &) = delete;
+    Span &operator=(const Span &) = delete;
+
+  private:
+    TraceRecorder *recorder_m;
+    const char *category_m = nullptr;
+    std::string name_m;
+    Clock::time_point begin_m;
+  };
+
+  /// The recorder of the process.
+  static TraceRecorder &instance();
+
+  TraceRecorder() = default;
+  TraceRecorder(const TraceRecorder &) = delete;
+  TraceRecorder &operator=(const TraceRecorder &) = delete;
+
+  /// Start recording; the calling thread becomes the "main" track.
+  void enable();
+  /// Stop recording; recorded spans are kept.
+  void disable() { enabled_m.store(false, std::memory_order_relaxed); }
+  bool enabled() const { return enabled_m.load(std::memory_order_relaxed); }
+
+  /// Record a span on the track of the calling thread (no-op when disabled).
+  void record(std::string name, const char *category, Clock::time_point begin,
+              Clock::time_point end,
+              std::vector<std::pair<std::string, std::string>> args = {});
+
+  /// Record a span on the track of RDataFrame slot @p slot.
+  void recordSlot(unsigned int slot, std::string name, const char *category,
+                  Clock::time_point begin, Clock::time_point end,
+                  std::vector<std::pair<std::string, std::string>> args = {});
+
+  /// Copy of the spans recorded so far, in recording order.
+  std::vector<Event> events() const;
+
+  /// Name of track @p track ("main", "thread N" or "slot N").
+  std::string trackName(std::uint32_t track) const;
+
+  /// Drop every recorded span.
+  void clear();
+
+  /**
+   * @brief Write the spans as Chrome trace event JSON to @p path.
+   *
+   * Timestamps are microseconds of the steady clock.  The file is written
+   * next to @p path and renamed over it.
+   *
+   * @throws std::runtime_error if @p path cannot be written.
+   */
+  void writeChromeTrace(const std::string &path) const;
+
+private:
+  void append(Event event);
+  /// Track of the calling thread, assigned on its first span.
+  std::uint32_t threadTrack();
+
+  std::atomic<bool> enabled_m{false};
+  mutable std::mutex mutex_m;
+  std::vector<Event> events_m;
+  std::thread::id mainThread_m;
+  std::vector<std::thread::id> threads_m;
+};
+
+#endif // TRACERECORDER_H_INCLUDED
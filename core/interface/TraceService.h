@@ -0,0 +1,76 @@
+#ifndef TRACESERVICE_H_INCLUDED
+#define TRACESERVICE_H_INCLUDED
+
+#include "api/IAnalysisService.h"
+#include <ROOT/RResultPtr.hxx>
+#include <RtypesCore.h>
+#include <TraceRecorder.h>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief Analysis service writing a Chrome trace / Perfetto timeline of the
+ *        job to ``traceFile``.
+ *
+ * The Analyzer enables TraceRecorder::instance() when ``traceFile`` is set,
+ * so the job phases (see PhaseTimer) and the setup, initialize, execute and
+ * finalize hooks of every plugin are recorded from the start.  This service
+ * adds the event loop: an action booked before any filter records every
+ * RDataFrame task as a span on the track of its slot, with the input file
+ * and the number of entries, and the time between the loop trigger and the
+ * first entry (graph jitting) as a "jit" span.
+ *
+ * The trace is written by write(), which the Analyzer calls once everything
+ * else, including the plugins' finalize(), is done.
+ */
+class TraceService : public IAnalysisService {
+public:
+  /// Task state of one slot; only the slot's thread touches it.
+  struct alignas(64) SlotTask {
+    TraceRecorder::Clock::time_point begin;
+    /// Entries of the current task and of all tasks of the slot.
+    std::uint64_t entries = 0;
+    std::uint64_t total = 0;
+    std::string file;
+  };
+
+  /// State shared with the booked action.
+  struct Loop {
+    explicit Loop(unsigned int nSlots) : slots(nSlots) {}
+    std::vector<SlotTask> slots;
+    /// Set by markEventLoopTrigger(), consumed when the loop starts.
+    bool triggerMarked = false;
+    TraceRecorder::Clock::time_point trigger;
+    TraceRecorder::Clock::time_point start;
+  };
+
+  /**
+   * @brief Book the task recorder on the data frame.
+   * @throws std::runtime_error if traceFile is not set
+   */
+  void initialize(ManagerContext &ctx) override;
+
+  /// Nothing to do: the trace is written by write() after the plugins.
+  void finalize(ROOT::RDF::RNode &df) override;
+
+  /// Mark the call that starts the event loop; the time up to its first
+  /// entry is recorded as graph jitting.
+  void markEventLoopTrigger();
+
+  /// Write the spans recorded so far to ``traceFile``.
+  void write() const;
+
+  /// Provenance: "service.trace.file".
+  std::unordered_map<std::string, std::string>
+  collectProvenanceEntries() const override;
+
+private:
+  std::string path_m;
+  std::shared_ptr<Loop> loop_m;
+  ROOT::RDF::RResultPtr<ULong64_t> result_m;
+};
+
+#endif // TRACESERVICE_H_INCLUDED
@@ -0,0 +1,132 @@
+/**
+ * @file TrainingShuffler.h
+ * @brief Shuffle buffer and per-class down-sampling for ML training output.
+ *
+ * Training pipelines want rows in random order and, often, fewer rows of the
+ * abundant classes.  Doing either after the skim means reading it again;
+ * TrainingShuffler does both on the ColumnChunker chunks of the event loop,
+ * so the written dataset is ready to be streamed into training.
+ *
+ * TrainingSettings::shuffleRows rows are buffered in total, split evenly
+ * between the slots, so the memory does not grow with the thread count.
+ * Rows first fill the buffer of their slot; once it is full, every new row
+ * replaces a random buffered row, which is written out (the shuffle buffer
+ * of tf.data and torchdata).  At the end the buffers are shuffled and
+ * written.  A row ends up at most about one slot buffer from a random
+ * position of its slot's output, so each slot buffer should hold several
+ * row groups; the slots write separate files, so reading their row groups
+ * in random order mixes the slots too.
+ */
+#ifndef TRAININGSHUFFLER_H_INCLUDED
+#define TRAININGSHUFFLER_H_INCLUDED
+
+#include <ColumnChunker.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+class IConfigurationProvider;
+
+/**
+ * @brief Training output settings (``skimOutputFormat=training``).
+ */
+struct TrainingSettings {
+  /// Class label column; integer (or bool) valued.
+  std::string labelColumn;
+  /// Optional event weight column, written with the features.
+  std::string weightColumn;
+  /// Rows per written chunk (Parquet row group).
+  std::size_t chunkRows = 65536;
+  /// Rows of the shuffle buffers, summed over the slots.
+  std::size_t shuffleRows = 262144;
+  /// Fraction of the rows of each label that is kept; labels not listed keep all.
+  std::map<std::int64_t, double> classFractions;
+  /// Seed of the random generators; slot @c s uses seed + s.
+  std::uint64_t seed = 1;
+
+  /**
+   * @brief Settings from the ``training*`` config keys; @p chunkRows is the
+   *        row group size.
+   * @throws std::runtime_error if trainingLabelColumn is unset or a value
+   *         is invalid
+   */
+  static TrainingSettings fromConfig(const IConfigurationProvider &configProvider,
+                                     std::size_t chunkRows);
+};
+
+/**
+ * @class TrainingShuffler
+ * @brief Down-samples and shuffles the chunks of a ColumnChunker per slot.
+ *
+ * add() is called by the slot threads, concurrently for different slots;
+ * the emitted chunks carry the slot they came from and are emitted on its
+ * thread, so a consumer writing one file per slot needs no lock.  drain()
+ * runs after the event loop.  Only scalar columns are supported.
+ */
+class TrainingShuffler {
+public:
+  using Emit = std::function<void(ColumnChunker::Chunk &&)>;
+
+  /// Rows of one label seen and kept.
+  struct ClassCount {
+    std::uint64_t seen = 0;
+    std::uint64_t kept = 0;
+  };
+
+  /**
+   * @throws std::invalid_argument if chunkRows or shuffleRows is zero, the
+   *         label column is empty or a class fraction is outside [0, 1]
+   */
+  TrainingShuffler(TrainingSettings settings, unsigned int nSlots, Emit emit);
+
+  /**
+   * @brief Down-sample the rows of @p chunk and pass them through the
+   *        buffer of its slot, emitting every full chunk.
+   * @throws std::runtime_error if the chunk lacks the label column or has
+   *         an RVec column
+   */
+  void add(ColumnChunker::Chunk &&chunk);
+
+  /// Shuffle what every buffer holds and emit it, with the last partial chunks.
+  void drain();
+
+  /// Rows seen and kept per label, over all slots.
+  std::map<std::int64_t, ClassCount> classCounts() const;
+
+  const TrainingSettings &settings() const { return settings_m; }
+
+private:
+  struct Slot {
+    std::mt19937_64 rng;
+    /// Buffered rows; columns as in the chunks.
+    ColumnChunker::Chunk buffer;
+    /// Rows evicted from the buffer, not yet emitted.
+    ColumnChunker::Chunk out;
+    std::map<std::int64_t, ClassCount> counts;
+    bool initialised = false;
+  };
+
+  /// Row @c row of the input goes to buffer row @c target (npos: appended).
+  struct Placement {
+    std::size_t row;
+    std::size_t target;
+  };
+
+  void initialise(Slot &slot, const ColumnChunker::Chunk &chunk) const;
+  void place(Slot &slot, ColumnChunker::Chunk &chunk, const std::vector<Placement> &placements);
+  void emitOut(Slot &slot, unsigned int slotIndex);
+  double fraction(std::int64_t label) const;
+
+  TrainingSettings settings_m;
+  /// Rows of the buffer of one slot.
+  std::size_t slotRows_m;
+  std::vector<Slot> slots_m;
+  Emit emit_m;
+};
+
+#endif // TRAININGSHUFFLER_H_INCLUDED
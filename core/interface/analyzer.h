@@ -15,6 +15,7 @@
 #include <RtypesCore.h>
 #include <correction.h>
 #include <fastforest.h>
+#include <map>
 #include <memory>
 #include <string>
 #include <unordered_map>
@@ -30,11 +31,19 @@
 #include <functions.h>
 #include <api/IPluggableManager.h>
 #include <api/ILogger.h>
+#include <AsyncLogger.h>
 #include <api/IOutputSink.h>
 #include <api/IAnalysisService.h>
 #include <api/ManagerContext.h> // needed for wiring plugins and services
+#include <FilterProfile.h>
+#include <PhaseTimer.h>
+#include <GraphCost.h>
 
 class ProvenanceService; // forward declare to avoid header pollution
+class CheckpointService;
+class TraceService;
+class CounterService;
+class WeightManager;
 
 
 /**
@@ -139,10 +148,78 @@ public:
     }
     name = "pass_" + name;
     Define(name, f, columns);
+    if (preselectionOpen_m) {
+      // Applied by endPreselection(), in the order of the filter profile.
+      preselection_m.push_back(name);
+      return this;
+    }
     dataFrameProvider_m->Filter(passCut, {name});
     return this;
   }
 
+  /**
+   * @brief Compute the columns of plugin @p role only where the boolean
+   *        column @p gateColumn is true.
+   *
+   * Columns the plugin defines through IDataFrameProvider::Define() or
+   * IDataFrameProvider::defineColumn() while it is set up, initialized or
+   * executed, and the columns it lists in getProducedColumns() wherever
+   * they are defined, evaluate their callable only for entries passing the
+   * gate and hold a value-initialised result (0, an empty RVec) otherwise.
+   * Up/Down variants share the gate.  Gate columns must be defined before
+   * the gated columns; nodes defined directly on an RNode, string
+   * expressions, Redefine()s and columns whose result is not
+   * default-constructible are not gated.
+   *
+   * Equivalent to the @c pluginGates config entry @c <role>:<column>.
+   * Only gate plugins whose results are not used for events failing the
+   * gate: a gated column reads as 0 there.
+   *
+   * @return Pointer to this Analyzer (for chaining)
+   */
+  Analyzer *gatePlugin(const std::string& role, const std::string& gateColumn);
+
+  /**
+   * @brief Open a preselection block of commutative filters.
+   *
+   * Filter() calls up to endPreselection() define their pass column but
+   * are applied only when the block is closed.  With @c filterProfile set,
+   * the filters of the block are timed and counted during the event loop
+   * (the time of a filter includes the columns it is the first of the block
+   * to read), the totals are saved to the profile, and a later run applies them in
+   * increasing order of cost / rejection (see FilterProfile), so a cheap
+   * cut that rejects most events runs before an expensive one.  Without a
+   * profile, or until every filter of the block has one, the declared order
+   * is kept.
+   *
+   * Only filters whose outcome does not depend on each other may share a
+   * block.  CutflowManager counts its cuts in their registration order from
+   * its own base node, so cutflows do not change with the order applied.
+   *
+   * With @c selectionCacheDir set, the entries passing a block named
+   * @p name are stored per input file as a SelectionBitmap, keyed by a hash
+   * of the name, @p version, the block's filters and the config (the values
+   * of the @c selectionCacheKeys entries, or the whole config when unset).
+   * A later run with the same key reads only those entries (see
+   * DataManager::useSelectionCache()); the filters are still applied.  Only
+   * the first named block of a job is cached.
+   *
+   * @param name    Name of the block; unnamed blocks are never cached.
+   * @param version Version of the block's cuts, which the key cannot see:
+   *                change it whenever a cut changes.  Blocks without a
+   *                version are never cached.
+   * @throws std::runtime_error if a block is already open
+   * @return Pointer to this Analyzer (for chaining)
+   */
+  Analyzer *beginPreselection(const std::string& name = "", const std::string& version = "");
+
+  /**
+   * @brief Apply the filters of the open preselection block.
+   * @throws std::runtime_error if no block is open
+   * @return Pointer to this Analyzer (for chaining)
+   */
+  Analyzer *endPreselection();
+
   /**
    * @brief Define a variable per sample (e.g., for storing constants).
    * @tparam F Callable type for the variable definition
@@ -166,7 +243,7 @@ public:
     auto storeVar = [var](unsigned int, const ROOT::RDF::RSampleInfo) -> T {
       return (var);
     };
-    std::cout << "Defining variable " << name << " to be " << var << std::endl;
+    RDF_LOG_INFO << "Defining variable " << name << " to be " << var;
     dataFrameProvider_m->DefinePerSample(name, storeVar);
     return (this);
   }
@@ -220,8 +297,15 @@ public:
    *
    * Triggers the event loop exactly once. This method:
    *  - Writes a skim only when @c enableSkim=1 (or @c true/@c True) is present in the config.
+   *    The skim is booked as a lazy Snapshot and filled by the histogram event loop.
    *  - Saves all histograms booked on the NDHistogramManager (if one is registered).
    *  - Finalizes all analysis services (e.g. CounterService).
+   *  - With @c checkpointFile set, checkpoints the results of the
+   *    ICheckpointParticipant plugins during the event loop (see
+   *    CheckpointService).
+   *  - In a systematic pruning pass (@c systematicPruningReport set), writes
+   *    the pruning report measured from the saved histograms.
+   *  - Warns if more than one event loop ran.
    *
    * Use this instead of manually calling save() followed by a separate
    * NDHistogramManager::saveHists() call.
@@ -230,6 +314,34 @@ public:
    */
   Analyzer *run();
 
+  /**
+   * @brief run() several analyzers with their event loops running
+   *        concurrently.
+   *
+   * Every analyzer first books its skim, checkpoints and pending results as
+   * run() does.  ROOT::RDF::RunGraphs() then starts the event loops of all
+   * of them together, which fills every result booked on each computation
+   * graph (histograms, cutflows, counters, plugin results), and each
+   * analyzer finally saves and finalizes as run() does.  Under ImplicitMT
+   * the loops share the thread pool, so analyzers over small inputs (one
+   * per sample or systematic configuration) keep all cores busy where one
+   * graph alone would not; without it they run one after the other.
+   *
+   * @throws std::invalid_argument if an analyzer is null or listed twice
+   */
+  static void runAll(const std::vector<Analyzer*>& analyzers);
+
+  /**
+   * @brief Estimate the resources of the booked graph without running it.
+   *
+   * Counts the defined columns, the string expressions to JIT-compile, the
+   * systematics and slots, and what the plugins book (histogram cells and
+   * slot memory, ML models; see IPluggableManager::estimateCost()).  Call
+   * after the plugins booked their results, as the ``dryRun`` mode of run()
+   * and save() does.
+   */
+  GraphCost estimateCost() const;
+
   /**
    * @brief Get the underlying RDataFrame node.
    * @return The current RNode
@@ -320,7 +432,26 @@ public:
    */
   Analyzer *setTaskMetadata(const std::string& key, const std::string& value);
 
+  /**
+   * @brief Set the scale of the histogram and weighted cutflow outputs: the
+   *        deferred normalization of the WeightManager plugins, or else the
+   *        preview scale of a preview run.
+   *
+   * The preview scale applies to the histograms only: CounterService and
+   * CutflowManager report the entries actually read.
+   *
+   * Called by save() / run(); callers reading the histograms without saving
+   * them (e.g. NDHistogramManager::packResults()) call it first.  Runs the
+   * event loop if a normalization is deferred and the loop has not run yet.
+   */
+  void applyOutputScales();
+
 private:
+  /**
+   * @brief Wall and CPU time of the job phases, reported in the provenance.
+   * Declared first so that it starts before the configuration is parsed.
+   */
+  PhaseTimer phaseTimer_m;
   /**
    * @brief Verbosity level for logging and debug output (higher = more verbose)
    */
@@ -374,6 +505,16 @@ private:
    * after initializeServices() has run.
    */
   ProvenanceService* provenanceService_m = nullptr;
+  /**
+   * @brief Non-owning pointer to the CheckpointService (owned by services_m),
+   * or nullptr when @c checkpointFile is not set.
+   */
+  CheckpointService* checkpointService_m = nullptr;
+  /**
+   * @brief Non-owning pointer to the TraceService (owned by services_m),
+   * or nullptr when @c traceFile is not set.
+   */
+  TraceService* traceService_m = nullptr;
   /**
    * @brief Task-level provenance metadata contributed via setTaskMetadata().
    * Entries are stored here until finalize time, then forwarded to the
@@ -399,6 +540,191 @@ private:
    * written to disk.
    */
   void collectAndRegisterProvenance(ROOT::RDF::RNode& df);
+
+  /**
+   * @brief Warn when run() started more than one event loop on @p df.
+   *
+   * Each extra loop re-reads the full input; it usually means a result was
+   * booked after another one had already been read.
+   *
+   * @param runsBefore Value of df.GetNRuns() when run() started.
+   */
+  void warnOnRepeatedEventLoops(ROOT::RDF::RNode& df, unsigned int runsBefore) const;
+
+  /**
+   * @brief Book everything run() triggers: plugin execute() hooks, the skim,
+   *        checkpoints and input branch pruning.
+   * @return Whether a skim was booked.
+   */
+  bool prepareRun(ROOT::RDF::RNode& df);
+
+  /**
+   * @brief With ``dryRun=true``: book the plugin results, report
+   *        estimateCost() against the ``costBudget*`` keys (to
+   *        ``dryRunReport`` when set) and skip the event loop.
+   * @return Whether the job is a dry run.
+   */
+  bool runDry();
+
+  /**
+   * @brief Save the histograms and skim booked by prepareRun() (running the
+   *        event loop if it has not run yet) and finalize services and plugins.
+   */
+  void completeRun(ROOT::RDF::RNode& df, bool skimBooked, unsigned int runsBefore);
+
+  /// WeightManager plugins with a deferred normalization.
+  std::vector<WeightManager*> deferredNormalizationManagers() const;
+
+  /// The CounterService summing counterWeightBranch, or nullptr.
+  CounterService* weightCounters() const;
+
+  /**
+   * @brief Check before the event loop that this job can resolve the
+   *        deferred normalizations of the WeightManager plugins.
+   * @param writesSkim Whether the job writes a skim.
+   * @throws std::runtime_error if a plugin defers its normalization but the
+   *         job has no weight counters, resumes from a checkpoint, reads only
+   *         part of its sample (``firstEntry``/``lastEntry``, an MPI rank, or
+   *         ``sampleJobs`` > 1) or writes a skim
+   */
+  void checkDeferredNormalization(bool writesSkim) const;
+
+  /**
+   * @brief Resolve the deferred normalizations of the WeightManager plugins
+   *        with the CounterService sum of weights and scale the saved
+   *        histograms and weighted cutflows by them (runs the event loop if
+   *        it has not run yet).
+   * @return Whether a deferred normalization was applied.
+   * @throws std::runtime_error if a plugin defers its normalization but the
+   *         job has no weight counters
+   */
+  bool applyDeferredNormalization();
+
+  /**
+   * @brief Register the results of every ICheckpointParticipant plugin with
+   * the CheckpointService and arm it (no-op without @c checkpointFile).
+   */
+  void bookCheckpoints();
+
+  /**
+   * @brief Set up two-pass systematic pruning from the configuration.
+   *
+   *  - @c systematicPruningInput: report of an earlier pass; its pruned
+   *    systematics are dropped before any plugin registers variations.
+   *  - @c systematicPruningReport: makes this run the fast first pass.  Only
+   *    every 1/@c systematicPruningFraction-th entry (default 0.1) is
+   *    processed, and run() writes the report to this path using
+   *    @c systematicPruningNormThreshold / @c systematicPruningShapeThreshold
+   *    (default 0.001 each).
+   */
+  void configureSystematicPruning();
+
+  /// Write the pruning report of a first pass (no-op otherwise).
+  void writeSystematicPruningReport();
+
+  /**
+   * @brief Let systematic lookups define deferred variation columns.
+   *
+   * Active when DataManager defers variations (@c deferVariationColumns):
+   * SystematicManager::getVariationColumnName() then materializes the
+   * column it resolves, so every consumer pulls in what it reads.
+   */
+  void configureDeferredVariations();
+
+  /**
+   * @brief Materialize the deferred variations and folded constants written
+   *        by the skim.
+   * @return True when the dataframe node may have changed.
+   */
+  bool materializeSkimVariations();
+
+  /// Record and print the deferred variations left without a consumer.
+  void reportDeadVariationColumns();
+
+  /**
+   * @brief Disable the input branches nothing reads (``pruneInputBranches``).
+   *
+   * Call once every consumer has been booked.  With @p skimBooked the
+   * columns of the booked skim are kept; a skim of every column disables
+   * the pruning.
+   */
+  void pruneInputBranches(bool skimBooked);
+
+  /**
+   * @brief Hand the skim sink the producer of every column of @p df.
+   *
+   * Active with @c skimColumnManifest or @c incrementalSkimBase.  Columns
+   * declared by a plugin in getProducedColumns() (and their systematic
+   * variations) carry the plugin's config hash; other defined columns belong
+   * to ``analysis``.  Columns matching the @c incrementalSkimForce globs get
+   * a fresh hash so an incremental skim rewrites them.
+   *
+   * @throws std::runtime_error if the skim is not written as a ROOT TTree,
+   *         or @c incrementalSkimBase is set without index columns
+   */
+  void configureSkimColumnManifest(ROOT::RDF::RNode& df);
+
+  /**
+   * @brief Attribute the columns plugins declare in getProducedColumns()
+   * and write the node profile report (no-op without @c profileNodes).
+   */
+  void reportNodeProfile();
+
+  /// Variation columns never defined because nothing consumed them.
+  std::vector<std::string> deadVariationColumns_m;
+
+  /// Apply the @c logLevel and @c logRateLimit config entries to the
+  /// process logger (AsyncLogger::instance()).
+  void configureLogging();
+
+  /// Start recording the job timeline when @c traceFile is set (see
+  /// TraceService).
+  void configureTracing();
+
+  /// Read the @c pluginGates config entry.
+  void configurePluginGates();
+  /// Gate column of plugin @p role, or an empty string.
+  std::string pluginGate(const std::string& role) const;
+  /// Register the produced columns of a gated plugin with the DataManager.
+  void gatePluginColumns(const std::string& role);
+
+  /// Gate column per plugin role (see gatePlugin()).
+  std::map<std::string, std::string> pluginGates_m;
+
+  /// Write the filter profile (no-op without @c filterProfile).
+  void reportFilterProfile();
+
+  /// Filter on or prepare to record the selection cache of the block
+  /// being closed, before its filters are applied.
+  void useSelectionCache(const std::vector<std::string>& filters);
+
+  bool preselectionOpen_m = false;
+  /// Name of the open preselection block.
+  std::string preselectionName_m;
+  /// Version of the open preselection block's cuts.
+  std::string preselectionVersion_m;
+  /// Selection cache of a named block (see beginPreselection()).
+  struct SelectionCacheUse {
+    std::string name;
+    std::string key;
+    /// "applied", "recording" or "unused".
+    std::string status;
+  };
+  std::vector<SelectionCacheUse> selectionCaches_m;
+  /// Pass columns of the open preselection block, in declared order.
+  std::vector<std::string> preselection_m;
+  /// Applied filter order of each closed block, comma separated.
+  std::vector<std::string> preselectionOrders_m;
+  std::unique_ptr<FilterProfile> filterProfile_m;
+  std::string filterProfilePath_m;
+  /// Profile read at the first beginPreselection(), used for ordering.
+  std::map<std::string, FilterProfile::Stats> filterProfilePrevious_m;
+
+  std::string systematicPruningReport_m; ///< First-pass report path.
+  std::string systematicPruningInput_m;  ///< Report applied to this run.
+  double systematicPruningNormThreshold_m = 1e-3;
+  double systematicPruningShapeThreshold_m = 1e-3;
+  double systematicPruningFraction_m = 0.1;
 };
 
 #endif // ANALYZER_H_INCLUDED
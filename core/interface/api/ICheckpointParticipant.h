@@ -0,0 +1,27 @@
+#ifndef ICHECKPOINTPARTICIPANT_H_INCLUDED
+#define ICHECKPOINTPARTICIPANT_H_INCLUDED
+
+class CheckpointService;
+
+/**
+ * @brief Interface for plugins whose booked results can be checkpointed.
+ *
+ * When checkpointing is enabled, Analyzer::run() calls bookCheckpoint() on
+ * every participating plugin after the pre-execution hooks and before the
+ * event loop.  The plugin registers its lazy results with the service and
+ * merges the results restored from a resumed checkpoint into its own when
+ * they are read.
+ */
+class ICheckpointParticipant {
+public:
+  virtual ~ICheckpointParticipant() = default;
+
+  /**
+   * @brief Register the booked results with @p checkpoints.
+   * @throws std::runtime_error if a booked result cannot be checkpointed, or
+   *         the resumed checkpoint does not match the booked results.
+   */
+  virtual void bookCheckpoint(CheckpointService &checkpoints) = 0;
+};
+
+#endif // ICHECKPOINTPARTICIPANT_H_INCLUDED
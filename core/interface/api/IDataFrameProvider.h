@@ -3,11 +3,15 @@
 
 #include <ROOT/RDataFrame.hxx>
 #include <algorithm>
+#include <functional>
 #include <string>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 
 #include <api/ISystematicManager.h>
+#include <NodeProfiler.h>
 
 /**
  * @brief Interface for dataframe providers to enable dependency injection
@@ -30,11 +34,228 @@ public:
      * @param node The RNode to set
      */
     virtual void setDataFrame(const ROOT::RDF::RNode &node) = 0;
+
+    /**
+     * @brief Set the current node to @p node, derived from the current node
+     *        by defining (or redefining) @p addedColumns only.
+     *
+     * Lets providers that index their columns (see ColumnRegistry) update
+     * the index instead of rebuilding it.  Default implementation calls
+     * setDataFrame().
+     */
+    virtual void updateDataFrame(const ROOT::RDF::RNode &node,
+                                 const std::vector<std::string> & /*addedColumns*/) {
+        setDataFrame(node);
+    }
+
+    /**
+     * @brief Whether the current node has column @p name.
+     *
+     * Default implementation searches GetColumnNames(), which is linear in
+     * the number of columns; DataManager answers from a hash index.
+     */
+    virtual bool hasColumn(const std::string &name) {
+        const auto names = getDataFrame().GetColumnNames();
+        return std::find(names.begin(), names.end(), name) != names.end();
+    }
+
+    /**
+     * @brief Type name of column @p name of the current node.
+     */
+    virtual std::string columnType(const std::string &name) {
+        return getDataFrame().GetColumnType(name);
+    }
     
+    /**
+     * @brief Offer a systematic-variation column for deferred definition.
+     *
+     * Define() routes every Up/Down variant through this hook.  A provider
+     * that returns true keeps @p define and applies it to its dataframe,
+     * after materializing @p inputs, the first time materializeColumn() is
+     * called for @p name.  Variants nobody requests are never defined.
+     * Default implementation declines, so the column is defined at once.
+     *
+     * @param name   Column the deferred definition creates.
+     * @param inputs Input columns of the definition.
+     * @param define Applies the definition to a node and returns the result.
+     * @return True when the provider took over the definition.
+     */
+    virtual bool deferColumn(const std::string & /*name*/,
+                             const std::vector<std::string> & /*inputs*/,
+                             std::function<ROOT::RDF::RNode(ROOT::RDF::RNode)> /*define*/) {
+        return false;
+    }
+
+    /**
+     * @brief Define @p name now if its definition was deferred.
+     *
+     * No-op for columns that are already defined or unknown.
+     */
+    virtual void materializeColumn(const std::string & /*name*/) {}
+
+    /**
+     * @brief Record that a node of the graph reads @p columns.
+     *
+     * Define(), Redefine() and Filter() report their inputs here, so that a
+     * provider can tell which input branches the analysis reads (see
+     * DataManager::getReadInputBranches()).  Code that filters or books
+     * actions directly on the RNode reports the columns it reads itself;
+     * defines made directly on the RNode need not (DataManager reads their
+     * inputs from the dataframe).  Default implementation ignores them.
+     */
+    virtual void recordColumnsRead(const std::vector<std::string> & /*columns*/) {}
+
+    /**
+     * @brief Profiler of the Define/Filter callables, or nullptr.
+     *
+     * When non-null, Define(), Redefine() and Filter() register their
+     * callables with it and pass the timed wrappers to the dataframe.
+     * Default implementation returns nullptr (no instrumentation).
+     */
+    virtual NodeProfiler *nodeProfiler() { return nullptr; }
+
+    /**
+     * @brief Define @p name on @p df from the JIT string @p expression.
+     *
+     * Framework code defines string expressions through this hook, so that
+     * providers with a JIT cache (see JitCache) can reuse a precompiled
+     * definition.  Default implementation calls RDataFrame's string Define.
+     *
+     * @return @p df with the column defined; the provider's own dataframe is
+     *         not changed.
+     */
+    virtual ROOT::RDF::RNode defineExpression(ROOT::RDF::RNode df, const std::string &name,
+                                              const std::string &expression) {
+        return df.Define(name, expression);
+    }
+
+    /**
+     * @brief Compile the self-contained C++ @p source and return the address
+     *        of its ``extern "C"`` entry point named JitCache::kFunctionName.
+     *
+     * Providers with a JIT cache reuse a precompiled function.  Default
+     * implementation returns nullptr (no compiler available), and callers
+     * fall back to their interpreted path.
+     */
+    virtual void *compileFunction(const std::string & /*source*/) { return nullptr; }
+
+    /**
+     * @brief Boolean column gating the computation of column @p name, or an
+     *        empty string when it is always computed.
+     *
+     * Define() evaluates the callable of a gated column only for entries
+     * where the gate is true and returns a value-initialised result (0, an
+     * empty RVec) otherwise.  Default implementation gates nothing.
+     */
+    virtual std::string defineGate(const std::string & /*name*/) { return std::string(); }
+
+    /**
+     * @brief Restrict the event loop to entries in certified luminosity
+     *        sections before it starts (see DataManager::applyLumiSectionMask()).
+     *
+     * Callers keep their per-event filter; this only avoids reading the
+     * uncertified entries.  Default implementation applies nothing.
+     *
+     * @param isCertified Predicate returning true for certified (run, lumi) pairs.
+     * @param runBranch   Name of the run-number branch.
+     * @param lumiBranch  Name of the luminosity-section branch.
+     * @return Number of entries kept, or -1 if pre-skipping was not applied.
+     */
+    virtual Long64_t applyLumiSectionMask(
+        const std::function<bool(unsigned int, unsigned int)> & /*isCertified*/,
+        const std::string & /*runBranch*/ = "run",
+        const std::string & /*lumiBranch*/ = "luminosityBlock") {
+        return -1;
+    }
+
+    /**
+     * @brief Whether a column computed by @p F from @p nColumns inputs can
+     *        be gated: its result must be default-constructible and its
+     *        inputs given explicitly.
+     */
+    template <typename F> static bool canGate(std::size_t nColumns) {
+        using Ret = typename ROOT::TypeTraits::CallableTraits<F>::ret_type;
+        return std::is_default_constructible<Ret>::value && NodeProfiler::canWrap<F>(nColumns);
+    }
+
+    /**
+     * @brief Define @p name on @p node, timed by @p profiler when non-null
+     *        and computed only where the boolean column @p gate is true when
+     *        @p gate is not empty.
+     */
+    template <typename F>
+    static ROOT::RDF::RNode defineNode(ROOT::RDF::RNode node, const std::string &name, F f,
+                                       const std::vector<std::string> &columns,
+                                       NodeProfiler *profiler,
+                                       const std::string &gate = std::string()) {
+        if constexpr (std::is_default_constructible<
+                          typename ROOT::TypeTraits::CallableTraits<F>::ret_type>::value) {
+            if (!gate.empty() && canGate<F>(columns.size())) {
+                std::vector<std::string> gatedColumns{gate};
+                gatedColumns.insert(gatedColumns.end(), columns.begin(), columns.end());
+                return defineNode(node, name, gated(std::move(f)), gatedColumns, profiler);
+            }
+        }
+        if (profiler && NodeProfiler::canWrap<F>(columns.size())) {
+            return node.Define(name, profiler->wrap(name, "define", std::move(f)),
+                               NodeProfiler::slotColumns(columns));
+        }
+        return node.Define(name, std::move(f), columns);
+    }
+
+    /// @p f taking the gate as an extra first argument.
+    template <typename F> static auto gated(F f) {
+        using Traits = ROOT::TypeTraits::CallableTraits<F>;
+        return gatedImpl<typename Traits::ret_type>(std::move(f),
+                                                    typename Traits::arg_types_nodecay());
+    }
+
+    template <typename Ret, typename F, typename... Args>
+    static auto gatedImpl(F f, ROOT::TypeTraits::TypeList<Args...>) {
+        return [f = std::move(f)](bool pass, Args... args) mutable -> Ret {
+            if (!pass) {
+                return Ret{};
+            }
+            return f(std::forward<Args>(args)...);
+        };
+    }
+
+    /**
+     * @brief Define @p name on @p node from @p columns, without Up/Down
+     *        variants, reporting its reads, timing it and gating it like
+     *        Define() (see defineGate()).
+     *
+     * For code that builds its own variation columns on a node before
+     * passing it to setDataFrame() or updateDataFrame().
+     *
+     * @return @p node with the column defined; the provider's own dataframe
+     *         is not changed.
+     */
+    template <typename F>
+    ROOT::RDF::RNode defineColumn(ROOT::RDF::RNode node, const std::string &name, F f,
+                                  const std::vector<std::string> &columns) {
+        recordColumnsRead(columns);
+        std::string gate = defineGate(name);
+        if (!gate.empty() && canGate<F>(columns.size())) {
+            recordColumnsRead({gate});
+        } else {
+            gate.clear();
+        }
+        return defineNode(std::move(node), name, std::move(f), columns, nodeProfiler(), gate);
+    }
+
     // TODO: Why are these defined here? Shouldn't they be defined in the final classes?
 
     /**
      * @brief Define a new variable in the dataframe
+     *
+     * Up/Down variants are defined for every systematic affecting one of
+     * @p columns and are offered to deferColumn() first.  A variant whose
+     * inputs all resolve to the nominal columns (e.g. the Down side of a
+     * one-sided systematic) would only repeat the nominal computation: it
+     * is registered as a variation column resolving to @p name and defined
+     * as an alias of it instead.
+     *
      * @tparam F Callable type for the variable definition
      * @param name Name of the variable
      * @param f Callable to compute the variable
@@ -43,13 +264,27 @@ public:
      */
     template <typename F>
     void Define(std::string name, F f, const std::vector<std::string> &columns, ISystematicManager &systematicManager) {
-        auto df = getDataFrame();
-        const auto existingColumns = df.GetColumnNames();
-        if (std::find(existingColumns.begin(), existingColumns.end(), name) != existingColumns.end()) {
+        if (hasColumn(name)) {
             return;
         }
+        recordColumnsRead(columns);
+        auto df = getDataFrame();
+        std::vector<std::string> added;
 
+        NodeProfiler *profiler = nodeProfiler();
+        // Deferred variants are registered with the profiler when they are
+        // defined, under the owner of this call.
+        const std::string owner = profiler ? profiler->owner() : std::string();
+        // Variants share the gate of the nominal column.
+        std::string gate = defineGate(name);
+        if (!gate.empty() && hasColumn(gate) && canGate<F>(columns.size())) {
+            recordColumnsRead({gate});
+        } else {
+            gate.clear();
+        }
         std::vector<std::string> systList(systematicManager.getSystematics().begin(), systematicManager.getSystematics().end());
+        // Variants aliasing the nominal column, added once it is defined.
+        std::vector<std::string> nominalAliases;
         if (!systList.empty()) {
             for (const auto &syst : systList) {
                 int nAffected = 0;
@@ -57,9 +292,9 @@ public:
                 std::vector<std::string> newColumnsDown;
                 for (const auto &col : columns) {
                     const std::string upColumn =
-                        systematicManager.getVariationColumnName(col, syst + "Up");
+                        systematicManager.resolveVariationColumnName(col, syst + "Up");
                     const std::string downColumn =
-                        systematicManager.getVariationColumnName(col, syst + "Down");
+                        systematicManager.resolveVariationColumnName(col, syst + "Down");
                     if (upColumn != col || downColumn != col) {
                         newColumnsUp.push_back(upColumn);
                         newColumnsDown.push_back(downColumn);
@@ -70,21 +305,51 @@ public:
                     }
                 }
                 if (nAffected > 0) {
+                    recordColumnsRead(newColumnsUp);
+                    recordColumnsRead(newColumnsDown);
                     const auto upName = name + "_" + syst + "Up";
                     const auto downName = name + "_" + syst + "Down";
-                    if (std::find(existingColumns.begin(), existingColumns.end(), upName) == existingColumns.end()) {
-                        df = df.Define(upName, f, newColumnsUp);
+                    const bool upNominal = newColumnsUp == columns;
+                    const bool downNominal = newColumnsDown == columns;
+                    if (upNominal || downNominal) {
+                        systematicManager.registerVariationColumns(
+                            name, syst, upNominal ? name : upName, downNominal ? name : downName);
+                        if (!hasColumn(upNominal ? upName : downName)) {
+                            nominalAliases.push_back(upNominal ? upName : downName);
+                        }
                     }
-                    if (std::find(existingColumns.begin(), existingColumns.end(), downName) == existingColumns.end()) {
-                        df = df.Define(downName, f, newColumnsDown);
+                    if (!upNominal && !hasColumn(upName)) {
+                        auto defineUp = [upName, f, newColumnsUp, profiler, owner, gate](ROOT::RDF::RNode node) {
+                            NodeProfiler::OwnerScope scope(profiler, owner);
+                            return defineNode(node, upName, f, newColumnsUp, profiler, gate);
+                        };
+                        if (!deferColumn(upName, newColumnsUp, defineUp)) {
+                            df = defineUp(df);
+                            added.push_back(upName);
+                        }
+                    }
+                    if (!downNominal && !hasColumn(downName)) {
+                        auto defineDown = [downName, f, newColumnsDown, profiler, owner, gate](ROOT::RDF::RNode node) {
+                            NodeProfiler::OwnerScope scope(profiler, owner);
+                            return defineNode(node, downName, f, newColumnsDown, profiler, gate);
+                        };
+                        if (!deferColumn(downName, newColumnsDown, defineDown)) {
+                            df = defineDown(df);
+                            added.push_back(downName);
+                        }
                     }
                     systematicManager.registerSystematic(syst, {name});
                 }
             }
         }
 
-        df = df.Define(name, f, columns);
-        setDataFrame(df);
+        df = defineNode(df, name, f, columns, profiler, gate);
+        added.push_back(name);
+        for (const auto &alias : nominalAliases) {
+            df = df.Alias(alias, name);
+            added.push_back(alias);
+        }
+        updateDataFrame(df, added);
     }
     
     /**
@@ -98,7 +363,29 @@ public:
                              const std::vector<std::string> &columns,
                              std::string type,
                              ISystematicManager &systematicManager) = 0;
-    
+
+    /**
+     * @brief Define the Float_t model input @p name from the scalar
+     *        @p features, gathered from a feature block shared by the ML
+     *        managers.
+     *
+     * Models reading the same features share one packed block per event;
+     * each input is a slice (or gather) of it by feature offset.  Default
+     * implementation calls DefineVector().
+     */
+    virtual void DefineFeatureVector(std::string name,
+                                     const std::vector<std::string> &features,
+                                     ISystematicManager &systematicManager) {
+        DefineVector(std::move(name), features, "Float_t", systematicManager);
+    }
+
+    /**
+     * @brief Announce the features a model will read through
+     *        DefineFeatureVector(), so that the first block gathers the
+     *        features of every declared model.  Default: no-op.
+     */
+    virtual void declareFeatures(const std::vector<std::string> & /*features*/) {}
+
     /**
      * @brief Filter the dataframe
      * @param f Filter function
@@ -106,9 +393,20 @@ public:
      */
     template <typename F>
     void Filter(F f, const std::vector<std::string> &columns = {}) {
+        recordColumnsRead(columns);
         auto df = getDataFrame();
-        df = df.Filter(f, columns);
-        setDataFrame(df);
+        NodeProfiler *profiler = nodeProfiler();
+        if (profiler && NodeProfiler::canWrap<F>(columns.size())) {
+            std::string name = "filter(";
+            for (std::size_t i = 0; i < columns.size(); ++i) {
+                name += (i ? "," : "") + columns[i];
+            }
+            df = df.Filter(profiler->wrap(name + ")", "filter", f),
+                           NodeProfiler::slotColumns(columns));
+        } else {
+            df = df.Filter(f, columns);
+        }
+        updateDataFrame(df, {});
     }
     
     /**
@@ -118,13 +416,10 @@ public:
      */
     template <typename F> 
     void DefinePerSample(std::string name, F f) {
-        auto df = getDataFrame();
-        const auto existingColumns = df.GetColumnNames();
-        if (std::find(existingColumns.begin(), existingColumns.end(), name) != existingColumns.end()) {
+        if (hasColumn(name)) {
             return;
         }
-        df = df.DefinePerSample(name, f);
-        setDataFrame(df);
+        updateDataFrame(getDataFrame().DefinePerSample(name, f), {name});
     }
     
     /**
@@ -135,9 +430,16 @@ public:
      */
     template <typename F>
     void Redefine(std::string name, F f, const std::vector<std::string> &columns = {}) {
+        recordColumnsRead(columns);
         auto df = getDataFrame();
-        df = df.Redefine(name, f, columns);
-        setDataFrame(df);
+        NodeProfiler *profiler = nodeProfiler();
+        if (profiler && NodeProfiler::canWrap<F>(columns.size())) {
+            df = df.Redefine(name, profiler->wrap(name, "redefine", f),
+                             NodeProfiler::slotColumns(columns));
+        } else {
+            df = df.Redefine(name, f, columns);
+        }
+        updateDataFrame(df, {name});
     }
 };
 
@@ -41,6 +41,48 @@ public:
                               const ISystematicManager* systematicManager,
                               OutputChannel channel) = 0;
 
+  /**
+   * @brief Book a write that runs in the next event loop instead of now.
+   *
+   * Lets a skim share the event loop that fills histograms and counters.
+   * The default writes immediately; sinks that book lazily complete the
+   * write in flush().
+   */
+  virtual void bookDataFrame(ROOT::RDF::RNode& df,
+                             const IConfigurationProvider& configProvider,
+                             const IDataFrameProvider* dataFrameProvider,
+                             const ISystematicManager* systematicManager,
+                             OutputChannel channel) {
+    writeDataFrame(df, configProvider, dataFrameProvider, systematicManager, channel);
+  }
+
+  /**
+   * @brief Book a write of @p spec that runs in the next event loop.
+   *
+   * The default writes immediately.
+   */
+  virtual void bookDataFrame(ROOT::RDF::RNode& df, const OutputSpec& spec) {
+    writeDataFrame(df, spec);
+  }
+
+  /**
+   * @brief Complete every write booked with bookDataFrame(), running the
+   *        event loop only if it has not run yet.
+   */
+  virtual void flush() {}
+
+  /**
+   * @brief Append the columns read by the writes booked with
+   *        bookDataFrame() and not yet flushed to @p columns.
+   *
+   * Lets the input branches they read be kept when unread branches are
+   * pruned (see DataManager::pruneUnreadBranches()).
+   *
+   * @return False when the sink cannot tell, or a booked write reads every
+   *         column.  The default returns false.
+   */
+  virtual bool bookedColumns(std::vector<std::string>& /*columns*/) const { return false; }
+
   virtual std::string resolveOutputFile(const IConfigurationProvider& configProvider,
                                         OutputChannel channel) = 0;
 };
@@ -6,6 +6,8 @@
 #include <vector>
 #include <api/IContextAware.h>
 
+struct GraphCost;
+
 /**
  * @brief Abstract base class for all pluggable manager types.
  *
@@ -49,6 +51,18 @@ public:
      */
     virtual void setupFromConfigFile() = 0;
 
+    /**
+     * @brief Whether setupFromConfigFile() may run concurrently with the
+     *        setup of other plugins.
+     *
+     * Return true only when setupFromConfigFile() just reads files into the
+     * plugin's own state: it must not Define or Filter columns, touch the
+     * dataframe or use the ROOT interpreter.  The Analyzer then runs it on a
+     * worker thread once the plugins it depends on are set up, overlapping
+     * the loading of models, corrections and JSON files.
+     */
+    virtual bool concurrentSetup() const { return false; }
+
     // -----------------------------------------------------------------------
     // Dependency and resource advertisement (default: no dependencies/columns)
     // -----------------------------------------------------------------------
@@ -138,6 +152,14 @@ public:
      */
     virtual std::unordered_map<std::string, std::string>
     collectProvenanceEntries() const { return {}; }
+
+    /**
+     * @brief Add the resources this plugin books to @p cost (see
+     *        Analyzer::estimateCost()): histograms, ML models.
+     *
+     * Called on the booked graph, without running it.  Default: nothing.
+     */
+    virtual void estimateCost(GraphCost & /*cost*/) const {}
 };
 
 #endif // IPLUGGABLEMANAGER_H_INCLUDED 
\ No newline at end of file
@@ -29,6 +29,20 @@ struct SystematicValidationResult {
   std::vector<std::string> missingUp;
 };
 
+/**
+ * @brief A single column holding one variable under several variations.
+ *
+ * The column is an RVec in variation-major layout: for a per-object variable
+ * with n objects, entries [k * n : (k + 1) * n) hold the values under
+ * variationLabels[k].  Scalar variables have n = 1.
+ */
+struct SystematicVariationBundle {
+  /// Bundle column name.
+  std::string column;
+  /// Variation label of each block, e.g. {"Nominal", "jesUp", "jesDown"}.
+  std::vector<std::string> variationLabels;
+};
+
 /**
  * @brief Interface for systematic managers to enable dependency injection
  *
@@ -75,6 +89,48 @@ public:
                                           const std::string &upColumn,
                                           const std::string &downColumn) = 0;
 
+    /**
+     * @brief Register a variation-major bundle column for a variable.
+     *
+     * Consumers that evaluate all variations at once (histogram fills,
+     * bundled ONNX inputs) read the bundle instead of one column per
+     * variation.  Registering a bundle does not register the systematics
+     * themselves.  Default implementation ignores the bundle.
+     *
+     * @param variable        Nominal/base variable name.
+     * @param bundleColumn    Bundle column name.
+     * @param variationLabels Variation label of each block, in bundle order.
+     */
+    virtual void registerVariationBundle(const std::string & /*variable*/,
+                                         const std::string & /*bundleColumn*/,
+                                         const std::vector<std::string> & /*variationLabels*/) {}
+
+    /**
+     * @brief Get the bundle registered for @p variable, if any.
+     * @return Pointer to the bundle, or nullptr when none is registered
+     */
+    virtual const SystematicVariationBundle *
+    getVariationBundle(const std::string & /*variable*/) const {
+        return nullptr;
+    }
+
+    /**
+     * @brief Record the effect of a systematic on one booked histogram.
+     *
+     * Called by histogram writers with the bin contents of the nominal and
+     * varied histograms so that negligible systematics can be pruned before
+     * a full run.  Default implementation ignores the measurement.
+     *
+     * @param syst    Base systematic name without Up/Down.
+     * @param nominal Nominal bin contents.
+     * @param up      Up-variation bin contents (same binning).
+     * @param down    Down-variation bin contents (same binning).
+     */
+    virtual void recordSystematicImpact(const std::string & /*syst*/,
+                                        const std::vector<double> & /*nominal*/,
+                                        const std::vector<double> & /*up*/,
+                                        const std::vector<double> & /*down*/) {}
+
     /**
      * @brief Get the set of all registered systematics
      * @return Reference to the set of systematic names
@@ -189,6 +245,19 @@ public:
         }
         return variable;
     }
+
+    /**
+     * @brief Resolve a variation column name without requesting the column.
+     *
+     * Same lookup as getVariationColumnName(), but never materializes a
+     * deferred column.  Used while building the variation graph itself, so
+     * that declaring a dependent column does not mark its inputs as consumed.
+     * Default implementation delegates to getVariationColumnName().
+     */
+    virtual std::string resolveVariationColumnName(const std::string &variable,
+                                                   const std::string &syst) const {
+        return getVariationColumnName(variable, syst);
+    }
 };
 
 #endif // ISYSTEMATICMANAGER_H_INCLUDED 
\ No newline at end of file
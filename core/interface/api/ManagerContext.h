@@ -6,6 +6,7 @@ class IDataFrameProvider;
 class ISystematicManager;
 class ILogger;
 class IOutputSink;
+class ModelRegistry;
 
 /**
  * @brief Shared context injected into managers/services.
@@ -17,6 +18,8 @@ struct ManagerContext {
   ILogger& logger;
   IOutputSink& skimSink;
   IOutputSink& metaSink;
+  /// Shared correction/model registry; null means ModelRegistry::instance().
+  ModelRegistry* models = nullptr;
 };
 
 #endif // MANAGERCONTEXT_H_INCLUDED
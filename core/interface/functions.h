@@ -11,7 +11,12 @@
 #define FUNCTIONS_H_INCLUDED
 
 #include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
 #include <numeric>
+#include <stdexcept>
 
 #include <Math/Math.h>
 #include <Math/Vector4D.h>
@@ -119,6 +124,58 @@ ROOT::VecOps::RVec<S> castRVec(const ROOT::VecOps::RVec<T> &values) {
   return out;
 }
 
+/**
+ * @brief Rounds a float to @p bits mantissa bits (round to nearest).
+ *
+ * The dropped low mantissa bits are zero, which compresses well.  NaN and
+ * infinities are returned unchanged.
+ * @param value Value to round
+ * @param bits Mantissa bits kept (1-23)
+ * @return Rounded value
+ */
+inline Float_t truncateMantissa(Float_t value, int bits) {
+  std::uint32_t word;
+  std::memcpy(&word, &value, sizeof(word));
+  if ((word & 0x7f800000u) == 0x7f800000u || bits >= 23) {
+    return value;
+  }
+  const int dropped = 23 - bits;
+  word += 1u << (dropped - 1);
+  word &= ~((1u << dropped) - 1u);
+  std::memcpy(&value, &word, sizeof(word));
+  return value;
+}
+
+/**
+ * @brief Packs a bool vector into bytes, eight flags per byte, LSB first.
+ * @param flags Flags to pack
+ * @return ceil(size / 8) bytes
+ */
+inline ROOT::VecOps::RVec<UChar_t> packBits(const ROOT::VecOps::RVec<bool> &flags) {
+  ROOT::VecOps::RVec<UChar_t> packed((flags.size() + 7) / 8, 0);
+  for (std::size_t i = 0; i < flags.size(); ++i) {
+    if (flags[i]) {
+      packed[i / 8] |= static_cast<UChar_t>(1u << (i % 8));
+    }
+  }
+  return packed;
+}
+
+/**
+ * @brief Unpacks the first @p size flags of a vector written by packBits().
+ * @param packed Packed bytes
+ * @param size Number of flags (e.g. the collection's count column)
+ * @return Unpacked flags
+ */
+template <typename S>
+ROOT::VecOps::RVec<bool> unpackBits(const ROOT::VecOps::RVec<UChar_t> &packed, S size) {
+  ROOT::VecOps::RVec<bool> flags(static_cast<std::size_t>(size));
+  for (std::size_t i = 0; i < flags.size() && i / 8 < packed.size(); ++i) {
+    flags[i] = (packed[i / 8] >> (i % 8)) & 1u;
+  }
+  return flags;
+}
+
 /**
  * @brief Creates a vector with a single value.
  * @tparam T Type of the value
@@ -658,6 +715,298 @@ inline Float_t getPT(Float_t px, Float_t py) {
   return sqrt(px * px + py * py);
 }
 
+// =========================
+// Vectorized Kinematics
+// =========================
+//
+// Whole-RVec counterparts of the scalar helpers above.  The loops are written
+// branch-free over contiguous data so that the compiler vectorizes them; use
+// them in Define expressions instead of calling the scalar helpers per
+// element.
+
+/**
+ * @brief Element-wise EvalDeltaPhi() of two equally long vectors.
+ * @tparam T Numeric type
+ * @param phi0 First angles
+ * @param phi1 Second angles
+ * @return |Δφ| per element, wrapped to [0, pi]
+ * @throws std::runtime_error if the vectors differ in size
+ */
+template <typename T>
+ROOT::VecOps::RVec<T> EvalDeltaPhiVec(const ROOT::VecOps::RVec<T> &phi0,
+                                      const ROOT::VecOps::RVec<T> &phi1) {
+  if (phi0.size() != phi1.size()) {
+    throw std::runtime_error("EvalDeltaPhiVec: vector size mismatch");
+  }
+  const T pi = T(ROOT::Math::Pi());
+  const std::size_t n = phi0.size();
+  ROOT::VecOps::RVec<T> out(n);
+  const T *a = phi0.data();
+  const T *b = phi1.data();
+  T *o = out.data();
+  for (std::size_t i = 0; i < n; ++i) {
+    const T d = std::abs(a[i] - b[i]);
+    o[i] = d > pi ? T(2) * pi - d : d;
+  }
+  return out;
+}
+
+/**
+ * @brief Element-wise EvalDeltaR() of two equally long sets of objects.
+ * @tparam T Numeric type
+ * @return ΔR per element
+ * @throws std::runtime_error if the vectors differ in size
+ */
+template <typename T>
+ROOT::VecOps::RVec<T> EvalDeltaRVec(const ROOT::VecOps::RVec<T> &eta0,
+                                    const ROOT::VecOps::RVec<T> &phi0,
+                                    const ROOT::VecOps::RVec<T> &eta1,
+                                    const ROOT::VecOps::RVec<T> &phi1) {
+  const std::size_t n = eta0.size();
+  if (phi0.size() != n || eta1.size() != n || phi1.size() != n) {
+    throw std::runtime_error("EvalDeltaRVec: vector size mismatch");
+  }
+  const T pi = T(ROOT::Math::Pi());
+  ROOT::VecOps::RVec<T> out(n);
+  T *o = out.data();
+  for (std::size_t i = 0; i < n; ++i) {
+    const T dEta = eta0[i] - eta1[i];
+    const T d = std::abs(phi0[i] - phi1[i]);
+    const T dPhi = d > pi ? T(2) * pi - d : d;
+    o[i] = std::sqrt(dEta * dEta + dPhi * dPhi);
+  }
+  return out;
+}
+
+/**
+ * @brief All-pairs ΔR between two collections.
+ *
+ * Entry [i * n1 + j] is ΔR between object i of the first and object j of
+ * the second collection.  The inner loop runs over the second collection
+ * and vectorizes.
+ *
+ * @tparam T Numeric type
+ * @return Row-major n0 × n1 ΔR matrix
+ * @throws std::runtime_error if eta and phi of a collection differ in size
+ */
+template <typename T>
+ROOT::VecOps::RVec<T> EvalDeltaRMatrix(const ROOT::VecOps::RVec<T> &eta0,
+                                       const ROOT::VecOps::RVec<T> &phi0,
+                                       const ROOT::VecOps::RVec<T> &eta1,
+                                       const ROOT::VecOps::RVec<T> &phi1) {
+  if (eta0.size() != phi0.size() || eta1.size() != phi1.size()) {
+    throw std::runtime_error("EvalDeltaRMatrix: vector size mismatch");
+  }
+  const T pi = T(ROOT::Math::Pi());
+  const std::size_t n0 = eta0.size();
+  const std::size_t n1 = eta1.size();
+  ROOT::VecOps::RVec<T> out(n0 * n1);
+  const T *e1 = eta1.data();
+  const T *p1 = phi1.data();
+  for (std::size_t i = 0; i < n0; ++i) {
+    const T e0 = eta0[i];
+    const T p0 = phi0[i];
+    T *row = out.data() + i * n1;
+    for (std::size_t j = 0; j < n1; ++j) {
+      const T dEta = e0 - e1[j];
+      const T d = std::abs(p0 - p1[j]);
+      const T dPhi = d > pi ? T(2) * pi - d : d;
+      row[j] = std::sqrt(dEta * dEta + dPhi * dPhi);
+    }
+  }
+  return out;
+}
+
+/**
+ * @brief ΔR from each object of the first collection to the closest object
+ * of the second, for cleaning and matching.
+ *
+ * Objects are compared in ΔR² and only one square root is taken per object
+ * of the first collection.
+ *
+ * @tparam T Numeric type
+ * @return One entry per object of the first collection; -9999 when the
+ *   second collection is empty
+ * @throws std::runtime_error if eta and phi of a collection differ in size
+ */
+template <typename T>
+ROOT::VecOps::RVec<T> EvalMinDeltaR(const ROOT::VecOps::RVec<T> &eta0,
+                                    const ROOT::VecOps::RVec<T> &phi0,
+                                    const ROOT::VecOps::RVec<T> &eta1,
+                                    const ROOT::VecOps::RVec<T> &phi1) {
+  if (eta0.size() != phi0.size() || eta1.size() != phi1.size()) {
+    throw std::runtime_error("EvalMinDeltaR: vector size mismatch");
+  }
+  const std::size_t n0 = eta0.size();
+  const std::size_t n1 = eta1.size();
+  ROOT::VecOps::RVec<T> out(n0, T(-9999.0));
+  if (n1 == 0) {
+    return out;
+  }
+  const T pi = T(ROOT::Math::Pi());
+  const T *e1 = eta1.data();
+  const T *p1 = phi1.data();
+  for (std::size_t i = 0; i < n0; ++i) {
+    const T e0 = eta0[i];
+    const T p0 = phi0[i];
+    T best = std::numeric_limits<T>::max();
+    for (std::size_t j = 0; j < n1; ++j) {
+      const T dEta = e0 - e1[j];
+      const T d = std::abs(p0 - p1[j]);
+      const T dPhi = d > pi ? T(2) * pi - d : d;
+      best = std::min(best, dEta * dEta + dPhi * dPhi);
+    }
+    out[i] = std::sqrt(best);
+  }
+  return out;
+}
+
+/**
+ * @brief Bulk px = pt cos(phi).
+ * @throws std::runtime_error if the vectors differ in size
+ */
+template <typename T>
+ROOT::VecOps::RVec<T> EvalPx(const ROOT::VecOps::RVec<T> &pt,
+                             const ROOT::VecOps::RVec<T> &phi) {
+  if (pt.size() != phi.size()) {
+    throw std::runtime_error("EvalPx: vector size mismatch");
+  }
+  ROOT::VecOps::RVec<T> out(pt.size());
+  for (std::size_t i = 0; i < pt.size(); ++i) {
+    out[i] = pt[i] * std::cos(phi[i]);
+  }
+  return out;
+}
+
+/**
+ * @brief Bulk py = pt sin(phi).
+ * @throws std::runtime_error if the vectors differ in size
+ */
+template <typename T>
+ROOT::VecOps::RVec<T> EvalPy(const ROOT::VecOps::RVec<T> &pt,
+                             const ROOT::VecOps::RVec<T> &phi) {
+  if (pt.size() != phi.size()) {
+    throw std::runtime_error("EvalPy: vector size mismatch");
+  }
+  ROOT::VecOps::RVec<T> out(pt.size());
+  for (std::size_t i = 0; i < pt.size(); ++i) {
+    out[i] = pt[i] * std::sin(phi[i]);
+  }
+  return out;
+}
+
+/**
+ * @brief Bulk pz = pt sinh(eta).
+ * @throws std::runtime_error if the vectors differ in size
+ */
+template <typename T>
+ROOT::VecOps::RVec<T> EvalPz(const ROOT::VecOps::RVec<T> &pt,
+                             const ROOT::VecOps::RVec<T> &eta) {
+  if (pt.size() != eta.size()) {
+    throw std::runtime_error("EvalPz: vector size mismatch");
+  }
+  ROOT::VecOps::RVec<T> out(pt.size());
+  for (std::size_t i = 0; i < pt.size(); ++i) {
+    out[i] = pt[i] * std::sinh(eta[i]);
+  }
+  return out;
+}
+
+/**
+ * @brief Bulk energy sqrt((pt cosh(eta))^2 + mass^2).
+ * @throws std::runtime_error if the vectors differ in size
+ */
+template <typename T>
+ROOT::VecOps::RVec<T> EvalEnergy(const ROOT::VecOps::RVec<T> &pt,
+                                 const ROOT::VecOps::RVec<T> &eta,
+                                 const ROOT::VecOps::RVec<T> &mass) {
+  if (pt.size() != eta.size() || pt.size() != mass.size()) {
+    throw std::runtime_error("EvalEnergy: vector size mismatch");
+  }
+  ROOT::VecOps::RVec<T> out(pt.size());
+  for (std::size_t i = 0; i < pt.size(); ++i) {
+    const T p = pt[i] * std::cosh(eta[i]);
+    out[i] = std::sqrt(p * p + mass[i] * mass[i]);
+  }
+  return out;
+}
+
+/**
+ * @brief Invariant masses of index pairs of one collection.
+ *
+ * The Cartesian components of all objects are computed once in bulk, so each
+ * pair costs a gather and a handful of multiplications.  Pairs with an index
+ * outside the collection get -9999.
+ *
+ * @tparam T Numeric type
+ * @tparam S Index type
+ * @param idx0 First index of each pair
+ * @param idx1 Second index of each pair
+ * @return One invariant mass per pair
+ * @throws std::runtime_error if the kinematic or index vectors differ in size
+ */
+template <typename T, typename S>
+ROOT::VecOps::RVec<T> EvalPairMass(const ROOT::VecOps::RVec<T> &pt,
+                                   const ROOT::VecOps::RVec<T> &eta,
+                                   const ROOT::VecOps::RVec<T> &phi,
+                                   const ROOT::VecOps::RVec<T> &mass,
+                                   const ROOT::VecOps::RVec<S> &idx0,
+                                   const ROOT::VecOps::RVec<S> &idx1) {
+  if (idx0.size() != idx1.size()) {
+    throw std::runtime_error("EvalPairMass: index vector size mismatch");
+  }
+  const auto px = EvalPx(pt, phi);
+  const auto py = EvalPy(pt, phi);
+  const auto pz = EvalPz(pt, eta);
+  const auto e = EvalEnergy(pt, eta, mass);
+  const std::size_t n = pt.size();
+  ROOT::VecOps::RVec<T> out(idx0.size());
+  for (std::size_t k = 0; k < idx0.size(); ++k) {
+    const auto i = static_cast<long long>(idx0[k]);
+    const auto j = static_cast<long long>(idx1[k]);
+    if (i < 0 || j < 0 || static_cast<std::size_t>(i) >= n ||
+        static_cast<std::size_t>(j) >= n) {
+      out[k] = T(-9999.0);
+      continue;
+    }
+    const T sE = e[i] + e[j];
+    const T sX = px[i] + px[j];
+    const T sY = py[i] + py[j];
+    const T sZ = pz[i] + pz[j];
+    const T m2 = sE * sE - sX * sX - sY * sY - sZ * sZ;
+    out[k] = std::sqrt(std::max(m2, T(0)));
+  }
+  return out;
+}
+
+/**
+ * @brief Sum of all objects of a collection as one Lorentz vector, the
+ * whole-RVec counterpart of sumLorentzVec().
+ * @return ROOT::Math::LorentzVector<ROOT::Math::PxPyPzM4D<Float_t>>
+ * @throws std::runtime_error if the vectors differ in size
+ */
+inline ROOT::Math::LorentzVector<ROOT::Math::PxPyPzM4D<Float_t>>
+sumLorentzVecs(const ROOT::VecOps::RVec<Float_t> &pt,
+               const ROOT::VecOps::RVec<Float_t> &eta,
+               const ROOT::VecOps::RVec<Float_t> &phi,
+               const ROOT::VecOps::RVec<Float_t> &mass) {
+  const auto px = EvalPx(pt, phi);
+  const auto py = EvalPy(pt, phi);
+  const auto pz = EvalPz(pt, eta);
+  const auto e = EvalEnergy(pt, eta, mass);
+  Double_t sX = 0, sY = 0, sZ = 0, sE = 0;
+  for (std::size_t i = 0; i < pt.size(); ++i) {
+    sX += px[i];
+    sY += py[i];
+    sZ += pz[i];
+    sE += e[i];
+  }
+  const Double_t m2 = sE * sE - sX * sX - sY * sY - sZ * sZ;
+  return getPxPyPzMVector(static_cast<Float_t>(sX), static_cast<Float_t>(sY),
+                          static_cast<Float_t>(sZ),
+                          static_cast<Float_t>(std::sqrt(std::max(m2, 0.0))));
+}
+
 /**
  * @brief Saves a variable as a new column in a ROOT RDataFrame.
  * @tparam T Variable type
@@ -14,10 +14,12 @@
 #include <string>
 #include <vector>
 
+#include <AsyncLogger.h>
 #include <Math/MinimizerOptions.h>
 #include <cstdlib>
 #include <iostream>
 #include <ROOT/RDataFrame.hxx>
+#include <ROOT/TThreadExecutor.hxx>
 #include <TAxis.h>
 #include <TCanvas.h>
 #include <TF1.h>
@@ -44,10 +46,19 @@
 
 #include <boost/histogram.hpp>
 
+#include <HistDeviceSink.h>
+#include <HistSpill.h>
+#include <ThreadPinning.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
 #include <limits>
-#if BOOST_VERSION >= 107600
+#include <mutex>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
 #include <variant>
-#endif
 
 
 /// @brief Estimates the total memory in bytes required for dense per-thread histogram storage.
@@ -78,6 +89,426 @@ inline std::size_t estimateDenseMemoryBytes(const std::vector<Int_t>& nbins,
 /// Maximum total bytes for dense per-thread storage before falling back to sparse storage.
 static constexpr std::size_t kDenseMemoryThresholdBytes = 64ULL * 1024 * 1024; // 64 MiB
 
+/// @brief Estimates the bytes held per filled bin of a THnSparseF with Sumw2.
+///
+/// Counts the compact bin coordinate (the bits of every axis, over/underflow
+/// included), the Float_t content, the Double_t sum of squared weights and
+/// the bin's entry in the coordinate hash table.
+///
+/// @param nbins Number of bins along each axis (overflow excluded).
+inline std::size_t estimateSparseBytesPerBin(const std::vector<Int_t>& nbins) {
+    // TExMap keeps three 8-byte words per slot and is at most half full.
+    constexpr std::size_t kHashBytesPerBin = 48;
+    std::size_t bits = 0;
+    for (int n : nbins) {
+        for (std::size_t v = static_cast<std::size_t>(n) + 2; v != 0; v >>= 1) {
+            ++bits;
+        }
+    }
+    return (bits + 7) / 8 + sizeof(Float_t) + sizeof(Double_t) + kHashBytesPerBin;
+}
+
+/// @brief Filled bins at which a sparse slot accumulator of THnMulti is
+///        promoted to a flat array (histFillInfo::densePromotionFraction).
+///
+/// A negative @p fraction promotes where the sparse bins take as much
+/// memory as the flat array (16 / estimateSparseBytesPerBin() of the
+/// cells).  A slot whose flat array would exceed its share of
+/// @p memoryCeilingBytes is never promoted.
+///
+/// @return 0 when slots are never promoted.
+inline Long64_t densePromotionBins(const std::vector<Int_t>& nbins,
+                                   unsigned int nSlots,
+                                   Double_t fraction,
+                                   std::size_t memoryCeilingBytes) {
+    const std::size_t denseBytes = estimateDenseMemoryBytes(nbins, 1, 16);
+    if (fraction == 0.0 || denseBytes == std::numeric_limits<std::size_t>::max()) {
+        return 0;
+    }
+    if (memoryCeilingBytes != 0 && denseBytes > memoryCeilingBytes / std::max(nSlots, 1u)) {
+        return 0;
+    }
+    if (fraction < 0.0) {
+        fraction = 16.0 / static_cast<Double_t>(estimateSparseBytesPerBin(nbins));
+    }
+    const Double_t bins = std::ceil(fraction * static_cast<Double_t>(denseBytes / 16));
+    return std::max<Long64_t>(static_cast<Long64_t>(bins), 1);
+}
+
+/**
+ * @brief Bin of @p x on a uniform axis, with the TAxis::FindBin conventions.
+ *
+ * Bin 0 is the underflow and @p nbins + 1 the overflow (also for NaN).
+ * @p width is xmax - xmin, passed in so that callers can precompute it.
+ */
+inline Int_t uniformAxisBin(Double_t x, Int_t nbins, Double_t xmin, Double_t xmax,
+                            Double_t width) {
+  if (x < xmin) {
+    return 0;
+  }
+  if (!(x < xmax)) {
+    return nbins + 1;
+  }
+  const Int_t bin = 1 + static_cast<Int_t>(nbins * (x - xmin) / width);
+  return bin > nbins ? nbins : bin;
+}
+
+/**
+ * @class VariableAxisLookup
+ * @brief Constant-time bin lookup on a variable-width axis.
+ *
+ * TAxis::FindBin binary-searches the edges of a variable-width axis on
+ * every call.  This lookup instead covers [edges.front(), edges.back()) with
+ * a uniform grid whose cells are no wider than the narrowest bin, and stores
+ * the bin at the lower end of each cell.  A cell then overlaps at most two
+ * bins, so a lookup is one grid index and one refine step.  Grids that would
+ * exceed kMaxCells cells are capped; the refine then walks further on the
+ * narrow bins.
+ *
+ * Bin numbering follows uniformAxisBin(): 0 is the underflow and nbins + 1
+ * the overflow (also for NaN).
+ */
+class VariableAxisLookup {
+public:
+  /// Largest number of grid cells.
+  static constexpr std::size_t kMaxCells = 1u << 16;
+
+  /// Empty lookup (no variable-width axis).
+  VariableAxisLookup() = default;
+
+  /**
+   * @brief Build the lookup for the bin @p edges.
+   * @throws std::runtime_error unless there are at least two strictly
+   *         increasing, finite edges.
+   */
+  explicit VariableAxisLookup(const std::vector<Double_t>& edges) : edges_m(edges) {
+    if (edges_m.size() < 2 || !std::isfinite(edges_m.front()) ||
+        !std::isfinite(edges_m.back())) {
+      throw std::runtime_error("VariableAxisLookup: needs at least two finite bin edges.");
+    }
+    Double_t minWidth = std::numeric_limits<Double_t>::max();
+    for (std::size_t i = 1; i < edges_m.size(); ++i) {
+      if (!(edges_m[i] > edges_m[i - 1])) {
+        throw std::runtime_error("VariableAxisLookup: bin edges must be strictly increasing.");
+      }
+      minWidth = std::min(minWidth, edges_m[i] - edges_m[i - 1]);
+    }
+    const Double_t range = edges_m.back() - edges_m.front();
+    const Double_t wanted = std::ceil(range / minWidth);
+    const std::size_t nCells =
+        wanted < static_cast<Double_t>(kMaxCells)
+            ? std::max<std::size_t>(static_cast<std::size_t>(wanted), edges_m.size() - 1)
+            : kMaxCells;
+    cellScale_m = nCells / range;
+    cells_m.resize(nCells);
+    for (std::size_t c = 0; c < nCells; ++c) {
+      const Double_t lower = edges_m.front() + c / cellScale_m;
+      cells_m[c] = static_cast<Int_t>(
+          std::upper_bound(edges_m.begin(), edges_m.end(), lower) - edges_m.begin());
+    }
+  }
+
+  /// True when no edges were given.
+  bool empty() const { return edges_m.empty(); }
+
+  /// Number of bins (edges - 1).
+  Int_t nbins() const { return static_cast<Int_t>(edges_m.size()) - 1; }
+
+  /// Bin edges, as given.
+  const std::vector<Double_t>& edges() const { return edges_m; }
+
+  /// Bin of @p x; bin b spans [edges[b - 1], edges[b]).
+  Int_t findBin(Double_t x) const {
+    if (x < edges_m.front()) {
+      return 0;
+    }
+    if (!(x < edges_m.back())) {
+      return nbins() + 1;
+    }
+    std::size_t cell = static_cast<std::size_t>((x - edges_m.front()) * cellScale_m);
+    if (cell >= cells_m.size()) {
+      cell = cells_m.size() - 1;
+    }
+    Int_t bin = cells_m[cell];
+    while (x >= edges_m[bin]) {
+      ++bin;
+    }
+    // Rounding of the cell index can land one cell too high.
+    while (x < edges_m[bin - 1]) {
+      --bin;
+    }
+    return bin;
+  }
+
+private:
+  std::vector<Double_t> edges_m;
+  /// Bin containing the lower end of each grid cell.
+  std::vector<Int_t> cells_m;
+  Double_t cellScale_m = 0.0;
+};
+
+/**
+ * @class FlatHistAccumulator
+ * @brief Flat-array N-dimensional accumulator for uniformly binned axes.
+ *
+ * Bin contents are stored as interleaved (sum of weights, sum of squared
+ * weights) pairs in one contiguous array laid out in THn's linearized order
+ * (under/overflow included, first axis fastest).  Bin lookup uses precomputed
+ * strides and the same uniform-bin arithmetic as TAxis::FindBin, without any
+ * virtual dispatch.  Instances are cache-line aligned so the per-slot headers
+ * touched in the fill loop never share a line.
+ *
+ * One axis can be made the fastest instead, so that the bins along it are
+ * adjacent in memory and fillAxisRun() adds a whole vector of weights in one
+ * contiguous pass.
+ */
+class alignas(64) FlatHistAccumulator {
+public:
+  /// No innermost axis: THn's linearized order.
+  static constexpr std::size_t kNoAxis = static_cast<std::size_t>(-1);
+
+  FlatHistAccumulator(const std::vector<Int_t>& nbins,
+                      const std::vector<Double_t>& xmin,
+                      const std::vector<Double_t>& xmax,
+                      std::size_t innermostAxis = kNoAxis)
+      : nbins_m(nbins), xmin_m(xmin), xmax_m(xmax),
+        width_m(nbins.size()), strides_m(nbins.size()) {
+    if (innermostAxis != kNoAxis) {
+      order_m.push_back(innermostAxis);
+    }
+    for (std::size_t d = 0; d < nbins_m.size(); ++d) {
+      width_m[d] = xmax_m[d] - xmin_m[d];
+      if (d != innermostAxis) {
+        order_m.push_back(d);
+      }
+    }
+    std::size_t stride = 1;
+    for (const std::size_t d : order_m) {
+      strides_m[d] = stride;
+      stride *= static_cast<std::size_t>(nbins_m[d]) + 2;
+    }
+    storageSize_m = 2 * stride;
+  }
+
+  /**
+   * @brief Allocate the zeroed bin storage, unless done already.
+   *
+   * Called by the thread that fills the accumulator before its first fill,
+   * so that the pages are first touched, and placed, on that thread's NUMA
+   * node.  An accumulator that was never placed holds no bins.
+   */
+  void place() {
+    if (storage_m.empty()) {
+      storage_m.assign(storageSize_m, 0.0);
+    }
+  }
+
+  /// Linear bin index of @p x (one coordinate per axis).
+  std::size_t findBin(const Double_t* x) const {
+    return findBin(x, nbins_m.size());
+  }
+
+  void fill(const Double_t* x, Double_t w) {
+    addToCell(findBin(x), w);
+  }
+
+  /**
+   * @brief Fill with a precomputed bin index on the last axis.
+   *
+   * @p x holds the coordinates of all other axes; @p lastAxisBin is the
+   * uniformAxisBin() of the last axis (0 = underflow, nbins + 1 = overflow).
+   */
+  void fillLastAxisBin(const Double_t* x, Int_t lastAxisBin, Double_t w) {
+    addToCell(findBinLastAxis(x, lastAxisBin), w);
+  }
+
+  /// Linear bin index of @p x with a precomputed last-axis bin, as in
+  /// fillLastAxisBin().
+  std::size_t findBinLastAxis(const Double_t* x, Int_t lastAxisBin) const {
+    const std::size_t last = nbins_m.size() - 1;
+    return findBin(x, last) + static_cast<std::size_t>(lastAxisBin) * strides_m[last];
+  }
+
+  /**
+   * @brief Add @p n weights to consecutive in-range bins of @p axis.
+   *
+   * Weight i goes to bin i + 1 of @p axis (weights beyond its last bin are
+   * dropped); the other axes are looked up from @p x, whose entry for
+   * @p axis is ignored.  A non-negative @p lastAxisBin is the precomputed
+   * bin of the last axis, as in fillLastAxisBin().  One bin lookup serves
+   * all weights, and when @p axis is the innermost axis the add loop runs
+   * over adjacent cells.
+   */
+  void fillAxisRun(const Double_t* x, std::size_t axis, Int_t lastAxisBin,
+                   const Float_t* __restrict__ w, std::size_t n) {
+    n = std::min(n, static_cast<std::size_t>(nbins_m[axis]));
+    const std::size_t step = 2 * strides_m[axis];
+    Double_t* __restrict__ cell = storage_m.data() + 2 * findAxisRunBin(x, axis, lastAxisBin);
+    for (std::size_t i = 0; i < n; ++i) {
+      const Double_t wi = w[i];
+      cell[i * step] += wi;
+      cell[i * step + 1] += wi * wi;
+    }
+  }
+
+  /// Linear bin index of bin 1 of @p axis, the other axes given as in
+  /// fillAxisRun().  Bin i + 1 of @p axis is i * stride(axis) further.
+  std::size_t findAxisRunBin(const Double_t* x, std::size_t axis, Int_t lastAxisBin) const {
+    const std::size_t last = nbins_m.size() - 1;
+    std::size_t bin = strides_m[axis];
+    for (std::size_t d = 0; d < nbins_m.size(); ++d) {
+      if (d == axis) continue;
+      const Int_t b = (d == last && lastAxisBin >= 0)
+                          ? lastAxisBin
+                          : uniformAxisBin(x[d], nbins_m[d], xmin_m[d], xmax_m[d], width_m[d]);
+      bin += static_cast<std::size_t>(b) * strides_m[d];
+    }
+    return bin;
+  }
+
+  /// Distance in linear bin index between adjacent bins of @p axis.
+  std::size_t stride(std::size_t axis) const { return strides_m[axis]; }
+
+  /// Number of bins, under/overflow included.
+  std::size_t cells() const { return storageSize_m / 2; }
+
+  /// Interleaved (sumw, sumw2) bin storage, placed first if needed.
+  Double_t* data() {
+    place();
+    return storage_m.data();
+  }
+
+  /// Number of bins (under/overflow included) with a non-zero content.
+  Long64_t filledBins() const {
+    Long64_t filled = 0;
+    for (std::size_t i = 0; i < storage_m.size(); i += 2) {
+      filled += storage_m[i] != 0.0;
+    }
+    return filled;
+  }
+
+  /// Bytes held by the bin storage.
+  std::size_t bytes() const { return storage_m.size() * sizeof(Double_t); }
+
+  /// Add @p sumw and @p sumw2 to the bin with per-axis indices @p idx
+  /// (0 = underflow, nbins + 1 = overflow), placing the storage if needed.
+  void addBin(const Int_t* idx, Double_t sumw, Double_t sumw2) {
+    place();
+    std::size_t bin = 0;
+    for (std::size_t d = 0; d < nbins_m.size(); ++d) {
+      bin += static_cast<std::size_t>(idx[d]) * strides_m[d];
+    }
+    storage_m[2 * bin] += sumw;
+    storage_m[2 * bin + 1] += sumw2;
+  }
+
+  /// Add the contents of an accumulator with identical binning.
+  void add(const FlatHistAccumulator& other) {
+    if (other.storage_m.empty()) return;
+    place();
+    const Double_t* __restrict__ src = other.storage_m.data();
+    Double_t* __restrict__ dst = storage_m.data();
+    const std::size_t n = storage_m.size();
+    for (std::size_t i = 0; i < n; ++i) {
+      dst[i] += src[i];
+    }
+  }
+
+  /**
+   * @brief Copy every non-empty in-range bin into @p target.
+   *
+   * @p target must have the same axes.  Under/overflow bins are skipped, as
+   * only in-range bins are persisted.  With @p add the bins are added to
+   * the contents of @p target instead of replacing them.
+   */
+  void writeTo(THnSparseF& target, bool add = false) const {
+    const std::size_t dim = nbins_m.size();
+    const std::size_t nCells = storage_m.size() / 2;
+    std::vector<Int_t> idx(dim);
+    for (std::size_t bin = 0; bin < nCells; ++bin) {
+      const Double_t content = storage_m[2 * bin];
+      if (content == 0.0) continue;
+      bool inRange = true;
+      std::size_t rest = bin;
+      for (const std::size_t d : order_m) {
+        const std::size_t axisBins = static_cast<std::size_t>(nbins_m[d]) + 2;
+        idx[d] = static_cast<Int_t>(rest % axisBins);
+        rest /= axisBins;
+        if (idx[d] == 0 || idx[d] > nbins_m[d]) {
+          inRange = false;
+          break;
+        }
+      }
+      if (!inRange) continue;
+      const Long64_t sparseBin = target.GetBin(idx.data(), true);
+      if (add) {
+        target.AddBinContent(sparseBin, content);
+        target.AddBinError2(sparseBin, storage_m[2 * bin + 1]);
+      } else {
+        target.SetBinContent(sparseBin, content);
+        target.SetBinError2(sparseBin, storage_m[2 * bin + 1]);
+      }
+    }
+  }
+
+private:
+  std::size_t findBin(const Double_t* x, std::size_t nAxes) const {
+    std::size_t bin = 0;
+    for (std::size_t d = 0; d < nAxes; ++d) {
+      bin += static_cast<std::size_t>(uniformAxisBin(x[d], nbins_m[d], xmin_m[d], xmax_m[d], width_m[d])) *
+             strides_m[d];
+    }
+    return bin;
+  }
+
+  void addToCell(std::size_t bin, Double_t w) {
+    Double_t* cell = storage_m.data() + 2 * bin;
+    cell[0] += w;
+    cell[1] += w * w;
+  }
+
+  std::vector<Int_t> nbins_m;
+  std::vector<Double_t> xmin_m;
+  std::vector<Double_t> xmax_m;
+  std::vector<Double_t> width_m;
+  std::vector<std::size_t> strides_m;
+  /// Axes from the fastest to the slowest varying.
+  std::vector<std::size_t> order_m;
+  std::size_t storageSize_m = 0;
+  /// Interleaved (sumw, sumw2) per linearized bin; empty until place().
+  std::vector<Double_t> storage_m;
+};
+
+
+/**
+ * @brief Memory of the per-slot accumulators of one THnMulti.
+ *
+ * Written by THnMulti::Finalize() before the slots are merged.  Each slot
+ * reports the most bins it held at once during the loop; sparse byte counts
+ * are estimateSparseBytesPerBin() estimates.
+ */
+struct HistMemoryReport {
+  std::string name;
+  /// Flat-array accumulators (FlatHistAccumulator) rather than THnSparseF.
+  bool dense = false;
+  std::vector<Long64_t> slotFilledBins;
+  std::vector<std::size_t> slotBytes;
+  /// Mid-loop merges forced by histFillInfo::memoryCeilingBytes.
+  std::size_t flushes = 0;
+  /// Sparse slots promoted to flat arrays during the loop
+  /// (histFillInfo::densePromotionFraction).
+  std::size_t promotions = 0;
+  /// Slot accumulators spilled to disk runs instead of flushed
+  /// (histFillInfo::spillDirectory), and the bytes written.
+  std::size_t spills = 0;
+  std::uint64_t spilledBytes = 0;
+
+  std::size_t totalBytes() const {
+    std::size_t total = 0;
+    for (std::size_t bytes : slotBytes) total += bytes;
+    return total;
+  }
+};
 
 struct histFillInfo {
   std::string name = "";
@@ -98,8 +529,159 @@ struct histFillInfo {
   Bool_t systematic_hasMultiFill = false;
   Bool_t weight_hasMultiFill = false;
   Bool_t hasMultiFill = false;
+  /// Base values are uniformAxisBin() indices of the value axis, not values.
+  Bool_t value_isBinIndex = false;
+  /// Edges of a variable-width value axis; empty for uniform bins.  The
+  /// value axis entries of nbins, xmin and xmax must still describe it
+  /// (number of bins, first and last edge).
+  std::vector<Double_t> valueEdges;
+  /// Ceiling in bytes on the sparse slot accumulators together; a slot
+  /// holding more than its share is merged into the result and emptied
+  /// during the loop.  0 disables the ceiling.
+  std::size_t memoryCeilingBytes = 0;
+  /// Fill fraction (filled bins over all bins, under- and overflow
+  /// included) at which a sparse slot accumulator is promoted to a flat
+  /// array for the rest of the loop; negative: where both take the same
+  /// memory (see densePromotionBins()), 0: never.
+  Double_t densePromotionFraction = -1.0;
+  /// Directory of the on-disk runs a sparse slot over its share of
+  /// memoryCeilingBytes is spilled to (see HistSpillRuns), instead of being
+  /// merged into the in-memory result.  Empty: no spilling.  The runs are
+  /// merged into the in-memory result at Finalize(), so the peak memory
+  /// there is still that of the whole histogram.
+  std::string spillDirectory;
+  /// Filled at Finalize() with the accumulator memory when set.
+  std::shared_ptr<HistMemoryReport> memoryReport;
+  /// Cells of the channel and systematic axes that are filled, indexed by
+  /// (systematic bin - 1) * nbins[0] + channel bin - 1; fills of the other
+  /// in-range cells are skipped.  Empty fills every cell.  Not supported
+  /// with weightVector.
+  std::vector<std::uint8_t> cellMask;
+  /// The systematic axis holds the entries of a weight vector, filled by
+  /// THnMulti's weight-vector Exec() (one bin lookup for all entries).
+  Bool_t weightVector = false;
+  /// Storage the fills are streamed to instead of per-slot accumulators,
+  /// e.g. a GPU buffer; it must hold as many bins as a FlatHistAccumulator
+  /// of the same axes.  nullptr fills on the host.
+  std::shared_ptr<HistDeviceSink> deviceSink;
+};
+
+/**
+ * @brief Pairwise (tree) reduction of per-slot accumulators into slots[0].
+ *
+ * At each level, slot i absorbs slot i + stride for every i that is a
+ * multiple of 2 * stride, so N slots are merged in ceil(log2 N) levels.
+ * The pairs of one level touch disjoint accumulators and are merged
+ * concurrently on ROOT's thread pool when implicit multi-threading is
+ * enabled; otherwise the same reduction runs sequentially.
+ *
+ * @param slots Per-slot accumulators; on return slots[0] holds the total.
+ * @param merge Callable merge(T& into, T& from).
+ */
+template <typename T, typename MergeFn>
+void treeReduceSlots(std::vector<T>& slots, MergeFn merge) {
+  const std::size_t n = slots.size();
+  std::unique_ptr<ROOT::TThreadExecutor> pool;
+  if (n > 2 && ROOT::IsImplicitMTEnabled()) {
+    pool = std::make_unique<ROOT::TThreadExecutor>();
+  }
+  for (std::size_t stride = 1; stride < n; stride *= 2) {
+    std::vector<std::size_t> targets;
+    for (std::size_t i = 0; i + stride < n; i += 2 * stride) {
+      targets.push_back(i);
+    }
+    const auto mergePair = [&](std::size_t i) { merge(slots[i], slots[i + stride]); };
+    if (pool && targets.size() > 1) {
+      pool->Foreach(mergePair, targets);
+    } else {
+      for (const std::size_t i : targets) {
+        mergePair(i);
+      }
+    }
+  }
+}
+
+/**
+ * @brief Fill layout of a THnMulti action, as compile-time flags.
+ *
+ * Each bit records whether one input vector advances per systematic
+ * variation (`*Syst`) or per fill (`*Multi`).  THnMulti instantiates one
+ * fill kernel per canonical layout, so the per-entry loop has no indirect
+ * call and no flag check.
+ */
+namespace THnFill {
+
+enum : unsigned {
+  kChannelSyst = 1u << 0,
+  kControlRegionSyst = 1u << 1,
+  kSampleCategorySyst = 1u << 2,
+  kWeightSyst = 1u << 3,
+  kChannelMulti = 1u << 4,
+  kControlRegionMulti = 1u << 5,
+  kSampleCategoryMulti = 1u << 6,
+  kWeightMulti = 1u << 7,
+  kSystematicMulti = 1u << 8,
 };
 
+constexpr unsigned kSystFlags = kChannelSyst | kControlRegionSyst | kSampleCategorySyst | kWeightSyst;
+constexpr unsigned kMultiFlags = kChannelMulti | kControlRegionMulti | kSampleCategoryMulti | kWeightMulti;
+/// Number of distinct flag words.
+constexpr unsigned kLayouts = 1u << 9;
+
+enum class Path { Single, SingleSystematic, MultiNoSystematic, General };
+
+/// Fill loop used for a layout.
+constexpr Path path(unsigned flags) {
+  const bool systMulti = (flags & kSystematicMulti) != 0;
+  const bool multi = (flags & kMultiFlags) != 0;
+  if (flags == 0) return Path::Single;
+  if (systMulti && !multi) return Path::SingleSystematic;
+  if (!systMulti && multi) return Path::MultiNoSystematic;
+  return Path::General;
+}
+
+/// Clear the flags the fill loop of a layout ignores, so equivalent layouts
+/// share one kernel.
+constexpr unsigned canonical(unsigned flags) {
+  switch (path(flags)) {
+  case Path::SingleSystematic:
+    return flags & (kSystFlags | kSystematicMulti);
+  case Path::MultiNoSystematic:
+    return flags & kMultiFlags;
+  default:
+    return flags;
+  }
+}
+
+/// Kernel id of the General layouts that also multi-fill the systematic axis;
+/// NDHistogramManager never books them, so they share one kernel that reads
+/// the layout at run time instead of 240 specializations.
+constexpr unsigned kRuntimeLayout = kLayouts;
+
+/// Layout a kernel is instantiated for: the canonical flags, or
+/// kRuntimeLayout.
+constexpr unsigned kernelLayout(unsigned flags) {
+  const unsigned layout = canonical(flags);
+  return (path(layout) == Path::General && (layout & kSystematicMulti) != 0) ? kRuntimeLayout
+                                                                          : layout;
+}
+
+/// Canonical flag word of @p info.
+inline unsigned flagsOf(const histFillInfo &info) {
+  const unsigned flags = (info.channel_hasSystematic ? kChannelSyst : 0u) |
+                         (info.controlRegion_hasSystematic ? kControlRegionSyst : 0u) |
+                         (info.sampleCategory_hasSystematic ? kSampleCategorySyst : 0u) |
+                         (info.weight_hasSystematic ? kWeightSyst : 0u) |
+                         (info.channel_hasMultiFill ? kChannelMulti : 0u) |
+                         (info.controlRegion_hasMultiFill ? kControlRegionMulti : 0u) |
+                         (info.sampleCategory_hasMultiFill ? kSampleCategoryMulti : 0u) |
+                         (info.weight_hasMultiFill ? kWeightMulti : 0u) |
+                         (info.systematic_hasMultiFill ? kSystematicMulti : 0u);
+  return canonical(flags);
+}
+
+} // namespace THnFill
+
 /**
  * @class THnMulti
  * @brief Multi-threaded N-dimensional histogram action for ROOT RDataFrame.
@@ -107,6 +689,30 @@ struct histFillInfo {
  * This class manages a set of THnSparseF histograms, one per thread, and merges
  * them at the end of processing. It is used as a custom action in ROOT's
  * RDataFrame for efficient multi-threaded histogramming.
+ *
+ * The fill loop is a kernel specialized at compile time on the fill layout
+ * (THnFill flags) and on the accumulator storage; the constructor selects
+ * the instantiation from a table indexed by the runtime layout.  Only the
+ * General layouts with a multi-filled systematic axis, which
+ * NDHistogramManager does not book, share a kernel that reads the layout at
+ * run time (THnFill::kRuntimeLayout).
+ *
+ * With a histFillInfo::deviceSink the slots keep no accumulator: each fill
+ * is reduced to its linear bin index on the host, staged per slot, and
+ * streamed to the sink in batches of kDeviceBatchFills.
+ *
+ * Sparse slots are promoted one by one: a slot whose THnSparseF holds
+ * densePromotionBins() filled bins moves them into a FlatHistAccumulator
+ * and fills that for the rest of the loop, so a histogram that is sparse
+ * overall uses flat arrays in the slots that do fill it densely.
+ *
+ * With a histFillInfo::spillDirectory, a sparse slot over its share of the
+ * memory ceiling is written to a slot-local sorted run on disk rather than
+ * merged into the result, so the result is only built at Finalize(), by a
+ * k-way merge of the runs.  That result is still an in-memory THnSparseF
+ * holding every filled bin: spilling bounds the memory of the event loop,
+ * not the peak at Finalize(), which is that of the merged histogram, as
+ * without spilling.
  */
 class THnMulti : public ROOT::Detail::RDF::RActionImpl<THnMulti> {
 
@@ -116,35 +722,58 @@ public:
    */
   using Result_t = THnSparseF;
 
-  // Define a function pointer type for fill functions
-  using FillFuncType = void (THnMulti::*)(unsigned int,
-    const ROOT::VecOps::RVec<Float_t>&, const ROOT::VecOps::RVec<Float_t>&,
-    const ROOT::VecOps::RVec<Float_t>&, const ROOT::VecOps::RVec<Float_t>&,
-    const ROOT::VecOps::RVec<Float_t>&, const ROOT::VecOps::RVec<Float_t>&,
-    const ROOT::VecOps::RVec<Int_t>&);
-
   /**
    * @brief Construct a new THnMulti object
    * @param fillInfo Histogram fill information
    */
   THnMulti(histFillInfo &fillInfo)
-    : nSlots_m(fillInfo.nSlots), dim_m(fillInfo.dim), nbins_m(fillInfo.nbins), xmin_m(fillInfo.xmin), xmax_m(fillInfo.xmax), channel_hasSystematic_m(fillInfo.channel_hasSystematic), controlRegion_hasSystematic_m(fillInfo.controlRegion_hasSystematic), 
-      sampleCategory_hasSystematic_m(fillInfo.sampleCategory_hasSystematic), weight_hasSystematic_m(fillInfo.weight_hasSystematic), hasSystematic_m(fillInfo.hasSystematic), channel_hasMultiFill_m(fillInfo.channel_hasMultiFill), 
-      controlRegion_hasMultiFill_m(fillInfo.controlRegion_hasMultiFill), sampleCategory_hasMultiFill_m(fillInfo.sampleCategory_hasMultiFill), systematic_hasMultiFill_m(fillInfo.systematic_hasMultiFill), weight_hasMultiFill_m(fillInfo.weight_hasMultiFill), 
-      hasMultiFill_m(fillInfo.hasMultiFill), name_m(fillInfo.name), title_m(fillInfo.title) {
-
-    // Auto-select dense (THnF) vs sparse (THnSparseF) per-thread accumulators.
-    // THnF uses direct array indexing (O(1)) which is faster than THnSparseF's
-    // hash-based lookup, but consumes memory proportional to all bins.
-    // Float_t content (4 B) + Double_t sumw2 (8 B) = 12 bytes per bin (with Sumw2).
-    useDense_m = estimateDenseMemoryBytes(nbins_m, nSlots_m, 12) <= kDenseMemoryThresholdBytes;
+    : nSlots_m(fillInfo.nSlots), dim_m(fillInfo.dim), nbins_m(fillInfo.nbins), xmin_m(fillInfo.xmin), xmax_m(fillInfo.xmax),
+      name_m(fillInfo.name), title_m(fillInfo.title), fillFlags_m(THnFill::flagsOf(fillInfo)),
+      valueIsBinIndex_m(fillInfo.value_isBinIndex), weightVector_m(fillInfo.weightVector),
+      valueAxis_m(fillInfo.valueEdges.empty() ? VariableAxisLookup()
+                                              : VariableAxisLookup(fillInfo.valueEdges)),
+      memoryReport_m(fillInfo.memoryReport), deviceSink_m(fillInfo.deviceSink),
+      cellMask_m(fillInfo.cellMask) {
+    if (!valueAxis_m.empty() && valueAxis_m.nbins() != nbins_m.back()) {
+      throw std::runtime_error("THnMulti: '" + name_m + "' has " +
+                               std::to_string(nbins_m.back()) + " value bins but " +
+                               std::to_string(fillInfo.valueEdges.size()) + " bin edges.");
+    }
+    if (!cellMask_m.empty() &&
+        (weightVector_m || cellMask_m.size() != static_cast<std::size_t>(nbins_m[0]) *
+                                                    static_cast<std::size_t>(nbins_m[3]))) {
+      throw std::runtime_error("THnMulti: the cell mask of '" + name_m + "' needs " +
+                               std::to_string(nbins_m[0] * nbins_m[3]) +
+                               " channel x systematic cells and no weight vector.");
+    }
 
-    for (unsigned int i = 0; i < nSlots_m; i++) {
+    // Auto-select dense (flat array) vs sparse (THnSparseF) per-thread accumulators.
+    // The flat array uses direct stride indexing (O(1)) which is faster than
+    // THnSparseF's hash-based lookup, but consumes memory proportional to all bins.
+    // Double_t sumw (8 B) + Double_t sumw2 (8 B) = 16 bytes per bin.
+    // Device storage holds a single copy of all bins, off the host.
+    useDense_m = !deviceSink_m &&
+                 estimateDenseMemoryBytes(nbins_m, nSlots_m, 16) <= kDenseMemoryThresholdBytes;
+
+    if (deviceSink_m) {
+      // Never placed: only computes the bin indices of the device storage.
+      deviceIndex_m = std::make_unique<FlatHistAccumulator>(
+          nbins_m, xmin_m, xmax_m, weightVector_m ? 3 : FlatHistAccumulator::kNoAxis);
+      if (deviceSink_m->cells() != deviceIndex_m->cells()) {
+        throw std::runtime_error("THnMulti: the device storage of '" + name_m + "' holds " +
+                                 std::to_string(deviceSink_m->cells()) + " bins instead of " +
+                                 std::to_string(deviceIndex_m->cells()) + ".");
+      }
+      fPerThreadStage_m.resize(nSlots_m);
+    } else if (useDense_m) {
+      fPerThreadDense_m.reserve(nSlots_m);
+      fPerThreadPartial_m.resize(nSlots_m);
+    }
+    for (unsigned int i = 0; i < nSlots_m && !deviceSink_m; i++) {
       if (useDense_m) {
-        fPerThreadDense_m.push_back(std::make_shared<THnF>(
-            (name_m + "_" + std::to_string(i)).c_str(), title_m.c_str(), dim_m,
-            nbins_m.data(), xmin_m.data(), xmax_m.data()));
-        fPerThreadDense_m[i]->Sumw2();
+        // Weight vectors fill adjacent systematic-axis cells.
+        fPerThreadDense_m.emplace_back(nbins_m, xmin_m, xmax_m,
+                                       weightVector_m ? 3 : FlatHistAccumulator::kNoAxis);
       } else {
         fPerThreadResults.push_back(std::make_shared<THnSparseF>(
             (name_m + "_" + std::to_string(i)).c_str(), title_m.c_str(), dim_m,
@@ -156,25 +785,57 @@ public:
         std::make_shared<Result_t>((name_m).c_str(), title_m.c_str(), dim_m,
                                    nbins_m.data(), xmin_m.data(), xmax_m.data());
 
-    // Select the per-bin fill helper: dense uses THnF (direct array), sparse uses THnSparseF (hash).
-    fillHistFunc_ = useDense_m ? &THnMulti::fillHistDense_ : &THnMulti::fillHistSparse_;
+    // Each sparse slot may hold its share of the memory ceiling before it is
+    // flushed into the result.
+    if (!useDense_m && !deviceSink_m) {
+      bytesPerSparseBin_m = estimateSparseBytesPerBin(nbins_m);
+      peakSlotBins_m.assign(nSlots_m, 0);
+      if (fillInfo.memoryCeilingBytes != 0) {
+        const std::size_t slotBins =
+            fillInfo.memoryCeilingBytes / std::max(nSlots_m, 1u) / bytesPerSparseBin_m;
+        maxSlotBins_m = std::max<Long64_t>(static_cast<Long64_t>(slotBins), 1);
+      }
+      if (maxSlotBins_m != 0 && !fillInfo.spillDirectory.empty()) {
+        if (estimateDenseMemoryBytes(nbins_m, 1, 1) == std::numeric_limits<std::size_t>::max()) {
+          throw std::runtime_error("THnMulti: '" + name_m + "' has too many bins to be "
+                                   "indexed in spill runs.");
+        }
+        spill_m = std::make_unique<HistSpillRuns>(fillInfo.spillDirectory, name_m, nSlots_m);
+        spilledEntries_m.assign(nSlots_m, 0.0);
+      }
+      promoteBins_m = densePromotionBins(nbins_m, nSlots_m, fillInfo.densePromotionFraction,
+                                         fillInfo.memoryCeilingBytes);
+      fPerThreadPromoted_m.resize(nSlots_m);
+      fPerThreadPartial_m.resize(nSlots_m);
+    }
 
-    // Set the fill function pointer based on configuration
-    // (This logic can be expanded for more fast paths as needed)
-    if (!channel_hasSystematic_m && !controlRegion_hasSystematic_m && !sampleCategory_hasSystematic_m && !weight_hasSystematic_m && !systematic_hasMultiFill_m &&
-        !channel_hasMultiFill_m && !controlRegion_hasMultiFill_m && !sampleCategory_hasMultiFill_m && !weight_hasMultiFill_m) {
-      // Fast path: single fill, no systematic
-      fillFunc_ = &THnMulti::SingleNoSystematicFill;
-    } else if (systematic_hasMultiFill_m && !channel_hasMultiFill_m && !controlRegion_hasMultiFill_m && !sampleCategory_hasMultiFill_m && !weight_hasMultiFill_m) {
-      // Fast path: single systematic fill
-      fillFunc_ = &THnMulti::SingleSystematicFill;
-    } else if (!systematic_hasMultiFill_m && (channel_hasMultiFill_m || controlRegion_hasMultiFill_m || sampleCategory_hasMultiFill_m || weight_hasMultiFill_m)) {
-      // Fast path: multi fill, no systematic
-      fillFunc_ = &THnMulti::MultiNoSystematicFill;
-    } else {
-      // General case
-      fillFunc_ = &THnMulti::GeneralFill;
+    // A variable-width value axis is filled by bin index.  Per-thread
+    // accumulators keep the uniform value axis as index space; slots are
+    // merged into the result by bin index, so only the result carries the
+    // real edges.
+    const bool variableValue = !valueIsBinIndex_m && !valueAxis_m.empty();
+    if (!valueAxis_m.empty()) {
+      fFinalResult->GetAxis(dim_m - 1)->Set(nbins_m.back(), valueAxis_m.edges().data());
+    }
+
+    // The sparse accumulator fills coordinates: map each value-axis bin
+    // index back to a coordinate inside that bin.
+    if ((valueIsBinIndex_m || variableValue) && !useDense_m && !deviceSink_m) {
+      const std::size_t last = nbins_m.size() - 1;
+      const Double_t width = (xmax_m[last] - xmin_m[last]) / nbins_m[last];
+      valueBinCoordinates_m.resize(nbins_m[last] + 2);
+      for (Int_t b = 0; b < nbins_m[last] + 2; ++b) {
+        valueBinCoordinates_m[b] = xmin_m[last] + (b - 0.5) * width;
+      }
     }
+
+    const unsigned storage = (useDense_m ? kDenseStorage : 0u) |
+                             (deviceSink_m ? kDeviceStorage : 0u) |
+                             (valueIsBinIndex_m ? kBinnedValue : 0u) |
+                             (variableValue ? kVariableValue : 0u);
+    fillKernel_m = selectKernel(fillFlags_m, storage);
+    scalarKernel_m = selectScalarKernel(storage);
+    weightVectorKernel_m = selectWeightVectorKernel(storage);
   }
 
   /**
@@ -201,16 +862,30 @@ public:
 
   /**
    * @brief Initialize a processing task (called at the beginning of each task)
+   *
+   * Pins the thread of @p slot (with ``pinThreads``) before the slot's dense
+   * accumulator is allocated, so that it lives on the thread's NUMA node.
    * @param reader TTreeReader pointer
    * @param slot Slot index
    */
-  void InitTask(TTreeReader *, int) {}
+  void InitTask(TTreeReader *, int slot) {
+    ThreadPinning::pinSlot(static_cast<unsigned int>(slot));
+    if (useDense_m) {
+      fPerThreadDense_m[slot].place();
+    } else if (deviceSink_m) {
+      fPerThreadStage_m[slot].cells.reserve(kDeviceBatchFills);
+      fPerThreadStage_m[slot].weights.reserve(kDeviceBatchFills);
+    }
+  }
+
+  /// Canonical THnFill layout the fill kernel is specialized on.
+  unsigned fillFlags() const { return fillFlags_m; }
 
   /// Called at every entry.
   /**
    * @brief Fill the per-thread histogram for one entry (hot loop).
    *
-   * This function dispatches to the appropriate fast path fill function based on configuration.
+   * Runs the fill kernel selected for this histogram's layout and storage.
    */
   void Exec(unsigned int slot,
             const ROOT::VecOps::RVec<Float_t> &__restrict__ baseHistogramValues, const ROOT::VecOps::RVec<Float_t> &__restrict__ baseHistogramWeights,
@@ -223,311 +898,704 @@ public:
                systematicVariation, sampleCategory, controlRegion, channel, nFills);
       return;
     }
-    // Dispatch to the selected fill function for optimal performance
-    (this->*fillFunc_)(slot, baseHistogramValues, baseHistogramWeights,
-                      systematicVariation, sampleCategory, controlRegion, channel, nFills);
+    fillKernel_m(*this, slot, baseHistogramValues, baseHistogramWeights,
+                 systematicVariation, sampleCategory, controlRegion, channel, nFills);
+    checkSlot(slot);
+  }
+
+  /**
+   * @brief Fill one nominal entry from scalar columns (hot loop).
+   *
+   * Booked by NDHistogramManager for the single-fill layout without
+   * systematics, where wrapping every input in a one-element RVec would
+   * only add heap allocations.  The systematic axis is the nominal bin.
+   */
+  void Exec(unsigned int slot, Float_t baseHistogramValue, Float_t baseHistogramWeight,
+            Float_t sampleCategory, Float_t controlRegion, Float_t channel) {
+    if (baseHistogramWeight == 0.0f) {
+      return;
+    }
+    scalarKernel_m(*this, slot, channel, controlRegion, sampleCategory, baseHistogramValue,
+                   baseHistogramWeight);
+    checkSlot(slot);
+  }
+
+  /**
+   * @brief Fill one entry with a vector of weights (hot loop).
+   *
+   * Weight i fills bin i + 1 of the systematic axis (histFillInfo::
+   * weightVector), e.g. one LHE scale or PDF variation per bin.  The other
+   * axes are looked up once for all weights, and the dense accumulator adds
+   * them in one pass over adjacent cells.
+   */
+  void Exec(unsigned int slot, Float_t baseHistogramValue,
+            const ROOT::VecOps::RVec<Float_t> &__restrict__ baseHistogramWeights,
+            Float_t sampleCategory, Float_t controlRegion, Float_t channel) {
+    weightVectorKernel_m(*this, slot, channel, controlRegion, sampleCategory,
+                         baseHistogramValue, baseHistogramWeights);
+    checkSlot(slot);
+  }
+
+  /**
+   * @brief Merge per-thread histograms at the end of the event loop.
+   *
+   * Per-thread accumulators are combined with a pairwise tree reduction
+   * (treeReduceSlots), running independent merges in parallel under implicit MT.
+   * When using dense per-thread accumulators (flat arrays), the slots are
+   * summed element-wise and non-zero in-range bins are written to the sparse
+   * final result, minimising output size.
+   * When using sparse per-thread accumulators (THnSparseF), the reduced
+   * histogram is added to the final result, which already holds the slots
+   * flushed under the memory ceiling, and so are the promoted slots, summed
+   * like dense ones.  With device storage, the fills still
+   * staged are streamed to the sink and its bins are downloaded into the
+   * result.  Spilled runs are merged into the result last.  The slot memory
+   * is recorded in the HistMemoryReport first, if one was requested.
+   */
+  void Finalize() {
+    recordMemory();
+    if (deviceSink_m) {
+      for (unsigned int slot = 0; slot < nSlots_m; ++slot) {
+        flushStage(slot);
+      }
+      FlatHistAccumulator total = *deviceIndex_m;
+      deviceSink_m->download(total.data());
+      total.writeTo(*fFinalResult);
+    } else if (useDense_m) {
+      // Tree-reduce all per-thread dense accumulators into the first one
+      treeReduceSlots(fPerThreadDense_m,
+                      [](FlatHistAccumulator& into, FlatHistAccumulator& from) {
+                        into.add(from);
+                      });
+      if (!fPerThreadDense_m.empty()) {
+        fPerThreadDense_m[0].writeTo(*fFinalResult);
+      }
+    } else {
+      treeReduceSlots(fPerThreadResults,
+                      [](std::shared_ptr<THnSparseF>& into, std::shared_ptr<THnSparseF>& from) {
+                        into->Add(from.get());
+                      });
+      if (!fPerThreadResults.empty()) {
+        fFinalResult->Add(fPerThreadResults[0].get());
+      }
+      treeReduceSlots(fPerThreadPromoted_m,
+                      [](std::unique_ptr<FlatHistAccumulator>& into,
+                         std::unique_ptr<FlatHistAccumulator>& from) {
+                        if (!into) {
+                          into = std::move(from);
+                        } else if (from) {
+                          into->add(*from);
+                        }
+                      });
+      if (!fPerThreadPromoted_m.empty() && fPerThreadPromoted_m[0]) {
+        fPerThreadPromoted_m[0]->writeTo(*fFinalResult, true);
+      }
+      if (spill_m) {
+        mergeSpilledRuns();
+      }
+    }
+  }
+
+  /**
+   * @brief Slot accumulator so far, for RResultPtr::OnPartialResultSlot().
+   *
+   * A sparse slot accumulator is returned as is.  A dense or promoted one
+   * is copied into a per-slot THnSparseF, which is only allocated on first
+   * use.  Like the slot accumulators, a variable-width value axis is in
+   * index space.  Device storage has no slot accumulators, so it has no
+   * partial results.
+   */
+  THnSparseF &PartialUpdate(unsigned int slot) {
+    if (deviceSink_m) {
+      throw std::runtime_error("THnMulti: '" + name_m + "' is filled on a device and has no "
+                               "per-slot partial results.");
+    }
+    const FlatHistAccumulator *dense =
+        useDense_m ? &fPerThreadDense_m[slot] : fPerThreadPromoted_m[slot].get();
+    if (!dense) {
+      return *fPerThreadResults[slot];
+    }
+    auto &partial = fPerThreadPartial_m[slot];
+    if (!partial) {
+      partial = std::make_shared<THnSparseF>(
+          (name_m + "_" + std::to_string(slot)).c_str(), title_m.c_str(), dim_m,
+          nbins_m.data(), xmin_m.data(), xmax_m.data());
+      partial->Sumw2();
+    } else {
+      partial->Reset();
+    }
+    dense->writeTo(*partial);
+    return *partial;
+  }
+
+  /**
+   * @brief Get the name of this action for RDataFrame
+   * @return Action name string
+   */
+  std::string GetActionName() const { return "THnMulti"; }
+
+private:
+  void LogSizes(const char* reason,
+                unsigned int slot,
+                const ROOT::VecOps::RVec<Float_t> &baseHistogramValues,
+                const ROOT::VecOps::RVec<Float_t> &baseHistogramWeights,
+                const ROOT::VecOps::RVec<Float_t> &systematicVariation,
+                const ROOT::VecOps::RVec<Float_t> &sampleCategory,
+                const ROOT::VecOps::RVec<Float_t> &controlRegion,
+                const ROOT::VecOps::RVec<Float_t> &channel,
+                const ROOT::VecOps::RVec<Int_t> &nFills) const {
+    static const bool enabled = (std::getenv("RDF_NDHIST_DEBUG") != nullptr);
+    if (!enabled) {
+      return;
+    }
+    RDF_LOG_INFO << "[THnMulti] " << reason
+                 << " slot=" << slot
+                 << " baseVals=" << baseHistogramValues.size()
+                 << " baseWts=" << baseHistogramWeights.size()
+                 << " syst=" << systematicVariation.size()
+                 << " sampleCat=" << sampleCategory.size()
+                 << " control=" << controlRegion.size()
+                 << " channel=" << channel.size()
+                 << " nFills=" << nFills.size();
+  }
+
+  /// Promote or flush the sparse accumulator of @p slot after a fill.
+  void checkSlot(unsigned int slot) {
+    if (promoteBins_m != 0 && fPerThreadResults[slot]->GetNbins() >= promoteBins_m) {
+      promoteSlot(slot);
+    }
+    if (maxSlotBins_m != 0 && fPerThreadResults[slot]->GetNbins() > maxSlotBins_m) {
+      flushSlot(slot);
+    }
+  }
+
+  /**
+   * @brief Move the bins of a sparse slot accumulator into a flat array
+   *        that the slot fills from then on.
+   *
+   * The THnSparseF is emptied, so the slot is not promoted twice.
+   */
+  void promoteSlot(unsigned int slot) {
+    THnSparseF &sparse = *fPerThreadResults[slot];
+    peakSlotBins_m[slot] = std::max(peakSlotBins_m[slot], sparse.GetNbins());
+    auto dense = std::make_unique<FlatHistAccumulator>(
+        nbins_m, xmin_m, xmax_m, weightVector_m ? 3 : FlatHistAccumulator::kNoAxis);
+    dense->place();
+    std::vector<Int_t> idx(dim_m);
+    for (Long64_t bin = 0; bin < sparse.GetNbins(); ++bin) {
+      const Double_t content = sparse.GetBinContent(bin, idx.data());
+      dense->addBin(idx.data(), content, sparse.GetBinError2(bin));
+    }
+    sparse.Reset();
+    fPerThreadPromoted_m[slot] = std::move(dense);
+  }
+
+  /**
+   * @brief Merge a sparse slot accumulator into the result and empty it.
+   *
+   * Keeps the slot under its share of histFillInfo::memoryCeilingBytes; the
+   * result is shared by the slots, so the merge is serialized.  With a
+   * spill directory the slot is spilled to a run instead (spillSlot()).
+   */
+  void flushSlot(unsigned int slot) {
+    THnSparseF &accumulator = *fPerThreadResults[slot];
+    peakSlotBins_m[slot] = std::max(peakSlotBins_m[slot], accumulator.GetNbins());
+    if (spill_m) {
+      spillSlot(slot);
+      return;
+    }
+    {
+      std::lock_guard<std::mutex> lock(*flushMutex_m);
+      fFinalResult->Add(&accumulator);
+      ++flushes_m;
+    }
+    accumulator.Reset();
   }
 
-  void SingleNoSystematicFill(unsigned int slot,
-    const ROOT::VecOps::RVec<Float_t> &__restrict__ baseHistogramValues, const ROOT::VecOps::RVec<Float_t> &__restrict__ baseHistogramWeights,
-    const ROOT::VecOps::RVec<Float_t> &__restrict__ systematicVariation, // unused
-    const ROOT::VecOps::RVec<Float_t> &__restrict__ sampleCategory, 
-    const ROOT::VecOps::RVec<Float_t> &__restrict__ controlRegion, const ROOT::VecOps::RVec<Float_t> &__restrict__ channel, 
-    const ROOT::VecOps::RVec<Int_t>   &__restrict__ nFills) {
+  /**
+   * @brief Write a sparse slot accumulator to a run on disk and empty it.
+   *
+   * Bins are keyed by their linear index over all axes, under- and overflow
+   * included, the first axis varying fastest.  The run is slot-local, so
+   * no lock is taken.
+   */
+  void spillSlot(unsigned int slot) {
+    THnSparseF &accumulator = *fPerThreadResults[slot];
+    std::vector<HistSpillRuns::Cell> cells(static_cast<std::size_t>(accumulator.GetNbins()));
+    std::vector<Int_t> idx(dim_m);
+    for (Long64_t bin = 0; bin < accumulator.GetNbins(); ++bin) {
+      HistSpillRuns::Cell &cell = cells[static_cast<std::size_t>(bin)];
+      cell.sumw = accumulator.GetBinContent(bin, idx.data());
+      cell.sumw2 = accumulator.GetBinError2(bin);
+      cell.index = 0;
+      for (Int_t d = dim_m - 1; d >= 0; --d) {
+        cell.index = cell.index * (static_cast<std::uint64_t>(nbins_m[d]) + 2) +
+                     static_cast<std::uint64_t>(idx[d]);
+      }
+    }
+    spill_m->write(slot, cells);
+    spilledEntries_m[slot] += accumulator.GetEntries();
+    accumulator.Reset();
+  }
 
-      if (baseHistogramWeights.size() < 1 || channel.size() < 1 || controlRegion.size() < 1 ||
-          sampleCategory.size() < 1 || systematicVariation.size() < 1) {
-        LogSizes("single fill size mismatch", slot, baseHistogramValues, baseHistogramWeights,
-                 systematicVariation, sampleCategory, controlRegion, channel, nFills);
-        return;
+  /// Add the bins of all spilled runs to the result, each bin once.
+  void mergeSpilledRuns() {
+    fFinalResult->Sumw2();
+    Double_t entries = fFinalResult->GetEntries();
+    std::vector<Int_t> idx(dim_m);
+    spill_m->merge([this, &idx](const HistSpillRuns::Cell &cell) {
+      std::uint64_t rest = cell.index;
+      for (Int_t d = 0; d < dim_m; ++d) {
+        const std::uint64_t axisBins = static_cast<std::uint64_t>(nbins_m[d]) + 2;
+        idx[d] = static_cast<Int_t>(rest % axisBins);
+        rest /= axisBins;
       }
+      const Long64_t bin = fFinalResult->GetBin(idx.data(), true);
+      fFinalResult->AddBinContent(bin, cell.sumw);
+      fFinalResult->AddBinError2(bin, cell.sumw2);
+    });
+    for (const Double_t spilled : spilledEntries_m) {
+      entries += spilled;
+    }
+    fFinalResult->SetEntries(entries);
+  }
 
-      const Double_t weight = baseHistogramWeights[0];
+  /// Fills of one slot waiting to be streamed to the device storage.
+  struct alignas(64) DeviceStage {
+    std::vector<std::uint64_t> cells;
+    std::vector<Float_t> weights;
+  };
+
+  /// Stage one fill of @p slot, streaming the stage once it is full.
+  void stageFill(unsigned int slot, std::size_t cell, Float_t w) {
+    DeviceStage &stage = fPerThreadStage_m[slot];
+    stage.cells.push_back(cell);
+    stage.weights.push_back(w);
+    if (stage.cells.size() >= kDeviceBatchFills) {
+      flushStage(slot);
+    }
+  }
+
+  /// Stream the staged fills of @p slot to the device storage.
+  void flushStage(unsigned int slot) {
+    DeviceStage &stage = fPerThreadStage_m[slot];
+    if (!stage.cells.empty()) {
+      deviceSink_m->add(stage.cells.data(), stage.weights.data(), stage.cells.size());
+      stage.cells.clear();
+      stage.weights.clear();
+    }
+  }
 
-      // Skip zero-weight entries for efficiency
-      if (weight != 0.0) { // Skip zero-weight contributions.
-        (this->*fillHistFunc_)(slot, channel[0], controlRegion[0], sampleCategory[0], systematicVariation[0], baseHistogramValues[0], weight);
+  /// Write the slot accumulator memory to the requested HistMemoryReport.
+  void recordMemory() const {
+    if (!memoryReport_m) {
+      return;
+    }
+    HistMemoryReport &report = *memoryReport_m;
+    report.name = name_m;
+    report.dense = useDense_m;
+    report.flushes = flushes_m;
+    report.promotions = 0;
+    report.spills = spill_m ? spill_m->runs() : 0;
+    report.spilledBytes = spill_m ? spill_m->bytes() : 0;
+    report.slotFilledBins.assign(nSlots_m, 0);
+    report.slotBytes.assign(nSlots_m, 0);
+    for (unsigned int slot = 0; slot < nSlots_m; ++slot) {
+      if (deviceSink_m) {
+        // Only the staging buffers live on the host.
+        const DeviceStage &stage = fPerThreadStage_m[slot];
+        report.slotBytes[slot] = stage.cells.capacity() * sizeof(std::uint64_t) +
+                                 stage.weights.capacity() * sizeof(Float_t);
+      } else if (useDense_m) {
+        report.slotFilledBins[slot] = fPerThreadDense_m[slot].filledBins();
+        report.slotBytes[slot] = fPerThreadDense_m[slot].bytes();
+      } else if (const FlatHistAccumulator *promoted = fPerThreadPromoted_m[slot].get()) {
+        // The flat array is at least as large as the sparse bins it replaced.
+        ++report.promotions;
+        report.slotFilledBins[slot] = promoted->filledBins();
+        report.slotBytes[slot] =
+            std::max(promoted->bytes(),
+                     static_cast<std::size_t>(peakSlotBins_m[slot]) * bytesPerSparseBin_m);
+      } else {
+        const Long64_t filled =
+            std::max(peakSlotBins_m[slot], fPerThreadResults[slot]->GetNbins());
+        report.slotFilledBins[slot] = filled;
+        report.slotBytes[slot] = static_cast<std::size_t>(filled) * bytesPerSparseBin_m;
       }
-    
+    }
   }
 
+  using KernelType = void (*)(THnMulti &, unsigned int,
+    const ROOT::VecOps::RVec<Float_t> &, const ROOT::VecOps::RVec<Float_t> &,
+    const ROOT::VecOps::RVec<Float_t> &, const ROOT::VecOps::RVec<Float_t> &,
+    const ROOT::VecOps::RVec<Float_t> &, const ROOT::VecOps::RVec<Float_t> &,
+    const ROOT::VecOps::RVec<Int_t> &);
+
+  /// Storage bits of a kernel: dense accumulator or device storage (never
+  /// both), and base values given as value-axis bin indices or looked up on
+  /// a variable-width value axis (never both).
+  static constexpr unsigned kDenseStorage = 1u;
+  static constexpr unsigned kBinnedValue = 2u;
+  static constexpr unsigned kVariableValue = 4u;
+  static constexpr unsigned kDeviceStorage = 8u;
+  /// Kernel table entries per layout: the six host storages, then the three
+  /// device storages.
+  static constexpr unsigned kStorageKinds = 9u;
+
+  /// Storage bits of kernel table entry @p index.
+  static constexpr unsigned storageBits(unsigned index) {
+    return index < 6u ? index : kDeviceStorage | 2u * (index - 6u);
+  }
 
-  void SingleSystematicFill(unsigned int slot,
+  /// Kernel table entry of the @p storage bits (inverse of storageBits()).
+  static constexpr unsigned storageIndex(unsigned storage) {
+    return storage < kDeviceStorage ? storage : 6u + (storage & ~kDeviceStorage) / 2u;
+  }
+
+  /// Staged fills per slot streamed to the device storage at once.
+  static constexpr std::size_t kDeviceBatchFills = std::size_t{1} << 16;
+
+  /// Whether histFillInfo::cellMask skips the channel and systematic cell
+  /// of @p ch and @p sv; under- and overflow are never skipped.
+  bool skipsCell(Double_t ch, Double_t sv) const {
+    const Int_t chBin = uniformAxisBin(ch, nbins_m[0], xmin_m[0], xmax_m[0], xmax_m[0] - xmin_m[0]);
+    const Int_t svBin = uniformAxisBin(sv, nbins_m[3], xmin_m[3], xmax_m[3], xmax_m[3] - xmin_m[3]);
+    if (chBin == 0 || chBin > nbins_m[0] || svBin == 0 || svBin > nbins_m[3]) {
+      return false;
+    }
+    return cellMask_m[static_cast<std::size_t>(svBin - 1) * nbins_m[0] + (chBin - 1)] == 0;
+  }
+
+  /// Value-axis bin of @p bv for the binned or variable-width value storage.
+  template <unsigned Storage>
+  Int_t valueBin(Double_t bv) const {
+    if constexpr ((Storage & kVariableValue) != 0) {
+      return valueAxis_m.findBin(bv);
+    } else {
+      const Int_t last = nbins_m.back() + 1;
+      const Int_t bin = static_cast<Int_t>(bv);
+      return bin < 0 ? 0 : (bin > last ? last : bin);
+    }
+  }
+
+  /// Fill one bin in the dense (O(1) direct array indexing) or sparse
+  /// (THnSparseF hash) per-thread accumulator, or stage it for the device
+  /// storage.  The sparse storage fills the flat array of a promoted slot.
+  template <unsigned Storage>
+  void fillBin(unsigned int slot, Double_t ch, Double_t cr, Double_t sc,
+               Double_t sv, Double_t bv, Double_t w) {
+    if (!cellMask_m.empty() && skipsCell(ch, sv)) {
+      return;
+    }
+    if constexpr ((Storage & kDeviceStorage) != 0) {
+      if constexpr ((Storage & (kBinnedValue | kVariableValue)) != 0) {
+        const Double_t x[4] = {ch, cr, sc, sv};
+        stageFill(slot, deviceIndex_m->findBinLastAxis(x, valueBin<Storage>(bv)),
+                  static_cast<Float_t>(w));
+      } else {
+        const Double_t x[5] = {ch, cr, sc, sv, bv};
+        stageFill(slot, deviceIndex_m->findBin(x), static_cast<Float_t>(w));
+      }
+    } else if constexpr ((Storage & (kBinnedValue | kVariableValue)) != 0) {
+      const Int_t bin = valueBin<Storage>(bv);
+      if constexpr ((Storage & kDenseStorage) != 0) {
+        const Double_t x[4] = {ch, cr, sc, sv};
+        fPerThreadDense_m[slot].fillLastAxisBin(x, bin, w);
+      } else if (FlatHistAccumulator *promoted = fPerThreadPromoted_m[slot].get()) {
+        const Double_t x[4] = {ch, cr, sc, sv};
+        promoted->fillLastAxisBin(x, bin, w);
+      } else {
+        fPerThreadResults[slot]->Fill(ch, cr, sc, sv, valueBinCoordinates_m[bin], w);
+      }
+    } else if constexpr ((Storage & kDenseStorage) != 0) {
+      const Double_t x[5] = {ch, cr, sc, sv, bv};
+      fPerThreadDense_m[slot].fill(x, w);
+    } else if (FlatHistAccumulator *promoted = fPerThreadPromoted_m[slot].get()) {
+      const Double_t x[5] = {ch, cr, sc, sv, bv};
+      promoted->fill(x, w);
+    } else {
+      fPerThreadResults[slot]->Fill(ch, cr, sc, sv, bv, w);
+    }
+  }
+
+  /**
+   * @brief Fill loop for one entry, specialized on the layout @p Flags and
+   *        the @p Storage bits.
+   *
+   * Single: one fill from the first element of every input.
+   * SingleSystematic: one fill per systematic variation; inputs with a
+   * systematic flag advance with the variation.
+   * MultiNoSystematic: one fill per base value; inputs with a multi-fill
+   * flag advance with each fill.
+   * General: nFills[k] fills per variation k; inputs advance per fill when
+   * multi-fill, per variation when systematic, and restart otherwise.
+   * Zero-weight contributions are skipped.
+   */
+  template <unsigned Flags, unsigned Storage>
+  static void fillKernel(THnMulti &self, unsigned int slot,
     const ROOT::VecOps::RVec<Float_t> &__restrict__ baseHistogramValues, const ROOT::VecOps::RVec<Float_t> &__restrict__ baseHistogramWeights,
-    const ROOT::VecOps::RVec<Float_t> &__restrict__ systematicVariation,
-    const ROOT::VecOps::RVec<Float_t> &__restrict__ sampleCategory, 
-    const ROOT::VecOps::RVec<Float_t> &__restrict__ controlRegion, const ROOT::VecOps::RVec<Float_t> &__restrict__ channel, 
+    const ROOT::VecOps::RVec<Float_t> &__restrict__ systematicVariation, const ROOT::VecOps::RVec<Float_t> &__restrict__ sampleCategory,
+    const ROOT::VecOps::RVec<Float_t> &__restrict__ controlRegion, const ROOT::VecOps::RVec<Float_t> &__restrict__ channel,
     const ROOT::VecOps::RVec<Int_t> &__restrict__ nFills) {
+    using namespace THnFill;
+    constexpr Path kPath = Flags == kRuntimeLayout ? Path::General : path(Flags);
+    if constexpr ((Storage & kDenseStorage) != 0) {
+      // Placed by InitTask() in the event loop; this covers direct Exec() calls.
+      self.fPerThreadDense_m[slot].place();
+    }
 
+    if constexpr (kPath == Path::Single) {
+      const Double_t weight = baseHistogramWeights[0];
+      if (weight != 0.0) {
+        self.fillBin<Storage>(slot, channel[0], controlRegion[0], sampleCategory[0],
+                            systematicVariation[0], baseHistogramValues[0], weight);
+      }
+    } else if constexpr (kPath != Path::General) {
+      // SingleSystematic steps the systematic flags, MultiNoSystematic the
+      // multi-fill flags; the systematic axis follows the base values in the
+      // former and is fixed in the latter.
+      constexpr bool kSteppedSyst = kPath == Path::SingleSystematic;
+      // The multi-fill bits sit four above the matching systematic bits.
+      constexpr unsigned kStepped = kSteppedSyst ? Flags : Flags >> 4;
+      constexpr int kChannelStep = (kStepped & kChannelSyst) != 0;
+      constexpr int kControlStep = (kStepped & kControlRegionSyst) != 0;
+      constexpr int kSampleStep = (kStepped & kSampleCategorySyst) != 0;
+      constexpr int kWeightStep = (kStepped & kWeightSyst) != 0;
+
+      const int nBase = static_cast<int>(baseHistogramValues.size());
+      const int nWeights = static_cast<int>(baseHistogramWeights.size());
+      const int nControl = static_cast<int>(controlRegion.size());
+      const int nChannel = static_cast<int>(channel.size());
+      const int nSample = static_cast<int>(sampleCategory.size());
+      const int nSyst = static_cast<int>(systematicVariation.size());
       int weightCounter = 0;
-      int baseFillCounter = 0;
       int controlRegionCounter = 0;
       int channelCounter = 0;
       int sampleCategoryCounter = 0;
-
-      // Main fill loop: iterates over all base histogram values for this event
-      while(baseFillCounter < baseHistogramValues.size()) {
-        if (weightCounter >= static_cast<int>(baseHistogramWeights.size()) ||
-            controlRegionCounter >= static_cast<int>(controlRegion.size()) ||
-            channelCounter >= static_cast<int>(channel.size()) ||
-            sampleCategoryCounter >= static_cast<int>(sampleCategory.size()) ||
-            baseFillCounter >= static_cast<int>(systematicVariation.size())) {
-          LogSizes("single systematic size mismatch", slot, baseHistogramValues, baseHistogramWeights,
-                   systematicVariation, sampleCategory, controlRegion, channel, nFills);
+      for (int baseFillCounter = 0; baseFillCounter < nBase; ++baseFillCounter) {
+        const int systematicCounter = kSteppedSyst ? baseFillCounter : 0;
+        if (weightCounter >= nWeights || controlRegionCounter >= nControl ||
+            channelCounter >= nChannel || sampleCategoryCounter >= nSample ||
+            systematicCounter >= nSyst) {
+          self.LogSizes(kSteppedSyst ? "single systematic size mismatch" : "multi fill size mismatch",
+                        slot, baseHistogramValues, baseHistogramWeights, systematicVariation,
+                        sampleCategory, controlRegion, channel, nFills);
           break;
         }
         const Double_t weight = baseHistogramWeights[weightCounter];
-  
-        // Skip zero-weight entries for efficiency
-        if (weight != 0.0) { // Skip zero-weight contributions.
-          (this->*fillHistFunc_)(slot, channel[channelCounter], controlRegion[controlRegionCounter], sampleCategory[sampleCategoryCounter], systematicVariation[baseFillCounter], baseHistogramValues[baseFillCounter], weight);
+        if (weight != 0.0) {
+          self.fillBin<Storage>(slot, channel[channelCounter], controlRegion[controlRegionCounter],
+                              sampleCategory[sampleCategoryCounter], systematicVariation[systematicCounter],
+                              baseHistogramValues[baseFillCounter], weight);
         }
-        
-        controlRegionCounter+=controlRegion_hasSystematic_m;
-        sampleCategoryCounter+=sampleCategory_hasSystematic_m;
-        channelCounter+=channel_hasSystematic_m;
-        weightCounter+=weight_hasSystematic_m;
-        baseFillCounter++;
+        controlRegionCounter += kControlStep;
+        sampleCategoryCounter += kSampleStep;
+        channelCounter += kChannelStep;
+        weightCounter += kWeightStep;
       }
-    
-  }
-
-
-  void MultiNoSystematicFill(unsigned int slot,
-    const ROOT::VecOps::RVec<Float_t> &__restrict__ baseHistogramValues, const ROOT::VecOps::RVec<Float_t> &__restrict__ baseHistogramWeights,
-    const ROOT::VecOps::RVec<Float_t> &__restrict__ systematicVariation, // unused
-    const ROOT::VecOps::RVec<Float_t> &__restrict__ sampleCategory, 
-    const ROOT::VecOps::RVec<Float_t> &__restrict__ controlRegion, const ROOT::VecOps::RVec<Float_t> &__restrict__ channel, 
-    const ROOT::VecOps::RVec<Int_t> &__restrict__ nFills) {
-
+    } else {
+      // Constant for every layout but kRuntimeLayout, so the flag tests
+      // below fold away in the specialized kernels.
+      const unsigned layout = Flags == kRuntimeLayout ? self.fillFlags_m : Flags;
+      const bool channelSyst = (layout & kChannelSyst) != 0;
+      const bool controlSyst = (layout & kControlRegionSyst) != 0;
+      const bool sampleSyst = (layout & kSampleCategorySyst) != 0;
+      const bool weightSyst = (layout & kWeightSyst) != 0;
+      const bool channelMulti = (layout & kChannelMulti) != 0;
+      const bool controlMulti = (layout & kControlRegionMulti) != 0;
+      const bool sampleMulti = (layout & kSampleCategoryMulti) != 0;
+      const bool weightMulti = (layout & kWeightMulti) != 0;
+      const bool systMulti = (layout & kSystematicMulti) != 0;
+
+      const int nBase = static_cast<int>(baseHistogramValues.size());
       int weightCounter = 0;
-      int baseFillCounter = 0;
       int systematicCounter = 0;
       int controlRegionCounter = 0;
       int channelCounter = 0;
       int sampleCategoryCounter = 0;
-
-      
-      // Main fill loop: iterates over all base histogram values for this event
-      while(baseFillCounter < baseHistogramValues.size()) {
+      int fillCounter = 0;
+      for (int baseFillCounter = 0; baseFillCounter < nBase; ++baseFillCounter) {
         if (weightCounter >= static_cast<int>(baseHistogramWeights.size()) ||
             controlRegionCounter >= static_cast<int>(controlRegion.size()) ||
             channelCounter >= static_cast<int>(channel.size()) ||
             sampleCategoryCounter >= static_cast<int>(sampleCategory.size()) ||
-            systematicCounter >= static_cast<int>(systematicVariation.size())) {
-          LogSizes("multi fill size mismatch", slot, baseHistogramValues, baseHistogramWeights,
-                   systematicVariation, sampleCategory, controlRegion, channel, nFills);
+            systematicCounter >= static_cast<int>(systematicVariation.size()) ||
+            systematicCounter >= static_cast<int>(nFills.size())) {
+          self.LogSizes("general fill size mismatch", slot, baseHistogramValues, baseHistogramWeights,
+                        systematicVariation, sampleCategory, controlRegion, channel, nFills);
           break;
         }
         const Double_t weight = baseHistogramWeights[weightCounter];
-  
-        // Skip zero-weight entries for efficiency
-        if (weight != 0.0) { // Skip zero-weight contributions.
-          (this->*fillHistFunc_)(slot, channel[channelCounter], controlRegion[controlRegionCounter], sampleCategory[sampleCategoryCounter], systematicVariation[systematicCounter], baseHistogramValues[baseFillCounter], weight);
+        if (weight != 0.0) {
+          self.fillBin<Storage>(slot, channel[channelCounter], controlRegion[controlRegionCounter],
+                              sampleCategory[sampleCategoryCounter], systematicVariation[systematicCounter],
+                              baseHistogramValues[baseFillCounter], weight);
         }
-        
-        systematicCounter+=systematic_hasMultiFill_m;
-        controlRegionCounter+=controlRegion_hasMultiFill_m;
-        sampleCategoryCounter+=sampleCategory_hasMultiFill_m;
-        channelCounter+=channel_hasMultiFill_m;
-        weightCounter+=weight_hasMultiFill_m;
-        baseFillCounter++;
-      }
-      
-    
-  }
-
-
-
-  void GeneralFill(unsigned int slot,
-    const ROOT::VecOps::RVec<Float_t> &__restrict__ baseHistogramValues, const ROOT::VecOps::RVec<Float_t> &__restrict__ baseHistogramWeights,
-    const ROOT::VecOps::RVec<Float_t> &__restrict__ systematicVariation,
-    const ROOT::VecOps::RVec<Float_t> &__restrict__ sampleCategory, 
-    const ROOT::VecOps::RVec<Float_t> &__restrict__ controlRegion, const ROOT::VecOps::RVec<Float_t> &__restrict__ channel, 
-    const ROOT::VecOps::RVec<Int_t> &__restrict__ nFills) {
-
-    int weightCounter = 0;
-    int baseFillCounter = 0;
-    int systematicCounter = 0;
-    int controlRegionCounter = 0;
-    int channelCounter = 0;
-    int sampleCategoryCounter = 0;
-    int fillCounter = 0;
-    // Main fill loop: iterates over all base histogram values for this event
-    while(baseFillCounter < baseHistogramValues.size()) {
-      if (weightCounter >= static_cast<int>(baseHistogramWeights.size()) ||
-          controlRegionCounter >= static_cast<int>(controlRegion.size()) ||
-          channelCounter >= static_cast<int>(channel.size()) ||
-          sampleCategoryCounter >= static_cast<int>(sampleCategory.size()) ||
-          systematicCounter >= static_cast<int>(systematicVariation.size()) ||
-          systematicCounter >= static_cast<int>(nFills.size())) {
-        LogSizes("general fill size mismatch", slot, baseHistogramValues, baseHistogramWeights,
-                 systematicVariation, sampleCategory, controlRegion, channel, nFills);
-        break;
-      }
-      const Double_t weight = baseHistogramWeights[weightCounter];
-
-      // Skip zero-weight entries for efficiency
-      if (weight != 0.0) { // Skip zero-weight contributions.
-        (this->*fillHistFunc_)(slot, channel[channelCounter], controlRegion[controlRegionCounter], sampleCategory[sampleCategoryCounter], systematicVariation[systematicCounter], baseHistogramValues[baseFillCounter], weight);
-      }
 
-      // Update the counter for everything with multi fill
-      // These counters track the current index for each axis that may require multiple fills per event.
-      baseFillCounter++;
-      fillCounter++;
-      if(channel_hasMultiFill_m) {
-        channelCounter++;
-      }
-      if(controlRegion_hasMultiFill_m) {
-        controlRegionCounter++;
-      }
-      if(sampleCategory_hasMultiFill_m) {
-        sampleCategoryCounter++;
-      }
-      if(systematic_hasMultiFill_m) {
-        systematicCounter++;
-      }
-      if(weight_hasMultiFill_m) {
-        weightCounter++;
-      }
-      // Check if we've completed the required number of fills for the current systematic
-      if (systematicCounter >= static_cast<int>(nFills.size())) {
-        LogSizes("general fill nFills index", slot, baseHistogramValues, baseHistogramWeights,
-                 systematicVariation, sampleCategory, controlRegion, channel, nFills);
-        break;
-      }
-      if(fillCounter >= nFills[systematicCounter]) { // finished fill for the first systematic
-        fillCounter = 0;
-        // Reset or increment counters for each axis depending on systematic/multifill configuration
-        // If the axis does not depend on the systematic, reset its counter; otherwise, increment if not multi-fill
-        if(!channel_hasSystematic_m) {
-          channelCounter = 0;
-        } else if(!channel_hasMultiFill_m) {
-          channelCounter +=1;
-        }
-        if(!controlRegion_hasSystematic_m) {
-          controlRegionCounter = 0;
-        } else if(!controlRegion_hasMultiFill_m) {
-          controlRegionCounter +=1;
-        }
-        if(!sampleCategory_hasSystematic_m) {
-          sampleCategoryCounter = 0;
-        } else if(!sampleCategory_hasMultiFill_m) {
-          sampleCategoryCounter +=1;
-        }
-        if(!weight_hasSystematic_m) {
-          weightCounter = 0;
-        } else if(!weight_hasMultiFill_m) {
-          weightCounter +=1;
+        // Axes with multi fill advance with every fill.
+        ++fillCounter;
+        channelCounter += channelMulti;
+        controlRegionCounter += controlMulti;
+        sampleCategoryCounter += sampleMulti;
+        systematicCounter += systMulti;
+        weightCounter += weightMulti;
+        if (systematicCounter >= static_cast<int>(nFills.size())) {
+          self.LogSizes("general fill nFills index", slot, baseHistogramValues, baseHistogramWeights,
+                        systematicVariation, sampleCategory, controlRegion, channel, nFills);
+          break;
         }
-        // If the systematic axis is not multi-fill, increment its counter
-        if(!systematic_hasMultiFill_m) {
-          systematicCounter +=1;
+        if (fillCounter >= nFills[systematicCounter]) { // finished the fills of this variation
+          fillCounter = 0;
+          // Axes that do not depend on the systematic restart; systematic
+          // axes without multi fill move to the next variation.
+          if (!channelSyst) {
+            channelCounter = 0;
+          } else if (!channelMulti) {
+            ++channelCounter;
+          }
+          if (!controlSyst) {
+            controlRegionCounter = 0;
+          } else if (!controlMulti) {
+            ++controlRegionCounter;
+          }
+          if (!sampleSyst) {
+            sampleCategoryCounter = 0;
+          } else if (!sampleMulti) {
+            ++sampleCategoryCounter;
+          }
+          if (!weightSyst) {
+            weightCounter = 0;
+          } else if (!weightMulti) {
+            ++weightCounter;
+          }
+          if (!systMulti) {
+            ++systematicCounter;
+          }
         }
       }
+    }
+  }
+
+  template <std::size_t... I>
+  static constexpr std::array<KernelType, sizeof...(I)> makeKernels(std::index_sequence<I...>) {
+    return {{&fillKernel<THnFill::kernelLayout(static_cast<unsigned>(I / kStorageKinds)),
+                         storageBits(static_cast<unsigned>(I % kStorageKinds))>...}};
+  }
 
+  using ScalarKernelType = void (*)(THnMulti &, unsigned int, Double_t, Double_t, Double_t,
+                                    Double_t, Double_t);
 
+  /// Nominal fill of one entry given as scalars (see the scalar Exec()).
+  template <unsigned Storage>
+  static void scalarKernel(THnMulti &self, unsigned int slot, Double_t channel,
+                           Double_t controlRegion, Double_t sampleCategory, Double_t value,
+                           Double_t weight) {
+    if constexpr ((Storage & kDenseStorage) != 0) {
+      self.fPerThreadDense_m[slot].place();
     }
+    self.fillBin<Storage>(slot, channel, controlRegion, sampleCategory, 0.0, value, weight);
+  }
 
-}
+  template <std::size_t... I>
+  static constexpr std::array<ScalarKernelType, sizeof...(I)>
+  makeScalarKernels(std::index_sequence<I...>) {
+    return {{&scalarKernel<storageBits(static_cast<unsigned>(I))>...}};
+  }
 
-  /**
-   * @brief Merge per-thread histograms at the end of the event loop.
-   *
-   * When using dense per-thread accumulators (THnF), all bins are iterated and
-   * non-zero bins are written to the sparse final result, minimising output size.
-   * When using sparse per-thread accumulators (THnSparseF), a simple Add() merge
-   * is used as before.
-   */
-  void Finalize() {
-    if (useDense_m) {
-      // Sum all per-thread dense histograms into the first one
-      for (size_t slot = 1; slot < fPerThreadDense_m.size(); slot++) {
-        fPerThreadDense_m[0]->Add(fPerThreadDense_m[slot].get());
+  /// Scalar kernel for the @p storage bits.
+  static ScalarKernelType selectScalarKernel(unsigned storage) {
+    static constexpr std::array<ScalarKernelType, kStorageKinds> kernels =
+        makeScalarKernels(std::make_index_sequence<kStorageKinds>{});
+    return kernels[storageIndex(storage)];
+  }
+
+  using WeightVectorKernelType = void (*)(THnMulti &, unsigned int, Double_t, Double_t,
+                                          Double_t, Double_t,
+                                          const ROOT::VecOps::RVec<Float_t> &);
+
+  /// Fill of one entry with a weight vector (see the weight-vector Exec()).
+  template <unsigned Storage>
+  static void weightVectorKernel(THnMulti &self, unsigned int slot, Double_t channel,
+                                 Double_t controlRegion, Double_t sampleCategory,
+                                 Double_t value, const ROOT::VecOps::RVec<Float_t> &weights) {
+    FlatHistAccumulator *dense = nullptr;
+    if constexpr ((Storage & kDenseStorage) != 0) {
+      dense = &self.fPerThreadDense_m[slot];
+      dense->place();
+    } else if constexpr ((Storage & kDeviceStorage) == 0) {
+      dense = self.fPerThreadPromoted_m[slot].get();
+    }
+    if (dense) {
+      const Double_t x[5] = {channel, controlRegion, sampleCategory, 0.0, value};
+      Int_t lastAxisBin = -1;
+      if constexpr ((Storage & (kBinnedValue | kVariableValue)) != 0) {
+        lastAxisBin = self.valueBin<Storage>(value);
       }
-      // Convert dense result to sparse: iterate all inner bins and copy non-zero ones
-      const Long64_t totalBins = fPerThreadDense_m[0]->GetNbins();
-      std::vector<Int_t> idxBuf(dim_m);
-      std::vector<Double_t> coordBuf(dim_m);
-      for (Long64_t bin = 0; bin < totalBins; ++bin) {
-        const Double_t content = fPerThreadDense_m[0]->GetBinContent(bin, idxBuf.data());
-        if (content == 0.0) continue;
-        // Skip overflow/underflow bins
-        bool isOverflow = false;
-        for (int d = 0; d < dim_m; ++d) {
-          if (idxBuf[d] == 0 || idxBuf[d] > fPerThreadDense_m[0]->GetAxis(d)->GetNbins()) {
-            isOverflow = true;
-            break;
-          }
-        }
-        if (isOverflow) continue;
-        for (int d = 0; d < dim_m; ++d) {
-          coordBuf[d] = fPerThreadDense_m[0]->GetAxis(d)->GetBinCenter(idxBuf[d]);
+      dense->fillAxisRun(x, 3, lastAxisBin, weights.data(), weights.size());
+    } else if constexpr ((Storage & kDeviceStorage) != 0) {
+      const Double_t x[5] = {channel, controlRegion, sampleCategory, 0.0, value};
+      Int_t lastAxisBin = -1;
+      if constexpr ((Storage & (kBinnedValue | kVariableValue)) != 0) {
+        lastAxisBin = self.valueBin<Storage>(value);
+      }
+      const FlatHistAccumulator &index = *self.deviceIndex_m;
+      const std::size_t first = index.findAxisRunBin(x, 3, lastAxisBin);
+      const std::size_t step = index.stride(3);
+      const std::size_t n =
+          std::min(weights.size(), static_cast<std::size_t>(self.nbins_m[3]));
+      for (std::size_t i = 0; i < n; ++i) {
+        if (weights[i] != 0.0f) {
+          self.stageFill(slot, first + i * step, weights[i]);
         }
-        Long64_t sparseBin = fFinalResult->GetBin(coordBuf.data(), true);
-        fFinalResult->SetBinContent(sparseBin, content);
-        fFinalResult->SetBinError(sparseBin, fPerThreadDense_m[0]->GetBinError(bin));
       }
     } else {
-      for (auto hist : fPerThreadResults) {
-        fFinalResult->Add(hist.get());
+      const std::size_t n =
+          std::min(weights.size(), static_cast<std::size_t>(self.nbins_m[3]));
+      for (std::size_t i = 0; i < n; ++i) {
+        if (weights[i] != 0.0f) {
+          self.fillBin<Storage>(slot, channel, controlRegion, sampleCategory,
+                                static_cast<Double_t>(i), value, weights[i]);
+        }
       }
     }
   }
 
-  /**
-   * @brief Get the name of this action for RDataFrame
-   * @return Action name string
-   */
-  std::string GetActionName() const { return "THnMulti"; }
-
-private:
-  void LogSizes(const char* reason,
-                unsigned int slot,
-                const ROOT::VecOps::RVec<Float_t> &baseHistogramValues,
-                const ROOT::VecOps::RVec<Float_t> &baseHistogramWeights,
-                const ROOT::VecOps::RVec<Float_t> &systematicVariation,
-                const ROOT::VecOps::RVec<Float_t> &sampleCategory,
-                const ROOT::VecOps::RVec<Float_t> &controlRegion,
-                const ROOT::VecOps::RVec<Float_t> &channel,
-                const ROOT::VecOps::RVec<Int_t> &nFills) const {
-    static const bool enabled = (std::getenv("RDF_NDHIST_DEBUG") != nullptr);
-    if (!enabled) {
-      return;
-    }
-    std::cerr << "[THnMulti] " << reason
-              << " slot=" << slot
-              << " baseVals=" << baseHistogramValues.size()
-              << " baseWts=" << baseHistogramWeights.size()
-              << " syst=" << systematicVariation.size()
-              << " sampleCat=" << sampleCategory.size()
-              << " control=" << controlRegion.size()
-              << " channel=" << channel.size()
-              << " nFills=" << nFills.size()
-              << std::endl;
+  template <std::size_t... I>
+  static constexpr std::array<WeightVectorKernelType, sizeof...(I)>
+  makeWeightVectorKernels(std::index_sequence<I...>) {
+    return {{&weightVectorKernel<storageBits(static_cast<unsigned>(I))>...}};
   }
 
-  /// Fill one bin in the sparse per-thread accumulator.
-  void fillHistSparse_(unsigned int slot, Double_t ch, Double_t cr, Double_t sc,
-                       Double_t sv, Double_t bv, Double_t w) {
-    fPerThreadResults[slot]->Fill(ch, cr, sc, sv, bv, w);
+  /// Weight-vector kernel for the @p storage bits.
+  static WeightVectorKernelType selectWeightVectorKernel(unsigned storage) {
+    static constexpr std::array<WeightVectorKernelType, kStorageKinds> kernels =
+        makeWeightVectorKernels(std::make_index_sequence<kStorageKinds>{});
+    return kernels[storageIndex(storage)];
   }
 
-  /// Fill one bin in the dense per-thread accumulator (faster: O(1) direct array indexing).
-  void fillHistDense_(unsigned int slot, Double_t ch, Double_t cr, Double_t sc,
-                      Double_t sv, Double_t bv, Double_t w) {
-    fPerThreadDense_m[slot]->Fill(ch, cr, sc, sv, bv, w);
+  /// Kernel for the layout @p flags and the @p storage bits.
+  static KernelType selectKernel(unsigned flags, unsigned storage) {
+    static constexpr std::array<KernelType, kStorageKinds * THnFill::kLayouts> kernels =
+        makeKernels(std::make_index_sequence<kStorageKinds * THnFill::kLayouts>{});
+    return kernels[kStorageKinds * THnFill::canonical(flags) + storageIndex(storage)];
   }
 
   /** @brief Shared pointer to the final merged THnSparseD result. */
   std::shared_ptr<THnSparseF> fFinalResult = std::make_shared<THnSparseF>();
   /** @brief Vector of per-thread THnSparseF histogram pointers (used when useDense_m == false). */
   std::vector<std::shared_ptr<THnSparseF>> fPerThreadResults;
-  /** @brief Vector of per-thread THnF histogram pointers (used when useDense_m == true). */
-  std::vector<std::shared_ptr<THnF>> fPerThreadDense_m;
-  /** @brief True when dense (THnF) per-thread accumulators are used instead of sparse. */
+  /** @brief Per-thread flat-array accumulators (used when useDense_m == true). */
+  std::vector<FlatHistAccumulator> fPerThreadDense_m;
+  /** @brief Flat arrays of the promoted sparse slots; nullptr while a slot is sparse. */
+  std::vector<std::unique_ptr<FlatHistAccumulator>> fPerThreadPromoted_m;
+  /** @brief Per-thread copies of the dense accumulators handed out by PartialUpdate(). */
+  std::vector<std::shared_ptr<THnSparseF>> fPerThreadPartial_m;
+  /** @brief True when dense (flat-array) per-thread accumulators are used instead of sparse. */
   bool useDense_m = false;
+  /** @brief Per-thread fills staged for the device storage (used with deviceSink_m). */
+  std::vector<DeviceStage> fPerThreadStage_m;
+  /** @brief Bin indexing of the device storage; never placed. */
+  std::unique_ptr<FlatHistAccumulator> deviceIndex_m;
   /** @brief Number of threads/slots. */
   const unsigned int nSlots_m;
   /** @brief Number of dimensions. */
@@ -541,26 +1609,47 @@ private:
 
   const std::string name_m;
   const std::string title_m;
-  
-  const Bool_t channel_hasSystematic_m;
-  const Bool_t controlRegion_hasSystematic_m;
-  const Bool_t sampleCategory_hasSystematic_m;
-  const Bool_t weight_hasSystematic_m;
-  const Bool_t hasSystematic_m;
-
-  const Bool_t channel_hasMultiFill_m;
-  const Bool_t controlRegion_hasMultiFill_m;
-  const Bool_t sampleCategory_hasMultiFill_m;
-  const Bool_t systematic_hasMultiFill_m;
-  const Bool_t weight_hasMultiFill_m;
-  const Bool_t hasMultiFill_m;
-  
-  // Pointer to the per-bin fill helper (sparse or dense path), set once in constructor.
-  using FillHistFuncType = void (THnMulti::*)(unsigned int, Double_t, Double_t, Double_t, Double_t, Double_t, Double_t);
-  FillHistFuncType fillHistFunc_ = nullptr;
 
-  // Pointer to the selected fill function for fast path dispatch
-  FillFuncType fillFunc_ = nullptr;
+  /** @brief Canonical THnFill layout. */
+  const unsigned fillFlags_m;
+  /** @brief Base values are value-axis bin indices (histFillInfo::value_isBinIndex). */
+  const bool valueIsBinIndex_m;
+  /** @brief The systematic axis holds weight-vector entries (histFillInfo::weightVector). */
+  const bool weightVector_m;
+  /** @brief Lookup of a variable-width value axis (histFillInfo::valueEdges). */
+  const VariableAxisLookup valueAxis_m;
+  /** @brief Coordinate inside each value-axis bin, for sparse fills from bin indices. */
+  std::vector<Double_t> valueBinCoordinates_m;
+
+  /** @brief Fill kernel specialized on the layout and storage, set once in constructor. */
+  KernelType fillKernel_m = nullptr;
+  /** @brief Kernel of the scalar Exec() for the same storage. */
+  ScalarKernelType scalarKernel_m = nullptr;
+  /** @brief Kernel of the weight-vector Exec() for the same storage. */
+  WeightVectorKernelType weightVectorKernel_m = nullptr;
+
+  /** @brief Report written at Finalize(), or nullptr (histFillInfo::memoryReport). */
+  std::shared_ptr<HistMemoryReport> memoryReport_m;
+  /** @brief Device storage the fills are streamed to, or nullptr (histFillInfo::deviceSink). */
+  std::shared_ptr<HistDeviceSink> deviceSink_m;
+  /** @brief Filled channel x systematic cells (histFillInfo::cellMask); empty = all. */
+  const std::vector<std::uint8_t> cellMask_m;
+  /** @brief Estimated bytes per filled bin of a sparse slot accumulator. */
+  std::size_t bytesPerSparseBin_m = 0;
+  /** @brief Filled bins above which a sparse slot is flushed; 0 = no ceiling. */
+  Long64_t maxSlotBins_m = 0;
+  /** @brief Filled bins at which a sparse slot is promoted; 0 = never (densePromotionBins()). */
+  Long64_t promoteBins_m = 0;
+  /** @brief Most bins each sparse slot held before a flush. */
+  std::vector<Long64_t> peakSlotBins_m;
+  /** @brief Number of slot flushes into the result. */
+  std::size_t flushes_m = 0;
+  /** @brief Serializes slot flushes into the shared result. */
+  std::unique_ptr<std::mutex> flushMutex_m = std::make_unique<std::mutex>();
+  /** @brief On-disk runs slots are flushed to instead (histFillInfo::spillDirectory), or nullptr. */
+  std::unique_ptr<HistSpillRuns> spill_m;
+  /** @brief Entries of the bins each slot spilled. */
+  std::vector<Double_t> spilledEntries_m;
 };
 
 /**
@@ -580,9 +1669,18 @@ private:
  *   memory.  Selected when the dense estimate exceeds the threshold.
  *   Requires Boost >= 1.76; on older Boost only dense storage is available.
  *
+ * Single-bin axes (unused channel, control-region or sample-category axes, and
+ * the systematic axis without systematics) are collapsed: when at most three
+ * axes have more than one bin, the per-thread accumulator is a 1D, 2D or 3D
+ * histogram with static regular axes and weighted storage, so bin lookup is
+ * fully inlined.  Fills whose collapsed coordinates fall outside the single
+ * bin are dropped, exactly as the 5D under/overflow bins are dropped when
+ * converting the result.
+ *
  * The final result is always a sparse THnSparseF.
  *
- * Select this backend by setting histogramBackend=boost in the configuration.
+ * Select this backend by setting histogramBackend=boost in the configuration,
+ * or backend=boost on an individual histogram config entry.
  */
 class BHnMulti : public ROOT::Detail::RDF::RActionImpl<BHnMulti> {
 public:
@@ -598,6 +1696,20 @@ public:
       boost::histogram::axis::regular<>(1, 0.0, 1.0),
       boost::histogram::axis::regular<>(1, 0.0, 1.0)));
 
+  // Reduced-rank dense histograms used when single-bin axes are collapsed.
+  using BH1DDense = decltype(boost::histogram::make_histogram_with(
+      boost::histogram::weight_storage(),
+      boost::histogram::axis::regular<>(1, 0.0, 1.0)));
+  using BH2DDense = decltype(boost::histogram::make_histogram_with(
+      boost::histogram::weight_storage(),
+      boost::histogram::axis::regular<>(1, 0.0, 1.0),
+      boost::histogram::axis::regular<>(1, 0.0, 1.0)));
+  using BH3DDense = decltype(boost::histogram::make_histogram_with(
+      boost::histogram::weight_storage(),
+      boost::histogram::axis::regular<>(1, 0.0, 1.0),
+      boost::histogram::axis::regular<>(1, 0.0, 1.0),
+      boost::histogram::axis::regular<>(1, 0.0, 1.0)));
+
 #if BOOST_VERSION >= 107600
   // Boost 1.76+: sparse_storage<weighted_sum<>> available (hash-based, memory-proportional to filled bins)
   using BH5DSparse = decltype(boost::histogram::make_histogram_with(
@@ -607,13 +1719,20 @@ public:
       boost::histogram::axis::regular<>(1, 0.0, 1.0),
       boost::histogram::axis::regular<>(1, 0.0, 1.0),
       boost::histogram::axis::regular<>(1, 0.0, 1.0)));
-  /// Storage type: variant of dense and sparse per-thread histogram vectors.
-  using BHStorage = std::variant<std::vector<BH5DDense>, std::vector<BH5DSparse>>;
+  /// Storage type: variant of dense, sparse and reduced-rank per-thread histogram vectors.
+  using BHStorage = std::variant<std::vector<BH5DDense>, std::vector<BH5DSparse>,
+                                 std::vector<BH1DDense>, std::vector<BH2DDense>,
+                                 std::vector<BH3DDense>>;
 #else
-  /// Storage type: only dense is available on Boost < 1.76 (no sparse_storage).
-  using BHStorage = std::vector<BH5DDense>;
+  /// Storage type: only dense storage is available on Boost < 1.76 (no sparse_storage).
+  using BHStorage = std::variant<std::vector<BH5DDense>,
+                                 std::vector<BH1DDense>, std::vector<BH2DDense>,
+                                 std::vector<BH3DDense>>;
 #endif
 
+  /// Number of axes of the full (uncollapsed) histogram.
+  static constexpr std::size_t kFullRank = 5;
+
   // Define a function pointer type for fill functions (same signature as THnMulti)
   using FillFuncType = void (BHnMulti::*)(unsigned int,
     const ROOT::VecOps::RVec<Float_t>&, const ROOT::VecOps::RVec<Float_t>&,
@@ -636,54 +1755,86 @@ public:
 
     namespace bh = boost::histogram;
 
-#if BOOST_VERSION >= 107600
-    // On Boost 1.76+, choose storage based on estimated dense memory usage:
-    // weight_storage (dense) when it fits within the threshold; sparse_storage<weighted_sum<>>
-    // otherwise.  Dense gives O(1) fills; sparse uses memory proportional to filled bins only.
-    const bool useSparse = estimateDenseMemoryBytes(nbins_m, nSlots_m, 16) > kDenseMemoryThresholdBytes;
-    if (!useSparse) {
-      auto& denseVec = fPerThreadHists.emplace<std::vector<BH5DDense>>();
-      denseVec.reserve(nSlots_m);
-      for (unsigned int i = 0; i < nSlots_m; i++) {
-        denseVec.push_back(bh::make_histogram_with(
-            bh::weight_storage(),
-            bh::axis::regular<>(nbins_m[0], xmin_m[0], xmax_m[0]),
-            bh::axis::regular<>(nbins_m[1], xmin_m[1], xmax_m[1]),
-            bh::axis::regular<>(nbins_m[2], xmin_m[2], xmax_m[2]),
-            bh::axis::regular<>(nbins_m[3], xmin_m[3], xmax_m[3]),
-            bh::axis::regular<>(nbins_m[4], xmin_m[4], xmax_m[4])));
+    // Collapse single-bin axes.  The value axis (last) is always kept.
+    std::vector<Int_t> activeNbins;
+    for (std::size_t d = 0; d < kFullRank; d++) {
+      if (nbins_m[d] > 1 || d + 1 == kFullRank) {
+        activeAxes_m[activeRank_m++] = d;
+        activeNbins.push_back(nbins_m[d]);
+      } else {
+        collapsedAxes_m[collapsedRank_m++] = d;
+      }
+    }
+    const auto regularAxis = [this](std::size_t d) {
+      return bh::axis::regular<>(nbins_m[d], xmin_m[d], xmax_m[d]);
+    };
+
+    if (activeRank_m <= 3 &&
+        estimateDenseMemoryBytes(activeNbins, nSlots_m, 16) <= kDenseMemoryThresholdBytes) {
+      const auto* a = activeAxes_m.data();
+      if (activeRank_m == 1) {
+        auto& vec = fPerThreadHists.emplace<std::vector<BH1DDense>>();
+        for (unsigned int i = 0; i < nSlots_m; i++) {
+          vec.push_back(bh::make_histogram_with(bh::weight_storage(), regularAxis(a[0])));
+        }
+      } else if (activeRank_m == 2) {
+        auto& vec = fPerThreadHists.emplace<std::vector<BH2DDense>>();
+        for (unsigned int i = 0; i < nSlots_m; i++) {
+          vec.push_back(bh::make_histogram_with(bh::weight_storage(),
+                                                regularAxis(a[0]), regularAxis(a[1])));
+        }
+      } else {
+        auto& vec = fPerThreadHists.emplace<std::vector<BH3DDense>>();
+        for (unsigned int i = 0; i < nSlots_m; i++) {
+          vec.push_back(bh::make_histogram_with(bh::weight_storage(), regularAxis(a[0]),
+                                                regularAxis(a[1]), regularAxis(a[2])));
+        }
       }
     } else {
-      auto& sparseVec = fPerThreadHists.emplace<std::vector<BH5DSparse>>();
-      sparseVec.reserve(nSlots_m);
-      for (unsigned int i = 0; i < nSlots_m; i++) {
-        sparseVec.push_back(bh::make_histogram_with(
-            bh::sparse_storage<bh::accumulators::weighted_sum<>>(),
-            bh::axis::regular<>(nbins_m[0], xmin_m[0], xmax_m[0]),
-            bh::axis::regular<>(nbins_m[1], xmin_m[1], xmax_m[1]),
-            bh::axis::regular<>(nbins_m[2], xmin_m[2], xmax_m[2]),
-            bh::axis::regular<>(nbins_m[3], xmin_m[3], xmax_m[3]),
-            bh::axis::regular<>(nbins_m[4], xmin_m[4], xmax_m[4])));
+      // Keep all five axes: no collapsing.
+      activeRank_m = kFullRank;
+      collapsedRank_m = 0;
+      for (std::size_t d = 0; d < kFullRank; d++) {
+        activeAxes_m[d] = d;
       }
-    }
+
+#if BOOST_VERSION >= 107600
+      // On Boost 1.76+, choose storage based on estimated dense memory usage:
+      // weight_storage (dense) when it fits within the threshold; sparse_storage<weighted_sum<>>
+      // otherwise.  Dense gives O(1) fills; sparse uses memory proportional to filled bins only.
+      const bool useSparse = estimateDenseMemoryBytes(nbins_m, nSlots_m, 16) > kDenseMemoryThresholdBytes;
 #else
-    // Boost < 1.76: sparse_storage not available; always use weight_storage (dense).
-    fPerThreadHists.reserve(nSlots_m);
-    for (unsigned int i = 0; i < nSlots_m; i++) {
-      fPerThreadHists.push_back(bh::make_histogram_with(
-          bh::weight_storage(),
-          bh::axis::regular<>(nbins_m[0], xmin_m[0], xmax_m[0]),
-          bh::axis::regular<>(nbins_m[1], xmin_m[1], xmax_m[1]),
-          bh::axis::regular<>(nbins_m[2], xmin_m[2], xmax_m[2]),
-          bh::axis::regular<>(nbins_m[3], xmin_m[3], xmax_m[3]),
-          bh::axis::regular<>(nbins_m[4], xmin_m[4], xmax_m[4])));
-    }
+      // Boost < 1.76: sparse_storage not available; always use weight_storage (dense).
+      const bool useSparse = false;
+#endif
+      if (!useSparse) {
+        auto& denseVec = fPerThreadHists.emplace<std::vector<BH5DDense>>();
+        denseVec.reserve(nSlots_m);
+        for (unsigned int i = 0; i < nSlots_m; i++) {
+          denseVec.push_back(bh::make_histogram_with(
+              bh::weight_storage(), regularAxis(0), regularAxis(1), regularAxis(2),
+              regularAxis(3), regularAxis(4)));
+        }
+      }
+#if BOOST_VERSION >= 107600
+      else {
+        auto& sparseVec = fPerThreadHists.emplace<std::vector<BH5DSparse>>();
+        sparseVec.reserve(nSlots_m);
+        for (unsigned int i = 0; i < nSlots_m; i++) {
+          sparseVec.push_back(bh::make_histogram_with(
+              bh::sparse_storage<bh::accumulators::weighted_sum<>>(),
+              regularAxis(0), regularAxis(1), regularAxis(2), regularAxis(3),
+              regularAxis(4)));
+        }
+      }
 #endif
+    }
 
     fFinalResult = std::make_shared<THnSparseF>(
         name_m.c_str(), title_m.c_str(), dim_m,
         nbins_m.data(), xmin_m.data(), xmax_m.data());
     fFinalResult->Sumw2();
+    fPerThreadPartial_m.resize(nSlots_m);
 
     // Select fill function fast path (same logic as THnMulti)
     if (!channel_hasSystematic_m && !controlRegion_hasSystematic_m && !sampleCategory_hasSystematic_m && !weight_hasSystematic_m && !systematic_hasMultiFill_m &&
@@ -727,6 +1878,36 @@ public:
                        systematicVariation, sampleCategory, controlRegion, channel, nFills);
   }
 
+  /**
+   * @brief Fill one nominal entry from scalar columns (see THnMulti's
+   *        scalar Exec()).
+   */
+  void Exec(unsigned int slot, Float_t baseHistogramValue, Float_t baseHistogramWeight,
+            Float_t sampleCategory, Float_t controlRegion, Float_t channel) {
+    if (baseHistogramWeight != 0.0f) {
+      fillHist_(slot, static_cast<double>(baseHistogramWeight), static_cast<double>(channel),
+                static_cast<double>(controlRegion), static_cast<double>(sampleCategory), 0.0,
+                static_cast<double>(baseHistogramValue));
+    }
+  }
+
+  /**
+   * @brief Fill one entry with a vector of weights, weight i on systematic
+   *        bin i + 1 (see THnMulti's weight-vector Exec()).
+   */
+  void Exec(unsigned int slot, Float_t baseHistogramValue,
+            const ROOT::VecOps::RVec<Float_t> &__restrict__ baseHistogramWeights,
+            Float_t sampleCategory, Float_t controlRegion, Float_t channel) {
+    for (std::size_t i = 0; i < baseHistogramWeights.size(); ++i) {
+      if (baseHistogramWeights[i] != 0.0f) {
+        fillHist_(slot, static_cast<double>(baseHistogramWeights[i]),
+                  static_cast<double>(channel), static_cast<double>(controlRegion),
+                  static_cast<double>(sampleCategory), static_cast<double>(i),
+                  static_cast<double>(baseHistogramValue));
+      }
+    }
+  }
+
   void SingleNoSystematicFill(unsigned int slot,
     const ROOT::VecOps::RVec<Float_t> &__restrict__ baseHistogramValues,
     const ROOT::VecOps::RVec<Float_t> &__restrict__ baseHistogramWeights,
@@ -883,72 +2064,118 @@ public:
   /**
    * @brief Merge per-thread Boost histograms and convert to THnSparseF.
    *
-   * On Boost >= 1.76, dispatches via std::visit to handle both dense (weight_storage)
-   * and sparse (sparse_storage<weighted_sum<>>) per-thread accumulators.
-   * Only bins with non-zero content are written to the result, keeping the output sparse.
+   * Dispatches via std::visit over the dense, sparse (Boost >= 1.76) and
+   * reduced-rank per-thread accumulators.  Collapsed axes are mapped back to
+   * their single bin.  Only bins with non-zero content are written to the
+   * result, keeping the output sparse.
    */
   void Finalize() {
-    namespace bh = boost::histogram;
-
-    auto doFinalize = [&](auto& hists) {
+    std::visit([&](auto& hists) {
       if (hists.empty()) return;
 
-      // Merge all per-thread histograms into the first one
-      auto& merged = hists[0];
-      for (size_t slot = 1; slot < hists.size(); slot++) {
-        merged += hists[slot];
-      }
+      // Tree-reduce all per-thread histograms into the first one
+      using Hist = typename std::decay_t<decltype(hists)>::value_type;
+      treeReduceSlots(hists, [](Hist& into, Hist& from) { into += from; });
+      writeHist_(hists[0], *fFinalResult);
+    }, fPerThreadHists);
+  }
 
-      // Convert to THnSparseF: iterate only filled (inner) bins
-      for (auto&& x : bh::indexed(merged, bh::coverage::inner)) {
-        const auto& w = *x;
-        const double content = w.value();
-        const double variance = w.variance();
-        if (content == 0.0 && variance == 0.0) {
-          continue;  // skip empty bins — sparse output
-        }
+  /**
+   * @brief Slot histogram so far, for RResultPtr::OnPartialResultSlot().
+   *
+   * The slot's Boost histogram is converted into a per-slot THnSparseF,
+   * which is only allocated on first use.
+   */
+  THnSparseF &PartialUpdate(unsigned int slot) {
+    auto &partial = fPerThreadPartial_m[slot];
+    if (!partial) {
+      partial = std::make_shared<THnSparseF>(
+          (name_m + "_" + std::to_string(slot)).c_str(), title_m.c_str(), dim_m,
+          nbins_m.data(), xmin_m.data(), xmax_m.data());
+      partial->Sumw2();
+    } else {
+      partial->Reset();
+    }
+    std::visit([&](auto& hists) { writeHist_(hists[slot], *partial); }, fPerThreadHists);
+    return *partial;
+  }
 
-        // Compute bin-centre coordinates for each axis
-        std::vector<Double_t> coords(dim_m);
-        for (int d = 0; d < dim_m; d++) {
-          coords[d] = merged.axis(d).bin(x.index(d)).center();
-        }
+  std::string GetActionName() const { return "BHnMulti"; }
 
-        // Create bin in THnSparseF and set content/error
-        Long64_t globalBin = fFinalResult->GetBin(coords.data(), true);
-        fFinalResult->SetBinContent(globalBin, content);
-        fFinalResult->SetBinError2(globalBin, variance);
+private:
+  /// Write the filled in-range bins of @p hist to @p target.
+  template <typename Hist>
+  void writeHist_(const Hist& hist, THnSparseF& target) const {
+    namespace bh = boost::histogram;
+
+    // Collapsed axes always map to the centre of their single bin.
+    std::vector<Double_t> coords(dim_m);
+    for (std::size_t c = 0; c < collapsedRank_m; c++) {
+      const std::size_t d = collapsedAxes_m[c];
+      coords[d] = 0.5 * (xmin_m[d] + xmax_m[d]);
+    }
+
+    // Convert to THnSparseF: iterate only filled (inner) bins
+    for (auto&& x : bh::indexed(hist, bh::coverage::inner)) {
+      const auto& w = *x;
+      const double content = w.value();
+      const double variance = w.variance();
+      if (content == 0.0 && variance == 0.0) {
+        continue;  // skip empty bins — sparse output
       }
-    };
 
-#if BOOST_VERSION >= 107600
-    std::visit(doFinalize, fPerThreadHists);
-#else
-    doFinalize(fPerThreadHists);
-#endif
+      // Compute bin-centre coordinates for each kept axis
+      for (std::size_t r = 0; r < activeRank_m; r++) {
+        coords[activeAxes_m[r]] = hist.axis(r).bin(x.index(r)).center();
+      }
+
+      // Create bin in THnSparseF and set content/error
+      Long64_t globalBin = target.GetBin(coords.data(), true);
+      target.SetBinContent(globalBin, content);
+      target.SetBinError2(globalBin, variance);
+    }
   }
 
-  std::string GetActionName() const { return "BHnMulti"; }
+  /// Fill a histogram with static axes using the coordinates of its kept axes.
+  template <typename Hist, std::size_t... I>
+  void fillStatic_(Hist& hist, double weight, const double* x,
+                   std::index_sequence<I...>) const {
+    hist(boost::histogram::weight(weight), x[activeAxes_m[I]]...);
+  }
 
-private:
-  /// Fill one bin in the per-thread Boost histogram (dispatches via std::visit on Boost >= 1.76).
+  /// Fill one bin in the per-thread Boost histogram (dispatches via std::visit).
   void fillHist_(unsigned int slot, double weight,
                  double ch, double cr, double sc, double sv, double bv) {
-#if BOOST_VERSION >= 107600
+    const double x[kFullRank] = {ch, cr, sc, sv, bv};
+    // A collapsed axis only has its single in-range bin: anything else would
+    // land in 5D under/overflow, which the conversion to THnSparseF drops.
+    for (std::size_t c = 0; c < collapsedRank_m; c++) {
+      const std::size_t d = collapsedAxes_m[c];
+      if (!(x[d] >= xmin_m[d] && x[d] < xmax_m[d])) return;
+    }
     std::visit([&](auto& hists) {
-      hists[slot](boost::histogram::weight(weight), ch, cr, sc, sv, bv);
+      using Hist = typename std::decay_t<decltype(hists)>::value_type;
+      constexpr std::size_t rank =
+          std::tuple_size<std::decay_t<typename Hist::axes_type>>::value;
+      fillStatic_(hists[slot], weight, x, std::make_index_sequence<rank>{});
     }, fPerThreadHists);
-#else
-    fPerThreadHists[slot](boost::histogram::weight(weight), ch, cr, sc, sv, bv);
-#endif
   }
 
   std::shared_ptr<THnSparseF> fFinalResult = std::make_shared<THnSparseF>();
   /// Per-thread Boost histograms.
-  /// On Boost >= 1.76: variant of dense (weight_storage) or sparse (sparse_storage<weighted_sum<>>)
-  /// selected automatically at construction based on estimated memory usage.
-  /// On Boost < 1.76: always dense (weight_storage).  Output is always THnSparseF.
+  /// Reduced-rank dense (1D/2D/3D) when at most three axes have more than one
+  /// bin; otherwise 5D dense (weight_storage) or, on Boost >= 1.76, sparse
+  /// (sparse_storage<weighted_sum<>>) selected from the estimated memory usage.
+  /// Output is always THnSparseF.
   BHStorage fPerThreadHists;
+  /// Per-thread conversions handed out by PartialUpdate().
+  std::vector<std::shared_ptr<THnSparseF>> fPerThreadPartial_m;
+  /// Full-histogram axis index of each axis kept in fPerThreadHists.
+  std::array<std::size_t, kFullRank> activeAxes_m{};
+  /// Full-histogram axis index of each collapsed single-bin axis.
+  std::array<std::size_t, kFullRank> collapsedAxes_m{};
+  std::size_t activeRank_m = 0;
+  std::size_t collapsedRank_m = 0;
 
   const unsigned int nSlots_m;
   const Int_t dim_m;
@@ -994,11 +2221,36 @@ public:
    * @param bins Number of bins.
    * @param lowerBound Lower bound of the histogram.
    * @param upperBound Upper bound of the histogram.
+   * @param backend Histogram backend ("root", "boost" or "gpu"); empty uses the
+   *                manager-wide histogramBackend.
+   */
+  histInfo(const char name[], const char variable[], const char label[],
+           const char weight[], int bins, float lowerBound, float upperBound,
+           const std::string &backend = "")
+      : name_m(name), variable_m(variable), label_m(label), weight_m(weight),
+        bins_m(bins), lowerBound_m(lowerBound), upperBound_m(upperBound),
+        backend_m(backend) {}
+
+  /**
+   * @brief Construct a histInfo with a variable-width value axis.
+   * @param binEdges Strictly increasing bin edges (at least two); bins(),
+   *                 lowerBound() and upperBound() follow from them.
+   * @param backend  Histogram backend; variable-width axes need "root".
+   * @throws std::runtime_error if fewer than two edges are given.
    */
   histInfo(const char name[], const char variable[], const char label[],
-           const char weight[], int bins, float lowerBound, float upperBound)
+           const char weight[], const std::vector<float> &binEdges,
+           const std::string &backend = "")
       : name_m(name), variable_m(variable), label_m(label), weight_m(weight),
-        bins_m(bins), lowerBound_m(lowerBound), upperBound_m(upperBound) {}
+        bins_m(static_cast<int>(binEdges.size()) - 1),
+        lowerBound_m(binEdges.empty() ? 0.f : binEdges.front()),
+        upperBound_m(binEdges.empty() ? 0.f : binEdges.back()), backend_m(backend),
+        binEdges_m(binEdges) {
+    if (binEdges_m.size() < 2) {
+      throw std::runtime_error("histInfo: histogram '" + name_m +
+                               "' needs at least two bin edges.");
+    }
+  }
 
   /**
    * @brief Get the name of the histogram.
@@ -1042,6 +2294,18 @@ public:
    */
   constexpr const float &upperBound() const { return (upperBound_m); }
 
+  /**
+   * @brief Get the per-histogram backend override.
+   * @return Reference to the backend string (empty if not overridden).
+   */
+  const std::string &backend() const { return (backend_m); }
+
+  /**
+   * @brief Get the bin edges of a variable-width value axis.
+   * @return Reference to the edges (empty for uniform bins).
+   */
+  const std::vector<float> &binEdges() const { return (binEdges_m); }
+
 private:
   /** @brief Name of the histogram. */
   const std::string name_m;
@@ -1057,6 +2321,10 @@ private:
   const float lowerBound_m;
   /** @brief Upper bound of the histogram. */
   const float upperBound_m;
+  /** @brief Backend override ("root", "boost", "gpu" or empty). */
+  const std::string backend_m;
+  /** @brief Variable-width bin edges (empty for uniform bins). */
+  const std::vector<float> binEdges_m;
 };
 
 /**
@@ -84,13 +84,48 @@ std::vector<FriendTreeSpec>
 parseFriendTreeConfig(const std::string &configFile);
 
 /**
- * @brief Scan a directory for ROOT files matching globs and add them to a
- * TChain.
+ * @brief Write @p specs as a friend-tree YAML config readable by
+ *        parseFriendTreeConfig().
+ *
+ * Only explicit file lists are written; ``directory``, ``globs`` and
+ * ``antiglobs`` are ignored.
+ *
+ * @throws std::runtime_error if the file cannot be written.
+ */
+void writeFriendTreeConfig(const std::string &configFile,
+                           const std::vector<FriendTreeSpec> &specs);
+
+/**
+ * @brief Find the ROOT files below a directory that match the globs.
+ *
+ * Subdirectories of one depth are listed concurrently by up to @p threads
+ * workers, and the result is sorted per directory so it does not depend on
+ * scheduling.  When @p cacheDirectory is set, the list is stored there keyed
+ * by directory and glob set and reused while no visited directory has a new
+ * modification time.
+ *
+ * @param directory Top-level directory
+ * @param globs List of substrings to match (include)
+ * @param antiglobs List of substrings to exclude
+ * @param threads Maximum number of concurrent directory listings
+ * @param cacheDirectory Directory of the file-list cache (empty disables it)
+ * @return Matching file paths
+ */
+std::vector<std::string>
+discoverRootFiles(const std::string &directory,
+                  const std::vector<std::string> &globs,
+                  const std::vector<std::string> &antiglobs,
+                  unsigned int threads = 8,
+                  const std::string &cacheDirectory = "");
+
+/**
+ * @brief Scan a directory tree for ROOT files matching globs and add them to
+ * a TChain.
  * @param chain TChain to add files to
  * @param directory Directory to scan
  * @param globs List of substrings to match (include)
  * @param antiglobs List of substrings to exclude
- * @param base If true, only scan the top-level directory
+ * @param base If true, warn when no file is found
  * @return Number of files found and added
  */
 int scan(TChain &chain, const std::string &directory,
@@ -109,6 +144,51 @@ int scan(TChain &chain, const std::string &directory,
 std::vector<std::unique_ptr<TChain>>
 makeTChain(const IConfigurationProvider &configProvider);
 
+/**
+ * @brief Return the file names added to a TChain, in chain order.
+ * @param chain TChain to inspect
+ * @return Vector of file names (local paths or URLs)
+ */
+std::vector<std::string> getChainFileNames(const TChain &chain);
+
+/**
+ * @brief Apply the read-ahead configuration to an input chain.
+ *
+ * Optional config keys (ROOT defaults when absent):
+ *   - ``treeCacheSize``: TTreeCache size in bytes for @p chain.
+ *   - ``treeCacheSizeFactor``: ``TTreeCache.Size`` factor, which sizes the
+ *     per-task caches that RDataFrame creates under ImplicitMT.
+ *   - ``treeCacheLearnEntries``: entries read before the cache fixes its
+ *     branch set (global TTreeCache setting).
+ *   - ``treeCachePrefetch``: enable asynchronous prefetching of the next
+ *     cache block (``TFile.AsyncPrefetching``).
+ *   - ``asyncOpenFiles``: number of chain files whose open is started
+ *     asynchronously (TFile::AsyncOpen) so remote opens overlap.
+ *
+ * @param configProvider Configuration provider with the keys above
+ * @param chain Chain to configure
+ * @param openAhead Whether to issue the asynchronous opens for this chain
+ */
+void configureTreeReadAhead(const IConfigurationProvider &configProvider,
+                            TChain &chain, bool openAhead);
+
+/**
+ * @brief Decide whether the input files hold RNTuples instead of TTrees.
+ *
+ * Controlled by the ``inputFormat`` config key:
+ *   - ``ttree`` (default): TTree input.
+ *   - ``rntuple``: RNTuple input.
+ *   - ``auto``: open the first file of @p chain and inspect the class of the
+ *     object named like the chain.
+ *
+ * @param configProvider Configuration provider containing ``inputFormat``
+ * @param chain Main input chain (provides the object name and file list)
+ * @return true for RNTuple input
+ * @throws std::runtime_error for an unknown ``inputFormat`` value
+ */
+bool isRNTupleInput(const IConfigurationProvider &configProvider,
+                    const TChain &chain);
+
 void save(std::vector<std::vector<histInfo>> &fullHistList,
           const histHolder &hists,
           const std::vector<std::vector<std::string>> &allRegionNames,
@@ -1,10 +1,247 @@
 #include <BDTManager.h>
+#include <AsyncLogger.h>
+#include <ModelOutputVariations.h>
+#include <RowBatcher.h>
 #include <analyzer.h>
 #include <api/IConfigurationProvider.h>
 #include <api/IDataFrameProvider.h>
 #include <api/ILogger.h>
 #include <api/ISystematicManager.h>
 
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <map>
+#include <sstream>
+
+/**
+ * @class BDTBlockForest
+ * @brief Flat, tree-major copy of a FastForest model for block evaluation.
+ *
+ * Parsed from the same text dump as fastforest::load_txt.  Nodes of one tree
+ * are stored contiguously, so scoring a block of events one tree at a time
+ * keeps that tree's nodes in cache.  A negative child index ~k refers to
+ * leaf k.
+ */
+class BDTBlockForest {
+public:
+  BDTBlockForest(const std::string &file, const std::vector<std::string> &features,
+                 const std::string &bdtName)
+      : nFeatures_m(features.size()) {
+    std::ifstream input(file);
+    if (!input) {
+      throw std::runtime_error("BDTManager: Cannot open BDT file '" + file +
+                               "' for block evaluation of '" + bdtName + "'.");
+    }
+    std::map<int, RawNode> tree;
+    std::string line;
+    while (std::getline(input, line)) {
+      const auto begin = line.find_first_not_of(" \t\r");
+      if (begin == std::string::npos) {
+        continue;
+      }
+      line = line.substr(begin);
+      if (line.rfind("booster", 0) == 0) {
+        addTree(tree, bdtName);
+        continue;
+      }
+      const auto base = line.find("base_score=");
+      if (base != std::string::npos) {
+        std::string value = line.substr(base + 11);
+        value.erase(std::remove_if(value.begin(), value.end(),
+                                   [](char c) { return c == '[' || c == ']'; }),
+                    value.end());
+        baseResponse_m = std::stof(value);
+        continue;
+      }
+      parseNode(line, features, tree, bdtName);
+    }
+    addTree(tree, bdtName);
+    if (roots_m.empty()) {
+      throw std::runtime_error("BDTManager: No trees found in '" + file +
+                               "' for block evaluation of '" + bdtName + "'.");
+    }
+  }
+
+  std::size_t nFeatures() const { return nFeatures_m; }
+
+  /// Raw score of one event (base response plus leaf values).
+  float score(const float *row) const {
+    float result = baseResponse_m;
+    for (const int root : roots_m) {
+      result += leaves_m[leafOf(root, row)];
+    }
+    return result;
+  }
+
+  /**
+   * @brief Raw scores of @p nRows events stored row-major in @p rows
+   *
+   * Loops over trees outside and events inside.
+   */
+  void scoreBlock(const float *rows, std::size_t nRows, float *scores) const {
+    std::fill(scores, scores + nRows, baseResponse_m);
+    for (const int root : roots_m) {
+      const float *row = rows;
+      for (std::size_t i = 0; i < nRows; ++i, row += nFeatures_m) {
+        scores[i] += leaves_m[leafOf(root, row)];
+      }
+    }
+  }
+
+private:
+  struct RawNode {
+    bool leaf = false;
+    float value = 0.0f;
+    int feature = 0;
+    int yes = -1;
+    int no = -1;
+  };
+
+  std::size_t leafOf(int index, const float *row) const {
+    while (index >= 0) {
+      index = row[cutFeatures_m[index]] < cutValues_m[index] ? yes_m[index] : no_m[index];
+    }
+    return static_cast<std::size_t>(~index);
+  }
+
+  static int parseChild(const std::string &line, const std::string &key,
+                        const std::string &bdtName) {
+    const auto pos = line.find(key);
+    if (pos == std::string::npos) {
+      throw std::runtime_error("BDTManager: Missing '" + key + "' in BDT node '" +
+                               line + "' of '" + bdtName + "'.");
+    }
+    return std::stoi(line.substr(pos + key.size()));
+  }
+
+  void parseNode(const std::string &line, const std::vector<std::string> &features,
+                 std::map<int, RawNode> &tree, const std::string &bdtName) {
+    std::size_t idEnd = 0;
+    const int id = std::stoi(line, &idEnd);
+    // Dumps without booster[] headers start each tree at node 0.
+    if (id == 0) {
+      addTree(tree, bdtName);
+    }
+    RawNode node;
+    const auto leaf = line.find("leaf=", idEnd);
+    if (leaf != std::string::npos) {
+      node.leaf = true;
+      node.value = std::stof(line.substr(leaf + 5));
+      tree[id] = node;
+      return;
+    }
+    const auto open = line.find('[', idEnd);
+    const auto less = line.find('<', open);
+    const auto close = line.find(']', less);
+    if (open == std::string::npos || less == std::string::npos || close == std::string::npos) {
+      throw std::runtime_error("BDTManager: Cannot parse BDT node '" + line + "' of '" +
+                               bdtName + "'.");
+    }
+    const std::string name = line.substr(open + 1, less - open - 1);
+    const auto it = std::find(features.begin(), features.end(), name);
+    if (it != features.end()) {
+      node.feature = static_cast<int>(it - features.begin());
+    } else if (name.size() > 1 && name[0] == 'f' &&
+               std::all_of(name.begin() + 1, name.end(), ::isdigit)) {
+      node.feature = std::stoi(name.substr(1));
+    } else {
+      throw std::runtime_error("BDTManager: Unknown feature '" + name + "' in BDT '" +
+                               bdtName + "'.");
+    }
+    if (node.feature >= static_cast<int>(nFeatures_m)) {
+      throw std::runtime_error("BDTManager: Feature index of '" + name +
+                               "' out of range in BDT '" + bdtName + "'.");
+    }
+    node.value = std::stof(line.substr(less + 1, close - less - 1));
+    node.yes = parseChild(line, "yes=", bdtName);
+    node.no = parseChild(line, "no=", bdtName);
+    tree[id] = node;
+  }
+
+  /// Append the nodes reachable from node 0 in depth-first order.
+  int flatten(const std::map<int, RawNode> &tree, int id, const std::string &bdtName) {
+    const auto it = tree.find(id);
+    if (it == tree.end()) {
+      throw std::runtime_error("BDTManager: Missing node " + std::to_string(id) +
+                               " in BDT '" + bdtName + "'.");
+    }
+    const RawNode &node = it->second;
+    if (node.leaf) {
+      leaves_m.push_back(node.value);
+      return ~static_cast<int>(leaves_m.size() - 1);
+    }
+    const int index = static_cast<int>(cutFeatures_m.size());
+    cutFeatures_m.push_back(node.feature);
+    cutValues_m.push_back(node.value);
+    yes_m.push_back(0);
+    no_m.push_back(0);
+    const int yes = flatten(tree, node.yes, bdtName);
+    const int no = flatten(tree, node.no, bdtName);
+    yes_m[index] = yes;
+    no_m[index] = no;
+    return index;
+  }
+
+  void addTree(std::map<int, RawNode> &tree, const std::string &bdtName) {
+    if (tree.empty()) {
+      return;
+    }
+    roots_m.push_back(flatten(tree, 0, bdtName));
+    tree.clear();
+  }
+
+  std::size_t nFeatures_m;
+  float baseResponse_m = 0.0f;
+  std::vector<int> roots_m;
+  std::vector<int> cutFeatures_m;
+  std::vector<float> cutValues_m;
+  std::vector<int> yes_m;
+  std::vector<int> no_m;
+  std::vector<float> leaves_m;
+};
+
+namespace {
+
+/// Per-event BDT output: sigmoid of the raw score, -1 when runVar is false.
+Float_t bdtSigmoid(float raw) { return (1. / (1. + std::exp(-raw))); }
+
+/**
+ * @brief Check the block copy against FastForest on probe rows either side
+ *        of every cut, so a dump the parser reads differently is rejected.
+ */
+void validateBlockForest(const BDTBlockForest &forest,
+                         const fastforest::FastForest &bdt,
+                         const std::string &file, const std::string &bdtName) {
+  std::ifstream input(file);
+  std::vector<float> cuts{0.0f};
+  std::string line;
+  while (std::getline(input, line) && cuts.size() < 128) {
+    const auto less = line.find('<');
+    const auto close = line.find(']', less);
+    if (less != std::string::npos && close != std::string::npos) {
+      cuts.push_back(std::stof(line.substr(less + 1, close - less - 1)));
+    }
+  }
+  std::vector<float> row(forest.nFeatures());
+  for (const float cut : cuts) {
+    for (const float offset : {-1e-3f, 1e-3f}) {
+      std::fill(row.begin(), row.end(), cut + offset * (1.0f + std::abs(cut)));
+      const float expected = bdt(row.data());
+      const float actual = forest.score(row.data());
+      if (std::abs(expected - actual) > 1e-5f * (1.0f + std::abs(expected))) {
+        throw std::runtime_error("BDTManager: Block evaluation of BDT '" + bdtName +
+                                 "' disagrees with FastForest (" +
+                                 std::to_string(actual) + " vs " +
+                                 std::to_string(expected) +
+                                 "); remove blockSize for this BDT.");
+      }
+    }
+  }
+}
+
+} // namespace
+
 /**
  * @brief Construct a new BDTManager object
  * @param configProvider Reference to the configuration provider
@@ -21,28 +258,126 @@ void BDTManager::applyBDT(const std::string &bdtName) {
   if (!dataManager_m || !systematicManager_m) {
     throw std::runtime_error("BDTManager: DataManager or SystematicManager not set");
   }
-  
+  if (getBlockSize(bdtName) > 0) {
+    applyBlockBDTs({bdtName});
+    return;
+  }
+
   const auto &inputFeatures = getBDTFeatures(bdtName);
   const auto &runVar = getRunVar(bdtName);
-  dataManager_m->DefineVector("input_" + bdtName, inputFeatures, "Float_t", *systematicManager_m);
+  dataManager_m->DefineFeatureVector("input_" + bdtName, inputFeatures, *systematicManager_m);
   auto bdt = this->objects_m.at(bdtName);
-  auto bdtLambda = [bdt](ROOT::VecOps::RVec<Float_t> &inputVector,
-                         bool runVar) -> Float_t {
+  auto bdtLambda = [bdt](const ROOT::VecOps::RVec<Float_t> &inputVector,
+                         bool runVar, ULong64_t) -> Float_t {
     if (runVar) {
-      return (1. / (1. + std::exp(-((*bdt.get())(inputVector.data())))));
+      return bdtSigmoid((*bdt.get())(inputVector.data()));
     } else {
       return (-1);
     }
   };
-  dataManager_m->Define(bdtName, bdtLambda, {"input_" + bdtName, runVar}, *systematicManager_m);
+  defineModelOutput<Float_t>(*dataManager_m, *systematicManager_m, bdtName, bdtLambda,
+                             "input_" + bdtName, runVar);
 }
 
 /**
  * @brief Apply all BDTs to the dataframe provider
  */
 void BDTManager::applyAllBDTs() {
+  if (!dataManager_m || !systematicManager_m) {
+    throw std::runtime_error("BDTManager: DataManager or SystematicManager not set");
+  }
+  // Block-evaluated BDTs over the same variables share one batch.
+  std::map<std::vector<std::string>, std::vector<std::string>> blockGroups;
   for (const auto &bdtName : getAllBDTNames()) {
-    applyBDT(bdtName);
+    if (getBlockSize(bdtName) > 0) {
+      blockGroups[getBDTFeatures(bdtName)].push_back(bdtName);
+    } else {
+      applyBDT(bdtName);
+    }
+  }
+  for (auto &group : blockGroups) {
+    std::sort(group.second.begin(), group.second.end());
+    applyBlockBDTs(group.second);
+  }
+}
+
+void BDTManager::applyBlockBDTs(const std::vector<std::string> &bdtNames) {
+  const auto &inputFeatures = getBDTFeatures(bdtNames.front());
+  const std::size_t nFeatures = inputFeatures.size();
+  const std::size_t nOutputs = bdtNames.size();
+  const std::string inputColumn = "input_" + bdtNames.front();
+
+  std::vector<std::shared_ptr<const BDTBlockForest>> forests;
+  std::vector<std::string> runVars;
+  std::size_t blockSize = 1;
+  for (const auto &bdtName : bdtNames) {
+    if (getBDTFeatures(bdtName) != inputFeatures) {
+      throw std::runtime_error("BDTManager: BDT '" + bdtName +
+                               "' does not share the input variables of '" +
+                               bdtNames.front() + "'.");
+    }
+    forests.push_back(bdt_blockForests_m.at(bdtName));
+    runVars.push_back(getRunVar(bdtName));
+    blockSize = std::max(blockSize, getBlockSize(bdtName));
+    dataManager_m->DefineFeatureVector("input_" + bdtName, inputFeatures,
+                                       *systematicManager_m);
+  }
+  const std::string runMaskColumn = "blockRun_" + bdtNames.front();
+  dataManager_m->DefineVector(runMaskColumn, runVars, "Bool_t", *systematicManager_m);
+  const std::string runAnyColumn = "blockRunAny_" + bdtNames.front();
+  dataManager_m->Define(runAnyColumn,
+                        [](const ROOT::VecOps::RVec<bool> &runMask) -> bool {
+                          return ROOT::VecOps::Any(runMask);
+                        },
+                        {runMaskColumn}, *systematicManager_m);
+
+  // Rows of the slots running concurrently are scored together, one tree at
+  // a time over the batch.
+  auto evaluate = [forests, nOutputs](const float *rows, std::size_t nRows,
+                                      float *outputs) {
+    thread_local std::vector<float> scores;
+    scores.resize(nRows);
+    for (std::size_t k = 0; k < nOutputs; ++k) {
+      forests[k]->scoreBlock(rows, nRows, scores.data());
+      // Branch-free loop over contiguous scores so the sigmoid vectorizes.
+      for (std::size_t i = 0; i < nRows; ++i) {
+        scores[i] = bdtSigmoid(scores[i]);
+      }
+      for (std::size_t i = 0; i < nRows; ++i) {
+        outputs[i * nOutputs + k] = scores[i];
+      }
+    }
+  };
+  const auto nSlots = static_cast<std::size_t>(dataManager_m->getDataFrame().GetNSlots());
+  auto batcher = std::make_shared<RowBatcher>(nFeatures, nOutputs, blockSize, nSlots,
+                                              std::move(evaluate));
+
+  const std::string scoresColumn = "blockScores_" + bdtNames.front();
+  const std::string groupName = bdtNames.front();
+  auto blockLambda = [batcher, nFeatures, nOutputs, groupName](
+      const ROOT::VecOps::RVec<Float_t> &inputVector, bool run,
+      ULong64_t) -> ROOT::VecOps::RVec<Float_t> {
+    if (!run) {
+      return ROOT::VecOps::RVec<Float_t>(nOutputs, -1.0f);
+    }
+    if (inputVector.size() != nFeatures) {
+      throw std::runtime_error("BDTManager: Input of BDT '" + groupName +
+                               "' has an unexpected size.");
+    }
+    ROOT::VecOps::RVec<Float_t> scores(nOutputs);
+    batcher->infer(inputVector.data(), inputVector.size(), scores.data());
+    return scores;
+  };
+  defineModelOutput<ROOT::VecOps::RVec<Float_t>>(*dataManager_m, *systematicManager_m,
+                                                 scoresColumn, blockLambda, inputColumn,
+                                                 runAnyColumn);
+
+  for (std::size_t k = 0; k < nOutputs; ++k) {
+    auto bdtLambda = [k](const ROOT::VecOps::RVec<Float_t> &scores, bool runVar) -> Float_t {
+      return runVar ? scores[k] : -1.0f;
+    };
+    dataManager_m->Define(bdtNames[k], bdtLambda, {scoresColumn, runVars[k]},
+                          *systematicManager_m);
   }
 }
 
@@ -79,6 +414,19 @@ const std::string &BDTManager::getRunVar(const std::string &bdtName) const {
   throw std::runtime_error("RunVar not found for BDT: " + bdtName);
 }
 
+/**
+ * @brief Get the block-evaluation size for a BDT
+ * @param bdtName Name of the BDT
+ * @return Most events scored per batch (0 if block evaluation is disabled)
+ */
+std::size_t BDTManager::getBlockSize(const std::string &bdtName) const {
+  auto it = bdt_blockSizes_m.find(bdtName);
+  if (it != bdt_blockSizes_m.end()) {
+    return it->second;
+  }
+  return 0;
+}
+
 /**
  * @brief Get all BDT names
  * @return Vector of all BDT names
@@ -101,24 +449,61 @@ void BDTManager::registerBDTs(const IConfigurationProvider &configProvider) {
       {"file", "name", "inputVariables", "runVar"});
 
   for (const auto &entryKeys : bdtConfig) {
+    registerBDT(configProvider, entryKeys);
+  }
+}
 
-    // Split the variable list on commas, save to vector
-    auto inputVariableVector =
-        configProvider.splitString(entryKeys.at("inputVariables"), ",");
+void BDTManager::registerBDT(
+    const IConfigurationProvider &configProvider,
+    const std::unordered_map<std::string, std::string> &entryKeys) {
+  // Split the variable list on commas, save to vector
+  auto inputVariableVector =
+      configProvider.splitString(entryKeys.at("inputVariables"), ",");
 
-    // Add BDT
+  // Load the BDT, shared with other BDTManagers reading the same file with
+  // the same features.
+  const std::string &file = entryKeys.at("file");
+  std::string featureKey;
+  for (const auto &feature : inputVariableVector) {
+    featureKey += feature + ",";
+  }
+  auto bdt = models().get<fastforest::FastForest>(file, featureKey, [&] {
     std::vector<std::string> features = inputVariableVector;
+    return std::make_shared<fastforest::FastForest>(fastforest::load_txt(file, features));
+  });
+  const auto &name = entryKeys.at("name");
 
-    // Load the BDT
-    auto bdt = fastforest::load_txt(entryKeys.at("file"), features);
-
-    // Add the BDT and feature list to their maps
-    objects_m.emplace(entryKeys.at("name"),
-                      std::make_shared<fastforest::FastForest>(bdt));
-    features_m.emplace(entryKeys.at("name"), inputVariableVector);
-    bdt_runVars_m.emplace(entryKeys.at("name"), entryKeys.at("runVar"));
+  std::size_t blockSize = 0;
+  auto blockIt = entryKeys.find("blockSize");
+  if (blockIt != entryKeys.end()) {
+    long long value = 0;
+    try {
+      value = std::stoll(blockIt->second);
+    } catch (const std::exception &e) {
+      throw std::runtime_error("BDTManager: Invalid blockSize value '" +
+                               blockIt->second + "' for BDT '" + name +
+                               "': " + e.what());
+    }
+    if (value < 0) {
+      throw std::runtime_error("BDTManager: Invalid blockSize value '" +
+                               blockIt->second + "' for BDT '" + name +
+                               "': block size must be non-negative");
+    }
+    blockSize = static_cast<std::size_t>(value);
   }
-} 
+  if (blockSize > 0 && bdt_blockForests_m.find(name) == bdt_blockForests_m.end()) {
+    auto forest = std::make_shared<const BDTBlockForest>(entryKeys.at("file"),
+                                                         inputVariableVector, name);
+    validateBlockForest(*forest, *bdt, entryKeys.at("file"), name);
+    bdt_blockForests_m.emplace(name, std::move(forest));
+  }
+
+  // Add the BDT and feature list to their maps
+  objects_m.emplace(name, std::move(bdt));
+  features_m.emplace(name, inputVariableVector);
+  bdt_runVars_m.emplace(name, entryKeys.at("runVar"));
+  bdt_blockSizes_m.emplace(name, blockSize);
+}
 
 void BDTManager::setupFromConfigFile() {
   if (!configManager_m) {
@@ -130,27 +515,19 @@ void BDTManager::setupFromConfigFile() {
     {"file", "name", "inputVariables", "runVar"});
 
   for (const auto &entryKeys : bdtConfig) {
-
-    // Split the variable list on commas, save to vector
-    auto inputVariableVector =
-      configManager_m->splitString(entryKeys.at("inputVariables"), ",");
-
-    // Add BDT
-    std::vector<std::string> features = inputVariableVector;
-
-    // Load the BDT
-    auto bdt = fastforest::load_txt(entryKeys.at("file"), features);
-
-    // Add the BDT and feature list to their maps
-    objects_m.emplace(entryKeys.at("name"),
-                    std::make_shared<fastforest::FastForest>(bdt));
-    features_m.emplace(entryKeys.at("name"), inputVariableVector);
-    bdt_runVars_m.emplace(entryKeys.at("name"), entryKeys.at("runVar"));
+    registerBDT(*configManager_m, entryKeys);
   }
 }
 void BDTManager::initialize() {
-  std::cout << "BDTManager: initialized with " << bdt_runVars_m.size()
-            << " BDT(s)." << std::endl;
+  // The features of every BDT go into the block shared with the other ML
+  // managers (see IDataFrameProvider::DefineFeatureVector()).
+  if (dataManager_m) {
+    for (const auto &bdtName : getAllBDTNames()) {
+      dataManager_m->declareFeatures(getBDTFeatures(bdtName));
+    }
+  }
+  RDF_LOG_INFO << "BDTManager: initialized with " << bdt_runVars_m.size()
+               << " BDT(s).";
 }
 
 void BDTManager::reportMetadata() {
@@ -165,6 +542,10 @@ void BDTManager::reportMetadata() {
   logger_m->log(ILogger::Level::Info, msg);
 }
 
+void BDTManager::estimateCost(GraphCost &cost) const {
+  cost.models += getAllBDTNames().size();
+}
+
 std::shared_ptr<BDTManager> BDTManager::create(
     Analyzer& an, const std::string& role) {
     auto plugin = std::make_shared<BDTManager>(an.getConfigurationProvider());
@@ -3,16 +3,19 @@
 
 #include <api/IConfigurationProvider.h>
 #include <api/IDataFrameProvider.h>
+#include <GraphCost.h>
 #include <NamedObjectManager.h>
 #include <ROOT/RVec.hxx>
 #include <RtypesCore.h>
 #include <fastforest.h>
+#include <cstddef>
 #include <memory>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
 class Analyzer;
+class BDTBlockForest;
 
 /**
  * @class BDTManager
@@ -46,6 +49,9 @@ public:
 
   /**
    * @brief Apply all BDTs to the dataframe provider
+   *
+   * BDTs with a ``blockSize`` that read the same input variables are scored
+   * together in one batch.
    */
   void applyAllBDTs();
 
@@ -70,6 +76,14 @@ public:
    */
   const std::string &getRunVar(const std::string &bdtName) const;
 
+  /**
+   * @brief Get the block-evaluation size for a BDT (``blockSize``)
+   * @param bdtName Name of the BDT
+   * @return Most events of concurrent slots scored per batch (0 if block
+   *         evaluation is disabled)
+   */
+  std::size_t getBlockSize(const std::string &bdtName) const;
+
   /**
    * @brief Get all BDT names
    * @return Vector of all BDT names
@@ -83,6 +97,9 @@ public:
 
   void setupFromConfigFile() override;
 
+  /// Setup only reads files; it may overlap with other plugins' setup.
+  bool concurrentSetup() const override { return true; }
+
   /**
    * @brief Post-wiring initialization: logs loaded BDT names.
    */
@@ -93,16 +110,51 @@ public:
    */
   void reportMetadata() override;
 
+  /**
+   * @brief Cost estimate: counts the loaded BDTs.
+   */
+  void estimateCost(GraphCost &cost) const override;
+
 private:
   /**
    * @brief Register BDTs from the configuration
    * @param configProvider Reference to the configuration provider
    */
   void registerBDTs(const IConfigurationProvider &configProvider);
+
+  /**
+   * @brief Load one ``bdtConfig`` entry
+   * @param configProvider Provider used to split the variable list
+   * @param entryKeys Parsed key/value pairs of the entry
+   */
+  void registerBDT(const IConfigurationProvider &configProvider,
+                   const std::unordered_map<std::string, std::string> &entryKeys);
+
+  /**
+   * @brief Apply BDTs that share input variables with block evaluation
+   * @param bdtNames Names of the BDTs; all must read the same variables
+   *
+   * The rows of the slots running concurrently are collected by a
+   * RowBatcher and scored, tree by tree, in batches of at most blockSize
+   * events during the main event loop.  One column holds the scores of all
+   * the BDTs; each BDT output reads its own score.
+   */
+  void applyBlockBDTs(const std::vector<std::string> &bdtNames);
+
   /**
    * @brief Map from BDT name to run variable name.
    */
   std::unordered_map<std::string, std::string> bdt_runVars_m;
+
+  /**
+   * @brief Map from BDT name to block-evaluation size (0 = per event).
+   */
+  std::unordered_map<std::string, std::size_t> bdt_blockSizes_m;
+
+  /**
+   * @brief Map from BDT name to its tree-major copy used for block evaluation.
+   */
+  std::unordered_map<std::string, std::shared_ptr<const BDTBlockForest>> bdt_blockForests_m;
 };
 
 
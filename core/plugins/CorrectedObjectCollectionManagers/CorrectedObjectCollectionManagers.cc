@@ -1079,6 +1079,26 @@ CorrectedCollectionManagerBase::parseSpec(const std::string &configFile) const {
   spec.correctedMassColumn = config.count("correctedMassColumn") ? config.at("correctedMassColumn") : "";
   spec.outputCollection = requireValue(config, "outputCollection", type(), configFile);
   spec.variationMapColumn = config.count("variationMapColumn") ? config.at("variationMapColumn") : "";
+  spec.overlapReferenceCollection = getValue(config, "overlapReferenceCollection");
+  spec.cleanedOutputCollection = getValue(config, "cleanedOutputCollection");
+  if (!spec.cleanedOutputCollection.empty()) {
+    spec.overlapReferenceCollection =
+        requireValue(config, "overlapReferenceCollection", type(), configFile);
+    const std::string deltaR = getValue(config, "overlapDeltaR");
+    if (!deltaR.empty()) {
+      try {
+        std::size_t pos = 0;
+        spec.overlapDeltaR = std::stof(deltaR, &pos);
+        if (pos != deltaR.size() || !(spec.overlapDeltaR > 0.0f)) {
+          throw std::invalid_argument(deltaR);
+        }
+      } catch (const std::exception &) {
+        throw std::runtime_error(type() + ": invalid overlapDeltaR '" + deltaR +
+                                 "' in config file '" + configFile +
+                                 "'; expected a positive number");
+      }
+    }
+  }
 
   if (spec.inputCollection.empty()) {
     spec.ptColumn = requireValue(config, "ptColumn", type(), configFile);
@@ -1189,9 +1209,28 @@ void CorrectedCollectionManagerBase::setupFromConfigFile() {
   applyWorkflowConfig(spec_m);
   bindCollectionSpec(spec_m);
   materializeWrappedOutputs();
+  defineCleanedCollection(spec_m);
   configured_m = true;
 }
 
+void CorrectedCollectionManagerBase::defineCleanedCollection(
+    const CorrectedCollectionSpec &spec) {
+  if (spec.cleanedOutputCollection.empty()) {
+    return;
+  }
+  // Defined through the systematic manager, so Up/Down columns exist only for
+  // systematics that vary the corrected or the reference collection; every
+  // other variation resolves to the nominal cleaned collection.
+  const float deltaR = spec.overlapDeltaR;
+  dataManager_m->Define(
+      spec.cleanedOutputCollection,
+      [deltaR](const PhysicsObjectCollection &objects,
+               const PhysicsObjectCollection &reference) -> PhysicsObjectCollection {
+        return objects.removeOverlap(reference, deltaR);
+      },
+      {spec.outputCollection, spec.overlapReferenceCollection}, *systematicManager_m);
+}
+
 void CorrectedCollectionManagerBase::execute() {
   if (!configured_m || systematicsRegistered_m || !systematicManager_m) {
     return;
@@ -1236,6 +1275,11 @@ CorrectedCollectionManagerBase::collectProvenanceEntries() const {
   if (!spec_m.workflowConfig.empty()) {
     entries["workflow_config"] = spec_m.workflowConfig;
   }
+  if (!spec_m.cleanedOutputCollection.empty()) {
+    entries["cleaned_output_collection"] = spec_m.cleanedOutputCollection;
+    entries["overlap_reference_collection"] = spec_m.overlapReferenceCollection;
+    entries["overlap_delta_r"] = std::to_string(spec_m.overlapDeltaR);
+  }
   return entries;
 }
 
@@ -1254,6 +1298,9 @@ std::vector<std::string> CorrectedCollectionManagerBase::getRequiredColumns() co
   if (!spec_m.correctedMassColumn.empty()) {
     columns.push_back(spec_m.correctedMassColumn);
   }
+  if (!spec_m.cleanedOutputCollection.empty()) {
+    columns.push_back(spec_m.overlapReferenceCollection);
+  }
   return columns;
 }
 
@@ -1274,6 +1321,14 @@ std::vector<std::string> CorrectedCollectionManagerBase::getProducedColumns() co
     columns.push_back(spec_m.outputCollection + "_" + variationName + "Up");
     columns.push_back(spec_m.outputCollection + "_" + variationName + "Down");
   }
+  if (!spec_m.cleanedOutputCollection.empty()) {
+    columns.push_back(spec_m.cleanedOutputCollection);
+    for (const auto &syst :
+         systematicManager_m->getSystematicsForVariable(spec_m.cleanedOutputCollection)) {
+      columns.push_back(spec_m.cleanedOutputCollection + "_" + syst + "Up");
+      columns.push_back(spec_m.cleanedOutputCollection + "_" + syst + "Down");
+    }
+  }
   return columns;
 }
 
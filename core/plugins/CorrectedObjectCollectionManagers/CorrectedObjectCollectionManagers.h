@@ -48,6 +48,9 @@ struct CorrectedCollectionSpec {
   std::string correctedMassColumn;
   std::string outputCollection;
   std::string variationMapColumn;
+  std::string overlapReferenceCollection;
+  std::string cleanedOutputCollection;
+  float overlapDeltaR = 0.4f;
   bool autoBuildInputCollection = false;
 };
 
@@ -83,6 +86,7 @@ private:
   CorrectedCollectionSpec parseSpec(const std::string &configFile) const;
   void defineAutoInputCollection(const CorrectedCollectionSpec &spec);
   void applyWorkflowConfig(const CorrectedCollectionSpec &spec);
+  void defineCleanedCollection(const CorrectedCollectionSpec &spec);
 
   std::string configKey_m;
   IConfigurationProvider *configManager_m = nullptr;
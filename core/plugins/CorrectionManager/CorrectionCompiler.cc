@@ -0,0 +1,732 @@
+#include <CorrectionCompiler.h>
+
+#include <JitCache.h>
+#include <rapidjson/document.h>
+
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+#include <variant>
+
+namespace {
+
+[[noreturn]] void fail(const std::string &message) {
+  throw std::runtime_error("CorrectionCompiler: " + message);
+}
+
+/// C++ literal of @p value that is a double in every context.
+std::string literal(double value) {
+  if (std::isnan(value)) {
+    return "std::numeric_limits<double>::quiet_NaN()";
+  }
+  if (std::isinf(value)) {
+    return value > 0 ? "std::numeric_limits<double>::infinity()"
+                     : "(-std::numeric_limits<double>::infinity())";
+  }
+  char buffer[32];
+  std::snprintf(buffer, sizeof(buffer), "%.17g", value);
+  std::string text = buffer;
+  if (text.find_first_of(".e") == std::string::npos) {
+    text += ".0";
+  }
+  return value < 0 ? "(" + text + ")" : text;
+}
+
+/// C++ string literal of @p text.
+std::string quoted(const std::string &text) {
+  std::string out = "\"";
+  for (const char c : text) {
+    if (c == '"' || c == '\\') {
+      out += '\\';
+    }
+    if (c == '\n') {
+      out += "\\n";
+      continue;
+    }
+    out += c;
+  }
+  return out + '"';
+}
+
+/// A JSON number, or one of the strings correctionlib accepts for edges.
+double number(const rapidjson::Value &value) {
+  if (value.IsNumber()) {
+    return value.GetDouble();
+  }
+  if (value.IsString()) {
+    const std::string text = value.GetString();
+    if (text == "inf" || text == "+inf") return HUGE_VAL;
+    if (text == "-inf") return -HUGE_VAL;
+  }
+  fail("expected a number");
+}
+
+const rapidjson::Value &member(const rapidjson::Value &node, const char *name) {
+  if (!node.IsObject() || !node.HasMember(name)) {
+    fail(std::string("node without '") + name + "'");
+  }
+  return node[name];
+}
+
+std::string text(const rapidjson::Value &node, const char *name) {
+  const rapidjson::Value &value = member(node, name);
+  if (!value.IsString()) {
+    fail(std::string("'") + name + "' is not a string");
+  }
+  return value.GetString();
+}
+
+const rapidjson::Value &array(const rapidjson::Value &node, const char *name) {
+  const rapidjson::Value &value = member(node, name);
+  if (!value.IsArray()) {
+    fail(std::string("'") + name + "' is not an array");
+  }
+  return value;
+}
+
+/**
+ * @brief Translation of a correctionlib formula (TFormula dialect) to a C++
+ *        expression.
+ *
+ * Follows the grammar of correctionlib: binary operators by increasing
+ * precedence ``== !=``, ``> < >= <=``, ``+ -``, ``* /`` and
+ * right-associative ``^``; unary minus applies to the atom that follows.
+ */
+class FormulaTranslator {
+public:
+  /// @p variables and @p parameters are the C++ expressions of x, y, z, t
+  /// and of the parameters [0], [1], ....
+  FormulaTranslator(std::string expression, std::vector<std::string> variables,
+                    std::vector<std::string> parameters)
+      : expr_m(std::move(expression)), variables_m(std::move(variables)),
+        parameters_m(std::move(parameters)) {}
+
+  std::string translate() {
+    std::string result = binary(0);
+    skipSpace();
+    if (pos_m != expr_m.size()) {
+      error("unexpected '" + expr_m.substr(pos_m) + "'");
+    }
+    return result;
+  }
+
+  /// One past the highest parameter index the expression uses.
+  std::size_t parameterCount() const { return parameterCount_m; }
+
+private:
+  [[noreturn]] void error(const std::string &message) const {
+    fail("formula '" + expr_m + "': " + message);
+  }
+
+  void skipSpace() {
+    while (pos_m < expr_m.size() && std::isspace(static_cast<unsigned char>(expr_m[pos_m]))) {
+      ++pos_m;
+    }
+  }
+
+  bool accept(const std::string &token) {
+    skipSpace();
+    if (expr_m.compare(pos_m, token.size(), token) == 0) {
+      pos_m += token.size();
+      return true;
+    }
+    return false;
+  }
+
+  void expect(const std::string &token) {
+    if (!accept(token)) {
+      error("expected '" + token + "'");
+    }
+  }
+
+  /// Operators of precedence level @p level, longest first.
+  static const std::vector<std::string> &operators(int level) {
+    static const std::vector<std::vector<std::string>> levels = {
+        {"==", "!="}, {">=", "<=", ">", "<"}, {"+", "-"}, {"*", "/"}};
+    return levels[static_cast<std::size_t>(level)];
+  }
+
+  std::string binary(int level) {
+    if (level == 4) {
+      return power();
+    }
+    std::string left = binary(level + 1);
+    for (;;) {
+      std::string op;
+      for (const auto &candidate : operators(level)) {
+        if (accept(candidate)) {
+          op = candidate;
+          break;
+        }
+      }
+      if (op.empty()) {
+        return left;
+      }
+      const std::string right = binary(level + 1);
+      left = level < 2 ? "static_cast<double>(" + left + " " + op + " " + right + ")"
+                       : "(" + left + " " + op + " " + right + ")";
+    }
+  }
+
+  std::string power() {
+    const std::string base = atom();
+    if (accept("^")) {
+      return "std::pow(" + base + ", " + power() + ")";
+    }
+    return base;
+  }
+
+  std::string atom() {
+    skipSpace();
+    if (pos_m >= expr_m.size()) {
+      error("unexpected end");
+    }
+    const char c = expr_m[pos_m];
+    if (c == '(') {
+      ++pos_m;
+      const std::string inner = binary(0);
+      expect(")");
+      return inner;
+    }
+    if (c == '-') {
+      ++pos_m;
+      return "(-" + atom() + ")";
+    }
+    if (c == '[') {
+      ++pos_m;
+      const std::size_t begin = pos_m;
+      while (pos_m < expr_m.size() && std::isdigit(static_cast<unsigned char>(expr_m[pos_m]))) {
+        ++pos_m;
+      }
+      const std::string index = expr_m.substr(begin, pos_m - begin);
+      expect("]");
+      const std::size_t i = index.empty() ? parameters_m.size() : std::stoul(index);
+      if (i >= parameters_m.size()) {
+        error("parameter [" + index + "] is not defined");
+      }
+      parameterCount_m = std::max(parameterCount_m, i + 1);
+      return parameters_m[i];
+    }
+    if (std::isdigit(static_cast<unsigned char>(c)) || c == '.') {
+      const char *begin = expr_m.c_str() + pos_m;
+      char *end = nullptr;
+      const double value = std::strtod(begin, &end);
+      pos_m += static_cast<std::size_t>(end - begin);
+      return literal(value);
+    }
+    if (std::isalpha(static_cast<unsigned char>(c))) {
+      const std::size_t begin = pos_m;
+      while (pos_m < expr_m.size() &&
+             (std::isalnum(static_cast<unsigned char>(expr_m[pos_m])) || expr_m[pos_m] == '_')) {
+        ++pos_m;
+      }
+      return name(expr_m.substr(begin, pos_m - begin));
+    }
+    error(std::string("unexpected '") + c + "'");
+  }
+
+  std::string name(const std::string &identifier) {
+    static const std::map<std::string, std::string> unary = {
+        {"log", "std::log"},     {"log10", "std::log10"}, {"exp", "std::exp"},
+        {"erf", "std::erf"},     {"sqrt", "std::sqrt"},   {"abs", "std::fabs"},
+        {"cos", "std::cos"},     {"sin", "std::sin"},     {"tan", "std::tan"},
+        {"acos", "std::acos"},   {"asin", "std::asin"},   {"atan", "std::atan"},
+        {"cosh", "std::cosh"},   {"sinh", "std::sinh"},   {"tanh", "std::tanh"},
+        {"acosh", "std::acosh"}, {"asinh", "std::asinh"}, {"atanh", "std::atanh"}};
+    static const std::map<std::string, std::string> binaryFunctions = {
+        {"atan2", "std::atan2"},
+        {"pow", "std::pow"},
+        {"max", "std::max<double>"},
+        {"min", "std::min<double>"}};
+    static const std::string variableNames = "xyzt";
+    if (const auto it = unary.find(identifier); it != unary.end()) {
+      expect("(");
+      const std::string argument = binary(0);
+      expect(")");
+      return it->second + "(" + argument + ")";
+    }
+    if (const auto it = binaryFunctions.find(identifier); it != binaryFunctions.end()) {
+      expect("(");
+      const std::string first = binary(0);
+      expect(",");
+      const std::string second = binary(0);
+      expect(")");
+      return it->second + "(" + first + ", " + second + ")";
+    }
+    if (identifier.size() == 1 && variableNames.find(identifier) != std::string::npos) {
+      const std::size_t i = variableNames.find(identifier);
+      if (i >= variables_m.size()) {
+        error("variable '" + identifier + "' is not defined");
+      }
+      return variables_m[i];
+    }
+    error("unsupported name '" + identifier + "'");
+  }
+
+  std::string expr_m;
+  std::vector<std::string> variables_m;
+  std::vector<std::string> parameters_m;
+  std::size_t pos_m = 0;
+  std::size_t parameterCount_m = 0;
+};
+
+/// Writes one C++ function per node of a correction.
+class Generator {
+public:
+  explicit Generator(const rapidjson::Value &correction) : correction_m(correction) {
+    const rapidjson::Value &inputs = array(correction, "inputs");
+    for (rapidjson::SizeType i = 0; i < inputs.Size(); ++i) {
+      inputs_m[text(inputs[i], "name")] = {i, text(inputs[i], "type")};
+    }
+  }
+
+  std::string source() {
+    const std::string root = call(node(member(correction_m, "data")), "x");
+    std::ostringstream out;
+    out << "// correctionlib correction " << quoted(text(correction_m, "name"))
+        << ", generated by CorrectionCompiler; do not edit.\n"
+        << "#include <algorithm>\n#include <cmath>\n#include <limits>\n"
+        << "#include <stdexcept>\n#include <string>\n\n"
+        << "namespace " << JitCache::kFunctionName << "_detail {\n\n"
+        << "using Strings = const std::string *const *;\n"
+        << body_m.str() << "\n} // namespace " << JitCache::kFunctionName << "_detail\n\n"
+        << "extern \"C\" double " << JitCache::kFunctionName
+        << "(const double *x, const std::string *const *s) {\n"
+        << "  using namespace " << JitCache::kFunctionName << "_detail;\n"
+        << "  (void)s;\n  return " << root << ";\n}\n";
+    return out.str();
+  }
+
+private:
+  struct Input {
+    rapidjson::SizeType index;
+    std::string type;
+  };
+
+  /// A node: a literal, or the name of its function.
+  struct Ref {
+    bool literal;
+    std::string text;
+  };
+
+  /// Expression of @p ref for the numeric inputs @p inputs.
+  static std::string call(const Ref &ref, const std::string &inputs) {
+    return ref.literal ? ref.text : ref.text + "(" + inputs + ", s)";
+  }
+
+  const Input &input(const std::string &name) const {
+    const auto it = inputs_m.find(name);
+    if (it == inputs_m.end()) {
+      fail("unknown input '" + name + "'");
+    }
+    return it->second;
+  }
+
+  std::string numericInput(const std::string &name) const {
+    const Input &in = input(name);
+    if (in.type == "string") {
+      fail("input '" + name + "' is a string");
+    }
+    return "x[" + std::to_string(in.index) + "]";
+  }
+
+  /// Start the function of a new node; returns its name.
+  std::string open() {
+    const std::string name = "node" + std::to_string(next_m++);
+    body_m << "\ndouble " << name << "(const double *x, Strings s) {\n  (void)s;\n";
+    return name;
+  }
+
+  Ref node(const rapidjson::Value &value) {
+    if (value.IsNumber()) {
+      return {true, literal(value.GetDouble())};
+    }
+    const std::string type = text(value, "nodetype");
+    if (type == "binning") return binning(value);
+    if (type == "multibinning") return multibinning(value);
+    if (type == "category") return category(value);
+    if (type == "formula") return formula(value);
+    if (type == "formularef") return formulaRef(value);
+    if (type == "transform") return transform(value);
+    fail("node type '" + type + "' is not supported");
+  }
+
+  /// Statement returning content bin @p index of @p contents.
+  void content(std::ostringstream &code, const std::vector<Ref> &contents,
+               const std::string &index) {
+    bool literals = true;
+    for (const Ref &ref : contents) {
+      literals = literals && ref.literal;
+    }
+    if (literals) {
+      code << "  static const double content[] = {";
+      for (std::size_t i = 0; i < contents.size(); ++i) {
+        code << (i ? ", " : "") << contents[i].text;
+      }
+      code << "};\n  return content[" << index << "];\n}\n";
+      return;
+    }
+    code << "  switch (" << index << ") {\n";
+    for (std::size_t i = 0; i < contents.size(); ++i) {
+      code << "  case " << i << ": return " << call(contents[i], "x") << ";\n";
+    }
+    code << "  }\n  return 0.0;\n}\n";
+  }
+
+  /// Statements computing bin @p bin of @p value on the axis @p edges, or
+  /// -1 (underflow) and nBins (overflow).
+  void axis(std::ostringstream &code, const rapidjson::Value &edges, const std::string &value,
+            const std::string &bin, std::size_t &nBins) {
+    if (edges.IsArray()) {
+      if (edges.Size() < 2) {
+        fail("binning with fewer than two edges");
+      }
+      nBins = edges.Size() - 1;
+      code << "  static const double " << bin << "Edges[] = {";
+      for (rapidjson::SizeType i = 0; i < edges.Size(); ++i) {
+        code << (i ? ", " : "") << literal(number(edges[i]));
+      }
+      code << "};\n  const long " << bin << " = static_cast<long>(std::upper_bound(" << bin
+           << "Edges, " << bin << "Edges + " << edges.Size() << ", " << value << ") - " << bin
+           << "Edges) - 1;\n";
+      return;
+    }
+    // Uniform binning {n, low, high}.
+    nBins = static_cast<std::size_t>(number(member(edges, "n")));
+    const std::string low = literal(number(member(edges, "low")));
+    const std::string high = literal(number(member(edges, "high")));
+    if (nBins == 0) {
+      fail("uniform binning without bins");
+    }
+    code << "  const long " << bin << " = " << value << " < " << low << " ? -1L : !(" << value
+         << " < " << high << ") ? " << nBins << "L : std::min(" << nBins - 1
+         << "L, static_cast<long>((" << value << " - " << low << ") / (" << high << " - " << low
+         << ") * " << nBins << "));\n";
+  }
+
+  /// How a binning treats values outside its edges.
+  struct Flow {
+    enum Kind { Clamp, Error, Node } kind;
+    Ref fallback;
+  };
+
+  Flow flowOf(const rapidjson::Value &value) {
+    if (value.IsString() && std::string(value.GetString()) == "clamp") {
+      return {Flow::Clamp, {true, ""}};
+    }
+    if (value.IsString() && std::string(value.GetString()) == "error") {
+      return {Flow::Error, {true, ""}};
+    }
+    return {Flow::Node, node(value)};
+  }
+
+  /// Statements handling bin @p raw outside [0, nBins) by @p flow, leaving
+  /// the bin to use in @p bin.
+  static void handleFlow(std::ostringstream &code, const Flow &flow, const std::string &raw,
+                         std::size_t nBins, const std::string &inputName, const std::string &bin) {
+    code << "  long " << bin << " = " << raw << ";\n";
+    switch (flow.kind) {
+    case Flow::Clamp:
+      code << "  " << bin << " = std::max(0L, std::min(" << nBins - 1 << "L, " << raw << "));\n";
+      break;
+    case Flow::Error:
+      code << "  if (" << raw << " < 0 || " << raw << " >= " << nBins
+           << ") throw std::runtime_error("
+           << quoted("Index out of bounds in binning for input '" + inputName + "'") << ");\n";
+      break;
+    case Flow::Node:
+      code << "  if (" << raw << " < 0 || " << raw << " >= " << nBins << ") return "
+           << call(flow.fallback, "x") << ";\n";
+      break;
+    }
+  }
+
+  Ref binning(const rapidjson::Value &value) {
+    const std::string inputName = text(value, "input");
+    const std::string in = numericInput(inputName);
+    std::vector<Ref> contents;
+    const rapidjson::Value &items = array(value, "content");
+    for (rapidjson::SizeType i = 0; i < items.Size(); ++i) {
+      contents.push_back(node(items[i]));
+    }
+    const Flow flow = flowOf(member(value, "flow"));
+    std::ostringstream code;
+    std::size_t nBins = 0;
+    axis(code, member(value, "edges"), in, "raw", nBins);
+    if (contents.size() != nBins) {
+      fail("binning on '" + inputName + "' has " + std::to_string(nBins) + " bins and " +
+           std::to_string(contents.size()) + " contents");
+    }
+    handleFlow(code, flow, "raw", nBins, inputName, "bin");
+    content(code, contents, "bin");
+    const std::string name = open();
+    body_m << code.str();
+    return {false, name};
+  }
+
+  Ref multibinning(const rapidjson::Value &value) {
+    const rapidjson::Value &inputs = array(value, "inputs");
+    const rapidjson::Value &edges = array(value, "edges");
+    if (inputs.Size() != edges.Size() || inputs.Size() == 0) {
+      fail("multibinning with mismatched inputs and edges");
+    }
+    std::vector<Ref> contents;
+    const rapidjson::Value &items = array(value, "content");
+    for (rapidjson::SizeType i = 0; i < items.Size(); ++i) {
+      contents.push_back(node(items[i]));
+    }
+    const Flow flow = flowOf(member(value, "flow"));
+    std::ostringstream code;
+    std::vector<std::size_t> sizes(inputs.Size());
+    for (rapidjson::SizeType d = 0; d < inputs.Size(); ++d) {
+      if (!inputs[d].IsString()) {
+        fail("multibinning input is not a string");
+      }
+      const std::string inputName = inputs[d].GetString();
+      const std::string raw = "raw" + std::to_string(d);
+      const std::string bin = "bin" + std::to_string(d);
+      axis(code, edges[d], numericInput(inputName), raw, sizes[d]);
+      handleFlow(code, flow, raw, sizes[d], inputName, bin);
+    }
+    std::size_t total = 1;
+    std::string index;
+    for (std::size_t d = sizes.size(); d-- > 0;) {
+      index = "bin" + std::to_string(d) + (total > 1 ? " * " + std::to_string(total) : "") +
+              (index.empty() ? "" : " + " + index);
+      total *= sizes[d];
+    }
+    if (contents.size() != total) {
+      fail("multibinning has " + std::to_string(total) + " bins and " +
+           std::to_string(contents.size()) + " contents");
+    }
+    code << "  const long bin = " << index << ";\n";
+    content(code, contents, "bin");
+    const std::string name = open();
+    body_m << code.str();
+    return {false, name};
+  }
+
+  Ref category(const rapidjson::Value &value) {
+    const std::string inputName = text(value, "input");
+    const Input &in = input(inputName);
+    const rapidjson::Value &items = array(value, "content");
+    std::vector<std::pair<std::string, Ref>> cases;
+    for (rapidjson::SizeType i = 0; i < items.Size(); ++i) {
+      const rapidjson::Value &key = member(items[i], "key");
+      std::string label;
+      if (in.type == "string") {
+        if (!key.IsString()) fail("category on '" + inputName + "' with a non-string key");
+        label = quoted(key.GetString());
+      } else {
+        if (!key.IsInt64()) fail("category on '" + inputName + "' with a non-integer key");
+        label = std::to_string(key.GetInt64()) + "LL";
+      }
+      cases.emplace_back(label, node(member(items[i], "value")));
+    }
+    const bool hasDefault = value.HasMember("default") && !value["default"].IsNull();
+    const Ref fallback = hasDefault ? node(value["default"]) : Ref{true, ""};
+
+    std::ostringstream code;
+    if (in.type == "string") {
+      code << "  const std::string &key = *s[" << in.index << "];\n";
+      for (const auto &[label, ref] : cases) {
+        code << "  if (key == " << label << ") return " << call(ref, "x") << ";\n";
+      }
+    } else {
+      code << "  switch (static_cast<long long>(x[" << in.index << "])) {\n";
+      for (const auto &[label, ref] : cases) {
+        code << "  case " << label << ": return " << call(ref, "x") << ";\n";
+      }
+      code << "  default: break;\n  }\n";
+    }
+    if (hasDefault) {
+      code << "  return " << call(fallback, "x") << ";\n}\n";
+    } else {
+      code << "  throw std::runtime_error("
+           << quoted("Index not available in category for input '" + inputName + "'")
+           << ");\n}\n";
+    }
+    const std::string name = open();
+    body_m << code.str();
+    return {false, name};
+  }
+
+  /// Expressions of the variables of formula @p value.
+  std::vector<std::string> variables(const rapidjson::Value &value) const {
+    std::vector<std::string> result;
+    const rapidjson::Value &names = array(value, "variables");
+    for (rapidjson::SizeType i = 0; i < names.Size(); ++i) {
+      if (!names[i].IsString()) fail("formula variable is not a string");
+      result.push_back(numericInput(names[i].GetString()));
+    }
+    return result;
+  }
+
+  static void checkParser(const rapidjson::Value &value) {
+    if (text(value, "parser") != "TFormula") {
+      fail("formula parser '" + text(value, "parser") + "' is not supported");
+    }
+  }
+
+  Ref formula(const rapidjson::Value &value) {
+    checkParser(value);
+    std::vector<std::string> parameters;
+    if (value.HasMember("parameters") && value["parameters"].IsArray()) {
+      const rapidjson::Value &values = value["parameters"];
+      for (rapidjson::SizeType i = 0; i < values.Size(); ++i) {
+        parameters.push_back(literal(number(values[i])));
+      }
+    }
+    const std::string expression =
+        FormulaTranslator(text(value, "expression"), variables(value), parameters).translate();
+    const std::string name = open();
+    body_m << "  return " << expression << ";\n}\n";
+    return {false, name};
+  }
+
+  /// Function of a generic formula and the number of parameters it uses.
+  struct GenericFormula {
+    std::string name;
+    std::size_t parameterCount = 0;
+  };
+
+  /// Function of generic formula @p index, taking the parameters as ``p``.
+  const GenericFormula &genericFormula(rapidjson::SizeType index) {
+    const auto it = generic_m.find(index);
+    if (it != generic_m.end()) {
+      return it->second;
+    }
+    const rapidjson::Value &formulas = array(correction_m, "generic_formulas");
+    if (index >= formulas.Size()) {
+      fail("formularef to missing generic formula " + std::to_string(index));
+    }
+    const rapidjson::Value &value = formulas[index];
+    checkParser(value);
+    // Parameters are bound per reference; 64 is well above any payload.
+    // formulaRef() checks that a reference supplies the ones used.
+    std::vector<std::string> parameters;
+    for (int i = 0; i < 64; ++i) {
+      parameters.push_back("p[" + std::to_string(i) + "]");
+    }
+    FormulaTranslator translator(text(value, "expression"), variables(value), parameters);
+    const std::string expression = translator.translate();
+    const std::string name = "formula" + std::to_string(index);
+    body_m << "\ndouble " << name << "(const double *x, const double *p) {\n  (void)p;\n"
+           << "  return " << expression << ";\n}\n";
+    return generic_m.emplace(index, GenericFormula{name, translator.parameterCount()})
+        .first->second;
+  }
+
+  Ref formulaRef(const rapidjson::Value &value) {
+    const rapidjson::Value &index = member(value, "index");
+    if (!index.IsUint()) {
+      fail("formularef without a valid index");
+    }
+    const GenericFormula &formula = genericFormula(index.GetUint());
+    const rapidjson::Value &parameters = array(value, "parameters");
+    if (parameters.Size() < formula.parameterCount) {
+      fail("formularef to generic formula " + std::to_string(index.GetUint()) + " with " +
+           std::to_string(parameters.Size()) + " parameters; the formula uses " +
+           std::to_string(formula.parameterCount));
+    }
+    std::ostringstream code;
+    code << "  static const double p[] = {";
+    for (rapidjson::SizeType i = 0; i < parameters.Size(); ++i) {
+      code << (i ? ", " : "") << literal(number(parameters[i]));
+    }
+    code << (parameters.Size() == 0 ? "0.0" : "") << "};\n  return " << formula.name
+         << "(x, p);\n}\n";
+    const std::string name = open();
+    body_m << code.str();
+    return {false, name};
+  }
+
+  Ref transform(const rapidjson::Value &value) {
+    const std::string inputName = text(value, "input");
+    const Input &in = input(inputName);
+    if (in.type == "string") {
+      fail("transform of string input '" + inputName + "'");
+    }
+    const Ref rule = node(member(value, "rule"));
+    const Ref content = node(member(value, "content"));
+    const std::size_t n = inputs_m.size();
+    std::ostringstream code;
+    code << "  double t[" << n << "];\n  std::copy(x, x + " << n << ", t);\n  t[" << in.index
+         << "] = " << (in.type == "int" ? "static_cast<double>(static_cast<long long>(" : "(")
+         << call(rule, "x") << (in.type == "int" ? "))" : ")") << ";\n  return "
+         << call(content, "t") << ";\n}\n";
+    const std::string name = open();
+    body_m << code.str();
+    return {false, name};
+  }
+
+  const rapidjson::Value &correction_m;
+  std::map<std::string, Input> inputs_m;
+  std::map<rapidjson::SizeType, GenericFormula> generic_m;
+  std::ostringstream body_m;
+  std::size_t next_m = 0;
+};
+
+} // namespace
+
+struct CorrectionCompiler::Document {
+  rapidjson::Document json;
+};
+
+CorrectionCompiler::CorrectionCompiler(const std::string &json) {
+  auto parsed = std::make_shared<Document>();
+  rapidjson::Document &document = parsed->json;
+  document.Parse(json.c_str(), json.size());
+  if (document.HasParseError() || !document.IsObject() || !document.HasMember("corrections") ||
+      !document["corrections"].IsArray()) {
+    fail("invalid correctionlib document");
+  }
+  document_m = std::move(parsed);
+}
+
+std::string CorrectionCompiler::generate(const std::string &json, const std::string &name) {
+  return CorrectionCompiler(json).generate(name);
+}
+
+std::string CorrectionCompiler::generate(const std::string &name) const {
+  const rapidjson::Value &corrections = document_m->json["corrections"];
+  for (rapidjson::SizeType i = 0; i < corrections.Size(); ++i) {
+    const rapidjson::Value &correction = corrections[i];
+    if (correction.IsObject() && correction.HasMember("name") && correction["name"].IsString() &&
+        name == correction["name"].GetString()) {
+      return Generator(correction).source();
+    }
+  }
+  fail("no correction named '" + name + "'");
+}
+
+CompiledCorrection::CompiledCorrection(correction::Correction::Ref correction, Function function)
+    : correction_m(std::move(correction)), function_m(function) {}
+
+double CompiledCorrection::evaluate(const std::vector<correction::Variable::Type> &values) const {
+  const std::size_t n = inputs().size();
+  if (values.size() != n) {
+    throw std::runtime_error("CompiledCorrection: '" + name() + "' expects " + std::to_string(n) +
+                             " inputs, got " + std::to_string(values.size()));
+  }
+  thread_local std::vector<double> numeric;
+  thread_local std::vector<const std::string *> strings;
+  numeric.assign(n, 0.0);
+  strings.assign(n, nullptr);
+  for (std::size_t i = 0; i < n; ++i) {
+    if (const auto *real = std::get_if<double>(&values[i])) {
+      numeric[i] = *real;
+    } else if (const auto *integer = std::get_if<int>(&values[i])) {
+      numeric[i] = *integer;
+    } else {
+      strings[i] = &std::get<std::string>(values[i]);
+    }
+  }
+  return function_m(numeric.data(), strings.data());
+}
@@ -0,0 +1,91 @@
+#ifndef CORRECTIONCOMPILER_H_INCLUDED
+#define CORRECTIONCOMPILER_H_INCLUDED
+
+#include <correction.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * @brief C++ code generation for correctionlib corrections
+ *        (``compileCorrections``).
+ *
+ * correctionlib walks the node tree of a correction, and interprets the AST
+ * of every formula, at each evaluate() call.  The generator turns the JSON
+ * of a correction into C++: one function per node, binning edges and
+ * contents as static arrays, categories as comparisons and formulas as
+ * plain arithmetic.  The source is compiled once, through the JIT cache of
+ * the data frame provider (IDataFrameProvider::compileFunction()).
+ *
+ * Supported nodes: numbers, binning (with ``clamp``, ``error`` or a node as
+ * flow), multibinning, category, formula and formularef (TFormula parser)
+ * and transform.  A correction using another node type (``hashprng``) is
+ * not compiled and keeps the correctionlib evaluator.
+ */
+class CorrectionCompiler {
+public:
+  /**
+   * @brief Parse the correctionlib document @p json once, for generate()
+   *        of any number of its corrections.
+   * @throws std::runtime_error for invalid JSON.
+   */
+  explicit CorrectionCompiler(const std::string &json);
+
+  /**
+   * @brief C++ source of correction @p name of the parsed document (see the
+   *        static overload).
+   */
+  std::string generate(const std::string &name) const;
+
+  /**
+   * @brief C++ source of correction @p name of the correctionlib document
+   *        @p json.
+   *
+   * The source defines ``extern "C" double`` JitCache::kFunctionName
+   * ``(const double *x, const std::string *const *s)``, where @c x[i] is
+   * input i when it is numeric and @c s[i] points to it when it is a
+   * string.
+   *
+   * @throws std::runtime_error for an unknown correction, an unsupported
+   *         node type or formula, a formularef with fewer parameters than
+   *         its formula uses, or invalid JSON.
+   */
+  static std::string generate(const std::string &json, const std::string &name);
+
+private:
+  struct Document;
+  std::shared_ptr<const Document> document_m;
+};
+
+/**
+ * @brief A correction evaluated by its generated function.
+ *
+ * Exposes inputs() and evaluate() like correction::Correction, so that the
+ * evaluation paths of CorrectionManager accept either.
+ */
+class CompiledCorrection {
+public:
+  /// Entry point of a CorrectionCompiler source.
+  using Function = double (*)(const double *numeric, const std::string *const *strings);
+
+  CompiledCorrection(correction::Correction::Ref correction, Function function);
+
+  const std::vector<correction::Variable> &inputs() const { return correction_m->inputs(); }
+  const std::string &name() const { return correction_m->name(); }
+
+  /// Evaluate with correctionlib's argument list.
+  /// @throws std::runtime_error if the number of arguments is wrong.
+  double evaluate(const std::vector<correction::Variable::Type> &values) const;
+
+  /// Evaluate with the numeric and string inputs indexed by input position.
+  double evaluate(const double *numeric, const std::string *const *strings) const {
+    return function_m(numeric, strings);
+  }
+
+private:
+  correction::Correction::Ref correction_m;
+  Function function_m;
+};
+
+#endif // CORRECTIONCOMPILER_H_INCLUDED
@@ -1,4 +1,8 @@
 #include <CorrectionManager.h>
+#include <AsyncLogger.h>
+#include <CorrectionCompiler.h>
+#include <CorrectionSnapshotCache.h>
+#include <MetricsService.h>
 #include <analyzer.h>
 #include <api/IConfigurationProvider.h>
 #include <api/IDataFrameProvider.h>
@@ -8,7 +12,9 @@
 #include <algorithm>
 #include <cctype>
 #include <iostream>
+#include <memory>
 #include <stdexcept>
+#include <unordered_map>
 
 namespace {
 
@@ -127,6 +133,8 @@ Float_t evaluateScalarCorrection(
   return correction->evaluate(values);
 }
 
+} // namespace
+
 ROOT::VecOps::RVec<Float_t> evaluateVectorCorrection(
     const correction::Correction::Ref &correction,
     const std::vector<std::string> &stringArgs,
@@ -142,8 +150,11 @@ ROOT::VecOps::RVec<Float_t> evaluateVectorCorrection(
 
   const size_t objectCount = flatInputVector.size() / featureCount;
   ROOT::VecOps::RVec<Float_t> result(objectCount);
+  // One argument buffer for all objects: clear() keeps its capacity.
+  std::vector<std::variant<int, double, std::string>> values;
+  values.reserve(correction->inputs().size());
   for (size_t i = 0; i < objectCount; ++i) {
-    std::vector<std::variant<int, double, std::string>> values;
+    values.clear();
     auto stringArgIt = stringArgs.begin();
     auto doubleArgIt = flatInputVector.begin() + static_cast<std::ptrdiff_t>(i * featureCount);
     for (const auto &varType : correction->inputs()) {
@@ -178,8 +189,11 @@ ROOT::VecOps::RVec<Float_t> evaluateVectorCorrection(
 
   const size_t objectCount = flatInputVector.size() / featureCount;
   ROOT::VecOps::RVec<Float_t> result(objectCount);
+  // One argument buffer for all objects: clear() keeps its capacity.
+  std::vector<std::variant<int, double, std::string>> values;
+  values.reserve(correction->inputs().size());
   for (size_t i = 0; i < objectCount; ++i) {
-    std::vector<std::variant<int, double, std::string>> values;
+    values.clear();
     auto stringArgIt = stringArgs.begin();
     auto doubleArgIt = flatInputVector.begin() + static_cast<std::ptrdiff_t>(i * featureCount);
     for (const auto &varType : correction->inputs()) {
@@ -196,6 +210,227 @@ ROOT::VecOps::RVec<Float_t> evaluateVectorCorrection(
   return result;
 }
 
+namespace {
+
+/**
+ * @brief Input layout of a correction, resolved once at applyCorrectionVec()
+ * time for block evaluation.
+ *
+ * templateValues holds the string arguments in place and placeholders for the
+ * numeric inputs; numericSlots gives, for each numeric feature in stride
+ * order, the position it occupies in the correctionlib argument list.
+ */
+struct BlockCorrectionLayout {
+  std::vector<std::variant<int, double, std::string>> templateValues;
+  std::vector<std::size_t> numericSlots;
+  std::vector<bool> numericIsInt;
+  /// The string arguments of templateValues by position, for a compiled
+  /// correction; nullptr at the numeric slots.
+  std::vector<const std::string *> strings;
+};
+
+template <typename CorrectionRefT>
+std::shared_ptr<const BlockCorrectionLayout> resolveBlockCorrectionLayout(
+    const CorrectionRefT &correction,
+    const std::vector<std::string> &stringArgs,
+    size_t featureCount,
+    bool supportsIntInputs,
+    const std::string &correctionName) {
+  auto layout = std::make_shared<BlockCorrectionLayout>();
+
+  auto stringArgIt = stringArgs.begin();
+  for (const auto &varType : correction->inputs()) {
+    if (varType.typeStr() == "string") {
+      if (stringArgIt == stringArgs.end()) {
+        throw std::runtime_error(
+            "applyCorrectionVec: not enough string arguments for correction '" +
+            correctionName + "'");
+      }
+      layout->templateValues.emplace_back(*stringArgIt);
+      ++stringArgIt;
+      continue;
+    }
+    const bool isInt = supportsIntInputs && varType.typeStr() == "int";
+    layout->numericSlots.push_back(layout->templateValues.size());
+    layout->numericIsInt.push_back(isInt);
+    if (isInt) {
+      layout->templateValues.emplace_back(0);
+    } else {
+      layout->templateValues.emplace_back(0.0);
+    }
+  }
+
+  if (layout->numericSlots.size() != featureCount) {
+    throw std::runtime_error(
+        "applyCorrectionVec: correction '" + correctionName + "' expects " +
+        std::to_string(layout->numericSlots.size()) +
+        " numeric inputs but " + std::to_string(featureCount) +
+        " input columns were given");
+  }
+  for (const auto &value : layout->templateValues) {
+    layout->strings.push_back(std::get_if<std::string>(&value));
+  }
+  return layout;
+}
+
+/**
+ * @brief Number of objects in a flattened input block of @p featureCount
+ * values per object.
+ */
+size_t blockObjectCount(const ROOT::VecOps::RVec<double> &flatInputVector,
+                        size_t featureCount, const char *caller) {
+  if (featureCount == 0) {
+    throw std::runtime_error(std::string(caller) +
+                             ": the correction has no numeric inputs to count objects by");
+  }
+  if (flatInputVector.size() % featureCount != 0) {
+    throw std::runtime_error(std::string(caller) +
+                             ": flattened input size is not divisible by featureCount");
+  }
+  return flatInputVector.size() / featureCount;
+}
+
+/**
+ * @brief Evaluate a correction for the @p objectCount objects of a flattened
+ * input block, writing one result per object starting at @p out.
+ *
+ * Each thread keeps one argument buffer, refilled from the layout's template
+ * once per block; only the numeric slots are overwritten per object, so the
+ * object loop performs no allocation.  A correction without numeric inputs
+ * is evaluated once for all objects.
+ */
+template <typename CorrectionRefT>
+void evaluateBlockCorrectionInto(
+    const CorrectionRefT &correction,
+    const BlockCorrectionLayout &layout,
+    const ROOT::VecOps::RVec<double> &flatInputVector,
+    size_t objectCount,
+    Float_t *out) {
+  const size_t featureCount = layout.numericSlots.size();
+
+  thread_local std::vector<std::variant<int, double, std::string>> values;
+  values.assign(layout.templateValues.begin(), layout.templateValues.end());
+  if (featureCount == 0) {
+    std::fill(out, out + objectCount, static_cast<Float_t>(correction->evaluate(values)));
+    return;
+  }
+
+  const double *row = flatInputVector.data();
+  for (size_t i = 0; i < objectCount; ++i, row += featureCount) {
+    for (size_t f = 0; f < featureCount; ++f) {
+      auto &slot = values[layout.numericSlots[f]];
+      if (layout.numericIsInt[f]) {
+        slot = static_cast<int>(row[f]);
+      } else {
+        slot = row[f];
+      }
+    }
+    out[i] = correction->evaluate(values);
+  }
+}
+
+/**
+ * @brief evaluateBlockCorrectionInto() for a compiled correction: the numeric
+ * inputs go to a thread-local array and the strings are passed in place.
+ */
+void evaluateBlockCorrectionInto(
+    const std::shared_ptr<const CompiledCorrection> &correction,
+    const BlockCorrectionLayout &layout,
+    const ROOT::VecOps::RVec<double> &flatInputVector,
+    size_t objectCount,
+    Float_t *out) {
+  const size_t featureCount = layout.numericSlots.size();
+  thread_local std::vector<double> numeric;
+  numeric.resize(layout.templateValues.size());
+  if (featureCount == 0) {
+    std::fill(out, out + objectCount,
+              static_cast<Float_t>(correction->evaluate(numeric.data(), layout.strings.data())));
+    return;
+  }
+
+  const double *row = flatInputVector.data();
+  for (size_t i = 0; i < objectCount; ++i, row += featureCount) {
+    for (size_t f = 0; f < featureCount; ++f) {
+      numeric[layout.numericSlots[f]] =
+          layout.numericIsInt[f] ? static_cast<int>(row[f]) : row[f];
+    }
+    out[i] = correction->evaluate(numeric.data(), layout.strings.data());
+  }
+}
+
+/**
+ * @brief Evaluate a correction for every object of a flattened input block.
+ */
+template <typename CorrectionRefT>
+ROOT::VecOps::RVec<Float_t> evaluateBlockCorrection(
+    const CorrectionRefT &correction,
+    const BlockCorrectionLayout &layout,
+    const ROOT::VecOps::RVec<double> &flatInputVector) {
+  const size_t objectCount = blockObjectCount(
+      flatInputVector, layout.numericSlots.size(), "evaluateBlockCorrection");
+  ROOT::VecOps::RVec<Float_t> result(objectCount);
+  evaluateBlockCorrectionInto(correction, layout, flatInputVector, objectCount,
+                              result.data());
+  return result;
+}
+
+/**
+ * @brief Evaluate one correction for several string-argument layouts over the
+ * same flattened input block.
+ *
+ * The result is variation-major: entries [k * nObjects : (k + 1) * nObjects)
+ * hold the values for the k-th layout.
+ */
+template <typename CorrectionRefT>
+ROOT::VecOps::RVec<Float_t> evaluateBlockCorrectionBundle(
+    const CorrectionRefT &correction,
+    const std::vector<std::shared_ptr<const BlockCorrectionLayout>> &layouts,
+    const ROOT::VecOps::RVec<double> &flatInputVector) {
+  const size_t objectCount = blockObjectCount(
+      flatInputVector, layouts.front()->numericSlots.size(), "evaluateBlockCorrectionBundle");
+  ROOT::VecOps::RVec<Float_t> result(objectCount * layouts.size());
+  for (size_t k = 0; k < layouts.size(); ++k) {
+    evaluateBlockCorrectionInto(correction, *layouts[k], flatInputVector, objectCount,
+                                result.data() + k * objectCount);
+  }
+  return result;
+}
+
+/// One correction of a multi-correction bundle with its input layout.
+struct BundleMember {
+  correction::Correction::Ref correction;
+  correction::CompoundCorrection::Ref compound;
+  std::shared_ptr<const CompiledCorrection> compiled;
+  std::shared_ptr<const BlockCorrectionLayout> layout;
+};
+
+/**
+ * @brief Evaluate several corrections over the same flattened input block;
+ * variation-major like evaluateBlockCorrectionBundle().
+ */
+ROOT::VecOps::RVec<Float_t> evaluateBlockCorrectionMembers(
+    const std::vector<BundleMember> &members,
+    const ROOT::VecOps::RVec<double> &flatInputVector) {
+  const size_t objectCount = blockObjectCount(
+      flatInputVector, members.front().layout->numericSlots.size(),
+      "evaluateBlockCorrectionMembers");
+  ROOT::VecOps::RVec<Float_t> result(objectCount * members.size());
+  for (size_t k = 0; k < members.size(); ++k) {
+    Float_t *out = result.data() + k * objectCount;
+    if (members[k].compiled) {
+      evaluateBlockCorrectionInto(members[k].compiled, *members[k].layout,
+                                  flatInputVector, objectCount, out);
+    } else if (members[k].correction) {
+      evaluateBlockCorrectionInto(members[k].correction, *members[k].layout,
+                                  flatInputVector, objectCount, out);
+    } else {
+      evaluateBlockCorrectionInto(members[k].compound, *members[k].layout,
+                                  flatInputVector, objectCount, out);
+    }
+  }
+  return result;
+}
+
 template <typename CorrectionSetT>
 auto lookupCorrectionOrCompound(const CorrectionSetT &correctionSet,
                                 const std::string &name)
@@ -220,7 +455,10 @@ auto lookupCorrectionOrCompound(const CorrectionSetT &correctionSet,
  * @param configProvider Reference to the configuration provider
  */
 CorrectionManager::CorrectionManager(IConfigurationProvider const& configProvider) {
-  std::cout  << "Constructing CorrectionManager with config provider" << std::endl;
+  RDF_LOG_INFO << "Constructing CorrectionManager with config provider";
+  snapshotDir_m = configProvider.get("correctionCacheDir");
+  const std::string compile = configProvider.get("compileCorrections");
+  compileCorrections_m = compile == "true" || compile == "1";
   registerCorrectionlib(configProvider);
   initialized_m = true;
 }
@@ -271,6 +509,55 @@ static std::string makeBranchName(const std::string &correctionName,
   return name;
 }
 
+std::shared_ptr<correction::CorrectionSet>
+CorrectionManager::loadCorrectionSet(const std::string &file,
+                                     const std::vector<std::string> &keep) {
+  // Process-wide: plugins set up concurrently (parallelPluginSetup) add
+  // their allocations to the figure, so it is an approximation.
+  const double residentBefore = MetricsService::currentRssMegabytes();
+  std::string names;
+  for (const auto &name : keep) {
+    names += ";" + name;
+  }
+  const std::string digest = snapshotDir_m.empty() ? "" : models().contentHash(file);
+  std::shared_ptr<correction::CorrectionSet> correctionSet;
+  if (keep.empty()) {
+    correctionSet = models().get<correction::CorrectionSet>(
+        file, "", [&file] { return correction::CorrectionSet::from_file(file); });
+  } else if (digest.empty()) {
+    // Parse only the requested corrections; the rest of the document is
+    // dropped before correctionlib builds its evaluation trees.
+    correctionSet = models().get<correction::CorrectionSet>(file, "selected" + names, [&] {
+      const std::string json =
+          CorrectionSnapshotCache::prune(CorrectionSnapshotCache::readJson(file), keep);
+      return correction::CorrectionSet::from_string(json.c_str());
+    });
+  } else {
+    correctionSet = models().get<correction::CorrectionSet>(file, "snapshot" + names, [&] {
+      const CorrectionSnapshotCache cache(snapshotDir_m);
+      return CorrectionSnapshotCache::load(cache.snapshot(file, digest, keep));
+    });
+  }
+  // The config loops ask once per correction for the set of its file.
+  const bool recorded = std::any_of(loaded_m.begin(), loaded_m.end(), [&](const auto &load) {
+    return load.file == file && load.corrections == keep;
+  });
+  if (!recorded) {
+    loaded_m.push_back(
+        {file, keep, std::max(0.0, MetricsService::currentRssMegabytes() - residentBefore)});
+  }
+  return correctionSet;
+}
+
+std::unordered_map<std::string, std::vector<std::string>> CorrectionManager::correctionsByFile(
+    const std::vector<std::unordered_map<std::string, std::string>> &entries) {
+  std::unordered_map<std::string, std::vector<std::string>> names;
+  for (const auto &entry : entries) {
+    names[entry.at("file")].push_back(entry.at("correctionName"));
+  }
+  return names;
+}
+
 /**
  * @brief Register a correction directly from C++ code (without a config file).
  */
@@ -285,11 +572,14 @@ void CorrectionManager::registerCorrection(
         "' is already registered. Use a unique name for each correction.");
   }
   try {
-    auto correctionSet = correction::CorrectionSet::from_file(file);
+    auto correctionSet = loadCorrectionSet(file, {correctionlibName});
     const auto [corr, compoundCorr] =
         lookupCorrectionOrCompound(correctionSet, correctionlibName);
     if (corr) {
       objects_m.emplace(name, corr);
+      if (compileCorrections_m) {
+        generateSource(name, file, correctionlibName);
+      }
     } else {
       compoundObjects_m.emplace(name, compoundCorr);
     }
@@ -299,8 +589,8 @@ void CorrectionManager::registerCorrection(
         correctionlibName + "' from file '" + file + "' for registration as '" +
         name + "': " + e.what());
   }
-  std::cout << "CorrectionManager: registering correction '" << name
-            << "' from file '" << file << "'" << std::endl;
+  RDF_LOG_INFO << "CorrectionManager: registering correction '" << name
+               << "' from file '" << file << "'";
   features_m.emplace(name, inputVariables);
 }
 
@@ -319,7 +609,7 @@ void CorrectionManager::applyCorrection(const std::string &correctionName,
                                         const std::vector<std::string> &stringArguments,
                                         const std::vector<std::string> &inputColumns,
                                         const std::string &outputBranch) {
-  std::cout << "Applying correction " << correctionName << std::endl;
+  RDF_LOG_INFO << "Applying correction " << correctionName;
 
   if (!dataManager_m || !systematicManager_m) {
     throw std::runtime_error("CorrectionManager: DataManager or SystematicManager not set");
@@ -333,8 +623,20 @@ void CorrectionManager::applyCorrection(const std::string &correctionName,
   const std::vector<std::string> &resolvedInputs =
       inputColumns.empty() ? getCorrectionFeatures(correctionName) : inputColumns;
 
-  std::cout << "Defining input features for correction " << correctionName << std::endl;
+  RDF_LOG_INFO << "Defining input features for correction " << correctionName;
   dataManager_m->DefineVector(inputColName, resolvedInputs, "double", *systematicManager_m);
+  if (auto compiled = getCompiledCorrection(correctionName)) {
+    auto layout = resolveBlockCorrectionLayout(compiled, stringArguments,
+                                               resolvedInputs.size(), true, correctionName);
+    auto correctionLambda =
+        [compiled, layout](ROOT::VecOps::RVec<double> &inputVector) -> Float_t {
+      Float_t value;
+      evaluateBlockCorrectionInto(compiled, *layout, inputVector, 1, &value);
+      return value;
+    };
+    dataManager_m->Define(branchName, correctionLambda, {inputColName}, *systematicManager_m);
+    return;
+  }
   if (const auto corrIt = this->objects_m.find(correctionName);
       corrIt != this->objects_m.end()) {
     auto correction = corrIt->second;
@@ -372,6 +674,43 @@ CorrectionManager::getCorrection(const std::string &key) const {
   return getObject(key);
 }
 
+void CorrectionManager::generateSource(const std::string &name, const std::string &file,
+                                       const std::string &correctionlibName) {
+  try {
+    auto &document = documents_m[file];
+    if (!document) {
+      document = std::make_shared<const CorrectionCompiler>(
+          CorrectionSnapshotCache::readJson(file));
+    }
+    sources_m[name] = document->generate(correctionlibName);
+  } catch (const std::exception &e) {
+    RDF_LOG_WARN << "CorrectionManager: correction '" << name
+                 << "' is evaluated by correctionlib: " << e.what();
+  }
+}
+
+std::shared_ptr<const CompiledCorrection>
+CorrectionManager::getCompiledCorrection(const std::string &key) {
+  if (const auto it = compiled_m.find(key); it != compiled_m.end()) {
+    return it->second;
+  }
+  const auto source = sources_m.find(key);
+  if (source == sources_m.end() || !dataManager_m) {
+    return nullptr;
+  }
+  std::shared_ptr<const CompiledCorrection> compiled;
+  if (void *function = dataManager_m->compileFunction(source->second)) {
+    compiled = std::make_shared<const CompiledCorrection>(
+        getCorrection(key), reinterpret_cast<CompiledCorrection::Function>(function));
+  } else {
+    RDF_LOG_WARN << "CorrectionManager: correction '" << key
+                 << "' failed to compile and is evaluated by correctionlib";
+  }
+  sources_m.erase(source);
+  compiled_m.emplace(key, compiled);
+  return compiled;
+}
+
 correction::CompoundCorrection::Ref
 CorrectionManager::getCompoundCorrection(const std::string &key) const {
   const auto it = compoundObjects_m.find(key);
@@ -392,41 +731,18 @@ CorrectionManager::getCorrectionFeatures(const std::string &key) const {
 }
 
 /**
- * @brief Apply a correction over a vector of objects and store per-object
- *        results as an RVec<Float_t> column in the dataframe.
- *
- * @param correctionName  Name of the registered correction.
- * @param stringArguments Constant string arguments consumed by the correction.
- * @param inputColumns    Optional override for the RDF input column names
- *        (RVec columns).  When non-empty, used instead of configured columns.
- * @param outputBranch    Optional explicit output column name.
- *        When non-empty, used as-is instead of the auto-derived name.
+ * @brief Validate the input columns of a vector correction and define the
+ * flattened per-object input column @p inputVecName (once).
  */
-void CorrectionManager::applyCorrectionVec(
+void CorrectionManager::defineFlattenedInputs(
     const std::string &correctionName,
-    const std::vector<std::string> &stringArguments,
-    const std::vector<std::string> &inputColumns,
-    const std::string &outputBranch) {
-  std::cout << "Applying vector correction " << correctionName << std::endl;
-  if (!dataManager_m || !systematicManager_m) {
-    throw std::runtime_error(
-        "CorrectionManager: DataManager or SystematicManager not set");
-  }
-
-  const std::string branchName = outputBranch.empty()
-                                     ? makeBranchName(correctionName, stringArguments)
-                                     : outputBranch;
-
-  const std::vector<std::string> &resolvedInputs =
-      inputColumns.empty() ? getCorrectionFeatures(correctionName) : inputColumns;
-
+    const std::vector<std::string> &resolvedInputs,
+    const std::string &inputVecName) {
   // Validate that all required input columns exist in the dataframe.
   {
-    const auto existingColumns = dataManager_m->getDataFrame().GetColumnNames();
     std::vector<std::string> missing;
     for (const auto &f : resolvedInputs) {
-      if (std::find(existingColumns.begin(), existingColumns.end(), f) ==
-          existingColumns.end()) {
+      if (!dataManager_m->hasColumn(f)) {
         missing.push_back(f);
       }
     }
@@ -448,38 +764,75 @@ void CorrectionManager::applyCorrectionVec(
         "applyCorrectionVec: correction '" + correctionName +
         "' has no registered input variables");
   }
+  if (dataManager_m->hasColumn(inputVecName)) {
+    return;
+  }
+  ensureFlattenHelperDeclared();
+  const bool hasVectorInput = std::any_of(
+      resolvedInputs.begin(), resolvedInputs.end(), [&](const std::string &f) {
+        return isVectorColumnType(dataManager_m->columnType(f));
+      });
+  if (!hasVectorInput) {
+    throw std::runtime_error(
+        "applyCorrectionVec: at least one input column must be an RVec for correction '" +
+        correctionName + "'");
+  }
+
+  auto dfNode = dataManager_m->getDataFrame().Define(
+      inputVecName, buildFlattenRVecExpression(resolvedInputs));
+  dataManager_m->updateDataFrame(dfNode, {inputVecName});
+}
+
+/**
+ * @brief Apply a correction over a vector of objects and store per-object
+ *        results as an RVec<Float_t> column in the dataframe.
+ *
+ * @param correctionName  Name of the registered correction.
+ * @param stringArguments Constant string arguments consumed by the correction.
+ * @param inputColumns    Optional override for the RDF input column names
+ *        (RVec columns).  When non-empty, used instead of configured columns.
+ * @param outputBranch    Optional explicit output column name.
+ *        When non-empty, used as-is instead of the auto-derived name.
+ * @param blockEvaluation Evaluate each event's objects as one block against a
+ *        pre-resolved input layout with reused thread-local buffers.
+ */
+void CorrectionManager::applyCorrectionVec(
+    const std::string &correctionName,
+    const std::vector<std::string> &stringArguments,
+    const std::vector<std::string> &inputColumns,
+    const std::string &outputBranch,
+    bool blockEvaluation) {
+  RDF_LOG_INFO << "Applying vector correction " << correctionName;
+  if (!dataManager_m || !systematicManager_m) {
+    throw std::runtime_error(
+        "CorrectionManager: DataManager or SystematicManager not set");
+  }
+
+  const std::string branchName = outputBranch.empty()
+                                     ? makeBranchName(correctionName, stringArguments)
+                                     : outputBranch;
+
+  const std::vector<std::string> &resolvedInputs =
+      inputColumns.empty() ? getCorrectionFeatures(correctionName) : inputColumns;
+
   // The intermediate packed column name includes the branch suffix so that the
   // same correction can be applied with different string arguments without
   // column name collisions.
   const std::string inputVecName = "input_vec_" + branchName;
-  {
-    auto dfNode = dataManager_m->getDataFrame();
-    const auto existingColumns = dfNode.GetColumnNames();
-    if (std::find(existingColumns.begin(), existingColumns.end(),
-                  inputVecName) == existingColumns.end()) {
-      ensureFlattenHelperDeclared();
-      bool hasVectorInput = false;
-      std::vector<bool> isVectorInput;
-      isVectorInput.reserve(resolvedInputs.size());
-      for (const auto &f : resolvedInputs) {
-        const bool columnIsVector = isVectorColumnType(dfNode.GetColumnType(f));
-        isVectorInput.push_back(columnIsVector);
-        if (columnIsVector) {
-          hasVectorInput = true;
-        }
-      }
-
-      if (!hasVectorInput) {
-        throw std::runtime_error(
-            "applyCorrectionVec: at least one input column must be an RVec for correction '" +
-            correctionName + "'");
-      }
+  defineFlattenedInputs(correctionName, resolvedInputs, inputVecName);
 
-      dfNode = dfNode.Define(
-          inputVecName,
-          buildFlattenRVecExpression(resolvedInputs));
-      dataManager_m->setDataFrame(dfNode);
-    }
+  // A compiled correction is always evaluated as a block.
+  if (auto compiled = getCompiledCorrection(correctionName)) {
+    auto layout = resolveBlockCorrectionLayout(compiled, stringArguments,
+                                               resolvedInputs.size(), true, correctionName);
+    auto blockLambda =
+        [compiled, layout](const ROOT::VecOps::RVec<double>
+                               &flatInputVector) -> ROOT::VecOps::RVec<Float_t> {
+      return evaluateBlockCorrection(compiled, *layout, flatInputVector);
+    };
+    dataManager_m->Define(branchName, blockLambda, {inputVecName},
+                          *systematicManager_m);
+    return;
   }
 
   // Lambda that applies the correction to every object in the collection.
@@ -488,6 +841,18 @@ void CorrectionManager::applyCorrectionVec(
     auto correction = corrIt->second;
     auto stringArgs = stringArguments;
     const size_t featureCount = resolvedInputs.size();
+    if (blockEvaluation) {
+      auto layout = resolveBlockCorrectionLayout(
+          correction, stringArgs, featureCount, true, correctionName);
+      auto blockLambda =
+          [correction, layout](const ROOT::VecOps::RVec<double>
+                                   &flatInputVector) -> ROOT::VecOps::RVec<Float_t> {
+        return evaluateBlockCorrection(correction, *layout, flatInputVector);
+      };
+      dataManager_m->Define(branchName, blockLambda, {inputVecName},
+                            *systematicManager_m);
+      return;
+    }
     auto correctionLambda =
         [correction, stringArgs, featureCount](const ROOT::VecOps::RVec<double>
                                                    &flatInputVector) -> ROOT::VecOps::RVec<Float_t> {
@@ -504,6 +869,18 @@ void CorrectionManager::applyCorrectionVec(
     auto correction = compoundIt->second;
     auto stringArgs = stringArguments;
     const size_t featureCount = resolvedInputs.size();
+    if (blockEvaluation) {
+      auto layout = resolveBlockCorrectionLayout(
+          correction, stringArgs, featureCount, false, correctionName);
+      auto blockLambda =
+          [correction, layout](const ROOT::VecOps::RVec<double>
+                                   &flatInputVector) -> ROOT::VecOps::RVec<Float_t> {
+        return evaluateBlockCorrection(correction, *layout, flatInputVector);
+      };
+      dataManager_m->Define(branchName, blockLambda, {inputVecName},
+                            *systematicManager_m);
+      return;
+    }
     auto correctionLambda =
         [correction, stringArgs, featureCount](const ROOT::VecOps::RVec<double>
                                                    &flatInputVector) -> ROOT::VecOps::RVec<Float_t> {
@@ -518,6 +895,132 @@ void CorrectionManager::applyCorrectionVec(
   throw std::runtime_error("CorrectionManager::applyCorrectionVec: unknown correction '" + correctionName + "'");
 }
 
+/**
+ * @brief Evaluate a vector correction for several string-argument sets into
+ * one variation-major bundle column.
+ */
+void CorrectionManager::applyCorrectionVecBundle(
+    const std::string &correctionName,
+    const std::vector<std::vector<std::string>> &stringArgumentSets,
+    const std::vector<std::string> &inputColumns,
+    const std::string &outputBranch) {
+  RDF_LOG_INFO << "Applying bundled vector correction " << correctionName
+               << " (" << stringArgumentSets.size() << " variations)";
+  if (!dataManager_m || !systematicManager_m) {
+    throw std::runtime_error(
+        "CorrectionManager: DataManager or SystematicManager not set");
+  }
+  if (stringArgumentSets.empty()) {
+    throw std::runtime_error(
+        "applyCorrectionVecBundle: correction '" + correctionName +
+        "' needs at least one string-argument set");
+  }
+  if (outputBranch.empty()) {
+    throw std::runtime_error(
+        "applyCorrectionVecBundle: outputBranch must not be empty");
+  }
+
+  const std::vector<std::string> &resolvedInputs =
+      inputColumns.empty() ? getCorrectionFeatures(correctionName) : inputColumns;
+  const std::string inputVecName = "input_vec_" + outputBranch;
+  defineFlattenedInputs(correctionName, resolvedInputs, inputVecName);
+
+  auto defineBundle = [&](const auto &correction, bool supportsIntInputs) {
+    std::vector<std::shared_ptr<const BlockCorrectionLayout>> layouts;
+    layouts.reserve(stringArgumentSets.size());
+    for (const auto &stringArgs : stringArgumentSets) {
+      layouts.push_back(resolveBlockCorrectionLayout(
+          correction, stringArgs, resolvedInputs.size(), supportsIntInputs,
+          correctionName));
+    }
+    auto bundleLambda =
+        [correction, layouts](const ROOT::VecOps::RVec<double> &flatInputVector)
+        -> ROOT::VecOps::RVec<Float_t> {
+      return evaluateBlockCorrectionBundle(correction, layouts, flatInputVector);
+    };
+    dataManager_m->Define(outputBranch, bundleLambda, {inputVecName},
+                          *systematicManager_m);
+  };
+
+  if (auto compiled = getCompiledCorrection(correctionName)) {
+    defineBundle(compiled, true);
+    return;
+  }
+  if (const auto corrIt = this->objects_m.find(correctionName);
+      corrIt != this->objects_m.end()) {
+    defineBundle(corrIt->second, true);
+    return;
+  }
+  if (const auto compoundIt = compoundObjects_m.find(correctionName);
+      compoundIt != compoundObjects_m.end()) {
+    defineBundle(compoundIt->second, false);
+    return;
+  }
+
+  throw std::runtime_error("CorrectionManager::applyCorrectionVecBundle: unknown correction '" + correctionName + "'");
+}
+
+/**
+ * @brief Evaluate several corrections sharing their inputs into one
+ * variation-major bundle column.
+ */
+void CorrectionManager::applyCorrectionsVecBundle(
+    const std::vector<std::string> &correctionNames,
+    const std::vector<std::vector<std::string>> &stringArgumentSets,
+    const std::vector<std::string> &inputColumns,
+    const std::string &outputBranch) {
+  RDF_LOG_INFO << "Applying bundle of " << correctionNames.size()
+               << " vector corrections";
+  if (!dataManager_m || !systematicManager_m) {
+    throw std::runtime_error(
+        "CorrectionManager: DataManager or SystematicManager not set");
+  }
+  if (correctionNames.empty() || correctionNames.size() != stringArgumentSets.size()) {
+    throw std::runtime_error(
+        "applyCorrectionsVecBundle: needs one string-argument set per correction");
+  }
+  if (outputBranch.empty()) {
+    throw std::runtime_error(
+        "applyCorrectionsVecBundle: outputBranch must not be empty");
+  }
+
+  const std::vector<std::string> &resolvedInputs =
+      inputColumns.empty() ? getCorrectionFeatures(correctionNames.front()) : inputColumns;
+  const std::string inputVecName = "input_vec_" + outputBranch;
+  defineFlattenedInputs(correctionNames.front(), resolvedInputs, inputVecName);
+
+  std::vector<BundleMember> members;
+  members.reserve(correctionNames.size());
+  for (std::size_t k = 0; k < correctionNames.size(); ++k) {
+    const std::string &name = correctionNames[k];
+    BundleMember member;
+    if ((member.compiled = getCompiledCorrection(name))) {
+      member.layout = resolveBlockCorrectionLayout(
+          member.compiled, stringArgumentSets[k], resolvedInputs.size(), true, name);
+    } else if (const auto corrIt = objects_m.find(name); corrIt != objects_m.end()) {
+      member.correction = corrIt->second;
+      member.layout = resolveBlockCorrectionLayout(
+          member.correction, stringArgumentSets[k], resolvedInputs.size(), true, name);
+    } else if (const auto compoundIt = compoundObjects_m.find(name);
+               compoundIt != compoundObjects_m.end()) {
+      member.compound = compoundIt->second;
+      member.layout = resolveBlockCorrectionLayout(
+          member.compound, stringArgumentSets[k], resolvedInputs.size(), false, name);
+    } else {
+      throw std::runtime_error(
+          "CorrectionManager::applyCorrectionsVecBundle: unknown correction '" + name + "'");
+    }
+    members.push_back(std::move(member));
+  }
+  auto bundleLambda =
+      [members](const ROOT::VecOps::RVec<double> &flatInputVector)
+      -> ROOT::VecOps::RVec<Float_t> {
+    return evaluateBlockCorrectionMembers(members, flatInputVector);
+  };
+  dataManager_m->Define(outputBranch, bundleLambda, {inputVecName},
+                        *systematicManager_m);
+}
+
 /**
  * @brief Register corrections from correctionlib using the configuration
  * @param configProvider Reference to the configuration provider
@@ -530,13 +1033,15 @@ void CorrectionManager::registerCorrectionlib(
   if (correctionConfigFile.empty()) {
     correctionConfigFile = configProvider.get("correctionlibConfig");
   }
-  std::cout << "CorrectionManager: Registering corrections from config file: " << correctionConfigFile << std::endl;
+  RDF_LOG_INFO << "CorrectionManager: Registering corrections from config file: " << correctionConfigFile;
 
   const auto correctionConfig = configProvider.parseMultiKeyConfig(
       correctionConfigFile,
       {"file", "correctionName", "name", "inputVariables"});
   
-  std::cout << "CorrectionManager: Found " << correctionConfig.size() << " corrections in config file." << std::endl;
+  RDF_LOG_INFO << "CorrectionManager: Found " << correctionConfig.size() << " corrections in config file.";
+  // Each file is loaded once with all the corrections the config takes from it.
+  const auto namesByFile = correctionsByFile(correctionConfig);
 
   for (const auto &entryKeys : correctionConfig) {
     // Split the variable list on commas, save to vector
@@ -544,16 +1049,19 @@ void CorrectionManager::registerCorrectionlib(
         configProvider.splitString(entryKeys.at("inputVariables"), ",");
 
     // load correction object from json
-    auto correctionF =
-        correction::CorrectionSet::from_file(entryKeys.at("file"));
+    auto correctionF = loadCorrectionSet(entryKeys.at("file"),
+                                         namesByFile.at(entryKeys.at("file")));
     const auto [correction, compoundCorrection] =
         lookupCorrectionOrCompound(correctionF, entryKeys.at("correctionName"));
 
     // Add the correction and feature list to their maps
-    std::cout << "Adding correction " << entryKeys.at("name") << "!"
-              << std::endl;
+    RDF_LOG_INFO << "Adding correction " << entryKeys.at("name") << "!";
     if (correction) {
       objects_m.emplace(entryKeys.at("name"), correction);
+      if (compileCorrections_m) {
+        generateSource(entryKeys.at("name"), entryKeys.at("file"),
+                       entryKeys.at("correctionName"));
+      }
     } else {
       compoundObjects_m.emplace(entryKeys.at("name"), compoundCorrection);
     }
@@ -575,9 +1083,13 @@ void CorrectionManager::setupFromConfigFile() {
     correctionConfigFile = "correctionlibConfig";
   }
 
+  const std::string compile = configManager_m->get("compileCorrections");
+  compileCorrections_m = compileCorrections_m || compile == "true" || compile == "1";
+
   const auto correctionConfig = configManager_m->parseMultiKeyConfig(
     correctionConfigFile,
     {"file", "correctionName", "name", "inputVariables"});
+  const auto namesByFile = correctionsByFile(correctionConfig);
 
   for (const auto &entryKeys : correctionConfig) {
     // Split the variable list on commas, save to vector
@@ -585,16 +1097,19 @@ void CorrectionManager::setupFromConfigFile() {
         configManager_m->splitString(entryKeys.at("inputVariables"), ",");
 
     // load correction object from json
-    auto correctionF =
-      correction::CorrectionSet::from_file(entryKeys.at("file"));
+    auto correctionF = loadCorrectionSet(entryKeys.at("file"),
+                                         namesByFile.at(entryKeys.at("file")));
     const auto [correction, compoundCorrection] =
       lookupCorrectionOrCompound(correctionF, entryKeys.at("correctionName"));
 
     // Add the correction and feature list to their maps
-    std::cout << "Adding correction " << entryKeys.at("name") << "!"
-              << std::endl;
+    RDF_LOG_INFO << "Adding correction " << entryKeys.at("name") << "!";
     if (correction) {
       objects_m.emplace(entryKeys.at("name"), correction);
+      if (compileCorrections_m) {
+        generateSource(entryKeys.at("name"), entryKeys.at("file"),
+                       entryKeys.at("correctionName"));
+      }
     } else {
       compoundObjects_m.emplace(entryKeys.at("name"), compoundCorrection);
     }
@@ -604,8 +1119,8 @@ void CorrectionManager::setupFromConfigFile() {
   initialized_m = true;
 }
 void CorrectionManager::initialize() {
-  std::cout << "CorrectionManager: initialized with " << objects_m.size()
-            << " correction(s)." << std::endl;
+  RDF_LOG_INFO << "CorrectionManager: initialized with " << objects_m.size()
+               << " correction(s).";
 }
 
 void CorrectionManager::reportMetadata() {
@@ -618,6 +1133,30 @@ void CorrectionManager::reportMetadata() {
     first = false;
   }
   logger_m->log(ILogger::Level::Info, msg);
+  for (const auto &load : loaded_m) {
+    std::string corrections;
+    for (const auto &name : load.corrections) {
+      corrections += (corrections.empty() ? "" : ", ") + name;
+    }
+    logger_m->log(ILogger::Level::Info,
+                  "CorrectionManager: " + load.file + " [" +
+                      (corrections.empty() ? std::string("all") : corrections) +
+                      "]: ~" + std::to_string(load.residentMB) +
+                      " MB resident (process-wide growth during the load)");
+  }
+}
+
+std::unordered_map<std::string, std::string>
+CorrectionManager::collectProvenanceEntries() const {
+  std::unordered_map<std::string, double> residentByFile;
+  for (const auto &load : loaded_m) {
+    residentByFile[load.file] += load.residentMB;
+  }
+  std::unordered_map<std::string, std::string> entries;
+  for (const auto &[file, residentMB] : residentByFile) {
+    entries["resident_mb." + file] = std::to_string(residentMB);
+  }
+  return entries;
 }
 
 std::shared_ptr<CorrectionManager> CorrectionManager::create(
@@ -13,6 +13,8 @@
 #include <vector>
 
 class Analyzer;
+class CompiledCorrection;
+class CorrectionCompiler;
 
 /**
  * @class CorrectionManager
@@ -24,6 +26,11 @@ class Analyzer;
  *
  * Corrections can be registered either from a config file (via the constructor
  * or setupFromConfigFile()) or directly from C++ using registerCorrection().
+ *
+ * With ``compileCorrections=true`` each registered (non-compound) correction
+ * is translated to C++ (CorrectionCompiler) and compiled once, through the
+ * JIT cache, the first time it is applied; the correction columns then call
+ * the compiled function instead of correctionlib's evaluator.
  */
 class CorrectionManager
     : public NamedObjectManager<correction::Correction::Ref> {
@@ -129,10 +136,18 @@ public:
    *        these are used instead of the columns registered with the correction.
    * @param outputBranch    Optional explicit name for the output RDF column.
    *        When non-empty this name is used instead of the auto-derived name.
+   * @param blockEvaluation When true, the correction's input layout (string
+   *        argument positions and int/real numeric slots) is resolved once
+   *        here and each event's objects are evaluated as one block against a
+   *        reused thread-local argument buffer, instead of building a fresh
+   *        argument vector per object.  Results are identical to the default
+   *        path.
    *
    * @throws std::runtime_error if the DataManager or SystematicManager have
    *         not been set, if @p correctionName is not registered, or if any
-   *         required input column is missing from the dataframe.
+   *         required input column is missing from the dataframe.  With
+   *         @p blockEvaluation, also throws if the string arguments or input
+   *         columns do not match the correction's declared inputs.
    *
    * @code{.cpp}
    * // Suppose "jet_sf" is configured with inputVariables=jet_pt,jet_eta
@@ -146,12 +161,72 @@ public:
    * // Override input branches at call time (no config change needed):
    * correctionManager.applyCorrectionVec(
    *     "jet_sf", {"nominal"}, {"jet_pt_raw", "jet_eta"}, "jet_sf_raw_nominal");
+   *
+   * // Block evaluation for high-multiplicity collections:
+   * correctionManager.applyCorrectionVec("jet_sf", {"nominal"}, {}, "", true);
    * @endcode
    */
   void applyCorrectionVec(const std::string &correctionName,
                           const std::vector<std::string> &stringArguments,
                           const std::vector<std::string> &inputColumns = {},
-                          const std::string &outputBranch = "");
+                          const std::string &outputBranch = "",
+                          bool blockEvaluation = false);
+
+  /**
+   * @brief Evaluate a vector correction for several string-argument sets and
+   * store all results in one variation-major bundle column.
+   *
+   * The inputs are flattened once and every argument set is evaluated with
+   * block evaluation against the same flattened block.  Entry
+   * @c [k * nObjects + i] of @p outputBranch is the value of the i-th object
+   * for @c stringArgumentSets[k], so the bundle replaces one
+   * applyCorrectionVec() column per argument set.
+   *
+   * @param correctionName     Name of the correction.
+   * @param stringArgumentSets String arguments of each variation, in bundle order.
+   * @param inputColumns       Optional override for the RDF input columns.
+   * @param outputBranch       Name of the bundle column (required).
+   *
+   * @throws std::runtime_error under the same conditions as
+   *         applyCorrectionVec() with block evaluation, or if
+   *         @p stringArgumentSets or @p outputBranch is empty.
+   *
+   * @code{.cpp}
+   * correctionManager.applyCorrectionVecBundle(
+   *     "jet_jes", {{"Total", "up"}, {"Total", "down"}},
+   *     {"Jet_eta", "Jet_pt"}, "jet_jes_bundle");
+   * // jet_jes_bundle = [sf_up(jet0..jetN-1), sf_down(jet0..jetN-1)]
+   * @endcode
+   */
+  void applyCorrectionVecBundle(
+      const std::string &correctionName,
+      const std::vector<std::vector<std::string>> &stringArgumentSets,
+      const std::vector<std::string> &inputColumns,
+      const std::string &outputBranch);
+
+  /**
+   * @brief Evaluate several corrections with the same numeric inputs (e.g.
+   * one uncertainty payload per JES source) into one variation-major bundle
+   * column.
+   *
+   * Like applyCorrectionVecBundle(), but entry k of the bundle evaluates
+   * @c correctionNames[k] with @c stringArgumentSets[k]: the inputs are
+   * flattened once and all corrections are evaluated in one pass per event.
+   *
+   * @param correctionNames    Corrections, in bundle order.
+   * @param stringArgumentSets String arguments of each correction.
+   * @param inputColumns       Optional override for the RDF input columns
+   *                           (default: the features of the first correction).
+   * @param outputBranch       Name of the bundle column (required).
+   *
+   * @throws std::runtime_error for unknown corrections, mismatched sizes or
+   *         corrections whose numeric input counts differ.
+   */
+  void applyCorrectionsVecBundle(
+      const std::vector<std::string> &correctionNames,
+      const std::vector<std::vector<std::string>> &stringArgumentSets,
+      const std::vector<std::string> &inputColumns,
+      const std::string &outputBranch);
 
   /**
    * @brief Get a correction object by key
@@ -168,6 +243,27 @@ public:
   correction::CompoundCorrection::Ref
   getCompoundCorrection(const std::string &key) const;
 
+  /**
+   * @brief Compile the corrections registered from now on (see
+   *        CorrectionCompiler); the ``compileCorrections`` config key sets
+   *        it for the configured corrections.
+   */
+  void setCompileCorrections(bool enable) { compileCorrections_m = enable; }
+
+  /**
+   * @brief The compiled form of correction @p key, compiled on first use.
+   *
+   * @return nullptr if @p key is not compiled: compilation is disabled, the
+   *         correction is a compound one or uses a node type the compiler
+   *         does not support, or no compiler is available.
+   */
+  std::shared_ptr<const CompiledCorrection> getCompiledCorrection(const std::string &key);
+
+  /// Whether @p key names a registered compound correction.
+  bool isCompoundCorrection(const std::string &key) const {
+    return compoundObjects_m.count(key) != 0;
+  }
+
   /**
    * @brief Get the features for a correction by key
    * @param key Correction key
@@ -176,6 +272,21 @@ public:
   const std::vector<std::string> &
   getCorrectionFeatures(const std::string &key) const;
 
+  /**
+   * @brief Validate vector-correction inputs and define the flattened
+   * per-object input column @p inputVecName if it does not exist yet.
+   *
+   * The column is an RVec<double> holding the values of @p resolvedInputs
+   * row-major, one row per object; plugins that evaluate a correction in
+   * their own kernel read it like applyCorrectionVec() does.
+   *
+   * @throws std::runtime_error if an input column is missing or none of
+   *         them is an RVec.
+   */
+  void defineFlattenedInputs(const std::string &correctionName,
+                             const std::vector<std::string> &resolvedInputs,
+                             const std::string &inputVecName);
+
   /**
    * @brief Return the type of the manager
    */
@@ -183,16 +294,42 @@ public:
 
   void setupFromConfigFile() override;
 
+  /// Setup only reads files; it may overlap with other plugins' setup.
+  bool concurrentSetup() const override { return true; }
+
   /**
    * @brief Post-wiring initialization: logs loaded correction names.
    */
   void initialize() override;
 
   /**
-   * @brief Metadata hook: reports the list of loaded corrections to the logger.
+   * @brief Metadata hook: reports the list of loaded corrections and the
+   *        memory they take to the logger.
    */
   void reportMetadata() override;
 
+  /**
+   * @brief Provenance: ``resident_mb.<file>``, the approximate resident
+   *        memory the corrections loaded from each file added to the
+   *        process (see LoadedCorrections::residentMB).
+   */
+  std::unordered_map<std::string, std::string> collectProvenanceEntries() const override;
+
+  /// Corrections parsed together from one file, with the resident memory
+  /// the parse added to the process.
+  struct LoadedCorrections {
+    std::string file;
+    std::vector<std::string> corrections;
+    /// Growth of the resident set size of the process during the load, an
+    /// approximation: plugins set up concurrently (parallelPluginSetup)
+    /// are counted too, and 0 when another plugin had already loaded the
+    /// same corrections.
+    double residentMB = 0.0;
+  };
+
+  /// Every correction set loaded by this manager, in load order.
+  const std::vector<LoadedCorrections> &loadedCorrections() const { return loaded_m; }
+
 private:
   /**
    * @brief Register corrections from correctionlib using the configuration
@@ -200,11 +337,68 @@ private:
    */
   void registerCorrectionlib(const IConfigurationProvider &configProvider);
 
+  /**
+   * @brief Parse the corrections @p keep of @p file (all when empty), or
+   *        share the set already loaded by another plugin.
+   *
+   * Only the requested corrections (and those their compound corrections
+   * stack) are parsed; with ``correctionCacheDir`` they come from a
+   * memory-mapped snapshot instead of the source file.  The load is
+   * recorded in loadedCorrections().
+   */
+  std::shared_ptr<correction::CorrectionSet>
+  loadCorrectionSet(const std::string &file, const std::vector<std::string> &keep = {});
+
+  /**
+   * @brief Generate the source of @p name (correction @p correctionlibName
+   *        of the correctionlib document @p file) for getCompiledCorrection().
+   *
+   * Each file is read and parsed once.  A correction the compiler does not
+   * support is reported and left to correctionlib.
+   */
+  void generateSource(const std::string &name, const std::string &file,
+                      const std::string &correctionlibName);
+
+  /// Correction names of each file of a correction config, for loadCorrectionSet().
+  static std::unordered_map<std::string, std::vector<std::string>>
+  correctionsByFile(const std::vector<std::unordered_map<std::string, std::string>> &entries);
+
   std::unordered_map<std::string, correction::CompoundCorrection::Ref> compoundObjects_m;
 
   bool initialized_m = false;
+  /// Snapshot directory (``correctionCacheDir``); empty disables snapshots.
+  std::string snapshotDir_m;
+  /// Generate and compile corrections (``compileCorrections``).
+  bool compileCorrections_m = false;
+  /// Parsed correctionlib documents by file, for generateSource().
+  std::unordered_map<std::string, std::shared_ptr<const CorrectionCompiler>> documents_m;
+  /// Generated sources of the corrections not compiled yet.
+  std::unordered_map<std::string, std::string> sources_m;
+  std::vector<LoadedCorrections> loaded_m;
+  /// Compiled corrections; nullptr when compilation failed.
+  std::unordered_map<std::string, std::shared_ptr<const CompiledCorrection>> compiled_m;
 };
 
 
+/**
+ * @brief Evaluate @p correction once per object of a flattened input.
+ *
+ * @p flatInputVector holds the @p featureCount numeric inputs of every
+ * object in turn; @p stringArgs are the string inputs, shared by all
+ * objects.  This is the per-entry kernel of applyCorrectionVec().
+ *
+ * @throws std::runtime_error if @p featureCount is 0 or does not divide the
+ *         input size.
+ */
+ROOT::VecOps::RVec<Float_t> evaluateVectorCorrection(
+    const correction::Correction::Ref &correction,
+    const std::vector<std::string> &stringArgs,
+    const ROOT::VecOps::RVec<double> &flatInputVector, size_t featureCount);
+
+/// @copydoc evaluateVectorCorrection
+ROOT::VecOps::RVec<Float_t> evaluateVectorCorrection(
+    const correction::CompoundCorrection::Ref &correction,
+    const std::vector<std::string> &stringArgs,
+    const ROOT::VecOps::RVec<double> &flatInputVector, size_t featureCount);
 
 #endif // CORRECTIONMANAGER_H_INCLUDED 
\ No newline at end of file
@@ -0,0 +1,203 @@
+#include <CorrectionSnapshotCache.h>
+
+#include <TMD5.h>
+#include <rapidjson/document.h>
+#include <rapidjson/stringbuffer.h>
+#include <rapidjson/writer.h>
+#include <zlib.h>
+
+#include <algorithm>
+#include <array>
+#include <filesystem>
+#include <fstream>
+#include <set>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+/// Read-only memory map of a whole file, unmapped on destruction.
+class MappedFile {
+public:
+  explicit MappedFile(const std::string &path) {
+    fd_m = ::open(path.c_str(), O_RDONLY);
+    if (fd_m < 0) {
+      throw std::runtime_error("CorrectionSnapshotCache: cannot open '" + path + "'");
+    }
+    struct stat st {};
+    if (::fstat(fd_m, &st) != 0 || st.st_size == 0) {
+      ::close(fd_m);
+      throw std::runtime_error("CorrectionSnapshotCache: cannot read '" + path + "'");
+    }
+    size_m = static_cast<std::size_t>(st.st_size);
+    data_m = ::mmap(nullptr, size_m, PROT_READ, MAP_PRIVATE, fd_m, 0);
+    if (data_m == MAP_FAILED) {
+      ::close(fd_m);
+      throw std::runtime_error("CorrectionSnapshotCache: cannot map '" + path + "'");
+    }
+  }
+  ~MappedFile() {
+    ::munmap(data_m, size_m);
+    ::close(fd_m);
+  }
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+
+  const char *data() const { return static_cast<const char *>(data_m); }
+  std::size_t size() const { return size_m; }
+
+private:
+  int fd_m = -1;
+  void *data_m = nullptr;
+  std::size_t size_m = 0;
+};
+
+std::size_t pageSize() { return static_cast<std::size_t>(::sysconf(_SC_PAGESIZE)); }
+
+std::string md5Of(const std::string &data) {
+  TMD5 md5;
+  md5.Update(reinterpret_cast<const UChar_t *>(data.data()), static_cast<UInt_t>(data.size()));
+  md5.Final();
+  return md5.AsString();
+}
+
+std::string nameOf(const rapidjson::Value &entry) {
+  if (!entry.IsObject() || !entry.HasMember("name") || !entry["name"].IsString()) {
+    return "";
+  }
+  return entry["name"].GetString();
+}
+
+} // namespace
+
+CorrectionSnapshotCache::CorrectionSnapshotCache(std::string directory)
+    : directory_m(std::move(directory)) {}
+
+std::string CorrectionSnapshotCache::snapshot(const std::string &file, const std::string &digest,
+                                              const std::vector<std::string> &keep) const {
+  namespace fs = std::filesystem;
+  std::vector<std::string> names = keep;
+  std::sort(names.begin(), names.end());
+  names.erase(std::unique(names.begin(), names.end()), names.end());
+  std::string key = digest;
+  if (!names.empty()) {
+    std::string joined;
+    for (const auto &name : names) {
+      joined += name + '\n';
+    }
+    key += "-" + md5Of(joined);
+  }
+  const fs::path path = fs::path(directory_m) / (key + ".json");
+  if (fs::exists(path)) {
+    return path.string();
+  }
+
+  std::string json = readJson(file);
+  if (!names.empty()) {
+    json = prune(json, names);
+  }
+  // The parser needs a NUL after the document: a map whose size is not a
+  // multiple of the page size is zero-filled up to the page end.
+  if (json.size() % pageSize() == 0) {
+    json += '\n';
+  }
+  fs::create_directories(directory_m);
+  const fs::path tmp = path.string() + ".tmp." + std::to_string(::getpid());
+  {
+    std::ofstream out(tmp, std::ios::binary);
+    out.write(json.data(), static_cast<std::streamsize>(json.size()));
+    if (!out) {
+      throw std::runtime_error("CorrectionSnapshotCache: cannot write '" + tmp.string() + "'");
+    }
+  }
+  fs::rename(tmp, path);
+  return path.string();
+}
+
+std::unique_ptr<correction::CorrectionSet>
+CorrectionSnapshotCache::load(const std::string &path) {
+  MappedFile mapped(path);
+  if (mapped.size() % pageSize() != 0) {
+    return correction::CorrectionSet::from_string(mapped.data());
+  }
+  // Not written by snapshot(): no terminating NUL inside the map.
+  return correction::CorrectionSet::from_string(
+      std::string(mapped.data(), mapped.size()).c_str());
+}
+
+std::string CorrectionSnapshotCache::readJson(const std::string &file) {
+  // gzread passes uncompressed files through unchanged.
+  gzFile in = gzopen(file.c_str(), "rb");
+  if (!in) {
+    throw std::runtime_error("CorrectionSnapshotCache: cannot open '" + file + "'");
+  }
+  std::string json;
+  std::array<char, 1 << 16> buf{};
+  int n = 0;
+  while ((n = gzread(in, buf.data(), static_cast<unsigned>(buf.size()))) > 0) {
+    json.append(buf.data(), static_cast<std::size_t>(n));
+  }
+  gzclose(in);
+  if (n < 0) {
+    throw std::runtime_error("CorrectionSnapshotCache: cannot decompress '" + file + "'");
+  }
+  return json;
+}
+
+std::string CorrectionSnapshotCache::prune(const std::string &json,
+                                           const std::vector<std::string> &keep) {
+  rapidjson::Document doc;
+  doc.Parse(json.c_str());
+  if (doc.HasParseError() || !doc.IsObject()) {
+    throw std::runtime_error("CorrectionSnapshotCache: invalid correctionlib JSON");
+  }
+  auto &allocator = doc.GetAllocator();
+  std::set<std::string> wanted(keep.begin(), keep.end());
+  std::set<std::string> found;
+
+  // Compound corrections evaluate the corrections they stack.
+  if (doc.HasMember("compound_corrections") && doc["compound_corrections"].IsArray()) {
+    rapidjson::Value kept(rapidjson::kArrayType);
+    for (auto &compound : doc["compound_corrections"].GetArray()) {
+      const std::string name = nameOf(compound);
+      if (!wanted.count(name)) {
+        continue;
+      }
+      found.insert(name);
+      if (compound.HasMember("stack") && compound["stack"].IsArray()) {
+        for (const auto &member : compound["stack"].GetArray()) {
+          if (member.IsString()) {
+            wanted.insert(member.GetString());
+          }
+        }
+      }
+      kept.PushBack(compound, allocator);
+    }
+    doc["compound_corrections"] = kept;
+  }
+  if (doc.HasMember("corrections") && doc["corrections"].IsArray()) {
+    rapidjson::Value kept(rapidjson::kArrayType);
+    for (auto &correction : doc["corrections"].GetArray()) {
+      const std::string name = nameOf(correction);
+      if (wanted.count(name)) {
+        found.insert(name);
+        kept.PushBack(correction, allocator);
+      }
+    }
+    doc["corrections"] = kept;
+  }
+  for (const auto &name : wanted) {
+    if (!found.count(name)) {
+      throw std::runtime_error("CorrectionSnapshotCache: no correction '" + name + "'");
+    }
+  }
+
+  rapidjson::StringBuffer buffer;
+  rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+  doc.Accept(writer);
+  return std::string(buffer.GetString(), buffer.GetSize());
+}
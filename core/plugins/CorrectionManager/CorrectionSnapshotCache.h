@@ -0,0 +1,56 @@
+#ifndef CORRECTIONSNAPSHOTCACHE_H_INCLUDED
+#define CORRECTIONSNAPSHOTCACHE_H_INCLUDED
+
+#include <correction.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * @brief On-disk cache of pre-processed correctionlib files
+ *        (``correctionCacheDir``).
+ *
+ * correctionlib has no binary form of its compiled objects, so the snapshot
+ * is the part of the JSON a job needs: decompressed, reduced to the
+ * requested corrections (plus the corrections their compound corrections
+ * stack) and written once per campaign under the MD5 of the source file.
+ * Later jobs memory-map the snapshot and parse it in place, skipping the
+ * gzip inflation and the corrections they never evaluate; for a campaign
+ * file like jet_jerc.json.gz that is most of it.
+ *
+ * Snapshots are written to a temporary file and renamed, so concurrent jobs
+ * sharing the directory never read a partial snapshot.
+ */
+class CorrectionSnapshotCache {
+public:
+  explicit CorrectionSnapshotCache(std::string directory);
+
+  /**
+   * @brief Path of the snapshot of @p file (contents digest @p digest) that
+   *        keeps the corrections in @p keep (all when empty); written if it
+   *        does not exist yet.
+   * @throws std::runtime_error if the file cannot be read or a requested
+   *         correction is missing from it
+   */
+  std::string snapshot(const std::string &file, const std::string &digest,
+                       const std::vector<std::string> &keep) const;
+
+  /// Parse the snapshot at @p path through a read-only memory map.
+  static std::unique_ptr<correction::CorrectionSet> load(const std::string &path);
+
+  /// Contents of a correctionlib file, gzip-compressed or not.
+  static std::string readJson(const std::string &file);
+
+  /**
+   * @brief Reduce the correctionlib document @p json to the corrections and
+   *        compound corrections named in @p keep and those they depend on.
+   * @throws std::runtime_error for invalid JSON or unknown names
+   */
+  static std::string prune(const std::string &json, const std::vector<std::string> &keep);
+
+private:
+  std::string directory_m;
+};
+
+#endif // CORRECTIONSNAPSHOTCACHE_H_INCLUDED
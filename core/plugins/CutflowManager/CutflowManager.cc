@@ -2,21 +2,208 @@
 #include <analyzer.h>
 #include <RegionManager.h>
 #include <NullOutputSink.h>
+#include <SampleSet.h>
+#include <WeightManager.h>
+#include <BoolMaskColumn.h>
+#include <CheckpointService.h>
+#include <ROOT/RVec.hxx>
 #include <TFile.h>
 #include <TH1D.h>
 #include <TH2D.h>
 #include <TObject.h>
+#include <TVectorD.h>
 #include <api/ILogger.h>
 #include <api/IOutputSink.h>
+#include <array>
+#include <cmath>
+#include <cstdint>
 #include <iostream>
 #include <sstream>
 #include <stdexcept>
+#include <type_traits>
+#include <utility>
 
 // ---------------------------------------------------------------------------
 // Helper: pass a boolean column value as a filter predicate.
 // ---------------------------------------------------------------------------
 namespace {
 bool passBoolCut(bool pass) { return pass; }
+
+/// Column holding the cut mask of a counted node.
+constexpr const char *kCutMaskColumn = "cutflow_mask";
+
+/// Column holding the region membership word of the cutflow base node.
+constexpr const char *kMembershipColumn = "cutflow_region_membership";
+
+/// Column with the bit of the entry's sample set (multi-sample jobs).
+constexpr const char *kSampleMembershipColumn = "cutflow_sample_membership";
+
+/// Largest number of samples counted by the per-sample tally.
+constexpr std::size_t kMaxCutflowSamples = 64;
+
+/// Defines a column of a counted node from the given input columns.
+using ColumnDefiner = ROOT::RDF::RNode (*)(ROOT::RDF::RNode,
+                                           const std::vector<std::string> &);
+
+/// Column holding the cutflow weights of a counted node.
+constexpr const char *kCutflowWeightsColumn = "cutflow_weights";
+
+template <std::size_t>
+using WeightValue = double;
+
+/// Typed kernel packing N weight columns into one RVec.
+template <std::size_t... I>
+auto makeWeightPackKernel(std::index_sequence<I...>) {
+  return [](WeightValue<I>... weights) {
+    return ROOT::VecOps::RVec<double>{weights...};
+  };
+}
+
+template <std::size_t N>
+ROOT::RDF::RNode defineCutflowWeights(ROOT::RDF::RNode node,
+                                      const std::vector<std::string> &columns) {
+  return node.Define(kCutflowWeightsColumn,
+                     makeWeightPackKernel(std::make_index_sequence<N>{}),
+                     columns);
+}
+
+template <std::size_t... N>
+constexpr std::array<ColumnDefiner, sizeof...(N)>
+makeCutflowWeightDefiners(std::index_sequence<N...>) {
+  return {&defineCutflowWeights<N + 1>...};
+}
+
+/// cutflowWeightDefiners[n - 1] packs exactly n weight columns.
+constexpr auto cutflowWeightDefiners = makeCutflowWeightDefiners(
+    std::make_index_sequence<CutflowManager::kMaxCutflowWeights>{});
+
+/**
+ * @brief RDataFrame action filling the CutflowTally of every counted
+ *        selection, per slot.
+ *
+ * Tally 0 counts every entry reaching the node.  When the action also reads
+ * a region membership word, tally r + 1 counts the entries with bit r set,
+ * so all region cutflows share one action.  The slot tallies are merged in
+ * Finalize().
+ */
+class CutflowTallyAction
+    : public ROOT::Detail::RDF::RActionImpl<CutflowTallyAction> {
+public:
+  using Result_t = std::vector<CutflowTally>;
+
+  CutflowTallyAction(const CutflowTally &identity, std::size_t nRegions,
+                     unsigned int nSlots)
+      : slots_m(nSlots, Result_t(nRegions + 1, identity)),
+        result_m(std::make_shared<Result_t>(nRegions + 1, identity)) {}
+
+  CutflowTallyAction(CutflowTallyAction &&) = default;
+  CutflowTallyAction(const CutflowTallyAction &) = delete;
+
+  std::shared_ptr<Result_t> GetResultPtr() const { return result_m; }
+
+  void Initialize() {}
+  void InitTask(TTreeReader *, unsigned int) {}
+
+  void Exec(unsigned int slot, std::uint64_t mask) {
+    slots_m[slot][0].fill(mask);
+  }
+
+  void Exec(unsigned int slot, std::uint64_t mask,
+            const ROOT::VecOps::RVec<double> &weights) {
+    slots_m[slot][0].fill(mask, weights.data());
+  }
+
+  void Exec(unsigned int slot, std::uint64_t mask, std::uint64_t membership) {
+    fillMembers(slots_m[slot], mask, membership, nullptr);
+  }
+
+  void Exec(unsigned int slot, std::uint64_t mask, std::uint64_t membership,
+            const ROOT::VecOps::RVec<double> &weights) {
+    fillMembers(slots_m[slot], mask, membership, weights.data());
+  }
+
+  void Finalize() {
+    for (const auto &tallies : slots_m) {
+      for (std::size_t t = 0; t < tallies.size(); ++t) {
+        (*result_m)[t].merge(tallies[t]);
+      }
+    }
+  }
+
+  Result_t &PartialUpdate(unsigned int slot) { return slots_m[slot]; }
+
+  std::string GetActionName() const { return "CutflowTally"; }
+
+private:
+  static void fillMembers(Result_t &tallies, std::uint64_t mask,
+                          std::uint64_t membership, const double *weights) {
+    tallies[0].fill(mask, weights);
+    for (; membership != 0; membership &= membership - 1) {
+      tallies[1 + __builtin_ctzll(membership)].fill(mask, weights);
+    }
+  }
+
+  std::vector<Result_t> slots_m;
+  std::shared_ptr<Result_t> result_m;
+};
+
+/// Call @p visit on every counter of @p tally, in a fixed order.
+template <typename Tally, typename Visit>
+void visitCounters(Tally &tally, Visit &&visit) {
+  visit(tally.total);
+  for (auto *counters : {&tally.leadingPass, &tally.onlyFailed, &tally.patterns}) {
+    for (auto &count : *counters) {
+      visit(count);
+    }
+  }
+  for (auto *sums : {&tally.totalSumW, &tally.totalSumW2, &tally.leadingSumW,
+                     &tally.leadingSumW2, &tally.onlyFailedSumW,
+                     &tally.onlyFailedSumW2}) {
+    for (auto &sum : *sums) {
+      visit(sum);
+    }
+  }
+}
+
+/// Checkpoint payload of @p tallies: their counters as one TVectorD.
+std::unique_ptr<TObject> encodeTallies(const std::vector<CutflowTally> &tallies) {
+  std::vector<double> counters;
+  for (const auto &tally : tallies) {
+    visitCounters(tally, [&](const auto &value) {
+      counters.push_back(static_cast<double>(value));
+    });
+  }
+  return std::make_unique<TVectorD>(static_cast<Int_t>(counters.size()),
+                                    counters.data());
+}
+
+/**
+ * @brief Add a payload written by encodeTallies() to @p tallies.
+ * @throws std::runtime_error if the payload has another layout.
+ */
+void addEncodedTallies(std::vector<CutflowTally> &tallies,
+                       const TVectorD &payload) {
+  Int_t next = 0;
+  for (auto &tally : tallies) {
+    visitCounters(tally, [&](auto &value) {
+      if (next < payload.GetNrows()) {
+        value += static_cast<std::decay_t<decltype(value)>>(payload[next]);
+      }
+      ++next;
+    });
+  }
+  if (next != payload.GetNrows()) {
+    throw std::runtime_error(
+        "CutflowManager: checkpointed cutflow has " +
+        std::to_string(payload.GetNrows()) + " counters, expected " +
+        std::to_string(next) + "; the cuts differ from the preempted run.");
+  }
+}
+
+bool isDoubleColumn(ROOT::RDF::RNode node, const std::string &column) {
+  const auto type = node.GetColumnType(column);
+  return type == "double" || type == "Double_t";
+}
 } // anonymous namespace
 
 // ---------------------------------------------------------------------------
@@ -63,9 +250,197 @@ void CutflowManager::addCut(const std::string &name,
   dataManager_m->Filter(passBoolCut, {boolColumn});
 }
 
+ROOT::RDF::RResultPtr<std::vector<CutflowTally>>
+CutflowManager::bookTally(ROOT::RDF::RNode node,
+                          const std::string &membershipColumn,
+                          std::size_t nGroups) const {
+  std::vector<std::string> columns;
+  columns.reserve(cuts_m.size());
+  for (const auto &cut : cuts_m) {
+    columns.push_back(cut.column);
+  }
+  node = defineBoolMask(node, kCutMaskColumn, columns);
+  const CutflowTally identity(cuts_m.size(), patternCounts_m,
+                              weights_m.size());
+  CutflowTallyAction action(identity, membershipColumn.empty() ? 0 : nGroups,
+                            node.GetNSlots());
+
+  if (!weights_m.empty()) {
+    std::vector<std::string> weightColumns;
+    weightColumns.reserve(weights_m.size());
+    for (const auto &weight : weights_m) {
+      weightColumns.push_back(weight.column);
+    }
+    node = cutflowWeightDefiners[weightColumns.size() - 1](node, weightColumns);
+  }
+
+  using Weights = ROOT::VecOps::RVec<double>;
+  if (membershipColumn.empty()) {
+    if (weights_m.empty()) {
+      return node.Book<std::uint64_t>(std::move(action), {kCutMaskColumn});
+    }
+    return node.Book<std::uint64_t, Weights>(
+        std::move(action), {kCutMaskColumn, kCutflowWeightsColumn});
+  }
+  if (weights_m.empty()) {
+    return node.Book<std::uint64_t, std::uint64_t>(
+        std::move(action), {kCutMaskColumn, membershipColumn});
+  }
+  return node.Book<std::uint64_t, std::uint64_t, Weights>(
+      std::move(action),
+      {kCutMaskColumn, membershipColumn, kCutflowWeightsColumn});
+}
+
+void CutflowManager::addWeight(const std::string &label,
+                               const std::string &column) {
+  for (const auto &weight : weights_m) {
+    if (weight.label == label) {
+      throw std::runtime_error("CutflowManager::addWeight(): duplicate weight "
+                               "label '" + label + "'.");
+    }
+  }
+  if (weights_m.size() == kMaxCutflowWeights) {
+    throw std::runtime_error(
+        "CutflowManager::addWeight(): at most " +
+        std::to_string(kMaxCutflowWeights) + " weights are supported.");
+  }
+  weights_m.push_back({label, column});
+}
+
+void CutflowManager::bindToWeightManager(
+    const WeightManager &wm, const std::vector<std::string> &variations) {
+  const std::string &nominal = wm.getNominalWeightColumn();
+  if (nominal.empty()) {
+    throw std::runtime_error(
+        "CutflowManager::bindToWeightManager(): no nominal weight defined. "
+        "Call WeightManager::defineNominalWeight() first.");
+  }
+  addWeight("nominal", nominal);
+  const std::pair<std::string, std::string> directions[] = {{"up", "Up"},
+                                                            {"down", "Down"}};
+  for (const auto &variation : variations) {
+    for (const auto &[direction, suffix] : directions) {
+      const std::string column = wm.getWeightColumn(variation, direction);
+      if (column.empty()) {
+        throw std::runtime_error(
+            "CutflowManager::bindToWeightManager(): weight variation '" +
+            variation + "' (" + direction + ") is not defined.");
+      }
+      addWeight(variation + suffix, column);
+    }
+  }
+}
+
+std::vector<WeightedCutflow>
+CutflowManager::weightedCutflows(const CutflowTally &tally) const {
+  std::vector<WeightedCutflow> cutflows;
+  for (std::size_t w = 0; w < weights_m.size(); ++w) {
+    WeightedCutflow cutflow;
+    cutflow.label = weights_m[w].label;
+    cutflow.column = weights_m[w].column;
+    cutflow.totalSumW = tally.totalSumW[w];
+    cutflow.totalSumW2 = tally.totalSumW2[w];
+    cutflow.sumW = tally.cumulativeSums(w, false);
+    cutflow.sumW2 = tally.cumulativeSums(w, true);
+    cutflow.nMinusOneSumW = tally.nMinusOneSums(w, false);
+    cutflow.nMinusOneSumW2 = tally.nMinusOneSums(w, true);
+    if (weightScale_m != 1.0) {
+      const double scale2 = weightScale_m * weightScale_m;
+      cutflow.totalSumW *= weightScale_m;
+      cutflow.totalSumW2 *= scale2;
+      for (auto *sums : {&cutflow.sumW, &cutflow.nMinusOneSumW}) {
+        for (double &sum : *sums) sum *= weightScale_m;
+      }
+      for (auto *sums : {&cutflow.sumW2, &cutflow.nMinusOneSumW2}) {
+        for (double &sum : *sums) sum *= scale2;
+      }
+    }
+    cutflows.push_back(std::move(cutflow));
+  }
+  return cutflows;
+}
+
 void CutflowManager::execute() {
   if (cuts_m.empty()) return;
 
+  if (patternCounts_m && cuts_m.size() > kMaxPatternCuts) {
+    throw std::runtime_error(
+        "CutflowManager::execute(): pattern counts need at most " +
+        std::to_string(kMaxPatternCuts) + " cuts, got " +
+        std::to_string(cuts_m.size()) + ".");
+  }
+  if (cuts_m.size() > kMaxMaskedCuts) {
+    if (!weights_m.empty()) {
+      throw std::runtime_error(
+          "CutflowManager::execute(): weighted cutflows need at most " +
+          std::to_string(kMaxMaskedCuts) + " cuts, got " +
+          std::to_string(cuts_m.size()) + ".");
+    }
+    bookFilterChains();
+    return;
+  }
+  for (const auto &weight : weights_m) {
+    if (!isDoubleColumn(cuts_m[0].dfNode, weight.column)) {
+      throw std::runtime_error("CutflowManager::execute(): weight column '" +
+                               weight.column + "' of '" + weight.label +
+                               "' is not a double column.");
+    }
+  }
+
+  // The "base" node is captured before the first cut's filter was applied
+  // and carries the boolean columns of every registered cut.  Total,
+  // sequential, N-1 and pattern counts all come from one tally on it.
+  regionPending_m.clear();
+  sampleTallyResult_m = {};
+  regionsFromMembership_m = regionManager_m &&
+                            regionManager_m->isMembershipMode() &&
+                            !regionManager_m->getRegionNames().empty();
+  if (regionsFromMembership_m) {
+    // One action counts the global and every region cutflow, filling
+    // region r for the events with bit r of the membership word set.
+    auto node = regionManager_m->defineMembershipColumn(cuts_m[0].dfNode,
+                                                        kMembershipColumn);
+    tallyResult_m = bookTally(node, kMembershipColumn,
+                              regionManager_m->getRegionNames().size());
+  } else {
+    tallyResult_m = bookTally(cuts_m[0].dfNode);
+
+    // -----------------------------------------------------------------------
+    // Per-region tallies (all on the same computation graph → single pass)
+    // -----------------------------------------------------------------------
+    if (regionManager_m) {
+      for (const auto &regionName : regionManager_m->getRegionNames()) {
+        RegionCutflowPending pending;
+        pending.tally =
+            bookTally(regionManager_m->getRegionDataFrame(regionName));
+        regionPending_m.emplace(regionName, std::move(pending));
+      }
+    }
+  }
+
+  // A multi-sample job counts every sample with one more tally, filling
+  // sample s for the entries whose sampleIndex is s.
+  sampleNames_m = configManager_m
+                      ? SampleSet::fromConfig(*configManager_m).names()
+                      : std::vector<std::string>{};
+  if (sampleNames_m.empty()) return;
+  if (sampleNames_m.size() > kMaxCutflowSamples) {
+    throw std::runtime_error(
+        "CutflowManager::execute(): per-sample cutflows need at most " +
+        std::to_string(kMaxCutflowSamples) + " samples, got " +
+        std::to_string(sampleNames_m.size()) + ".");
+  }
+  auto node = cuts_m[0].dfNode.Define(
+      kSampleMembershipColumn,
+      [](Float_t sample) {
+        return std::uint64_t{1} << static_cast<unsigned int>(sample);
+      },
+      {SampleSet::kIndexColumn});
+  sampleTallyResult_m =
+      bookTally(node, kSampleMembershipColumn, sampleNames_m.size());
+}
+
+void CutflowManager::bookFilterChains() {
   // The "base" node is captured before the first cut's filter was applied.
   // It must carry all boolean columns used by every registered cut so that
   // N-1 chains can be constructed from it.
@@ -74,15 +449,13 @@ void CutflowManager::execute() {
   // Book total event count (before any registered cut).
   totalCountResult_m = baseDf.Count();
 
-  // Sequential cutflow:
-  //   cuts_m[j].dfNode has cuts 0..j-1 applied as filters;
-  //   applying cut j's column as a filter yields the count after cuts 0..j.
+  // Sequential cutflow: apply each cut in turn from the base node, matching
+  // the counts of the cut-mask tally.
   cutflowCountResults_m.clear();
+  ROOT::RDF::RNode accumulatedDf = baseDf;
   for (const auto &cut : cuts_m) {
-    // Copy to a non-const local: RNode::Filter() is not const-qualified.
-    ROOT::RDF::RNode dfNode = cut.dfNode;
-    auto filtered = dfNode.Filter(passBoolCut, {cut.column});
-    cutflowCountResults_m.push_back(filtered.Count());
+    accumulatedDf = accumulatedDf.Filter(passBoolCut, {cut.column});
+    cutflowCountResults_m.push_back(accumulatedDf.Count());
   }
 
   // N-1 counts:
@@ -135,41 +508,128 @@ void CutflowManager::execute() {
   }
 }
 
-void CutflowManager::finalize() {
+void CutflowManager::bookCheckpoint(CheckpointService &checkpoints) {
+  restoredTallies_m.clear();
   if (cuts_m.empty()) return;
+  if (!tallyResult_m) {
+    throw std::runtime_error(
+        "CutflowManager::bookCheckpoint(): checkpoints need at most " +
+        std::to_string(kMaxMaskedCuts) + " cuts, got " +
+        std::to_string(cuts_m.size()) + ".");
+  }
 
-  // Retrieve all lazy results (event loop must have completed by now).
-  totalEventCount_m = totalCountResult_m.GetValue();
+  std::vector<std::pair<std::string,
+                        ROOT::RDF::RResultPtr<std::vector<CutflowTally>>>>
+      tallies{{"cutflow", tallyResult_m}};
+  for (const auto &[regionName, pending] : regionPending_m) {
+    if (pending.tally) {
+      tallies.emplace_back("cutflow_" + regionName, pending.tally);
+    }
+  }
+  if (sampleTallyResult_m) {
+    tallies.emplace_back("cutflow_samples", sampleTallyResult_m);
+  }
+  for (auto &[key, result] : tallies) {
+    checkpoints.watch(key, result, encodeTallies);
+    if (!checkpoints.resuming()) continue;
+    const TObject *restored = checkpoints.restored(key);
+    if (!dynamic_cast<const TVectorD *>(restored)) {
+      throw std::runtime_error(
+          "CutflowManager::bookCheckpoint(): the checkpoint has no tally '" +
+          key + "'; the cutflow differs from the preempted run.");
+    }
+    restoredTallies_m.push_back(
+        {result, std::unique_ptr<TObject>(restored->Clone())});
+  }
+}
 
-  cutflowCounts_m.clear();
-  for (std::size_t i = 0; i < cuts_m.size(); ++i) {
-    cutflowCounts_m.emplace_back(cuts_m[i].name,
-                                 cutflowCountResults_m[i].GetValue());
+void CutflowManager::finalize() {
+  if (cuts_m.empty()) return;
+
+  // Add the tallies of the preempted run this job resumed.
+  for (auto &restored : restoredTallies_m) {
+    addEncodedTallies(*restored.result,
+                      static_cast<const TVectorD &>(*restored.payload));
   }
+  restoredTallies_m.clear();
 
-  nMinusOneCounts_m.clear();
-  for (std::size_t i = 0; i < cuts_m.size(); ++i) {
-    nMinusOneCounts_m.emplace_back(cuts_m[i].name,
-                                   nMinusOneCountResults_m[i].GetValue());
+  // Retrieve all lazy results (event loop must have completed by now).
+  const auto labelled = [this](const std::vector<ULong64_t> &counts) {
+    std::vector<std::pair<std::string, ULong64_t>> named;
+    for (std::size_t i = 0; i < cuts_m.size(); ++i) {
+      named.emplace_back(cuts_m[i].name, counts[i]);
+    }
+    return named;
+  };
+
+  if (tallyResult_m) {
+    const CutflowTally &tally = (*tallyResult_m)[0];
+    totalEventCount_m = tally.total;
+    cutflowCounts_m = labelled(tally.cumulativeCounts());
+    nMinusOneCounts_m = labelled(tally.nMinusOneCounts());
+    patternCountValues_m = tally.patterns;
+    weightedCutflows_m = weightedCutflows(tally);
+  } else {
+    totalEventCount_m = totalCountResult_m.GetValue();
+
+    cutflowCounts_m.clear();
+    for (std::size_t i = 0; i < cuts_m.size(); ++i) {
+      cutflowCounts_m.emplace_back(cuts_m[i].name,
+                                   cutflowCountResults_m[i].GetValue());
+    }
+
+    nMinusOneCounts_m.clear();
+    for (std::size_t i = 0; i < cuts_m.size(); ++i) {
+      nMinusOneCounts_m.emplace_back(cuts_m[i].name,
+                                     nMinusOneCountResults_m[i].GetValue());
+    }
   }
 
   // Retrieve per-region results.
   regionResults_m.clear();
   if (regionManager_m) {
-    for (const auto &regionName : regionManager_m->getRegionNames()) {
-      auto &pending = regionPending_m.at(regionName);
+    const auto &regionNames = regionManager_m->getRegionNames();
+    for (std::size_t r = 0; r < regionNames.size(); ++r) {
+      const auto &regionName = regionNames[r];
       RegionCutflowResult result;
-      result.totalCount = pending.totalCount.GetValue();
-      for (std::size_t i = 0; i < cuts_m.size(); ++i) {
-        result.cutflowCounts.emplace_back(cuts_m[i].name,
-                                          pending.cutflowCounts[i].GetValue());
-        result.nMinusOneCounts.emplace_back(
-            cuts_m[i].name, pending.nMinusOneCounts[i].GetValue());
+      if (regionsFromMembership_m || regionPending_m.at(regionName).tally) {
+        const CutflowTally &tally =
+            regionsFromMembership_m ? (*tallyResult_m)[r + 1]
+                                    : (*regionPending_m.at(regionName).tally)[0];
+        result.totalCount = tally.total;
+        result.cutflowCounts = labelled(tally.cumulativeCounts());
+        result.nMinusOneCounts = labelled(tally.nMinusOneCounts());
+        result.patternCounts = tally.patterns;
+        result.weightedCutflows = weightedCutflows(tally);
+      } else {
+        auto &pending = regionPending_m.at(regionName);
+        result.totalCount = pending.totalCount.GetValue();
+        for (std::size_t i = 0; i < cuts_m.size(); ++i) {
+          result.cutflowCounts.emplace_back(
+              cuts_m[i].name, pending.cutflowCounts[i].GetValue());
+          result.nMinusOneCounts.emplace_back(
+              cuts_m[i].name, pending.nMinusOneCounts[i].GetValue());
+        }
       }
       regionResults_m.emplace(regionName, std::move(result));
     }
   }
 
+  // Retrieve per-sample results.
+  sampleResults_m.clear();
+  if (sampleTallyResult_m) {
+    for (std::size_t s = 0; s < sampleNames_m.size(); ++s) {
+      const CutflowTally &tally = (*sampleTallyResult_m)[s + 1];
+      RegionCutflowResult result;
+      result.totalCount = tally.total;
+      result.cutflowCounts = labelled(tally.cumulativeCounts());
+      result.nMinusOneCounts = labelled(tally.nMinusOneCounts());
+      result.patternCounts = tally.patterns;
+      result.weightedCutflows = weightedCutflows(tally);
+      sampleResults_m.emplace(sampleNames_m[s], std::move(result));
+    }
+  }
+
   // Write histograms to the meta output ROOT file.
   if (dynamic_cast<NullOutputSink *>(metaSink_m) != nullptr) return;
 
@@ -219,6 +679,52 @@ void CutflowManager::finalize() {
     hist.Write("cutflow_nminus1", TObject::kOverwrite);
   }
 
+  // Weighted cutflow and N-1 histograms: sum of weights per bin, with
+  // errors from the sum of squared weights.
+  for (const auto &cutflow : weightedCutflows_m) {
+    const std::string name = "cutflow_" + cutflow.label;
+    TH1D hist(name.c_str(), ("Cutflow (" + cutflow.label + ");Cut;Events").c_str(),
+              nCuts + 1, -0.5, static_cast<double>(nCuts) + 0.5);
+    hist.Sumw2();
+    hist.GetXaxis()->SetBinLabel(1, "total");
+    hist.SetBinContent(1, cutflow.totalSumW);
+    hist.SetBinError(1, std::sqrt(cutflow.totalSumW2));
+    for (int b = 0; b < nCuts; ++b) {
+      hist.GetXaxis()->SetBinLabel(b + 2, cuts_m[b].name.c_str());
+      hist.SetBinContent(b + 2, cutflow.sumW[b]);
+      hist.SetBinError(b + 2, std::sqrt(cutflow.sumW2[b]));
+    }
+    hist.SetDirectory(&outFile);
+    hist.Write(name.c_str(), TObject::kOverwrite);
+
+    const std::string nMinusOneName = "cutflow_nminus1_" + cutflow.label;
+    TH1D histN1(nMinusOneName.c_str(),
+                ("N-1 Cutflow (" + cutflow.label + ");Cut removed;Events").c_str(),
+                nCuts, -0.5, static_cast<double>(nCuts) - 0.5);
+    histN1.Sumw2();
+    for (int b = 0; b < nCuts; ++b) {
+      histN1.GetXaxis()->SetBinLabel(b + 1, cuts_m[b].name.c_str());
+      histN1.SetBinContent(b + 1, cutflow.nMinusOneSumW[b]);
+      histN1.SetBinError(b + 1, std::sqrt(cutflow.nMinusOneSumW2[b]));
+    }
+    histN1.SetDirectory(&outFile);
+    histN1.Write(nMinusOneName.c_str(), TObject::kOverwrite);
+  }
+
+  // Pattern histogram: bin m + 1 counts events with cut mask m.
+  if (!patternCountValues_m.empty()) {
+    const int nPatterns = static_cast<int>(patternCountValues_m.size());
+    TH1D hist("cutflow_patterns",
+              "Cut patterns;Cut mask (bit i = cut i passed);Events", nPatterns,
+              -0.5, static_cast<double>(nPatterns) - 0.5);
+    for (int m = 0; m < nPatterns; ++m) {
+      hist.SetBinContent(m + 1,
+                         static_cast<double>(patternCountValues_m[m]));
+    }
+    hist.SetDirectory(&outFile);
+    hist.Write("cutflow_patterns", TObject::kOverwrite);
+  }
+
   // -------------------------------------------------------------------------
   // Region-aware output: a single TH2D (regions × cuts).
   // Using one large 2-D histogram keeps the output compact and avoids
@@ -268,6 +774,30 @@ void CutflowManager::finalize() {
     hist2d.Write("cutflow_regions", TObject::kOverwrite);
   }
 
+  // Per-sample output: one TH2D (samples × cuts), same layout without the
+  // global column.
+  if (!sampleResults_m.empty()) {
+    const int nSamples = static_cast<int>(sampleNames_m.size());
+    TH2D hist2d("cutflow_samples", "Cutflow per Sample;Sample;Cut", nSamples,
+                -0.5, static_cast<double>(nSamples) - 0.5, nCuts + 1, -0.5,
+                static_cast<double>(nCuts) + 0.5);
+    hist2d.GetYaxis()->SetBinLabel(1, "total");
+    for (int b = 0; b < nCuts; ++b) {
+      hist2d.GetYaxis()->SetBinLabel(b + 2, cuts_m[b].name.c_str());
+    }
+    for (int s = 0; s < nSamples; ++s) {
+      const auto &res = sampleResults_m.at(sampleNames_m[s]);
+      hist2d.GetXaxis()->SetBinLabel(s + 1, sampleNames_m[s].c_str());
+      hist2d.SetBinContent(s + 1, 1, static_cast<double>(res.totalCount));
+      for (int b = 0; b < nCuts; ++b) {
+        hist2d.SetBinContent(s + 1, b + 2,
+                             static_cast<double>(res.cutflowCounts[b].second));
+      }
+    }
+    hist2d.SetDirectory(&outFile);
+    hist2d.Write("cutflow_samples", TObject::kOverwrite);
+  }
+
   outFile.Close();
 }
 
@@ -289,6 +819,31 @@ void CutflowManager::reportMetadata() {
   }
   logger_m->log(ILogger::Level::Info, ss2.str());
 
+  for (const auto &cutflow : weightedCutflows_m) {
+    std::ostringstream ssw;
+    ssw << "CutflowManager: weighted cutflow (" << cutflow.label << ")\n";
+    ssw << "  total: " << cutflow.totalSumW << " +- "
+        << std::sqrt(cutflow.totalSumW2) << "\n";
+    for (std::size_t i = 0; i < cuts_m.size(); ++i) {
+      ssw << "  after " << cuts_m[i].name << ": " << cutflow.sumW[i] << " +- "
+          << std::sqrt(cutflow.sumW2[i]) << "\n";
+    }
+    logger_m->log(ILogger::Level::Info, ssw.str());
+  }
+
+  if (!sampleResults_m.empty()) {
+    std::ostringstream sss;
+    sss << "CutflowManager: per-sample sequential cutflow\n";
+    for (const auto &sampleName : sampleNames_m) {
+      const auto &res = sampleResults_m.at(sampleName);
+      sss << "  [" << sampleName << "] total: " << res.totalCount << "\n";
+      for (const auto &[name, count] : res.cutflowCounts) {
+        sss << "  [" << sampleName << "] after " << name << ": " << count << "\n";
+      }
+    }
+    logger_m->log(ILogger::Level::Info, sss.str());
+  }
+
   if (!regionManager_m || regionManager_m->getRegionNames().empty()) return;
 
   std::ostringstream ss3;
@@ -337,6 +892,30 @@ CutflowManager::getRegionNMinusOneCounts(const std::string &regionName) const {
   return it->second.nMinusOneCounts;
 }
 
+const std::vector<ULong64_t> &
+CutflowManager::getRegionPatternCounts(const std::string &regionName) const {
+  auto it = regionResults_m.find(regionName);
+  if (it == regionResults_m.end()) {
+    throw std::runtime_error(
+        "CutflowManager::getRegionPatternCounts(): region '" + regionName +
+        "' not found. Ensure bindToRegionManager() was called and the "
+        "analysis has been run.");
+  }
+  return it->second.patternCounts;
+}
+
+const std::vector<WeightedCutflow> &
+CutflowManager::getRegionWeightedCutflows(const std::string &regionName) const {
+  auto it = regionResults_m.find(regionName);
+  if (it == regionResults_m.end()) {
+    throw std::runtime_error(
+        "CutflowManager::getRegionWeightedCutflows(): region '" + regionName +
+        "' not found. Ensure bindToRegionManager() was called and the "
+        "analysis has been run.");
+  }
+  return it->second.weightedCutflows;
+}
+
 ULong64_t
 CutflowManager::getRegionTotalCount(const std::string &regionName) const {
   auto it = regionResults_m.find(regionName);
@@ -349,6 +928,30 @@ CutflowManager::getRegionTotalCount(const std::string &regionName) const {
   return it->second.totalCount;
 }
 
+const std::vector<std::pair<std::string, ULong64_t>> &
+CutflowManager::getSampleCutflowCounts(const std::string &sampleName) const {
+  auto it = sampleResults_m.find(sampleName);
+  if (it == sampleResults_m.end()) {
+    throw std::runtime_error(
+        "CutflowManager::getSampleCutflowCounts(): sample '" + sampleName +
+        "' not found. Ensure sampleConfig lists it and the analysis has "
+        "been run.");
+  }
+  return it->second.cutflowCounts;
+}
+
+ULong64_t
+CutflowManager::getSampleTotalCount(const std::string &sampleName) const {
+  auto it = sampleResults_m.find(sampleName);
+  if (it == sampleResults_m.end()) {
+    throw std::runtime_error(
+        "CutflowManager::getSampleTotalCount(): sample '" + sampleName +
+        "' not found. Ensure sampleConfig lists it and the analysis has "
+        "been run.");
+  }
+  return it->second.totalCount;
+}
+
 // ---------------------------------------------------------------------------
 // collectProvenanceEntries()
 // ---------------------------------------------------------------------------
@@ -368,6 +971,15 @@ CutflowManager::collectProvenanceEntries() const {
     entries["cuts"] = ss.str();
   }
 
+  if (!weights_m.empty()) {
+    std::ostringstream ss;
+    for (std::size_t i = 0; i < weights_m.size(); ++i) {
+      if (i > 0) ss << ',';
+      ss << weights_m[i].label << ':' << weights_m[i].column;
+    }
+    entries["weights"] = ss.str();
+  }
+
   return entries;
 }
 
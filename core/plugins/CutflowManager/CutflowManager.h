@@ -1,6 +1,7 @@
 #ifndef CUTFLOWMANAGER_H_INCLUDED
 #define CUTFLOWMANAGER_H_INCLUDED
 
+#include <api/ICheckpointParticipant.h>
 #include <api/IPluggableManager.h>
 #include <api/IConfigurationProvider.h>
 #include <api/IDataFrameProvider.h>
@@ -11,6 +12,9 @@
 #include <ROOT/RDataFrame.hxx>
 #include <ROOT/RResultPtr.hxx>
 #include <RtypesCore.h>
+#include <TObject.h>
+#include <cstddef>
+#include <cstdint>
 #include <string>
 #include <unordered_map>
 #include <utility>
@@ -19,8 +23,159 @@
 
 class Analyzer;
 
-// Forward declaration to avoid circular includes.
+// Forward declarations to avoid circular includes.
 class RegionManager;
+class WeightManager;
+
+/**
+ * @brief Event counters of one cutflow, filled from a per-event cut mask.
+ *
+ * Bit i of the mask is set when the event passes cut i.  fill() updates a
+ * constant number of counters per event and weight; the cumulative and N-1
+ * tables are derived from them after the event loop.  One tally is kept per
+ * processing slot and the slot tallies are merged at the end.
+ */
+struct CutflowTally {
+  std::size_t nCuts = 0;
+  std::size_t nWeights = 0;
+  /// Mask with the bits of all nCuts cuts set.
+  std::uint64_t passMask = 0;
+  /// Events seen.
+  ULong64_t total = 0;
+  /// leadingPass[k]: events passing cuts 0..k-1 and failing cut k
+  /// (k = nCuts: events passing every cut).
+  std::vector<ULong64_t> leadingPass;
+  /// onlyFailed[i]: events failing cut i and passing every other cut.
+  std::vector<ULong64_t> onlyFailed;
+  /// patterns[m]: events whose cut mask is m; empty unless requested.
+  std::vector<ULong64_t> patterns;
+  /// Sum of weight w (and of its square) over all events.
+  std::vector<double> totalSumW, totalSumW2;
+  /// Element w * (nCuts + 1) + k: weight sums of the leadingPass[k] events.
+  std::vector<double> leadingSumW, leadingSumW2;
+  /// Element w * nCuts + i: weight sums of the onlyFailed[i] events.
+  std::vector<double> onlyFailedSumW, onlyFailedSumW2;
+
+  CutflowTally() = default;
+
+  CutflowTally(std::size_t cuts, bool withPatterns, std::size_t weights = 0)
+      : nCuts(cuts), nWeights(weights),
+        passMask(cuts >= 64 ? ~std::uint64_t{0}
+                            : (std::uint64_t{1} << cuts) - 1),
+        leadingPass(cuts + 1, 0), onlyFailed(cuts, 0),
+        patterns(withPatterns ? (std::size_t{1} << cuts) : 0, 0),
+        totalSumW(weights, 0.0), totalSumW2(weights, 0.0),
+        leadingSumW(weights * (cuts + 1), 0.0),
+        leadingSumW2(weights * (cuts + 1), 0.0),
+        onlyFailedSumW(weights * cuts, 0.0),
+        onlyFailedSumW2(weights * cuts, 0.0) {}
+
+  /// Count one event; @p weights holds nWeights values.
+  void fill(std::uint64_t mask, const double *weights = nullptr) {
+    ++total;
+    const std::uint64_t failed = ~mask & passMask;
+    const std::size_t firstFailed =
+        failed == 0 ? nCuts : static_cast<std::size_t>(__builtin_ctzll(failed));
+    const bool failedOnlyOne = failed != 0 && (failed & (failed - 1)) == 0;
+    ++leadingPass[firstFailed];
+    if (failedOnlyOne) {
+      ++onlyFailed[firstFailed];
+    }
+    if (!patterns.empty()) {
+      ++patterns[mask & passMask];
+    }
+    for (std::size_t w = 0; w < nWeights; ++w) {
+      const double x = weights[w];
+      const double x2 = x * x;
+      totalSumW[w] += x;
+      totalSumW2[w] += x2;
+      leadingSumW[w * (nCuts + 1) + firstFailed] += x;
+      leadingSumW2[w * (nCuts + 1) + firstFailed] += x2;
+      if (failedOnlyOne) {
+        onlyFailedSumW[w * nCuts + firstFailed] += x;
+        onlyFailedSumW2[w * nCuts + firstFailed] += x2;
+      }
+    }
+  }
+
+  void merge(const CutflowTally &other) {
+    total += other.total;
+    addInto(leadingPass, other.leadingPass);
+    addInto(onlyFailed, other.onlyFailed);
+    addInto(patterns, other.patterns);
+    addInto(totalSumW, other.totalSumW);
+    addInto(totalSumW2, other.totalSumW2);
+    addInto(leadingSumW, other.leadingSumW);
+    addInto(leadingSumW2, other.leadingSumW2);
+    addInto(onlyFailedSumW, other.onlyFailedSumW);
+    addInto(onlyFailedSumW2, other.onlyFailedSumW2);
+  }
+
+  /// Events passing cuts 0..j, for every cut j.
+  std::vector<ULong64_t> cumulativeCounts() const {
+    return cumulative(leadingPass.data());
+  }
+
+  /// Events passing every cut except cut i, for every cut i.
+  std::vector<ULong64_t> nMinusOneCounts() const {
+    return nMinusOne(leadingPass.data(), onlyFailed.data());
+  }
+
+  /// Sum of weight @p w (or of its square) after cuts 0..j, for every cut j.
+  std::vector<double> cumulativeSums(std::size_t w, bool squared) const {
+    const auto &leading = squared ? leadingSumW2 : leadingSumW;
+    return cumulative(leading.data() + w * (nCuts + 1));
+  }
+
+  /// Sum of weight @p w (or of its square) of the N-1 selections.
+  std::vector<double> nMinusOneSums(std::size_t w, bool squared) const {
+    const auto &leading = squared ? leadingSumW2 : leadingSumW;
+    const auto &only = squared ? onlyFailedSumW2 : onlyFailedSumW;
+    return nMinusOne(leading.data() + w * (nCuts + 1), only.data() + w * nCuts);
+  }
+
+private:
+  template <typename T>
+  static void addInto(std::vector<T> &into, const std::vector<T> &from) {
+    for (std::size_t i = 0; i < into.size(); ++i) {
+      into[i] += from[i];
+    }
+  }
+
+  template <typename T>
+  std::vector<T> cumulative(const T *leading) const {
+    std::vector<T> sums(nCuts, T{});
+    T passing{};
+    for (std::size_t j = nCuts; j-- > 0;) {
+      passing += leading[j + 1];
+      sums[j] = passing;
+    }
+    return sums;
+  }
+
+  template <typename T>
+  std::vector<T> nMinusOne(const T *leading, const T *only) const {
+    std::vector<T> sums(nCuts, T{});
+    for (std::size_t i = 0; i < nCuts; ++i) {
+      sums[i] = leading[nCuts] + only[i];
+    }
+    return sums;
+  }
+};
+
+/**
+ * @brief Weighted cutflow of one weight column (populated after run()).
+ */
+struct WeightedCutflow {
+  std::string label;  ///< Weight label, e.g. "nominal" or "pileupUp"
+  std::string column; ///< Weight column
+  double totalSumW = 0.0;
+  double totalSumW2 = 0.0;
+  std::vector<double> sumW;           ///< after cuts 0..j
+  std::vector<double> sumW2;          ///< after cuts 0..j
+  std::vector<double> nMinusOneSumW;  ///< all cuts except cut i
+  std::vector<double> nMinusOneSumW2; ///< all cuts except cut i
+};
 
 /**
  * @class CutflowManager
@@ -35,6 +190,23 @@ class RegionManager;
  * ensures the base node (captured at the first addCut) carries every column
  * needed for the N-1 computation.
  *
+ * ### Counting
+ *
+ * execute() defines a cut-mask column (bit i = cut i) once per counted
+ * node and books a single aggregation on it, so the global table and each
+ * region cost one action regardless of the number of cuts.  Counts refer
+ * to the registered cuts applied in order from the base node; filters
+ * applied to the main dataframe outside addCut() are not part of the
+ * cutflow.  With more than kMaxMaskedCuts cuts, execute() falls back to one
+ * Filter/Count chain per cumulative and N-1 count.
+ *
+ * enablePatternCounts() additionally counts every pass/fail pattern of the
+ * cuts, i.e. events per cut mask (at most kMaxPatternCuts cuts).
+ *
+ * addWeight() and bindToWeightManager() register weight columns whose sums
+ * of weights and of squared weights are accumulated by the same action, so
+ * weighted cutflows need no Sum() bookings of their own.
+ *
  * ### Region-aware mode
  *
  * Call bindToRegionManager() after all cuts and regions have been declared.
@@ -47,6 +219,12 @@ class RegionManager;
  *  - Per-region results are accessible via getRegionCutflowCounts(),
  *    getRegionNMinusOneCounts(), and getRegionTotalCount().
  *
+ * If the RegionManager is in membership mode (RegionManager::setMembershipMode),
+ * the region cutflows are instead filled by the global action from the
+ * region membership word defined on the base node, so all regions share one
+ * action and no region filter branch is created.  The region filter columns
+ * must then exist on the base node, and region counts start from it.
+ *
  * Typical usage:
  * @code
  *   // 1. Define all boolean cut columns upfront.
@@ -75,8 +253,17 @@ class RegionManager;
  * "cutflow_nminus1") to the meta output ROOT file and logged via the
  * analysis logger.  When regions are bound a TH2D histogram
  * "cutflow_regions" is additionally written.
+ *
+ * ### Multi-sample jobs
+ *
+ * In a multi-sample job (``sampleConfig``, see SampleSet) execute() also
+ * books one tally keyed by ``sampleIndex`` on the base node, so every
+ * sample gets its own cutflow in the same pass: written as the TH2D
+ * "cutflow_samples" (samples × cuts) and returned by
+ * getSampleCutflowCounts().  It needs at most kMaxMaskedCuts cuts and 64
+ * samples.
  */
-class CutflowManager : public IPluggableManager {
+class CutflowManager : public IPluggableManager, public ICheckpointParticipant {
 public:
 
   // -------------------------------------------------------------------------
@@ -85,6 +272,15 @@ public:
   static std::shared_ptr<CutflowManager> create(
       Analyzer& an, const std::string& role = "cutflowManager");
 
+  /// Largest number of cuts counted from a single cut-mask column.
+  static constexpr std::size_t kMaxMaskedCuts = 64;
+
+  /// Largest number of cuts for which pattern counts can be requested.
+  static constexpr std::size_t kMaxPatternCuts = 16;
+
+  /// Largest number of weight columns accumulated by one cutflow.
+  static constexpr std::size_t kMaxCutflowWeights = 32;
+
   CutflowManager() = default;
 
   /**
@@ -114,6 +310,51 @@ public:
    */
   void bindToRegionManager(RegionManager *rm);
 
+  /**
+   * @brief Also count events per pass/fail pattern of all cuts.
+   *
+   * Must be called before execute().  The patterns are written as the TH1D
+   * "cutflow_patterns" and returned by getPatternCounts().
+   *
+   * @param enable  True to count patterns.
+   */
+  void enablePatternCounts(bool enable = true) { patternCounts_m = enable; }
+
+  /**
+   * @brief Accumulate sums of weights per cut for a weight column.
+   *
+   * Like the cut columns, @p column must be a double column defined before
+   * the first addCut() call.  Must be called before execute().
+   *
+   * @param label   Label of the weighted cutflow (unique).
+   * @param column  Name of the weight column.
+   * @throws std::runtime_error on a duplicate label.
+   */
+  void addWeight(const std::string &label, const std::string &column);
+
+  /**
+   * @brief Accumulate the nominal weight and selected variations of a
+   *        WeightManager.
+   *
+   * Adds the nominal weight column under the label "nominal" and, for each
+   * entry of @p variations, the up and down columns under the labels
+   * variation + "Up" and variation + "Down".  The columns must already have
+   * been defined with defineNominalWeight() and defineVariedWeight().
+   *
+   * @param wm          WeightManager providing the columns.
+   * @param variations  Variation names as passed to addWeightVariation().
+   * @throws std::runtime_error if a requested column is not defined.
+   */
+  void bindToWeightManager(const WeightManager &wm,
+                           const std::vector<std::string> &variations = {});
+
+  /**
+   * @brief Multiply the weighted cutflows computed in finalize() by
+   *        @p scale (and the sums of squares by its square); used for the
+   *        deferred normalization of WeightManager.
+   */
+  void setWeightScale(double scale) { weightScale_m = scale; }
+
   /**
    * @brief Return the sequential cutflow counts (populated after run()).
    * @return Vector of (cut_label, event_count) in registration order.
@@ -135,6 +376,25 @@ public:
    */
   ULong64_t getTotalCount() const { return totalEventCount_m; }
 
+  /**
+   * @brief Return events per cut pattern (populated after run()).
+   *
+   * Element m counts the events whose cut mask is m, where bit i is set
+   * when the event passes cut i.  Empty unless enablePatternCounts() was
+   * called.
+   */
+  const std::vector<ULong64_t> &getPatternCounts() const {
+    return patternCountValues_m;
+  }
+
+  /**
+   * @brief Return the weighted cutflows (populated after run()).
+   * @return One entry per registered weight, in registration order.
+   */
+  const std::vector<WeightedCutflow> &getWeightedCutflows() const {
+    return weightedCutflows_m;
+  }
+
   /**
    * @brief Return per-region sequential cutflow counts (populated after run()).
    *
@@ -169,6 +429,43 @@ public:
    */
   ULong64_t getRegionTotalCount(const std::string &regionName) const;
 
+  /**
+   * @brief Return per-region events per cut pattern (populated after run()).
+   *
+   * Empty unless enablePatternCounts() was called.
+   *
+   * @param regionName  Declared region name.
+   * @throws std::runtime_error if @p regionName is unknown.
+   */
+  const std::vector<ULong64_t> &
+  getRegionPatternCounts(const std::string &regionName) const;
+
+  /**
+   * @brief Return per-region weighted cutflows (populated after run()).
+   *
+   * @param regionName  Declared region name.
+   * @throws std::runtime_error if @p regionName is unknown.
+   */
+  const std::vector<WeightedCutflow> &
+  getRegionWeightedCutflows(const std::string &regionName) const;
+
+  /**
+   * @brief Return the sequential cutflow counts of one sample of a
+   *        multi-sample job (populated after run()).
+   *
+   * @param sampleName  Sample name from ``sampleConfig``.
+   * @throws std::runtime_error if @p sampleName is unknown.
+   */
+  const std::vector<std::pair<std::string, ULong64_t>> &
+  getSampleCutflowCounts(const std::string &sampleName) const;
+
+  /**
+   * @brief Return the total event count of one sample of a multi-sample
+   *        job (populated after run()).
+   * @throws std::runtime_error if @p sampleName is unknown.
+   */
+  ULong64_t getSampleTotalCount(const std::string &sampleName) const;
+
   std::string type() const override { return "CutflowManager"; }
 
   void setContext(ManagerContext &ctx) override;
@@ -192,6 +489,19 @@ public:
    */
   void execute() override;
 
+  /**
+   * @brief Checkpoint the cut-mask tallies booked by execute().
+   *
+   * The global tally is stored under the key "cutflow" and the tally of a
+   * region under "cutflow_<region>".  Restored tallies are added to the
+   * results in finalize().
+   *
+   * @throws std::runtime_error with more than kMaxMaskedCuts cuts (the
+   *         Filter/Count chains cannot be checkpointed), or if the resumed
+   *         checkpoint lacks a tally.
+   */
+  void bookCheckpoint(CheckpointService &checkpoints) override;
+
   /**
    * @brief Retrieve count results and write tables to the meta output file.
    *
@@ -211,6 +521,8 @@ public:
    * Returns:
    *  - "cuts": comma-separated "name:boolColumn" pairs for each registered cut
    *  - "num_cuts": number of registered cuts
+   *  - "weights": comma-separated "label:column" pairs, if weights are
+   *    registered
    *
    * The Analyzer automatically computes "plugin.<role>.config_hash" from
    * these entries.
@@ -225,17 +537,56 @@ private:
     ROOT::RDF::RNode dfNode; ///< DF state before this cut's filter was applied
   };
 
+  struct WeightEntry {
+    std::string label;
+    std::string column;
+  };
+
   std::vector<CutEntry> cuts_m;
+  std::vector<WeightEntry> weights_m;
+  bool patternCounts_m = false;
+  double weightScale_m = 1.0;
+
+  /// Weighted cutflows of @p tally, labelled by weights_m.
+  std::vector<WeightedCutflow> weightedCutflows(const CutflowTally &tally) const;
+
+  /**
+   * @brief Book the cut-mask tally action on @p node.
+   *
+   * Without @p membershipColumn the result holds the tally of @p node only;
+   * with it, also one tally per bit of the membership word (element g + 1
+   * for bit g, @p nGroups bits: regions or samples).
+   */
+  ROOT::RDF::RResultPtr<std::vector<CutflowTally>>
+  bookTally(ROOT::RDF::RNode node, const std::string &membershipColumn = "",
+            std::size_t nGroups = 0) const;
+
+  /// Book one Filter/Count chain per count (more than kMaxMaskedCuts cuts).
+  void bookFilterChains();
 
   // Lazy RDataFrame count results (booked in execute(), read in finalize()).
+  // tallyResult_m is booked up to kMaxMaskedCuts cuts, the count chains
+  // beyond that.
+  ROOT::RDF::RResultPtr<std::vector<CutflowTally>> tallyResult_m;
+  // True if tallyResult_m also holds the region tallies (membership mode).
+  bool regionsFromMembership_m = false;
   ROOT::RDF::RResultPtr<ULong64_t> totalCountResult_m;
   std::vector<ROOT::RDF::RResultPtr<ULong64_t>> cutflowCountResults_m;
   std::vector<ROOT::RDF::RResultPtr<ULong64_t>> nMinusOneCountResults_m;
 
+  // Tallies restored from a checkpoint, added to their result in finalize().
+  struct RestoredTally {
+    ROOT::RDF::RResultPtr<std::vector<CutflowTally>> result;
+    std::unique_ptr<TObject> payload;
+  };
+  std::vector<RestoredTally> restoredTallies_m;
+
   // Final values populated in finalize().
   ULong64_t totalEventCount_m = 0;
   std::vector<std::pair<std::string, ULong64_t>> cutflowCounts_m;
   std::vector<std::pair<std::string, ULong64_t>> nMinusOneCounts_m;
+  std::vector<ULong64_t> patternCountValues_m;
+  std::vector<WeightedCutflow> weightedCutflows_m;
 
   // -------------------------------------------------------------------------
   // Region-aware state
@@ -244,6 +595,7 @@ private:
   RegionManager *regionManager_m = nullptr;
 
   struct RegionCutflowPending {
+    ROOT::RDF::RResultPtr<std::vector<CutflowTally>> tally;
     ROOT::RDF::RResultPtr<ULong64_t> totalCount;
     std::vector<ROOT::RDF::RResultPtr<ULong64_t>> cutflowCounts;
     std::vector<ROOT::RDF::RResultPtr<ULong64_t>> nMinusOneCounts;
@@ -253,11 +605,22 @@ private:
     ULong64_t totalCount = 0;
     std::vector<std::pair<std::string, ULong64_t>> cutflowCounts;
     std::vector<std::pair<std::string, ULong64_t>> nMinusOneCounts;
+    std::vector<ULong64_t> patternCounts;
+    std::vector<WeightedCutflow> weightedCutflows;
   };
 
   std::unordered_map<std::string, RegionCutflowPending> regionPending_m;
   std::unordered_map<std::string, RegionCutflowResult>  regionResults_m;
 
+  // -------------------------------------------------------------------------
+  // Per-sample state of a multi-sample job
+  // -------------------------------------------------------------------------
+
+  std::vector<std::string> sampleNames_m;
+  /// Element s + 1 holds the tally of sample s.
+  ROOT::RDF::RResultPtr<std::vector<CutflowTally>> sampleTallyResult_m;
+  std::unordered_map<std::string, RegionCutflowResult> sampleResults_m;
+
   IConfigurationProvider *configManager_m = nullptr;
   IDataFrameProvider *dataManager_m = nullptr;
   ILogger *logger_m = nullptr;
@@ -0,0 +1,337 @@
+#include <DatasetOverlapManager.h>
+#include <AsyncLogger.h>
+#include <TriggerManager.h>
+#include <analyzer.h>
+#include <api/ILogger.h>
+
+#include <ROOT/RDF/RActionImpl.hxx>
+#include <ROOT/RVec.hxx>
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
+#include <unistd.h>
+
+namespace {
+
+using EventKey = DatasetOverlapManager::EventKey;
+
+constexpr char kKeyFileMagic[8] = {'R', 'D', 'F', 'E', 'V', 'K', '2', '\0'};
+
+// Keys are written to and read from the key files as raw bytes.
+static_assert(sizeof(EventKey) == 16 && std::is_trivially_copyable_v<EventKey>,
+              "EventKey must be a packed 16-byte record");
+
+/**
+ * @brief RDataFrame action collecting the event keys of every slot.
+ */
+class EventKeyAction : public ROOT::Detail::RDF::RActionImpl<EventKeyAction> {
+public:
+  using Result_t = std::vector<EventKey>;
+
+  explicit EventKeyAction(unsigned int nSlots)
+      : slots_m(std::max(nSlots, 1u)), result_m(std::make_shared<Result_t>()) {}
+
+  EventKeyAction(EventKeyAction &&) = default;
+  EventKeyAction(const EventKeyAction &) = delete;
+
+  std::shared_ptr<Result_t> GetResultPtr() const { return result_m; }
+
+  void Initialize() {}
+  void InitTask(TTreeReader *, unsigned int) {}
+
+  void Exec(unsigned int slot, unsigned int run, unsigned int lumi, ULong64_t event) {
+    slots_m[slot].push_back(DatasetOverlapManager::eventKey(run, lumi, event));
+  }
+
+  void Finalize() {
+    for (auto &keys : slots_m) {
+      result_m->insert(result_m->end(), keys.begin(), keys.end());
+      Result_t().swap(keys);
+    }
+  }
+
+  std::string GetActionName() const { return "DatasetOverlapKeys"; }
+
+private:
+  std::vector<Result_t> slots_m;
+  std::shared_ptr<Result_t> result_m;
+};
+
+bool allBoolColumns(ROOT::RDF::RNode df, const std::vector<std::string> &paths) {
+  for (const auto &path : paths) {
+    const auto columnType = df.GetColumnType(path);
+    if (columnType != "bool" && columnType != "Bool_t") {
+      return false;
+    }
+  }
+  return true;
+}
+
+} // namespace
+
+void DatasetOverlapManager::setContext(ManagerContext &ctx) {
+  configManager_m = &ctx.config;
+  dataManager_m = &ctx.data;
+  systematicManager_m = &ctx.systematics;
+  logger_m = &ctx.logger;
+}
+
+void DatasetOverlapManager::setupFromConfigFile() {
+  if (!configManager_m) {
+    throw std::runtime_error("DatasetOverlapManager: ConfigManager not set");
+  }
+  datasets_m.clear();
+  const std::string configFile = configManager_m->get("datasetOverlapConfig");
+  if (configFile.empty()) {
+    return;
+  }
+  const auto entries =
+      configManager_m->parseMultiKeyConfig(configFile, {"dataset", "triggers"});
+  for (const auto &entry : entries) {
+    const std::string &name = entry.at("dataset");
+    for (const auto &dataset : datasets_m) {
+      if (dataset.name == name) {
+        throw std::runtime_error("DatasetOverlapManager: dataset '" + name +
+                                 "' listed twice in '" + configFile + "'");
+      }
+    }
+    datasets_m.push_back({name, configManager_m->splitString(entry.at("triggers"), ",")});
+  }
+}
+
+std::vector<std::string>
+DatasetOverlapManager::higherPriorityTriggers(const std::string &dataset) const {
+  std::vector<std::string> triggers;
+  for (const auto &entry : datasets_m) {
+    if (entry.name == dataset) {
+      break;
+    }
+    for (const auto &trigger : entry.triggers) {
+      if (std::find(triggers.begin(), triggers.end(), trigger) == triggers.end()) {
+        triggers.push_back(trigger);
+      }
+    }
+  }
+  return triggers;
+}
+
+std::vector<std::string>
+DatasetOverlapManager::datasetTriggers(const std::string &dataset) const {
+  for (const auto &entry : datasets_m) {
+    if (entry.name == dataset) {
+      return entry.triggers;
+    }
+  }
+  return {};
+}
+
+DatasetOverlapManager::EventKey DatasetOverlapManager::eventKey(unsigned int run,
+                                                                unsigned int lumi,
+                                                                ULong64_t event) {
+  return EventKey{run, lumi, event};
+}
+
+void DatasetOverlapManager::defineAnyFired(const std::string &name,
+                                           const std::vector<std::string> &paths) {
+  if (allBoolColumns(dataManager_m->getDataFrame(), paths)) {
+    const std::string mask = TriggerManager::defineTriggerMask(
+        *dataManager_m, name + "_mask", paths, *systematicManager_m);
+    dataManager_m->Define(
+        name, [](std::uint64_t fired) { return fired != 0; }, {mask}, *systematicManager_m);
+  } else {
+    dataManager_m->DefineVector(name + "_vector", paths, "Bool_t", *systematicManager_m);
+    dataManager_m->Define(
+        name,
+        [](const ROOT::VecOps::RVec<Bool_t> &fired) { return ROOT::VecOps::Any(fired); },
+        {name + "_vector"}, *systematicManager_m);
+  }
+}
+
+void DatasetOverlapManager::applyDatasetOverlap() {
+  if (!dataManager_m || !configManager_m || !systematicManager_m) {
+    throw std::runtime_error(
+        "DatasetOverlapManager: DataManager, SystematicManager or ConfigManager not set");
+  }
+  std::string sampleType = configManager_m->get("dtype");
+  if (sampleType.empty()) {
+    sampleType = configManager_m->get("type");
+  }
+  if (sampleType != "data") {
+    return;
+  }
+  const std::string dataset = configManager_m->get("primaryDataset");
+  if (dataset.empty()) {
+    throw std::runtime_error(
+        "DatasetOverlapManager: 'primaryDataset' key not found or empty in config.");
+  }
+
+  std::vector<std::string> conditions;
+  if (!datasets_m.empty()) {
+    if (std::none_of(datasets_m.begin(), datasets_m.end(),
+                     [&dataset](const Dataset &entry) { return entry.name == dataset; })) {
+      throw std::runtime_error("DatasetOverlapManager: primaryDataset '" + dataset +
+                               "' is not listed in datasetOverlapConfig");
+    }
+    // A path missing from this input never fired in it.
+    const auto present = [this](std::vector<std::string> paths) {
+      paths.erase(std::remove_if(paths.begin(), paths.end(),
+                                 [this](const std::string &path) {
+                                   if (dataManager_m->hasColumn(path)) {
+                                     return false;
+                                   }
+                                   RDF_LOG_INFO << "DatasetOverlapManager: trigger '" << path
+                                                << "' not in the input; ignored.";
+                                   return true;
+                                 }),
+                  paths.end());
+      return paths;
+    };
+    const auto own = present(datasetTriggers(dataset));
+    const auto higher = present(higherPriorityTriggers(dataset));
+    if (own.empty()) {
+      throw std::runtime_error("DatasetOverlapManager: none of the triggers of '" + dataset +
+                               "' is in the input");
+    }
+    defineAnyFired("datasetOverlap_own", own);
+    conditions.push_back("datasetOverlap_own");
+    if (!higher.empty()) {
+      defineAnyFired("datasetOverlap_higher", higher);
+      dataManager_m->Define(
+          "datasetOverlap_notHigher", [](bool fired) { return !fired; },
+          {"datasetOverlap_higher"}, *systematicManager_m);
+      conditions.push_back("datasetOverlap_notHigher");
+    }
+  }
+
+  const auto vetoFiles = configManager_m->getList("datasetOverlapVeto");
+  if (!vetoFiles.empty()) {
+    auto vetoed =
+        std::make_shared<const std::vector<EventKey>>(readEventKeys(vetoFiles));
+    RDF_LOG_INFO << "DatasetOverlapManager: vetoing " << vetoed->size()
+                 << " events of higher-priority datasets";
+    dataManager_m->Define(
+        "datasetOverlap_notVetoed",
+        [vetoed](unsigned int run, unsigned int lumi, ULong64_t event) {
+          return !std::binary_search(vetoed->begin(), vetoed->end(),
+                                     eventKey(run, lumi, event));
+        },
+        {"run", "luminosityBlock", "event"}, *systematicManager_m);
+    conditions.push_back("datasetOverlap_notVetoed");
+  }
+
+  if (conditions.size() == 1) {
+    dataManager_m->Define(
+        "pass_datasetOverlap", [](bool pass) { return pass; }, conditions,
+        *systematicManager_m);
+  } else if (conditions.size() == 2) {
+    dataManager_m->Define(
+        "pass_datasetOverlap", [](bool a, bool b) { return a && b; }, conditions,
+        *systematicManager_m);
+  } else if (conditions.size() == 3) {
+    dataManager_m->Define(
+        "pass_datasetOverlap", [](bool a, bool b, bool c) { return a && b && c; },
+        conditions, *systematicManager_m);
+  } else {
+    RDF_LOG_INFO << "DatasetOverlapManager: neither datasetOverlapConfig nor "
+                    "datasetOverlapVeto is set; no events removed.";
+  }
+  if (!conditions.empty()) {
+    dataManager_m->Filter([](bool pass) { return pass; }, {"pass_datasetOverlap"});
+  }
+
+  if (!configManager_m->get("datasetOverlapRecord").empty()) {
+    auto df = dataManager_m->getDataFrame();
+    recorded_m = df.Book<unsigned int, unsigned int, ULong64_t>(
+        EventKeyAction(df.GetNSlots()), {"run", "luminosityBlock", "event"});
+  }
+}
+
+void DatasetOverlapManager::writeEventKeys(const std::string &path,
+                                           std::vector<EventKey> keys) {
+  std::sort(keys.begin(), keys.end());
+  keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+  const std::uint64_t count = keys.size();
+
+  const std::filesystem::path parent = std::filesystem::path(path).parent_path();
+  if (!parent.empty()) {
+    std::filesystem::create_directories(parent);
+  }
+  // Write to a temporary file first so readers never see a partial list.
+  const std::string tmpPath = path + ".tmp." + std::to_string(getpid());
+  {
+    std::ofstream file(tmpPath, std::ios::binary);
+    if (!file) {
+      throw std::runtime_error("DatasetOverlapManager: cannot write '" + path + "'");
+    }
+    file.write(kKeyFileMagic, sizeof(kKeyFileMagic));
+    file.write(reinterpret_cast<const char *>(&count), sizeof(count));
+    file.write(reinterpret_cast<const char *>(keys.data()),
+               static_cast<std::streamsize>(keys.size() * sizeof(EventKey)));
+  }
+  std::filesystem::rename(tmpPath, path);
+}
+
+std::vector<DatasetOverlapManager::EventKey>
+DatasetOverlapManager::readEventKeys(const std::vector<std::string> &paths) {
+  std::vector<EventKey> keys;
+  for (const auto &path : paths) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+      throw std::runtime_error("DatasetOverlapManager: cannot open event key file '" +
+                               path + "'");
+    }
+    const std::string data((std::istreambuf_iterator<char>(file)),
+                           std::istreambuf_iterator<char>());
+    std::uint64_t count = 0;
+    const std::size_t header = sizeof(kKeyFileMagic) + sizeof(count);
+    if (data.size() >= header) {
+      std::memcpy(&count, data.data() + sizeof(kKeyFileMagic), sizeof(count));
+    }
+    if (data.size() < header ||
+        std::memcmp(data.data(), kKeyFileMagic, sizeof(kKeyFileMagic)) != 0 ||
+        (data.size() - header) / sizeof(EventKey) != count ||
+        (data.size() - header) % sizeof(EventKey) != 0) {
+      throw std::runtime_error("DatasetOverlapManager: malformed event key file '" + path +
+                               "'");
+    }
+    const std::size_t offset = keys.size();
+    keys.resize(offset + count);
+    std::memcpy(keys.data() + offset, data.data() + header, count * sizeof(EventKey));
+  }
+  std::sort(keys.begin(), keys.end());
+  keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+  return keys;
+}
+
+void DatasetOverlapManager::finalize() {
+  if (!recorded_m) {
+    return;
+  }
+  const std::string path = configManager_m->get("datasetOverlapRecord");
+  writeEventKeys(path, **recorded_m);
+  RDF_LOG_INFO << "DatasetOverlapManager: wrote the keys of " << (*recorded_m)->size()
+               << " kept events to " << path;
+  recorded_m.reset();
+}
+
+void DatasetOverlapManager::reportMetadata() {
+  if (!logger_m || datasets_m.empty()) return;
+  std::string msg = "DatasetOverlapManager dataset priority: ";
+  for (std::size_t i = 0; i < datasets_m.size(); ++i) {
+    msg += (i == 0 ? "" : " > ") + datasets_m[i].name;
+  }
+  logger_m->log(ILogger::Level::Info, msg);
+}
+
+std::shared_ptr<DatasetOverlapManager> DatasetOverlapManager::create(
+    Analyzer& an, const std::string& role) {
+    auto plugin = std::make_shared<DatasetOverlapManager>();
+    an.addPlugin(role, plugin);
+    return plugin;
+}
@@ -0,0 +1,156 @@
+#ifndef DATASETOVERLAPMANAGER_H_INCLUDED
+#define DATASETOVERLAPMANAGER_H_INCLUDED
+
+#include <api/IPluggableManager.h>
+#include <api/IConfigurationProvider.h>
+#include <api/IDataFrameProvider.h>
+#include <api/ILogger.h>
+#include <api/ISystematicManager.h>
+#include <api/ManagerContext.h>
+#include <ROOT/RResultPtr.hxx>
+#include <RtypesCore.h>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <tuple>
+#include <vector>
+
+class Analyzer;
+
+/**
+ * @class DatasetOverlapManager
+ * @brief Removes events that also belong to a higher-priority primary
+ *        dataset, inside the event loop.
+ *
+ * Overlapping data streams (DoubleMuon and SingleMuon, MuonEG and EGamma,
+ * ...) contain the same collision whenever it fired triggers of more than
+ * one stream.  Each job processes one primary dataset (config key
+ * "primaryDataset") and keeps an event only if that dataset owns it:
+ *
+ *  - Trigger rule: datasets are listed in priority order together with
+ *    their triggers.  An event of dataset k is kept if it fired one of the
+ *    triggers of dataset k and none of the triggers of datasets 0..k-1, so
+ *    every collision is kept exactly once, in the first dataset whose
+ *    triggers it fired.
+ *  - Event list: where the trigger content does not allow such a rule, the
+ *    jobs of higher-priority datasets record the (run, lumi, event) keys of
+ *    the events they keep, and lower-priority jobs veto those keys.
+ *
+ * Both mechanisms may be combined.  Nothing is done for MC samples
+ * (config key "dtype", or "type", not equal to "data").
+ *
+ * Configuration:
+ *   - primaryDataset: dataset of this job.
+ *   - datasetOverlapConfig (optional): multi-key file with one
+ *     "dataset=<name> triggers=<path,...>" line per dataset, highest
+ *     priority first.  Trigger paths missing from the input are ignored.
+ *   - datasetOverlapVeto (optional): comma-separated event key files of
+ *     higher-priority datasets (see writeEventKeys()).
+ *   - datasetOverlapRecord (optional): event key file written with the
+ *     events this job keeps.
+ */
+class DatasetOverlapManager : public IPluggableManager {
+public:
+  /// Identity of a collision: event numbers are unique within a run.
+  struct EventKey {
+    std::uint32_t run;
+    std::uint32_t lumi;
+    std::uint64_t event;
+
+    bool operator<(const EventKey &other) const {
+      return std::tie(run, lumi, event) < std::tie(other.run, other.lumi, other.event);
+    }
+    bool operator==(const EventKey &other) const {
+      return run == other.run && lumi == other.lumi && event == other.event;
+    }
+  };
+
+  // -------------------------------------------------------------------------
+  // Factory: create, register with an Analyzer, and return as shared_ptr.
+  // -------------------------------------------------------------------------
+  static std::shared_ptr<DatasetOverlapManager> create(
+      Analyzer& an, const std::string& role = "datasetOverlapManager");
+
+  DatasetOverlapManager() = default;
+
+  /**
+   * @brief Filter out the events owned by a higher-priority dataset.
+   *
+   * Defines "pass_datasetOverlap" and filters on it, then books the event
+   * key recording when datasetOverlapRecord is set.  Reads the "run",
+   * "luminosityBlock" and "event" columns when an event list is used.
+   *
+   * @throws std::runtime_error if primaryDataset is unset, or the trigger
+   *         rule is configured without listing primaryDataset
+   */
+  void applyDatasetOverlap();
+
+  /// Triggers of the datasets listed before @p dataset, in priority order.
+  std::vector<std::string> higherPriorityTriggers(const std::string &dataset) const;
+
+  /// Triggers of @p dataset (empty when it is not listed).
+  std::vector<std::string> datasetTriggers(const std::string &dataset) const;
+
+  /**
+   * @brief Key of a collision.
+   *
+   * The full (run, lumi, event) triple is kept and compared, so distinct
+   * collisions never share a key.
+   */
+  static EventKey eventKey(unsigned int run, unsigned int lumi, ULong64_t event);
+
+  /**
+   * @brief Write @p keys (sorted and deduplicated) to @p path.
+   * @throws std::runtime_error if @p path cannot be written
+   */
+  static void writeEventKeys(const std::string &path, std::vector<EventKey> keys);
+
+  /**
+   * @brief Sorted union of the keys of the files in @p paths.
+   * @throws std::runtime_error if a file is missing or malformed
+   */
+  static std::vector<EventKey> readEventKeys(const std::vector<std::string> &paths);
+
+  std::string type() const override { return "DatasetOverlapManager"; }
+
+  void setContext(ManagerContext &ctx) override;
+
+  /**
+   * @brief Read the dataset priority list and trigger rule.
+   */
+  void setupFromConfigFile() override;
+
+  /**
+   * @brief Write the keys of the kept events when datasetOverlapRecord is set.
+   */
+  void finalize() override;
+
+  /**
+   * @brief Metadata hook: reports the dataset priority order to the logger.
+   */
+  void reportMetadata() override;
+
+private:
+  struct Dataset {
+    std::string name;
+    std::vector<std::string> triggers;
+  };
+
+  /// Datasets in priority order (highest first).
+  std::vector<Dataset> datasets_m;
+  /// Keys of the kept events, booked by applyDatasetOverlap().
+  std::optional<ROOT::RDF::RResultPtr<std::vector<EventKey>>> recorded_m;
+
+  IConfigurationProvider *configManager_m = nullptr;
+  IDataFrameProvider *dataManager_m = nullptr;
+  ISystematicManager *systematicManager_m = nullptr;
+  ILogger *logger_m = nullptr;
+
+  /// Define bool column @p name, true iff any of @p paths fired.
+  void defineAnyFired(const std::string &name, const std::vector<std::string> &paths);
+};
+
+
+
+#endif // DATASETOVERLAPMANAGER_H_INCLUDED
@@ -1,7 +1,9 @@
 #include <GoldenJsonManager.h>
+#include <AsyncLogger.h>
 #include <analyzer.h>
 #include <api/ILogger.h>
 
+#include <algorithm>
 #include <cctype>
 #include <fstream>
 #include <iostream>
@@ -151,8 +153,8 @@ void GoldenJsonManager::setupFromConfigFile() {
   const std::string configKey = "goldenJsonConfig";
   std::string configFile;
   try {
-    std::cout << "GoldenJsonManager: loading golden JSON files from config key '"
-              << configKey << "'..." << std::endl;
+    RDF_LOG_INFO << "GoldenJsonManager: loading golden JSON files from config key '"
+                 << configKey << "'...";
     configFile = configManager_m->get(configKey);
   } catch (...) {
     throw std::runtime_error(
@@ -160,8 +162,8 @@ void GoldenJsonManager::setupFromConfigFile() {
         "' not found. Add 'goldenJsonConfig=<path>' to your configuration.");
   }
 
-  std::cout << "GoldenJsonManager: loading golden JSON files from '" << configFile
-            << "'..." << std::endl;
+  RDF_LOG_INFO << "GoldenJsonManager: loading golden JSON files from '" << configFile
+               << "'...";
   const auto jsonFiles = configManager_m->parseVectorConfig(configFile);
   if (jsonFiles.empty()) {
     throw std::runtime_error(
@@ -171,6 +173,7 @@ void GoldenJsonManager::setupFromConfigFile() {
   for (const auto &f : jsonFiles) {
     loadJsonFile(f);
   }
+  compileLumiMask();
 }
 
 void GoldenJsonManager::loadJsonFile(const std::string &filename) {
@@ -193,17 +196,63 @@ void GoldenJsonManager::loadJsonFile(const std::string &filename) {
   }
 }
 
-bool GoldenJsonManager::isValid(unsigned int run, unsigned int lumi) const {
-  auto it = validLumis_m.find(run);
-  if (it == validLumis_m.end()) {
-    return false;
+void GoldenJsonManager::compileLumiMask() {
+  auto mask = std::make_shared<CompiledLumiMask>();
+
+  mask->runs.reserve(validLumis_m.size());
+  for (const auto &entry : validLumis_m) {
+    mask->runs.push_back(entry.first);
   }
-  for (const auto &range : it->second) {
-    if (lumi >= range.first && lumi <= range.second) {
-      return true;
+  std::sort(mask->runs.begin(), mask->runs.end());
+
+  mask->runOffsets.reserve(mask->runs.size() + 1);
+  mask->runOffsets.push_back(0);
+  for (const unsigned int run : mask->runs) {
+    auto ranges = validLumis_m.at(run);
+    std::sort(ranges.begin(), ranges.end());
+    const std::size_t runBegin = mask->lumiRanges.size();
+    for (const auto &range : ranges) {
+      if (range.first > range.second) {
+        continue;
+      }
+      // Merge overlapping or adjacent ranges so that at most one range can
+      // contain a given lumi section.
+      if (mask->lumiRanges.size() > runBegin &&
+          range.first <= mask->lumiRanges.back().second + 1ULL) {
+        mask->lumiRanges.back().second =
+            std::max(mask->lumiRanges.back().second, range.second);
+      } else {
+        mask->lumiRanges.push_back(range);
+      }
     }
+    mask->runOffsets.push_back(mask->lumiRanges.size());
+  }
+
+  compiledMask_m = std::move(mask);
+}
+
+bool GoldenJsonManager::CompiledLumiMask::contains(unsigned int run,
+                                                   unsigned int lumi) const {
+  const auto runIt = std::lower_bound(runs.begin(), runs.end(), run);
+  if (runIt == runs.end() || *runIt != run) {
+    return false;
   }
-  return false;
+  const auto runIndex = static_cast<std::size_t>(runIt - runs.begin());
+  const auto first = lumiRanges.begin() +
+                     static_cast<std::ptrdiff_t>(runOffsets[runIndex]);
+  const auto last = lumiRanges.begin() +
+                    static_cast<std::ptrdiff_t>(runOffsets[runIndex + 1]);
+  // First range starting after lumi; the candidate is the one before it.
+  const auto next = std::upper_bound(
+      first, last, lumi,
+      [](unsigned int value, const std::pair<unsigned int, unsigned int> &range) {
+        return value < range.first;
+      });
+  return next != first && lumi <= std::prev(next)->second;
+}
+
+bool GoldenJsonManager::isValid(unsigned int run, unsigned int lumi) const {
+  return compiledMask_m && compiledMask_m->contains(run, lumi);
 }
 
 void GoldenJsonManager::applyGoldenJson() {
@@ -213,12 +262,10 @@ void GoldenJsonManager::applyGoldenJson() {
   }
 
   std::string sampleType;
-  std::cout << "GoldenJsonManager: checking sample type from config key 'dtype'..."
-            << std::endl;
+  RDF_LOG_INFO << "GoldenJsonManager: checking sample type from config key 'dtype'...";
   sampleType = configManager_m->get("dtype");
   if (sampleType.empty()) {
-    std::cout << "GoldenJsonManager: falling back to config key 'type'..."
-              << std::endl;
+    RDF_LOG_INFO << "GoldenJsonManager: falling back to config key 'type'...";
     sampleType = configManager_m->get("type");
   }
   if (sampleType.empty()) {
@@ -230,31 +277,58 @@ void GoldenJsonManager::applyGoldenJson() {
     return;
   }
 
-  // Share the validity map via shared_ptr to avoid a full copy into the lambda.
-  auto validLumisPtr = std::make_shared<
-      std::unordered_map<unsigned int,
-                         std::vector<std::pair<unsigned int, unsigned int>>>>(
-      validLumis_m);
+  if (!compiledMask_m) {
+    compileLumiMask();
+  }
+
+  // Optionally drop uncertified lumi sections before the event loop so their
+  // baskets are never read.  The per-event filter below stays in place and
+  // covers providers or configurations where pre-skipping is not possible.
+  const std::string preSkip = configManager_m->get("goldenJsonPreSkip");
+  if (preSkip == "1" || preSkip == "true" || preSkip == "True") {
+    auto preSkipMask = compiledMask_m;
+    const Long64_t kept = dataManager_m->applyLumiSectionMask(
+        [preSkipMask](unsigned int run, unsigned int lumi) {
+          return preSkipMask->contains(run, lumi);
+        });
+    if (kept < 0) {
+      RDF_LOG_INFO << "GoldenJsonManager: lumi-section pre-skipping not applied; "
+                      "filtering per event only.";
+    }
+  }
+
+  // Consecutive events almost always share a lumi section, so each slot
+  // remembers the verdict for the last (run, lumi) pair it looked up.
+  // Entries are cache-line aligned to avoid false sharing between slots.
+  struct alignas(64) SlotCache {
+    bool filled = false;
+    unsigned int run = 0;
+    unsigned int lumi = 0;
+    bool valid = false;
+  };
+  const unsigned int nSlots =
+      std::max(1u, dataManager_m->getDataFrame().GetNSlots());
+  auto slotCaches = std::make_shared<std::vector<SlotCache>>(nSlots);
+  auto mask = compiledMask_m;
 
   dataManager_m->Filter(
-      [validLumisPtr](unsigned int run, unsigned int lumi) -> bool {
-        auto it = validLumisPtr->find(run);
-        if (it == validLumisPtr->end()) {
-          return false;
-        }
-        for (const auto &range : it->second) {
-          if (lumi >= range.first && lumi <= range.second) {
-            return true;
-          }
+      [mask, slotCaches](unsigned int slot, unsigned int run,
+                         unsigned int lumi) -> bool {
+        auto &cache = (*slotCaches)[slot];
+        if (!cache.filled || cache.run != run || cache.lumi != lumi) {
+          cache.filled = true;
+          cache.run = run;
+          cache.lumi = lumi;
+          cache.valid = mask->contains(run, lumi);
         }
-        return false;
+        return cache.valid;
       },
-      {"run", "luminosityBlock"});
+      {"rdfslot_", "run", "luminosityBlock"});
 }
 
 void GoldenJsonManager::initialize() {
-  std::cout << "GoldenJsonManager: initialized with " << validLumis_m.size()
-            << " certified run(s)." << std::endl;
+  RDF_LOG_INFO << "GoldenJsonManager: initialized with " << validLumis_m.size()
+               << " certified run(s).";
 }
 
 void GoldenJsonManager::reportMetadata() {
@@ -34,6 +34,9 @@ class Analyzer;
  * Configuration:
  *   - goldenJsonConfig: path to a text file listing golden JSON file paths,
  *     one per line (comments starting with '#' are ignored).
+ *   - goldenJsonPreSkip (optional, default false): when true, entries in
+ *     uncertified lumi sections are removed from the input chain before the
+ *     event loop via DataManager::applyLumiSectionMask().
  */
 class GoldenJsonManager : public IPluggableManager {
 public:
@@ -54,12 +57,18 @@ public:
    *
    * Events whose (run, luminosityBlock) pair is not listed in any of the
    * loaded golden JSON files are removed.  The filter is skipped when the
-   * sample type is not "data".
+   * sample type is not "data".  With goldenJsonPreSkip enabled, whole
+   * uncertified lumi sections are additionally skipped at the input level.
    */
   void applyGoldenJson();
 
   /**
    * @brief Check whether a (run, luminosityBlock) pair is valid.
+   *
+   * Uses the compiled lookup table built at setupFromConfigFile() time:
+   * a binary search over the sorted run list followed by a binary search over
+   * that run's merged lumi ranges.
+   *
    * @param run       Run number.
    * @param lumi      Luminosity section number.
    * @return true if the pair falls within a certified range, false otherwise.
@@ -81,6 +90,9 @@ public:
    */
   void setupFromConfigFile() override;
 
+  /// Setup only reads files; it may overlap with other plugins' setup.
+  bool concurrentSetup() const override { return true; }
+
   /**
    * @brief Post-wiring initialization: logs the number of loaded run entries.
    */
@@ -91,12 +103,31 @@ public:
    */
   void reportMetadata() override;
 
+  /**
+   * @brief Flat, sorted form of the certified lumi ranges.
+   *
+   * Runs are stored in ascending order; the ranges of runs[i] occupy
+   * lumiRanges[runOffsets[i], runOffsets[i + 1]) sorted by start with
+   * overlapping and adjacent ranges merged, so both lookups are binary
+   * searches over contiguous memory.
+   */
+  struct CompiledLumiMask {
+    std::vector<unsigned int> runs;
+    std::vector<std::size_t> runOffsets;
+    std::vector<std::pair<unsigned int, unsigned int>> lumiRanges;
+
+    bool contains(unsigned int run, unsigned int lumi) const;
+  };
+
 private:
   /// run number -> list of [lumi_start, lumi_end] inclusive ranges
   std::unordered_map<unsigned int,
                      std::vector<std::pair<unsigned int, unsigned int>>>
       validLumis_m;
 
+  /// Lookup table compiled from validLumis_m; shared with the filter lambda.
+  std::shared_ptr<const CompiledLumiMask> compiledMask_m;
+
   IConfigurationProvider *configManager_m = nullptr;
   IDataFrameProvider *dataManager_m = nullptr;
   ISystematicManager *systematicManager_m = nullptr;
@@ -108,6 +139,11 @@ private:
    * @param filename Path to the JSON file.
    */
   void loadJsonFile(const std::string &filename);
+
+  /**
+   * @brief Rebuild compiledMask_m from validLumis_m.
+   */
+  void compileLumiMask();
 };
 
 
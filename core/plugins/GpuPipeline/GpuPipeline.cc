@@ -0,0 +1,633 @@
+#include <GpuPipeline.h>
+#include <GpuPipelineGPU.h>
+#include <GpuPipelineKernels.h>
+#include <NullOutputSink.h>
+#include <analyzer.h>
+
+#include <ROOT/RDF/RActionImpl.hxx>
+#include <ROOT/RVec.hxx>
+#include <TFile.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+
+#ifndef USE_CUDA
+/// Never constructed without CUDA; complete so that a slot can own one.
+class CudaPipelineContext {};
+#endif
+
+namespace {
+
+using ROOT::VecOps::RVec;
+
+/// Histogram adds of the host path.
+struct HostBins {
+  double *bins;
+
+  void add(std::size_t cell, double weight) {
+    bins[2 * cell] += weight;
+    bins[2 * cell + 1] += weight * weight;
+  }
+};
+
+bool ascending(const std::vector<float> &values) {
+  for (std::size_t i = 1; i < values.size(); ++i) {
+    if (!(values[i] > values[i - 1])) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void validateGrid(const GpuPipeline::CorrectionGrid &grid) {
+  if (grid.etaEdges.size() < 2 || grid.ptNodes.empty() || !ascending(grid.etaEdges) ||
+      !ascending(grid.ptNodes) || !(grid.ptNodes.front() > 0.0f)) {
+    throw std::runtime_error("GpuPipeline: a correction grid needs at least two ascending eta "
+                             "edges and ascending, positive pT nodes.");
+  }
+  if (grid.values.size() != (grid.etaEdges.size() - 1) * grid.ptNodes.size()) {
+    throw std::runtime_error("GpuPipeline: a correction grid of " +
+                             std::to_string(grid.etaEdges.size() - 1) + " eta bins and " +
+                             std::to_string(grid.ptNodes.size()) + " pT nodes has " +
+                             std::to_string(grid.values.size()) + " values.");
+  }
+}
+
+/**
+ * @brief Correction grid and thresholds of one booking, in the layout of
+ *        GpuPipelineKernels::Params, shared by its action and its output
+ *        columns.
+ */
+struct Tables {
+  std::vector<float> etaEdges;
+  std::vector<float> logPtNodes;
+  std::vector<float> values;
+  std::vector<float> thresholds;
+  /// Points into the vectors above.
+  GpuPipelineKernels::Params params;
+
+  explicit Tables(const GpuPipeline::Config &config)
+      : etaEdges(config.jes.etaEdges), values(config.jes.values),
+        thresholds(config.wpThresholds) {
+    for (const float node : config.jes.ptNodes) {
+      logPtNodes.push_back(std::log(node));
+    }
+    params.jes.etaEdges = etaEdges.data();
+    params.jes.nEta = static_cast<int>(etaEdges.size() - 1);
+    params.jes.logPtNodes = logPtNodes.data();
+    params.jes.nPt = static_cast<int>(logPtNodes.size());
+    params.jes.values = values.data();
+    params.thresholds = thresholds.data();
+    params.nThresholds = static_cast<int>(thresholds.size());
+    params.ptBins = config.ptBins;
+    params.ptMin = static_cast<float>(config.ptMin);
+    params.ptMax = static_cast<float>(config.ptMax);
+    params.nWeights = static_cast<int>(config.weights.size());
+  }
+
+  Tables(const Tables &) = delete;
+  Tables &operator=(const Tables &) = delete;
+};
+
+/**
+ * @brief RDataFrame action running the pipeline on blocks of events.
+ *
+ * Each slot gathers its events into a block and processes it, on its own
+ * device context or host histogram, once it holds @c blockSize events;
+ * Finalize() processes the remainders and sums the histograms of the
+ * slots.  The result holds (sumw, sumw2) per TH2D global bin.
+ */
+class PipelineAction : public ROOT::Detail::RDF::RActionImpl<PipelineAction> {
+public:
+  using Result_t = std::vector<double>;
+
+  PipelineAction(unsigned int nSlots, std::shared_ptr<const Tables> tables, std::size_t cells,
+                 std::size_t blockSize, bool device, std::string jetPt)
+      : tables_m(std::move(tables)), cells_m(cells), blockSize_m(blockSize), device_m(device),
+        jetPt_m(std::move(jetPt)), slots_m(std::max(nSlots, 1u)),
+        result_m(std::make_shared<Result_t>(2 * cells, 0.0)) {
+    for (auto &slot : slots_m) {
+      if (!device_m) {
+        slot.bins.assign(2 * cells_m, 0.0);
+      }
+    }
+  }
+
+  PipelineAction(PipelineAction &&) = default;
+  PipelineAction(const PipelineAction &) = delete;
+
+  std::shared_ptr<Result_t> GetResultPtr() const { return result_m; }
+
+  void Initialize() {}
+  void InitTask(TTreeReader *, unsigned int) {}
+
+  void Exec(unsigned int slot, const RVec<float> &pt, const RVec<float> &eta,
+            const RVec<float> &score, const RVec<double> &weights) {
+    if (eta.size() != pt.size() || score.size() != pt.size()) {
+      throw std::runtime_error("GpuPipeline: the jet columns differ in length from '" +
+                               jetPt_m + "'.");
+    }
+    Slot &state = slots_m[slot];
+    state.pt.insert(state.pt.end(), pt.begin(), pt.end());
+    state.eta.insert(state.eta.end(), eta.begin(), eta.end());
+    state.score.insert(state.score.end(), score.begin(), score.end());
+    state.offsets.push_back(static_cast<std::int64_t>(state.pt.size()));
+    state.weights.insert(state.weights.end(), weights.begin(), weights.end());
+    if (state.offsets.size() > blockSize_m) {
+      flush(state);
+    }
+  }
+
+  void Finalize() {
+    for (auto &slot : slots_m) {
+      flush(slot);
+#ifdef USE_CUDA
+      if (slot.device) {
+        slot.bins.resize(2 * cells_m);
+        slot.device->download(slot.bins.data());
+      }
+#endif
+      // Empty for a device slot that saw no event.
+      for (std::size_t i = 0; i < slot.bins.size(); ++i) {
+        (*result_m)[i] += slot.bins[i];
+      }
+    }
+  }
+
+  std::string GetActionName() const { return "GpuPipeline"; }
+
+private:
+  struct Slot {
+    /// Jets of each event gathered so far: offsets, then per-jet inputs.
+    std::vector<std::int64_t> offsets{0};
+    std::vector<float> pt;
+    std::vector<float> eta;
+    std::vector<float> score;
+    /// Event weights, event-major as gathered; weight-major for the block.
+    std::vector<double> weights;
+    std::vector<double> weightMajor;
+    /// Per-jet and per-event outputs of the host path (not kept).
+    std::vector<float> outPt;
+    std::vector<std::int32_t> outCategory;
+    std::vector<double> outWeight;
+    /// Host histogram, interleaved (sumw, sumw2).
+    std::vector<double> bins;
+    std::unique_ptr<CudaPipelineContext> device;
+  };
+
+  /// Process the events gathered by @p slot and clear them.
+  void flush(Slot &slot) {
+    const std::size_t nEvents = slot.offsets.size() - 1;
+    if (nEvents == 0) {
+      return;
+    }
+    const GpuPipelineKernels::Params &params = tables_m->params;
+    const std::size_t nWeights = static_cast<std::size_t>(params.nWeights);
+    slot.weightMajor.resize(nWeights * nEvents);
+    for (std::size_t event = 0; event < nEvents; ++event) {
+      for (std::size_t k = 0; k < nWeights; ++k) {
+        slot.weightMajor[k * nEvents + event] = slot.weights[event * nWeights + k];
+      }
+    }
+    const std::int64_t nJets = slot.offsets.back();
+
+    GpuPipelineKernels::Block block;
+    block.nEvents = static_cast<std::int64_t>(nEvents);
+    block.offsets = slot.offsets.data();
+    block.pt = slot.pt.data();
+    block.eta = slot.eta.data();
+    block.score = slot.score.data();
+    block.weights = slot.weightMajor.data();
+    if (device_m) {
+#ifdef USE_CUDA
+      // Only the histogram is kept, so no output comes back per block.
+      if (!slot.device) {
+        slot.device = std::make_unique<CudaPipelineContext>(params, cells_m);
+      }
+      slot.device->run(block, nJets);
+#endif
+    } else {
+      slot.outPt.resize(static_cast<std::size_t>(nJets));
+      slot.outCategory.resize(static_cast<std::size_t>(nJets));
+      slot.outWeight.resize(nEvents);
+      block.outPt = slot.outPt.data();
+      block.outCategory = slot.outCategory.data();
+      block.outWeight = slot.outWeight.data();
+      HostBins hostBins{slot.bins.data()};
+      for (std::int64_t event = 0; event < block.nEvents; ++event) {
+        GpuPipelineKernels::processEvent(params, block, event, hostBins);
+      }
+    }
+
+    slot.offsets.resize(1);
+    slot.pt.clear();
+    slot.eta.clear();
+    slot.score.clear();
+    slot.weights.clear();
+  }
+
+  std::shared_ptr<const Tables> tables_m;
+  std::size_t cells_m;
+  std::size_t blockSize_m;
+  bool device_m;
+  std::string jetPt_m;
+  std::vector<Slot> slots_m;
+  std::shared_ptr<Result_t> result_m;
+};
+
+bool isFloatVector(const std::string &type) {
+  return type == "ROOT::VecOps::RVec<float>" || type == "ROOT::VecOps::RVec<Float_t>" ||
+         type == "ROOT::RVec<float>" || type == "ROOT::RVecF";
+}
+
+bool isVector(const std::string &type) {
+  return type.find("RVec") != std::string::npos || type.find("vector") != std::string::npos;
+}
+
+/// Parse the number @p value of config key @p key.
+double parseNumber(const std::string &value, const std::string &key) {
+  std::size_t end = 0;
+  double number = 0.0;
+  try {
+    number = std::stod(value, &end);
+  } catch (const std::logic_error &) {
+    end = 0;
+  }
+  if (end == 0 || end != value.size()) {
+    throw std::runtime_error("GpuPipeline: invalid value '" + value + "' for key '" + key +
+                             "'");
+  }
+  return number;
+}
+
+/// Parse the non-negative integer @p value of config key @p key.
+std::size_t parseCount(const std::string &value, const std::string &key) {
+  const double number = parseNumber(value, key);
+  if (!(number >= 0.0) || number != std::floor(number) ||
+      number > static_cast<double>(std::numeric_limits<int>::max())) {
+    throw std::runtime_error("GpuPipeline: invalid value '" + value + "' for key '" + key +
+                             "'");
+  }
+  return static_cast<std::size_t>(number);
+}
+
+} // namespace
+
+GpuPipeline::CorrectionGrid GpuPipeline::CorrectionGrid::identity() {
+  const float inf = std::numeric_limits<float>::infinity();
+  return CorrectionGrid{{-inf, inf}, {1.0f}, {1.0f}};
+}
+
+GpuPipeline::CorrectionGrid GpuPipeline::CorrectionGrid::tabulate(
+    const std::vector<correction::Correction::Ref> &steps, const std::string &etaInput,
+    const std::string &ptInput, std::vector<float> etaEdges, std::vector<float> ptNodes,
+    const std::map<std::string, correction::Variable::Type> &fixedInputs) {
+  CorrectionGrid grid{std::move(etaEdges), std::move(ptNodes), {}};
+  grid.values.assign((grid.etaEdges.size() > 1 ? grid.etaEdges.size() - 1 : 0) *
+                         grid.ptNodes.size(),
+                     1.0f);
+  validateGrid(grid);
+
+  // Input values of each step, with the eta and pT slots filled per node.
+  struct Step {
+    correction::Correction::Ref correction;
+    std::vector<correction::Variable::Type> values;
+    std::vector<std::size_t> etaSlots;
+    std::vector<std::size_t> ptSlots;
+  };
+  std::vector<Step> prepared;
+  for (const auto &correction : steps) {
+    if (!correction) {
+      throw std::runtime_error("GpuPipeline: null correction in a tabulated chain");
+    }
+    Step step{correction, {}, {}, {}};
+    for (const auto &input : correction->inputs()) {
+      const std::size_t slot = step.values.size();
+      if (input.name() == etaInput) {
+        step.etaSlots.push_back(slot);
+        step.values.emplace_back(0.0);
+      } else if (input.name() == ptInput) {
+        step.ptSlots.push_back(slot);
+        step.values.emplace_back(0.0);
+      } else if (const auto it = fixedInputs.find(input.name()); it != fixedInputs.end()) {
+        step.values.push_back(it->second);
+      } else {
+        throw std::runtime_error("GpuPipeline: no value for input '" + input.name() +
+                                 "' of correction '" + correction->name() + "'");
+      }
+    }
+    prepared.push_back(std::move(step));
+  }
+
+  const std::size_t nEta = grid.etaEdges.size() - 1;
+  const std::size_t nPt = grid.ptNodes.size();
+  for (std::size_t i = 0; i < nEta; ++i) {
+    // Infinite outer edges evaluate at the finite one.
+    const double lo = grid.etaEdges[i];
+    const double hi = grid.etaEdges[i + 1];
+    const double eta = std::isinf(lo) ? (std::isinf(hi) ? 0.0 : hi)
+                       : std::isinf(hi) ? lo
+                                        : 0.5 * (lo + hi);
+    for (std::size_t k = 0; k < nPt; ++k) {
+      double pt = grid.ptNodes[k];
+      double factor = 1.0;
+      for (Step &step : prepared) {
+        for (const std::size_t slot : step.etaSlots) step.values[slot] = eta;
+        for (const std::size_t slot : step.ptSlots) step.values[slot] = pt;
+        const double scale = step.correction->evaluate(step.values);
+        factor *= scale;
+        pt *= scale;
+      }
+      grid.values[i * nPt + k] = static_cast<float>(factor);
+    }
+  }
+  return grid;
+}
+
+GpuPipeline::GpuPipeline(Config config) : config_m(std::move(config)) { validate(); }
+
+GpuPipeline::~GpuPipeline() = default;
+
+bool GpuPipeline::deviceSupport() {
+#ifdef USE_CUDA
+  return true;
+#else
+  return false;
+#endif
+}
+
+std::size_t GpuPipeline::cells() const {
+  return (static_cast<std::size_t>(config_m.ptBins) + 2) * (config_m.wpThresholds.size() + 3);
+}
+
+void GpuPipeline::validate() const {
+  validateGrid(config_m.jes);
+  if (config_m.jetPt.empty() || config_m.jetEta.empty() || config_m.jetScore.empty()) {
+    throw std::runtime_error("GpuPipeline: the jet pT, eta and score columns must be set.");
+  }
+  if (config_m.ptBins < 1 || !(config_m.ptMax > config_m.ptMin)) {
+    throw std::runtime_error("GpuPipeline: the histogram needs at least one bin and "
+                             "ptMax > ptMin.");
+  }
+  if (config_m.blockSize == 0) {
+    throw std::runtime_error("GpuPipeline: blockSize must be at least 1.");
+  }
+  if (!ascending(config_m.wpThresholds)) {
+    throw std::runtime_error("GpuPipeline: working-point thresholds must be ascending.");
+  }
+  if (config_m.device && !deviceSupport()) {
+    throw std::runtime_error("GpuPipeline: device mode needs a build with -DUSE_CUDA=ON "
+                             "(set device = false for the host implementation).");
+  }
+}
+
+ROOT::RDF::RNode GpuPipeline::book(ROOT::RDF::RNode df) {
+  std::vector<std::string> added;
+  return book(std::move(df), nullptr, added);
+}
+
+ROOT::RDF::RNode GpuPipeline::book(ROOT::RDF::RNode df, IDataFrameProvider *provider,
+                                   std::vector<std::string> &added) {
+  // Helper columns are numbered so that the pipeline can be booked again
+  // downstream of an earlier booking.
+  const std::string prefix = "_gpuPipeline" + std::to_string(bookings_m++) + "_";
+  const auto define = [&](const std::string &name, const std::string &expression) {
+    df = provider ? provider->defineExpression(df, name, expression) : df.Define(name, expression);
+    added.push_back(name);
+  };
+
+  // The action reads the jets as float and the weights as one double per
+  // event weight; other types are converted by helper columns.
+  const auto jetColumn = [&](const std::string &column, const std::string &role) {
+    const std::string columnType = df.GetColumnType(column);
+    if (!isVector(columnType)) {
+      throw std::runtime_error("GpuPipeline: jet column '" + column + "' is not an RVec column.");
+    }
+    if (isFloatVector(columnType)) {
+      return column;
+    }
+    const std::string name = prefix + role;
+    define(name, "ROOT::VecOps::RVec<float>(" + column + ".begin(), " + column + ".end())");
+    return name;
+  };
+  const std::string pt = jetColumn(config_m.jetPt, "pt");
+  const std::string eta = jetColumn(config_m.jetEta, "eta");
+  const std::string score = jetColumn(config_m.jetScore, "score");
+
+  const std::string weights = prefix + "weights";
+  if (config_m.weights.empty()) {
+    df = df.Define(weights, [] { return RVec<double>(); });
+    added.push_back(weights);
+  } else {
+    std::string expression = "ROOT::VecOps::RVec<double>{";
+    for (std::size_t k = 0; k < config_m.weights.size(); ++k) {
+      const std::string &column = config_m.weights[k];
+      if (isVector(df.GetColumnType(column))) {
+        throw std::runtime_error("GpuPipeline: weight column '" + column +
+                                 "' is not a scalar column.");
+      }
+      expression += (k > 0 ? ", " : "") + std::string("static_cast<double>(") + column + ")";
+    }
+    define(weights, expression + "}");
+  }
+
+  auto tables = std::make_shared<const Tables>(config_m);
+  result_m = df.Book<RVec<float>, RVec<float>, RVec<float>, RVec<double>>(
+      PipelineAction(df.GetNSlots(), tables, cells(), config_m.blockSize, config_m.device,
+                     config_m.jetPt),
+      {pt, eta, score, weights});
+
+  // The per-jet and per-event outputs are computed on the host with the
+  // kernels' own stages, and only for the events that read them.
+  const std::string jetPt = config_m.jetPt;
+  df = df.Define(config_m.correctedPtColumn,
+                 [tables, jetPt](const RVec<float> &pt, const RVec<float> &eta) {
+                   if (eta.size() != pt.size()) {
+                     throw std::runtime_error("GpuPipeline: the jet columns differ in length "
+                                              "from '" + jetPt + "'.");
+                   }
+                   RVec<Float_t> corrected(pt.size());
+                   for (std::size_t j = 0; j < pt.size(); ++j) {
+                     corrected[j] = pt[j] * GpuPipelineKernels::correctionScale(
+                                                tables->params.jes, eta[j], pt[j]);
+                   }
+                   return corrected;
+                 },
+                 {pt, eta});
+  df = df.Define(config_m.categoryColumn,
+                 [tables](const RVec<float> &score) {
+                   RVec<Int_t> category(score.size());
+                   for (std::size_t j = 0; j < score.size(); ++j) {
+                     category[j] = GpuPipelineKernels::wpCategory(
+                         tables->params.thresholds, tables->params.nThresholds, score[j]);
+                   }
+                   return category;
+                 },
+                 {score});
+  df = df.Define(config_m.weightColumn,
+                 [](const RVec<double> &weights) {
+                   double weight = 1.0;
+                   for (const double w : weights) weight *= w;
+                   return weight;
+                 },
+                 {weights});
+  added.push_back(config_m.correctedPtColumn);
+  added.push_back(config_m.categoryColumn);
+  added.push_back(config_m.weightColumn);
+  return df;
+}
+
+std::shared_ptr<TH2D> GpuPipeline::histogram(const std::string &name,
+                                             const std::string &title) const {
+  if (!result_m) {
+    throw std::runtime_error("GpuPipeline::histogram: the pipeline was not booked.");
+  }
+  auto result = *result_m;
+  const std::vector<double> &bins = *result;
+  const int nCategories = static_cast<int>(config_m.wpThresholds.size()) + 1;
+  auto hist = std::make_shared<TH2D>(name.c_str(), title.c_str(), config_m.ptBins,
+                                     config_m.ptMin, config_m.ptMax, nCategories, -0.5,
+                                     nCategories - 0.5);
+  hist->SetDirectory(nullptr);
+  hist->Sumw2();
+  // Cells are TH2D global bins (see GpuPipelineKernels::processEvent()).
+  for (std::size_t cell = 0; cell < cells(); ++cell) {
+    if (bins[2 * cell] != 0.0 || bins[2 * cell + 1] != 0.0) {
+      hist->SetBinContent(static_cast<Int_t>(cell), bins[2 * cell]);
+      hist->GetSumw2()->SetAt(bins[2 * cell + 1], static_cast<Int_t>(cell));
+    }
+  }
+  hist->ResetStats();
+  return hist;
+}
+
+// ---------------------------------------------------------------------------
+// Plugin interface
+// ---------------------------------------------------------------------------
+
+std::shared_ptr<GpuPipeline> GpuPipeline::create(Analyzer &an, Config config,
+                                                 const std::string &role) {
+  std::shared_ptr<GpuPipeline> plugin(new GpuPipeline());
+  plugin->config_m = std::move(config);
+  an.addPlugin(role, plugin);
+  return plugin;
+}
+
+std::shared_ptr<GpuPipeline> GpuPipeline::create(Analyzer &an, const std::string &role) {
+  return create(an, Config(), role);
+}
+
+void GpuPipeline::setContext(ManagerContext &ctx) {
+  configManager_m = &ctx.config;
+  dataManager_m = &ctx.data;
+  logger_m = &ctx.logger;
+  metaSink_m = &ctx.metaSink;
+}
+
+void GpuPipeline::setupFromConfigFile() {
+  if (!configManager_m) {
+    throw std::runtime_error("GpuPipeline: ConfigManager not set");
+  }
+  const auto value = [this](const std::string &key) { return configManager_m->get(key); };
+  if (const auto v = value("gpuPipelineJetPt"); !v.empty()) config_m.jetPt = v;
+  if (const auto v = value("gpuPipelineJetEta"); !v.empty()) config_m.jetEta = v;
+  if (const auto v = value("gpuPipelineJetScore"); !v.empty()) config_m.jetScore = v;
+  if (const auto v = value("gpuPipelineWeights"); !v.empty()) {
+    config_m.weights = configManager_m->splitString(v, ",");
+  }
+  if (const auto v = value("gpuPipelineWpThresholds"); !v.empty()) {
+    config_m.wpThresholds.clear();
+    for (const auto &threshold : configManager_m->splitString(v, ",")) {
+      config_m.wpThresholds.push_back(
+          static_cast<float>(parseNumber(threshold, "gpuPipelineWpThresholds")));
+    }
+  }
+  if (const auto v = value("gpuPipelinePtBins"); !v.empty()) {
+    config_m.ptBins = static_cast<int>(parseCount(v, "gpuPipelinePtBins"));
+  }
+  if (const auto v = value("gpuPipelinePtMin"); !v.empty()) {
+    config_m.ptMin = parseNumber(v, "gpuPipelinePtMin");
+  }
+  if (const auto v = value("gpuPipelinePtMax"); !v.empty()) {
+    config_m.ptMax = parseNumber(v, "gpuPipelinePtMax");
+  }
+  if (const auto v = value("gpuPipelineBlockSize"); !v.empty()) {
+    config_m.blockSize = parseCount(v, "gpuPipelineBlockSize");
+  }
+  if (const auto v = value("gpuPipelineDevice"); !v.empty()) {
+    if (v == "1" || v == "true" || v == "True") {
+      config_m.device = true;
+    } else if (v == "0" || v == "false" || v == "False") {
+      config_m.device = false;
+    } else {
+      throw std::runtime_error("GpuPipeline: invalid value '" + v +
+                               "' for key 'gpuPipelineDevice'");
+    }
+  }
+  if (const auto v = value("gpuPipelineHistogram"); !v.empty()) histogramName_m = v;
+  validate();
+}
+
+void GpuPipeline::execute() {
+  if (!dataManager_m) {
+    throw std::runtime_error("GpuPipeline::execute: context not set");
+  }
+  if (executed_m) {
+    return;
+  }
+  std::vector<std::string> added;
+  auto df = book(dataManager_m->getDataFrame(), dataManager_m, added);
+  dataManager_m->updateDataFrame(df, added);
+  std::vector<std::string> inputs = {config_m.jetPt, config_m.jetEta, config_m.jetScore};
+  inputs.insert(inputs.end(), config_m.weights.begin(), config_m.weights.end());
+  dataManager_m->recordColumnsRead(inputs);
+  executed_m = true;
+}
+
+void GpuPipeline::finalize() {
+  if (!result_m || !metaSink_m || dynamic_cast<NullOutputSink *>(metaSink_m) != nullptr) {
+    return;
+  }
+  const std::string fileName =
+      metaSink_m->resolveOutputFile(*configManager_m, OutputChannel::Meta);
+  if (fileName.empty()) {
+    return;
+  }
+  TFile outFile(fileName.c_str(), "UPDATE");
+  if (outFile.IsZombie()) {
+    if (logger_m) {
+      logger_m->log(ILogger::Level::Error,
+                    "GpuPipeline: failed to open meta output file: " + fileName);
+    }
+    return;
+  }
+  const auto hist =
+      histogram(histogramName_m, "GpuPipeline;corrected jet p_{T};working-point category");
+  outFile.WriteTObject(hist.get(), histogramName_m.c_str(), "Overwrite");
+}
+
+void GpuPipeline::reportMetadata() {
+  if (!logger_m) {
+    return;
+  }
+  std::ostringstream ss;
+  ss << "GpuPipeline: jets " << config_m.jetPt << ", " << config_m.jetEta << ", "
+     << config_m.jetScore << "; " << config_m.weights.size() << " weight column(s), "
+     << config_m.wpThresholds.size() << " working point(s), blocks of "
+     << config_m.blockSize << " events on the " << (config_m.device ? "device" : "host");
+  logger_m->log(ILogger::Level::Info, ss.str());
+}
+
+std::unordered_map<std::string, std::string> GpuPipeline::collectProvenanceEntries() const {
+  std::ostringstream thresholds;
+  for (std::size_t i = 0; i < config_m.wpThresholds.size(); ++i) {
+    thresholds << (i > 0 ? "," : "") << config_m.wpThresholds[i];
+  }
+  return {{"jet_columns", config_m.jetPt + "," + config_m.jetEta + "," + config_m.jetScore},
+          {"wp_thresholds", thresholds.str()},
+          {"device", config_m.device ? "true" : "false"}};
+}
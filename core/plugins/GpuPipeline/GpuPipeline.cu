@@ -0,0 +1,220 @@
+/**
+ * @file GpuPipeline.cu
+ * @brief CUDA implementation of the GpuPipeline device context.
+ *
+ * One CUDA thread runs every stage of one event (GpuPipelineKernels.h); the
+ * histogram bins are added with atomic adds on doubles, which needs a device
+ * of compute capability 6.0 or newer.
+ *
+ * Compile with:
+ *   nvcc -arch=sm_60 -DUSE_CUDA -c GpuPipeline.cu
+ * or let CMake handle it via the USE_CUDA build option.
+ */
+
+#include "GpuPipelineGPU.h"
+
+#include <cuda_runtime.h>
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+constexpr int kBlockSize = 128;
+
+// ── CUDA error-checking helper ──────────────────────────────────────────────
+
+void checkCuda(cudaError_t err, const char *location) {
+  if (err != cudaSuccess) {
+    throw std::runtime_error(std::string("CUDA error at ") + location + ": " +
+                             cudaGetErrorString(err));
+  }
+}
+
+/// Histogram adds of the device threads.
+struct DeviceBins {
+  double *bins;
+
+  __device__ void add(std::size_t cell, double weight) {
+    atomicAdd(bins + 2 * cell, weight);
+    atomicAdd(bins + 2 * cell + 1, weight * weight);
+  }
+};
+
+} // anonymous namespace
+
+// ── CUDA kernel: one thread per event ─────────────────────────────────────────
+
+__global__ static void pipelineKernel(GpuPipelineKernels::Params params,
+                                      GpuPipelineKernels::Block block, double *bins) {
+  const std::int64_t event = static_cast<std::int64_t>(blockIdx.x) * blockDim.x + threadIdx.x;
+  if (event >= block.nEvents) {
+    return;
+  }
+  DeviceBins deviceBins{bins};
+  GpuPipelineKernels::processEvent(params, block, event, deviceBins);
+}
+
+// ── CudaPipelineContext ──────────────────────────────────────────────────────
+
+CudaPipelineContext::CudaPipelineContext(const GpuPipelineKernels::Params &params,
+                                         std::size_t cells)
+    : params_m(params), cells_m(cells) {
+  const GpuPipelineKernels::GridView &grid = params.jes;
+  const std::size_t nEdges = static_cast<std::size_t>(grid.nEta) + 1;
+  const std::size_t nNodes = static_cast<std::size_t>(grid.nPt);
+  const std::size_t nValues = static_cast<std::size_t>(grid.nEta) * grid.nPt;
+  const std::size_t nThresholds = static_cast<std::size_t>(params.nThresholds);
+  const std::size_t nFloats = nEdges + nNodes + nValues + nThresholds;
+  try {
+    cudaStream_t stream = nullptr;
+    checkCuda(cudaStreamCreateWithFlags(&stream, cudaStreamNonBlocking),
+              "CudaPipelineContext: create stream");
+    stream_m = stream;
+    checkCuda(cudaMalloc(&d_grid_m, std::max<std::size_t>(nFloats, 1) * sizeof(float)),
+              "CudaPipelineContext: malloc grid");
+    float *cursor = d_grid_m;
+    const auto upload = [&cursor](const float *host, std::size_t n, const char *what) {
+      if (n > 0) {
+        checkCuda(cudaMemcpy(cursor, host, n * sizeof(float), cudaMemcpyHostToDevice), what);
+      }
+      const float *device = cursor;
+      cursor += n;
+      return device;
+    };
+    params_m.jes.etaEdges = upload(grid.etaEdges, nEdges, "CudaPipelineContext: H2D eta edges");
+    params_m.jes.logPtNodes = upload(grid.logPtNodes, nNodes, "CudaPipelineContext: H2D pt nodes");
+    params_m.jes.values = upload(grid.values, nValues, "CudaPipelineContext: H2D grid values");
+    params_m.thresholds =
+        upload(params.thresholds, nThresholds, "CudaPipelineContext: H2D thresholds");
+    checkCuda(cudaMalloc(&d_bins_m, 2 * cells_m * sizeof(double)),
+              "CudaPipelineContext: malloc bins");
+    reset();
+  } catch (...) {
+    cudaFree(d_grid_m);
+    cudaFree(d_bins_m);
+    if (stream_m) cudaStreamDestroy(static_cast<cudaStream_t>(stream_m));
+    throw;
+  }
+}
+
+CudaPipelineContext::~CudaPipelineContext() {
+  // These calls are no-ops when the CUDA driver has already been unloaded.
+  cudaStreamSynchronize(static_cast<cudaStream_t>(stream_m));
+  cudaFree(d_offsets_m);
+  cudaFree(d_jets_m);
+  cudaFree(d_category_m);
+  cudaFree(d_weights_m);
+  cudaFree(d_outWeight_m);
+  cudaFree(d_grid_m);
+  cudaFree(d_bins_m);
+  cudaStreamDestroy(static_cast<cudaStream_t>(stream_m));
+}
+
+void CudaPipelineContext::reserve(std::int64_t nEvents, std::int64_t nJets) {
+  if (nEvents > eventCapacity_m) {
+    cudaFree(d_offsets_m);
+    cudaFree(d_weights_m);
+    cudaFree(d_outWeight_m);
+    d_offsets_m = nullptr;
+    d_weights_m = nullptr;
+    d_outWeight_m = nullptr;
+    eventCapacity_m = 0;
+    const std::size_t n = static_cast<std::size_t>(nEvents);
+    checkCuda(cudaMalloc(&d_offsets_m, (n + 1) * sizeof(std::int64_t)),
+              "CudaPipelineContext: malloc offsets");
+    checkCuda(cudaMalloc(&d_weights_m,
+                         std::max<std::size_t>(params_m.nWeights * n, 1) * sizeof(double)),
+              "CudaPipelineContext: malloc weights");
+    checkCuda(cudaMalloc(&d_outWeight_m, n * sizeof(double)),
+              "CudaPipelineContext: malloc event weights");
+    eventCapacity_m = nEvents;
+  }
+  if (nJets > jetCapacity_m) {
+    cudaFree(d_jets_m);
+    cudaFree(d_category_m);
+    d_jets_m = nullptr;
+    d_category_m = nullptr;
+    jetCapacity_m = 0;
+    const std::size_t n = static_cast<std::size_t>(nJets);
+    checkCuda(cudaMalloc(&d_jets_m, 4 * n * sizeof(float)), "CudaPipelineContext: malloc jets");
+    checkCuda(cudaMalloc(&d_category_m, n * sizeof(std::int32_t)),
+              "CudaPipelineContext: malloc categories");
+    jetCapacity_m = nJets;
+  }
+}
+
+void CudaPipelineContext::run(const GpuPipelineKernels::Block &block, std::int64_t nJets) {
+  if (block.nEvents == 0) {
+    return;
+  }
+  reserve(block.nEvents, std::max<std::int64_t>(nJets, 1));
+  cudaStream_t stream = static_cast<cudaStream_t>(stream_m);
+  const std::size_t nEvents = static_cast<std::size_t>(block.nEvents);
+  const std::size_t jets = static_cast<std::size_t>(nJets);
+  const std::size_t capacity = static_cast<std::size_t>(jetCapacity_m);
+
+  GpuPipelineKernels::Block device;
+  device.nEvents = block.nEvents;
+  device.offsets = d_offsets_m;
+  device.pt = d_jets_m;
+  device.eta = d_jets_m + capacity;
+  device.score = d_jets_m + 2 * capacity;
+  device.weights = d_weights_m;
+  device.outPt = d_jets_m + 3 * capacity;
+  device.outCategory = d_category_m;
+  device.outWeight = d_outWeight_m;
+
+  checkCuda(cudaMemcpyAsync(d_offsets_m, block.offsets, (nEvents + 1) * sizeof(std::int64_t),
+                            cudaMemcpyHostToDevice, stream),
+            "CudaPipelineContext: H2D offsets");
+  checkCuda(cudaMemcpyAsync(d_jets_m, block.pt, jets * sizeof(float), cudaMemcpyHostToDevice,
+                            stream),
+            "CudaPipelineContext: H2D pt");
+  checkCuda(cudaMemcpyAsync(d_jets_m + capacity, block.eta, jets * sizeof(float),
+                            cudaMemcpyHostToDevice, stream),
+            "CudaPipelineContext: H2D eta");
+  checkCuda(cudaMemcpyAsync(d_jets_m + 2 * capacity, block.score, jets * sizeof(float),
+                            cudaMemcpyHostToDevice, stream),
+            "CudaPipelineContext: H2D score");
+  if (params_m.nWeights > 0) {
+    checkCuda(cudaMemcpyAsync(d_weights_m, block.weights,
+                              params_m.nWeights * nEvents * sizeof(double),
+                              cudaMemcpyHostToDevice, stream),
+              "CudaPipelineContext: H2D weights");
+  }
+
+  const int gridSize = static_cast<int>((nEvents + kBlockSize - 1) / kBlockSize);
+  pipelineKernel<<<gridSize, kBlockSize, 0, stream>>>(params_m, device, d_bins_m);
+  checkCuda(cudaGetLastError(), "CudaPipelineContext: pipeline kernel launch");
+
+  if (block.outPt) {
+    checkCuda(cudaMemcpyAsync(block.outPt, device.outPt, jets * sizeof(float),
+                              cudaMemcpyDeviceToHost, stream),
+              "CudaPipelineContext: D2H pt");
+  }
+  if (block.outCategory) {
+    checkCuda(cudaMemcpyAsync(block.outCategory, d_category_m, jets * sizeof(std::int32_t),
+                              cudaMemcpyDeviceToHost, stream),
+              "CudaPipelineContext: D2H categories");
+  }
+  if (block.outWeight) {
+    checkCuda(cudaMemcpyAsync(block.outWeight, d_outWeight_m, nEvents * sizeof(double),
+                              cudaMemcpyDeviceToHost, stream),
+              "CudaPipelineContext: D2H event weights");
+  }
+  checkCuda(cudaStreamSynchronize(stream), "CudaPipelineContext: synchronize block");
+}
+
+void CudaPipelineContext::reset() {
+  checkCuda(cudaMemset(d_bins_m, 0, 2 * cells_m * sizeof(double)),
+            "CudaPipelineContext: zero bins");
+}
+
+void CudaPipelineContext::download(double *interleaved) {
+  checkCuda(cudaStreamSynchronize(static_cast<cudaStream_t>(stream_m)),
+            "CudaPipelineContext: synchronize");
+  checkCuda(cudaMemcpy(interleaved, d_bins_m, 2 * cells_m * sizeof(double),
+                       cudaMemcpyDeviceToHost),
+            "CudaPipelineContext: D2H bins");
+}
@@ -0,0 +1,257 @@
+#ifndef GPUPIPELINE_H_INCLUDED
+#define GPUPIPELINE_H_INCLUDED
+
+/**
+ * @file GpuPipeline.h
+ * @brief Experimental GPU-resident pipeline of jet corrections, working-point
+ *        categories, event weights and a histogram fill.
+ *
+ * Offloading each plugin to the GPU on its own moves the event data to the
+ * device and back once per plugin, which costs more than the kernels save.
+ * GpuPipeline instead moves a block of events to the device once and runs
+ * every stage there before copying the results back:
+ *
+ *  1. JES: each jet pT is scaled by a correction tabulated from correctionlib
+ *     (CorrectionGrid), constant per eta bin and linear in log(pT);
+ *  2. tagger working points: each jet gets the number of consecutive
+ *     thresholds its score passes, as in TaggerWorkingPointManager;
+ *  3. event weight: the product of the weight columns;
+ *  4. histogram: the event weight is added to the (category, corrected pT)
+ *     bin of every jet, in a device-resident TH2D that is copied back once.
+ *
+ * The stages run inside the main event loop, as a booked RDataFrame
+ * action: every processing slot gathers its events into a block of
+ * @c blockSize events and processes it when full (and the rest at the end
+ * of the loop), so the host memory is bounded by one block per slot and the
+ * input is read once.  Each slot has its own device context and histogram;
+ * they are summed when the loop ends.  The per-jet and per-event outputs
+ * are defined as ordinary columns, computed on the host with the same
+ * stages (GpuPipelineKernels.h) only when something reads them.  Event
+ * weights are multiplied in double precision; jet inputs are converted to
+ * float.
+ *
+ * The device implementation is compiled with @c -DUSE_CUDA=ON.  With
+ * @c device = false the same stages (GpuPipelineKernels.h) run on the host,
+ * which is the reference of the device path.
+ *
+ * As a plugin, execute() books the pipeline on the analysis dataframe and
+ * finalize() writes the histogram to the meta output file.
+ *
+ * Configuration (each key overrides the Config passed to create()):
+ *   - gpuPipelineJetPt, gpuPipelineJetEta, gpuPipelineJetScore: jet columns.
+ *   - gpuPipelineWeights: comma-separated event-weight columns.
+ *   - gpuPipelineWpThresholds: comma-separated working-point thresholds.
+ *   - gpuPipelinePtBins, gpuPipelinePtMin, gpuPipelinePtMax: histogram axis.
+ *   - gpuPipelineBlockSize: events per block.
+ *   - gpuPipelineDevice: run on the GPU (true/false).
+ *   - gpuPipelineHistogram: name of the histogram in the meta output
+ *     (default "gpuPipeline_jetPt").
+ *
+ * ### Example
+ * @code
+ * GpuPipeline::Config config;
+ * config.jetPt = "Jet_pt";
+ * config.jetEta = "Jet_eta";
+ * config.jetScore = "Jet_btagDeepFlavB";
+ * config.weights = {"genWeight", "puWeight"};
+ * config.jes = GpuPipeline::CorrectionGrid::tabulate(
+ *     {cm->getCorrection("L1"), cm->getCorrection("L2"), cm->getCorrection("L3")},
+ *     "JetEta", "JetPt", etaEdges, ptNodes, {{"JetArea", 0.5}, {"Rho", 20.0}});
+ * config.wpThresholds = {0.05f, 0.3f, 0.75f};
+ * auto pipeline = GpuPipeline::create(*analyzer, config);
+ * // ... analyzer->run() writes the histogram to the meta output ...
+ * @endcode
+ */
+
+#include <api/IConfigurationProvider.h>
+#include <api/IDataFrameProvider.h>
+#include <api/ILogger.h>
+#include <api/IOutputSink.h>
+#include <api/IPluggableManager.h>
+#include <api/ManagerContext.h>
+
+#include <ROOT/RDataFrame.hxx>
+#include <ROOT/RResultPtr.hxx>
+#include <TH2D.h>
+#include <correction.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class Analyzer;
+
+/**
+ * @class GpuPipeline
+ * @brief Runs JES, working-point, weight and histogram stages on blocks of
+ *        events on one device.
+ */
+class GpuPipeline : public IPluggableManager {
+public:
+  /**
+   * @brief Correction factor tabulated on an (eta, pT) grid.
+   *
+   * The factor is constant within each eta bin and interpolated linearly in
+   * log(pT) between the pT nodes; outside the grid the nearest bin or node
+   * is used.  A correction binned in eta is reproduced exactly by its own
+   * eta edges; the pT dependence is approximated by the node spacing.
+   */
+  struct CorrectionGrid {
+    std::vector<float> etaEdges; ///< nEta + 1 ascending edges
+    std::vector<float> ptNodes;  ///< nPt ascending, positive pT values
+    std::vector<float> values;   ///< nEta * nPt factors, eta-major
+
+    /// Factor 1 everywhere.
+    static CorrectionGrid identity();
+
+    /**
+     * @brief Tabulate the factor of a chain of correctionlib corrections.
+     *
+     * The @p steps are applied in order, each evaluated at the pT
+     * corrected by the previous ones, as in a JES L1-L2-L3 chain; the
+     * tabulated value is the product of their factors.  Each eta bin is
+     * evaluated at its centre.
+     *
+     * @param etaInput    Name of the eta input of the corrections.
+     * @param ptInput     Name of the pT input of the corrections.
+     * @param fixedInputs Values of all other inputs (e.g. rho, jet area).
+     * @throws std::runtime_error for an invalid grid or an input without a
+     *         value.
+     */
+    static CorrectionGrid
+    tabulate(const std::vector<correction::Correction::Ref> &steps, const std::string &etaInput,
+             const std::string &ptInput, std::vector<float> etaEdges, std::vector<float> ptNodes,
+             const std::map<std::string, correction::Variable::Type> &fixedInputs = {});
+  };
+
+  struct Config {
+    /// Per-jet RVec columns; they must have the same length in every event.
+    std::string jetPt;
+    std::string jetEta;
+    std::string jetScore;
+    /// Scalar event-weight columns multiplied into the event weight.
+    std::vector<std::string> weights;
+    /// JES factor applied to the jet pT.
+    CorrectionGrid jes = CorrectionGrid::identity();
+    /// Ascending working-point thresholds on the jet score.
+    std::vector<float> wpThresholds;
+    /// Uniform corrected-pT axis of the histogram.
+    int ptBins = 50;
+    double ptMin = 0.0;
+    double ptMax = 500.0;
+    /// Output columns: RVec<Float_t>, RVec<Int_t> and Double_t.
+    std::string correctedPtColumn = "GpuPipeline_jetPt";
+    std::string categoryColumn = "GpuPipeline_jetCategory";
+    std::string weightColumn = "GpuPipeline_weight";
+    /// Events moved to the device per block.
+    std::size_t blockSize = 65536;
+    /// Run on the GPU; false runs the same stages on the host.
+    bool device = true;
+  };
+
+  /**
+   * @brief Create the plugin with @p config, register it with @p an and
+   *        return it; the configuration keys override @p config.
+   * @throws std::runtime_error for an invalid configuration.
+   */
+  static std::shared_ptr<GpuPipeline> create(Analyzer &an, Config config,
+                                             const std::string &role = "gpuPipeline");
+
+  /// As above, configured by the configuration keys alone.
+  static std::shared_ptr<GpuPipeline> create(Analyzer &an,
+                                             const std::string &role = "gpuPipeline");
+
+  /**
+   * @throws std::runtime_error for an invalid configuration, or when
+   *         @c device is set in a build without CUDA support.
+   */
+  explicit GpuPipeline(Config config);
+  ~GpuPipeline() override;
+
+  GpuPipeline(const GpuPipeline &) = delete;
+  GpuPipeline &operator=(const GpuPipeline &) = delete;
+
+  /**
+   * @brief Book the pipeline on the event loop of @p df and define the
+   *        output columns.
+   *
+   * Nothing runs until the event loop of @p df does; histogram() runs it
+   * if needed.  Booking again replaces the histogram of the previous
+   * booking.
+   *
+   * @return @p df with the output columns defined.
+   * @throws std::runtime_error if an input column is missing or of the
+   *         wrong kind (jets: RVec; weights: scalar).  Jet columns of
+   *         different lengths throw from the event loop.
+   */
+  ROOT::RDF::RNode book(ROOT::RDF::RNode df);
+
+  /**
+   * @brief Histogram of the last booking: corrected jet pT (x) by
+   *        working-point category (y, category c at y = c).
+   * @throws std::runtime_error if nothing was booked.
+   */
+  std::shared_ptr<TH2D> histogram(const std::string &name, const std::string &title = "") const;
+
+  /// Whether the build has the device implementation (-DUSE_CUDA=ON).
+  static bool deviceSupport();
+
+  // -------------------------------------------------------------------------
+  // IPluggableManager interface
+  // -------------------------------------------------------------------------
+
+  std::string type() const override { return "GpuPipeline"; }
+
+  void setContext(ManagerContext &ctx) override;
+
+  /**
+   * @brief Apply the gpuPipeline* configuration keys and validate.
+   * @throws std::runtime_error for an invalid value or configuration.
+   */
+  void setupFromConfigFile() override;
+
+  /**
+   * @brief Book the pipeline on the analysis dataframe (once).
+   * @throws std::runtime_error if the context is not set.
+   */
+  void execute() override;
+
+  /// Write the histogram to the meta output file.
+  void finalize() override;
+
+  void reportMetadata() override;
+
+  std::unordered_map<std::string, std::string> collectProvenanceEntries() const override;
+
+private:
+  GpuPipeline() = default;
+
+  /// Validate config_m.
+  void validate() const;
+
+  /// Number of histogram cells, TH2D under/overflow included.
+  std::size_t cells() const;
+
+  /// Book on @p df, defining expressions through @p provider when set.
+  ROOT::RDF::RNode book(ROOT::RDF::RNode df, IDataFrameProvider *provider,
+                        std::vector<std::string> &added);
+
+  Config config_m;
+  std::string histogramName_m = "gpuPipeline_jetPt";
+  /// Interleaved (sumw, sumw2) per TH2D global bin, of the last booking.
+  std::optional<ROOT::RDF::RResultPtr<std::vector<double>>> result_m;
+  std::size_t bookings_m = 0;
+  bool executed_m = false;
+
+  IConfigurationProvider *configManager_m = nullptr;
+  IDataFrameProvider *dataManager_m = nullptr;
+  ILogger *logger_m = nullptr;
+  IOutputSink *metaSink_m = nullptr;
+};
+
+#endif // GPUPIPELINE_H_INCLUDED
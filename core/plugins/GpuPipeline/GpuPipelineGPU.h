@@ -0,0 +1,69 @@
+#ifndef GPUPIPELINEGPU_H_INCLUDED
+#define GPUPIPELINEGPU_H_INCLUDED
+
+/**
+ * @file GpuPipelineGPU.h
+ * @brief Device context of GpuPipeline.
+ *
+ * The implementation lives in GpuPipeline.cu and is only compiled when the
+ * project is built with @c -DUSE_CUDA=ON.
+ */
+
+#ifdef USE_CUDA
+
+#include <GpuPipelineKernels.h>
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Device copies of the pipeline settings and histogram, and the
+ *        per-block device buffers.
+ *
+ * The correction grid and thresholds are uploaded once.  Each block is
+ * copied to the device with one transfer per input array, processed by a
+ * single kernel (one thread per event) that runs every stage, and its
+ * per-jet and per-event outputs are copied back when the block has host
+ * output arrays; the histogram stays on the device until download().  Blocks are processed one at a time on the context's stream.
+ */
+class CudaPipelineContext {
+public:
+  /// @p params holds host pointers; @p cells is the number of histogram bins.
+  CudaPipelineContext(const GpuPipelineKernels::Params &params, std::size_t cells);
+  ~CudaPipelineContext();
+
+  CudaPipelineContext(const CudaPipelineContext &) = delete;
+  CudaPipelineContext &operator=(const CudaPipelineContext &) = delete;
+
+  /// Process @p block (host arrays) of @p nJets jets and write its outputs,
+  /// if @p block has output arrays.
+  void run(const GpuPipelineKernels::Block &block, std::int64_t nJets);
+
+  /// Zero the histogram.
+  void reset();
+
+  /// Copy the 2 * cells histogram values (sumw, sumw2) to @p interleaved.
+  void download(double *interleaved);
+
+private:
+  /// Grow the block buffers to @p nEvents events and @p nJets jets.
+  void reserve(std::int64_t nEvents, std::int64_t nJets);
+
+  GpuPipelineKernels::Params params_m; ///< Device pointers
+  float *d_grid_m = nullptr;           ///< Edges, nodes, values and thresholds
+  double *d_bins_m = nullptr;
+  std::size_t cells_m = 0;
+  void *stream_m = nullptr;            ///< cudaStream_t
+
+  std::int64_t eventCapacity_m = 0;
+  std::int64_t jetCapacity_m = 0;
+  std::int64_t *d_offsets_m = nullptr;
+  float *d_jets_m = nullptr;           ///< pt, eta, score, corrected pt
+  std::int32_t *d_category_m = nullptr;
+  double *d_weights_m = nullptr;
+  double *d_outWeight_m = nullptr;
+};
+
+#endif // USE_CUDA
+
+#endif // GPUPIPELINEGPU_H_INCLUDED
@@ -0,0 +1,152 @@
+#ifndef GPUPIPELINEKERNELS_H_INCLUDED
+#define GPUPIPELINEKERNELS_H_INCLUDED
+
+/**
+ * @file GpuPipelineKernels.h
+ * @brief Per-event stages of GpuPipeline, shared by its host and device
+ *        implementations.
+ *
+ * The functions only use fundamental types and raw arrays so that they are
+ * compiled both by the host compiler (GpuPipeline.cc) and by nvcc
+ * (GpuPipeline.cu); the host path is therefore the exact reference of the
+ * device path.
+ */
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+#ifdef __CUDACC__
+#define GPU_PIPELINE_HD __host__ __device__
+#else
+#define GPU_PIPELINE_HD
+#endif
+
+namespace GpuPipelineKernels {
+
+/// Device-copyable view of a GpuPipeline::CorrectionGrid.
+struct GridView {
+  const float *etaEdges = nullptr;   ///< [nEta + 1]
+  int nEta = 0;
+  const float *logPtNodes = nullptr; ///< [nPt], log(pT) of the nodes
+  int nPt = 0;
+  const float *values = nullptr;     ///< [nEta * nPt], eta-major
+};
+
+/// Settings shared by every block.
+struct Params {
+  GridView jes;
+  const float *thresholds = nullptr; ///< [nThresholds], ascending
+  int nThresholds = 0;
+  int ptBins = 0;
+  float ptMin = 0.0f;
+  float ptMax = 0.0f;
+  int nWeights = 0;
+};
+
+/// Inputs and outputs of one block of events.
+struct Block {
+  std::int64_t nEvents = 0;
+  const std::int64_t *offsets = nullptr; ///< [nEvents + 1] jets of each event
+  const float *pt = nullptr;             ///< per jet
+  const float *eta = nullptr;            ///< per jet
+  const float *score = nullptr;          ///< per jet
+  const double *weights = nullptr;       ///< [nWeights * nEvents], weight-major
+  float *outPt = nullptr;                ///< per jet
+  std::int32_t *outCategory = nullptr;   ///< per jet
+  double *outWeight = nullptr;           ///< per event
+};
+
+/// Index of the first of the @p n ascending @p edges above @p x.
+GPU_PIPELINE_HD inline int upperBound(const float *edges, int n, float x) {
+  int lo = 0;
+  while (n > 0) {
+    const int half = n / 2;
+    if (edges[lo + half] <= x) {
+      lo += half + 1;
+      n -= half + 1;
+    } else {
+      n = half;
+    }
+  }
+  return lo;
+}
+
+/**
+ * @brief Correction factor at (@p eta, @p pt).
+ *
+ * Constant within an eta bin (the outermost bins extend to infinity) and
+ * linear in log(pT) between nodes, clamped outside the first and last node.
+ */
+GPU_PIPELINE_HD inline float correctionScale(const GridView &grid, float eta, float pt) {
+  int etaBin = upperBound(grid.etaEdges, grid.nEta + 1, eta) - 1;
+  etaBin = etaBin < 0 ? 0 : (etaBin >= grid.nEta ? grid.nEta - 1 : etaBin);
+  const float *row = grid.values + static_cast<std::size_t>(etaBin) * grid.nPt;
+  const float *nodes = grid.logPtNodes;
+  const float x = logf(fmaxf(pt, 1e-6f));
+  if (grid.nPt == 1 || x <= nodes[0]) {
+    return row[0];
+  }
+  if (x >= nodes[grid.nPt - 1]) {
+    return row[grid.nPt - 1];
+  }
+  const int k = upperBound(nodes, grid.nPt, x) - 1;
+  const float t = (x - nodes[k]) / (nodes[k + 1] - nodes[k]);
+  return row[k] + t * (row[k + 1] - row[k]);
+}
+
+/// Working-point category: number of consecutive thresholds passed.
+GPU_PIPELINE_HD inline int wpCategory(const float *thresholds, int n, float score) {
+  int category = 0;
+  while (category < n && score >= thresholds[category]) {
+    ++category;
+  }
+  return category;
+}
+
+/// Bin of @p pt on a uniform axis (0 = underflow, nBins + 1 = overflow).
+GPU_PIPELINE_HD inline int ptBin(float pt, int nBins, float lo, float hi) {
+  if (!(pt >= lo)) {
+    return 0;
+  }
+  if (pt >= hi) {
+    return nBins + 1;
+  }
+  const int bin = 1 + static_cast<int>((pt - lo) * nBins / (hi - lo));
+  return bin > nBins ? nBins : bin;
+}
+
+/**
+ * @brief Run all stages for event @p event of @p block.
+ *
+ * Multiplies the event weights, corrects and categorizes each jet, and adds
+ * the event weight to the (category, corrected pT) bin of each jet through
+ * @p bins.add(cell, weight).  Cells are TH2 global bins: category c is bin
+ * c + 1 of the second axis.
+ */
+#ifdef __CUDACC__
+#pragma nv_exec_check_disable
+#endif
+template <typename Bins>
+GPU_PIPELINE_HD inline void processEvent(const Params &params, const Block &block,
+                                         std::int64_t event, Bins &bins) {
+  double weight = 1.0;
+  for (int k = 0; k < params.nWeights; ++k) {
+    weight *= block.weights[static_cast<std::int64_t>(k) * block.nEvents + event];
+  }
+  block.outWeight[event] = weight;
+  const std::size_t rowCells = static_cast<std::size_t>(params.ptBins) + 2;
+  for (std::int64_t j = block.offsets[event]; j < block.offsets[event + 1]; ++j) {
+    const float pt = block.pt[j] * correctionScale(params.jes, block.eta[j], block.pt[j]);
+    const int category = wpCategory(params.thresholds, params.nThresholds, block.score[j]);
+    block.outPt[j] = pt;
+    block.outCategory[j] = category;
+    bins.add(static_cast<std::size_t>(category + 1) * rowCells +
+                 ptBin(pt, params.ptBins, params.ptMin, params.ptMax),
+             weight);
+  }
+}
+
+} // namespace GpuPipelineKernels
+
+#endif // GPUPIPELINEKERNELS_H_INCLUDED
@@ -1,12 +1,15 @@
 #include <JetEnergyScaleManager.h>
+#include <METPropagator.h>
 #include <TInterpreter.h>
 #include <analyzer.h>
 #include <ROOT/RVec.hxx>
 #include <api/ILogger.h>
+#include <atomic>
 #include <cmath>
 #include <cstdint>
 #include <sstream>
 #include <stdexcept>
+#include <unordered_map>
 
 namespace {
 
@@ -102,6 +105,83 @@ float normalFromSeed(uint64_t seed) {
                             std::cos(2.0 * M_PI * u2));
 }
 
+/// One correctionlib step of a fused correction chain.
+struct FusedCorrectionStep {
+  /// Where a numeric argument comes from: a pT stage of the chain (stage 0
+  /// is the chain input) or a column of the flattened per-jet inputs.
+  struct Slot {
+    std::size_t position = 0;
+    bool fromStage = false;
+    std::size_t index = 0;
+    bool isInt = false;
+  };
+
+  correction::Correction::Ref correction;
+  correction::CompoundCorrection::Ref compound;
+  /// Argument list with the string arguments in place.
+  std::vector<correction::Variable::Type> templateValues;
+  std::vector<Slot> slots;
+  float offset = 0.0f;
+  float multiplier = 1.0f;
+
+  double evaluate(const std::vector<correction::Variable::Type> &values) const {
+    return correction ? correction->evaluate(values) : compound->evaluate(values);
+  }
+};
+
+struct FusedCorrectionChain {
+  std::size_t id = 0;
+  /// Flattened inputs per jet; input 0 is the chain's input pT.
+  std::size_t stride = 0;
+  std::vector<FusedCorrectionStep> steps;
+};
+
+/**
+ * @brief Total correction factor of every jet of a fused chain.
+ *
+ * Each thread keeps the argument lists of a chain, so only the numeric
+ * slots are written per jet and the jet loop does not allocate.
+ */
+ROOT::VecOps::RVec<Float_t>
+evaluateFusedChain(const FusedCorrectionChain &chain,
+                   const ROOT::VecOps::RVec<double> &flatInputs) {
+  thread_local std::unordered_map<
+      std::size_t, std::vector<std::vector<correction::Variable::Type>>>
+      scratch;
+  thread_local std::vector<double> stages;
+  auto [bufferIt, inserted] = scratch.try_emplace(chain.id);
+  auto &values = bufferIt->second;
+  if (inserted) {
+    for (const auto &step : chain.steps)
+      values.push_back(step.templateValues);
+  }
+  stages.resize(chain.steps.size() + 1);
+
+  const std::size_t nJets = flatInputs.size() / chain.stride;
+  ROOT::VecOps::RVec<Float_t> factors(nJets);
+  const double *row = flatInputs.data();
+  for (std::size_t i = 0; i < nJets; ++i, row += chain.stride) {
+    stages[0] = row[0];
+    double factor = 1.0;
+    for (std::size_t k = 0; k < chain.steps.size(); ++k) {
+      const auto &step = chain.steps[k];
+      auto &args = values[k];
+      for (const auto &slot : step.slots) {
+        const double value = slot.fromStage ? stages[slot.index] : row[slot.index];
+        if (slot.isInt)
+          args[slot.position] = static_cast<int>(value);
+        else
+          args[slot.position] = value;
+      }
+      const double stepFactor = step.offset + step.multiplier * step.evaluate(args);
+      factor *= stepFactor;
+      stages[k + 1] = stages[k] * stepFactor;
+    }
+    factors[i] = static_cast<Float_t>(factor);
+  }
+  return factors;
+}
+
 } // namespace
 
 // ---------------------------------------------------------------------------
@@ -378,6 +458,51 @@ void JetEnergyScaleManager::applySystematicSet(
         "JetEnergyScaleManager::applySystematicSet: outputPtPrefix must not be empty");
 
   const auto &sources = getSystematicSources(setName); // throws if not found
+  // "{source}" selects one relative-uncertainty correction per source.
+  const std::string placeholder = "{source}";
+  const std::size_t placeholderPos = correctionName.find(placeholder);
+  const bool perSourceCorrections = placeholderPos != std::string::npos;
+  auto sourceCorrection = [&](const std::string &source) {
+    std::string name = correctionName;
+    name.replace(placeholderPos, placeholder.size(), source);
+    return name;
+  };
+
+  SystematicBundleOptions defaults;
+  defaults.bundleTag = outputPtPrefix;
+  const auto bundle = resolveBundleOptions(defaults, bundleOptions_m, {}, {});
+  if (bundle.mode == SystematicBundleMode::Auto ||
+      bundle.mode == SystematicBundleMode::Required) {
+    BundledSetStep step;
+    static_cast<ScaledBundleStep &>(step) = makeScaledBundleStep(
+        bundle, inputPtColumn,
+        !applyToMass ? ""
+        : inputMassColumn.empty() ? deriveMassColumnName(inputPtColumn)
+                                  : inputMassColumn);
+    step.correctionManager = &cm;
+    step.correctionName = correctionName;
+    step.correctionInputColumns = inputColumns;
+    step.relativeUncertainties = perSourceCorrections;
+
+    for (const auto &source : sources) {
+      const std::string upPtCol = outputPtPrefix + "_" + source + "_up";
+      const std::string dnPtCol = outputPtPrefix + "_" + source + "_down";
+      const std::string upMasCol = applyToMass ? deriveMassColumnName(upPtCol) : "";
+      const std::string dnMasCol = applyToMass ? deriveMassColumnName(dnPtCol) : "";
+      step.correctionArgumentSets.push_back({source, "up"});
+      step.correctionArgumentSets.push_back({source, "down"});
+      if (perSourceCorrections)
+        step.sourceCorrectionNames.push_back(sourceCorrection(source));
+      addScaledBundleSource(step, source, upPtCol, dnPtCol, upMasCol, dnMasCol);
+      // Without fan-out the per-source columns are never defined; the
+      // bundle columns carry the systematic instead (defineScaledBundles).
+      if (step.fanOutOutputs)
+        addVariation(source, upPtCol, dnPtCol, upMasCol, dnMasCol);
+    }
+    bundledSetSteps_m.push_back(std::move(step));
+    executionPending_m = true;
+    return;
+  }
 
   for (const auto &source : sources) {
     const std::string upPtCol = outputPtPrefix + "_" + source + "_up";
@@ -389,10 +514,19 @@ void JetEnergyScaleManager::applySystematicSet(
     const std::string upMasCol = applyToMass ? deriveMassColumnName(upPtCol) : "";
     const std::string dnMasCol = applyToMass ? deriveMassColumnName(dnPtCol) : "";
 
-    applyCorrectionlib(cm, correctionName, {source, "up"}, inputPtColumn,
-                       upPtCol, applyToMass, inMass, upMasCol, inputColumns);
-    applyCorrectionlib(cm, correctionName, {source, "down"}, inputPtColumn,
-                       dnPtCol, applyToMass, inMass, dnMasCol, inputColumns);
+    if (perSourceCorrections) {
+      // Both directions read the same uncertainty column, evaluated once.
+      const std::string name = sourceCorrection(source);
+      applyCorrectionlib(cm, name, {}, inputPtColumn, upPtCol, applyToMass,
+                         inMass, upMasCol, inputColumns, true, 1.0f);
+      applyCorrectionlib(cm, name, {}, inputPtColumn, dnPtCol, applyToMass,
+                         inMass, dnMasCol, inputColumns, true, -1.0f);
+    } else {
+      applyCorrectionlib(cm, correctionName, {source, "up"}, inputPtColumn,
+                         upPtCol, applyToMass, inMass, upMasCol, inputColumns);
+      applyCorrectionlib(cm, correctionName, {source, "down"}, inputPtColumn,
+                         dnPtCol, applyToMass, inMass, dnMasCol, inputColumns);
+    }
 
     addVariation(source, upPtCol, dnPtCol,
                  applyToMass ? upMasCol : "",
@@ -400,6 +534,16 @@ void JetEnergyScaleManager::applySystematicSet(
   }
 }
 
+void JetEnergyScaleManager::setSystematicBundleOptions(
+    const SystematicBundleOptions &options) {
+  bundleOptions_m = options;
+}
+
+const SystematicBundleOptions &
+JetEnergyScaleManager::getSystematicBundleOptions() const {
+  return bundleOptions_m;
+}
+
 // ---------------------------------------------------------------------------
 // Systematic variation registration
 // ---------------------------------------------------------------------------
@@ -537,6 +681,141 @@ void JetEnergyScaleManager::defineVariationCollections(
   executionPending_m = true;
 }
 
+void JetEnergyScaleManager::setDeltaPropagation(bool enabled) {
+  deltaPropagation_m = enabled;
+}
+
+bool JetEnergyScaleManager::isDeltaPropagationEnabled() const {
+  return deltaPropagation_m;
+}
+
+void JetEnergyScaleManager::setFusedCorrections(bool enabled) {
+  fusedCorrections_m = enabled;
+}
+
+bool JetEnergyScaleManager::isFusedCorrectionsEnabled() const {
+  return fusedCorrections_m;
+}
+
+std::vector<std::size_t> JetEnergyScaleManager::fusedChainStarts() const {
+  std::vector<std::size_t> starts(correctionSteps_m.size());
+  for (std::size_t i = 0; i < correctionSteps_m.size(); ++i) {
+    const auto &step = correctionSteps_m[i];
+    starts[i] = i;
+    if (i == 0 || !step.evaluateScaleFactor)
+      continue;
+    const auto &previous = correctionSteps_m[i - 1];
+    if (previous.evaluateScaleFactor &&
+        step.inputPtColumn == previous.outputPtColumn &&
+        step.inputMassColumn == previous.outputMassColumn)
+      starts[i] = starts[i - 1];
+  }
+  return starts;
+}
+
+void JetEnergyScaleManager::defineFusedCorrectionChain(std::size_t first,
+                                                       std::size_t last) {
+  static std::atomic<std::size_t> nextChainId{1};
+  auto chain = std::make_shared<FusedCorrectionChain>();
+  chain->id = nextChainId.fetch_add(1, std::memory_order_relaxed);
+
+  // pT of each stage: stage 0 is the chain input, stage k + 1 the output of
+  // step first + k.
+  std::unordered_map<std::string, std::size_t> stageOfColumn;
+  stageOfColumn.emplace(correctionSteps_m[first].inputPtColumn, 0);
+  std::vector<std::string> flatColumns{correctionSteps_m[first].inputPtColumn};
+  std::unordered_map<std::string, std::size_t> flatIndexOfColumn;
+
+  for (std::size_t k = 0; first + k <= last; ++k) {
+    const auto &step = correctionSteps_m[first + k];
+    CorrectionManager &cm = *step.correctionManager;
+    FusedCorrectionStep fused;
+    if (cm.isCompoundCorrection(step.correctionName))
+      fused.compound = cm.getCompoundCorrection(step.correctionName);
+    else
+      fused.correction = cm.getCorrection(step.correctionName);
+    fused.offset = step.scaleFactorOffset;
+    fused.multiplier = step.scaleFactorMultiplier;
+
+    const std::vector<std::string> &inputs =
+        step.correctionInputColumns.empty()
+            ? cm.getCorrectionFeatures(step.correctionName)
+            : step.correctionInputColumns;
+    const auto &variables =
+        fused.correction ? fused.correction->inputs() : fused.compound->inputs();
+    auto stringArgIt = step.correctionStringArgs.begin();
+    auto inputIt = inputs.begin();
+    for (const auto &variable : variables) {
+      if (variable.type() == correction::Variable::VarType::string) {
+        if (stringArgIt == step.correctionStringArgs.end())
+          throw std::runtime_error(
+              "JetEnergyScaleManager: not enough string arguments for correction '" +
+              step.correctionName + "'");
+        fused.templateValues.emplace_back(*stringArgIt++);
+        continue;
+      }
+      if (inputIt == inputs.end())
+        throw std::runtime_error(
+            "JetEnergyScaleManager: not enough input columns for correction '" +
+            step.correctionName + "'");
+      FusedCorrectionStep::Slot slot;
+      slot.position = fused.templateValues.size();
+      slot.isInt = variable.type() == correction::Variable::VarType::integer;
+      if (auto stage = stageOfColumn.find(*inputIt); stage != stageOfColumn.end()) {
+        slot.fromStage = true;
+        slot.index = stage->second;
+      } else {
+        auto [flat, added] =
+            flatIndexOfColumn.emplace(*inputIt, flatColumns.size());
+        if (added)
+          flatColumns.push_back(*inputIt);
+        slot.index = flat->second;
+      }
+      ++inputIt;
+      fused.slots.push_back(slot);
+      if (slot.isInt)
+        fused.templateValues.emplace_back(0);
+      else
+        fused.templateValues.emplace_back(0.0);
+    }
+    if (inputIt != inputs.end())
+      throw std::runtime_error(
+          "JetEnergyScaleManager: correction '" + step.correctionName + "' expects " +
+          std::to_string(fused.slots.size()) + " numeric inputs but " +
+          std::to_string(inputs.size()) + " input columns were given");
+    chain->steps.push_back(std::move(fused));
+    stageOfColumn.emplace(step.outputPtColumn, k + 1);
+  }
+  chain->stride = flatColumns.size();
+
+  const auto &lastStep = correctionSteps_m[last];
+  const std::string inputCol = "_jes_fused_inputs_" + lastStep.outputPtColumn;
+  const std::string factorCol = "_jes_fused_factor_" + lastStep.outputPtColumn;
+  ensureFlattenHelperDeclared();
+  ROOT::RDF::RNode df = dataManager_m->getDataFrame();
+  df = dataManager_m->defineExpression(df, inputCol,
+                                       buildFlattenInputExpression(flatColumns));
+  df = dataManager_m->defineColumn(
+      df, factorCol,
+      [chain](const ROOT::VecOps::RVec<double> &flatInputs) {
+        return evaluateFusedChain(*chain, flatInputs);
+      },
+      {inputCol});
+  auto scale = [](const ROOT::VecOps::RVec<Float_t> &values,
+                  const ROOT::VecOps::RVec<Float_t> &factor) {
+    return values * factor;
+  };
+  df = dataManager_m->defineColumn(df, lastStep.outputPtColumn, scale,
+                                   {correctionSteps_m[first].inputPtColumn, factorCol});
+  std::vector<std::string> added{inputCol, factorCol, lastStep.outputPtColumn};
+  if (!lastStep.inputMassColumn.empty() && !lastStep.outputMassColumn.empty()) {
+    df = dataManager_m->defineColumn(df, lastStep.outputMassColumn, scale,
+                                     {correctionSteps_m[first].inputMassColumn, factorCol});
+    added.push_back(lastStep.outputMassColumn);
+  }
+  dataManager_m->updateDataFrame(df, added);
+}
+
 // ---------------------------------------------------------------------------
 // Accessors
 // ---------------------------------------------------------------------------
@@ -583,44 +862,42 @@ void JetEnergyScaleManager::execute() {
   // 1. Define raw-pT and raw-mass columns (if removeExistingCorrections was called).
   if (!rawFactorColumn_m.empty()) {
     ROOT::RDF::RNode df = dataManager_m->getDataFrame();
-    const auto existingColumns = df.GetColumnNames();
-    const auto hasColumn = [&existingColumns](const std::string &columnName) {
-      return std::find(existingColumns.begin(), existingColumns.end(), columnName) !=
-             existingColumns.end();
-    };
 
-    if (!hasColumn(rawPtColumn_m)) {
+    if (!dataManager_m->hasColumn(rawPtColumn_m)) {
       const std::string ptCol = ptColumn_m;
       const std::string rawFactor = rawFactorColumn_m;
       const std::string rawPtCol = rawPtColumn_m;
-      auto newDf = df.Define(
-          rawPtCol,
+      auto newDf = dataManager_m->defineColumn(
+          df, rawPtCol,
           [](const ROOT::VecOps::RVec<Float_t> &pt,
              const ROOT::VecOps::RVec<Float_t> &rawFactor) {
             return pt * (1.0f - rawFactor);
           },
           {ptCol, rawFactor});
-      dataManager_m->setDataFrame(newDf);
+      dataManager_m->updateDataFrame(newDf, {rawPtCol});
     }
     if (!massColumn_m.empty() && !rawMassColumn_m.empty() &&
-        !hasColumn(rawMassColumn_m)) {
+        !dataManager_m->hasColumn(rawMassColumn_m)) {
       ROOT::RDF::RNode massDf = dataManager_m->getDataFrame();
       const std::string massCol = massColumn_m;
       const std::string rawFactor = rawFactorColumn_m;
       const std::string rawMassCol = rawMassColumn_m;
-      auto newDf = massDf.Define(
-          rawMassCol,
+      auto newDf = dataManager_m->defineColumn(
+          massDf, rawMassCol,
           [](const ROOT::VecOps::RVec<Float_t> &mass,
              const ROOT::VecOps::RVec<Float_t> &rawFactor) {
             return mass * (1.0f - rawFactor);
           },
           {massCol, rawFactor});
-      dataManager_m->setDataFrame(newDf);
+      dataManager_m->updateDataFrame(newDf, {rawMassCol});
     }
   }
 
-  // 2. Apply each registered correction step.
-  for (const auto &step : correctionSteps_m) {
+  // 2. Apply each registered correction step.  With fused corrections the
+  //    last step of each chain is defined from the chain kernel instead.
+  const std::vector<std::size_t> chainStarts = fusedChainStarts();
+  for (std::size_t index = 0; index < correctionSteps_m.size(); ++index) {
+    const auto &step = correctionSteps_m[index];
     if (step.evaluateScaleFactor) {
       if (!step.correctionManager) {
         throw std::runtime_error(
@@ -633,6 +910,12 @@ void JetEnergyScaleManager::execute() {
           step.correctionInputColumns,
           step.sfColumn);
     }
+    const bool endsChain = index + 1 == correctionSteps_m.size() ||
+                           chainStarts[index + 1] != chainStarts[index];
+    if (fusedCorrections_m && endsChain && chainStarts[index] != index) {
+      defineFusedCorrectionChain(chainStarts[index], index);
+      continue;
+    }
 
     // Corrected pT.
     {
@@ -640,8 +923,8 @@ void JetEnergyScaleManager::execute() {
       const std::string inputPt = step.inputPtColumn;
       const std::string sf = step.sfColumn;
       const std::string outputPt = step.outputPtColumn;
-      auto newDf = df.Define(
-          outputPt,
+      auto newDf = dataManager_m->defineColumn(
+          df, outputPt,
           [offset = step.scaleFactorOffset,
            multiplier = step.scaleFactorMultiplier](
               const ROOT::VecOps::RVec<Float_t> &pt,
@@ -657,8 +940,8 @@ void JetEnergyScaleManager::execute() {
       const std::string inputMass = step.inputMassColumn;
       const std::string sf = step.sfColumn;
       const std::string outputMass = step.outputMassColumn;
-      auto newDf = df.Define(
-          outputMass,
+      auto newDf = dataManager_m->defineColumn(
+          df, outputMass,
           [offset = step.scaleFactorOffset,
            multiplier = step.scaleFactorMultiplier](
               const ROOT::VecOps::RVec<Float_t> &mass,
@@ -670,6 +953,34 @@ void JetEnergyScaleManager::execute() {
     }
   }
 
+  // 2b. Bundled systematic sets: one SF evaluation pass and one pT (and
+  //     mass) column for all sources, {Nominal, S1Up, S1Down, ...} with the
+  //     input as the Nominal block.
+  for (const auto &step : bundledSetSteps_m) {
+    if (!step.correctionManager) {
+      throw std::runtime_error(
+          "JetEnergyScaleManager::execute: missing CorrectionManager for bundled correction '" +
+          step.correctionName + "'");
+    }
+    if (!step.fanOutOutputs &&
+        (!collectionOutputSteps_m.empty() || !metPropagationSteps_m.empty())) {
+      throw std::runtime_error(
+          "JetEnergyScaleManager::execute: collection outputs and MET propagation need the "
+          "per-source columns; enable fanOutOutputs for bundle " + step.ptBundleColumn);
+    }
+    if (step.relativeUncertainties) {
+      step.correctionManager->applyCorrectionsVecBundle(
+          step.sourceCorrectionNames,
+          std::vector<std::vector<std::string>>(step.sourceCorrectionNames.size()),
+          step.correctionInputColumns, step.sfBundleColumn);
+    } else {
+      step.correctionManager->applyCorrectionVecBundle(
+          step.correctionName, step.correctionArgumentSets,
+          step.correctionInputColumns, step.sfBundleColumn);
+    }
+    defineScaledBundles(*dataManager_m, *systematicManager_m, step);
+  }
+
   // 3. Apply each registered JER smearing step.
   for (const auto &step : jerSmearingSteps_m) {
     const std::string resInputCol = "_jer_inputs_res_" + step.outputPtColumn;
@@ -681,16 +992,16 @@ void JetEnergyScaleManager::execute() {
     {
       ROOT::RDF::RNode df = dataManager_m->getDataFrame();
       ensureFlattenHelperDeclared();
-      auto newDf = df.Define(resInputCol,
-                             buildFlattenInputExpression(step.ptResolutionInputs));
+      auto newDf = dataManager_m->defineExpression(
+          df, resInputCol, buildFlattenInputExpression(step.ptResolutionInputs));
       dataManager_m->setDataFrame(newDf);
     }
 
     {
       ROOT::RDF::RNode df = dataManager_m->getDataFrame();
       ensureFlattenHelperDeclared();
-      auto newDf = df.Define(sfInputCol,
-                             buildFlattenInputExpression(step.scaleFactorInputs));
+      auto newDf = dataManager_m->defineExpression(
+          df, sfInputCol, buildFlattenInputExpression(step.scaleFactorInputs));
       dataManager_m->setDataFrame(newDf);
     }
 
@@ -698,8 +1009,8 @@ void JetEnergyScaleManager::execute() {
       ROOT::RDF::RNode df = dataManager_m->getDataFrame();
       const auto resolution = step.ptResolutionCorrection;
       const auto featureCount = step.ptResolutionInputs.size();
-      auto newDf = df.Define(
-          jerResCol,
+      auto newDf = dataManager_m->defineColumn(
+          df, jerResCol,
           [resolution, featureCount](const ROOT::VecOps::RVec<double> &flatInputVector)
               -> ROOT::VecOps::RVec<Float_t> {
             if (featureCount == 0) {
@@ -733,8 +1044,8 @@ void JetEnergyScaleManager::execute() {
       const auto scaleFactor = step.scaleFactorCorrection;
       const auto systematic = step.systematic;
       const auto featureCount = step.scaleFactorInputs.size();
-      auto newDf = df.Define(
-          jerSfCol,
+      auto newDf = dataManager_m->defineColumn(
+          df, jerSfCol,
           [scaleFactor, systematic, featureCount](const ROOT::VecOps::RVec<double> &flatInputVector)
               -> ROOT::VecOps::RVec<Float_t> {
             if (featureCount == 0) {
@@ -772,8 +1083,8 @@ void JetEnergyScaleManager::execute() {
       const std::string etaCol = etaColumn_m;
       const std::string genJetPtCol = genJetPtColumn_m;
       const std::string eventCol = eventColumn_m;
-      auto newDf = df.Define(
-          smearCol,
+      auto newDf = dataManager_m->defineColumn(
+          df, smearCol,
           [](const ROOT::VecOps::RVec<Float_t> &pt,
              const ROOT::VecOps::RVec<Float_t> &eta,
              const ROOT::VecOps::RVec<Float_t> &genJetPt,
@@ -818,8 +1129,8 @@ void JetEnergyScaleManager::execute() {
       ROOT::RDF::RNode df = dataManager_m->getDataFrame();
       const std::string inputPt = step.inputPtColumn;
       const std::string outputPt = step.outputPtColumn;
-      auto newDf = df.Define(
-          outputPt,
+      auto newDf = dataManager_m->defineColumn(
+          df, outputPt,
           [](const ROOT::VecOps::RVec<Float_t> &pt,
              const ROOT::VecOps::RVec<Float_t> &smear)
               -> ROOT::VecOps::RVec<Float_t> {
@@ -833,8 +1144,8 @@ void JetEnergyScaleManager::execute() {
       ROOT::RDF::RNode df = dataManager_m->getDataFrame();
       const std::string inputMass = step.inputMassColumn;
       const std::string outputMass = step.outputMassColumn;
-      auto newDf = df.Define(
-          outputMass,
+      auto newDf = dataManager_m->defineColumn(
+          df, outputMass,
           [](const ROOT::VecOps::RVec<Float_t> &mass,
              const ROOT::VecOps::RVec<Float_t> &smear)
               -> ROOT::VecOps::RVec<Float_t> {
@@ -845,69 +1156,13 @@ void JetEnergyScaleManager::execute() {
     }
   }
 
-  // 4. Apply each MET propagation step.
-  //    Strategy: define an intermediate column holding [metX, metY], then
-  //    derive MET pT and phi from it to avoid computing the sum twice.
+  // 4. Apply each MET propagation step.  Jet directions and base MET
+  //    vectors are shared between steps; see METPropagator.
+  METPropagator met("_jesmet_");
   for (const auto &step : metPropagationSteps_m) {
-    const std::string tmpCol =
-        "_jesmet_tmp_" + step.outputMETPtColumn;
-    const std::string basePt  = step.baseMETPtColumn;
-    const std::string basePhi = step.baseMETPhiColumn;
-    const std::string nomPt   = step.nominalJetPtColumn;
-    const std::string varPt   = step.variedJetPtColumn;
-    const std::string jetPhi  = phiColumn_m;
-    const float threshold     = step.jetPtThreshold;
-
-    // Intermediate: RVec<float>{newMET_x, newMET_y}
-    {
-      ROOT::RDF::RNode df = dataManager_m->getDataFrame();
-      auto newDf = df.Define(
-          tmpCol,
-          [threshold](Float_t baseMETPt, Float_t baseMETPhiArg,
-                      const ROOT::VecOps::RVec<Float_t> &nomJetPt,
-                      const ROOT::VecOps::RVec<Float_t> &varJetPt,
-                      const ROOT::VecOps::RVec<Float_t> &jPhi)
-              -> ROOT::VecOps::RVec<float> {
-            float metX = baseMETPt * std::cos(baseMETPhiArg);
-            float metY = baseMETPt * std::sin(baseMETPhiArg);
-            for (std::size_t i = 0; i < nomJetPt.size(); ++i) {
-              if (nomJetPt[i] > threshold) {
-                float dpt = varJetPt[i] - nomJetPt[i];
-                metX -= dpt * std::cos(jPhi[i]);
-                metY -= dpt * std::sin(jPhi[i]);
-              }
-            }
-            return ROOT::VecOps::RVec<float>{metX, metY};
-          },
-          {basePt, basePhi, nomPt, varPt, jetPhi});
-      dataManager_m->setDataFrame(newDf);
-    }
-
-    // Output MET pT.
-    {
-      ROOT::RDF::RNode df = dataManager_m->getDataFrame();
-      const std::string outPt = step.outputMETPtColumn;
-      auto newDf = df.Define(
-          outPt,
-          [](const ROOT::VecOps::RVec<float> &xy) -> Float_t {
-            return std::sqrt(xy[0] * xy[0] + xy[1] * xy[1]);
-          },
-          {tmpCol});
-      dataManager_m->setDataFrame(newDf);
-    }
-
-    // Output MET phi.
-    {
-      ROOT::RDF::RNode df = dataManager_m->getDataFrame();
-      const std::string outPhi = step.outputMETPhiColumn;
-      auto newDf = df.Define(
-          outPhi,
-          [](const ROOT::VecOps::RVec<float> &xy) -> Float_t {
-            return std::atan2(xy[1], xy[0]);
-          },
-          {tmpCol});
-      dataManager_m->setDataFrame(newDf);
-    }
+    met.define(*dataManager_m, step.baseMETPtColumn, step.baseMETPhiColumn,
+               step.nominalJetPtColumn, step.variedJetPtColumn, phiColumn_m,
+               step.outputMETPtColumn, step.outputMETPhiColumn, step.jetPtThreshold);
   }
 
   // 5. Register explicit variation mappings for corrected collection inputs.
@@ -963,6 +1218,82 @@ void JetEnergyScaleManager::execute() {
           },
           {inputCol, corrPtCol}, *systematicManager_m);
     }
+
+    // 6b. Delta propagation: derive the varied collections from the nominal
+    //     output so unchanged jets keep their nominal 4-vectors.  The full
+    //     per-variation definitions made above are replaced and never run.
+    //     Names are resolved without materializing, so variants deferred by
+    //     the data manager stay deferred and keep their full definition.
+    if (!deltaPropagation_m)
+      continue;
+    for (const auto &var : variations_m) {
+      for (const std::string direction : {"Up", "Down"}) {
+        const std::string syst = var.name + direction;
+        const std::string variedCol =
+            systematicManager_m->resolveVariationColumnName(outputCol, syst);
+        const std::string variedPtCol =
+            systematicManager_m->resolveVariationColumnName(corrPtCol, syst);
+        if (variedCol == outputCol || variedPtCol == corrPtCol ||
+            systematicManager_m->resolveVariationColumnName(inputCol, syst) !=
+                inputCol ||
+            !dataManager_m->hasColumn(variedCol))
+          continue;
+        std::string corrMassCol = colStep.correctedMassColumn;
+        std::string variedMassCol =
+            corrMassCol.empty()
+                ? std::string()
+                : systematicManager_m->resolveVariationColumnName(corrMassCol,
+                                                                  syst);
+        if (variedMassCol == corrMassCol) {
+          corrMassCol.clear();
+          variedMassCol.clear();
+        }
+        const std::string changedCol = variedCol + "_changed";
+
+        ROOT::RDF::RNode df = dataManager_m->getDataFrame();
+        if (corrMassCol.empty()) {
+          df = dataManager_m->defineColumn(
+              df, changedCol,
+              [](const PhysicsObjectCollection &nominal,
+                 const ROOT::VecOps::RVec<Float_t> &nomPt,
+                 const ROOT::VecOps::RVec<Float_t> &varPt) {
+                return nominal.changedObjects(nomPt, varPt);
+              },
+              {outputCol, corrPtCol, variedPtCol});
+          df = df.Redefine(
+              variedCol,
+              [](const PhysicsObjectCollection &nominal,
+                 const ROOT::VecOps::RVec<bool> &changed,
+                 const ROOT::VecOps::RVec<Float_t> &varPt)
+                  -> PhysicsObjectCollection {
+                return nominal.withVariedKinematics(changed, varPt);
+              },
+              {outputCol, changedCol, variedPtCol});
+        } else {
+          df = dataManager_m->defineColumn(
+              df, changedCol,
+              [](const PhysicsObjectCollection &nominal,
+                 const ROOT::VecOps::RVec<Float_t> &nomPt,
+                 const ROOT::VecOps::RVec<Float_t> &varPt,
+                 const ROOT::VecOps::RVec<Float_t> &nomMass,
+                 const ROOT::VecOps::RVec<Float_t> &varMass) {
+                return nominal.changedObjects(nomPt, varPt, nomMass, varMass);
+              },
+              {outputCol, corrPtCol, variedPtCol, corrMassCol, variedMassCol});
+          df = df.Redefine(
+              variedCol,
+              [](const PhysicsObjectCollection &nominal,
+                 const ROOT::VecOps::RVec<bool> &changed,
+                 const ROOT::VecOps::RVec<Float_t> &varPt,
+                 const ROOT::VecOps::RVec<Float_t> &varMass)
+                  -> PhysicsObjectCollection {
+                return nominal.withVariedKinematics(changed, varPt, varMass);
+              },
+              {outputCol, changedCol, variedPtCol, variedMassCol});
+        }
+        dataManager_m->updateDataFrame(df, {changedCol, variedCol});
+      }
+    }
   }
 
   // 7. Define per-variation collection aliases and optional variation map.
@@ -985,8 +1316,8 @@ void JetEnergyScaleManager::execute() {
 
       if (upCol != sourceUpCol) {
         ROOT::RDF::RNode df = dataManager_m->getDataFrame();
-        auto newDf = df.Define(
-            upCol,
+        auto newDf = dataManager_m->defineColumn(
+            df, upCol,
             [](const PhysicsObjectCollection &col) -> PhysicsObjectCollection {
               return col;
             },
@@ -996,8 +1327,8 @@ void JetEnergyScaleManager::execute() {
 
       if (dnCol != sourceDnCol) {
         ROOT::RDF::RNode df = dataManager_m->getDataFrame();
-        auto newDf = df.Define(
-            dnCol,
+        auto newDf = dataManager_m->defineColumn(
+            df, dnCol,
             [](const PhysicsObjectCollection &col) -> PhysicsObjectCollection {
               return col;
             },
@@ -1015,19 +1346,29 @@ void JetEnergyScaleManager::execute() {
 
     // Build the PhysicsObjectVariationMap column (if requested).
     // Strategy: define the column with "nominal" first, then Redefine
-    // it to accumulate each variation (up then down) one at a time.
+    // it to accumulate each variation (up and down together) one at a time.
     // Listing the column name itself in the input cols of Redefine passes
     // the current value of the column to the lambda, enabling accumulation.
     if (!mapCol.empty()) {
+      // Slot 0 is "nominal", followed by the up/down collections of each
+      // variation; the name table is shared by the maps of all events.
+      std::vector<std::string> keyNames = {"nominal"};
+      for (const auto &name : varNames) {
+        keyNames.push_back(name + "Up");
+        keyNames.push_back(name + "Down");
+      }
+      const auto keys =
+          std::make_shared<const PhysicsObjectVariationMap::Keys>(keyNames);
+
       // Step A: initialise the map with just the nominal collection.
       {
         ROOT::RDF::RNode df = dataManager_m->getDataFrame();
-        auto newDf = df.Define(
-            mapCol,
-            [](const PhysicsObjectCollection &nominalCol)
+        auto newDf = dataManager_m->defineColumn(
+            df, mapCol,
+            [keys](const PhysicsObjectCollection &nominalCol)
                 -> PhysicsObjectVariationMap {
-              PhysicsObjectVariationMap m;
-              m.emplace("nominal", nominalCol);
+              PhysicsObjectVariationMap m(keys);
+              m.set(0, nominalCol);
               return m;
             },
             {nomCol});
@@ -1036,36 +1377,21 @@ void JetEnergyScaleManager::execute() {
 
       // Step B: fold in each variation's up and down collections.
       for (std::size_t i = 0; i < varNames.size(); ++i) {
-        const std::string keyUp = varNames[i] + "Up";
-        const std::string keyDn = varNames[i] + "Down";
-
-        {
-          ROOT::RDF::RNode df = dataManager_m->getDataFrame();
-          auto newDf = df.Redefine(
-              mapCol,
-              [keyUp](PhysicsObjectVariationMap m,
-                      const PhysicsObjectCollection &upCol)
-                  -> PhysicsObjectVariationMap {
-                m.emplace(keyUp, upCol);
-                return m;
-              },
-              {mapCol, upColNames[i]});
-          dataManager_m->setDataFrame(newDf);
-        }
-
-        {
-          ROOT::RDF::RNode df = dataManager_m->getDataFrame();
-          auto newDf = df.Redefine(
-              mapCol,
-              [keyDn](PhysicsObjectVariationMap m,
-                      const PhysicsObjectCollection &dnCol)
-                  -> PhysicsObjectVariationMap {
-                m.emplace(keyDn, dnCol);
-                return m;
-              },
-              {mapCol, dnColNames[i]});
-          dataManager_m->setDataFrame(newDf);
-        }
+        const std::size_t slotUp = keys->slot(varNames[i] + "Up");
+        const std::size_t slotDn = keys->slot(varNames[i] + "Down");
+        ROOT::RDF::RNode df = dataManager_m->getDataFrame();
+        auto newDf = df.Redefine(
+            mapCol,
+            [slotUp, slotDn](PhysicsObjectVariationMap m,
+                             const PhysicsObjectCollection &upCol,
+                             const PhysicsObjectCollection &dnCol)
+                -> PhysicsObjectVariationMap {
+              m.set(slotUp, upCol);
+              m.set(slotDn, dnCol);
+              return m;
+            },
+            {mapCol, upColNames[i], dnColNames[i]});
+        dataManager_m->setDataFrame(newDf);
       }
     }
   }
@@ -1082,6 +1408,7 @@ void JetEnergyScaleManager::execute() {
   }
 
   correctionSteps_m.clear();
+  bundledSetSteps_m.clear();
   jerSmearingSteps_m.clear();
   metPropagationSteps_m.clear();
   collectionOutputSteps_m.clear();
@@ -1135,6 +1462,14 @@ void JetEnergyScaleManager::reportMetadata() {
     }
   }
 
+  if (!bundledSetSteps_m.empty()) {
+    ss << "  Bundled systematic sets (" << bundledSetSteps_m.size() << "):\n";
+    for (const auto &step : bundledSetSteps_m)
+      ss << "    " << step.inputPtColumn << " x " << step.sfBundleColumn
+         << " -> " << step.ptBundleColumn << " ("
+         << step.variationLabels.size() << " variations)\n";
+  }
+
   if (!jerSmearingSteps_m.empty()) {
     ss << "  JER smearing steps (" << jerSmearingSteps_m.size() << "):\n";
     for (const auto &step : jerSmearingSteps_m) {
@@ -1253,6 +1588,17 @@ JetEnergyScaleManager::collectProvenanceEntries() const {
     entries["correction_steps"] = ss.str();
   }
 
+  if (!bundledSetSteps_m.empty()) {
+    std::ostringstream ss;
+    for (std::size_t i = 0; i < bundledSetSteps_m.size(); ++i) {
+      if (i > 0) ss << ',';
+      ss << bundledSetSteps_m[i].inputPtColumn
+         << "->" << bundledSetSteps_m[i].ptBundleColumn
+         << "(sf:" << bundledSetSteps_m[i].sfBundleColumn << ')';
+    }
+    entries["bundled_set_steps"] = ss.str();
+  }
+
   if (!jerSmearingSteps_m.empty()) {
     std::ostringstream ss;
     for (std::size_t i = 0; i < jerSmearingSteps_m.size(); ++i) {
@@ -1316,6 +1662,14 @@ JetEnergyScaleManager::collectProvenanceEntries() const {
     entries["collection_output_steps"] = ss.str();
   }
 
+  if (deltaPropagation_m) {
+    entries["delta_propagation"] = "true";
+  }
+
+  if (fusedCorrections_m) {
+    entries["fused_corrections"] = "true";
+  }
+
   if (!variationCollectionsSteps_m.empty()) {
     std::ostringstream ss;
     for (std::size_t i = 0; i < variationCollectionsSteps_m.size(); ++i) {
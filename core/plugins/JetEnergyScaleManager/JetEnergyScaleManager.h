@@ -3,6 +3,7 @@
 
 #include <CorrectionManager.h>
 #include <PhysicsObjectCollection.h>
+#include <SystematicBundle.h>
 #include <api/IPluggableManager.h>
 #include <api/IConfigurationProvider.h>
 #include <api/IDataFrameProvider.h>
@@ -367,8 +368,29 @@ public:
    * @c {S, "up"} / @c {S, "down"}.  If your correction uses a different
    * argument order, call applyCorrectionlib() directly for each source.
    *
+   * When systematic bundling is enabled (setSystematicBundleOptions()), all
+   * sources are evaluated in one CorrectionManager::applyCorrectionVecBundle()
+   * pass and execute() defines one pT bundle (and one mass bundle if
+   * @p applyToMass) with layout @c {Nominal, S1Up, S1Down, ...}, where the
+   * Nominal block is @p inputPtColumn.  The pT bundle is registered for
+   * @p inputPtColumn via ISystematicManager::registerVariationBundle(), so
+   * histogram and bundled ONNX consumers read all variations from one
+   * column.  The per-source SF columns are not defined, and the per-source
+   * pT/mass columns are defined as bundle slices only when
+   * @c fanOutOutputs is set.
+   *
+   * CMS publishes one uncertainty payload per source.  When
+   * @p correctionName contains @c "{source}", it names one correction per
+   * source (e.g. @c "jes_{source}" → @c jes_AbsoluteStat, registered in
+   * @p cm), each returning the relative uncertainty @c u with no string
+   * arguments; the source is shifted to pT × (1 ± u).  Each source is then
+   * evaluated once for both directions, and with bundling all sources run
+   * in one CorrectionManager::applyCorrectionsVecBundle() pass over shared
+   * flattened inputs, with one bundle block per source.
+   *
    * @param cm               CorrectionManager that holds the registered correction.
-   * @param correctionName   Name of the correction in @p cm.
+   * @param correctionName   Name of the correction in @p cm, or a per-source
+   *                         name pattern containing @c "{source}".
    * @param setName          Name of the previously registered source set.
    * @param inputPtColumn    Per-jet pT input column.
    * @param outputPtPrefix   Prefix for the per-source output pT column names.
@@ -391,6 +413,23 @@ public:
                           const std::vector<std::string> &inputColumns = {},
                           const std::string &inputMassColumn = "");
 
+  /**
+   * @brief Configure variation-major bundling for applySystematicSet().
+   *
+   * @c mode Auto or Required enables bundling; Off or Inherit keeps one
+   * column per source and direction.  @c bundleTag names the bundle columns
+   * (@c makeBundleColumnName(tag, "pt"), defaulting to the output pT
+   * prefix), and @c fanOutOutputs controls whether the per-source columns
+   * are still defined.  Collection outputs and MET propagation read the
+   * per-source columns and therefore need @c fanOutOutputs.
+   *
+   * Applies to applySystematicSet() calls made after this call.
+   */
+  void setSystematicBundleOptions(const SystematicBundleOptions &options);
+
+  /// Bundling options set by setSystematicBundleOptions().
+  const SystematicBundleOptions &getSystematicBundleOptions() const;
+
   // -------------------------------------------------------------------------
   // Systematic variation registration
   // -------------------------------------------------------------------------
@@ -429,7 +468,10 @@ public:
    *   new_MET_y = baseMET_y + dMET_y
    * @endcode
    *
-   * The jet φ column used is the one declared in setJetColumns().
+   * The jet φ column used is the one declared in setJetColumns().  The steps
+   * share the jet directions and base MET vectors (METPropagator), so
+   * variations propagated from the nominal output MET with the nominal jet
+   * pT as reference only sum the jets they change.
    *
    * @param baseMETPtColumn     Input scalar MET-pT column (Float_t).
    * @param baseMETPhiColumn    Input scalar MET-φ column (Float_t).
@@ -559,6 +601,52 @@ public:
                                   const std::string &collectionPrefix,
                                   const std::string &variationMapColumn = "");
 
+  /**
+   * @brief Enable delta propagation of variations into collection outputs.
+   *
+   * By default each variation of a defineCollectionOutput() column rebuilds
+   * every jet 4-vector from the varied pT/mass.  With delta propagation the
+   * varied collections registered via addVariation() are instead derived
+   * from the nominal output collection:
+   *  - @c <variedCollection>_changed (RVec<bool>, one flag per selected jet)
+   *    records which jets the variation moves.
+   *  - The varied collection copies the nominal 4-vectors of unchanged jets
+   *    and rebuilds only the changed ones.
+   *
+   * Downstream consumers can pass the change flags to the delta makePairs()
+   * overload or reuseNominalIfUnchanged() to skip unaffected objects and
+   * events.  Column names and variation registration are unchanged.
+   *
+   * @param enabled Whether to use delta propagation (default off).
+   */
+  void setDeltaPropagation(bool enabled);
+
+  /// Whether delta propagation is enabled (setDeltaPropagation()).
+  bool isDeltaPropagationEnabled() const;
+
+  /**
+   * @brief Evaluate chains of correctionlib steps in one per-jet kernel.
+   *
+   * A chain is a run of consecutive applyCorrectionlib() steps where each
+   * step corrects the previous step's output (pT, and mass when the first
+   * step corrects mass).  With fused corrections the chain's final pT and
+   * mass are computed from one factor column: for each jet, all steps are
+   * evaluated back to back on a running pT, with no intermediate RVec per
+   * step.  Step inputs that name the pT of an earlier stage of the chain
+   * read the running value.
+   *
+   * The intermediate pT/mass and scale-factor columns stay defined under
+   * their usual names but no longer feed the final outputs, so RDataFrame
+   * computes them only for events where they are read (e.g. when saved).
+   * Results agree with the unfused steps up to float rounding.
+   *
+   * @param enabled Whether to fuse correction chains (default off).
+   */
+  void setFusedCorrections(bool enabled);
+
+  /// Whether correction chains are fused (setFusedCorrections()).
+  bool isFusedCorrectionsEnabled() const;
+
   // -------------------------------------------------------------------------
   // Accessors
   // -------------------------------------------------------------------------
@@ -658,6 +746,19 @@ private:
   };
   std::vector<CorrectionStep> correctionSteps_m;
 
+  /// Deferred step: one correctionlib pass for all sources of a set.
+  struct BundledSetStep : ScaledBundleStep {
+    CorrectionManager *correctionManager = nullptr;
+    std::string correctionName;
+    std::vector<std::vector<std::string>> correctionArgumentSets;
+    std::vector<std::string> correctionInputColumns;
+    /// Per-source uncertainty corrections; when set, the SF bundle holds one
+    /// relative uncertainty block per source instead of correctionArgumentSets.
+    std::vector<std::string> sourceCorrectionNames;
+  };
+  std::vector<BundledSetStep> bundledSetSteps_m;
+  SystematicBundleOptions bundleOptions_m;
+
   struct JERSmearingStep {
     correction::Correction::Ref ptResolutionCorrection;
     correction::Correction::Ref scaleFactorCorrection;
@@ -707,6 +808,8 @@ private:
     std::string variationMapColumn; ///< may be empty
   };
   std::vector<VariationCollectionsStep> variationCollectionsSteps_m;
+  bool deltaPropagation_m = false; ///< Set by setDeltaPropagation().
+  bool fusedCorrections_m = false; ///< Set by setFusedCorrections().
 
   // ---- Context ------------------------------------------------------------
   IConfigurationProvider *configManager_m = nullptr;
@@ -725,6 +828,18 @@ private:
    * Returns empty string when substitution is not possible.
    */
   std::string deriveMassColumnName(const std::string &ptColName) const;
+
+  /**
+   * @brief Index of the first step of the fused chain of each correction
+   * step (the step itself when it starts a chain).
+   */
+  std::vector<std::size_t> fusedChainStarts() const;
+
+  /**
+   * @brief Define the outputs of correction step @p last from one kernel
+   * over the steps [@p first, @p last] (see setFusedCorrections()).
+   */
+  void defineFusedCorrectionChain(std::size_t first, std::size_t last);
 };
 
 
@@ -1,6 +1,9 @@
 #ifndef KINEMATICFIT_H_INCLUDED
 #define KINEMATICFIT_H_INCLUDED
 
+#include <SlotArena.h>
+
+#include <algorithm>
 #include <array>
 #include <cmath>
 #include <stdexcept>
@@ -134,6 +137,9 @@ constexpr double kMinPt          = 1e-4;
  * @endcode
  */
 class KinematicFit {
+  template <int NP, int NC>
+  friend class FixedKinematicFit;
+
 public:
   /**
    * @brief Add a particle to the fit.
@@ -142,9 +148,26 @@ public:
    */
   int addParticle(const KinFitParticle &p) {
     particles_.push_back(p);
+    start_.push_back(p);
     return static_cast<int>(particles_.size()) - 1;
   }
 
+  /**
+   * @brief Start the iterations of particle @p idx from the (pT, eta, phi)
+   *        of @p p instead of from its measured values.
+   *
+   * chi2 is still measured from the measured values.  A start near the
+   * solution, such as the fit of nearby measurements (a systematic
+   * variation started from the nominal fit), needs fewer iterations.
+   * @throws std::out_of_range if no particle @p idx was added.
+   */
+  void setStart(int idx, const KinFitParticle &p) {
+    auto &start = start_.at(static_cast<std::size_t>(idx));
+    start.pt  = p.pt;
+    start.eta = p.eta;
+    start.phi = p.phi;
+  }
+
   /**
    * @brief Add a two-body invariant mass constraint.
    * @param idx1       Index of the first particle.
@@ -200,6 +223,7 @@ public:
 
 private:
   std::vector<KinFitParticle> particles_;
+  std::vector<KinFitParticle> start_; ///< Start point; the measured values unless set
   std::vector<MassConstraint> constraints_;
   std::vector<PtConstraint>   ptConstraints_;
 
@@ -300,8 +324,13 @@ inline KinFitResult KinematicFit::fit(int maxIter, double tolerance) const {
     return {particles_, 0.0, 0, true};
   }
 
+  // Work matrices are per-call temporaries: take them from the slot arena so
+  // that the iterations below do not touch the global heap.
+  SlotArena::Scope scratch;
+  const auto alloc = scratch.allocator<double>();
+
   // ── build diagonal variance vector ──────────────────────────────────────
-  std::vector<double> var(nParams);
+  ArenaVector<double> var(nParams, alloc);
   for (int i = 0; i < nParticles; ++i) {
     // pT variance: use (sigma_pT * pT)^2 (fractional resolution)
     const double sp = particles_[i].sigPt * particles_[i].pt;
@@ -312,14 +341,17 @@ inline KinFitResult KinematicFit::fit(int maxIter, double tolerance) const {
   }
 
   // Working copy of particle parameters
-  std::vector<KinFitParticle> current = particles_;
+  std::vector<KinFitParticle> current = start_;
   double prevChi2 = 1e30;
 
   for (int iter = 0; iter < maxIter; ++iter) {
+    // Rewinds the arena to here at the end of every iteration.
+    SlotArena::Scope iterationScratch;
+
     // ── build constraint vector f and Jacobian D ─────────────────────────
-    std::vector<double> f(nConstraints, 0.0);
+    ArenaVector<double> f(nConstraints, 0.0, alloc);
     // D is (nConstraints × nParams), stored row-major
-    std::vector<double> D(nConstraints * nParams, 0.0);
+    ArenaVector<double> D(nConstraints * nParams, 0.0, alloc);
 
     // Mass constraints (two-body and three-body)
     for (int c = 0; c < nMassConstr; ++c) {
@@ -372,7 +404,7 @@ inline KinFitResult KinematicFit::fit(int maxIter, double tolerance) const {
     }
 
     // ── compute W = D * V * D^T  (nConstraints × nConstraints) ──────────
-    std::vector<double> W(nConstraints * nConstraints, 0.0);
+    ArenaVector<double> W(nConstraints * nConstraints, 0.0, alloc);
     for (int ci = 0; ci < nConstraints; ++ci) {
       for (int cj = 0; cj < nConstraints; ++cj) {
         double w = 0.0;
@@ -399,7 +431,7 @@ inline KinFitResult KinematicFit::fit(int maxIter, double tolerance) const {
     }
 
     // ── solve  W * lambda = -f  ──────────────────────────────────────────
-    std::vector<double> lambda(nConstraints, 0.0);
+    ArenaVector<double> lambda(nConstraints, 0.0, alloc);
     if (nConstraints == 1) {
       if (std::abs(W[0]) < detail::kSingularityEps) break;
       lambda[0] = -f[0] / W[0];
@@ -411,7 +443,7 @@ inline KinFitResult KinematicFit::fit(int maxIter, double tolerance) const {
     } else {
       // General Gauss elimination for nConstraints > 2
       // Augmented matrix [W | -f], in-place
-      std::vector<double> aug(nConstraints * (nConstraints + 1));
+      ArenaVector<double> aug(nConstraints * (nConstraints + 1), alloc);
       for (int r = 0; r < nConstraints; ++r) {
         for (int col = 0; col < nConstraints; ++col) {
           aug[r * (nConstraints + 1) + col] = W[r * nConstraints + col];
@@ -499,4 +531,617 @@ inline KinFitResult KinematicFit::fit(int maxIter, double tolerance) const {
   return {current, chi2, maxIter, false};
 }
 
+/**
+ * @class FixedKinematicFit
+ * @brief KinematicFit with a compile-time number of particles and constraints.
+ *
+ * Same method, interface and results as KinematicFit, but every work vector
+ * and matrix is a fixed-size std::array on the stack, and W = D V Dᵀ is
+ * solved by a Cholesky decomposition instead of elimination on an augmented
+ * matrix (W is symmetric positive definite for independent constraints).
+ * Exactly @p NP particles and @p NC constraints (mass and pT constraints
+ * together) must be added before fit().
+ *
+ * KinematicFitManager::applyFit() selects an instantiation automatically for
+ * the common fit sizes and falls back to KinematicFit otherwise.
+ *
+ * @tparam NP Number of particles.
+ * @tparam NC Number of constraints.
+ */
+template <int NP, int NC>
+class FixedKinematicFit {
+  static_assert(NP > 0 && NC > 0,
+                "FixedKinematicFit needs at least one particle and one constraint");
+
+public:
+  /// Result of a fixed-size fit; the same fields as KinFitResult.
+  struct Result {
+    std::array<KinFitParticle, NP> fittedParticles; ///< Fitted particle parameters
+    double chi2;        ///< Chi-square at the fitted point
+    int nIterations;    ///< Number of iterations used
+    bool converged;     ///< Whether the fit converged within tolerance
+  };
+
+  /// @copydoc KinematicFit::addParticle
+  /// @throws std::runtime_error if @p NP particles were already added.
+  int addParticle(const KinFitParticle &p) {
+    if (nParticles_ >= NP) {
+      throw std::runtime_error("FixedKinematicFit: more than NP particles added");
+    }
+    particles_[nParticles_] = p;
+    start_[nParticles_] = p;
+    return nParticles_++;
+  }
+
+  /// @copydoc KinematicFit::setStart
+  void setStart(int idx, const KinFitParticle &p) {
+    if (idx < 0 || idx >= nParticles_) {
+      throw std::out_of_range("FixedKinematicFit: particle index out of range");
+    }
+    start_[idx].pt  = p.pt;
+    start_[idx].eta = p.eta;
+    start_[idx].phi = p.phi;
+  }
+
+  /// @copydoc KinematicFit::addMassConstraint
+  void addMassConstraint(int idx1, int idx2, double targetMass,
+                         double massSigma = 0.0) {
+    addConstraint();
+    constraints_[nMassConstr_++] = {idx1, idx2, -1, targetMass, massSigma};
+  }
+
+  /// @copydoc KinematicFit::addThreeBodyMassConstraint
+  void addThreeBodyMassConstraint(int idx1, int idx2, int idx3,
+                                  double targetMass,
+                                  double massSigma = 0.0) {
+    addConstraint();
+    constraints_[nMassConstr_++] = {idx1, idx2, idx3, targetMass, massSigma};
+  }
+
+  /// @copydoc KinematicFit::addPtConstraint
+  void addPtConstraint(int idx, double targetPt) {
+    addConstraint();
+    ptConstraints_[nPtConstr_++] = {idx, targetPt};
+  }
+
+  /**
+   * @brief Perform the kinematic fit.
+   * @param maxIter   Maximum number of linearisation iterations.
+   * @param tolerance Convergence criterion on |delta_chi2|.
+   * @throws std::runtime_error unless exactly @p NP particles and @p NC
+   *         constraints were added.
+   */
+  Result fit(int maxIter = 50, double tolerance = 1e-6) const;
+
+private:
+  void addConstraint() {
+    if (nMassConstr_ + nPtConstr_ >= NC) {
+      throw std::runtime_error("FixedKinematicFit: more than NC constraints added");
+    }
+  }
+
+  std::array<KinFitParticle, NP> particles_{};
+  std::array<KinFitParticle, NP> start_{};
+  std::array<MassConstraint, NC> constraints_{};
+  std::array<PtConstraint, NC>   ptConstraints_{};
+  int nParticles_  = 0;
+  int nMassConstr_ = 0;
+  int nPtConstr_   = 0;
+}; // class FixedKinematicFit
+
+template <int NP, int NC>
+typename FixedKinematicFit<NP, NC>::Result
+FixedKinematicFit<NP, NC>::fit(int maxIter, double tolerance) const {
+  if (nParticles_ != NP || nMassConstr_ + nPtConstr_ != NC) {
+    throw std::runtime_error(
+        "FixedKinematicFit: fit() requires exactly NP particles and NC constraints");
+  }
+  constexpr int nParams = NP * 3;
+
+  std::array<double, nParams> var;
+  for (int i = 0; i < NP; ++i) {
+    const double sp = particles_[i].sigPt * particles_[i].pt;
+    var[3 * i + 0] = std::max(sp * sp, detail::kMinVariance);
+    var[3 * i + 1] = std::max(particles_[i].sigEta * particles_[i].sigEta, detail::kMinVariance);
+    var[3 * i + 2] = std::max(particles_[i].sigPhi * particles_[i].sigPhi, detail::kMinVariance);
+  }
+
+  std::array<KinFitParticle, NP> current = start_;
+  const auto chi2Of = [&]() {
+    double chi2 = 0.0;
+    for (int i = 0; i < NP; ++i) {
+      const double dpt  = current[i].pt  - particles_[i].pt;
+      const double deta = current[i].eta - particles_[i].eta;
+      const double dphi = current[i].phi - particles_[i].phi;
+      chi2 += dpt  * dpt  / var[3 * i + 0];
+      chi2 += deta * deta / var[3 * i + 1];
+      chi2 += dphi * dphi / var[3 * i + 2];
+    }
+    return chi2;
+  };
+  double prevChi2 = 1e30;
+
+  for (int iter = 0; iter < maxIter; ++iter) {
+    // ── constraint vector f and Jacobian D (NC × nParams) ────────────────
+    std::array<double, NC> f{};
+    std::array<std::array<double, nParams>, NC> D{};
+
+    for (int c = 0; c < nMassConstr_; ++c) {
+      const auto &con = constraints_[c];
+      const int members[3] = {con.idx1, con.idx2, con.idx3};
+      const int nMembers = con.idx3 < 0 ? 2 : 3;
+      double sE = 0.0, sPx = 0.0, sPy = 0.0, sPz = 0.0;
+      for (int m = 0; m < nMembers; ++m) {
+        const auto &p = current[members[m]];
+        const auto [E, px, py, pz] = KinematicFit::fourMomentum(p.pt, p.eta, p.phi, p.mass);
+        sE += E; sPx += px; sPy += py; sPz += pz;
+      }
+      f[c] = sE * sE - sPx * sPx - sPy * sPy - sPz * sPz -
+             con.targetMass * con.targetMass;
+      for (int m = 0; m < nMembers; ++m) {
+        const auto g = KinematicFit::gradMassN(current[members[m]], sE, sPx, sPy, sPz);
+        D[c][3 * members[m] + 0] = g[0];
+        D[c][3 * members[m] + 1] = g[1];
+        D[c][3 * members[m] + 2] = g[2];
+      }
+    }
+    for (int k = 0; k < nPtConstr_; ++k) {
+      const int c = nMassConstr_ + k;
+      const auto &pc = ptConstraints_[k];
+      f[c] = current[pc.idx].pt - pc.targetPt;
+      D[c][3 * pc.idx + 0] = 1.0;
+    }
+
+    // ── W = D V Dᵀ, symmetric: fill the lower triangle ───────────────────
+    std::array<std::array<double, NC>, NC> W{};
+    for (int ci = 0; ci < NC; ++ci) {
+      for (int cj = 0; cj <= ci; ++cj) {
+        double w = 0.0;
+        for (int k = 0; k < nParams; ++k) {
+          w += D[ci][k] * var[k] * D[cj][k];
+        }
+        W[ci][cj] = w;
+      }
+    }
+    for (int c = 0; c < nMassConstr_; ++c) {
+      if (constraints_[c].massSigma > 0.0) {
+        const double residualSigma = 2.0 * constraints_[c].targetMass * constraints_[c].massSigma;
+        W[c][c] += residualSigma * residualSigma;
+      }
+    }
+
+    // ── Cholesky W = L Lᵀ (in place, lower triangle) ─────────────────────
+    bool singular = false;
+    for (int j = 0; j < NC && !singular; ++j) {
+      double diag = W[j][j];
+      for (int k = 0; k < j; ++k) {
+        diag -= W[j][k] * W[j][k];
+      }
+      if (diag < detail::kSingularityEps) {
+        singular = true;
+        break;
+      }
+      W[j][j] = std::sqrt(diag);
+      for (int i = j + 1; i < NC; ++i) {
+        double sum = W[i][j];
+        for (int k = 0; k < j; ++k) {
+          sum -= W[i][k] * W[j][k];
+        }
+        W[i][j] = sum / W[j][j];
+      }
+    }
+    if (singular) break;
+
+    // ── solve L y = -f, then Lᵀ lambda = y ───────────────────────────────
+    std::array<double, NC> lambda;
+    for (int i = 0; i < NC; ++i) {
+      double sum = -f[i];
+      for (int k = 0; k < i; ++k) {
+        sum -= W[i][k] * lambda[k];
+      }
+      lambda[i] = sum / W[i][i];
+    }
+    for (int i = NC - 1; i >= 0; --i) {
+      double sum = lambda[i];
+      for (int k = i + 1; k < NC; ++k) {
+        sum -= W[k][i] * lambda[k];
+      }
+      lambda[i] = sum / W[i][i];
+    }
+
+    // ── update particles: delta = V Dᵀ lambda ────────────────────────────
+    for (int i = 0; i < NP; ++i) {
+      double dpt = 0.0, deta = 0.0, dphi = 0.0;
+      for (int c = 0; c < NC; ++c) {
+        dpt  += var[3 * i + 0] * D[c][3 * i + 0] * lambda[c];
+        deta += var[3 * i + 1] * D[c][3 * i + 1] * lambda[c];
+        dphi += var[3 * i + 2] * D[c][3 * i + 2] * lambda[c];
+      }
+      current[i].pt  += dpt;
+      current[i].eta += deta;
+      current[i].phi += dphi;
+      if (current[i].pt < detail::kMinPt) current[i].pt = detail::kMinPt;
+    }
+
+    const double chi2 = chi2Of();
+    if (std::abs(chi2 - prevChi2) < tolerance) {
+      return {current, chi2, iter + 1, true};
+    }
+    prevChi2 = chi2;
+  }
+
+  return {current, chi2Of(), maxIter, false};
+}
+
+/**
+ * @class BatchedKinematicFit
+ * @brief FixedKinematicFit for @p L independent fits solved together, one
+ *        per SIMD lane.
+ *
+ * All lanes share the constraints; each lane has its own particles.  Every
+ * work quantity is stored lane-innermost (structure of arrays), so the
+ * linearisation, W = D V Dᵀ, its Cholesky decomposition, the solves and the
+ * update are plain loops over @p L contiguous doubles that the compiler
+ * vectorises — four lanes fill an AVX2 register, eight an AVX-512 one.
+ *
+ * Convergence is masked: a lane that converges, or whose W becomes singular,
+ * stops updating and keeps the result FixedKinematicFit would have returned
+ * for it, while the remaining lanes keep iterating.  The loop ends when no
+ * lane is active or after @p maxIter iterations.
+ *
+ * @code
+ *   BatchedKinematicFit<2, 1, 4> fitter;
+ *   fitter.addMassConstraint(0, 1, 91.2);
+ *   for (int lane = 0; lane < 4; ++lane) {
+ *     fitter.setParticle(lane, 0, mu1[lane]);
+ *     fitter.setParticle(lane, 1, mu2[lane]);
+ *   }
+ *   std::array<BatchedKinematicFit<2, 1, 4>::Result, 4> results;
+ *   fitter.fit(results);
+ * @endcode
+ *
+ * @tparam NP Number of particles.
+ * @tparam NC Number of constraints.
+ * @tparam L  Number of lanes (fits per call).
+ */
+template <int NP, int NC, int L>
+class BatchedKinematicFit {
+  static_assert(NP > 0 && NC > 0,
+                "BatchedKinematicFit needs at least one particle and one constraint");
+  static_assert(L > 0, "BatchedKinematicFit needs at least one lane");
+
+public:
+  /// Result of one lane; the same fields as FixedKinematicFit::Result.
+  using Result = typename FixedKinematicFit<NP, NC>::Result;
+
+  /// Number of lanes.
+  static constexpr int kLanes = L;
+
+  /**
+   * @brief Set particle @p idx of lane @p lane; its iterations start from
+   *        @p p until setStart() moves them.
+   * @throws std::out_of_range if @p lane or @p idx is out of range.
+   */
+  void setParticle(int lane, int idx, const KinFitParticle &p) {
+    checkIndex(lane, idx);
+    particles_[lane][idx] = p;
+    start_[lane][idx] = p;
+  }
+
+  /// Start point of particle @p idx of lane @p lane, as
+  /// KinematicFit::setStart(); call it after setParticle().
+  /// @throws std::out_of_range if @p lane or @p idx is out of range.
+  void setStart(int lane, int idx, const KinFitParticle &p) {
+    checkIndex(lane, idx);
+    start_[lane][idx].pt  = p.pt;
+    start_[lane][idx].eta = p.eta;
+    start_[lane][idx].phi = p.phi;
+  }
+
+  /// @copydoc FixedKinematicFit::addMassConstraint
+  void addMassConstraint(int idx1, int idx2, double targetMass,
+                         double massSigma = 0.0) {
+    addConstraint();
+    constraints_[nMassConstr_++] = {idx1, idx2, -1, targetMass, massSigma};
+  }
+
+  /// @copydoc FixedKinematicFit::addThreeBodyMassConstraint
+  void addThreeBodyMassConstraint(int idx1, int idx2, int idx3,
+                                  double targetMass,
+                                  double massSigma = 0.0) {
+    addConstraint();
+    constraints_[nMassConstr_++] = {idx1, idx2, idx3, targetMass, massSigma};
+  }
+
+  /// @copydoc FixedKinematicFit::addPtConstraint
+  void addPtConstraint(int idx, double targetPt) {
+    addConstraint();
+    ptConstraints_[nPtConstr_++] = {idx, targetPt};
+  }
+
+  /**
+   * @brief Fit the first @p nLanes lanes.
+   *
+   * Lanes from @p nLanes on are not fitted and their entries of @p results
+   * are left untouched, so a partly filled batch costs no more than a full
+   * one.
+   *
+   * @param results   Receives the result of each fitted lane.
+   * @param maxIter   Maximum number of linearisation iterations.
+   * @param tolerance Convergence criterion on |delta_chi2|.
+   * @param nLanes    Number of leading lanes to fit (1..L).
+   * @throws std::runtime_error unless exactly @p NC constraints were added.
+   * @throws std::out_of_range if @p nLanes is not in 1..L.
+   */
+  void fit(std::array<Result, L> &results, int maxIter = 50,
+           double tolerance = 1e-6, int nLanes = L) const;
+
+private:
+  using Lanes = std::array<double, L>;
+
+  void addConstraint() {
+    if (nMassConstr_ + nPtConstr_ >= NC) {
+      throw std::runtime_error("BatchedKinematicFit: more than NC constraints added");
+    }
+  }
+
+  static void checkIndex(int lane, int idx) {
+    if (lane < 0 || lane >= L || idx < 0 || idx >= NP) {
+      throw std::out_of_range("BatchedKinematicFit: lane or particle index out of range");
+    }
+  }
+
+  std::array<std::array<KinFitParticle, NP>, L> particles_{};
+  std::array<std::array<KinFitParticle, NP>, L> start_{};
+  std::array<MassConstraint, NC> constraints_{};
+  std::array<PtConstraint, NC>   ptConstraints_{};
+  int nMassConstr_ = 0;
+  int nPtConstr_   = 0;
+}; // class BatchedKinematicFit
+
+template <int NP, int NC, int L>
+void BatchedKinematicFit<NP, NC, L>::fit(std::array<Result, L> &results,
+                                         int maxIter, double tolerance,
+                                         int nLanes) const {
+  if (nMassConstr_ + nPtConstr_ != NC) {
+    throw std::runtime_error(
+        "BatchedKinematicFit: fit() requires exactly NC constraints");
+  }
+  if (nLanes < 1 || nLanes > L) {
+    throw std::out_of_range("BatchedKinematicFit: nLanes must be in 1..L");
+  }
+  constexpr int nParams = NP * 3;
+
+  // ── measured values and variances; unused lanes replicate lane 0 ───────
+  std::array<Lanes, NP> pt0, eta0, phi0, mass;
+  std::array<Lanes, nParams> var;
+  for (int i = 0; i < NP; ++i) {
+    for (int l = 0; l < L; ++l) {
+      const auto &p = particles_[l < nLanes ? l : 0][i];
+      pt0[i][l]  = p.pt;
+      eta0[i][l] = p.eta;
+      phi0[i][l] = p.phi;
+      mass[i][l] = p.mass;
+      const double sp = p.sigPt * p.pt;
+      var[3 * i + 0][l] = std::max(sp * sp, detail::kMinVariance);
+      var[3 * i + 1][l] = std::max(p.sigEta * p.sigEta, detail::kMinVariance);
+      var[3 * i + 2][l] = std::max(p.sigPhi * p.sigPhi, detail::kMinVariance);
+    }
+  }
+
+  std::array<Lanes, NP> pt, eta, phi;
+  for (int i = 0; i < NP; ++i) {
+    for (int l = 0; l < L; ++l) {
+      const auto &s = start_[l < nLanes ? l : 0][i];
+      pt[i][l]  = s.pt;
+      eta[i][l] = s.eta;
+      phi[i][l] = s.phi;
+    }
+  }
+  const auto laneChi2 = [&](int l) {
+    double chi2 = 0.0;
+    for (int i = 0; i < NP; ++i) {
+      const double dpt  = pt[i][l]  - pt0[i][l];
+      const double deta = eta[i][l] - eta0[i][l];
+      const double dphi = phi[i][l] - phi0[i][l];
+      chi2 += dpt  * dpt  / var[3 * i + 0][l];
+      chi2 += deta * deta / var[3 * i + 1][l];
+      chi2 += dphi * dphi / var[3 * i + 2][l];
+    }
+    return chi2;
+  };
+  const auto finish = [&](int l, double chi2, int nIterations, bool converged) {
+    auto &r = results[l];
+    for (int i = 0; i < NP; ++i) {
+      r.fittedParticles[i] = particles_[l][i];
+      r.fittedParticles[i].pt  = pt[i][l];
+      r.fittedParticles[i].eta = eta[i][l];
+      r.fittedParticles[i].phi = phi[i][l];
+    }
+    r.chi2 = chi2;
+    r.nIterations = nIterations;
+    r.converged = converged;
+  };
+
+  std::array<bool, L> active;
+  for (int l = 0; l < L; ++l) active[l] = l < nLanes;
+  int nActive = nLanes;
+  Lanes prevChi2;
+  prevChi2.fill(1e30);
+
+  for (int iter = 0; iter < maxIter && nActive > 0; ++iter) {
+    // ── four-momenta and the trigonometric terms of the Jacobian ─────────
+    std::array<Lanes, NP> E, px, py, pz, ch, sh, cphi, sphi;
+    for (int i = 0; i < NP; ++i) {
+      for (int l = 0; l < L; ++l) {
+        ch[i][l]   = std::cosh(eta[i][l]);
+        sh[i][l]   = std::sinh(eta[i][l]);
+        cphi[i][l] = std::cos(phi[i][l]);
+        sphi[i][l] = std::sin(phi[i][l]);
+        const double p = pt[i][l];
+        E[i][l]  = std::sqrt(p * p * ch[i][l] * ch[i][l] + mass[i][l] * mass[i][l]);
+        px[i][l] = p * cphi[i][l];
+        py[i][l] = p * sphi[i][l];
+        pz[i][l] = p * sh[i][l];
+      }
+    }
+
+    // ── constraint vector f and Jacobian D (NC × nParams) ────────────────
+    std::array<Lanes, NC> f{};
+    std::array<std::array<Lanes, nParams>, NC> D{};
+    for (int c = 0; c < nMassConstr_; ++c) {
+      const auto &con = constraints_[c];
+      const int members[3] = {con.idx1, con.idx2, con.idx3};
+      const int nMembers = con.idx3 < 0 ? 2 : 3;
+      Lanes sE{}, sPx{}, sPy{}, sPz{};
+      for (int m = 0; m < nMembers; ++m) {
+        const int k = members[m];
+        for (int l = 0; l < L; ++l) {
+          sE[l] += E[k][l]; sPx[l] += px[k][l]; sPy[l] += py[k][l]; sPz[l] += pz[k][l];
+        }
+      }
+      for (int l = 0; l < L; ++l) {
+        f[c][l] = sE[l] * sE[l] - sPx[l] * sPx[l] - sPy[l] * sPy[l] - sPz[l] * sPz[l] -
+                  con.targetMass * con.targetMass;
+      }
+      // Same expressions as KinematicFit::gradMassN, lane by lane.
+      for (int m = 0; m < nMembers; ++m) {
+        const int k = members[m];
+        for (int l = 0; l < L; ++l) {
+          const double p  = pt[k][l];
+          const double Ek = E[k][l];
+          const double dEk_dpT  = (Ek > detail::kMinEnergy) ? p * ch[k][l] * ch[k][l] / Ek : 0.0;
+          const double dEk_deta = (Ek > detail::kMinEnergy) ? p * p * sh[k][l] * ch[k][l] / Ek : 0.0;
+          D[c][3 * k + 0][l] = 2.0 * (sE[l] * dEk_dpT
+                                      - sPx[l] * cphi[k][l]
+                                      - sPy[l] * sphi[k][l]
+                                      - sPz[l] * sh[k][l]);
+          D[c][3 * k + 1][l] = 2.0 * (sE[l] * dEk_deta
+                                      - sPz[l] * p * ch[k][l]);
+          D[c][3 * k + 2][l] = 2.0 * (sPx[l] * p * sphi[k][l]
+                                      - sPy[l] * p * cphi[k][l]);
+        }
+      }
+    }
+    for (int k = 0; k < nPtConstr_; ++k) {
+      const int c = nMassConstr_ + k;
+      const auto &pc = ptConstraints_[k];
+      for (int l = 0; l < L; ++l) {
+        f[c][l] = pt[pc.idx][l] - pc.targetPt;
+        D[c][3 * pc.idx + 0][l] = 1.0;
+      }
+    }
+
+    // ── W = D V Dᵀ, lower triangle ───────────────────────────────────────
+    std::array<std::array<Lanes, NC>, NC> W{};
+    for (int ci = 0; ci < NC; ++ci) {
+      for (int cj = 0; cj <= ci; ++cj) {
+        Lanes w{};
+        for (int k = 0; k < nParams; ++k) {
+          for (int l = 0; l < L; ++l) {
+            w[l] += D[ci][k][l] * var[k][l] * D[cj][k][l];
+          }
+        }
+        W[ci][cj] = w;
+      }
+    }
+    for (int c = 0; c < nMassConstr_; ++c) {
+      if (constraints_[c].massSigma > 0.0) {
+        const double residualSigma = 2.0 * constraints_[c].targetMass * constraints_[c].massSigma;
+        for (int l = 0; l < L; ++l) {
+          W[c][c][l] += residualSigma * residualSigma;
+        }
+      }
+    }
+
+    // ── Cholesky W = L Lᵀ; a singular lane gets a unit pivot and stops ───
+    std::array<bool, L> singular{};
+    for (int j = 0; j < NC; ++j) {
+      for (int l = 0; l < L; ++l) {
+        double diag = W[j][j][l];
+        for (int k = 0; k < j; ++k) {
+          diag -= W[j][k][l] * W[j][k][l];
+        }
+        const bool bad = singular[l] || diag < detail::kSingularityEps;
+        singular[l] = bad;
+        W[j][j][l] = bad ? 1.0 : std::sqrt(diag);
+      }
+      for (int i = j + 1; i < NC; ++i) {
+        for (int l = 0; l < L; ++l) {
+          double sum = W[i][j][l];
+          for (int k = 0; k < j; ++k) {
+            sum -= W[i][k][l] * W[j][k][l];
+          }
+          W[i][j][l] = sum / W[j][j][l];
+        }
+      }
+    }
+    for (int l = 0; l < L; ++l) {
+      if (active[l] && singular[l]) {
+        finish(l, laneChi2(l), maxIter, false);
+        active[l] = false;
+        --nActive;
+      }
+    }
+    if (nActive == 0) break;
+
+    // ── solve L y = -f, then Lᵀ lambda = y ───────────────────────────────
+    std::array<Lanes, NC> lambda;
+    for (int i = 0; i < NC; ++i) {
+      for (int l = 0; l < L; ++l) {
+        double sum = -f[i][l];
+        for (int k = 0; k < i; ++k) {
+          sum -= W[i][k][l] * lambda[k][l];
+        }
+        lambda[i][l] = sum / W[i][i][l];
+      }
+    }
+    for (int i = NC - 1; i >= 0; --i) {
+      for (int l = 0; l < L; ++l) {
+        double sum = lambda[i][l];
+        for (int k = i + 1; k < NC; ++k) {
+          sum -= W[k][i][l] * lambda[k][l];
+        }
+        lambda[i][l] = sum / W[i][i][l];
+      }
+    }
+
+    // ── update active lanes: delta = V Dᵀ lambda ─────────────────────────
+    for (int i = 0; i < NP; ++i) {
+      for (int l = 0; l < L; ++l) {
+        double dpt = 0.0, deta = 0.0, dphi = 0.0;
+        for (int c = 0; c < NC; ++c) {
+          dpt  += var[3 * i + 0][l] * D[c][3 * i + 0][l] * lambda[c][l];
+          deta += var[3 * i + 1][l] * D[c][3 * i + 1][l] * lambda[c][l];
+          dphi += var[3 * i + 2][l] * D[c][3 * i + 2][l] * lambda[c][l];
+        }
+        double newPt = pt[i][l] + dpt;
+        if (newPt < detail::kMinPt) newPt = detail::kMinPt;
+        pt[i][l]  = active[l] ? newPt : pt[i][l];
+        eta[i][l] = active[l] ? eta[i][l] + deta : eta[i][l];
+        phi[i][l] = active[l] ? phi[i][l] + dphi : phi[i][l];
+      }
+    }
+
+    // ── chi2 and masked convergence ──────────────────────────────────────
+    for (int l = 0; l < L; ++l) {
+      if (!active[l]) continue;
+      const double chi2 = laneChi2(l);
+      if (std::abs(chi2 - prevChi2[l]) < tolerance) {
+        finish(l, chi2, iter + 1, true);
+        active[l] = false;
+        --nActive;
+      } else {
+        prevChi2[l] = chi2;
+      }
+    }
+  }
+
+  for (int l = 0; l < L; ++l) {
+    if (active[l]) {
+      finish(l, laneChi2(l), maxIter, false);
+    }
+  }
+}
+
 #endif // KINEMATICFIT_H_INCLUDED
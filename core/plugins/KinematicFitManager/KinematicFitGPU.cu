@@ -15,8 +15,15 @@
 #include "KinematicFitGPU.h"
 
 #include <cuda_runtime.h>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
 #include <stdexcept>
 #include <string>
+#include <thread>
+#include <vector>
 
 // ── compile-time limits ───────────────────────────────────────────────────────
 // These must match the constants declared in KinematicFitGPU.h.
@@ -510,3 +517,198 @@ void kinFitBatchGPU(const float *inputs, const float *sigmas, int nParticles,
   kinFitRunGPU(ctx, inputs, nEvents, maxIter, tolerance, outputs);
 }
 
+
+// ── CudaKinFitBatchQueue ──────────────────────────────────────────────────────
+
+struct CudaKinFitBatchQueue::Impl {
+  /// One staging batch: pinned host buffers, device buffers and a stream.
+  struct Batch {
+    float        *h_inputs  = nullptr; ///< Pinned: [maxBatch * inStride]
+    float        *h_outputs = nullptr; ///< Pinned: [maxBatch * outStride]
+    float        *d_inputs  = nullptr;
+    float        *d_outputs = nullptr;
+    cudaStream_t  stream    = nullptr;
+    int           count     = 0;
+    std::vector<float *>            destinations;
+    std::vector<std::promise<void>> promises;
+    std::chrono::steady_clock::time_point firstQueued;
+  };
+
+  std::shared_ptr<const CudaKinFitContext> ctx;
+  int   maxIter;
+  float tolerance;
+  int   maxBatch;
+  int   flushAt;
+  std::chrono::microseconds maxWait;
+  int   inStride;
+  int   outStride;
+
+  Batch batches[2];
+  int   filling  = 0;     ///< Batch currently accepting events
+  bool  stopping = false;
+  std::mutex              mutex;
+  std::condition_variable ready; ///< Dispatcher: the filling batch changed
+  std::condition_variable space; ///< Submitters: the filling batch has room
+  std::atomic<std::uint64_t> launches{0};
+  std::atomic<std::uint64_t> events{0};
+  std::thread dispatcher;
+
+  void allocate(Batch &batch) {
+    const size_t inBytes  = static_cast<size_t>(maxBatch) * inStride * sizeof(float);
+    const size_t outBytes = static_cast<size_t>(maxBatch) * outStride * sizeof(float);
+    checkCuda(cudaMallocHost(&batch.h_inputs, inBytes), "CudaKinFitBatchQueue: pinned inputs");
+    checkCuda(cudaMallocHost(&batch.h_outputs, outBytes), "CudaKinFitBatchQueue: pinned outputs");
+    checkCuda(cudaMalloc(&batch.d_inputs, inBytes), "CudaKinFitBatchQueue: device inputs");
+    checkCuda(cudaMalloc(&batch.d_outputs, outBytes), "CudaKinFitBatchQueue: device outputs");
+    checkCuda(cudaStreamCreateWithFlags(&batch.stream, cudaStreamNonBlocking),
+              "CudaKinFitBatchQueue: stream");
+    batch.destinations.reserve(static_cast<size_t>(maxBatch));
+    batch.promises.reserve(static_cast<size_t>(maxBatch));
+  }
+
+  static void release(Batch &batch) {
+    if (batch.stream) cudaStreamDestroy(batch.stream);
+    cudaFreeHost(batch.h_inputs);
+    cudaFreeHost(batch.h_outputs);
+    cudaFree(batch.d_inputs);
+    cudaFree(batch.d_outputs);
+    batch = Batch{};
+  }
+
+  /// Run @p batch on the device and resolve its futures.  Called without
+  /// the lock: submitters only touch the other batch meanwhile.
+  void launch(Batch &batch) {
+    const int n = batch.count;
+    try {
+      checkCuda(cudaMemcpyAsync(batch.d_inputs, batch.h_inputs,
+                                static_cast<size_t>(n) * inStride * sizeof(float),
+                                cudaMemcpyHostToDevice, batch.stream),
+                "CudaKinFitBatchQueue: H2D inputs");
+      constexpr int kBlockSize = 256;
+      const int gridSize = (n + kBlockSize - 1) / kBlockSize;
+      kinFitKernel<<<gridSize, kBlockSize, 0, batch.stream>>>(
+          batch.d_inputs, ctx->d_sigmas,
+          ctx->d_conTypes, ctx->d_conIdx1, ctx->d_conIdx2, ctx->d_conIdx3,
+          ctx->d_conTarget, ctx->d_conSigma,
+          batch.d_outputs,
+          ctx->nParticles, ctx->nConstraints, n, maxIter, tolerance);
+      checkCuda(cudaGetLastError(), "CudaKinFitBatchQueue: kernel launch");
+      checkCuda(cudaMemcpyAsync(batch.h_outputs, batch.d_outputs,
+                                static_cast<size_t>(n) * outStride * sizeof(float),
+                                cudaMemcpyDeviceToHost, batch.stream),
+                "CudaKinFitBatchQueue: D2H outputs");
+      checkCuda(cudaStreamSynchronize(batch.stream), "CudaKinFitBatchQueue: synchronize");
+    } catch (...) {
+      const auto error = std::current_exception();
+      for (auto &promise : batch.promises) promise.set_exception(error);
+      return;
+    }
+    for (int e = 0; e < n; ++e) {
+      std::memcpy(batch.destinations[static_cast<size_t>(e)],
+                  batch.h_outputs + static_cast<size_t>(e) * outStride,
+                  static_cast<size_t>(outStride) * sizeof(float));
+      batch.promises[static_cast<size_t>(e)].set_value();
+    }
+    launches.fetch_add(1, std::memory_order_relaxed);
+    events.fetch_add(static_cast<std::uint64_t>(n), std::memory_order_relaxed);
+  }
+
+  void dispatchLoop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    for (;;) {
+      Batch &batch = batches[filling];
+      if (batch.count == 0) {
+        if (stopping) return;
+        ready.wait(lock);
+        continue;
+      }
+      const auto deadline = batch.firstQueued + maxWait;
+      if (!stopping && batch.count < flushAt &&
+          std::chrono::steady_clock::now() < deadline) {
+        ready.wait_until(lock, deadline);
+        continue;
+      }
+      // The other batch finished its launch before this one started filling.
+      filling = 1 - filling;
+      space.notify_all();
+      lock.unlock();
+      launch(batch);
+      lock.lock();
+      batch.count = 0;
+      batch.destinations.clear();
+      batch.promises.clear();
+      space.notify_all();
+    }
+  }
+};
+
+CudaKinFitBatchQueue::CudaKinFitBatchQueue(
+    std::shared_ptr<const CudaKinFitContext> ctx, int maxIter, float tolerance,
+    int maxBatch, int concurrency, std::chrono::microseconds maxWait)
+    : impl_(std::make_unique<Impl>()) {
+  if (!ctx) {
+    throw std::runtime_error("CudaKinFitBatchQueue: null fit context");
+  }
+  if (maxBatch <= 0) {
+    throw std::runtime_error("CudaKinFitBatchQueue: maxBatch (" +
+                             std::to_string(maxBatch) + ") must be positive");
+  }
+  Impl &q     = *impl_;
+  q.ctx       = std::move(ctx);
+  q.maxIter   = maxIter;
+  q.tolerance = tolerance;
+  q.maxBatch  = maxBatch;
+  q.flushAt   = std::max(1, std::min(maxBatch, concurrency));
+  q.maxWait   = maxWait;
+  q.inStride  = q.ctx->nParticles * 4;
+  q.outStride = 2 + q.ctx->nParticles * 3;
+  try {
+    q.allocate(q.batches[0]);
+    q.allocate(q.batches[1]);
+  } catch (...) {
+    Impl::release(q.batches[0]);
+    Impl::release(q.batches[1]);
+    throw;
+  }
+  q.dispatcher = std::thread([&q] { q.dispatchLoop(); });
+}
+
+CudaKinFitBatchQueue::~CudaKinFitBatchQueue() {
+  Impl &q = *impl_;
+  {
+    std::lock_guard<std::mutex> lock(q.mutex);
+    q.stopping = true;
+  }
+  q.ready.notify_all();
+  q.dispatcher.join();
+  Impl::release(q.batches[0]);
+  Impl::release(q.batches[1]);
+}
+
+std::future<void> CudaKinFitBatchQueue::submit(const float *inputs, float *outputs) {
+  Impl &q = *impl_;
+  std::unique_lock<std::mutex> lock(q.mutex);
+  q.space.wait(lock, [&q] { return q.batches[q.filling].count < q.maxBatch; });
+  Impl::Batch &batch = q.batches[q.filling];
+  if (batch.count == 0) {
+    batch.firstQueued = std::chrono::steady_clock::now();
+  }
+  std::memcpy(batch.h_inputs + static_cast<size_t>(batch.count) * q.inStride, inputs,
+              static_cast<size_t>(q.inStride) * sizeof(float));
+  batch.destinations.push_back(outputs);
+  batch.promises.emplace_back();
+  std::future<void> result = batch.promises.back().get_future();
+  ++batch.count;
+  if (batch.count == 1 || batch.count >= q.flushAt) {
+    q.ready.notify_one();
+  }
+  return result;
+}
+
+std::uint64_t CudaKinFitBatchQueue::launchCount() const {
+  return impl_->launches.load(std::memory_order_relaxed);
+}
+
+std::uint64_t CudaKinFitBatchQueue::eventCount() const {
+  return impl_->events.load(std::memory_order_relaxed);
+}
@@ -71,9 +71,18 @@
 static constexpr int kGPUMaxParticles   = 10;
 /// Maximum number of constraints supported by the GPU kinematic-fit kernel.
 static constexpr int kGPUMaxConstraints =  8;
+/// Default maximum number of events per CudaKinFitBatchQueue launch.
+static constexpr int kGPUDefaultBatchSize = 1024;
+/// Default time a CudaKinFitBatchQueue waits for a batch to fill [µs].
+static constexpr int kGPUDefaultBatchWaitMicroseconds = 200;
 
 #ifdef USE_CUDA
 
+#include <chrono>
+#include <cstdint>
+#include <future>
+#include <memory>
+
 /**
  * @brief Persistent GPU context for a kinematic fit configuration.
  *
@@ -166,6 +175,73 @@ void kinFitBatchGPU(const float *inputs, const float *sigmas, int nParticles,
                     const float *conSigma, int nConstraints, int nEvents,
                     int maxIter, float tolerance, float *outputs);
 
+/**
+ * @brief Queue that collects single-event fits from all RDataFrame slots and
+ *        runs them as one GPU launch.
+ *
+ * kinFitRunGPU() with nEvents=1 pays a kernel launch and two synchronous
+ * copies per event, which leaves the GPU idle.  A batch queue is shared by
+ * every slot of a fit: submit() copies the event into a pinned host staging
+ * buffer and returns a future; a dispatcher thread launches the kernel on
+ * its own CUDA stream once @p maxBatch events are queued, once
+ * @p concurrency events are queued (every slot is waiting), or
+ * @p maxWait after the first queued event, and resolves the futures when the
+ * results are back.  Two staging batches alternate, so slots fill the next
+ * batch while the previous one is on the device.
+ *
+ * A slot blocks on its future inside the Define lambda, so a batch holds at
+ * most one event per slot and per fit column; @p concurrency should be the
+ * number of slots.
+ *
+ * Thread-safety: submit() and run() may be called concurrently from any
+ * thread.  The destructor completes all queued events.
+ */
+class CudaKinFitBatchQueue {
+public:
+  /**
+   * @param ctx         Fit context (static device data), shared with the queue.
+   * @param maxIter     Maximum number of linearisation iterations.
+   * @param tolerance   Convergence criterion on |Δχ²|.
+   * @param maxBatch    Maximum events per launch.
+   * @param concurrency Number of threads submitting concurrently (slots).
+   * @param maxWait     Longest time an event waits for its batch to fill.
+   */
+  CudaKinFitBatchQueue(std::shared_ptr<const CudaKinFitContext> ctx,
+                       int maxIter, float tolerance,
+                       int maxBatch = kGPUDefaultBatchSize,
+                       int concurrency = 1,
+                       std::chrono::microseconds maxWait =
+                           std::chrono::microseconds(kGPUDefaultBatchWaitMicroseconds));
+  ~CudaKinFitBatchQueue();
+
+  CudaKinFitBatchQueue(const CudaKinFitBatchQueue &) = delete;
+  CudaKinFitBatchQueue &operator=(const CudaKinFitBatchQueue &) = delete;
+
+  /**
+   * @brief Queue one event.
+   *
+   * @param inputs  Host array [nParticles * 4]; copied before returning.
+   * @param outputs Host array [2 + nParticles * 3]; written before the
+   *                returned future becomes ready and must stay valid until
+   *                then.
+   * @return Future that becomes ready (or holds the CUDA error) once the
+   *         event's batch has been processed.
+   */
+  std::future<void> submit(const float *inputs, float *outputs);
+
+  /// Queue one event and wait for its result.
+  void run(const float *inputs, float *outputs) { submit(inputs, outputs).get(); }
+
+  /// Number of kernel launches so far.
+  std::uint64_t launchCount() const;
+  /// Number of events processed so far.
+  std::uint64_t eventCount() const;
+
+private:
+  struct Impl;
+  std::unique_ptr<Impl> impl_;
+};
+
 #endif // USE_CUDA
 
 #endif // KINEMATICFITGPU_H_INCLUDED
@@ -1,4 +1,5 @@
 #include <KinematicFit.h>
+#include <AsyncLogger.h>
 #include <analyzer.h>
 #include <KinematicFitGPU.h>
 #include <KinematicFitManager.h>
@@ -6,12 +7,16 @@
 #include <api/IDataFrameProvider.h>
 #include <api/ILogger.h>
 #include <api/ISystematicManager.h>
+#include <SystematicBundle.h>
 #include <ROOT/RVec.hxx>
 #include <RtypesCore.h>
 #include <algorithm>
+#include <array>
 #include <cctype>
+#include <chrono>
 #include <cmath>
 #include <memory>
+#include <set>
 #include <sstream>
 #include <stdexcept>
 #include <string>
@@ -226,6 +231,269 @@ static Float_t recoilMass(const RVecF &pt, const RVecF &eta,
   return static_cast<Float_t>(m2 > 0.0 ? std::sqrt(m2) : 0.0);
 }
 
+// ── per-event CPU fit kernels ──────────────────────────────────────────────────
+//
+// Packed inputs (pT, η, φ, m per particle) → results
+// [chi2, converged, pT_0, eta_0, phi_0, ...].  Fits of a common size run on a
+// FixedKinematicFit instantiation whose work storage lives on the stack; any
+// other size uses the dynamically sized KinematicFit.
+
+using FitKernel = void (*)(const KinFitConfig &cfg,
+                           const std::vector<float> &sigmas,
+                           const RVecF &inputs, RVecF &out);
+
+/// Particle @p i of a packed input block, with its configured resolutions.
+KinFitParticle packedParticle(const Float_t *inputs,
+                              const std::vector<float> &sigmas, int i) {
+  return {static_cast<double>(inputs[i * 4 + 0]),
+          static_cast<double>(inputs[i * 4 + 1]),
+          static_cast<double>(inputs[i * 4 + 2]),
+          static_cast<double>(inputs[i * 4 + 3]),
+          static_cast<double>(sigmas[static_cast<size_t>(i) * 3 + 0]),
+          static_cast<double>(sigmas[static_cast<size_t>(i) * 3 + 1]),
+          static_cast<double>(sigmas[static_cast<size_t>(i) * 3 + 2])};
+}
+
+template <typename Fitter>
+void addConfiguredConstraints(Fitter &fitter, const KinFitConfig &cfg) {
+  for (const auto &con : cfg.constraints) {
+    if (con.type == KinFitConstraintConfig::Type::PT) {
+      fitter.addPtConstraint(con.idx1, con.targetValue);
+    } else if (con.idx3 >= 0) {
+      fitter.addThreeBodyMassConstraint(con.idx1, con.idx2, con.idx3,
+                                        con.targetValue, con.massSigma);
+    } else {
+      fitter.addMassConstraint(con.idx1, con.idx2, con.targetValue,
+                               con.massSigma);
+    }
+  }
+}
+
+/// Write a fit result into one [chi2, converged, pT_0, eta_0, phi_0, ...] block.
+template <typename Result>
+void writeFitResult(const Result &res, int nParticles, Float_t *out) {
+  out[0] = static_cast<Float_t>(res.chi2);
+  out[1] = static_cast<Float_t>(res.converged ? 1.0f : 0.0f);
+  for (int i = 0; i < nParticles; ++i) {
+    out[2 + i * 3 + 0] = static_cast<Float_t>(res.fittedParticles[i].pt);
+    out[2 + i * 3 + 1] = static_cast<Float_t>(res.fittedParticles[i].eta);
+    out[2 + i * 3 + 2] = static_cast<Float_t>(res.fittedParticles[i].phi);
+  }
+}
+
+template <typename Fitter>
+void runFit(Fitter &fitter, const KinFitConfig &cfg,
+            const std::vector<float> &sigmas, const RVecF &inputs,
+            RVecF &out) {
+  const int nParticles = static_cast<int>(cfg.particles.size());
+  for (int i = 0; i < nParticles; ++i) {
+    fitter.addParticle(packedParticle(inputs.data(), sigmas, i));
+  }
+  addConfiguredConstraints(fitter, cfg);
+
+  const auto res = fitter.fit(cfg.maxIterations, cfg.convergenceTolerance);
+  writeFitResult(res, nParticles, out.data());
+}
+
+void runDynamicFit(const KinFitConfig &cfg, const std::vector<float> &sigmas,
+                   const RVecF &inputs, RVecF &out) {
+  KinematicFit fitter;
+  runFit(fitter, cfg, sigmas, inputs, out);
+}
+
+template <int NP, int NC>
+void runFixedFit(const KinFitConfig &cfg, const std::vector<float> &sigmas,
+                 const RVecF &inputs, RVecF &out) {
+  FixedKinematicFit<NP, NC> fitter;
+  runFit(fitter, cfg, sigmas, inputs, out);
+}
+
+template <int NP>
+FitKernel selectFixedFitKernel(int nConstraints) {
+  switch (nConstraints) {
+  case 1: return &runFixedFit<NP, 1>;
+  case 2: return &runFixedFit<NP, 2>;
+  case 3: return &runFixedFit<NP, 3>;
+  case 4: return &runFixedFit<NP, 4>;
+  default: return &runDynamicFit;
+  }
+}
+
+/// Fixed-size kernel for 2–6 particles with 1–4 constraints, else dynamic.
+FitKernel selectFitKernel(int nParticles, int nConstraints) {
+  switch (nParticles) {
+  case 2: return selectFixedFitKernel<2>(nConstraints);
+  case 3: return selectFixedFitKernel<3>(nConstraints);
+  case 4: return selectFixedFitKernel<4>(nConstraints);
+  case 5: return selectFixedFitKernel<5>(nConstraints);
+  case 6: return selectFixedFitKernel<6>(nConstraints);
+  default: return &runDynamicFit;
+  }
+}
+
+
+// ── block-mode CPU fit kernels ────────────────────────────────────────────────
+//
+// A block holds the packed inputs of several fits of one event (the nominal
+// inputs followed by each systematic variation of them) and a run flag per
+// fit.  Fits whose flag is set are handed to a BatchedKinematicFit L at a
+// time; the results are written block by block.  Skipped fits keep the -1
+// sentinel the caller filled in.
+//
+// With cfg.warmStart the nominal block is fitted first and the variations
+// start from its result (see scheduleBlockFits).
+
+using BlockFitKernel = void (*)(const KinFitConfig &cfg,
+                                const std::vector<float> &sigmas,
+                                const RVecF &inputs,
+                                const ROOT::VecOps::RVec<Bool_t> &run,
+                                RVecF &out);
+
+/// Start point of particle @p i of block @p b: the nominal fit (block 0)
+/// moved by the shift of the measured values from block 0 to block @p b.
+KinFitParticle warmStartParticle(const RVecF &inputs, const RVecF &out,
+                                 std::size_t b, int nParticles, int i) {
+  const Float_t *nominalIn = inputs.data();
+  const Float_t *variedIn  = inputs.data() + b * 4 * static_cast<std::size_t>(nParticles);
+  const Float_t *fitted    = out.data() + 2 + 3 * i;
+  KinFitParticle p{};
+  p.pt  = std::max(static_cast<double>(fitted[0]) + (variedIn[i * 4 + 0] - nominalIn[i * 4 + 0]),
+                   detail::kMinPt);
+  p.eta = static_cast<double>(fitted[1]) + (variedIn[i * 4 + 1] - nominalIn[i * 4 + 1]);
+  p.phi = static_cast<double>(fitted[2]) + (variedIn[i * 4 + 2] - nominalIn[i * 4 + 2]);
+  return p;
+}
+
+/**
+ * Fit the blocks of one event through @p fitBlocks(select, maxIter, warm),
+ * which fits every block b with select(b), from warmStartParticle() if
+ * @p warm, and writes its result to @p out.
+ *
+ * Without cfg.warmStart every run block is fitted cold.  With it the
+ * nominal block goes first; if it converged, the variations are fitted warm
+ * with cfg.warmStartMaxIterations and those that did not converge are
+ * fitted again cold.
+ */
+template <typename FitBlocks>
+void scheduleBlockFits(const KinFitConfig &cfg, const ROOT::VecOps::RVec<Bool_t> &run,
+                       const RVecF &out, FitBlocks &&fitBlocks) {
+  const std::size_t nOut = 2 + 3 * cfg.particles.size();
+  const auto runs = [&run](std::size_t b) { return static_cast<bool>(run[b]); };
+  if (!cfg.warmStart || run.size() < 2 || !run[0]) {
+    fitBlocks(runs, cfg.maxIterations, false);
+    return;
+  }
+  fitBlocks([](std::size_t b) { return b == 0; }, cfg.maxIterations, false);
+  const auto varied = [&run](std::size_t b) { return b > 0 && run[b]; };
+  if (!(out[1] > 0.5f)) {
+    fitBlocks(varied, cfg.maxIterations, false);
+    return;
+  }
+  fitBlocks(varied, cfg.warmStartMaxIterations, true);
+  fitBlocks([&](std::size_t b) { return varied(b) && !(out[b * nOut + 1] > 0.5f); },
+            cfg.maxIterations, false);
+}
+
+template <int NP, int NC, int L>
+void runBatchedFit(const KinFitConfig &cfg, const std::vector<float> &sigmas,
+                   const RVecF &inputs, const ROOT::VecOps::RVec<Bool_t> &run,
+                   RVecF &out) {
+  using Fitter = BatchedKinematicFit<NP, NC, L>;
+  constexpr std::size_t nIn  = 4 * NP;
+  constexpr std::size_t nOut = 2 + 3 * NP;
+  Fitter fitter;
+  addConfiguredConstraints(fitter, cfg);
+
+  std::array<typename Fitter::Result, L> results;
+  std::array<std::size_t, L> blocks;
+  int nLanes = 0;
+  const auto flush = [&](int maxIter) {
+    fitter.fit(results, maxIter, cfg.convergenceTolerance, nLanes);
+    for (int lane = 0; lane < nLanes; ++lane) {
+      writeFitResult(results[lane], NP, out.data() + blocks[lane] * nOut);
+    }
+    nLanes = 0;
+  };
+  scheduleBlockFits(cfg, run, out, [&](auto &&select, int maxIter, bool warm) {
+    for (std::size_t b = 0; b < run.size(); ++b) {
+      if (!select(b)) continue;
+      for (int i = 0; i < NP; ++i) {
+        fitter.setParticle(nLanes, i, packedParticle(inputs.data() + b * nIn, sigmas, i));
+        if (warm) fitter.setStart(nLanes, i, warmStartParticle(inputs, out, b, NP, i));
+      }
+      blocks[nLanes++] = b;
+      if (nLanes == L) flush(maxIter);
+    }
+    if (nLanes > 0) flush(maxIter);
+  });
+}
+
+/// Block kernel for fit sizes without a batched instantiation.
+void runDynamicBlockFit(const KinFitConfig &cfg, const std::vector<float> &sigmas,
+                        const RVecF &inputs, const ROOT::VecOps::RVec<Bool_t> &run,
+                        RVecF &out) {
+  const int nParticles   = static_cast<int>(cfg.particles.size());
+  const std::size_t nIn  = 4 * cfg.particles.size();
+  const std::size_t nOut = 2 + 3 * cfg.particles.size();
+  scheduleBlockFits(cfg, run, out, [&](auto &&select, int maxIter, bool warm) {
+    for (std::size_t b = 0; b < run.size(); ++b) {
+      if (!select(b)) continue;
+      KinematicFit fitter;
+      for (int i = 0; i < nParticles; ++i) {
+        fitter.addParticle(packedParticle(inputs.data() + b * nIn, sigmas, i));
+        if (warm) fitter.setStart(i, warmStartParticle(inputs, out, b, nParticles, i));
+      }
+      addConfiguredConstraints(fitter, cfg);
+      const auto res = fitter.fit(maxIter, cfg.convergenceTolerance);
+      writeFitResult(res, nParticles, out.data() + b * nOut);
+    }
+  });
+}
+
+template <int NP, int L>
+BlockFitKernel selectBatchedFitKernel(int nConstraints) {
+  switch (nConstraints) {
+  case 1: return &runBatchedFit<NP, 1, L>;
+  case 2: return &runBatchedFit<NP, 2, L>;
+  case 3: return &runBatchedFit<NP, 3, L>;
+  case 4: return &runBatchedFit<NP, 4, L>;
+  default: return &runDynamicBlockFit;
+  }
+}
+
+template <int L>
+BlockFitKernel selectBatchedFitKernel(int nParticles, int nConstraints) {
+  switch (nParticles) {
+  case 2: return selectBatchedFitKernel<2, L>(nConstraints);
+  case 3: return selectBatchedFitKernel<3, L>(nConstraints);
+  case 4: return selectBatchedFitKernel<4, L>(nConstraints);
+  case 5: return selectBatchedFitKernel<5, L>(nConstraints);
+  case 6: return selectBatchedFitKernel<6, L>(nConstraints);
+  default: return &runDynamicBlockFit;
+  }
+}
+
+/// Batched kernel with @p lanes lanes (4 or 8) for the fit sizes of
+/// selectFitKernel, else the per-fit dynamic kernel.
+BlockFitKernel selectBlockFitKernel(int nParticles, int nConstraints, int lanes) {
+  return lanes == 8 ? selectBatchedFitKernel<8>(nParticles, nConstraints)
+                    : selectBatchedFitKernel<4>(nParticles, nConstraints);
+}
+
+/// Parse a boolean config value ("true"/"false"/"1"/"0", case-insensitive).
+bool parseBool(const std::string &value, const std::string &key,
+               const std::string &fitName) {
+  std::string val = value;
+  std::transform(val.begin(), val.end(), val.begin(),
+                 [](unsigned char c) { return std::tolower(c); });
+  if (val == "true" || val == "1") return true;
+  if (val == "false" || val == "0") return false;
+  throw std::runtime_error(
+      "KinematicFitManager: invalid value '" + value +
+      "' for key '" + key + "' in fit '" + fitName +
+      "' – expected 'true', 'false', '1', or '0'");
+}
+
 } // anonymous namespace
 
 // ── constructor ───────────────────────────────────────────────────────────────
@@ -256,7 +524,7 @@ KinematicFitManager::KinematicFitManager(
  *
  * The fit itself sees ordinary (pT, η, φ, m) scalar inputs for every particle
  * regardless of source.  Thread safety is guaranteed because a fresh
- * KinematicFit object is created inside the per-event lambda.
+ * fitter is created inside the per-event lambda.
  *
  * Output layout (2 + 3*N floats, N = number of particles):
  *  [0]          chi2
@@ -535,25 +803,28 @@ void KinematicFitManager::applyFit(const std::string &fitName) {
     // Upload static data (resolutions and constraints) to the GPU once.
     // The context is shared across all events via shared_ptr, so device
     // memory for static data is allocated only once per fit definition.
-    // Per-event input/output device buffers are managed by kinFitRunGPU()
-    // using thread-local storage that grows on demand and is never freed
-    // until thread exit — no per-event cudaMalloc/cudaFree overhead.
     auto ctx = std::make_shared<CudaKinFitContext>(
         sigmas.data(), nParticles,
         conTypes.data(), conIdx1.data(), conIdx2.data(), conIdx3.data(),
         conTarget.data(), conSigma.data(), nConstraints);
 
+    // One queue per fit, shared by its nominal and variation columns: events
+    // from all slots are fitted together instead of one launch per event.
+    const int nSlots =
+        static_cast<int>(dataManager_m->getDataFrame().GetNSlots());
+    auto queue = std::make_shared<CudaKinFitBatchQueue>(
+        ctx, cfg.maxIterations, static_cast<float>(cfg.convergenceTolerance),
+        cfg.gpuBatchSize, nSlots,
+        std::chrono::microseconds(cfg.gpuBatchWaitMicroseconds));
+
     auto fitLambdaGPU =
-        [ctx, nParticles, maxIter = cfg.maxIterations,
-         tol = static_cast<float>(cfg.convergenceTolerance)](
-            ROOT::VecOps::RVec<Float_t> &inputs, bool runVar)
+        [queue, nParticles](ROOT::VecOps::RVec<Float_t> &inputs, bool runVar)
         -> ROOT::VecOps::RVec<Float_t> {
       if (!runVar) {
         return ROOT::VecOps::RVec<Float_t>(2 + 3 * nParticles, -1.0f);
       }
-      const int outSize = 2 + nParticles * 3;
-      ROOT::VecOps::RVec<Float_t> out(outSize);
-      kinFitRunGPU(*ctx, inputs.data(), /*nEvents=*/1, maxIter, tol, out.data());
+      ROOT::VecOps::RVec<Float_t> out(2 + nParticles * 3);
+      queue->run(inputs.data(), out.data());
       return out;
     };
 
@@ -569,58 +840,31 @@ void KinematicFitManager::applyFit(const std::string &fitName) {
   }
 #endif
   { // CPU path (also the else-branch of the USE_CUDA block above)
-    // ── per-event fit lambda ────────────────────────────────────────────────
-    // Output layout: [chi2, converged, pT_0, eta_0, phi_0, pT_1, eta_1, phi_1, ...]
-    // When runVar is false the fit is skipped and all outputs are -1.
-    // The precomputed sigmas vector is captured to avoid re-reading cfg per event.
-    auto fitLambda =
-        [cfg, nParticles, sigmas](ROOT::VecOps::RVec<Float_t> &inputs, bool runVar)
-        -> ROOT::VecOps::RVec<Float_t> {
-      if (!runVar) {
-        // Sentinel: chi2 = -1, converged = -1 (→ false), fitted momenta = -1
-        return ROOT::VecOps::RVec<Float_t>(2 + 3 * nParticles, -1.0f);
-      }
-      KinematicFit fitter;
-
-      for (int i = 0; i < nParticles; ++i) {
-        const double pt   = static_cast<double>(inputs[i * 4 + 0]);
-        const double eta  = static_cast<double>(inputs[i * 4 + 1]);
-        const double phi  = static_cast<double>(inputs[i * 4 + 2]);
-        const double mass = static_cast<double>(inputs[i * 4 + 3]);
-        const double sigPt  = static_cast<double>(sigmas[static_cast<size_t>(i) * 3 + 0]);
-        const double sigEta = static_cast<double>(sigmas[static_cast<size_t>(i) * 3 + 1]);
-        const double sigPhi = static_cast<double>(sigmas[static_cast<size_t>(i) * 3 + 2]);
-        fitter.addParticle({pt, eta, phi, mass, sigPt, sigEta, sigPhi});
-      }
-
-      for (const auto &con : cfg.constraints) {
-        if (con.type == KinFitConstraintConfig::Type::PT) {
-          fitter.addPtConstraint(con.idx1, con.targetValue);
-        } else if (con.idx3 >= 0) {
-          fitter.addThreeBodyMassConstraint(con.idx1, con.idx2, con.idx3,
-                                            con.targetValue, con.massSigma);
-        } else {
-          fitter.addMassConstraint(con.idx1, con.idx2, con.targetValue,
-                                   con.massSigma);
+    if (cfg.blockMode) {
+      // Nominal and varied inputs are fitted together in SIMD lanes.
+      defineBlockFit(fitName, cfg, inputCols, runVarCol, sigmas);
+    } else {
+      // ── per-event fit lambda ────────────────────────────────────────────────
+      // Output layout: [chi2, converged, pT_0, eta_0, phi_0, pT_1, eta_1, phi_1, ...]
+      // When runVar is false the fit is skipped and all outputs are -1.
+      // The precomputed sigmas vector is captured to avoid re-reading cfg per event.
+      // The kernel is chosen once here from the fit size (see selectFitKernel).
+      const FitKernel kernel = selectFitKernel(nParticles, nConstraints);
+      auto fitLambda =
+          [cfg, nParticles, sigmas, kernel](ROOT::VecOps::RVec<Float_t> &inputs, bool runVar)
+          -> ROOT::VecOps::RVec<Float_t> {
+        if (!runVar) {
+          // Sentinel: chi2 = -1, converged = -1 (→ false), fitted momenta = -1
+          return ROOT::VecOps::RVec<Float_t>(2 + 3 * nParticles, -1.0f);
         }
-      }
-
-      const KinFitResult res = fitter.fit(cfg.maxIterations,
-                                          cfg.convergenceTolerance);
-
-      ROOT::VecOps::RVec<Float_t> out(2 + 3 * nParticles);
-      out[0] = static_cast<Float_t>(res.chi2);
-      out[1] = static_cast<Float_t>(res.converged ? 1.0f : 0.0f);
-      for (int i = 0; i < nParticles; ++i) {
-        out[2 + i * 3 + 0] = static_cast<Float_t>(res.fittedParticles[i].pt);
-        out[2 + i * 3 + 1] = static_cast<Float_t>(res.fittedParticles[i].eta);
-        out[2 + i * 3 + 2] = static_cast<Float_t>(res.fittedParticles[i].phi);
-      }
-      return out;
-    };
+        ROOT::VecOps::RVec<Float_t> out(2 + 3 * nParticles);
+        kernel(cfg, sigmas, inputs, out);
+        return out;
+      };
 
-    dataManager_m->Define(resultsCol, fitLambda, {inputsCol, runVarCol},
-                           *systematicManager_m);
+      dataManager_m->Define(resultsCol, fitLambda, {inputsCol, runVarCol},
+                             *systematicManager_m);
+    }
   }
 
   // ── slice individual output columns ──────────────────────────────────────
@@ -649,6 +893,84 @@ void KinematicFitManager::applyFit(const std::string &fitName) {
   }
 }
 
+/**
+ * @brief Define the results of a block-mode fit and of all its variations.
+ *
+ * The packed inputs and run flags of the nominal fit and of every systematic
+ * variation that affects them are concatenated, variation-major, into one
+ * block per event.  A single Define fits the whole block with a
+ * BatchedKinematicFit of cfg.blockLanes lanes, and the block is fanned out
+ * into @p fitName_results and @p fitName_results_<variation>, which are
+ * registered with the systematic manager so that the sliced output columns
+ * get their variations.
+ */
+void KinematicFitManager::defineBlockFit(const std::string &fitName,
+                                         const KinFitConfig &cfg,
+                                         const std::vector<std::string> &inputCols,
+                                         const std::string &runVarCol,
+                                         const std::vector<float> &sigmas) {
+  std::set<std::string> systematics;
+  for (const auto &col : inputCols) {
+    const auto &s = systematicManager_m->getSystematicsForVariable(col);
+    systematics.insert(s.begin(), s.end());
+  }
+  const auto &runSysts = systematicManager_m->getSystematicsForVariable(runVarCol);
+  systematics.insert(runSysts.begin(), runSysts.end());
+
+  std::vector<std::string> labels{"Nominal"};
+  for (const auto &syst : systematics) {
+    labels.push_back(syst + "Up");
+    labels.push_back(syst + "Down");
+  }
+
+  std::vector<std::string> blockInputCols;
+  std::vector<std::string> blockRunCols;
+  blockInputCols.reserve(labels.size() * inputCols.size());
+  for (const auto &label : labels) {
+    for (const auto &col : inputCols) {
+      blockInputCols.push_back(systematicManager_m->getVariationColumnName(col, label));
+    }
+    blockRunCols.push_back(systematicManager_m->getVariationColumnName(runVarCol, label));
+  }
+
+  const std::string blockInputsCol  = fitName + "_inputs_block";
+  const std::string blockRunCol     = fitName + "_run_block";
+  const std::string blockResultsCol = fitName + "_results_block";
+  dataManager_m->DefineVector(blockInputsCol, blockInputCols, "Float_t",
+                               *systematicManager_m);
+  dataManager_m->DefineVector(blockRunCol, blockRunCols, "Bool_t",
+                               *systematicManager_m);
+
+  const int nParticles   = static_cast<int>(cfg.particles.size());
+  const int nConstraints = static_cast<int>(cfg.constraints.size());
+  const std::size_t blockSize =
+      labels.size() * (2 + 3 * static_cast<std::size_t>(nParticles));
+  const BlockFitKernel kernel =
+      selectBlockFitKernel(nParticles, nConstraints, cfg.blockLanes);
+  auto blockLambda =
+      [cfg, sigmas, kernel, blockSize](const RVecF &inputs,
+                                       const ROOT::VecOps::RVec<Bool_t> &run)
+      -> RVecF {
+    RVecF out(blockSize, -1.0f);
+    kernel(cfg, sigmas, inputs, run, out);
+    return out;
+  };
+  dataManager_m->Define(blockResultsCol, blockLambda, {blockInputsCol, blockRunCol},
+                         *systematicManager_m);
+
+  const std::string resultsCol = fitName + "_results";
+  std::vector<std::string> resultCols;
+  resultCols.reserve(labels.size());
+  for (const auto &label : labels) {
+    resultCols.push_back(label == "Nominal" ? resultsCol : resultsCol + "_" + label);
+  }
+  fanOutVectorResultBundle(*dataManager_m, blockResultsCol, resultCols);
+  for (const auto &syst : systematics) {
+    systematicManager_m->registerSystematic(syst, {resultsCol});
+  }
+  systematicManager_m->registerVariationBundle(resultsCol, blockResultsCol, labels);
+}
+
 /**
  * @brief Apply all configured kinematic fits to the current RDataFrame.
  */
@@ -771,6 +1093,14 @@ void KinematicFitManager::registerFits(
     cfg.maxIterations = getOptInt("maxIterations", cfg.maxIterations);
     cfg.convergenceTolerance =
         getOpt("convergenceTolerance", cfg.convergenceTolerance);
+    cfg.gpuBatchSize = getOptInt("gpuBatchSize", cfg.gpuBatchSize);
+    cfg.gpuBatchWaitMicroseconds =
+        getOptInt("gpuBatchWaitMicroseconds", cfg.gpuBatchWaitMicroseconds);
+    if (cfg.gpuBatchSize <= 0 || cfg.gpuBatchWaitMicroseconds < 0) {
+      throw std::runtime_error(
+          "KinematicFitManager: fit '" + entry.at("name") +
+          "' needs gpuBatchSize > 0 and gpuBatchWaitMicroseconds >= 0");
+    }
 
     // ── optional resolution parameters (fall back to struct defaults) ──────
     cfg.leptonPtResolution  = getOpt("leptonPtResolution",  cfg.leptonPtResolution);
@@ -792,22 +1122,49 @@ void KinematicFitManager::registerFits(
     {
       auto it = entry.find("useGPU");
       if (it != entry.end()) {
-        std::string val = it->second;
-        // Normalize to lowercase for case-insensitive comparison.
-        std::transform(val.begin(), val.end(), val.begin(),
-                       [](unsigned char c) { return std::tolower(c); });
-        if (val == "true" || val == "1") {
-          cfg.useGPU = true;
-        } else if (val == "false" || val == "0") {
-          cfg.useGPU = false;
-        } else {
-          throw std::runtime_error(
-              "KinematicFitManager: invalid value '" + it->second +
-              "' for key 'useGPU' in fit '" + entry.at("name") +
-              "' – expected 'true', 'false', '1', or '0'");
-        }
+        cfg.useGPU = parseBool(it->second, "useGPU", entry.at("name"));
+      }
+    }
+
+    // ── optional block mode (CPU only) ─────────────────────────────────────
+    {
+      auto it = entry.find("blockMode");
+      if (it != entry.end()) {
+        cfg.blockMode = parseBool(it->second, "blockMode", entry.at("name"));
+      }
+    }
+    cfg.blockLanes = getOptInt("blockLanes", cfg.blockLanes);
+    if (cfg.blockLanes != 4 && cfg.blockLanes != 8) {
+      throw std::runtime_error(
+          "KinematicFitManager: fit '" + entry.at("name") +
+          "' needs blockLanes = 4 or 8");
+    }
+    if (cfg.blockMode && cfg.useGPU) {
+      throw std::runtime_error(
+          "KinematicFitManager: fit '" + entry.at("name") +
+          "' sets both blockMode and useGPU; block mode runs on the CPU");
+    }
+
+    // ── optional warm start of the variations (block mode only) ───────────
+    {
+      auto it = entry.find("warmStart");
+      if (it != entry.end()) {
+        cfg.warmStart = parseBool(it->second, "warmStart", entry.at("name"));
       }
     }
+    cfg.warmStartMaxIterations =
+        getOptInt("warmStartMaxIterations", cfg.warmStartMaxIterations);
+    if (cfg.warmStart && !cfg.blockMode) {
+      throw std::runtime_error(
+          "KinematicFitManager: fit '" + entry.at("name") +
+          "' sets warmStart without blockMode; only block mode fits the "
+          "nominal and its variations together");
+    }
+    if (cfg.warmStartMaxIterations < 2) {
+      throw std::runtime_error(
+          "KinematicFitManager: fit '" + entry.at("name") +
+          "' needs warmStartMaxIterations >= 2");
+    }
 
     objects_m.emplace(entry.at("name"), std::move(cfg));
 
@@ -822,8 +1179,8 @@ void KinematicFitManager::registerFits(
 }
 
 void KinematicFitManager::initialize() {
-  std::cout << "KinematicFitManager: initialized with "
-            << kinfit_runVars_m.size() << " fit(s)." << std::endl;
+  RDF_LOG_INFO << "KinematicFitManager: initialized with "
+               << kinfit_runVars_m.size() << " fit(s).";
 }
 
 void KinematicFitManager::reportMetadata() {
@@ -166,6 +166,56 @@ struct KinFitConfig {
   ///
   /// Config key: @c useGPU=true / @c useGPU=false  (default: false)
   bool useGPU = false;
+
+  /// @brief Maximum number of events per GPU launch.
+  ///
+  /// Events from all slots are collected by a shared CudaKinFitBatchQueue
+  /// and fitted together; a batch is launched when it is full, when every
+  /// slot is waiting on it, or after @ref gpuBatchWaitMicroseconds.
+  ///
+  /// Config key: @c gpuBatchSize  (default: kGPUDefaultBatchSize)
+  int gpuBatchSize = 1024;
+
+  /// @brief Longest time an event waits for its GPU batch to fill [µs].
+  ///
+  /// Config key: @c gpuBatchWaitMicroseconds  (default: 200)
+  int gpuBatchWaitMicroseconds = 200;
+
+  /// @brief Fit the nominal inputs and all their systematic variations
+  ///        together on the CPU.
+  ///
+  /// Each event's nominal and varied inputs are fitted in one call by a
+  /// BatchedKinematicFit, @ref blockLanes fits per SIMD batch, and the
+  /// results are registered as variations of the fit outputs.  Only
+  /// systematics that affect a fit input or the run variable are fitted;
+  /// without any the fit still runs once per event.  Cannot be combined with
+  /// @ref useGPU.
+  ///
+  /// Config key: @c blockMode=true / @c blockMode=false  (default: false)
+  bool blockMode = false;
+
+  /// @brief Fits per SIMD batch in block mode: 4 (AVX2) or 8 (AVX-512).
+  ///
+  /// Config key: @c blockLanes  (default: 4)
+  int blockLanes = 4;
+
+  /// @brief Start the systematic variations of a block-mode fit from the
+  ///        nominal fit of the same event.
+  ///
+  /// The nominal inputs are fitted first.  Each variation then starts from
+  /// the nominal fitted parameters moved by the shift of its measured
+  /// values, and gets at most @ref warmStartMaxIterations iterations.  A
+  /// variation that does not converge in them, and every variation of an
+  /// event whose nominal fit did not converge, is fitted again from its
+  /// measured values with @ref maxIterations.  Requires @ref blockMode.
+  ///
+  /// Config key: @c warmStart=true / @c warmStart=false  (default: false)
+  bool warmStart = false;
+
+  /// @brief Iteration limit of a warm-started variation fit (at least 2).
+  ///
+  /// Config key: @c warmStartMaxIterations  (default: 10)
+  int warmStartMaxIterations = 10;
 };
 
 /**
@@ -209,6 +259,18 @@ struct KinFitConfig {
  *     jetPtResolution,    jetEtaResolution,    jetPhiResolution
  *     metPtResolution,    metEtaResolution,    metPhiResolution
  *     recoilPtResolution, recoilEtaResolution, recoilPhiResolution
+ *     useGPU               – run the fit on the GPU (CUDA builds only)
+ *     gpuBatchSize         – maximum events per GPU launch (default 1024)
+ *     gpuBatchWaitMicroseconds – longest wait for a GPU batch to fill
+ *                           (default 200)
+ *     blockMode            – fit the nominal inputs and their systematic
+ *                           variations together in SIMD lanes (CPU only)
+ *     blockLanes           – lanes per batch in block mode, 4 or 8
+ *                           (default 4)
+ *     warmStart            – start the variations of a block-mode fit from
+ *                           the event's nominal fit (default false)
+ *     warmStartMaxIterations – iterations of a warm-started fit before it
+ *                           falls back to a cold start (default 10)
  *
  * **Particle spec format**
  *
@@ -350,6 +412,17 @@ private:
    */
   void registerFits(const IConfigurationProvider &configProvider);
 
+  /**
+   * @brief Define @p fitName_results and its variation columns in block mode.
+   * @param inputCols Packed per-particle input columns (pT, η, φ, m each).
+   * @param runVarCol Boolean run-variable column.
+   * @param sigmas    Per-particle resolutions (σ_pT/pT, σ_η, σ_φ each).
+   */
+  void defineBlockFit(const std::string &fitName, const KinFitConfig &cfg,
+                      const std::vector<std::string> &inputCols,
+                      const std::string &runVarCol,
+                      const std::vector<float> &sigmas);
+
   /// Map from fit name to run-variable column name (empty = always run).
   std::unordered_map<std::string, std::string> kinfit_runVars_m;
 };
@@ -6,14 +6,161 @@
 #include <MuonRochesterManager.h>
 #include <analyzer.h>
 #include <api/ILogger.h>
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <cmath>
 #include <cstdint>
+#include <unordered_map>
 #include <vector>
 #include <sstream>
 #include <stdexcept>
 
 namespace {
 
+using CorrectionArgs = std::vector<correction::Variable::Type>;
+
+/// Number of numeric Rochester inputs: charge, eta, phi, pt, genPt,
+/// nTrackerLayers, u1, u2.
+constexpr std::size_t kRochesterInputs = 8;
+
+/**
+ * @brief Rochester correction with its argument layout resolved once.
+ *
+ * templates holds one argument list per string-argument set, with the
+ * strings in place and placeholders in the numeric slots.
+ */
+struct RochesterKernel {
+  correction::Correction::Ref correction;
+  std::size_t id = 0;
+  std::vector<CorrectionArgs> templates;
+  std::array<std::size_t, kRochesterInputs> slots{};
+  std::array<bool, kRochesterInputs> isInt{};
+};
+
+std::shared_ptr<const RochesterKernel>
+makeRochesterKernel(correction::Correction::Ref correction,
+                    const std::vector<std::vector<std::string>> &argumentSets,
+                    const std::string &correctionName) {
+  static std::atomic<std::size_t> nextKernelId{1};
+  auto kernel = std::make_shared<RochesterKernel>();
+  kernel->correction = correction;
+  kernel->id = nextKernelId.fetch_add(1, std::memory_order_relaxed);
+
+  for (const auto &stringArgs : argumentSets) {
+    CorrectionArgs args;
+    std::size_t numeric = 0;
+    auto stringIt = stringArgs.begin();
+    for (const auto &input : correction->inputs()) {
+      if (input.typeStr() == "string") {
+        if (stringIt == stringArgs.end())
+          throw std::runtime_error(
+              "MuonRochesterManager: not enough string arguments for "
+              "correction '" + correctionName + "'");
+        args.emplace_back(*stringIt++);
+        continue;
+      }
+      if (numeric < kRochesterInputs) {
+        kernel->slots[numeric] = args.size();
+        kernel->isInt[numeric] = input.typeStr() == "int";
+      }
+      ++numeric;
+      if (input.typeStr() == "int")
+        args.emplace_back(0);
+      else
+        args.emplace_back(0.0);
+    }
+    if (numeric != kRochesterInputs)
+      throw std::runtime_error(
+          "MuonRochesterManager: correction '" + correctionName + "' expects " +
+          std::to_string(numeric) + " numeric inputs, the Rochester layout has " +
+          std::to_string(kRochesterInputs));
+    kernel->templates.push_back(std::move(args));
+  }
+  return kernel;
+}
+
+/**
+ * @brief Evaluate the kernel for every muon of the event.
+ *
+ * The result is variation-major (entries [k·n, (k+1)·n) for argument set k).
+ * Each thread keeps its own copy of the argument lists, so only the numeric
+ * slots are written per muon and the loop does not allocate.
+ */
+ROOT::VecOps::RVec<Float_t> evaluateRochesterKernel(
+    const RochesterKernel &kernel,
+    const std::array<const ROOT::VecOps::RVec<Float_t> *, kRochesterInputs> &inputs) {
+  thread_local std::unordered_map<std::size_t, std::vector<CorrectionArgs>> scratch;
+  auto [it, inserted] = scratch.try_emplace(kernel.id);
+  if (inserted)
+    it->second = kernel.templates;
+  auto &argumentLists = it->second;
+
+  const std::size_t n = inputs[0]->size();
+  for (const auto *column : inputs) {
+    if (column->size() != n)
+      throw std::runtime_error(
+          "MuonRochesterManager: Rochester input columns have different lengths");
+  }
+  ROOT::VecOps::RVec<Float_t> out(n * argumentLists.size());
+  for (std::size_t k = 0; k < argumentLists.size(); ++k) {
+    auto &args = argumentLists[k];
+    for (std::size_t i = 0; i < n; ++i) {
+      for (std::size_t f = 0; f < kRochesterInputs; ++f) {
+        const Float_t value = (*inputs[f])[i];
+        if (kernel.isInt[f])
+          args[kernel.slots[f]] = static_cast<int>(value);
+        else
+          args[kernel.slots[f]] = static_cast<double>(value);
+      }
+      out[k * n + i] = static_cast<Float_t>(kernel.correction->evaluate(args));
+    }
+  }
+  return out;
+}
+
+bool isFloatVectorType(const std::string &type) {
+  return type == "ROOT::VecOps::RVec<float>" ||
+         type == "ROOT::VecOps::RVec<Float_t>" || type == "ROOT::RVec<float>" ||
+         type == "ROOT::RVecF";
+}
+
+/**
+ * @brief Argument lists of the Run 3 scale/resolution payload.
+ *
+ * The string arguments are fixed per list, so a thread-local instance is
+ * reused and only its numeric slots are written per muon.
+ */
+struct ScaleResolutionArgs {
+  CorrectionArgs etaPhiNom{0.0, 0.0, std::string("nom")};
+  CorrectionArgs etaPhiStat{0.0, 0.0, std::string("stat")};
+  CorrectionArgs etaPhiRhoStat{0.0, 0.0, std::string("rho_stat")};
+  CorrectionArgs absEtaNom{0.0, std::string("nom")};
+  CorrectionArgs absEtaStat{0.0, std::string("stat")};
+  CorrectionArgs params{0.0, 0.0, 0};
+
+  void setEtaPhi(double eta, double phi) {
+    etaPhiNom[0] = eta;
+    etaPhiNom[1] = phi;
+    etaPhiStat[0] = eta;
+    etaPhiStat[1] = phi;
+    etaPhiRhoStat[0] = eta;
+    etaPhiRhoStat[1] = phi;
+  }
+
+  void setAbsEta(double absEta, double layers) {
+    absEtaNom[0] = absEta;
+    absEtaStat[0] = absEta;
+    params[0] = absEta;
+    params[1] = layers;
+  }
+
+  double parameter(const correction::Correction::Ref &corr, int index) {
+    params[2] = index;
+    return corr->evaluate(params);
+  }
+};
+
 uint64_t splitmix64(uint64_t value) {
   value += 0x9e3779b97f4a7c15ULL;
   value = (value ^ (value >> 30U)) * 0xbf58476d1ce4e5b9ULL;
@@ -175,6 +322,44 @@ void MuonRochesterManager::applyRochesterSystematicSet(
                      buildRochesterInputColumns(inputPtColumn));
 }
 
+void MuonRochesterManager::defineCorrectionColumn(
+    CorrectionManager &cm, const std::string &correctionName,
+    const std::vector<std::vector<std::string>> &argumentSets,
+    const std::vector<std::string> &inputColumns,
+    const std::string &outputColumn) {
+  // The typed kernel reads the Rochester columns directly; any other layout
+  // (or non-float inputs, or a compound correction) goes through the
+  // flattened CorrectionManager path.
+  IDataFrameProvider *dm = getDataFrameProvider();
+  ISystematicManager *sm = getSystematicManager();
+  const bool rochesterLayout =
+      dm && sm && !chargeColumn_m.empty() &&
+      inputColumns.size() == kRochesterInputs &&
+      inputColumns == buildRochesterInputColumns(inputColumns[3]) &&
+      !cm.isCompoundCorrection(correctionName) &&
+      std::all_of(inputColumns.begin(), inputColumns.end(),
+                  [dm](const std::string &col) {
+                    return isFloatVectorType(dm->columnType(col));
+                  });
+  if (!rochesterLayout) {
+    ObjectEnergyManagerBase::defineCorrectionColumn(
+        cm, correctionName, argumentSets, inputColumns, outputColumn);
+    return;
+  }
+
+  auto kernel = makeRochesterKernel(cm.getCorrection(correctionName),
+                                    argumentSets, correctionName);
+  using V = ROOT::VecOps::RVec<Float_t>;
+  dm->Define(
+      outputColumn,
+      [kernel](const V &charge, const V &eta, const V &phi, const V &pt,
+               const V &genPt, const V &nLayers, const V &u1, const V &u2) {
+        return evaluateRochesterKernel(
+            *kernel, {&charge, &eta, &phi, &pt, &genPt, &nLayers, &u1, &u2});
+      },
+      inputColumns, *sm);
+}
+
 void MuonRochesterManager::applyScaleAndResolution(
     const std::string &jsonFile, bool isData, const std::string &inputPtColumn,
     const std::string &outputPtColumn, const std::string &scaleVariation,
@@ -195,8 +380,8 @@ void MuonRochesterManager::applyScaleAndResolution(
   }
 
   ScaleResolutionStep step;
-  step.correctionSet = std::shared_ptr<correction::CorrectionSet>(
-      correction::CorrectionSet::from_file(jsonFile).release());
+  step.correctionSet = models().get<correction::CorrectionSet>(
+      jsonFile, "", [&jsonFile] { return correction::CorrectionSet::from_file(jsonFile); });
   step.isData = isData;
   step.inputPtColumn = inputPtColumn;
   step.outputPtColumn = outputPtColumn;
@@ -250,6 +435,7 @@ void MuonRochesterManager::execute() {
             UInt_t lumi,
             ULong64_t event)
             -> ROOT::VecOps::RVec<Float_t> {
+          thread_local ScaleResolutionArgs args;
           ROOT::VecOps::RVec<Float_t> output(pt.size(), 0.0f);
           for (std::size_t i = 0; i < pt.size(); ++i) {
             const double ptIn = pt[i];
@@ -258,25 +444,28 @@ void MuonRochesterManager::execute() {
             const double chargeIn = charge[i];
             const double layers = nLayers[i];
 
+            args.setEtaPhi(etaIn, phiIn);
+            args.setAbsEta(std::abs(etaIn), layers);
+
             const auto &aCorr = isData ? aData : aMc;
             const auto &mCorr = isData ? mData : mMc;
-            const double aNom = aCorr->evaluate({etaIn, phiIn, std::string("nom")});
-            const double mNom = mCorr->evaluate({etaIn, phiIn, std::string("nom")});
+            const double aNom = aCorr->evaluate(args.etaPhiNom);
+            const double mNom = mCorr->evaluate(args.etaPhiNom);
             double ptScaled = 1.0 / (mNom / ptIn + chargeIn * aNom);
             ptScaled = applyMuonPtBoundaryFilter(ptScaled, ptIn);
 
             double ptCorrected = ptScaled;
             if (!isData) {
-              const double mean = cbParams->evaluate({std::abs(etaIn), layers, 0});
-              const double sigma = cbParams->evaluate({std::abs(etaIn), layers, 1});
-              const double n = cbParams->evaluate({std::abs(etaIn), layers, 2});
-              const double alpha = cbParams->evaluate({std::abs(etaIn), layers, 3});
-              const double poly0 = polyParams->evaluate({std::abs(etaIn), layers, 0});
-              const double poly1 = polyParams->evaluate({std::abs(etaIn), layers, 1});
-              const double poly2 = polyParams->evaluate({std::abs(etaIn), layers, 2});
+              const double mean = args.parameter(cbParams, 0);
+              const double sigma = args.parameter(cbParams, 1);
+              const double n = args.parameter(cbParams, 2);
+              const double alpha = args.parameter(cbParams, 3);
+              const double poly0 = args.parameter(polyParams, 0);
+              const double poly1 = args.parameter(polyParams, 1);
+              const double poly2 = args.parameter(polyParams, 2);
               const double stddev = std::max(poly0 + poly1 * ptScaled + poly2 * ptScaled * ptScaled, 0.0);
-              const double kDataNom = kData->evaluate({std::abs(etaIn), std::string("nom")});
-              const double kMcNom = kMc->evaluate({std::abs(etaIn), std::string("nom")});
+              const double kDataNom = kData->evaluate(args.absEtaNom);
+              const double kMcNom = kMc->evaluate(args.absEtaNom);
               const double kNom = kMcNom < kDataNom
                                       ? std::sqrt(kDataNom * kDataNom - kMcNom * kMcNom)
                                       : 0.0;
@@ -292,7 +481,7 @@ void MuonRochesterManager::execute() {
                 ptCorrected = ptScaled;
 
               if (resolutionVariation == "up" || resolutionVariation == "down") {
-                const double kUnc = kMc->evaluate({std::abs(etaIn), std::string("stat")});
+                const double kUnc = kMc->evaluate(args.absEtaStat);
                 if (kNom > 0.0 && ptScaled > 0.0) {
                   const double stdTimesCb = (ptCorrected / ptScaled - 1.0) / kNom;
                   const double shiftedK =
@@ -306,9 +495,9 @@ void MuonRochesterManager::execute() {
               }
 
               if (scaleVariation == "up" || scaleVariation == "down") {
-                const double statA = aMc->evaluate({etaIn, phiIn, std::string("stat")});
-                const double statM = mMc->evaluate({etaIn, phiIn, std::string("stat")});
-                const double rhoStat = mMc->evaluate({etaIn, phiIn, std::string("rho_stat")});
+                const double statA = aMc->evaluate(args.etaPhiStat);
+                const double statM = mMc->evaluate(args.etaPhiStat);
+                const double rhoStat = mMc->evaluate(args.etaPhiRhoStat);
                 const double unc = ptCorrected * ptCorrected * std::sqrt(
                     statM * statM / (ptCorrected * ptCorrected) +
                     statA * statA +
@@ -221,6 +221,23 @@ public:
 protected:
   std::string objectName() const override { return "Muon"; }
 
+  /**
+   * @brief Evaluate Rochester corrections with a typed per-event kernel.
+   *
+   * When @p inputColumns is the Rochester layout of
+   * buildRochesterInputColumns() and all eight columns are RVec<Float_t>, the
+   * scale factors of every argument set are computed for the whole muon
+   * collection in one pass: the correction and its argument layout are
+   * resolved once, and each thread reuses its own argument buffers, so the
+   * muon loop does not allocate.  Any other layout falls back to the base
+   * implementation.
+   */
+  void defineCorrectionColumn(CorrectionManager &cm,
+                              const std::string &correctionName,
+                              const std::vector<std::vector<std::string>> &argumentSets,
+                              const std::vector<std::string> &inputColumns,
+                              const std::string &outputColumn) override;
+
   /// Append Rochester-specific column names to the metadata log.
   void appendObjectMetadata(std::ostringstream &ss) const override;
 
@@ -0,0 +1,154 @@
+/**
+ * @file HistogramGPU.cu
+ * @brief CUDA implementation of the GPU histogram storage.
+ *
+ * Each CUDA thread adds one (bin index, weight) fill of a batch to the
+ * device-resident bins with atomic adds, so fills of all slots land in a
+ * single copy of the histogram.
+ *
+ * Compile with:
+ *   nvcc -arch=sm_60 -DUSE_CUDA -c HistogramGPU.cu
+ * or let CMake handle it via the USE_CUDA build option.
+ */
+
+#include "HistogramGPU.h"
+
+#include <cuda_runtime.h>
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+constexpr int kBlockSize = 256;
+/// Upper bound on the blocks of one launch; larger batches use a grid-stride loop.
+constexpr int kMaxGridSize = 4096;
+
+// ── CUDA error-checking helper ──────────────────────────────────────────────
+
+void checkCuda(cudaError_t err, const char *location) {
+  if (err != cudaSuccess) {
+    throw std::runtime_error(std::string("CUDA error at ") + location + ": " +
+                             cudaGetErrorString(err));
+  }
+}
+
+// ── Thread-local per-slot staging buffers ───────────────────────────────────
+//
+// Each RDataFrame slot runs on its own OS thread.  The first batch from a
+// slot creates its stream and allocates pinned host and device buffers;
+// later batches reuse them.  A batch is copied into the pinned buffers so the
+// caller can refill its stage while the copy and kernel run; the next batch
+// of the thread waits for the previous one before overwriting the buffers.
+struct GpuStagingSlot {
+  cudaStream_t stream = nullptr;
+  unsigned long long *h_cells = nullptr;
+  float *h_weights = nullptr;
+  unsigned long long *d_cells = nullptr;
+  float *d_weights = nullptr;
+  size_t capacity = 0; // fills the buffers hold
+
+  /// Wait for the batch in flight, then ensure room for @p n fills.
+  void prepare(size_t n) {
+    if (!stream) {
+      checkCuda(cudaStreamCreateWithFlags(&stream, cudaStreamNonBlocking),
+                "CudaHistogramBuffer: create stream");
+    }
+    checkCuda(cudaStreamSynchronize(stream), "CudaHistogramBuffer: synchronize batch");
+    if (n > capacity) {
+      release();
+      checkCuda(cudaMallocHost(&h_cells, n * sizeof(unsigned long long)),
+                "CudaHistogramBuffer: pinned cells");
+      checkCuda(cudaMallocHost(&h_weights, n * sizeof(float)),
+                "CudaHistogramBuffer: pinned weights");
+      checkCuda(cudaMalloc(&d_cells, n * sizeof(unsigned long long)),
+                "CudaHistogramBuffer: malloc cells");
+      checkCuda(cudaMalloc(&d_weights, n * sizeof(float)),
+                "CudaHistogramBuffer: malloc weights");
+      capacity = n;
+    }
+  }
+
+  void release() {
+    cudaFreeHost(h_cells);
+    cudaFreeHost(h_weights);
+    cudaFree(d_cells);
+    cudaFree(d_weights);
+    h_cells = nullptr;
+    h_weights = nullptr;
+    d_cells = nullptr;
+    d_weights = nullptr;
+    capacity = 0;
+  }
+
+  ~GpuStagingSlot() {
+    // These calls are no-ops when the CUDA driver has already been unloaded.
+    if (stream) cudaStreamSynchronize(stream);
+    release();
+    if (stream) cudaStreamDestroy(stream);
+  }
+};
+
+thread_local GpuStagingSlot gpuStagingSlot;
+
+} // anonymous namespace
+
+// ── CUDA kernel: one thread per fill ─────────────────────────────────────────
+
+__global__ static void histogramFillKernel(double *__restrict__ bins,
+                                           const unsigned long long *__restrict__ cells,
+                                           const float *__restrict__ weights, size_t n) {
+  const size_t step = static_cast<size_t>(blockDim.x) * gridDim.x;
+  for (size_t i = static_cast<size_t>(blockIdx.x) * blockDim.x + threadIdx.x; i < n;
+       i += step) {
+    const double w = weights[i];
+    double *bin = bins + 2 * cells[i];
+    atomicAdd(bin, w);
+    atomicAdd(bin + 1, w * w);
+  }
+}
+
+// ── CudaHistogramBuffer ──────────────────────────────────────────────────────
+
+CudaHistogramBuffer::CudaHistogramBuffer(std::size_t cells) : cells_m(cells) {
+  checkCuda(cudaMalloc(&d_bins_m, 2 * cells_m * sizeof(double)),
+            "CudaHistogramBuffer: malloc bins");
+  const cudaError_t err = cudaMemset(d_bins_m, 0, 2 * cells_m * sizeof(double));
+  if (err != cudaSuccess) {
+    cudaFree(d_bins_m);
+    checkCuda(err, "CudaHistogramBuffer: zero bins");
+  }
+}
+
+CudaHistogramBuffer::~CudaHistogramBuffer() { cudaFree(d_bins_m); }
+
+void CudaHistogramBuffer::add(const std::uint64_t *cells, const float *weights,
+                              std::size_t n) {
+  if (n == 0) {
+    return;
+  }
+  GpuStagingSlot &slot = gpuStagingSlot;
+  slot.prepare(n);
+  std::memcpy(slot.h_cells, cells, n * sizeof(unsigned long long));
+  std::memcpy(slot.h_weights, weights, n * sizeof(float));
+  checkCuda(cudaMemcpyAsync(slot.d_cells, slot.h_cells, n * sizeof(unsigned long long),
+                            cudaMemcpyHostToDevice, slot.stream),
+            "CudaHistogramBuffer: H2D cells");
+  checkCuda(cudaMemcpyAsync(slot.d_weights, slot.h_weights, n * sizeof(float),
+                            cudaMemcpyHostToDevice, slot.stream),
+            "CudaHistogramBuffer: H2D weights");
+  const int gridSize = static_cast<int>(
+      std::min<size_t>((n + kBlockSize - 1) / kBlockSize, kMaxGridSize));
+  histogramFillKernel<<<gridSize, kBlockSize, 0, slot.stream>>>(d_bins_m, slot.d_cells,
+                                                                 slot.d_weights, n);
+  checkCuda(cudaGetLastError(), "CudaHistogramBuffer: fill kernel launch");
+}
+
+void CudaHistogramBuffer::download(double *interleaved) {
+  // Batches run on the streams of the threads that added them.
+  checkCuda(cudaDeviceSynchronize(), "CudaHistogramBuffer: synchronize");
+  checkCuda(cudaMemcpy(interleaved, d_bins_m, 2 * cells_m * sizeof(double),
+                       cudaMemcpyDeviceToHost),
+            "CudaHistogramBuffer: D2H bins");
+}
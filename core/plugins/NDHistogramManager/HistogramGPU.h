@@ -0,0 +1,64 @@
+#ifndef HISTOGRAMGPU_H_INCLUDED
+#define HISTOGRAMGPU_H_INCLUDED
+
+/**
+ * @file HistogramGPU.h
+ * @brief GPU histogram storage for the gpu backend of NDHistogramManager.
+ *
+ * The implementation lives in HistogramGPU.cu and is only compiled when the
+ * project is built with @c -DUSE_CUDA=ON.
+ *
+ * **Filling model**
+ *
+ * THnMulti computes the linear bin index of every fill on the host and
+ * streams (bin index, weight) batches from its slots to a
+ * CudaHistogramBuffer.  Each batch is copied to the device on a stream of
+ * the calling thread and added by a kernel with one thread per fill, using
+ * atomic adds on the device-resident bins.  The copy and kernel of one batch
+ * overlap with the slot staging the next batch.  The bins are copied back
+ * once, when the histogram is finalized.
+ *
+ * The device holds one copy of all bins, under/overflow included: 16 bytes
+ * (double sum of weights and sum of squared weights) per bin.  Atomic adds
+ * on doubles need a device of compute capability 6.0 or newer.
+ */
+
+#ifdef USE_CUDA
+
+#include <HistDeviceSink.h>
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Device-resident histogram bins filled from host batches.
+ *
+ * Thread-safety: add() may be called concurrently from multiple CPU threads
+ * (RDataFrame slots).  Per-thread pinned staging buffers, device input
+ * buffers and streams are managed internally via thread-local storage and
+ * shared by all buffers used on that thread.
+ */
+class CudaHistogramBuffer : public HistDeviceSink {
+public:
+  /// Allocate @p cells zeroed bins on the current device.
+  explicit CudaHistogramBuffer(std::size_t cells);
+  ~CudaHistogramBuffer() override;
+
+  CudaHistogramBuffer(const CudaHistogramBuffer &) = delete;
+  CudaHistogramBuffer &operator=(const CudaHistogramBuffer &) = delete;
+
+  std::size_t cells() const override { return cells_m; }
+
+  void add(const std::uint64_t *cells, const float *weights, std::size_t n) override;
+
+  void download(double *interleaved) override;
+
+private:
+  /// Device: [2 * cells_m] interleaved sum of weights and sum of squares.
+  double *d_bins_m = nullptr;
+  std::size_t cells_m = 0;
+};
+
+#endif // USE_CUDA
+
+#endif // HISTOGRAMGPU_H_INCLUDED
@@ -1,4 +1,5 @@
 #include <api/IConfigurationProvider.h>
+#include <AsyncLogger.h>
 #include <analyzer.h>
 #include <api/IDataFrameProvider.h>
 #include <api/ISystematicManager.h>
@@ -6,11 +7,29 @@
 #include <DataManager.h>
 #include <NDHistogramManager.h>
 #include <RegionManager.h>
+#include <SampleSet.h>
+#include <SystematicBundle.h>
+#include <CheckpointService.h>
 #include <CounterService.h>
+#include <HistogramPack.h>
+#include <HistogramGPU.h>
+#include <ROOT/RDFHelpers.hxx>
+#include <ROOT/TSeq.hxx>
+#include <ROOT/TThreadExecutor.hxx>
+#include <TDirectory.h>
 #include <TFile.h>
 #include <TH1F.h>
 #include <THnSparse.h>
+#include <TKey.h>
+#include <TMemFile.h>
+#include <TROOT.h>
 #include <cmath>
+#include <cstdint>
+#include <iomanip>
+#include <map>
+#include <memory>
+#include <limits>
+#include <set>
 #include <unordered_map>
 #include <unordered_set>
 #include <algorithm>
@@ -20,6 +39,80 @@
 #include <vector>
 #include <sstream>
 
+namespace {
+
+/// A projected histogram and the output directory it is written to.
+struct HistogramWriteItem {
+  std::string directory;
+  const TH1F *hist;
+};
+
+TDirectory *outputDirectory(TDirectory &file, const std::string &name) {
+  if (name.empty()) {
+    return &file;
+  }
+  return file.mkdir(name.c_str(), "", true);
+}
+
+/**
+ * @brief Write @p items into @p saveFile in order.
+ *
+ * Streaming and compressing tens of thousands of histograms dominates the
+ * write.  In parallel mode each pool thread streams a contiguous block of the
+ * items into its own TMemFile, with the compression settings of @p saveFile.
+ * The compressed keys are then copied into @p saveFile without being
+ * unzipped, in item order, so the file does not depend on the thread count.
+ */
+void writeHistogramItems(TFile &saveFile, const std::vector<HistogramWriteItem> &items,
+                         bool parallel) {
+  const std::size_t nBlocks =
+      parallel ? std::min<std::size_t>(ROOT::GetThreadPoolSize(), items.size()) : 1;
+  if (nBlocks <= 1) {
+    for (const auto &item : items) {
+      outputDirectory(saveFile, item.directory)->WriteTObject(item.hist);
+    }
+    return;
+  }
+
+  using CycleKey = std::pair<std::string, std::string>;
+  const std::size_t blockSize = (items.size() + nBlocks - 1) / nBlocks;
+  std::vector<std::unique_ptr<TMemFile>> blocks(nBlocks);
+  // Cycle of every item in its block's memory file: a name written twice
+  // into one directory gets a new cycle.
+  std::vector<Short_t> blockCycles(items.size());
+  const auto streamBlock = [&](unsigned int block) {
+    TDirectory::TContext context(nullptr);
+    blocks[block] = std::make_unique<TMemFile>(
+        ("ndhist_block_" + std::to_string(block) + ".root").c_str(), "RECREATE", "",
+        saveFile.GetCompressionSettings());
+    std::map<CycleKey, Short_t> cycles;
+    const std::size_t end = std::min(items.size(), (block + 1) * blockSize);
+    for (std::size_t i = block * blockSize; i < end; ++i) {
+      outputDirectory(*blocks[block], items[i].directory)->WriteTObject(items[i].hist);
+      blockCycles[i] = ++cycles[{items[i].directory, items[i].hist->GetName()}];
+    }
+  };
+  ROOT::TThreadExecutor pool;
+  pool.Foreach(streamBlock, ROOT::TSeqU(nBlocks));
+
+  for (std::size_t i = 0; i < items.size(); ++i) {
+    const auto &item = items[i];
+    const TKey *source = outputDirectory(*blocks[i / blockSize], item.directory)
+                             ->GetKey(item.hist->GetName(), blockCycles[i]);
+    if (!source) {
+      throw std::runtime_error("NDHistogramManager: histogram '" +
+                               std::string(item.hist->GetName()) +
+                               "' is missing from its serialized block");
+    }
+    TDirectory *target = outputDirectory(saveFile, item.directory);
+    // Copies the compressed record; the key appends itself to the target.
+    auto *key = new TKey(target, *source, 0);
+    key->WriteFile(0);
+  }
+}
+
+} // namespace
+
 /**
  * @brief Construct a new NDHistogramManager object
  */
@@ -29,6 +122,17 @@ void NDHistogramManager::bindToRegionManager(RegionManager *rm) {
   regionManager_m = rm;
 }
 
+void NDHistogramManager::registerWeightVector(const std::string &column,
+                                              const std::vector<std::string> &labels) {
+  if (column.empty()) {
+    throw std::invalid_argument("NDHistogramManager::registerWeightVector: column must not be empty");
+  }
+  if (labels.empty()) {
+    throw std::invalid_argument("NDHistogramManager::registerWeightVector: labels must not be empty");
+  }
+  weightVectors_m[column] = labels;
+}
+
 struct ColumnCache {
   ROOT::RDF::RNode& df;
   std::vector<std::string> names;
@@ -57,6 +161,165 @@ struct ColumnCache {
   }
 };
 
+// Fuse the channel value of an event with its regions: every region ID r + 1
+// in @p membership becomes r * nChannels + c, with c the 1-indexed channel bin
+// (same uniform binning as THnMulti).  Events outside the channel range fill
+// nothing, as under- and overflow are not persisted.
+template <typename T>
+static ROOT::RDF::RNode defineFusedRegionAxis(ROOT::RDF::RNode df, const std::string &name,
+                                              const std::string &membership,
+                                              const std::string &channel, int nChannels,
+                                              double lowerBound, double upperBound) {
+  const double width = upperBound - lowerBound;
+  auto fuse = [nChannels, lowerBound, upperBound, width](
+                  const ROOT::VecOps::RVec<Float_t> &regions, T value) {
+    ROOT::VecOps::RVec<Float_t> fused;
+    const double x = static_cast<double>(value);
+    if (!(x >= lowerBound) || !(x < upperBound)) {
+      return fused;
+    }
+    const int bin = std::min(static_cast<int>(nChannels * (x - lowerBound) / width),
+                             nChannels - 1);
+    fused.reserve(regions.size());
+    for (const Float_t id : regions) {
+      if (id > 0.5f) {
+        fused.push_back(static_cast<Float_t>((static_cast<int>(id) - 1) * nChannels + bin + 1));
+      }
+    }
+    return fused;
+  };
+  return df.Define(name, fuse, {membership, channel});
+}
+
+using FusedRegionAxisDefiner = ROOT::RDF::RNode (*)(ROOT::RDF::RNode, const std::string &,
+                                                    const std::string &, const std::string &,
+                                                    int, double, double);
+
+static FusedRegionAxisDefiner fusedRegionAxisDefiner(const std::string &type) {
+  if (type == "float" || type == "Float_t") return &defineFusedRegionAxis<Float_t>;
+  if (type == "double" || type == "Double_t") return &defineFusedRegionAxis<Double_t>;
+  if (type == "int" || type == "Int_t") return &defineFusedRegionAxis<Int_t>;
+  if (type == "unsigned int" || type == "UInt_t") return &defineFusedRegionAxis<UInt_t>;
+  if (type == "long" || type == "Long_t") return &defineFusedRegionAxis<Long_t>;
+  if (type == "long long" || type == "Long64_t") return &defineFusedRegionAxis<Long64_t>;
+  if (type == "unsigned long" || type == "ULong_t") return &defineFusedRegionAxis<ULong_t>;
+  if (type == "unsigned long long" || type == "ULong64_t") return &defineFusedRegionAxis<ULong64_t>;
+  if (type == "short" || type == "Short_t") return &defineFusedRegionAxis<Short_t>;
+  if (type == "unsigned short" || type == "UShort_t") return &defineFusedRegionAxis<UShort_t>;
+  if (type == "bool" || type == "Bool_t") return &defineFusedRegionAxis<Bool_t>;
+  return nullptr;
+}
+
+// Define @p name as the value-axis bin index of @p variable (uniformAxisBin(),
+// as a Float_t like every THnMulti input).  The value is rounded to Float_t
+// first, exactly as the unbinned fill path converts it.  DataManager::Define
+// also declares the Up/Down variants, so varied values are binned alike.
+template <typename T, bool Vector>
+static void defineValueBins(IDataFrameProvider &dataManager,
+                            ISystematicManager &systematicManager, const std::string &name,
+                            const std::string &variable, int nbins, double lowerBound,
+                            double upperBound) {
+  const double width = upperBound - lowerBound;
+  auto toBin = [nbins, lowerBound, upperBound, width](T value) -> Float_t {
+    return static_cast<Float_t>(uniformAxisBin(static_cast<Float_t>(value), nbins,
+                                               lowerBound, upperBound, width));
+  };
+  if constexpr (Vector) {
+    dataManager.Define(
+        name,
+        [toBin](const ROOT::VecOps::RVec<T> &values) {
+          ROOT::VecOps::RVec<Float_t> bins(values.size());
+          for (std::size_t i = 0; i < values.size(); ++i) {
+            bins[i] = toBin(values[i]);
+          }
+          return bins;
+        },
+        {variable}, systematicManager);
+  } else {
+    dataManager.Define(name, toBin, {variable}, systematicManager);
+  }
+}
+
+using ValueBinsDefiner = void (*)(IDataFrameProvider &, ISystematicManager &,
+                                  const std::string &, const std::string &, int, double,
+                                  double);
+
+template <bool Vector>
+static ValueBinsDefiner valueBinsDefinerFor(const std::string &type) {
+  if (type == "float" || type == "Float_t") return &defineValueBins<Float_t, Vector>;
+  if (type == "double" || type == "Double_t") return &defineValueBins<Double_t, Vector>;
+  if (type == "int" || type == "Int_t") return &defineValueBins<Int_t, Vector>;
+  if (type == "unsigned int" || type == "UInt_t") return &defineValueBins<UInt_t, Vector>;
+  if (type == "long" || type == "Long_t") return &defineValueBins<Long_t, Vector>;
+  if (type == "long long" || type == "Long64_t") return &defineValueBins<Long64_t, Vector>;
+  if (type == "unsigned long" || type == "ULong_t") return &defineValueBins<ULong_t, Vector>;
+  if (type == "unsigned long long" || type == "ULong64_t") return &defineValueBins<ULong64_t, Vector>;
+  if (type == "short" || type == "Short_t") return &defineValueBins<Short_t, Vector>;
+  if (type == "unsigned short" || type == "UShort_t") return &defineValueBins<UShort_t, Vector>;
+  if (type == "bool" || type == "Bool_t") return &defineValueBins<Bool_t, Vector>;
+  return nullptr;
+}
+
+static ValueBinsDefiner valueBinsDefiner(const std::string &type) {
+  static const std::string rvecPrefix = "ROOT::VecOps::RVec<";
+  if (type.compare(0, rvecPrefix.size(), rvecPrefix) == 0 && type.back() == '>') {
+    return valueBinsDefinerFor<true>(
+        type.substr(rvecPrefix.size(), type.size() - rvecPrefix.size() - 1));
+  }
+  return valueBinsDefinerFor<false>(type);
+}
+
+// Define @p name as the Float_t value of the scalar @p variable.
+template <typename T>
+static void defineScalarFloat(IDataFrameProvider &dataManager,
+                              ISystematicManager &systematicManager, const std::string &name,
+                              const std::string &variable) {
+  dataManager.Define(name, [](T value) -> Float_t { return static_cast<Float_t>(value); },
+                     {variable}, systematicManager);
+}
+
+using ScalarFloatDefiner = void (*)(IDataFrameProvider &, ISystematicManager &,
+                                    const std::string &, const std::string &);
+
+static ScalarFloatDefiner scalarFloatDefiner(const std::string &type) {
+  if (type == "double" || type == "Double_t") return &defineScalarFloat<Double_t>;
+  if (type == "int" || type == "Int_t") return &defineScalarFloat<Int_t>;
+  if (type == "unsigned int" || type == "UInt_t") return &defineScalarFloat<UInt_t>;
+  if (type == "long" || type == "Long_t") return &defineScalarFloat<Long_t>;
+  if (type == "long long" || type == "Long64_t") return &defineScalarFloat<Long64_t>;
+  if (type == "unsigned long" || type == "ULong_t") return &defineScalarFloat<ULong_t>;
+  if (type == "unsigned long long" || type == "ULong64_t") return &defineScalarFloat<ULong64_t>;
+  if (type == "short" || type == "Short_t") return &defineScalarFloat<Short_t>;
+  if (type == "unsigned short" || type == "UShort_t") return &defineScalarFloat<UShort_t>;
+  if (type == "unsigned char" || type == "UChar_t") return &defineScalarFloat<UChar_t>;
+  if (type == "bool" || type == "Bool_t") return &defineScalarFloat<Bool_t>;
+  return nullptr;
+}
+
+// Column holding @p variable as a Float_t scalar, for the scalar fill path:
+// the variable itself when it already is one, otherwise a cast shared by
+// every histogram that reads it.
+static std::string scalarFillColumn(ROOT::RDF::RNode &df, IDataFrameProvider *dataManager_m,
+                                    ISystematicManager *systematicManager_m,
+                                    ColumnCache &cache, const std::string &variable) {
+  const std::string type = cache.GetType(variable);
+  if (type == "float" || type == "Float_t") {
+    return variable;
+  }
+  const std::string name = variable + "_FillFloat";
+  if (!cache.Has(name)) {
+    if (const auto define = scalarFloatDefiner(type)) {
+      define(*dataManager_m, *systematicManager_m, name, variable);
+      df = dataManager_m->getDataFrame();
+    } else {
+      df = dataManager_m->defineExpression(df, name, "static_cast<Float_t>(" + variable + ")");
+      dataManager_m->setDataFrame(df);
+    }
+    cache.Refresh();
+  }
+  return name;
+}
+
 // Helper function to handle per-axis logic for varVector and DefineVector
 static void HandleAxisVarVector(
     ROOT::RDF::RNode& df,
@@ -85,7 +348,7 @@ static void HandleAxisVarVector(
       const std::string expandedName = column + "_FillRVec_" + refVector + tagSuffix;
       if (!cache.Has(expandedName)) {
         const std::string expr = "ROOT::VecOps::RVec<Float_t>(" + refVector + ".size(), static_cast<Float_t>(" + column + "))";
-        df = df.Define(expandedName, expr);
+        df = dataManager_m->defineExpression(df, expandedName, expr);
         dataManager_m->setDataFrame(df);
         cache.Refresh();
       }
@@ -93,6 +356,19 @@ static void HandleAxisVarVector(
     };
 
     if (hasSystematic) {
+        // A registered variation bundle already holds every variation in the
+        // same variation-major layout as the systVector built below.
+        if (refVector.empty() || cache.GetType(variable).find("RVec") != std::string::npos) {
+          const std::string bundleView = defineVariationBundleView(
+              *dataManager_m, *systematicManager_m, variable, allSystematics,
+              variable + "_systBundle" + tagSuffix);
+          if (!bundleView.empty()) {
+            df = dataManager_m->getDataFrame();
+            cache.Refresh();
+            varVector.push_back(bundleView);
+            return;
+          }
+        }
         std::vector<std::string> systematicVariations;
         for (const auto& syst : allSystematics) {
         std::string columnName = systematicManager_m->getVariationColumnName(variable, syst);
@@ -185,6 +461,18 @@ static bool HasSystematicColumns(
     ISystematicManager* systematicManager_m,
     const std::string& variable,
     const std::vector<std::string>& systList) {
+  if (const auto* bundle = systematicManager_m->getVariationBundle(variable);
+      bundle && cache.Has(bundle->column)) {
+    for (const auto& label : bundle->variationLabels) {
+      if (label != "Nominal" &&
+          std::find(systList.begin(), systList.end(), label) != systList.end()) {
+        return true;
+      }
+    }
+  }
+  if (systematicManager_m->getSystematicsForVariable(variable).empty()) {
+    return false;
+  }
   for (const auto& syst : systList) {
     if (syst == "Nominal") {
       continue;
@@ -200,6 +488,25 @@ static bool HasSystematicColumns(
   return false;
 }
 
+/**
+ * @brief Device storage for a histogram of the gpu backend.
+ *
+ * One bin per FlatHistAccumulator bin of the axes of @p fillInfo,
+ * under/overflow included.
+ */
+static std::shared_ptr<HistDeviceSink> makeDeviceSink(const histFillInfo &fillInfo) {
+#ifdef USE_CUDA
+  std::size_t cells = 1;
+  for (const Int_t n : fillInfo.nbins) {
+    cells *= static_cast<std::size_t>(n) + 2;
+  }
+  return std::make_shared<CudaHistogramBuffer>(cells);
+#else
+  throw std::runtime_error("NDHistogramManager: histogram '" + fillInfo.name +
+                           "' uses the gpu backend, which needs a build with -DUSE_CUDA=ON.");
+#endif
+}
+
 /**
  * @brief Automatically detect and register systematic variations from the
  *        current dataframe columns before the first histogram booking.
@@ -269,6 +576,19 @@ void NDHistogramManager::BookSingleHistogram(
   ensureSystematicsAutoRegistered();
   const std::vector<std::string> systList =
       systematicManager_m->makeSystList("SystematicCounter", *dataManager_m);
+  countValueAxis(info);
+  if (useRegionAxis({info.variable()}, "BookSingleHistogram")) {
+    selectionInfo regionInfo = makeRegionAxis(channelInfo);
+    const std::string regionColumn = regionInfo.variable();
+    BookSingleHistogramWithSystList(info,
+                                    std::move(sampleCategoryInfo),
+                                    std::move(controlRegionInfo),
+                                    std::move(regionInfo),
+                                    std::move(suffix),
+                                    systList,
+                                    regionColumn);
+    return;
+  }
   BookSingleHistogramWithSystList(info,
                                   std::move(sampleCategoryInfo),
                                   std::move(controlRegionInfo),
@@ -291,6 +611,21 @@ void NDHistogramManager::BookSingleHistogramWithSystList(
     throw std::runtime_error("NDHistogramManager::BookSingleHistogram: DataManager not set");
   }
 
+  // Histograms sharing their value axis fill precomputed bin indices.
+  const std::string binnedValue = valueBinColumn(info);
+  const std::string &valueColumn = binnedValue.empty() ? info.variable() : binnedValue;
+
+  // Resolve the variation columns this histogram reads before the column
+  // cache is built, so deferred variations are defined first.
+  for (const auto& variable : {valueColumn, info.weight(), channelInfo.variable(),
+                               controlRegionInfo.variable(), sampleCategoryInfo.variable()}) {
+    for (const auto& syst : systList) {
+      if (syst != "Nominal") {
+        systematicManager_m->getVariationColumnName(variable, syst);
+      }
+    }
+  }
+
   ROOT::RDF::RNode df = dataManager_m->getDataFrame();
   ColumnCache cache(df);
 
@@ -300,6 +635,8 @@ void NDHistogramManager::BookSingleHistogramWithSystList(
   fillInfo.name = info.name() + "_" + suffix;
   fillInfo.title = info.name() + " " + suffix;
   fillInfo.nSlots = df.GetNSlots();
+  fillInfo.value_isBinIndex = !binnedValue.empty();
+  fillInfo.valueEdges.assign(info.binEdges().begin(), info.binEdges().end());
   // Systematic axis will be inserted between sampleCategory and the histogram variable.
   fillInfo.nbins = {channelInfo.bins(), controlRegionInfo.bins(), sampleCategoryInfo.bins(), 1, info.bins()};
   fillInfo.xmin = {channelInfo.lowerBound(), controlRegionInfo.lowerBound(), sampleCategoryInfo.lowerBound(), 0.0, info.lowerBound()};
@@ -340,36 +677,148 @@ void NDHistogramManager::BookSingleHistogramWithSystList(
   }
 
   // determine if the variables have systematic variations
-  if(systematicManager_m->getSystematicsForVariable(channelInfo.variable()).size() > 0 &&
-     HasSystematicColumns(cache, systematicManager_m, channelInfo.variable(), systList)) {
+  if(HasSystematicColumns(cache, systematicManager_m, channelInfo.variable(), systList)) {
     fillInfo.channel_hasSystematic = true;
     fillInfo.hasSystematic = true;
   }
 
-  if(systematicManager_m->getSystematicsForVariable(controlRegionInfo.variable()).size() > 0 &&
-     HasSystematicColumns(cache, systematicManager_m, controlRegionInfo.variable(), systList)) {
+  if(HasSystematicColumns(cache, systematicManager_m, controlRegionInfo.variable(), systList)) {
     fillInfo.controlRegion_hasSystematic = true;
     fillInfo.hasSystematic = true;
   }
 
-  if(systematicManager_m->getSystematicsForVariable(sampleCategoryInfo.variable()).size() > 0 &&
-     HasSystematicColumns(cache, systematicManager_m, sampleCategoryInfo.variable(), systList)) {
+  if(HasSystematicColumns(cache, systematicManager_m, sampleCategoryInfo.variable(), systList)) {
     fillInfo.sampleCategory_hasSystematic = true;
     fillInfo.hasSystematic = true;
   }
 
-  if(systematicManager_m->getSystematicsForVariable(info.weight()).size() > 0 &&
-     HasSystematicColumns(cache, systematicManager_m, info.weight(), systList)) {
+  if(HasSystematicColumns(cache, systematicManager_m, info.weight(), systList)) {
     fillInfo.weight_hasSystematic = true;
     fillInfo.hasSystematic = true;
   }
 
+  // A variation bundle registered for the histogram variable supplies every
+  // variation in one column.
+  if(systematicManager_m->getVariationBundle(valueColumn) != nullptr &&
+     HasSystematicColumns(cache, systematicManager_m, valueColumn, systList)) {
+    fillInfo.hasSystematic = true;
+  }
+
   // For now, we don't support multi-fill for systematic variations
   fillInfo.systematic_hasMultiFill = false;
   
   fillInfo.nbins[3] = static_cast<Int_t>(systList.size());
   fillInfo.xmax[3] = static_cast<Double_t>(systList.size());
 
+  const std::string &backend =
+      info.backend().empty() ? histogramBackend_m : info.backend();
+  if (backend == "boost" && !fillInfo.valueEdges.empty()) {
+    throw std::runtime_error("NDHistogramManager::BookSingleHistogram(): histogram '" +
+                             info.name() + "' has variable-width bins, which need "
+                             "the root backend.");
+  }
+
+  // A weight vector fills all of its entries, one per systematic bin, from
+  // one set of scalar axis values.
+  if (const auto wv = weightVectors_m.find(info.weight()); wv != weightVectors_m.end()) {
+    const std::string weightType = cache.GetType(info.weight());
+    if (weightType != "ROOT::VecOps::RVec<Float_t>" && weightType != "ROOT::VecOps::RVec<float>") {
+      throw std::runtime_error("NDHistogramManager::BookSingleHistogram(): weight vector '" +
+                               info.weight() + "' of histogram '" + info.name() +
+                               "' is a " + weightType + ", not an RVec<Float_t>.");
+    }
+    if (fillInfo.channel_hasMultiFill || fillInfo.controlRegion_hasMultiFill ||
+        fillInfo.sampleCategory_hasMultiFill || fillInfo.channel_hasSystematic ||
+        fillInfo.controlRegion_hasSystematic || fillInfo.sampleCategory_hasSystematic ||
+        !baseRefVector.empty() || cache.GetType(valueColumn).find("RVec") != std::string::npos) {
+      throw std::runtime_error("NDHistogramManager::BookSingleHistogram(): histogram '" +
+                               info.name() + "' is weighted by the weight vector '" +
+                               info.weight() + "' and needs scalar axes without "
+                               "systematics.");
+    }
+    const std::vector<std::string> &labels = wv->second;
+    fillInfo.weightVector = true;
+    fillInfo.nbins[3] = static_cast<Int_t>(labels.size());
+    fillInfo.xmax[3] = static_cast<Double_t>(labels.size());
+    const std::vector<std::string> columns = {
+        scalarFillColumn(df, dataManager_m, systematicManager_m, cache, valueColumn),
+        info.weight(),
+        scalarFillColumn(df, dataManager_m, systematicManager_m, cache,
+                         sampleCategoryInfo.variable()),
+        scalarFillColumn(df, dataManager_m, systematicManager_m, cache,
+                         controlRegionInfo.variable()),
+        scalarFillColumn(df, dataManager_m, systematicManager_m, cache, channelInfo.variable())};
+    df = dataManager_m->getDataFrame();
+    dataManager_m->recordColumnsRead(columns);
+    histSystLabels_m[histos_m.size()] = labels;
+    recordBookingCost(fillInfo, backend);
+    if (backend == "boost") {
+      BHnMulti tempModel(fillInfo);
+      histos_m.push_back(
+          df.Book<Float_t, ROOT::VecOps::RVec<Float_t>, Float_t, Float_t, Float_t>(
+              std::move(tempModel), columns));
+    } else {
+      fillInfo.memoryCeilingBytes = memoryCeilingBytes_m;
+      fillInfo.densePromotionFraction = densePromotion_m;
+      fillInfo.spillDirectory = spillDirectory_m;
+      fillInfo.memoryReport = std::make_shared<HistMemoryReport>();
+      memoryReports_m.push_back(fillInfo.memoryReport);
+      if (backend == "gpu") {
+        fillInfo.deviceSink = makeDeviceSink(fillInfo);
+      }
+      THnMulti tempModel(fillInfo);
+      histos_m.push_back(
+          df.Book<Float_t, ROOT::VecOps::RVec<Float_t>, Float_t, Float_t, Float_t>(
+              std::move(tempModel), columns));
+    }
+    histNodes_m.push_back(df);
+    return;
+  }
+
+  // One nominal fill per event: book the scalar columns directly instead of
+  // wrapping each of them in a one-element RVec per event.
+  if (!fillInfo.hasSystematic && !fillInfo.hasMultiFill && baseRefVector.empty() &&
+      cache.GetType(valueColumn).find("RVec") == std::string::npos) {
+    const std::vector<std::string> scalarColumns = {
+        scalarFillColumn(df, dataManager_m, systematicManager_m, cache, valueColumn),
+        scalarFillColumn(df, dataManager_m, systematicManager_m, cache, info.weight()),
+        scalarFillColumn(df, dataManager_m, systematicManager_m, cache,
+                         sampleCategoryInfo.variable()),
+        scalarFillColumn(df, dataManager_m, systematicManager_m, cache,
+                         controlRegionInfo.variable()),
+        scalarFillColumn(df, dataManager_m, systematicManager_m, cache, channelInfo.variable())};
+    if (std::getenv("RDF_NDHIST_DEBUG") != nullptr) {
+      LogLine line(ILogger::Level::Info);
+      line << "[NDHistogramManager] Book " << fillInfo.name << " scalar columns: ";
+      for (const auto& name : scalarColumns) {
+        line << name << " ";
+      }
+    }
+    df = dataManager_m->getDataFrame();
+    dataManager_m->recordColumnsRead(scalarColumns);
+    nominalOnlyHists_m.insert(histos_m.size());
+    recordBookingCost(fillInfo, backend);
+    if (backend == "boost") {
+      BHnMulti tempModel(fillInfo);
+      histos_m.push_back(df.Book<Float_t, Float_t, Float_t, Float_t, Float_t>(
+          std::move(tempModel), scalarColumns));
+    } else {
+      fillInfo.memoryCeilingBytes = memoryCeilingBytes_m;
+      fillInfo.densePromotionFraction = densePromotion_m;
+      fillInfo.spillDirectory = spillDirectory_m;
+      fillInfo.memoryReport = std::make_shared<HistMemoryReport>();
+      memoryReports_m.push_back(fillInfo.memoryReport);
+      if (backend == "gpu") {
+        fillInfo.deviceSink = makeDeviceSink(fillInfo);
+      }
+      THnMulti tempModel(fillInfo);
+      histos_m.push_back(df.Book<Float_t, Float_t, Float_t, Float_t, Float_t>(
+          std::move(tempModel), scalarColumns));
+    }
+    histNodes_m.push_back(df);
+    return;
+  }
+
   std::vector<std::string> varVector;
   std::string uniqueTag = fillInfo.name;
   std::replace(uniqueTag.begin(), uniqueTag.end(), ' ', '_');
@@ -386,7 +835,7 @@ void NDHistogramManager::BookSingleHistogramWithSystList(
   // of the reference (the region membership RVec) so that multi-fill works
   // correctly without an extra event-loop pass.
   std::vector<std::string> baseValsVec;
-  HandleAxisVarVector(df, dataManager_m, systematicManager_m, cache, info.variable(),
+  HandleAxisVarVector(df, dataManager_m, systematicManager_m, cache, valueColumn,
                       fillInfo.hasSystematic, fillInfo.hasMultiFill, usedSystematics,
                       baseValsVec, false,
                       baseRefVector.empty() ? std::vector<std::string>{}
@@ -438,15 +887,17 @@ void NDHistogramManager::BookSingleHistogramWithSystList(
   };
 
   if (std::getenv("RDF_NDHIST_DEBUG") != nullptr) {
-    std::cout << "[NDHistogramManager] Book " << fillInfo.name << " columns: ";
+    LogLine line(ILogger::Level::Info);
+    line << "[NDHistogramManager] Book " << fillInfo.name << " columns: ";
     for (const auto& name : varVector) {
-      std::cout << name << " ";
+      line << name << " ";
     }
-    std::cout << std::endl;
   }
 
   df = dataManager_m->getDataFrame();
-  if (histogramBackend_m == "boost") {
+  dataManager_m->recordColumnsRead(varVector);
+  recordBookingCost(fillInfo, backend);
+  if (backend == "boost") {
     BHnMulti tempModel(fillInfo);
     histos_m.push_back(df.Book<
       ROOT::VecOps::RVec<Float_t>,
@@ -458,6 +909,17 @@ void NDHistogramManager::BookSingleHistogramWithSystList(
       ROOT::VecOps::RVec<Int_t>>(
       std::move(tempModel), varVector));
   } else {
+    fillInfo.memoryCeilingBytes = memoryCeilingBytes_m;
+    fillInfo.densePromotionFraction = densePromotion_m;
+    fillInfo.spillDirectory = spillDirectory_m;
+    fillInfo.memoryReport = std::make_shared<HistMemoryReport>();
+    memoryReports_m.push_back(fillInfo.memoryReport);
+    if (!baseRefVector.empty()) {
+      fillInfo.cellMask = variationPlanMask(channelInfo, systList);
+    }
+    if (backend == "gpu") {
+      fillInfo.deviceSink = makeDeviceSink(fillInfo);
+    }
     THnMulti tempModel(fillInfo);
     histos_m.push_back(df.Book<
       ROOT::VecOps::RVec<Float_t>,
@@ -514,6 +976,21 @@ void NDHistogramManager::bookND(std::vector<histInfo> &infos,
   if (normalizedRegionNames.empty() || normalizedRegionNames.back() != systList) {
     normalizedRegionNames.emplace_back(systList);
   }
+
+  // With a bound RegionManager the channel axis becomes the fused
+  // region x channel axis, so each info is one action for all regions.
+  std::vector<std::string> variables;
+  variables.reserve(infos.size());
+  for (const auto &info : infos) {
+    variables.push_back(info.variable());
+  }
+  const bool regionAxis = useRegionAxis(variables, "bookND");
+  std::string regionColumn;
+  const selectionInfo axisInfo = regionAxis ? makeRegionAxis(channelInfo) : channelInfo;
+  if (regionAxis) {
+    regionColumn = axisInfo.variable();
+    normalizedRegionNames[0] = axisInfo.regions();
+  }
   allRegionNames = normalizedRegionNames;
 
   // Track booked infos and region names for the no-args saveHists() overload.
@@ -522,13 +999,17 @@ void NDHistogramManager::bookND(std::vector<histInfo> &infos,
 
   histos_m.reserve(histos_m.size() + infos.size());
 
+  for (const auto &info : infos) {
+    countValueAxis(info);
+  }
   for (auto &info : infos) {
     BookSingleHistogramWithSystList(info,
                                     selectionInfo(sampleInfo),
                                     selectionInfo(controlInfo),
-                                    selectionInfo(channelInfo),
+                                    selectionInfo(axisInfo),
                                     suffix,
-                                    systList);
+                                    systList,
+                                    regionColumn);
   }
 }
 
@@ -602,6 +1083,7 @@ void NDHistogramManager::SaveHists(
   std::vector<int> allBins;
   std::vector<float> allLowerBounds;
   std::vector<float> allUpperBounds;
+  std::vector<std::vector<float>> allBinEdges;
   for (auto const &histList : fullHistList) {
     for (auto const &info : histList) {
       //std::cout << "Storing histogram: " << info.name() << std::endl;
@@ -611,6 +1093,7 @@ void NDHistogramManager::SaveHists(
       allBins.push_back(info.bins());
       allLowerBounds.push_back(info.lowerBound());
       allUpperBounds.push_back(info.upperBound());
+      allBinEdges.push_back(info.binEdges());
     }
   }
 
@@ -623,24 +1106,49 @@ void NDHistogramManager::SaveHists(
     commonAxisSize.push_back(regionNameList.size());
   }
 
-  int histIndex = 0;
-  std::unordered_map<std::string, TH1F> histMap;
-  std::unordered_set<std::string> dirSet;
-  std::cout << "Processing " << histos_m.size() << " histograms for saving..." << std::endl;
-  for (auto &histo_m : histos_m) {
-    auto hist = histo_m.GetPtr();
+  // Run the event loop(s) once on this thread: the projections below read
+  // the results from pool threads, which must not start a loop themselves.
+  std::vector<ROOT::RDF::RResultHandle> pendingResults;
+  for (auto &hist : histos_m) {
+    if (!hist.IsReady()) {
+      pendingResults.emplace_back(hist);
+    }
+  }
+  if (!pendingResults.empty()) {
+    ROOT::RDF::RunGraphs(pendingResults);
+  }
+
+  addRestoredHistos();
+
+  // Project every THnSparse onto its 1D histograms.  Histograms are
+  // independent, so they are projected in parallel, each into its own map;
+  // the maps are merged in booking order afterwards.
+  struct Projection {
+    std::map<std::string, TH1F> hists;
+    std::set<std::string> dirs;
+    // Nominal histograms filled along the systematic axis, i.e. with
+    // variations the systematics below are compared against.
+    std::unordered_set<std::string> variedKeys;
+  };
+  std::vector<Projection> projections(histos_m.size());
+  RDF_LOG_INFO << "Processing " << histos_m.size() << " histograms for saving...";
+  const auto project = [&](unsigned int histIndex) {
+    // Keep the projections out of gDirectory (the output file, or a
+    // directory shared between the pool threads).
+    TDirectory::TContext context(nullptr);
+    Projection &projection = projections[histIndex];
+    auto hist = histos_m[histIndex].GetPtr();
     const Int_t currentHistogramSize = hist->GetNbins();
     const Int_t dim = hist->GetNdimensions();
     std::vector<Int_t> indices(dim);
-      
+
     std::string histName = allNames[histIndex];
-    //std::cout << "Processing histogram name: " << histName << std::endl;
     for (int i = 0; i < currentHistogramSize; i++) {
-      Float_t content = hist->GetBinContent(i, indices.data());
+      Float_t content = hist->GetBinContent(i, indices.data()) * outputScale_m;
       if (content == 0) {
         continue;
       }
-      Float_t error = hist->GetBinError2(i);
+      Float_t error = hist->GetBinError2(i) * outputScale_m * outputScale_m;
 
       std::string dirName = "";
       const Int_t regionAxes = std::min(static_cast<Int_t>(allRegionNames.size()), dim - 1);
@@ -659,9 +1167,15 @@ void NDHistogramManager::SaveHists(
         dirName += allRegionNames[regionAxes - 2][indices[regionAxes - 2] - 1];
       }
 
-      
-      
-      if (regionAxes - 1 >= 0 &&
+      const auto systLabels = histSystLabels_m.find(static_cast<std::size_t>(histIndex));
+      if (systLabels != histSystLabels_m.end()) {
+        const auto &labels = systLabels->second;
+        if (regionAxes - 1 >= 0 && indices[regionAxes - 1] > 0 &&
+            indices[regionAxes - 1] - 1 < static_cast<Int_t>(labels.size()) &&
+            labels[indices[regionAxes - 1] - 1] != "Nominal") {
+          histName += "_" + labels[indices[regionAxes - 1] - 1];
+        }
+      } else if (regionAxes - 1 >= 0 &&
           regionAxes - 1 < static_cast<Int_t>(allRegionNames.size()) &&
           indices[regionAxes - 1] > 0 &&
           indices[regionAxes - 1] - 1 < static_cast<Int_t>(allRegionNames[regionAxes - 1].size())) {
@@ -670,47 +1184,138 @@ void NDHistogramManager::SaveHists(
         }
       }
 
-      if (histMap.count(dirName + "/" + histName) == 0) {
-        // std::cout << "Booking histogram: " << dirName + "/" + histName << std::endl;
-        histMap[dirName + "/" + histName] =
-            TH1F(histName.c_str(),
-                 (allNames[histIndex] + ";" + allNames[histIndex] +
-                  ";Counts").c_str(),
-                 allBins[histIndex], allLowerBounds[histIndex],
-                 allUpperBounds[histIndex]);
-        dirSet.emplace(dirName);
+      const std::string key = dirName + "/" + histName;
+      if (histName == allNames[histIndex] && systLabels == histSystLabels_m.end() &&
+          nominalOnlyHists_m.count(static_cast<std::size_t>(histIndex)) == 0) {
+        projection.variedKeys.insert(key);
+      }
+      auto it = projection.hists.find(key);
+      if (it == projection.hists.end()) {
+        const std::string title =
+            allNames[histIndex] + ";" + allNames[histIndex] + ";Counts";
+        if (allBinEdges[histIndex].empty()) {
+          it = projection.hists.emplace(
+              key, TH1F(histName.c_str(), title.c_str(), allBins[histIndex],
+                        allLowerBounds[histIndex], allUpperBounds[histIndex])).first;
+        } else {
+          it = projection.hists.emplace(
+              key, TH1F(histName.c_str(), title.c_str(), allBins[histIndex],
+                        allBinEdges[histIndex].data())).first;
+        }
+        projection.dirs.emplace(dirName);
       }
 
       const Int_t valueAxisIndex = regionAxes;
       if (valueAxisIndex < dim) {
-        // std::cout << "Booking histogram: " << dirName + "/" + histName << std::endl;
-        histMap[dirName + "/" + histName].SetBinContent(
-          indices[valueAxisIndex], content);
-        histMap[dirName + "/" + histName].SetBinError(
-          indices[valueAxisIndex], std::sqrt(error));
-        }
+        it->second.SetBinContent(indices[valueAxisIndex], content);
+        it->second.SetBinError(indices[valueAxisIndex], std::sqrt(error));
+      }
+    }
+  };
+  const bool parallel = histos_m.size() > 1 && ROOT::IsImplicitMTEnabled();
+  if (parallel) {
+    ROOT::EnableThreadSafety();
+    ROOT::TThreadExecutor pool;
+    pool.Foreach(project, ROOT::TSeqU(histos_m.size()));
+  } else {
+    for (unsigned int histIndex = 0; histIndex < histos_m.size(); ++histIndex) {
+      project(histIndex);
     }
+  }
 
-    histIndex++;
+  std::map<std::string, TH1F> histMap;
+  std::set<std::string> dirSet;
+  std::unordered_set<std::string> variedKeys;
+  TDirectory::TContext detached(nullptr);
+  for (auto &projection : projections) {
+    for (auto &[key, hist] : projection.hists) {
+      auto it = histMap.find(key);
+      if (it == histMap.end()) {
+        histMap.emplace(key, hist);
+        continue;
+      }
+      // Two booked histograms with the same name: the later one overwrites
+      // the bins it filled, as when they were projected one after the other.
+      for (Int_t b = 0; b <= hist.GetNbinsX() + 1; ++b) {
+        if (hist.GetBinContent(b) != 0) {
+          it->second.SetBinContent(b, hist.GetBinContent(b));
+          it->second.SetBinError(b, hist.GetBinError(b));
+        }
+      }
+    }
+    dirSet.insert(projection.dirs.begin(), projection.dirs.end());
+    variedKeys.insert(projection.variedKeys.begin(), projection.variedKeys.end());
+  }
+  projections.clear();
+
+  // In a pruning pass, report the effect of each systematic on the nominal
+  // histograms so that negligible systematics can be pruned.  Histograms
+  // booked without a systematic axis say nothing about a systematic and are
+  // skipped; a variation without any filled bin counts as empty.
+  if (systematicManager_m && !allRegionNames.empty() &&
+      !configProvider.get("systematicPruningReport").empty()) {
+    std::vector<std::string> systNames;
+    for (const auto &label : allRegionNames.back()) {
+      if (label.size() > 2 && label.compare(label.size() - 2, 2, "Up") == 0) {
+        systNames.push_back(label.substr(0, label.size() - 2));
+      }
+    }
+    const auto binContents = [](const TH1F *hist, Int_t nBins) {
+      std::vector<double> bins(nBins + 2, 0.0);
+      if (hist) {
+        for (Int_t b = 0; b < nBins + 2; ++b) {
+          bins[b] = hist->GetBinContent(b);
+        }
+      }
+      return bins;
+    };
+    for (const auto &[key, nominalHist] : histMap) {
+      if (variedKeys.count(key) == 0) {
+        continue;
+      }
+      const Int_t nBins = nominalHist.GetNbinsX();
+      const std::vector<double> nominal = binContents(&nominalHist, nBins);
+      for (const auto &syst : systNames) {
+        const auto upIt = histMap.find(key + "_" + syst + "Up");
+        const auto downIt = histMap.find(key + "_" + syst + "Down");
+        systematicManager_m->recordSystematicImpact(
+            syst, nominal,
+            binContents(upIt != histMap.end() ? &upIt->second : nullptr, nBins),
+            binContents(downIt != histMap.end() ? &downIt->second : nullptr, nBins));
+      }
+    }
   }
 
+  // Histograms of every output directory, in a fixed (sorted) order.
+  std::vector<HistogramWriteItem> items;
   for (const auto &dirName : dirSet) {
     std::string newDir(dirName);
     if (newDir.find('/') != std::string::npos) {
       newDir[newDir.find('/')] = '_';
     }
-    saveFile.cd();
-    if (!newDir.empty()) {
-      saveFile.mkdir(newDir.c_str());
-      saveFile.cd(newDir.c_str());
-    }
-    for (auto &pair : histMap) {
-      //std::cout << "Saving histogram: " << pair.first << std::endl;
+    for (const auto &pair : histMap) {
       if (pair.first.rfind(dirName + "/", 0) == 0) {
-        pair.second.Write();
+        items.push_back({newDir, &pair.second});
       }
     }
-    saveFile.cd();
+  }
+  writeHistogramItems(saveFile, items, ROOT::IsImplicitMTEnabled());
+
+  // Optional flat copy of the same histograms for fast merging.  A name
+  // written twice keeps its last histogram, as the highest key cycle does.
+  const std::string packFile = configProvider.get("histogramPackFile");
+  if (!packFile.empty()) {
+    std::map<std::string, const TH1F *> packed;
+    for (const auto &item : items) {
+      const std::string name = item.hist->GetName();
+      packed[item.directory.empty() ? name : item.directory + "/" + name] = item.hist;
+    }
+    HistogramPack pack;
+    for (const auto &[name, hist] : packed) {
+      pack.add(name, *hist);
+    }
+    pack.write(packFile);
+    RDF_LOG_INFO << "Wrote " << packed.size() << " histograms to " << packFile;
   }
 }
 
@@ -725,12 +1330,64 @@ NDHistogramManager::GetHistos() {
   return histos_m;
 }
 
+HistogramPack NDHistogramManager::packResults() {
+  addRestoredHistos();
+  HistogramPack pack;
+  for (auto &histo : histos_m) {
+    const THnSparseF &hist = *histo;
+    pack.add(hist.GetName(), hist);
+  }
+  // Same contents as saveHists() writes.
+  pack.scale(outputScale_m);
+  return pack;
+}
+
 /**
  * @brief Clear all stored histograms
  */
 void NDHistogramManager::Clear() {
   histos_m.clear();
   histNodes_m.clear();
+  histSystLabels_m.clear();
+  nominalOnlyHists_m.clear();
+  restoredHistos_m.clear();
+  memoryReports_m.clear();
+  bookingCosts_m.clear();
+  planSkippedCells_m = 0;
+  planCells_m = 0;
+}
+
+void NDHistogramManager::bookCheckpoint(CheckpointService &checkpoints) {
+  if (memoryCeilingBytes_m != 0 && !histos_m.empty()) {
+    throw std::runtime_error("NDHistogramManager: histogramMemoryCeiling cannot "
+                             "be combined with checkpointFile; slots flushed "
+                             "into the result are not in the checkpoint.");
+  }
+  restoredHistos_m.clear();
+  restoredHistos_m.resize(histos_m.size());
+  for (std::size_t i = 0; i < histos_m.size(); ++i) {
+    const std::string key = "ndhist_" + std::to_string(i);
+    checkpoints.watch(key, histos_m[i]);
+    if (!checkpoints.resuming()) {
+      continue;
+    }
+    const auto *restored = dynamic_cast<const THnBase *>(checkpoints.restored(key));
+    if (!restored) {
+      throw std::runtime_error("NDHistogramManager: the checkpoint has no "
+                               "histogram '" + key + "'; the booked "
+                               "histograms differ from the preempted run.");
+    }
+    restoredHistos_m[i].reset(static_cast<THnBase *>(restored->Clone()));
+  }
+}
+
+void NDHistogramManager::addRestoredHistos() {
+  for (std::size_t i = 0; i < restoredHistos_m.size() && i < histos_m.size(); ++i) {
+    if (restoredHistos_m[i]) {
+      CheckpointService::mergePayload(*histos_m[i], *restoredHistos_m[i]);
+      restoredHistos_m[i].reset();
+    }
+  }
 }
 
 /**
@@ -741,17 +1398,94 @@ void NDHistogramManager::setupFromConfigFile() {
     throw std::runtime_error("NDHistogramManager: ConfigManager not set");
   }
 
-  // Read optional histogram backend selection (default: "root", option: "boost")
+  // Read optional histogram backend selection (default: "root", options:
+  // "boost", "gpu")
   const std::string backend = configManager_m->get("histogramBackend");
   if (!backend.empty()) {
-    if (backend != "root" && backend != "boost") {
+    if (backend != "root" && backend != "boost" && backend != "gpu") {
       throw std::runtime_error(
           "NDHistogramManager: invalid histogramBackend '" + backend +
-          "'. Valid values are 'root' (default) or 'boost'.");
+          "'. Valid values are 'root' (default), 'boost' or 'gpu'.");
     }
+#ifndef USE_CUDA
+    if (backend == "gpu") {
+      throw std::runtime_error(
+          "NDHistogramManager: histogramBackend 'gpu' needs a build with -DUSE_CUDA=ON.");
+    }
+#endif
     histogramBackend_m = backend;
   }
 
+  // Optional ceiling on the sparse slot accumulators of each histogram.
+  const std::string ceiling = configManager_m->get("histogramMemoryCeiling");
+  if (!ceiling.empty()) {
+    try {
+      std::size_t pos = 0;
+      memoryCeilingBytes_m = std::stoull(ceiling, &pos);
+      if (pos != ceiling.size()) {
+        throw std::invalid_argument(ceiling);
+      }
+    } catch (const std::exception &) {
+      throw std::runtime_error(
+          "NDHistogramManager: invalid histogramMemoryCeiling '" + ceiling +
+          "'; expected a number of bytes.");
+    }
+  }
+
+  // Optional fill fraction at which sparse slot accumulators become dense.
+  const std::string promotion = configManager_m->get("histogramDensePromotion");
+  if (!promotion.empty()) {
+    try {
+      std::size_t pos = 0;
+      densePromotion_m = std::stod(promotion, &pos);
+      if (pos != promotion.size() || densePromotion_m < 0.0 || densePromotion_m > 1.0) {
+        throw std::invalid_argument(promotion);
+      }
+    } catch (const std::exception &) {
+      throw std::runtime_error(
+          "NDHistogramManager: invalid histogramDensePromotion '" + promotion +
+          "'; expected a fill fraction between 0 and 1.");
+    }
+  }
+
+  // Optional fill fraction of sparse histograms assumed by estimateCost().
+  const std::string fillFraction = configManager_m->get("costSparseFillFraction");
+  if (!fillFraction.empty()) {
+    try {
+      std::size_t pos = 0;
+      costFillFraction_m = std::stod(fillFraction, &pos);
+      if (pos != fillFraction.size() || !(costFillFraction_m > 0.0) ||
+          costFillFraction_m > 1.0) {
+        throw std::invalid_argument(fillFraction);
+      }
+    } catch (const std::exception &) {
+      throw std::runtime_error(
+          "NDHistogramManager: invalid costSparseFillFraction '" + fillFraction +
+          "'; expected a fill fraction in (0, 1].");
+    }
+  }
+
+  // Optional directory sparse slots over the ceiling are spilled to.
+  spillDirectory_m = configManager_m->get("histogramSpillDirectory");
+  if (!spillDirectory_m.empty() && memoryCeilingBytes_m == 0) {
+    throw std::runtime_error(
+        "NDHistogramManager: histogramSpillDirectory needs histogramMemoryCeiling; "
+        "slots are only spilled once they exceed their share of the ceiling.");
+  }
+
+  // Optional plan of the systematics each region needs downstream.
+  variationPlan_m.clear();
+  const std::string planFile = configManager_m->get("histogramVariationPlan");
+  if (!planFile.empty()) {
+    for (const auto &entry :
+         configManager_m->parseMultiKeyConfig(planFile, {"region", "systematics"})) {
+      auto &systematics = variationPlan_m[entry.at("region")];
+      for (const auto &syst : configManager_m->splitString(entry.at("systematics"), ",")) {
+        systematics.insert(syst);
+      }
+    }
+  }
+
   // Parse histogram configuration if present
   std::string histogramConfigFile = configManager_m->get("histogramConfig");
   if (histogramConfigFile.empty()) {
@@ -768,12 +1502,16 @@ void NDHistogramManager::setupFromConfigFile() {
     // Optional keys: label, suffix, channelVariable, channelBins, channelLowerBound, channelUpperBound, 
     //                channelRegions, controlRegionVariable, controlRegionBins, controlRegionLowerBound,
     //                controlRegionUpperBound, controlRegionRegions, sampleCategoryVariable, 
-    //                sampleCategoryBins, sampleCategoryLowerBound, sampleCategoryUpperBound, sampleCategoryRegions
+    //                sampleCategoryBins, sampleCategoryLowerBound, sampleCategoryUpperBound, sampleCategoryRegions,
+    //                backend, binEdges
     auto histogramEntries = configManager_m->parseMultiKeyConfig(
         histogramConfigFile,
         {"name", "variable", "weight", "bins", "lowerBound", "upperBound"});
 
     configHistograms_m.reserve(histogramEntries.size());
+    // A multi-sample job splits histograms by sample unless they set their
+    // own sample category.
+    const SampleSet samples = SampleSet::fromConfig(*configManager_m);
 
     for (const auto &entry : histogramEntries) {
       HistogramConfig config;
@@ -791,6 +1529,33 @@ void NDHistogramManager::setupFromConfigFile() {
       auto suffixIt = entry.find("suffix");
       config.suffix = (suffixIt != entry.end()) ? suffixIt->second : "";
 
+      auto backendIt = entry.find("backend");
+      if (backendIt != entry.end()) {
+        if (backendIt->second != "root" && backendIt->second != "boost" &&
+            backendIt->second != "gpu") {
+          throw std::runtime_error(
+              "NDHistogramManager: invalid backend '" + backendIt->second +
+              "' for histogram '" + config.name +
+              "'. Valid values are 'root', 'boost' or 'gpu'.");
+        }
+        config.backend = backendIt->second;
+      }
+
+      // Variable-width value axis: the edges replace bins and bounds.
+      auto binEdgesIt = entry.find("binEdges");
+      if (binEdgesIt != entry.end()) {
+        for (const auto &edge : configManager_m->splitString(binEdgesIt->second, ",")) {
+          config.binEdges.push_back(std::stof(edge));
+        }
+        if (config.binEdges.size() < 2) {
+          throw std::runtime_error("NDHistogramManager: binEdges of histogram '" +
+                                   config.name + "' needs at least two edges.");
+        }
+        config.bins = static_cast<int>(config.binEdges.size()) - 1;
+        config.lowerBound = config.binEdges.front();
+        config.upperBound = config.binEdges.back();
+      }
+
       // Channel selection info
       auto channelVarIt = entry.find("channelVariable");
       if (channelVarIt != entry.end()) {
@@ -860,6 +1625,12 @@ void NDHistogramManager::setupFromConfigFile() {
           throw std::runtime_error("NDHistogramManager: Error parsing sample category config for histogram '" + 
                                  config.name + "': " + e.what());
         }
+      } else if (!samples.empty()) {
+        config.sampleCategoryVariable = SampleSet::kIndexColumn;
+        config.sampleCategoryBins = static_cast<int>(samples.size());
+        config.sampleCategoryLowerBound = 0.0;
+        config.sampleCategoryUpperBound = static_cast<float>(samples.size());
+        config.sampleCategoryRegions = samples.names();
       } else {
         // Use default "zero__" variable for no sample category selection
         config.sampleCategoryVariable = "zero__";
@@ -897,23 +1668,40 @@ void NDHistogramManager::setupFromConfigFile() {
  * "not in this region" – it maps to the underflow bin (index < 1) and is
  * therefore silently ignored by the ROOT output code.
  *
- * Because DefineVector builds a compact scalar expression, no extra event-loop
- * pass is triggered; the column is computed lazily alongside everything else.
+ * The IDs are unpacked from the RegionManager membership word, which reads
+ * every region filter column once per event; only the regions of the event
+ * are listed, so an event fills one entry per region it belongs to.  With
+ * more regions than fit in one word, one boolean and one index column per
+ * region are defined instead and the column holds one entry per region.
  */
 std::string NDHistogramManager::ensureRegionMembershipColumn() {
   static const std::string kMembershipCol = "__rm_region_membership__";
   if (!regionManager_m) return kMembershipCol;
 
-  ROOT::RDF::RNode df = dataManager_m->getDataFrame();
-  const auto existingCols = df.GetColumnNames();
-  if (std::find(existingCols.begin(), existingCols.end(), kMembershipCol) !=
-      existingCols.end()) {
+  if (dataManager_m->hasColumn(kMembershipCol)) {
     return kMembershipCol; // already defined
   }
+  ROOT::RDF::RNode df = dataManager_m->getDataFrame();
 
   const auto &regionNames = regionManager_m->getRegionNames();
   if (regionNames.empty()) return kMembershipCol;
 
+  if (regionNames.size() <= RegionManager::kMaxMembershipRegions) {
+    const std::string word = regionManager_m->ensureMembershipColumn();
+    const std::size_t nRegions = regionNames.size();
+    auto unpack = [nRegions](std::uint64_t membership) {
+      ROOT::VecOps::RVec<Float_t> ids;
+      ids.reserve(nRegions);
+      for (; membership != 0; membership &= membership - 1) {
+        ids.push_back(static_cast<Float_t>(__builtin_ctzll(membership) + 1));
+      }
+      return ids;
+    };
+    df = dataManager_m->getDataFrame();
+    dataManager_m->updateDataFrame(df.Define(kMembershipCol, unpack, {word}), {kMembershipCol});
+    return kMembershipCol;
+  }
+
   // Step 1: For each region, define a boolean column whose value is true when
   //         the event satisfies the FULL ancestor filter chain.
   //         These are simple AND-expressions; RDF JIT-compiles them.
@@ -922,9 +1710,7 @@ std::string NDHistogramManager::ensureRegionMembershipColumn() {
     const std::string boolCol = "__rm_in_region_" + name + "__";
     boolColNames.push_back(boolCol);
 
-    const auto existingNow = dataManager_m->getDataFrame().GetColumnNames();
-    if (std::find(existingNow.begin(), existingNow.end(), boolCol) !=
-        existingNow.end()) {
+    if (dataManager_m->hasColumn(boolCol)) {
       continue; // already defined (e.g. called twice)
     }
 
@@ -935,8 +1721,8 @@ std::string NDHistogramManager::ensureRegionMembershipColumn() {
     }
     // Wrap as bool cast to be safe with different column types.
     expr = "static_cast<bool>(" + expr + ")";
-    df = df.Define(boolCol, expr);
-    dataManager_m->setDataFrame(df);
+    df = dataManager_m->defineExpression(df, boolCol, expr);
+    dataManager_m->updateDataFrame(df, {boolCol});
   }
 
   // Step 2: For each region, define a float-index column:
@@ -947,17 +1733,15 @@ std::string NDHistogramManager::ensureRegionMembershipColumn() {
     const std::string idxCol = "__rm_ridx_" + regionNames[i] + "__";
     idxColNames.push_back(idxCol);
 
-    const auto existingNow = dataManager_m->getDataFrame().GetColumnNames();
-    if (std::find(existingNow.begin(), existingNow.end(), idxCol) !=
-        existingNow.end()) {
+    if (dataManager_m->hasColumn(idxCol)) {
       continue;
     }
 
     const std::string expr =
         "static_cast<float>(" + boolColNames[i] + ") * " +
         std::to_string(static_cast<float>(i + 1)) + "f";
-    df = df.Define(idxCol, expr);
-    dataManager_m->setDataFrame(df);
+    df = dataManager_m->defineExpression(df, idxCol, expr);
+    dataManager_m->updateDataFrame(df, {idxCol});
   }
 
   // Step 3: Use DefineVector to pack the per-region float indices into a
@@ -968,12 +1752,160 @@ std::string NDHistogramManager::ensureRegionMembershipColumn() {
   return kMembershipCol;
 }
 
+bool NDHistogramManager::hasRegionAxis() const {
+  return regionManager_m && !regionManager_m->getRegionNames().empty();
+}
+
+bool NDHistogramManager::useRegionAxis(const std::vector<std::string> &variables,
+                                       const std::string &caller) const {
+  if (!hasRegionAxis()) {
+    return false;
+  }
+  auto df = dataManager_m->getDataFrame();
+  for (const auto &variable : variables) {
+    const std::string type = df.GetColumnType(variable);
+    if (type.find("RVec") != std::string::npos) {
+      if (logger_m) {
+        logger_m->log(ILogger::Level::Info,
+                      "NDHistogramManager::" + caller + "(): variable '" + variable +
+                          "' is a collection (" + type +
+                          "); booking without the region axis.");
+      }
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * @brief Region axis replacing the channel axis of a booking.
+ *
+ * Without a channel selection (`zero__`) the axis has one bin per region and
+ * reads the region membership column.  Otherwise region and channel are
+ * fused into one axis of N x C bins with the channel bin running fastest,
+ * read from a column defined once per channel binning.
+ */
+selectionInfo NDHistogramManager::makeRegionAxis(const selectionInfo &channelInfo) {
+  const std::string membershipCol = ensureRegionMembershipColumn();
+  const auto &regionNames = regionManager_m->getRegionNames();
+  const int nRegions = static_cast<int>(regionNames.size());
+  if (channelInfo.variable() == "zero__") {
+    return selectionInfo(membershipCol, nRegions, 0.5f,
+                         static_cast<float>(nRegions) + 0.5f, regionNames);
+  }
+
+  const std::string &channel = channelInfo.variable();
+  const int nChannels = channelInfo.bins();
+  if (nChannels < 1) {
+    throw std::runtime_error("NDHistogramManager::makeRegionAxis(): channel '" +
+                             channel + "' needs at least one bin.");
+  }
+  if (!systematicManager_m->getSystematicsForVariable(channel).empty()) {
+    throw std::runtime_error("NDHistogramManager::makeRegionAxis(): channel '" +
+                             channel + "' has systematic variations and cannot be "
+                             "fused with the region axis.");
+  }
+  const auto &channelNames = channelInfo.regions();
+  std::vector<std::string> names;
+  names.reserve(static_cast<std::size_t>(nRegions) * nChannels);
+  for (const auto &region : regionNames) {
+    for (int c = 0; c < nChannels; ++c) {
+      names.push_back(region + "_" +
+                      (c < static_cast<int>(channelNames.size()) ? channelNames[c]
+                                                                 : std::to_string(c)));
+    }
+  }
+  const int nBins = nRegions * nChannels;
+
+  const std::string key = channel + "|" + std::to_string(nChannels) + "|" +
+                          std::to_string(channelInfo.lowerBound()) + "|" +
+                          std::to_string(channelInfo.upperBound());
+  auto it = regionAxisColumns_m.find(key);
+  if (it == regionAxisColumns_m.end()) {
+    ROOT::RDF::RNode df = dataManager_m->getDataFrame();
+    const std::string type = df.GetColumnType(channel);
+    const FusedRegionAxisDefiner define = fusedRegionAxisDefiner(type);
+    if (!define) {
+      throw std::runtime_error("NDHistogramManager::makeRegionAxis(): channel '" +
+                               channel + "' of type '" + type +
+                               "' cannot be fused with the region axis; use a "
+                               "scalar arithmetic column.");
+    }
+    const std::string column = "__rm_region_" + channel + "_" +
+                               std::to_string(regionAxisColumns_m.size()) + "__";
+    dataManager_m->setDataFrame(define(df, column, membershipCol, channel, nChannels,
+                                       channelInfo.lowerBound(),
+                                       channelInfo.upperBound()));
+    it = regionAxisColumns_m.emplace(key, column).first;
+  }
+  return selectionInfo(it->second, nBins, 0.5f, static_cast<float>(nBins) + 0.5f,
+                       std::move(names));
+}
+
+static std::string valueAxisKey(const histInfo &info) {
+  std::ostringstream key;
+  key << std::setprecision(9) << info.variable() << '|' << info.bins() << '|'
+      << info.lowerBound() << '|' << info.upperBound();
+  return key.str();
+}
+
+void NDHistogramManager::countValueAxis(const histInfo &info) {
+  const std::string &backend =
+      info.backend().empty() ? histogramBackend_m : info.backend();
+  // BHnMulti bins raw values itself; THnMulti looks up variable-width bins
+  // in constant time.
+  if (backend != "boost" && info.binEdges().empty()) {
+    ++valueAxisUses_m[valueAxisKey(info)];
+  }
+}
+
+/**
+ * @brief Bin-index column for the value axis of @p info.
+ *
+ * THnMulti otherwise searches the value bin of every fill of every
+ * histogram; with a shared column the search runs once per event and axis.
+ * Variables with a variation bundle keep their raw values, as the bundle
+ * already supplies all variations in one column.
+ */
+std::string NDHistogramManager::valueBinColumn(const histInfo &info) {
+  const std::string key = valueAxisKey(info);
+  const auto uses = valueAxisUses_m.find(key);
+  const std::string &backend =
+      info.backend().empty() ? histogramBackend_m : info.backend();
+  if (backend == "boost" || !info.binEdges().empty() ||
+      uses == valueAxisUses_m.end() || uses->second < 2 ||
+      info.bins() < 1 || !(info.upperBound() > info.lowerBound())) {
+    return "";
+  }
+  if (const auto it = valueBinColumns_m.find(key); it != valueBinColumns_m.end()) {
+    return it->second;
+  }
+  if (systematicManager_m->getVariationBundle(info.variable()) != nullptr) {
+    return "";
+  }
+  auto df = dataManager_m->getDataFrame();
+  const auto columns = df.GetColumnNames();
+  if (std::find(columns.begin(), columns.end(), info.variable()) == columns.end()) {
+    return "";
+  }
+  const ValueBinsDefiner define = valueBinsDefiner(df.GetColumnType(info.variable()));
+  if (!define) {
+    return "";
+  }
+  const std::string column =
+      info.variable() + "__bin" + std::to_string(valueBinColumns_m.size());
+  define(*dataManager_m, *systematicManager_m, column, info.variable(), info.bins(),
+         info.lowerBound(), info.upperBound());
+  valueBinColumns_m.emplace(key, column);
+  return column;
+}
+
 /**
  * @brief Book histograms defined in config file
  *
  * When a RegionManager is bound, each config histogram is booked once as a
- * single large THnSparse with an additional region axis.  All bookings are
- * lazy, so the event loop runs exactly once.
+ * single large THnSparse whose channel axis is the region (x channel) axis.
+ * All bookings are lazy, so the event loop runs exactly once.
  */
 void NDHistogramManager::bookConfigHistograms() {
   if (configHistograms_m.empty()) {
@@ -984,27 +1916,27 @@ void NDHistogramManager::bookConfigHistograms() {
     throw std::runtime_error("NDHistogramManager: DataManager or SystematicManager not set");
   }
 
+  // The batch shares one set of axis names, so the region axis is used for
+  // all of its histograms or none.
+  std::vector<std::string> variables;
+  variables.reserve(configHistograms_m.size());
+  for (const auto &config : configHistograms_m) {
+    variables.push_back(config.variable);
+  }
+  const bool regionAxis = useRegionAxis(variables, "bookConfigHistograms");
+  std::vector<std::string> regionAxisNames;
+
   if (logger_m) {
     std::stringstream msg;
     msg << "NDHistogramManager: Booking " << configHistograms_m.size()
         << " histograms from config";
-    if (regionManager_m && !regionManager_m->getRegionNames().empty()) {
+    if (regionAxis) {
       msg << " with region axis ("
           << regionManager_m->getRegionNames().size() << " region(s))";
     }
     logger_m->log(ILogger::Level::Info, msg.str());
   }
 
-  // Build the region membership column once (no-op if already done or no RM).
-  std::string membershipCol;
-  std::vector<std::string> rmRegionNames;
-  int nRegions = 0;
-  if (regionManager_m && !regionManager_m->getRegionNames().empty()) {
-    membershipCol = ensureRegionMembershipColumn();
-    rmRegionNames = regionManager_m->getRegionNames();
-    nRegions = static_cast<int>(rmRegionNames.size());
-  }
-
   // Auto-detect systematic variations from dataframe columns before the syst
   // list is built for the first time.
   ensureSystematicsAutoRegistered();
@@ -1012,57 +1944,59 @@ void NDHistogramManager::bookConfigHistograms() {
   const std::vector<std::string> systList =
       systematicManager_m->makeSystList("SystematicCounter", *dataManager_m);
 
-  for (const auto &config : configHistograms_m) {
-    histInfo info(config.name.c_str(), config.variable.c_str(),
-                  config.label.c_str(), config.weight.c_str(),
-                  config.bins, config.lowerBound, config.upperBound);
-
-    if (nRegions > 0) {
-      // Region-aware path: override the channel axis with the region
-      // membership RVec.  Axis range [0.5, N+0.5] with N bins ensures that
-      // index 0 (event not in this region) falls to underflow (ignored).
-      selectionInfo regionChannelInfo(membershipCol, nRegions,
-                                      0.5f,
-                                      static_cast<float>(nRegions) + 0.5f,
-                                      rmRegionNames);
-
-      selectionInfo controlRegionInfo(config.controlRegionVariable,
-                                      config.controlRegionBins,
-                                      config.controlRegionLowerBound,
-                                      config.controlRegionUpperBound,
-                                      config.controlRegionRegions);
-
-      selectionInfo sampleCategoryInfo(config.sampleCategoryVariable,
-                                       config.sampleCategoryBins,
-                                       config.sampleCategoryLowerBound,
-                                       config.sampleCategoryUpperBound,
-                                       config.sampleCategoryRegions);
-
-      // Pass the membership column as baseRefVector so that scalar base
-      // variables (and their systematic variations) are expanded to the same
-      // size as the region RVec – required for correct multi-fill behaviour.
+  std::vector<histInfo> configBatch;
+  configBatch.reserve(configHistograms_m.size());
+  for (const auto& config : configHistograms_m) {
+    if (config.binEdges.empty()) {
+      configBatch.emplace_back(config.name.c_str(), config.variable.c_str(),
+                                config.label.c_str(), config.weight.c_str(),
+                                config.bins, config.lowerBound, config.upperBound,
+                                config.backend);
+    } else {
+      configBatch.emplace_back(config.name.c_str(), config.variable.c_str(),
+                                config.label.c_str(), config.weight.c_str(),
+                                config.binEdges, config.backend);
+    }
+    countValueAxis(configBatch.back());
+  }
+
+  for (std::size_t i = 0; i < configHistograms_m.size(); ++i) {
+    const auto &config = configHistograms_m[i];
+    histInfo info(configBatch[i]);
+
+    selectionInfo channelInfo(config.channelVariable, config.channelBins,
+                              config.channelLowerBound, config.channelUpperBound,
+                              config.channelRegions);
+    selectionInfo controlRegionInfo(config.controlRegionVariable,
+                                    config.controlRegionBins,
+                                    config.controlRegionLowerBound,
+                                    config.controlRegionUpperBound,
+                                    config.controlRegionRegions);
+    selectionInfo sampleCategoryInfo(config.sampleCategoryVariable,
+                                     config.sampleCategoryBins,
+                                     config.sampleCategoryLowerBound,
+                                     config.sampleCategoryUpperBound,
+                                     config.sampleCategoryRegions);
+    if (regionAxis) {
+      // Region-aware path: the channel axis becomes the region (x channel)
+      // axis.  Axis range [0.5, N+0.5] with N bins ensures that index 0
+      // (event not in this region) falls to underflow (ignored).  The region
+      // column is passed as baseRefVector so that scalar base variables (and
+      // their systematic variations) are expanded to the same size as the
+      // region RVec – required for correct multi-fill behaviour.
+      selectionInfo regionInfo = makeRegionAxis(channelInfo);
+      const std::string regionColumn = regionInfo.variable();
+      if (regionAxisNames.empty()) {
+        regionAxisNames = regionInfo.regions();
+      }
       BookSingleHistogramWithSystList(info,
                                       std::move(sampleCategoryInfo),
                                       std::move(controlRegionInfo),
-                                      std::move(regionChannelInfo),
+                                      std::move(regionInfo),
                                       config.suffix,
                                       systList,
-                                      membershipCol);
+                                      regionColumn);
     } else {
-      // Standard (non-region) path: existing behaviour unchanged.
-      selectionInfo channelInfo(config.channelVariable, config.channelBins,
-                                config.channelLowerBound, config.channelUpperBound,
-                                config.channelRegions);
-      selectionInfo controlRegionInfo(config.controlRegionVariable,
-                                      config.controlRegionBins,
-                                      config.controlRegionLowerBound,
-                                      config.controlRegionUpperBound,
-                                      config.controlRegionRegions);
-      selectionInfo sampleCategoryInfo(config.sampleCategoryVariable,
-                                       config.sampleCategoryBins,
-                                       config.sampleCategoryLowerBound,
-                                       config.sampleCategoryUpperBound,
-                                       config.sampleCategoryRegions);
       BookSingleHistogramWithSystList(info,
                                       std::move(sampleCategoryInfo),
                                       std::move(controlRegionInfo),
@@ -1076,13 +2010,6 @@ void NDHistogramManager::bookConfigHistograms() {
   // overload (called by Analyzer::run()) can find and write them to the meta
   // file.  Without this, trackedHistInfos_m stays empty and saveHists()
   // returns early, leaving histograms out of the output.
-  std::vector<histInfo> configBatch;
-  configBatch.reserve(configHistograms_m.size());
-  for (const auto& config : configHistograms_m) {
-    configBatch.emplace_back(config.name.c_str(), config.variable.c_str(),
-                              config.label.c_str(), config.weight.c_str(),
-                              config.bins, config.lowerBound, config.upperBound);
-  }
   if (!configBatch.empty()) {
     trackedHistInfos_m.push_back(std::move(configBatch));
     // Build region names that match the axes used when booking.
@@ -1097,11 +2024,11 @@ void NDHistogramManager::bookConfigHistograms() {
     // book them via separate bookND() calls with explicit allRegionNames.
     // The guard `configBatch.empty()` above ensures configHistograms_m is
     // non-empty before the `.front()` calls below.
-    if (nRegions > 0) {
-      // RegionManager path: channel axis is the region membership column.
+    if (regionAxis) {
+      // RegionManager path: channel axis is the (fused) region axis.
       const auto& firstConfig = configHistograms_m.front();
       trackedRegionNames_m = {
-          rmRegionNames,
+          regionAxisNames,
           firstConfig.controlRegionRegions,
           firstConfig.sampleCategoryRegions,
           systList};
@@ -1122,9 +2049,8 @@ void NDHistogramManager::bookConfigHistograms() {
   }
 }
 void NDHistogramManager::initialize() {
-  std::cout << "NDHistogramManager: initialized with "
-            << configHistograms_m.size() << " config histogram(s)."
-            << std::endl;
+  RDF_LOG_INFO << "NDHistogramManager: initialized with "
+               << configHistograms_m.size() << " config histogram(s).";
 }
 
 void NDHistogramManager::reportMetadata() {
@@ -1133,6 +2059,155 @@ void NDHistogramManager::reportMetadata() {
                 "NDHistogramManager: " +
                 std::to_string(configHistograms_m.size()) +
                 " config histogram(s) defined.");
+
+  // Slot accumulator memory, with the largest histogram singled out.
+  std::size_t totalBytes = 0;
+  std::size_t flushes = 0;
+  std::size_t promotions = 0;
+  std::size_t spills = 0;
+  std::uint64_t spilledBytes = 0;
+  const HistMemoryReport *largest = nullptr;
+  for (const auto &report : memoryReports_m) {
+    if (report->name.empty()) continue;
+    totalBytes += report->totalBytes();
+    flushes += report->flushes;
+    promotions += report->promotions;
+    spills += report->spills;
+    spilledBytes += report->spilledBytes;
+    if (!largest || report->totalBytes() > largest->totalBytes()) {
+      largest = report.get();
+    }
+  }
+  if (!largest) return;
+  std::ostringstream msg;
+  msg << "NDHistogramManager: histogram slot accumulators peaked at "
+      << totalBytes / (1024 * 1024) << " MiB; largest '" << largest->name
+      << "' (" << (largest->dense ? "dense" : "sparse") << ") at "
+      << largest->totalBytes() / (1024 * 1024) << " MiB, filled bins per slot:";
+  for (Long64_t bins : largest->slotFilledBins) {
+    msg << ' ' << bins;
+  }
+  if (flushes != 0) {
+    msg << "; " << flushes << " slot flush(es) under histogramMemoryCeiling="
+        << memoryCeilingBytes_m;
+  }
+  if (promotions != 0) {
+    msg << "; " << promotions << " sparse slot(s) promoted to dense";
+  }
+  if (planSkippedCells_m != 0) {
+    msg << "; histogramVariationPlan skipped " << planSkippedCells_m << " of " << planCells_m
+        << " region x variation cells";
+  }
+  if (spills != 0) {
+    msg << "; " << spills << " slot run(s) of " << spilledBytes / (1024 * 1024)
+        << " MiB spilled to " << spillDirectory_m;
+  }
+  logger_m->log(ILogger::Level::Info, msg.str());
+}
+
+std::vector<std::uint8_t>
+NDHistogramManager::variationPlanMask(const selectionInfo &regionAxis,
+                                      const std::vector<std::string> &systList) {
+  if (variationPlan_m.empty() || !hasRegionAxis()) {
+    return {};
+  }
+  const auto &regionNames = regionManager_m->getRegionNames();
+  const std::size_t nBins = static_cast<std::size_t>(regionAxis.bins());
+  const std::size_t nChannels = std::max<std::size_t>(nBins / regionNames.size(), 1);
+  std::vector<std::uint8_t> mask(nBins * systList.size(), 1);
+  std::size_t skipped = 0;
+  for (std::size_t s = 0; s < systList.size(); ++s) {
+    // Variations are "<systematic>Up" / "<systematic>Down".
+    std::string syst = systList[s];
+    for (const std::string suffix : {"Up", "Down"}) {
+      if (syst.size() > suffix.size() &&
+          syst.compare(syst.size() - suffix.size(), suffix.size(), suffix) == 0) {
+        syst.erase(syst.size() - suffix.size());
+        break;
+      }
+    }
+    if (syst == "Nominal") {
+      continue;
+    }
+    for (std::size_t bin = 0; bin < nBins; ++bin) {
+      const auto plan = variationPlan_m.find(regionNames[bin / nChannels]);
+      if (plan != variationPlan_m.end() && plan->second.count(syst) == 0) {
+        mask[s * nBins + bin] = 0;
+        ++skipped;
+      }
+    }
+  }
+  planCells_m += mask.size();
+  planSkippedCells_m += skipped;
+  if (skipped == 0) {
+    return {};
+  }
+  return mask;
+}
+
+void NDHistogramManager::recordBookingCost(const histFillInfo &fillInfo,
+                                           const std::string &backend) {
+  GraphCost::Histogram cost;
+  cost.name = fillInfo.name;
+  cost.cells = estimateDenseMemoryBytes(fillInfo.nbins, 1, 1);
+  cost.systematics = static_cast<std::size_t>(fillInfo.nbins[3]);
+  // Same choice as THnMulti: flat arrays of 16 bytes per cell below the
+  // dense threshold, otherwise a THnSparseF holding costFillFraction_m of
+  // the cells, or the flat array it is promoted to once it holds more.
+  const auto nSlots = static_cast<unsigned int>(std::max<Int_t>(fillInfo.nSlots, 1));
+  const bool dense =
+      estimateDenseMemoryBytes(fillInfo.nbins, nSlots, 16) <= kDenseMemoryThresholdBytes;
+  const std::uint64_t sparseBytes = estimateSparseBytesPerBin(fillInfo.nbins);
+  const Long64_t promoteBins =
+      backend == "root" ? densePromotionBins(fillInfo.nbins, nSlots, densePromotion_m,
+                                             memoryCeilingBytes_m)
+                        : 0;
+  constexpr auto kMax = std::numeric_limits<std::uint64_t>::max();
+  const auto filled = static_cast<std::uint64_t>(
+      std::ceil(static_cast<double>(cost.cells) * costFillFraction_m));
+  if (dense) {
+    cost.bytesPerSlot = cost.cells > kMax / 16 ? kMax : cost.cells * 16;
+  } else if (promoteBins != 0 && filled >= static_cast<std::uint64_t>(promoteBins)) {
+    cost.bytesPerSlot = std::max<std::uint64_t>(
+        cost.cells * 16, static_cast<std::uint64_t>(promoteBins) * sparseBytes);
+  } else {
+    cost.bytesPerSlot = filled > kMax / sparseBytes ? kMax : filled * sparseBytes;
+  }
+  bookingCosts_m.push_back(std::move(cost));
+}
+
+void NDHistogramManager::estimateCost(GraphCost &cost) const {
+  cost.histograms.insert(cost.histograms.end(), bookingCosts_m.begin(), bookingCosts_m.end());
+}
+
+std::unordered_map<std::string, std::string>
+NDHistogramManager::collectMemoryEntries() const {
+  std::unordered_map<std::string, std::string> entries;
+  std::size_t totalBytes = 0;
+  std::size_t flushes = 0;
+  for (const auto &report : memoryReports_m) {
+    if (report->name.empty()) continue;
+    totalBytes += report->totalBytes();
+    flushes += report->flushes;
+    std::ostringstream bins;
+    std::ostringstream bytes;
+    for (std::size_t slot = 0; slot < report->slotBytes.size(); ++slot) {
+      bins << (slot ? "," : "") << report->slotFilledBins[slot];
+      bytes << (slot ? "," : "") << report->slotBytes[slot];
+    }
+    entries[report->name] = std::string(report->dense ? "dense" : "sparse") +
+                            ";filled_bins=" + bins.str() + ";bytes=" + bytes.str() +
+                            ";flushes=" + std::to_string(report->flushes) +
+                            ";promoted=" + std::to_string(report->promotions) +
+                            ";spilled=" + std::to_string(report->spills);
+  }
+  if (entries.empty()) return entries;
+  entries["total_bytes"] = std::to_string(totalBytes);
+  entries["flushes"] = std::to_string(flushes);
+  if (memoryCeilingBytes_m != 0) {
+    entries["ceiling_bytes"] = std::to_string(memoryCeilingBytes_m);
+  }
+  return entries;
 }
 
 std::shared_ptr<NDHistogramManager> NDHistogramManager::create(
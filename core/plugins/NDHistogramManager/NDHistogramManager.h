@@ -1,13 +1,18 @@
 #ifndef NDHISTOGRAMMANAGER_H_INCLUDED
 #define NDHISTOGRAMMANAGER_H_INCLUDED
 
+#include <api/ICheckpointParticipant.h>
 #include <api/IPluggableManager.h>
 #include <api/ManagerContext.h>
 #include <plots.h>
 #include <ROOT/RDataFrame.hxx>
 #include <api/ILogger.h>
 #include <api/IOutputSink.h>
+#include <GraphCost.h>
+#include <HistogramPack.h>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 #include <memory>
 
@@ -27,26 +32,32 @@ class RegionManager;
  *
  * ### Region-aware mode
  *
- * Call bindToRegionManager() with a configured RegionManager before calling
- * bookConfigHistograms().  When a RegionManager is bound:
+ * Call bindToRegionManager() with a configured RegionManager before booking.
+ * When a RegionManager is bound, every booking path (bookConfigHistograms(),
+ * BookSingleHistogram() and bookND()) books on the main dataframe:
  *
  *  - A `__rm_region_membership__` multi-fill column is defined on the
- *    dataframe.  For each event, it contains the 1-indexed float index of
- *    every declared region the event belongs to (empty entries are 0.0 and
- *    fall to the underflow bin, which is not included in the output).
- *  - Each config histogram is booked **once** as a single, large
- *    multi-dimensional THnSparse that has an additional *region axis*.
- *    The region axis has @em N bins (one per declared region), so the total
- *    number of stored histogram objects does not grow with the region count.
- *    This satisfies the single-execution / large-multi-dim requirement.
+ *    dataframe from the RegionManager membership word.  For each event, it
+ *    contains the 1-indexed float index of every declared region the event
+ *    belongs to.
+ *  - Each histogram is booked **once** as a single, large
+ *    multi-dimensional THnSparse whose channel axis is a *region axis*.
+ *    Without a channel selection the region axis has @em N bins (one per
+ *    declared region).  A channel selection is fused into the same axis,
+ *    which then has N x C bins named `<region>_<channel>`, so region and
+ *    channel are filled by the same action.  The sample-category and
+ *    control-region axes are kept.  There is one THnMulti action per
+ *    histogram, independent of the region count.
  *  - All histogram bookings share the same underlying RDataFrame computation
  *    graph, so the event loop is executed **exactly once**.
  *
  * @note Only scalar (non-collection) base variables are supported in the
- *       region-aware booking path.  For per-object (RVec) variables use the
- *       standard bookND() interface.
+ *       region-aware booking path, and a fused channel must be a scalar
+ *       arithmetic column without systematic variations.  Booking an RVec
+ *       variable while a RegionManager is bound throws.
  */
-class NDHistogramManager : public IPluggableManager {
+class NDHistogramManager : public IPluggableManager,
+                           public ICheckpointParticipant {
 public:
 
   // -------------------------------------------------------------------------
@@ -72,6 +83,9 @@ public:
    * @param controlRegionInfo Selection info object for control region
    * @param channelInfo Selection info object for channel
    * @param suffix Suffix to append to histogram names
+   *
+   * With a bound RegionManager the channel axis is replaced by the fused
+   * region x channel axis (see the class documentation).
    */
    void BookSingleHistogram(histInfo &info, selectionInfo &&sampleCategoryInfo=selectionInfo(),
      selectionInfo &&controlRegionInfo=selectionInfo(), 
@@ -93,6 +107,9 @@ public:
    * @param selection Vector of selection info objects
    * @param suffix Suffix to append to histogram names
    * @param allRegionNames Vector of region name vectors
+   *
+   * With a bound RegionManager allRegionNames[0] is replaced by the names of
+   * the fused region x channel axis.
    */
   void bookND(std::vector<histInfo> &infos,
               std::vector<selectionInfo> &selection,
@@ -116,12 +133,33 @@ public:
    */
   void saveHists();
 
+  /**
+   * @brief Multiply the contents saved by saveHists() and returned by
+   *        packResults() by @p scale (and the errors accordingly); used to
+   *        scale preview runs to full statistics and for deferred
+   *        normalizations (see Analyzer::applyOutputScales()).
+   */
+  void setOutputScale(double scale) { outputScale_m = scale; }
+
   /**
    * @brief Get the vector of histogram result pointers
    * @return Reference to the vector of RResultPtr<THnSparseD>
    */
   std::vector<ROOT::RDF::RResultPtr<THnSparseF>> &GetHistos();
 
+  /**
+   * @brief Filled bins of every booked histogram, without writing a file.
+   *
+   * Runs the event loop if it has not run yet, and adds the histograms
+   * restored from a checkpoint.  Each THnSparse is stored under its booking
+   * name ("<name>_<suffix>") with all of its axes, in the HistogramPack
+   * layout, scaled by setOutputScale(); the Python bindings hand the arrays
+   * to NumPy without a copy.
+   *
+   * @throws std::runtime_error if two histograms share a booking name.
+   */
+  HistogramPack packResults();
+
   /**
    * @brief Clear all stored histograms
    */
@@ -152,6 +190,42 @@ public:
    */
   void reportMetadata() override;
 
+  /**
+   * @brief Checkpoint every booked histogram.
+   *
+   * Histogram i is stored under the key "ndhist_<i>", so a resumed job must
+   * book the same histograms in the same order.  Restored histograms are
+   * added to the results when they are saved.
+   *
+   * @throws std::runtime_error if the resumed checkpoint lacks a histogram,
+   *         or if histogramMemoryCeiling is set (flushed slots would be
+   *         missing from the snapshots).
+   */
+  void bookCheckpoint(CheckpointService &checkpoints) override;
+
+  /**
+   * @brief Slot accumulator memory of the root-backend histograms.
+   *
+   * One report per THnMulti booking, filled when the event loop finalizes
+   * the action; reports of histograms not yet run have an empty name.
+   */
+  const std::vector<std::shared_ptr<HistMemoryReport>> &getMemoryReports() const {
+    return memoryReports_m;
+  }
+
+  /**
+   * @brief ProvenanceService entries for getMemoryReports().
+   *
+   * Kept apart from collectProvenanceEntries(), whose entries are hashed as
+   * the plugin configuration.  Keys: "total_bytes", "flushes",
+   * "ceiling_bytes" (when set) and "<histogram>" with the storage and the
+   * filled bins and bytes of every slot.
+   */
+  std::unordered_map<std::string, std::string> collectMemoryEntries() const;
+
+  /// Booked histograms with their cells and worst-case slot memory.
+  void estimateCost(GraphCost &cost) const override;
+
   /**
    * @brief Book histograms defined in config file
    * 
@@ -174,16 +248,31 @@ public:
    * Must be called *before* bookConfigHistograms().  The RegionManager must
    * have already had all its regions declared.
    *
-   * When bound, bookConfigHistograms() defines a multi-fill region membership
-   * column on the dataframe and books each config histogram with the region
-   * as an extra axis (a single large THnSparse per config entry instead of
-   * N separate histograms).  Because all bookings are lazy and share the same
+   * When bound, every booking path defines a multi-fill region membership
+   * column on the dataframe and books each histogram with the region (fused
+   * with the channel) as its channel axis (a single large THnSparse per
+   * histogram instead of N separate histograms).  Because all bookings are lazy and share the same
    * computation graph, the event loop runs **exactly once**.
    *
    * @param rm  Pointer to the RegionManager.  Passing nullptr is a no-op.
    */
   void bindToRegionManager(RegionManager *rm);
 
+  /**
+   * @brief Declare @p column as a weight vector with one entry per label.
+   *
+   * Histograms booked afterwards with @p column as their weight are filled
+   * with all entries at once: the systematic axis has one bin per label and
+   * the entries share one bin lookup (see THnMulti's weight-vector Exec()).
+   * The histograms are saved as "<name>_<label>", with the first label taken
+   * as nominal when it is "Nominal".  The column must be an
+   * RVec<Float_t>, e.g. WeightManager::defineVariedWeightVector(); the
+   * other axes of such histograms must be scalars without systematics.
+   *
+   * @throws std::invalid_argument if @p column or @p labels is empty
+   */
+  void registerWeightVector(const std::string &column, const std::vector<std::string> &labels);
+
   /**
    * @brief Structure to hold parsed histogram configuration.
    *
@@ -214,6 +303,8 @@ public:
     float sampleCategoryLowerBound;
     float sampleCategoryUpperBound;
     std::vector<std::string> sampleCategoryRegions;
+    std::string backend; ///< Per-histogram backend override (empty = histogramBackend)
+    std::vector<float> binEdges; ///< Variable-width bin edges (empty = uniform bins)
   };
 
   /**
@@ -260,18 +351,77 @@ private:
    *
    * Defines `__rm_region_membership__` as an RVec<Float_t> whose elements are
    * the 1-indexed float IDs of all regions the event belongs to.  Values of
-   * 0.0 (event not in that region) are mapped to the underflow bin and are
-   * therefore not counted in the histogram output.
+   * 0.0 (event not in that region, only used above 64 regions) are mapped to
+   * the underflow bin and are therefore not counted in the histogram output.
    *
    * @return The column name of the membership vector.
    */
   std::string ensureRegionMembershipColumn();
 
+  /// True when a RegionManager with at least one region is bound.
+  bool hasRegionAxis() const;
+
+  /**
+   * @brief Region axis replacing @p channelInfo in a region-aware booking.
+   *
+   * Defines the fused region x channel column once per channel binning.
+   *
+   * @throws std::runtime_error if the channel has systematic variations or is
+   *         not a scalar arithmetic column.
+   */
+  selectionInfo makeRegionAxis(const selectionInfo &channelInfo);
+
+  /// True when a booking of @p variables gets the region axis: a region
+  /// axis is bound and none of them is an RVec column (those are booked
+  /// without it).
+  bool useRegionAxis(const std::vector<std::string> &variables,
+                     const std::string &caller) const;
+
+  /// Add the restored histograms to the results (runs the event loop).
+  void addRestoredHistos();
+
+  /// Record the cells and slot accumulator bytes of a booking for
+  /// estimateCost(), with the storage the @p backend selects for it.
+  void recordBookingCost(const histFillInfo &fillInfo, const std::string &backend);
+
+  /**
+   * @brief Cell mask (histFillInfo::cellMask) of a region-aware booking
+   *        from the histogramVariationPlan.
+   *
+   * Nominal is filled in every region, a variation only in the regions
+   * whose plan lists its systematic; regions the plan does not list keep
+   * every variation.
+   *
+   * @return Empty when no plan is set or it skips no cell of the booking.
+   */
+  std::vector<std::uint8_t> variationPlanMask(const selectionInfo &regionAxis,
+                                              const std::vector<std::string> &systList);
+
+  /// Record that @p info fills its value axis with the root backend.
+  void countValueAxis(const histInfo &info);
+
+  /**
+   * @brief Per-event value-axis bin column shared by histograms with the
+   *        same variable and binning.
+   *
+   * Defines the column (and its systematic variations) on first use when at
+   * least two root-backend histograms counted by countValueAxis() share the
+   * axis.
+   *
+   * @return The bin-index column, or an empty string when @p info fills raw
+   *         values (axis not shared, boost backend, variation bundle or
+   *         unsupported column type).
+   */
+  std::string valueBinColumn(const histInfo &info);
+
   /**
    * @brief Vector of histogram result pointers.
    */
   std::vector<ROOT::RDF::RNode> histNodes_m;
   std::vector<ROOT::RDF::RResultPtr<THnSparseF>> histos_m;
+  // Histograms restored from a checkpoint, parallel to histos_m (nullptr
+  // when none); added to the results by addRestoredHistos().
+  std::vector<std::unique_ptr<THnBase>> restoredHistos_m;
   std::vector<HistogramConfig> configHistograms_m;
   // Accumulated metadata from each bookND() call — used by the no-args saveHists()
   std::vector<std::vector<histInfo>> trackedHistInfos_m;
@@ -283,8 +433,42 @@ private:
   IOutputSink* skimSink_m = nullptr;
   IOutputSink* metaSink_m = nullptr;
   bool countersFinalized_m = false;
+  double outputScale_m = 1.0;
   std::string histogramBackend_m = "root";
+  // histogramMemoryCeiling: bytes allowed for the sparse slot accumulators
+  // of each histogram (0 = none).
+  std::size_t memoryCeilingBytes_m = 0;
+  // histogramDensePromotion: fill fraction at which a sparse slot
+  // accumulator becomes a flat array (negative = memory break-even).
+  double densePromotion_m = -1.0;
+  // costSparseFillFraction: share of the cells of a sparse histogram the
+  // dry-run cost estimate expects to be filled.
+  double costFillFraction_m = 0.1;
+  // histogramSpillDirectory: where sparse slots over the ceiling are
+  // written as sorted runs instead of merged in memory (empty = none).
+  std::string spillDirectory_m;
+  // histogramVariationPlan: systematics used downstream per region (empty
+  // = fill every variation everywhere), and the cells it skipped out of
+  // those of the bookings it applied to.
+  std::unordered_map<std::string, std::unordered_set<std::string>> variationPlan_m;
+  std::size_t planSkippedCells_m = 0;
+  std::size_t planCells_m = 0;
+  std::vector<std::shared_ptr<HistMemoryReport>> memoryReports_m;
+  /// One entry per booking (see recordBookingCost()).
+  std::vector<GraphCost::Histogram> bookingCosts_m;
   RegionManager* regionManager_m = nullptr;
+  // Fused region x channel columns, keyed by channel variable and binning.
+  std::unordered_map<std::string, std::string> regionAxisColumns_m;
+  // Root-backend bookings per value axis and the bin-index column defined
+  // for each shared one, keyed by variable and binning.
+  std::unordered_map<std::string, unsigned> valueAxisUses_m;
+  std::unordered_map<std::string, std::string> valueBinColumns_m;
+  // Weight-vector columns and the labels of their entries.
+  std::unordered_map<std::string, std::vector<std::string>> weightVectors_m;
+  // Systematic-axis labels of weight-vector histograms, by index in histos_m.
+  std::unordered_map<std::size_t, std::vector<std::string>> histSystLabels_m;
+  // Indices in histos_m of histograms booked without a systematic axis fill.
+  std::unordered_set<std::size_t> nominalOnlyHists_m;
 };
 
 
@@ -4,6 +4,7 @@
 #include <api/IPluggableManager.h>
 #include <api/ILogger.h>
 #include <api/ManagerContext.h>
+#include <ModelRegistry.h>
 #include <stdexcept>
 #include <string>
 #include <unordered_map>
@@ -52,6 +53,7 @@ public:
     dataManager_m = &ctx.data;
     systematicManager_m = &ctx.systematics;
     logger_m = &ctx.logger;
+    models_m = ctx.models;
   }
 
   void setupFromConfigFile() override {
@@ -59,12 +61,18 @@ public:
   }
 
 protected:
+  /// Registry for loading shared correction sets and models.
+  ModelRegistry &models() const {
+    return models_m ? *models_m : ModelRegistry::instance();
+  }
+
   std::unordered_map<std::string, ObjectType> objects_m;
   std::unordered_map<std::string, std::vector<std::string>> features_m;
   IConfigurationProvider* configManager_m = nullptr;
   IDataFrameProvider* dataManager_m = nullptr;
   ISystematicManager* systematicManager_m = nullptr;
   ILogger* logger_m = nullptr;
+  ModelRegistry* models_m = nullptr;
 };
 
 #endif // NAMEDOBJECTMANAGER_H_INCLUDED 
\ No newline at end of file
@@ -0,0 +1,269 @@
+#include <ObjectEnergyCorrectionPass.h>
+#include <ROOT/RVec.hxx>
+#include <algorithm>
+#include <analyzer.h>
+#include <cmath>
+#include <sstream>
+#include <stdexcept>
+
+std::shared_ptr<ObjectEnergyCorrectionPass> ObjectEnergyCorrectionPass::create(
+    Analyzer &an, const std::string &role) {
+  auto plugin = std::make_shared<ObjectEnergyCorrectionPass>();
+  an.addPlugin(role, plugin);
+  return plugin;
+}
+
+void ObjectEnergyCorrectionPass::setContext(ManagerContext &ctx) {
+  dataManager_m       = &ctx.data;
+  systematicManager_m = &ctx.systematics;
+  logger_m            = &ctx.logger;
+}
+
+// ---------------------------------------------------------------------------
+// Configuration
+// ---------------------------------------------------------------------------
+
+void ObjectEnergyCorrectionPass::addObjects(
+    std::shared_ptr<ObjectEnergyManagerBase> manager,
+    const std::string &correctedPtColumn, float ptThreshold,
+    const std::string &referencePtColumn) {
+  if (!manager)
+    throw std::invalid_argument(type() + "::addObjects: manager must not be null");
+  if (correctedPtColumn.empty())
+    throw std::invalid_argument(
+        type() + "::addObjects: correctedPtColumn must not be empty");
+
+  ObjectSet set;
+  set.referencePtColumn =
+      referencePtColumn.empty() ? manager->getPtColumn() : referencePtColumn;
+  if (set.referencePtColumn.empty())
+    throw std::invalid_argument(
+        type() + "::addObjects: no reference pT column; call setObjectColumns() "
+        "on the " + manager->type() + " first or pass referencePtColumn");
+  set.manager           = std::move(manager);
+  set.correctedPtColumn = correctedPtColumn;
+  set.ptThreshold       = ptThreshold;
+  objectSets_m.push_back(std::move(set));
+  executionPending_m = true;
+}
+
+void ObjectEnergyCorrectionPass::propagateMET(
+    const std::string &baseMETPtColumn, const std::string &baseMETPhiColumn,
+    const std::string &outputMETPtColumn, const std::string &outputMETPhiColumn) {
+  if (baseMETPtColumn.empty() || baseMETPhiColumn.empty())
+    throw std::invalid_argument(
+        type() + "::propagateMET: base MET columns must not be empty");
+  if (outputMETPtColumn.empty() || outputMETPhiColumn.empty())
+    throw std::invalid_argument(
+        type() + "::propagateMET: output MET columns must not be empty");
+  metOutputs_m.push_back(
+      {baseMETPtColumn, baseMETPhiColumn, outputMETPtColumn, outputMETPhiColumn});
+  executionPending_m = true;
+}
+
+std::vector<std::string> ObjectEnergyCorrectionPass::getVariationNames() const {
+  std::vector<std::string> names;
+  for (const auto &set : objectSets_m) {
+    for (const auto &var : set.manager->getVariations()) {
+      if (std::find(names.begin(), names.end(), var.name) == names.end())
+        names.push_back(var.name);
+    }
+  }
+  return names;
+}
+
+// ---------------------------------------------------------------------------
+// execute()
+// ---------------------------------------------------------------------------
+
+void ObjectEnergyCorrectionPass::execute() {
+  if (!dataManager_m)
+    throw std::runtime_error(type() + "::execute: context not set");
+  if (!executionPending_m)
+    return;
+
+  // The managers define the corrected and varied pT columns read below; a
+  // manager that already executed has nothing pending and returns at once.
+  for (const auto &set : objectSets_m) {
+    if (set.manager->getPhiColumn().empty())
+      throw std::runtime_error(
+          type() + "::execute: " + set.manager->type() +
+          " has no object phi column; call setObjectColumns() first");
+    set.manager->execute();
+  }
+
+  // One column per object set with its reference, nominal and varied pT,
+  // {ref, nominal, var1Up, var1Down, ...}, so that one kernel reads them all.
+  for (std::size_t j = packColumns_m.size(); j < objectSets_m.size(); ++j) {
+    const auto &set = objectSets_m[j];
+    std::vector<std::string> columns = {set.referencePtColumn, set.correctedPtColumn};
+    for (const auto &var : set.manager->getVariations()) {
+      columns.push_back(var.upPtColumn);
+      columns.push_back(var.downPtColumn);
+    }
+    const std::string pack =
+        "_objcorr_pack_" + std::to_string(j) + "_" + set.correctedPtColumn;
+    dataManager_m->DefineVector(pack, columns, "Float_t", *systematicManager_m);
+    packColumns_m.push_back(pack);
+  }
+
+  const auto variationNames = getVariationNames();
+  for (const auto &output : metOutputs_m)
+    defineMET(output, variationNames);
+
+  metOutputs_m.clear();
+  executionPending_m = false;
+}
+
+void ObjectEnergyCorrectionPass::defineMET(
+    const METOutput &output, const std::vector<std::string> &variationNames) {
+  using ROOT::VecOps::RVec;
+  // Block 0 is the nominal MET, block 1 + 2g / 2 + 2g variation g Up / Down.
+  const std::size_t nBlocks = 1 + 2 * variationNames.size();
+  const std::string xyCol = "_objcorr_xy_" + output.outputMETPtColumn;
+  const std::string baseXY = met_m.baseVectorColumn(
+      *dataManager_m, output.baseMETPtColumn, output.baseMETPhiColumn);
+
+  dataManager_m->updateDataFrame(
+      dataManager_m->defineColumn(
+          dataManager_m->getDataFrame(), xyCol,
+          [nBlocks](const RVec<float> &base) {
+            RVec<float> xy(2 * nBlocks);
+            for (std::size_t k = 0; k < nBlocks; ++k) {
+              xy[2 * k]     = base[0];
+              xy[2 * k + 1] = base[1];
+            }
+            return xy;
+          },
+          {baseXY}),
+      {xyCol});
+
+  for (std::size_t j = 0; j < objectSets_m.size(); ++j) {
+    const auto &set = objectSets_m[j];
+    // Bundle block of each of the set's varied pT columns.
+    std::vector<std::size_t> blocks;
+    for (const auto &var : set.manager->getVariations()) {
+      const std::size_t g =
+          std::find(variationNames.begin(), variationNames.end(), var.name) -
+          variationNames.begin();
+      blocks.push_back(1 + 2 * g);
+      blocks.push_back(2 + 2 * g);
+    }
+    const float threshold = set.ptThreshold;
+    const std::string owner = set.manager->type();
+    const std::string direction =
+        met_m.directionColumn(*dataManager_m, set.manager->getPhiColumn());
+    dataManager_m->setDataFrame(dataManager_m->getDataFrame().Redefine(
+        xyCol,
+        [blocks, threshold, nBlocks, owner](RVec<float> xy, const RVec<float> &dir,
+                                            const RVec<Float_t> &pack) {
+          const std::size_t n = dir.size() / 2;
+          if (pack.size() != (2 + blocks.size()) * n)
+            throw std::runtime_error(
+                "ObjectEnergyCorrectionPass: pT columns of " + owner +
+                " differ in length from its phi column");
+          const Float_t *ref = pack.data();
+          const Float_t *nominal = ref + n;
+          for (std::size_t i = 0; i < n; ++i) {
+            if (!(ref[i] > threshold))
+              continue;
+            const float c = dir[2 * i];
+            const float s = dir[2 * i + 1];
+            // The nominal shift applies to every block; a variation adds its
+            // difference to the nominal to its own block.
+            const float dNominal = nominal[i] - ref[i];
+            if (dNominal != 0.0f) {
+              for (std::size_t k = 0; k < nBlocks; ++k) {
+                xy[2 * k]     -= dNominal * c;
+                xy[2 * k + 1] -= dNominal * s;
+              }
+            }
+            for (std::size_t v = 0; v < blocks.size(); ++v) {
+              const float dVaried = nominal[(1 + v) * n + i] - nominal[i];
+              if (dVaried != 0.0f) {
+                xy[2 * blocks[v]]     -= dVaried * c;
+                xy[2 * blocks[v] + 1] -= dVaried * s;
+              }
+            }
+          }
+          return xy;
+        },
+        {xyCol, direction, packColumns_m[j]}));
+  }
+
+  // MET pT and φ of every block.
+  for (std::size_t k = 0; k < nBlocks; ++k) {
+    const std::string suffix =
+        k == 0 ? std::string()
+               : "_" + variationNames[(k - 1) / 2] + (k % 2 == 1 ? "Up" : "Down");
+    const std::string ptCol = output.outputMETPtColumn + suffix;
+    const std::string phiCol = output.outputMETPhiColumn + suffix;
+    dataManager_m->updateDataFrame(
+        dataManager_m->defineColumn(
+            dataManager_m->getDataFrame(), ptCol,
+            [k](const RVec<float> &xy) -> Float_t {
+              return std::sqrt(xy[2 * k] * xy[2 * k] + xy[2 * k + 1] * xy[2 * k + 1]);
+            },
+            {xyCol}),
+        {ptCol});
+    dataManager_m->updateDataFrame(
+        dataManager_m->defineColumn(
+            dataManager_m->getDataFrame(), phiCol,
+            [k](const RVec<float> &xy) -> Float_t {
+              return std::atan2(xy[2 * k + 1], xy[2 * k]);
+            },
+            {xyCol}),
+        {phiCol});
+  }
+
+  for (const auto &name : variationNames) {
+    systematicManager_m->registerVariationColumns(
+        output.outputMETPtColumn, name, output.outputMETPtColumn + "_" + name + "Up",
+        output.outputMETPtColumn + "_" + name + "Down");
+    systematicManager_m->registerVariationColumns(
+        output.outputMETPhiColumn, name, output.outputMETPhiColumn + "_" + name + "Up",
+        output.outputMETPhiColumn + "_" + name + "Down");
+  }
+}
+
+// ---------------------------------------------------------------------------
+// Metadata and provenance
+// ---------------------------------------------------------------------------
+
+void ObjectEnergyCorrectionPass::reportMetadata() {
+  if (!logger_m)
+    return;
+  std::ostringstream ss;
+  ss << type() << ": configuration summary\n";
+  ss << "  Object sets (" << objectSets_m.size() << "):\n";
+  for (const auto &set : objectSets_m) {
+    ss << "    " << set.manager->type() << ": " << set.referencePtColumn
+       << " -> " << set.correctedPtColumn << " ("
+       << set.manager->getVariations().size() << " variations, pT > "
+       << set.ptThreshold << ")\n";
+  }
+  const auto names = getVariationNames();
+  ss << "  Combined MET variations (" << names.size() << ")\n";
+  logger_m->log(ILogger::Level::Info, ss.str());
+}
+
+std::unordered_map<std::string, std::string>
+ObjectEnergyCorrectionPass::collectProvenanceEntries() const {
+  std::unordered_map<std::string, std::string> entries;
+  std::ostringstream sets;
+  for (std::size_t i = 0; i < objectSets_m.size(); ++i) {
+    if (i > 0) sets << ',';
+    sets << objectSets_m[i].manager->type() << ':'
+         << objectSets_m[i].referencePtColumn << "->"
+         << objectSets_m[i].correctedPtColumn;
+  }
+  entries["object_sets"] = sets.str();
+  std::ostringstream names;
+  const auto variationNames = getVariationNames();
+  for (std::size_t i = 0; i < variationNames.size(); ++i) {
+    if (i > 0) names << ',';
+    names << variationNames[i];
+  }
+  entries["met_variations"] = names.str();
+  return entries;
+}
@@ -0,0 +1,159 @@
+#ifndef OBJECTENERGYCORRECTIONPASS_H_INCLUDED
+#define OBJECTENERGYCORRECTIONPASS_H_INCLUDED
+
+#include <METPropagator.h>
+#include <ObjectEnergyManagerBase.h>
+#include <api/IPluggableManager.h>
+#include <api/IConfigurationProvider.h>
+#include <api/IDataFrameProvider.h>
+#include <api/ILogger.h>
+#include <api/ISystematicManager.h>
+#include <api/ManagerContext.h>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class Analyzer;
+
+/**
+ * @class ObjectEnergyCorrectionPass
+ * @brief Runs several ObjectEnergyManagerBase managers together and
+ *        propagates all of their corrections into MET at once.
+ *
+ * With one manager per object type, every manager propagates its own
+ * nominal correction and each of its variations into MET: one pass over the
+ * objects and one MET-pT/φ pair per variation, chained from one object type
+ * to the next.  This plugin instead defines, per output MET, one
+ * variation-major column with the MET {x, y} of the nominal and of every
+ * variation of every manager:
+ * @code
+ *   MET_xy[k] = MET_xy_base − Σ_types Σ_i (pt_k,i − refPt_i)·(cos φ_i, sin φ_i)
+ * @endcode
+ * where @c pt_k is the variation's pT column for the managers that have
+ * variation @c k and the corrected nominal pT for the others.  Each object
+ * type adds its terms for all variations in one pass over its objects,
+ * reading the object directions and base MET vector from the columns
+ * METPropagator shares with the managers.  The output MET pT/φ of each
+ * variation are slices of that column, registered as the variations of the
+ * nominal output with the systematic manager.  Variations with the same
+ * name in several managers are treated as fully correlated.  As in
+ * ObjectEnergyManagerBase::propagateMET(), the pT threshold of an object
+ * set is tested on its reference pT, so an object enters MET for the
+ * nominal and every variation alike.
+ *
+ * execute() first executes the managers (their corrections, smearing and
+ * collection outputs, unchanged; a manager executes only once), so the pass
+ * can be registered before or after them.
+ *
+ * @code
+ *   auto ele = ElectronEnergyScaleManager::create(*analyzer);
+ *   auto pho = PhotonEnergyScaleManager::create(*analyzer);
+ *   // ... corrections and variations as usual, without propagateMET() ...
+ *   auto pass = ObjectEnergyCorrectionPass::create(*analyzer);
+ *   pass->addObjects(ele, "Electron_pt_corr");
+ *   pass->addObjects(pho, "Photon_pt_corr");
+ *   pass->propagateMET("MET_pt", "MET_phi", "MET_pt_egcorr", "MET_phi_egcorr");
+ * @endcode
+ */
+class ObjectEnergyCorrectionPass : public IPluggableManager {
+public:
+  // -------------------------------------------------------------------------
+  // Factory: create, register with an Analyzer, and return as shared_ptr.
+  // -------------------------------------------------------------------------
+  static std::shared_ptr<ObjectEnergyCorrectionPass> create(
+      Analyzer &an, const std::string &role = "objectEnergyCorrectionPass");
+
+  /**
+   * @brief Add the objects corrected by @p manager.
+   *
+   * @param manager            Manager whose setObjectColumns() gives the φ
+   *                           column and, by default, the reference pT.
+   * @param correctedPtColumn  Nominal corrected pT column; the variations
+   *                           of @p manager (getVariations()) are read at
+   *                           execute() time.
+   * @param ptThreshold        Only objects with reference pT above this
+   *                           value enter MET (default: all).
+   * @param referencePtColumn  pT the MET was computed with; defaults to
+   *                           the manager's input pT column.
+   *
+   * @throws std::invalid_argument if @p manager is null or
+   *         @p correctedPtColumn is empty.
+   */
+  void addObjects(std::shared_ptr<ObjectEnergyManagerBase> manager,
+                  const std::string &correctedPtColumn,
+                  float ptThreshold = 0.0f,
+                  const std::string &referencePtColumn = "");
+
+  /**
+   * @brief Schedule a combined MET output.
+   *
+   * Variation outputs are named @c outputMETPtColumn_<name>Up/Down (and
+   * likewise for φ).
+   *
+   * @throws std::invalid_argument if any column name is empty.
+   */
+  void propagateMET(const std::string &baseMETPtColumn,
+                    const std::string &baseMETPhiColumn,
+                    const std::string &outputMETPtColumn,
+                    const std::string &outputMETPhiColumn);
+
+  /// Variation names of the combined MET, in bundle order (after nominal).
+  std::vector<std::string> getVariationNames() const;
+
+  // -------------------------------------------------------------------------
+  // IPluggableManager interface
+  // -------------------------------------------------------------------------
+
+  std::string type() const override { return "ObjectEnergyCorrectionPass"; }
+
+  void setContext(ManagerContext &ctx) override;
+  void setupFromConfigFile() override {}
+
+  /**
+   * @brief Execute the managers, then define every scheduled MET output.
+   *
+   * @throws std::runtime_error if the context is not set, or if a manager
+   *         has no object φ column.
+   */
+  void execute() override;
+
+  void finalize() override {}
+  void reportMetadata() override;
+
+  std::unordered_map<std::string, std::string>
+  collectProvenanceEntries() const override;
+
+private:
+  struct ObjectSet {
+    std::shared_ptr<ObjectEnergyManagerBase> manager;
+    std::string correctedPtColumn;
+    std::string referencePtColumn;
+    float ptThreshold = 0.0f;
+  };
+
+  struct METOutput {
+    std::string baseMETPtColumn;
+    std::string baseMETPhiColumn;
+    std::string outputMETPtColumn;
+    std::string outputMETPhiColumn;
+  };
+
+  /// Define one combined MET output.
+  void defineMET(const METOutput &output,
+                 const std::vector<std::string> &variationNames);
+
+  std::vector<ObjectSet> objectSets_m;
+  std::vector<METOutput> metOutputs_m;
+  /// Pack column of each object set ({ref, nominal, up1, down1, ...}).
+  std::vector<std::string> packColumns_m;
+  /// Object direction and base MET vector columns.
+  METPropagator met_m{"_objcorr_"};
+
+  IDataFrameProvider *dataManager_m = nullptr;
+  ISystematicManager *systematicManager_m = nullptr;
+  ILogger *logger_m = nullptr;
+  bool executionPending_m = false;
+};
+
+#endif // OBJECTENERGYCORRECTIONPASS_H_INCLUDED
@@ -0,0 +1,101 @@
+#include <METPropagator.h>
+#include <ROOT/RVec.hxx>
+
+#include <cmath>
+
+METPropagator::METPropagator(std::string prefix) : prefix_m(std::move(prefix)) {}
+
+void METPropagator::define(IDataFrameProvider &dm, const std::string &basePtColumn,
+                           const std::string &basePhiColumn,
+                           const std::string &nominalPtColumn,
+                           const std::string &variedPtColumn,
+                           const std::string &objectPhiColumn,
+                           const std::string &outputPtColumn,
+                           const std::string &outputPhiColumn, float ptThreshold) {
+  const std::string baseXY = baseVectorColumn(dm, basePtColumn, basePhiColumn);
+  const std::string direction = directionColumn(dm, objectPhiColumn);
+  const std::string xyCol = prefix_m + "tmp_" + outputPtColumn;
+
+  // Intermediate: RVec<float>{new_MET_x, new_MET_y}.
+  dm.updateDataFrame(
+      dm.defineColumn(
+          dm.getDataFrame(), xyCol,
+          [ptThreshold](const ROOT::VecOps::RVec<float> &base,
+                        const ROOT::VecOps::RVec<Float_t> &nomPt,
+                        const ROOT::VecOps::RVec<Float_t> &varPt,
+                        const ROOT::VecOps::RVec<float> &dir) -> ROOT::VecOps::RVec<float> {
+            float metX = base[0];
+            float metY = base[1];
+            for (std::size_t i = 0; i < nomPt.size(); ++i) {
+              const float dpt = varPt[i] - nomPt[i];
+              if (dpt != 0.0f && nomPt[i] > ptThreshold) {
+                metX -= dpt * dir[2 * i];
+                metY -= dpt * dir[2 * i + 1];
+              }
+            }
+            return ROOT::VecOps::RVec<float>{metX, metY};
+          },
+          {baseXY, nominalPtColumn, variedPtColumn, direction}),
+      {xyCol});
+  dm.updateDataFrame(dm.defineColumn(
+                         dm.getDataFrame(), outputPtColumn,
+                         [](const ROOT::VecOps::RVec<float> &xy) -> Float_t {
+                           return std::sqrt(xy[0] * xy[0] + xy[1] * xy[1]);
+                         },
+                         {xyCol}),
+                     {outputPtColumn});
+  dm.updateDataFrame(dm.defineColumn(
+                         dm.getDataFrame(), outputPhiColumn,
+                         [](const ROOT::VecOps::RVec<float> &xy) -> Float_t {
+                           return std::atan2(xy[1], xy[0]);
+                         },
+                         {xyCol}),
+                     {outputPhiColumn});
+  vectorColumns_m[{outputPtColumn, outputPhiColumn}] = xyCol;
+}
+
+std::string METPropagator::baseVectorColumn(IDataFrameProvider &dm,
+                                            const std::string &ptColumn,
+                                            const std::string &phiColumn) {
+  auto it = vectorColumns_m.find({ptColumn, phiColumn});
+  if (it != vectorColumns_m.end()) {
+    return it->second;
+  }
+  const std::string col = prefix_m + "xy_" + ptColumn + "_" + phiColumn;
+  if (!dm.hasColumn(col)) {
+    dm.updateDataFrame(dm.defineColumn(
+                           dm.getDataFrame(), col,
+                           [](Float_t pt, Float_t phi) -> ROOT::VecOps::RVec<float> {
+                             return {pt * std::cos(phi), pt * std::sin(phi)};
+                           },
+                           {ptColumn, phiColumn}),
+                       {col});
+  }
+  vectorColumns_m[{ptColumn, phiColumn}] = col;
+  return col;
+}
+
+std::string METPropagator::directionColumn(IDataFrameProvider &dm,
+                                           const std::string &phiColumn) {
+  auto it = directionColumns_m.find(phiColumn);
+  if (it != directionColumns_m.end()) {
+    return it->second;
+  }
+  const std::string col = prefix_m + "dir_" + phiColumn;
+  if (!dm.hasColumn(col)) {
+    dm.updateDataFrame(dm.defineColumn(
+                           dm.getDataFrame(), col,
+                           [](const ROOT::VecOps::RVec<Float_t> &phi) {
+                             ROOT::VecOps::RVec<float> dir(2 * phi.size());
+                             for (std::size_t i = 0; i < phi.size(); ++i) {
+                               dir[2 * i] = std::cos(phi[i]);
+                               dir[2 * i + 1] = std::sin(phi[i]);
+                             }
+                             return dir;
+                           },
+                           {phiColumn}),
+                       {col});
+  }
+  directionColumns_m[phiColumn] = col;
+  return col;
+}
@@ -0,0 +1,60 @@
+#ifndef METPROPAGATOR_H_INCLUDED
+#define METPROPAGATOR_H_INCLUDED
+
+#include <api/IDataFrameProvider.h>
+
+#include <map>
+#include <string>
+#include <utility>
+
+/**
+ * @class METPropagator
+ * @brief Type-1 MET propagation shared by the energy-scale managers.
+ *
+ * Each propagation defines
+ * @code
+ *   MET_xy_out = MET_xy_base − Σ_i (variedPt_i − nominalPt_i)·(cos φ_i, sin φ_i)
+ * @endcode
+ * over the objects with nominal pT above the threshold.  The work that does
+ * not depend on the variation is done once per event and shared:
+ *
+ *  - (cos φ_i, sin φ_i) of the objects is one column per phi column;
+ *  - the base MET vector is one column per base (pT, φ) pair, and when the
+ *    base is the output of an earlier propagation (the nominal MET the
+ *    variations start from) its x/y column is reused directly;
+ *  - objects whose pT the variation leaves unchanged are skipped.
+ *
+ * A variation propagated from the nominal MET with the nominal pT as
+ * reference therefore costs one pass over the objects it changes.
+ */
+class METPropagator {
+public:
+  /// @p prefix names the internal columns (e.g. "_jesmet_").
+  explicit METPropagator(std::string prefix);
+
+  /**
+   * @brief Define @p outputPtColumn and @p outputPhiColumn on the current
+   *        node of @p dm.
+   */
+  void define(IDataFrameProvider &dm, const std::string &basePtColumn,
+              const std::string &basePhiColumn, const std::string &nominalPtColumn,
+              const std::string &variedPtColumn, const std::string &objectPhiColumn,
+              const std::string &outputPtColumn, const std::string &outputPhiColumn,
+              float ptThreshold);
+
+  /// Column with {MET_x, MET_y} of the base MET.
+  std::string baseVectorColumn(IDataFrameProvider &dm, const std::string &ptColumn,
+                               const std::string &phiColumn);
+
+  /// Column with cos φ_i, sin φ_i interleaved per object.
+  std::string directionColumn(IDataFrameProvider &dm, const std::string &phiColumn);
+
+private:
+  std::string prefix_m;
+  /// (MET pT, MET φ) column -> column with its {x, y}.
+  std::map<std::pair<std::string, std::string>, std::string> vectorColumns_m;
+  /// Object φ column -> its direction column.
+  std::map<std::string, std::string> directionColumns_m;
+};
+
+#endif // METPROPAGATOR_H_INCLUDED
@@ -1,4 +1,6 @@
 #include <ObjectEnergyManagerBase.h>
+#include <CounterRng.h>
+#include <METPropagator.h>
 #include <ROOT/RVec.hxx>
 #include <api/ILogger.h>
 #include <algorithm>
@@ -6,7 +8,6 @@
 #include <cmath>
 #include <cstdint>
 #include <functional>
-#include <random>
 #include <sstream>
 #include <stdexcept>
 
@@ -41,6 +42,7 @@ void ObjectEnergyManagerBase::setContext(ManagerContext &ctx) {
   systematicManager_m = &ctx.systematics;
   logger_m           = &ctx.logger;
   metaSink_m         = &ctx.metaSink;
+  models_m           = ctx.models;
 }
 
 // ---------------------------------------------------------------------------
@@ -108,7 +110,7 @@ void ObjectEnergyManagerBase::defineReproducibleGaussian(
   step.lumiColumn   = lumiColumn;
   step.eventColumn  = eventColumn;
   // Hash the salt string at schedule time so the lambda captures only a uint64_t.
-  step.saltHash = std::hash<std::string>{}(salt);
+  step.saltHash = counter_rng::saltKey(salt);
   gaussianColumnSteps_m.push_back(std::move(step));
   executionPending_m = true;
 }
@@ -155,16 +157,30 @@ void ObjectEnergyManagerBase::applyCorrectionlib(
     bool applyToMass, const std::string &inputMassColumn,
     const std::string &outputMassColumn,
     const std::vector<std::string> &inputColumns) {
-  cm.applyCorrectionVec(correctionName, stringArgs, inputColumns);
-
   std::string sfColumn = correctionName;
   for (const auto &arg : stringArgs)
     sfColumn += "_" + arg;
+  defineCorrectionColumn(cm, correctionName, {stringArgs}, inputColumns,
+                         sfColumn);
 
   applyCorrection(inputPtColumn, sfColumn, outputPtColumn, applyToMass,
                   inputMassColumn, outputMassColumn);
 }
 
+void ObjectEnergyManagerBase::defineCorrectionColumn(
+    CorrectionManager &cm, const std::string &correctionName,
+    const std::vector<std::vector<std::string>> &argumentSets,
+    const std::vector<std::string> &inputColumns,
+    const std::string &outputColumn) {
+  if (argumentSets.size() == 1) {
+    cm.applyCorrectionVec(correctionName, argumentSets.front(), inputColumns,
+                          outputColumn);
+    return;
+  }
+  cm.applyCorrectionVecBundle(correctionName, argumentSets, inputColumns,
+                              outputColumn);
+}
+
 // ---------------------------------------------------------------------------
 // Resolution smearing
 // ---------------------------------------------------------------------------
@@ -242,14 +258,46 @@ void ObjectEnergyManagerBase::applySystematicSet(
         type() + "::applySystematicSet: outputPtPrefix must not be empty");
 
   const auto &sources = getSystematicSources(setName);
+  SystematicBundleOptions defaults;
+  defaults.bundleTag = outputPtPrefix;
+  const auto bundle = resolveBundleOptions(defaults, bundleOptions_m, {}, {});
+  if (bundle.mode == SystematicBundleMode::Auto ||
+      bundle.mode == SystematicBundleMode::Required) {
+    BundledSetStep step = makeScaledBundleStep(
+        bundle, inputPtColumn,
+        !applyToMass ? ""
+        : inputMassColumn.empty() ? deriveMassColumnName(inputPtColumn)
+                                  : inputMassColumn);
+
+    std::vector<std::vector<std::string>> argumentSets;
+    for (const auto &source : sources) {
+      const std::string upPtCol  = outputPtPrefix + "_" + source + "_up";
+      const std::string dnPtCol  = outputPtPrefix + "_" + source + "_down";
+      const std::string upMasCol = applyToMass ? deriveMassColumnName(upPtCol) : "";
+      const std::string dnMasCol = applyToMass ? deriveMassColumnName(dnPtCol) : "";
+      argumentSets.push_back({source, "up"});
+      argumentSets.push_back({source, "down"});
+      addScaledBundleSource(step, source, upPtCol, dnPtCol, upMasCol, dnMasCol);
+      // Without fan-out the per-source columns are never defined; the
+      // bundle columns carry the systematic instead (defineScaledBundles).
+      if (step.fanOutOutputs)
+        addVariation(source, upPtCol, dnPtCol, upMasCol, dnMasCol);
+    }
+    defineCorrectionColumn(cm, correctionName, argumentSets, inputColumns,
+                           step.sfBundleColumn);
+    bundledSetSteps_m.push_back(std::move(step));
+    executionPending_m = true;
+    return;
+  }
+
   for (const auto &source : sources) {
     const std::string upPtCol = outputPtPrefix + "_" + source + "_up";
     const std::string dnPtCol = outputPtPrefix + "_" + source + "_down";
 
     const std::string sfUpCol = correctionName + "_" + source + "_up";
     const std::string sfDnCol = correctionName + "_" + source + "_down";
-    cm.applyCorrectionVec(correctionName, {source, "up"},   inputColumns, sfUpCol);
-    cm.applyCorrectionVec(correctionName, {source, "down"}, inputColumns, sfDnCol);
+    defineCorrectionColumn(cm, correctionName, {{source, "up"}},   inputColumns, sfUpCol);
+    defineCorrectionColumn(cm, correctionName, {{source, "down"}}, inputColumns, sfDnCol);
 
     const std::string inMass   = inputMassColumn.empty()
                                      ? deriveMassColumnName(inputPtColumn)
@@ -268,6 +316,16 @@ void ObjectEnergyManagerBase::applySystematicSet(
   }
 }
 
+void ObjectEnergyManagerBase::setSystematicBundleOptions(
+    const SystematicBundleOptions &options) {
+  bundleOptions_m = options;
+}
+
+const SystematicBundleOptions &
+ObjectEnergyManagerBase::getSystematicBundleOptions() const {
+  return bundleOptions_m;
+}
+
 // ---------------------------------------------------------------------------
 // Direct variation registration
 // ---------------------------------------------------------------------------
@@ -453,8 +511,8 @@ void ObjectEnergyManagerBase::execute() {
 
   // 0. Define reproducible per-object Gaussian random columns.
   //    These must be defined before any smearing steps that consume them.
-  //    Each per-object value is seeded by a splitmix64 hash of:
-  //      saltHash ^ run ^ lumi ^ event ^ objectIndex
+  //    The values come from a counter-based generator keyed on
+  //      (saltHash, run, lumi, event, objectIndex)
   //    guaranteeing bit-identical results for any re-run on the same dataset.
   for (const auto &step : gaussianColumnSteps_m) {
     const std::string outCol  = step.outputColumn;
@@ -465,33 +523,14 @@ void ObjectEnergyManagerBase::execute() {
     const uint64_t saltHash   = step.saltHash;
 
     ROOT::RDF::RNode df = dataManager_m->getDataFrame();
-    auto newDf = df.Define(
-        outCol,
+    auto newDf = dataManager_m->defineColumn(
+        df, outCol,
         [saltHash](UInt_t run, UInt_t lumi, ULong64_t event,
                    const ROOT::VecOps::RVec<Float_t> &sizeVec)
             -> ROOT::VecOps::RVec<float> {
-          // Mix run/lumi/event into a per-event seed.
-          // Each constant is a distinct odd 64-bit integer to break symmetry.
-          uint64_t seed = saltHash;
-          seed ^= static_cast<uint64_t>(run)  * 0x9e3779b97f4a7c15ULL;
-          seed ^= static_cast<uint64_t>(lumi) * 0x6c62272e07bb0142ULL;
-          seed ^= static_cast<uint64_t>(event)* 0x517cc1b727220a95ULL;
-
           ROOT::VecOps::RVec<float> result(sizeVec.size());
-          for (std::size_t i = 0; i < sizeVec.size(); ++i) {
-            // Incorporate object index, then finalise with splitmix64
-            // to ensure excellent avalanche and zero-correlation between
-            // adjacent indices.
-            uint64_t h = seed ^ (static_cast<uint64_t>(i) * 0x9e3779b97f4a7c15ULL + 1ULL);
-            h ^= h >> 30;
-            h *= 0xbf58476d1ce4e5b9ULL;
-            h ^= h >> 27;
-            h *= 0x94d049bb133111ebULL;
-            h ^= h >> 31;
-            std::mt19937_64 rng(h);
-            std::normal_distribution<float> dist(0.0f, 1.0f);
-            result[i] = dist(rng);
-          }
+          counter_rng::fillNormals(saltHash, run, lumi, event, result.data(),
+                                   result.size());
           return result;
         },
         {runCol, lumiCol, evtCol, sizeCol});
@@ -505,8 +544,8 @@ void ObjectEnergyManagerBase::execute() {
       const std::string inPt  = step.inputPtColumn;
       const std::string sf    = step.sfColumn;
       const std::string outPt = step.outputPtColumn;
-      auto newDf = df.Define(
-          outPt,
+      auto newDf = dataManager_m->defineColumn(
+          df, outPt,
           [](const ROOT::VecOps::RVec<Float_t> &pt,
              const ROOT::VecOps::RVec<Float_t> &sf) { return pt * sf; },
           {inPt, sf});
@@ -517,8 +556,8 @@ void ObjectEnergyManagerBase::execute() {
       const std::string inMass  = step.inputMassColumn;
       const std::string sf      = step.sfColumn;
       const std::string outMass = step.outputMassColumn;
-      auto newDf = df.Define(
-          outMass,
+      auto newDf = dataManager_m->defineColumn(
+          df, outMass,
           [](const ROOT::VecOps::RVec<Float_t> &mass,
              const ROOT::VecOps::RVec<Float_t> &sf) { return mass * sf; },
           {inMass, sf});
@@ -526,6 +565,17 @@ void ObjectEnergyManagerBase::execute() {
     }
   }
 
+  // 1b. Bundled systematic sets: one pT (and mass) column for all sources,
+  //     {Nominal, S1Up, S1Down, ...} with the input as the Nominal block.
+  for (const auto &step : bundledSetSteps_m) {
+    if (!step.fanOutOutputs &&
+        (!collectionOutputSteps_m.empty() || !metPropagationSteps_m.empty()))
+      throw std::runtime_error(
+          type() + "::execute: collection outputs and MET propagation need the "
+          "per-source columns; enable fanOutOutputs for bundle " + step.ptBundleColumn);
+    defineScaledBundles(*dataManager_m, *systematicManager_m, step);
+  }
+
   // 2. Resolution smearing steps: output_pt = input_pt + sigma × u.
   for (const auto &step : smearingSteps_m) {
     ROOT::RDF::RNode df = dataManager_m->getDataFrame();
@@ -533,8 +583,8 @@ void ObjectEnergyManagerBase::execute() {
     const std::string sigma = step.sigmaColumn;
     const std::string rnd   = step.randomColumn;
     const std::string outPt = step.outputPtColumn;
-    auto newDf = df.Define(
-        outPt,
+    auto newDf = dataManager_m->defineColumn(
+        df, outPt,
         [](const ROOT::VecOps::RVec<Float_t> &pt,
            const ROOT::VecOps::RVec<Float_t> &sig,
            const ROOT::VecOps::RVec<Float_t> &u) { return pt + sig * u; },
@@ -542,67 +592,13 @@ void ObjectEnergyManagerBase::execute() {
     dataManager_m->setDataFrame(newDf);
   }
 
-  // 3. MET propagation steps.
-  //    An intermediate column {MET_x_new, MET_y_new} avoids computing the
-  //    sum twice. The naming uses the output pT column to keep it unique.
+  // 3. MET propagation steps.  Object directions and base MET vectors are
+  //    shared between steps; see METPropagator.
+  METPropagator met("_" + toLower(objectName()) + "met_");
   for (const auto &step : metPropagationSteps_m) {
-    const std::string tmpCol =
-        "_" + toLower(objectName()) + "met_tmp_" + step.outputMETPtColumn;
-    const std::string basePt  = step.baseMETPtColumn;
-    const std::string basePhi = step.baseMETPhiColumn;
-    const std::string nomPt   = step.nominalPtColumn;
-    const std::string varPt   = step.variedPtColumn;
-    const std::string objPhi  = phiColumn_m;
-    const float threshold     = step.ptThreshold;
-
-    // Intermediate: RVec<float>{new_MET_x, new_MET_y}.
-    {
-      ROOT::RDF::RNode df = dataManager_m->getDataFrame();
-      auto newDf = df.Define(
-          tmpCol,
-          [threshold](Float_t baseMETPt, Float_t baseMETPhiArg,
-                      const ROOT::VecOps::RVec<Float_t> &nomObjPt,
-                      const ROOT::VecOps::RVec<Float_t> &varObjPt,
-                      const ROOT::VecOps::RVec<Float_t> &oPhi)
-              -> ROOT::VecOps::RVec<float> {
-            float metX = baseMETPt * std::cos(baseMETPhiArg);
-            float metY = baseMETPt * std::sin(baseMETPhiArg);
-            for (std::size_t i = 0; i < nomObjPt.size(); ++i) {
-              if (nomObjPt[i] > threshold) {
-                float dpt = varObjPt[i] - nomObjPt[i];
-                metX -= dpt * std::cos(oPhi[i]);
-                metY -= dpt * std::sin(oPhi[i]);
-              }
-            }
-            return ROOT::VecOps::RVec<float>{metX, metY};
-          },
-          {basePt, basePhi, nomPt, varPt, objPhi});
-      dataManager_m->setDataFrame(newDf);
-    }
-    // Output MET pT.
-    {
-      ROOT::RDF::RNode df = dataManager_m->getDataFrame();
-      const std::string outPt = step.outputMETPtColumn;
-      auto newDf = df.Define(
-          outPt,
-          [](const ROOT::VecOps::RVec<float> &xy) -> Float_t {
-            return std::sqrt(xy[0] * xy[0] + xy[1] * xy[1]);
-          },
-          {tmpCol});
-      dataManager_m->setDataFrame(newDf);
-    }
-    // Output MET phi.
-    {
-      ROOT::RDF::RNode df = dataManager_m->getDataFrame();
-      const std::string outPhi = step.outputMETPhiColumn;
-      auto newDf = df.Define(
-          outPhi,
-          [](const ROOT::VecOps::RVec<float> &xy) -> Float_t {
-            return std::atan2(xy[1], xy[0]);
-          },
-          {tmpCol});
-      dataManager_m->setDataFrame(newDf);
-    }
+    met.define(*dataManager_m, step.baseMETPtColumn, step.baseMETPhiColumn,
+               step.nominalPtColumn, step.variedPtColumn, phiColumn_m,
+               step.outputMETPtColumn, step.outputMETPhiColumn, step.ptThreshold);
   }
 
   // 4. Register explicit variation mappings for corrected collection inputs.
@@ -678,8 +674,8 @@ void ObjectEnergyManagerBase::execute() {
 
       if (upCol != sourceUpCol) {
         ROOT::RDF::RNode df = dataManager_m->getDataFrame();
-        auto newDf = df.Define(
-            upCol,
+        auto newDf = dataManager_m->defineColumn(
+            df, upCol,
             [](const PhysicsObjectCollection &col) -> PhysicsObjectCollection {
               return col;
             },
@@ -688,8 +684,8 @@ void ObjectEnergyManagerBase::execute() {
       }
       if (dnCol != sourceDnCol) {
         ROOT::RDF::RNode df = dataManager_m->getDataFrame();
-        auto newDf = df.Define(
-            dnCol,
+        auto newDf = dataManager_m->defineColumn(
+            df, dnCol,
             [](const PhysicsObjectCollection &col) -> PhysicsObjectCollection {
               return col;
             },
@@ -707,48 +703,45 @@ void ObjectEnergyManagerBase::execute() {
 
     // Build PhysicsObjectVariationMap if requested.
     if (!mapCol.empty()) {
+      // Slot 0 is "nominal", followed by the up/down collections of each
+      // variation; the name table is shared by the maps of all events.
+      std::vector<std::string> keyNames = {"nominal"};
+      for (const auto &name : varNames) {
+        keyNames.push_back(name + "Up");
+        keyNames.push_back(name + "Down");
+      }
+      const auto keys =
+          std::make_shared<const PhysicsObjectVariationMap::Keys>(keyNames);
+
       {
         ROOT::RDF::RNode df = dataManager_m->getDataFrame();
-        auto newDf = df.Define(
-            mapCol,
-            [](const PhysicsObjectCollection &nominalCol)
+        auto newDf = dataManager_m->defineColumn(
+            df, mapCol,
+            [keys](const PhysicsObjectCollection &nominalCol)
                 -> PhysicsObjectVariationMap {
-              PhysicsObjectVariationMap m;
-              m.emplace("nominal", nominalCol);
+              PhysicsObjectVariationMap m(keys);
+              m.set(0, nominalCol);
               return m;
             },
             {nomCol});
         dataManager_m->setDataFrame(newDf);
       }
       for (std::size_t i = 0; i < varNames.size(); ++i) {
-        const std::string keyUp = varNames[i] + "Up";
-        const std::string keyDn = varNames[i] + "Down";
-        {
-          ROOT::RDF::RNode df = dataManager_m->getDataFrame();
-          auto newDf = df.Redefine(
-              mapCol,
-              [keyUp](PhysicsObjectVariationMap m,
-                      const PhysicsObjectCollection &upCol)
-                  -> PhysicsObjectVariationMap {
-                m.emplace(keyUp, upCol);
-                return m;
-              },
-              {mapCol, upColNames[i]});
-          dataManager_m->setDataFrame(newDf);
-        }
-        {
-          ROOT::RDF::RNode df = dataManager_m->getDataFrame();
-          auto newDf = df.Redefine(
-              mapCol,
-              [keyDn](PhysicsObjectVariationMap m,
-                      const PhysicsObjectCollection &dnCol)
-                  -> PhysicsObjectVariationMap {
-                m.emplace(keyDn, dnCol);
-                return m;
-              },
-              {mapCol, dnColNames[i]});
-          dataManager_m->setDataFrame(newDf);
-        }
+        const std::size_t slotUp = keys->slot(varNames[i] + "Up");
+        const std::size_t slotDn = keys->slot(varNames[i] + "Down");
+        ROOT::RDF::RNode df = dataManager_m->getDataFrame();
+        auto newDf = df.Redefine(
+            mapCol,
+            [slotUp, slotDn](PhysicsObjectVariationMap m,
+                             const PhysicsObjectCollection &upCol,
+                             const PhysicsObjectCollection &dnCol)
+                -> PhysicsObjectVariationMap {
+              m.set(slotUp, upCol);
+              m.set(slotDn, dnCol);
+              return m;
+            },
+            {mapCol, upColNames[i], dnColNames[i]});
+        dataManager_m->setDataFrame(newDf);
       }
     }
   }
@@ -766,6 +759,7 @@ void ObjectEnergyManagerBase::execute() {
 
   gaussianColumnSteps_m.clear();
   correctionSteps_m.clear();
+  bundledSetSteps_m.clear();
   smearingSteps_m.clear();
   metPropagationSteps_m.clear();
   collectionOutputSteps_m.clear();
@@ -807,6 +801,14 @@ void ObjectEnergyManagerBase::reportMetadata() {
     }
   }
 
+  if (!bundledSetSteps_m.empty()) {
+    ss << "  Bundled systematic sets (" << bundledSetSteps_m.size() << "):\n";
+    for (const auto &step : bundledSetSteps_m)
+      ss << "    " << step.inputPtColumn << " x " << step.sfBundleColumn
+         << " -> " << step.ptBundleColumn << " ("
+         << step.variationLabels.size() << " variations)\n";
+  }
+
   if (!smearingSteps_m.empty()) {
     ss << "  Resolution smearing steps (" << smearingSteps_m.size() << "):\n";
     for (const auto &step : smearingSteps_m)
@@ -899,6 +901,17 @@ ObjectEnergyManagerBase::collectProvenanceEntries() const {
     entries["correction_steps"] = ss.str();
   }
 
+  if (!bundledSetSteps_m.empty()) {
+    std::ostringstream ss;
+    for (std::size_t i = 0; i < bundledSetSteps_m.size(); ++i) {
+      if (i > 0) ss << ',';
+      ss << bundledSetSteps_m[i].inputPtColumn
+         << "->" << bundledSetSteps_m[i].ptBundleColumn
+         << "(sf:" << bundledSetSteps_m[i].sfBundleColumn << ')';
+    }
+    entries["bundled_set_steps"] = ss.str();
+  }
+
   if (!smearingSteps_m.empty()) {
     std::ostringstream ss;
     for (std::size_t i = 0; i < smearingSteps_m.size(); ++i) {
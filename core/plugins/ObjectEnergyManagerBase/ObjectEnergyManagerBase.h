@@ -2,7 +2,9 @@
 #define OBJECTENERGYMANAGERBASE_H_INCLUDED
 
 #include <CorrectionManager.h>
+#include <ModelRegistry.h>
 #include <PhysicsObjectCollection.h>
+#include <SystematicBundle.h>
 #include <api/IPluggableManager.h>
 #include <api/IConfigurationProvider.h>
 #include <api/IDataFrameProvider.h>
@@ -189,12 +191,12 @@ public:
    *        values are fully determined by the event identity.
    *
    * Running the same analysis twice on the same dataset will produce
-   * identical smearing because the per-object seed is derived entirely from
-   * event-level quantities:
-   * @code
-   *   seed = splitmix64( hash(run, lumi, event) XOR saltHash XOR objIndex )
-   * @endcode
-   * where @c saltHash = std::hash<std::string>{}(salt).
+   * identical smearing because each value is a pure function of the event
+   * identity: a Philox4x32-10 counter-based generator (CounterRng.h) keyed
+   * on the FNV-1a hash of @p salt, with counter (object block, event, lumi,
+   * run), yields the normals of a whole collection in one batch.  No
+   * generator is seeded per event, and the value of object @c i does not
+   * depend on the thread count or on the size of the collection.
    *
    * The output column is a @c RVec<float> of the same length as
    * @p sizeColumn.  It is defined in execute() before any correction or
@@ -245,6 +247,16 @@ public:
    *  2. Evaluates correctionlib with args @c {S,"down"} → @c outputPtPrefix_S_down.
    *  3. Calls addVariation(S, up, down).
    *
+   * When systematic bundling is enabled (setSystematicBundleOptions()), all
+   * sources are instead evaluated in one correctionlib pass into a single
+   * variation-major scale-factor bundle, and execute() defines one pT bundle
+   * (and one mass bundle if @p applyToMass) with layout
+   * @c {Nominal, S1Up, S1Down, ...}, where the Nominal block is
+   * @p inputPtColumn.  The pT bundle is registered for @p inputPtColumn via
+   * ISystematicManager::registerVariationBundle().  The per-source
+   * @c outputPtPrefix_S_up/down columns are defined as slices of the bundle
+   * only when @c fanOutOutputs is set.
+   *
    * @param applyToMass     Also define corrected-mass columns (default: false).
    * @param inputMassColumn Explicit input mass column; auto-derived if empty.
    *
@@ -260,6 +272,23 @@ public:
                           const std::vector<std::string> &inputColumns = {},
                           const std::string &inputMassColumn = "");
 
+  /**
+   * @brief Configure variation-major bundling for applySystematicSet().
+   *
+   * @c mode Auto or Required enables bundling; Off or Inherit keeps one
+   * column per source and direction.  @c bundleTag names the bundle columns
+   * (@c makeBundleColumnName(tag, "pt"), defaulting to the output pT
+   * prefix), and @c fanOutOutputs controls whether the per-source columns
+   * are still defined.  Collection outputs and MET propagation read the
+   * per-source columns and therefore need @c fanOutOutputs.
+   *
+   * Applies to applySystematicSet() calls made after this call.
+   */
+  void setSystematicBundleOptions(const SystematicBundleOptions &options);
+
+  /// Bundling options set by setSystematicBundleOptions().
+  const SystematicBundleOptions &getSystematicBundleOptions() const;
+
   // -------------------------------------------------------------------------
   // Direct variation registration
   // -------------------------------------------------------------------------
@@ -290,6 +319,11 @@ public:
    * @endcode
    * where the sum runs over all objects with nominal pT > @p ptThreshold.
    *
+   * The steps share the object directions and base MET vectors
+   * (METPropagator): propagate each variation from the nominal output MET
+   * with the nominal pT as reference, and it only sums the objects the
+   * variation changes.
+   *
    * @param baseMETPtColumn    Input scalar MET-pT column (Float_t).
    * @param baseMETPhiColumn   Input scalar MET-φ column (Float_t).
    * @param nominalPtColumn    Nominal per-object pT column (RVec<Float_t>).
@@ -408,6 +442,11 @@ public:
   collectProvenanceEntries() const override;
 
 protected:
+  /// Registry for loading shared correction sets.
+  ModelRegistry &models() const {
+    return models_m ? *models_m : ModelRegistry::instance();
+  }
+
   /**
    * @brief Return the physics-object name used in error messages and
    *        provenance keys (e.g. "Electron", "Photon", "Tau", "Muon").
@@ -435,9 +474,27 @@ protected:
   virtual void appendObjectProvenanceEntries(
       std::unordered_map<std::string, std::string> &entries) const;
 
+  /**
+   * @brief Define the per-object scale-factor column of a correctionlib
+   *        correction for applyCorrectionlib() and applySystematicSet().
+   *
+   * With one argument set @p outputColumn holds one SF per object; with
+   * several it is a variation-major bundle (entries [k·n, (k+1)·n) for set
+   * k).  The default evaluates through CorrectionManager's vector path;
+   * managers with a dedicated kernel for their input layout override it.
+   */
+  virtual void defineCorrectionColumn(
+      CorrectionManager &cm, const std::string &correctionName,
+      const std::vector<std::vector<std::string>> &argumentSets,
+      const std::vector<std::string> &inputColumns,
+      const std::string &outputColumn);
+
   /// Access the current dataframe provider from derived managers.
   IDataFrameProvider *getDataFrameProvider() const { return dataManager_m; }
 
+  /// Access the systematic manager from derived managers.
+  ISystematicManager *getSystematicManager() const { return systematicManager_m; }
+
   /// Convenience wrapper for reading the current dataframe from derived managers.
   ROOT::RDF::RNode getCurrentDataFrame() const { return dataManager_m->getDataFrame(); }
 
@@ -483,6 +540,11 @@ private:
   };
   std::vector<CorrectionStep> correctionSteps_m;
 
+  // ---- Bundled systematic set steps ---------------------------------------
+  using BundledSetStep = ScaledBundleStep;
+  std::vector<BundledSetStep> bundledSetSteps_m;
+  SystematicBundleOptions bundleOptions_m;
+
   // ---- Resolution smearing steps ------------------------------------------
   struct SmearingStep {
     std::string inputPtColumn;
@@ -533,6 +595,7 @@ private:
   ISystematicManager     *systematicManager_m = nullptr;
   ILogger                *logger_m = nullptr;
   IOutputSink            *metaSink_m = nullptr;
+  ModelRegistry          *models_m = nullptr;
   bool executionPending_m = false;
 };
 
@@ -1,15 +1,31 @@
 #include <OnnxManager.h>
+#include <AsyncLogger.h>
+#include <ModelOutputVariations.h>
 #include <SystematicBundle.h>
 #include <analyzer.h>
 #include <api/IConfigurationProvider.h>
 #include <api/IDataFrameProvider.h>
 #include <api/ILogger.h>
 #include <api/ISystematicManager.h>
+#include <ProvenanceService.h>
+#include <RowBatcher.h>
+
+#include <TROOT.h>
 
 #include <algorithm>
+#include <atomic>
 #include <cctype>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <functional>
+#include <future>
+#include <list>
 #include <numeric>
 #include <sstream>
+#include <unistd.h>
+#include <utility>
 
 namespace {
 std::string trim(const std::string &value) {
@@ -65,6 +81,68 @@ SystematicBundleMode parseBundleMode(const std::string &rawValue,
                            rawValue + "' for model '" + modelName + "'.");
 }
 
+bool parseBoolOption(const std::string &rawValue, const std::string &key,
+                     const std::string &owner) {
+  const auto normalized = toLowerCopy(trim(rawValue));
+  if (normalized == "true" || normalized == "1" || normalized == "on") {
+    return true;
+  }
+  if (normalized == "false" || normalized == "0" || normalized == "off") {
+    return false;
+  }
+  throw std::runtime_error("OnnxManager: Invalid " + key + " value '" +
+                           rawValue + "' for " + owner + ".");
+}
+
+int parseThreadCount(const std::string &rawValue, const std::string &key,
+                     const std::string &owner) {
+  int count = 0;
+  try {
+    count = std::stoi(rawValue);
+  } catch (const std::exception &e) {
+    throw std::runtime_error("OnnxManager: Invalid " + key + " value '" +
+                             rawValue + "' for " + owner + ": " + e.what());
+  }
+  if (count < 0) {
+    throw std::runtime_error("OnnxManager: Invalid " + key + " value '" +
+                             rawValue + "' for " + owner +
+                             ": thread count must be non-negative");
+  }
+  return count;
+}
+
+GraphOptimizationLevel parseGraphOptimization(const std::string &rawValue,
+                                              const std::string &modelName) {
+  const auto normalized = toLowerCopy(trim(rawValue));
+  if (normalized == "disable" || normalized == "none") {
+    return GraphOptimizationLevel::ORT_DISABLE_ALL;
+  }
+  if (normalized == "basic") {
+    return GraphOptimizationLevel::ORT_ENABLE_BASIC;
+  }
+  if (normalized == "extended") {
+    return GraphOptimizationLevel::ORT_ENABLE_EXTENDED;
+  }
+  if (normalized == "all") {
+    return GraphOptimizationLevel::ORT_ENABLE_ALL;
+  }
+  throw std::runtime_error("OnnxManager: Invalid graphOptimization value '" +
+                           rawValue + "' for model '" + modelName + "'.");
+}
+
+ExecutionMode parseExecutionMode(const std::string &rawValue,
+                                 const std::string &modelName) {
+  const auto normalized = toLowerCopy(trim(rawValue));
+  if (normalized == "sequential") {
+    return ExecutionMode::ORT_SEQUENTIAL;
+  }
+  if (normalized == "parallel") {
+    return ExecutionMode::ORT_PARALLEL;
+  }
+  throw std::runtime_error("OnnxManager: Invalid executionMode value '" +
+                           rawValue + "' for model '" + modelName + "'.");
+}
+
 std::vector<int64_t> parseShape(const std::string &shapeString,
                                 const std::string &modelName,
                                 size_t inputIndex) {
@@ -278,6 +356,8 @@ const Ort::MemoryInfo &cpuMemoryInfo() {
 struct OnnxScratchBuffers {
   std::vector<std::vector<float>> ownedInputs;
   std::vector<Ort::Value> inputTensors;
+  std::vector<std::vector<float>> ownedOutputs;
+  std::vector<Ort::Value> outputTensors;
   std::vector<float> outputs;
 };
 
@@ -313,12 +393,23 @@ const std::vector<float> &runBundledModelOutputs(
         " elements, expected " + std::to_string(expectedInputSize) + ".");
   }
 
+  // Variations whose input block equals the nominal (first) block reuse its
+  // outputs instead of adding a row to the ONNX call.
+  const size_t blockElements = static_cast<size_t>(perVariationInputElements);
   std::vector<size_t> activeIndices;
+  std::vector<size_t> nominalAliases;
   activeIndices.reserve(nVariations);
   for (size_t i = 0; i < nVariations; ++i) {
-    if (activeMask[i]) {
-      activeIndices.push_back(i);
+    if (!activeMask[i]) {
+      continue;
     }
+    if (i > 0 && activeMask[0] &&
+        std::memcmp(inputVector.data() + i * blockElements, inputVector.data(),
+                    blockElements * sizeof(Float_t)) == 0) {
+      nominalAliases.push_back(i);
+      continue;
+    }
+    activeIndices.push_back(i);
   }
 
   if (activeIndices.empty()) {
@@ -413,17 +504,31 @@ const std::vector<float> &runBundledModelOutputs(
       scratch.outputs[outputIndex * nVariations + variationIndex] =
           outputData[row * rowElements];
     }
+    for (const size_t variationIndex : nominalAliases) {
+      scratch.outputs[outputIndex * nVariations + variationIndex] =
+          scratch.outputs[outputIndex * nVariations];
+    }
   }
 
   return scratch.outputs;
 }
 
+/**
+ * @brief Per-event inference on a packed input vector.
+ *
+ * When @p inputVector holds exactly the packed model input, the input
+ * tensors are views of the RVec's contiguous memory and no copy is made;
+ * shorter vectors (padding) are copied into zero-filled scratch buffers.
+ * Outputs with a known shape (@p outputRunShapes non-empty) are written into
+ * pre-allocated per-thread tensors instead of tensors allocated by each Run.
+ */
 const std::vector<float> &runModelOutputs(
   Ort::Session &session,
     const std::vector<std::vector<int64_t>> &inputShapes,
     const std::vector<int64_t> &inputElementCounts,
     const std::vector<const char *> &inputNamePtrs,
     const std::vector<const char *> &outputNamePtrs,
+    const std::vector<std::vector<int64_t>> &outputRunShapes,
     const ROOT::VecOps::RVec<Float_t> &inputVector,
     int64_t totalExpectedElements) {
   if (static_cast<int64_t>(inputVector.size()) > totalExpectedElements) {
@@ -439,9 +544,21 @@ const std::vector<float> &runModelOutputs(
   scratch.inputTensors.clear();
   scratch.inputTensors.reserve(inputShapes.size());
 
+  // ORT does not write to input tensors, so the RVec memory can back them.
+  const bool bindInPlace =
+      static_cast<int64_t>(inputVector.size()) == totalExpectedElements;
   size_t cursor = 0;
   for (size_t i = 0; i < inputShapes.size(); ++i) {
     const int64_t expectedElements = inputElementCounts[i];
+    if (bindInPlace) {
+      scratch.inputTensors.emplace_back(Ort::Value::CreateTensor<float>(
+          memoryInfo, const_cast<float *>(inputVector.data()) + cursor,
+          static_cast<size_t>(expectedElements), inputShapes[i].data(),
+          inputShapes[i].size()));
+      cursor += static_cast<size_t>(expectedElements);
+      continue;
+    }
+
     const size_t available = inputVector.size() - cursor;
     const size_t toCopy =
         std::min<size_t>(available, static_cast<size_t>(expectedElements));
@@ -466,6 +583,36 @@ const std::vector<float> &runModelOutputs(
         inputShapes[i].size()));
   }
 
+  const bool preallocatedOutputs =
+      !outputRunShapes.empty() &&
+      std::none_of(outputRunShapes.begin(), outputRunShapes.end(),
+                   [](const std::vector<int64_t> &shape) { return shape.empty(); });
+  scratch.outputs.resize(outputNamePtrs.size());
+  if (preallocatedOutputs) {
+    if (scratch.ownedOutputs.size() < outputRunShapes.size()) {
+      scratch.ownedOutputs.resize(outputRunShapes.size());
+    }
+    scratch.outputTensors.clear();
+    scratch.outputTensors.reserve(outputRunShapes.size());
+    for (size_t i = 0; i < outputRunShapes.size(); ++i) {
+      const auto &shape = outputRunShapes[i];
+      const auto nElements = static_cast<size_t>(std::accumulate(
+          shape.begin(), shape.end(), int64_t{1}, std::multiplies<int64_t>()));
+      auto &buffer = scratch.ownedOutputs[i];
+      buffer.resize(nElements);
+      scratch.outputTensors.emplace_back(Ort::Value::CreateTensor<float>(
+          memoryInfo, buffer.data(), buffer.size(), shape.data(), shape.size()));
+    }
+    session.Run(Ort::RunOptions{nullptr}, inputNamePtrs.data(),
+                scratch.inputTensors.data(), scratch.inputTensors.size(),
+                outputNamePtrs.data(), scratch.outputTensors.data(),
+                scratch.outputTensors.size());
+    for (size_t i = 0; i < scratch.ownedOutputs.size() && i < scratch.outputs.size(); ++i) {
+      scratch.outputs[i] = scratch.ownedOutputs[i].empty() ? 0.0f : scratch.ownedOutputs[i][0];
+    }
+    return scratch.outputs;
+  }
+
   auto outputTensors = session.Run(
       Ort::RunOptions{nullptr}, inputNamePtrs.data(), scratch.inputTensors.data(),
       scratch.inputTensors.size(), outputNamePtrs.data(), outputNamePtrs.size());
@@ -478,15 +625,258 @@ const std::vector<float> &runModelOutputs(
 
   return scratch.outputs;
 }
+
+/**
+ * @brief Define the packed model input column @p inputColumn.
+ *
+ * A single feature that already is an RVec<float> is aliased instead of
+ * copied by DefineVector, so the inference lambda reads the feature's own
+ * memory.  Scalar features come from the feature block shared with the
+ * other models (IDataFrameProvider::DefineFeatureVector()).
+ */
+void definePackedInput(IDataFrameProvider &dataManager,
+                       ISystematicManager &systematicManager,
+                       const std::string &inputColumn,
+                       const std::vector<std::string> &inputFeatures) {
+  auto df = dataManager.getDataFrame();
+  const auto columns = df.GetColumnNames();
+  if (std::find(columns.begin(), columns.end(), inputColumn) != columns.end()) {
+    return;
+  }
+  if (inputFeatures.size() == 1 &&
+      std::find(columns.begin(), columns.end(), inputFeatures[0]) != columns.end()) {
+    const std::string type = df.GetColumnType(inputFeatures[0]);
+    if (type == "ROOT::VecOps::RVec<float>" || type == "ROOT::VecOps::RVec<Float_t>") {
+      dataManager.setDataFrame(df.Alias(inputColumn, inputFeatures[0]));
+      return;
+    }
+  }
+  dataManager.DefineFeatureVector(inputColumn, inputFeatures, systematicManager);
+}
+
+/**
+ * @brief Batcher evaluating the packed input rows of concurrent slots with
+ *        one ONNX call (``batchSize``).
+ *
+ * The row-major rows of the batch are split into the per-input buffers;
+ * fixed batch dimensions larger than the batch are zero-padded.
+ */
+std::shared_ptr<RowBatcher> makeSharedBatcher(
+    std::shared_ptr<OnnxSessionPool> sessions,
+    std::vector<std::vector<int64_t>> batchInputShapes,
+    std::vector<int64_t> inputRowElementCounts, int64_t paddingSize,
+    std::vector<const char *> inputNamePtrs, std::vector<const char *> outputNamePtrs,
+    const std::string &modelName, std::size_t batchSize, std::size_t nSlots,
+    std::chrono::microseconds timeout) {
+  const auto rowSize = static_cast<std::size_t>(std::accumulate(
+      inputRowElementCounts.begin(), inputRowElementCounts.end(), int64_t{0}));
+  const std::size_t nOutputs = outputNamePtrs.size();
+  auto evaluate = [sessions = std::move(sessions),
+                   batchInputShapes = std::move(batchInputShapes),
+                   inputRowElementCounts = std::move(inputRowElementCounts), paddingSize,
+                   inputNamePtrs = std::move(inputNamePtrs),
+                   outputNamePtrs = std::move(outputNamePtrs), modelName, rowSize,
+                   nOutputs](const float *rows, std::size_t nRows, float *outputs) {
+    const auto &memoryInfo = cpuMemoryInfo();
+    thread_local OnnxScratchBuffers scratch;
+    scratch.ownedInputs.resize(batchInputShapes.size());
+    scratch.inputTensors.clear();
+    std::vector<std::vector<int64_t>> runtimeShapes;
+    runtimeShapes.reserve(batchInputShapes.size());
+    std::size_t offset = 0;
+    for (std::size_t i = 0; i < batchInputShapes.size(); ++i) {
+      runtimeShapes.push_back(resolveRuntimeInputShape(
+          batchInputShapes[i], static_cast<int64_t>(nRows), paddingSize, modelName, i));
+      const auto rowElements = static_cast<std::size_t>(inputRowElementCounts[i]);
+      auto &input = scratch.ownedInputs[i];
+      input.assign(static_cast<std::size_t>(elementCount(runtimeShapes[i], modelName, i)),
+                   0.0f);
+      for (std::size_t row = 0; row < nRows; ++row) {
+        std::copy_n(rows + row * rowSize + offset, rowElements,
+                    input.data() + row * rowElements);
+      }
+      offset += rowElements;
+      scratch.inputTensors.emplace_back(Ort::Value::CreateTensor<float>(
+          memoryInfo, input.data(), input.size(), runtimeShapes[i].data(),
+          runtimeShapes[i].size()));
+    }
+
+    auto outputTensors = sessions->local().Run(
+        Ort::RunOptions{nullptr}, inputNamePtrs.data(), scratch.inputTensors.data(),
+        scratch.inputTensors.size(), outputNamePtrs.data(), outputNamePtrs.size());
+
+    for (std::size_t outputIndex = 0; outputIndex < nOutputs; ++outputIndex) {
+      auto tensorInfo = outputTensors[outputIndex].GetTensorTypeAndShapeInfo();
+      const auto runtimeShape = tensorInfo.GetShape();
+      const int64_t totalElements = tensorInfo.GetElementCount();
+      const int64_t runtimeBatchSize = runtimeShape.empty() ? 1 : runtimeShape[0];
+      if (runtimeBatchSize < static_cast<int64_t>(nRows) ||
+          totalElements % runtimeBatchSize != 0) {
+        throw std::runtime_error("OnnxManager: Batched output shape for model '" +
+                                 modelName + "' output index " +
+                                 std::to_string(outputIndex) +
+                                 " does not match the batch of " +
+                                 std::to_string(nRows) + " rows.");
+      }
+      const int64_t rowElements = totalElements / runtimeBatchSize;
+      const float *outputData = outputTensors[outputIndex].GetTensorData<float>();
+      for (std::size_t row = 0; row < nRows; ++row) {
+        outputs[row * nOutputs + outputIndex] =
+            outputData[static_cast<int64_t>(row) * rowElements];
+      }
+    }
+  };
+  return std::make_shared<RowBatcher>(rowSize, nOutputs, batchSize, nSlots,
+                                      std::move(evaluate), timeout);
+}
+
+/// Session owning a reference to the environment it was created in.
+std::shared_ptr<Ort::Session> makeSession(const std::shared_ptr<Ort::Env> &env,
+                                          const std::string &modelFile,
+                                          const Ort::SessionOptions &options) {
+  auto owner = std::make_shared<std::pair<std::shared_ptr<Ort::Env>, Ort::Session>>(
+      env, Ort::Session(*env, modelFile.c_str(), options));
+  return std::shared_ptr<Ort::Session>(owner, &owner->second);
+}
+
+/// Options for loading a model already optimized with @p options.
+Ort::SessionOptions optimizedModelOptions(const Ort::SessionOptions &options) {
+  Ort::SessionOptions optimized = options.Clone();
+  optimized.SetGraphOptimizationLevel(GraphOptimizationLevel::ORT_DISABLE_ALL);
+  return optimized;
+}
+
+/**
+ * Suffix of a temporary file name that no other process, on this or another
+ * host sharing the directory, and no other thread of this process uses.
+ */
+std::string temporarySuffix() {
+  static std::atomic<unsigned> counter{0};
+  char host[256] = {};
+  if (gethostname(host, sizeof(host) - 1) != 0) {
+    host[0] = '\0';
+  }
+  return ".tmp." + std::string(host) + "." + std::to_string(getpid()) + "." +
+         std::to_string(counter.fetch_add(1));
+}
+
+/**
+ * Run @p session once on zero inputs of @p inputShapes with a dynamic batch
+ * dimension of @p rows, so the first event does not pay for the allocation
+ * of the session's buffers.  Returns false when the inputs are not float
+ * tensors of known shape.
+ */
+bool warmupSession(Ort::Session &session, std::vector<std::vector<int64_t>> inputShapes,
+                   int64_t rows, const std::vector<const char *> &inputNames,
+                   const std::vector<const char *> &outputNames) {
+  const auto &memoryInfo = cpuMemoryInfo();
+  std::vector<std::vector<float>> buffers;
+  std::vector<Ort::Value> inputs;
+  for (std::size_t i = 0; i < inputShapes.size(); ++i) {
+    auto &shape = inputShapes[i];
+    if (!shape.empty() && shape[0] <= 0) {
+      shape[0] = rows;
+    }
+    if (std::any_of(shape.begin(), shape.end(), [](int64_t d) { return d <= 0; }) ||
+        session.GetInputTypeInfo(i).GetTensorTypeAndShapeInfo().GetElementType() !=
+            ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT) {
+      return false;
+    }
+    const auto n = std::accumulate(shape.begin(), shape.end(), int64_t(1),
+                                   std::multiplies<int64_t>());
+    buffers.emplace_back(static_cast<std::size_t>(n), 0.0f);
+    inputs.emplace_back(Ort::Value::CreateTensor<float>(
+        memoryInfo, buffers.back().data(), buffers.back().size(), shape.data(),
+        shape.size()));
+  }
+  session.Run(Ort::RunOptions{nullptr}, inputNames.data(), inputs.data(), inputs.size(),
+              outputNames.data(), outputNames.size());
+  return true;
+}
+
 } // namespace
 
+OnnxSessionPool::OnnxSessionPool(std::shared_ptr<Ort::Session> shared,
+                                 std::shared_ptr<Ort::Env> env,
+                                 std::string modelFile,
+                                 Ort::SessionOptions options, bool perSlot)
+    : shared_m(std::move(shared)), env_m(std::move(env)),
+      modelFile_m(std::move(modelFile)), options_m(std::move(options)),
+      perSlot_m(perSlot) {}
+
+Ort::Session &OnnxSessionPool::local() {
+  if (!perSlot_m) {
+    return *shared_m;
+  }
+  return sessions_m.local([this]() {
+    return std::make_unique<Ort::Session>(*env_m, modelFile_m.c_str(), options_m);
+  });
+}
+
+std::size_t OnnxSessionPool::getSessionCount() const {
+  if (!perSlot_m) {
+    return 1;
+  }
+  return sessions_m.size();
+}
+
 /**
  * @brief Construct a new OnnxManager object
  * @param configProvider Reference to the configuration provider
+ *
+ * With ``onnxGlobalThreadPool=true`` the environment owns one intra-op
+ * thread pool shared by all sessions, sized by ``onnxGlobalIntraOpThreads``
+ * or, by default, ROOT::GetThreadPoolSize(), so ONNX inference and the
+ * RDataFrame slots do not oversubscribe the cores.
+ *
+ * With ``pluginThreadPool=shared`` ROOT's pool is the only one: every session
+ * runs sequentially with one intra-op and one inter-op thread, i.e. on the
+ * slot thread calling it, whatever the per-model thread options say.
  */
 OnnxManager::OnnxManager(IConfigurationProvider const& configProvider) {
+  const std::string globalPool = configProvider.get("onnxGlobalThreadPool");
+  globalThreadPool_m =
+      !globalPool.empty() &&
+      parseBoolOption(globalPool, "onnxGlobalThreadPool", "the main configuration");
+  const std::string pluginPool = configProvider.get("pluginThreadPool");
+  if (!pluginPool.empty() && pluginPool != "shared" && pluginPool != "separate") {
+    throw std::runtime_error("OnnxManager: invalid pluginThreadPool '" + pluginPool +
+                             "' (expected shared or separate)");
+  }
+  sharedRootPool_m = pluginPool == "shared";
+  if (sharedRootPool_m && globalThreadPool_m) {
+    throw std::runtime_error(
+        "OnnxManager: onnxGlobalThreadPool cannot be combined with pluginThreadPool=shared");
+  }
+
   // Initialize ONNX Runtime environment
-  env_m = std::make_shared<Ort::Env>(ORT_LOGGING_LEVEL_WARNING, "RDFAnalyzer");
+  if (globalThreadPool_m) {
+    const std::string intraThreads = configProvider.get("onnxGlobalIntraOpThreads");
+    const std::string interThreads = configProvider.get("onnxGlobalInterOpThreads");
+    const std::string spinning = configProvider.get("onnxAllowSpinning");
+    const int nIntra =
+        intraThreads.empty()
+            ? std::max(1, static_cast<int>(ROOT::GetThreadPoolSize()))
+            : parseThreadCount(intraThreads, "onnxGlobalIntraOpThreads",
+                               "the main configuration");
+    const int nInter =
+        interThreads.empty() ? 1
+                             : parseThreadCount(interThreads, "onnxGlobalInterOpThreads",
+                                                "the main configuration");
+    Ort::ThreadingOptions threadingOptions;
+    threadingOptions.SetGlobalIntraOpNumThreads(nIntra);
+    threadingOptions.SetGlobalInterOpNumThreads(nInter);
+    if (!spinning.empty() &&
+        !parseBoolOption(spinning, "onnxAllowSpinning", "the main configuration")) {
+      threadingOptions.SetGlobalSpinControl(0);
+    }
+    env_m = std::make_shared<Ort::Env>(threadingOptions, ORT_LOGGING_LEVEL_WARNING,
+                                       "RDFAnalyzer");
+    RDF_LOG_INFO << "OnnxManager: global ONNX Runtime thread pool with " << nIntra
+                 << " intra-op and " << nInter << " inter-op thread(s).";
+  } else {
+    env_m = std::make_shared<Ort::Env>(ORT_LOGGING_LEVEL_WARNING, "RDFAnalyzer");
+  }
   registerModels(configProvider);
 }
 
@@ -502,7 +892,8 @@ void OnnxManager::applyModel(const std::string &modelName, const std::string &ou
 
   const auto &inputFeatures = getModelFeatures(modelName);
   const auto &runVar = getRunVar(modelName);
-  const auto &session = this->objects_m.at(modelName);
+  const auto &session = model_sessionPools_m.at(modelName);
+  const auto &outputRunShapes = model_outputRunShapes_m.at(modelName);
   const auto &inputShapes = model_inputShapes_m.at(modelName);
   const auto &inputElementCounts = model_inputElementCounts_m.at(modelName);
   const auto &inputNames = model_inputNames_m.at(modelName);
@@ -589,7 +980,7 @@ void OnnxManager::applyModel(const std::string &modelName, const std::string &ou
             activeMask[i] = runEnabled && selectionEnabled;
           }
           const auto &outputs = runBundledModelOutputs(
-              *session, inputShapes, inputRowElementCounts, paddingSize,
+              session->local(), inputShapes, inputRowElementCounts, paddingSize,
               inputNamePtrs, outputNamePtrs, inputVector, activeMask, -1.0f,
               modelName);
           return ROOT::VecOps::RVec<Float_t>(outputs.begin(), outputs.end());
@@ -609,7 +1000,7 @@ void OnnxManager::applyModel(const std::string &modelName, const std::string &ou
             activeMask[i] = (i < runMask.size()) ? runMask[i] : false;
           }
           const auto &outputs = runBundledModelOutputs(
-              *session, inputShapes, inputRowElementCounts, paddingSize,
+              session->local(), inputShapes, inputRowElementCounts, paddingSize,
               inputNamePtrs, outputNamePtrs, inputVector, activeMask, -1.0f,
               modelName);
           return ROOT::VecOps::RVec<Float_t>(outputs.begin(), outputs.end());
@@ -639,42 +1030,102 @@ void OnnxManager::applyModel(const std::string &modelName, const std::string &ou
   }
 
   // Auto-create packed model input from configured inputVariables for all models.
-  dataManager_m->DefineVector("input_" + modelName, inputFeatures, "Float_t", *systematicManager_m);
+  definePackedInput(*dataManager_m, *systematicManager_m, "input_" + modelName, inputFeatures);
 
   const int64_t totalExpectedElements = std::accumulate(
       inputElementCounts.begin(), inputElementCounts.end(), int64_t{0});
   const size_t numOutputs = outputNames.size();
 
+  // Batching: slots submit their row to one batcher and wait for the batch
+  // they joined, so a single ONNX call serves events from all slots.
+  std::shared_ptr<RowBatcher> batcher;
+  const int64_t batchSize = model_batchSize_m.at(modelName);
+  if (batchSize > 1) {
+    const auto nSlots = static_cast<std::size_t>(dataManager_m->getDataFrame().GetNSlots());
+    batcher = makeSharedBatcher(
+        session, model_batchInputShapes_m.at(modelName),
+        model_inputRowElementCounts_m.at(modelName), paddingSize, inputNamePtrs,
+        outputNamePtrs, modelName, static_cast<std::size_t>(batchSize), nSlots,
+        std::chrono::microseconds(model_sharedBatchTimeoutUs_m.at(modelName)));
+    model_sharedBatchers_m[modelName] = batcher;
+  }
+
+  if (batcher) {
+    const auto &rowElementCounts = model_inputRowElementCounts_m.at(modelName);
+    const auto rowElements = static_cast<std::size_t>(
+        std::accumulate(rowElementCounts.begin(), rowElementCounts.end(), int64_t{0}));
+    auto sharedLambda = [batcher, numOutputs, rowElements, modelName](
+        const ROOT::VecOps::RVec<Float_t> &inputVector,
+        bool runVar, ULong64_t) -> ROOT::VecOps::RVec<Float_t> {
+      if (!runVar) {
+        return ROOT::VecOps::RVec<Float_t>(numOutputs, -1.0f);
+      }
+      if (inputVector.size() > rowElements) {
+        throw std::runtime_error(
+            "OnnxManager: Packed input size exceeds expected ONNX input size for model '" +
+            modelName + "'.");
+      }
+      ROOT::VecOps::RVec<Float_t> outputs(numOutputs);
+      batcher->infer(inputVector.data(), inputVector.size(), outputs.data());
+      return outputs;
+    };
+
+    const std::string sharedColName =
+        (numOutputs == 1) ? "shared_" + modelName + outputSuffix
+                          : modelName + "_outputs" + outputSuffix;
+    defineModelOutput<ROOT::VecOps::RVec<Float_t>>(*dataManager_m, *systematicManager_m,
+                                                   sharedColName, sharedLambda,
+                                                   "input_" + modelName, runVar);
+    if (numOutputs == 1) {
+      auto firstLambda = [](const ROOT::VecOps::RVec<Float_t> &outputs) -> Float_t {
+        return outputs[0];
+      };
+      dataManager_m->Define(modelName + outputSuffix, firstLambda, {sharedColName},
+                            *systematicManager_m);
+    } else {
+      for (size_t i = 0; i < numOutputs; i++) {
+        std::string outputColName = modelName + "_output" + std::to_string(i) + outputSuffix;
+        auto indexLambda = [i](const ROOT::VecOps::RVec<Float_t> &outputs) -> Float_t {
+          return outputs[i];
+        };
+        dataManager_m->Define(outputColName, indexLambda, {sharedColName}, *systematicManager_m);
+      }
+    }
+    return;
+  }
+
   if (numOutputs == 1) {
     auto onnxLambda = [session, inputShapes, inputElementCounts,
-                       inputNamePtrs, outputNamePtrs, totalExpectedElements](
+                       inputNamePtrs, outputNamePtrs, outputRunShapes,
+                       totalExpectedElements](
         const ROOT::VecOps::RVec<Float_t> &inputVector,
-        bool runVar) -> Float_t {
+        bool runVar, ULong64_t) -> Float_t {
       if (!runVar) {
         return -1.0f;
       }
-      return runModelOutputs(*session, inputShapes, inputElementCounts,
-                             inputNamePtrs, outputNamePtrs, inputVector,
+      return runModelOutputs(session->local(), inputShapes, inputElementCounts,
+                             inputNamePtrs, outputNamePtrs, outputRunShapes, inputVector,
                              totalExpectedElements)[0];
     };
 
     std::string outputColName = modelName + outputSuffix;
-    dataManager_m->Define(outputColName, onnxLambda, {"input_" + modelName, runVar}, *systematicManager_m);
+    defineModelOutput<Float_t>(*dataManager_m, *systematicManager_m, outputColName,
+                               onnxLambda, "input_" + modelName, runVar);
 
   } else {
     auto onnxLambdaMulti = [session, inputShapes, inputElementCounts,
-                            inputNamePtrs, outputNamePtrs,
+                            inputNamePtrs, outputNamePtrs, outputRunShapes,
                             numOutputs, totalExpectedElements](
         const ROOT::VecOps::RVec<Float_t> &inputVector,
-        bool runVar) -> ROOT::VecOps::RVec<Float_t> {
+        bool runVar, ULong64_t) -> ROOT::VecOps::RVec<Float_t> {
       ROOT::VecOps::RVec<Float_t> outputs(numOutputs, -1.0f);
 
       if (!runVar) {
         return outputs;
       }
       const auto modelOutputs =
-          runModelOutputs(*session, inputShapes, inputElementCounts,
-                          inputNamePtrs, outputNamePtrs, inputVector,
+          runModelOutputs(session->local(), inputShapes, inputElementCounts,
+                          inputNamePtrs, outputNamePtrs, outputRunShapes, inputVector,
                           totalExpectedElements);
       for (size_t i = 0; i < numOutputs; i++) {
         outputs[i] = modelOutputs[i];
@@ -684,7 +1135,9 @@ void OnnxManager::applyModel(const std::string &modelName, const std::string &ou
     };
 
     std::string multiOutputColName = modelName + "_outputs" + outputSuffix;
-    dataManager_m->Define(multiOutputColName, onnxLambdaMulti, {"input_" + modelName, runVar}, *systematicManager_m);
+    defineModelOutput<ROOT::VecOps::RVec<Float_t>>(*dataManager_m, *systematicManager_m,
+                                                   multiOutputColName, onnxLambdaMulti,
+                                                   "input_" + modelName, runVar);
 
     for (size_t i = 0; i < numOutputs; i++) {
       std::string outputColName = modelName + "_output" + std::to_string(i) + outputSuffix;
@@ -709,7 +1162,8 @@ void OnnxManager::applyAllModels(const std::string &outputSuffix) {
 Float_t OnnxManager::runScalarModel(
     const std::string &modelName,
     const ROOT::VecOps::RVec<Float_t> &inputVector) const {
-  const auto &session = this->objects_m.at(modelName);
+  const auto &session = model_sessionPools_m.at(modelName);
+  const auto &outputRunShapes = model_outputRunShapes_m.at(modelName);
   const auto &inputShapes = model_inputShapes_m.at(modelName);
   const auto &inputElementCounts = model_inputElementCounts_m.at(modelName);
   const auto &inputNamePtrs = model_inputNamePtrs_m.at(modelName);
@@ -722,8 +1176,8 @@ Float_t OnnxManager::runScalarModel(
 
   const int64_t totalExpectedElements = std::accumulate(
       inputElementCounts.begin(), inputElementCounts.end(), int64_t{0});
-  return runModelOutputs(*session, inputShapes, inputElementCounts,
-                         inputNamePtrs, outputNamePtrs, inputVector,
+  return runModelOutputs(session->local(), inputShapes, inputElementCounts,
+                         inputNamePtrs, outputNamePtrs, outputRunShapes, inputVector,
                          totalExpectedElements)[0];
 }
 
@@ -832,6 +1286,59 @@ bool OnnxManager::getUseCuda(const std::string &modelName) const {
   return false;
 }
 
+/**
+ * @brief Get the inference batch size for an ONNX model (``batchSize``)
+ * @param modelName Name of the model
+ * @return Batch size (0 if batching is disabled)
+ */
+int64_t OnnxManager::getBatchSize(const std::string &modelName) const {
+  auto it = model_batchSize_m.find(modelName);
+  if (it != model_batchSize_m.end()) {
+    return it->second;
+  }
+  return 0;
+}
+
+/**
+ * @brief Get whether an ONNX model was warmed up at load time
+ * @param modelName Name of the model
+ * @return true if the warmup call succeeded, false otherwise
+ */
+bool OnnxManager::getWarmedUp(const std::string &modelName) const {
+  auto it = model_warmedUp_m.find(modelName);
+  if (it != model_warmedUp_m.end()) {
+    return it->second;
+  }
+  return false;
+}
+
+/**
+ * @brief Get the number of shared batches launched so far for an ONNX model
+ * @param modelName Name of the model
+ * @return Number of ONNX calls made by the shared batcher (0 if it is unused)
+ */
+std::size_t OnnxManager::getSharedBatchCount(const std::string &modelName) const {
+  auto it = model_sharedBatchers_m.find(modelName);
+  if (it != model_sharedBatchers_m.end()) {
+    return it->second->batches();
+  }
+  return 0;
+}
+
+/**
+ * @brief Get the session pool used for inference with an ONNX model
+ * @param modelName Name of the model
+ * @return Shared pointer to the pool
+ */
+std::shared_ptr<OnnxSessionPool>
+OnnxManager::getSessionPool(const std::string &modelName) const {
+  auto it = model_sessionPools_m.find(modelName);
+  if (it == model_sessionPools_m.end()) {
+    throw std::runtime_error("OnnxManager: Model not found: " + modelName);
+  }
+  return it->second;
+}
+
 /**
  * @brief Register ONNX models from configuration
  * @param configProvider Reference to the configuration provider
@@ -853,16 +1360,92 @@ void OnnxManager::loadModelsFromConfig(
     const IConfigurationProvider &configProvider,
     const std::vector<std::unordered_map<std::string, std::string>> &modelConfig) {
 
+  const std::string optimizedModelDir = configProvider.get("onnxOptimizedModelDir");
+  if (!optimizedModelDir.empty()) {
+    std::filesystem::create_directories(optimizedModelDir);
+  }
+
+  // Sessions of all models are created concurrently; a model's settings are
+  // read while the sessions of the models before it are being built.
+  struct PendingModel {
+    const std::unordered_map<std::string, std::string> *entryKeys;
+    /// File the session is created from (the converted copy if any).
+    std::string modelFile;
+    std::string precision;
+    std::vector<std::string> inputVariables;
+    Ort::SessionOptions options;
+    bool sessionPerSlot;
+    bool useCuda;
+    bool warmup;
+    int64_t paddingSize;
+    int64_t batchSize;
+    int64_t sharedBatchTimeoutUs;
+    /// Optimized model cached by onnxOptimizedModelDir (empty: no cache).
+    std::string optimizedModel;
+    std::future<std::shared_ptr<Ort::Session>> session;
+  };
+  // A list keeps the options in place while the sessions are created.
+  std::list<PendingModel> pending;
+
   for (const auto &entryKeys : modelConfig) {
     const std::string &modelName = entryKeys.at("name");
 
     auto inputVariableVector =
         configProvider.splitString(entryKeys.at("inputVariables"), ",");
 
-    // Build per-model session options
+    // Build per-model session options.  One intra-op thread per session by
+    // default: RDataFrame already runs one slot per core.
+    const std::string owner = "model '" + modelName + "'";
     Ort::SessionOptions session_options;
-    session_options.SetIntraOpNumThreads(1);
-    session_options.SetGraphOptimizationLevel(GraphOptimizationLevel::ORT_ENABLE_EXTENDED);
+    auto optionIt = entryKeys.find("graphOptimization");
+    session_options.SetGraphOptimizationLevel(
+        optionIt != entryKeys.end()
+            ? parseGraphOptimization(optionIt->second, modelName)
+            : GraphOptimizationLevel::ORT_ENABLE_EXTENDED);
+    optionIt = entryKeys.find("executionMode");
+    if (optionIt != entryKeys.end()) {
+      session_options.SetExecutionMode(parseExecutionMode(optionIt->second, modelName));
+    }
+    if (sharedRootPool_m) {
+      if (entryKeys.count("intraOpThreads") || entryKeys.count("interOpThreads") ||
+          entryKeys.count("executionMode")) {
+        RDF_LOG_INFO << "OnnxManager: model '" << modelName
+                     << "' runs on ROOT's thread pool (pluginThreadPool=shared); its "
+                        "intraOpThreads, interOpThreads and executionMode are ignored.";
+      }
+      session_options.SetExecutionMode(ExecutionMode::ORT_SEQUENTIAL);
+      session_options.SetIntraOpNumThreads(1);
+      session_options.SetInterOpNumThreads(1);
+    } else if (globalThreadPool_m) {
+      if (entryKeys.count("intraOpThreads") || entryKeys.count("interOpThreads") ||
+          entryKeys.count("allowSpinning")) {
+        RDF_LOG_INFO << "OnnxManager: model '" << modelName
+                     << "' uses the global thread pool; its intraOpThreads, "
+                        "interOpThreads and allowSpinning are ignored.";
+      }
+      session_options.DisablePerSessionThreads();
+    } else {
+      optionIt = entryKeys.find("intraOpThreads");
+      session_options.SetIntraOpNumThreads(
+          optionIt != entryKeys.end()
+              ? parseThreadCount(optionIt->second, "intraOpThreads", owner)
+              : 1);
+      optionIt = entryKeys.find("interOpThreads");
+      if (optionIt != entryKeys.end()) {
+        session_options.SetInterOpNumThreads(
+            parseThreadCount(optionIt->second, "interOpThreads", owner));
+      }
+      optionIt = entryKeys.find("allowSpinning");
+      if (optionIt != entryKeys.end() &&
+          !parseBoolOption(optionIt->second, "allowSpinning", owner)) {
+        session_options.AddConfigEntry("session.intra_op.allow_spinning", "0");
+        session_options.AddConfigEntry("session.inter_op.allow_spinning", "0");
+      }
+    }
+    optionIt = entryKeys.find("sessionPerSlot");
+    const bool sessionPerSlot =
+        optionIt != entryKeys.end() &&
+        parseBoolOption(optionIt->second, "sessionPerSlot", owner);
 
     // Parse optional useCuda flag
     bool useCuda = false;
@@ -912,7 +1495,167 @@ void OnnxManager::loadModelsFromConfig(
       }
     }
 
-    auto session = std::make_shared<Ort::Session>(*env_m, entryKeys.at("file").c_str(), session_options);
+    int64_t batchSize = 0;
+    auto batchIt = entryKeys.find("batchSize");
+    if (batchIt != entryKeys.end()) {
+      try {
+        batchSize = std::stoll(batchIt->second);
+      } catch (const std::exception &e) {
+        throw std::runtime_error("OnnxManager: Invalid batchSize value '" +
+                                 batchIt->second + "' for model '" +
+                                 modelName + "': " + e.what());
+      }
+      if (batchSize < 0) {
+        throw std::runtime_error("OnnxManager: Invalid batchSize value '" +
+                                 batchIt->second + "' for model '" +
+                                 modelName + "': batch size must be non-negative");
+      }
+    }
+
+    if (entryKeys.count("sharedBatchSize") != 0) {
+      throw std::runtime_error("OnnxManager: Model '" + modelName +
+                               "' sets sharedBatchSize; use batchSize instead.");
+    }
+
+    int64_t sharedBatchTimeoutUs = 1000;
+    auto sharedTimeoutIt = entryKeys.find("sharedBatchTimeoutUs");
+    if (sharedTimeoutIt != entryKeys.end()) {
+      try {
+        sharedBatchTimeoutUs = std::stoll(sharedTimeoutIt->second);
+      } catch (const std::exception &e) {
+        throw std::runtime_error("OnnxManager: Invalid sharedBatchTimeoutUs value '" +
+                                 sharedTimeoutIt->second + "' for model '" +
+                                 modelName + "': " + e.what());
+      }
+      if (sharedBatchTimeoutUs < 0) {
+        throw std::runtime_error("OnnxManager: Invalid sharedBatchTimeoutUs value '" +
+                                 sharedTimeoutIt->second + "' for model '" +
+                                 modelName + "': timeout must be non-negative");
+      }
+    }
+
+    // Reduced-precision copies are converted offline (convert_onnx_precision.py)
+    // into onnxConvertedModelDir; their inputs and outputs stay float.
+    auto precisionIt = entryKeys.find("precision");
+    const std::string precision =
+        precisionIt == entryKeys.end() ? "fp32" : toLowerCopy(trim(precisionIt->second));
+    if (precision != "fp32" && precision != "fp16" && precision != "int8") {
+      throw std::runtime_error("OnnxManager: Invalid precision value '" + precisionIt->second +
+                               "' for model '" + modelName +
+                               "'. Expected fp32, fp16 or int8.");
+    }
+    std::string modelFile = entryKeys.at("file");
+    if (precision != "fp32") {
+      const std::string convertedDir = configProvider.get("onnxConvertedModelDir");
+      const std::string converted = convertedModelFile(
+          convertedDir.empty() ? "onnx_converted" : convertedDir, modelFile, precision);
+      if (!std::filesystem::exists(converted)) {
+        throw std::runtime_error(
+            "OnnxManager: no " + precision + " copy of model '" + modelName + "' at '" +
+            converted + "'. Create it with: python core/python/convert_onnx_precision.py "
+            "--precision " + precision + " --output-dir " +
+            std::filesystem::path(converted).parent_path().string() + " " + modelFile);
+      }
+      if (precision == "fp16" && !useCuda) {
+        RDF_LOG_WARN << "OnnxManager: model '" << modelName
+                     << "' runs in fp16 on the CPU, where it is usually slower than fp32; "
+                        "fp16 is meant for useCuda=true.";
+      } else if (precision == "int8" && useCuda) {
+        RDF_LOG_WARN << "OnnxManager: model '" << modelName
+                     << "' runs in int8 with CUDA, where most quantized operators fall back "
+                        "to the CPU; int8 is meant for CPUs with VNNI.";
+      }
+      modelFile = converted;
+    }
+
+    auto warmupIt = entryKeys.find("warmup");
+    const bool warmup = warmupIt == entryKeys.end() ||
+                        parseBoolOption(warmupIt->second, "warmup", owner);
+
+    // Sessions built with the same options are shared with other
+    // OnnxManagers; a session keeps the environment it was created in alive.
+    // With the global thread pool the environment is part of the key.
+    std::string optionsKey;
+    for (const char *key : {"graphOptimization", "executionMode", "intraOpThreads",
+                            "interOpThreads", "allowSpinning", "useCuda", "cudaDeviceId"}) {
+      if (auto it = entryKeys.find(key); it != entryKeys.end()) {
+        optionsKey += std::string(";") + key + "=" + it->second;
+      }
+    }
+    if (sharedRootPool_m) {
+      optionsKey += ";pluginThreadPool=shared";
+    }
+    std::string sessionKey = globalThreadPool_m
+                                 ? "env=" + std::to_string(reinterpret_cast<std::uintptr_t>(env_m.get()))
+                                 : std::string();
+    sessionKey += optionsKey;
+
+    // The optimized graph depends on the model, the options and the ONNX
+    // Runtime version.
+    std::string optimizedModel;
+    if (!optimizedModelDir.empty()) {
+      const std::string digest = models().contentHash(modelFile);
+      if (!digest.empty()) {
+        optimizedModel = optimizedModelDir + "/" +
+                         ProvenanceService::hashString(digest + "\n" + optionsKey + "\n" +
+                                                       OrtGetApiBase()->GetVersionString()) +
+                         ".onnx";
+      }
+    }
+
+    PendingModel &model = pending.emplace_back(PendingModel{
+        &entryKeys, modelFile, precision, std::move(inputVariableVector),
+        std::move(session_options),
+        sessionPerSlot, useCuda, warmup, paddingSize, batchSize,
+        sharedBatchTimeoutUs, optimizedModel, {}});
+    model.session = std::async(
+        std::launch::async,
+        [env = env_m, &registry = models(), modelFile, sessionKey, optimizedModel,
+         &options = model.options]() {
+          if (!optimizedModel.empty() && std::filesystem::exists(optimizedModel)) {
+            const Ort::SessionOptions optimized = optimizedModelOptions(options);
+            return registry.get<Ort::Session>(optimizedModel, sessionKey, [&] {
+              return makeSession(env, optimizedModel, optimized);
+            });
+          }
+          return registry.get<Ort::Session>(modelFile, sessionKey, [&] {
+            if (optimizedModel.empty()) {
+              return makeSession(env, modelFile, options);
+            }
+            // Write the optimized graph next to its final name first so
+            // other jobs never load a partial file.
+            const std::string tmpPath = optimizedModel + temporarySuffix();
+            Ort::SessionOptions saving = options.Clone();
+            saving.SetOptimizedModelFilePath(tmpPath.c_str());
+            auto session = makeSession(env, modelFile, saving);
+            std::error_code ec;
+            std::filesystem::rename(tmpPath, optimizedModel, ec);
+            if (ec) {
+              std::filesystem::remove(tmpPath, ec);
+            }
+            return session;
+          });
+        });
+  }
+
+  for (auto &model : pending) {
+    const auto &entryKeys = *model.entryKeys;
+    const std::string &modelName = entryKeys.at("name");
+    const auto &inputVariableVector = model.inputVariables;
+    const bool useCuda = model.useCuda;
+    const int64_t paddingSize = model.paddingSize;
+    int64_t batchSize = model.batchSize;
+    const int64_t sharedBatchTimeoutUs = model.sharedBatchTimeoutUs;
+
+    auto session = model.session.get();
+    // Per-slot sessions load the optimized model once it is cached.
+    const bool optimized =
+        !model.optimizedModel.empty() && std::filesystem::exists(model.optimizedModel);
+    model_sessionPools_m.emplace(
+        modelName, std::make_shared<OnnxSessionPool>(
+                       session, env_m, optimized ? model.optimizedModel : model.modelFile,
+                       optimized ? optimizedModelOptions(model.options) : std::move(model.options),
+                       model.sessionPerSlot));
 
     Ort::AllocatorWithDefaultOptions allocator;
 
@@ -947,6 +1690,8 @@ void OnnxManager::loadModelsFromConfig(
 
     std::vector<std::vector<int64_t>> resolvedInputShapes;
     resolvedInputShapes.reserve(num_input_nodes);
+    std::vector<std::vector<int64_t>> batchInputShapes;
+    batchInputShapes.reserve(num_input_nodes);
     std::vector<int64_t> inputElementCounts;
     inputElementCounts.reserve(num_input_nodes);
     for (size_t i = 0; i < num_input_nodes; ++i) {
@@ -954,6 +1699,23 @@ void OnnxManager::loadModelsFromConfig(
       auto resolvedShape = resolveShape(baseShape, paddingSize, modelName, i);
       resolvedInputShapes.push_back(resolvedShape);
       inputElementCounts.push_back(elementCount(resolvedShape, modelName, i));
+
+      auto batchShape = resolvedShape;
+      batchShape[0] = baseShape[0];
+      batchInputShapes.push_back(batchShape);
+      // A fixed batch dimension caps the number of rows per ONNX call.
+      if (batchSize > 1 && baseShape[0] > 0 && baseShape[0] < batchSize) {
+        if (baseShape[0] == 1) {
+          throw std::runtime_error(
+              "OnnxManager: batchSize=" + std::to_string(batchSize) +
+              " requested for model '" + modelName + "' but input index " +
+              std::to_string(i) + " has a fixed batch dimension of 1.");
+        }
+        RDF_LOG_INFO << "OnnxManager: capping batchSize for model '" << modelName
+                     << "' to the fixed ONNX batch dimension " << baseShape[0]
+                     << ".";
+        batchSize = baseShape[0];
+      }
     }
 
     size_t num_output_nodes = session->GetOutputCount();
@@ -982,6 +1744,23 @@ void OnnxManager::loadModelsFromConfig(
     model_inputNames_m.emplace(modelName, input_names);
     model_outputNames_m.emplace(modelName, output_names);
     model_outputShapes_m.emplace(modelName, outputShapes);
+    // Per-event output shapes for pre-allocated output tensors: a dynamic
+    // batch dimension is 1.  Any other dynamic dimension leaves allocation
+    // to ONNX Runtime.
+    std::vector<std::vector<int64_t>> outputRunShapes;
+    for (const auto &shape : outputShapes) {
+      std::vector<int64_t> runShape = shape;
+      if (!runShape.empty() && runShape[0] <= 0) {
+        runShape[0] = 1;
+      }
+      if (runShape.empty() ||
+          std::any_of(runShape.begin(), runShape.end(), [](int64_t d) { return d <= 0; })) {
+        outputRunShapes.clear();
+        break;
+      }
+      outputRunShapes.push_back(std::move(runShape));
+    }
+    model_outputRunShapes_m.emplace(modelName, std::move(outputRunShapes));
     model_paddingSize_m.emplace(modelName, paddingSize);
     model_inputShapes_m.emplace(modelName, resolvedInputShapes);
     model_inputElementCounts_m.emplace(modelName, inputElementCounts);
@@ -993,8 +1772,12 @@ void OnnxManager::loadModelsFromConfig(
     }
     model_inputRowElementCounts_m.emplace(modelName, inputRowElementCounts);
     model_useCuda_m.emplace(modelName, useCuda);
+    model_batchSize_m.emplace(modelName, batchSize);
+    model_sharedBatchTimeoutUs_m.emplace(modelName, sharedBatchTimeoutUs);
+    model_batchInputShapes_m.emplace(modelName, batchInputShapes);
     model_selectionMaskColumns_m.emplace(modelName, selectionMaskColumn);
     model_bundleModes_m.emplace(modelName, bundleMode);
+    model_precisions_m.emplace(modelName, model.precision);
 
 
     const auto &storedInputNames = model_inputNames_m.at(modelName);
@@ -1013,6 +1796,35 @@ void OnnxManager::loadModelsFromConfig(
     }
     model_outputNamePtrs_m.emplace(modelName, std::move(outputNamePtrs));
   }
+
+  // Warm every session up with one call at the configured batch size, so
+  // the event loop starts at full speed.
+  std::vector<std::pair<std::string, std::future<bool>>> warmups;
+  for (const auto &model : pending) {
+    if (!model.warmup) {
+      continue;
+    }
+    const std::string &modelName = model.entryKeys->at("name");
+    const int64_t rows = std::max<int64_t>(1, model_batchSize_m.at(modelName));
+    warmups.emplace_back(
+        modelName,
+        std::async(std::launch::async, warmupSession, std::ref(*objects_m.at(modelName)),
+                   model_batchInputShapes_m.at(modelName), rows,
+                   std::cref(model_inputNamePtrs_m.at(modelName)),
+                   std::cref(model_outputNamePtrs_m.at(modelName))));
+  }
+  for (auto &[modelName, warmup] : warmups) {
+    try {
+      model_warmedUp_m[modelName] = warmup.get();
+      if (!model_warmedUp_m[modelName]) {
+        RDF_LOG_INFO << "OnnxManager: no warmup for model '" << modelName
+                     << "' (non-float or dynamic inputs).";
+      }
+    } catch (const std::exception &e) {
+      RDF_LOG_WARN << "OnnxManager: warmup of model '" << modelName
+                   << "' failed: " << e.what();
+    }
+  }
 }
 
 void OnnxManager::setupFromConfigFile() {
@@ -1028,8 +1840,13 @@ void OnnxManager::setupFromConfigFile() {
 }
 
 void OnnxManager::initialize() {
-  std::cout << "OnnxManager: initialized with " << model_runVars_m.size()
-            << " ONNX model(s)." << std::endl;
+  if (dataManager_m) {
+    for (const auto &modelName : getAllModelNames()) {
+      dataManager_m->declareFeatures(getModelFeatures(modelName));
+    }
+  }
+  RDF_LOG_INFO << "OnnxManager: initialized with " << model_runVars_m.size()
+               << " ONNX model(s).";
 }
 
 void OnnxManager::reportMetadata() {
@@ -1044,6 +1861,28 @@ void OnnxManager::reportMetadata() {
   logger_m->log(ILogger::Level::Info, msg);
 }
 
+void OnnxManager::estimateCost(GraphCost &cost) const {
+  cost.models += getAllModelNames().size();
+}
+
+std::unordered_map<std::string, std::string> OnnxManager::collectProvenanceEntries() const {
+  std::unordered_map<std::string, std::string> entries;
+  for (const auto &[name, precision] : model_precisions_m) {
+    entries[name + ".precision"] = precision;
+  }
+  return entries;
+}
+
+std::string OnnxManager::convertedModelFile(const std::string &dir,
+                                            const std::string &modelFile,
+                                            const std::string &precision) {
+  const std::string digest = ModelRegistry::instance().contentHash(modelFile);
+  if (digest.empty()) {
+    throw std::runtime_error("OnnxManager: cannot read model file '" + modelFile + "'");
+  }
+  return (std::filesystem::path(dir) / (digest + "." + precision + ".onnx")).string();
+}
+
 std::shared_ptr<OnnxManager> OnnxManager::create(
     Analyzer& an, const std::string& role) {
     auto plugin = std::make_shared<OnnxManager>(an.getConfigurationProvider());
@@ -3,8 +3,10 @@
 
 #include <api/IConfigurationProvider.h>
 #include <api/IDataFrameProvider.h>
+#include <GraphCost.h>
 #include <NamedObjectManager.h>
 #include <SystematicBundle.h>
+#include <ThreadLocalPool.h>
 #include <ROOT/RVec.hxx>
 #include <RtypesCore.h>
 #include <onnxruntime_cxx_api.h>
@@ -15,6 +17,40 @@
 #include <vector>
 
 class Analyzer;
+class RowBatcher;
+
+/**
+ * @class OnnxSessionPool
+ * @brief Sessions used by the inference lambdas of one ONNX model.
+ *
+ * In shared mode every slot calls the session loaded at startup.  In
+ * per-slot mode each worker thread lazily gets its own session, created from
+ * the same file and session options, so that slots never contend on one
+ * session's internal state.  Each session holds its own copy of the model
+ * weights.
+ */
+class OnnxSessionPool {
+public:
+  OnnxSessionPool(std::shared_ptr<Ort::Session> shared,
+                  std::shared_ptr<Ort::Env> env, std::string modelFile,
+                  Ort::SessionOptions options, bool perSlot);
+
+  /// Session for the calling thread.
+  Ort::Session &local();
+
+  bool isPerSlot() const { return perSlot_m; }
+
+  /// Number of sessions created so far (1 in shared mode).
+  std::size_t getSessionCount() const;
+
+private:
+  std::shared_ptr<Ort::Session> shared_m;
+  std::shared_ptr<Ort::Env> env_m;
+  std::string modelFile_m;
+  Ort::SessionOptions options_m;
+  bool perSlot_m;
+  ThreadLocalPool<Ort::Session> sessions_m;
+};
 
 /**
  * @class OnnxManager
@@ -134,6 +170,59 @@ public:
    */
   bool getUseCuda(const std::string &modelName) const;
 
+  /**
+   * @brief Get the inference batch size for an ONNX model (``batchSize``)
+   * @param modelName Name of the model
+   * @return Most events of concurrent slots per ONNX call (0 if batching is disabled)
+   */
+  int64_t getBatchSize(const std::string &modelName) const;
+
+  /**
+   * @brief Get whether an ONNX model was run once at load time (``warmup``)
+   * @param modelName Name of the model
+   * @return true if the warmup call succeeded, false if it was disabled,
+   *         skipped or failed
+   */
+  bool getWarmedUp(const std::string &modelName) const;
+
+  /**
+   * @brief Number of shared batches launched for a model by its last applyModel()
+   * @param modelName Name of the model
+   * @return Launched batches (0 when the model does not use a shared batcher)
+   */
+  std::size_t getSharedBatchCount(const std::string &modelName) const;
+
+  /**
+   * @brief Get the session pool used for inference with an ONNX model
+   * @param modelName Name of the model
+   * @return Shared pointer to the pool
+   */
+  std::shared_ptr<OnnxSessionPool> getSessionPool(const std::string &modelName) const;
+
+  /**
+   * @brief Path of the copy of @p modelFile converted to @p precision
+   *        (``fp16`` or ``int8``) in @p dir
+   *
+   * The name is the MD5 digest of the model contents, so a retrained model
+   * needs a new conversion.  core/python/convert_onnx_precision.py writes
+   * the copies under the same names.
+   *
+   * @throws std::runtime_error if @p modelFile cannot be read
+   */
+  static std::string convertedModelFile(const std::string &dir, const std::string &modelFile,
+                                        const std::string &precision);
+
+  /**
+   * @brief Whether the models share one ORT thread pool (``onnxGlobalThreadPool``)
+   */
+  bool usesGlobalThreadPool() const { return globalThreadPool_m; }
+
+  /**
+   * @brief Whether inference runs on ROOT's slot threads only
+   *        (``pluginThreadPool=shared``)
+   */
+  bool sharesRootThreadPool() const { return sharedRootPool_m; }
+
   /**
    * @brief Return the type of the manager
    */
@@ -141,6 +230,9 @@ public:
 
   void setupFromConfigFile() override;
 
+  /// Setup only reads files; it may overlap with other plugins' setup.
+  bool concurrentSetup() const override { return true; }
+
   /**
    * @brief Post-wiring initialization: logs the number of loaded ONNX models.
    */
@@ -151,6 +243,16 @@ public:
    */
   void reportMetadata() override;
 
+  /**
+   * @brief Cost estimate: counts the loaded ONNX models.
+   */
+  void estimateCost(GraphCost &cost) const override;
+
+  /**
+   * @brief Provenance: the precision (``<model>.precision``) of every model.
+   */
+  std::unordered_map<std::string, std::string> collectProvenanceEntries() const override;
+
 private:
   /**
    * @brief Register ONNX models from the configuration
@@ -172,6 +274,22 @@ private:
    */
   std::shared_ptr<Ort::Env> env_m;
 
+  /**
+   * @brief True when env_m owns a global ORT thread pool used by all sessions.
+   */
+  bool globalThreadPool_m = false;
+
+  /**
+   * @brief True when sessions own no threads and run inference on the
+   *        calling RDataFrame slot (``pluginThreadPool=shared``).
+   */
+  bool sharedRootPool_m = false;
+
+  /**
+   * @brief Map from model name to the sessions used by its inference lambdas.
+   */
+  std::unordered_map<std::string, std::shared_ptr<OnnxSessionPool>> model_sessionPools_m;
+
   /**
    * @brief Map from model name to run variable name.
    */
@@ -196,6 +314,34 @@ private:
    * @brief Map from model name to CUDA runtime usage flag
    */
   std::unordered_map<std::string, bool> model_useCuda_m;
+
+  /**
+   * @brief Map from model name to inference batch size (0 = per-event inference)
+   */
+  std::unordered_map<std::string, int64_t> model_batchSize_m;
+
+  /**
+   * @brief Map from model name to whether its warmup call succeeded
+   */
+  std::unordered_map<std::string, bool> model_warmedUp_m;
+
+  /**
+   * @brief Map from model name to the longest wait for a partial shared batch (µs)
+   */
+  std::unordered_map<std::string, int64_t> model_sharedBatchTimeoutUs_m;
+
+  /**
+   * @brief Map from model name to the shared batcher of its last applyModel()
+   */
+  std::unordered_map<std::string, std::shared_ptr<RowBatcher>> model_sharedBatchers_m;
+
+  /**
+   * @brief Map from model name to input shapes used for batched inference.
+   *
+   * Identical to model_inputShapes_m except that the leading (batch) dimension
+   * keeps its value from the model or inputShapes config (<= 0 means dynamic).
+   */
+  std::unordered_map<std::string, std::vector<std::vector<int64_t>>> model_batchInputShapes_m;
   
   /**
    * @brief Map from model name to resolved ONNX input shapes.
@@ -207,6 +353,12 @@ private:
    */
   std::unordered_map<std::string, std::vector<std::vector<int64_t>>> model_outputShapes_m;
 
+  /**
+   * @brief Map from model name to per-event output shapes used to pre-allocate
+   *        output tensors (empty when an output has a dynamic non-batch dimension).
+   */
+  std::unordered_map<std::string, std::vector<std::vector<int64_t>>> model_outputRunShapes_m;
+
   /**
    * @brief Map from model name to flattened element count per ONNX input tensor.
    */
@@ -227,6 +379,11 @@ private:
    */
   std::unordered_map<std::string, SystematicBundleMode> model_bundleModes_m;
 
+  /**
+   * @brief Per-model precision: ``fp32``, ``fp16`` or ``int8``.
+   */
+  std::unordered_map<std::string, std::string> model_precisions_m;
+
   /**
    * @brief Cached C-string pointers for ONNX input names (to avoid per-event allocation).
    */
@@ -1,4 +1,5 @@
 #include <RegionManager.h>
+#include <BoolMaskColumn.h>
 #include <analyzer.h>
 #include <NullOutputSink.h>
 #include <TFile.h>
@@ -6,6 +7,7 @@
 #include <algorithm>
 #include <api/ILogger.h>
 #include <api/IOutputSink.h>
+#include <cstdint>
 #include <sstream>
 #include <stdexcept>
 #include <unordered_set>
@@ -25,6 +27,7 @@ void RegionManager::setContext(ManagerContext &ctx) {
   configManager_m = &ctx.config;
   dataManager_m = &ctx.data;
   logger_m = &ctx.logger;
+  skimSink_m = &ctx.skimSink;
   metaSink_m = &ctx.metaSink;
 }
 
@@ -59,24 +62,103 @@ void RegionManager::declareRegion(const std::string &name,
     baseCaptured_m = true;
   }
 
-  // Determine the starting node for this region.
-  ROOT::RDF::RNode startNode =
-      parent.empty() ? baseDf_m : [&]() -> ROOT::RDF::RNode {
-        auto it = regions_m.find(parent);
-        if (it == regions_m.end()) {
-          throw std::runtime_error(
-              "RegionManager::declareRegion(): parent region '" + parent +
-              "' has not been declared. Declare parent regions before children.");
-        }
-        return it->second.dfNode;
-      }();
+  if (!parent.empty() && !regions_m.count(parent)) {
+    throw std::runtime_error(
+        "RegionManager::declareRegion(): parent region '" + parent +
+        "' has not been declared. Declare parent regions before children.");
+  }
 
-  // Build the filtered node for this region.
-  ROOT::RDF::RNode filteredNode =
-      startNode.Filter(passRegionFilter, {filterColumn});
+  // The filtered node is built on first use; check the column now so that a
+  // missing or non-boolean filter column is still reported here.
+  const std::string columnType = baseDf_m.GetColumnType(filterColumn);
+  if (columnType != "bool" && columnType != "Bool_t") {
+    throw std::runtime_error(
+        "RegionManager::declareRegion(): filterColumn '" + filterColumn +
+        "' of region '" + name + "' has type '" + columnType +
+        "', expected bool.");
+  }
 
+  RegionEntry entry{name, filterColumn, parent, regionOrder_m.size(), nullptr};
   regionOrder_m.push_back(name);
-  regions_m.emplace(name, RegionEntry{name, filterColumn, parent, filteredNode});
+  regions_m.emplace(name, std::move(entry));
+}
+
+ROOT::RDF::RNode RegionManager::regionNode(const RegionEntry &entry) const {
+  if (!entry.dfNode) {
+    ROOT::RDF::RNode startNode = entry.parent.empty()
+                                     ? baseDf_m
+                                     : regionNode(regions_m.at(entry.parent));
+    entry.dfNode = std::make_shared<ROOT::RDF::RNode>(
+        startNode.Filter(passRegionFilter, {entry.filterColumn}));
+  }
+  return *entry.dfNode;
+}
+
+std::size_t RegionManager::getRegionIndex(const std::string &name) const {
+  auto it = regions_m.find(name);
+  if (it == regions_m.end()) {
+    throw std::runtime_error(
+        "RegionManager::getRegionIndex(): region '" + name +
+        "' has not been declared.");
+  }
+  return it->second.index;
+}
+
+ROOT::RDF::RNode
+RegionManager::defineMembershipColumn(ROOT::RDF::RNode node,
+                                      const std::string &column) const {
+  if (regionOrder_m.empty() || regionOrder_m.size() > kMaxMembershipRegions) {
+    throw std::runtime_error(
+        "RegionManager::defineMembershipColumn(): membership needs 1 to " +
+        std::to_string(kMaxMembershipRegions) + " regions, got " +
+        std::to_string(regionOrder_m.size()) + ".");
+  }
+
+  // Read every distinct filter column once; regions sharing a column share
+  // its bit in the filter word.
+  std::vector<std::string> filterColumns;
+  std::vector<unsigned> filterBit;
+  std::vector<int> parentIndex;
+  for (const auto &name : regionOrder_m) {
+    const auto &entry = regions_m.at(name);
+    auto it = std::find(filterColumns.begin(), filterColumns.end(),
+                        entry.filterColumn);
+    if (it == filterColumns.end()) {
+      it = filterColumns.insert(filterColumns.end(), entry.filterColumn);
+    }
+    filterBit.push_back(static_cast<unsigned>(it - filterColumns.begin()));
+    parentIndex.push_back(
+        entry.parent.empty()
+            ? -1
+            : static_cast<int>(regions_m.at(entry.parent).index));
+  }
+
+  const std::string filterWord = column + "_filters";
+  node = defineBoolMask(node, filterWord, filterColumns);
+
+  // Parents are declared before their children, so one pass in declaration
+  // order resolves the full chain.
+  auto resolve = [filterBit, parentIndex](std::uint64_t filters) {
+    std::uint64_t membership = 0;
+    for (std::size_t r = 0; r < filterBit.size(); ++r) {
+      const bool passes = (filters >> filterBit[r]) & 1u;
+      const bool inParent =
+          parentIndex[r] < 0 || ((membership >> parentIndex[r]) & 1u);
+      membership |= static_cast<std::uint64_t>(passes && inParent) << r;
+    }
+    return membership;
+  };
+  return node.Define(column, resolve, {filterWord});
+}
+
+std::string RegionManager::ensureMembershipColumn() {
+  ROOT::RDF::RNode df = dataManager_m->getDataFrame();
+  const auto columns = df.GetColumnNames();
+  if (std::find(columns.begin(), columns.end(), kMembershipColumn) ==
+      columns.end()) {
+    dataManager_m->setDataFrame(defineMembershipColumn(df, kMembershipColumn));
+  }
+  return kMembershipColumn;
 }
 
 std::vector<std::string>
@@ -106,7 +188,61 @@ RegionManager::getRegionDataFrame(const std::string &name) const {
         "RegionManager::getRegionDataFrame(): region '" + name +
         "' has not been declared.");
   }
-  return it->second.dfNode;
+  return regionNode(it->second);
+}
+
+void RegionManager::addRegionSkim(const std::string &region,
+                                  const std::vector<std::string> &columns) {
+  if (!regions_m.count(region)) {
+    throw std::runtime_error(
+        "RegionManager::addRegionSkim(): region '" + region +
+        "' has not been declared.");
+  }
+  for (const auto &skim : regionSkims_m) {
+    if (skim.region == region) {
+      throw std::runtime_error(
+          "RegionManager::addRegionSkim(): region '" + region +
+          "' already has a skim.");
+    }
+  }
+  if (regionSkimsBooked_m) {
+    throw std::runtime_error(
+        "RegionManager::addRegionSkim(): region skims were already booked; "
+        "add them before the analysis is run.");
+  }
+  regionSkims_m.push_back(RegionSkim{region, columns});
+}
+
+std::string RegionManager::getRegionSkimFile(const std::string &region) const {
+  if (!configManager_m) {
+    throw std::runtime_error(
+        "RegionManager::getRegionSkimFile(): context not set.");
+  }
+  const std::string saveFile = configManager_m->get("saveFile");
+  if (saveFile.empty()) {
+    throw std::runtime_error(
+        "RegionManager::getRegionSkimFile(): saveFile is not configured.");
+  }
+  const auto pos = saveFile.rfind('.');
+  if (pos != std::string::npos) {
+    return saveFile.substr(0, pos) + "_" + region + saveFile.substr(pos);
+  }
+  return saveFile + "_" + region + ".root";
+}
+
+void RegionManager::execute() {
+  if (regionSkimsBooked_m || regionSkims_m.empty()) return;
+  regionSkimsBooked_m = true;
+
+  std::string treeName = configManager_m->get("saveTree");
+  if (treeName.empty()) {
+    treeName = "Events";
+  }
+  for (const auto &skim : regionSkims_m) {
+    auto node = regionNode(regions_m.at(skim.region));
+    skimSink_m->bookDataFrame(
+        node, OutputSpec{getRegionSkimFile(skim.region), treeName, skim.columns});
+  }
 }
 
 const std::vector<std::string> &RegionManager::getRegionNames() const {
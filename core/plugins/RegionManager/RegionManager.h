@@ -8,6 +8,7 @@
 #include <api/IOutputSink.h>
 #include <api/ManagerContext.h>
 #include <ROOT/RDataFrame.hxx>
+#include <cstddef>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -35,7 +36,20 @@ class Analyzer;
  *
  * The main analysis dataframe is **not modified** by RegionManager. It builds
  * its own filtered branches independently, which other plugins (histogram and
- * cutflow managers) can retrieve via getRegionDataFrame().
+ * cutflow managers) can retrieve via getRegionDataFrame().  A region's branch
+ * is only created when getRegionDataFrame() is first called for it (or for
+ * one of its children).
+ *
+ * ### Membership mode
+ *
+ * Many overlapping regions as separate filter branches evaluate shared
+ * predicates once per branch and load the RDataFrame scheduler with one
+ * branch per region.  defineMembershipColumn() instead computes, once per
+ * event, a std::uint64_t word whose bit i is set when the event belongs to
+ * the i-th declared region (full ancestor chain).  NDHistogramManager always
+ * fills its region axis from this word.  With setMembershipMode(true),
+ * CutflowManager books all region cutflows as one action on it as well.
+ * The word holds at most kMaxMembershipRegions regions.
  *
  * Typical usage:
  * @code
@@ -68,6 +82,12 @@ public:
   static std::shared_ptr<RegionManager> create(
       Analyzer& an, const std::string& role = "regionManager");
 
+  /// Largest number of regions held by one membership word.
+  static constexpr std::size_t kMaxMembershipRegions = 64;
+
+  /// Name of the membership column defined by ensureMembershipColumn().
+  static constexpr const char *kMembershipColumn = "region_membership";
+
   RegionManager() = default;
 
   /**
@@ -84,8 +104,8 @@ public:
    *                     string for a root region (no parent).
    *
    * @throws std::runtime_error if context has not been set, if @p name is
-   *         already declared, or if @p parent is specified but has not yet
-   *         been declared.
+   *         already declared, if @p parent is specified but has not yet
+   *         been declared, or if @p filterColumn is not a bool column.
    */
   void declareRegion(const std::string &name,
                      const std::string &filterColumn,
@@ -108,6 +128,47 @@ public:
    */
   const std::vector<std::string> &getRegionNames() const;
 
+  /**
+   * @brief Return the position of a region in getRegionNames(), which is
+   *        also its bit in the membership word.
+   * @throws std::runtime_error if @p name has not been declared.
+   */
+  std::size_t getRegionIndex(const std::string &name) const;
+
+  /**
+   * @brief Let consumers fill regions from the membership word instead of
+   *        per-region filter branches.
+   *
+   * Read by CutflowManager when it books its region cutflows.
+   */
+  void setMembershipMode(bool enable = true) { membershipMode_m = enable; }
+
+  /// True if setMembershipMode(true) was called.
+  bool isMembershipMode() const { return membershipMode_m; }
+
+  /**
+   * @brief Define the region membership word as @p column on @p node.
+   *
+   * Bit i of the std::uint64_t column is set when the event passes the
+   * filter chain of the i-th declared region.  Each distinct filter column
+   * is read once per event; the hierarchy is resolved on the packed word,
+   * so no Filter node is added.  Every region filter column must be
+   * available on @p node.
+   *
+   * @return @p node with the column (and a "<column>_filters" helper
+   *         column) defined.
+   * @throws std::runtime_error if no region is declared or more than
+   *         kMaxMembershipRegions are.
+   */
+  ROOT::RDF::RNode defineMembershipColumn(ROOT::RDF::RNode node,
+                                          const std::string &column) const;
+
+  /**
+   * @brief Define kMembershipColumn on the main analysis dataframe, once.
+   * @return kMembershipColumn.
+   */
+  std::string ensureMembershipColumn();
+
   /**
    * @brief Validate the region hierarchy without throwing.
    *
@@ -135,6 +196,29 @@ public:
    */
   std::vector<std::string> getFilterChain(const std::string &name) const;
 
+  /**
+   * @brief Write the events of a declared region to their own skim file.
+   *
+   * Region skims are booked as lazy Snapshots on the region's filtered node in
+   * execute(), so every region skim is written by the same event loop as the
+   * main skim and the histograms.  Each region gets the file returned by
+   * getRegionSkimFile() holding a ``saveTree`` tree (default "Events").
+   *
+   * @param region  Name of an already-declared region.
+   * @param columns Columns to write; empty writes every column available on
+   *                the region node.
+   * @throws std::runtime_error if @p region is not declared or already has
+   *         a skim.
+   */
+  void addRegionSkim(const std::string &region,
+                     const std::vector<std::string> &columns = {});
+
+  /**
+   * @brief Output file of a region skim: ``saveFile`` with ``_<region>``
+   *        inserted before the extension.
+   */
+  std::string getRegionSkimFile(const std::string &region) const;
+
   // -------------------------------------------------------------------------
   // IPluggableManager interface
   // -------------------------------------------------------------------------
@@ -159,9 +243,11 @@ public:
   void initialize() override;
 
   /**
-   * @brief No-op for the event loop; regions are fully built at declaration.
+   * @brief Book the region skims added with addRegionSkim().
+   *
+   * Regions are fully built at declaration; this only books output.
    */
-  void execute() override {}
+  void execute() override;
 
   /**
    * @brief Validate regions and write a summary to the meta output ROOT file.
@@ -178,14 +264,27 @@ private:
     std::string name;
     std::string filterColumn;
     std::string parent;             ///< empty = root region
-    ROOT::RDF::RNode dfNode;        ///< DF filtered by this region's full chain
+    std::size_t index = 0;          ///< position in regionOrder_m
+    /// DF filtered by this region's full chain; built on first request.
+    mutable std::shared_ptr<ROOT::RDF::RNode> dfNode;
   };
 
+  /// Filtered node of @p entry, building it (and its ancestors) on demand.
+  ROOT::RDF::RNode regionNode(const RegionEntry &entry) const;
+
   // Declaration-order list of names (stable for iteration).
   std::vector<std::string> regionOrder_m;
   // Map from name to entry (for O(1) lookup).
   std::unordered_map<std::string, RegionEntry> regions_m;
 
+  struct RegionSkim {
+    std::string region;
+    std::vector<std::string> columns;
+  };
+  // Region skims in addRegionSkim() order; booked once by execute().
+  std::vector<RegionSkim> regionSkims_m;
+  bool regionSkimsBooked_m = false;
+
   // Base DF captured on the first declareRegion() call.
   // All root regions are filtered from this node so they share the same
   // baseline (any global preselection applied before the first region
@@ -193,9 +292,12 @@ private:
   bool baseCaptured_m = false;
   ROOT::RDF::RNode baseDf_m{ROOT::RDataFrame(0)};
 
+  bool membershipMode_m = false;
+
   IConfigurationProvider *configManager_m = nullptr;
   IDataFrameProvider *dataManager_m = nullptr;
   ILogger *logger_m = nullptr;
+  IOutputSink *skimSink_m = nullptr;
   IOutputSink *metaSink_m = nullptr;
 };
 
@@ -1,10 +1,118 @@
 #include <SofieManager.h>
+#include <AsyncLogger.h>
+#include <ModelOutputVariations.h>
+#include <RowBatcher.h>
 #include <analyzer.h>
 #include <api/IConfigurationProvider.h>
 #include <api/IDataFrameProvider.h>
 #include <api/ILogger.h>
 #include <api/ISystematicManager.h>
 
+
+namespace {
+
+/// Wraps a SofieInferenceFunction registered with registerModel().
+class SofieFunctionSession : public SofieSession {
+public:
+  SofieFunctionSession(std::shared_ptr<SofieInferenceFunction> function,
+                       std::size_t nFeatures, std::string modelName)
+      : function_m(std::move(function)), input_m(nFeatures),
+        modelName_m(std::move(modelName)) {}
+
+  void infer(const float *input, float *output) override {
+    // The buffer keeps its capacity, so only the returned vector allocates.
+    input_m.assign(input, input + input_m.size());
+    const std::vector<float> result = (*function_m)(input_m);
+    if (result.empty()) {
+      throw std::runtime_error("SOFIE model returned empty output: " + modelName_m);
+    }
+    output[0] = result[0];
+  }
+
+private:
+  std::shared_ptr<SofieInferenceFunction> function_m;
+  std::vector<float> input_m;
+  std::string modelName_m;
+};
+
+void checkInputSize(const ROOT::VecOps::RVec<Float_t> &inputVector,
+                    std::size_t nFeatures, const std::string &modelName) {
+  if (inputVector.size() != nFeatures) {
+    throw std::runtime_error("SofieManager: Input of model '" + modelName + "' has " +
+                             std::to_string(inputVector.size()) + " values, expected " +
+                             std::to_string(nFeatures) + ".");
+  }
+}
+
+/**
+ * @brief Define the output columns of a model from a lambda returning all
+ *        outputs of an event as an RVec
+ */
+template <typename F>
+void defineOutputColumns(IDataFrameProvider &dataManager,
+                         ISystematicManager &systematicManager,
+                         const std::string &modelName, std::size_t nOutputs,
+                         F outputsLambda, const std::string &inputColumn,
+                         const std::string &runVar) {
+  if (nOutputs == 1) {
+    auto scalarLambda = [outputsLambda](const ROOT::VecOps::RVec<Float_t> &inputVector,
+                                        bool runFlag, ULong64_t entry) -> Float_t {
+      return outputsLambda(inputVector, runFlag, entry)[0];
+    };
+    defineModelOutput<Float_t>(dataManager, systematicManager, modelName, scalarLambda,
+                               inputColumn, runVar);
+    return;
+  }
+  const std::string multiOutputColName = modelName + "_outputs";
+  defineModelOutput<ROOT::VecOps::RVec<Float_t>>(dataManager, systematicManager,
+                                                 multiOutputColName, outputsLambda,
+                                                 inputColumn, runVar);
+  for (std::size_t i = 0; i < nOutputs; ++i) {
+    auto indexLambda = [i](const ROOT::VecOps::RVec<Float_t> &outputs) -> Float_t {
+      return outputs[i];
+    };
+    dataManager.Define(modelName + "_output" + std::to_string(i), indexLambda,
+                       {multiOutputColName}, systematicManager);
+  }
+}
+
+} // namespace
+
+SofieSessionPool::SofieSessionPool(SofieSessionFactory factory, std::size_t nFeatures,
+                                   std::size_t nOutputs, std::size_t batchSize)
+    : factory_m(std::move(factory)), nFeatures_m(nFeatures),
+      nOutputs_m(std::max<std::size_t>(nOutputs, 1)),
+      batchSize_m(std::max<std::size_t>(batchSize, 1)) {}
+
+SofieSessionPool::Slot &SofieSessionPool::local() {
+  return slots_m.local([this]() {
+    auto slot = std::make_unique<Slot>();
+    slot->session = factory_m();
+    if (!slot->session) {
+      throw std::runtime_error("SofieManager: Session factory returned no session.");
+    }
+    slot->input.assign(batchSize_m * nFeatures_m, 0.0f);
+    slot->output.assign(batchSize_m * nOutputs_m, 0.0f);
+    return slot;
+  });
+}
+
+const float *SofieSessionPool::inferRow(const float *row) {
+  auto &slot = local();
+  if (batchSize_m == 1) {
+    slot.session->infer(row, slot.output.data());
+  } else {
+    // Rows after the first stay zero from the initial fill.
+    std::copy_n(row, nFeatures_m, slot.input.begin());
+    slot.session->infer(slot.input.data(), slot.output.data());
+  }
+  return slot.output.data();
+}
+
+std::size_t SofieSessionPool::getSessionCount() const {
+  return slots_m.size();
+}
+
 /**
  * @brief Construct a new SofieManager object
  * @param configProvider Reference to the configuration provider
@@ -24,33 +132,82 @@ void SofieManager::applyModel(const std::string &modelName) {
   
   const auto &inputFeatures = getModelFeatures(modelName);
   const auto &runVar = getRunVar(modelName);
+  auto pool = getSessionPool(modelName);
+  if (pool->getBatchSize() > 1) {
+    applyBatchedModel(modelName);
+    return;
+  }
   
   // Create input vector column from the features
-  dataManager_m->DefineVector("input_" + modelName, inputFeatures, "Float_t", *systematicManager_m);
-  
-  auto inferenceFunc = this->objects_m.at(modelName);
+  dataManager_m->DefineFeatureVector("input_" + modelName, inputFeatures, *systematicManager_m);
   
-  // Create lambda that calls the SOFIE inference function
-  auto sofieLambda = [inferenceFunc, modelName](ROOT::VecOps::RVec<Float_t> &inputVector,
-                                      bool runFlag) -> Float_t {
+  const std::size_t nFeatures = pool->getFeatureCount();
+  const std::size_t nOutputs = pool->getOutputCount();
+  if (nOutputs == 1) {
+    // The input RVec is passed to the session as is; outputs land in the
+    // slot's buffer.
+    auto sofieLambda = [pool, nFeatures, modelName](const ROOT::VecOps::RVec<Float_t> &inputVector,
+                                                    bool runFlag, ULong64_t) -> Float_t {
+      if (!runFlag) {
+        return -1.0f;
+      }
+      checkInputSize(inputVector, nFeatures, modelName);
+      return pool->inferRow(inputVector.data())[0];
+    };
+    defineModelOutput<Float_t>(*dataManager_m, *systematicManager_m, modelName, sofieLambda,
+                               "input_" + modelName, runVar);
+    return;
+  }
+
+  auto sofieLambda = [pool, nFeatures, nOutputs, modelName](
+                         const ROOT::VecOps::RVec<Float_t> &inputVector, bool runFlag,
+                         ULong64_t) -> ROOT::VecOps::RVec<Float_t> {
     if (!runFlag) {
-      return -1.0f;
+      return ROOT::VecOps::RVec<Float_t>(nOutputs, -1.0f);
     }
-    
-    // Convert ROOT::RVec to std::vector for the inference function
-    std::vector<float> inputVec(inputVector.begin(), inputVector.end());
-    
-    // Call the SOFIE inference function
-    std::vector<float> output = (*inferenceFunc)(inputVec);
-    
-    // Return the first output (most models have a single output)
-    if (output.empty()) {
-      throw std::runtime_error("SOFIE model returned empty output: " + modelName);
+    checkInputSize(inputVector, nFeatures, modelName);
+    const float *outputs = pool->inferRow(inputVector.data());
+    return ROOT::VecOps::RVec<Float_t>(outputs, outputs + nOutputs);
+  };
+  defineOutputColumns(*dataManager_m, *systematicManager_m, modelName, nOutputs, sofieLambda,
+                      "input_" + modelName, runVar);
+}
+
+void SofieManager::applyBatchedModel(const std::string &modelName) {
+  const auto &inputFeatures = getModelFeatures(modelName);
+  const auto &runVar = getRunVar(modelName);
+  auto pool = getSessionPool(modelName);
+  const std::size_t nFeatures = pool->getFeatureCount();
+  const std::size_t nOutputs = pool->getOutputCount();
+  const std::size_t batchSize = pool->getBatchSize();
+  const std::string inputColumn = "input_" + modelName;
+
+  dataManager_m->DefineFeatureVector(inputColumn, inputFeatures, *systematicManager_m);
+
+  // Rows of the slots running concurrently share one call of the session,
+  // zero-padded to the generated batch size.
+  auto evaluate = [pool, nOutputs](const float *rows, std::size_t nRows, float *outputs) {
+    auto &slot = pool->local();
+    slot.session->infer(rows, slot.output.data());
+    std::copy_n(slot.output.begin(), nRows * nOutputs, outputs);
+  };
+  const auto nSlots = static_cast<std::size_t>(dataManager_m->getDataFrame().GetNSlots());
+  auto batcher = std::make_shared<RowBatcher>(nFeatures, nOutputs, batchSize, nSlots,
+                                              std::move(evaluate));
+
+  auto sofieLambda = [batcher, nFeatures, nOutputs, modelName](
+                         const ROOT::VecOps::RVec<Float_t> &inputVector, bool runFlag,
+                         ULong64_t) -> ROOT::VecOps::RVec<Float_t> {
+    if (!runFlag) {
+      return ROOT::VecOps::RVec<Float_t>(nOutputs, -1.0f);
     }
-    return output[0];
+    checkInputSize(inputVector, nFeatures, modelName);
+    ROOT::VecOps::RVec<Float_t> outputs(nOutputs);
+    batcher->infer(inputVector.data(), inputVector.size(), outputs.data());
+    return outputs;
   };
-  
-  dataManager_m->Define(modelName, sofieLambda, {"input_" + modelName, runVar}, *systematicManager_m);
+  defineOutputColumns(*dataManager_m, *systematicManager_m, modelName, nOutputs, sofieLambda,
+                      inputColumn, runVar);
 }
 
 /**
@@ -118,9 +275,69 @@ void SofieManager::registerModel(const std::string &name,
                                   std::shared_ptr<SofieInferenceFunction> inferenceFunc,
                                   const std::vector<std::string> &features,
                                   const std::string &runVar) {
+  const std::size_t nFeatures = features.size();
+  auto factory = [inferenceFunc, nFeatures, name]() -> std::unique_ptr<SofieSession> {
+    return std::make_unique<SofieFunctionSession>(inferenceFunc, nFeatures, name);
+  };
+  objects_m.emplace(name, inferenceFunc);
+  features_m.emplace(name, features);
+  model_runVars_m.emplace(name, runVar);
+  model_sessionPools_m.emplace(
+      name, std::make_shared<SofieSessionPool>(factory, nFeatures, 1, 1));
+}
+
+/**
+ * @brief Register a SOFIE model invoked through slot-local sessions
+ * @param name Model name
+ * @param factory Creates one session per worker thread
+ * @param features Vector of input feature names
+ * @param runVar Name of the run variable
+ * @param nOutputs Number of outputs per event
+ * @param batchSize Batch size the model was generated with
+ */
+void SofieManager::registerSessionModel(const std::string &name,
+                                         SofieSessionFactory factory,
+                                         const std::vector<std::string> &features,
+                                         const std::string &runVar,
+                                         std::size_t nOutputs,
+                                         std::size_t batchSize) {
+  if (!factory) {
+    throw std::runtime_error("SofieManager: No session factory given for model: " + name);
+  }
+  if (nOutputs == 0) {
+    throw std::runtime_error("SofieManager: Model '" + name + "' must have at least one output");
+  }
+  auto pool = std::make_shared<SofieSessionPool>(std::move(factory), features.size(),
+                                                 nOutputs, batchSize);
+  // getModel() keeps working for session models: the wrapper evaluates one
+  // event on the calling thread's session.
+  auto inferenceFunc = std::make_shared<SofieInferenceFunction>(
+      [pool, name](const std::vector<float> &input) -> std::vector<float> {
+        if (input.size() != pool->getFeatureCount()) {
+          throw std::runtime_error("SofieManager: Input of model '" + name +
+                                   "' has an unexpected size.");
+        }
+        const float *outputs = pool->inferRow(input.data());
+        return std::vector<float>(outputs, outputs + pool->getOutputCount());
+      });
   objects_m.emplace(name, inferenceFunc);
   features_m.emplace(name, features);
   model_runVars_m.emplace(name, runVar);
+  model_sessionPools_m.emplace(name, std::move(pool));
+}
+
+/**
+ * @brief Get the session pool used for inference with a SOFIE model
+ * @param modelName Name of the model
+ * @return Shared pointer to the pool
+ */
+std::shared_ptr<SofieSessionPool>
+SofieManager::getSessionPool(const std::string &modelName) const {
+  auto it = model_sessionPools_m.find(modelName);
+  if (it == model_sessionPools_m.end()) {
+    throw std::runtime_error("SofieManager: Model not found: " + modelName);
+  }
+  return it->second;
 }
 
 /**
@@ -182,8 +399,13 @@ void SofieManager::setupFromConfigFile() {
 }
 
 void SofieManager::initialize() {
-  std::cout << "SofieManager: initialized with " << model_runVars_m.size()
-            << " SOFIE model(s)." << std::endl;
+  if (dataManager_m) {
+    for (const auto &modelName : getAllModelNames()) {
+      dataManager_m->declareFeatures(getModelFeatures(modelName));
+    }
+  }
+  RDF_LOG_INFO << "SofieManager: initialized with " << model_runVars_m.size()
+               << " SOFIE model(s).";
 }
 
 void SofieManager::reportMetadata() {
@@ -198,6 +420,10 @@ void SofieManager::reportMetadata() {
   logger_m->log(ILogger::Level::Info, msg);
 }
 
+void SofieManager::estimateCost(GraphCost &cost) const {
+  cost.models += getAllModelNames().size();
+}
+
 std::shared_ptr<SofieManager> SofieManager::create(
     Analyzer& an, const std::string& role) {
     auto plugin = std::make_shared<SofieManager>(an.getConfigurationProvider());
@@ -3,9 +3,14 @@
 
 #include <api/IConfigurationProvider.h>
 #include <api/IDataFrameProvider.h>
+#include <GraphCost.h>
 #include <NamedObjectManager.h>
 #include <ROOT/RVec.hxx>
 #include <RtypesCore.h>
+#include <ThreadLocalPool.h>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
 #include <functional>
 #include <memory>
 #include <stdexcept>
@@ -31,6 +36,102 @@ class Analyzer;
 // Takes a vector of floats (input features) and returns a vector of floats (outputs)
 using SofieInferenceFunction = std::function<std::vector<float>(const std::vector<float>&)>;
 
+/**
+ * @class SofieSession
+ * @brief Pointer-based interface to one SOFIE model session.
+ *
+ * infer() reads batchSize rows of input features and writes batchSize rows
+ * of outputs, both row-major, into caller-owned memory.  SofieManager gives
+ * every worker thread its own session, so implementations need not be
+ * thread-safe.
+ */
+class SofieSession {
+public:
+  virtual ~SofieSession() = default;
+  virtual void infer(const float *input, float *output) = 0;
+};
+
+/// Creates one session; called once per worker thread.
+using SofieSessionFactory = std::function<std::unique_ptr<SofieSession>()>;
+
+/**
+ * @class SofieGeneratedSession
+ * @brief Adapts a SOFIE-generated ``TMVA_SOFIE_<Model>::Session``.
+ *
+ * The generated infer() returns its outputs by value; they are copied into
+ * the caller's buffer.  Sessions that call the generated code with a
+ * preallocated output tensor can implement SofieSession directly instead.
+ */
+template <typename GeneratedSession>
+class SofieGeneratedSession : public SofieSession {
+public:
+  explicit SofieGeneratedSession(std::size_t nOutputValues)
+      : nOutputValues_m(nOutputValues) {}
+
+  void infer(const float *input, float *output) override {
+    const auto result = session_m.infer(const_cast<float *>(input));
+    std::copy_n(result.begin(), std::min(result.size(), nOutputValues_m), output);
+  }
+
+  /// Factory for SofieManager::registerSessionModel().
+  static SofieSessionFactory factory(std::size_t nOutputValues) {
+    return [nOutputValues]() -> std::unique_ptr<SofieSession> {
+      return std::make_unique<SofieGeneratedSession>(nOutputValues);
+    };
+  }
+
+private:
+  GeneratedSession session_m;
+  std::size_t nOutputValues_m;
+};
+
+/**
+ * @class SofieSessionPool
+ * @brief Slot-local sessions and scratch buffers of one SOFIE model.
+ *
+ * Each worker thread lazily gets its own session from the factory, together
+ * with input and output buffers sized for one call, so inference does not
+ * allocate per event.
+ */
+class SofieSessionPool {
+public:
+  struct Slot {
+    std::unique_ptr<SofieSession> session;
+    /// batchSize rows of input, used to zero-pad partial batches.
+    std::vector<float> input;
+    /// batchSize rows of outputs.
+    std::vector<float> output;
+  };
+
+  SofieSessionPool(SofieSessionFactory factory, std::size_t nFeatures,
+                   std::size_t nOutputs, std::size_t batchSize);
+
+  /// Session and buffers of the calling thread.
+  Slot &local();
+
+  /**
+   * @brief Evaluate one event.
+   * @param row nFeatures input values
+   * @return Pointer to the nOutputs outputs, valid until the next call on
+   *         this thread
+   */
+  const float *inferRow(const float *row);
+
+  std::size_t getFeatureCount() const { return nFeatures_m; }
+  std::size_t getOutputCount() const { return nOutputs_m; }
+  std::size_t getBatchSize() const { return batchSize_m; }
+
+  /// Number of sessions created so far.
+  std::size_t getSessionCount() const;
+
+private:
+  SofieSessionFactory factory_m;
+  std::size_t nFeatures_m;
+  std::size_t nOutputs_m;
+  std::size_t batchSize_m;
+  ThreadLocalPool<Slot> slots_m;
+};
+
 class SofieManager
     : public NamedObjectManager<std::shared_ptr<SofieInferenceFunction>> {
 public:
@@ -50,6 +151,10 @@ public:
   /**
    * @brief Apply a SOFIE model to the dataframe provider
    * @param modelName Name of the SOFIE model
+   *
+   * Single-output models define the column @p modelName.  Models with
+   * several outputs define ``<modelName>_outputs`` (RVec) and
+   * ``<modelName>_output<i>``, as OnnxManager does.
    */
   void applyModel(const std::string &modelName);
 
@@ -97,6 +202,29 @@ public:
                      const std::vector<std::string> &features,
                      const std::string &runVar);
 
+  /**
+   * @brief Register a SOFIE model invoked through slot-local sessions
+   * @param name Model name
+   * @param factory Creates one session per worker thread
+   * @param features Vector of input feature names
+   * @param runVar Name of the run variable
+   * @param nOutputs Number of outputs per event
+   * @param batchSize Batch size the model was generated with; above 1,
+   *        applyModel() evaluates up to batchSize events of concurrent
+   *        slots per call
+   */
+  void registerSessionModel(const std::string &name, SofieSessionFactory factory,
+                            const std::vector<std::string> &features,
+                            const std::string &runVar, std::size_t nOutputs = 1,
+                            std::size_t batchSize = 1);
+
+  /**
+   * @brief Get the session pool used for inference with a SOFIE model
+   * @param modelName Name of the model
+   * @return Shared pointer to the pool
+   */
+  std::shared_ptr<SofieSessionPool> getSessionPool(const std::string &modelName) const;
+
   /**
    * @brief Return the type of the manager
    */
@@ -114,6 +242,11 @@ public:
    */
   void reportMetadata() override;
 
+  /**
+   * @brief Cost estimate: counts the loaded SOFIE models.
+   */
+  void estimateCost(GraphCost &cost) const override;
+
 private:
   /**
    * @brief Register SOFIE models from the configuration
@@ -128,6 +261,21 @@ private:
    */
   void parseModelConfig(const IConfigurationProvider &configProvider, bool checkExisting);
 
+  /**
+   * @brief Apply a SOFIE model generated with batch size > 1
+   * @param modelName Name of the model
+   *
+   * The rows of the slots running concurrently are collected by a
+   * RowBatcher and evaluated in one zero-padded call of the session during
+   * the main event loop, as OnnxManager's batchSize option does.
+   */
+  void applyBatchedModel(const std::string &modelName);
+
+  /**
+   * @brief Map from model name to its slot-local sessions.
+   */
+  std::unordered_map<std::string, std::shared_ptr<SofieSessionPool>> model_sessionPools_m;
+
   /**
    * @brief Map from model name to run variable name.
    */
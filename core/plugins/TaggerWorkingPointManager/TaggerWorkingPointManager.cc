@@ -5,11 +5,211 @@
 #include <ROOT/RVec.hxx>
 #include <TFile.h>
 #include <TH1D.h>
+#include <TH2D.h>
 #include <api/ILogger.h>
+#include <algorithm>
+#include <atomic>
 #include <cmath>
 #include <set>
 #include <sstream>
 #include <stdexcept>
+#include <utility>
+
+namespace {
+
+/// Number of leading working points whose threshold @p score passes.  For
+/// non-decreasing thresholds this is a branch-free count.
+inline Int_t passedWorkingPoints(Float_t score, const std::vector<float> &thresholds,
+                                 bool ascending) {
+  Int_t passed = 0;
+  if (ascending) {
+    for (const float threshold : thresholds)
+      passed += score >= threshold;
+    return passed;
+  }
+  for (const float threshold : thresholds) {
+    if (score < threshold)
+      break;
+    ++passed;
+  }
+  return passed;
+}
+
+/// Define @p stackedCol as the per-object values of @p columns stacked
+/// column-major: value of object i in column k at [k * nObjects + i].
+void defineStackedColumn(IDataFrameProvider &dm, const std::string &stackedCol,
+                         const std::vector<std::string> &columns, const std::string &what) {
+  const std::size_t nColumns = columns.size();
+  dm.setDataFrame(dm.getDataFrame().Define(
+      stackedCol,
+      [nColumns](const ROOT::VecOps::RVec<Float_t> &values) {
+        ROOT::VecOps::RVec<Float_t> stacked;
+        stacked.reserve(values.size() * nColumns);
+        stacked.insert(stacked.end(), values.begin(), values.end());
+        return stacked;
+      },
+      {columns.front()}));
+  for (std::size_t k = 1; k < nColumns; ++k) {
+    dm.setDataFrame(dm.getDataFrame().Redefine(
+        stackedCol,
+        [k, what](ROOT::VecOps::RVec<Float_t> stacked,
+                  const ROOT::VecOps::RVec<Float_t> &values) {
+          if (stacked.size() != k * values.size())
+            throw std::runtime_error("TaggerWorkingPointManager: " + what +
+                                     " columns have different lengths per event");
+          stacked.insert(stacked.end(), values.begin(), values.end());
+          return stacked;
+        },
+        {stackedCol, columns[k]}));
+  }
+}
+
+/**
+ * @brief BTV fixed-WP event weight.
+ *
+ * @p sf and @p eff hold the per-object values of all working points, working
+ * point major: the value of object i at working point w is [w * nObjects + i].
+ */
+Float_t fixedWorkingPointEventWeight(const PhysicsObjectCollection &objects,
+                                     const ROOT::VecOps::RVec<Int_t> &category,
+                                     const Float_t *sf, const Float_t *eff,
+                                     std::size_t nObjects, std::size_t nWorkingPoints) {
+  auto unityIfInvalid = [](Float_t numerator, Float_t denominator) -> Float_t {
+    if (!std::isfinite(numerator) || !std::isfinite(denominator) ||
+        denominator <= 0.0f || numerator < 0.0f) {
+      return 1.0f;
+    }
+    const Float_t value = numerator / denominator;
+    if (!std::isfinite(value) || value < 0.0f)
+      return 1.0f;
+    return value;
+  };
+
+  Float_t weight = 1.0f;
+  for (std::size_t objectIndex = 0; objectIndex < objects.size(); ++objectIndex) {
+    const Int_t idx = objects.index(objectIndex);
+    if (idx < 0)
+      continue;
+
+    const std::size_t flatIndex = static_cast<std::size_t>(idx);
+    if (flatIndex >= category.size() || flatIndex >= nObjects)
+      continue;
+
+    auto sfAt = [&](std::size_t wp) { return sf[wp * nObjects + flatIndex]; };
+    auto effAt = [&](std::size_t wp) { return eff[wp * nObjects + flatIndex]; };
+
+    const Int_t cat = category[flatIndex];
+    Float_t factor = 1.0f;
+
+    if (cat <= 0) {
+      const Float_t effLoose = effAt(0);
+      const Float_t sfLoose = sfAt(0);
+      factor = unityIfInvalid(1.0f - sfLoose * effLoose, 1.0f - effLoose);
+    } else if (static_cast<std::size_t>(cat) >= nWorkingPoints) {
+      factor = sfAt(nWorkingPoints - 1);
+      if (!std::isfinite(factor) || factor < 0.0f)
+        factor = 1.0f;
+    } else {
+      const std::size_t lower = static_cast<std::size_t>(cat) - 1;
+      const std::size_t upper = static_cast<std::size_t>(cat);
+      const Float_t effLower = effAt(lower);
+      const Float_t effUpper = effAt(upper);
+      const Float_t sfLower = sfAt(lower);
+      const Float_t sfUpper = sfAt(upper);
+      factor = unityIfInvalid(sfLower * effLower - sfUpper * effUpper,
+                              effLower - effUpper);
+    }
+
+    weight *= factor;
+  }
+  return weight;
+}
+
+} // namespace
+
+/**
+ * @brief Correction and argument layout of a fixed-WP SF sweep.
+ *
+ * templates[v * nWorkingPoints + w] is the correctionlib argument list of
+ * variation v at working point w with placeholders in numericSlots.
+ */
+struct TaggerWorkingPointManager::FixedWorkingPointSweep {
+  std::size_t id = 0;
+  correction::Correction::Ref correction;
+  std::vector<std::vector<correction::Variable::Type>> templates;
+  std::vector<std::size_t> numericSlots;
+  std::vector<bool> numericIsInt;
+  std::size_t nWorkingPoints = 0;
+  /// Per variation: flavours it changes (empty = all).
+  std::vector<std::vector<Int_t>> flavours;
+
+  /**
+   * @brief SFs of all variations for one event, variation major then
+   *        working point major: [(v * nWorkingPoints + w) * nObjects + i].
+   *
+   * Only the working points the category of an object needs are evaluated;
+   * the others are left at 1.  @p flavour may be empty when no variation
+   * lists flavours.
+   */
+  ROOT::VecOps::RVec<Float_t> evaluate(const ROOT::VecOps::RVec<double> &inputs,
+                                       const ROOT::VecOps::RVec<Int_t> &category,
+                                       const ROOT::VecOps::RVec<Int_t> &flavour) const {
+    const std::size_t featureCount = numericSlots.size();
+    const std::size_t nObjects = inputs.size() / featureCount;
+    const std::size_t nVariations = flavours.size();
+    const std::size_t stride = nWorkingPoints * nObjects;
+    ROOT::VecOps::RVec<Float_t> sf(nVariations * stride, 1.0f);
+
+    // One argument buffer per template and thread; only the numeric slots
+    // change between objects.
+    thread_local std::unordered_map<std::size_t,
+                                    std::vector<std::vector<correction::Variable::Type>>>
+        scratch;
+    auto [bufferIt, inserted] = scratch.try_emplace(id);
+    auto &buffers = bufferIt->second;
+    if (inserted)
+      buffers = templates;
+
+    const double *row = inputs.data();
+    for (std::size_t i = 0; i < nObjects && i < category.size(); ++i, row += featureCount) {
+      const Int_t cat = category[i];
+      std::size_t wps[2];
+      std::size_t nWps = 0;
+      if (cat <= 0) {
+        wps[nWps++] = 0;
+      } else if (static_cast<std::size_t>(cat) >= nWorkingPoints) {
+        wps[nWps++] = nWorkingPoints - 1;
+      } else {
+        wps[nWps++] = static_cast<std::size_t>(cat) - 1;
+        wps[nWps++] = static_cast<std::size_t>(cat);
+      }
+      for (std::size_t v = 0; v < nVariations; ++v) {
+        const auto &changed = flavours[v];
+        const bool reuse =
+            v > 0 && !changed.empty() && i < flavour.size() &&
+            std::find(changed.begin(), changed.end(), flavour[i]) == changed.end();
+        for (std::size_t k = 0; k < nWps; ++k) {
+          const std::size_t w = wps[k];
+          Float_t &out = sf[v * stride + w * nObjects + i];
+          if (reuse) {
+            out = sf[w * nObjects + i];
+            continue;
+          }
+          auto &values = buffers[v * nWorkingPoints + w];
+          for (std::size_t f = 0; f < featureCount; ++f) {
+            auto &slot = values[numericSlots[f]];
+            if (numericIsInt[f])
+              slot = static_cast<int>(row[f]);
+            else
+              slot = row[f];
+          }
+          out = static_cast<Float_t>(correction->evaluate(values));
+        }
+      }
+    }
+    return sf;
+  }
+};
 
 // ---------------------------------------------------------------------------
 // Factory
@@ -232,6 +432,115 @@ void TaggerWorkingPointManager::defineFixedWorkingPointWeight(
        outputWeightColumn});
 }
 
+void TaggerWorkingPointManager::defineFixedWorkingPointWeights(
+    CorrectionManager &cm, const std::string &correctionName,
+    const std::vector<FixedWorkingPointVariation> &variations,
+    const std::vector<std::string> &inputColumns,
+    const std::vector<std::string> &perWorkingPointEfficiencyColumns,
+    const std::string &flavourColumn,
+    const std::vector<std::string> &workingPointArguments) {
+  if (inputObjectCollectionColumn_m.empty())
+    throw std::runtime_error(
+        "TaggerWorkingPointManager::defineFixedWorkingPointWeights: call "
+        "setInputObjectCollection() first");
+  if (workingPoints_m.empty())
+    throw std::runtime_error(
+        "TaggerWorkingPointManager::defineFixedWorkingPointWeights: call "
+        "addWorkingPoint() first");
+  if (correctionName.empty())
+    throw std::invalid_argument(
+        "TaggerWorkingPointManager::defineFixedWorkingPointWeights: "
+        "correctionName must not be empty");
+  if (variations.empty())
+    throw std::invalid_argument(
+        "TaggerWorkingPointManager::defineFixedWorkingPointWeights: "
+        "variations must not be empty");
+  if (!variations.front().flavours.empty())
+    throw std::invalid_argument(
+        "TaggerWorkingPointManager::defineFixedWorkingPointWeights: the "
+        "first variation is the reference and must apply to all flavours");
+  for (const auto &variation : variations) {
+    if (variation.systematic.empty() || variation.outputWeightColumn.empty())
+      throw std::invalid_argument(
+          "TaggerWorkingPointManager::defineFixedWorkingPointWeights: "
+          "variation systematic and output column must not be empty");
+    if (!variation.flavours.empty() && flavourColumn.empty())
+      throw std::invalid_argument(
+          "TaggerWorkingPointManager::defineFixedWorkingPointWeights: "
+          "variation '" + variation.systematic +
+          "' lists flavours but no flavourColumn is given");
+  }
+  const std::size_t nWorkingPoints = workingPoints_m.size();
+  if (perWorkingPointEfficiencyColumns.size() != nWorkingPoints)
+    throw std::invalid_argument(
+        "TaggerWorkingPointManager::defineFixedWorkingPointWeights: "
+        "perWorkingPointEfficiencyColumns size must match the number of "
+        "working points");
+  for (const auto &column : perWorkingPointEfficiencyColumns) {
+    if (column.empty())
+      throw std::invalid_argument(
+          "TaggerWorkingPointManager::defineFixedWorkingPointWeights: "
+          "efficiency column names must not be empty");
+  }
+  std::vector<std::string> wpArgs = workingPointArguments;
+  if (wpArgs.empty()) {
+    for (const auto &wp : workingPoints_m)
+      wpArgs.push_back(wp.name);
+  }
+  if (wpArgs.size() != nWorkingPoints)
+    throw std::invalid_argument(
+        "TaggerWorkingPointManager::defineFixedWorkingPointWeights: "
+        "workingPointArguments size must match the number of working points");
+
+  const std::vector<std::string> &inputs =
+      inputColumns.empty() ? cm.getCorrectionFeatures(correctionName) : inputColumns;
+
+  // Argument layout: the string inputs take (systematic, working point).
+  static std::atomic<std::size_t> nextSweepId{1};
+  auto sweep = std::make_shared<FixedWorkingPointSweep>();
+  sweep->id = nextSweepId.fetch_add(1, std::memory_order_relaxed);
+  sweep->correction = cm.getCorrection(correctionName);
+  sweep->nWorkingPoints = nWorkingPoints;
+  std::vector<correction::Variable::Type> base;
+  std::vector<std::size_t> stringSlots;
+  for (const auto &input : sweep->correction->inputs()) {
+    const std::string type = input.typeStr();
+    if (type == "string") {
+      stringSlots.push_back(base.size());
+      base.emplace_back(std::string());
+      continue;
+    }
+    sweep->numericSlots.push_back(base.size());
+    sweep->numericIsInt.push_back(type == "int");
+    if (type == "int")
+      base.emplace_back(0);
+    else
+      base.emplace_back(0.0);
+  }
+  if (stringSlots.size() != 2 || sweep->numericSlots.size() != inputs.size())
+    throw std::runtime_error(
+        "TaggerWorkingPointManager::defineFixedWorkingPointWeights: "
+        "correction '" + correctionName + "' must take two string inputs "
+        "(systematic, working point) and " + std::to_string(inputs.size()) +
+        " numeric inputs");
+  std::vector<std::string> outputs;
+  for (const auto &variation : variations) {
+    for (const auto &wpArg : wpArgs) {
+      auto values = base;
+      values[stringSlots[0]] = variation.systematic;
+      values[stringSlots[1]] = wpArg;
+      sweep->templates.push_back(std::move(values));
+    }
+    sweep->flavours.push_back(variation.flavours);
+    outputs.push_back(variation.outputWeightColumn);
+  }
+
+  const std::string inputColumn = "_twm_fixedwp_inputs_" + outputs.front();
+  cm.defineFlattenedInputs(correctionName, inputs, inputColumn);
+  fixedWPSweepSteps_m.push_back(
+      {sweep, inputColumn, flavourColumn, perWorkingPointEfficiencyColumns, outputs});
+}
+
 // ---------------------------------------------------------------------------
 // registerSystematicSources / getSystematicSources
 // ---------------------------------------------------------------------------
@@ -477,10 +786,73 @@ void TaggerWorkingPointManager::setupFromConfigFile() {
             configManager_m->splitString(entry.at("sources"), ",");
         registerSystematicSources(entry.at("setName"), sources);
       }
+    } else if (blockType == "fraction_histograms") {
+      // Fill the efficiency maps in the same event loop as the analysis.
+      // The object columns may still be set after this call, so the setup
+      // checks of defineFractionHistograms() are deferred to execute().
+      if (!entry.count("outputPrefix") || !entry.count("ptBinEdges") ||
+          !entry.count("etaBinEdges"))
+        throw std::invalid_argument(
+            "TaggerWorkingPointManager::setupFromConfigFile: "
+            "fraction_histograms block needs outputPrefix, ptBinEdges and "
+            "etaBinEdges");
+      auto parseEdges = [this, &entry](const std::string &key) {
+        std::vector<float> edges;
+        for (const auto &e : configManager_m->splitString(entry.at(key), ",")) {
+          std::size_t end = 0;
+          try {
+            edges.push_back(std::stof(e, &end));
+          } catch (const std::exception &) {
+            end = 0;
+          }
+          if (end == 0 || end != e.size())
+            throw std::invalid_argument(
+                "TaggerWorkingPointManager::setupFromConfigFile: "
+                "fraction_histograms " + key + " has an invalid edge '" + e +
+                "' (outputPrefix=" + entry.at("outputPrefix") + ")");
+        }
+        return edges;
+      };
+      const std::vector<float> ptEdges = parseEdges("ptBinEdges");
+      const std::vector<float> etaEdges = parseEdges("etaBinEdges");
+      if (entry.at("outputPrefix").empty() || ptEdges.size() < 2 ||
+          etaEdges.size() < 2)
+        throw std::invalid_argument(
+            "TaggerWorkingPointManager::setupFromConfigFile: "
+            "fraction_histograms block needs a prefix and at least 2 edges "
+            "per axis");
+      fractionHistogramConfigs_m.push_back(
+          {entry.at("outputPrefix"), ptEdges, etaEdges,
+           entry.count("flavourColumn") ? entry.at("flavourColumn")
+                                        : std::string()});
+    } else if (blockType == "fraction_correction") {
+      // Divide the SF weight by the fractions of the maps of an earlier run
+      // (see efficiencyMapFile()); applied by applyConfiguredCorrections().
+      if (!entry.count("outputPrefix") || !entry.count("inputColumns") ||
+          entry.at("outputPrefix").empty())
+        throw std::invalid_argument(
+            "TaggerWorkingPointManager::setupFromConfigFile: "
+            "fraction_correction block needs outputPrefix and inputColumns");
+      fractionCorrections_m.push_back(
+          {entry.at("outputPrefix"),
+           configManager_m->splitString(entry.at("inputColumns"), ",")});
     }
   }
 }
 
+// ---------------------------------------------------------------------------
+// efficiencyMapFile
+// ---------------------------------------------------------------------------
+
+std::string TaggerWorkingPointManager::efficiencyMapFile(
+    const std::string &outputPrefix) const {
+  if (!configManager_m) return "";
+  std::string dir = configManager_m->get("taggerMapDir");
+  if (dir.empty()) return "";
+  if (dir.back() != '/') dir += '/';
+  return dir + outputPrefix + ".json";
+}
+
 // ---------------------------------------------------------------------------
 // applyConfiguredCorrections
 // ---------------------------------------------------------------------------
@@ -490,6 +862,16 @@ void TaggerWorkingPointManager::applyConfiguredCorrections(
   for (const auto &cc : configuredCorrections_m) {
     applyCorrectionlib(cm, cc.correctionName, cc.stringArgs, cc.inputColumns);
   }
+  for (const auto &fc : fractionCorrections_m) {
+    const std::string file = efficiencyMapFile(fc.outputPrefix);
+    if (file.empty()) {
+      // No maps from an earlier run yet (e.g. the run that fills them).
+      continue;
+    }
+    const std::string name = fc.outputPrefix + "_fractions";
+    cm.registerCorrection(name, file, name, fc.inputColumns);
+    setFractionCorrection(cm, name, fc.inputColumns);
+  }
 }
 
 // ---------------------------------------------------------------------------
@@ -680,82 +1062,14 @@ void TaggerWorkingPointManager::defineFixedWorkingPointWeightColumn(
     const std::vector<std::string> &perWorkingPointSFColumns,
     const std::vector<std::string> &perWorkingPointEfficiencyColumns,
     const std::string &outputWeightColumn) {
+  // The SFs and efficiencies of all working points are stacked into one
+  // flat column each (working point major), read with the category index.
   const std::string packedSFCol = "_twm_fixedwp_sf_" + outputWeightColumn;
   const std::string packedEffCol = "_twm_fixedwp_eff_" + outputWeightColumn;
-
-  {
-    ROOT::RDF::RNode df = dataManager_m->getDataFrame();
-    const std::string firstCol = perWorkingPointSFColumns.front();
-    auto newDf = df.Define(
-        packedSFCol,
-        [](const ROOT::VecOps::RVec<Float_t> &values)
-            -> ROOT::VecOps::RVec<ROOT::VecOps::RVec<Float_t>> {
-          ROOT::VecOps::RVec<ROOT::VecOps::RVec<Float_t>> packed(values.size());
-          for (std::size_t index = 0; index < values.size(); ++index)
-            packed[index] = ROOT::VecOps::RVec<Float_t>{values[index]};
-          return packed;
-        },
-        {firstCol});
-    dataManager_m->setDataFrame(newDf);
-  }
-
-  for (std::size_t wpIndex = 1; wpIndex < perWorkingPointSFColumns.size();
-       ++wpIndex) {
-    ROOT::RDF::RNode df = dataManager_m->getDataFrame();
-    const std::string sfColumn = perWorkingPointSFColumns[wpIndex];
-    auto newDf = df.Redefine(
-        packedSFCol,
-        [](ROOT::VecOps::RVec<ROOT::VecOps::RVec<Float_t>> packed,
-           const ROOT::VecOps::RVec<Float_t> &values)
-            -> ROOT::VecOps::RVec<ROOT::VecOps::RVec<Float_t>> {
-          if (packed.size() != values.size())
-            throw std::runtime_error(
-                "TaggerWorkingPointManager: fixed-WP SF columns have "
-                "different lengths per event");
-          for (std::size_t index = 0; index < packed.size(); ++index)
-            packed[index].push_back(values[index]);
-          return packed;
-        },
-        {packedSFCol, sfColumn});
-    dataManager_m->setDataFrame(newDf);
-  }
-
-  {
-    ROOT::RDF::RNode df = dataManager_m->getDataFrame();
-    const std::string firstCol = perWorkingPointEfficiencyColumns.front();
-    auto newDf = df.Define(
-        packedEffCol,
-        [](const ROOT::VecOps::RVec<Float_t> &values)
-            -> ROOT::VecOps::RVec<ROOT::VecOps::RVec<Float_t>> {
-          ROOT::VecOps::RVec<ROOT::VecOps::RVec<Float_t>> packed(values.size());
-          for (std::size_t index = 0; index < values.size(); ++index)
-            packed[index] = ROOT::VecOps::RVec<Float_t>{values[index]};
-          return packed;
-        },
-        {firstCol});
-    dataManager_m->setDataFrame(newDf);
-  }
-
-  for (std::size_t wpIndex = 1;
-       wpIndex < perWorkingPointEfficiencyColumns.size(); ++wpIndex) {
-    ROOT::RDF::RNode df = dataManager_m->getDataFrame();
-    const std::string effColumn = perWorkingPointEfficiencyColumns[wpIndex];
-    auto newDf = df.Redefine(
-        packedEffCol,
-        [](ROOT::VecOps::RVec<ROOT::VecOps::RVec<Float_t>> packed,
-           const ROOT::VecOps::RVec<Float_t> &values)
-            -> ROOT::VecOps::RVec<ROOT::VecOps::RVec<Float_t>> {
-          if (packed.size() != values.size())
-            throw std::runtime_error(
-                "TaggerWorkingPointManager: fixed-WP efficiency columns "
-                "have different lengths per event");
-          for (std::size_t index = 0; index < packed.size(); ++index)
-            packed[index].push_back(values[index]);
-          return packed;
-        },
-        {packedEffCol, effColumn});
-    dataManager_m->setDataFrame(newDf);
-  }
+  defineStackedColumn(*dataManager_m, packedSFCol, perWorkingPointSFColumns,
+                      "fixed-WP SF");
+  defineStackedColumn(*dataManager_m, packedEffCol,
+                      perWorkingPointEfficiencyColumns, "fixed-WP efficiency");
 
   ROOT::RDF::RNode df = dataManager_m->getDataFrame();
   const std::string collectionCol = inputObjectCollectionColumn_m;
@@ -764,196 +1078,131 @@ void TaggerWorkingPointManager::defineFixedWorkingPointWeightColumn(
 
   auto newDf = df.Define(
       outputWeightColumn,
-      [nWorkingPoints](
-          const PhysicsObjectCollection &objects,
-          const ROOT::VecOps::RVec<Int_t> &category,
-          const ROOT::VecOps::RVec<ROOT::VecOps::RVec<Float_t>> &sfPacked,
-          const ROOT::VecOps::RVec<ROOT::VecOps::RVec<Float_t>> &effPacked)
-          -> Float_t {
-        auto unityIfInvalid = [](Float_t numerator,
-                                 Float_t denominator) -> Float_t {
-          if (!std::isfinite(numerator) || !std::isfinite(denominator) ||
-              denominator <= 0.0f || numerator < 0.0f) {
-            return 1.0f;
-          }
-          const Float_t value = numerator / denominator;
-          if (!std::isfinite(value) || value < 0.0f)
-            return 1.0f;
-          return value;
-        };
-
-        Float_t weight = 1.0f;
-        for (std::size_t objectIndex = 0; objectIndex < objects.size();
-             ++objectIndex) {
-          const Int_t idx = objects.index(objectIndex);
-          if (idx < 0)
-            continue;
-
-          const std::size_t flatIndex = static_cast<std::size_t>(idx);
-          if (flatIndex >= category.size() || flatIndex >= sfPacked.size() ||
-              flatIndex >= effPacked.size()) {
-            continue;
-          }
-
-          const auto &sfValues = sfPacked[flatIndex];
-          const auto &effValues = effPacked[flatIndex];
-          if (sfValues.size() < nWorkingPoints ||
-              effValues.size() < nWorkingPoints) {
-            continue;
-          }
-
-          const Int_t cat = category[flatIndex];
-          Float_t factor = 1.0f;
-
-          if (cat <= 0) {
-            const Float_t effLoose = effValues[0];
-            const Float_t sfLoose = sfValues[0];
-            factor = unityIfInvalid(1.0f - sfLoose * effLoose,
-                                    1.0f - effLoose);
-          } else if (static_cast<std::size_t>(cat) >= nWorkingPoints) {
-            factor = sfValues[nWorkingPoints - 1];
-            if (!std::isfinite(factor) || factor < 0.0f)
-              factor = 1.0f;
-          } else {
-            const std::size_t lower = static_cast<std::size_t>(cat) - 1;
-            const std::size_t upper = static_cast<std::size_t>(cat);
-            const Float_t effLower = effValues[lower];
-            const Float_t effUpper = effValues[upper];
-            const Float_t sfLower = sfValues[lower];
-            const Float_t sfUpper = sfValues[upper];
-            factor = unityIfInvalid(sfLower * effLower - sfUpper * effUpper,
-                                    effLower - effUpper);
-          }
-
-          weight *= factor;
-        }
-        return weight;
+      [nWorkingPoints](const PhysicsObjectCollection &objects,
+                       const ROOT::VecOps::RVec<Int_t> &category,
+                       const ROOT::VecOps::RVec<Float_t> &sfPacked,
+                       const ROOT::VecOps::RVec<Float_t> &effPacked) -> Float_t {
+        if (effPacked.size() != sfPacked.size())
+          return 1.0f;
+        return fixedWorkingPointEventWeight(objects, category, sfPacked.data(),
+                                            effPacked.data(),
+                                            sfPacked.size() / nWorkingPoints,
+                                            nWorkingPoints);
       },
       {collectionCol, categoryCol, packedSFCol, packedEffCol});
   dataManager_m->setDataFrame(newDf);
 }
 
 // ---------------------------------------------------------------------------
-// defineWPCategoryColumn() — private helper called from execute()
+// defineFixedWorkingPointSweepColumns — private helper called from execute()
 // ---------------------------------------------------------------------------
 
-void TaggerWorkingPointManager::defineWPCategoryColumn() {
-  const std::string catCol = wpCategoryColumn();
-  const std::vector<WorkingPointEntry> wps = workingPoints_m;
-
-  if (taggerColumns_m.size() == 1) {
-    // -----------------------------------------------------------------------
-    // Single-score path (fast path — existing logic, no intermediate columns).
-    // -----------------------------------------------------------------------
-    ROOT::RDF::RNode df = dataManager_m->getDataFrame();
-    const std::string taggerCol = taggerColumns_m[0];
+void TaggerWorkingPointManager::defineFixedWorkingPointSweepColumns(
+    const FixedWorkingPointSweepStep &step) {
+  const std::string &first = step.outputWeightColumns.front();
+  const std::string cacheCol = "_twm_fixedwp_sfcache_" + first;
+  const std::string effCol = "_twm_fixedwp_eff_" + first;
+  const std::string categoryCol = wpCategoryColumn();
+  const std::size_t nWorkingPoints = workingPoints_m.size();
 
-    auto newDf = df.Define(
-        catCol,
-        [wps](const ROOT::VecOps::RVec<Float_t> &score)
-            -> ROOT::VecOps::RVec<Int_t> {
-          ROOT::VecOps::RVec<Int_t> cat(score.size(), 0);
-          for (std::size_t i = 0; i < score.size(); ++i) {
-            Int_t c = 0;
-            for (const auto &wp : wps) {
-              if (score[i] >= wp.thresholds[0])
-                ++c;
-              else
-                break;
-            }
-            cat[i] = c;
-          }
-          return cat;
+  auto sweep = step.sweep;
+  ROOT::RDF::RNode df = dataManager_m->getDataFrame();
+  if (step.flavourColumn.empty()) {
+    dataManager_m->setDataFrame(df.Define(
+        cacheCol,
+        [sweep](const ROOT::VecOps::RVec<double> &inputs,
+                const ROOT::VecOps::RVec<Int_t> &category) {
+          return sweep->evaluate(inputs, category, {});
         },
-        {taggerCol});
-    dataManager_m->setDataFrame(newDf);
-
+        {step.inputColumn, categoryCol}));
   } else {
-    // -----------------------------------------------------------------------
-    // Multi-score path: pack all discriminant scores per object into a
-    // RVec<RVec<Float_t>> intermediate column, then compute category.
-    //
-    // The packed column is named "_twm_packed_<catCol>" so multiple instances
-    // of the plugin don't collide.
-    // -----------------------------------------------------------------------
-    const std::string packedCol = "_twm_packed_" + catCol;
-    const std::size_t numScores = taggerColumns_m.size();
-
-    // Step A: initialise packed column from first tagger score.
-    {
-      ROOT::RDF::RNode df = dataManager_m->getDataFrame();
-      const std::string firstCol = taggerColumns_m[0];
-      auto newDf = df.Define(
-          packedCol,
-          [](const ROOT::VecOps::RVec<Float_t> &s)
-              -> ROOT::VecOps::RVec<ROOT::VecOps::RVec<Float_t>> {
-            ROOT::VecOps::RVec<ROOT::VecOps::RVec<Float_t>> result(s.size());
-            for (std::size_t i = 0; i < s.size(); ++i)
-              result[i] = ROOT::VecOps::RVec<Float_t>{s[i]};
-            return result;
-          },
-          {firstCol});
-      dataManager_m->setDataFrame(newDf);
-    }
+    dataManager_m->setDataFrame(df.Define(
+        cacheCol,
+        [sweep](const ROOT::VecOps::RVec<double> &inputs,
+                const ROOT::VecOps::RVec<Int_t> &category,
+                const ROOT::VecOps::RVec<Int_t> &flavour) {
+          return sweep->evaluate(inputs, category, flavour);
+        },
+        {step.inputColumn, categoryCol, step.flavourColumn}));
+  }
+  defineStackedColumn(*dataManager_m, effCol, step.perWorkingPointEfficiencyColumns,
+                      "fixed-WP efficiency");
+
+  const std::size_t nVariations = step.outputWeightColumns.size();
+  for (std::size_t v = 0; v < nVariations; ++v) {
+    ROOT::RDF::RNode current = dataManager_m->getDataFrame();
+    dataManager_m->setDataFrame(current.Define(
+        step.outputWeightColumns[v],
+        [v, nVariations, nWorkingPoints](const PhysicsObjectCollection &objects,
+                                         const ROOT::VecOps::RVec<Int_t> &category,
+                                         const ROOT::VecOps::RVec<Float_t> &sfCache,
+                                         const ROOT::VecOps::RVec<Float_t> &eff) -> Float_t {
+          const std::size_t stride = sfCache.size() / nVariations;
+          if (eff.size() != stride)
+            return 1.0f;
+          return fixedWorkingPointEventWeight(objects, category,
+                                              sfCache.data() + v * stride, eff.data(),
+                                              stride / nWorkingPoints, nWorkingPoints);
+        },
+        {inputObjectCollectionColumn_m, categoryCol, cacheCol, effCol}));
+  }
+}
 
-    // Step B: append each additional tagger score column.
-    for (std::size_t k = 1; k < taggerColumns_m.size(); ++k) {
-      ROOT::RDF::RNode df = dataManager_m->getDataFrame();
-      const std::string scoreCol = taggerColumns_m[k];
-      auto newDf = df.Redefine(
-          packedCol,
-          [](ROOT::VecOps::RVec<ROOT::VecOps::RVec<Float_t>> packed,
-             const ROOT::VecOps::RVec<Float_t> &s)
-              -> ROOT::VecOps::RVec<ROOT::VecOps::RVec<Float_t>> {
-            // Both columns must have the same number of objects per event.
-            // Size mismatches indicate a configuration error (mismatched
-            // tagger columns or incorrectly sized branches).
-            if (packed.size() != s.size())
-              throw std::runtime_error(
-                  "TaggerWorkingPointManager: tagger score columns have "
-                  "different lengths per event — ensure all setTaggerColumns() "
-                  "columns have one entry per object");
-            for (std::size_t i = 0; i < packed.size(); ++i)
-              packed[i].push_back(s[i]);
-            return packed;
-          },
-          {packedCol, scoreCol});
-      dataManager_m->setDataFrame(newDf);
+// ---------------------------------------------------------------------------
+// defineWPCategoryColumn() — private helper called from execute()
+// ---------------------------------------------------------------------------
+
+void TaggerWorkingPointManager::defineWPCategoryColumn() {
+  const std::string catCol = wpCategoryColumn();
+
+  // An object passes working point w if every score passes its threshold
+  // for w, so its category is the minimum over the scores of the number of
+  // leading working points that score passes.  Each score is categorised
+  // against its threshold array in one pass, without packing the scores per
+  // object.
+  for (std::size_t k = 0; k < taggerColumns_m.size(); ++k) {
+    std::vector<float> thresholds;
+    thresholds.reserve(workingPoints_m.size());
+    for (const auto &wp : workingPoints_m) {
+      if (k >= wp.thresholds.size())
+        throw std::runtime_error(
+            "TaggerWorkingPointManager::execute: working point '" + wp.name +
+            "' has " + std::to_string(wp.thresholds.size()) +
+            " thresholds but " + std::to_string(taggerColumns_m.size()) +
+            " tagger columns are set");
+      thresholds.push_back(wp.thresholds[k]);
     }
+    const bool ascending = std::is_sorted(thresholds.begin(), thresholds.end());
 
-    // Step C: compute category from packed scores.
-    {
-      ROOT::RDF::RNode df = dataManager_m->getDataFrame();
-      auto newDf = df.Define(
+    ROOT::RDF::RNode df = dataManager_m->getDataFrame();
+    if (k == 0) {
+      dataManager_m->setDataFrame(df.Define(
           catCol,
-          [wps, numScores](
-              const ROOT::VecOps::RVec<ROOT::VecOps::RVec<Float_t>> &packed)
-              -> ROOT::VecOps::RVec<Int_t> {
-            ROOT::VecOps::RVec<Int_t> cat(packed.size(), 0);
-            for (std::size_t i = 0; i < packed.size(); ++i) {
-              const auto &scores = packed[i];
-              Int_t c = 0;
-              for (const auto &wp : wps) {
-                bool passes = true;
-                for (std::size_t k = 0; k < numScores; ++k) {
-                  if (k >= scores.size() ||
-                      scores[k] < wp.thresholds[k]) {
-                    passes = false;
-                    break;
-                  }
-                }
-                if (passes)
-                  ++c;
-                else
-                  break;
-              }
-              cat[i] = c;
-            }
+          [thresholds, ascending](const ROOT::VecOps::RVec<Float_t> &score) {
+            ROOT::VecOps::RVec<Int_t> cat(score.size());
+            for (std::size_t i = 0; i < score.size(); ++i)
+              cat[i] = passedWorkingPoints(score[i], thresholds, ascending);
             return cat;
           },
-          {packedCol});
-      dataManager_m->setDataFrame(newDf);
+          {taggerColumns_m[k]}));
+      continue;
     }
+    dataManager_m->setDataFrame(df.Redefine(
+        catCol,
+        [thresholds, ascending](ROOT::VecOps::RVec<Int_t> cat,
+                                const ROOT::VecOps::RVec<Float_t> &score) {
+          // Size mismatches indicate a configuration error (mismatched
+          // tagger columns or incorrectly sized branches).
+          if (cat.size() != score.size())
+            throw std::runtime_error(
+                "TaggerWorkingPointManager: tagger score columns have "
+                "different lengths per event — ensure all setTaggerColumns() "
+                "columns have one entry per object");
+          for (std::size_t i = 0; i < cat.size(); ++i)
+            cat[i] = std::min(cat[i], passedWorkingPoints(score[i], thresholds, ascending));
+          return cat;
+        },
+        {catCol, taggerColumns_m[k]}));
   }
 }
 
@@ -987,6 +1236,10 @@ void TaggerWorkingPointManager::execute() {
         step.outputWeightColumn);
   }
 
+  for (const auto &step : fixedWPSweepSteps_m) {
+    defineFixedWorkingPointSweepColumns(step);
+  }
+
   // -------------------------------------------------------------------------
   // 3. Define WP-filtered PhysicsObjectCollection columns.
   // -------------------------------------------------------------------------
@@ -1127,15 +1380,25 @@ void TaggerWorkingPointManager::execute() {
     // Build the PhysicsObjectVariationMap using the same fold-redefine
     // pattern as JetEnergyScaleManager.
     if (!mapCol.empty()) {
+      // Slot 0 is "nominal", followed by the up/down collections of each
+      // variation; the name table is shared by the maps of all events.
+      std::vector<std::string> keyNames = {"nominal"};
+      for (const auto &name : varNames) {
+        keyNames.push_back(name + "Up");
+        keyNames.push_back(name + "Down");
+      }
+      const auto keys =
+          std::make_shared<const PhysicsObjectVariationMap::Keys>(keyNames);
+
       // Step A: initialise the map with just the nominal collection.
       {
         ROOT::RDF::RNode df = dataManager_m->getDataFrame();
         auto newDf = df.Define(
             mapCol,
-            [](const PhysicsObjectCollection &nominalCol)
+            [keys](const PhysicsObjectCollection &nominalCol)
                 -> PhysicsObjectVariationMap {
-              PhysicsObjectVariationMap m;
-              m.emplace("nominal", nominalCol);
+              PhysicsObjectVariationMap m(keys);
+              m.set(0, nominalCol);
               return m;
             },
             {nomCol});
@@ -1144,36 +1407,21 @@ void TaggerWorkingPointManager::execute() {
 
       // Step B: fold in each variation's up and down collections.
       for (std::size_t i = 0; i < varNames.size(); ++i) {
-        const std::string keyUp = varNames[i] + "Up";
-        const std::string keyDn = varNames[i] + "Down";
-
-        {
-          ROOT::RDF::RNode df = dataManager_m->getDataFrame();
-          auto newDf = df.Redefine(
-              mapCol,
-              [keyUp](PhysicsObjectVariationMap m,
-                      const PhysicsObjectCollection &upCol)
-                  -> PhysicsObjectVariationMap {
-                m.emplace(keyUp, upCol);
-                return m;
-              },
-              {mapCol, upColNames[i]});
-          dataManager_m->setDataFrame(newDf);
-        }
-
-        {
-          ROOT::RDF::RNode df = dataManager_m->getDataFrame();
-          auto newDf = df.Redefine(
-              mapCol,
-              [keyDn](PhysicsObjectVariationMap m,
-                      const PhysicsObjectCollection &dnCol)
-                  -> PhysicsObjectVariationMap {
-                m.emplace(keyDn, dnCol);
-                return m;
-              },
-              {mapCol, dnColNames[i]});
-          dataManager_m->setDataFrame(newDf);
-        }
+        const std::size_t slotUp = keys->slot(varNames[i] + "Up");
+        const std::size_t slotDn = keys->slot(varNames[i] + "Down");
+        ROOT::RDF::RNode df = dataManager_m->getDataFrame();
+        auto newDf = df.Redefine(
+            mapCol,
+            [slotUp, slotDn](PhysicsObjectVariationMap m,
+                             const PhysicsObjectCollection &upCol,
+                             const PhysicsObjectCollection &dnCol)
+                -> PhysicsObjectVariationMap {
+              m.set(slotUp, upCol);
+              m.set(slotDn, dnCol);
+              return m;
+            },
+            {mapCol, upColNames[i], dnColNames[i]});
+        dataManager_m->setDataFrame(newDf);
       }
     }
   }
@@ -1192,8 +1440,18 @@ void TaggerWorkingPointManager::execute() {
   }
 
   // -------------------------------------------------------------------------
-  // 6. Book fraction histograms (pre-processing mode).
+  // 6. Book fraction histograms.
+  //
+  // The (pt, |η|, flavour) bin of every object is computed once per
+  // configuration; each histogram then only selects the objects of its bin,
+  // so booking the maps alongside the analysis adds one pass over the objects
+  // per configuration rather than one per histogram.
   // -------------------------------------------------------------------------
+  if (!fractionHistogramConfigs_m.empty() &&
+      (taggerColumns_m.empty() || inputObjectCollectionColumn_m.empty()))
+    throw std::runtime_error(
+        "TaggerWorkingPointManager::execute: fraction histograms need "
+        "setTaggerColumn(s)() and setInputObjectCollection()");
   for (const auto &cfg : fractionHistogramConfigs_m) {
     const std::size_t nPt  = cfg.ptBinEdges.size() - 1;
     const std::size_t nEta = cfg.etaBinEdges.size() - 1;
@@ -1203,18 +1461,95 @@ void TaggerWorkingPointManager::execute() {
     const std::vector<std::string> flavourLabels =
         hasFlavour ? std::vector<std::string>{"b", "c", "light"}
                    : std::vector<std::string>{""};
+    const std::size_t nFl = flavourLabels.size();
+
+    // Per-object source index and flat bin (iPt * nEta + iEta) * nFl + iFl,
+    // for the objects inside the binning.
+    const std::string idxCol = "_frac_idx_" + cfg.outputPrefix;
+    const std::string binCol = "_frac_bin_" + cfg.outputPrefix;
+    const std::vector<float> ptEdges = cfg.ptBinEdges;
+    const std::vector<float> etaEdges = cfg.etaBinEdges;
+    auto findBin = [](const std::vector<float> &edges, Float_t x) -> int {
+      if (x < edges.front() || x >= edges.back()) return -1;
+      return static_cast<int>(
+          std::upper_bound(edges.begin(), edges.end(), x) - edges.begin()) - 1;
+    };
+    auto objectBins =
+        [ptEdges, etaEdges, nEta, nFl, findBin](
+            const PhysicsObjectCollection &jets, std::size_t nSource,
+            const ROOT::VecOps::RVec<Int_t> *flavour) {
+          ROOT::VecOps::RVec<Int_t> idx, bins;
+          idx.reserve(jets.size());
+          bins.reserve(jets.size());
+          for (std::size_t i = 0; i < jets.size(); ++i) {
+            const int iPt = findBin(ptEdges, static_cast<Float_t>(jets.at(i).Pt()));
+            const int iEta = findBin(
+                etaEdges, static_cast<Float_t>(std::fabs(jets.at(i).Eta())));
+            const Int_t j = jets.index(i);
+            if (iPt < 0 || iEta < 0 || j < 0 ||
+                static_cast<std::size_t>(j) >= nSource)
+              continue;
+            int iFl = 0;
+            if (flavour) {
+              const std::size_t js = static_cast<std::size_t>(j);
+              const Int_t fl = js < flavour->size() ? (*flavour)[js] : 0;
+              iFl = fl == 5 ? 0 : (fl == 4 ? 1 : 2);
+            }
+            idx.push_back(j);
+            bins.push_back(static_cast<Int_t>(
+                (static_cast<std::size_t>(iPt) * nEta + iEta) * nFl + iFl));
+          }
+          return std::make_pair(idx, bins);
+        };
+    const std::string pairCol = "_frac_objbins_" + cfg.outputPrefix;
+    ROOT::RDF::RNode dfBins = dataManager_m->getDataFrame();
+    if (!hasFlavour) {
+      dfBins = dfBins.Define(
+          pairCol,
+          [objectBins](const PhysicsObjectCollection &jets,
+                       const ROOT::VecOps::RVec<Float_t> &tagger) {
+            return objectBins(jets, tagger.size(), nullptr);
+          },
+          {inputObjectCollectionColumn_m, taggerColumns_m[0]});
+    } else {
+      dfBins = dfBins.Define(
+          pairCol,
+          [objectBins](const PhysicsObjectCollection &jets,
+                       const ROOT::VecOps::RVec<Float_t> &tagger,
+                       const ROOT::VecOps::RVec<Int_t> &flavour) {
+            return objectBins(jets, tagger.size(), &flavour);
+          },
+          {inputObjectCollectionColumn_m, taggerColumns_m[0],
+           cfg.flavourColumn});
+    }
+    using ObjectBins =
+        std::pair<ROOT::VecOps::RVec<Int_t>, ROOT::VecOps::RVec<Int_t>>;
+    dfBins = dfBins
+                 .Define(idxCol, [](const ObjectBins &p) { return p.first; },
+                         {pairCol})
+                 .Define(binCol, [](const ObjectBins &p) { return p.second; },
+                         {pairCol});
+    dataManager_m->setDataFrame(dfBins);
+
+    // Values of the objects in one bin, as Float_t for Histo1D.
+    auto selectBin = [](Int_t bin) {
+      return [bin](const ROOT::VecOps::RVec<Int_t> &idx,
+                   const ROOT::VecOps::RVec<Int_t> &bins,
+                   const auto &values) -> ROOT::VecOps::RVec<Float_t> {
+        ROOT::VecOps::RVec<Float_t> out;
+        for (std::size_t k = 0; k < bins.size(); ++k) {
+          if (bins[k] == bin)
+            out.push_back(static_cast<Float_t>(
+                values[static_cast<std::size_t>(idx[k])]));
+        }
+        return out;
+      };
+    };
 
     for (std::size_t iPt = 0; iPt < nPt; ++iPt) {
       for (std::size_t iEta = 0; iEta < nEta; ++iEta) {
-        for (std::size_t iFl = 0; iFl < flavourLabels.size(); ++iFl) {
-          const float ptLow   = cfg.ptBinEdges[iPt];
-          const float ptHigh  = cfg.ptBinEdges[iPt + 1];
-          const float etaLow  = cfg.etaBinEdges[iEta];
-          const float etaHigh = cfg.etaBinEdges[iEta + 1];
-          // flavTarget: 5=b, 4=c, -1=light (anything else)
-          const int flavTarget = hasFlavour
-              ? (iFl == 0 ? 5 : (iFl == 1 ? 4 : -1))
-              : 0;
+        for (std::size_t iFl = 0; iFl < nFl; ++iFl) {
+          const Int_t bin = static_cast<Int_t>((iPt * nEta + iEta) * nFl + iFl);
 
           // Build histogram name.
           std::ostringstream hname;
@@ -1222,73 +1557,19 @@ void TaggerWorkingPointManager::execute() {
           if (hasFlavour) hname << "_" << flavourLabels[iFl];
           const std::string histName = hname.str();
 
-          // Build an intermediate column with the selected jet scores.
           // For multi-score WPs, use the first tagger column for the fraction
           // histogram (the primary discriminant).
           const std::string scoreSelCol = "_frac_score_" + histName;
-          const std::string taggerCol   = taggerColumns_m[0];
-          const std::string collectionCol = inputObjectCollectionColumn_m;
-          const std::string flavCol     = cfg.flavourColumn;
-
-          if (!hasFlavour) {
-            ROOT::RDF::RNode df = dataManager_m->getDataFrame();
-            auto newDf = df.Define(
-                scoreSelCol,
-                [ptLow, ptHigh, etaLow, etaHigh](
-                    const PhysicsObjectCollection &jets,
-                    const ROOT::VecOps::RVec<Float_t> &tagger)
-                    -> ROOT::VecOps::RVec<Float_t> {
-                  ROOT::VecOps::RVec<Float_t> scores;
-                  for (std::size_t i = 0; i < jets.size(); ++i) {
-                    const Float_t pt  = static_cast<Float_t>(jets.at(i).Pt());
-                    const Float_t eta = static_cast<Float_t>(
-                        std::fabs(jets.at(i).Eta()));
-                    if (pt < ptLow || pt >= ptHigh) continue;
-                    if (eta < etaLow || eta >= etaHigh) continue;
-                    const Int_t idx = jets.index(i);
-                    if (idx >= 0 &&
-                        static_cast<std::size_t>(idx) < tagger.size())
-                      scores.push_back(
-                          tagger[static_cast<std::size_t>(idx)]);
-                  }
-                  return scores;
-                },
-                {collectionCol, taggerCol});
-            dataManager_m->setDataFrame(newDf);
-          } else {
-            ROOT::RDF::RNode df = dataManager_m->getDataFrame();
-            auto newDf = df.Define(
-                scoreSelCol,
-                [ptLow, ptHigh, etaLow, etaHigh, flavTarget](
-                    const PhysicsObjectCollection &jets,
-                    const ROOT::VecOps::RVec<Float_t> &tagger,
-                    const ROOT::VecOps::RVec<Int_t> &flavour)
-                    -> ROOT::VecOps::RVec<Float_t> {
-                  ROOT::VecOps::RVec<Float_t> scores;
-                  for (std::size_t i = 0; i < jets.size(); ++i) {
-                    const Float_t pt  = static_cast<Float_t>(jets.at(i).Pt());
-                    const Float_t eta = static_cast<Float_t>(
-                        std::fabs(jets.at(i).Eta()));
-                    if (pt < ptLow || pt >= ptHigh) continue;
-                    if (eta < etaLow || eta >= etaHigh) continue;
-                    const Int_t idx = jets.index(i);
-                    if (idx < 0 ||
-                        static_cast<std::size_t>(idx) >= tagger.size())
-                      continue;
-                    const std::size_t j = static_cast<std::size_t>(idx);
-                    const Int_t fl = (j < flavour.size()) ? flavour[j] : 0;
-                    const bool matchFlavour =
-                        (flavTarget == 5  && fl == 5) ||
-                        (flavTarget == 4  && fl == 4) ||
-                        (flavTarget == -1 && fl != 5 && fl != 4);
-                    if (!matchFlavour) continue;
-                    scores.push_back(tagger[j]);
-                  }
-                  return scores;
-                },
-                {collectionCol, taggerCol, flavCol});
-            dataManager_m->setDataFrame(newDf);
-          }
+          ROOT::RDF::RNode df = dataManager_m->getDataFrame();
+          auto newDf = df.Define(
+              scoreSelCol,
+              [select = selectBin(bin)](const ROOT::VecOps::RVec<Int_t> &idx,
+                                        const ROOT::VecOps::RVec<Int_t> &bins,
+                                        const ROOT::VecOps::RVec<Float_t> &tagger) {
+                return select(idx, bins, tagger);
+              },
+              {idxCol, binCol, taggerColumns_m[0]});
+          dataManager_m->setDataFrame(newDf);
 
           // Book a 1D histogram of tagger scores in [0, 1].
           ROOT::RDF::RNode dfHist = dataManager_m->getDataFrame();
@@ -1306,71 +1587,17 @@ void TaggerWorkingPointManager::execute() {
                 "_eta" + std::to_string(iEta) +
                 (hasFlavour ? "_" + flavourLabels[iFl] : "");
             const std::string catSelCol = "_frac_cat_" + catHistName;
-            const std::string catColName = wpCategoryColumn();
-
-            if (!hasFlavour) {
-              ROOT::RDF::RNode dfCat = dataManager_m->getDataFrame();
-              auto newDfCat = dfCat.Define(
-                  catSelCol,
-                  [ptLow, ptHigh, etaLow, etaHigh](
-                      const PhysicsObjectCollection &jets,
-                      const ROOT::VecOps::RVec<Int_t> &category)
-                      -> ROOT::VecOps::RVec<Float_t> {
-                    ROOT::VecOps::RVec<Float_t> cats;
-                    for (std::size_t i = 0; i < jets.size(); ++i) {
-                      const Float_t pt =
-                          static_cast<Float_t>(jets.at(i).Pt());
-                      const Float_t eta = static_cast<Float_t>(
-                          std::fabs(jets.at(i).Eta()));
-                      if (pt < ptLow || pt >= ptHigh) continue;
-                      if (eta < etaLow || eta >= etaHigh) continue;
-                      const Int_t idx = jets.index(i);
-                      if (idx >= 0 &&
-                          static_cast<std::size_t>(idx) < category.size())
-                        cats.push_back(static_cast<Float_t>(
-                            category[static_cast<std::size_t>(idx)]));
-                    }
-                    return cats;
-                  },
-                  {collectionCol, catColName});
-              dataManager_m->setDataFrame(newDfCat);
-            } else {
-              ROOT::RDF::RNode dfCat = dataManager_m->getDataFrame();
-              auto newDfCat = dfCat.Define(
-                  catSelCol,
-                  [ptLow, ptHigh, etaLow, etaHigh, flavTarget](
-                      const PhysicsObjectCollection &jets,
-                      const ROOT::VecOps::RVec<Int_t> &category,
-                      const ROOT::VecOps::RVec<Int_t> &flavour)
-                      -> ROOT::VecOps::RVec<Float_t> {
-                    ROOT::VecOps::RVec<Float_t> cats;
-                    for (std::size_t i = 0; i < jets.size(); ++i) {
-                      const Float_t pt =
-                          static_cast<Float_t>(jets.at(i).Pt());
-                      const Float_t eta = static_cast<Float_t>(
-                          std::fabs(jets.at(i).Eta()));
-                      if (pt < ptLow || pt >= ptHigh) continue;
-                      if (eta < etaLow || eta >= etaHigh) continue;
-                      const Int_t idx = jets.index(i);
-                      if (idx < 0 ||
-                          static_cast<std::size_t>(idx) >= category.size())
-                        continue;
-                      const std::size_t j = static_cast<std::size_t>(idx);
-                      const Int_t fl =
-                          (j < flavour.size()) ? flavour[j] : 0;
-                      const bool matchFlavour =
-                          (flavTarget == 5  && fl == 5) ||
-                          (flavTarget == 4  && fl == 4) ||
-                          (flavTarget == -1 && fl != 5 && fl != 4);
-                      if (!matchFlavour) continue;
-                      cats.push_back(static_cast<Float_t>(
-                          category[static_cast<std::size_t>(idx)]));
-                    }
-                    return cats;
-                  },
-                  {collectionCol, catColName, flavCol});
-              dataManager_m->setDataFrame(newDfCat);
-            }
+
+            ROOT::RDF::RNode dfCat = dataManager_m->getDataFrame();
+            auto newDfCat = dfCat.Define(
+                catSelCol,
+                [select = selectBin(bin)](const ROOT::VecOps::RVec<Int_t> &idx,
+                                          const ROOT::VecOps::RVec<Int_t> &bins,
+                                          const ROOT::VecOps::RVec<Int_t> &category) {
+                  return select(idx, bins, category);
+                },
+                {idxCol, binCol, wpCategoryColumn()});
+            dataManager_m->setDataFrame(newDfCat);
 
             // N+1 bins from 0 to N+1: one bin per category (0 = fail all,
             // 1..N = count of WPs passed).  The +1 accounts for category 0.
@@ -1430,6 +1657,23 @@ void TaggerWorkingPointManager::finalize() {
       delete histClone;
     }
   }
+
+  // Record the binning of each configuration: the histogram names only carry
+  // bin indices, and the efficiency-map builder reads the edges from here.
+  for (const auto &cfg : fractionHistogramConfigs_m) {
+    const std::vector<double> ptEdges(cfg.ptBinEdges.begin(),
+                                      cfg.ptBinEdges.end());
+    const std::vector<double> etaEdges(cfg.etaBinEdges.begin(),
+                                       cfg.etaBinEdges.end());
+    const std::string binningName = cfg.outputPrefix + "_binning";
+    TH2D binning(binningName.c_str(), (binningName + ";p_{T};|#eta|").c_str(),
+                 static_cast<int>(ptEdges.size()) - 1, ptEdges.data(),
+                 static_cast<int>(etaEdges.size()) - 1, etaEdges.data());
+    binning.SetDirectory(fragDir);
+    fragDir->cd();
+    binning.Write(binningName.c_str(), TObject::kOverwrite);
+    binning.SetDirectory(nullptr);
+  }
   outFile.Close();
 }
 
@@ -1496,6 +1740,14 @@ void TaggerWorkingPointManager::reportMetadata() {
     }
   }
 
+  if (!fixedWPSweepSteps_m.empty()) {
+    ss << "  Fixed-WP weight sweeps (" << fixedWPSweepSteps_m.size() << "):\n";
+    for (const auto &step : fixedWPSweepSteps_m) {
+      ss << "    -> " << step.outputWeightColumns.size() << " variations from "
+         << step.inputColumn << "\n";
+    }
+  }
+
   if (!systematicSets_m.empty()) {
     ss << "  Systematic source sets:\n";
     for (const auto &kv : systematicSets_m) {
@@ -1595,12 +1847,22 @@ TaggerWorkingPointManager::collectProvenanceEntries() const {
   if (hasFractionCorrection_m)
     entries["fraction_correction"] = fractionCorrectionName_m;
 
-  if (!fixedWPWeightSteps_m.empty()) {
+  if (!fixedWPWeightSteps_m.empty() || !fixedWPSweepSteps_m.empty()) {
     std::ostringstream ss;
-    for (std::size_t index = 0; index < fixedWPWeightSteps_m.size(); ++index) {
-      if (index > 0)
+    bool firstColumn = true;
+    for (const auto &step : fixedWPWeightSteps_m) {
+      if (!firstColumn)
         ss << ',';
-      ss << fixedWPWeightSteps_m[index].outputWeightColumn;
+      ss << step.outputWeightColumn;
+      firstColumn = false;
+    }
+    for (const auto &step : fixedWPSweepSteps_m) {
+      for (const auto &column : step.outputWeightColumns) {
+        if (!firstColumn)
+          ss << ',';
+        ss << column;
+        firstColumn = false;
+      }
     }
     entries["fixed_wp_weight_columns"] = ss.str();
   }
@@ -85,6 +85,19 @@ struct WPCollectionSelection {
   std::string wpNameUpper;  ///< Name of the upper WP (only for PassRangeWP)
 };
 
+/**
+ * @brief One systematic variation of
+ *        TaggerWorkingPointManager::defineFixedWorkingPointWeights().
+ */
+struct FixedWorkingPointVariation {
+  std::string systematic;         ///< correctionlib systematic string, e.g. "central"
+  std::string outputWeightColumn; ///< Event-weight column of this variation
+  /// Object flavours whose SF this variation changes; objects of other
+  /// flavours take the SF of the first (reference) variation.  Empty means
+  /// all flavours.
+  std::vector<Int_t> flavours;
+};
+
 // ---------------------------------------------------------------------------
 // TaggerWorkingPointManager
 // ---------------------------------------------------------------------------
@@ -128,8 +141,9 @@ struct WPCollectionSelection {
  *  - **Variation collections and map**: per-variation up/down object collections
  *    and a PhysicsObjectVariationMap for downstream systematic propagation.
  *  - **Fraction histogram utility**: book per-(pt, η, flavour) tagger-score
- *    histograms in a dedicated pre-processing run so the fraction payload can
- *    be constructed from MC data.
+ *    histograms, either in a dedicated pre-processing run or alongside the
+ *    analysis, so the fraction / efficiency payload can be constructed from
+ *    MC data.
  *
  * ## Typical usage — Jets (b-tagging with DeepJet)
  * @code
@@ -471,6 +485,58 @@ public:
       const std::vector<std::string> &perWorkingPointEfficiencyColumns,
       const std::string &outputWeightColumn);
 
+  /**
+   * @brief Define the fixed-WP event weights of several systematic
+   *        variations from one SF sweep per event.
+   *
+   * Instead of one SF column per working point and variation, execute()
+   * defines one per-event cache of the SFs of all variations, filled by a
+   * single pass over the objects.  Each object is evaluated only at the (at
+   * most two) working points its category needs.  An object whose flavour a
+   * variation does not change (see FixedWorkingPointVariation::flavours)
+   * reuses the SF of the first variation.  Every weight column reads the
+   * cache with the defineFixedWorkingPointWeight() formula.
+   *
+   * The string inputs of the correction receive the systematic and the
+   * working-point argument in that order, as in the BTV fixed-WP payloads
+   * (systematic, working_point, flavor, abseta, pt).
+   *
+   * @code
+   *   btag->defineFixedWorkingPointWeights(
+   *       *cm, "deepJet_comb",
+   *       {{"central", "btag_w"},
+   *        {"up_correlated", "btag_w_up", {4, 5}},
+   *        {"down_correlated", "btag_w_down", {4, 5}}},
+   *       {"Jet_hadronFlavour", "Jet_absEta", "Jet_pt"},
+   *       {"eff_L", "eff_M", "eff_T"}, "Jet_hadronFlavour", {"L", "M", "T"});
+   * @endcode
+   *
+   * @param cm              CorrectionManager holding the correction.
+   * @param correctionName  Correction with two string inputs (systematic,
+   *                        working point).
+   * @param variations      Variations; the first is the reference and must
+   *                        apply to all flavours.
+   * @param inputColumns    Numeric inputs of the correction (default: the
+   *                        columns registered with it).
+   * @param perWorkingPointEfficiencyColumns  MC efficiencies in WP order.
+   * @param flavourColumn   RVec<Int_t> flavour column; required when a
+   *                        variation lists flavours.
+   * @param workingPointArguments  Working-point strings of the correction in
+   *                        WP order (default: the working-point names).
+   *
+   * @throws std::runtime_error if setInputObjectCollection() or
+   *         addWorkingPoint() was not called, or if the correction does not
+   *         have two string inputs and one numeric input per input column.
+   * @throws std::invalid_argument for empty or mismatched arguments.
+   */
+  void defineFixedWorkingPointWeights(
+      CorrectionManager &cm, const std::string &correctionName,
+      const std::vector<FixedWorkingPointVariation> &variations,
+      const std::vector<std::string> &inputColumns,
+      const std::vector<std::string> &perWorkingPointEfficiencyColumns,
+      const std::string &flavourColumn = "",
+      const std::vector<std::string> &workingPointArguments = {});
+
   // -------------------------------------------------------------------------
   // Generator-level fraction correction
   // -------------------------------------------------------------------------
@@ -639,10 +705,14 @@ public:
   /**
    * @brief Book per-(pt, η, flavour) tagger-score fraction histograms.
    *
-   * This method is intended for a **dedicated pre-processing run** whose sole
-   * purpose is to compute generator-level object fractions.  The resulting
-   * histograms can be used to build the fraction correctionlib payload consumed
-   * by setFractionCorrection().
+   * The histograms can be booked in a dedicated pre-processing run or in the
+   * analysis run itself, where they are filled in the same event loop (see
+   * also the `fraction_histograms` config block).  The resulting histograms
+   * can be used to build the fraction correctionlib payload consumed by
+   * setFractionCorrection() and the MC efficiencies of
+   * defineFixedWorkingPointWeight(); `core/python/tagger_efficiency_maps.py`
+   * converts them.  The bin edges are written next to them as the axes of
+   * an empty TH2D `<outputPrefix>_binning`.
    *
    * For each combination of (pt-bin, η-bin) a TH1D named
    * `<outputPrefix>_pt<I>_eta<J>[_<flavourLabel>]` is booked in the metadata
@@ -671,6 +741,16 @@ public:
                                  const std::vector<float> &etaBinEdges,
                                  const std::string &flavourColumn = "");
 
+  /**
+   * @brief Path of the efficiency-map payload built for @p outputPrefix by an
+   *        earlier run.
+   *
+   * Returns `<taggerMapDir>/<outputPrefix>.json` when the `taggerMapDir`
+   * config key is set (FullAnalysisDAG sets it for runs that consume the
+   * maps of an earlier run), and an empty string otherwise.
+   */
+  std::string efficiencyMapFile(const std::string &outputPrefix) const;
+
   // -------------------------------------------------------------------------
   // Unfiltered collection (all objects, annotated with WP category)
   // -------------------------------------------------------------------------
@@ -724,7 +804,9 @@ public:
    *
    * Call this after setupFromConfigFile() and before execute() to register
    * the correctionlib scale-factor payloads that were declared in the config
-   * file.
+   * file.  A `fraction_correction` block registers `<outputPrefix>_fractions`
+   * from efficiencyMapFile() and passes it to setFractionCorrection(); it is
+   * skipped when `taggerMapDir` is not set.
    *
    * @param cm  CorrectionManager to apply corrections on.
    */
@@ -874,6 +956,18 @@ private:
   };
   std::vector<FixedWorkingPointWeightStep> fixedWPWeightSteps_m;
 
+  /// Correction and argument layout of a fixed-WP SF sweep (defined in the
+  /// .cc file).
+  struct FixedWorkingPointSweep;
+  struct FixedWorkingPointSweepStep {
+    std::shared_ptr<const FixedWorkingPointSweep> sweep;
+    std::string inputColumn;   ///< flattened correction inputs
+    std::string flavourColumn; ///< may be empty
+    std::vector<std::string> perWorkingPointEfficiencyColumns;
+    std::vector<std::string> outputWeightColumns;
+  };
+  std::vector<FixedWorkingPointSweepStep> fixedWPSweepSteps_m;
+
   // ---- Systematic source sets ---------------------------------------------
   std::unordered_map<std::string, std::vector<std::string>> systematicSets_m;
 
@@ -904,6 +998,13 @@ private:
   };
   std::vector<FractionHistogramConfig> fractionHistogramConfigs_m;
 
+  /// `fraction_correction` config blocks, see applyConfiguredCorrections().
+  struct FractionCorrectionConfig {
+    std::string outputPrefix;
+    std::vector<std::string> inputColumns;
+  };
+  std::vector<FractionCorrectionConfig> fractionCorrections_m;
+
   // ---- Fraction histogram results (populated in execute, used in finalize) -
   struct FractionHistResult {
     std::string name;
@@ -939,6 +1040,9 @@ private:
       const std::vector<std::string> &perWorkingPointEfficiencyColumns,
       const std::string &outputWeightColumn);
 
+  /// Define the SF cache and weight columns of a fixed-WP sweep step.
+  void defineFixedWorkingPointSweepColumns(const FixedWorkingPointSweepStep &step);
+
   /// Define the per-object WP category column (handles single- and multi-score).
   void defineWPCategoryColumn();
 };
@@ -1,11 +1,366 @@
 #include <api/IConfigurationProvider.h>
+#include <AsyncLogger.h>
 #include <analyzer.h>
 #include <api/IDataFrameProvider.h>
 #include <api/ILogger.h>
 #include <api/ISystematicManager.h>
 #include <TriggerManager.h>
 #include <ROOT/RVec.hxx>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <limits>
 #include <stdexcept>
+#include <type_traits>
+#include <unordered_set>
+#include <utility>
+
+namespace {
+
+/// Number of trigger paths packed into one mask word.
+constexpr std::size_t kPathsPerMaskWord = 64;
+
+template <std::size_t>
+using PathBit = bool;
+
+/// Typed kernel packing N boolean path decisions into one word (bit i = path i).
+template <std::size_t... I>
+auto makeMaskKernel(std::index_sequence<I...>) {
+  return [](PathBit<I>... fired) -> std::uint64_t {
+    return (std::uint64_t{0} | ... |
+            (static_cast<std::uint64_t>(fired) << I));
+  };
+}
+
+using MaskWordDefiner = void (*)(IDataFrameProvider &, const std::string &,
+                                 const std::vector<std::string> &,
+                                 ISystematicManager &);
+
+template <std::size_t N>
+void defineMaskWord(IDataFrameProvider &dataManager, const std::string &name,
+                    const std::vector<std::string> &paths,
+                    ISystematicManager &systematicManager) {
+  dataManager.Define(name, makeMaskKernel(std::make_index_sequence<N>{}),
+                     paths, systematicManager);
+}
+
+template <std::size_t... N>
+constexpr std::array<MaskWordDefiner, sizeof...(N)>
+makeMaskWordDefiners(std::index_sequence<N...>) {
+  return {&defineMaskWord<N + 1>...};
+}
+
+/// maskWordDefiners[n - 1] defines a mask word from exactly n path columns.
+constexpr auto maskWordDefiners =
+    makeMaskWordDefiners(std::make_index_sequence<kPathsPerMaskWord>{});
+
+/// True if every path column is a plain bool and can feed the typed kernel.
+bool allBoolColumns(ROOT::RDF::RNode df, const std::vector<std::string> &paths) {
+  for (const auto &path : paths) {
+    const auto columnType = df.GetColumnType(path);
+    if (columnType != "bool" && columnType != "Bool_t") {
+      return false;
+    }
+  }
+  return true;
+}
+
+/// Remove repeated path names while keeping the first occurrence's position.
+std::vector<std::string> uniquePaths(const std::vector<std::string> &paths) {
+  std::vector<std::string> unique;
+  std::unordered_set<std::string> seen;
+  for (const auto &path : paths) {
+    if (seen.insert(path).second) {
+      unique.push_back(path);
+    }
+  }
+  return unique;
+}
+
+/// A trigger object of the matched type with the paths it can serve.
+struct TriggerCandidate {
+  Float_t phi;
+  Float_t eta;
+  std::uint64_t paths;
+};
+
+/**
+ * @brief Match masks of the offline objects against the trigger objects.
+ *
+ * Candidates (trigger objects of the requested type that satisfy at least
+ * one path) are sorted by phi; each offline object scans only the phi window
+ * [phi - dR, phi + dR], split in two where it wraps around +-pi.
+ */
+template <typename Id, typename Bits>
+ROOT::VecOps::RVec<std::uint64_t>
+matchKernel(const ROOT::VecOps::RVec<Float_t> &eta,
+            const ROOT::VecOps::RVec<Float_t> &phi,
+            const ROOT::VecOps::RVec<Float_t> &trigEta,
+            const ROOT::VecOps::RVec<Float_t> &trigPhi,
+            const ROOT::VecOps::RVec<Id> &trigId,
+            const ROOT::VecOps::RVec<Bits> &trigBits, int triggerObjectId,
+            const std::vector<std::uint64_t> &requiredBits, float maxDeltaR) {
+  if (eta.size() != phi.size() || trigEta.size() != trigPhi.size() ||
+      trigEta.size() != trigId.size() || trigEta.size() != trigBits.size()) {
+    throw std::runtime_error(
+        "TriggerManager: inconsistent object or trigger-object array sizes");
+  }
+  ROOT::VecOps::RVec<std::uint64_t> masks(eta.size(), 0);
+
+  ROOT::VecOps::RVecN<TriggerCandidate, 16> candidates;
+  for (std::size_t t = 0; t < trigEta.size(); ++t) {
+    if (static_cast<int>(trigId[t]) != triggerObjectId) {
+      continue;
+    }
+    const auto bits = static_cast<std::uint64_t>(
+        static_cast<std::make_unsigned_t<Bits>>(trigBits[t]));
+    std::uint64_t paths = 0;
+    for (std::size_t p = 0; p < requiredBits.size(); ++p) {
+      if ((bits & requiredBits[p]) == requiredBits[p]) {
+        paths |= std::uint64_t{1} << p;
+      }
+    }
+    if (paths != 0) {
+      candidates.push_back({trigPhi[t], trigEta[t], paths});
+    }
+  }
+  if (candidates.empty()) {
+    return masks;
+  }
+  std::sort(candidates.begin(), candidates.end(),
+            [](const TriggerCandidate &a, const TriggerCandidate &b) {
+              return a.phi < b.phi;
+            });
+
+  constexpr float kPi = static_cast<float>(M_PI);
+  const float maxDeltaR2 = maxDeltaR * maxDeltaR;
+  for (std::size_t i = 0; i < eta.size(); ++i) {
+    std::uint64_t mask = 0;
+    const auto scan = [&](float lo, float hi) {
+      auto it = std::lower_bound(
+          candidates.begin(), candidates.end(), lo,
+          [](const TriggerCandidate &c, float value) { return c.phi < value; });
+      for (; it != candidates.end() && it->phi <= hi; ++it) {
+        float dPhi = std::fabs(phi[i] - it->phi);
+        if (dPhi > kPi) {
+          dPhi = 2.f * kPi - dPhi;
+        }
+        const float dEta = eta[i] - it->eta;
+        if (dEta * dEta + dPhi * dPhi < maxDeltaR2) {
+          mask |= it->paths;
+        }
+      }
+    };
+    const float lo = phi[i] - maxDeltaR;
+    const float hi = phi[i] + maxDeltaR;
+    if (maxDeltaR >= kPi) {
+      scan(-std::numeric_limits<float>::infinity(),
+           std::numeric_limits<float>::infinity());
+    } else {
+      scan(std::max(lo, -kPi), std::min(hi, kPi));
+      if (lo < -kPi) {
+        scan(lo + 2.f * kPi, kPi);
+      }
+      if (hi > kPi) {
+        scan(-kPi, hi - 2.f * kPi);
+      }
+    }
+    masks[i] = mask;
+  }
+  return masks;
+}
+
+/// Element type of an RVec column type name ("ROOT::VecOps::RVec<Int_t>").
+std::string elementType(const std::string &columnType) {
+  const auto open = columnType.find('<');
+  const auto close = columnType.rfind('>');
+  if (open == std::string::npos || close == std::string::npos || close < open) {
+    return columnType;
+  }
+  return columnType.substr(open + 1, close - open - 1);
+}
+
+/// Call @p f with a value of the trigger-object id type of @p columnType.
+template <typename F>
+void dispatchIdType(const std::string &column, const std::string &columnType,
+                    F &&f) {
+  const std::string element = elementType(columnType);
+  if (element == "Int_t" || element == "int") {
+    f(Int_t{});
+  } else if (element == "UShort_t" || element == "unsigned short") {
+    f(UShort_t{});
+  } else {
+    throw std::runtime_error("TriggerManager: unsupported type " + columnType +
+                             " of trigger-object column " + column);
+  }
+}
+
+/// Call @p f with a value of the filter-bit type of @p columnType.
+template <typename F>
+void dispatchBitsType(const std::string &column, const std::string &columnType,
+                      F &&f) {
+  const std::string element = elementType(columnType);
+  if (element == "Int_t" || element == "int") {
+    f(Int_t{});
+  } else if (element == "UInt_t" || element == "unsigned int") {
+    f(UInt_t{});
+  } else if (element == "ULong64_t" || element == "unsigned long" ||
+             element == "unsigned long long") {
+    f(ULong64_t{});
+  } else {
+    throw std::runtime_error("TriggerManager: unsupported type " + columnType +
+                             " of trigger-object column " + column);
+  }
+}
+
+} // namespace
+
+ROOT::VecOps::RVec<std::uint64_t> TriggerManager::matchTriggerObjects(
+    const ROOT::VecOps::RVec<Float_t> &eta, const ROOT::VecOps::RVec<Float_t> &phi,
+    const ROOT::VecOps::RVec<Float_t> &trigEta,
+    const ROOT::VecOps::RVec<Float_t> &trigPhi,
+    const ROOT::VecOps::RVec<Int_t> &trigId,
+    const ROOT::VecOps::RVec<Int_t> &trigFilterBits, int triggerObjectId,
+    const std::vector<std::uint64_t> &requiredBits, float maxDeltaR) {
+  return matchKernel(eta, phi, trigEta, trigPhi, trigId, trigFilterBits,
+                     triggerObjectId, requiredBits, maxDeltaR);
+}
+
+std::string TriggerManager::defineTriggerMatch(const TriggerMatchSpec &spec) {
+  if (!dataManager_m || !systematicManager_m) {
+    throw std::runtime_error(
+        "TriggerManager: DataManager or SystematicManager not set");
+  }
+  if (spec.name.empty() || spec.etaColumn.empty() || spec.phiColumn.empty() ||
+      spec.paths.empty()) {
+    throw std::runtime_error("TriggerManager: trigger match '" + spec.name +
+                             "' needs a name, eta/phi columns and paths");
+  }
+  if (spec.paths.size() > 64) {
+    throw std::runtime_error("TriggerManager: trigger match '" + spec.name +
+                             "' has more than 64 paths");
+  }
+  if (matchPaths_m.count(spec.name) != 0) {
+    throw std::runtime_error("TriggerManager: trigger match '" + spec.name +
+                             "' is already defined");
+  }
+
+  std::vector<std::string> pathNames;
+  std::vector<std::uint64_t> requiredBits;
+  for (const auto &[path, bits] : spec.paths) {
+    pathNames.push_back(path);
+    requiredBits.push_back(bits);
+  }
+  const std::string &prefix = spec.triggerObjectPrefix;
+  const std::vector<std::string> columns = {
+      spec.etaColumn,    spec.phiColumn,  prefix + "_eta",
+      prefix + "_phi",   prefix + "_id",  prefix + "_filterBits"};
+  auto df = dataManager_m->getDataFrame();
+  const int id = spec.triggerObjectId;
+  const float maxDeltaR = spec.maxDeltaR;
+  dispatchIdType(columns[4], df.GetColumnType(columns[4]), [&](auto idTag) {
+    using Id = decltype(idTag);
+    dispatchBitsType(columns[5], df.GetColumnType(columns[5]), [&](auto bitsTag) {
+      using Bits = decltype(bitsTag);
+      dataManager_m->Define(
+          spec.name,
+          [id, requiredBits, maxDeltaR](
+              const ROOT::VecOps::RVec<Float_t> &eta,
+              const ROOT::VecOps::RVec<Float_t> &phi,
+              const ROOT::VecOps::RVec<Float_t> &trigEta,
+              const ROOT::VecOps::RVec<Float_t> &trigPhi,
+              const ROOT::VecOps::RVec<Id> &trigId,
+              const ROOT::VecOps::RVec<Bits> &trigBits) {
+            return matchKernel(eta, phi, trigEta, trigPhi, trigId, trigBits, id,
+                               requiredBits, maxDeltaR);
+          },
+          columns, *systematicManager_m);
+    });
+  });
+  matchPaths_m.emplace(spec.name, std::move(pathNames));
+  return spec.name;
+}
+
+unsigned int TriggerManager::getTriggerMatchBit(const std::string &matchName,
+                                                const std::string &path) const {
+  const auto it = matchPaths_m.find(matchName);
+  if (it == matchPaths_m.end()) {
+    throw std::runtime_error("TriggerManager: unknown trigger match '" +
+                             matchName + "'");
+  }
+  const auto pos = std::find(it->second.begin(), it->second.end(), path);
+  if (pos == it->second.end()) {
+    throw std::runtime_error("TriggerManager: trigger match '" + matchName +
+                             "' has no path '" + path + "'");
+  }
+  return static_cast<unsigned int>(pos - it->second.begin());
+}
+
+void TriggerManager::defineTriggerMatchFlags(const std::string &matchName,
+                                             const std::string &path,
+                                             const std::string &outputColumn) {
+  if (!dataManager_m || !systematicManager_m) {
+    throw std::runtime_error("TriggerManager::defineTriggerMatchFlags: context not set");
+  }
+  const unsigned int bit = getTriggerMatchBit(matchName, path);
+  dataManager_m->Define(
+      outputColumn,
+      [bit](const ROOT::VecOps::RVec<std::uint64_t> &masks) {
+        ROOT::VecOps::RVec<bool> matched(masks.size());
+        for (std::size_t i = 0; i < masks.size(); ++i) {
+          matched[i] = ((masks[i] >> bit) & 1u) != 0;
+        }
+        return matched;
+      },
+      {matchName}, *systematicManager_m);
+}
+
+/**
+ * @brief Define the bitmask column(s) for a list of trigger paths.
+ *
+ * Paths are packed 64 per word: @p name holds paths [0, 64), and further
+ * words "<name>_1", "<name>_2", ... hold the following blocks.  When more
+ * than one word is needed, "<name>_any" is the bitwise OR of all words, so
+ * it is non-zero exactly when at least one path fired.
+ *
+ * @return Name of a uint64_t column that is non-zero iff any path fired.
+ */
+std::string TriggerManager::defineTriggerMask(IDataFrameProvider &dataManager,
+                                              const std::string &name,
+                                              const std::vector<std::string> &paths,
+                                              ISystematicManager &systematicManager) {
+  std::vector<std::string> words;
+  for (std::size_t begin = 0; begin < paths.size();
+       begin += kPathsPerMaskWord) {
+    const std::size_t end = std::min(paths.size(), begin + kPathsPerMaskWord);
+    const std::vector<std::string> block(paths.begin() + begin,
+                                         paths.begin() + end);
+    const std::string wordName =
+        words.empty() ? name : name + "_" + std::to_string(words.size());
+    maskWordDefiners[block.size() - 1](dataManager, wordName, block,
+                                       systematicManager);
+    words.push_back(wordName);
+  }
+
+  if (words.size() == 1) {
+    return words.front();
+  }
+  std::string folded = words.front();
+  for (std::size_t k = 1; k < words.size(); ++k) {
+    const std::string next = k + 1 == words.size()
+                                 ? name + "_any"
+                                 : name + "_any" + std::to_string(k);
+    dataManager.Define(
+        next,
+        [](std::uint64_t lhs, std::uint64_t rhs) -> std::uint64_t {
+          return lhs | rhs;
+        },
+        {folded, words[k]}, systematicManager);
+    folded = next;
+  }
+  return folded;
+}
 
 /**
  * @brief Construct a new TriggerManager object
@@ -115,79 +470,93 @@ void TriggerManager::applyAllTriggers() {
   
   std::string group = getGroupForSample(sampleType);
   
-  auto passTrigger = [](const ROOT::VecOps::RVec<bool>& triggerVec) {
-    for (bool v : triggerVec) {
-      if (v) return true;
-    }
-    return false;
-  };
-  
-  auto passTriggerAndVeto = [](const ROOT::VecOps::RVec<bool>& passVec, const ROOT::VecOps::RVec<bool>& vetoVec) {
-    bool pass = false;
-    for (bool v : passVec) {
-      if (v) pass = true;
-    }
-    for (bool v : vetoVec) {
-      if (v) return false;
-    }
-    return pass;
-  };
-  
   // Avoid forcing a dataframe evaluation here; counting entries would
   // trigger an event loop before the main analysis execution, which doubles
   // runtime.  Counters/logging can be added later if needed, but the
   // default behaviour should be lazy.
-  auto dfBefore = dataManager_m->getDataFrame();
-
+  std::vector<std::string> triggers;
+  std::vector<std::string> vetoes;
+  std::string maskPrefix;
   if (!group.empty()) {
-    const auto& triggers = getTriggers(group);
-    const auto& vetoes = getVetoes(group);
+    triggers = getTriggers(group);
+    vetoes = getVetoes(group);
+    maskPrefix = group;
+  } else {
+    for (const auto& g : getAllGroups()) {
+      const auto& groupTriggers = getTriggers(g);
+      triggers.insert(triggers.end(), groupTriggers.begin(), groupTriggers.end());
+    }
+    triggers = uniquePaths(triggers);
+    maskPrefix = "allTriggers";
+  }
+
+  auto df = dataManager_m->getDataFrame();
+  if (!triggers.empty() && allBoolColumns(df, triggers) &&
+      allBoolColumns(df, vetoes)) {
+    // Pack the HLT decisions into uint64_t bitmasks (bit i = i-th path of the
+    // group) with precompiled typed kernels; pass/veto become mask tests.
+    const std::string passMask = defineTriggerMask(
+        *dataManager_m, maskPrefix + "_triggerMask", triggers, *systematicManager_m);
+    if (vetoes.empty()) {
+      dataManager_m->Define(
+          "pass_applyTrigger",
+          [](std::uint64_t pass) { return pass != 0; },
+          {passMask}, *systematicManager_m);
+    } else {
+      const std::string vetoMask = defineTriggerMask(
+          *dataManager_m, maskPrefix + "_vetoMask", vetoes, *systematicManager_m);
+      dataManager_m->Define(
+          "pass_applyTrigger",
+          [](std::uint64_t pass, std::uint64_t veto) {
+            return pass != 0 && veto == 0;
+          },
+          {passMask, vetoMask}, *systematicManager_m);
+    }
+  } else {
+    // Non-bool trigger columns: pack into RVec<Bool_t> via DefineVector.
+    auto passTrigger = [](const ROOT::VecOps::RVec<bool>& triggerVec) {
+      for (bool v : triggerVec) {
+        if (v) return true;
+      }
+      return false;
+    };
+
+    auto passTriggerAndVeto = [](const ROOT::VecOps::RVec<bool>& passVec, const ROOT::VecOps::RVec<bool>& vetoVec) {
+      bool pass = false;
+      for (bool v : passVec) {
+        if (v) pass = true;
+      }
+      for (bool v : vetoVec) {
+        if (v) return false;
+      }
+      return pass;
+    };
+
     if (vetoes.empty()) {
       dataManager_m->DefineVector("allTriggersPassVector", triggers, "Bool_t", *systematicManager_m);
-      // Define the filter variable
       dataManager_m->Define("pass_applyTrigger", passTrigger, {"allTriggersPassVector"}, *systematicManager_m);
-      // Optional debug: count rows passing pass_applyTrigger pre-apply. Only runs
-      // if TRIGGER_MANAGER_DEBUG is set (to avoid an eager event loop).
-      if (std::getenv("TRIGGER_MANAGER_DEBUG") != nullptr) {
-        auto dfDbg = dataManager_m->getDataFrame();
-        auto cntDbg = dfDbg.Filter([](bool val){ return val; }, {"pass_applyTrigger"}).Count();
-        std::cout << "TriggerManager debug: rows passing pass_applyTrigger (pre-apply): " << cntDbg.GetValue() << std::endl;
-      }
-      // Apply the filter
-      dataManager_m->Filter([](bool val) { return val; }, {"pass_applyTrigger"});
     } else {
       dataManager_m->DefineVector(group + "_passVector", triggers, "Bool_t", *systematicManager_m);
       dataManager_m->DefineVector(group + "_vetoVector", vetoes, "Bool_t", *systematicManager_m);
-      // Define the filter variable
       dataManager_m->Define("pass_applyTrigger", passTriggerAndVeto, {group + "_passVector", group + "_vetoVector"}, *systematicManager_m);
-      // Optional debug: count rows passing pass_applyTrigger pre-apply, only when
-      // TRIGGER_MANAGER_DEBUG is set.
-      if (std::getenv("TRIGGER_MANAGER_DEBUG") != nullptr) {
-        auto dfDbg = dataManager_m->getDataFrame();
-        auto cntDbg = dfDbg.Filter([](bool val){ return val; }, {"pass_applyTrigger"}).Count();
-        std::cout << "TriggerManager debug: rows passing pass_applyTrigger (pre-apply): " << cntDbg.GetValue() << std::endl;
-      }
-      // Apply the filter
-      dataManager_m->Filter([](bool val) { return val; }, {"pass_applyTrigger"});
-    }
-  } else {
-    std::vector<std::string> allTriggers;
-    for (const auto& g : getAllGroups()) {
-      const auto& triggers = getTriggers(g);
-      allTriggers.insert(allTriggers.end(), triggers.begin(), triggers.end());
     }
-    dataManager_m->DefineVector("allTriggersPassVector", allTriggers, "Bool_t", *systematicManager_m);
-    // Define the filter variable
-    dataManager_m->Define("pass_applyTrigger", passTrigger, {"allTriggersPassVector"}, *systematicManager_m);
-    // Apply the filter
-    dataManager_m->Filter([](bool val) { return val; }, {"pass_applyTrigger"});
   }
 
+  // Optional debug: count rows passing pass_applyTrigger pre-apply. Only runs
+  // if TRIGGER_MANAGER_DEBUG is set (to avoid an eager event loop).
+  if (!group.empty() && std::getenv("TRIGGER_MANAGER_DEBUG") != nullptr) {
+    auto dfDbg = dataManager_m->getDataFrame();
+    auto cntDbg = dfDbg.Filter([](bool val){ return val; }, {"pass_applyTrigger"}).Count();
+    RDF_LOG_INFO << "TriggerManager debug: rows passing pass_applyTrigger (pre-apply): " << cntDbg.GetValue();
+  }
+  // Apply the filter
+  dataManager_m->Filter([](bool val) { return val; }, {"pass_applyTrigger"});
+
   // Similarly, avoid counting after applying triggers unless debugging.
   if (std::getenv("TRIGGER_MANAGER_DEBUG") != nullptr) {
     auto dfAfter = dataManager_m->getDataFrame();
     auto totalAfter = dfAfter.Count();
-    std::cout << "TriggerManager: rows after applying triggers: " << totalAfter.GetValue() << std::endl;
+    RDF_LOG_INFO << "TriggerManager: rows after applying triggers: " << totalAfter.GetValue();
   }
 }
 
@@ -221,8 +590,8 @@ void TriggerManager::setupFromConfigFile() {
   }
 }
 void TriggerManager::initialize() {
-  std::cout << "TriggerManager: initialized with " << getAllGroups().size()
-            << " trigger group(s)." << std::endl;
+  RDF_LOG_INFO << "TriggerManager: initialized with " << getAllGroups().size()
+               << " trigger group(s).";
 }
 
 void TriggerManager::reportMetadata() {
@@ -3,13 +3,36 @@
 
 #include <api/IConfigurationProvider.h>
 #include <NamedObjectManager.h>
+#include <ROOT/RVec.hxx>
+#include <cstdint>
 #include <string>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 #include <memory>
 
 class Analyzer;
 
+/**
+ * @brief Trigger-object matching of one offline collection to several paths.
+ *
+ * Each path is given with the filter bits its trigger object must carry; bit
+ * p of the per-object output mask is set when the object lies within
+ * @c maxDeltaR of a trigger object of type @c triggerObjectId whose filter
+ * bits contain all bits required by @c paths[p].
+ */
+struct TriggerMatchSpec {
+  std::string name;      ///< Output column: RVec<std::uint64_t>, one mask per object.
+  std::string etaColumn; ///< Offline object eta.
+  std::string phiColumn; ///< Offline object phi.
+  int triggerObjectId = 0; ///< TrigObj_id to match (11 e/gamma, 13 muon, 1 jet, ...).
+  /// (path name, required filter bits); at most 64 paths.
+  std::vector<std::pair<std::string, std::uint64_t>> paths;
+  float maxDeltaR = 0.1f;
+  /// Trigger objects are read from <prefix>_eta, _phi, _id and _filterBits.
+  std::string triggerObjectPrefix = "TrigObj";
+};
+
 /**
  * @class TriggerManager
  * @brief Handles loading, storing, and applying trigger groups and vetoes.
@@ -68,9 +91,82 @@ public:
 
   /**
    * @brief Apply all triggers for the current sample type
+   *
+   * When every trigger and veto column is a plain bool, the paths of the
+   * sample's group are packed into a uint64_t bitmask column
+   * "<group>_triggerMask" (bit i = i-th configured path; further 64-path
+   * blocks go to "<group>_triggerMask_1", ...) by a precompiled typed
+   * kernel, and vetoes likewise into "<group>_vetoMask".  Samples without a
+   * group use the union of all groups under the prefix "allTriggers".
+   * "pass_applyTrigger" is then (triggerMask != 0 && vetoMask == 0).  Other
+   * column types fall back to RVec<Bool_t> pass vectors.
    */
   void applyAllTriggers();
 
+  /**
+   * @brief Pack the bool trigger columns @p paths into uint64_t mask
+   *        column(s) named after @p name (bit i = paths[i]).
+   *
+   * Paths beyond the first 64 go to "<name>_1", "<name>_2", ...
+   *
+   * @return Name of a column that is non-zero iff any path fired.
+   */
+  static std::string defineTriggerMask(IDataFrameProvider &dataManager,
+                                       const std::string &name,
+                                       const std::vector<std::string> &paths,
+                                       ISystematicManager &systematicManager);
+
+  /**
+   * @brief Define the trigger-object match masks of @p spec.
+   *
+   * All paths of the spec are matched in one typed kernel per event: the
+   * trigger objects of the requested type are sorted by phi once, each
+   * offline object only visits those inside its phi window, and the path
+   * requirements are tested as filter-bit masks.  The result can be tested
+   * with (mask >> bit) & 1 in scale-factor columns, with the bit from
+   * getTriggerMatchBit() or a defineTriggerMatchFlags() column.
+   *
+   * @return Name of the output column (@c spec.name).
+   * @throws std::runtime_error if the spec is incomplete, has more than 64
+   *         paths, or the name is already used by another match.
+   */
+  std::string defineTriggerMatch(const TriggerMatchSpec &spec);
+
+  /**
+   * @brief Define @p outputColumn (RVec<bool>, one flag per object) that is
+   *        true for the objects of match @p matchName matched to @p path.
+   * @throws std::runtime_error for an unknown match or path, or if the
+   *         context is not set.
+   */
+  void defineTriggerMatchFlags(const std::string &matchName,
+                               const std::string &path,
+                               const std::string &outputColumn);
+
+  /**
+   * @brief Bit of @p path in the masks of match @p matchName.
+   * @throws std::runtime_error for an unknown match or path.
+   */
+  unsigned int getTriggerMatchBit(const std::string &matchName,
+                                  const std::string &path) const;
+
+  /**
+   * @brief Match mask of each offline object (bit p = path p matched).
+   *
+   * Trigger objects with an id other than @p triggerObjectId are ignored.
+   * The kernel behind defineTriggerMatch(); @p requiredBits holds the
+   * filter bits of each path.
+   */
+  static ROOT::VecOps::RVec<std::uint64_t>
+  matchTriggerObjects(const ROOT::VecOps::RVec<Float_t> &eta,
+                      const ROOT::VecOps::RVec<Float_t> &phi,
+                      const ROOT::VecOps::RVec<Float_t> &trigEta,
+                      const ROOT::VecOps::RVec<Float_t> &trigPhi,
+                      const ROOT::VecOps::RVec<Int_t> &trigId,
+                      const ROOT::VecOps::RVec<Int_t> &trigFilterBits,
+                      int triggerObjectId,
+                      const std::vector<std::uint64_t> &requiredBits,
+                      float maxDeltaR);
+
   std::string type() const override {
     return "TriggerManager";
   }
@@ -96,6 +192,10 @@ private:
    * @brief Map from sample name to group name.
    */
   std::unordered_map<std::string, std::string> sampleToGroup_m;
+  /**
+   * @brief Path names of each defined trigger match, in bit order.
+   */
+  std::unordered_map<std::string, std::vector<std::string>> matchPaths_m;
 };
 
 
@@ -8,8 +8,82 @@
 #include <api/ILogger.h>
 #include <api/IOutputSink.h>
 #include <algorithm>
+#include <array>
 #include <sstream>
 #include <stdexcept>
+#include <utility>
+
+namespace {
+
+/// Largest number of scale factors multiplied by one precompiled kernel.
+constexpr std::size_t kMaxFusedWeightFactors = 32;
+
+template <typename T, std::size_t>
+using WeightFactor = T;
+
+/// Typed kernel multiplying N scale factors in column order, then the norm.
+template <typename T, std::size_t... I>
+auto makeWeightProductKernel(double normProduct, std::index_sequence<I...>) {
+  return [normProduct](WeightFactor<T, I>... factors) -> double {
+    return (static_cast<double>(factors) * ...) * normProduct;
+  };
+}
+
+using WeightProductDefiner = ROOT::RDF::RNode (*)(ROOT::RDF::RNode,
+                                                  const std::string &,
+                                                  const std::vector<std::string> &,
+                                                  double);
+
+template <typename T, std::size_t N>
+ROOT::RDF::RNode defineWeightProduct(ROOT::RDF::RNode df, const std::string &name,
+                                     const std::vector<std::string> &columns,
+                                     double normProduct) {
+  return df.Define(name,
+                   makeWeightProductKernel<T>(normProduct, std::make_index_sequence<N>{}),
+                   columns);
+}
+
+template <typename T, std::size_t... N>
+constexpr std::array<WeightProductDefiner, sizeof...(N)>
+makeWeightProductTable(std::index_sequence<N...>) {
+  return {&defineWeightProduct<T, N + 1>...};
+}
+
+template <typename T>
+WeightProductDefiner selectWeightProduct(std::size_t nFactors) {
+  static constexpr auto table = makeWeightProductTable<T>(
+      std::make_index_sequence<kMaxFusedWeightFactors>{});
+  return (nFactors >= 1 && nFactors <= table.size()) ? table[nFactors - 1]
+                                                     : nullptr;
+}
+
+/// Nominal weight times each of @p size factors; missing factors count as 1.
+template <typename T>
+ROOT::RDF::RNode defineWeightVector(ROOT::RDF::RNode df, const std::string &name,
+                                    const std::string &nominal, const std::string &factors,
+                                    std::size_t size) {
+  return df.Define(
+      name,
+      [size](double weight, const ROOT::VecOps::RVec<T> &values) {
+        ROOT::VecOps::RVec<Float_t> weights(size, static_cast<Float_t>(weight));
+        const std::size_t n = std::min(size, values.size());
+        for (std::size_t i = 0; i < n; ++i) {
+          weights[i] = static_cast<Float_t>(weight * static_cast<double>(values[i]));
+        }
+        return weights;
+      },
+      {nominal, factors});
+}
+
+bool isFloatColumnType(const std::string &type) {
+  return type == "float" || type == "Float_t";
+}
+
+bool isDoubleColumnType(const std::string &type) {
+  return type == "double" || type == "Double_t";
+}
+
+} // namespace
 
 // ---------------------------------------------------------------------------
 // setContext
@@ -33,12 +107,34 @@ void WeightManager::addScaleFactor(const std::string &name,
   if (column.empty())
     throw std::invalid_argument("WeightManager::addScaleFactor: column must not be empty");
   scaleFactors_m.push_back({name, column});
+  invalidateComplementColumns();
 }
 
 void WeightManager::addNormalization(const std::string &name, double value) {
   if (name.empty())
     throw std::invalid_argument("WeightManager::addNormalization: name must not be empty");
   normalizations_m.push_back({name, value});
+  invalidateComplementColumns();
+}
+
+void WeightManager::addDeferredNormalization(const std::string &name, double numerator) {
+  if (name.empty())
+    throw std::invalid_argument(
+        "WeightManager::addDeferredNormalization: name must not be empty");
+  deferredNormalizations_m.push_back({name, numerator});
+}
+
+double WeightManager::resolveDeferredNormalization(double sumWeights) {
+  if (sumWeights == 0.0)
+    throw std::runtime_error(
+        "WeightManager::resolveDeferredNormalization: the sum of weights is zero");
+  double product = 1.0;
+  for (const auto &[name, numerator] : deferredNormalizations_m) {
+    product *= numerator;
+  }
+  deferredFactor_m = product / sumWeights;
+  deferredResolved_m = true;
+  return deferredFactor_m;
 }
 
 void WeightManager::addWeightVariation(const std::string &name,
@@ -62,6 +158,18 @@ void WeightManager::addWeightVariation(const std::string &name,
   variations_m.push_back({name, componentName, upColumn, downColumn});
 }
 
+void WeightManager::addWeightVectorVariation(const std::string &name,
+                                              const std::string &column,
+                                              const std::vector<std::string> &labels) {
+  if (name.empty())
+    throw std::invalid_argument("WeightManager::addWeightVectorVariation: name must not be empty");
+  if (column.empty())
+    throw std::invalid_argument("WeightManager::addWeightVectorVariation: column must not be empty");
+  if (labels.empty())
+    throw std::invalid_argument("WeightManager::addWeightVectorVariation: labels must not be empty");
+  vectorVariations_m.push_back({name, column, labels});
+}
+
 // ---------------------------------------------------------------------------
 // Weight column scheduling
 // ---------------------------------------------------------------------------
@@ -90,6 +198,18 @@ void WeightManager::defineVariedWeight(const std::string &variationName,
   }
 }
 
+void WeightManager::defineVariedWeightVector(const std::string &variationName,
+                                              const std::string &outputColumn) {
+  if (variationName.empty())
+    throw std::invalid_argument("WeightManager::defineVariedWeightVector: variationName must not be empty");
+  if (outputColumn.empty())
+    throw std::invalid_argument("WeightManager::defineVariedWeightVector: outputColumn must not be empty");
+  vectorColumnSpecs_m.push_back({variationName, outputColumn});
+  if (dataManager_m) {
+    materializeScheduledWeights(false);
+  }
+}
+
 // ---------------------------------------------------------------------------
 // Accessors
 // ---------------------------------------------------------------------------
@@ -107,6 +227,27 @@ std::string WeightManager::getWeightColumn(const std::string &variationName,
   return {};
 }
 
+std::string WeightManager::getWeightVectorColumn(const std::string &variationName) const {
+  const auto it = vectorColumns_m.find(variationName);
+  if (it != vectorColumns_m.end()) {
+    return it->second;
+  }
+  for (const auto &[name, column] : vectorColumnSpecs_m) {
+    if (name == variationName) return column;
+  }
+  return {};
+}
+
+const std::vector<std::string> &
+WeightManager::getWeightVectorLabels(const std::string &variationName) const {
+  for (const auto &v : vectorVariations_m) {
+    if (v.name == variationName) return v.labels;
+  }
+  throw std::runtime_error("WeightManager::getWeightVectorLabels: variation \"" +
+                           variationName +
+                           "\" was not registered via addWeightVectorVariation()");
+}
+
 double WeightManager::getTotalNormalization() const {
   return computeNormProduct();
 }
@@ -133,17 +274,6 @@ void WeightManager::defineWeightColumn(const std::string &outputColumn,
     throw std::runtime_error("WeightManager::defineWeightColumn: context not set");
 
   const double normProduct = computeNormProduct();
-
-  // Build a lambda that multiplies all SF columns together, then scales by norm.
-  // We use RDataFrame's variadic Define mechanism with a captured copy of the
-  // norm product.  The lambda signature must match the number of input columns,
-  // which varies at runtime.  We therefore handle the common cases explicitly
-  // and fall back to a generic loop approach via a helper lambda defined below.
-  //
-  // Strategy: define a helper column "_tmp_wm_product_<outputColumn>" that
-  // holds the product of all SF columns (as double), then multiply by normProduct.
-  // If there are no SF columns the weight is just the normProduct scalar.
-
   ROOT::RDF::RNode df = dataManager_m->getDataFrame();
 
   if (sfColumns.empty()) {
@@ -157,39 +287,103 @@ void WeightManager::defineWeightColumn(const std::string &outputColumn,
     return;
   }
 
-  // Generic approach: accumulate the product of scale factors step by step
-  // using a chain of Define() calls, since the number of SF columns is only
-  // known at runtime and variadic lambdas cannot be formed statically.
-
-  // Define the first accumulator column
-  std::string prevCol = outputColumn + "_wm_acc_0_";
-  {
-    const std::string sfCol0 = sfColumns[0];
-    auto newDf = df.Define(prevCol, "static_cast<double>(" + sfCol0 + ")");
-    df = newDf;
+  // Single fused Define over all SF columns.  When every SF column has the
+  // same floating-point type, a precompiled kernel of matching arity is used;
+  // otherwise the product is JIT-compiled once as a single expression.
+  const std::string firstType = df.GetColumnType(sfColumns.front());
+  const bool allSameType = std::all_of(
+      sfColumns.begin(), sfColumns.end(),
+      [&](const std::string &col) { return df.GetColumnType(col) == firstType; });
+  WeightProductDefiner kernel = nullptr;
+  if (allSameType && isDoubleColumnType(firstType)) {
+    kernel = selectWeightProduct<double>(sfColumns.size());
+  } else if (allSameType && isFloatColumnType(firstType)) {
+    kernel = selectWeightProduct<float>(sfColumns.size());
   }
-
-  // Multiply in subsequent SF columns
-  for (std::size_t i = 1; i < sfColumns.size(); ++i) {
-    std::string nextCol = outputColumn + "_wm_acc_" + std::to_string(i) + "_";
-    const std::string sfColI = sfColumns[i];
-    const std::string pCol = prevCol;
-    auto newDf = df.Define(nextCol,
-                 pCol + " * static_cast<double>(" + sfColI + ")");
-    df = newDf;
-    prevCol = nextCol;
+  if (kernel) {
+    dataManager_m->setDataFrame(kernel(df, outputColumn, sfColumns, normProduct));
+    return;
   }
 
-  // Final column: multiply accumulated product by normProduct
-  const std::string lastAcc = prevCol;
+  std::string expr;
+  for (std::size_t i = 0; i < sfColumns.size(); ++i) {
+    if (i > 0) expr += " * ";
+    expr += "static_cast<double>(" + sfColumns[i] + ")";
+  }
+  const std::string productCol = outputColumn + "_wm_product_";
+  df = dataManager_m->defineExpression(df, productCol, expr);
   const double np = normProduct;
   auto finalDf = df.Define(outputColumn,
-      [np](double acc) { return acc * np; },
-      {lastAcc});
-
+      [np](double product) { return product * np; },
+      {productCol});
   dataManager_m->setDataFrame(finalDf);
 }
 
+void WeightManager::defineScaledWeightColumn(const std::string &outputColumn,
+                                              const std::string &baseColumn,
+                                              const std::string &factorColumn) {
+  ROOT::RDF::RNode df = dataManager_m->getDataFrame();
+  const std::string factorType = df.GetColumnType(factorColumn);
+  if (isDoubleColumnType(factorType)) {
+    df = df.Define(outputColumn,
+        [](double base, double factor) { return base * factor; },
+        {baseColumn, factorColumn});
+  } else if (isFloatColumnType(factorType)) {
+    df = df.Define(outputColumn,
+        [](double base, float factor) { return base * static_cast<double>(factor); },
+        {baseColumn, factorColumn});
+  } else {
+    df = dataManager_m->defineExpression(
+        df, outputColumn, baseColumn + " * static_cast<double>(" + factorColumn + ")");
+  }
+  dataManager_m->setDataFrame(df);
+}
+
+void WeightManager::invalidateComplementColumns() {
+  // Columns already defined keep their old product; later variations get
+  // fresh columns (under new names, since RDF cannot redefine a column).
+  if (complementColumns_m.empty() && !nominalMaterialized_m) {
+    return;
+  }
+  complementColumns_m.clear();
+  ++complementGeneration_m;
+}
+
+const std::string &
+WeightManager::complementColumnFor(const std::string &componentName) {
+  const auto it = complementColumns_m.find(componentName);
+  if (it != complementColumns_m.end()) {
+    return it->second;
+  }
+
+  // The product of all nominal factors is the nominal weight itself, unless
+  // factors were added after it was defined.
+  if (componentName.empty() && nominalMaterialized_m &&
+      nominalGeneration_m == complementGeneration_m) {
+    return complementColumns_m.emplace(componentName, nominalOutputColumn_m)
+        .first->second;
+  }
+
+  std::vector<std::string> sfCols;
+  sfCols.reserve(scaleFactors_m.size());
+  for (const auto &[sfName, sfCol] : scaleFactors_m) {
+    if (componentName.empty() || sfName != componentName) {
+      sfCols.push_back(sfCol);
+    }
+  }
+
+  const std::string prefix =
+      nominalOutputColumn_m.empty() ? "weight" : nominalOutputColumn_m;
+  std::string column =
+      componentName.empty() ? prefix + "_wm_all_"
+                            : prefix + "_wm_excl_" + componentName + "_";
+  if (complementGeneration_m > 0) {
+    column += "g" + std::to_string(complementGeneration_m) + "_";
+  }
+  defineWeightColumn(column, sfCols);
+  return complementColumns_m.emplace(componentName, column).first->second;
+}
+
 void WeightManager::materializeScheduledWeights(bool shouldBookAudit) {
   if (!dataManager_m)
     throw std::runtime_error("WeightManager::materializeScheduledWeights: context not set");
@@ -203,6 +397,7 @@ void WeightManager::materializeScheduledWeights(bool shouldBookAudit) {
 
     defineWeightColumn(nominalOutputColumn_m, sfCols);
     nominalMaterialized_m = true;
+    nominalGeneration_m = complementGeneration_m;
   }
 
   for (const auto &spec : variedColumnSpecs_m) {
@@ -233,22 +428,63 @@ void WeightManager::materializeScheduledWeights(bool shouldBookAudit) {
     const std::string variedSfCol =
         (spec.direction == "up") ? var->upColumn : var->downColumn;
 
-    std::vector<std::string> sfCols;
-    bool replaced = false;
-    for (const auto &[sfName, sfCol] : scaleFactors_m) {
-      if (sfName == var->componentName) {
-        sfCols.push_back(variedSfCol);
-        replaced = true;
-      } else {
-        sfCols.push_back(sfCol);
+    // Each nominal factor of the component is replaced by the varied factor
+    // (appended when the component has none).  With a single match, the
+    // product of every other factor is shared across all variations of the
+    // same component; repeated component names take the explicit product.
+    const auto matches = std::count_if(
+        scaleFactors_m.begin(), scaleFactors_m.end(),
+        [&](const auto &sf) { return sf.first == var->componentName; });
+    if (matches > 1) {
+      std::vector<std::string> sfCols;
+      sfCols.reserve(scaleFactors_m.size());
+      for (const auto &[sfName, sfCol] : scaleFactors_m) {
+        sfCols.push_back(sfName == var->componentName ? variedSfCol : sfCol);
       }
+      defineWeightColumn(spec.outputColumn, sfCols);
+    } else {
+      const std::string baseColumn =
+          complementColumnFor(matches == 1 ? var->componentName : "");
+      defineScaledWeightColumn(spec.outputColumn, baseColumn, variedSfCol);
     }
-    if (!replaced) {
-      sfCols.push_back(variedSfCol);
+    variedColumns_m.push_back({{spec.variationName, spec.direction}, spec.outputColumn});
+  }
+
+  for (const auto &[variationName, outputColumn] : vectorColumnSpecs_m) {
+    if (vectorColumns_m.count(variationName) != 0) {
+      continue;
+    }
+    const WeightVectorVariation *var = nullptr;
+    for (const auto &v : vectorVariations_m) {
+      if (v.name == variationName) {
+        var = &v;
+        break;
+      }
+    }
+    if (!var) {
+      throw std::runtime_error(
+          "WeightManager::materializeScheduledWeights: variation \"" + variationName +
+          "\" was not registered via addWeightVectorVariation()");
     }
 
-    defineWeightColumn(spec.outputColumn, sfCols);
-    variedColumns_m.push_back({{spec.variationName, spec.direction}, spec.outputColumn});
+    ROOT::RDF::RNode df = dataManager_m->getDataFrame();
+    const std::string &nominal = complementColumnFor("");
+    const std::string factorType = df.GetColumnType(var->column);
+    if (factorType == "ROOT::VecOps::RVec<Float_t>" ||
+        factorType == "ROOT::VecOps::RVec<float>") {
+      df = defineWeightVector<Float_t>(df, outputColumn, nominal, var->column,
+                                       var->labels.size());
+    } else if (factorType == "ROOT::VecOps::RVec<Double_t>" ||
+               factorType == "ROOT::VecOps::RVec<double>") {
+      df = defineWeightVector<Double_t>(df, outputColumn, nominal, var->column,
+                                        var->labels.size());
+    } else {
+      throw std::runtime_error("WeightManager::materializeScheduledWeights: column \"" +
+                               var->column + "\" of variation \"" + variationName +
+                               "\" is a " + factorType + ", not a floating-point RVec");
+    }
+    dataManager_m->setDataFrame(df);
+    vectorColumns_m.emplace(variationName, outputColumn);
   }
 
   if (shouldBookAudit && !auditsBooked_m) {
@@ -348,6 +584,13 @@ void WeightManager::finalize() {
     obj.Write("weight_norm_total", TObject::kOverwrite);
   }
 
+  // The deferred factor is applied to the saved outputs, not the weights.
+  if (deferredResolved_m) {
+    std::string valStr = std::to_string(deferredFactor_m);
+    TNamed obj("weight_norm_deferred", valStr.c_str());
+    obj.Write("weight_norm_deferred", TObject::kOverwrite);
+  }
+
   // Write audit statistics as TH1D histograms (one per audited column).
   for (const auto &entry : auditEntries_m) {
     // Summary histogram: bins = sumWeights, mean, min, max.
@@ -400,6 +643,17 @@ void WeightManager::reportMetadata() {
     ss << "  total = " << computeNormProduct() << "\n";
     logger_m->log(ILogger::Level::Info, ss.str());
   }
+  if (!deferredNormalizations_m.empty()) {
+    std::ostringstream ss;
+    ss << "WeightManager: deferred normalizations (divided by the sum of weights)\n";
+    for (const auto &[name, numerator] : deferredNormalizations_m) {
+      ss << "  " << name << " = " << numerator << "\n";
+    }
+    if (deferredResolved_m) {
+      ss << "  applied factor = " << deferredFactor_m << "\n";
+    }
+    logger_m->log(ILogger::Level::Info, ss.str());
+  }
 
   // ---- Scale factor summary ----
   if (!scaleFactors_m.empty()) {
@@ -468,6 +722,19 @@ WeightManager::collectProvenanceEntries() const {
     entries["normalizations"] = ss.str();
   }
 
+  // Deferred normalizations: "name:numerator,..." and the resolved factor.
+  if (!deferredNormalizations_m.empty()) {
+    std::ostringstream ss;
+    for (std::size_t i = 0; i < deferredNormalizations_m.size(); ++i) {
+      if (i > 0) ss << ',';
+      ss << deferredNormalizations_m[i].first << ':' << deferredNormalizations_m[i].second;
+    }
+    entries["deferred_normalizations"] = ss.str();
+    if (deferredResolved_m) {
+      entries["deferred_normalization_factor"] = std::to_string(deferredFactor_m);
+    }
+  }
+
   // Registered weight variations: "name(up:col,dn:col),..."
   if (!variations_m.empty()) {
     std::ostringstream ss;
@@ -480,6 +747,17 @@ WeightManager::collectProvenanceEntries() const {
     entries["weight_variations"] = ss.str();
   }
 
+  // Registered vector variations: "name(column:size),..."
+  if (!vectorVariations_m.empty()) {
+    std::ostringstream ss;
+    for (std::size_t i = 0; i < vectorVariations_m.size(); ++i) {
+      if (i > 0) ss << ',';
+      ss << vectorVariations_m[i].name << '(' << vectorVariations_m[i].column << ':'
+         << vectorVariations_m[i].labels.size() << ')';
+    }
+    entries["weight_vector_variations"] = ss.str();
+  }
+
   // Nominal weight column (if scheduled)
   if (!nominalOutputColumn_m.empty()) {
     entries["nominal_weight_column"] = nominalOutputColumn_m;
@@ -11,6 +11,7 @@
 #include <ROOT/RDataFrame.hxx>
 #include <ROOT/RResultPtr.hxx>
 #include <string>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 #include <memory>
@@ -43,6 +44,16 @@ struct WeightVariation {
   std::string downColumn;  ///< Dataframe column for the "down" shift
 };
 
+/**
+ * @brief Descriptor for a vector of weight variations read from one column,
+ *        such as the LHE scale, LHE PDF or parton-shower weights.
+ */
+struct WeightVectorVariation {
+  std::string name;                ///< Variation label (e.g. "pdf")
+  std::string column;              ///< RVec column of per-event factors
+  std::vector<std::string> labels; ///< One label per factor
+};
+
 /**
  * @class WeightManager
  * @brief Plugin that manages nominal and varied event weights.
@@ -76,6 +87,12 @@ struct WeightVariation {
  *   wm->defineVariedWeight("pileup", "up",   "weight_pileup_up");
  *   wm->defineVariedWeight("pileup", "down", "weight_pileup_down");
  *
+ *   // Register the LHE PDF weights as one vector-valued variation and
+ *   // fill all of them at once.
+ *   wm->addWeightVectorVariation("pdf", "LHEPdfWeight", pdfLabels);
+ *   wm->defineVariedWeightVector("pdf", "weight_pdf");
+ *   histManager->registerWeightVector("weight_pdf", pdfLabels);
+ *
  *   // Retrieve column names for histogram filling.
  *   std::string nomCol = wm->getNominalWeightColumn(); // "weight_nominal"
  *   std::string upCol  = wm->getWeightColumn("pileup", "up"); // "weight_pileup_up"
@@ -118,6 +135,36 @@ public:
    */
   void addNormalization(const std::string &name, double value);
 
+  /**
+   * @brief Register a normalization @p numerator / sumW whose sum of
+   *        generator weights is only known at the end of the job.
+   *
+   * The weight columns leave it out, so histograms and weighted cutflows
+   * are filled unnormalized; after the event loop the Analyzer divides
+   * @p numerator by the weight sum CounterService accumulated in the same
+   * pass (``enableCounters=true`` with ``counterWeightBranch``) and scales
+   * the saved histograms and weighted cutflows by the result.  No counting
+   * pass or external sum of weights is needed.
+   *
+   * @param name      Human-readable label used in audit output.
+   * @param numerator Scalar divided by the sum of weights (e.g. xsec × lumi).
+   */
+  void addDeferredNormalization(const std::string &name, double numerator);
+
+  /// Whether addDeferredNormalization() was called.
+  bool hasDeferredNormalization() const { return !deferredNormalizations_m.empty(); }
+
+  /**
+   * @brief Resolve the deferred normalizations with the sum of weights
+   *        @p sumWeights of the processed sample.
+   * @return The product of the numerators divided by @p sumWeights.
+   * @throws std::runtime_error if @p sumWeights is zero
+   */
+  double resolveDeferredNormalization(double sumWeights);
+
+  /// The factor of resolveDeferredNormalization(); 1 before it is called.
+  double getDeferredNormalization() const { return deferredFactor_m; }
+
   /**
    * @brief Register a systematic weight variation.
    *
@@ -152,6 +199,23 @@ public:
                           const std::string &upColumn,
                           const std::string &downColumn);
 
+  /**
+   * @brief Register a vector of weight variations stored in one column.
+   *
+   * Generator weights (LHE scale and PDF, parton shower) come as one RVec
+   * of factors relative to the nominal weight.  Registering them as one
+   * variation lets histograms fill all of them with a single bin lookup
+   * (NDHistogramManager::registerWeightVector()) instead of booking one
+   * systematic weight per entry.
+   *
+   * @param name   Variation label used by defineVariedWeightVector().
+   * @param column RVec<float> or RVec<double> column of per-event factors.
+   * @param labels One label per factor, in column order.
+   */
+  void addWeightVectorVariation(const std::string &name,
+                                const std::string &column,
+                                const std::vector<std::string> &labels);
+
   // -------------------------------------------------------------------------
   // Weight column definition (deferred to execute())
   // -------------------------------------------------------------------------
@@ -174,7 +238,9 @@ public:
    *
    * The varied column replaces the scale factor for the named variation with
    * its up or down variant while keeping all other components at nominal.
-   * The scalar normalizations are still applied.
+   * The scalar normalizations are still applied.  The product of the other
+   * components is defined once per varied component and shared by all of its
+   * variations, so each varied column costs a single multiplication.
    *
    * defineVariedWeight() may be called multiple times to register several
    * systematic columns. If the manager context has already been set, each
@@ -190,6 +256,23 @@ public:
                            const std::string &direction,
                            const std::string &outputColumn);
 
+  /**
+   * @brief Define or schedule the varied weight vector of a vector
+   *        variation.
+   *
+   * @p outputColumn is an RVec<Float_t> with one entry per label: the
+   * nominal weight times the corresponding factor.  Events with fewer
+   * factors than labels (e.g. samples without PDF weights) get the nominal
+   * weight for the missing entries.  Defined immediately when the context
+   * has been set, otherwise in execute().
+   *
+   * @param variationName Name of the variation (must match a prior
+   *                      addWeightVectorVariation() call).
+   * @param outputColumn  Dataframe column name to define.
+   */
+  void defineVariedWeightVector(const std::string &variationName,
+                                const std::string &outputColumn);
+
   // -------------------------------------------------------------------------
   // Column name accessors (for histogram filling)
   // -------------------------------------------------------------------------
@@ -212,6 +295,19 @@ public:
   std::string getWeightColumn(const std::string &variationName,
                                const std::string &direction) const;
 
+  /**
+   * @brief Return the column of a varied weight vector, or an empty string
+   *        if defineVariedWeightVector() was not called for it.
+   */
+  std::string getWeightVectorColumn(const std::string &variationName) const;
+
+  /**
+   * @brief Return the labels of a vector variation.
+   * @throws std::runtime_error if the variation was not registered
+   */
+  const std::vector<std::string> &
+  getWeightVectorLabels(const std::string &variationName) const;
+
   /**
    * @brief Return the total scalar normalization factor.
    *
@@ -271,6 +367,8 @@ public:
    * Returns entries describing:
    *  - "scale_factors": comma-separated "name:column" pairs
    *  - "normalizations": comma-separated "name:value" pairs
+   *  - "deferred_normalizations": comma-separated "name:numerator" pairs,
+   *    and "deferred_normalization_factor" once resolved
    *  - "weight_variations": comma-separated variation names
    *  - "nominal_weight_column": the defined nominal weight column (if set)
    *
@@ -284,7 +382,11 @@ private:
   // ---- Registered components ----------------------------------------------
   std::vector<std::pair<std::string, std::string>> scaleFactors_m; ///< name → column
   std::vector<std::pair<std::string, double>> normalizations_m;    ///< name → value
+  std::vector<std::pair<std::string, double>> deferredNormalizations_m; ///< name → numerator
+  double deferredFactor_m = 1.0;
+  bool deferredResolved_m = false;
   std::vector<WeightVariation> variations_m;
+  std::vector<WeightVectorVariation> vectorVariations_m;
 
   // ---- Pending column definitions (scheduled before execute()) ------------
   struct VariedColumnSpec {
@@ -304,6 +406,17 @@ private:
   // Stored as flat vector for simplicity
   std::vector<std::pair<VariedColumnKey, std::string>> variedColumns_m;
 
+  /// Vector variation name → scheduled output column, and those defined.
+  std::vector<std::pair<std::string, std::string>> vectorColumnSpecs_m;
+  std::unordered_map<std::string, std::string> vectorColumns_m;
+
+  /// componentName → column with the product of all other nominal factors.
+  std::unordered_map<std::string, std::string> complementColumns_m;
+  /// Bumped whenever a factor is added; the nominal weight is only reused as
+  /// the full product when it was defined in the current generation.
+  std::size_t complementGeneration_m = 0;
+  std::size_t nominalGeneration_m = 0;
+
   // ---- Lazy audit RDF results (booked in execute(), read in finalize()) ---
   struct AuditPending {
     std::string name;
@@ -335,11 +448,28 @@ private:
 
   /**
    * @brief Define a weight column as the product of the given SF columns
-   *        times the scalar normalization product.
+   *        times the scalar normalization product, in a single Define.
    */
   void defineWeightColumn(const std::string &outputColumn,
                           const std::vector<std::string> &sfColumns);
 
+  /// Define @p outputColumn = @p baseColumn (double) × @p factorColumn.
+  void defineScaledWeightColumn(const std::string &outputColumn,
+                                const std::string &baseColumn,
+                                const std::string &factorColumn);
+
+  /**
+   * @brief Return the column holding the normalized product of all nominal
+   *        scale factors except @p componentName, defining it on first use.
+   *
+   * An empty @p componentName yields the full product (the nominal weight
+   * when it has been defined).
+   */
+  const std::string &complementColumnFor(const std::string &componentName);
+
+  /// Forget memoized complement columns after the set of factors changed.
+  void invalidateComplementColumns();
+
   /// Materialize any scheduled nominal/varied weight columns that have not
   /// yet been defined. When requested, also book lazy audit actions once.
   void materializeScheduledWeights(bool shouldBookAudit);
@@ -31,17 +31,28 @@
 #include <SofieManager.h>
 #include <NDHistogramManager.h>
 #include <PlottingUtility.h>
+#include <SparseProjector.h>
+#include <ColumnChunker.h>
+#include <HistogramPack.h>
+#include <BlockKernel.h>
 
 #include <ROOT/RDataFrame.hxx>
 #include <ROOT/RVec.hxx>
+#include <TH1D.h>
 #include <TInterpreter.h>
 
 #include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
 #include <sstream>
+#include <thread>
 #include <algorithm>
 #include <set>
 #include <iostream>
+#include <map>
 #include <cctype>
+#include <exception>
 #include <unordered_map>
 
 namespace py = pybind11;
@@ -82,6 +93,69 @@ static bool isValidSignature(const std::string& signature) {
     return true;
 }
 
+/**
+ * @brief Count of the runAsync() threads still running.
+ *
+ * The threads take the GIL to report progress and resolve their future,
+ * which is no longer possible once the interpreter is finalizing, so an
+ * atexit hook (registered with the module) waits for them with the GIL
+ * released.
+ */
+class AsyncRuns {
+public:
+    static void started() {
+        std::lock_guard<std::mutex> lock(instance().mutex);
+        ++instance().active;
+    }
+
+    /// Called by a thread once it no longer needs the GIL.
+    static void finished() {
+        {
+            std::lock_guard<std::mutex> lock(instance().mutex);
+            --instance().active;
+        }
+        instance().idle.notify_all();
+    }
+
+    /// Wait for every thread to finish; the caller must not hold the GIL.
+    static void wait() {
+        std::unique_lock<std::mutex> lock(instance().mutex);
+        instance().idle.wait(lock, [] { return instance().active == 0; });
+    }
+
+private:
+    static AsyncRuns& instance() {
+        static AsyncRuns runs;
+        return runs;
+    }
+
+    std::mutex mutex;
+    std::condition_variable idle;
+    unsigned int active = 0;
+};
+
+/// State shared by a runAsync() call with its threads.
+struct AsyncRunState {
+    explicit AsyncRunState(unsigned int nSlots) : slotEntries(nSlots) {}
+
+    /// Entries read so far, from the partial counts of every slot.
+    ULong64_t entries() const {
+        ULong64_t total = 0;
+        for (const auto& slot : slotEntries) {
+            total += slot.load(std::memory_order_relaxed);
+        }
+        return total;
+    }
+
+    std::vector<std::atomic<ULong64_t>> slotEntries;
+    /// Entries of the input; booked only with a progress callback.
+    ROOT::RDF::RResultPtr<ULong64_t> count;
+    std::mutex mutex;
+    std::condition_variable wake;
+    bool done = false;
+    std::exception_ptr error;
+};
+
 /**
  * @brief Wrapper to handle string-based Define calls (ROOT JIT compilation)
  * 
@@ -91,7 +165,7 @@ static bool isValidSignature(const std::string& signature) {
 class AnalyzerPythonWrapper {
 public:
     AnalyzerPythonWrapper(const std::string& configFile) 
-        : analyzer_(configFile) {}
+        : analyzer_(configFile), input_(analyzer_.getDF()) {}
 
     // C++-style API: Define(name, expression, columns)
     AnalyzerPythonWrapper& Define(const std::string& name,
@@ -112,6 +186,7 @@ public:
                                      const std::vector<std::string>& columns = {}) {
         auto df = analyzer_.getDF();
         auto& sysMgr = analyzer_.getSystematicManager();
+        auto& provider = analyzer_.getDataFrameProvider();
         
         const auto existingColumns = df.GetColumnNames();
         if (std::find(existingColumns.begin(), existingColumns.end(), name) != existingColumns.end()) {
@@ -148,11 +223,11 @@ public:
                         // Use the string-expression overload (only name + expression). Columns are
                         // used for systematic bookkeeping above, ROOT's string-based Define does
                         // not accept an explicit columns argument.
-                        df = df.Define(upName, expression);
+                        df = provider.defineExpression(df, upName, expression);
                     }
                     if (std::find(existingColumns.begin(), existingColumns.end(), downName) == 
                         existingColumns.end()) {
-                        df = df.Define(downName, expression);
+                        df = provider.defineExpression(df, downName, expression);
                     }
                     sysMgr.registerSystematic(syst, {name});
                 }
@@ -163,8 +238,8 @@ public:
         // column list (it only supports a name + expression). Therefore, we
         // rely on ROOT's expression parsing (and the earlier systematic handling
         // above) and ignore the provided column list here.
-        df = df.Define(name, expression);
-        analyzer_.getDataFrameProvider().setDataFrame(df);
+        df = provider.defineExpression(df, name, expression);
+        provider.setDataFrame(df);
         return *this;
     }
     
@@ -335,6 +410,39 @@ public:
         return DefineJIT(name, jit_expr.str(), {});
     }
 
+    /**
+     * @brief Define a variable with a columnar kernel called once per block
+     *        of events (see BlockKernel)
+     * @param name Variable name
+     * @param func_ptr Address of a ``void(int64, double**, int64**, double*)`` kernel
+     * @param columns Input columns (numeric scalars or RVecs)
+     * @param block_size Events per kernel call
+     * @param output_type Type of the new column ("double", "float", "int", "bool")
+     * @return Reference to this wrapper for chaining
+     *
+     * The kernel runs in an event loop of its own, without the GIL, before
+     * the column is defined; systematic variations are not propagated.
+     */
+    AnalyzerPythonWrapper& DefineFromBlockPointer(const std::string& name,
+                                                  uintptr_t func_ptr,
+                                                  const std::vector<std::string>& columns,
+                                                  size_t block_size = 4096,
+                                                  const std::string& output_type = "double") {
+        auto& provider = analyzer_.getDataFrameProvider();
+        auto df = analyzer_.getDF();
+        {
+            RunClaim claim(running_);
+            py::gil_scoped_release release;
+            df = BlockKernel::define(df, name, reinterpret_cast<BlockKernel::Function>(func_ptr),
+                                     columns, block_size, output_type);
+        }
+        // The column is a lookup by rdfentry_, so its inputs are recorded
+        // here rather than read from the dataframe.
+        provider.recordColumnsRead(columns);
+        provider.updateDataFrame(df, {name});
+        return *this;
+    }
+
     // C++-style API name parity with Analyzer::DefineVector
     AnalyzerPythonWrapper& DefineVector(const std::string& name,
                                         uintptr_t data_ptr,
@@ -431,6 +539,72 @@ public:
         throw std::runtime_error("No supported plugin found for role '" + role + "'");
     }
 
+    /**
+     * @brief Run the event loop and pass the selected numeric columns to
+     *        @p callback in chunks of @p chunk_size rows
+     * @return Number of rows delivered
+     *
+     * Each chunk is a dict of NumPy arrays that take over the buffers the
+     * event loop filled, without a copy or a Python object per event. The
+     * event loop runs without the GIL; the callback is called with it, one
+     * chunk at a time, from the processing threads.
+     */
+    size_t IterateArrays(const std::vector<std::string>& columns,
+                         size_t chunk_size,
+                         const py::function& callback) {
+        return iterateArrays(columns, chunk_size, [&callback](py::dict chunk) {
+            callback(std::move(chunk));
+        });
+    }
+
+    /**
+     * @brief Run the event loop and return the selected numeric columns as
+     *        a dict of NumPy arrays (a faster AsNumpy)
+     */
+    py::dict AsArrays(const std::vector<std::string>& columns) {
+        std::vector<py::dict> chunks;
+        iterateArrays(columns, size_t(1) << 20, [&chunks](py::dict chunk) {
+            chunks.push_back(std::move(chunk));
+        });
+
+        auto np = py::module_::import("numpy");
+        auto df = analyzer_.getDF();
+        py::dict result;
+        for (const auto& column : columns) {
+            const std::string type = df.GetColumnType(column);
+            const std::string offsetsName = column + "_offsets";
+            if (chunks.size() == 1) {
+                result[column.c_str()] = chunks.front()[column.c_str()];
+                if (ColumnChunker::isVector(type)) {
+                    result[offsetsName.c_str()] = chunks.front()[offsetsName.c_str()];
+                }
+                continue;
+            }
+            py::list parts;
+            // Offsets of the concatenation: those of each chunk after the
+            // first entry, shifted by the values of the chunks before it.
+            py::list offsetParts;
+            offsetParts.append(np.attr("zeros")(1, "int64"));
+            py::ssize_t base = 0;
+            for (const auto& chunk : chunks) {
+                auto values = chunk[column.c_str()].cast<py::array>();
+                parts.append(values);
+                if (ColumnChunker::isVector(type)) {
+                    auto offsets = chunk[offsetsName.c_str()].cast<py::array>();
+                    offsetParts.append(np.attr("add")(offsets[py::slice(1, offsets.size(), 1)], base));
+                    base += values.size();
+                }
+            }
+            result[column.c_str()] = chunks.empty()
+                ? np.attr("empty")(0, ColumnChunker::dtypeOf(type))
+                : np.attr("concatenate")(parts);
+            if (ColumnChunker::isVector(type)) {
+                result[offsetsName.c_str()] = np.attr("concatenate")(offsetParts);
+            }
+        }
+        return result;
+    }
+
     std::vector<std::string> GetColumnNames() {
         auto names = analyzer_.getDF().GetColumnNames();
         return std::vector<std::string>(names.begin(), names.end());
@@ -594,9 +768,10 @@ public:
                                               const std::string& correctionName,
                                               const std::vector<std::string>& stringArguments,
                                               const std::vector<std::string>& inputColumns = {},
-                                              const std::string& outputBranch = "") {
+                                              const std::string& outputBranch = "",
+                                              bool blockEvaluation = false) {
         requirePlugin<CorrectionManager>(role, "CorrectionManager").applyCorrectionVec(
-            correctionName, stringArguments, inputColumns, outputBranch);
+            correctionName, stringArguments, inputColumns, outputBranch, blockEvaluation);
         return *this;
     }
 
@@ -681,14 +856,136 @@ public:
         requirePlugin<NDHistogramManager>(role, "NDHistogramManager").Clear();
         return *this;
     }
+
+    /**
+     * @brief Filled bins of the booked histograms as NumPy arrays
+     *
+     * The event loop runs (without the GIL) if it has not yet.  The bin,
+     * sum and sumw2 arrays take over the buffers the bins were collected
+     * into, without a further copy or a file round trip.
+     */
+    py::dict getNDHistogramArrays(const std::string& role) {
+        auto& manager = requirePlugin<NDHistogramManager>(role, "NDHistogramManager");
+        HistogramPack pack;
+        {
+            RunClaim claim(running_);
+            py::gil_scoped_release release;
+            analyzer_.applyOutputScales();
+            pack = manager.packResults();
+        }
+        py::list schemas;
+        for (const auto& schema : pack.schemas()) {
+            py::list axes;
+            for (const auto& edges : schema) {
+                axes.append(py::array_t<double>(static_cast<py::ssize_t>(edges.size()), edges.data()));
+            }
+            schemas.append(axes);
+        }
+        py::dict histograms;
+        for (auto& hist : pack.releaseHistograms()) {
+            py::dict arrays;
+            arrays["axes"] = schemas[hist.schema];
+            arrays["bins"] = ownedArray(std::move(hist.bins));
+            arrays["sums"] = ownedArray(std::move(hist.sums));
+            arrays["sumw2"] = ownedArray(std::move(hist.sumw2));
+            histograms[py::str(hist.name)] = arrays;
+        }
+        return histograms;
+    }
     
     /**
      * @brief Save the analysis results
+     *
+     * The event loop runs without the GIL.
      */
     AnalyzerPythonWrapper& save() {
+        RunClaim claim(running_);
+        py::gil_scoped_release release;
         analyzer_.save();
         return *this;
     }
+
+    /**
+     * @brief Run the analysis (Analyzer::run()) without the GIL
+     */
+    AnalyzerPythonWrapper& run() {
+        RunClaim claim(running_);
+        py::gil_scoped_release release;
+        analyzer_.run();
+        return *this;
+    }
+
+    /**
+     * @brief Start Analyzer::run() on a thread of its own
+     * @return concurrent.futures.Future resolving to this analyzer
+     *
+     * The call returns at once; the event loop runs without the GIL.  With
+     * @p progress, the entries read so far are passed to it every
+     * @p interval seconds (and once at the end), with the GIL, from a
+     * reporting thread rather than the processing threads.
+     */
+    py::object runAsync(py::object progress, double interval) {
+        if (!(interval > 0.0)) {
+            throw std::runtime_error("Analyzer: runAsync interval must be positive");
+        }
+        RunClaim claim(running_);
+        // Event loops of several analyzers may now run concurrently.
+        ROOT::EnableThreadSafety();
+        auto state = std::make_shared<AsyncRunState>(input_.GetNSlots());
+        if (!progress.is_none()) {
+            state->count = input_.Count();
+            state->count.OnPartialResultSlot(kProgressEntries,
+                [weak = std::weak_ptr<AsyncRunState>(state)](unsigned int slot, ULong64_t& entries) {
+                    if (auto shared = weak.lock()) {
+                        shared->slotEntries[slot].store(entries, std::memory_order_relaxed);
+                    }
+                });
+        }
+        py::object future = py::module_::import("concurrent.futures").attr("Future")();
+        future.attr("set_running_or_notify_cancel")();
+        // Counted before the thread starts, so the exit hook waits for it.
+        AsyncRuns::started();
+        // Python objects used by the reporting thread, released there with
+        // the GIL; holding the analyzer keeps it alive during the run.
+        auto handles = std::make_unique<AsyncRunHandles>(AsyncRunHandles{
+            py::cast(this, py::return_value_policy::reference), future, progress, py::none()});
+        std::thread([this, state, interval, handles = std::move(handles)]() mutable {
+            std::thread loop([this, state]() {
+                try {
+                    analyzer_.run();
+                } catch (...) {
+                    state->error = std::current_exception();
+                }
+                {
+                    std::lock_guard<std::mutex> lock(state->mutex);
+                    state->done = true;
+                }
+                state->wake.notify_all();
+            });
+            {
+                std::unique_lock<std::mutex> lock(state->mutex);
+                const std::chrono::duration<double> period(interval);
+                while (!state->wake.wait_for(lock, period, [&state] { return state->done; })) {
+                    lock.unlock();
+                    if (!handles->progress.is_none()) {
+                        py::gil_scoped_acquire gil;
+                        reportProgress(*handles, state->entries());
+                    }
+                    lock.lock();
+                }
+            }
+            loop.join();
+            {
+                py::gil_scoped_acquire gil;
+                running_ = false;
+                finishAsyncRun(*state, *handles);
+                handles.reset();
+            }
+            AsyncRuns::finished();
+        }).detach();
+        claim.handOver();
+        return future;
+    }
     
     /**
      * @brief Get configuration value by key
@@ -705,6 +1002,142 @@ public:
     }
 
 private:
+    /// Entries between two partial counts of a slot in runAsync().
+    static constexpr ULong64_t kProgressEntries = 10000;
+
+    /// Marks the analyzer busy while one of its event loops (run(), save(),
+    /// runAsync(), the array and histogram exports) is in progress.
+    class RunClaim {
+    public:
+        explicit RunClaim(std::atomic<bool>& running) : running_(running) {
+            if (running_.exchange(true)) {
+                throw std::runtime_error("Analyzer: an event loop of this analyzer is already running");
+            }
+        }
+        ~RunClaim() {
+            if (owned_) {
+                running_ = false;
+            }
+        }
+        RunClaim(const RunClaim&) = delete;
+        RunClaim& operator=(const RunClaim&) = delete;
+        /// The claim is released by the thread the run was handed to.
+        void handOver() { owned_ = false; }
+
+    private:
+        std::atomic<bool>& running_;
+        bool owned_ = true;
+    };
+
+    struct AsyncRunHandles {
+        py::object self;
+        py::object future;
+        py::object progress;
+        /// First exception raised by @c progress; later calls are skipped.
+        py::object progressError;
+    };
+
+    /// Call the progress callback of @p handles (GIL held).
+    static void reportProgress(AsyncRunHandles& handles, ULong64_t entries) {
+        if (!handles.progressError.is_none()) {
+            return;
+        }
+        try {
+            handles.progress(entries);
+        } catch (py::error_already_set& e) {
+            handles.progressError = e.value();
+        }
+    }
+
+    /// Final progress report and result of a runAsync() call (GIL held).
+    static void finishAsyncRun(AsyncRunState& state, AsyncRunHandles& handles) {
+        if (!handles.progress.is_none()) {
+            // The exact count once the loop has run; the partial ones otherwise.
+            reportProgress(handles, !state.error && state.count.IsReady() ? *state.count
+                                                                          : state.entries());
+        }
+        py::object error = handles.progressError;
+        if (state.error) {
+            try {
+                std::rethrow_exception(state.error);
+            } catch (py::error_already_set& e) {
+                error = e.value();
+            } catch (const std::exception& e) {
+                error = py::module_::import("builtins").attr("RuntimeError")(e.what());
+            } catch (...) {
+                error = py::module_::import("builtins").attr("RuntimeError")(
+                    "Analyzer: unknown error in the event loop");
+            }
+        }
+        if (error.is_none()) {
+            handles.future.attr("set_result")(handles.self);
+        } else {
+            handles.future.attr("set_exception")(error);
+        }
+    }
+
+    /// One-dimensional NumPy array taking over the buffer of @p values.
+    template <typename T>
+    static py::array_t<T> ownedArray(std::vector<T>&& values) {
+        auto* owned = new std::vector<T>(std::move(values));
+        py::capsule release(owned, [](void* p) { delete static_cast<std::vector<T>*>(p); });
+        return py::array_t<T>({static_cast<py::ssize_t>(owned->size())}, owned->data(), release);
+    }
+
+    /// NumPy arrays owning the buffers of @p chunk, by column name.
+    static py::dict toNumpy(ColumnChunker::Chunk&& chunk) {
+        py::dict arrays;
+        for (size_t i = 0; i < chunk.columns.size(); ++i) {
+            const py::dtype dtype(chunk.dtypes[i]);
+            std::visit([&](auto& values) {
+                using Vector = std::decay_t<decltype(values)>;
+                auto* owned = new Vector(std::move(values));
+                py::capsule release(owned, [](void* p) { delete static_cast<Vector*>(p); });
+                arrays[chunk.columns[i].c_str()] =
+                    py::array(dtype, {static_cast<py::ssize_t>(owned->size())},
+                              {static_cast<py::ssize_t>(sizeof(typename Vector::value_type))},
+                              owned->data(), release);
+            }, chunk.data[i]);
+            if (!chunk.offsets[i].empty()) {
+                auto* owned = new std::vector<std::int64_t>(std::move(chunk.offsets[i]));
+                py::capsule release(owned, [](void* p) { delete static_cast<std::vector<std::int64_t>*>(p); });
+                arrays[(chunk.columns[i] + "_offsets").c_str()] =
+                    py::array_t<std::int64_t>({static_cast<py::ssize_t>(owned->size())},
+                                              owned->data(), release);
+            }
+        }
+        return arrays;
+    }
+
+    size_t iterateArrays(const std::vector<std::string>& columns,
+                         size_t chunk_size,
+                         const std::function<void(py::dict)>& consume) {
+        std::exception_ptr error;
+        ColumnChunker chunker(analyzer_.getDF(), columns, chunk_size,
+            [&](ColumnChunker::Chunk&& chunk) {
+                py::gil_scoped_acquire gil;
+                if (error) {
+                    return;
+                }
+                try {
+                    consume(toNumpy(std::move(chunk)));
+                } catch (...) {
+                    // Raised again once the event loop is over.
+                    error = std::current_exception();
+                }
+            });
+        size_t rows = 0;
+        {
+            RunClaim claim(running_);
+            py::gil_scoped_release release;
+            rows = chunker.run();
+        }
+        if (error) {
+            std::rethrow_exception(error);
+        }
+        return rows;
+    }
+
     template <typename T>
     T& requirePlugin(const std::string& role, const std::string& typeName) {
         auto plugin = analyzer_.getPlugin<T>(role);
@@ -733,11 +1166,20 @@ private:
     }
 
     Analyzer analyzer_;
+    /// Input of the analysis, where runAsync() counts the entries read.
+    ROOT::RDF::RNode input_;
+    std::atomic<bool> running_{false};
 };
 
 PYBIND11_MODULE(rdfanalyzer, m) {
     m.doc() = "Python bindings for RDFAnalyzerCore framework";
 
+    // Runs started by runAsync() finish before the interpreter shuts down.
+    py::module_::import("atexit").attr("register")(py::cpp_function([]() {
+        py::gil_scoped_release release;
+        AsyncRuns::wait();
+    }));
+
     py::class_<histInfo>(m, "HistInfo",
         "Histogram booking descriptor equivalent to C++ histInfo")
         .def(py::init([](const std::string& name,
@@ -955,6 +1397,40 @@ PYBIND11_MODULE(rdfanalyzer, m) {
              ...                            ["eta1", "eta2"])
              )pbdoc",
              py::return_value_policy::reference_internal)
+        .def("DefineFromBlockPointer", &AnalyzerPythonWrapper::DefineFromBlockPointer,
+             py::arg("name"),
+             py::arg("func_ptr"),
+             py::arg("columns"),
+             py::arg("block_size") = 4096,
+             py::arg("output_type") = "double",
+             R"pbdoc(
+             Define a variable with a columnar kernel over blocks of events.
+
+             The kernel is called once per ``block_size`` events with
+             contiguous float64 arrays of its inputs, instead of once per
+             event, so numba can vectorise it. Its C signature is
+             ``void(int64 n, double** inputs, int64** offsets, double* out)``:
+             ``inputs[i]`` holds the values of column ``i`` (flattened for RVec
+             columns), ``offsets[i]`` is null for scalar columns and holds
+             ``n + 1`` offsets for RVec columns. The kernel runs in a
+             separate event loop before the column is defined; call it
+             before booking histograms.
+
+             Examples
+             --------
+             >>> from numba import cfunc, carray, types
+             >>> sig = types.void(types.int64, types.CPointer(types.CPointer(types.float64)),
+             ...                  types.CPointer(types.CPointer(types.int64)),
+             ...                  types.CPointer(types.float64))
+             >>> @cfunc(sig)
+             ... def ht(n, inputs, offsets, out):
+             ...     off = carray(offsets[0], n + 1)
+             ...     pt = carray(inputs[0], off[n])
+             ...     for i in range(n):
+             ...         out[i] = pt[off[i]:off[i + 1]].sum()
+             >>> analyzer.DefineFromBlockPointer("ht", ht.address, ["Jet_pt"])
+             )pbdoc",
+             py::return_value_policy::reference_internal)
         .def("DefineFromVector", &AnalyzerPythonWrapper::DefineFromVector,
              py::arg("name"),
              py::arg("data_ptr"),
@@ -1004,8 +1480,51 @@ PYBIND11_MODULE(rdfanalyzer, m) {
                )pbdoc",
                py::return_value_policy::reference_internal)
         .def("save", &AnalyzerPythonWrapper::save,
-               "Trigger computation and save the analysis results",
+               "Trigger computation and save the analysis results (without holding the GIL)",
                py::return_value_policy::reference_internal)
+        .def("run", &AnalyzerPythonWrapper::run,
+               R"pbdoc(
+               Run the analysis as Analyzer::run() does: event loop, save,
+               plugin and service finalization.
+
+               The GIL is released for the whole run, so other Python threads
+               keep running meanwhile.
+               )pbdoc",
+               py::return_value_policy::reference_internal)
+        .def("runAsync", &AnalyzerPythonWrapper::runAsync,
+               py::arg("progress") = py::none(),
+               py::arg("interval") = 1.0,
+               R"pbdoc(
+               Start :py:meth:`run` on a background thread and return at once.
+
+               Parameters
+               ----------
+               progress : callable, optional
+                   Called as ``progress(entries)`` with the input entries read
+                   so far, every ``interval`` seconds and once when the run is
+                   over.  It is called from a reporting thread, never from the
+                   processing threads.  An exception it raises stops the
+                   reports and becomes the exception of the future.
+               interval : float
+                   Seconds between two progress reports.
+
+               Returns
+               -------
+               concurrent.futures.Future
+                   Resolves to this analyzer, or raises the error of the run.
+                   ``asyncio.wrap_future`` makes it awaitable.
+
+               Several analyzers may run at once; a second run of the same
+               analyzer raises until the first is over.  Do not modify the
+               analyzer while it runs.  The interpreter waits for the runs
+               still in progress when it exits.
+
+               Example
+               -------
+               >>> futures = [a.runAsync(progress=print) for a in analyzers]
+               >>> for f in futures:
+               ...     f.result()
+               )pbdoc")
         .def("configMap", &AnalyzerPythonWrapper::configMap,
              py::arg("key"),
                "Get a configuration value by key")
@@ -1059,6 +1578,33 @@ PYBIND11_MODULE(rdfanalyzer, m) {
                "Compute systematic variation list for a branch")
            .def("GetColumnNames", &AnalyzerPythonWrapper::GetColumnNames,
                "Get current dataframe column names")
+           .def("IterateArrays", &AnalyzerPythonWrapper::IterateArrays,
+               py::arg("columns"),
+               py::arg("chunk_size") = 65536,
+               py::arg("callback"),
+               R"pbdoc(
+               Run the event loop and stream numeric columns to a callback.
+
+               The callback receives dicts of NumPy arrays with up to
+               ``chunk_size`` rows each. RVec columns are flattened and come
+               with ``<column>_offsets`` (rows + 1 entries). The arrays own the buffers filled by
+               the event loop, so no value is copied or boxed. With several
+               threads, chunks of different slots arrive interleaved.
+               Returns the number of rows delivered.
+
+               Example:
+                   >>> analyzer.IterateArrays(["pt", "eta", "weight"], 100000,
+                   ...                        lambda chunk: trainer.feed(chunk))
+               )pbdoc")
+           .def("AsArrays", &AnalyzerPythonWrapper::AsArrays,
+               py::arg("columns"),
+               R"pbdoc(
+               Run the event loop and return scalar columns as NumPy arrays.
+
+               Like RDataFrame.AsNumpy for numeric columns, without per-event
+               Python objects; RVec columns are flattened with
+               ``<column>_offsets``.
+               )pbdoc")
            .def("AddPlugin", &AnalyzerPythonWrapper::AddPlugin,
                py::arg("role"),
                py::arg("pluginType"),
@@ -1110,6 +1656,7 @@ PYBIND11_MODULE(rdfanalyzer, m) {
                py::arg("stringArguments"),
                py::arg("inputColumns") = std::vector<std::string>{},
                py::arg("outputBranch") = "",
+               py::arg("blockEvaluation") = false,
                py::return_value_policy::reference_internal)
            .def("registerCorrection", &AnalyzerPythonWrapper::registerCorrection,
                py::arg("role"),
@@ -1156,7 +1703,31 @@ PYBIND11_MODULE(rdfanalyzer, m) {
                py::return_value_policy::reference_internal)
            .def("clearNDHistograms", &AnalyzerPythonWrapper::clearNDHistograms,
                py::arg("role"),
-               py::return_value_policy::reference_internal);
+               py::return_value_policy::reference_internal)
+           .def("getNDHistogramArrays", &AnalyzerPythonWrapper::getNDHistogramArrays,
+               py::arg("role") = "hist",
+               R"pbdoc(
+               Filled bins of the booked histograms as NumPy arrays.
+
+               Runs the event loop if it has not run yet; no ROOT file is
+               written or read.  Every histogram is keyed by its booking name
+               and described as in a histogram pack: ``axes`` (bin edges of
+               each THnSparse axis), and ``bins`` (linear bin index with
+               under- and overflow, first axis fastest), ``sums`` and
+               ``sumw2`` of its filled bins, sorted by bin.  The bin arrays
+               own the buffers they were collected into.
+
+               Returns
+               -------
+               dict[str, dict]
+                   ``{name: {"axes", "bins", "sums", "sumw2"}}``.
+
+               Example
+               -------
+               >>> from histogram_pack import PackedHistogram
+               >>> arrays = analyzer.getNDHistogramArrays("hist")
+               >>> h = PackedHistogram("pt_Nominal", **arrays["pt_Nominal"]).to_boost()
+               )pbdoc");
     
     // Version info
     m.attr("__version__") = "1.0.0";
@@ -1241,6 +1812,8 @@ PYBIND11_MODULE(rdfanalyzer, m) {
             *True* if the plot was created and saved successfully.
         message : str
             Error description when *success* is *False*.
+        skipped : bool
+            *True* when the existing output was up to date and kept.
         mcIntegral : float
             Integral of the total MC stack histogram.
         dataIntegral : float
@@ -1250,7 +1823,27 @@ PYBIND11_MODULE(rdfanalyzer, m) {
         .def_readwrite("success", &PlotResult::success)
         .def_readwrite("message", &PlotResult::message)
         .def_readwrite("mcIntegral", &PlotResult::mcIntegral)
-        .def_readwrite("dataIntegral", &PlotResult::dataIntegral);
+        .def_readwrite("dataIntegral", &PlotResult::dataIntegral)
+        .def_readwrite("skipped", &PlotResult::skipped);
+
+    py::class_<PlotBatchOptions>(m, "PlotBatchOptions",
+        R"pbdoc(
+        Options of :py:meth:`PlottingUtility.makeStackPlots`.
+
+        Attributes
+        ----------
+        parallel : bool
+            Render on a pool of worker threads.
+        maxWorkers : int
+            Pool size; 0 (default) uses the hardware concurrency.
+        skipUnchanged : bool
+            Keep plots whose input histograms and style have not changed
+            since they were written (tracked in ``<outputFile>.hash``).
+        )pbdoc")
+        .def(py::init<>())
+        .def_readwrite("parallel", &PlotBatchOptions::parallel)
+        .def_readwrite("maxWorkers", &PlotBatchOptions::maxWorkers)
+        .def_readwrite("skipUnchanged", &PlotBatchOptions::skipUnchanged);
 
     py::class_<PlottingUtility>(m, "PlottingUtility",
         R"pbdoc(
@@ -1301,9 +1894,12 @@ PYBIND11_MODULE(rdfanalyzer, m) {
              PlotResult
                  Success flag, optional error message, and histogram integrals.
              )pbdoc")
-        .def("makeStackPlots", &PlottingUtility::makeStackPlots,
+        .def("makeStackPlots",
+             py::overload_cast<const std::vector<PlotRequest>&, bool>(
+                 &PlottingUtility::makeStackPlots, py::const_),
              py::arg("requests"),
              py::arg("parallel") = false,
+             py::call_guard<py::gil_scoped_release>(),
              R"pbdoc(
              Create and save multiple stack plots.
 
@@ -1312,12 +1908,129 @@ PYBIND11_MODULE(rdfanalyzer, m) {
              requests : list[PlotRequest]
                  List of plot specifications.
              parallel : bool
-                 When *True*, plots are rendered concurrently using
-                 ``std::async``.  ROOT thread-safety is enabled automatically.
+                 When *True*, plots are rendered on a pool of worker
+                 threads.  ROOT thread-safety is enabled automatically.
 
              Returns
              -------
              list[PlotResult]
                  One result per request, in the same order.
+             )pbdoc")
+        .def("makeStackPlots",
+             py::overload_cast<const std::vector<PlotRequest>&, const PlotBatchOptions&>(
+                 &PlottingUtility::makeStackPlots, py::const_),
+             py::arg("requests"),
+             py::arg("options"),
+             py::call_guard<py::gil_scoped_release>(),
+             R"pbdoc(
+             Create and save multiple stack plots with batch options.
+
+             Every input histogram is read once before any plot is drawn.
+
+             Parameters
+             ----------
+             requests : list[PlotRequest]
+                 List of plot specifications.
+             options : PlotBatchOptions
+                 Worker pool and skipping of unchanged plots.
+
+             Returns
+             -------
+             list[PlotResult]
+                 One result per request, in the same order.
+             )pbdoc")
+        .def_static("inputHash", &PlottingUtility::inputHash,
+             py::arg("request"),
+             R"pbdoc(
+             Hash of the style of *request* and the contents of its input
+             histograms, as recorded in ``<outputFile>.hash``.
              )pbdoc");
+
+    // ---------------------------------------------------------------------------
+    // SparseProjector bindings
+    // ---------------------------------------------------------------------------
+
+    py::class_<SparseProjection>(m, "SparseProjection",
+        R"pbdoc(
+        One 1D projection of a THnSparse, for :py:func:`projectSparse`.
+
+        Parameters
+        ----------
+        name : str
+            Name of the output shape.
+        axis : int
+            Axis projected onto.
+        fixedBins : list[tuple[int, int]]
+            ``(axis, bin)`` selections, e.g. the region and systematic bins;
+            the other axes are summed.
+        )pbdoc")
+        .def(py::init<>())
+        .def(py::init([](const std::string& name, int axis,
+                         const std::vector<std::pair<int, int>>& fixedBins) {
+                 return SparseProjection{name, axis, fixedBins};
+             }),
+             py::arg("name"), py::arg("axis"),
+             py::arg("fixedBins") = std::vector<std::pair<int, int>>())
+        .def_readwrite("name", &SparseProjection::name)
+        .def_readwrite("axis", &SparseProjection::axis)
+        .def_readwrite("fixedBins", &SparseProjection::fixedBins);
+
+    m.def("projectSparse",
+        [](const std::string& path,
+           const std::map<std::string, std::vector<SparseProjection>>& projections) {
+            std::map<std::string, std::vector<std::unique_ptr<TH1D>>> results;
+            {
+                py::gil_scoped_release release;
+                results = SparseProjector::projectFile(path, projections);
+            }
+            py::dict out;
+            for (const auto& [histName, shapes] : results) {
+                py::dict byName;
+                for (const auto& shape : shapes) {
+                    const int bins = shape->GetNbinsX();
+                    py::array_t<double> values(bins + 2);
+                    py::array_t<double> variances(bins + 2);
+                    py::array_t<double> edges(bins + 1);
+                    auto v = values.mutable_unchecked<1>();
+                    auto w = variances.mutable_unchecked<1>();
+                    auto e = edges.mutable_unchecked<1>();
+                    for (int b = 0; b <= bins + 1; ++b) {
+                        v(b) = shape->GetBinContent(b);
+                        w(b) = shape->GetBinError(b) * shape->GetBinError(b);
+                    }
+                    for (int b = 1; b <= bins + 1; ++b) {
+                        e(b - 1) = shape->GetXaxis()->GetBinLowEdge(b);
+                    }
+                    byName[py::str(shape->GetName())] = py::make_tuple(values, variances, edges);
+                }
+                out[py::str(histName)] = byName;
+            }
+            return out;
+        },
+        py::arg("path"), py::arg("projections"),
+        R"pbdoc(
+        Project THnSparse histograms of a ROOT file into many 1D shapes.
+
+        Each histogram is scanned once for all of its projections, and the
+        histograms are projected in parallel when implicit multi-threading is
+        enabled.
+
+        Parameters
+        ----------
+        path : str
+            ROOT file holding the histograms.
+        projections : dict[str, list[SparseProjection]]
+            Projections of each histogram, keyed by its path in the file.
+
+        Returns
+        -------
+        dict[str, dict[str, tuple]]
+            ``{histogram: {shape: (values, variances, edges)}}``; ``values``
+            and ``variances`` include the under- and overflow bins.
+
+        Example
+        -------
+        >>> shapes = rdfanalyzer.projectSparse("merged.root", {
+        ...     "Nominal/mass": [rdfanalyzer.SparseProjection("SR", 0, [(1, 2)])]})
+        )pbdoc");
 }
@@ -0,0 +1,150 @@
+"""
+Reduced-precision copies of ONNX models for OnnxManager.
+
+A model entry of the ONNX config with ``precision=fp16`` or ``precision=int8``
+is loaded from a converted copy instead of the original ``file``.  The copies
+live in ``onnxConvertedModelDir`` (default ``onnx_converted``) under the name
+``<md5 of the original model>.<precision>.onnx``, the name computed by
+``OnnxManager::convertedModelFile``, so a model is converted once and a
+retrained model under the same path gets a new copy.
+
+* ``int8`` – dynamic quantization of the weights to 8-bit integers
+  (``onnxruntime.quantization.quantize_dynamic``).  Activations are
+  quantized on the fly, so no calibration data is needed; on CPUs with
+  AVX-512 VNNI the integer kernels run several times faster than fp32.
+* ``fp16`` – conversion of the weights and operators to half precision
+  (``onnxconverter_common.float16``), meant for the CUDA execution provider.
+
+Inputs and outputs stay fp32 in both cases, so the columns fed to and read
+from the model do not change.
+
+Usage
+-----
+From the command line::
+
+    python convert_onnx_precision.py --precision int8 \\
+        --output-dir onnx_converted aux/tagger.onnx
+
+Programmatically::
+
+    from convert_onnx_precision import convert
+
+    path = convert("aux/tagger.onnx", "int8", "onnx_converted")
+"""
+
+from __future__ import annotations
+
+import argparse
+import hashlib
+import os
+import sys
+from typing import List, Optional
+
+#: Precisions with a converted copy.
+PRECISIONS = ("fp16", "int8")
+
+
+def model_digest(model_path: str) -> str:
+    """MD5 hex digest of the contents of *model_path*."""
+    md5 = hashlib.md5()
+    with open(model_path, "rb") as fh:
+        for block in iter(lambda: fh.read(1 << 16), b""):
+            md5.update(block)
+    return md5.hexdigest()
+
+
+def converted_model_path(model_path: str, precision: str, output_dir: str) -> str:
+    """Path OnnxManager loads the *precision* copy of *model_path* from.
+
+    Raises
+    ------
+    ValueError
+        If *precision* is not one of :data:`PRECISIONS`.
+    FileNotFoundError
+        If *model_path* does not exist.
+    """
+    if precision not in PRECISIONS:
+        raise ValueError(
+            f"unknown precision '{precision}'; expected one of {', '.join(PRECISIONS)}"
+        )
+    return os.path.join(output_dir, f"{model_digest(model_path)}.{precision}.onnx")
+
+
+def _convert_int8(model_path: str, output_path: str) -> None:
+    try:
+        from onnxruntime.quantization import QuantType, quantize_dynamic  # type: ignore[import]
+    except ImportError as exc:
+        raise ImportError(
+            "onnxruntime is required for int8 quantization.  "
+            "Install it with: pip install onnxruntime"
+        ) from exc
+    quantize_dynamic(model_path, output_path, weight_type=QuantType.QInt8)
+
+
+def _convert_fp16(model_path: str, output_path: str) -> None:
+    try:
+        import onnx  # type: ignore[import]
+        from onnxconverter_common import float16  # type: ignore[import]
+    except ImportError as exc:
+        raise ImportError(
+            "onnx and onnxconverter-common are required for fp16 conversion.  "
+            "Install them with: pip install onnx onnxconverter-common"
+        ) from exc
+    model = float16.convert_float_to_float16(onnx.load(model_path), keep_io_types=True)
+    onnx.save(model, output_path)
+
+
+def convert(model_path: str, precision: str, output_dir: str, force: bool = False) -> str:
+    """Write the *precision* copy of *model_path* to *output_dir*.
+
+    An existing copy is kept unless *force* is set.  The copy is written to a
+    temporary file and renamed, so jobs never load a partial model.
+
+    Returns
+    -------
+    str
+        Path of the converted model.
+    """
+    output_path = converted_model_path(model_path, precision, output_dir)
+    if os.path.exists(output_path) and not force:
+        return output_path
+    os.makedirs(output_dir, exist_ok=True)
+    tmp_path = f"{output_path}.tmp.{os.getpid()}"
+    try:
+        if precision == "int8":
+            _convert_int8(model_path, tmp_path)
+        else:
+            _convert_fp16(model_path, tmp_path)
+        os.replace(tmp_path, output_path)
+    finally:
+        if os.path.exists(tmp_path):
+            os.remove(tmp_path)
+    return output_path
+
+
+def main(argv: Optional[List[str]] = None) -> int:
+    """Command-line entrypoint: convert one or more models."""
+    parser = argparse.ArgumentParser(
+        description="Convert ONNX models to the reduced precision used by OnnxManager.",
+    )
+    parser.add_argument("models", nargs="+", metavar="MODEL",
+                        help="Original ONNX model file(s), as given in the ONNX config.")
+    parser.add_argument("--precision", required=True, choices=PRECISIONS,
+                        help="Target precision.")
+    parser.add_argument("--output-dir", default="onnx_converted",
+                        help="Directory of the converted copies (onnxConvertedModelDir).")
+    parser.add_argument("--force", action="store_true",
+                        help="Convert again even if a copy exists.")
+    args = parser.parse_args(argv)
+
+    try:
+        for model in args.models:
+            print(convert(model, args.precision, args.output_dir, force=args.force))
+    except (OSError, ValueError, ImportError) as exc:
+        print(f"convert_onnx_precision: {exc}", file=sys.stderr)
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -192,6 +192,10 @@ class DatacardGenerator:
             print(f"  Processing {sample_name}: {file_path}")
             
             try:
+                if file_path.endswith('.rdfh'):
+                    self.histograms.setdefault(sample_name, {})
+                    self._read_histograms_from_pack(file_path, sample_name)
+                    continue
                 with uproot.open(file_path) as root_file:
                     # Store file reference
                     if sample_name not in self.histograms:
@@ -203,6 +207,19 @@ class DatacardGenerator:
                 print(f"Error reading file {file_path}: {e}")
                 continue
     
+    def _read_histograms_from_pack(self, file_path: str, sample_name: str) -> None:
+        """Read the 1D histograms of a histogram pack (histogramPackFile)."""
+        from histogram_pack import read_pack
+
+        with read_pack(file_path) as pack:
+            for name, packed in pack.histograms.items():
+                if len(packed.axes) != 1:
+                    continue
+                values, _ = packed.dense()
+                self.histograms[sample_name][name] = Histogram1D(
+                    values, list(packed.axes[0]), name
+                )
+
     def _read_histograms_from_file(self, root_file, sample_name: str, prefix: str = "") -> None:
         """
         Read all 1D histograms from a ROOT file using uproot.
@@ -0,0 +1,234 @@
+"""
+Reader and merger for histogram packs (``.rdfh``).
+
+A histogram pack is the flat binary copy of a job's histograms written by
+NDHistogramManager when ``histogramPackFile`` is set (see
+``core/interface/HistogramPack.h`` for the layout).  Every histogram is three
+parallel arrays of its filled bins - linear bin index, sum of weights and sum
+of squared weights, sorted by bin index - plus a reference into a table of
+axis schemas shared by the whole file.
+
+:func:`read_pack` memory-maps the file and exposes the arrays in place, so
+reading thousands of packs costs little more than their I/O.
+:func:`merge_packs` adds packs one at a time with a sorted merge of the bin
+arrays.
+
+Usage::
+
+    from histogram_pack import merge_packs, read_pack
+
+    merge_packs("merged.rdfh", ["job_0/hists.rdfh", "job_1/hists.rdfh"])
+    with read_pack("merged.rdfh") as pack:
+        for name, hist in pack.histograms.items():
+            values = hist.dense()
+
+Histograms still in memory after a run come from the Python bindings in the
+same layout: ``PackedHistogram(name, **analyzer.getNDHistogramArrays()[name])``.
+"""
+
+from __future__ import annotations
+
+import mmap
+import struct
+from dataclasses import dataclass
+from typing import Dict, List, Sequence, Tuple
+
+MAGIC = b"RDFHPACK"
+VERSION = 1
+
+_HEADER = struct.Struct("<8sIIQ")
+_PAIR = struct.Struct("<II")
+_HIST_HEADER = struct.Struct("<IIQ")
+
+
+def _padded(size: int) -> int:
+    return (size + 7) // 8 * 8
+
+
+@dataclass
+class PackedHistogram:
+    """Filled bins of one histogram; ``bins``/``sums``/``sumw2`` are sequences."""
+
+    name: str
+    axes: List[Sequence[float]]
+    bins: Sequence[int]
+    sums: Sequence[float]
+    sumw2: Sequence[float]
+
+    def dense(self, flow: bool = False) -> Tuple[List[float], List[float]]:
+        """Bin contents and squared errors of a one-axis histogram.
+
+        Without ``flow`` the under- and overflow bins are dropped, as
+        ``uproot``'s ``values()`` does.
+        """
+        if len(self.axes) != 1:
+            raise ValueError(f"{self.name} has {len(self.axes)} axes, not 1")
+        size = len(self.axes[0]) + 1
+        values = [0.0] * size
+        variances = [0.0] * size
+        for bin_index, total, total_w2 in zip(self.bins, self.sums, self.sumw2):
+            values[bin_index] = total
+            variances[bin_index] = total_w2
+        if not flow:
+            return values[1:-1], variances[1:-1]
+        return values, variances
+
+    def to_boost(self):
+        """``boost_histogram.Histogram`` with ``Weight`` storage, flow bins filled.
+
+        ``hist.Hist(packed.to_boost())`` gives a ``hist`` object.
+        """
+        import boost_histogram as bh
+        import numpy as np
+
+        hist = bh.Histogram(*(bh.axis.Variable(list(edges)) for edges in self.axes),
+                            storage=bh.storage.Weight())
+        shape = tuple(len(edges) + 1 for edges in self.axes)
+        index = np.unravel_index(np.asarray(self.bins, dtype=np.intp), shape, order="F")
+        view = hist.view(flow=True)
+        view.value[index] = np.asarray(self.sums, dtype=float)
+        view.variance[index] = np.asarray(self.sumw2, dtype=float)
+        return hist
+
+
+class HistogramPack:
+    """A memory-mapped histogram pack; use as a context manager."""
+
+    def __init__(self, path: str):
+        self.path = path
+        self._file = open(path, "rb")
+        try:
+            self._map = mmap.mmap(self._file.fileno(), 0, access=mmap.ACCESS_READ)
+        except ValueError:  # empty file
+            self._file.close()
+            raise ValueError(f"{path} is not a histogram pack")
+        self.schemas: List[List[Sequence[float]]] = []
+        self.histograms: Dict[str, PackedHistogram] = {}
+        try:
+            self._parse()
+        except Exception:
+            self.close()
+            raise
+
+    def _parse(self) -> None:
+        data = memoryview(self._map)
+        if len(data) < _HEADER.size:
+            raise ValueError(f"{self.path} is not a histogram pack")
+        magic, version, schema_count, histogram_count = _HEADER.unpack_from(data, 0)
+        if magic != MAGIC:
+            raise ValueError(f"{self.path} is not a histogram pack")
+        if version != VERSION:
+            raise ValueError(f"{self.path} has unsupported version {version}")
+        offset = _HEADER.size
+        for _ in range(schema_count):
+            axis_count, _reserved = _PAIR.unpack_from(data, offset)
+            offset += _PAIR.size
+            axes = []
+            for _ in range(axis_count):
+                bins, _reserved = _PAIR.unpack_from(data, offset)
+                offset += _PAIR.size
+                end = offset + 8 * (bins + 1)
+                axes.append(data[offset:end].cast("d"))
+                offset = end
+            self.schemas.append(axes)
+        for _ in range(histogram_count):
+            schema, name_length, entries = _HIST_HEADER.unpack_from(data, offset)
+            offset += _HIST_HEADER.size
+            name = bytes(data[offset:offset + name_length]).decode()
+            offset += _padded(name_length)
+            arrays = []
+            for fmt in ("Q", "d", "d"):
+                end = offset + 8 * entries
+                if end > len(data):
+                    raise ValueError(f"{self.path} is truncated")
+                arrays.append(data[offset:end].cast(fmt))
+                offset = end
+            self.histograms[name] = PackedHistogram(name, self.schemas[schema], *arrays)
+
+    def close(self) -> None:
+        # Views into the map must be released before it can be closed.
+        self.histograms = {}
+        self.schemas = []
+        try:
+            self._map.close()
+        except BufferError:
+            pass
+        self._file.close()
+
+    def __enter__(self) -> "HistogramPack":
+        return self
+
+    def __exit__(self, *exc) -> None:
+        self.close()
+
+
+def read_pack(path: str) -> HistogramPack:
+    """Memory-map the pack at ``path``."""
+    return HistogramPack(path)
+
+
+def _add(into: Dict[str, list], hist: PackedHistogram) -> None:
+    axes = [list(axis) for axis in hist.axes]
+    entry = into.get(hist.name)
+    if entry is None:
+        into[hist.name] = [axes, list(hist.bins), list(hist.sums), list(hist.sumw2)]
+        return
+    if entry[0] != axes:
+        raise ValueError(f"histogram {hist.name!r} has different binnings in the merged packs")
+    _, bins_a, sums_a, w2_a = entry
+    bins, sums, w2 = [], [], []
+    a = b = 0
+    while a < len(bins_a) or b < len(hist.bins):
+        if b == len(hist.bins) or (a < len(bins_a) and bins_a[a] < hist.bins[b]):
+            bins.append(bins_a[a])
+            sums.append(sums_a[a])
+            w2.append(w2_a[a])
+            a += 1
+        elif a == len(bins_a) or hist.bins[b] < bins_a[a]:
+            bins.append(hist.bins[b])
+            sums.append(hist.sums[b])
+            w2.append(hist.sumw2[b])
+            b += 1
+        else:
+            bins.append(bins_a[a])
+            sums.append(sums_a[a] + hist.sums[b])
+            w2.append(w2_a[a] + hist.sumw2[b])
+            a += 1
+            b += 1
+    entry[1:] = [bins, sums, w2]
+
+
+def write_pack(path: str, histograms: Dict[str, list]) -> None:
+    """Write ``{name: [axes, bins, sums, sumw2]}`` as a pack."""
+    schemas: List[List[List[float]]] = []
+    chunks = []
+    for name, (axes, bins, sums, sumw2) in histograms.items():
+        if axes not in schemas:
+            schemas.append(axes)
+        encoded = name.encode()
+        chunks.append(_HIST_HEADER.pack(schemas.index(axes), len(encoded), len(bins)))
+        chunks.append(encoded.ljust(_padded(len(encoded)), b"\0"))
+        chunks.append(struct.pack(f"<{len(bins)}Q", *bins))
+        chunks.append(struct.pack(f"<{len(sums)}d", *sums))
+        chunks.append(struct.pack(f"<{len(sumw2)}d", *sumw2))
+    with open(path, "wb") as out:
+        out.write(_HEADER.pack(MAGIC, VERSION, len(schemas), len(histograms)))
+        for axes in schemas:
+            out.write(_PAIR.pack(len(axes), 0))
+            for edges in axes:
+                out.write(_PAIR.pack(len(edges) - 1, 0))
+                out.write(struct.pack(f"<{len(edges)}d", *edges))
+        for chunk in chunks:
+            out.write(chunk)
+
+
+def merge_packs(output: str, inputs: Sequence[str]) -> None:
+    """Add the packs ``inputs`` bin by bin and write the sum to ``output``."""
+    if not inputs:
+        raise ValueError("no histogram packs to merge")
+    merged: Dict[str, list] = {}
+    for path in inputs:
+        with read_pack(path) as pack:
+            for hist in pack.histograms.values():
+                _add(merged, hist)
+    write_pack(output, merged)
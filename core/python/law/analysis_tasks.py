@@ -160,7 +160,13 @@ from submission_backend import (  # noqa: E402
     write_submit_files,
 )
 from workflow_executors import DaskWorkflow, HTCondorWorkflow, _run_analysis_job  # noqa: E402
-from partition_utils import _make_partitions  # noqa: E402
+from partition_utils import (  # noqa: E402
+    _config_cost_key,
+    _entries_for_target,
+    _load_job_costs,
+    _make_partitions,
+)
+from output_cache import OutputCache, code_version, job_cache_key  # noqa: E402
 from output_schema import (  # noqa: E402
     ArtifactResolutionStatus,
     CutflowSchema,
@@ -1762,13 +1768,22 @@ def _plan_file_source_jobs(
     entries_per_job: int,
     jobs_dir: str,
     outputs_dir: str,
+    job_costs: Optional[dict[tuple[str, str], tuple[int, float]]] = None,
+    config_hash: str = "",
+    target_job_seconds: float = 0,
 ) -> list[dict[str, object]]:
-    """Build deterministic per-job metadata from file-list JSON outputs."""
+    """Build deterministic per-job metadata from file-list JSON outputs.
+
+    With *job_costs* (from :func:`partition_utils._load_job_costs`) and a
+    positive *target_job_seconds*, ``entry_range`` jobs of datasets measured
+    with *config_hash* get the number of entries expected to take
+    *target_job_seconds*; other datasets use *entries_per_job*.
+    """
     job_plans: list[dict[str, object]] = []
     missing_datasets: list[str] = []
 
     for json_path in sorted(Path(file_list_dir).glob("*.json")):
-        if json_path.name.endswith(".perf.json"):
+        if json_path.name.endswith((".perf.json", ".entry_index.json")):
             continue
 
         with open(json_path) as fh:
@@ -1793,11 +1808,22 @@ def _plan_file_source_jobs(
             if not all_files:
                 missing_datasets.append(str(dataset_name))
                 continue
+            # Entry counts and cluster boundaries persist next to the file
+            # list so later runs partition without reopening the files.
             partitions = _make_partitions(
                 urls=all_files,
                 mode=partition,
                 files_per_job=files_per_job,
-                entries_per_job=entries_per_job,
+                entries_per_job=_entries_for_target(
+                    job_costs or {},
+                    str(dataset_name),
+                    config_hash,
+                    target_job_seconds,
+                    entries_per_job,
+                ),
+                index_path=str(
+                    Path(file_list_dir) / f"{dataset_name}.entry_index.json"
+                ),
             )
 
         dataset_entry = _find_dataset_entry(dataset_manifest_path, dataset_name)
@@ -1871,6 +1897,37 @@ class AnalysisMixin:
             "One workflow branch is created per dataset entry in the manifest."
         ),
     )
+    output_cache = luigi.Parameter(
+        default="",
+        description=(
+            "Shared directory of a content-addressed output cache.  A job "
+            "whose input file and dataset manifest hashes, config, referenced "
+            "files, executable and code version match a cached job has its outputs hard-linked from the "
+            "cache instead of running; finished jobs are added to it.  "
+            "Empty (default) disables the cache."
+        ),
+    )
+
+    # ---- output cache --------------------------------------------------------
+
+    def _run_cached(self, config_path: str, exe_path: str, out_dir: str, run_job):
+        """Run *run_job* unless the output cache already holds its outputs.
+
+        Returns ``(result, restored)``; *restored* is ``True`` when the
+        outputs in *out_dir* were linked from the cache.
+        """
+        if not self.output_cache:
+            return run_job(), False
+        cache = OutputCache(self.output_cache)
+        key = job_cache_key(
+            config_path, exe_path, code_version(config_path), self.dataset_manifest
+        )
+        if cache.restore(key, out_dir):
+            self.publish_message(f"[output-cache] restored {out_dir} from {key[:12]}")
+            return f"restored from output cache ({key})", True
+        result = run_job()
+        cache.store(key, out_dir)
+        return result, False
 
     # ---- derived directory helpers -----------------------------------------
 
@@ -1942,10 +1999,27 @@ class SkimMixin:
     entries_per_job = luigi.IntParameter(
         default=100_000,
         description=(
-            "Maximum TTree entries per job in 'entry_range' mode (default: 100000). "
+            "Minimum TTree entries per job in 'entry_range' mode (default: 100000); "
+            "ranges are extended to the next TTree cluster boundary. "
             "Requires uproot.  Ignored for 'file_group' and 'file' modes."
         ),
     )
+    cost_from = luigi.Parameter(
+        default="",
+        description=(
+            "Comma-separated earlier run directories (e.g. skimRun_<name>) whose "
+            "job.perf.json wall times give the events/s of each dataset.  With "
+            "--target-job-seconds, 'entry_range' jobs of measured datasets are "
+            "sized to that wall time; others use --entries-per-job."
+        ),
+    )
+    target_job_seconds = luigi.IntParameter(
+        default=0,
+        description=(
+            "Target wall time per job in seconds for cost-model partitioning "
+            "with --cost-from (default: 0 = disabled)."
+        ),
+    )
 
     # ---- worker environment -----------------------------------------------
 
@@ -2086,6 +2160,26 @@ class SkimMixin:
             return ""
         return os.path.join(WORKSPACE, f"{prefix}_{self._effective_file_source_name}")
 
+    def _job_cost_args(self) -> dict[str, Any]:
+        """Cost-model arguments for :func:`_plan_file_source_jobs`.
+
+        Run directories in ``--cost-from`` are resolved relative to the
+        workspace.  The config hash is that of the submit-config template.
+        """
+        config_hash = ""
+        if os.path.isfile(self.submit_config):
+            config_hash = _config_cost_key(read_config(self.submit_config))
+        run_dirs = [
+            os.path.join(WORKSPACE, d.strip())
+            for d in str(self.cost_from).split(",")
+            if d.strip()
+        ]
+        return {
+            "job_costs": _load_job_costs(run_dirs) if run_dirs else {},
+            "config_hash": config_hash,
+            "target_job_seconds": self.target_job_seconds,
+        }
+
     @property
     def _effective_file_source_name(self) -> str:
         """Return the configured file-source name or fall back to the run name."""
@@ -2250,6 +2344,7 @@ class PrepareSkimJobs(AnalysisMixin, SkimMixin, law.Task):
                     f"--name {self.file_source_name!r} ..."
                 )
 
+            cost_args = self._job_cost_args()
             planned_jobs = _plan_file_source_jobs(
                 dataset_manifest_path=self.dataset_manifest,
                 file_list_dir=fl_dir,
@@ -2258,8 +2353,15 @@ class PrepareSkimJobs(AnalysisMixin, SkimMixin, law.Task):
                 entries_per_job=self.entries_per_job,
                 jobs_dir=self._jobs_dir,
                 outputs_dir=self._outputs_dir,
+                **cost_args,
             )
 
+            # Jobs per dataset, so that a job can tell it reads part of a sample.
+            jobs_per_dataset: dict[str, int] = {}
+            for plan in planned_jobs:
+                name = str(plan["dataset_name"])
+                jobs_per_dataset[name] = jobs_per_dataset.get(name, 0) + 1
+
             for plan in planned_jobs:
                 job_dir = str(plan["job_dir"])
                 out_dir = str(plan["out_dir"])
@@ -2286,7 +2388,10 @@ class PrepareSkimJobs(AnalysisMixin, SkimMixin, law.Task):
                         dtype=str(plan["dtype"]),
                     )
 
-                extra_overrides: dict[str, str] = {}
+                extra_overrides: dict[str, str] = {
+                    "configHash": str(cost_args["config_hash"]),
+                    "sampleJobs": str(jobs_per_dataset[dataset_name]),
+                }
                 if int(plan.get("last_entry", 0)) > 0:
                     extra_overrides["firstEntry"] = str(plan["first_entry"])
                     extra_overrides["lastEntry"] = str(plan["last_entry"])
@@ -3242,6 +3347,7 @@ class SkimTask(AnalysisMixin, SkimMixin, law.LocalWorkflow, SkimHTCondorWorkflow
                         entries_per_job=self.entries_per_job,
                         jobs_dir=self._jobs_dir,
                         outputs_dir=self._outputs_dir,
+                        **self._job_cost_args(),
                     )
                 ]
 
@@ -3437,10 +3543,15 @@ class SkimTask(AnalysisMixin, SkimMixin, law.LocalWorkflow, SkimHTCondorWorkflow
 
             task_label = f"SkimTask[{dataset.name}]"
             with PerformanceRecorder(task_label) as rec:
-                result = _run_analysis_job(
-                    exe_path=exe_path,
-                    job_dir=job_dir,
-                    stream_output=True,
+                result, _restored = self._run_cached(
+                    os.path.join(job_dir, "submit_config.txt"),
+                    exe_path,
+                    out_dir,
+                    lambda: _run_analysis_job(
+                        exe_path=exe_path,
+                        job_dir=job_dir,
+                        stream_output=True,
+                    ),
                 )
 
             Path(self._job_outputs_dir).mkdir(parents=True, exist_ok=True)
@@ -3492,19 +3603,32 @@ class SkimTask(AnalysisMixin, SkimMixin, law.LocalWorkflow, SkimHTCondorWorkflow
 
             task_label = f"SkimTask[{dataset_name}/b{self.branch}]"
             with PerformanceRecorder(task_label) as rec:
-                result = _run_prepared_skim_job(
-                    shared_dir=self._shared_dir,
-                    source_job_dir=job_dir,
-                    exe_relpath=self._exe_relpath,
-                    root_setup=self._root_setup_content,
-                    container_setup=self.container_setup or "",
-                    source_config_path=config_path,
-                    shared_archive_path=self._shared_archive_path,
-                    stream_output=True,
+                result, restored = self._run_cached(
+                    config_path,
+                    os.path.join(self._shared_dir, self._exe_relpath),
+                    out_dir,
+                    lambda: _run_prepared_skim_job(
+                        shared_dir=self._shared_dir,
+                        source_job_dir=job_dir,
+                        exe_relpath=self._exe_relpath,
+                        root_setup=self._root_setup_content,
+                        container_setup=self.container_setup or "",
+                        source_config_path=config_path,
+                        shared_archive_path=self._shared_archive_path,
+                        stream_output=True,
+                    ),
                 )
 
             Path(self._job_outputs_dir).mkdir(parents=True, exist_ok=True)
             rec.save(perf_path_for(str(self.output().path)))
+            # The runtime copy of the job is gone; keep the timing next to
+            # submit_config.txt where --cost-from looks for it.  A restore
+            # from the output cache says nothing about the job's cost.
+            if not restored:
+                try:
+                    rec.save(os.path.join(job_dir, "job.perf.json"))
+                except OSError:
+                    pass
 
             if not self.file_source:
                 dataset = _find_dataset_entry(self.dataset_manifest, dataset_name)
@@ -3707,6 +3831,14 @@ class HistFillTask(AnalysisMixin, law.LocalWorkflow):
         uses the skimmed ROOT files from
         ``skimRun_{skim_name}/outputs/{dataset_name}/skim.root`` as the
         per-dataset input file list.
+    fuse_skim:
+        Run the skim and the histogram fill as one pass over the manifest
+        inputs.  The analyzer books the skim and the histograms on the same
+        dataframe, so one event loop fills both; the skim is written only
+        with ``persist_skim``.  Excludes ``skim_name``.
+    persist_skim:
+        With ``fuse_skim``, also write ``outputs/{dataset_name}/skim.root``
+        (with its cache sidecar) next to the histograms.
     """
 
     task_namespace = ""
@@ -3722,6 +3854,30 @@ class HistFillTask(AnalysisMixin, law.LocalWorkflow):
             "Leave empty to use the ``fileList`` from the submit_config template."
         ),
     )
+    tagger_map_dir = luigi.Parameter(
+        default="",
+        description=(
+            "Directory of tagger efficiency-map payloads built by an earlier "
+            "run (TaggerEfficiencyMapTask).  Forwarded to every job as the "
+            "``taggerMapDir`` config key, which "
+            "TaggerWorkingPointManager::efficiencyMapFile() resolves against."
+        ),
+    )
+    fuse_skim = luigi.BoolParameter(
+        default=False,
+        description=(
+            "Fill the histograms in the skim's own event loop: jobs read the "
+            "manifest inputs and no intermediate skim is written or re-read "
+            "(unless --persist-skim).  Cannot be combined with --skim-name."
+        ),
+    )
+    persist_skim = luigi.BoolParameter(
+        default=False,
+        description=(
+            "With --fuse-skim, also write skim.root (enableSkim=true) in the "
+            "same event loop as the histograms."
+        ),
+    )
 
     @property
     def _run_dir(self) -> str:
@@ -3783,6 +3939,16 @@ class HistFillTask(AnalysisMixin, law.LocalWorkflow):
 
         # ---- determine input files -----------------------------------------
         extra_overrides: dict[str, str] = {}
+        if self.fuse_skim and self.skim_name:
+            raise RuntimeError(
+                "HistFillTask: --fuse-skim runs the skim in the same job and "
+                f"cannot read the skim of run {self.skim_name!r}; drop --skim-name."
+            )
+        if self.fuse_skim:
+            # The skim graph is the histogram graph's input: booking the
+            # snapshot is the only difference, and it is lazy, so a single
+            # event loop serves both.
+            extra_overrides["enableSkim"] = "true" if self.persist_skim else "false"
         if self.skim_name:
             skim_file = os.path.join(
                 self._skim_run_dir, "outputs", dataset.name, "skim.root"
@@ -3833,6 +3999,9 @@ class HistFillTask(AnalysisMixin, law.LocalWorkflow):
                 "in the dataset manifest and no --skim-name was provided."
             )
 
+        if self.tagger_map_dir:
+            extra_overrides["taggerMapDir"] = os.path.abspath(self.tagger_map_dir)
+
         # ---- set up job directory ------------------------------------------
         job_dir = os.path.join(self._jobs_dir, dataset.name)
         Path(job_dir).mkdir(parents=True, exist_ok=True)
@@ -3849,10 +4018,15 @@ class HistFillTask(AnalysisMixin, law.LocalWorkflow):
         # ---- run the analysis executable -----------------------------------
         task_label = f"HistFillTask[{dataset.name}]"
         with PerformanceRecorder(task_label) as rec:
-            result = _run_analysis_job(
-                exe_path=exe_path,
-                job_dir=job_dir,
-                stream_output=True,
+            result, _restored = self._run_cached(
+                os.path.join(job_dir, "submit_config.txt"),
+                exe_path,
+                out_dir,
+                lambda: _run_analysis_job(
+                    exe_path=exe_path,
+                    job_dir=job_dir,
+                    stream_output=True,
+                ),
             )
 
         Path(self._job_outputs_dir).mkdir(parents=True, exist_ok=True)
@@ -3870,6 +4044,15 @@ class HistFillTask(AnalysisMixin, law.LocalWorkflow):
             f"Histogram manifest written for '{dataset.name}': {manifest_path}"
         )
 
+        skim_file = os.path.join(out_dir, "skim.root")
+        if self.fuse_skim and self.persist_skim and os.path.isfile(skim_file):
+            write_cache_sidecar(skim_file, _build_skim_manifest(
+                dataset=dataset,
+                submit_config_path=self.submit_config,
+                dataset_manifest_path=self.dataset_manifest,
+                skim_output_file=skim_file,
+            ))
+
         self.publish_message(f"Histogram fill done for '{dataset.name}': {result}")
         with self.output().open("w") as fh:
             fh.write(f"status=done\ndataset={dataset.name}\n{result}\n")
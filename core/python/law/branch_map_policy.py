@@ -40,6 +40,10 @@ Use :attr:`BranchingPolicy.max_branches` to impose a hard cap.  The
 default cap is ``None`` (no limit); set it conservatively when deploying
 to a grid cluster with limited job slots.
 
+The policy also sizes the merged outputs of the branches:
+:attr:`BranchingPolicy.merge_target_size` is the target file size of the
+merged skims written by ``MergeSkims``.
+
 Usage example
 -------------
 ::
@@ -88,6 +92,7 @@ __all__ = [
     "BranchMapEntry",
     "BranchingPolicy",
     "generate_branch_map",
+    "parse_size",
     "BranchMapGenerationError",
 ]
 
@@ -100,6 +105,38 @@ class BranchMapGenerationError(RuntimeError):
     """Raised when branch map generation fails or would exceed policy limits."""
 
 
+# ---------------------------------------------------------------------------
+# Helpers
+# ---------------------------------------------------------------------------
+
+_SIZE_UNITS = {"": 1, "KB": 1 << 10, "MB": 1 << 20, "GB": 1 << 30, "TB": 1 << 40}
+
+
+def parse_size(value: str) -> int:
+    """Parse a byte count such as ``"2GB"``, ``"500MB"`` or ``"1048576"``.
+
+    Units are binary (``1KB = 1024`` bytes) and case-insensitive.
+
+    Raises
+    ------
+    BranchMapGenerationError
+        If *value* is not a non-negative number with an optional unit.
+    """
+    text = value.strip().upper()
+    digits = text.rstrip("KMGTB")
+    unit = text[len(digits):]
+    try:
+        number = float(digits)
+    except ValueError:
+        number = -1.0
+    if unit not in _SIZE_UNITS or number < 0:
+        raise BranchMapGenerationError(
+            f"Invalid size {value!r}: expected a number with an optional "
+            f"unit ({', '.join(u for u in _SIZE_UNITS if u)})."
+        )
+    return int(number * _SIZE_UNITS[unit])
+
+
 # ---------------------------------------------------------------------------
 # Enumerations
 # ---------------------------------------------------------------------------
@@ -214,6 +251,13 @@ class BranchingPolicy:
         this list will be expanded as separate branches.  This is useful
         for re-running a targeted subset of systematics without recreating
         all branches.  An empty list (the default) includes all groups.
+
+    merge_target_size : int or None
+        Target size in bytes of the merged skim files.  ``MergeSkims``
+        splits the per-job skims of each output, in order, into merged
+        files of at most this size (a single larger job skim is kept
+        whole), so that downstream fits can read them in parallel.
+        ``None`` (the default) writes one merged file per output.
     """
 
     dimensions: List[BranchingDimension] = field(
@@ -222,6 +266,7 @@ class BranchingPolicy:
     max_branches: Optional[int] = None
     systematic_output_usage: Optional[str] = None
     systematic_group_names: List[str] = field(default_factory=list)
+    merge_target_size: Optional[int] = None
 
     # ------------------------------------------------------------------ factories
 
@@ -306,6 +351,9 @@ class BranchingPolicy:
         ``systematic_groups``
             Colon-separated allow-list of nuisance group names.
             Example: ``systematic_groups=jet_energy:b_tagging``.
+        ``merge_target_size``
+            Target merged skim size (see :func:`parse_size`), or ``none``.
+            Example: ``merge_target_size=2GB``.
 
         If *config_str* is empty or ``"default"`` the
         :meth:`dataset_only` policy is returned.
@@ -365,10 +413,17 @@ class BranchingPolicy:
                     g.strip() for g in value.split(":") if g.strip()
                 ]
 
+            elif key == "merge_target_size":
+                if value.lower() == "none":
+                    kwargs["merge_target_size"] = None
+                else:
+                    kwargs["merge_target_size"] = parse_size(value)
+
             else:
                 raise BranchMapGenerationError(
                     f"Unknown policy key {key!r}.  Valid keys: "
-                    "dims, max_branches, systematic_usage, systematic_groups."
+                    "dims, max_branches, systematic_usage, systematic_groups, "
+                    "merge_target_size."
                 )
 
         return cls(**kwargs)
@@ -387,6 +442,11 @@ class BranchingPolicy:
                 f"BranchingPolicy.max_branches must be >= 1 or None, "
                 f"got {self.max_branches}."
             )
+        if self.merge_target_size is not None and self.merge_target_size < 1:
+            errors.append(
+                f"BranchingPolicy.merge_target_size must be >= 1 or None, "
+                f"got {self.merge_target_size}."
+            )
 
         seen: set = set()
         for dim in self.dimensions:
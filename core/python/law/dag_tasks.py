@@ -7,9 +7,16 @@ Provides:
       Orchestrates the full pipeline:
           Get{NANO,OpenData,XRDFS}FileList  (optional via --file-source)
               → SkimTask  →  HistFillTask  →  MergeAll
+                (--fuse-skim: one HistFillTask event loop does both)
                → ManifestDatacardTask  (datacards + nuisance coverage validation)
                → ManifestPlotTask      (per-region plots)
                → ManifestFitTask       (Combine or analysis-defined fits)
+               → TaggerEfficiencyMapTask (optional via --tagger-maps)
+
+  TaggerEfficiencyMapTask  (Task)
+      Builds correctionlib tagger efficiency maps from the fraction histograms
+      the analysis filled in its own event loop, so a later run can consume
+      them (--tagger-maps-from) without a dedicated pre-processing pass.
 
       Skim, histogramming, merge, plotting, and fitting are chained through the
       actual LAW task dependencies so the full pipeline can be run in one go on
@@ -70,6 +77,109 @@ WORKSPACE = os.path.abspath(os.path.join(_HERE, "..", "..", ".."))
 #: explicit ``--manifest-path`` is given.
 _MERGED_HISTOGRAM_MANIFEST_RELPATH = os.path.join("histograms", "output_manifest.yaml")
 
+#: Relative path within a ``mergeRun_<name>/`` directory of the sidecar
+#: listing the merged histogram files.
+_MERGED_HISTOGRAM_GROUPS_RELPATH = os.path.join("histograms", "merged_histogram_groups.json")
+
+#: Directory within ``mergeRun_<name>/`` that TaggerEfficiencyMapTask writes to.
+_TAGGER_MAP_DIRNAME = "tagger_maps"
+
+
+def tagger_map_dir(run_name: str) -> str:
+    """Directory of the tagger efficiency maps built for run *run_name*."""
+    return os.path.join(WORKSPACE, f"mergeRun_{run_name}", _TAGGER_MAP_DIRNAME)
+
+
+def _split_prefixes(value: str) -> List[str]:
+    return [p.strip() for p in str(value).split(",") if p.strip()]
+
+
+class TaggerEfficiencyMapTask(law.Task):
+    """Build tagger efficiency maps from the merged fraction histograms.
+
+    The analysis books the maps with ``defineFractionHistograms`` (or a
+    ``type=fraction_histograms`` tagger config block) in the same event loop
+    as everything else; after MergeAll this task converts the merged
+    ``tagger_fractions`` histograms of each prefix into
+    ``mergeRun_<name>/tagger_maps/<prefix>.json`` (see
+    :mod:`tagger_efficiency_maps`).
+
+    Parameters
+    ----------
+    name:
+        Run name whose merged outputs hold the histograms.
+    prefixes:
+        Comma-separated ``defineFractionHistograms`` output prefixes.
+    merge_input_dir:
+        Optional MergeAll input directory.  When set, the task waits for
+        MergeAll to complete.
+    """
+
+    task_namespace = ""
+
+    name = luigi.Parameter(description="Run name of the merged outputs.")
+    prefixes = luigi.Parameter(
+        description="Comma-separated fraction-histogram output prefixes.",
+    )
+    merge_input_dir = luigi.Parameter(
+        default="",
+        description="Optional MergeAll input directory to depend on.",
+    )
+
+    def requires(self):
+        if not self.merge_input_dir:
+            return None
+        from merge_tasks import MergeAll  # noqa: E402
+
+        return MergeAll(name=self.name, input_dir=self.merge_input_dir)
+
+    def output(self):
+        return {
+            prefix: law.LocalFileTarget(
+                os.path.join(tagger_map_dir(self.name), f"{prefix}.json")
+            )
+            for prefix in _split_prefixes(self.prefixes)
+        }
+
+    def _merged_histogram_files(self) -> List[str]:
+        groups_path = os.path.join(
+            WORKSPACE, f"mergeRun_{self.name}", _MERGED_HISTOGRAM_GROUPS_RELPATH
+        )
+        if not os.path.isfile(groups_path):
+            raise RuntimeError(
+                f"Merged histogram groups not found: {groups_path!r}.  "
+                f"Run MergeAll --name {self.name} first."
+            )
+        with open(groups_path) as fh:
+            groups = json.load(fh)
+        return [groups[k] for k in sorted(groups)]
+
+    def run(self):
+        from tagger_efficiency_maps import FRACTION_DIRECTORY, write_payload  # noqa: E402
+
+        files = self._merged_histogram_files()
+        for prefix, target in self.output().items():
+            # Only the meta file of the nominal pass carries the histograms.
+            sources = [
+                f for f in files
+                if _has_fraction_binning(f, f"{FRACTION_DIRECTORY}/{prefix}_binning")
+            ]
+            if not sources:
+                raise RuntimeError(
+                    f"No merged histogram file contains the fraction histograms "
+                    f"of prefix {prefix!r}."
+                )
+            write_payload(sources, prefix, target.path)
+            self.publish_message(f"Tagger efficiency map written to: {target.path}")
+
+
+def _has_fraction_binning(path: str, key: str) -> bool:
+    import uproot  # type: ignore[import]
+
+    with uproot.open(path) as root_file:
+        return key in root_file
+
+
 class FullAnalysisDAG(law.Task):
     """Orchestrate the complete analysis pipeline as a single law task.
 
@@ -138,12 +248,29 @@ class FullAnalysisDAG(law.Task):
         Skip the SkimTask stage.
     skip_histfill:
         Skip the HistFillTask stage.
+    fuse_skim:
+        Run skim and histfill as one HistFillTask pass over the dataset
+        manifest inputs, without an intermediate skim on shared storage.
+        Ignored, with a warning, when ``hist_config`` differs from
+        ``submit_config``.
+    persist_skim:
+        With ``fuse_skim``, still write the skim from the fused event loop.
     skip_merge:
         Skip the MergeAll stage (implies the merged manifest already exists).
     skip_plots:
         Skip the ManifestPlotTask stage.
     skip_fits:
         Skip the ManifestFitTask stage.
+    tagger_maps:
+        Comma-separated ``defineFractionHistograms`` prefixes filled by this
+        run.  When set and the merge stage runs, the efficiency maps are built
+        by :class:`TaggerEfficiencyMapTask`.
+    tagger_maps_from:
+        Name of an earlier run whose efficiency maps HistFillTask forwards to
+        the analysis jobs as ``taggerMapDir``.
+    output_cache:
+        Shared output-cache directory forwarded to SkimTask / HistFillTask;
+        jobs whose outputs are cached are linked instead of re-run.
     """
 
     task_namespace = ""
@@ -229,6 +356,23 @@ class FullAnalysisDAG(law.Task):
         default=False,
         description="Skip the MergeAll stage.",
     )
+    fuse_skim = luigi.BoolParameter(
+        default=False,
+        description=(
+            "Fuse the skim and histfill stages: HistFillTask reads the dataset "
+            "manifest inputs and fills the histograms in the skim's event "
+            "loop, so no skim is written to and re-read from shared storage.  "
+            "Ignored, with a warning, when --hist-config differs from "
+            "--submit-config."
+        ),
+    )
+    persist_skim = luigi.BoolParameter(
+        default=False,
+        description=(
+            "With --fuse-skim, also write each dataset's skim.root under "
+            "histRun_<name>/outputs/ from the fused event loop."
+        ),
+    )
     skip_plots = luigi.BoolParameter(
         default=False,
         description="Skip the ManifestPlotTask stage.",
@@ -237,6 +381,28 @@ class FullAnalysisDAG(law.Task):
         default=False,
         description="Skip the ManifestFitTask stage.",
     )
+    tagger_maps = luigi.Parameter(
+        default="",
+        description=(
+            "Comma-separated fraction-histogram prefixes filled by this run.  "
+            "After the merge stage, TaggerEfficiencyMapTask builds their "
+            "efficiency maps under mergeRun_<name>/tagger_maps/."
+        ),
+    )
+    tagger_maps_from = luigi.Parameter(
+        default="",
+        description=(
+            "Name of an earlier run whose tagger efficiency maps the "
+            "HistFillTask jobs consume (forwarded as taggerMapDir)."
+        ),
+    )
+    output_cache = luigi.Parameter(
+        default="",
+        description=(
+            "Shared output-cache directory for SkimTask / HistFillTask jobs "
+            "(see output_cache.py).  Empty (default) disables the cache."
+        ),
+    )
 
     # ------------------------------------------------------------------ helpers
 
@@ -260,6 +426,7 @@ class FullAnalysisDAG(law.Task):
     def _skim_stage_enabled(self) -> bool:
         return bool(
             not self.skip_skim
+            and not self._skim_fused
             and self.exe
             and self.submit_config
             and self.dataset_manifest
@@ -274,6 +441,39 @@ class FullAnalysisDAG(law.Task):
             and self.dataset_manifest
         )
 
+    @property
+    def _skim_fused(self) -> bool:
+        """Whether the skim runs inside the HistFillTask jobs.
+
+        A fused job runs one config, so a ``hist_config`` that differs from
+        ``submit_config`` keeps the stages separate (with a warning) rather
+        than dropping the skim config.
+        """
+        if not (self.fuse_skim and not self.skip_skim and self._histfill_stage_enabled):
+            return False
+        if self._hist_config_differs():
+            if not getattr(self, "_fuse_warned", False):
+                self._fuse_warned = True
+                print(
+                    "Warning: --fuse-skim ignored: hist_config "
+                    f"{self.hist_config!r} differs from submit_config "
+                    f"{self.submit_config!r}; running separate skim and "
+                    "histfill stages."
+                )
+            return False
+        return True
+
+    def _hist_config_differs(self) -> bool:
+        """Whether ``hist_config`` is set and is not the ``submit_config`` content."""
+        if not self.hist_config:
+            return False
+        if os.path.abspath(self.hist_config) == os.path.abspath(self.submit_config):
+            return False
+        try:
+            return Path(self.hist_config).read_bytes() != Path(self.submit_config).read_bytes()
+        except OSError:
+            return True
+
     @property
     def _merge_stage_enabled(self) -> bool:
         return not self.skip_merge
@@ -296,6 +496,13 @@ class FullAnalysisDAG(law.Task):
     def requires(self) -> list:
         reqs: list = []
 
+        if self._skim_fused and self.file_source:
+            raise RuntimeError(
+                "FullAnalysisDAG: --fuse-skim reads the dataset manifest "
+                f"directly; file_source={self.file_source!r} ingestion needs "
+                "the separate skim stage."
+            )
+
         merge_input_dir = self._effective_merge_input_dir()
 
         # ---- Fit stage (terminal task; chains datacards and merge automatically) ----
@@ -339,6 +546,16 @@ class FullAnalysisDAG(law.Task):
             except ImportError:
                 pass
 
+        # ---- Tagger efficiency maps (alongside the downstream stages) ----
+        if self._merge_stage_enabled and self.tagger_maps:
+            reqs.append(
+                TaggerEfficiencyMapTask(
+                    name=self.name,
+                    prefixes=self.tagger_maps,
+                    merge_input_dir=merge_input_dir,
+                )
+            )
+
         # ---- Merge stage (terminal only when nothing downstream is requested) ----
         if self._merge_stage_enabled and not reqs:
             try:
@@ -361,9 +578,17 @@ class FullAnalysisDAG(law.Task):
                     submit_config=self.hist_config or self.submit_config,
                     dataset_manifest=self.dataset_manifest,
                     name=self.name,
+                    output_cache=self.output_cache,
                 )
-                if self._skim_stage_enabled:
+                if self._skim_fused:
+                    histfill_kwargs["fuse_skim"] = True
+                    histfill_kwargs["persist_skim"] = self.persist_skim
+                elif self._skim_stage_enabled:
                     histfill_kwargs["skim_name"] = self.name
+                if self.tagger_maps_from:
+                    histfill_kwargs["tagger_map_dir"] = tagger_map_dir(
+                        self.tagger_maps_from
+                    )
                 reqs.append(HistFillTask(**histfill_kwargs))
             except ImportError:
                 pass
@@ -380,6 +605,7 @@ class FullAnalysisDAG(law.Task):
                         name=self.name,
                         file_source=self.file_source,
                         file_source_name=self.file_source_name,
+                        output_cache=self.output_cache,
                     )
                 )
             except ImportError:
@@ -406,12 +632,21 @@ class FullAnalysisDAG(law.Task):
             "stages": {
                 "ingestion": bool(self.file_source) and self._skim_stage_enabled,
                 "skim": self._skim_stage_enabled,
+                "fused_skim": self._skim_fused,
                 "histfill": self._histfill_stage_enabled,
                 "merge": self._merge_stage_enabled,
                 "datacards": bool(self.datacard_config),
                 "plots": not self.skip_plots and bool(self.plot_config),
                 "fits": not self.skip_fits and bool(self.datacard_config),
+                "tagger_maps": self._merge_stage_enabled and bool(self.tagger_maps),
             },
+            "tagger_maps": {
+                prefix: os.path.join(tagger_map_dir(self.name), f"{prefix}.json")
+                for prefix in _split_prefixes(self.tagger_maps)
+            } if self._merge_stage_enabled else {},
+            "tagger_maps_from": (
+                tagger_map_dir(self.tagger_maps_from) if self.tagger_maps_from else ""
+            ),
         }
         summary_path = os.path.join(self._dag_dir, "dag_summary.json")
         with open(summary_path, "w") as fh:
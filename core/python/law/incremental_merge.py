@@ -0,0 +1,274 @@
+"""
+Incremental, tree-shaped merging of per-job outputs.
+
+:class:`IncrementalMerger` folds each job's output files into a running
+merged result as the job finishes, so nothing waits for the last branch of
+a workflow and the final merge only adds what is still unmerged.
+
+For every output basename (``histograms.root``, ``histograms_jesUp.root``,
+...) the jobs are the leaves of a tree with fan-in ``fan_in``.  Every
+``fan_in`` jobs are merged into a level-1 partial, every ``fan_in`` level-1
+partials into a level-2 partial, and so on.  Each level holds fewer than
+``fan_in`` unmerged members, so the running result (:meth:`publish`) merges
+at most ``(fan_in - 1) * depth`` files.  Every input is read about
+log_fan_in(jobs) times, instead of once per job when folding into a single
+accumulator.
+
+A job is known by an id (its directory relative to the input directory)
+and a signature of its manifest and files (:func:`job_signature`).
+Folding a job again with the same signature does nothing.  With a new
+signature (a resubmitted job), its files replace the old ones and only the
+partials that contain it are rebuilt::
+
+    merger = IncrementalMerger("mergeRun_x/streaming/histograms", _run_merge)
+    merger.fold("job_12", {"histograms.root": path}, job_signature(manifest, [path]))
+    merger.publish("mergeRun_x/histograms")
+
+The state is kept in ``<state_dir>/incremental_merge_state.json`` and the
+partials under ``<state_dir>/partials/``, so a restarted merge resumes
+where it stopped.  Partials and published files are written under a
+temporary name and renamed, so a reader never sees a half-written file.
+"""
+
+from __future__ import annotations
+
+import hashlib
+import json
+import os
+import shutil
+from typing import Callable, Dict, Iterable, List, Optional
+
+#: Bumped when the state layout changes; older states are not resumed.
+STATE_VERSION = 1
+
+#: Name of the state file inside the state directory.
+STATE_FILE = "incremental_merge_state.json"
+
+#: ``merge_fn(output_path, input_paths)``, e.g. ``merge_tasks._run_merge``.
+MergeFn = Callable[[str, List[str]], None]
+
+
+def job_signature(manifest_path: str, files: Iterable[str]) -> str:
+    """Return a signature of a job's manifest content and output files.
+
+    Output files enter by path, size and modification time, so a job that
+    is rerun and rewrites its outputs gets a new signature.
+    """
+    digest = hashlib.sha256()
+    with open(manifest_path, "rb") as fh:
+        digest.update(fh.read())
+    for path in sorted(files):
+        st = os.stat(path)
+        digest.update(f"\0{path}\0{st.st_size}\0{st.st_mtime_ns}".encode())
+    return digest.hexdigest()
+
+
+def _temporary_path(path: str) -> str:
+    """Hidden sibling of *path* keeping its extension (ROOT tools look at it)."""
+    directory, name = os.path.split(path)
+    return os.path.join(directory, f".tmp.{name}")
+
+
+class IncrementalMerger:
+    """Fold job outputs into per-basename merge trees.
+
+    Parameters
+    ----------
+    state_dir:
+        Directory holding the state file and the partials.
+    merge_fn:
+        Merges a non-empty list of input files into an output file.
+    fan_in:
+        Number of members merged into one partial (at least 2).
+
+    Raises
+    ------
+    ValueError
+        If *fan_in* is smaller than 2.
+    RuntimeError
+        If the state in *state_dir* was written with another fan-in or
+        state version.
+    """
+
+    def __init__(self, state_dir: str, merge_fn: MergeFn, fan_in: int = 8) -> None:
+        if fan_in < 2:
+            raise ValueError(f"IncrementalMerger: fan_in must be at least 2, got {fan_in}")
+        self.state_dir = os.path.abspath(state_dir)
+        self.fan_in = fan_in
+        self._merge_fn = merge_fn
+        # job id -> {"signature": str, "files": {basename: path}}
+        self._jobs: Dict[str, dict] = {}
+        # basename -> {"open": [[job ids], [level-1 ids], ...],
+        #              "nodes": {node id: {"level", "members", "path"}},
+        #              "next": [next index of level 1, level 2, ...]}
+        self._groups: Dict[str, dict] = {}
+        self._load()
+
+    # ---- public API ---------------------------------------------------------
+
+    @property
+    def job_ids(self) -> List[str]:
+        """Ids of all folded jobs, sorted."""
+        return sorted(self._jobs)
+
+    def signature(self, job_id: str) -> Optional[str]:
+        """Signature the job was last folded with, or ``None``."""
+        job = self._jobs.get(job_id)
+        return job["signature"] if job else None
+
+    def fold(self, job_id: str, files: Dict[str, str], signature: str) -> bool:
+        """Fold the output *files* (``basename → path``) of a job.
+
+        Returns ``False`` if the job was already folded with *signature*.
+        Otherwise the files replace those of an earlier fold of the job, the
+        partials containing it are rebuilt and full levels are merged.
+        """
+        previous = self._jobs.get(job_id)
+        if previous is not None and previous["signature"] == signature:
+            return False
+        old_files = previous["files"] if previous is not None else {}
+        self._jobs[job_id] = {"signature": signature, "files": dict(files)}
+
+        for basename in sorted(set(old_files) | set(files)):
+            group = self._groups.setdefault(basename, {"open": [[]], "nodes": {}, "next": []})
+            parent = self._parent(group, job_id, 1)
+            if basename not in files:
+                # The rerun no longer writes this output: drop its contribution.
+                if parent is None:
+                    group["open"][0].remove(job_id)
+                else:
+                    group["nodes"][parent]["members"].remove(job_id)
+                    self._rebuild(basename, parent)
+            elif parent is not None:
+                self._rebuild(basename, parent)
+            elif job_id not in group["open"][0]:
+                group["open"][0].append(job_id)
+                self._seal(basename)
+        self._save()
+        return True
+
+    def publish(self, out_dir: str) -> Dict[str, str]:
+        """Write the current merged result of every basename into *out_dir*.
+
+        Returns ``basename → path`` of the files written.
+        """
+        os.makedirs(out_dir, exist_ok=True)
+        written: Dict[str, str] = {}
+        for basename in sorted(self._groups):
+            group = self._groups[basename]
+            inputs = [self._jobs[j]["files"][basename] for j in group["open"][0]]
+            for level in group["open"][1:]:
+                inputs += [group["nodes"][n]["path"] for n in level if group["nodes"][n]["path"]]
+            if not inputs:
+                continue
+            path = os.path.join(out_dir, basename)
+            tmp = _temporary_path(path)
+            if len(inputs) == 1:
+                shutil.copyfile(inputs[0], tmp)
+            else:
+                self._merge_fn(tmp, inputs)
+            os.replace(tmp, path)
+            written[basename] = path
+        return written
+
+    def stats(self) -> Dict[str, int]:
+        """Numbers of jobs, partials and the deepest tree level."""
+        partials = sum(len(g["nodes"]) for g in self._groups.values())
+        depth = max((len(g["open"]) for g in self._groups.values()), default=1) - 1
+        return {"jobs": len(self._jobs), "partials": partials, "depth": depth}
+
+    # ---- tree maintenance ---------------------------------------------------
+
+    @staticmethod
+    def _parent(group: dict, member: str, level: int) -> Optional[str]:
+        """Partial of *level* containing *member* (a job id for level 1)."""
+        for node_id, node in group["nodes"].items():
+            if node["level"] == level and member in node["members"]:
+                return node_id
+        return None
+
+    def _seal(self, basename: str) -> None:
+        """Merge every full level into a partial of the next level."""
+        group = self._groups[basename]
+        level = 0
+        while level < len(group["open"]):
+            members = group["open"][level]
+            if len(members) < self.fan_in:
+                level += 1
+                continue
+            if len(group["next"]) <= level:
+                group["next"].append(0)
+            node_id = f"L{level + 1}_{group['next'][level]}"
+            group["next"][level] += 1
+            group["nodes"][node_id] = {
+                "level": level + 1,
+                "members": members[: self.fan_in],
+                "path": None,
+            }
+            del members[: self.fan_in]
+            self._build(basename, node_id)
+            if len(group["open"]) <= level + 1:
+                group["open"].append([])
+            group["open"][level + 1].append(node_id)
+
+    def _rebuild(self, basename: str, node_id: Optional[str]) -> None:
+        """Rebuild *node_id* and every partial above it."""
+        group = self._groups[basename]
+        while node_id is not None:
+            self._build(basename, node_id)
+            node_id = self._parent(group, node_id, group["nodes"][node_id]["level"] + 1)
+
+    def _build(self, basename: str, node_id: str) -> None:
+        group = self._groups[basename]
+        node = group["nodes"][node_id]
+        if node["level"] == 1:
+            inputs = [self._jobs[j]["files"][basename] for j in node["members"]]
+        else:
+            inputs = [group["nodes"][n]["path"] for n in node["members"]]
+            inputs = [p for p in inputs if p]
+        stem, ext = os.path.splitext(basename)
+        path = os.path.join(self.state_dir, "partials", stem, node_id + ext)
+        if not inputs:
+            if os.path.exists(path):
+                os.remove(path)
+            node["path"] = None
+            return
+        os.makedirs(os.path.dirname(path), exist_ok=True)
+        tmp = _temporary_path(path)
+        self._merge_fn(tmp, inputs)
+        os.replace(tmp, path)
+        node["path"] = path
+
+    # ---- persistence --------------------------------------------------------
+
+    @property
+    def _state_path(self) -> str:
+        return os.path.join(self.state_dir, STATE_FILE)
+
+    def _load(self) -> None:
+        if not os.path.isfile(self._state_path):
+            return
+        with open(self._state_path) as fh:
+            state = json.load(fh)
+        if state.get("version") != STATE_VERSION or state.get("fan_in") != self.fan_in:
+            raise RuntimeError(
+                f"IncrementalMerger: state {self._state_path!r} was written with "
+                f"version {state.get('version')} and fan_in {state.get('fan_in')}; "
+                f"expected version {STATE_VERSION} and fan_in {self.fan_in}.  "
+                "Remove the state directory to start over."
+            )
+        self._jobs = state["jobs"]
+        self._groups = state["groups"]
+
+    def _save(self) -> None:
+        os.makedirs(self.state_dir, exist_ok=True)
+        state = {
+            "version": STATE_VERSION,
+            "fan_in": self.fan_in,
+            "jobs": self._jobs,
+            "groups": self._groups,
+        }
+        tmp = self._state_path + ".tmp"
+        with open(tmp, "w") as fh:
+            json.dump(state, fh, indent=1, sort_keys=True)
+        os.replace(tmp, self._state_path)
@@ -267,6 +267,7 @@ class ManifestPlotTask(law.Task):
                 )
 
             contexts = region_names if region_names else [""]
+            pending = []
             for cfg in plot_cfgs:
                 for region in contexts:
                     out_file = cfg.get("outputFile", "plot.pdf")
@@ -303,18 +304,32 @@ class ManifestPlotTask(law.Task):
                             processes_cfg=cfg.get("processes", []),
                             rdfanalyzer=rdfanalyzer,
                         )
-                        result = pu.makeStackPlot(req)
-                        if result.success:
-                            plots_created.append(out_path)
-                            self.publish_message(
-                                f"  [{region or 'combined'}] {out_file} saved "
-                                f"(MC={result.mcIntegral:.3g}, data={result.dataIntegral:.3g})"
-                            )
-                        else:
-                            errors.append(f"PlottingUtility failed for {out_file!r}: {result.message}")
+                        pending.append((req, out_path, out_file, region))
                     except Exception as exc:  # noqa: BLE001
                         errors.append(f"Error plotting {out_file!r}: {exc}")
 
+            if pending:
+                # One batch: each input histogram is read once and the plots
+                # are rendered on a worker pool; unchanged plots are kept.
+                options = rdfanalyzer.PlotBatchOptions()
+                options.parallel = True
+                options.skipUnchanged = True
+                try:
+                    results = pu.makeStackPlots([p[0] for p in pending], options)
+                except Exception as exc:  # noqa: BLE001
+                    results = []
+                    errors.append(f"Error plotting batch: {exc}")
+                for (_, out_path, out_file, region), result in zip(pending, results):
+                    if result.success:
+                        plots_created.append(out_path)
+                        state = "unchanged" if result.skipped else "saved"
+                        self.publish_message(
+                            f"  [{region or 'combined'}] {out_file} {state} "
+                            f"(MC={result.mcIntegral:.3g}, data={result.dataIntegral:.3g})"
+                        )
+                    else:
+                        errors.append(f"PlottingUtility failed for {out_file!r}: {result.message}")
+
         rec.save(os.path.join(self._plots_dir, "manifest_plot.perf.json"))
 
         provenance["plots_created"] = plots_created
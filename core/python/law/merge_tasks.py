@@ -17,11 +17,13 @@ per-job files for each variation or region are merged independently.
 
 Workflow
 --------
-  MergeSkims      (Task)  – hadd all per-job skim ROOT files into merged skim(s)
-  MergeHistograms (Task)  – hadd all per-job histogram ROOT files
-  MergeCutflows   (Task)  – hadd all per-job cutflow ROOT files
+  MergeSkims      (Task)  – merge all per-job skim ROOT files into merged skim(s)
+  MergeHistograms (Task)  – merge all per-job histogram ROOT files
+  MergeCutflows   (Task)  – merge all per-job cutflow ROOT files
   MergeMetadata   (Task)  – write merged manifest preserving full provenance
   MergeAll        (Task)  – requires all applicable merge sub-tasks
+  StreamingMerge  (Task)  – fold histograms, cutflows and metadata into
+                            tree-shaped partial merges while jobs finish
 
 All tasks:
   - Validate inputs via :func:`~output_schema.validate_merge_inputs` before executing
@@ -29,6 +31,10 @@ All tasks:
   - Are resumable: existing output targets skip re-execution
   - Handle systematic variations: separate hadd per variation basename
   - Handle multi-region outputs: separate hadd per region basename
+  - Merge histogram and cutflow files with the parallel ``rdfmerge`` tool
+    built with the core library, falling back to ``hadd`` when it is not built
+  - Merge skims with ``rdfmerge --skim`` (baskets copied without
+    recompression, outputs split at the policy's ``merge_target_size``)
   - Record performance metrics via :class:`~performance_recorder.PerformanceRecorder`
 
 Usage
@@ -46,6 +52,11 @@ Usage
   law run MergeAll \\
       --name myRun
 
+  # Merge while the jobs of a 500-job run are still finishing
+  law run StreamingMerge \\
+      --name myRun \\
+      --expected-jobs 500
+
   # Override where to look for manifests
   law run MergeAll \\
       --name myRun \\
@@ -57,9 +68,11 @@ from __future__ import annotations
 
 import json
 import os
+import re
 import shutil
 import subprocess
 import sys
+import time
 from collections import defaultdict
 from pathlib import Path
 from typing import Dict, List, Optional, Tuple
@@ -83,6 +96,8 @@ from output_schema import (  # noqa: E402
     validate_merge_inputs,
 )
 from performance_recorder import PerformanceRecorder, perf_path_for  # noqa: E402
+from branch_map_policy import BranchingPolicy  # noqa: E402
+from incremental_merge import IncrementalMerger, job_signature  # noqa: E402
 
 WORKSPACE = os.path.abspath(os.path.join(_HERE, "..", "..", ".."))
 
@@ -124,7 +139,9 @@ def _find_hadd() -> str:
     )
 
 
-def _run_hadd(output_path: str, input_paths: List[str]) -> None:
+def _run_hadd(
+    output_path: str, input_paths: List[str], keep_compression: bool = False
+) -> None:
     """Run ``hadd`` to merge *input_paths* into *output_path*.
 
     Parameters
@@ -133,6 +150,9 @@ def _run_hadd(output_path: str, input_paths: List[str]) -> None:
         Destination file.  Parent directories are created automatically.
     input_paths:
         Non-empty list of input ROOT files.
+    keep_compression:
+        Write with the compression of the first input (``hadd -fk``), so
+        that baskets of inputs with the same settings are not recompressed.
 
     Raises
     ------
@@ -147,7 +167,8 @@ def _run_hadd(output_path: str, input_paths: List[str]) -> None:
     hadd_bin = _find_hadd()
     Path(output_path).parent.mkdir(parents=True, exist_ok=True)
 
-    cmd = [hadd_bin, "-f", output_path] + list(input_paths)
+    cmd = [hadd_bin, "-fk" if keep_compression else "-f", output_path]
+    cmd += list(input_paths)
     result = subprocess.run(cmd, capture_output=True, text=True)
     if result.returncode != 0:
         raise RuntimeError(
@@ -157,6 +178,104 @@ def _run_hadd(output_path: str, input_paths: List[str]) -> None:
         )
 
 
+def _find_merge_tool() -> Optional[str]:
+    """Return the path to the ``rdfmerge`` binary, or ``None``.
+
+    Searches the build tree (``build/core/tools/rdfmerge``) and the PATH.
+    """
+    candidate = os.path.join(WORKSPACE, "build", "core", "tools", "rdfmerge")
+    if os.path.isfile(candidate) and os.access(candidate, os.X_OK):
+        return candidate
+    return shutil.which("rdfmerge")
+
+
+def _run_merge(output_path: str, input_paths: List[str]) -> None:
+    """Merge histogram, cutflow or meta ROOT files into *output_path*.
+
+    Uses ``rdfmerge``, which merges in parallel (files striped over threads,
+    partial results tree-reduced, objects added key by key) and keeps the
+    first copy of provenance entries.  Falls back to :func:`_run_hadd` when
+    the tool is not built.
+
+    Raises
+    ------
+    RuntimeError
+        If the merge exits with a non-zero status.
+    ValueError
+        If *input_paths* is empty.
+    """
+    if not input_paths:
+        raise ValueError("_run_merge: no input files provided.")
+
+    tool = _find_merge_tool()
+    if tool is None:
+        _run_hadd(output_path, input_paths)
+        return
+
+    cmd = [tool, "-o", output_path] + list(input_paths)
+    result = subprocess.run(cmd, capture_output=True, text=True)
+    if result.returncode != 0:
+        raise RuntimeError(
+            f"rdfmerge failed (exit {result.returncode}) merging "
+            f"{len(input_paths)} file(s) into {output_path!r}.\n"
+            f"stderr: {result.stderr.strip()}"
+        )
+
+
+#: Line printed by ``rdfmerge --skim`` for every output file it writes.
+_SKIM_OUTPUT_LINE = re.compile(
+    r"^rdfmerge: merged \d+ file\(s\) into (.+) \((?:fast copy|recompressed)\)$"
+)
+
+
+def _run_skim_merge(
+    output_path: str,
+    input_paths: List[str],
+    target_bytes: Optional[int] = None,
+) -> List[str]:
+    """Merge skim ROOT files into *output_path*; return the files written.
+
+    Uses ``rdfmerge --skim``, which writes with the compression of the
+    first input and copies baskets without recompression when the inputs
+    share it.  With *target_bytes* the inputs are split, in order, into
+    outputs of at most that size (``skim_0.root``, ``skim_1.root``, ...)
+    that are merged in parallel.  Falls back to ``hadd -fk`` into a single
+    *output_path* when the tool is not built.
+
+    Raises
+    ------
+    RuntimeError
+        If the merge exits with a non-zero status.
+    ValueError
+        If *input_paths* is empty.
+    """
+    if not input_paths:
+        raise ValueError("_run_skim_merge: no input files provided.")
+
+    tool = _find_merge_tool()
+    if tool is None:
+        _run_hadd(output_path, input_paths, keep_compression=True)
+        return [output_path]
+
+    cmd = [tool, "--skim", "-o", output_path]
+    if target_bytes:
+        cmd += ["--target-size", str(target_bytes)]
+    cmd += list(input_paths)
+    result = subprocess.run(cmd, capture_output=True, text=True)
+    if result.returncode != 0:
+        raise RuntimeError(
+            f"rdfmerge failed (exit {result.returncode}) merging "
+            f"{len(input_paths)} skim file(s) into {output_path!r}.\n"
+            f"stderr: {result.stderr.strip()}"
+        )
+    outputs = []
+    for line in result.stdout.splitlines():
+        match = _SKIM_OUTPUT_LINE.match(line.strip())
+        if match:
+            outputs.append(match.group(1))
+    return outputs or [output_path]
+
+
 def _group_files_by_basename(
     file_paths: List[str],
 ) -> Dict[str, List[str]]:
@@ -345,6 +464,49 @@ class MergeMixin:
             required_roles=required_roles,
         )
 
+    def _write_metadata(
+        self,
+        loaded: List[Tuple[str, OutputManifest]],
+        out_dir: str,
+        manifest_path: str,
+    ) -> str:
+        """Write ``provenance_summary.json`` and the merged metadata manifest.
+
+        Returns the path of the provenance summary.
+        """
+        provenance_records = []
+        for p, m in loaded:
+            record = {
+                "manifest_path": p,
+                "framework_hash": m.framework_hash,
+                "user_repo_hash": m.user_repo_hash,
+                "config_mtime": m.config_mtime,
+            }
+            provenance_records.append(record)
+
+        summary_path = os.path.join(out_dir, "provenance_summary.json")
+        with open(summary_path, "w") as fh:
+            json.dump(
+                {
+                    "n_inputs": len(loaded),
+                    "provenance_records": provenance_records,
+                },
+                fh,
+                indent=2,
+            )
+
+        merged = merge_manifests(
+            [m for _, m in loaded],
+            framework_hash=self.framework_hash or None,
+            user_repo_hash=self.user_repo_hash or None,
+        )
+        # Point metadata output_file to the provenance summary we just wrote
+        if merged.metadata is not None:
+            merged.metadata.output_file = summary_path
+
+        merged.save_yaml(manifest_path)
+        return summary_path
+
 
 # ---------------------------------------------------------------------------
 # Task 1 – MergeSkims
@@ -356,15 +518,30 @@ class MergeSkims(MergeMixin, law.Task):
 
     For each unique skim output basename found across all job manifests
     (e.g. ``skim.root``, ``skim_jesUp.root``, ``skim_jesDown.root``) a
-    separate ``hadd`` call is made.  This correctly handles systematic
-    variations and multi-region outputs without any extra configuration.
+    separate :func:`_run_skim_merge` call is made.  This correctly handles
+    systematic variations and multi-region outputs without any extra
+    configuration.
+
+    When ``--branching-policy`` sets ``merge_target_size``, each basename
+    is split into merged files of about that size (``skim_0.root``,
+    ``skim_1.root``, ...).
 
     Outputs are written to ``<merge_dir>/skims/`` and a merged manifest
-    is saved as ``<merge_dir>/skims/output_manifest.yaml``.
+    is saved as ``<merge_dir>/skims/output_manifest.yaml``.  The sidecar
+    ``merged_skim_groups.json`` maps each basename to its merged files.
     """
 
     task_namespace = ""
 
+    branching_policy = luigi.Parameter(
+        default="",
+        description=(
+            "BranchingPolicy descriptor (see BranchingPolicy.from_config_str).  "
+            "Its merge_target_size sets the target size of the merged skim "
+            "files, e.g. 'merge_target_size=2GB'.  Default: one file per output."
+        ),
+    )
+
     def output(self):
         return law.LocalFileTarget(
             os.path.join(self._merge_dir, "skims", "output_manifest.yaml")
@@ -412,15 +589,18 @@ class MergeSkims(MergeMixin, law.Task):
             f"{len(groups)} group(s): {sorted(groups.keys())}"
         )
 
-        merged_output_files: Dict[str, str] = {}
+        target_bytes = BranchingPolicy.from_config_str(
+            self.branching_policy
+        ).merge_target_size
+        merged_output_files: Dict[str, List[str]] = {}
         with PerformanceRecorder("MergeSkims") as rec:
             for basename, paths in groups.items():
                 out_path = os.path.join(out_dir, basename)
+                outputs = _run_skim_merge(out_path, paths, target_bytes)
                 self.publish_message(
-                    f"hadd: {len(paths)} → {out_path}"
+                    f"merge: {len(paths)} → {', '.join(outputs)}"
                 )
-                _run_hadd(out_path, paths)
-                merged_output_files[basename] = out_path
+                merged_output_files[basename] = outputs
 
         rec.save(os.path.join(out_dir, "merge_skims.perf.json"))
 
@@ -430,7 +610,7 @@ class MergeSkims(MergeMixin, law.Task):
         )
         # Update output_file to the primary (first) merged skim
         primary_basename = sorted(merged_output_files.keys())[0]
-        merged.skim.output_file = merged_output_files[primary_basename]  # type: ignore[union-attr]
+        merged.skim.output_file = merged_output_files[primary_basename][0]  # type: ignore[union-attr]
 
         # Persist a sidecar JSON listing all merged groups for downstream use
         groups_meta = {k: v for k, v in sorted(merged_output_files.items())}
@@ -451,6 +631,7 @@ class MergeHistograms(MergeMixin, law.Task):
 
     Groups histogram output files by basename so that separate merge
     operations are performed for each systematic variation or region.
+    Each group is merged with :func:`_run_merge`.
 
     Outputs are written to ``<merge_dir>/histograms/``.
     """
@@ -504,8 +685,8 @@ class MergeHistograms(MergeMixin, law.Task):
         with PerformanceRecorder("MergeHistograms") as rec:
             for basename, paths in groups.items():
                 out_path = os.path.join(out_dir, basename)
-                self.publish_message(f"hadd: {len(paths)} → {out_path}")
-                _run_hadd(out_path, paths)
+                self.publish_message(f"merge: {len(paths)} → {out_path}")
+                _run_merge(out_path, paths)
                 merged_output_files[basename] = out_path
 
         rec.save(os.path.join(out_dir, "merge_histograms.perf.json"))
@@ -532,9 +713,8 @@ class MergeHistograms(MergeMixin, law.Task):
 class MergeCutflows(MergeMixin, law.Task):
     """Merge per-job cutflow ROOT files into one merged cutflow file.
 
-    ``hadd`` is called once per unique cutflow output basename.  All
-    counter objects within each merged file are summed automatically by
-    ROOT.
+    :func:`_run_merge` is called once per unique cutflow output basename.
+    All counter objects within each merged file are summed.
 
     Outputs are written to ``<merge_dir>/cutflows/``.
     """
@@ -588,8 +768,8 @@ class MergeCutflows(MergeMixin, law.Task):
         with PerformanceRecorder("MergeCutflows") as rec:
             for basename, paths in groups.items():
                 out_path = os.path.join(out_dir, basename)
-                self.publish_message(f"hadd: {len(paths)} → {out_path}")
-                _run_hadd(out_path, paths)
+                self.publish_message(f"merge: {len(paths)} → {out_path}")
+                _run_merge(out_path, paths)
                 merged_output_files[basename] = out_path
 
         rec.save(os.path.join(out_dir, "merge_cutflows.perf.json"))
@@ -653,40 +833,9 @@ class MergeMetadata(MergeMixin, law.Task):
             )
 
         with PerformanceRecorder("MergeMetadata") as rec:
-            # Collect provenance from all manifests
-            provenance_records = []
-            for p, m in loaded:
-                record = {
-                    "manifest_path": p,
-                    "framework_hash": m.framework_hash,
-                    "user_repo_hash": m.user_repo_hash,
-                    "config_mtime": m.config_mtime,
-                }
-                provenance_records.append(record)
-
-            summary_path = os.path.join(out_dir, "provenance_summary.json")
-            with open(summary_path, "w") as fh:
-                json.dump(
-                    {
-                        "n_inputs": len(loaded),
-                        "provenance_records": provenance_records,
-                    },
-                    fh,
-                    indent=2,
-                )
+            summary_path = self._write_metadata(loaded, out_dir, self.output().path)
 
         rec.save(os.path.join(out_dir, "merge_metadata.perf.json"))
-
-        merged = merge_manifests(
-            all_manifests,
-            framework_hash=self.framework_hash or None,
-            user_repo_hash=self.user_repo_hash or None,
-        )
-        # Point metadata output_file to the provenance summary we just wrote
-        if merged.metadata is not None:
-            merged.metadata.output_file = summary_path
-
-        merged.save_yaml(self.output().path)
         self.publish_message(
             f"Provenance summary written to: {summary_path}\n"
             f"Merged manifest written to: {self.output().path}"
@@ -736,6 +885,10 @@ class MergeAll(MergeMixin, law.Task):
         default=False,
         description="Skip writing the merged provenance metadata manifest.",
     )
+    branching_policy = luigi.Parameter(
+        default="",
+        description="BranchingPolicy descriptor forwarded to MergeSkims.",
+    )
 
     def _shared_params(self):
         """Return shared MergeMixin parameter values for sub-task construction."""
@@ -788,7 +941,7 @@ class MergeAll(MergeMixin, law.Task):
         reqs = []
 
         if present["skim"] and not self.skip_skims:
-            reqs.append(MergeSkims(**params))
+            reqs.append(MergeSkims(branching_policy=self.branching_policy, **params))
         if present["histograms"] and not self.skip_histograms:
             reqs.append(MergeHistograms(**params))
         if present["cutflow"] and not self.skip_cutflows:
@@ -831,3 +984,222 @@ class MergeAll(MergeMixin, law.Task):
         # Mark this orchestrating task as done
         with open(self.output().path, "w") as fh:
             fh.write(json.dumps(summary, indent=2) + "\n")
+
+
+# ---------------------------------------------------------------------------
+# Task 6 – StreamingMerge
+# ---------------------------------------------------------------------------
+
+
+class StreamingMerge(MergeMixin, law.Task):
+    """Merge histograms, cutflows and metadata while the jobs are running.
+
+    Polls ``--input-dir`` for job manifests and folds the histogram and
+    cutflow files of every finished job into an
+    :class:`~incremental_merge.IncrementalMerger` as its manifest appears:
+    every ``--fan-in`` jobs are merged into a partial, every ``--fan-in``
+    partials into a partial of the next level, and so on.  After each poll
+    that folded something the running result is published to
+    ``<merge_dir>/histograms/`` and ``<merge_dir>/cutflows/``, so the
+    final merge only adds the last few unmerged files.
+
+    A resubmitted job (a rewritten manifest with new contents or output
+    files) replaces its earlier contribution, rebuilding only the partials that contain it;
+    seeing the same job again changes nothing.  The merge state lives in
+    ``<merge_dir>/streaming/``, so a restarted task resumes.  Manifests that
+    cannot be loaded yet, or whose files are missing, are retried on the
+    next poll.
+
+    The task stops when ``--expected-jobs`` jobs are folded or no manifest
+    changed for ``--idle-timeout`` seconds.  It then writes the same
+    outputs as :class:`MergeHistograms`, :class:`MergeCutflows` and
+    :class:`MergeMetadata`, which are therefore complete, and a summary
+    ``<merge_dir>/streaming_merge.json``.  Skims are not merged here; use
+    :class:`MergeSkims`.
+    """
+
+    task_namespace = ""
+
+    expected_jobs = luigi.IntParameter(
+        default=0,
+        description=(
+            "Number of jobs of the run; the merge finishes once that many are "
+            "folded.  0: finish after --idle-timeout without new manifests."
+        ),
+    )
+    poll_interval = luigi.FloatParameter(
+        default=30.0,
+        description="Seconds between scans of --input-dir for new manifests.",
+    )
+    idle_timeout = luigi.FloatParameter(
+        default=3600.0,
+        description=(
+            "Stop after this many seconds without a new or changed manifest; "
+            "with --expected-jobs an incomplete run is an error.  0 waits forever."
+        ),
+    )
+    fan_in = luigi.IntParameter(
+        default=8,
+        description="Number of files merged into one partial of the merge tree.",
+    )
+
+    #: (manifest role, output subdirectory, groups sidecar) of the ROOT merges.
+    _ROLES = (
+        ("histograms", "histograms", "merged_histogram_groups.json"),
+        ("cutflow", "cutflows", "merged_cutflow_groups.json"),
+    )
+
+    def output(self):
+        return law.LocalFileTarget(
+            os.path.join(self._merge_dir, "streaming_merge.json")
+        )
+
+    def _ready_job(
+        self, manifest_path: str
+    ) -> Optional[Tuple[OutputManifest, Dict[str, str]]]:
+        """Load a job manifest and its ``role → file``; ``None`` if not ready."""
+        try:
+            manifest = OutputManifest.load_yaml(manifest_path)
+        except Exception:  # noqa: BLE001 – possibly still being written
+            return None
+        files: Dict[str, str] = {}
+        for role, _, _ in self._ROLES:
+            schema = getattr(manifest, role)
+            if schema is None:
+                continue
+            path = schema.output_file
+            if not os.path.isabs(path):
+                path = os.path.join(os.path.dirname(manifest_path), path)
+            if not os.path.isfile(path):
+                return None
+            files[role] = path
+        return manifest, files
+
+    def _poll(
+        self,
+        mergers: Dict[str, IncrementalMerger],
+        loaded: Dict[str, Tuple[str, OutputManifest]],
+        seen: Dict[str, Tuple[int, int]],
+    ) -> int:
+        """Fold new and changed jobs; return how many were folded."""
+        import glob as _glob
+
+        input_dir = self._effective_input_dir
+        pattern = os.path.join(input_dir, self.manifest_glob)
+        folded = 0
+        for manifest_path in sorted(_glob.glob(pattern, recursive=True)):
+            try:
+                st = os.stat(manifest_path)
+            except OSError:
+                continue
+            stamp = (st.st_mtime_ns, st.st_size)
+            if seen.get(manifest_path) == stamp:
+                continue
+            ready = self._ready_job(manifest_path)
+            if ready is None:
+                continue
+            manifest, files = ready
+            job_id = os.path.relpath(os.path.dirname(manifest_path), input_dir)
+            signature = job_signature(manifest_path, files.values())
+            if loaded:
+                reference = next(iter(loaded.values()))[1]
+                errors = validate_merge_inputs([reference, manifest])
+                if errors:
+                    raise MergeInputValidationError(
+                        f"Job manifest {manifest_path!r} is incompatible with the run:\n"
+                        + "\n".join(f"  {e}" for e in errors)
+                    )
+            changed = False
+            for role, merger in mergers.items():
+                role_files = {os.path.basename(files[role]): files[role]} if role in files else {}
+                changed |= merger.fold(job_id, role_files, signature)
+            loaded[job_id] = (manifest_path, manifest)
+            seen[manifest_path] = stamp
+            folded += changed
+        return folded
+
+    def run(self):
+        merge_dir = self._merge_dir
+        Path(merge_dir).mkdir(parents=True, exist_ok=True)
+        mergers = {
+            role: IncrementalMerger(
+                os.path.join(merge_dir, "streaming", subdir), _run_merge, self.fan_in
+            )
+            for role, subdir, _ in self._ROLES
+        }
+        loaded: Dict[str, Tuple[str, OutputManifest]] = {}
+        seen: Dict[str, Tuple[int, int]] = {}
+
+        with PerformanceRecorder("StreamingMerge") as rec:
+            last_change = time.monotonic()
+            while True:
+                folded = self._poll(mergers, loaded, seen)
+                now = time.monotonic()
+                if folded:
+                    last_change = now
+                    for role, subdir, _ in self._ROLES:
+                        mergers[role].publish(os.path.join(merge_dir, subdir))
+                    self.publish_message(
+                        f"Folded {folded} job(s); {len(loaded)} job(s) merged so far."
+                    )
+                if self.expected_jobs and len(loaded) >= self.expected_jobs:
+                    break
+                if self.idle_timeout and now - last_change >= self.idle_timeout:
+                    if self.expected_jobs:
+                        raise RuntimeError(
+                            f"Only {len(loaded)} of {self.expected_jobs} job(s) "
+                            f"finished; no manifest changed for {self.idle_timeout:g} s."
+                        )
+                    break
+                time.sleep(self.poll_interval)
+
+            if not loaded:
+                raise RuntimeError(
+                    f"No job manifests appeared under {self._effective_input_dir!r}."
+                )
+            jobs = [loaded[job_id] for job_id in sorted(loaded)]
+            merged_manifests = self._finalise(mergers, jobs)
+
+        rec.save(os.path.join(merge_dir, "streaming", "streaming_merge.perf.json"))
+
+        summary = {
+            "name": self.name,
+            "merge_dir": merge_dir,
+            "n_jobs": len(loaded),
+            "merged_manifests": merged_manifests,
+            "merge_trees": {role: m.stats() for role, m in mergers.items()},
+        }
+        with open(self.output().path, "w") as fh:
+            json.dump(summary, fh, indent=2)
+        self.publish_message(f"Streaming merge summary written to: {self.output().path}")
+
+    def _finalise(
+        self,
+        mergers: Dict[str, IncrementalMerger],
+        jobs: List[Tuple[str, OutputManifest]],
+    ) -> Dict[str, str]:
+        """Publish the final results and write the merged manifests."""
+        merge_dir = self._merge_dir
+        merged_manifests: Dict[str, str] = {}
+        for role, subdir, groups_file in self._ROLES:
+            role_jobs = [m for _, m in jobs if getattr(m, role) is not None]
+            if not role_jobs:
+                continue
+            self._validate(role_jobs, required_roles=[role])
+            out_dir = os.path.join(merge_dir, subdir)
+            merged_files = mergers[role].publish(out_dir)
+            merged = self._build_merged_manifest(role_jobs, required_roles=[role])
+            getattr(merged, role).output_file = merged_files[sorted(merged_files)[0]]
+            with open(os.path.join(out_dir, groups_file), "w") as fh:
+                json.dump(dict(sorted(merged_files.items())), fh, indent=2)
+            manifest_path = os.path.join(out_dir, "output_manifest.yaml")
+            merged.save_yaml(manifest_path)
+            merged_manifests[role] = manifest_path
+
+        self._validate([m for _, m in jobs])
+        out_dir = os.path.join(merge_dir, "metadata")
+        Path(out_dir).mkdir(parents=True, exist_ok=True)
+        manifest_path = os.path.join(out_dir, "output_manifest.yaml")
+        self._write_metadata(jobs, out_dir, manifest_path)
+        merged_manifests["metadata"] = manifest_path
+        return merged_manifests
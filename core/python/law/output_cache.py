@@ -0,0 +1,220 @@
+"""
+Content-addressed output cache for RDFAnalyzerCore law tasks.
+
+A job's outputs are determined by what it reads and how it is configured,
+not by the run it belongs to.  :func:`job_cache_key` hashes exactly that:
+
+  - the job config, without the keys naming where outputs go
+    (:data:`_OUTPUT_KEYS`) and the law-internal ``__`` keys;
+  - the content of every file the config references (correction, histogram
+    and plugin configs, models), and of the files those reference through
+    ``file=`` entries;
+  - the input files: remote URLs by name (grid files are immutable), local
+    files by content (:meth:`DatasetManifest.file_hash`);
+  - the dataset manifest the job was partitioned from, by content;
+  - the analysis executable and the framework / analysis git hashes from
+    :func:`version_info.get_version_info`.
+
+:class:`OutputCache` keeps the output directory of each finished job under
+``<root>/<key[:2]>/<key>/`` as hard links (copies across file systems).  A
+later job with the same key, in any run, gets its outputs linked back
+instead of running::
+
+    cache = OutputCache("/eos/user/me/rdf_cache")
+    key = job_cache_key("jobs/ttH/submit_config.txt", "build/analysis")
+    if not cache.restore(key, "outputs/ttH"):
+        run_job()
+        cache.store(key, "outputs/ttH")
+
+Entries appear atomically (written under a temporary name, then renamed),
+so concurrent jobs never restore a partial entry.  Outputs restored as hard
+links share their inode with the cache and must not be modified in place.
+"""
+
+from __future__ import annotations
+
+import hashlib
+import json
+import os
+import re
+import shutil
+from typing import Optional
+
+from dataset_manifest import DatasetManifest
+from partition_utils import _read_job_config
+from version_info import get_version_info
+
+#: Bumped when the key derivation changes, so old entries are never matched.
+CACHE_KEY_VERSION = 2
+
+#: Job config keys naming where a job writes; they do not change its outputs.
+_OUTPUT_KEYS = frozenset({
+    "saveFile",
+    "metaFile",
+    "saveDirectory",
+    "metricsFile",
+    "checkpointFile",
+    "configHash",
+})
+
+_FILE_REF = re.compile(r"(?:^|\s)file=([^\s#]+)")
+
+
+def _file_digest(path: str) -> str:
+    """SHA-256 of the content of *path*."""
+    digest = hashlib.sha256()
+    with open(path, "rb") as fh:
+        for chunk in iter(lambda: fh.read(1 << 20), b""):
+            digest.update(chunk)
+    return digest.hexdigest()
+
+
+def _input_fingerprint(url: str) -> list:
+    """Identity of one input file for the cache key."""
+    if os.path.isfile(url):
+        return [os.path.abspath(url), DatasetManifest.file_hash(url)]
+    return [url]
+
+
+def _referenced_digests(path: str) -> list:
+    """Digests of the files a text config refers to with ``file=`` entries."""
+    try:
+        with open(path, errors="replace") as fh:
+            text = fh.read()
+    except OSError:
+        return []
+    base = os.path.dirname(path)
+    digests = []
+    for ref in sorted(set(_FILE_REF.findall(text))):
+        ref_path = ref if os.path.isabs(ref) else os.path.join(base, ref)
+        if os.path.isfile(ref_path):
+            digests.append([ref, _file_digest(ref_path)])
+    return digests
+
+
+def code_version(config_path: str) -> dict:
+    """Framework and analysis git hashes of the code building a job."""
+    info = get_version_info(config_path)
+    return {k: info.get(k) for k in ("framework_hash", "user_repo_hash")}
+
+
+def job_cache_key(
+    config_path: str,
+    exe_path: str,
+    code_version: Optional[dict] = None,
+    dataset_manifest: Optional[str] = None,
+) -> str:
+    """Return the content hash identifying the outputs of a job.
+
+    Parameters
+    ----------
+    config_path:
+        The job's ``submit_config.txt``.  Relative file references are
+        resolved against its directory.
+    exe_path:
+        The analysis executable the job runs.
+    code_version:
+        Extra code identity, typically the ``framework_hash`` and
+        ``user_repo_hash`` of :func:`version_info.get_version_info`.
+    dataset_manifest:
+        The dataset manifest the job was built from; its
+        :meth:`DatasetManifest.file_hash` enters the key.
+    """
+    config = _read_job_config(config_path)
+    config_dir = os.path.dirname(os.path.abspath(config_path))
+    items: list = []
+    for key in sorted(config):
+        if key.startswith("__") or key in _OUTPUT_KEYS:
+            continue
+        value = config[key]
+        if key == "fileList":
+            files = [u.strip() for u in value.split(",") if u.strip()]
+            items.append([key, [_input_fingerprint(u) for u in files]])
+            continue
+        path = value if os.path.isabs(value) else os.path.join(config_dir, value)
+        if value and os.path.isfile(path):
+            # Referenced files enter by content: jobs of different runs name
+            # the same file by different paths.
+            items.append([key, _file_digest(path), _referenced_digests(path)])
+        else:
+            items.append([key, value])
+    payload = {
+        "version": CACHE_KEY_VERSION,
+        "config": items,
+        "exe": _file_digest(exe_path),
+        "code": code_version or {},
+        "dataset_manifest": (
+            DatasetManifest.file_hash(dataset_manifest) if dataset_manifest else ""
+        ),
+    }
+    return hashlib.sha256(json.dumps(payload, sort_keys=True).encode()).hexdigest()
+
+
+def _link(src: str, dst: str) -> None:
+    """Hard-link *src* to *dst*, copying when they are on different file systems."""
+    if os.path.lexists(dst):
+        os.remove(dst)
+    try:
+        os.link(src, dst)
+    except OSError:
+        shutil.copy2(src, dst)
+
+
+def _link_tree(src_dir: str, dst_dir: str) -> int:
+    """Link every file below *src_dir* to the same place below *dst_dir*."""
+    count = 0
+    for dirpath, _dirnames, filenames in os.walk(src_dir):
+        rel = os.path.relpath(dirpath, src_dir)
+        target = os.path.normpath(os.path.join(dst_dir, rel))
+        os.makedirs(target, exist_ok=True)
+        for name in filenames:
+            _link(os.path.join(dirpath, name), os.path.join(target, name))
+            count += 1
+    return count
+
+
+class OutputCache:
+    """Shared store of job output directories, addressed by :func:`job_cache_key`.
+
+    Parameters
+    ----------
+    root:
+        Cache directory, shared between runs (and users) that should reuse
+        each other's outputs.
+    """
+
+    def __init__(self, root: str) -> None:
+        self.root = root
+
+    def entry_path(self, key: str) -> str:
+        """Directory holding the outputs stored under *key*."""
+        return os.path.join(self.root, key[:2], key)
+
+    def restore(self, key: str, out_dir: str) -> bool:
+        """Link the outputs stored under *key* into *out_dir*.
+
+        Returns ``False`` when the cache has no entry for *key*.
+        """
+        entry = self.entry_path(key)
+        if not os.path.isdir(entry):
+            return False
+        _link_tree(entry, out_dir)
+        return True
+
+    def store(self, key: str, out_dir: str) -> None:
+        """Store the files of *out_dir* under *key*.
+
+        The first job to store a key wins; later stores are dropped.
+        """
+        entry = self.entry_path(key)
+        if os.path.isdir(entry) or not os.path.isdir(out_dir):
+            return
+        os.makedirs(os.path.dirname(entry), exist_ok=True)
+        tmp = f"{entry}.tmp.{os.getpid()}"
+        shutil.rmtree(tmp, ignore_errors=True)
+        _link_tree(out_dir, tmp)
+        try:
+            os.rename(tmp, entry)
+        except OSError:
+            # Another job stored the same key first.
+            shutil.rmtree(tmp, ignore_errors=True)
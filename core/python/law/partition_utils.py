@@ -22,12 +22,27 @@ Partition modes
     The number of partitions per file equals
     ``ceil(total_entries / entries_per_job)``.
 
+    When an *index_path* is given, entry counts and TTree cluster
+    boundaries are read from (and added to) a persistent JSON sidecar index,
+    so files are opened only the first time they are partitioned, and every
+    partition starts and ends on a cluster boundary.  Chunks then hold at
+    least *entries_per_job* entries (or the rest of the file) and no job
+    decompresses baskets it does not process.
+
     .. note::
-       Entry-range partitions are applied by the C++ ``DataManager`` via
-       ``ROOT::RDataFrame::Range(firstEntry, lastEntry)``.  This disables
-       implicit multi-threading for the processing job when ROOT < 6.28 is
-       used.  When running with ``--threads > 1``, prefer ``"file"`` or
-       ``"file_group"`` mode unless all workers use ROOT ≥ 6.28.
+       Entry-range partitions are applied by the C++ ``DataManager`` as a
+       ``TEntryList`` on the input chain, which keeps implicit
+       multi-threading enabled.
+
+Cost model
+----------
+Per-event costs differ a lot between samples, so a fixed *entries_per_job*
+gives job runtimes from minutes to hours.  :func:`_load_job_costs` reads the
+``job.perf.json`` wall times and ``submit_config.txt`` entry ranges of
+earlier runs and sums them per dataset and ``configHash`` (see
+:func:`_config_cost_key`); :func:`_entries_for_target` turns the measured
+events/s into the *entries_per_job* that gives a target wall time, and
+falls back to the configured value for datasets without measurements.
 
 Determinism and reproducibility
 --------------------------------
@@ -38,6 +53,29 @@ rerun by specifying the corresponding law branch number.
 
 from __future__ import annotations
 
+import hashlib
+import json
+import os
+import tempfile
+from pathlib import Path
+
+#: Format version of the entry index sidecar written by :func:`_save_entry_index`.
+ENTRY_INDEX_VERSION = 1
+
+#: Config keys that :func:`_config_cost_key` ignores: they differ between
+#: jobs of the same analysis and do not change the per-event cost.
+_PER_JOB_CONFIG_KEYS = frozenset({
+    "fileList",
+    "firstEntry",
+    "lastEntry",
+    "saveFile",
+    "metaFile",
+    "saveDirectory",
+    "entryIndex",
+    "configHash",
+    "sampleJobs",
+})
+
 
 def _query_tree_entries(url: str, tree_name: str = "Events") -> int:
     """Return the number of TTree entries in *url*.
@@ -84,12 +122,211 @@ def _query_tree_entries(url: str, tree_name: str = "Events") -> int:
         ) from exc
 
 
+def _query_tree_clusters(url: str, tree_name: str = "Events") -> tuple[int, list[int]]:
+    """Return the entry count and cluster boundaries of the TTree in *url*.
+
+    Boundaries are the entry offsets at which every branch starts a new
+    basket (``uproot``'s ``common_entry_offsets``), i.e. the TTree cluster
+    boundaries.  The list starts with 0 and ends with the entry count.
+
+    Raises
+    ------
+    RuntimeError
+        If ``uproot`` is not installed, or the tree cannot be read.
+    """
+    try:
+        import uproot  # type: ignore
+    except ImportError as exc:
+        raise RuntimeError(
+            "partition='entry_range' requires uproot.\n"
+            "Install it with:  pip install uproot"
+        ) from exc
+
+    try:
+        with uproot.open(url) as f:
+            tree = f[tree_name]
+            n_entries = int(tree.num_entries)
+            boundaries = sorted({0, n_entries, *(int(x) for x in tree.common_entry_offsets())})
+            return n_entries, [b for b in boundaries if 0 <= b <= n_entries]
+    except Exception as exc:
+        raise RuntimeError(
+            f"Failed to query cluster boundaries for {url!r}: {exc}"
+        ) from exc
+
+
+def _load_entry_index(index_path: str, tree_name: str = "Events") -> dict:
+    """Load the entry index sidecar at *index_path*.
+
+    Returns an empty index when the file does not exist, has another format
+    version, or was built for a different tree.
+    """
+    empty = {"version": ENTRY_INDEX_VERSION, "tree": tree_name, "files": {}}
+    try:
+        with open(index_path) as fh:
+            index = json.load(fh)
+    except (OSError, ValueError):
+        return empty
+    if (
+        not isinstance(index, dict)
+        or index.get("version") != ENTRY_INDEX_VERSION
+        or index.get("tree") != tree_name
+        or not isinstance(index.get("files"), dict)
+    ):
+        return empty
+    return index
+
+
+def _save_entry_index(index_path: str, index: dict) -> None:
+    """Atomically write the entry index sidecar to *index_path*."""
+    directory = os.path.dirname(os.path.abspath(index_path))
+    os.makedirs(directory, exist_ok=True)
+    fd, tmp_path = tempfile.mkstemp(dir=directory, suffix=".tmp")
+    try:
+        with os.fdopen(fd, "w") as fh:
+            json.dump(index, fh, indent=1, sort_keys=True)
+        os.replace(tmp_path, index_path)
+    except BaseException:
+        if os.path.exists(tmp_path):
+            os.remove(tmp_path)
+        raise
+
+
+def _cluster_aligned_ranges(
+    n_entries: int, boundaries: list[int], entries_per_job: int
+) -> list[tuple[int, int]]:
+    """Split ``[0, n_entries)`` into ranges that start and end on *boundaries*.
+
+    Clusters are accumulated until a range holds at least *entries_per_job*
+    entries; the last range takes the remainder.
+    """
+    ranges: list[tuple[int, int]] = []
+    start = 0
+    for boundary in boundaries:
+        if boundary <= start:
+            continue
+        if boundary - start >= entries_per_job:
+            ranges.append((start, boundary))
+            start = boundary
+    if start < n_entries:
+        ranges.append((start, n_entries))
+    return ranges
+
+
+def _config_cost_key(config: dict) -> str:
+    """Return a short hash identifying the analysis configured by *config*.
+
+    Per-job keys (input files, entry ranges, output paths) are ignored, so
+    the template config and every job config written from it hash the same
+    way.  Written to job configs as ``configHash`` so that costs measured
+    with one configuration are not applied to another.
+    """
+    items = sorted(
+        (str(k), str(v)) for k, v in config.items()
+        if k not in _PER_JOB_CONFIG_KEYS and not str(k).startswith("__")
+    )
+    return hashlib.sha256(json.dumps(items).encode()).hexdigest()[:16]
+
+
+def _read_job_config(path: "str | Path") -> dict[str, str]:
+    """Read a job config (``key=value`` text or YAML) into a flat dict.
+
+    Comments and blank lines of text configs are ignored.
+    """
+    if str(path).endswith((".yaml", ".yml")):
+        import yaml  # type: ignore[import]
+        with open(path) as fh:
+            raw = yaml.safe_load(fh)
+        return {k: str(v) for k, v in (raw or {}).items()}
+    config: dict[str, str] = {}
+    with open(path) as fh:
+        for line in fh:
+            key, sep, value = line.split("#")[0].strip().partition("=")
+            if sep:
+                config[key.strip()] = value.strip()
+    return config
+
+
+def _job_events(config: dict[str, str]) -> int:
+    """Number of entries a job processed, or 0 when it cannot be told.
+
+    Entry-range jobs carry it in ``firstEntry``/``lastEntry``; whole-file
+    jobs need every input file in the config's ``entryIndex``.
+    """
+    first = int(config.get("firstEntry") or 0)
+    last = int(config.get("lastEntry") or 0)
+    if last > first:
+        return last - first
+    if not config.get("entryIndex"):
+        return 0
+    tree_name = (config.get("treeList") or "Events").split(",")[0].strip()
+    files = _load_entry_index(config["entryIndex"], tree_name)["files"]
+    total = 0
+    for url in filter(None, (u.strip() for u in config.get("fileList", "").split(","))):
+        record = files.get(url)
+        if record is None:
+            return 0
+        total += int(record["entries"])
+    return total
+
+
+def _load_job_costs(run_dirs: list[str]) -> dict[tuple[str, str], tuple[int, float]]:
+    """Sum the events and wall seconds of finished jobs in earlier runs.
+
+    Each entry of *run_dirs* is a run directory (containing ``jobs/``) or a
+    jobs directory laid out as ``<dataset>/<job>/``.  A job counts when its
+    directory holds a ``job.perf.json`` with a positive ``wall_time_s`` and
+    a ``submit_config.txt`` with a ``configHash`` and a known event count.
+
+    Returns
+    -------
+    dict
+        ``(dataset, configHash) -> (events, seconds)``.
+    """
+    costs: dict[tuple[str, str], tuple[int, float]] = {}
+    for run_dir in run_dirs:
+        jobs_dir = Path(run_dir) / "jobs" if (Path(run_dir) / "jobs").is_dir() else Path(run_dir)
+        for perf_path in sorted(jobs_dir.glob("*/*/job.perf.json")):
+            config_path = perf_path.parent / "submit_config.txt"
+            try:
+                with open(perf_path) as fh:
+                    seconds = float(json.load(fh).get("wall_time_s") or 0.0)
+                config = _read_job_config(config_path)
+                events = _job_events(config)
+            except (OSError, ValueError, TypeError, KeyError):
+                continue
+            if seconds <= 0 or events <= 0 or not config.get("configHash"):
+                continue
+            key = (perf_path.parent.parent.name, config["configHash"])
+            total_events, total_seconds = costs.get(key, (0, 0.0))
+            costs[key] = (total_events + events, total_seconds + seconds)
+    return costs
+
+
+def _entries_for_target(
+    costs: dict[tuple[str, str], tuple[int, float]],
+    dataset: str,
+    config_hash: str,
+    target_seconds: float,
+    fallback: int,
+) -> int:
+    """Entries per job that take about *target_seconds* for *dataset*.
+
+    Uses the events/s measured for *dataset* with *config_hash*; returns
+    *fallback* when there is no measurement or no target.
+    """
+    events, seconds = costs.get((dataset, config_hash), (0, 0.0))
+    if target_seconds <= 0 or events <= 0 or seconds <= 0:
+        return fallback
+    return max(1, int(events / seconds * target_seconds))
+
+
 def _make_partitions(
     urls: list[str],
     mode: str,
     files_per_job: int,
     entries_per_job: int,
     tree_name: str = "Events",
+    index_path: str | None = None,
 ) -> list[dict]:
     """Split a URL list into job partitions.
 
@@ -106,6 +343,10 @@ def _make_partitions(
         Maximum TTree entries per partition (``"entry_range"`` mode only).
     tree_name:
         TTree name used to query entry counts in ``"entry_range"`` mode.
+    index_path:
+        Optional entry index sidecar (``"entry_range"`` mode only).  When
+        given, partitions are aligned to TTree cluster boundaries and files
+        missing from the index are queried once and added to it.
 
     Returns
     -------
@@ -153,6 +394,34 @@ def _make_partitions(
             })
         return partitions
 
+    if mode == "entry_range" and index_path:
+        index = _load_entry_index(index_path, tree_name)
+        files = index["files"]
+        updated = False
+        partitions = []
+        for u in sorted_urls:
+            record = files.get(u)
+            if record is None:
+                n_entries, boundaries = _query_tree_clusters(u, tree_name)
+                record = {"entries": n_entries, "clusters": boundaries}
+                files[u] = record
+                updated = True
+            n_entries = int(record["entries"])
+            if n_entries <= 0:
+                partitions.append({"files": u, "first_entry": 0, "last_entry": 0})
+                continue
+            for first, last in _cluster_aligned_ranges(
+                n_entries, [int(b) for b in record["clusters"]], entries_per_job
+            ):
+                partitions.append({
+                    "files": u,
+                    "first_entry": first,
+                    "last_entry": last,
+                })
+        if updated:
+            _save_entry_index(index_path, index)
+        return partitions
+
     if mode == "entry_range":
         partitions = []
         for u in sorted_urls:
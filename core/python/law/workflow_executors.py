@@ -12,6 +12,10 @@ This module provides:
   _run_analysis_job  – a pure, picklable function that executes one analysis
                        job on a remote worker (used by the Dask proxy).
 
+  _run_analysis_job_ranges – splits one job into cluster-aligned entry ranges
+                       that run on separate Dask workers, and tree-reduces
+                       their outputs on the cluster (``--dask-ranges N``).
+
 The Dask proxy integrates with :mod:`failure_handler` to classify each branch
 failure, apply per-category retry policies, and collect a
 :class:`~failure_handler.DiagnosticSummary` that is printed at the end of the
@@ -94,6 +98,12 @@ except ImportError:
     _PerformanceRecorder = None  # type: ignore[assignment,misc]
     _estimate_job_input_bytes = None  # type: ignore[assignment]
     _perf_path_for = None  # type: ignore[assignment]
+from partition_utils import (  # noqa: E402
+    _cluster_aligned_ranges,
+    _load_entry_index,
+    _query_tree_clusters,
+    _read_job_config,
+)
 from failure_handler import (  # noqa: E402
     DiagnosticSummary,
     FailureCategory,
@@ -206,6 +216,19 @@ class _IOThroughputMonitor:
 # XRootD site optimisation helper
 # ---------------------------------------------------------------------------
 
+def _write_job_config(config_path: str, cfg: dict[str, str]) -> None:
+    """Write *cfg* in the format implied by the extension of *config_path*."""
+    if config_path.endswith((".yaml", ".yml")):
+        import yaml  # type: ignore[import]
+        with open(config_path, "w") as fh:
+            yaml.dump(cfg, fh, default_flow_style=False, sort_keys=False)
+    else:
+        with open(config_path, "w") as fh:
+            for k, v in cfg.items():
+                if not k.startswith("__"):
+                    fh.write(f"{k}={v}\n")
+
+
 def _optimize_job_config_xrootd(config_path: str) -> None:
     """Rewrite XRootD URLs in *config_path* to use the fastest available site.
 
@@ -236,23 +259,8 @@ def _optimize_job_config_xrootd(config_path: str) -> None:
     except ImportError:
         return  # selector not available; skip optimisation silently
 
-    # Read the config (support both key=value text and YAML).
-    cfg: dict[str, str] = {}
-    is_yaml = config_path.endswith((".yaml", ".yml"))
     try:
-        if is_yaml:
-            import yaml  # type: ignore[import]
-            with open(config_path) as fh:
-                raw = yaml.safe_load(fh)
-            cfg = {k: str(v) for k, v in (raw or {}).items()}
-        else:
-            with open(config_path) as fh:
-                for line in fh:
-                    line = line.split("#")[0].strip()
-                    if not line or "=" not in line:
-                        continue
-                    k, v = line.split("=", 1)
-                    cfg[k.strip()] = v.strip()
+        cfg = _read_job_config(config_path)
     except Exception:
         return
 
@@ -283,15 +291,7 @@ def _optimize_job_config_xrootd(config_path: str) -> None:
 
     # Write back the updated config.
     try:
-        if is_yaml:
-            import yaml  # type: ignore[import]
-            with open(config_path, "w") as fh:
-                yaml.dump(cfg, fh, default_flow_style=False, sort_keys=False)
-        else:
-            with open(config_path, "w") as fh:
-                for k, v in cfg.items():
-                    if not k.startswith("__"):
-                        fh.write(f"{k}={v}\n")
+        _write_job_config(config_path, cfg)
     except Exception:
         pass  # best-effort; leave the original if write fails
 
@@ -543,6 +543,195 @@ def _run_analysis_job(
     return f"done:{job_dir}"
 
 
+# ---------------------------------------------------------------------------
+# Entry-range splitting: one job over several Dask workers
+# ---------------------------------------------------------------------------
+
+#: Job config keys naming the ROOT files an analysis job writes.
+_RANGE_OUTPUT_KEYS = ("saveFile", "metaFile")
+
+
+def _plan_job_ranges(cfg: dict[str, str], n_ranges: int) -> list[tuple[int, int]]:
+    """Split the input chain of a job config into up to *n_ranges* ranges.
+
+    Ranges are global chain entries ``[first, last)`` that start and end on
+    TTree cluster boundaries, so no range decompresses baskets of another.
+    Entry counts and boundaries come from the ``entryIndex`` sidecar when
+    the config names one and from the files otherwise.  A ``firstEntry`` /
+    ``lastEntry`` window already set on the job is split in the same way.
+
+    Returns an empty list when the job cannot be split (no ``fileList``,
+    multi-sample jobs, or fewer clusters than ranges requested).
+    """
+    files = [f.strip() for f in cfg.get("fileList", "").split(",") if f.strip()]
+    if n_ranges < 2 or not files or cfg.get("sampleConfig"):
+        return []
+    tree_name = (cfg.get("treeList") or "Events").split(",")[0].strip()
+    index = _load_entry_index(cfg["entryIndex"], tree_name) if cfg.get("entryIndex") else None
+
+    # Cluster boundaries of the chain, in the order the job adds the files.
+    boundaries = [0]
+    offset = 0
+    for url in files:
+        record = index["files"].get(url) if index else None
+        if record is None:
+            n_entries, clusters = _query_tree_clusters(url, tree_name)
+        else:
+            n_entries = int(record["entries"])
+            clusters = [int(b) for b in record.get("clusters", [0, n_entries])]
+        boundaries.extend(offset + b for b in clusters if b > 0)
+        offset += n_entries
+
+    first = int(cfg.get("firstEntry") or 0)
+    last = int(cfg.get("lastEntry") or 0) or offset
+    last = min(last, offset)
+    if last <= first:
+        return []
+    window = [b - first for b in boundaries if first < b < last] + [last - first]
+    per_range = -(-(last - first) // n_ranges)
+    ranges = [
+        (first + a, first + b)
+        for a, b in _cluster_aligned_ranges(last - first, window, per_range)
+    ]
+    return ranges if len(ranges) > 1 else []
+
+
+def _range_output_path(path: str, tag: str) -> str:
+    """Return *path* with ``.<tag>`` inserted before its extension."""
+    stem, ext = os.path.splitext(path)
+    return f"{stem}.{tag}{ext}"
+
+
+def _merge_range_outputs(output_path: str, input_paths: list[str], skim: bool) -> str:
+    """Merge partial range outputs into *output_path* and delete the inputs.
+
+    Runs on a Dask worker; uses the same ``rdfmerge`` / ``hadd`` helpers as
+    the merge tasks.
+    """
+    from merge_tasks import _run_merge, _run_skim_merge  # type: ignore
+
+    if skim:
+        _run_skim_merge(output_path, input_paths)
+    else:
+        _run_merge(output_path, input_paths)
+    for path in input_paths:
+        try:
+            os.remove(path)
+        except OSError:
+            pass
+    return output_path
+
+
+def _run_analysis_job_ranges(
+    exe_path: str,
+    job_dir: str,
+    root_setup: str = "",
+    container_setup: str = "",
+    config_relpath: str = "submit_config.txt",
+    stream_output: bool = False,
+    n_ranges: int = 2,
+) -> str:
+    """
+    Run one analysis job as *n_ranges* entry-range jobs on the Dask cluster.
+
+    Must itself run on a Dask worker: it secedes from the worker's thread
+    pool (``distributed.worker_client``) and submits one
+    :func:`_run_analysis_job` per range, each with a derived config
+    (``<config>.range<i>``) that sets ``firstEntry`` / ``lastEntry`` and
+    writes ``saveFile`` / ``metaFile`` to ``<file>.range<i>.root``.  As
+    ranges finish, their outputs are merged pairwise on the cluster, so the
+    reduction overlaps the remaining ranges instead of following them; the
+    last merge is renamed to the paths of the original config.  Histograms,
+    cutflows and counters in the meta file are added key by key.
+
+    Falls back to :func:`_run_analysis_job` when the job cannot be split
+    (see :func:`_plan_job_ranges`).  Per-job side files other than the two
+    outputs (reports, ``job.perf.json``) are written by every range.
+
+    Returns
+    -------
+    str
+        ``"done:<job_dir>"``, as :func:`_run_analysis_job`.
+    """
+    config_path = os.path.join(job_dir, config_relpath)
+    cfg = _read_job_config(config_path)
+    ranges = _plan_job_ranges(cfg, n_ranges)
+    if not ranges:
+        return _run_analysis_job(
+            exe_path, job_dir, root_setup, container_setup, config_relpath, stream_output
+        )
+
+    from distributed import as_completed, worker_client  # type: ignore
+
+    # Outputs are resolved against the job directory, where the job runs.
+    outputs = {
+        os.path.join(job_dir, cfg[key])
+        for key in _RANGE_OUTPUT_KEYS
+        if cfg.get(key)
+    }
+    skims = set()
+    if cfg.get("saveFile") and cfg.get("metaFile") and cfg["saveFile"] != cfg["metaFile"]:
+        skims.add(os.path.join(job_dir, cfg["saveFile"]))
+
+    range_configs = []
+    for i, (first, last) in enumerate(ranges):
+        range_cfg = dict(cfg)
+        range_cfg["firstEntry"] = str(first)
+        range_cfg["lastEntry"] = str(last)
+        for key in _RANGE_OUTPUT_KEYS:
+            if cfg.get(key):
+                range_cfg[key] = _range_output_path(cfg[key], f"range{i}")
+        stem, ext = os.path.splitext(config_relpath)
+        relpath = f"{stem}.range{i}{ext}"
+        _write_job_config(os.path.join(job_dir, relpath), range_cfg)
+        range_configs.append(relpath)
+
+    pending: dict[str, list[str]] = {output: [] for output in outputs}
+    merges = 0
+    try:
+        with worker_client() as client:
+            futures = {
+                client.submit(
+                    _run_analysis_job, exe_path, job_dir, root_setup,
+                    container_setup, relpath, pure=False,
+                ): ("range", i)
+                for i, relpath in enumerate(range_configs)
+            }
+            completed = as_completed(list(futures))
+            for future in completed:
+                kind, key = futures.pop(future)
+                future.result()  # re-raises the failure of a range or merge
+                if kind == "range":
+                    for output in outputs:
+                        partial = _range_output_path(output, f"range{key}")
+                        if os.path.isfile(partial):
+                            pending[output].append(partial)
+                else:
+                    pending[key].append(future.result())
+                for output in outputs:
+                    while len(pending[output]) >= 2:
+                        inputs = [pending[output].pop(0), pending[output].pop(0)]
+                        merged = _range_output_path(output, f"merge{merges}")
+                        merges += 1
+                        merge = client.submit(
+                            _merge_range_outputs, merged, inputs,
+                            output in skims, pure=False,
+                        )
+                        futures[merge] = ("merge", output)
+                        completed.add(merge)
+    finally:
+        for relpath in range_configs:
+            try:
+                os.remove(os.path.join(job_dir, relpath))
+            except OSError:
+                pass
+
+    for output, partials in pending.items():
+        if partials:
+            os.replace(partials[0], output)
+    return f"done:{job_dir}"
+
+
 # ---------------------------------------------------------------------------
 # DaskWorkflow
 # ---------------------------------------------------------------------------
@@ -564,6 +753,14 @@ class DaskWorkflowProxy(BaseWorkflowProxy):
     so performance data is available at a consistent location for all execution
     backends (local, HTCondor, Dask).
 
+    Entry-range splitting
+    ---------------------
+    With ``--dask-ranges N`` (N > 1), branches whose work is
+    :func:`_run_analysis_job` run through :func:`_run_analysis_job_ranges`
+    instead: the job is split into up to N entry ranges on separate workers
+    and their outputs are merged on the cluster, so a few large jobs use the
+    whole cluster.  Other callables are submitted unchanged.
+
     See :class:`DaskWorkflow` for the full documentation.
     """
 
@@ -593,6 +790,8 @@ class DaskWorkflowProxy(BaseWorkflowProxy):
             task, "dask_retry_policies", DEFAULT_RETRY_POLICIES
         )
 
+        n_ranges: int = getattr(task, "dask_ranges", 1) or 1
+
         if scheduler:
             client = Client(scheduler)
         else:
@@ -612,6 +811,9 @@ class DaskWorkflowProxy(BaseWorkflowProxy):
                     continue
 
                 func, args, kwargs = task.get_dask_work(branch_num, branch_data)
+                if n_ranges > 1 and func is _run_analysis_job:
+                    func = _run_analysis_job_ranges
+                    kwargs = {**kwargs, "n_ranges": n_ranges}
                 future = client.submit(func, *args, **kwargs, pure=False)
                 futures_to_branch[future] = (branch_num, branch_task, func, args, kwargs)
 
@@ -739,6 +941,10 @@ class DaskWorkflow(BaseWorkflow):
     dask_workers : int
         When ``dask_scheduler`` is empty (local cluster), this controls how
         many worker processes are launched.  Defaults to ``1``.
+    dask_ranges : int
+        Split every :func:`_run_analysis_job` branch into up to this many
+        entry ranges on separate workers (see :class:`DaskWorkflowProxy`).
+        Defaults to ``1`` (whole jobs).
 
     Example
     -------
@@ -806,6 +1012,15 @@ class DaskWorkflow(BaseWorkflow):
             "--dask-scheduler is empty (default: 1)."
         ),
     )
+    dask_ranges = luigi.IntParameter(
+        default=1,
+        significant=False,
+        description=(
+            "Split every analysis job into up to this many cluster-aligned "
+            "entry ranges that run on separate Dask workers; their outputs "
+            "are merged on the cluster (default: 1, whole jobs)."
+        ),
+    )
 
     #: Per-category retry policies used by :class:`DaskWorkflowProxy`.
     #: Override in a subclass to customise retry behaviour, e.g.::
@@ -821,7 +1036,7 @@ class DaskWorkflow(BaseWorkflow):
     # Subclasses that extend exclude_params_branch should merge rather than
     # replace this set to preserve the Dask scheduler exclusion, e.g.:
     #   exclude_params_branch = DaskWorkflow.exclude_params_branch | {"extra_param"}
-    exclude_params_branch = {"dask_scheduler", "dask_workers"}
+    exclude_params_branch = {"dask_scheduler", "dask_workers", "dask_ranges"}
     exclude_index = True
 
     def dask_workflow_requires(self):
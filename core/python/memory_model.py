@@ -0,0 +1,185 @@
+"""
+Memory model for the resource requests of batch jobs.
+
+The memory of an analysis job is a fixed part (ROOT, the interpreter and the
+analysis libraries) plus, for every thread, the event-loop buffers and one
+accumulator per booked histogram.  Requesting the worst case for every job
+wastes slots, so :class:`MemoryModel` estimates each job instead:
+
+- **static**: from the ``histogramConfig`` of the job config, counting the
+  bins of every histogram (all axes, with under- and overflow) at
+  :data:`SPARSE_BYTES_PER_BIN` per thread;
+- **observed**: from the ``memory.peak_rss_mb`` and
+  ``executor.num_threads`` provenance of finished jobs of the same dataset
+  (see :func:`production_monitor.collect_job_performance`), which replaces
+  the static estimate and captures sparse fills and systematic variations.
+
+:meth:`MemoryModel.plan` turns an estimate into an HTCondor request that
+packs onto multi-core slots: a job whose memory would hold more cores than
+it uses is given threads for those cores, up to a maximum.
+
+Usage::
+
+    from memory_model import MemoryModel
+
+    model = MemoryModel.from_config(read_config("config.txt"), Path("."), records)
+    threads, memory_mb = model.plan("ttH", threads=2, max_threads=8,
+                                    memory_per_core_mb=2000)
+"""
+
+from __future__ import annotations
+
+import math
+import re
+from dataclasses import dataclass, field
+from pathlib import Path
+from typing import Dict, Iterable, List, Optional, Tuple
+
+#: Memory of a job before any thread or histogram (ROOT, cling, libraries).
+BASE_MB = 800.0
+
+#: Event-loop buffers of one RDataFrame slot (readers, baskets, columns).
+PER_THREAD_MB = 150.0
+
+#: Bytes per filled bin of a per-slot ``THnSparseF`` accumulator; every bin
+#: is assumed filled.
+SPARSE_BYTES_PER_BIN = 65.0
+
+#: Safety factor applied to every estimate.
+DEFAULT_MARGIN = 1.2
+
+#: Config keys naming the dataset, in the order ProvenanceService uses them.
+DATASET_KEYS = ("sample", "name", "sample_type", "type", "process")
+
+_AXIS_PREFIXES = ("channel", "controlRegion", "sampleCategory")
+
+
+def dataset_of(config: Dict[str, str]) -> str:
+    """Dataset name of a job config, as ProvenanceService records it."""
+    for key in DATASET_KEYS:
+        if config.get(key):
+            return config[key]
+    return "unknown"
+
+
+def parse_histogram_config(path: Path) -> List[Dict[str, str]]:
+    """Read the ``key=value`` histogram specs of a ``histogramConfig`` file.
+
+    Values may contain spaces (e.g. ``label=Jet pT [GeV]``); a value ends
+    where the next ``key=`` starts.
+    """
+    specs = []
+    with open(path) as f:
+        for line in f:
+            line = line.split('#', 1)[0].strip()
+            if not line:
+                continue
+            matches = list(re.finditer(r'(?:^|\s)(\w+)=', line))
+            spec = {}
+            for i, match in enumerate(matches):
+                end = matches[i + 1].start() if i + 1 < len(matches) else len(line)
+                spec[match.group(1)] = line[match.end():end].strip()
+            if spec:
+                specs.append(spec)
+    return specs
+
+
+def histogram_bins(spec: Dict[str, str]) -> int:
+    """Number of bins of a histogram spec, with under- and overflow on each axis."""
+    if spec.get('binEdges'):
+        bins = len([e for e in spec['binEdges'].split(',') if e.strip()]) - 1
+    else:
+        bins = int(float(spec.get('bins', 1)))
+    total = bins + 2
+    for prefix in _AXIS_PREFIXES:
+        if spec.get(f'{prefix}Variable'):
+            total *= int(float(spec.get(f'{prefix}Bins', 1))) + 2
+    return total
+
+
+def static_per_thread_mb(config: Dict[str, str], config_dir: Path) -> float:
+    """Per-thread memory of the histograms booked by ``histogramConfig``."""
+    path_value = config.get('histogramConfig', '')
+    if not path_value:
+        return PER_THREAD_MB
+    path = Path(path_value)
+    if not path.is_absolute():
+        path = config_dir / path
+    if not path.is_file():
+        return PER_THREAD_MB
+    bins = sum(histogram_bins(spec) for spec in parse_histogram_config(path))
+    return PER_THREAD_MB + bins * SPARSE_BYTES_PER_BIN / 1e6
+
+
+@dataclass
+class MemoryModel:
+    """Estimates the memory of a job from its dataset and thread count."""
+
+    base_mb: float = BASE_MB
+    per_thread_mb: float = PER_THREAD_MB
+    #: dataset -> (largest observed peak RSS in MB, threads of that job)
+    observed: Dict[str, Tuple[float, int]] = field(default_factory=dict)
+    margin: float = DEFAULT_MARGIN
+
+    @classmethod
+    def from_config(
+        cls,
+        config: Dict[str, str],
+        config_dir: Path,
+        records: Optional[Iterable[dict]] = None,
+        margin: float = DEFAULT_MARGIN,
+    ) -> 'MemoryModel':
+        """
+        Build the model of an analysis config.
+
+        Args:
+            config: Analysis config (job or base config)
+            config_dir: Directory relative paths in *config* are resolved from
+            records: Optional per-job records with ``dataset``,
+                ``peak_rss_mb`` and ``threads`` (as returned by
+                production_monitor.collect_job_performance)
+            margin: Safety factor applied to every estimate
+        """
+        model = cls(per_thread_mb=static_per_thread_mb(config, config_dir), margin=margin)
+        for record in records or []:
+            peak = float(record.get('peak_rss_mb', 0.0))
+            if peak <= 0:
+                continue
+            dataset = record.get('dataset', 'unknown')
+            if peak > model.observed.get(dataset, (0.0, 0))[0]:
+                model.observed[dataset] = (peak, max(1, int(record.get('threads', 1))))
+        return model
+
+    def estimate_mb(self, dataset: str, threads: int) -> float:
+        """Expected peak memory in MB of a job of *dataset* with *threads*."""
+        if dataset in self.observed:
+            peak, observed_threads = self.observed[dataset]
+            estimate = peak + self.per_thread_mb * (threads - observed_threads)
+        else:
+            estimate = self.base_mb + self.per_thread_mb * threads
+        return max(estimate, self.base_mb) * self.margin
+
+    def plan(
+        self,
+        dataset: str,
+        threads: int,
+        max_threads: int,
+        memory_per_core_mb: float,
+    ) -> Tuple[int, int]:
+        """
+        Threads and memory (MB) to request for a job.
+
+        A job needing more memory than *threads* cores of the slot provide
+        holds the extra cores anyway, so it is given threads for them, up
+        to *max_threads*.
+
+        Returns:
+            (threads, memory_mb)
+        """
+        threads = max(1, threads)
+        while True:
+            memory = self.estimate_mb(dataset, threads)
+            cores = math.ceil(memory / memory_per_core_mb)
+            if cores <= threads or threads >= max_threads:
+                return threads, int(math.ceil(memory))
+            threads = min(cores, max_threads)
@@ -13,6 +13,7 @@ Features:
 - Progress monitoring and reporting
 - State persistence (can stop/start without breaking)
 - HTCondor submission with optional DASK backend
+- Speculative duplicates of straggler jobs at other sites
 - Support for AFS/EOS storage areas
 """
 
@@ -64,6 +65,14 @@ class Job:
     completion_time: Optional[float] = None
     attempts: int = 0
     last_error: Optional[str] = None
+    sites: List[str] = field(default_factory=list)
+    request_cpus: Optional[int] = None
+    request_memory_mb: Optional[int] = None
+    start_time: Optional[float] = None
+    run_site: Optional[str] = None
+    speculative_condor_id: Optional[str] = None
+    speculations: int = 0
+    speculation_winner: Optional[str] = None
     
     def to_dict(self) -> dict:
         """Serialize job to dictionary"""
@@ -78,6 +87,14 @@ class Job:
             'completion_time': self.completion_time,
             'attempts': self.attempts,
             'last_error': self.last_error,
+            'sites': self.sites,
+            'request_cpus': self.request_cpus,
+            'request_memory_mb': self.request_memory_mb,
+            'start_time': self.start_time,
+            'run_site': self.run_site,
+            'speculative_condor_id': self.speculative_condor_id,
+            'speculations': self.speculations,
+            'speculation_winner': self.speculation_winner,
         }
     
     @classmethod
@@ -106,6 +123,12 @@ class ProductionConfig:
     root_setup: str = ""  # command to setup ROOT on remote workers
     x509: Optional[str] = None  # path to x509 proxy (optional)
     state_file: Optional[Path] = None
+    site_placement: str = ""  # "", "rank" or "require": steer jobs to replica sites
+    probe_sites: bool = False  # order replica sites by probed read speed
+    memory_model: bool = False  # per-job threads/memory from memory_model.MemoryModel
+    max_threads: int = 8  # upper bound on threads given by the memory model
+    memory_per_core_mb: int = 2000  # slot memory per core the requests are packed onto
+    cost_check: bool = False  # dry-run a job config against its costBudget* keys before submitting
 
     def __post_init__(self):
         """Initialize derived attributes"""
@@ -113,6 +136,113 @@ class ProductionConfig:
             self.state_file = self.work_dir / "production_state.json"
 
 
+def group_files_by_site(
+    files: List[str],
+    site_redirectors: Dict[str, List[str]],
+    files_per_job: int,
+) -> List[str]:
+    """
+    Split *files* into comma-separated per-job file lists that share a site.
+
+    Each file is assigned to the site among its replicas that holds the most
+    files overall, so jobs read from as few sites as possible.  Files
+    without known replicas are grouped together.
+
+    Args:
+        files: Input file URLs or LFNs
+        site_redirectors: LFN -> site-specific redirectors, as returned by
+            rucio_discovery.query_rucio()
+        files_per_job: Maximum number of files per job
+
+    Returns:
+        File lists for ProductionManager.generate_jobs(), sorted by site
+    """
+    from xrootd_site_selector import _extract_lfn, redirector_site
+
+    file_sites = {
+        f: sorted({s for s in map(redirector_site, site_redirectors.get(_extract_lfn(f), [])) if s})
+        for f in set(files)
+    }
+    popularity: Dict[str, int] = {}
+    for sites in file_sites.values():
+        for site in sites:
+            popularity[site] = popularity.get(site, 0) + 1
+
+    by_site: Dict[str, List[str]] = {}
+    for f in sorted(file_sites):
+        sites = file_sites[f]
+        home = min(sites, key=lambda site: (-popularity[site], site)) if sites else ""
+        by_site.setdefault(home, []).append(f)
+
+    file_lists = []
+    for home in sorted(by_site):
+        group = by_site[home]
+        for start in range(0, len(group), files_per_job):
+            file_lists.append(",".join(group[start:start + files_per_job]))
+    return file_lists
+
+
+def create_from_rucio(
+    manager: 'ProductionManager',
+    dataset: str,
+    files_per_job: int,
+    client=None,
+) -> int:
+    """
+    Generate the jobs of a Rucio *dataset*, grouped by replica site.
+
+    The files and their replica redirectors come from
+    rucio_discovery.query_rucio(), the per-job file lists from
+    group_files_by_site().
+
+    Args:
+        manager: Manager whose jobs are generated
+        dataset: DAS name of the dataset
+        files_per_job: Maximum number of files per job
+        client: Rucio client (default: rucio_discovery.get_rucio_client())
+
+    Returns:
+        Number of jobs created
+    """
+    import rucio_discovery
+
+    if client is None:
+        client = rucio_discovery.get_rucio_client(manager.config.x509)
+    # The size groups of query_rucio are not used; jobs are split by site.
+    result = rucio_discovery.query_rucio(dataset, float("inf"), client=client,
+                                         max_files_per_group=sys.maxsize)
+    files = [f for group in result["groups"].values() for f in group.split(",") if f]
+    site_redirectors = result["site_redirectors"]
+    return manager.generate_jobs(
+        group_files_by_site(files, site_redirectors, files_per_job),
+        site_redirectors=site_redirectors,
+    )
+
+
+def job_sites(files: List[str], site_redirectors: Dict[str, List[str]]) -> List[str]:
+    """
+    Sites holding replicas of the largest number of *files*, sorted by name.
+
+    Args:
+        files: Input file URLs or LFNs of one job
+        site_redirectors: LFN -> site-specific redirectors
+
+    Returns:
+        Site names, empty when no replica site is known
+    """
+    from xrootd_site_selector import _extract_lfn, redirector_site
+
+    counts: Dict[str, int] = {}
+    for f in files:
+        for site in {redirector_site(r) for r in site_redirectors.get(_extract_lfn(f), [])}:
+            if site:
+                counts[site] = counts.get(site, 0) + 1
+    if not counts:
+        return []
+    best = max(counts.values())
+    return sorted(site for site, count in counts.items() if count == best)
+
+
 class ProductionManager:
     """
     Main production manager class.
@@ -189,10 +319,37 @@ class ProductionManager:
                 return c.resolve()
         return p
             
+    def _order_sites(
+        self,
+        files: List[str],
+        sites: List[str],
+        site_redirectors: Dict[str, List[str]],
+        cache: Dict[tuple, List[str]],
+    ) -> List[str]:
+        """Order *sites* fastest first by probing the first file (probe_sites)."""
+        if not self.config.probe_sites or len(sites) < 2:
+            return sites
+        key = tuple(sites)
+        if key not in cache:
+            from xrootd_site_selector import _extract_lfn, rank_redirectors, redirector_site
+
+            lfn = _extract_lfn(files[0])
+            redirectors = [
+                r for r in site_redirectors.get(lfn, []) if redirector_site(r) in sites
+            ]
+            try:
+                ranked = [redirector_site(r) for r, _ in rank_redirectors(lfn, redirectors)]
+            except Exception as e:
+                logger.warning(f"Could not probe sites {sites}: {e}")
+                ranked = []
+            cache[key] = ranked + [site for site in sites if site not in ranked]
+        return cache[key]
+
     def generate_jobs(
         self,
         file_lists: List[str],
-        job_configs: Optional[List[Dict[str, Any]]] = None
+        job_configs: Optional[List[Dict[str, Any]]] = None,
+        site_redirectors: Optional[Dict[str, List[str]]] = None,
     ) -> int:
         """
         Generate job configurations.
@@ -200,6 +357,10 @@ class ProductionManager:
         Args:
             file_lists: List of comma-separated file lists, one per job
             job_configs: Optional list of additional config parameters per job
+            site_redirectors: Optional LFN -> site-specific redirectors from
+                Rucio discovery.  Each job records the sites holding its
+                files (used by site_placement) and gets a
+                site_redirectors.json for worker-side site selection.
             
         Returns:
             Number of jobs created
@@ -330,6 +491,7 @@ class ProductionManager:
             except Exception:
                 pass
 
+        probed_sites: Dict[tuple, List[str]] = {}
         for i, (file_list, extra_config) in enumerate(zip(file_lists, job_configs)):
             job_id = len(self.jobs)
             
@@ -353,6 +515,35 @@ class ProductionManager:
             base_config['__orig_metaFile'] = str(meta_output_path)
             base_config['batch'] = 'True'
 
+            # Live metrics of every job go to one directory of the production,
+            # read by production_monitor.py's live command.  Batch jobs write
+            # them in their scratch directory; the submit file transfers them
+            # back (see _submit_htcondor).
+            if base_config.get('metricsFile', ''):
+                suffix = '.prom' if base_config.get('metricsFormat') == 'prometheus' else '.json'
+                metrics_dir = self.config.work_dir / "metrics"
+                metrics_dir.mkdir(parents=True, exist_ok=True)
+                base_config['metricsFile'] = f"metrics{suffix}"
+                base_config['__orig_metricsFile'] = str(
+                    (metrics_dir / f"job_{job_id}{suffix}").resolve())
+
+            # Checkpoints are written to a directory of the job's scratch
+            # area, which the submit file returns on exit and on eviction.
+            if base_config.get('checkpointFile', ''):
+                base_config['checkpointFile'] = (
+                    f"checkpoint/{os.path.basename(base_config['checkpointFile'])}")
+
+            # Batch jobs read the JIT cache shipped in the sandbox; the local
+            # test job fills the original directory (see create_test_job).
+            jit_cache_dir = base_config.get('jitCacheDir', '')
+            if jit_cache_dir:
+                jit_cache_path = Path(jit_cache_dir)
+                if not jit_cache_path.is_absolute():
+                    jit_cache_path = base_config_dir / jit_cache_path
+                base_config['__orig_jitCacheDir'] = str(jit_cache_path.resolve())
+                base_config['jitCacheDir'] = 'aux/jit_cache'
+                base_config['jitCacheBuild'] = 'False'
+
             # Handle special inline float/int config content.
             # If `extra_config` provides `floatConfig`/`intConfig` as inline content
             # (contains '\n' or an '=' sign and is not a filename), write that content
@@ -469,6 +660,19 @@ class ProductionManager:
             _rewrite_correction_config_to_top_level(job_dir, base_config.get('correctionConfig', ''))
 
             write_config(base_config, str(config_path))
+
+            sites: List[str] = []
+            if site_redirectors:
+                from xrootd_site_selector import _extract_lfn
+
+                files = [f.strip() for f in file_list.split(',') if f.strip()]
+                lfns = {_extract_lfn(f) for f in files}
+                with open(job_dir / "site_redirectors.json", 'w') as f:
+                    json.dump({lfn: site_redirectors[lfn] for lfn in sorted(lfns)
+                               if lfn in site_redirectors}, f)
+                sites = job_sites(files, site_redirectors)
+                if files:
+                    sites = self._order_sites(files, sites, site_redirectors, probed_sites)
             
             # Create job object
             job = Job(
@@ -476,6 +680,7 @@ class ProductionManager:
                 config_path=str(config_path),
                 output_path=str(output_path),
                 meta_output_path=str(meta_output_path),
+                sites=sites,
             )
             self.jobs[job_id] = job
             
@@ -670,6 +875,14 @@ class ProductionManager:
         test_cfg.setdefault('threads', '1')
         test_cfg['saveFile'] = 'test_output.root'
         test_cfg['metaFile'] = 'test_output_meta.root'
+        if test_cfg.get('__orig_metricsFile'):
+            test_cfg['metricsFile'] = test_cfg['__orig_metricsFile']
+
+        # The test job compiles its JIT expressions into the production's
+        # cache, which is shipped to the batch jobs at submission.
+        if test_cfg.get('__orig_jitCacheDir'):
+            test_cfg['jitCacheDir'] = test_cfg['__orig_jitCacheDir']
+            test_cfg['jitCacheBuild'] = 'True'
 
         # Ensure float/int references are basenames in test dir
         test_cfg['floatConfig'] = os.path.basename(float_cfg)
@@ -711,6 +924,12 @@ class ProductionManager:
             return 0
             
         logger.info(f"Submitting {len(job_ids)} jobs")
+
+        if self.config.memory_model:
+            self.plan_resources(job_ids)
+
+        if self.config.cost_check and not self.check_cost(job_ids[0]):
+            return 0
         
         if self.config.backend == "htcondor":
             return self._submit_htcondor(job_ids, dry_run)
@@ -720,6 +939,103 @@ class ProductionManager:
             logger.error(f"Unknown backend: {self.config.backend}")
             return 0
             
+    def check_cost(self, job_id: int) -> bool:
+        """
+        Dry-run the config of a job and check it against its cost budgets.
+
+        The analysis executable books the graph without running the event
+        loop (``dryRun=true``) and reports the defined columns, JIT
+        expressions, histogram cells and memory and ML models.  The jobs of a
+        production share the base config, so one job stands for all of them.
+
+        Args:
+            job_id: Job whose config is dry-run.
+
+        Returns:
+            False if the dry run failed or a ``costBudget*`` key is exceeded.
+        """
+        from validate_config import ValidationError, dry_run_config, format_cost_report
+
+        if self.config.exe_path is None:
+            logger.error("Cost check needs the analysis executable (exe_path)")
+            return False
+        job = self.jobs[job_id]
+        try:
+            report = dry_run_config(str(self.config.exe_path), job.config_path)
+        except ValidationError as exc:
+            logger.error(f"Cost check of job {job_id} failed: {exc}")
+            return False
+        logger.info(f"Cost of job {job_id}: {format_cost_report(report)}")
+        for warning in report["warnings"]:
+            logger.error(f"Cost budget exceeded: {warning}")
+        return not report["warnings"]
+
+    def plan_resources(
+        self,
+        job_ids: List[int],
+        records: Optional[List[dict]] = None,
+    ) -> None:
+        """
+        Set the threads and memory requested by each job from a memory model.
+
+        The model starts from the histograms booked by the base config and
+        uses the peak RSS of finished jobs of the same dataset once there
+        are any.  A job that already failed asks for at least 1.5x its last
+        memory request.  The chosen thread count is written to the job
+        config.
+
+        Args:
+            job_ids: Jobs to plan
+            records: Per-job performance records; defaults to
+                production_monitor.collect_job_performance(self) when jobs
+                have finished
+        """
+        from memory_model import MemoryModel, dataset_of
+        from submission_backend import read_config
+
+        if records is None:
+            finished = any(job.status in (JobStatus.COMPLETED, JobStatus.VALIDATED)
+                           for job in self.jobs.values())
+            records = []
+            if finished:
+                from production_monitor import collect_job_performance
+                try:
+                    records = collect_job_performance(self)
+                except ImportError as e:
+                    logger.warning(f"Cannot read job provenance for the memory model: {e}")
+
+        base_config_path = Path(self.config.base_config).resolve()
+        model = MemoryModel.from_config(
+            read_config(str(base_config_path)), base_config_path.parent, records)
+
+        for job_id in job_ids:
+            job = self.jobs[job_id]
+            job_config = read_config(job.config_path)
+            try:
+                threads = int(job_config.get('threads', '1'))
+            except ValueError:
+                threads = 1
+            threads, memory = model.plan(
+                dataset_of(job_config),
+                threads,
+                self.config.max_threads,
+                self.config.memory_per_core_mb,
+            )
+            if job.attempts > 0 and job.request_memory_mb:
+                memory = max(memory, int(job.request_memory_mb * 1.5))
+            job.request_cpus = threads
+            job.request_memory_mb = memory
+            if job_config.get('threads') != str(threads):
+                # Edit the one line: read_config drops lines it cannot parse.
+                with open(job.config_path) as f:
+                    lines = [ln for ln in f if not re.match(r'\s*threads\s*=', ln)]
+                if lines and not lines[-1].endswith('\n'):
+                    lines[-1] += '\n'
+                lines.append(f"threads={threads}\n")
+                with open(job.config_path, 'w') as f:
+                    f.writelines(lines)
+        self._save_state()
+
     def _prepare_shared_libraries(self) -> None:
         """
         Discover and stage shared libraries required by the executable.
@@ -814,6 +1130,16 @@ class ProductionManager:
                 if job_aux.exists() and job_aux.is_dir():
                     shared_aux.mkdir(parents=True, exist_ok=True)
                     shutil.copytree(str(job_aux), str(shared_aux), dirs_exist_ok=True)
+
+            # Ship the JIT cache filled by the test job (see generate_jobs)
+            from submission_backend import read_config
+            for job in self.jobs.values():
+                job_cfg = read_config(str(self._resolve_existing_path(job.config_path)))
+                jit_cache_src = Path(job_cfg.get('__orig_jitCacheDir', ''))
+                if job_cfg.get('__orig_jitCacheDir') and jit_cache_src.is_dir():
+                    shutil.copytree(str(jit_cache_src), str(shared_aux / 'jit_cache'),
+                                    dirs_exist_ok=True)
+                break
         except Exception as e:
             logger.warning(f"Failed to prepare shared_inputs: {e}")
             
@@ -993,8 +1319,9 @@ class ProductionManager:
                     pass
 
             # Move/copy all non-unique job files into shared_inputs.
-            # Keep only job_config.txt, floats.txt, and ints.txt as per-job files.
-            keep_per_job = {'job_config.txt', 'floats.txt', 'ints.txt'}
+            # Keep only job_config.txt, floats.txt, ints.txt, and
+            # site_redirectors.json as per-job files.
+            keep_per_job = {'job_config.txt', 'floats.txt', 'ints.txt', 'site_redirectors.json'}
             try:
                 for job_file in sorted(job_dir.iterdir()):
                     if not job_file.exists() or not job_file.is_file():
@@ -1012,6 +1339,21 @@ class ProductionManager:
             except Exception:
                 pass
 
+        # Live metrics are written next to the job config and moved to
+        # <work_dir>/metrics on transfer.
+        output_remaps = None
+        checkpoint_dir = None
+        if job_ids:
+            first_cfg = read_config(str(self.jobs[job_ids[0]].config_path))
+            metrics_file = first_cfg.get('metricsFile', '')
+            if metrics_file and first_cfg.get('__orig_metricsFile'):
+                suffix = Path(metrics_file).suffix
+                metrics_dir = (self.config.work_dir / "metrics").absolute()
+                output_remaps = {metrics_file: f"{metrics_dir}/job_$(Process){suffix}"}
+            checkpoint_file = Path(first_cfg.get('checkpointFile', ''))
+            if not checkpoint_file.is_absolute() and len(checkpoint_file.parts) > 1:
+                checkpoint_dir = checkpoint_file.parts[0]
+
         # Generate condor submission files
         submit_path = write_submit_files(
             str(self.config.work_dir.absolute()),
@@ -1025,6 +1367,18 @@ class ProductionManager:
             config_file="job_config.txt",
             eos_sched=self.config.eos_sched,
             shared_dir_name="shared_inputs",
+            job_sites=(
+                [self.jobs[job_id].sites for job_id in job_ids]
+                if self.config.site_placement else None
+            ),
+            site_placement=self.config.site_placement or "rank",
+            job_resources=(
+                [(self.jobs[job_id].request_cpus, self.jobs[job_id].request_memory_mb)
+                 for job_id in job_ids]
+                if self.config.memory_model else None
+            ),
+            output_remaps=output_remaps,
+            checkpoint_dir=checkpoint_dir,
         )
         
         if dry_run:
@@ -1217,7 +1571,9 @@ class ProductionManager:
         logger.info("Updating job statuses")
         
         if self.config.backend == "htcondor":
-            self._update_htcondor_status()
+            condor_statuses = self._update_htcondor_status()
+            if condor_statuses is not None:
+                self._resolve_speculation(condor_statuses)
         elif self.config.backend == "dask":
             # DASK status updates would go here
             pass
@@ -1232,8 +1588,16 @@ class ProductionManager:
         self._save_state()
         return status_counts
         
-    def _update_htcondor_status(self) -> None:
-        """Update job statuses from HTCondor"""
+    def _update_htcondor_status(self) -> Optional[Dict[str, int]]:
+        """
+        Update job statuses from HTCondor.
+
+        Also records when and at which site each running job started.
+
+        Returns:
+            Condor job ID -> HTCondor JobStatus of the queued jobs, or None
+            if condor_q could not be queried
+        """
         # Get condor_q output
         try:
             result = subprocess.run(
@@ -1245,12 +1609,13 @@ class ProductionManager:
             
             if result.returncode != 0:
                 logger.warning("Failed to query condor_q")
-                return
+                return None
                 
             queue_data = json.loads(result.stdout)
             
             # Build mapping of condor job ID to status
             condor_statuses = {}
+            condor_entries = {}
             for entry in queue_data:
                 job_id = entry.get('ClusterId')
                 proc_id = entry.get('ProcId')
@@ -1258,6 +1623,7 @@ class ProductionManager:
                     full_id = f"{job_id}.{proc_id}"
                     status = entry.get('JobStatus')
                     condor_statuses[full_id] = status
+                    condor_entries[full_id] = entry
                     
             # Update our jobs
             for job in self.jobs.values():
@@ -1266,14 +1632,215 @@ class ProductionManager:
                     # HTCondor status: 1=Idle, 2=Running, 3=Removed, 4=Completed, 5=Held
                     if condor_status == 2:
                         job.status = JobStatus.RUNNING
+                        entry = condor_entries[job.condor_job_id]
+                        if entry.get('JobCurrentStartDate'):
+                            job.start_time = float(entry['JobCurrentStartDate'])
+                        site = entry.get('MATCH_EXP_JOB_GLIDEIN_CMSSite')
+                        if site and site != 'Unknown':
+                            job.run_site = site
                     elif condor_status == 4:
                         job.status = JobStatus.COMPLETED
                         job.completion_time = time.time()
                     elif condor_status == 5:
                         job.status = JobStatus.FAILED
+            return condor_statuses
                         
         except Exception as e:
             logger.warning(f"Failed to update HTCondor status: {e}")
+            return None
+
+    def speculate_stragglers(
+        self,
+        policy: Optional['StragglerPolicy'] = None,
+        records: Optional[List[dict]] = None,
+        now: Optional[float] = None,
+        dry_run: bool = False,
+    ) -> List[int]:
+        """
+        Submit speculative duplicates of straggling running jobs.
+
+        A running job is a straggler when it has run more than
+        policy.slowdown times the runtime predicted by
+        speculative_execution.RuntimeModel from the finished jobs.  Its
+        duplicate runs at another site and writes ``.spec`` outputs;
+        update_status() keeps whichever copy finishes first.  Each job is
+        duplicated at most once.  HTCondor backend only.
+
+        Args:
+            policy: Straggler thresholds; defaults to StragglerPolicy()
+            records: Per-job performance records; defaults to
+                production_monitor.collect_job_performance(self)
+            now: Current time (for tests); defaults to time.time()
+            dry_run: Log the stragglers without submitting
+
+        Returns:
+            IDs of the jobs that got a duplicate
+        """
+        from memory_model import dataset_of
+        from speculative_execution import (
+            RunningJob, RuntimeModel, find_stragglers,
+        )
+        from submission_backend import read_config
+
+        if self.config.backend != "htcondor":
+            logger.warning("Speculative execution needs the HTCondor backend")
+            return []
+        now = time.time() if now is None else now
+        done_states = (JobStatus.COMPLETED, JobStatus.VALIDATED)
+
+        def _dataset(job: Job) -> str:
+            try:
+                return dataset_of(read_config(job.config_path))
+            except OSError:
+                return "unknown"
+
+        finished = [
+            (_dataset(job), job.completion_time - (job.start_time or job.submit_time))
+            for job in self.jobs.values()
+            if job.status in done_states and job.completion_time
+            and (job.start_time or job.submit_time)
+        ]
+        if records is None:
+            records = []
+            if finished:
+                from production_monitor import collect_job_performance
+                try:
+                    records = collect_job_performance(self)
+                except ImportError as e:
+                    logger.warning(f"Cannot read job provenance for the runtime model: {e}")
+        model = RuntimeModel.from_jobs(finished, records)
+
+        running = []
+        for job in self.jobs.values():
+            started = job.start_time or job.submit_time
+            if (job.status != JobStatus.RUNNING or job.speculative_condor_id
+                    or job.speculations > 0 or not started):
+                continue
+            try:
+                job_config = read_config(job.config_path)
+            except OSError:
+                continue
+            try:
+                events = int(job_config.get('lastEntry') or 0) - int(job_config.get('firstEntry') or 0)
+            except ValueError:
+                events = 0
+            running.append(RunningJob(job.job_id, now - started, dataset_of(job_config), max(events, 0)))
+
+        stragglers = find_stragglers(
+            running,
+            model,
+            n_jobs=len(self.jobs),
+            n_done=sum(1 for job in self.jobs.values() if job.status in done_states),
+            n_speculating=sum(1 for job in self.jobs.values() if job.speculative_condor_id),
+            policy=policy,
+        )
+        submitted = []
+        for job_id in stragglers:
+            if self._submit_speculative(self.jobs[job_id], dry_run):
+                submitted.append(job_id)
+        self._save_state()
+        return submitted
+
+    def _submit_speculative(self, job: Job, dry_run: bool) -> bool:
+        """Queue one duplicate of *job* away from the site it runs at."""
+        from speculative_execution import (
+            SPECULATIVE_DIR, speculative_config, speculative_submit,
+        )
+
+        submit_path = self.config.work_dir / "condor_submit.sub"
+        if not submit_path.exists():
+            logger.error(f"Cannot duplicate job {job.job_id}: {submit_path} not found")
+            return False
+        config_path = Path(job.config_path)
+        spec_dir = config_path.parent / SPECULATIVE_DIR
+        spec_dir.mkdir(parents=True, exist_ok=True)
+        (spec_dir / config_path.name).write_text(speculative_config(config_path.read_text()))
+        submit = speculative_submit(
+            submit_path.read_text(),
+            job.job_id,
+            config_file=config_path.name,
+            exclude_site=job.run_site,
+            request_cpus=job.request_cpus,
+            request_memory_mb=job.request_memory_mb,
+        )
+        job_submit_path = spec_dir / "condor_submit.sub"
+        job_submit_path.write_text(submit)
+
+        elsewhere = f" away from {job.run_site}" if job.run_site else ""
+        if dry_run:
+            logger.info(f"Dry run: would duplicate straggler job {job.job_id}{elsewhere}")
+            return True
+        try:
+            result = subprocess.run(
+                ["condor_submit", str(job_submit_path)],
+                capture_output=True,
+                text=True,
+                check=True
+            )
+        except subprocess.CalledProcessError as e:
+            logger.error(f"Failed to duplicate job {job.job_id}: {e.stderr}")
+            return False
+        match = re.search(r'submitted to cluster (\d+)', result.stdout, re.IGNORECASE)
+        if not match:
+            logger.error(f"Cannot find the cluster of the duplicate of job {job.job_id}")
+            return False
+        job.speculative_condor_id = f"{match.group(1)}.0"
+        job.speculations += 1
+        logger.info(f"Duplicated straggler job {job.job_id}{elsewhere} "
+                    f"(condor {job.speculative_condor_id})")
+        return True
+
+    def _resolve_speculation(self, condor_statuses: Dict[str, int]) -> None:
+        """
+        Keep the first copy of each duplicated job to finish.
+
+        A copy has finished when it left the queue (or completed) and its
+        output and meta files exist.  The other copy is removed with
+        condor_rm; the outputs of a winning duplicate are renamed to the
+        job's output paths, so only one set of outputs remains.  A held
+        duplicate is removed and the original left running.
+        """
+        from speculative_execution import speculative_path
+
+        def _finished(condor_id: Optional[str], paths: List[str]) -> bool:
+            if condor_id and condor_statuses.get(condor_id) not in (None, 3, 4):
+                return False
+            return all(os.path.exists(p) and os.path.getsize(p) > 0 for p in paths)
+
+        def _remove(condor_id: Optional[str]) -> None:
+            if condor_id and condor_statuses.get(condor_id) not in (None, 3, 4):
+                subprocess.run(["condor_rm", condor_id], capture_output=True, text=True)
+
+        for job in self.jobs.values():
+            if not job.speculative_condor_id:
+                continue
+            outputs = [job.output_path, job.meta_output_path]
+            spec_outputs = [speculative_path(p) for p in outputs]
+            if condor_statuses.get(job.speculative_condor_id) == 5:
+                logger.warning(f"Duplicate of job {job.job_id} is held; removing it")
+                _remove(job.speculative_condor_id)
+                job.speculative_condor_id = None
+                continue
+            original_done = job.status in (JobStatus.COMPLETED, JobStatus.VALIDATED) or (
+                job.status != JobStatus.FAILED and _finished(job.condor_job_id, outputs))
+            if original_done:
+                _remove(job.speculative_condor_id)
+                for path in spec_outputs:
+                    if os.path.exists(path):
+                        os.remove(path)
+                job.speculation_winner = "original"
+            elif _finished(job.speculative_condor_id, spec_outputs):
+                _remove(job.condor_job_id)
+                for spec, path in zip(spec_outputs, outputs):
+                    os.replace(spec, path)
+                job.speculation_winner = "speculative"
+                job.condor_job_id = job.speculative_condor_id
+                job.status = JobStatus.COMPLETED
+                job.completion_time = time.time()
+            else:
+                continue
+            logger.info(f"Job {job.job_id}: the {job.speculation_winner} copy finished first")
+            job.speculative_condor_id = None
             
     def validate_outputs(self, job_ids: Optional[List[int]] = None) -> Dict[int, bool]:
         """
@@ -1463,7 +2030,8 @@ def main():
     )
     parser.add_argument(
         "command",
-        choices=["create", "submit", "status", "validate", "resubmit", "test", "create-test"],
+        choices=["create", "submit", "status", "validate", "resubmit", "speculate",
+                 "test", "create-test"],
         help="Command to execute"
     )
     parser.add_argument(
@@ -1508,6 +2076,47 @@ def main():
         action="store_true",
         help="Stage output files from worker nodes"
     )
+    parser.add_argument(
+        "--site-placement",
+        choices=["rank", "require"],
+        help="Prefer (rank) or restrict (require) HTCondor jobs to the sites "
+             "holding their input replicas"
+    )
+    parser.add_argument(
+        "--probe-sites",
+        action="store_true",
+        help="create: order each job's replica sites by the read speed "
+             "probed on its first file"
+    )
+    parser.add_argument(
+        "--dataset",
+        help="create: DAS name of the Rucio dataset to process"
+    )
+    parser.add_argument(
+        "--files-per-job",
+        type=int,
+        default=20,
+        help="create: maximum number of files per job (default: 20)"
+    )
+    parser.add_argument(
+        "--memory-model",
+        action="store_true",
+        help="Request per-job threads and memory from the booked histograms "
+             "and the peak RSS of finished jobs"
+    )
+    parser.add_argument(
+        "--cost-check",
+        action="store_true",
+        help="Dry-run a job config before submitting and refuse to submit "
+             "if it exceeds a costBudget* key of the config"
+    )
+    parser.add_argument(
+        "--slowdown",
+        type=float,
+        default=2.0,
+        help="speculate: duplicate running jobs slower than this many times "
+             "their predicted runtime (default: 2.0)"
+    )
     parser.add_argument(
         "--job-id",
         type=int,
@@ -1527,10 +2136,16 @@ def main():
     prod_config = ProductionConfig(
         name=args.name,
         work_dir=work_dir,
+        base_config=args.config or "",
+        output_dir=Path(args.output_dir) if args.output_dir else work_dir / "outputs",
         exe_path=Path(args.exe) if args.exe else None,
         stage_inputs=args.stage_inputs,
         stage_outputs=args.stage_outputs,
         x509=args.x509,
+        site_placement=args.site_placement or "",
+        probe_sites=args.probe_sites,
+        memory_model=args.memory_model,
+        cost_check=args.cost_check,
     )
     
     # Create manager
@@ -1538,9 +2153,12 @@ def main():
     
     # Execute command
     if args.command == "create":
-        logger.error("Create command requires custom implementation")
-        logger.error("Use 'law run GetRucioFileList' / 'law run SkimTask' to create productions.")
-        sys.exit(1)
+        if not args.dataset or not args.config:
+            logger.error("create requires --dataset and --config")
+            logger.error("Or use 'law run GetRucioFileList' / 'law run SkimTask' to create productions.")
+            sys.exit(1)
+        count = create_from_rucio(manager, args.dataset, args.files_per_job)
+        print(f"Created {count} jobs")
         
     elif args.command == "submit":
         count = manager.submit_jobs(dry_run=args.dry_run)
@@ -1559,6 +2177,13 @@ def main():
     elif args.command == "resubmit":
         count = manager.resubmit_failed()
         print(f"Resubmitted {count} failed jobs")
+
+    elif args.command == "speculate":
+        from speculative_execution import StragglerPolicy
+        manager.update_status()
+        duplicated = manager.speculate_stragglers(
+            StragglerPolicy(slowdown=args.slowdown), dry_run=args.dry_run)
+        print(f"Duplicated {len(duplicated)} straggler jobs: {duplicated}")
         
     elif args.command == "test":
         if args.job_id is None:
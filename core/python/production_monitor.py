@@ -11,7 +11,7 @@ import curses
 import sys
 import time
 from pathlib import Path
-from typing import Optional
+from typing import Callable, Dict, List, Optional
 
 from production_manager import ProductionManager, ProductionConfig, JobStatus
 
@@ -365,6 +365,176 @@ def monitor_simple(manager: ProductionManager, refresh_interval: int = 30, max_i
         print("\nMonitoring interrupted")
 
 
+def _float_entry(provenance: Dict[str, str], key: str) -> float:
+    """Numeric value of a provenance entry, or 0.0 when absent or malformed."""
+    try:
+        return float(provenance.get(key, 0.0))
+    except (TypeError, ValueError):
+        return 0.0
+
+
+def collect_job_performance(
+    manager: ProductionManager,
+    loader: Optional[Callable[[str], Dict[str, str]]] = None,
+) -> List[dict]:
+    """Read the performance provenance of every finished job.
+
+    Uses the ``timing.*``, ``throughput.*``, ``memory.*`` and ``io.*``
+    entries that ProvenanceService writes into each job's meta file.  Jobs
+    whose meta file cannot be read are skipped.
+
+    Args:
+        manager: ProductionManager whose completed/validated jobs are read
+        loader: Returns the provenance map of a meta file; defaults to
+            reproducibility_report.load_provenance_from_root
+
+    Returns:
+        One record per job with site, dataset, events, event-loop seconds,
+        bytes read, peak RSS, threads and slot load imbalance
+    """
+    if loader is None:
+        from reproducibility_report import load_provenance_from_root
+        loader = load_provenance_from_root
+
+    records = []
+    for job in manager.jobs.values():
+        if job.status not in (JobStatus.COMPLETED, JobStatus.VALIDATED):
+            continue
+        try:
+            provenance = loader(job.meta_output_path)
+        except Exception:
+            continue
+        if not provenance:
+            continue
+        records.append({
+            'job_id': job.job_id,
+            'site': provenance.get('env.site', 'unknown'),
+            'dataset': provenance.get('dataset.name', 'unknown'),
+            'events': int(_float_entry(provenance, 'throughput.events')),
+            'event_loop_s': _float_entry(provenance, 'timing.event_loop.wall_s'),
+            'bytes_read': int(_float_entry(provenance, 'io.bytes_read')),
+            'peak_rss_mb': _float_entry(provenance, 'memory.peak_rss_mb'),
+            'threads': int(_float_entry(provenance, 'executor.num_threads')),
+            'load_imbalance': _float_entry(provenance, 'executor.load_imbalance'),
+        })
+    return records
+
+
+def aggregate_throughput(records: List[dict], key: str) -> Dict[str, dict]:
+    """Aggregate job performance records per ``key`` ("site" or "dataset").
+
+    Throughput is total events over total event-loop time, so that long jobs
+    weigh more than short ones.
+    """
+    groups: Dict[str, dict] = {}
+    for record in records:
+        group = groups.setdefault(record.get(key, 'unknown'), {
+            'jobs': 0,
+            'events': 0,
+            'event_loop_s': 0.0,
+            'bytes_read': 0,
+            'max_peak_rss_mb': 0.0,
+            'mean_load_imbalance': 0.0,
+        })
+        group['jobs'] += 1
+        group['events'] += record['events']
+        group['event_loop_s'] += record['event_loop_s']
+        group['bytes_read'] += record['bytes_read']
+        group['max_peak_rss_mb'] = max(group['max_peak_rss_mb'], record['peak_rss_mb'])
+        group['mean_load_imbalance'] += record['load_imbalance']
+
+    for group in groups.values():
+        seconds = group['event_loop_s']
+        group['events_per_s'] = group['events'] / seconds if seconds > 0 else 0.0
+        group['read_mb_per_s'] = group['bytes_read'] / 1e6 / seconds if seconds > 0 else 0.0
+        group['mean_load_imbalance'] /= group['jobs']
+    return groups
+
+
+def print_throughput(manager: ProductionManager, key: str = 'site') -> None:
+    """Print the throughput of finished jobs aggregated per site or dataset."""
+    groups = aggregate_throughput(collect_job_performance(manager), key)
+    if not groups:
+        print("No performance provenance found in finished jobs")
+        return
+    print(f"{key:<30} {'jobs':>6} {'events':>12} {'events/s':>10} "
+          f"{'MB/s':>8} {'RSS MB':>8} {'imbal.':>7}")
+    print("-" * 87)
+    for name, group in sorted(groups.items(),
+                              key=lambda item: item[1]['events_per_s']):
+        print(f"{name:<30} {group['jobs']:>6} {group['events']:>12} "
+              f"{group['events_per_s']:>10.1f} {group['read_mb_per_s']:>8.1f} "
+              f"{group['max_peak_rss_mb']:>8.0f} {group['mean_load_imbalance']:>7.2f}")
+
+
+def read_live_metrics(metrics_dir: Path) -> List[dict]:
+    """Read the live metrics files (``metricsFile``, JSON) of running jobs.
+
+    Each record is the file's content plus ``job``, the file name without
+    extension.  Files that cannot be parsed (e.g. Prometheus output) are
+    skipped.
+    """
+    import json
+
+    records = []
+    for path in sorted(Path(metrics_dir).glob("*.json")):
+        try:
+            with open(path) as fh:
+                record = json.load(fh)
+        except (OSError, ValueError):
+            continue
+        record['job'] = path.stem
+        records.append(record)
+    return records
+
+
+def classify_live_job(record: dict, now: float, stall_seconds: float) -> str:
+    """Status of a job from its live metrics.
+
+    ``dead`` when the file has not been rewritten for *stall_seconds* (the
+    process is gone or hung), ``stalled`` when the event loop runs but no
+    entry was processed for *stall_seconds* (e.g. a blocked remote read),
+    otherwise the job's own state (setup, running or finished).
+    """
+    state = record.get('state', 'setup')
+    if state == 'finished':
+        return state
+    if now - float(record.get('timestamp', 0.0)) > stall_seconds:
+        return 'dead'
+    if state == 'running' and now - float(record.get('last_progress', 0.0)) > stall_seconds:
+        return 'stalled'
+    return state
+
+
+def print_live(metrics_dir: Path, stall_seconds: float = 600.0,
+               now: Optional[float] = None) -> int:
+    """Print the live throughput of every job; return the number of stalled or dead jobs."""
+    records = read_live_metrics(metrics_dir)
+    if not records:
+        print(f"No live metrics found in {metrics_dir}")
+        return 0
+    if now is None:
+        now = time.time()
+    print(f"{'job':<20} {'status':<9} {'entries':>12} {'events/s':>10} "
+          f"{'MB/s':>8} {'RSS MB':>8} {'idle':>7}  input")
+    print("-" * 100)
+    problems = 0
+    for record in records:
+        status = classify_live_job(record, now, stall_seconds)
+        problems += status in ('stalled', 'dead')
+        last = float(record.get('last_progress', 0.0))
+        idle = format_duration(now - last) if last > 0 else '-'
+        files = sorted({f for f in record.get('input_files', []) if f})
+        print(f"{record['job']:<20} {status:<9} {int(record.get('entries', 0)):>12} "
+              f"{float(record.get('events_per_s', 0.0)):>10.1f} "
+              f"{float(record.get('read_mb_per_s', 0.0)):>8.1f} "
+              f"{float(record.get('rss_mb', 0.0)):>8.0f} {idle:>7}  "
+              f"{', '.join(files)}")
+    if problems:
+        print(f"\n{problems} job(s) stalled or dead (no progress for {format_duration(stall_seconds)})")
+    return problems
+
+
 def list_productions(work_dir: Path = Path(".")):
     """List all productions in a directory"""
     print("Available productions:")
@@ -469,6 +639,46 @@ def main():
         help='Production work directory'
     )
     
+    # Throughput command
+    throughput_parser = subparsers.add_parser(
+        'throughput', help='Aggregate job throughput per site or dataset')
+    throughput_parser.add_argument(
+        '--name', '-n',
+        help='Production name'
+    )
+    throughput_parser.add_argument(
+        '--work-dir', '-w',
+        help='Production work directory'
+    )
+    throughput_parser.add_argument(
+        '--by',
+        choices=['site', 'dataset'],
+        default='site',
+        help='Aggregate per site or per dataset (default: site)'
+    )
+    
+    # Live command
+    live_parser = subparsers.add_parser(
+        'live', help='Show live throughput of running jobs and detect stalled ones')
+    live_parser.add_argument(
+        '--name', '-n',
+        help='Production name'
+    )
+    live_parser.add_argument(
+        '--work-dir', '-w',
+        help='Production work directory'
+    )
+    live_parser.add_argument(
+        '--metrics-dir',
+        help='Directory of the jobs\' metricsFile outputs (default: <work-dir>/metrics)'
+    )
+    live_parser.add_argument(
+        '--stall',
+        type=float,
+        default=600.0,
+        help='Seconds without progress after which a job is reported as stalled (default: 600)'
+    )
+    
     # Resubmit command
     resubmit_parser = subparsers.add_parser('resubmit', help='Resubmit failed jobs')
     resubmit_parser.add_argument(
@@ -566,6 +776,13 @@ def main():
         print(f"Validated {valid_count}/{len(results)} jobs successfully")
         manager.print_progress()
         
+    elif args.command == 'throughput':
+        print_throughput(manager, args.by)
+
+    elif args.command == 'live':
+        metrics_dir = Path(args.metrics_dir) if args.metrics_dir else work_dir / "metrics"
+        return 2 if print_live(metrics_dir, args.stall) else 0
+        
     elif args.command == 'resubmit':
         print("Resubmitting failed jobs...")
         count = manager.resubmit_failed(max_attempts=args.max_attempts)
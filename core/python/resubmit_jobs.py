@@ -17,6 +17,11 @@ Behavior:
 - Calls `condor_submit` on the per-job submit file so only that single process
   is queued.
 - Validates that job_<N>/submit_config.txt exists before submitting.
+- If job_<N>/submit_config.txt sets ``checkpointFile`` and that checkpoint
+  exists in the job directory (returned by an evicted or timed-out attempt),
+  it is added to transfer_input_files, with its directory when the path has
+  one, so the resubmitted job resumes from it instead of reprocessing the
+  entries it covers.
 
 This is non-destructive and intended for interactive use.
 """
@@ -80,6 +85,38 @@ def ensure_job_dir_has_submit_config(main_dir: str, job_index: int) -> bool:
     return os.path.exists(p)
 
 
+def find_job_checkpoint(main_dir: str, job_index: int) -> str | None:
+    """Return the path to transfer for the checkpoint left in job_<N>/, if any.
+
+    A checkpoint in a directory (``checkpoint/checkpoint.root``) is
+    transferred as that directory, so it lands at the configured path.
+    """
+    job_dir = os.path.join(main_dir, f'job_{job_index}')
+    checkpoint = None
+    with open(os.path.join(job_dir, 'submit_config.txt'), 'r') as f:
+        for line in f:
+            line = line.split('#', 1)[0].strip()
+            if '=' not in line:
+                continue
+            key, value = line.split('=', 1)
+            if key.strip() == 'checkpointFile':
+                checkpoint = value.strip()
+    if not checkpoint or os.path.isabs(checkpoint):
+        return None
+    if not os.path.exists(os.path.join(job_dir, checkpoint)):
+        return None
+    return os.path.join(job_dir, os.path.normpath(checkpoint).split(os.sep)[0])
+
+
+def add_transfer_input_file(submit: str, path: str) -> str:
+    """Append *path* to transfer_input_files, adding the command if absent."""
+    s, replaced = re.subn(r'(?m)^([ \t]*transfer_input_files\s*=.*?)[ \t]*$',
+                          lambda m: f'{m.group(1)}, {path}', submit, count=1)
+    if replaced:
+        return s
+    return re.sub(r'(?m)^([ \t]*queue\b)', f'transfer_input_files = {path}\n\\1', submit, count=1)
+
+
 def submit_temp_file(contents: str, dry_run: bool = False) -> int:
     fd, path = tempfile.mkstemp(prefix='condor_resubmit_', suffix='.sub')
     os.close(fd)
@@ -140,6 +177,10 @@ def main(argv: List[str] | None = None) -> int:
     rc_sum = 0
     for idx in job_indices:
         per_job = make_per_job_submit(template, idx, double_maxruntime=(not args.no_double_runtime))
+        checkpoint = find_job_checkpoint(submit_dir, idx)
+        if checkpoint:
+            print(f"job_{idx}: resuming from checkpoint {checkpoint}")
+            per_job = add_transfer_input_file(per_job, checkpoint)
         rc = submit_temp_file(per_job, dry_run=args.dry_run)
         rc_sum += (rc != 0)
 
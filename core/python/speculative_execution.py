@@ -0,0 +1,242 @@
+"""
+Speculative re-execution of straggler jobs.
+
+The last few jobs of a production often run far longer than their
+partition predicts: a slow or overloaded worker, a congested storage link,
+a site that keeps restarting pilots.  Waiting for them can double the wall
+time of the whole campaign.  Like speculative tasks in MapReduce, a
+straggler gets a duplicate at another site; whichever copy finishes first
+wins and the other is removed.
+
+- :class:`RuntimeModel` predicts the runtime of a running job.  A job with
+  a known entry range gets its events divided by the throughput measured
+  on finished jobs of its dataset (the ``throughput.events`` and
+  ``timing.event_loop.wall_s`` provenance read by
+  :func:`production_monitor.collect_job_performance`).  Other jobs get the
+  median wall time of the finished jobs of their dataset, or of all jobs.
+- :func:`find_stragglers` picks the running jobs that took more than
+  :attr:`StragglerPolicy.slowdown` times their prediction.  It only
+  considers jobs once most of the production is done
+  (:attr:`StragglerPolicy.tail_fraction`), slowest first, and duplicates at
+  most :attr:`StragglerPolicy.max_fraction` of the jobs at a time.
+- :func:`speculative_config` and :func:`speculative_submit` derive the
+  duplicate's job config and HTCondor submit file.  The duplicate writes
+  its outputs next to the original's with a ``.spec`` infix
+  (:func:`speculative_path`).  It must not run at the site of the
+  original.
+
+:meth:`production_manager.ProductionManager.speculate_stragglers` submits
+the duplicates.  :meth:`~production_manager.ProductionManager.update_status`
+keeps the first copy to finish: the outputs of a winning duplicate are
+renamed to the original paths, so exactly one output per job is left for
+validation and merging.
+
+Usage::
+
+    from speculative_execution import RuntimeModel, StragglerPolicy, find_stragglers
+
+    model = RuntimeModel.from_jobs(finished, records)
+    stragglers = find_stragglers(running, model, n_jobs=500, n_done=492)
+"""
+
+from __future__ import annotations
+
+import os
+import re
+import statistics
+from dataclasses import dataclass, field
+from typing import Dict, Iterable, List, Optional, Tuple
+
+#: Infix of the outputs of a speculative duplicate (``out_3.root`` →
+#: ``out_3.spec.root``).
+SPECULATIVE_INFIX = ".spec"
+
+#: Job config keys naming outputs; the duplicate writes them with the infix.
+OUTPUT_KEYS = ("saveFile", "metaFile", "__orig_saveFile", "__orig_metaFile")
+
+#: Directory below the job directory holding the duplicate's job config.
+SPECULATIVE_DIR = "speculative"
+
+
+@dataclass
+class StragglerPolicy:
+    """When a running job counts as a straggler."""
+
+    #: Elapsed time over predicted runtime above which a job is a straggler.
+    slowdown: float = 2.0
+    #: Jobs younger than this are never duplicated (start-up, staging).
+    min_elapsed_s: float = 900.0
+    #: Fraction of all jobs that must be finished before speculating.
+    tail_fraction: float = 0.9
+    #: Maximum fraction of all jobs with a running duplicate (at least one).
+    max_fraction: float = 0.02
+
+
+@dataclass
+class RunningJob:
+    """What the straggler search needs to know about a running job."""
+
+    job_id: int
+    elapsed_s: float
+    dataset: str = "unknown"
+    #: Entries the job processes, 0 when unknown.
+    events: int = 0
+
+
+@dataclass
+class RuntimeModel:
+    """Predicted runtimes from finished jobs of the same production."""
+
+    #: Dataset → measured events per event-loop second.
+    throughput: Dict[str, float] = field(default_factory=dict)
+    #: Dataset → wall seconds of its finished jobs.
+    wall_times: Dict[str, List[float]] = field(default_factory=dict)
+
+    @classmethod
+    def from_jobs(
+        cls,
+        finished: Iterable[Tuple[str, float]],
+        records: Iterable[dict] = (),
+    ) -> "RuntimeModel":
+        """Build the model.
+
+        Args:
+            finished: ``(dataset, wall seconds)`` of every finished job
+            records: Performance records of
+                :func:`production_monitor.collect_job_performance`
+        """
+        wall_times: Dict[str, List[float]] = {}
+        for dataset, seconds in finished:
+            if seconds > 0:
+                wall_times.setdefault(dataset, []).append(seconds)
+        events: Dict[str, float] = {}
+        seconds: Dict[str, float] = {}
+        for record in records:
+            if record.get('events', 0) > 0 and record.get('event_loop_s', 0.0) > 0:
+                dataset = record.get('dataset', 'unknown')
+                events[dataset] = events.get(dataset, 0.0) + record['events']
+                seconds[dataset] = seconds.get(dataset, 0.0) + record['event_loop_s']
+        throughput = {d: events[d] / seconds[d] for d in events}
+        return cls(throughput=throughput, wall_times=wall_times)
+
+    def predict(self, dataset: str, events: int = 0) -> Optional[float]:
+        """Predicted runtime in seconds, or ``None`` without any measurement."""
+        rate = self.throughput.get(dataset)
+        if events > 0 and rate:
+            return events / rate
+        if self.wall_times.get(dataset):
+            return statistics.median(self.wall_times[dataset])
+        all_times = [t for times in self.wall_times.values() for t in times]
+        return statistics.median(all_times) if all_times else None
+
+
+def find_stragglers(
+    running: Iterable[RunningJob],
+    model: RuntimeModel,
+    n_jobs: int,
+    n_done: int,
+    n_speculating: int = 0,
+    policy: Optional[StragglerPolicy] = None,
+) -> List[int]:
+    """Return the ids of the running jobs to duplicate, slowest first.
+
+    Args:
+        running: Running jobs without a duplicate
+        model: Runtime predictions
+        n_jobs: Jobs of the production
+        n_done: Finished jobs of the production
+        n_speculating: Jobs that already have a running duplicate
+        policy: Straggler thresholds; defaults to :class:`StragglerPolicy`
+    """
+    policy = policy or StragglerPolicy()
+    if n_jobs <= 0 or n_done < policy.tail_fraction * n_jobs:
+        return []
+    budget = max(1, int(policy.max_fraction * n_jobs)) - n_speculating
+    if budget <= 0:
+        return []
+
+    candidates = []
+    for job in running:
+        if job.elapsed_s < policy.min_elapsed_s:
+            continue
+        predicted = model.predict(job.dataset, job.events)
+        if predicted is None or predicted <= 0:
+            continue
+        ratio = job.elapsed_s / predicted
+        if ratio > policy.slowdown:
+            candidates.append((-ratio, job.job_id))
+    return [job_id for _, job_id in sorted(candidates)[:budget]]
+
+
+def speculative_path(path: str) -> str:
+    """Output path of the duplicate: the infix before the extension."""
+    base, ext = os.path.splitext(path)
+    return f"{base}{SPECULATIVE_INFIX}{ext}"
+
+
+def speculative_config(text: str) -> str:
+    """Job config of the duplicate: the :data:`OUTPUT_KEYS` get the infix.
+
+    Works on the text, so lines that ``read_config`` cannot parse survive.
+    """
+    def _rewrite(match: re.Match) -> str:
+        return f"{match.group(1)}{speculative_path(match.group(2))}"
+
+    pattern = r'(?m)^(\s*(?:' + '|'.join(map(re.escape, OUTPUT_KEYS)) + r')\s*=\s*)(\S+?)\s*$'
+    return re.sub(pattern, _rewrite, text)
+
+
+def speculative_submit(
+    template: str,
+    job_index: int,
+    config_file: str = "job_config.txt",
+    exclude_site: Optional[str] = None,
+    request_cpus: Optional[int] = None,
+    request_memory_mb: Optional[int] = None,
+) -> str:
+    """HTCondor submit file queueing one duplicate of job *job_index*.
+
+    *template* is the production's ``condor_submit.sub``.  Its queue
+    statements (and their per-job requirements, rank and requests) are
+    replaced by one ``queue 1``; the job config comes from
+    ``job_<N>/speculative/``.  The duplicate may run anywhere except at
+    *exclude_site*, the site of the original; replica-site restrictions are
+    dropped so it can reach another site.
+    """
+    s = template.replace('job_$(Process)/', f'job_{job_index}/')
+    s = s.replace('$(Process)', str(job_index))
+    s = s.replace(f'job_{job_index}/{config_file}',
+                  f'job_{job_index}/{SPECULATIVE_DIR}/{config_file}')
+
+    requirements = None
+    kept = []
+    for line in s.splitlines():
+        stripped = line.strip()
+        if re.match(r'(?i)requirements\s*=', stripped):
+            if requirements is None:
+                requirements = stripped.split('=', 1)[1].strip()
+            continue
+        if re.match(r'(?i)(rank\s*=|queue\b)', stripped):
+            continue
+        if re.match(r'\+Request(Cpus|Memory)\s*=', stripped) and (
+                request_cpus if 'Cpus' in stripped else request_memory_mb):
+            continue
+        kept.append(line)
+
+    if requirements:
+        # The site whitelist may be any term, the first one included.
+        site_list = r'stringListMember\(TARGET\.GLIDEIN_CMSSite,[^)]*\)'
+        requirements = re.sub(r'\s*&&\s*' + site_list, '', requirements)
+        requirements = re.sub(site_list + r'\s*&&\s*', '', requirements)
+        requirements = re.sub(site_list, '', requirements).strip() or None
+    if exclude_site:
+        veto = f'(TARGET.GLIDEIN_CMSSite =!= "{exclude_site}")'
+        requirements = f"{requirements} && {veto}" if requirements else veto
+    if requirements:
+        kept.append(f"requirements = {requirements}")
+    if request_cpus:
+        kept.append(f"+RequestCpus={request_cpus}")
+    if request_memory_mb:
+        kept.append(f"+RequestMemory={request_memory_mb}")
+    kept.append("queue 1")
+    return "\n".join(kept) + "\n"
@@ -1144,6 +1144,24 @@ if not xrd_files:
 # Merge compile-time blacklist with runtime xrdBlacklist from config.
 runtime_bl = [s.strip() for s in cfg.get("xrdBlacklist", "").split(",") if s.strip()]
 blacklist = list(STATIC_BLACKLIST) + runtime_bl
+
+# Sites the event loop of an earlier attempt flagged as slow (DataManager's
+# slow-site report) are avoided on resubmission.
+_slow_report_file = cfg.get("slowSiteReport", "") or "slow_sites.json"
+if os.path.exists(_slow_report_file):
+    try:
+        import json as _slow_json
+        with open(_slow_report_file) as _slow_fh:
+            _slow_sites = _slow_json.load(_slow_fh).get("slow_sites", [])
+        for _slow_site in _slow_sites:
+            _slow_host = re.sub(r"^root://", "", _slow_site).rstrip("/")
+            if _slow_host and _slow_host not in blacklist:
+                blacklist.append(_slow_host)
+        if _slow_sites:
+            print(f"[xrd-opt] Avoiding {{len(_slow_sites)}} slow site(s) from {{_slow_report_file}}")
+    except Exception as _slow_exc:
+        print(f"[xrd-opt] Warning: could not read {{_slow_report_file}}: {{_slow_exc}}")
+
 if blacklist:
     print(f"[xrd-opt] Blacklisted sites/patterns: {{blacklist}}")
 
@@ -1419,6 +1437,11 @@ def generate_condor_submit(
     shared_archive_name=None,
     config_file="submit_config.txt",
     container_image="",
+    job_sites=None,
+    site_placement="rank",
+    job_resources=None,
+    output_remaps=None,
+    checkpoint_dir=None,
 ):
     Path(main_dir + "/condor_logs").mkdir(parents=True, exist_ok=True)
     transfer_files = [
@@ -1458,11 +1481,39 @@ def generate_condor_submit(
     log_name = "log_$(Cluster).log"
     want_os_block = f'MY.WantOS = "{want_os}"\n' if want_os else ""
     container_block = f'MY.SingularityImage = "{container_image}"\n' if container_image else ""
-    requirements_block = (
-        'requirements = (TARGET.Arch =?= "X86_64") && '
+    requirements = (
+        '(TARGET.Arch =?= "X86_64") && '
         '((TARGET.Microarch =!= UNDEFINED && regexp("^x86_64-v([2-9]|[1-9][0-9]+)$", TARGET.Microarch)) '
-        '|| (TARGET.Has_sse4_1 =?= True && TARGET.Has_sse4_2 =?= True && TARGET.has_ssse3 =?= True))\n'
+        '|| (TARGET.Has_sse4_1 =?= True && TARGET.Has_sse4_2 =?= True && TARGET.has_ssse3 =?= True))'
     )
+    # Placement and resources may differ per job: every queue statement
+    # then sets its own requirements, rank and requests.
+    requirements_block = "" if job_sites else f"requirements = {requirements}\n"
+    if job_sites or job_resources:
+        job_commands = [[] for _ in range(int(jobs))]
+        for commands, sites in zip(job_commands, job_sites or []):
+            commands.extend(site_commands(sites or [], requirements, site_placement))
+        for commands, (cpus, memory) in zip(job_commands, job_resources or []):
+            commands.extend([f"+RequestCpus={cpus}", f"+RequestMemory={memory}"])
+        queue_block = queue_blocks(job_commands)
+    else:
+        queue_block = f"queue {jobs}\n"
+
+    # Files the job writes in its scratch directory, returned next to the
+    # config and moved to their submit-host path.
+    output_remaps = dict(output_remaps or {})
+    when_to_transfer = "On_Exit"
+    if checkpoint_dir:
+        # The checkpoint directory (checkpointFile, see CheckpointService) is
+        # also returned when the job is evicted, into its job directory,
+        # where resubmit_jobs.py picks it up.
+        output_remaps[checkpoint_dir] = f"{main_dir}/job_$(Process)/{checkpoint_dir}"
+        when_to_transfer = "ON_EXIT_OR_EVICT"
+    output_files = [config_file] + list(output_remaps)
+    remap_block = ""
+    if output_remaps:
+        remaps = "; ".join(f"{name} = {path}" for name, path in output_remaps.items())
+        remap_block = f'transfer_output_remaps = "{remaps}"\n'
 
     submit_file = f"""universe = vanilla
 Executable     =  {main_dir}/condor_runscript.sh
@@ -1476,17 +1527,68 @@ environment = "CONDOR_PROC=$(Process) CONDOR_CLUSTER=$(Cluster)"
 +RequestDisk={request_disk}
 +MaxRuntime={max_runtime}
 max_transfer_input_mb = 10000
-WhenToTransferOutput=On_Exit
-transfer_output_files = {config_file}
-
+WhenToTransferOutput={when_to_transfer}
+transfer_output_files = {",".join(output_files)}
+{remap_block}
 Output     = {main_dir}/condor_logs/log_$(Cluster)_$(Process).stdout
 Error      = {main_dir}/condor_logs/log_$(Cluster)_$(Process).stderr
 Log        = {main_dir}/condor_logs/{log_name}
-queue {jobs}
-"""
+{queue_block}"""
     return submit_file
 
 
+def site_commands(sites, requirements, site_placement="rank"):
+    """Return the submit commands steering one job towards its replica sites.
+
+    *sites* are the sites holding the job's input files, best first.  With
+    ``site_placement="rank"`` matching slots are preferred in that order
+    (``rank`` on ``GLIDEIN_CMSSite``); with ``"require"`` the job may only
+    run at those sites.  A job without sites runs anywhere.
+    """
+    if site_placement not in ("rank", "require"):
+        raise ValueError(
+            f"Unknown site placement {site_placement!r}; expected 'rank' or 'require'"
+        )
+    job_requirements = requirements
+    rank = "0"
+    if sites:
+        for weight, site in enumerate(reversed(sites), start=1):
+            rank = f'ifThenElse(TARGET.GLIDEIN_CMSSite =?= "{site}", {weight}, {rank})'
+        if site_placement == "require":
+            site_list = ",".join(sites)
+            job_requirements = (
+                f'{requirements} && stringListMember(TARGET.GLIDEIN_CMSSite, "{site_list}")'
+            )
+    return [f"requirements = {job_requirements}", f"rank = {rank}"]
+
+
+def queue_blocks(job_commands):
+    """Return queue statements giving each process its own submit commands.
+
+    *job_commands* lists, per process, the commands to set before queueing
+    it.  Consecutive processes with the same commands share one ``queue``
+    statement; every statement repeats all of its commands, since submit
+    commands carry over to later statements.
+    """
+    blocks = []
+    i = 0
+    while i < len(job_commands):
+        commands = list(job_commands[i])
+        count = 1
+        while i + count < len(job_commands) and list(job_commands[i + count]) == commands:
+            count += 1
+        blocks.append("".join(f"{c}\n" for c in commands) + f"queue {count}\n")
+        i += count
+    return "".join(blocks)
+
+
+def site_queue_blocks(job_sites, requirements, site_placement="rank"):
+    """Return queue statements steering each process towards its sites."""
+    return queue_blocks(
+        [site_commands(sites or [], requirements, site_placement) for sites in job_sites]
+    )
+
+
 def write_submit_files(
     main_dir,
     jobs,
@@ -1512,6 +1614,11 @@ def write_submit_files(
     python_env_tarball=None,
     shared_archive_name=None,
     runtime_config_relpath=None,
+    job_sites=None,
+    site_placement="rank",
+    job_resources=None,
+    output_remaps=None,
+    checkpoint_dir=None,
 ):
     submit_path = os.path.join(main_dir, "condor_submit.sub")
     runscript_path = os.path.join(main_dir, "condor_runscript.sh")
@@ -1567,6 +1674,11 @@ def write_submit_files(
                 shared_archive_name=shared_archive_name,
                 config_file=config_file,
                 container_image=(container_setup or "").strip(),
+                job_sites=job_sites,
+                site_placement=site_placement,
+                job_resources=job_resources,
+                output_remaps=output_remaps,
+                checkpoint_dir=checkpoint_dir,
             )
         )
     return submit_path
\ No newline at end of file
@@ -0,0 +1,340 @@
+"""
+Tagger efficiency maps from the fraction histograms of TaggerWorkingPointManager.
+
+``TaggerWorkingPointManager::defineFractionHistograms`` (or a
+``type=fraction_histograms`` block in the tagger config) books, for every
+(pT, |η|, flavour) bin, a histogram of the per-object WP category under
+``tagger_fractions/<prefix>_cat_pt<I>_eta<J>[_<flavour>]`` in the meta ROOT
+output, together with an empty ``<prefix>_binning`` TH2D whose axes carry the
+pT and |η| bin edges.  Because the histograms can be filled in the same event
+loop as the analysis, the maps of one production are available to the next
+one without a dedicated pre-processing pass.
+
+This module turns those histograms into a correctionlib JSON payload with two
+corrections:
+
+* ``<prefix>_fractions`` – inputs ``(pt, eta[, flavour], category)``: the MC
+  fraction of objects in each WP category, as consumed by
+  ``TaggerWorkingPointManager::setFractionCorrection``.
+* ``<prefix>_efficiency`` – inputs ``(pt, eta[, flavour], working_point)``:
+  the MC efficiency to pass working point ``working_point`` (1 = loosest),
+  i.e. the fraction of objects with category ≥ ``working_point``, as used for
+  the efficiency columns of ``defineFixedWorkingPointWeight``.
+
+The η axis of the payload is mirrored from the |η| binning so the signed η
+column can be passed directly.  Bins without MC objects evaluate to 1.0, which
+leaves weights that divide by or multiply with them unchanged.
+
+Usage
+-----
+From the command line::
+
+    python tagger_efficiency_maps.py merged_meta.root --prefix deepjet_frac \\
+        --output tagger_maps/deepjet_frac.json
+
+Programmatically::
+
+    from tagger_efficiency_maps import read_category_counts, build_payload
+
+    counts = read_category_counts("merged_meta.root", "deepjet_frac")
+    payload = build_payload(counts)
+"""
+
+from __future__ import annotations
+
+import argparse
+import json
+import os
+import sys
+from dataclasses import dataclass
+from typing import Any, Dict, List, Optional, Sequence
+
+#: ROOT directory the fraction histograms are written to.
+FRACTION_DIRECTORY = "tagger_fractions"
+
+#: Flavour labels of the histograms and the hadron flavour they stand for
+#: (``None`` = any other flavour).
+FLAVOUR_CODES = {"b": 5, "c": 4, "light": None}
+
+
+@dataclass
+class CategoryCounts:
+    """WP-category counts of one fraction-histogram configuration.
+
+    Attributes
+    ----------
+    prefix : str
+        Output prefix passed to ``defineFractionHistograms``.
+    pt_edges, abseta_edges : list[float]
+        Bin edges of the pT and |η| axes.
+    flavours : list[str]
+        ``["b", "c", "light"]`` when the maps are split by flavour, ``[""]``
+        otherwise.
+    counts : list
+        ``counts[iPt][iEta][iFl][category]`` object counts.
+    """
+
+    prefix: str
+    pt_edges: List[float]
+    abseta_edges: List[float]
+    flavours: List[str]
+    counts: List[List[List[List[float]]]]
+
+    @property
+    def n_categories(self) -> int:
+        """Number of WP categories (working points + 1)."""
+        return len(self.counts[0][0][0])
+
+
+def _category_hist_name(prefix: str, i_pt: int, i_eta: int, flavour: str) -> str:
+    name = f"{prefix}_cat_pt{i_pt}_eta{i_eta}"
+    return f"{name}_{flavour}" if flavour else name
+
+
+def read_category_counts(meta_root_paths: Sequence[str] | str, prefix: str) -> CategoryCounts:
+    """Read and sum the WP-category histograms of *prefix*.
+
+    Parameters
+    ----------
+    meta_root_paths : str or sequence of str
+        Meta ROOT file(s) holding the ``tagger_fractions`` directory; the
+        counts of all files are summed.
+    prefix : str
+        Output prefix of the fraction-histogram configuration.
+
+    Raises
+    ------
+    FileNotFoundError
+        If a file does not exist.
+    KeyError
+        If a file has no ``<prefix>_binning`` histogram.
+    """
+    if isinstance(meta_root_paths, str):
+        meta_root_paths = [meta_root_paths]
+
+    try:
+        import uproot  # type: ignore[import]
+    except ImportError as exc:
+        raise ImportError(
+            "uproot is required to read ROOT meta files.  "
+            "Install it with: pip install uproot"
+        ) from exc
+
+    result: Optional[CategoryCounts] = None
+    for path in meta_root_paths:
+        if not os.path.isfile(path):
+            raise FileNotFoundError(f"ROOT meta file not found: {path!r}")
+        with uproot.open(path) as root_file:
+            binning_key = f"{FRACTION_DIRECTORY}/{prefix}_binning"
+            if binning_key not in root_file:
+                raise KeyError(f"{binning_key!r} not found in {path!r}")
+            binning = root_file[binning_key]
+            pt_edges = [float(e) for e in binning.axis(0).edges()]
+            eta_edges = [float(e) for e in binning.axis(1).edges()]
+            split = f"{FRACTION_DIRECTORY}/{_category_hist_name(prefix, 0, 0, 'b')}" in root_file
+            flavours = list(FLAVOUR_CODES) if split else [""]
+
+            counts = []
+            for i_pt in range(len(pt_edges) - 1):
+                row = []
+                for i_eta in range(len(eta_edges) - 1):
+                    cell = []
+                    for flavour in flavours:
+                        key = (
+                            f"{FRACTION_DIRECTORY}/"
+                            f"{_category_hist_name(prefix, i_pt, i_eta, flavour)}"
+                        )
+                        cell.append([float(v) for v in root_file[key].values()])
+                    row.append(cell)
+                counts.append(row)
+
+        current = CategoryCounts(prefix, pt_edges, eta_edges, flavours, counts)
+        if result is None:
+            result = current
+        else:
+            _accumulate(result, current)
+
+    if result is None:
+        raise ValueError("read_category_counts: no input files given")
+    return result
+
+
+def _accumulate(total: CategoryCounts, other: CategoryCounts) -> None:
+    if (total.pt_edges != other.pt_edges or total.abseta_edges != other.abseta_edges
+            or total.flavours != other.flavours):
+        raise ValueError(
+            f"Fraction histograms of prefix {total.prefix!r} have different "
+            "binnings in the input files"
+        )
+    for row_t, row_o in zip(total.counts, other.counts):
+        for cell_t, cell_o in zip(row_t, row_o):
+            for fl_t, fl_o in zip(cell_t, cell_o):
+                for k, v in enumerate(fl_o):
+                    fl_t[k] += v
+
+
+# ---------------------------------------------------------------------------
+# Payload construction
+# ---------------------------------------------------------------------------
+
+
+def _fractions(category_counts: List[float]) -> List[float]:
+    total = sum(category_counts)
+    if total <= 0.0:
+        return [1.0] * len(category_counts)
+    return [c / total for c in category_counts]
+
+
+def _efficiencies(category_counts: List[float]) -> List[float]:
+    """Efficiency of working points 1..N: fraction with category ≥ wp."""
+    total = sum(category_counts)
+    n_wp = len(category_counts) - 1
+    if total <= 0.0:
+        return [1.0] * n_wp
+    return [sum(category_counts[wp:]) / total for wp in range(1, n_wp + 1)]
+
+
+def _signed_eta_edges(abseta_edges: List[float]) -> List[float]:
+    negative = [-e for e in reversed(abseta_edges) if e > 0.0]
+    return negative + abseta_edges
+
+
+def _eta_content(per_abseta: List[Any], abseta_edges: List[float]) -> List[Any]:
+    """Mirror per-|η| contents onto the signed η binning."""
+    mirrored = list(reversed(per_abseta))
+    if abseta_edges[0] > 0.0:
+        # The gap (-first, first) between the two halves gets the first bin.
+        return mirrored + [per_abseta[0]] + per_abseta
+    return mirrored + per_abseta
+
+
+def _leaf(values: List[float], input_name: str, first_key: int) -> Dict[str, Any]:
+    return {
+        "nodetype": "category",
+        "input": input_name,
+        "content": [{"key": first_key + k, "value": v} for k, v in enumerate(values)],
+    }
+
+
+def _build_correction(
+    counts: CategoryCounts,
+    name: str,
+    description: str,
+    last_input: Dict[str, str],
+    leaf_values,
+    first_key: int,
+) -> Dict[str, Any]:
+    split = counts.flavours != [""]
+
+    def flavour_node(cell: List[List[float]]) -> Dict[str, Any]:
+        leaves = {fl: _leaf(leaf_values(c), last_input["name"], first_key)
+                  for fl, c in zip(counts.flavours, cell)}
+        if not split:
+            return leaves[""]
+        return {
+            "nodetype": "category",
+            "input": "flavour",
+            "content": [
+                {"key": code, "value": leaves[label]}
+                for label, code in FLAVOUR_CODES.items() if code is not None
+            ],
+            "default": leaves["light"],
+        }
+
+    pt_content = []
+    for row in counts.counts:
+        per_abseta = [flavour_node(cell) for cell in row]
+        pt_content.append({
+            "nodetype": "binning",
+            "input": "eta",
+            "edges": _signed_eta_edges(counts.abseta_edges),
+            "content": _eta_content(per_abseta, counts.abseta_edges),
+            "flow": "clamp",
+        })
+
+    inputs = [
+        {"name": "pt", "type": "real", "description": "Object pT"},
+        {"name": "eta", "type": "real", "description": "Object eta"},
+    ]
+    if split:
+        inputs.append({"name": "flavour", "type": "int",
+                       "description": "Hadron flavour (5 = b, 4 = c, other = light)"})
+    inputs.append(last_input)
+
+    return {
+        "name": name,
+        "description": description,
+        "version": 1,
+        "inputs": inputs,
+        "output": {"name": "value", "type": "real"},
+        "data": {
+            "nodetype": "binning",
+            "input": "pt",
+            "edges": counts.pt_edges,
+            "content": pt_content,
+            "flow": "clamp",
+        },
+    }
+
+
+def build_payload(counts: CategoryCounts) -> Dict[str, Any]:
+    """Return the correctionlib CorrectionSet (schema v2) for *counts*."""
+    fractions = _build_correction(
+        counts,
+        f"{counts.prefix}_fractions",
+        "MC fraction of objects per WP category",
+        {"name": "category", "type": "int",
+         "description": "WP category (0 = fail all, N = pass all)"},
+        _fractions,
+        0,
+    )
+    efficiency = _build_correction(
+        counts,
+        f"{counts.prefix}_efficiency",
+        "MC efficiency to pass a working point",
+        {"name": "working_point", "type": "int",
+         "description": "Working point index (1 = loosest)"},
+        _efficiencies,
+        1,
+    )
+    return {"schema_version": 2, "corrections": [fractions, efficiency]}
+
+
+def write_payload(
+    meta_root_paths: Sequence[str] | str, prefix: str, output_path: str
+) -> str:
+    """Read the maps of *prefix* and write the payload to *output_path*."""
+    payload = build_payload(read_category_counts(meta_root_paths, prefix))
+    out_dir = os.path.dirname(output_path)
+    if out_dir:
+        os.makedirs(out_dir, exist_ok=True)
+    with open(output_path, "w") as fh:
+        json.dump(payload, fh, indent=1)
+    return output_path
+
+
+def main(argv: Optional[List[str]] = None) -> int:
+    """Command-line entrypoint: build the payload of one prefix."""
+    parser = argparse.ArgumentParser(
+        description="Build tagger efficiency maps from fraction histograms.",
+    )
+    parser.add_argument("root_files", nargs="+", metavar="META_ROOT_FILE",
+                        help="Meta ROOT file(s) with the tagger_fractions directory.")
+    parser.add_argument("--prefix", required=True,
+                        help="Output prefix passed to defineFractionHistograms.")
+    parser.add_argument("--output", default="",
+                        help="Output JSON path (default: <prefix>.json).")
+    args = parser.parse_args(argv)
+
+    try:
+        path = write_payload(args.root_files, args.prefix,
+                             args.output or f"{args.prefix}.json")
+    except (OSError, KeyError, ValueError, ImportError) as exc:
+        print(f"tagger_efficiency_maps: {exc}", file=sys.stderr)
+        return 1
+    print(path)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
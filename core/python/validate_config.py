@@ -1,5 +1,9 @@
 import argparse
+import json
 import os
+import shutil
+import subprocess
+import tempfile
 from pathlib import Path
 from typing import Any, Dict, List, Optional, Tuple
 
@@ -1126,6 +1130,119 @@ def validate_submit_config(config_path: str, mode: str = "auto"):
     return errors, warnings
 
 
+def _find_config_compiler() -> Optional[str]:
+    """Return the path to the ``rdfconfig`` binary, or ``None``.
+
+    Searches the build tree (``build/core/tools/rdfconfig``) and the PATH.
+    """
+    workspace = os.path.abspath(os.path.join(os.path.dirname(__file__), "..", ".."))
+    candidate = os.path.join(workspace, "build", "core", "tools", "rdfconfig")
+    if os.path.isfile(candidate) and os.access(candidate, os.X_OK):
+        return candidate
+    return shutil.which("rdfconfig")
+
+
+def compile_config(config_path: str, output_path: str) -> None:
+    """Compile *config_path* and its sub-configs into *output_path*.
+
+    Runs ``rdfconfig``, which writes the binary compiled config (``.rdfcfg``)
+    that jobs read instead of the text and YAML sources.
+
+    Raises
+    ------
+    ValidationError
+        If ``rdfconfig`` is not built or fails.
+    """
+    tool = _find_config_compiler()
+    if tool is None:
+        raise ValidationError(
+            "rdfconfig not found (build core/tools or add it to the PATH)"
+        )
+    result = subprocess.run(
+        [tool, "-o", output_path, config_path], capture_output=True, text=True
+    )
+    if result.returncode != 0:
+        raise ValidationError(
+            f"rdfconfig failed (exit {result.returncode}): {result.stderr.strip()}"
+        )
+    print(result.stdout.strip())
+
+
+def dry_run_config(executable: str, config_path: str) -> Dict[str, Any]:
+    """Book the graph of *config_path* with *executable* without running it.
+
+    Runs the analysis executable on a copy of the config with ``dryRun=true``
+    (written beside it in the same format, key=value text or YAML, so that
+    relative paths resolve alike) and returns the JSON cost report of
+    ``Analyzer::estimateCost()``: defined columns, JIT expressions, histogram
+    cells and memory, ML models, and a ``warnings`` entry for every
+    ``costBudget*`` key of the config exceeded.
+
+    Raises
+    ------
+    ValidationError
+        If the config cannot be read, or the executable fails or writes no
+        report.
+    """
+    is_yaml = config_path.endswith((".yaml", ".yml"))
+    directory = os.path.dirname(os.path.abspath(config_path))
+    with tempfile.TemporaryDirectory() as tmp:
+        report_path = os.path.join(tmp, "cost.json")
+        # Keys may appear only once; the dry-run keys are replaced.
+        if is_yaml:
+            try:
+                with open(config_path) as f:
+                    data = yaml.safe_load(f) or {}
+            except yaml.YAMLError as exc:
+                raise ValidationError(f"cannot parse {config_path}: {exc}") from exc
+            if not isinstance(data, dict):
+                raise ValidationError(f"{config_path} is not a YAML mapping")
+            data["dryRun"] = "true"
+            data["dryRunReport"] = report_path
+            content = yaml.safe_dump(data, default_flow_style=False, sort_keys=False)
+        else:
+            with open(config_path) as f:
+                lines = [
+                    line for line in f
+                    if line.split("=", 1)[0].strip() not in ("dryRun", "dryRunReport")
+                ]
+            content = ("".join(lines).rstrip("\n") + "\n"
+                       + f"dryRun=true\ndryRunReport={report_path}\n")
+        suffix = os.path.splitext(config_path)[1] if is_yaml else ".txt"
+        with tempfile.NamedTemporaryFile(
+            "w", dir=directory, prefix=".dryrun_", suffix=suffix, delete=False
+        ) as f:
+            f.write(content)
+            dry_config = f.name
+        try:
+            result = subprocess.run(
+                [executable, dry_config], capture_output=True, text=True
+            )
+        finally:
+            os.remove(dry_config)
+        if result.returncode != 0:
+            raise ValidationError(
+                f"dry run failed (exit {result.returncode}): {result.stderr.strip()}"
+            )
+        if not os.path.isfile(report_path):
+            raise ValidationError(
+                f"dry run of {executable} wrote no cost report (dryRun unsupported?)"
+            )
+        with open(report_path) as f:
+            return json.load(f)
+
+
+def format_cost_report(report: Dict[str, Any]) -> str:
+    """One-line summary of a :func:`dry_run_config` report."""
+    return (
+        f"{report['defined_columns']} defined columns, "
+        f"{report['jit_compiled']}/{report['jit_expressions']} expressions JIT-compiled, "
+        f"{len(report['histograms'])} histograms with {report['histogram_cells']} cells, "
+        f"{report['histogram_bytes'] / 1e6:.1f} MB of histograms in {report['slots']} slots, "
+        f"{report['models']} ML models"
+    )
+
+
 def main():
     parser = argparse.ArgumentParser(
         "Validate submission, sample, and analysis configs"
@@ -1143,6 +1260,19 @@ def main():
         default="auto",
         help="Validation mode for submit config (auto detects from sample config)",
     )
+    parser.add_argument(
+        "--compile",
+        metavar="OUTPUT",
+        help="After a successful validation, compile the config and its "
+             "sub-configs into OUTPUT (.rdfcfg) with rdfconfig",
+    )
+    parser.add_argument(
+        "--dry-run",
+        metavar="EXE",
+        help="After a successful validation, book the graph of the submit "
+             "config with the analysis executable EXE without running it and "
+             "fail if a costBudget* key of the config is exceeded",
+    )
     args = parser.parse_args()
 
     try:
@@ -1167,6 +1297,29 @@ def main():
 
     print("Config validation OK")
 
+    if args.compile:
+        try:
+            compile_config(args.analysis_config or args.config, args.compile)
+        except ValidationError as exc:
+            print(str(exc))
+            raise SystemExit(1)
+
+    if args.dry_run:
+        if not args.config:
+            print("--dry-run needs a submit config (--config)")
+            raise SystemExit(1)
+        try:
+            report = dry_run_config(args.dry_run, args.config)
+        except ValidationError as exc:
+            print(str(exc))
+            raise SystemExit(1)
+        print(f"Dry run: {format_cost_report(report)}")
+        if report["warnings"]:
+            print("Cost budgets exceeded:")
+            for w in report["warnings"]:
+                print(f"- {w}")
+            raise SystemExit(1)
+
 
 if __name__ == "__main__":
     main()
@@ -512,6 +512,61 @@ class VariationOrchestrator:
             weight_variations=weight_variations,
         )
 
+    def write_booking_plan(
+        self,
+        path: str,
+        processes: Sequence[str],
+        regions: Sequence[str],
+        output_usages: Sequence[str] = ("histogram",),
+    ) -> Dict[str, List[str]]:
+        """Write the systematics each region needs as a ``histogramVariationPlan``.
+
+        ``NDHistogramManager`` reads the file (config key
+        ``histogramVariationPlan``) and, in region-aware bookings, fills a
+        variation only in the regions whose line lists its systematic;
+        Nominal is always filled.  One line is written per region::
+
+            region=signal_region systematics=Nominal,JES,JER,btag
+
+        Parameters
+        ----------
+        path : str
+            Output file.
+        processes : sequence of str
+            Processes filled by the job; a region keeps the union of their
+            plans.
+        regions : sequence of str
+            Region names as declared to the ``RegionManager``.  Regions the
+            file does not list keep every variation.
+        output_usages : sequence of str
+            Downstream uses the histograms serve; a variation is kept when
+            any of them consumes it.
+
+        Returns
+        -------
+        dict
+            Region name to the systematic names written for it.
+        """
+        plan: Dict[str, List[str]] = {}
+        for region in regions:
+            names: List[str] = []
+            for process in processes:
+                for usage in output_usages:
+                    context = self.get_variation_plan(process, region, usage)
+                    for name in (
+                        context.systematic_variation_names()
+                        + context.weight_variation_names()
+                    ):
+                        if name not in names:
+                            names.append(name)
+            plan[region] = names
+        with open(path, "w", encoding="utf-8") as handle:
+            for region, names in plan.items():
+                handle.write(
+                    f"region={region} systematics={','.join(['Nominal'] + names)}\n"
+                )
+        return plan
+
     # ------------------------------------------------------------------ validation
 
     def validate_coverage(
@@ -224,6 +224,21 @@ def _redirector_host(redirector: str) -> str:
     return m.group(1) if m else redirector
 
 
+def redirector_site(redirector: str) -> str:
+    """Return the CMS site served by a site-specific redirector, or ``""``.
+
+    Site-specific redirectors are the ones built from Rucio replica states
+    (see :func:`rucio_discovery.query_rucio`).
+
+    >>> redirector_site("root://xrootd-cms.infn.it//store/test/xrootd/T2_DE_DESY/")
+    'T2_DE_DESY'
+    >>> redirector_site("root://cmsxrootd.fnal.gov/")
+    ''
+    """
+    m = re.search(r"/store/test/xrootd/([^/]+)", redirector)
+    return m.group(1) if m else ""
+
+
 def _is_blacklisted(redirector: str, blacklisted_sites: list[str]) -> bool:
     """Return ``True`` when *redirector* matches any entry in *blacklisted_sites*.
 
@@ -0,0 +1,142 @@
+#include <AllocationTracker.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+std::atomic<bool> trackingEnabled{false};
+
+/// Constant-initialized, so usable from operator new on any thread at any
+/// time, including before the thread's dynamic TLS initialization.
+thread_local AllocationTracker::Counts threadCounters;
+
+#ifdef HAS_ALLOCATION_TRACKING
+
+void *allocate(std::size_t size) {
+  if (size == 0) {
+    size = 1;
+  }
+  for (;;) {
+    if (void *ptr = std::malloc(size)) {
+      AllocationTracker::record(size);
+      return ptr;
+    }
+    std::new_handler handler = std::get_new_handler();
+    if (!handler) {
+      throw std::bad_alloc();
+    }
+    handler();
+  }
+}
+
+void *allocateAligned(std::size_t size, std::align_val_t alignment) {
+  const auto align = std::max(static_cast<std::size_t>(alignment), sizeof(void *));
+  if (size == 0) {
+    size = 1;
+  }
+  for (;;) {
+    void *ptr = nullptr;
+    if (posix_memalign(&ptr, align, size) == 0) {
+      AllocationTracker::record(size);
+      return ptr;
+    }
+    std::new_handler handler = std::get_new_handler();
+    if (!handler) {
+      throw std::bad_alloc();
+    }
+    handler();
+  }
+}
+
+#endif // HAS_ALLOCATION_TRACKING
+
+} // namespace
+
+bool AllocationTracker::enable() {
+  trackingEnabled.store(true, std::memory_order_relaxed);
+  const Counts before = threadCounts();
+  // Kept opaque so that the compiler cannot elide the allocation.
+  void *volatile probe = ::operator new(1);
+  ::operator delete(probe);
+  return threadCounts().allocations != before.allocations;
+}
+
+void AllocationTracker::disable() { trackingEnabled.store(false, std::memory_order_relaxed); }
+
+bool AllocationTracker::enabled() { return trackingEnabled.load(std::memory_order_relaxed); }
+
+AllocationTracker::Counts AllocationTracker::threadCounts() noexcept { return threadCounters; }
+
+void AllocationTracker::record(std::size_t bytes) noexcept {
+  if (trackingEnabled.load(std::memory_order_relaxed)) {
+    ++threadCounters.allocations;
+    threadCounters.bytes += bytes;
+  }
+}
+
+// Replacements of the global allocation functions, only built with
+// -DPROFILE_ALLOCATIONS=ON.  They live in this translation unit so that they
+// are linked whenever the tracker is used.
+
+#ifdef HAS_ALLOCATION_TRACKING
+
+void *operator new(std::size_t size) { return allocate(size); }
+void *operator new[](std::size_t size) { return allocate(size); }
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept {
+  try {
+    return allocate(size);
+  } catch (...) {
+    return nullptr;
+  }
+}
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept {
+  try {
+    return allocate(size);
+  } catch (...) {
+    return nullptr;
+  }
+}
+void *operator new(std::size_t size, std::align_val_t alignment) {
+  return allocateAligned(size, alignment);
+}
+void *operator new[](std::size_t size, std::align_val_t alignment) {
+  return allocateAligned(size, alignment);
+}
+void *operator new(std::size_t size, std::align_val_t alignment,
+                   const std::nothrow_t &) noexcept {
+  try {
+    return allocateAligned(size, alignment);
+  } catch (...) {
+    return nullptr;
+  }
+}
+void *operator new[](std::size_t size, std::align_val_t alignment,
+                     const std::nothrow_t &) noexcept {
+  try {
+    return allocateAligned(size, alignment);
+  } catch (...) {
+    return nullptr;
+  }
+}
+
+void operator delete(void *ptr) noexcept { std::free(ptr); }
+void operator delete[](void *ptr) noexcept { std::free(ptr); }
+void operator delete(void *ptr, std::size_t) noexcept { std::free(ptr); }
+void operator delete[](void *ptr, std::size_t) noexcept { std::free(ptr); }
+void operator delete(void *ptr, const std::nothrow_t &) noexcept { std::free(ptr); }
+void operator delete[](void *ptr, const std::nothrow_t &) noexcept { std::free(ptr); }
+void operator delete(void *ptr, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete[](void *ptr, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete(void *ptr, std::size_t, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete[](void *ptr, std::size_t, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete(void *ptr, std::align_val_t, const std::nothrow_t &) noexcept {
+  std::free(ptr);
+}
+void operator delete[](void *ptr, std::align_val_t, const std::nothrow_t &) noexcept {
+  std::free(ptr);
+}
+
+#endif // HAS_ALLOCATION_TRACKING
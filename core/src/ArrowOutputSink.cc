@@ -0,0 +1,393 @@
+#include <ArrowOutputSink.h>
+#include <AsyncLogger.h>
+#include <ColumnChunker.h>
+#include <api/IConfigurationProvider.h>
+
+#include <algorithm>
+#include <filesystem>
+#include <iostream>
+#include <stdexcept>
+
+#if defined(HAS_ARROW_OUTPUT)
+#include <arrow/api.h>
+#include <arrow/io/file.h>
+#include <arrow/ipc/writer.h>
+#include <parquet/arrow/writer.h>
+#include <parquet/properties.h>
+#endif
+
+namespace {
+
+#if defined(HAS_ARROW_OUTPUT)
+
+template <typename T> T valueOrThrow(arrow::Result<T> result, const std::string& what) {
+  if (!result.ok()) {
+    throw std::runtime_error("ArrowOutputSink: " + what + ": " + result.status().ToString());
+  }
+  return std::move(result).ValueUnsafe();
+}
+
+void checkStatus(const arrow::Status& status, const std::string& what) {
+  if (!status.ok()) {
+    throw std::runtime_error("ArrowOutputSink: " + what + ": " + status.ToString());
+  }
+}
+
+/// Arrow buffer that owns the vector it exposes, so chunks are not copied.
+template <typename T> class VectorBuffer : public arrow::Buffer {
+public:
+  explicit VectorBuffer(std::vector<T>&& values)
+      : arrow::Buffer(nullptr, 0), values_m(std::move(values)) {
+    data_ = reinterpret_cast<const uint8_t*>(values_m.data());
+    size_ = capacity_ = static_cast<int64_t>(values_m.size() * sizeof(T));
+  }
+
+private:
+  std::vector<T> values_m;
+};
+
+std::shared_ptr<arrow::DataType> arrowType(const std::string& dtype) {
+  if (dtype == "float32") return arrow::float32();
+  if (dtype == "float64") return arrow::float64();
+  if (dtype == "bool") return arrow::boolean();
+  if (dtype == "int8") return arrow::int8();
+  if (dtype == "uint8") return arrow::uint8();
+  if (dtype == "int16") return arrow::int16();
+  if (dtype == "uint16") return arrow::uint16();
+  if (dtype == "int32") return arrow::int32();
+  if (dtype == "uint32") return arrow::uint32();
+  if (dtype == "int64") return arrow::int64();
+  return arrow::uint64();
+}
+
+/// Arrow array over the values of one chunk column.
+std::shared_ptr<arrow::Array> valuesArray(ColumnChunker::Data&& data, const std::string& dtype) {
+  return std::visit(
+      [&dtype](auto& values) -> std::shared_ptr<arrow::Array> {
+        using Value = typename std::decay_t<decltype(values)>::value_type;
+        const auto length = static_cast<int64_t>(values.size());
+        if (dtype == "bool") {
+          // Arrow booleans are bit-packed.
+          arrow::BooleanBuilder builder;
+          checkStatus(builder.AppendValues(reinterpret_cast<const uint8_t*>(values.data()), length),
+                      "boolean column");
+          return valueOrThrow(builder.Finish(), "boolean column");
+        }
+        auto buffer = std::make_shared<VectorBuffer<Value>>(std::move(values));
+        return arrow::MakeArray(arrow::ArrayData::Make(arrowType(dtype), length, {nullptr, buffer}));
+      },
+      data);
+}
+
+arrow::Compression::type parseCodec(const std::string& name) {
+  if (name == "zstd") return arrow::Compression::ZSTD;
+  if (name == "lz4") return arrow::Compression::LZ4_FRAME;
+  if (name == "snappy") return arrow::Compression::SNAPPY;
+  if (name == "gzip") return arrow::Compression::GZIP;
+  return arrow::Compression::UNCOMPRESSED;
+}
+
+#endif
+
+} // namespace
+
+#if defined(HAS_ARROW_OUTPUT)
+
+struct ArrowOutputSink::Writers {
+  /// Output of one slot; only its slot touches it during the event loop.
+  struct Slot {
+    std::shared_ptr<arrow::io::FileOutputStream> file;
+    std::unique_ptr<parquet::arrow::FileWriter> parquet;
+    std::shared_ptr<arrow::ipc::RecordBatchWriter> ipc;
+  };
+
+  ArrowSettings settings;
+  std::string directory;
+  std::shared_ptr<arrow::Schema> schema;
+  std::vector<Slot> slots;
+
+  void open(unsigned int slot) {
+    Slot& out = slots[slot];
+    const bool parquetFormat = settings.format == ArrowSettings::Format::Parquet;
+    const std::string path = directory + "/part-" + std::to_string(slot) +
+                             (parquetFormat ? ".parquet" : ".arrow");
+    out.file = valueOrThrow(arrow::io::FileOutputStream::Open(path), "cannot create " + path);
+    if (parquetFormat) {
+      parquet::WriterProperties::Builder properties;
+      properties.compression(parseCodec(settings.compression));
+      if (settings.dictionary) {
+        properties.enable_dictionary();
+      } else {
+        properties.disable_dictionary();
+      }
+      properties.max_row_group_length(static_cast<int64_t>(settings.rowGroupSize));
+      out.parquet = valueOrThrow(
+          parquet::arrow::FileWriter::Open(*schema, arrow::default_memory_pool(), out.file,
+                                           properties.build()),
+          "cannot open Parquet writer for " + path);
+    } else {
+      auto options = arrow::ipc::IpcWriteOptions::Defaults();
+      if (settings.compression != "none") {
+        options.codec = valueOrThrow(arrow::util::Codec::Create(parseCodec(settings.compression)),
+                                     "IPC compression");
+      }
+      out.ipc = valueOrThrow(arrow::ipc::MakeFileWriter(out.file, schema, options),
+                             "cannot open Arrow IPC writer for " + path);
+    }
+  }
+
+  void write(ColumnChunker::Chunk&& chunk) {
+    Slot& out = slots[chunk.slot];
+    if (!out.file) {
+      open(chunk.slot);
+    }
+    std::vector<std::shared_ptr<arrow::Array>> arrays;
+    for (std::size_t i = 0; i < chunk.data.size(); ++i) {
+      auto values = valuesArray(std::move(chunk.data[i]), chunk.dtypes[i]);
+      if (chunk.offsets[i].empty()) {
+        arrays.push_back(values);
+        continue;
+      }
+      const auto length = static_cast<int64_t>(chunk.offsets[i].size());
+      auto offsets = std::make_shared<arrow::Int64Array>(
+          length, std::make_shared<VectorBuffer<int64_t>>(std::move(chunk.offsets[i])));
+      arrays.push_back(valueOrThrow(arrow::LargeListArray::FromArrays(*offsets, *values),
+                                    "list column " + chunk.columns[i]));
+    }
+    auto batch =
+        arrow::RecordBatch::Make(schema, static_cast<int64_t>(chunk.rows), std::move(arrays));
+    if (out.parquet) {
+      checkStatus(out.parquet->WriteRecordBatch(*batch), "Parquet write");
+    } else {
+      checkStatus(out.ipc->WriteRecordBatch(*batch), "Arrow IPC write");
+    }
+  }
+
+  void close() {
+    // An empty output still gets one file carrying the schema.
+    if (std::none_of(slots.begin(), slots.end(),
+                     [](const Slot& slot) { return static_cast<bool>(slot.file); })) {
+      open(0);
+    }
+    for (auto& slot : slots) {
+      if (slot.parquet) {
+        checkStatus(slot.parquet->Close(), "Parquet close");
+      }
+      if (slot.ipc) {
+        checkStatus(slot.ipc->Close(), "Arrow IPC close");
+      }
+      if (slot.file) {
+        checkStatus(slot.file->Close(), "file close");
+      }
+    }
+  }
+};
+
+#else
+
+struct ArrowOutputSink::Writers {};
+
+#endif
+
+ArrowOutputSink::ArrowOutputSink(ArrowSettings settings) : arrowSettings_m(std::move(settings)) {
+  if (arrowSettings_m.rowGroupSize == 0) {
+    throw std::invalid_argument("ArrowOutputSink: row group size must be positive");
+  }
+  const std::string& codec = arrowSettings_m.compression;
+  if (codec != "zstd" && codec != "lz4" && codec != "snappy" && codec != "gzip" &&
+      codec != "none") {
+    throw std::invalid_argument("ArrowOutputSink: invalid compression '" + codec +
+                                "'. Valid values are zstd, lz4, snappy, gzip or none.");
+  }
+  if (arrowSettings_m.training && arrowSettings_m.format != ArrowSettings::Format::Parquet) {
+    throw std::invalid_argument("ArrowOutputSink: training output is written as Parquet");
+  }
+  if (arrowSettings_m.format == ArrowSettings::Format::Ipc && codec != "zstd" &&
+      codec != "lz4" && codec != "none") {
+    throw std::invalid_argument("ArrowOutputSink: Arrow IPC supports zstd, lz4 or none, not '" +
+                                codec + "'");
+  }
+}
+
+ArrowOutputSink::~ArrowOutputSink() = default;
+
+std::unique_ptr<ArrowOutputSink>
+ArrowOutputSink::fromConfig(const IConfigurationProvider& configProvider,
+                            const std::string& format) {
+  ArrowSettings settings;
+  settings.format =
+      format == "arrow" ? ArrowSettings::Format::Ipc : ArrowSettings::Format::Parquet;
+
+  const std::string rowGroupSize = configProvider.get("arrowRowGroupSize");
+  if (!rowGroupSize.empty()) {
+    try {
+      settings.rowGroupSize = std::stoul(rowGroupSize);
+    } catch (const std::exception&) {
+      throw std::runtime_error("ArrowOutputSink: invalid arrowRowGroupSize '" + rowGroupSize +
+                               "'");
+    }
+  }
+  const std::string dictionary = configProvider.get("arrowDictionary");
+  if (!dictionary.empty()) {
+    settings.dictionary = dictionary == "1" || dictionary == "true" || dictionary == "True";
+  }
+  const std::string compression = configProvider.get("arrowCompression");
+  if (!compression.empty()) {
+    settings.compression = compression;
+  }
+  if (format == "training") {
+    settings.training = TrainingSettings::fromConfig(configProvider, settings.rowGroupSize);
+  }
+  try {
+    return std::make_unique<ArrowOutputSink>(settings);
+  } catch (const std::invalid_argument& e) {
+    throw std::runtime_error(e.what());
+  }
+}
+
+std::string ArrowOutputSink::datasetPath(const std::string& outputFile,
+                                         ArrowSettings::Format format) {
+  std::filesystem::path path(outputFile);
+  path.replace_extension(format == ArrowSettings::Format::Parquet ? ".parquet" : ".arrow");
+  return path.string();
+}
+
+ArrowOutputSink::PendingWrite ArrowOutputSink::book(ROOT::RDF::RNode& df,
+                                                    const OutputSpec& spec) {
+  if (spec.outputFile.empty()) {
+    throw std::runtime_error("ArrowOutputSink: outputFile is empty");
+  }
+#if defined(HAS_ARROW_OUTPUT)
+  const auto& training = arrowSettings_m.training;
+  std::vector<std::string> requested = spec.columns.empty() ? df.GetColumnNames() : spec.columns;
+  if (training) {
+    for (const auto& column : {training->labelColumn, training->weightColumn}) {
+      if (!column.empty() &&
+          std::find(requested.begin(), requested.end(), column) == requested.end()) {
+        requested.push_back(column);
+      }
+    }
+  }
+  std::vector<std::string> columns;
+  arrow::FieldVector fields;
+  for (const auto& column : requested) {
+    const std::string type = df.GetColumnType(column);
+    const std::string dtype = ColumnChunker::dtypeOf(type);
+    if (dtype.empty() || (training && ColumnChunker::isVector(type))) {
+      RDF_LOG_WARN << "Warning: ArrowOutputSink skips column '" << column << "' of type '" << type
+                   << "'";
+      continue;
+    }
+    columns.push_back(column);
+    auto fieldType = arrowType(dtype);
+    fields.push_back(arrow::field(column, ColumnChunker::isVector(type)
+                                              ? arrow::large_list(fieldType)
+                                              : fieldType,
+                                  false));
+  }
+  if (columns.empty()) {
+    throw std::runtime_error("ArrowOutputSink: no numeric columns to write to " +
+                             spec.outputFile);
+  }
+
+  PendingWrite pending;
+  pending.directory = datasetPath(spec.outputFile, arrowSettings_m.format);
+  std::filesystem::remove_all(pending.directory);
+  std::filesystem::create_directories(pending.directory);
+  RDF_LOG_INFO << "Booking Arrow output";
+  RDF_LOG_INFO << "SaveFile: " << pending.directory;
+
+  auto writers = std::make_shared<Writers>();
+  writers->settings = arrowSettings_m;
+  writers->directory = pending.directory;
+  writers->schema = arrow::schema(fields);
+  writers->slots.resize(std::max(1u, df.GetNSlots()));
+  pending.writers = writers;
+  if (!spec.columns.empty()) {
+    pending.columns = columns;
+  }
+  if (training) {
+    if (std::find(columns.begin(), columns.end(), training->labelColumn) == columns.end()) {
+      throw std::runtime_error("ArrowOutputSink: training label column '" +
+                               training->labelColumn + "' is not a numeric scalar column");
+    }
+    auto shuffler = std::make_shared<TrainingShuffler>(
+        *training, static_cast<unsigned int>(writers->slots.size()),
+        [writers](ColumnChunker::Chunk&& chunk) { writers->write(std::move(chunk)); });
+    pending.shuffler = shuffler;
+    pending.chunker = std::make_unique<ColumnChunker>(
+        df, columns, arrowSettings_m.rowGroupSize,
+        [shuffler](ColumnChunker::Chunk&& chunk) { shuffler->add(std::move(chunk)); }, false);
+    return pending;
+  }
+  // Each slot writes its own file, so the callbacks need no serialisation.
+  pending.chunker = std::make_unique<ColumnChunker>(
+      df, columns, arrowSettings_m.rowGroupSize,
+      [writers](ColumnChunker::Chunk&& chunk) { writers->write(std::move(chunk)); }, false);
+  return pending;
+#else
+  (void)df;
+  throw std::runtime_error("ArrowOutputSink: Parquet/Arrow output requires building with "
+                           "-DUSE_ARROW=ON");
+#endif
+}
+
+void ArrowOutputSink::complete(PendingWrite& pending) {
+#if defined(HAS_ARROW_OUTPUT)
+  const std::size_t rows = pending.chunker->run();
+  if (pending.shuffler) {
+    pending.shuffler->drain();
+    for (const auto& [label, count] : pending.shuffler->classCounts()) {
+      RDF_LOG_INFO << "Training class " << label << ": kept " << count.kept << " of "
+                   << count.seen << " rows";
+    }
+  }
+  pending.writers->close();
+  RDF_LOG_INFO << "Done Saving " << pending.directory << " (" << rows << " rows)";
+#else
+  (void)pending;
+#endif
+}
+
+void ArrowOutputSink::writeDataFrame(ROOT::RDF::RNode& df, const OutputSpec& spec) {
+  auto pending = book(df, spec);
+  complete(pending);
+}
+
+void ArrowOutputSink::writeDataFrame(ROOT::RDF::RNode& df,
+                                     const IConfigurationProvider& configProvider,
+                                     const IDataFrameProvider*,
+                                     const ISystematicManager* systematicManager,
+                                     OutputChannel channel) {
+  writeDataFrame(df, resolveSpec(df, configProvider, systematicManager, channel));
+}
+
+void ArrowOutputSink::bookDataFrame(ROOT::RDF::RNode& df,
+                                    const IConfigurationProvider& configProvider,
+                                    const IDataFrameProvider*,
+                                    const ISystematicManager* systematicManager,
+                                    OutputChannel channel) {
+  bookDataFrame(df, resolveSpec(df, configProvider, systematicManager, channel));
+}
+
+void ArrowOutputSink::bookDataFrame(ROOT::RDF::RNode& df, const OutputSpec& spec) {
+  pendingWrites_m.push_back(book(df, spec));
+}
+
+void ArrowOutputSink::flush() {
+  for (auto& pending : pendingWrites_m) {
+    complete(pending);
+  }
+  pendingWrites_m.clear();
+  RootOutputSink::flush();
+}
+
+bool ArrowOutputSink::bookedColumns(std::vector<std::string>& columns) const {
+  for (const auto& pending : pendingWrites_m) {
+    if (pending.columns.empty()) {
+      return false;
+    }
+    columns.insert(columns.end(), pending.columns.begin(), pending.columns.end());
+  }
+  return RootOutputSink::bookedColumns(columns);
+}
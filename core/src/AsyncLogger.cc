@@ -0,0 +1,264 @@
+#include <AsyncLogger.h>
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+/// Messages the writer moves out of the ring before writing them.
+constexpr std::size_t kWriterBatch = 256;
+
+std::int64_t nowNs() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+} // namespace
+
+AsyncLogger &AsyncLogger::instance() {
+  static AsyncLogger logger;
+  return logger;
+}
+
+AsyncLogger::AsyncLogger(std::size_t capacity, Sink sink) : sink_m(std::move(sink)) {
+  std::size_t size = 2;
+  while (size < capacity) {
+    size <<= 1;
+  }
+  cells_m = std::make_unique<Cell[]>(size);
+  batch_m.reserve(kWriterBatch);
+  mask_m = size - 1;
+  for (std::size_t i = 0; i < size; ++i) {
+    cells_m[i].sequence.store(i, std::memory_order_relaxed);
+  }
+  writer_m = std::thread([this] { writerLoop(); });
+}
+
+AsyncLogger::~AsyncLogger() { stop(); }
+
+void AsyncLogger::stop() {
+  stop_m.store(true);
+  wakeWriter();
+  if (writer_m.joinable() && std::this_thread::get_id() != writer_m.get_id()) {
+    writer_m.join();
+  }
+}
+
+ILogger::Level AsyncLogger::parseLevel(const std::string &name) {
+  std::string lower(name);
+  std::transform(lower.begin(), lower.end(), lower.begin(),
+                 [](unsigned char c) { return std::tolower(c); });
+  if (lower == "trace") {
+    return Level::Trace;
+  }
+  if (lower == "debug") {
+    return Level::Debug;
+  }
+  if (lower == "info") {
+    return Level::Info;
+  }
+  if (lower == "warn" || lower == "warning") {
+    return Level::Warn;
+  }
+  if (lower == "error") {
+    return Level::Error;
+  }
+  throw std::invalid_argument("Unknown log level '" + name +
+                              "'; expected trace, debug, info, warn or error");
+}
+
+void AsyncLogger::setRateLimit(double perSecond, double burst) {
+  if (perSecond <= 0) {
+    rateInterval_m.store(0);
+    return;
+  }
+  const auto interval = static_cast<std::int64_t>(1e9 / perSecond);
+  rateTolerance_m.store(static_cast<std::int64_t>(interval * std::max(burst - 1, 0.0)));
+  rateTat_m.store(0);
+  rateInterval_m.store(std::max<std::int64_t>(interval, 1));
+}
+
+bool AsyncLogger::allowedByRateLimit() {
+  const std::int64_t interval = rateInterval_m.load(std::memory_order_relaxed);
+  if (interval == 0) {
+    return true;
+  }
+  const std::int64_t tolerance = rateTolerance_m.load(std::memory_order_relaxed);
+  const std::int64_t now = nowNs();
+  std::int64_t tat = rateTat_m.load(std::memory_order_relaxed);
+  while (true) {
+    const std::int64_t start = std::max(tat, now);
+    if (start - now > tolerance) {
+      return false;
+    }
+    if (rateTat_m.compare_exchange_weak(tat, start + interval, std::memory_order_relaxed)) {
+      return true;
+    }
+  }
+}
+
+bool AsyncLogger::tryPush(Level level, std::string &message) {
+  std::size_t pos = enqueuePos_m.load(std::memory_order_relaxed);
+  while (true) {
+    Cell &cell = cells_m[pos & mask_m];
+    const std::size_t seq = cell.sequence.load(std::memory_order_acquire);
+    const auto diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos);
+    if (diff == 0) {
+      if (enqueuePos_m.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+        cell.level = level;
+        cell.message = std::move(message);
+        cell.sequence.store(pos + 1, std::memory_order_release);
+        return true;
+      }
+    } else if (diff < 0) {
+      return false;
+    } else {
+      pos = enqueuePos_m.load(std::memory_order_relaxed);
+    }
+  }
+}
+
+bool AsyncLogger::tryPop(Level &level, std::string &message) {
+  Cell &cell = cells_m[dequeuePos_m & mask_m];
+  if (cell.sequence.load(std::memory_order_acquire) != dequeuePos_m + 1) {
+    return false;
+  }
+  level = cell.level;
+  message = std::move(cell.message);
+  cell.message.clear();
+  cell.sequence.store(dequeuePos_m + mask_m + 1, std::memory_order_release);
+  ++dequeuePos_m;
+  return true;
+}
+
+bool AsyncLogger::messageReady() const {
+  return cells_m[dequeuePos_m & mask_m].sequence.load(std::memory_order_acquire) ==
+         dequeuePos_m + 1;
+}
+
+void AsyncLogger::log(Level level, const std::string &message) {
+  log(level, std::string(message));
+}
+
+void AsyncLogger::log(Level level, std::string &&message) {
+  if (!enabled(level)) {
+    return;
+  }
+  const bool important = level >= Level::Warn;
+  if (!important && !allowedByRateLimit()) {
+    dropped_m.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+  while (!tryPush(level, message)) {
+    if (!important) {
+      dropped_m.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+    if (writerDone_m.load()) {
+      flush();
+    } else {
+      wakeWriter();
+      std::this_thread::yield();
+    }
+  }
+  // Pairs with the fence in writerLoop(): either the writer sees the message
+  // before it sleeps, or this thread sees it asleep and wakes it.
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (level == Level::Error || writerDone_m.load(std::memory_order_relaxed)) {
+    flush();
+  } else if (writerSleeping_m.load(std::memory_order_relaxed)) {
+    wakeWriter();
+  }
+}
+
+void AsyncLogger::wakeWriter() {
+  std::lock_guard<std::mutex> lock(wakeMutex_m);
+  wakeCv_m.notify_one();
+}
+
+void AsyncLogger::flush() {
+  if (std::this_thread::get_id() == writer_m.get_id()) {
+    return;
+  }
+  const std::size_t target = enqueuePos_m.load();
+  std::unique_lock<std::mutex> lock(wakeMutex_m);
+  wakeCv_m.notify_one();
+  writtenCv_m.wait(lock, [this, target] {
+    return written_m.load() >= target || writerDone_m.load();
+  });
+  if (writerDone_m.load()) {
+    // The writer has stopped: write what is left here.  The mutex keeps
+    // concurrent flushes from consuming at the same time.
+    while (writeBatch() > 0) {
+    }
+  }
+}
+
+std::size_t AsyncLogger::writeBatch() {
+  batch_m.clear();
+  Level level;
+  std::string message;
+  while (batch_m.size() < kWriterBatch && tryPop(level, message)) {
+    batch_m.emplace_back(level, std::move(message));
+  }
+  const std::size_t popped = batch_m.size();
+  if (popped == 0) {
+    const std::uint64_t dropped = dropped_m.load(std::memory_order_relaxed);
+    if (dropped != droppedReported_m) {
+      batch_m.emplace_back(Level::Warn, "AsyncLogger: " +
+                                            std::to_string(dropped - droppedReported_m) +
+                                            " messages dropped (rate limit or full buffer)");
+      droppedReported_m = dropped;
+    }
+  }
+
+  std::string out;
+  std::string err;
+  for (const auto &entry : batch_m) {
+    if (sink_m) {
+      sink_m(entry.first, entry.second);
+      continue;
+    }
+    std::string &buffer = entry.first >= Level::Warn ? err : out;
+    buffer += entry.second;
+    buffer += '\n';
+  }
+  if (!out.empty()) {
+    std::cout << out << std::flush;
+  }
+  if (!err.empty()) {
+    std::cerr << err << std::flush;
+  }
+  written_m.fetch_add(popped);
+  return popped;
+}
+
+void AsyncLogger::writerLoop() {
+  std::unique_lock<std::mutex> lock(wakeMutex_m, std::defer_lock);
+  while (true) {
+    if (writeBatch() > 0) {
+      lock.lock();
+      writtenCv_m.notify_all();
+      lock.unlock();
+      continue;
+    }
+
+    lock.lock();
+    writerSleeping_m.store(true);
+    // Pairs with the fence in log().
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    wakeCv_m.wait(lock, [this] { return stop_m.load() || messageReady(); });
+    writerSleeping_m.store(false);
+    if (stop_m.load() && !messageReady()) {
+      writerDone_m.store(true);
+      writtenCv_m.notify_all();
+      return;
+    }
+    lock.unlock();
+  }
+}
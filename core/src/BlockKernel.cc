@@ -0,0 +1,94 @@
+#include <BlockKernel.h>
+#include <ColumnChunker.h>
+
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include <variant>
+
+namespace {
+
+constexpr double kNotEvaluated = std::numeric_limits<double>::quiet_NaN();
+
+} // namespace
+
+std::shared_ptr<const std::vector<double>>
+BlockKernel::evaluate(ROOT::RDF::RNode df, Function kernel, const std::vector<std::string> &columns,
+                      std::size_t blockSize) {
+  if (!kernel) {
+    throw std::runtime_error("BlockKernel: null kernel");
+  }
+  auto results = std::make_shared<std::vector<double>>();
+  std::vector<std::string> inputs = columns;
+  inputs.push_back("rdfentry_");
+
+  // ColumnChunker calls back one chunk at a time, so the buffers below and
+  // the results need no locking.
+  std::vector<std::vector<double>> converted(columns.size());
+  std::vector<const double *> values(columns.size());
+  std::vector<const std::int64_t *> offsets(columns.size());
+  std::vector<double> output;
+  ColumnChunker chunker(df, inputs, blockSize, [&](ColumnChunker::Chunk &&chunk) {
+    for (std::size_t i = 0; i < columns.size(); ++i) {
+      values[i] = std::visit(
+          [&converted, i](const auto &data) -> const double * {
+            using Value = typename std::decay_t<decltype(data)>::value_type;
+            if constexpr (std::is_same_v<Value, double>) {
+              return data.data();
+            } else {
+              converted[i].assign(data.begin(), data.end());
+              return converted[i].data();
+            }
+          },
+          chunk.data[i]);
+      offsets[i] = chunk.offsets[i].empty() ? nullptr : chunk.offsets[i].data();
+    }
+    output.assign(chunk.rows, kNotEvaluated);
+    kernel(static_cast<std::int64_t>(chunk.rows), values.data(), offsets.data(), output.data());
+
+    const auto &entries = std::get<std::vector<std::uint64_t>>(chunk.data.back());
+    for (std::size_t row = 0; row < chunk.rows; ++row) {
+      if (entries[row] >= results->size()) {
+        results->resize(entries[row] + 1, kNotEvaluated);
+      }
+      (*results)[entries[row]] = output[row];
+    }
+  });
+  chunker.run();
+  return results;
+}
+
+ROOT::RDF::RNode BlockKernel::define(ROOT::RDF::RNode df, const std::string &name,
+                                     Function kernel, const std::vector<std::string> &columns,
+                                     std::size_t blockSize, const std::string &outputType) {
+  if (outputType != "double" && outputType != "float" && outputType != "int" &&
+      outputType != "bool") {
+    throw std::runtime_error("BlockKernel: unsupported output type '" + outputType +
+                             "' for column '" + name + "' (use double, float, int or bool)");
+  }
+  const auto results = evaluate(df, kernel, columns, blockSize);
+  const auto value = [results](ULong64_t entry) {
+    return entry < results->size() ? (*results)[entry] : kNotEvaluated;
+  };
+  if (outputType == "float") {
+    return df.Define(name, [value](ULong64_t entry) { return static_cast<float>(value(entry)); },
+                     {"rdfentry_"});
+  }
+  if (outputType == "int") {
+    return df.Define(name,
+                     [value](ULong64_t entry) {
+                       const double result = value(entry);
+                       return result == result ? static_cast<int>(result) : 0;
+                     },
+                     {"rdfentry_"});
+  }
+  if (outputType == "bool") {
+    return df.Define(name,
+                     [value](ULong64_t entry) {
+                       const double result = value(entry);
+                       return result == result && result != 0.0;
+                     },
+                     {"rdfentry_"});
+  }
+  return df.Define(name, value, {"rdfentry_"});
+}
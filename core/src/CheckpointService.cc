@@ -0,0 +1,290 @@
+#include <CheckpointService.h>
+#include <EntryTrackerAction.h>
+#include <api/IConfigurationProvider.h>
+#include <api/IDataFrameProvider.h>
+#include <api/ILogger.h>
+#include <TAxis.h>
+#include <TFile.h>
+#include <TKey.h>
+#include <TObjString.h>
+#include <TROOT.h>
+#include <TVectorD.h>
+#include <algorithm>
+#include <filesystem>
+#include <stdexcept>
+
+namespace {
+
+/// Positive integer value of config key @p key, or @p fallback when unset.
+ULong64_t positiveConfigValue(const IConfigurationProvider &config,
+                              const std::string &key, ULong64_t fallback) {
+  const std::string text = config.get(key);
+  if (text.empty()) {
+    return fallback;
+  }
+  std::size_t end = 0;
+  ULong64_t value = 0;
+  try {
+    value = std::stoull(text, &end);
+  } catch (const std::exception &) {
+    end = 0;
+  }
+  if (end != text.size() || value == 0) {
+    throw std::runtime_error("CheckpointService: invalid " + key + " '" +
+                             text + "'");
+  }
+  return value;
+}
+
+/// Open checkpoint @p path and read its processed-entries record.
+EntryRangeSet readEntries(TFile &file, const std::string &path) {
+  std::unique_ptr<TObjString> entries(
+      dynamic_cast<TObjString *>(file.Get(CheckpointService::kEntriesKey)));
+  if (!entries) {
+    throw std::runtime_error("CheckpointService: '" + path +
+                             "' is not a checkpoint file (no " +
+                             CheckpointService::kEntriesKey + ").");
+  }
+  return EntryRangeSet::fromString(entries->GetString().Data());
+}
+
+} // namespace
+
+CheckpointService::~CheckpointService() { stopWriter(); }
+
+void CheckpointService::initialize(ManagerContext &ctx) {
+  ctx_m = &ctx;
+  path_m = ctx.config.get("checkpointFile");
+  if (path_m.empty()) {
+    throw std::runtime_error("CheckpointService: checkpointFile is not set");
+  }
+  // The directory exists from the start of the job, so batch systems that
+  // transfer it back on eviction (see submission_backend.py) find it.
+  const std::filesystem::path parent = std::filesystem::path(path_m).parent_path();
+  if (!parent.empty()) {
+    std::filesystem::create_directories(parent);
+  }
+  every_m = positiveConfigValue(ctx.config, "checkpointEvery", every_m);
+  interval_m = std::chrono::seconds(
+      positiveConfigValue(ctx.config, "checkpointInterval", interval_m.count()));
+
+  if (std::filesystem::exists(path_m)) {
+    TFile file(path_m.c_str(), "READ");
+    if (file.IsZombie()) {
+      throw std::runtime_error("CheckpointService: cannot open checkpoint '" +
+                               path_m + "'");
+    }
+    resumedEntries_m = readEntries(file, path_m);
+    for (auto *object : *file.GetListOfKeys()) {
+      auto *key = static_cast<TKey *>(object);
+      const std::string name = key->GetName();
+      if (name != kEntriesKey) {
+        restored_m[name].reset(key->ReadObj());
+      }
+    }
+    resuming_m = true;
+    ctx.logger.log(ILogger::Level::Info,
+                   "CheckpointService: resuming from '" + path_m + "' (" +
+                       std::to_string(resumedEntries_m.size()) +
+                       " entries already processed)");
+  }
+
+  // Booked before any filter, so that every entry of the loop is recorded.
+  preFilterDf_m = ctx.data.getDataFrame();
+  const unsigned int nSlots = preFilterDf_m->GetNSlots();
+  slots_m.clear();
+  for (unsigned int slot = 0; slot < nSlots; ++slot) {
+    slots_m.push_back(std::make_unique<SlotState>());
+  }
+  entriesResult_m = preFilterDf_m->Book<ULong64_t>(EntryTrackerAction(nSlots),
+                                                   {"rdfentry_"});
+}
+
+void CheckpointService::watch(const std::string &key,
+                              ROOT::RDF::RResultPtr<THnSparseF> &result) {
+  watch(key, result, [](THnSparseF &partial) {
+    return std::unique_ptr<TObject>(partial.Clone());
+  });
+}
+
+void CheckpointService::arm() {
+  if (armed_m) {
+    return;
+  }
+  for (const auto &[key, payload] : restored_m) {
+    if (std::find(watched_m.begin(), watched_m.end(), key) == watched_m.end()) {
+      throw std::runtime_error("CheckpointService: checkpoint '" + path_m +
+                               "' holds result '" + key +
+                               "', which is not booked by this run.");
+    }
+  }
+  entriesResult_m.OnPartialResultSlot(
+      every_m, [this](unsigned int slot, EntryRangeSet &entries) {
+        commit(slot, entries);
+      });
+  armed_m = true;
+  stop_m = false;
+  // The writer opens files while the event loop runs.
+  ROOT::EnableThreadSafety();
+  writer_m = std::thread(&CheckpointService::writerLoop, this);
+}
+
+void CheckpointService::finalize(ROOT::RDF::RNode &) {
+  stopWriter();
+  if (!armed_m) {
+    return;
+  }
+  // The run is complete: its outputs supersede the checkpoint, and a stale
+  // checkpoint would make a rerun skip every entry.
+  entriesResult_m.GetValue();
+  std::error_code error;
+  std::filesystem::remove(path_m, error);
+  std::filesystem::remove(path_m + ".tmp", error);
+}
+
+const TObject *CheckpointService::restored(const std::string &key) const {
+  auto it = restored_m.find(key);
+  return it == restored_m.end() ? nullptr : it->second.get();
+}
+
+void CheckpointService::mergePayload(TObject &into, const TObject &from) {
+  if (auto *hist = dynamic_cast<THnBase *>(&into)) {
+    const auto *other = dynamic_cast<const THnBase *>(&from);
+    bool consistent = other && other->GetNdimensions() == hist->GetNdimensions();
+    for (Int_t d = 0; consistent && d < hist->GetNdimensions(); ++d) {
+      consistent = other->GetAxis(d)->GetNbins() == hist->GetAxis(d)->GetNbins();
+    }
+    if (consistent) {
+      hist->Add(other);
+      return;
+    }
+  } else if (auto *vec = dynamic_cast<TVectorD *>(&into)) {
+    const auto *other = dynamic_cast<const TVectorD *>(&from);
+    if (other && other->GetNrows() == vec->GetNrows()) {
+      *vec += *other;
+      return;
+    }
+  }
+  throw std::runtime_error(std::string("CheckpointService::mergePayload(): cannot add ") +
+                           from.ClassName() + " '" + from.GetName() + "' to " +
+                           into.ClassName() + " '" + into.GetName() + "'.");
+}
+
+EntryRangeSet CheckpointService::readProcessedEntries(const std::string &path) {
+  if (path.empty() || !std::filesystem::exists(path)) {
+    return {};
+  }
+  TFile file(path.c_str(), "READ");
+  if (file.IsZombie()) {
+    throw std::runtime_error("CheckpointService: cannot open checkpoint '" +
+                             path + "'");
+  }
+  return readEntries(file, path);
+}
+
+std::unordered_map<std::string, std::string>
+CheckpointService::collectProvenanceEntries() const {
+  return {
+      {"service.checkpoint.file", path_m},
+      {"service.checkpoint.every", std::to_string(every_m)},
+      {"service.checkpoint.resumed_entries",
+       std::to_string(resumedEntries_m.size())},
+  };
+}
+
+void CheckpointService::stage(unsigned int slot, const std::string &key,
+                              std::unique_ptr<TObject> payload) {
+  // Only the slot's own thread touches its staged payloads.
+  slots_m[slot]->staged[key] = std::shared_ptr<const TObject>(std::move(payload));
+}
+
+void CheckpointService::commit(unsigned int slot, const EntryRangeSet &entries) {
+  SlotState &state = *slots_m[slot];
+  {
+    std::lock_guard<std::mutex> lock(state.mutex);
+    for (auto &[key, payload] : state.staged) {
+      state.committed[key] = std::move(payload);
+    }
+    state.staged.clear();
+    state.entries = entries;
+  }
+  std::lock_guard<std::mutex> lock(writerMutex_m);
+  dirty_m = true;
+}
+
+void CheckpointService::writerLoop() {
+  std::unique_lock<std::mutex> lock(writerMutex_m);
+  while (!stop_m) {
+    writerWake_m.wait_for(lock, interval_m, [this] { return stop_m; });
+    if (stop_m || !dirty_m) {
+      continue;
+    }
+    dirty_m = false;
+    lock.unlock();
+    try {
+      writeCheckpoint();
+    } catch (const std::exception &e) {
+      ctx_m->logger.log(ILogger::Level::Warn,
+                        std::string("CheckpointService: checkpoint not written: ") +
+                            e.what());
+    }
+    lock.lock();
+  }
+}
+
+void CheckpointService::stopWriter() {
+  {
+    std::lock_guard<std::mutex> lock(writerMutex_m);
+    stop_m = true;
+  }
+  writerWake_m.notify_all();
+  if (writer_m.joinable()) {
+    writer_m.join();
+  }
+}
+
+void CheckpointService::writeCheckpoint() {
+  std::lock_guard<std::mutex> writeLock(writeMutex_m);
+  // Copy the payload pointers under the slot locks; the payloads themselves
+  // are never modified once committed.
+  std::map<std::string, std::vector<std::shared_ptr<const TObject>>> parts;
+  EntryRangeSet entries = resumedEntries_m;
+  for (const auto &state : slots_m) {
+    std::lock_guard<std::mutex> lock(state->mutex);
+    for (const auto &[key, payload] : state->committed) {
+      parts[key].push_back(payload);
+    }
+    entries.merge(state->entries);
+  }
+  for (const auto &[key, payload] : restored_m) {
+    parts[key];
+  }
+
+  // Write next to the checkpoint and rename, so that a job killed while
+  // writing leaves the previous checkpoint intact.
+  const std::string tmpPath = path_m + ".tmp";
+  {
+    TFile out(tmpPath.c_str(), "RECREATE");
+    if (out.IsZombie()) {
+      throw std::runtime_error("cannot create '" + tmpPath + "'");
+    }
+    for (const auto &[key, payloads] : parts) {
+      std::unique_ptr<TObject> merged;
+      if (const TObject *restoredPayload = restored(key)) {
+        merged.reset(restoredPayload->Clone());
+      }
+      for (const auto &payload : payloads) {
+        if (!merged) {
+          merged.reset(payload->Clone());
+        } else {
+          mergePayload(*merged, *payload);
+        }
+      }
+      out.WriteTObject(merged.get(), key.c_str());
+    }
+    TObjString record(entries.toString().c_str());
+    out.WriteTObject(&record, kEntriesKey);
+    out.Close();
+  }
+  std::filesystem::rename(tmpPath, path_m);
+}
@@ -0,0 +1,193 @@
+#include <ColumnChunker.h>
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace {
+
+using ColumnChunkerDetail::ColumnAction;
+
+/// Books the action of one column and returns its result.
+using Booker = ROOT::RDF::RResultPtr<ULong64_t> (*)(ROOT::RDF::RNode &,
+                                                    std::shared_ptr<ColumnChunker::State>,
+                                                    const std::string &, std::size_t, bool);
+
+template <typename T, typename Stored>
+ROOT::RDF::RResultPtr<ULong64_t> book(ROOT::RDF::RNode &df,
+                                      std::shared_ptr<ColumnChunker::State> state,
+                                      const std::string &column, std::size_t index, bool last) {
+  return df.Book<T>(ColumnAction<T, Stored>(std::move(state), index, last), {column});
+}
+
+struct ScalarType {
+  std::vector<std::string> names;
+  std::string dtype;
+  Booker booker;
+  /// Books RVecs of this type.
+  Booker vectorBooker;
+};
+
+#define RDF_CHUNKER_TYPE(T, Stored)                                                              \
+  &book<T, Stored>, &book<ROOT::VecOps::RVec<T>, Stored>
+
+const std::vector<ScalarType> &scalarTypes() {
+  static const std::vector<ScalarType> types{
+      {{"float", "Float_t"}, "float32", RDF_CHUNKER_TYPE(float, float)},
+      {{"double", "Double_t"}, "float64", RDF_CHUNKER_TYPE(double, double)},
+      {{"bool", "Bool_t"}, "bool", RDF_CHUNKER_TYPE(bool, std::uint8_t)},
+      {{"char", "Char_t"}, "int8", RDF_CHUNKER_TYPE(char, std::int8_t)},
+      {{"unsigned char", "UChar_t"}, "uint8", RDF_CHUNKER_TYPE(unsigned char, std::uint8_t)},
+      {{"short", "Short_t"}, "int16", RDF_CHUNKER_TYPE(short, std::int16_t)},
+      {{"unsigned short", "UShort_t"}, "uint16", RDF_CHUNKER_TYPE(unsigned short, std::uint16_t)},
+      {{"int", "Int_t"}, "int32", RDF_CHUNKER_TYPE(int, std::int32_t)},
+      {{"unsigned int", "UInt_t"}, "uint32", RDF_CHUNKER_TYPE(unsigned int, std::uint32_t)},
+      {{"Long64_t", "long long"}, "int64", RDF_CHUNKER_TYPE(Long64_t, std::int64_t)},
+      {{"ULong64_t", "unsigned long long"}, "uint64", RDF_CHUNKER_TYPE(ULong64_t, std::uint64_t)},
+      {{"long", "Long_t"}, "int64", RDF_CHUNKER_TYPE(long, std::int64_t)},
+      {{"unsigned long", "ULong_t"}, "uint64", RDF_CHUNKER_TYPE(unsigned long, std::uint64_t)},
+  };
+  return types;
+}
+
+#undef RDF_CHUNKER_TYPE
+
+/// Element type of the RVec type @p type, or empty if it is not one.
+std::string vectorElement(const std::string &type) {
+  for (const std::string prefix : {"ROOT::VecOps::RVec<", "ROOT::RVec<", "RVec<"}) {
+    if (type.size() > prefix.size() && type.compare(0, prefix.size(), prefix) == 0 &&
+        type.back() == '>') {
+      return type.substr(prefix.size(), type.size() - prefix.size() - 1);
+    }
+  }
+  return "";
+}
+
+const ScalarType *findType(const std::string &type) {
+  const std::string element = vectorElement(type);
+  const std::string &scalarName = element.empty() ? type : element;
+  for (const auto &scalar : scalarTypes()) {
+    if (std::find(scalar.names.begin(), scalar.names.end(), scalarName) != scalar.names.end()) {
+      return &scalar;
+    }
+  }
+  return nullptr;
+}
+
+/// Empty buffer for values of NumPy dtype @p dtype.
+ColumnChunker::Data emptyData(const std::string &dtype) {
+  if (dtype == "float32") return std::vector<float>{};
+  if (dtype == "float64") return std::vector<double>{};
+  if (dtype == "int8") return std::vector<std::int8_t>{};
+  if (dtype == "uint8" || dtype == "bool") return std::vector<std::uint8_t>{};
+  if (dtype == "int16") return std::vector<std::int16_t>{};
+  if (dtype == "uint16") return std::vector<std::uint16_t>{};
+  if (dtype == "int32") return std::vector<std::int32_t>{};
+  if (dtype == "uint32") return std::vector<std::uint32_t>{};
+  if (dtype == "int64") return std::vector<std::int64_t>{};
+  return std::vector<std::uint64_t>{};
+}
+
+/// Upper bound of the initial buffer reservation, in rows.
+constexpr std::size_t kMaxReserve = 1 << 16;
+
+} // namespace
+
+ColumnChunker::State::State(std::vector<std::string> columns_, std::vector<std::string> dtypes_,
+                            std::vector<bool> vectors_, std::size_t chunkRows_,
+                            unsigned int nSlots, Callback callback_, bool serialize_)
+    : columns(std::move(columns_)), dtypes(std::move(dtypes_)), vectors(std::move(vectors_)),
+      chunkRows(chunkRows_), slots(nSlots == 0 ? 1 : nSlots), callback(std::move(callback_)),
+      serialize(serialize_) {
+  for (auto &slot : slots) {
+    reset(slot);
+  }
+}
+
+void ColumnChunker::State::reset(Slot &slot) {
+  slot.rows = 0;
+  slot.data.clear();
+  slot.offsets.assign(dtypes.size(), {});
+  for (std::size_t i = 0; i < dtypes.size(); ++i) {
+    slot.data.push_back(emptyData(dtypes[i]));
+    std::visit([this](auto &values) { values.reserve(std::min(chunkRows, kMaxReserve)); },
+               slot.data.back());
+    if (vectors[i]) {
+      slot.offsets[i].reserve(std::min(chunkRows, kMaxReserve) + 1);
+      slot.offsets[i].push_back(0);
+    }
+  }
+}
+
+void ColumnChunker::State::rowDone(unsigned int slot) {
+  if (++slots[slot].rows >= chunkRows) {
+    emit(slot);
+  }
+}
+
+void ColumnChunker::State::emit(unsigned int slot) {
+  Slot &buffers = slots[slot];
+  if (buffers.rows == 0) {
+    return;
+  }
+  Chunk chunk{columns, dtypes, std::move(buffers.data), std::move(buffers.offsets), buffers.rows,
+              slot};
+  reset(buffers);
+  delivered += chunk.rows;
+  if (!serialize) {
+    callback(std::move(chunk));
+    return;
+  }
+  std::lock_guard<std::mutex> lock(callbackMutex);
+  callback(std::move(chunk));
+}
+
+ColumnChunker::ColumnChunker(ROOT::RDF::RNode df, std::vector<std::string> columns,
+                             std::size_t chunkRows, Callback callback, bool serialize)
+    : df_m(std::move(df)) {
+  if (columns.empty()) {
+    throw std::runtime_error("ColumnChunker: no columns selected");
+  }
+  const auto available = df_m.GetColumnNames();
+  std::vector<Booker> bookers;
+  std::vector<std::string> dtypes;
+  std::vector<bool> vectors;
+  for (const auto &column : columns) {
+    const bool defined = std::find(available.begin(), available.end(), column) != available.end() ||
+                         column == "rdfentry_" || column == "rdfslot_";
+    if (!defined) {
+      throw std::runtime_error("ColumnChunker: column '" + column + "' does not exist");
+    }
+    const std::string type = df_m.GetColumnType(column);
+    const ScalarType *scalar = findType(type);
+    if (!scalar) {
+      throw std::runtime_error("ColumnChunker: column '" + column + "' has type '" + type +
+                               "'; only numeric scalar and RVec columns can be exported");
+    }
+    vectors.push_back(isVector(type));
+    bookers.push_back(vectors.back() ? scalar->vectorBooker : scalar->booker);
+    dtypes.push_back(scalar->dtype);
+  }
+
+  state_m = std::make_shared<State>(columns, dtypes, vectors, std::max<std::size_t>(chunkRows, 1),
+                                    df_m.GetNSlots(), std::move(callback), serialize);
+  // Actions run in booking order for each entry, so the last one completes
+  // the row.
+  for (std::size_t i = 0; i < columns.size(); ++i) {
+    done_m = bookers[i](df_m, state_m, columns[i], i, i + 1 == columns.size());
+  }
+}
+
+std::size_t ColumnChunker::run() {
+  done_m.GetValue();
+  for (unsigned int slot = 0; slot < state_m->slots.size(); ++slot) {
+    state_m->emit(slot);
+  }
+  return state_m->delivered;
+}
+
+std::string ColumnChunker::dtypeOf(const std::string &type) {
+  const ScalarType *scalar = findType(type);
+  return scalar ? scalar->dtype : std::string();
+}
+
+bool ColumnChunker::isVector(const std::string &type) { return !vectorElement(type).empty(); }
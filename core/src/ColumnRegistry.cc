@@ -0,0 +1,43 @@
+#include <ColumnRegistry.h>
+
+bool ColumnRegistry::has(const std::string &name, ROOT::RDF::RNode &node) {
+  sync(node);
+  return types_m.count(name) != 0;
+}
+
+std::string ColumnRegistry::type(const std::string &name, ROOT::RDF::RNode &node) {
+  sync(node);
+  auto it = types_m.find(name);
+  if (it == types_m.end()) {
+    // Unknown to the registry: let RDataFrame report the error.
+    return node.GetColumnType(name);
+  }
+  if (it->second.empty()) {
+    it->second = node.GetColumnType(name);
+  }
+  return it->second;
+}
+
+void ColumnRegistry::add(const std::string &name) {
+  if (synced_m) {
+    types_m[name].clear();
+  }
+}
+
+void ColumnRegistry::invalidate() {
+  types_m.clear();
+  synced_m = false;
+}
+
+void ColumnRegistry::sync(ROOT::RDF::RNode &node) {
+  if (synced_m) {
+    return;
+  }
+  const auto names = node.GetColumnNames();
+  types_m.reserve(names.size());
+  for (const auto &name : names) {
+    types_m.emplace(name, std::string());
+  }
+  synced_m = true;
+  ++syncs_m;
+}
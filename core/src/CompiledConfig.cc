@@ -0,0 +1,172 @@
+#include <CompiledConfig.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <utility>
+
+namespace {
+
+constexpr char kMagic[8] = {'R', 'D', 'F', 'C', 'O', 'N', 'F', 'G'};
+constexpr std::uint32_t kVersion = 1;
+
+void putCount(std::string &out, std::size_t count) {
+  const auto value = static_cast<std::uint32_t>(count);
+  out.append(reinterpret_cast<const char *>(&value), sizeof(value));
+}
+
+void putString(std::string &out, const std::string &value) {
+  putCount(out, value.size());
+  out += value;
+}
+
+void putMap(std::string &out, const CompiledConfig::PairConfig &map) {
+  std::vector<std::pair<std::string, std::string>> sorted(map.begin(), map.end());
+  std::sort(sorted.begin(), sorted.end());
+  putCount(out, sorted.size());
+  for (const auto &[key, value] : sorted) {
+    putString(out, key);
+    putString(out, value);
+  }
+}
+
+/// Keys of @p map in sorted order, so that equal configs compile to equal files.
+template <typename Map> std::vector<std::string> sortedKeys(const Map &map) {
+  std::vector<std::string> keys;
+  keys.reserve(map.size());
+  for (const auto &entry : map) {
+    keys.push_back(entry.first);
+  }
+  std::sort(keys.begin(), keys.end());
+  return keys;
+}
+
+/// Bounds-checked reader over the file contents.
+class Reader {
+public:
+  Reader(const std::string &data, const std::string &path) : data_m(data), path_m(path) {}
+
+  std::uint32_t count() {
+    std::uint32_t value;
+    std::memcpy(&value, take(sizeof(value)), sizeof(value));
+    return value;
+  }
+
+  std::string string() {
+    const auto length = count();
+    return std::string(take(length), length);
+  }
+
+  CompiledConfig::PairConfig map() {
+    CompiledConfig::PairConfig map;
+    const auto n = count();
+    map.reserve(n);
+    for (std::uint32_t i = 0; i < n; ++i) {
+      auto key = string();
+      map.emplace(std::move(key), string());
+    }
+    return map;
+  }
+
+  const char *take(std::size_t bytes) {
+    if (data_m.size() - offset_m < bytes) {
+      throw std::runtime_error("CompiledConfig: " + path_m + " is truncated");
+    }
+    const char *begin = data_m.data() + offset_m;
+    offset_m += bytes;
+    return begin;
+  }
+
+private:
+  const std::string &data_m;
+  const std::string &path_m;
+  std::size_t offset_m = 0;
+};
+
+} // namespace
+
+bool CompiledConfig::isCompiled(const std::string &path) {
+  std::ifstream in(path, std::ios::binary);
+  char magic[sizeof(kMagic)];
+  return in.read(magic, sizeof(magic)) && std::memcmp(magic, kMagic, sizeof(kMagic)) == 0;
+}
+
+void CompiledConfig::write(const std::string &path) const {
+  std::string out(kMagic, sizeof(kMagic));
+  out.append(reinterpret_cast<const char *>(&kVersion), sizeof(kVersion));
+  putString(out, source);
+  putMap(out, top);
+
+  putCount(out, pairs.size());
+  for (const auto &key : sortedKeys(pairs)) {
+    putString(out, key);
+    putMap(out, pairs.at(key));
+  }
+  putCount(out, multiKeys.size());
+  for (const auto &key : sortedKeys(multiKeys)) {
+    const auto &entries = multiKeys.at(key);
+    putString(out, key);
+    putCount(out, entries.size());
+    for (const auto &entry : entries) {
+      putMap(out, entry);
+    }
+  }
+  putCount(out, vectors.size());
+  for (const auto &key : sortedKeys(vectors)) {
+    const auto &values = vectors.at(key);
+    putString(out, key);
+    putCount(out, values.size());
+    for (const auto &value : values) {
+      putString(out, value);
+    }
+  }
+
+  std::ofstream file(path, std::ios::binary | std::ios::trunc);
+  if (!file.write(out.data(), static_cast<std::streamsize>(out.size()))) {
+    throw std::runtime_error("CompiledConfig: cannot write " + path);
+  }
+}
+
+CompiledConfig CompiledConfig::read(const std::string &path) {
+  std::ifstream file(path, std::ios::binary);
+  if (!file) {
+    throw std::runtime_error("CompiledConfig: cannot open " + path);
+  }
+  const std::string data((std::istreambuf_iterator<char>(file)),
+                         std::istreambuf_iterator<char>());
+  Reader in(data, path);
+  if (std::memcmp(in.take(sizeof(kMagic)), kMagic, sizeof(kMagic)) != 0) {
+    throw std::runtime_error("CompiledConfig: " + path + " is not a compiled config");
+  }
+  const auto version = in.count();
+  if (version != kVersion) {
+    throw std::runtime_error("CompiledConfig: " + path + " has unsupported version " +
+                             std::to_string(version));
+  }
+
+  CompiledConfig config;
+  config.source = in.string();
+  config.top = in.map();
+  for (auto n = in.count(); n > 0; --n) {
+    auto key = in.string();
+    config.pairs.emplace(std::move(key), in.map());
+  }
+  for (auto n = in.count(); n > 0; --n) {
+    auto &entries = config.multiKeys[in.string()];
+    entries.resize(in.count());
+    for (auto &entry : entries) {
+      entry = in.map();
+    }
+  }
+  for (auto n = in.count(); n > 0; --n) {
+    auto &values = config.vectors[in.string()];
+    values.resize(in.count());
+    for (auto &value : values) {
+      value = in.string();
+    }
+  }
+  return config;
+}
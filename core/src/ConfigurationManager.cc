@@ -1,9 +1,65 @@
 #include <ConfigurationManager.h>
+#include <AsyncLogger.h>
 #include <TextConfigAdapter.h>
 #include <YamlConfigAdapter.h>
+#include <algorithm>
 #include <stdexcept>
 #include <filesystem>
 #include <iostream>
+#include <mutex>
+#include <system_error>
+#include <unordered_set>
+
+/**
+ * @brief Memoized results of parsePairBasedConfig(), parseMultiKeyConfig()
+ * and parseVectorConfig(), keyed by resolved path.
+ *
+ * Multi-key configs are cached unfiltered and filtered per call, since
+ * callers ask for different required keys.
+ */
+struct ConfigurationManager::ParseCache {
+  template <typename T> struct Entry {
+    std::uintmax_t size = 0;
+    std::filesystem::file_time_type mtime;
+    T value;
+  };
+  using PairConfig = std::unordered_map<std::string, std::string>;
+  using MultiKeyConfig = std::vector<std::unordered_map<std::string, std::string>>;
+  using VectorConfig = std::vector<std::string>;
+
+  std::mutex mutex;
+  std::unordered_map<std::string, Entry<PairConfig>> pairs;
+  std::unordered_map<std::string, Entry<MultiKeyConfig>> multiKeys;
+  std::unordered_map<std::string, Entry<VectorConfig>> vectors;
+
+  /**
+   * @brief Cached value of @p path in @p entries, or the result of @p parse.
+   * Files that cannot be stat'ed are parsed uncached so the parser reports
+   * the error.
+   */
+  template <typename T, typename Parse>
+  T get(std::unordered_map<std::string, Entry<T>> &entries, const std::string &path,
+        Parse &&parse) {
+    std::error_code ec;
+    const auto size = std::filesystem::file_size(path, ec);
+    const auto mtime = ec ? std::filesystem::file_time_type() :
+                            std::filesystem::last_write_time(path, ec);
+    if (ec) {
+      return parse();
+    }
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      auto it = entries.find(path);
+      if (it != entries.end() && it->second.size == size && it->second.mtime == mtime) {
+        return it->second.value;
+      }
+    }
+    T value = parse();
+    std::lock_guard<std::mutex> lock(mutex);
+    entries[path] = Entry<T>{size, mtime, value};
+    return value;
+  }
+};
 
 namespace {
   // Helper function for C++17 compatibility (ends_with is C++20)
@@ -22,7 +78,8 @@ namespace {
  * @brief Construct a new ConfigurationManager object
  * @param configFile Path to the configuration file
  */
-ConfigurationManager::ConfigurationManager(const std::string &configFile) {
+ConfigurationManager::ConfigurationManager(const std::string &configFile)
+    : parseCache_m(std::make_shared<ParseCache>()) {
   // Auto-detect format based on file extension
   if (endsWith(configFile, ".yaml") || endsWith(configFile, ".yml")) {
     adapter_m = std::make_shared<YamlConfigAdapter>();
@@ -34,7 +91,7 @@ ConfigurationManager::ConfigurationManager(const std::string &configFile) {
 
 ConfigurationManager::ConfigurationManager(const std::string &configFile,
                                            std::shared_ptr<IConfigAdapter> adapter)
-    : adapter_m(std::move(adapter)) {
+    : adapter_m(std::move(adapter)), parseCache_m(std::make_shared<ParseCache>()) {
   if (!adapter_m) {
     adapter_m = std::make_shared<TextConfigAdapter>();
   }
@@ -60,8 +117,8 @@ std::string ConfigurationManager::get(const std::string &key) const {
   if (it != configMap_m.end()) {
     return it->second;
   }
-  std::cerr << "Warning: Configuration key '" << key
-            << "' from config file '" << configFile_m << "' not found. Returning empty string." << std::endl;
+  RDF_LOG_WARN << "Warning: Configuration key '" << key
+               << "' from config file '" << configFile_m << "' not found. Returning empty string.";
   return "";
 }
 
@@ -151,8 +208,15 @@ void ConfigurationManager::processTopLevelConfig(
     }
   }
   
-  configMap_m = adapter_m->parsePairBasedConfig(configFile);
   configFile_m = configFile; // Store the original config file path for reference
+  if (CompiledConfig::isCompiled(configFile)) {
+    compiled_m = std::make_shared<const CompiledConfig>(CompiledConfig::read(configFile));
+    configMap_m = compiled_m->top;
+    RDF_LOG_DEBUG << "ConfigurationManager: read compiled config " << configFile
+                  << " (from " << compiled_m->source << ")";
+    return;
+  }
+  configMap_m = adapter_m->parsePairBasedConfig(configFile);
 }
 
 /**
@@ -207,12 +271,20 @@ std::string ConfigurationManager::resolveConfigPath(const std::string &path) con
 std::unordered_map<std::string, std::string>
 ConfigurationManager::parsePairBasedConfig(
     const std::string &configFile) const {
-  const std::string resolvedPath = resolveConfigPath(configFile);
-  if (isYamlFile(resolvedPath)) {
-    YamlConfigAdapter yamlAdapter;
-    return yamlAdapter.parsePairBasedConfig(resolvedPath);
+  if (compiled_m) {
+    const auto it = compiled_m->pairs.find(configFile);
+    if (it != compiled_m->pairs.end()) {
+      return it->second;
+    }
   }
-  return adapter_m->parsePairBasedConfig(resolvedPath);
+  const std::string resolvedPath = resolveConfigPath(configFile);
+  return parseCache_m->get(parseCache_m->pairs, resolvedPath, [&] {
+    if (isYamlFile(resolvedPath)) {
+      YamlConfigAdapter yamlAdapter;
+      return yamlAdapter.parsePairBasedConfig(resolvedPath);
+    }
+    return adapter_m->parsePairBasedConfig(resolvedPath);
+  });
 }
 
 /**
@@ -230,12 +302,33 @@ std::vector<std::unordered_map<std::string, std::string>>
 ConfigurationManager::parseMultiKeyConfig(
     const std::string &configFile,
     const std::vector<std::string> &requiredEntryKeys) const {
-  const std::string resolvedPath = resolveConfigPath(configFile);
-  if (isYamlFile(resolvedPath)) {
-    YamlConfigAdapter yamlAdapter;
-    return yamlAdapter.parseMultiKeyConfig(resolvedPath, requiredEntryKeys);
-  }
-  return adapter_m->parseMultiKeyConfig(resolvedPath, requiredEntryKeys);
+  auto entries = [&]() -> ParseCache::MultiKeyConfig {
+    if (compiled_m) {
+      const auto it = compiled_m->multiKeys.find(configFile);
+      if (it != compiled_m->multiKeys.end()) {
+        return it->second;
+      }
+    }
+    const std::string resolvedPath = resolveConfigPath(configFile);
+    return parseCache_m->get(parseCache_m->multiKeys, resolvedPath, [&] {
+      if (isYamlFile(resolvedPath)) {
+        YamlConfigAdapter yamlAdapter;
+        return yamlAdapter.parseMultiKeyConfig(resolvedPath, {});
+      }
+      return adapter_m->parseMultiKeyConfig(resolvedPath, {});
+    });
+  }();
+  // Entries without all required keys are skipped.
+  entries.erase(std::remove_if(entries.begin(), entries.end(),
+                               [&](const auto &entry) {
+                                 return std::any_of(requiredEntryKeys.begin(),
+                                                    requiredEntryKeys.end(),
+                                                    [&](const std::string &key) {
+                                                      return entry.count(key) == 0;
+                                                    });
+                               }),
+                entries.end());
+  return entries;
 }
 
 /**
@@ -249,12 +342,20 @@ ConfigurationManager::parseMultiKeyConfig(
  */
 std::vector<std::string>
 ConfigurationManager::parseVectorConfig(const std::string &configFile) const {
-  const std::string resolvedPath = resolveConfigPath(configFile);
-  if (isYamlFile(resolvedPath)) {
-    YamlConfigAdapter yamlAdapter;
-    return yamlAdapter.parseVectorConfig(resolvedPath);
+  if (compiled_m) {
+    const auto it = compiled_m->vectors.find(configFile);
+    if (it != compiled_m->vectors.end()) {
+      return it->second;
+    }
   }
-  return adapter_m->parseVectorConfig(resolvedPath);
+  const std::string resolvedPath = resolveConfigPath(configFile);
+  return parseCache_m->get(parseCache_m->vectors, resolvedPath, [&] {
+    if (isYamlFile(resolvedPath)) {
+      YamlConfigAdapter yamlAdapter;
+      return yamlAdapter.parseVectorConfig(resolvedPath);
+    }
+    return adapter_m->parseVectorConfig(resolvedPath);
+  });
 }
 
 /**
@@ -272,4 +373,69 @@ ConfigurationManager::getList(const std::string &key,
     return splitString(configMap_m.at(key), delimiter);
   }
   return defaultValue;
-}
\ No newline at end of file
+}
+
+namespace {
+  /// Whether @p path names an existing file with a config extension.
+  bool isConfigFile(const std::string &path) {
+    std::error_code ec;
+    if (path.empty() || !std::filesystem::is_regular_file(path, ec)) {
+      return false;
+    }
+    return isYamlFile(path) || endsWith(path, ".txt") || endsWith(path, ".cfg");
+  }
+}
+
+/**
+ * @brief Write this configuration as a compiled config
+ *
+ * Sub-configs are found breadth-first from the top-level values; each path
+ * is visited once.
+ */
+CompiledConfig ConfigurationManager::compile(const std::string &outputFile) const {
+  if (compiled_m) {
+    // The sources need not exist next to a compiled config; keep its contents.
+    CompiledConfig compiled = *compiled_m;
+    compiled.top = configMap_m;
+    compiled.write(outputFile);
+    return compiled;
+  }
+  CompiledConfig compiled;
+  compiled.source = configFile_m;
+  compiled.top = configMap_m;
+
+  std::vector<std::string> pending;
+  std::unordered_set<std::string> visited;
+  const auto enqueue = [&](const std::unordered_map<std::string, std::string> &map) {
+    for (const auto &[key, value] : map) {
+      if (visited.insert(value).second && isConfigFile(resolveConfigPath(value))) {
+        pending.push_back(value);
+      }
+    }
+  };
+  enqueue(configMap_m);
+  for (std::size_t i = 0; i < pending.size(); ++i) {
+    const std::string path = pending[i];
+    // A file is stored in every form that parses; the plugins ask for one.
+    try {
+      auto pairs = parsePairBasedConfig(path);
+      enqueue(pairs);
+      compiled.pairs.emplace(path, std::move(pairs));
+    } catch (const std::exception &) {
+    }
+    try {
+      // Entry values (model, correction, JSON files) are data, not configs.
+      compiled.multiKeys.emplace(path, parseMultiKeyConfig(path, {}));
+    } catch (const std::exception &) {
+    }
+    try {
+      compiled.vectors.emplace(path, parseVectorConfig(path));
+    } catch (const std::exception &) {
+    }
+  }
+
+  compiled.write(outputFile);
+  RDF_LOG_INFO << "ConfigurationManager: compiled " << compiled.source << " with "
+               << pending.size() << " sub-config(s) into " << outputFile;
+  return compiled;
+}
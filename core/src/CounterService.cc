@@ -1,17 +1,22 @@
 #include <CounterService.h>
+#include <AsyncLogger.h>
 #include <RtypesCore.h>
 #include <api/IConfigurationProvider.h>
 #include <api/IDataFrameProvider.h>
 #include <api/ILogger.h>
 #include <api/IOutputSink.h>
 #include <NullOutputSink.h>
+#include <SampleSet.h>
 #include <TFile.h>
 #include <TH1D.h>
 #include <TObject.h>
+#include <TTree.h>
 #include <chrono>
+#include <cmath>
 #include <iostream>
 #include <sstream>
 #include <iomanip>
+#include <stdexcept>
 
 void CounterService::initialize(ManagerContext& ctx) {
   ctx_m = &ctx;
@@ -41,15 +46,20 @@ void CounterService::initialize(ManagerContext& ctx) {
     intWeightBranch_m = configMap.at("counterIntWeightBranch");
   }
   preFilterDf_m = ctx.data.getDataFrame();
-  countResult = preFilterDf_m->Count();
-
   if (!weightBranch_m.empty()) {
-    weightSumResult = preFilterDf_m->Sum<Float_t>(weightBranch_m);
-    weightSignSumResult = preFilterDf_m->Define("__counter_sign_weight", [](Float_t w) {
-      return Int_t((w > 0.0) - (w < 0.0));
-    }, {weightBranch_m}).Sum<Int_t>("__counter_sign_weight");
+    ctx.data.recordColumnsRead({weightBranch_m});
   }
 
+  // Fill the int-weight histogram in the counters action itself when its
+  // branch is already defined; otherwise onPreFilter() books it.
+  if (!intWeightBranch_m.empty() && ctx.data.hasColumn(intWeightBranch_m)) {
+    intWeightHistBranch_m = intWeightBranch_m;
+    ctx.data.recordColumnsRead({intWeightBranch_m});
+    countersResult_m = bookCounters(*preFilterDf_m, intWeightBranch_m, intWeightBinning());
+    intWeightHistResult_m = countersResult_m;
+  } else {
+    countersResult_m = bookCounters(*preFilterDf_m, "", CounterAction::Binning{});
+  }
 
   // record start time for processing-speed measurement
   startTime_m = std::chrono::steady_clock::now();
@@ -67,34 +77,128 @@ void CounterService::bookIntWeightHistogram(ROOT::RDF::RNode df,
     if (ctx_m) {
       ctx_m->logger.log(ILogger::Level::Warn, msg);
     } else {
-      std::cerr << "[WARNING] " << msg << std::endl;
+      RDF_LOG_WARN << "[WARNING] " << msg;
     }
   }
 
   intWeightHistBranch_m = branch;
+  if (ctx_m) {
+    ctx_m->data.recordColumnsRead({branch, weightBranch_m});
+  }
 
-  const std::string histName  = "counter_intWeightSum_"     + sampleName_m;
-  const std::string histTitle = "Counter intWeightSum;"     + branch + ";sumWeights";
-  ROOT::RDF::TH1DModel model(histName.c_str(), histTitle.c_str(), nBins, low, high);
+  intWeightHistResult_m = bookCounters(df, branch, CounterAction::Binning{nBins, low, high});
+}
 
-  if (!weightBranch_m.empty()) {
-    intWeightHistResult_m = df.Histo1D(model, branch, weightBranch_m);
-  } else {
-    intWeightHistResult_m = df.Histo1D(model, branch);
+CounterAction::Binning CounterService::intWeightBinning() const {
+  CounterAction::Binning binning{10, -0.5, 9.5};
+  if (ctx_m) {
+    const auto& configMap = ctx_m->config.getConfigMap();
+    auto it_bins = configMap.find("counterIntWeightBranchNBins");
+    auto it_low  = configMap.find("counterIntWeightBranchMin");
+    auto it_high = configMap.find("counterIntWeightBranchMax");
+    if (it_bins != configMap.end()) {
+      try { binning.nBins = std::stoi(it_bins->second); } catch (...) {}
+    }
+    if (it_low != configMap.end()) {
+      try { binning.low = std::stod(it_low->second); } catch (...) {}
+    }
+    if (it_high != configMap.end()) {
+      try { binning.high = std::stod(it_high->second); } catch (...) {}
+    }
   }
+  return binning;
+}
 
-  // Book companion sign-weight-per-bin histogram when a weight branch is available
-  if (!weightBranch_m.empty()) {
-    const std::string signHistName  = "counter_intWeightSignSum_" + sampleName_m;
-    const std::string signHistTitle = "Counter intWeightSignSum;" + branch + ";sumSignWeights";
-    ROOT::RDF::TH1DModel signModel(signHistName.c_str(), signHistTitle.c_str(), nBins, low, high);
+namespace {
+
+using CounterBooker = ROOT::RDF::RResultPtr<CounterResult> (*)(
+    ROOT::RDF::RNode&, CounterAction&&, const std::string&, const std::string&);
+
+template <typename Code>
+ROOT::RDF::RResultPtr<CounterResult> bookWithCode(ROOT::RDF::RNode& df, CounterAction&& action,
+                                                  const std::string& weight,
+                                                  const std::string& code) {
+  if (weight.empty()) {
+    return df.Book<Code>(std::move(action), {code});
+  }
+  return df.Book<Float_t, Code>(std::move(action), {weight, code});
+}
+
+CounterBooker counterBookerFor(const std::string& type) {
+  if (type == "int" || type == "Int_t") return &bookWithCode<Int_t>;
+  if (type == "unsigned int" || type == "UInt_t") return &bookWithCode<UInt_t>;
+  if (type == "long" || type == "Long_t") return &bookWithCode<Long_t>;
+  if (type == "long long" || type == "Long64_t") return &bookWithCode<Long64_t>;
+  if (type == "unsigned long" || type == "ULong_t") return &bookWithCode<ULong_t>;
+  if (type == "unsigned long long" || type == "ULong64_t") return &bookWithCode<ULong64_t>;
+  if (type == "short" || type == "Short_t") return &bookWithCode<Short_t>;
+  if (type == "unsigned short" || type == "UShort_t") return &bookWithCode<UShort_t>;
+  if (type == "unsigned char" || type == "UChar_t") return &bookWithCode<UChar_t>;
+  if (type == "bool" || type == "Bool_t") return &bookWithCode<Bool_t>;
+  if (type == "float" || type == "Float_t") return &bookWithCode<Float_t>;
+  if (type == "double" || type == "Double_t") return &bookWithCode<Double_t>;
+  return nullptr;
+}
+
+// Stand-alone TH1D of the code histogram of a counters result.
+void writeCodeHistogram(TFile& outFile, const CounterResult& counters, const std::string& name,
+                        const std::string& title, const std::vector<Double_t>& sumw,
+                        const std::vector<Double_t>& sumw2) {
+  TH1D hist(name.c_str(), title.c_str(), counters.nBins, counters.low, counters.high);
+  hist.Sumw2();
+  for (std::size_t bin = 0; bin < sumw.size(); ++bin) {
+    hist.SetBinContent(static_cast<int>(bin), sumw[bin]);
+    hist.SetBinError(static_cast<int>(bin), std::sqrt(sumw2[bin]));
+  }
+  hist.SetEntries(static_cast<Double_t>(counters.total.entries));
+  hist.SetDirectory(&outFile);
+  hist.Write(hist.GetName(), TObject::kOverwrite);
+}
 
-    // Define the sign-weight column on the df that already has the int branch
-    auto signDf = df.Define("__counter_int_sign_weight", [](Float_t w) {
-      return Int_t((w > 0.0) - (w < 0.0));
-    }, {weightBranch_m});
-    intWeightSignHistResult_m = signDf.Histo1D(signModel, branch, "__counter_int_sign_weight");
+// Weight and sign sums of @p totals as the one-bin counter histograms of
+// sample @p sample.
+void writeWeightHistograms(TFile& outFile, const CounterTotals& totals, const std::string& sample,
+                           const std::string& weightBranch) {
+  TH1D weightSignSumHist(("counter_weightSignSum_" + sample).c_str(),
+                         ("Counter weightSignSum;" + weightBranch + ";sumSignWeights").c_str(),
+                         1, 0, 1);
+  weightSignSumHist.SetBinContent(1, totals.sumSign);
+  weightSignSumHist.SetDirectory(&outFile);
+  weightSignSumHist.Write("", TObject::kOverwrite);
+
+  // The bin error carries the sum of squared weights.
+  TH1D weightSumHist(("counter_weightSum_" + sample).c_str(),
+                     ("Counter weightSum;" + weightBranch + ";sumWeights").c_str(), 1, 0, 1);
+  weightSumHist.SetBinContent(1, totals.sumw);
+  weightSumHist.SetBinError(1, std::sqrt(totals.sumw2));
+  weightSumHist.SetDirectory(&outFile);
+  weightSumHist.Write("", TObject::kOverwrite);
+}
+
+} // namespace
+
+/**
+ * @brief Book one CounterAction reading the weight branch and, when
+ *        @p codeBranch is set, histogramming it with @p binning.
+ */
+ROOT::RDF::RResultPtr<CounterResult>
+CounterService::bookCounters(ROOT::RDF::RNode df, const std::string& codeBranch,
+                             CounterAction::Binning binning) {
+  if (codeBranch.empty()) {
+    binning.nBins = 0;
   }
+  CounterAction action(df.GetNSlots(), !weightBranch_m.empty(), binning);
+  if (codeBranch.empty()) {
+    if (weightBranch_m.empty()) {
+      return df.Book<>(std::move(action), {});
+    }
+    return df.Book<Float_t>(std::move(action), {weightBranch_m});
+  }
+  if (const auto book = counterBookerFor(df.GetColumnType(codeBranch))) {
+    return book(df, std::move(action), weightBranch_m, codeBranch);
+  }
+  ROOT::RDF::RNode codeDf = df.Define("__counter_int_code", "static_cast<Double_t>(" + codeBranch + ")");
+  return bookWithCode<Double_t>(codeDf, std::move(action), weightBranch_m, "__counter_int_code");
 }
 
 void CounterService::onPreFilter(ROOT::RDF::RNode& df) {
@@ -103,27 +207,8 @@ void CounterService::onPreFilter(ROOT::RDF::RNode& df) {
   // Must happen before filtersApplied_m is set to avoid the "called after
   // filters" warning inside bookIntWeightHistogram.
   if (!intWeightBranch_m.empty() && !intWeightHistResult_m.has_value()) {
-    int    nBins = 10;
-    double low   = -0.5;
-    double high  = 9.5;
-
-    if (ctx_m) {
-      const auto& configMap = ctx_m->config.getConfigMap();
-      auto it_bins = configMap.find("counterIntWeightBranchNBins");
-      auto it_low  = configMap.find("counterIntWeightBranchMin");
-      auto it_high = configMap.find("counterIntWeightBranchMax");
-      if (it_bins != configMap.end()) {
-        try { nBins = std::stoi(it_bins->second); } catch (...) {}
-      }
-      if (it_low != configMap.end()) {
-        try { low = std::stod(it_low->second); } catch (...) {}
-      }
-      if (it_high != configMap.end()) {
-        try { high = std::stod(it_high->second); } catch (...) {}
-      }
-    }
-
-    bookIntWeightHistogram(df, intWeightBranch_m, nBins, low, high);
+    const CounterAction::Binning binning = intWeightBinning();
+    bookIntWeightHistogram(df, intWeightBranch_m, binning.nBins, binning.low, binning.high);
   }
 
   filtersApplied_m = true;
@@ -139,7 +224,8 @@ void CounterService::finalize(ROOT::RDF::RNode& df) {
     throw std::runtime_error("CounterService: meta output sink is null");
   }
 
-  unsigned long long selectedCountValue = countResult.GetValue();
+  const CounterResult& counters = countersResult_m.GetValue();
+  unsigned long long selectedCountValue = counters.total.entries;
 
   // compute elapsed time from initialize() -> finalize()
   double elapsed_s = 0.0;
@@ -168,18 +254,26 @@ void CounterService::finalize(ROOT::RDF::RNode& df) {
                     "CounterService: sample=" + sampleName_m +
                     " processingSpeed=" + format_khz(selectedCountValue) + " kHz (elapsed=" + ss_elapsed.str() + " s)");
 
-  if (!weightBranch_m.empty() && weightSignSumResult) {
-    auto signWeightValue = weightSignSumResult.GetValue();
+  if (!weightBranch_m.empty()) {
     ctx_m->logger.log(ILogger::Level::Info,
                       "CounterService: sample=" + sampleName_m +
-                      " weightSignSum(" + weightBranch_m + ")=" + std::to_string(signWeightValue));
-  }
-
-  if (weightSumResult) {
-    auto weightSumValue = weightSumResult.GetValue();
+                      " weightSignSum(" + weightBranch_m + ")=" +
+                      std::to_string(static_cast<long long>(counters.total.sumSign)));
     ctx_m->logger.log(ILogger::Level::Info,
                       "CounterService: sample=" + sampleName_m +
-                      " weightSum(" + weightBranch_m + ")=" + std::to_string(weightSumValue));
+                      " weightSum(" + weightBranch_m + ")=" + std::to_string(counters.total.sumw));
+  }
+
+  // A multi-sample job also reports the totals of each sample.
+  const std::vector<std::pair<std::string, CounterTotals>> sampleTotals =
+      totalsPerSample(counters);
+  for (const auto& [name, totals] : sampleTotals) {
+    std::string line = "CounterService: sample=" + name + " entries=" +
+                       std::to_string(totals.entries);
+    if (!weightBranch_m.empty()) {
+      line += " weightSum(" + weightBranch_m + ")=" + std::to_string(totals.sumw);
+    }
+    ctx_m->logger.log(ILogger::Level::Info, line);
   }
 
   std::string fileName = ctx_m->metaSink.resolveOutputFile(ctx_m->config, OutputChannel::Meta);
@@ -191,46 +285,89 @@ void CounterService::finalize(ROOT::RDF::RNode& df) {
       return;
     }
 
-    if (!weightBranch_m.empty() && weightSignSumResult) {
-      auto signWeightValue = weightSignSumResult.GetValue();
-      TH1D weightSignSumHist(("counter_weightSignSum_" + sampleName_m).c_str(), ("Counter weightSignSum;" + weightBranch_m + ";sumSignWeights").c_str(), 1, 0, 1);
-      weightSignSumHist.SetBinContent(1, signWeightValue);
-      weightSignSumHist.SetDirectory(&outFile);
-      weightSignSumHist.Write("", TObject::kOverwrite);
+    if (!weightBranch_m.empty()) {
+      writeWeightHistograms(outFile, counters.total, sampleName_m, weightBranch_m);
+      for (const auto& [name, totals] : sampleTotals) {
+        writeWeightHistograms(outFile, totals, name, weightBranch_m);
+      }
     }
 
-    if (weightSumResult) {
-      auto weightSumValue = weightSumResult.GetValue();
-      TH1D weightSumHist(("counter_weightSum_" + sampleName_m).c_str(),
-                         ("Counter weightSum;" + weightBranch_m + ";sumWeights").c_str(),
-                         1, 0, 1);
-      weightSumHist.SetBinContent(1, weightSumValue);
-      weightSumHist.SetDirectory(&outFile);
-      weightSumHist.Write("", TObject::kOverwrite);
+    // Per-file totals, for bookkeeping of partially reprocessed samples
+    if (!counters.files.empty()) {
+      outFile.cd();
+      TTree filesTree(("counter_files_" + sampleName_m).c_str(), "Counter totals per input file");
+      std::string file;
+      ULong64_t entries = 0;
+      Double_t sumw = 0.0, sumSign = 0.0, sumw2 = 0.0;
+      filesTree.Branch("file", &file);
+      filesTree.Branch("entries", &entries);
+      filesTree.Branch("weightSum", &sumw);
+      filesTree.Branch("weightSignSum", &sumSign);
+      filesTree.Branch("weightSum2", &sumw2);
+      for (const auto& [url, totals] : counters.files) {
+        file = url;
+        entries = totals.entries;
+        sumw = totals.sumw;
+        sumSign = totals.sumSign;
+        sumw2 = totals.sumw2;
+        filesTree.Fill();
+      }
+      filesTree.Write("", TObject::kOverwrite);
     }
 
-    // Write pre-booked int-weight histograms (booked via bookIntWeightHistogram)
+    // Write the int-weight histograms (booked via bookIntWeightHistogram)
     if (intWeightHistResult_m.has_value()) {
-      auto histPtr = (*intWeightHistResult_m).GetPtr();
-      histPtr->SetDirectory(&outFile);
-      histPtr->Write(histPtr->GetName(), TObject::kOverwrite);
-      ctx_m->logger.log(ILogger::Level::Info,
-                        "CounterService: wrote intWeightSum histogram '" +
-                        std::string(histPtr->GetName()) + "'");
-    }
-    if (intWeightSignHistResult_m.has_value()) {
-      auto signHistPtr = (*intWeightSignHistResult_m).GetPtr();
-      signHistPtr->SetDirectory(&outFile);
-      signHistPtr->Write(signHistPtr->GetName(), TObject::kOverwrite);
+      const CounterResult& intCounters = intWeightHistResult_m->GetValue();
+      const std::string histName = "counter_intWeightSum_" + sampleName_m;
+      writeCodeHistogram(outFile, intCounters, histName,
+                         "Counter intWeightSum;" + intWeightHistBranch_m + ";sumWeights",
+                         intCounters.binSumw, intCounters.binSumw2);
       ctx_m->logger.log(ILogger::Level::Info,
-                        "CounterService: wrote intWeightSignSum histogram '" +
-                        std::string(signHistPtr->GetName()) + "'");
+                        "CounterService: wrote intWeightSum histogram '" + histName + "'");
+      if (!weightBranch_m.empty()) {
+        const std::string signHistName = "counter_intWeightSignSum_" + sampleName_m;
+        writeCodeHistogram(outFile, intCounters, signHistName,
+                           "Counter intWeightSignSum;" + intWeightHistBranch_m + ";sumSignWeights",
+                           intCounters.binSumSign, intCounters.binSumSign2);
+        ctx_m->logger.log(ILogger::Level::Info,
+                          "CounterService: wrote intWeightSignSum histogram '" + signHistName + "'");
+      }
     }
     outFile.Close();
   }
   
 }
 
+/**
+ * @brief Per-file totals summed by the sample (``sampleConfig``) of each
+ *        file; empty for a single-sample job.
+ */
+std::vector<std::pair<std::string, CounterTotals>>
+CounterService::totalsPerSample(const CounterResult& counters) const {
+  const SampleSet samples = SampleSet::fromConfig(ctx_m->config);
+  std::vector<std::pair<std::string, CounterTotals>> result;
+  for (const auto& name : samples.names()) {
+    result.emplace_back(name, CounterTotals{});
+  }
+  for (const auto& [url, totals] : counters.files) {
+    const int sample = samples.sampleOfFile(url);
+    if (sample < 0) {
+      ctx_m->logger.log(ILogger::Level::Warn,
+                        "CounterService: input file '" + url + "' belongs to no sample");
+      continue;
+    }
+    result[sample].second.add(totals);
+  }
+  return result;
+}
+
+const CounterTotals& CounterService::totals() {
+  if (!ctx_m) {
+    throw std::runtime_error("CounterService: totals() called before initialize()");
+  }
+  return countersResult_m.GetValue().total;
+}
+
 // ---------------------------------------------------------------------------
 // collectProvenanceEntries()
 // ---------------------------------------------------------------------------
@@ -1,15 +1,366 @@
 #include <api/IConfigurationProvider.h>
+#include <AsyncLogger.h>
 #include <algorithm>
 #include <ROOT/RVec.hxx>
+#include <CheckpointService.h>
 #include <DataManager.h>
+#include <EntryTrackerAction.h>
+#include <MpiRuntime.h>
+#include <ProvenanceService.h>
+#include <SelectionBitmap.h>
+#include <SkimColumnManifest.h>
 #include <TChain.h>
+#include <TChainElement.h>
+#include <TROOT.h>
+#include <TBranch.h>
+#include <TEntryList.h>
+#include <TLeaf.h>
+#include <TTree.h>
+#include <functional>
 #include <iostream>
 #include <util.h>
 #include <filesystem>
 
+#include <ROOT/RDF/RActionImpl.hxx>
+#include <ROOT/RDF/RColumnRegister.hxx>
+#include <ROOT/RDF/RDefineBase.hxx>
 #include <ROOT/RDFHelpers.hxx>
+#include <ROOT/TTreeProcessorMT.hxx>
 #include <functions.h>
 
+#include <array>
+#include <cctype>
+#include <cmath>
+#include <cstddef>
+#include <fnmatch.h>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <numeric>
+#include <set>
+#include <sstream>
+#include <unordered_map>
+#include <tuple>
+#include <utility>
+
+namespace {
+
+/// Identifiers of a JIT expression; the names of the columns it may read.
+std::vector<std::string> expressionIdentifiers(const std::string &expression) {
+  std::vector<std::string> names;
+  std::size_t i = 0;
+  while (i < expression.size()) {
+    const unsigned char c = expression[i];
+    if (std::isalpha(c) || c == '_') {
+      const std::size_t begin = i;
+      while (i < expression.size() &&
+             (std::isalnum(static_cast<unsigned char>(expression[i])) ||
+              expression[i] == '_')) {
+        ++i;
+      }
+      names.push_back(expression.substr(begin, i - begin));
+    } else if (std::isdigit(c)) {
+      // Skip numeric literals such as 1e5f.
+      while (i < expression.size() &&
+             (std::isalnum(static_cast<unsigned char>(expression[i])) ||
+              expression[i] == '.')) {
+        ++i;
+      }
+    } else {
+      ++i;
+    }
+  }
+  return names;
+}
+
+/// Largest number of scalar columns packed by a precompiled kernel.
+constexpr std::size_t kMaxTypedScalarColumns = 32;
+/// Largest number of RVec columns concatenated by a precompiled kernel.
+constexpr std::size_t kMaxTypedConcatColumns = 8;
+
+/// Element types with precompiled DefineVector kernels.
+enum class VectorElementKind { Float, Double, Int, Bool, Other };
+
+VectorElementKind elementKindFromTypeName(const std::string &typeName) {
+  if (typeName == "Float_t" || typeName == "float") return VectorElementKind::Float;
+  if (typeName == "Double_t" || typeName == "double") return VectorElementKind::Double;
+  if (typeName == "Int_t" || typeName == "int") return VectorElementKind::Int;
+  if (typeName == "Bool_t" || typeName == "bool") return VectorElementKind::Bool;
+  return VectorElementKind::Other;
+}
+
+/// Strip an RVec<...> wrapper from a column type name, if present.
+std::string elementTypeName(const std::string &columnType) {
+  const auto open = columnType.find("RVec<");
+  if (open == std::string::npos) {
+    return columnType;
+  }
+  const auto begin = open + 5;
+  const auto close = columnType.rfind('>');
+  if (close == std::string::npos || close < begin) {
+    return columnType;
+  }
+  std::string element = columnType.substr(begin, close - begin);
+  element.erase(std::remove(element.begin(), element.end(), ' '), element.end());
+  return element;
+}
+
+template <typename InT, std::size_t>
+using ScalarInput = InT;
+
+template <typename InT, std::size_t>
+using VectorInput = ROOT::VecOps::RVec<InT>;
+
+// The kernels take the slot so that one instantiation serves both plain and
+// profiled runs: @p node is null unless node profiling is enabled.
+template <typename OutT, typename InT, std::size_t... I>
+auto makeScalarPackKernel(NodeProfiler::Node *node, bool allocations,
+                          std::index_sequence<I...>) {
+  return [node, allocations](unsigned int slot, ScalarInput<InT, I>... values) {
+    NodeProfiler::Call call(node, slot, allocations);
+    return ROOT::VecOps::RVec<OutT>{static_cast<OutT>(values)...};
+  };
+}
+
+template <typename OutT, typename InT, std::size_t... I>
+auto makeConcatKernel(NodeProfiler::Node *node, bool allocations,
+                      std::index_sequence<I...>) {
+  return [node, allocations](unsigned int slot, const VectorInput<InT, I> &...inputs) {
+    NodeProfiler::Call call(node, slot, allocations);
+    ROOT::VecOps::RVec<OutT> out;
+    out.reserve((inputs.size() + ... + std::size_t{0}));
+    auto append = [&out](const ROOT::VecOps::RVec<InT> &input) {
+      for (const auto &x : input) {
+        out.push_back(static_cast<OutT>(x));
+      }
+    };
+    (append(inputs), ...);
+    return out;
+  };
+}
+
+using VectorKernelDefiner = ROOT::RDF::RNode (*)(ROOT::RDF::RNode,
+                                                 const std::string &,
+                                                 const std::vector<std::string> &,
+                                                 NodeProfiler *);
+
+template <typename OutT, typename InT, std::size_t N>
+ROOT::RDF::RNode defineScalarPack(ROOT::RDF::RNode df, const std::string &name,
+                                  const std::vector<std::string> &columns,
+                                  NodeProfiler *profiler) {
+  return df.Define(name,
+                   makeScalarPackKernel<OutT, InT>(
+                       profiler ? profiler->addNode(name, "define_vector") : nullptr,
+                       profiler && profiler->tracksAllocations(),
+                       std::make_index_sequence<N>{}),
+                   NodeProfiler::slotColumns(columns));
+}
+
+template <typename OutT, typename InT, std::size_t N>
+ROOT::RDF::RNode defineConcat(ROOT::RDF::RNode df, const std::string &name,
+                              const std::vector<std::string> &columns,
+                              NodeProfiler *profiler) {
+  return df.Define(name,
+                   makeConcatKernel<OutT, InT>(
+                       profiler ? profiler->addNode(name, "define_vector") : nullptr,
+                       profiler && profiler->tracksAllocations(),
+                       std::make_index_sequence<N>{}),
+                   NodeProfiler::slotColumns(columns));
+}
+
+template <typename OutT, typename InT, std::size_t... N>
+constexpr std::array<VectorKernelDefiner, sizeof...(N)>
+makeScalarPackTable(std::index_sequence<N...>) {
+  return {&defineScalarPack<OutT, InT, N>...};
+}
+
+template <typename OutT, typename InT, std::size_t... N>
+constexpr std::array<VectorKernelDefiner, sizeof...(N)>
+makeConcatTable(std::index_sequence<N...>) {
+  return {&defineConcat<OutT, InT, N + 1>...};
+}
+
+template <typename OutT, typename InT>
+VectorKernelDefiner selectVectorKernel(std::size_t nColumns, bool concatenate) {
+  if (concatenate) {
+    static constexpr auto table = makeConcatTable<OutT, InT>(
+        std::make_index_sequence<kMaxTypedConcatColumns>{});
+    return (nColumns >= 1 && nColumns <= table.size()) ? table[nColumns - 1]
+                                                       : nullptr;
+  }
+  static constexpr auto table = makeScalarPackTable<OutT, InT>(
+      std::make_index_sequence<kMaxTypedScalarColumns + 1>{});
+  return nColumns < table.size() ? table[nColumns] : nullptr;
+}
+
+template <typename OutT>
+VectorKernelDefiner selectVectorKernel(VectorElementKind inputKind,
+                                       std::size_t nColumns, bool concatenate) {
+  switch (inputKind) {
+  case VectorElementKind::Float:
+    return selectVectorKernel<OutT, Float_t>(nColumns, concatenate);
+  case VectorElementKind::Double:
+    return selectVectorKernel<OutT, Double_t>(nColumns, concatenate);
+  case VectorElementKind::Int:
+    return selectVectorKernel<OutT, Int_t>(nColumns, concatenate);
+  case VectorElementKind::Bool:
+    return selectVectorKernel<OutT, Bool_t>(nColumns, concatenate);
+  case VectorElementKind::Other:
+    break;
+  }
+  return nullptr;
+}
+
+/**
+ * @brief Find the precompiled kernel for a DefineVector call.
+ * @return nullptr when the combination has no kernel and JIT must be used.
+ */
+VectorKernelDefiner selectVectorKernel(VectorElementKind outputKind,
+                                       VectorElementKind inputKind,
+                                       std::size_t nColumns, bool concatenate) {
+  switch (outputKind) {
+  case VectorElementKind::Float:
+    return selectVectorKernel<Float_t>(inputKind, nColumns, concatenate);
+  case VectorElementKind::Double:
+    return selectVectorKernel<Double_t>(inputKind, nColumns, concatenate);
+  case VectorElementKind::Int:
+    return selectVectorKernel<Int_t>(inputKind, nColumns, concatenate);
+  case VectorElementKind::Bool:
+    return selectVectorKernel<Bool_t>(inputKind, nColumns, concatenate);
+  case VectorElementKind::Other:
+    break;
+  }
+  return nullptr;
+}
+
+/**
+ * @brief Value of constant @p name for each sample, in sample order: the
+ * sample's own value, else the job-wide one from @p globals.
+ */
+template <typename Value, typename Parse>
+std::vector<Value> sampleValues(const SampleSet &samples, const std::string &name,
+                                std::map<std::string, Value> SampleSpec::*constants,
+                                const std::unordered_map<std::string, std::string> &globals,
+                                Parse parse) {
+  std::vector<Value> values;
+  for (const auto &sample : samples.samples()) {
+    if (auto it = (sample.*constants).find(name); it != (sample.*constants).end()) {
+      values.push_back(it->second);
+    } else if (auto global = globals.find(name); global != globals.end()) {
+      values.push_back(parse(global->second));
+    } else {
+      throw std::runtime_error("DataManager: sample '" + sample.name +
+                               "' has no value for constant '" + name + "'");
+    }
+  }
+  return values;
+}
+
+/**
+ * @brief Counts the heap allocations of every task of the event loop on its
+ *        slot (see DataManager::enableAllocationProfiling()).
+ *
+ * InitTask() and FinalizeTask() run on the thread of the slot, so the
+ * difference of its thread-local counters covers everything the task did:
+ * reading, the instrumented nodes and every other action.  An action runs in
+ * one event loop only; Initialize() clears the allocations of the previous
+ * loop, so the profile always covers the loop that ran last.
+ */
+class AllocationTaskAction
+    : public ROOT::Detail::RDF::RActionImpl<AllocationTaskAction> {
+public:
+  using Result_t = ULong64_t;
+
+  AllocationTaskAction(NodeProfiler *profiler, unsigned int nSlots)
+      : profiler_m(profiler),
+        tasks_m(std::make_shared<std::vector<NodeProfiler::SlotTasks>>(nSlots)),
+        result_m(std::make_shared<Result_t>(0)) {}
+
+  AllocationTaskAction(AllocationTaskAction &&) = default;
+  AllocationTaskAction(const AllocationTaskAction &) = delete;
+
+  std::shared_ptr<Result_t> GetResultPtr() const { return result_m; }
+
+  void Initialize() { profiler_m->resetAllocations(); }
+
+  void InitTask(TTreeReader *, unsigned int slot) {
+    auto &task = (*tasks_m)[slot];
+    task.entries = 0;
+    task.counts = AllocationTracker::threadCounts();
+  }
+
+  void Exec(unsigned int slot, ULong64_t) { ++(*tasks_m)[slot].entries; }
+
+  void FinalizeTask(unsigned int slot) {
+    const auto &task = (*tasks_m)[slot];
+    profiler_m->recordTask(slot, task.entries,
+                           AllocationTracker::threadCounts() - task.counts);
+  }
+
+  void Finalize() { *result_m = profiler_m->taskTotals().entries; }
+
+  std::string GetActionName() const { return "AllocationTasks"; }
+
+private:
+  NodeProfiler *profiler_m;
+  std::shared_ptr<std::vector<NodeProfiler::SlotTasks>> tasks_m;
+  std::shared_ptr<Result_t> result_m;
+};
+
+/**
+ * @brief Node exposing its column register: the defines of its graph with
+ *        the columns each of them reads, and its aliases.
+ *
+ * Covers the columns defined directly on an RNode as well as those defined
+ * through the provider.
+ */
+class RegisteredColumns : public ROOT::RDF::RNode {
+public:
+  explicit RegisteredColumns(const ROOT::RDF::RNode &node) : ROOT::RDF::RNode(node) {}
+
+  const ROOT::Internal::RDF::RColumnRegister &columns() const { return fColRegister; }
+};
+
+/**
+ * @brief Entry list of @p chain holding the chain entries of @p ranges
+ *        (sorted, disjoint, end exclusive).
+ *
+ * The entries are entered file by file: the sub-list of a file is selected
+ * once per range and its entries are entered by local number, rather than
+ * paying the LoadTree() and sub-list lookup of TEntryList::Enter(entry,
+ * chain) for every entry.
+ */
+std::unique_ptr<TEntryList> chainEntryList(const char *name, const char *title, TChain &chain,
+                                           const std::vector<EntryRangeSet::Range> &ranges) {
+  auto entryList = std::make_unique<TEntryList>(name, title);
+  chain.GetEntries(); // fills the tree offsets
+  const Long64_t *offsets = chain.GetTreeOffset();
+  const Int_t nTrees = chain.GetNtrees();
+  Int_t t = 0;
+  for (const auto &range : ranges) {
+    const Long64_t last = static_cast<Long64_t>(range.second);
+    for (Long64_t entry = static_cast<Long64_t>(range.first); entry < last;) {
+      while (t < nTrees && offsets[t + 1] <= entry) {
+        ++t;
+      }
+      if (t == nTrees) {
+        return entryList;
+      }
+      const Long64_t end = std::min(last, offsets[t + 1]);
+      if (chain.LoadTree(offsets[t]) >= 0 && chain.GetTree()) {
+        entryList->SetTree(chain.GetTree());
+        for (; entry < end; ++entry) {
+          entryList->Enter(entry - offsets[t]);
+        }
+      }
+      entry = end;
+    }
+  }
+  return entryList;
+}
+
+} // namespace
+
 
 /**
  * @brief Construct a new DataManager object
@@ -18,6 +369,28 @@
 DataManager::DataManager(const IConfigurationProvider &configProvider)
     : chain_vec_m(makeTChain(configProvider)), df_m(ROOT::RDataFrame(1)) {
 
+    // Files on slow sites are moved to their failover URL before staging
+    // copies them, and staged files must be in place before any is opened.
+    if (!chain_vec_m.empty()) {
+      setupSlowSiteMonitor(configProvider);
+      stageInputFiles(configProvider);
+    }
+
+    rntupleInput_m = !chain_vec_m.empty() && isRNTupleInput(configProvider, *chain_vec_m[0]);
+    samples_m = SampleSet::fromConfig(configProvider);
+
+    const std::string deferVariations = configProvider.get("deferVariationColumns");
+    deferVariationColumns_m = deferVariations == "1" || deferVariations == "true" ||
+                              deferVariations == "True";
+    const std::string foldConstants = configProvider.get("foldConstants");
+    foldConstants_m = foldConstants == "1" || foldConstants == "true" || foldConstants == "True";
+
+    incrementalSkimBase_m = configProvider.get("incrementalSkimBase");
+    const std::string readSkimLayers = configProvider.get("readSkimLayers");
+    if (readSkimLayers == "1" || readSkimLayers == "true" || readSkimLayers == "True") {
+      attachSkimLayers();
+    }
+
     // Attach friend trees (from friendConfig) BEFORE wrapping in RDataFrame
     // so that all friend branches are visible to the RDataFrame at creation.
     const std::string friendConfigFile = configProvider.get("friendConfig");
@@ -25,38 +398,203 @@ DataManager::DataManager(const IConfigurationProvider &configProvider)
       registerFriendTrees(configProvider);
     }
 
+    bool hasInput = false;
+    if (rntupleInput_m) {
+      // RNTuple input: the chain only carries the file list.  RNTuples cannot
+      // be joined through TTree friendship, so extra trees are rejected.
+      if (chain_vec_m.size() > 1) {
+        throw std::runtime_error(
+            "DataManager: multiple treeList entries are not supported with RNTuple input");
+      }
+      if (!samples_m.empty()) {
+        throw std::runtime_error("DataManager: sampleConfig is not supported with RNTuple input");
+      }
+      const std::vector<std::string> files = getChainFileNames(*chain_vec_m[0]);
+      if (!files.empty()) {
+#if defined(HAS_RNTUPLE_INPUT)
+        // Since ROOT 6.34 the file-list constructor selects RNTupleDS for RNTuple inputs.
+        df_m = ROOT::RDataFrame(chain_vec_m[0]->GetName(), files);
+        hasInput = true;
+        RDF_LOG_INFO << "Reading RNTuple '" << chain_vec_m[0]->GetName()
+                     << "' from " << files.size() << " files";
+#else
+        throw std::runtime_error(
+            "DataManager: RNTuple input requires ROOT 6.34 or newer");
+#endif
+      }
+    } else if (!chain_vec_m.empty()) {
+      // Read-ahead settings must be in place before GetEntries() opens files.
+      for (std::size_t i = 0; i < chain_vec_m.size(); ++i) {
+        configureTreeReadAhead(configProvider, *chain_vec_m[i], i == 0);
+      }
+      setupFilePrefetcher(configProvider);
+      if (chain_vec_m[0]->GetEntries() > 0) {
+        df_m = ROOT::RDataFrame(*chain_vec_m[0]);
+        hasInput = true;
+        if (slowSiteMonitor_m) {
+          monitorSampleReads();
+        }
+        if (filePrefetcher_m) {
+          prefetchOnSampleSwitch();
+        }
+        if (!samples_m.empty()) {
+          defineSampleIndex();
+        }
+      }
+    }
+
     // Fall back to a small in-memory dataframe (1 entry) if no input files were found
     // This allows unit tests to define variables and perform simple operations
     // that expect at least one row.
-    if (!(chain_vec_m.empty()) && chain_vec_m[0]->GetEntries() > 0) {
-      df_m = ROOT::RDataFrame(*chain_vec_m[0]);
-
+    if (hasInput) {
       // Apply optional entry-range restriction.
       // Written by law tasks when partition='entry_range' is selected.
       // Both keys must be present; if only one is set the range is ignored.
-      // Note: Range() disables implicit multi-threading (ImplicitMT) when
-      // used with ROOT < 6.28.  In entry_range partition mode each condor
-      // job is a separate process, so per-job parallelism is unaffected;
-      // only the in-process thread count is restricted to 1 on older ROOT.
+      // TTree input attaches the range as a TEntryList, like
+      // applyLumiSectionMask(), so ImplicitMT stays enabled and clusters
+      // outside the range are never read.  RNTuple input falls back to
+      // Range().
       const std::string firstEntryStr = configProvider.get("firstEntry");
       const std::string lastEntryStr  = configProvider.get("lastEntry");
+      ULong64_t firstEntry = 0;
+      ULong64_t lastEntry = 0;
+      bool ranged = false;
       if (!firstEntryStr.empty() && !lastEntryStr.empty()) {
-        const ULong64_t firstEntry = std::stoull(firstEntryStr);
-        const ULong64_t lastEntry  = std::stoull(lastEntryStr);
-        if (lastEntry > firstEntry) {
+        auto parseEntry = [](const std::string &key, const std::string &value) {
+          std::size_t pos = 0;
+          ULong64_t entry = 0;
+          try {
+            entry = std::stoull(value, &pos);
+          } catch (const std::exception &) {
+            pos = 0;
+          }
+          if (pos == 0 || pos != value.size() || value.front() == '-') {
+            throw std::runtime_error("DataManager: invalid " + key + " '" + value + "'");
+          }
+          return entry;
+        };
+        firstEntry = parseEntry("firstEntry", firstEntryStr);
+        lastEntry  = parseEntry("lastEntry", lastEntryStr);
+        ranged = lastEntry > firstEntry;
+        if (!ranged) {
+          RDF_LOG_WARN << "Warning: firstEntry (" << firstEntry
+                       << ") >= lastEntry (" << lastEntry
+                       << "); entry range ignored.";
+        }
+      }
+      // Each MPI rank processes its slice of the job (see MpiRuntime); a
+      // slice may be empty when there are more ranks than entries.
+      if (MpiRuntime::size() > 1) {
+        if (!ranged) {
+          if (rntupleInput_m) {
+            throw std::runtime_error(
+                "DataManager: mpi=true with RNTuple input requires firstEntry/lastEntry");
+          }
+          firstEntry = 0;
+          lastEntry = static_cast<ULong64_t>(chain_vec_m[0]->GetEntries());
+        }
+        std::tie(firstEntry, lastEntry) =
+            MpiRuntime::partition(firstEntry, lastEntry, MpiRuntime::rank(), MpiRuntime::size());
+        ranged = true;
+      }
+      if (ranged) {
+        if (rntupleInput_m) {
           df_m = df_m.Range(firstEntry, lastEntry);
-          std::cout << "Entry range applied: [" << firstEntry << ", "
-                    << lastEntry << ")" << std::endl;
         } else {
-          std::cerr << "Warning: firstEntry (" << firstEntry
-                    << ") >= lastEntry (" << lastEntry
-                    << "); entry range ignored." << std::endl;
+          applyEntryRange(static_cast<Long64_t>(firstEntry),
+                          static_cast<Long64_t>(lastEntry));
+        }
+        entryRangeApplied_m = true;
+        firstEntry_m = static_cast<Long64_t>(firstEntry);
+        lastEntry_m = static_cast<Long64_t>(lastEntry);
+        RDF_LOG_INFO << "Entry range applied: [" << firstEntry << ", "
+                     << lastEntry << ")";
+      }
+      // Preview runs read a stratified sample of clusters; results are
+      // scaled to full statistics by the Analyzer.
+      const std::string previewStr = configProvider.get("previewFraction");
+      if (!previewStr.empty()) {
+        double fraction = 0.0;
+        std::size_t pos = 0;
+        try {
+          fraction = std::stod(previewStr, &pos);
+        } catch (const std::exception &) {
+          pos = 0;
         }
+        if (pos == 0 || pos != previewStr.size()) {
+          throw std::runtime_error("DataManager: invalid previewFraction '" + previewStr + "'");
+        }
+        if (!(fraction > 0.0 && fraction <= 1.0)) {
+          throw std::runtime_error("DataManager: previewFraction must be in (0, 1], got '" +
+                                   previewStr + "'");
+        }
+        if (fraction < 1.0) {
+          if (rntupleInput_m) {
+            RDF_LOG_WARN << "Warning: previewFraction is not supported for RNTuple input; "
+                            "processing all entries.";
+          } else {
+            applyPreviewSampling(fraction);
+          }
+        }
+      }
+      // A checkpoint left by a preempted run of this job (see
+      // CheckpointService) records the entries it already processed.
+      const EntryRangeSet processed =
+          CheckpointService::readProcessedEntries(configProvider.get("checkpointFile"));
+      entriesSkipped_m = !configProvider.get("checkpointFile").empty();
+      if (!processed.empty()) {
+        skipEntries(processed);
+        RDF_LOG_INFO << "Resuming from checkpoint: skipping " << processed.size()
+                     << " processed entries";
       }
     } else {
-      std::cout << "No input files found; using single-entry in-memory RDataFrame for testing." << std::endl;
+      RDF_LOG_INFO << "No input files found; using single-entry in-memory RDataFrame for testing.";
     }
 
+    const std::string jitCacheDir = configProvider.get("jitCacheDir");
+    jitExportFile_m = configProvider.get("jitExportFile");
+    if (!jitCacheDir.empty()) {
+      const std::string build = configProvider.get("jitCacheBuild");
+      enableJitCache(jitCacheDir, build == "1" || build == "true" || build == "True");
+    } else if (!jitExportFile_m.empty() || JitCache::compiledCount() > 0) {
+      // Expressions compiled into the executable, or recorded for it.
+      enableJitCache("", false);
+    }
+
+    const std::string profileNodes = configProvider.get("profileNodes");
+    if (profileNodes == "1" || profileNodes == "true" || profileNodes == "True") {
+      const std::string report = configProvider.get("nodeProfileReport");
+      enableNodeProfiling(report.empty() ? "node_profile.json" : report);
+    }
+    const std::string profileAllocations = configProvider.get("profileAllocations");
+    if (profileAllocations == "1" || profileAllocations == "true" ||
+        profileAllocations == "True") {
+      const std::string report = configProvider.get("nodeProfileReport");
+      enableAllocationProfiling(report.empty() ? "node_profile.json" : report);
+    }
+
+    if (hasInput && !rntupleInput_m) {
+      configureTaskSplitting(configProvider);
+    }
+    if (hasInput) {
+      configureThreadPinning(configProvider);
+    }
+
+    const std::string pruneBranches = configProvider.get("pruneInputBranches");
+    pruneInputBranches_m =
+        pruneBranches == "1" || pruneBranches == "true" || pruneBranches == "True";
+    const std::string keepBranches = configProvider.get("keepInputBranches");
+    if (!keepBranches.empty()) {
+      for (auto &glob : configProvider.splitString(keepBranches, ",")) {
+        glob.erase(0, glob.find_first_not_of(" \t"));
+        glob.erase(glob.find_last_not_of(" \t") + 1);
+        if (!glob.empty()) {
+          keepInputBranches_m.push_back(glob);
+        }
+      }
+    }
+    inputBranchReport_m = configProvider.get("inputBranchReport");
+
     // Display a progress bar depending on batch status and ROOT version
   #if defined(HAS_ROOT_PROGRESS_BAR)
     auto batch = configProvider.get("batch");
@@ -64,14 +602,13 @@ DataManager::DataManager(const IConfigurationProvider &configProvider)
       ROOT::RDF::Experimental::AddProgressBar(df_m);
     } else {
       //if (verbosityLevel_m >= 1) {
-      std::cout << "Batch mode, no progress bar" << std::endl;
+      RDF_LOG_INFO << "Batch mode, no progress bar";
       //}
     }
   #else
     if (verbosityLevel_m >= 1) {
-      std::cout << "ROOT version does not support progress bar, update to at "
-                  "least 6.28 to get it."
-                << std::endl;
+      RDF_LOG_INFO << "ROOT version does not support progress bar, update to at "
+                     "least 6.28 to get it.";
     }
   #endif
 
@@ -95,7 +632,28 @@ ROOT::RDF::RNode DataManager::getDataFrame() { return df_m; }
  * @brief Set the current RDataFrame node
  * @param node The RNode to set
  */
-void DataManager::setDataFrame(const ROOT::RDF::RNode &node) { df_m = node; }
+void DataManager::setDataFrame(const ROOT::RDF::RNode &node) {
+  df_m = node;
+  // Unknown changes: rebuild the column index on the next query.
+  columns_m.invalidate();
+}
+
+void DataManager::updateDataFrame(const ROOT::RDF::RNode &node,
+                                  const std::vector<std::string> &addedColumns) {
+  df_m = node;
+  for (const auto &name : addedColumns) {
+    columns_m.add(name);
+  }
+}
+
+bool DataManager::hasColumn(const std::string &name) {
+  materializeConstant(name);
+  return columns_m.has(name, df_m);
+}
+
+std::string DataManager::columnType(const std::string &name) {
+  return columns_m.type(name, df_m);
+}
 
 /**
  * @brief Get the main TChain pointer
@@ -103,8 +661,76 @@ void DataManager::setDataFrame(const ROOT::RDF::RNode &node) { df_m = node; }
  */
 TChain *DataManager::getChain() const { return chain_vec_m[0].get(); }
 
+bool DataManager::deferColumn(const std::string &name,
+                              const std::vector<std::string> &inputs,
+                              std::function<ROOT::RDF::RNode(ROOT::RDF::RNode)> define) {
+  if (!deferVariationColumns_m) {
+    return false;
+  }
+  if (deferredColumns_m.emplace(name, DeferredColumn{inputs, std::move(define)}).second) {
+    ++nDeferredColumns_m;
+  }
+  return true;
+}
+
+bool DataManager::materializeConstant(const std::string &name) {
+  const auto constant = constants_m.find(name);
+  if (constant == constants_m.end() || !constant->second.folded) {
+    return false;
+  }
+  constant->second.folded = false;
+  if (constant->second.isInt) {
+    defineConstant(name, static_cast<Int_t>(constant->second.value));
+  } else {
+    defineConstant(name, static_cast<Float_t>(constant->second.value));
+  }
+  return true;
+}
+
+void DataManager::materializeColumn(const std::string &name) {
+  if (materializeConstant(name)) {
+    return;
+  }
+  auto it = deferredColumns_m.find(name);
+  if (it == deferredColumns_m.end()) {
+    return;
+  }
+  // Remove the entry before resolving inputs so that a cycle cannot recurse
+  // forever.
+  DeferredColumn column = std::move(it->second);
+  deferredColumns_m.erase(it);
+  for (const auto &input : column.inputs) {
+    materializeColumn(input);
+  }
+  df_m = column.define(df_m);
+  columns_m.add(name);
+}
+
+void DataManager::materializeAllColumns() {
+  while (!deferredColumns_m.empty()) {
+    materializeColumn(deferredColumns_m.begin()->first);
+  }
+  for (const auto &name : getFoldedConstants()) {
+    materializeColumn(name);
+  }
+}
+
+std::vector<std::string> DataManager::getPendingColumns() const {
+  std::vector<std::string> pending;
+  pending.reserve(deferredColumns_m.size());
+  for (const auto &[name, column] : deferredColumns_m) {
+    pending.push_back(name);
+  }
+  return pending;
+}
+
 /**
- * @brief Define a vector variable in the dataframe. If all columns are scalars, creates a vector from them. If all columns are RVecs, concatenates and casts them to the target type. Mixed types are not supported and will throw an error at runtime. Uses a JIT lambda for type deduction and concatenation.
+ * @brief Define a vector variable in the dataframe. If all columns are scalars, creates a vector from them. If all columns are RVecs, concatenates and casts them to the target type. Mixed types are not supported and will throw an error at runtime.
+ *
+ * Column types are resolved once. When all inputs share one element type
+ * among Float_t/Double_t/Int_t/Bool_t, the target type is one of those, and
+ * there are at most 32 scalar or 8 RVec inputs, a precompiled typed kernel is
+ * used. Other combinations fall back to a JIT-compiled expression.
  * @param name Name of the variable
  * @param columns Input columns (scalars or vectors)
  * @param type Data type (default: Float_t)
@@ -114,18 +740,23 @@ void DataManager::DefineVector(std::string name,
                                const std::vector<std::string> &columns,
                                std::string type,
                                ISystematicManager &systematicManager) {
-  std::cout << "[DataManager] Defining vector column " << name << std::endl;
+  RDF_LOG_DEBUG << "[DataManager] Defining vector column " << name;
 
-  const auto existingColumns = df_m.GetColumnNames();
-  if (std::find(existingColumns.begin(), existingColumns.end(), name) != existingColumns.end()) {
-    std::cout << "[DataManager] Vector column " << name << " already exists, skipping." << std::endl;
+  if (hasColumn(name)) {
+    RDF_LOG_DEBUG << "[DataManager] Vector column " << name << " already exists, skipping.";
     return;
   }
 
+  recordColumnsRead(columns);
+  // Inputs may be deferred variation columns (see deferColumn()).
+  for (const auto &c : columns) {
+    materializeColumn(c);
+  }
+
   // Sanity-check that all requested columns exist in the dataframe.
   std::vector<std::string> missing;
   for (const auto &c : columns) {
-    if (std::find(existingColumns.begin(), existingColumns.end(), c) == existingColumns.end()) {
+    if (!hasColumn(c)) {
       missing.push_back(c);
     }
   }
@@ -137,11 +768,13 @@ void DataManager::DefineVector(std::string name,
     throw std::runtime_error(msg);
   }
 
-  // Determine the type of each column (scalar or RVec)
+  // Determine the type of each column (scalar or RVec) and its element type
   std::vector<bool> isRVec;
+  std::vector<VectorElementKind> elementKinds;
   for (const auto& col : columns) {
-    std::string colType = df_m.GetColumnType(col);
+    std::string colType = columnType(col);
     isRVec.push_back(colType.find("RVec") != std::string::npos);
+    elementKinds.push_back(elementKindFromTypeName(elementTypeName(colType)));
   }
 
   bool allRVec = std::all_of(isRVec.begin(), isRVec.end(), [](bool v){ return v; });
@@ -151,6 +784,27 @@ void DataManager::DefineVector(std::string name,
     throw std::runtime_error("DefineVector: Mixed scalar and RVec types are not supported.");
   }
 
+  // Use a precompiled kernel when all inputs share one of the common element
+  // types; otherwise fall back to JIT below.
+  const bool homogeneousInputs =
+      std::adjacent_find(elementKinds.begin(), elementKinds.end(),
+                         std::not_equal_to<VectorElementKind>()) ==
+      elementKinds.end();
+  const VectorElementKind inputKind =
+      elementKinds.empty() ? VectorElementKind::Float : elementKinds.front();
+  if (homogeneousInputs) {
+    const auto kernel = selectVectorKernel(
+        elementKindFromTypeName(type), inputKind, columns.size(),
+        allRVec && !columns.empty());
+    if (kernel) {
+      df_m = kernel(df_m, name, columns, nodeProfiler_m.get());
+      columns_m.add(name);
+      RDF_LOG_DEBUG << "[DataManager] Vector column " << name
+                   << " defined with a precompiled kernel.";
+      return;
+    }
+  }
+
   if (allScalar) {
     // Use the original string expression for scalars
     std::string expr = "ROOT::VecOps::RVec<" + type + ">{";
@@ -161,8 +815,9 @@ void DataManager::DefineVector(std::string name,
       }
     }
     expr += "}";
-    df_m = df_m.Define(name, expr);
-    std::cout << "[DataManager] Vector column " << name << " defined from scalars." << std::endl;
+    df_m = defineExpression(df_m, name, expr);
+    columns_m.add(name);
+    RDF_LOG_DEBUG << "[DataManager] Vector column " << name << " defined from scalars.";
     return;
   } else {
 
@@ -178,12 +833,115 @@ void DataManager::DefineVector(std::string name,
     }
     expr += "return out;";
 
-    df_m = df_m.Define(name, expr);
-    std::cout << "[DataManager] Vector column " << name << " defined by concatenating RVecs." << std::endl;
-    std::cout << "Expression: \n" << expr << std::endl;
+    df_m = defineExpression(df_m, name, expr);
+    columns_m.add(name);
+    RDF_LOG_DEBUG << "[DataManager] Vector column " << name << " defined by concatenating RVecs.";
+    RDF_LOG_DEBUG << "Expression: \n" << expr;
   }
 }
 
+void DataManager::declareFeatures(const std::vector<std::string> &features) {
+  for (const auto &feature : features) {
+    if (std::find(declaredFeatures_m.begin(), declaredFeatures_m.end(), feature) ==
+        declaredFeatures_m.end()) {
+      declaredFeatures_m.push_back(feature);
+    }
+  }
+}
+
+/**
+ * @brief Define a model input from a shared feature block.
+ *
+ * Blocks are plain DefineVector() columns; an input is their slice or gather,
+ * so the features common to several models are read and cast once per event.
+ */
+void DataManager::DefineFeatureVector(std::string name,
+                                      const std::vector<std::string> &features,
+                                      ISystematicManager &systematicManager) {
+  if (hasColumn(name)) {
+    return;
+  }
+  for (const auto &feature : features) {
+    materializeColumn(feature);
+  }
+  const auto isScalar = [this](const std::string &column) {
+    return hasColumn(column) && columnType(column).find("RVec") == std::string::npos;
+  };
+  if (features.empty() || !std::all_of(features.begin(), features.end(), isScalar)) {
+    // RVec features have no fixed offset in a block; missing ones are
+    // reported by DefineVector().
+    DefineVector(name, features, "Float_t", systematicManager);
+    return;
+  }
+
+  std::size_t block = featureBlocks_m.size();
+  std::vector<std::size_t> offsets;
+  for (std::size_t i = 0; i < featureBlocks_m.size() && block == featureBlocks_m.size(); ++i) {
+    const auto &blockFeatures = featureBlocks_m[i];
+    offsets.clear();
+    for (const auto &feature : features) {
+      const auto it = std::find(blockFeatures.begin(), blockFeatures.end(), feature);
+      if (it == blockFeatures.end()) {
+        break;
+      }
+      offsets.push_back(static_cast<std::size_t>(it - blockFeatures.begin()));
+    }
+    if (offsets.size() == features.size()) {
+      block = i;
+    }
+  }
+  if (block == featureBlocks_m.size()) {
+    // The requested features come first, so this input is a view of the
+    // block's head; declared features join when they are numeric scalars.
+    std::vector<std::string> blockFeatures = features;
+    for (const auto &feature : declaredFeatures_m) {
+      if (std::find(blockFeatures.begin(), blockFeatures.end(), feature) == blockFeatures.end() &&
+          isScalar(feature) &&
+          elementKindFromTypeName(columnType(feature)) != VectorElementKind::Other) {
+        blockFeatures.push_back(feature);
+      }
+    }
+    DefineVector("__features_" + std::to_string(block), blockFeatures, "Float_t",
+                 systematicManager);
+    featureBlocks_m.push_back(std::move(blockFeatures));
+    offsets.resize(features.size());
+    std::iota(offsets.begin(), offsets.end(), std::size_t{0});
+    RDF_LOG_DEBUG << "[DataManager] Feature block __features_" << block << " holds "
+                  << featureBlocks_m.back().size() << " features.";
+  }
+
+  const std::string blockColumn = "__features_" + std::to_string(block);
+  const std::size_t count = offsets.size();
+  bool contiguous = true;
+  for (std::size_t i = 1; i < count; ++i) {
+    contiguous = contiguous && offsets[i] == offsets[i - 1] + 1;
+  }
+  if (contiguous && offsets.front() == 0 && count == featureBlocks_m[block].size()) {
+    df_m = df_m.Alias(name, blockColumn);
+  } else if (contiguous) {
+    // An owning copy of the slice, so consumers that modify their input
+    // cannot write through to the shared block.
+    const std::size_t first = offsets.front();
+    df_m = df_m.Define(name,
+                       [first, count](const ROOT::VecOps::RVec<Float_t> &values) {
+                         return ROOT::VecOps::RVec<Float_t>(
+                             values.begin() + first, values.begin() + first + count);
+                       },
+                       {blockColumn});
+  } else {
+    df_m = df_m.Define(name,
+                       [offsets](const ROOT::VecOps::RVec<Float_t> &values) {
+                         ROOT::VecOps::RVec<Float_t> out(offsets.size());
+                         for (std::size_t i = 0; i < offsets.size(); ++i) {
+                           out[i] = values[offsets[i]];
+                         }
+                         return out;
+                       },
+                       {blockColumn});
+  }
+  columns_m.add(name);
+}
+
 
 
 
@@ -192,21 +950,164 @@ void DataManager::DefineVector(std::string name,
  * @param configProvider Reference to the configuration provider
  */
 void DataManager::registerConstants(const IConfigurationProvider &configProvider, const std::string& floatConfigKey, const std::string& intConfigKey) {
+  if (!sampleByUrl_m.empty()) {
+    registerSampleConstants(configProvider, floatConfigKey, intConfigKey);
+    return;
+  }
   std::string floatFile = configProvider.get(floatConfigKey);
   if (!floatFile.empty()) {
     auto floatConfig = configProvider.parsePairBasedConfig(floatFile);
     for (auto &pair : floatConfig) {
-      float val = std::stof(pair.second);
-      defineConstant(pair.first, val);
+      registerConstant(pair.first, std::stof(pair.second), false);
     }
   }
   std::string intFile = configProvider.get(intConfigKey);
   if (!intFile.empty()) {
     auto intConfig = configProvider.parsePairBasedConfig(intFile);
     for (auto &pair : intConfig) {
-      int val = std::stoi(pair.second);
-      defineConstant(pair.first, val);
+      registerConstant(pair.first, std::stoi(pair.second), true);
+    }
+  }
+}
+
+void DataManager::registerConstant(const std::string &name, double value, bool isInt) {
+  constants_m[name] = ConfigConstant{value, isInt, foldConstants_m};
+  if (foldConstants_m) {
+    return;
+  }
+  if (isInt) {
+    defineConstant(name, static_cast<Int_t>(value));
+  } else {
+    defineConstant(name, static_cast<Float_t>(value));
+  }
+}
+
+std::string DataManager::foldConstants(const std::string &expression) const {
+  if (!foldConstants_m || constants_m.empty()) {
+    return expression;
+  }
+  // Same tokens as expressionIdentifiers(); members (a.x, a->x) and
+  // qualified names (ns::x) are left alone.
+  std::string folded;
+  std::size_t i = 0;
+  while (i < expression.size()) {
+    const unsigned char c = expression[i];
+    if (std::isalpha(c) || c == '_') {
+      const std::size_t begin = i;
+      while (i < expression.size() &&
+             (std::isalnum(static_cast<unsigned char>(expression[i])) ||
+              expression[i] == '_')) {
+        ++i;
+      }
+      const std::string name = expression.substr(begin, i - begin);
+      const char before = begin > 0 ? expression[begin - 1] : ' ';
+      const bool qualified = before == '.' || before == '>' || before == ':' ||
+                             expression.compare(i, 2, "::") == 0;
+      const auto constant = constants_m.find(name);
+      if (qualified || constant == constants_m.end()) {
+        folded += name;
+        continue;
+      }
+      std::ostringstream literal;
+      if (constant->second.isInt) {
+        literal << "Int_t(" << static_cast<Int_t>(constant->second.value) << ")";
+      } else {
+        literal << "Float_t(" << std::setprecision(std::numeric_limits<float>::max_digits10)
+                << constant->second.value << ")";
+      }
+      folded += literal.str();
+    } else if (std::isdigit(c)) {
+      const std::size_t begin = i;
+      while (i < expression.size() &&
+             (std::isalnum(static_cast<unsigned char>(expression[i])) ||
+              expression[i] == '.')) {
+        ++i;
+      }
+      folded += expression.substr(begin, i - begin);
+    } else if (c == '"' || c == '\'') {
+      // String and character literals are copied as they are.
+      const std::size_t begin = i++;
+      while (i < expression.size() && expression[i] != static_cast<char>(c)) {
+        i += expression[i] == '\\' ? 2 : 1;
+      }
+      i = std::min(i + 1, expression.size());
+      folded += expression.substr(begin, i - begin);
+    } else {
+      folded += expression[i++];
+    }
+  }
+  return folded;
+}
+
+std::vector<std::string> DataManager::getFoldedConstants() const {
+  std::vector<std::string> folded;
+  for (const auto &[name, constant] : constants_m) {
+    if (constant.folded) {
+      folded.push_back(name);
+    }
+  }
+  std::sort(folded.begin(), folded.end());
+  return folded;
+}
+
+/**
+ * @brief Define every job-wide and sample constant per sample.
+ *
+ * A sample's own value takes precedence over the job-wide one; the values
+ * are looked up once per sample, not per entry.
+ */
+void DataManager::registerSampleConstants(const IConfigurationProvider &configProvider,
+                                          const std::string &floatConfigKey,
+                                          const std::string &intConfigKey) {
+  auto readGlobal = [&configProvider](const std::string &key) {
+    const std::string file = configProvider.get(key);
+    return file.empty() ? std::unordered_map<std::string, std::string>{}
+                        : configProvider.parsePairBasedConfig(file);
+  };
+  const auto globalFloats = readGlobal(floatConfigKey);
+  const auto globalInts = readGlobal(intConfigKey);
+
+  std::set<std::string> floatNames, intNames;
+  for (const auto &pair : globalFloats) floatNames.insert(pair.first);
+  for (const auto &pair : globalInts) intNames.insert(pair.first);
+  for (const auto &sample : samples_m.samples()) {
+    for (const auto &pair : sample.floatConstants) floatNames.insert(pair.first);
+    for (const auto &pair : sample.intConstants) intNames.insert(pair.first);
+  }
+
+  auto uniform = [](const auto &values) {
+    return std::adjacent_find(values.begin(), values.end(), std::not_equal_to<>()) ==
+           values.end();
+  };
+  for (const auto &name : floatNames) {
+    auto values = sampleValues(samples_m, name, &SampleSpec::floatConstants, globalFloats,
+                               [&name](const std::string &v) { return SampleSet::parseFloat(name, v); });
+    if (!values.empty() && uniform(values)) {
+      registerConstant(name, values.front(), false);
+      continue;
+    }
+    df_m = df_m.DefinePerSample(
+        name, [this, values](unsigned int, const ROOT::RDF::RSampleInfo &info) -> Float_t {
+          return values[sampleOf(info)];
+        });
+    columns_m.add(name);
+  }
+  for (const auto &name : intNames) {
+    if (floatNames.count(name)) {
+      throw std::runtime_error("DataManager: constant '" + name +
+                               "' is both a float and an int constant");
+    }
+    auto values = sampleValues(samples_m, name, &SampleSpec::intConstants, globalInts,
+                               [&name](const std::string &v) { return SampleSet::parseInt(name, v); });
+    if (!values.empty() && uniform(values)) {
+      registerConstant(name, values.front(), true);
+      continue;
     }
+    df_m = df_m.DefinePerSample(
+        name, [this, values](unsigned int, const ROOT::RDF::RSampleInfo &info) -> Int_t {
+          return values[sampleOf(info)];
+        });
+    columns_m.add(name);
   }
 }
 
@@ -217,16 +1118,16 @@ void DataManager::registerConstants(const IConfigurationProvider &configProvider
 void DataManager::registerAliases(const IConfigurationProvider &configProvider, const std::string& aliasConfigKey) {
   auto aliasConfig = configProvider.parseMultiKeyConfig(
       configProvider.get(aliasConfigKey) , {"existingName", "newName"});
-  const auto columnNames = df_m.GetColumnNames();
   for (const auto &entryKeys : aliasConfig) {
     const auto& existing = entryKeys.at("existingName");
     const auto& alias = entryKeys.at("newName");
-    if (std::find(columnNames.begin(), columnNames.end(), existing) == columnNames.end()) {
-      std::cout << "Alias skipped: missing column " << existing << std::endl;
+    if (!hasColumn(existing)) {
+      RDF_LOG_INFO << "Alias skipped: missing column " << existing;
       continue;
     }
-    std::cout << "Aliasing " << existing << " to " << alias << std::endl;
+    RDF_LOG_INFO << "Aliasing " << existing << " to " << alias;
     df_m = df_m.Alias(alias, existing);
+    columns_m.add(alias);
   }
 }
 
@@ -238,7 +1139,7 @@ void DataManager::registerOptionalBranches(
     const IConfigurationProvider &configProvider, const std::string& optionalBranchesConfigKey) {
   const auto aliasConfig = configProvider.parseMultiKeyConfig(
       configProvider.get(optionalBranchesConfigKey), {"name", "type", "default"});
-  std::cout << "Optional branches config: " << optionalBranchesConfigKey << std::endl;
+  RDF_LOG_INFO << "Optional branches config: " << optionalBranchesConfigKey;
 
 #if defined(HAS_DEFAULT_VALUE_FOR)
   // Precompute existing columns to avoid calling DefaultValueFor on missing
@@ -378,7 +1279,7 @@ void DataManager::registerOptionalBranches(
     columnSet.insert(column);
   }
   for (const auto &entryKeys : aliasConfig) {
-    std::cout << "Processing optional branch " << entryKeys.at("name") << std::endl;
+    RDF_LOG_INFO << "Processing optional branch " << entryKeys.at("name");
     if (columnSet.find(entryKeys.at("name")) == columnSet.end()) {
       const int varType = std::stoi(entryKeys.at("type"));
       const auto defaultValStr = entryKeys.at("default");
@@ -386,7 +1287,7 @@ void DataManager::registerOptionalBranches(
       const Bool_t defaultBool = defaultValStr == "1" ||
                                  defaultValStr == "true" ||
                                  defaultValStr == "True";
-      std::cout << "Defining optional branch " << varName << " with default " << defaultValStr << " and type number " << varType << std::endl;
+      RDF_LOG_INFO << "Defining optional branch " << varName << " with default " << defaultValStr << " and type number " << varType;
       switch (varType) {
       case 0:
         df_m = saveVar<UInt_t>(std::stoul(defaultValStr), varName, df_m);
@@ -446,6 +1347,7 @@ void DataManager::registerOptionalBranches(
     }
   }
 #endif
+  columns_m.invalidate();
 }
 
 /**
@@ -457,28 +1359,914 @@ void DataManager::finalizeSetup(const IConfigurationProvider &configProvider,
                                 const std::string& intConfigKey,
                                 const std::string& aliasConfigKey,
                                 const std::string& optionalBranchesConfigKey) {
-  std::cout << "Finalizing setup" << std::endl;
+  RDF_LOG_INFO << "Finalizing setup";
   const auto floatConfig = configProvider.get(floatConfigKey);
   const auto intConfig = configProvider.get(intConfigKey);
   if ((!floatConfig.empty() && std::filesystem::exists(floatConfig)) ||
       (!intConfig.empty() && std::filesystem::exists(intConfig))) {
-    std::cout << "Registering constants" << std::endl;
+    RDF_LOG_INFO << "Registering constants";
     registerConstants(configProvider, floatConfigKey, intConfigKey);
   }
 
   const auto aliasConfig = configProvider.get(aliasConfigKey);
   if (!aliasConfig.empty() && std::filesystem::exists(aliasConfig)) {
-    std::cout << "Registering aliases" << std::endl;
+    RDF_LOG_INFO << "Registering aliases";
     registerAliases(configProvider, aliasConfigKey);
   }
 
   const auto optionalBranchesConfig = configProvider.get(optionalBranchesConfigKey);
   if (!optionalBranchesConfig.empty() && std::filesystem::exists(optionalBranchesConfig)) {
-    std::cout << "Registering optional branches" << std::endl;
+    RDF_LOG_INFO << "Registering optional branches";
     registerOptionalBranches(configProvider, optionalBranchesConfigKey);
   }
 }
 
+/**
+ * @brief Restrict the event loop of the main chain to [firstEntry, lastEntry).
+ */
+void DataManager::applyEntryRange(Long64_t firstEntry, Long64_t lastEntry) {
+  TChain *chain = chain_vec_m[0].get();
+  const Long64_t end = std::min(lastEntry, chain->GetEntries());
+  std::vector<EntryRangeSet::Range> ranges;
+  if (firstEntry < end) {
+    ranges.emplace_back(static_cast<ULong64_t>(firstEntry), static_cast<ULong64_t>(end));
+  }
+  auto entryList = chainEntryList("entryRange", "configured entry range", *chain, ranges);
+  chain->SetEntryList(entryList.get());
+  entryRangeList_m = std::move(entryList);
+}
+
+/**
+ * @brief Keep whole clusters of each file, evenly spaced within the file.
+ */
+EntryRangeSet DataManager::samplePreviewClusters(TChain &chain, double fraction,
+                                                 Long64_t firstEntry, Long64_t lastEntry) {
+  EntryRangeSet sample;
+  chain.GetEntries(); // fills the tree offsets
+  const Long64_t *offsets = chain.GetTreeOffset();
+  for (Int_t t = 0; t < chain.GetNtrees(); ++t) {
+    const Long64_t begin = std::max(offsets[t], firstEntry);
+    const Long64_t end = std::min(offsets[t + 1], lastEntry);
+    if (begin >= end || chain.LoadTree(offsets[t]) < 0 || !chain.GetTree()) {
+      continue;
+    }
+    TTree *tree = chain.GetTree();
+    std::vector<std::pair<Long64_t, Long64_t>> clusters;
+    auto cluster = tree->GetClusterIterator(0);
+    for (Long64_t start = cluster(); start < tree->GetEntries(); start = cluster()) {
+      const Long64_t first = std::max(offsets[t] + start, begin);
+      const Long64_t last =
+          std::min(offsets[t] + std::min(cluster.GetNextEntry(), tree->GetEntries()), end);
+      if (first < last) {
+        clusters.emplace_back(first, last);
+      }
+    }
+    // Systematic sampling: cluster i is kept when the running count
+    // fraction * i crosses the next half-integer.
+    bool kept = false;
+    for (std::size_t i = 0; i < clusters.size(); ++i) {
+      const double position = fraction * static_cast<double>(i);
+      if (std::floor(position + fraction + 0.5) > std::floor(position + 0.5)) {
+        sample.add(static_cast<ULong64_t>(clusters[i].first),
+                   static_cast<ULong64_t>(clusters[i].second));
+        kept = true;
+      }
+    }
+    if (!kept && !clusters.empty()) {
+      const auto &middle = clusters[clusters.size() / 2];
+      sample.add(static_cast<ULong64_t>(middle.first), static_cast<ULong64_t>(middle.second));
+    }
+  }
+  return sample;
+}
+
+/**
+ * @brief Set ROOT's tasks-per-worker hint from the config.
+ */
+void DataManager::configureTaskSplitting(const IConfigurationProvider &configProvider) {
+  const std::string hintStr = configProvider.get("tasksPerWorkerHint");
+  const std::string profile = configProvider.get("taskCostProfile");
+  const std::string minEntriesStr = configProvider.get("minEntriesPerTask");
+  if ((hintStr.empty() && profile.empty() && minEntriesStr.empty()) ||
+      !ROOT::IsImplicitMTEnabled()) {
+    return;
+  }
+
+  const auto inputEntries = [this]() {
+    return static_cast<std::uint64_t>(entryRangeApplied_m ? lastEntry_m - firstEntry_m
+                                                          : chain_vec_m[0]->GetEntries());
+  };
+
+  unsigned int hint = ROOT::TTreeProcessorMT::GetTasksPerWorkerHint();
+  if (!hintStr.empty()) {
+    try {
+      hint = static_cast<unsigned int>(std::stoul(hintStr));
+    } catch (const std::exception &) {
+      throw std::runtime_error("DataManager: invalid tasksPerWorkerHint '" + hintStr + "'");
+    }
+    if (hint == 0) {
+      throw std::runtime_error("DataManager: tasksPerWorkerHint must be positive");
+    }
+  } else if (!profile.empty()) {
+    if (!std::filesystem::exists(profile)) {
+      RDF_LOG_WARN << "Warning: taskCostProfile '" << profile
+                   << "' not found; keeping the default task splitting.";
+    } else {
+      const std::string targetStr = configProvider.get("targetTaskSeconds");
+      double target = 2.0;
+      if (!targetStr.empty()) {
+        try {
+          target = std::stod(targetStr);
+        } catch (const std::exception &) {
+          throw std::runtime_error("DataManager: invalid targetTaskSeconds '" + targetStr +
+                                   "'");
+        }
+      }
+      const double cost = NodeProfiler::readEventCost(profile);
+      hint = NodeProfiler::tasksPerWorkerHint(cost, inputEntries(),
+                                              ROOT::GetThreadPoolSize(), target);
+      RDF_LOG_INFO << "Measured " << cost / 1000.0 << " us per event in " << profile;
+    }
+  }
+
+  if (!minEntriesStr.empty()) {
+    std::uint64_t minEntries = 0;
+    try {
+      minEntries = std::stoull(minEntriesStr);
+    } catch (const std::exception &) {
+      throw std::runtime_error("DataManager: invalid minEntriesPerTask '" + minEntriesStr +
+                               "'");
+    }
+    const unsigned int capped = NodeProfiler::capTasksPerWorker(
+        hint, inputEntries(), ROOT::GetThreadPoolSize(), minEntries);
+    if (capped < hint) {
+      RDF_LOG_INFO << "minEntriesPerTask " << minEntries << " lowers the tasks per worker from "
+                   << hint << " to " << capped;
+      hint = capped;
+    }
+  }
+  ROOT::TTreeProcessorMT::SetTasksPerWorkerHint(hint);
+  RDF_LOG_INFO << "Tasks per worker: " << hint;
+}
+
+/**
+ * @brief Pin every event-loop thread to a CPU when ``pinThreads`` is set.
+ *
+ * The pinning happens in a per-sample column, i.e. when a slot starts a new
+ * task and before any of its Defines run, so that the per-slot buffers the
+ * thread allocates afterwards are placed on its NUMA node.
+ */
+void DataManager::configureThreadPinning(const IConfigurationProvider &configProvider) {
+  const std::string pin = configProvider.get("pinThreads");
+  if (!(pin == "1" || pin == "true" || pin == "True") || !ROOT::IsImplicitMTEnabled()) {
+    return;
+  }
+  threadPinning_m = std::make_unique<ThreadPinning>(ThreadPinning::readTopology());
+  ThreadPinning::activate(threadPinning_m.get());
+  df_m = df_m.DefinePerSample(
+      "threadPinning_", [](unsigned int slot, const ROOT::RDF::RSampleInfo &) -> int {
+        ThreadPinning::pinSlot(slot);
+        return 0;
+      });
+  RDF_LOG_INFO << "Pinning event-loop threads to "
+               << threadPinning_m->topology().size() << " NUMA node(s)";
+}
+
+/**
+ * @brief Restrict the event loop of the main chain to a preview sample.
+ */
+void DataManager::applyPreviewSampling(double fraction) {
+  TChain *chain = chain_vec_m[0].get();
+  const Long64_t firstEntry = entryRangeApplied_m ? firstEntry_m : 0;
+  const Long64_t lastEntry =
+      entryRangeApplied_m ? std::min(lastEntry_m, chain->GetEntries()) : chain->GetEntries();
+  previewEntries_m = samplePreviewClusters(*chain, fraction, firstEntry, lastEntry);
+
+  auto entryList =
+      chainEntryList("previewSample", "preview sample", *chain, previewEntries_m.ranges());
+  // The sample lies within the entry range, so its list replaces the range's.
+  chain->SetEntryList(entryList.get());
+  previewEntryList_m = std::move(entryList);
+  previewSelected_m = static_cast<Long64_t>(previewEntries_m.size());
+  previewTotal_m = lastEntry - firstEntry;
+  RDF_LOG_INFO << "Preview: processing " << previewSelected_m << " of " << previewTotal_m
+               << " entries (scale " << previewScale() << ")";
+}
+
+/**
+ * @brief Drop @p entries from the event loop.
+ */
+void DataManager::skipEntries(const EntryRangeSet &entries) {
+  // A Filter leaves rdfentry_ unchanged, unlike an entry list, so the
+  // entries recorded by this run stay comparable with @p entries.
+  entriesSkipped_m = true;
+  df_m = df_m.Filter(
+      [entries](ULong64_t entry) { return !entries.contains(entry); },
+      {"rdfentry_"});
+}
+
+/**
+ * @brief Filter on the cached entries of a preselection, or prepare to
+ *        record them.
+ */
+std::string DataManager::useSelectionCache(const std::string &directory,
+                                           const std::string &key) {
+  if (directory.empty() || !selectionCacheKey_m.empty()) {
+    return "";
+  }
+  if (rntupleInput_m || chain_vec_m.empty() || !chain_vec_m[0] ||
+      chain_vec_m[0]->GetEntries() == 0) {
+    RDF_LOG_INFO << "[DataManager] Selection cache not used: no TTree input chain.";
+    return "";
+  }
+  // The bitmaps hold file-local entries, recorded through rdfentry_, which
+  // only counts chain entries while no entry list is attached.
+  if (entryRangeApplied_m || isPreview() || lumiEntryList_m || entriesSkipped_m) {
+    RDF_LOG_INFO << "[DataManager] Selection cache not used: the entries read are already "
+                    "restricted (entry range, preview, lumi mask or checkpoint).";
+    return "";
+  }
+  selectionCacheDir_m = directory;
+  selectionCacheKey_m = key;
+
+  TChain *chain = chain_vec_m[0].get();
+  const Long64_t *offsets = chain->GetTreeOffset();
+  auto cached = std::make_shared<EntryRangeSet>();
+  bool complete = true;
+  TIter nextFile(chain->GetListOfFiles());
+  for (Int_t t = 0; t < chain->GetNtrees(); ++t) {
+    const auto *element = static_cast<TChainElement *>(nextFile());
+    const ULong64_t fileEntries = static_cast<ULong64_t>(offsets[t + 1] - offsets[t]);
+    const auto bitmap =
+        SelectionBitmap::read(selectionBitmapPath(element->GetTitle()), fileEntries);
+    if (!bitmap) {
+      complete = false;
+      break;
+    }
+    // Files are in chain order, so every range is appended at the end.
+    const auto begin = static_cast<ULong64_t>(offsets[t]);
+    for (const auto &[first, last] : bitmap->toRanges().ranges()) {
+      cached->add(begin + first, begin + last);
+    }
+  }
+
+  if (complete) {
+    // A Filter node rather than an entry list on the chain, so that only
+    // the nodes booked from here on are restricted.
+    std::shared_ptr<const EntryRangeSet> entries = cached;
+    df_m = df_m.Filter([entries](ULong64_t entry) { return entries->contains(entry); },
+                       {"rdfentry_"});
+    RDF_LOG_INFO << "[DataManager] Selection cache " << key << ": reading " << entries->size()
+                 << " of " << chain->GetEntries() << " entries.";
+    return "applied";
+  }
+  selectionRecordPending_m = true;
+  return "recording";
+}
+
+void DataManager::recordSelectionCache() {
+  if (!selectionRecordPending_m) {
+    return;
+  }
+  selectionRecordPending_m = false;
+  selectionEntries_m = df_m.Book<ULong64_t>(
+      EntryTrackerAction(df_m.GetNSlots(), "SelectionCacheEntries"), {"rdfentry_"});
+  RDF_LOG_INFO << "[DataManager] Selection cache " << selectionCacheKey_m
+               << ": recording the selected entries of this run.";
+}
+
+/**
+ * @brief Split the recorded entries by file and write one bitmap per file.
+ */
+void DataManager::writeSelectionCache() {
+  if (!selectionEntries_m) {
+    return;
+  }
+  const EntryRangeSet &entries = **selectionEntries_m;
+  TChain *chain = chain_vec_m[0].get();
+  const Long64_t *offsets = chain->GetTreeOffset();
+  TIter nextFile(chain->GetListOfFiles());
+  for (Int_t t = 0; t < chain->GetNtrees(); ++t) {
+    const auto *element = static_cast<TChainElement *>(nextFile());
+    const auto begin = static_cast<ULong64_t>(offsets[t]);
+    const auto end = static_cast<ULong64_t>(offsets[t + 1]);
+    EntryRangeSet local;
+    for (const auto &[first, last] : entries.ranges()) {
+      if (last > begin && first < end) {
+        local.add(std::max(first, begin) - begin, std::min(last, end) - begin);
+      }
+    }
+    SelectionBitmap::fromRanges(local).write(selectionBitmapPath(element->GetTitle()),
+                                             end - begin);
+  }
+  RDF_LOG_INFO << "[DataManager] Selection cache " << selectionCacheKey_m << ": wrote "
+               << chain->GetNtrees() << " bitmaps (" << entries.size() << " of "
+               << chain->GetEntries() << " entries selected) to " << selectionCacheDir_m;
+  selectionEntries_m.reset();
+}
+
+std::string DataManager::selectionBitmapPath(const std::string &file) const {
+  return (std::filesystem::path(selectionCacheDir_m) /
+          (selectionCacheKey_m + "_" + ProvenanceService::hashString(file) + ".sel"))
+      .string();
+}
+
+/**
+ * @brief Stage the remote input files when stagingCacheDir is configured.
+ *
+ * Every chain element with a remote URL is retitled to its cache entry, so
+ * the chains, RNTuple input and the entry counts from an entry index all see
+ * the local copy. Files that cannot be staged keep their remote URL.
+ */
+void DataManager::stageInputFiles(const IConfigurationProvider &configProvider) {
+  const std::string directory = configProvider.get("stagingCacheDir");
+  if (directory.empty()) {
+    return;
+  }
+  const std::string sizeStr = configProvider.get("stagingCacheSize");
+  Long64_t maxBytes = 20LL * 1024 * 1024 * 1024;
+  if (!sizeStr.empty()) {
+    try {
+      maxBytes = std::stoll(sizeStr);
+    } catch (const std::exception &) {
+      throw std::runtime_error("DataManager: invalid stagingCacheSize '" +
+                               sizeStr + "'");
+    }
+  }
+  stagingCache_m = std::make_unique<InputStagingCache>(directory, maxBytes);
+
+  unsigned int staged = 0;
+  for (auto &chain : chain_vec_m) {
+    const TObjArray *elements = chain->GetListOfFiles();
+    if (!elements) {
+      continue;
+    }
+    for (TObject *object : *elements) {
+      auto *element = static_cast<TChainElement *>(object);
+      const std::string url = element->GetTitle();
+      if (!InputStagingCache::isRemote(url)) {
+        continue;
+      }
+      const std::string local = stagingCache_m->stage(url);
+      if (local != url) {
+        element->SetTitle(local.c_str());
+        ++staged;
+      }
+    }
+  }
+  RDF_LOG_INFO << "Staged " << staged << " input file(s) in " << directory << " ("
+               << stagingCache_m->hits() << " already cached)";
+}
+
+/**
+ * @brief Create the file prefetcher when prefetchFiles is configured.
+ *
+ * The first window is queued right away, so its opens overlap the setup
+ * (and the opens of GetEntries() when no entryIndex gives the counts).
+ * Files already opened ahead through asyncOpenFiles are not queued again.
+ */
+void DataManager::setupFilePrefetcher(const IConfigurationProvider &configProvider) {
+  const std::string filesStr = configProvider.get("prefetchFiles");
+  if (filesStr.empty()) {
+    return;
+  }
+  const std::string bytesStr = configProvider.get("prefetchBytes");
+  const std::string openedStr = configProvider.get("asyncOpenFiles");
+  long long lookahead = 0;
+  long long warmBytes = 0;
+  long long opened = 0;
+  try {
+    lookahead = std::stoll(filesStr);
+    if (!bytesStr.empty()) {
+      warmBytes = std::stoll(bytesStr);
+    }
+    if (!openedStr.empty()) {
+      opened = std::stoll(openedStr);
+    }
+  } catch (const std::exception &) {
+    throw std::runtime_error("DataManager: invalid prefetchFiles '" + filesStr +
+                             "' or prefetchBytes '" + bytesStr + "'");
+  }
+  if (lookahead <= 0) {
+    return;
+  }
+  const std::vector<std::string> files = getChainFileNames(*chain_vec_m[0]);
+  if (files.size() < 2) {
+    return;
+  }
+  filePrefetcher_m = std::make_unique<FilePrefetcher>(
+      files, static_cast<unsigned int>(lookahead), warmBytes,
+      static_cast<std::size_t>(std::max(opened, 0LL)));
+  filePrefetcher_m->onFileStarted(files.front());
+  RDF_LOG_INFO << "Prefetching " << lookahead << " file(s) ahead"
+               << (warmBytes > 0 ? " with " + std::to_string(warmBytes) + " warm-up bytes each"
+                                 : std::string());
+}
+
+/**
+ * @brief Move the prefetch window along with the files the loop starts.
+ */
+void DataManager::prefetchOnSampleSwitch() {
+  const std::string treeSuffix = "/" + std::string(chain_vec_m[0]->GetName());
+  df_m = df_m.DefinePerSample(
+      "filePrefetcher_",
+      [this, treeSuffix](unsigned int, const ROOT::RDF::RSampleInfo &info) -> int {
+        std::string url = info.AsString();
+        if (url.size() > treeSuffix.size() &&
+            url.compare(url.size() - treeSuffix.size(), treeSuffix.size(),
+                        treeSuffix) == 0) {
+          url.erase(url.size() - treeSuffix.size());
+        }
+        filePrefetcher_m->onFileStarted(url);
+        return 0;
+      });
+}
+
+/**
+ * @brief Create the slow-site monitor when slowSiteThreshold is configured.
+ *
+ * Sites listed in an existing report (e.g. from a previous attempt of the
+ * same job) start out flagged, so their files are read from the next-ranked
+ * redirector right away.
+ */
+void DataManager::setupSlowSiteMonitor(const IConfigurationProvider &configProvider) {
+  const std::string thresholdStr = configProvider.get("slowSiteThreshold");
+  if (thresholdStr.empty()) {
+    return;
+  }
+  const std::string windowStr = configProvider.get("slowSiteWindow");
+  double threshold = 0.0;
+  double window = 30.0;
+  try {
+    threshold = std::stod(thresholdStr);
+    if (!windowStr.empty()) {
+      window = std::stod(windowStr);
+    }
+  } catch (const std::exception &) {
+    throw std::runtime_error("DataManager: invalid slowSiteThreshold '" +
+                             thresholdStr + "' or slowSiteWindow '" +
+                             windowStr + "'");
+  }
+  if (threshold <= 0.0) {
+    return;
+  }
+
+  slowSiteMonitor_m = std::make_unique<SlowSiteMonitor>(threshold, window);
+  const std::string redirectors = configProvider.get("siteRedirectors");
+  slowSiteMonitor_m->loadRedirectors(redirectors.empty() ? "site_redirectors.json"
+                                                         : redirectors);
+  slowSiteReport_m = configProvider.get("slowSiteReport");
+  if (slowSiteReport_m.empty()) {
+    slowSiteReport_m = "slow_sites.json";
+  }
+
+  const auto reported = SlowSiteMonitor::readReportedSlowSites(slowSiteReport_m);
+  for (const auto &site : reported) {
+    slowSiteMonitor_m->markSlow(site);
+  }
+  if (!reported.empty()) {
+    RDF_LOG_INFO << "Avoiding " << reported.size()
+                 << " slow site(s) from " << slowSiteReport_m;
+    failoverUnopenedFiles();
+  }
+}
+
+/**
+ * @brief Report every sample switch of the event loop to the monitor.
+ *
+ * RSampleInfo identifies TTree samples as "<file>/<tree>". Without
+ * ImplicitMT the loop reads the main chain itself and opens its files one by
+ * one, so files that are still ahead are moved off a site as soon as it is
+ * flagged. With ImplicitMT the file list is fixed when the loop starts and
+ * the failover only takes effect through the report.
+ */
+void DataManager::monitorSampleReads() {
+  const std::string treeSuffix = "/" + std::string(chain_vec_m[0]->GetName());
+  df_m = df_m.DefinePerSample(
+      "slowSiteMonitor_",
+      [this, treeSuffix](unsigned int slot, const ROOT::RDF::RSampleInfo &info) -> int {
+        std::string url = info.AsString();
+        if (url.size() > treeSuffix.size() &&
+            url.compare(url.size() - treeSuffix.size(), treeSuffix.size(),
+                        treeSuffix) == 0) {
+          url.erase(url.size() - treeSuffix.size());
+        }
+        slowSiteMonitor_m->onSample(slot, url);
+        if (!ROOT::IsImplicitMTEnabled()) {
+          failoverUnopenedFiles();
+        }
+        return 0;
+      });
+  columns_m.add("slowSiteMonitor_");
+}
+
+/**
+ * @brief Define SampleSet::kIndexColumn from the file being read.
+ *
+ * The chain holds the files of all samples in sample order, so the sample
+ * of each chain element follows from its position.  Staging and slow-site
+ * failover may change a file's URL but keep its name, which is the fallback.
+ */
+void DataManager::defineSampleIndex() {
+  const std::vector<std::string> files = getChainFileNames(*chain_vec_m[0]);
+  const std::vector<int> fileSamples = samples_m.fileSamples();
+  if (files.size() != fileSamples.size()) {
+    throw std::runtime_error("DataManager: the input chain has " + std::to_string(files.size()) +
+                             " files but sampleConfig lists " +
+                             std::to_string(fileSamples.size()));
+  }
+  for (std::size_t i = 0; i < files.size(); ++i) {
+    sampleByUrl_m[files[i]] = fileSamples[i];
+    sampleByFileName_m[std::filesystem::path(files[i]).filename().string()] = fileSamples[i];
+  }
+  df_m = df_m.DefinePerSample(
+      SampleSet::kIndexColumn,
+      [this](unsigned int, const ROOT::RDF::RSampleInfo &info) -> Float_t {
+        return static_cast<Float_t>(sampleOf(info));
+      });
+  columns_m.add(SampleSet::kIndexColumn);
+  RDF_LOG_INFO << "Processing " << samples_m.size() << " samples in one event loop";
+}
+
+int DataManager::sampleOf(const ROOT::RDF::RSampleInfo &info) const {
+  std::string url = info.AsString();
+  const std::string treeSuffix = "/" + std::string(chain_vec_m[0]->GetName());
+  if (url.size() > treeSuffix.size() &&
+      url.compare(url.size() - treeSuffix.size(), treeSuffix.size(), treeSuffix) == 0) {
+    url.erase(url.size() - treeSuffix.size());
+  }
+  if (auto it = sampleByUrl_m.find(url); it != sampleByUrl_m.end()) {
+    return it->second;
+  }
+  const std::string name = std::filesystem::path(url).filename().string();
+  if (auto it = sampleByFileName_m.find(name); it != sampleByFileName_m.end()) {
+    return it->second;
+  }
+  throw std::runtime_error("DataManager: input file '" + url + "' belongs to no sample");
+}
+
+/**
+ * @brief Move chain files beyond the current tree off slow sites.
+ */
+void DataManager::failoverUnopenedFiles() {
+  auto failover = [this](TChain &chain) {
+    const TObjArray *elements = chain.GetListOfFiles();
+    if (!elements) {
+      return;
+    }
+    for (Int_t i = chain.GetTreeNumber() + 1; i < elements->GetEntriesFast(); ++i) {
+      auto *element = static_cast<TChainElement *>(elements->At(i));
+      const std::string url = element->GetTitle();
+      const std::string replacement = slowSiteMonitor_m->failoverUrl(url);
+      if (!replacement.empty() && replacement != url) {
+        RDF_LOG_INFO << "Slow site failover: " << url << " -> " << replacement;
+        element->SetTitle(replacement.c_str());
+      }
+    }
+  };
+  for (auto &chain : chain_vec_m) {
+    failover(*chain);
+  }
+  for (auto &chain : friend_chains_m) {
+    failover(*chain);
+  }
+}
+
+void DataManager::unpinMainThread() {
+  if (threadPinning_m) {
+    threadPinning_m->unpin();
+  }
+}
+
+void DataManager::reportSlowSites() {
+  if (!slowSiteMonitor_m) {
+    return;
+  }
+  slowSiteMonitor_m->closeAll();
+  slowSiteMonitor_m->writeReport(slowSiteReport_m);
+  const auto slow = slowSiteMonitor_m->slowSites();
+  if (!slow.empty()) {
+    RDF_LOG_WARN << "Warning: " << slow.size() << " slow XRootD site(s) reported in "
+                 << slowSiteReport_m;
+  }
+}
+
+void DataManager::enableNodeProfiling(const std::string &reportPath) {
+  if (!nodeProfiler_m) {
+    nodeProfiler_m = std::make_unique<NodeProfiler>(df_m.GetNSlots());
+  }
+  nodeProfileReport_m = reportPath;
+}
+
+void DataManager::enableAllocationProfiling(const std::string &reportPath) {
+  enableNodeProfiling(reportPath);
+  if (nodeProfiler_m->tracksAllocations()) {
+    return;
+  }
+  if (!nodeProfiler_m->trackAllocations()) {
+    RDF_LOG_WARN << "Warning: heap allocations are not counted in this process "
+                 << "(core is built without -DPROFILE_ALLOCATIONS=ON, or operator new "
+                 << "is not replaced); allocation counts will be zero";
+  }
+  bookAllocationTasks();
+}
+
+void DataManager::bookAllocationTasks() {
+  // Booked on the root node, so that every entry of a task is counted.
+  allocationTasks_m = df_m.Book<ULong64_t>(
+      AllocationTaskAction(nodeProfiler_m.get(), df_m.GetNSlots()), {"rdfentry_"});
+}
+
+void DataManager::gateColumns(const std::vector<std::string> &columns,
+                              const std::string &gate) {
+  for (const auto &column : columns) {
+    if (gate.empty()) {
+      columnGates_m.erase(column);
+    } else {
+      columnGates_m[column] = gate;
+    }
+  }
+}
+
+std::string DataManager::defineGate(const std::string &name) {
+  auto it = columnGates_m.find(name);
+  const std::string &gate = it != columnGates_m.end() ? it->second : gateScope_m;
+  if (gate.empty() || gate == name) {
+    return std::string();
+  }
+  if (!hasColumn(gate)) {
+    if (missingGates_m.insert(gate).second) {
+      RDF_LOG_WARN << "Warning: gate column '" << gate << "' is not defined yet; columns "
+                   << "gated by it are computed for every entry until it is (first: '"
+                   << name << "')";
+    }
+    return std::string();
+  }
+  return gate;
+}
+
+void DataManager::reportNodeProfile() {
+  if (!nodeProfiler_m) {
+    return;
+  }
+  nodeProfiler_m->writeReport(nodeProfileReport_m);
+  const auto entries = nodeProfiler_m->entries();
+  RDF_LOG_INFO << "Node profile of " << entries.size() << " node(s) written to "
+               << nodeProfileReport_m;
+  for (std::size_t i = 0; i < entries.size() && i < 5; ++i) {
+    RDF_LOG_INFO << "  " << entries[i].name << " [" << entries[i].owner << "]: "
+                 << entries[i].nanoseconds / 1e6 << " ms in " << entries[i].calls
+                 << " call(s)";
+  }
+  if (nodeProfiler_m->tracksAllocations()) {
+    const double events =
+        static_cast<double>(std::max<std::uint64_t>(nodeProfiler_m->taskTotals().entries, 1));
+    for (const auto &[owner, counts] : nodeProfiler_m->ownerAllocations()) {
+      RDF_LOG_INFO << "  allocations [" << owner << "]: " << counts.allocations / events
+                   << " per event, " << counts.bytes / events << " bytes per event";
+    }
+    // The task action of this loop has run; the next loop needs its own.
+    if (allocationTasks_m && allocationTasks_m->IsReady()) {
+      bookAllocationTasks();
+    }
+  }
+}
+
+void DataManager::enableJitCache(const std::string &directory, bool build) {
+  jitCache_m = std::make_unique<JitCache>(directory, build);
+  buildJitCache_m = build;
+}
+
+ROOT::RDF::RNode DataManager::defineExpression(ROOT::RDF::RNode df,
+                                               const std::string &name,
+                                               const std::string &expression) {
+  // Recorded without materializing: @p df may be a copy of df_m.
+  const std::string folded = foldConstants(expression);
+  const auto identifiers = expressionIdentifiers(folded);
+  readColumns_m.insert(identifiers.begin(), identifiers.end());
+  ++jitExpressionCount_m;
+  if (!jitCache_m) {
+    return df.Define(name, folded);
+  }
+  return jitCache_m->define(df, name, folded);
+}
+
+void *DataManager::compileFunction(const std::string &source) {
+  return jitCache_m ? jitCache_m->function(source) : JitCache::declareFunction(source);
+}
+
+void DataManager::buildJitCache() {
+  if (!jitCache_m || !buildJitCache_m) {
+    return;
+  }
+  const std::size_t added = jitCache_m->build();
+  const std::size_t missed = jitCache_m->missed().size() + jitCache_m->missedFunctions().size();
+  if (missed > 0) {
+    RDF_LOG_INFO << "JIT cache: compiled " << added << " of " << missed
+                 << " JIT expression(s) and function(s) into the cache";
+  }
+}
+
+void DataManager::exportJitExpressions() {
+  if (!jitCache_m || jitExportFile_m.empty()) {
+    return;
+  }
+  const std::size_t written = jitCache_m->exportTranslationUnit(jitExportFile_m);
+  RDF_LOG_INFO << "JIT export: wrote " << written << " expression(s) to " << jitExportFile_m;
+}
+
+void DataManager::recordColumnsRead(const std::vector<std::string> &columns) {
+  readColumns_m.insert(columns.begin(), columns.end());
+  // Define() and Filter() read their inputs from the node after recording
+  // them, so a folded constant read as a column is defined in time.
+  for (const auto &column : columns) {
+    materializeConstant(column);
+  }
+}
+
+std::vector<std::string> DataManager::getReadInputBranches() const {
+  if (rntupleInput_m || chain_vec_m.empty() || !chain_vec_m[0]) {
+    return {};
+  }
+  TObjArray *branches = chain_vec_m[0]->GetListOfBranches();
+  if (!branches) {
+    return {};
+  }
+
+  // The reads of every define of the main dataframe come from its column
+  // register, so columns defined directly on an RNode are covered too.
+  const RegisteredColumns node(df_m);
+  const auto &registered = node.columns();
+  std::unordered_set<std::string> columns(readColumns_m.begin(), readColumns_m.end());
+  for (const auto name : registered.BuildDefineNames()) {
+    if (const auto *define = registered.GetDefine(name)) {
+      const auto &inputs = define->GetColumnNames();
+      columns.insert(inputs.begin(), inputs.end());
+    }
+  }
+
+  // An alias reads the column it names; a name like "branch.leaf" reads
+  // "branch".
+  std::unordered_set<std::string> read;
+  for (const auto &name : columns) {
+    for (const std::string column : {name, std::string(registered.ResolveAlias(name))}) {
+      read.insert(column);
+      const auto dot = column.find('.');
+      if (dot != std::string::npos) {
+        read.insert(column.substr(0, dot));
+      }
+    }
+  }
+
+  std::set<std::string> kept;
+  for (auto *obj : *branches) {
+    auto *branch = static_cast<TBranch *>(obj);
+    const std::string name = branch->GetName();
+    bool keep = read.count(name) > 0;
+    for (std::size_t i = 0; !keep && i < keepInputBranches_m.size(); ++i) {
+      keep = fnmatch(keepInputBranches_m[i].c_str(), name.c_str(), 0) == 0;
+    }
+    if (!keep) {
+      continue;
+    }
+    kept.insert(name);
+    // An array is read together with the branch holding its size.
+    for (auto *leafObj : *branch->GetListOfLeaves()) {
+      if (auto *count = static_cast<TLeaf *>(leafObj)->GetLeafCount()) {
+        kept.insert(count->GetBranch()->GetName());
+      }
+    }
+  }
+  return {kept.begin(), kept.end()};
+}
+
+std::size_t DataManager::pruneUnreadBranches() {
+  if (rntupleInput_m || chain_vec_m.empty() || !chain_vec_m[0]) {
+    RDF_LOG_INFO << "[DataManager] No input chain; input branches not pruned.";
+    return 0;
+  }
+  TChain *chain = chain_vec_m[0].get();
+  TObjArray *branches = chain->GetListOfBranches();
+  if (!branches) {
+    return 0;
+  }
+  const auto read = getReadInputBranches();
+  std::size_t disabled = 0;
+  if (ROOT::IsImplicitMTEnabled()) {
+    // Each task of a multithreaded loop reads its own chain, built from the
+    // file names, so statuses set on this chain would not reach it; those
+    // trees only read the branches of booked columns.
+    RDF_LOG_INFO << "Input branch pruning: reading " << read.size() << " of "
+                 << branches->GetEntriesFast()
+                 << " branches; the multithreaded loop opens its own trees, so no "
+                    "branch is disabled";
+  } else {
+    const std::unordered_set<std::string> keep(read.begin(), read.end());
+    for (auto *obj : *branches) {
+      const char *name = obj->GetName();
+      if (!keep.count(name)) {
+        chain->SetBranchStatus(name, 0);
+        ++disabled;
+      }
+    }
+    RDF_LOG_INFO << "Input branch pruning: reading " << read.size() << " of "
+                 << branches->GetEntriesFast() << " branches, " << disabled
+                 << " disabled";
+  }
+
+  if (!inputBranchReport_m.empty()) {
+    std::ofstream report(inputBranchReport_m);
+    if (!report) {
+      throw std::runtime_error("DataManager: cannot write inputBranchReport '" +
+                               inputBranchReport_m + "'");
+    }
+    for (const auto &name : read) {
+      report << name << "\n";
+    }
+  }
+  return disabled;
+}
+
+/**
+ * @brief Restrict the event loop to entries in certified luminosity sections.
+ */
+Long64_t DataManager::applyLumiSectionMask(
+    const std::function<bool(unsigned int, unsigned int)> &isCertified,
+    const std::string &runBranch,
+    const std::string &lumiBranch) {
+  if (rntupleInput_m) {
+    RDF_LOG_INFO << "[DataManager] RNTuple input; lumi-section pre-skipping not applied.";
+    return -1;
+  }
+  if (chain_vec_m.empty() || !chain_vec_m[0] ||
+      chain_vec_m[0]->GetEntries() == 0) {
+    RDF_LOG_INFO << "[DataManager] No input chain; lumi-section pre-skipping not applied.";
+    return -1;
+  }
+  TChain *chain = chain_vec_m[0].get();
+
+  // Scan with an independent chain over the same files so that the branch
+  // status and addresses of the main chain are left untouched.
+  TChain scanChain(chain->GetName());
+  TIter nextFile(chain->GetListOfFiles());
+  while (auto *element = static_cast<TChainElement *>(nextFile())) {
+    scanChain.Add(element->GetTitle());
+  }
+  scanChain.SetBranchStatus("*", false);
+  scanChain.SetBranchStatus(runBranch.c_str(), true);
+  scanChain.SetBranchStatus(lumiBranch.c_str(), true);
+
+  UInt_t run = 0;
+  UInt_t lumi = 0;
+  if (scanChain.SetBranchAddress(runBranch.c_str(), &run) < 0 ||
+      scanChain.SetBranchAddress(lumiBranch.c_str(), &lumi) < 0) {
+    RDF_LOG_WARN << "[DataManager] Warning: cannot read branches '" << runBranch
+                 << "' / '" << lumiBranch
+                 << "'; lumi-section pre-skipping not applied.";
+    return -1;
+  }
+
+  // With a configured entry range only that range is scanned, and the mask
+  // replaces the range list (it is a subset of it).  A preview sample is
+  // intersected with the mask for the same reason.
+  const Long64_t firstEntry = entryRangeApplied_m ? firstEntry_m : 0;
+  const Long64_t nEntries = entryRangeApplied_m
+                                ? std::min(lastEntry_m, scanChain.GetEntries())
+                                : scanChain.GetEntries();
+  EntryRangeSet certified;
+  Long64_t kept = 0;
+  bool haveLast = false;
+  UInt_t lastRun = 0;
+  UInt_t lastLumi = 0;
+  bool lastCertified = false;
+  for (Long64_t entry = firstEntry; entry < nEntries; ++entry) {
+    if (scanChain.GetEntry(entry) <= 0) {
+      continue;
+    }
+    // Events of one lumi section are stored contiguously, so the predicate
+    // runs once per section rather than once per event.
+    if (!haveLast || run != lastRun || lumi != lastLumi) {
+      haveLast = true;
+      lastRun = run;
+      lastLumi = lumi;
+      lastCertified = isCertified(run, lumi);
+    }
+    if (lastCertified && (!isPreview() ||
+                          previewEntries_m.contains(static_cast<ULong64_t>(entry)))) {
+      certified.add(static_cast<ULong64_t>(entry));
+      ++kept;
+    }
+  }
+
+  auto entryList = chainEntryList("lumiSectionMask", "certified lumi sections", scanChain,
+                                  certified.ranges());
+  chain->SetEntryList(entryList.get());
+  lumiEntryList_m = std::move(entryList);
+  RDF_LOG_INFO << "[DataManager] Lumi-section mask applied: kept " << kept
+               << " of " << (nEntries - firstEntry) << " entries.";
+  return kept;
+}
+
 /**
  * @brief Attach a single friend tree specified by @p spec to the main TChain.
  */
@@ -487,22 +2275,21 @@ void DataManager::attachFriendTree(const FriendTreeSpec &spec) {
 
   if (!spec.files.empty()) {
     for (const auto &f : spec.files) {
-      std::cout << "[DataManager] Adding friend file: " << f << std::endl;
+      RDF_LOG_INFO << "[DataManager] Adding friend file: " << f;
       friendChain->Add(f.c_str());
     }
   } else if (!spec.directory.empty()) {
     scan(*friendChain, spec.directory, spec.globs, spec.antiglobs);
   } else {
-    std::cerr << "[DataManager] Warning: friend tree '" << spec.alias
-              << "' has neither fileList nor directory; skipping." << std::endl;
+    RDF_LOG_WARN << "[DataManager] Warning: friend tree '" << spec.alias
+                 << "' has neither fileList nor directory; skipping.";
     return;
   }
 
   const Long64_t nFriendEntries = friendChain->GetEntries();
   if (nFriendEntries == 0) {
-    std::cerr << "[DataManager] Warning: friend tree '" << spec.alias
-              << "' has no entries (files may not exist or tree is empty)."
-              << std::endl;
+    RDF_LOG_WARN << "[DataManager] Warning: friend tree '" << spec.alias
+                 << "' has no entries (files may not exist or tree is empty).";
   }
 
   // Build an in-memory event index for non-sequential (identifier-based) matching.
@@ -511,20 +2298,20 @@ void DataManager::attachFriendTree(const FriendTreeSpec &spec) {
     const std::string &major = spec.indexBranches[0];
     const std::string minor =
         spec.indexBranches.size() > 1 ? spec.indexBranches[1] : "0";
-    std::cout << "[DataManager] Building index on '" << major << "' / '"
-              << minor << "' for friend '" << spec.alias << "'" << std::endl;
+    RDF_LOG_INFO << "[DataManager] Building index on '" << major << "' / '"
+                 << minor << "' for friend '" << spec.alias << "'";
     friendChain->BuildIndex(major.c_str(), minor.c_str());
   }
 
   if (!chain_vec_m.empty() && chain_vec_m[0]) {
     chain_vec_m[0]->AddFriend(friendChain.get(), spec.alias.c_str());
-    std::cout << "[DataManager] Attached friend tree '" << spec.alias
-              << "' (tree='" << spec.treeName << "', entries=" << nFriendEntries
-              << ")" << std::endl;
+    RDF_LOG_INFO << "[DataManager] Attached friend tree '" << spec.alias
+                 << "' (tree='" << spec.treeName << "', entries=" << nFriendEntries
+                 << ")";
   } else {
-    std::cerr << "[DataManager] Warning: no main chain available; cannot "
-                 "attach friend tree '"
-              << spec.alias << "'." << std::endl;
+    RDF_LOG_WARN << "[DataManager] Warning: no main chain available; cannot "
+                    "attach friend tree '"
+                 << spec.alias << "'.";
     return;
   }
 
@@ -532,6 +2319,68 @@ void DataManager::attachFriendTree(const FriendTreeSpec &spec) {
   friend_chains_m.push_back(std::move(friendChain));
 }
 
+std::size_t DataManager::attachSkimLayers() {
+  if (chain_vec_m.empty() || !chain_vec_m[0]) {
+    return 0;
+  }
+  if (rntupleInput_m) {
+    throw std::runtime_error(
+        "DataManager: skim layers are not supported with RNTuple input");
+  }
+
+  std::vector<std::string> layerFiles = getChainFileNames(*chain_vec_m[0]);
+  std::vector<std::string> indexBranches;
+  std::unordered_set<std::string> visited(layerFiles.begin(), layerFiles.end());
+  std::size_t layers = 0;
+  while (true) {
+    std::vector<std::string> bases;
+    for (const auto &file : layerFiles) {
+      const std::string manifestPath = SkimColumnManifest::pathFor(file);
+      if (!std::filesystem::exists(manifestPath)) {
+        continue;
+      }
+      const auto manifest = SkimColumnManifest::read(manifestPath);
+      if (manifest.base.empty()) {
+        continue;
+      }
+      std::filesystem::path base(manifest.base);
+      if (base.is_relative()) {
+        base = std::filesystem::path(file).parent_path() / base;
+      }
+      if (!visited.insert(base.string()).second) {
+        throw std::runtime_error("DataManager: skim layer '" + base.string() +
+                                 "' is reached twice; the base links of '" +
+                                 file + "' loop");
+      }
+      bases.push_back(base.string());
+      if (layers == 0 && indexBranches.empty()) {
+        indexBranches = manifest.indexColumns;
+      }
+    }
+    if (bases.empty()) {
+      break;
+    }
+    if (bases.size() != layerFiles.size()) {
+      throw std::runtime_error("DataManager: " + std::to_string(bases.size()) + " of " +
+                               std::to_string(layerFiles.size()) + " skims of layer " +
+                               std::to_string(layers) +
+                               " name a base skim; all or none must");
+    }
+
+    FriendTreeSpec spec;
+    spec.alias = "skim_layer" + std::to_string(++layers);
+    spec.treeName = chain_vec_m[0]->GetName();
+    spec.files = bases;
+    spec.indexBranches = indexBranches;
+    attachFriendTree(spec);
+    layerFiles = std::move(bases);
+  }
+  if (layers > 0) {
+    RDF_LOG_INFO << "[DataManager] Attached " << layers << " skim layer(s)";
+  }
+  return layers;
+}
+
 /**
  * @brief Attach friend trees or sidecar files declared in a YAML config file.
  */
@@ -543,19 +2392,23 @@ void DataManager::registerFriendTrees(
     return;
   }
   if (!std::filesystem::exists(friendConfigFile)) {
-    std::cerr << "[DataManager] Warning: friendConfig file '" << friendConfigFile
-              << "' not found; skipping friend tree registration." << std::endl;
+    RDF_LOG_WARN << "[DataManager] Warning: friendConfig file '" << friendConfigFile
+                 << "' not found; skipping friend tree registration.";
     return;
   }
 
-  std::cout << "[DataManager] Loading friend tree config from '"
-            << friendConfigFile << "'" << std::endl;
+  RDF_LOG_INFO << "[DataManager] Loading friend tree config from '"
+               << friendConfigFile << "'";
 
   const auto specs = parseFriendTreeConfig(friendConfigFile);
   if (specs.empty()) {
-    std::cout << "[DataManager] No friend trees found in config." << std::endl;
+    RDF_LOG_INFO << "[DataManager] No friend trees found in config.";
     return;
   }
+  if (rntupleInput_m) {
+    throw std::runtime_error(
+        "DataManager: friend trees are not supported with RNTuple input");
+  }
 
   for (const auto &spec : specs) {
     attachFriendTree(spec);
@@ -568,8 +2421,9 @@ void DataManager::registerFriendTrees(
   if (!chain_vec_m.empty() && chain_vec_m[0] &&
       chain_vec_m[0]->GetEntries() > 0) {
     df_m = ROOT::RDataFrame(*chain_vec_m[0]);
-    std::cout << "[DataManager] RDataFrame rebuilt after attaching "
-              << specs.size() << " friend tree(s)." << std::endl;
+    columns_m.invalidate();
+    RDF_LOG_INFO << "[DataManager] RDataFrame rebuilt after attaching "
+                 << specs.size() << " friend tree(s).";
   }
 }
 
@@ -0,0 +1,142 @@
+#include <FilePrefetcher.h>
+#include <AsyncLogger.h>
+#include <InputStagingCache.h>
+
+#include <TFile.h>
+#include <TROOT.h>
+
+#include <algorithm>
+#include <memory>
+#include <utility>
+
+namespace {
+
+/// Size of one warm-up read.
+constexpr Long64_t kWarmChunkBytes = 1024 * 1024;
+
+} // namespace
+
+FilePrefetcher::FilePrefetcher(std::vector<std::string> files, unsigned int lookahead,
+                               Long64_t warmBytes, std::size_t opened)
+    : files_m(std::move(files)), lookahead_m(lookahead),
+      warmBytes_m(std::max<Long64_t>(warmBytes, 0)),
+      queuedUpTo_m(std::min(opened, files_m.size())) {
+  for (std::size_t i = 0; i < files_m.size(); ++i) {
+    index_m.emplace(files_m[i], i);
+  }
+  ROOT::EnableThreadSafety();
+  worker_m = std::thread(&FilePrefetcher::run, this);
+}
+
+FilePrefetcher::~FilePrefetcher() { stop(); }
+
+void FilePrefetcher::stop() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_m);
+    stop_m = true;
+    queue_m.clear();
+  }
+  wake_m.notify_all();
+  if (worker_m.joinable()) {
+    worker_m.join();
+  }
+}
+
+void FilePrefetcher::onFileStarted(const std::string &url) {
+  const auto it = index_m.find(url);
+  if (it == index_m.end()) {
+    return;
+  }
+  const std::size_t end = std::min(files_m.size(), it->second + 1 + lookahead_m);
+  bool queued = false;
+  std::unique_ptr<TFile> warmed;
+  {
+    std::lock_guard<std::mutex> lock(mutex_m);
+    const auto file = warmFiles_m.find(url);
+    if (file != warmFiles_m.end()) {
+      warmed = std::move(file->second);
+      warmFiles_m.erase(file);
+    }
+    // Slots start files out of order; everything up to the furthest
+    // window is queued exactly once.
+    for (std::size_t i = std::max(queuedUpTo_m, it->second + 1); i < end; ++i) {
+      if (InputStagingCache::isRemote(files_m[i])) {
+        queue_m.push_back(files_m[i]);
+        queued = true;
+      }
+    }
+    queuedUpTo_m = std::max(queuedUpTo_m, end);
+  }
+  if (queued) {
+    wake_m.notify_one();
+  }
+}
+
+void FilePrefetcher::wait() {
+  std::unique_lock<std::mutex> lock(mutex_m);
+  idle_m.wait(lock, [this] { return stop_m || (queue_m.empty() && !busy_m); });
+}
+
+unsigned int FilePrefetcher::prefetched() const {
+  std::lock_guard<std::mutex> lock(mutex_m);
+  return prefetched_m;
+}
+
+Long64_t FilePrefetcher::warmedBytes() const {
+  std::lock_guard<std::mutex> lock(mutex_m);
+  return warmedBytes_m;
+}
+
+void FilePrefetcher::run() {
+  std::unique_lock<std::mutex> lock(mutex_m);
+  while (true) {
+    wake_m.wait(lock, [this] { return stop_m || !queue_m.empty(); });
+    if (stop_m) {
+      break;
+    }
+    const std::string url = std::move(queue_m.front());
+    queue_m.pop_front();
+    busy_m = true;
+    lock.unlock();
+
+    // The warm-up open would consume a pending async open of the same URL.
+    const Long64_t bytes = warmBytes_m > 0 ? warm(url, warmBytes_m) : 0;
+    openAhead(url);
+
+    lock.lock();
+    busy_m = false;
+    ++prefetched_m;
+    warmedBytes_m += bytes;
+    if (queue_m.empty()) {
+      idle_m.notify_all();
+    }
+  }
+  busy_m = false;
+  idle_m.notify_all();
+}
+
+void FilePrefetcher::openAhead(const std::string &url) {
+  TFile::AsyncOpen(url.c_str());
+}
+
+Long64_t FilePrefetcher::warm(const std::string &url, Long64_t bytes) {
+  std::unique_ptr<TFile> file(TFile::Open(url.c_str(), "READ"));
+  if (!file || file->IsZombie()) {
+    RDF_LOG_WARN << "Warning: FilePrefetcher: cannot open " << url << " to warm it";
+    return 0;
+  }
+  const Long64_t total = std::min(bytes, file->GetSize());
+  std::vector<char> buffer(static_cast<std::size_t>(std::min(total, kWarmChunkBytes)));
+  Long64_t read = 0;
+  while (read < total) {
+    const Long64_t chunk = std::min(kWarmChunkBytes, total - read);
+    file->Seek(read);
+    if (file->ReadBuffer(buffer.data(), static_cast<Int_t>(chunk))) {
+      break;
+    }
+    read += chunk;
+  }
+  std::lock_guard<std::mutex> lock(mutex_m);
+  warmFiles_m[url] = std::move(file);
+  return read;
+}
@@ -0,0 +1,110 @@
+#include <FilterProfile.h>
+#include <JsonString.h>
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <numeric>
+#include <sstream>
+#include <stdexcept>
+#include <unistd.h>
+#include <yaml-cpp/yaml.h>
+
+namespace {
+
+/// Expected time spent per rejected event; lower runs earlier.
+double rank(const FilterProfile::Stats &stats) {
+  const double rejected = 1.0 - stats.passFraction();
+  if (rejected <= 0.0) {
+    return std::numeric_limits<double>::infinity();
+  }
+  return stats.costNs() / rejected;
+}
+
+} // namespace
+
+std::map<std::string, FilterProfile::Stats> FilterProfile::measured() const {
+  std::map<std::string, Stats> result;
+  for (const auto &filter : filters_m) {
+    Stats &stats = result[filter.name];
+    for (const auto &slot : filter.slots) {
+      stats.calls += slot.calls;
+      stats.passed += slot.passed;
+      stats.nanoseconds += slot.nanoseconds;
+    }
+  }
+  return result;
+}
+
+std::map<std::string, FilterProfile::Stats> FilterProfile::read(const std::string &path) {
+  std::map<std::string, Stats> profile;
+  if (!std::filesystem::exists(path)) {
+    return profile;
+  }
+  YAML::Node root;
+  try {
+    root = YAML::LoadFile(path);
+  } catch (const YAML::Exception &e) {
+    throw std::runtime_error("FilterProfile: cannot read '" + path + "': " + e.what());
+  }
+  if (root["filters"] && root["filters"].IsMap()) {
+    for (const auto &filter : root["filters"]) {
+      Stats &stats = profile[filter.first.as<std::string>()];
+      stats.calls = filter.second["calls"].as<std::uint64_t>(0);
+      stats.passed = filter.second["passed"].as<std::uint64_t>(0);
+      stats.nanoseconds = filter.second["ns"].as<std::uint64_t>(0);
+    }
+  }
+  return profile;
+}
+
+void FilterProfile::write(const std::string &path,
+                          const std::map<std::string, Stats> &previous) const {
+  std::map<std::string, Stats> profile = previous;
+  for (const auto &[name, stats] : measured()) {
+    if (stats.calls > 0 || !profile.count(name)) {
+      profile[name] = stats;
+    }
+  }
+
+  std::ostringstream out;
+  out << "{\n  \"filters\": {";
+  bool first = true;
+  for (const auto &[name, stats] : profile) {
+    out << (first ? "\n" : ",\n") << "    " << jsonString(name) << ": {\"calls\": "
+        << stats.calls << ", \"passed\": " << stats.passed << ", \"ns\": "
+        << stats.nanoseconds << "}";
+    first = false;
+  }
+  out << (first ? "" : "\n  ") << "}\n}\n";
+
+  // Write to a temporary file first so readers never see a partial profile.
+  const std::string tmpPath = path + ".tmp." + std::to_string(getpid());
+  {
+    std::ofstream file(tmpPath);
+    if (!file) {
+      throw std::runtime_error("FilterProfile: cannot write '" + path + "'");
+    }
+    file << out.str();
+  }
+  std::filesystem::rename(tmpPath, path);
+}
+
+std::vector<std::size_t> FilterProfile::order(const std::vector<std::string> &names,
+                                              const std::map<std::string, Stats> &profile) {
+  std::vector<std::size_t> indices(names.size());
+  std::iota(indices.begin(), indices.end(), 0);
+  std::vector<double> ranks;
+  ranks.reserve(names.size());
+  for (const auto &name : names) {
+    auto it = profile.find(name);
+    if (it == profile.end() || it->second.calls == 0) {
+      return indices;
+    }
+    ranks.push_back(rank(it->second));
+  }
+  std::stable_sort(indices.begin(), indices.end(),
+                   [&ranks](std::size_t a, std::size_t b) { return ranks[a] < ranks[b]; });
+  return indices;
+}
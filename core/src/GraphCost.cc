@@ -0,0 +1,90 @@
+#include <GraphCost.h>
+#include <JsonString.h>
+#include <api/IConfigurationProvider.h>
+
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+
+/// Budget @p key of @p config; 0 when unset.
+double budget(const IConfigurationProvider &config, const std::string &key) {
+  const auto &map = config.getConfigMap();
+  const auto it = map.find(key);
+  if (it == map.end() || it->second.empty()) {
+    return 0.0;
+  }
+  try {
+    return std::stod(it->second);
+  } catch (const std::exception &) {
+    throw std::runtime_error("GraphCost: " + key + " is not a number: " + it->second);
+  }
+}
+
+} // namespace
+
+std::uint64_t GraphCost::histogramCells() const {
+  std::uint64_t cells = 0;
+  for (const auto &histogram : histograms) {
+    cells += histogram.cells;
+  }
+  return cells;
+}
+
+std::uint64_t GraphCost::histogramBytesPerSlot() const {
+  std::uint64_t bytes = 0;
+  for (const auto &histogram : histograms) {
+    bytes += histogram.bytesPerSlot;
+  }
+  return bytes;
+}
+
+std::uint64_t GraphCost::histogramBytes() const { return histogramBytesPerSlot() * slots; }
+
+bool GraphCost::checkBudgets(const IConfigurationProvider &config) {
+  const auto check = [this, &config](const std::string &key, double value,
+                                     const std::string &what) {
+    const double limit = budget(config, key);
+    if (limit > 0.0 && value > limit) {
+      std::ostringstream message;
+      message << what << " " << value << " exceeds " << key << "=" << limit;
+      warnings.push_back(message.str());
+    }
+  };
+  const std::size_t before = warnings.size();
+  check("costBudgetColumns", static_cast<double>(definedColumns), "defined columns");
+  check("costBudgetJitExpressions", static_cast<double>(jitCompiled), "JIT-compiled expressions");
+  check("costBudgetHistogramCells", static_cast<double>(histogramCells()), "histogram cells");
+  check("costBudgetHistogramMB", static_cast<double>(histogramBytes()) / 1e6,
+        "histogram memory (MB, all slots)");
+  check("costBudgetModels", static_cast<double>(models), "ML models");
+  return warnings.size() == before;
+}
+
+std::string GraphCost::toJson() const {
+  std::ostringstream out;
+  out << "{\n"
+      << "  \"defined_columns\": " << definedColumns << ",\n"
+      << "  \"jit_expressions\": " << jitExpressions << ",\n"
+      << "  \"jit_compiled\": " << jitCompiled << ",\n"
+      << "  \"systematics\": " << systematics << ",\n"
+      << "  \"slots\": " << slots << ",\n"
+      << "  \"models\": " << models << ",\n"
+      << "  \"histogram_cells\": " << histogramCells() << ",\n"
+      << "  \"histogram_bytes_per_slot\": " << histogramBytesPerSlot() << ",\n"
+      << "  \"histogram_bytes\": " << histogramBytes() << ",\n"
+      << "  \"histograms\": [";
+  for (std::size_t i = 0; i < histograms.size(); ++i) {
+    const auto &histogram = histograms[i];
+    out << (i == 0 ? "\n" : ",\n") << "    {\"name\": " << jsonString(histogram.name)
+        << ", \"cells\": " << histogram.cells
+        << ", \"systematics\": " << histogram.systematics
+        << ", \"bytes_per_slot\": " << histogram.bytesPerSlot << "}";
+  }
+  out << (histograms.empty() ? "" : "\n  ") << "],\n  \"warnings\": [";
+  for (std::size_t i = 0; i < warnings.size(); ++i) {
+    out << (i == 0 ? "\n    " : ",\n    ") << jsonString(warnings[i]);
+  }
+  out << (warnings.empty() ? "" : "\n  ") << "]\n}\n";
+  return out.str();
+}
@@ -0,0 +1,213 @@
+#include <HistSpill.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <queue>
+#include <stdexcept>
+#include <unistd.h>
+
+namespace {
+
+constexpr std::size_t kReadCells = 4096;
+
+/// Buffered sequential reader of one run.
+class RunReader {
+public:
+  explicit RunReader(const std::string &path) : path_m(path), in_m(path, std::ios::binary) {
+    if (!in_m) {
+      throw std::runtime_error("HistSpillRuns: cannot open run " + path);
+    }
+    refill();
+  }
+
+  bool done() const { return pos_m == buffer_m.size(); }
+  const HistSpillRuns::Cell &cell() const { return buffer_m[pos_m]; }
+
+  void next() {
+    if (++pos_m == buffer_m.size()) {
+      refill();
+    }
+  }
+
+private:
+  void refill() {
+    buffer_m.resize(kReadCells);
+    in_m.read(reinterpret_cast<char *>(buffer_m.data()),
+              static_cast<std::streamsize>(kReadCells * sizeof(HistSpillRuns::Cell)));
+    const auto bytes = static_cast<std::size_t>(in_m.gcount());
+    if (bytes % sizeof(HistSpillRuns::Cell) != 0 || in_m.bad()) {
+      throw std::runtime_error("HistSpillRuns: run " + path_m + " is truncated");
+    }
+    buffer_m.resize(bytes / sizeof(HistSpillRuns::Cell));
+    pos_m = 0;
+  }
+
+  std::string path_m;
+  std::ifstream in_m;
+  std::vector<HistSpillRuns::Cell> buffer_m;
+  std::size_t pos_m = 0;
+};
+
+/// k-way merge of @p paths, summing the cells of equal index.
+void mergeRuns(const std::vector<std::string> &paths,
+               const std::function<void(const HistSpillRuns::Cell &)> &emit) {
+  std::vector<RunReader> readers;
+  readers.reserve(paths.size());
+  for (const auto &path : paths) {
+    readers.emplace_back(path);
+  }
+  // Min-heap of (index, reader).
+  using Head = std::pair<std::uint64_t, std::size_t>;
+  std::priority_queue<Head, std::vector<Head>, std::greater<Head>> heads;
+  for (std::size_t r = 0; r < readers.size(); ++r) {
+    if (!readers[r].done()) {
+      heads.emplace(readers[r].cell().index, r);
+    }
+  }
+  while (!heads.empty()) {
+    HistSpillRuns::Cell sum{heads.top().first, 0.0, 0.0};
+    while (!heads.empty() && heads.top().first == sum.index) {
+      RunReader &reader = readers[heads.top().second];
+      heads.pop();
+      sum.sumw += reader.cell().sumw;
+      sum.sumw2 += reader.cell().sumw2;
+      reader.next();
+      if (!reader.done()) {
+        heads.emplace(reader.cell().index, &reader - readers.data());
+      }
+    }
+    emit(sum);
+  }
+}
+
+void removeRuns(const std::vector<std::string> &paths) {
+  for (const auto &path : paths) {
+    std::remove(path.c_str());
+  }
+}
+
+std::string fileName(const std::string &name) {
+  std::string out = name.empty() ? "hist" : name;
+  for (char &c : out) {
+    if (c == '/' || c == '\\' || c == ' ') {
+      c = '_';
+    }
+  }
+  return out;
+}
+
+} // namespace
+
+HistSpillRuns::HistSpillRuns(const std::string &directory, const std::string &name,
+                             unsigned int nSlots)
+    : slotRuns_m(std::max(nSlots, 1u)), slotBytes_m(std::max(nSlots, 1u), 0) {
+  std::error_code error;
+  std::filesystem::create_directories(directory, error);
+  if (error) {
+    throw std::runtime_error("HistSpillRuns: cannot create spill directory " + directory +
+                             ": " + error.message());
+  }
+  // Distinct per process and per histogram, so that jobs and histograms
+  // sharing the directory do not collide.
+  static std::atomic<unsigned long> instances{0};
+  prefix_m = (std::filesystem::path(directory) / fileName(name)).string() + "." +
+             std::to_string(getpid()) + "." + std::to_string(instances++);
+}
+
+HistSpillRuns::~HistSpillRuns() {
+  for (const auto &runs : slotRuns_m) {
+    removeRuns(runs);
+  }
+}
+
+std::string HistSpillRuns::runPath(unsigned int slot, std::size_t run) const {
+  return prefix_m + ".slot" + std::to_string(slot) + ".run" + std::to_string(run);
+}
+
+void HistSpillRuns::write(unsigned int slot, std::vector<Cell> &cells) {
+  std::sort(cells.begin(), cells.end(),
+            [](const Cell &a, const Cell &b) { return a.index < b.index; });
+  auto &runs = slotRuns_m.at(slot);
+  const std::string path = runPath(slot, runs.size());
+  const std::size_t bytes = cells.size() * sizeof(Cell);
+  std::ofstream out(path, std::ios::binary | std::ios::trunc);
+  if (!out.write(reinterpret_cast<const char *>(cells.data()),
+                 static_cast<std::streamsize>(bytes)) ||
+      !out.flush()) {
+    out.close();
+    std::remove(path.c_str());
+    throw std::runtime_error("HistSpillRuns: cannot write run " + path);
+  }
+  runs.push_back(path);
+  slotBytes_m[slot] += bytes;
+}
+
+void HistSpillRuns::merge(const std::function<void(const Cell &)> &emit) {
+  std::vector<std::string> paths;
+  for (auto &runs : slotRuns_m) {
+    paths.insert(paths.end(), runs.begin(), runs.end());
+    runs.clear();
+  }
+  // Keep the open files under kMaxFanIn: merge the oldest runs into one
+  // until few enough are left.
+  for (std::size_t pass = 0; paths.size() > kMaxFanIn; ++pass) {
+    const std::vector<std::string> group(paths.begin(), paths.begin() + kMaxFanIn);
+    const std::string path = prefix_m + ".merge" + std::to_string(pass);
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    std::vector<Cell> buffer;
+    buffer.reserve(kReadCells);
+    const auto drain = [&out, &buffer, &path]() {
+      if (!out.write(reinterpret_cast<const char *>(buffer.data()),
+                     static_cast<std::streamsize>(buffer.size() * sizeof(Cell)))) {
+        throw std::runtime_error("HistSpillRuns: cannot write run " + path);
+      }
+      buffer.clear();
+    };
+    try {
+      mergeRuns(group, [&buffer, &drain](const Cell &cell) {
+        buffer.push_back(cell);
+        if (buffer.size() == kReadCells) {
+          drain();
+        }
+      });
+      drain();
+      if (!out.flush()) {
+        throw std::runtime_error("HistSpillRuns: cannot write run " + path);
+      }
+    } catch (...) {
+      out.close();
+      std::remove(path.c_str());
+      removeRuns(paths);
+      throw;
+    }
+    removeRuns(group);
+    paths.erase(paths.begin(), paths.begin() + kMaxFanIn);
+    paths.push_back(path);
+  }
+  try {
+    mergeRuns(paths, emit);
+  } catch (...) {
+    removeRuns(paths);
+    throw;
+  }
+  removeRuns(paths);
+}
+
+std::size_t HistSpillRuns::runs() const {
+  std::size_t total = 0;
+  for (const auto &runs : slotRuns_m) {
+    total += runs.size();
+  }
+  return total;
+}
+
+std::uint64_t HistSpillRuns::bytes() const {
+  std::uint64_t total = 0;
+  for (const auto bytes : slotBytes_m) {
+    total += bytes;
+  }
+  return total;
+}
@@ -0,0 +1,392 @@
+#include <HistogramPack.h>
+
+#include <TAxis.h>
+#include <TDirectory.h>
+#include <TFile.h>
+#include <TH1.h>
+#include <TH1F.h>
+#include <THnBase.h>
+#include <THnSparse.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <utility>
+
+namespace {
+
+constexpr char kMagic[8] = {'R', 'D', 'F', 'H', 'P', 'A', 'C', 'K'};
+constexpr std::uint32_t kVersion = 1;
+
+std::vector<double> axisEdges(const TAxis &axis) {
+  std::vector<double> edges;
+  edges.reserve(axis.GetNbins() + 1);
+  for (int b = 1; b <= axis.GetNbins(); ++b) {
+    edges.push_back(axis.GetBinLowEdge(b));
+  }
+  edges.push_back(axis.GetBinUpEdge(axis.GetNbins()));
+  return edges;
+}
+
+std::size_t padded(std::size_t bytes) { return (bytes + 7) / 8 * 8; }
+
+template <typename T> void put(std::ofstream &out, const T &value) {
+  out.write(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+template <typename T> void putArray(std::ofstream &out, const std::vector<T> &values) {
+  out.write(reinterpret_cast<const char *>(values.data()),
+            static_cast<std::streamsize>(values.size() * sizeof(T)));
+}
+
+template <typename T> T get(std::ifstream &in, const std::string &path) {
+  T value;
+  if (!in.read(reinterpret_cast<char *>(&value), sizeof(T))) {
+    throw std::runtime_error("HistogramPack: " + path + " is truncated");
+  }
+  return value;
+}
+
+template <typename T>
+void getArray(std::ifstream &in, std::vector<T> &values, std::size_t size,
+              const std::string &path) {
+  values.resize(size);
+  if (!in.read(reinterpret_cast<char *>(values.data()),
+               static_cast<std::streamsize>(size * sizeof(T)))) {
+    throw std::runtime_error("HistogramPack: " + path + " is truncated");
+  }
+}
+
+/// Split "dir/name" at the last '/'.
+std::pair<std::string, std::string> splitName(const std::string &name) {
+  const auto slash = name.rfind('/');
+  if (slash == std::string::npos) {
+    return {"", name};
+  }
+  return {name.substr(0, slash), name.substr(slash + 1)};
+}
+
+} // namespace
+
+std::uint32_t HistogramPack::schemaIndex(const Schema &schema) {
+  for (std::size_t i = 0; i < schemas_m.size(); ++i) {
+    if (schemas_m[i] == schema) {
+      return static_cast<std::uint32_t>(i);
+    }
+  }
+  schemas_m.push_back(schema);
+  return static_cast<std::uint32_t>(schemas_m.size() - 1);
+}
+
+void HistogramPack::append(Histogram hist) {
+  if (!index_m.emplace(hist.name, histograms_m.size()).second) {
+    throw std::runtime_error("HistogramPack: duplicate histogram '" + hist.name + "'");
+  }
+  histograms_m.push_back(std::move(hist));
+}
+
+void HistogramPack::add(const std::string &name, const TH1 &hist) {
+  Schema schema = {axisEdges(*hist.GetXaxis())};
+  if (hist.GetDimension() > 1) {
+    schema.push_back(axisEdges(*hist.GetYaxis()));
+  }
+  if (hist.GetDimension() > 2) {
+    schema.push_back(axisEdges(*hist.GetZaxis()));
+  }
+  Histogram packed;
+  packed.name = name;
+  packed.schema = schemaIndex(schema);
+  // TH1 global bin numbers already follow the pack's linear index.
+  for (Int_t bin = 0; bin < hist.GetNcells(); ++bin) {
+    const double content = hist.GetBinContent(bin);
+    const double error = hist.GetBinError(bin);
+    if (content == 0 && error == 0) {
+      continue;
+    }
+    packed.bins.push_back(static_cast<std::uint64_t>(bin));
+    packed.sums.push_back(content);
+    packed.sumw2.push_back(error * error);
+  }
+  append(std::move(packed));
+}
+
+void HistogramPack::add(const std::string &name, const THnBase &hist) {
+  const Int_t dim = hist.GetNdimensions();
+  Schema schema;
+  std::vector<std::uint64_t> strides(dim);
+  std::uint64_t stride = 1;
+  for (Int_t d = 0; d < dim; ++d) {
+    const TAxis *axis = hist.GetAxis(d);
+    schema.push_back(axisEdges(*axis));
+    strides[d] = stride;
+    stride *= static_cast<std::uint64_t>(axis->GetNbins() + 2);
+  }
+  // THnSparse bins are stored in fill order; collect, then sort.
+  std::vector<std::pair<std::uint64_t, std::pair<double, double>>> filled;
+  std::vector<Int_t> coords(dim);
+  std::unique_ptr<ROOT::Internal::THnBaseBinIter> iter(hist.CreateIter(false));
+  Long64_t bin;
+  while ((bin = iter->Next(coords.data())) >= 0) {
+    const double content = hist.GetBinContent(bin);
+    const double error2 = hist.GetBinError2(bin);
+    if (content == 0 && error2 == 0) {
+      continue;
+    }
+    std::uint64_t linear = 0;
+    for (Int_t d = 0; d < dim; ++d) {
+      linear += static_cast<std::uint64_t>(coords[d]) * strides[d];
+    }
+    filled.push_back({linear, {content, error2}});
+  }
+  std::sort(filled.begin(), filled.end());
+
+  Histogram packed;
+  packed.name = name;
+  packed.schema = schemaIndex(schema);
+  for (const auto &[linear, values] : filled) {
+    packed.bins.push_back(linear);
+    packed.sums.push_back(values.first);
+    packed.sumw2.push_back(values.second);
+  }
+  append(std::move(packed));
+}
+
+std::vector<HistogramPack::Histogram> HistogramPack::releaseHistograms() {
+  index_m.clear();
+  return std::move(histograms_m);
+}
+
+void HistogramPack::scale(double factor) {
+  if (factor == 1.0) {
+    return;
+  }
+  for (auto &hist : histograms_m) {
+    for (auto &sum : hist.sums) {
+      sum *= factor;
+    }
+    for (auto &sumw2 : hist.sumw2) {
+      sumw2 *= factor * factor;
+    }
+  }
+}
+
+void HistogramPack::merge(const HistogramPack &other) {
+  for (const auto &from : other.histograms_m) {
+    const Schema &schema = other.schemas_m[from.schema];
+    const auto it = index_m.find(from.name);
+    if (it == index_m.end()) {
+      Histogram copy = from;
+      copy.schema = schemaIndex(schema);
+      append(std::move(copy));
+      continue;
+    }
+    Histogram &into = histograms_m[it->second];
+    if (schemas_m[into.schema] != schema) {
+      throw std::runtime_error("HistogramPack: histogram '" + from.name +
+                               "' has different binnings in the merged packs");
+    }
+    // Both bin lists are sorted: a single pass adds them.
+    Histogram sum;
+    sum.name = into.name;
+    sum.schema = into.schema;
+    const std::size_t capacity = into.bins.size() + from.bins.size();
+    sum.bins.reserve(capacity);
+    sum.sums.reserve(capacity);
+    sum.sumw2.reserve(capacity);
+    std::size_t a = 0;
+    std::size_t b = 0;
+    while (a < into.bins.size() || b < from.bins.size()) {
+      if (b == from.bins.size() || (a < into.bins.size() && into.bins[a] < from.bins[b])) {
+        sum.bins.push_back(into.bins[a]);
+        sum.sums.push_back(into.sums[a]);
+        sum.sumw2.push_back(into.sumw2[a]);
+        ++a;
+      } else if (a == into.bins.size() || from.bins[b] < into.bins[a]) {
+        sum.bins.push_back(from.bins[b]);
+        sum.sums.push_back(from.sums[b]);
+        sum.sumw2.push_back(from.sumw2[b]);
+        ++b;
+      } else {
+        sum.bins.push_back(into.bins[a]);
+        sum.sums.push_back(into.sums[a] + from.sums[b]);
+        sum.sumw2.push_back(into.sumw2[a] + from.sumw2[b]);
+        ++a;
+        ++b;
+      }
+    }
+    into = std::move(sum);
+  }
+}
+
+void HistogramPack::write(const std::string &path) const {
+  std::ofstream out(path, std::ios::binary | std::ios::trunc);
+  if (!out) {
+    throw std::runtime_error("HistogramPack: cannot write " + path);
+  }
+  const std::uint32_t reserved = 0;
+  out.write(kMagic, sizeof(kMagic));
+  put(out, kVersion);
+  put(out, static_cast<std::uint32_t>(schemas_m.size()));
+  put(out, static_cast<std::uint64_t>(histograms_m.size()));
+  for (const auto &schema : schemas_m) {
+    put(out, static_cast<std::uint32_t>(schema.size()));
+    put(out, reserved);
+    for (const auto &edges : schema) {
+      put(out, static_cast<std::uint32_t>(edges.size() - 1));
+      put(out, reserved);
+      putArray(out, edges);
+    }
+  }
+  const char zeros[8] = {};
+  for (const auto &hist : histograms_m) {
+    put(out, hist.schema);
+    put(out, static_cast<std::uint32_t>(hist.name.size()));
+    put(out, static_cast<std::uint64_t>(hist.bins.size()));
+    out.write(hist.name.data(), static_cast<std::streamsize>(hist.name.size()));
+    out.write(zeros, static_cast<std::streamsize>(padded(hist.name.size()) - hist.name.size()));
+    putArray(out, hist.bins);
+    putArray(out, hist.sums);
+    putArray(out, hist.sumw2);
+  }
+  if (!out.flush()) {
+    throw std::runtime_error("HistogramPack: failed writing " + path);
+  }
+}
+
+HistogramPack HistogramPack::read(const std::string &path) {
+  std::ifstream in(path, std::ios::binary);
+  if (!in) {
+    throw std::runtime_error("HistogramPack: cannot open " + path);
+  }
+  char magic[sizeof(kMagic)];
+  if (!in.read(magic, sizeof(magic)) || std::memcmp(magic, kMagic, sizeof(kMagic)) != 0) {
+    throw std::runtime_error("HistogramPack: " + path + " is not a histogram pack");
+  }
+  const auto version = get<std::uint32_t>(in, path);
+  if (version != kVersion) {
+    throw std::runtime_error("HistogramPack: " + path + " has unsupported version " +
+                             std::to_string(version));
+  }
+  const auto schemaCount = get<std::uint32_t>(in, path);
+  const auto histogramCount = get<std::uint64_t>(in, path);
+
+  HistogramPack pack;
+  pack.schemas_m.resize(schemaCount);
+  for (auto &schema : pack.schemas_m) {
+    schema.resize(get<std::uint32_t>(in, path));
+    get<std::uint32_t>(in, path);
+    for (auto &edges : schema) {
+      const auto bins = get<std::uint32_t>(in, path);
+      get<std::uint32_t>(in, path);
+      getArray(in, edges, bins + 1, path);
+    }
+  }
+  pack.histograms_m.reserve(histogramCount);
+  for (std::uint64_t i = 0; i < histogramCount; ++i) {
+    Histogram hist;
+    hist.schema = get<std::uint32_t>(in, path);
+    const auto nameLength = get<std::uint32_t>(in, path);
+    const auto entries = get<std::uint64_t>(in, path);
+    if (hist.schema >= schemaCount) {
+      throw std::runtime_error("HistogramPack: " + path + " refers to a missing axis schema");
+    }
+    std::vector<char> name;
+    getArray(in, name, padded(nameLength), path);
+    hist.name.assign(name.data(), nameLength);
+    getArray(in, hist.bins, entries, path);
+    getArray(in, hist.sums, entries, path);
+    getArray(in, hist.sumw2, entries, path);
+    pack.append(std::move(hist));
+  }
+  return pack;
+}
+
+void HistogramPack::mergeFiles(const std::string &output,
+                               const std::vector<std::string> &inputs) {
+  if (inputs.empty()) {
+    throw std::runtime_error("HistogramPack: no inputs to merge");
+  }
+  HistogramPack merged = read(inputs.front());
+  for (std::size_t i = 1; i < inputs.size(); ++i) {
+    merged.merge(read(inputs[i]));
+  }
+  const std::string rootSuffix = ".root";
+  if (output.size() >= rootSuffix.size() &&
+      output.compare(output.size() - rootSuffix.size(), rootSuffix.size(), rootSuffix) == 0) {
+    merged.writeRoot(output);
+  } else {
+    merged.write(output);
+  }
+}
+
+std::unique_ptr<TH1> HistogramPack::toTH1(const Histogram &hist) const {
+  const Schema &schema = schemas_m.at(hist.schema);
+  if (schema.size() != 1) {
+    throw std::runtime_error("HistogramPack: histogram '" + hist.name + "' has " +
+                             std::to_string(schema.size()) + " axes, not 1");
+  }
+  const std::string name = splitName(hist.name).second;
+  const auto &edges = schema.front();
+  auto th1 = std::make_unique<TH1F>(name.c_str(), name.c_str(),
+                                    static_cast<Int_t>(edges.size() - 1), edges.data());
+  th1->SetDirectory(nullptr);
+  for (std::size_t i = 0; i < hist.bins.size(); ++i) {
+    const auto bin = static_cast<Int_t>(hist.bins[i]);
+    th1->SetBinContent(bin, hist.sums[i]);
+    th1->SetBinError(bin, std::sqrt(hist.sumw2[i]));
+  }
+  return th1;
+}
+
+std::unique_ptr<THnSparse> HistogramPack::toTHnSparse(const Histogram &hist) const {
+  const Schema &schema = schemas_m.at(hist.schema);
+  const auto dim = static_cast<Int_t>(schema.size());
+  std::vector<Int_t> nbins(dim);
+  std::vector<Double_t> lower(dim);
+  std::vector<Double_t> upper(dim);
+  for (Int_t d = 0; d < dim; ++d) {
+    nbins[d] = static_cast<Int_t>(schema[d].size() - 1);
+    lower[d] = schema[d].front();
+    upper[d] = schema[d].back();
+  }
+  const std::string name = splitName(hist.name).second;
+  auto sparse = std::make_unique<THnSparseD>(name.c_str(), name.c_str(), dim, nbins.data(),
+                                             lower.data(), upper.data());
+  for (Int_t d = 0; d < dim; ++d) {
+    sparse->SetBinEdges(d, schema[d].data());
+  }
+  sparse->Sumw2();
+  std::vector<Int_t> coords(dim);
+  for (std::size_t i = 0; i < hist.bins.size(); ++i) {
+    std::uint64_t linear = hist.bins[i];
+    for (Int_t d = 0; d < dim; ++d) {
+      const auto extent = static_cast<std::uint64_t>(nbins[d] + 2);
+      coords[d] = static_cast<Int_t>(linear % extent);
+      linear /= extent;
+    }
+    const Long64_t bin = sparse->GetBin(coords.data(), kTRUE);
+    sparse->SetBinContent(bin, hist.sums[i]);
+    sparse->SetBinError2(bin, hist.sumw2[i]);
+  }
+  return sparse;
+}
+
+void HistogramPack::writeRoot(const std::string &path) const {
+  TDirectory::TContext context(nullptr);
+  TFile file(path.c_str(), "RECREATE");
+  if (file.IsZombie()) {
+    throw std::runtime_error("HistogramPack: cannot write " + path);
+  }
+  for (const auto &hist : histograms_m) {
+    const auto [dirName, name] = splitName(hist.name);
+    TDirectory *dir = dirName.empty() ? &file : file.mkdir(dirName.c_str(), "", true);
+    if (schemas_m[hist.schema].size() == 1) {
+      dir->WriteTObject(toTH1(hist).get(), name.c_str());
+    } else {
+      dir->WriteTObject(toTHnSparse(hist).get(), name.c_str());
+    }
+  }
+  file.Close();
+}
@@ -0,0 +1,244 @@
+#include <InputStagingCache.h>
+#include <AsyncLogger.h>
+#include <SlowSiteMonitor.h>
+
+#include <TFile.h>
+#include <TMD5.h>
+
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <filesystem>
+#include <iostream>
+#include <stdexcept>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr const char *kEntryExtension = ".root";
+
+/// Whether @p fd still refers to the file at @p path.
+bool sameFile(int fd, const std::string &path) {
+  struct stat opened {};
+  struct stat current {};
+  return ::fstat(fd, &opened) == 0 && ::stat(path.c_str(), &current) == 0 &&
+         opened.st_dev == current.st_dev && opened.st_ino == current.st_ino;
+}
+
+/// Exclusive flock() held for the lifetime of the object.
+class FileLock {
+public:
+  explicit FileLock(const std::string &path) {
+    while (true) {
+      fd_m = ::open(path.c_str(), O_RDWR | O_CREAT, 0664);
+      if (fd_m < 0) {
+        throw std::runtime_error("InputStagingCache: cannot open lock file '" +
+                                 path + "'");
+      }
+      while (::flock(fd_m, LOCK_EX) != 0) {
+        if (errno != EINTR) {
+          ::close(fd_m);
+          throw std::runtime_error("InputStagingCache: cannot lock '" + path + "'");
+        }
+      }
+      // Eviction removes lock files; retry when ours was removed while we
+      // waited for it.
+      if (sameFile(fd_m, path)) {
+        return;
+      }
+      ::close(fd_m);
+    }
+  }
+  ~FileLock() {
+    ::flock(fd_m, LOCK_UN);
+    ::close(fd_m);
+  }
+  FileLock(const FileLock &) = delete;
+  FileLock &operator=(const FileLock &) = delete;
+
+private:
+  int fd_m;
+};
+
+bool isCacheEntry(const fs::directory_entry &entry) {
+  return entry.is_regular_file() && entry.path().extension() == kEntryExtension;
+}
+
+} // namespace
+
+InputStagingCache::InputStagingCache(std::string directory, Long64_t maxBytes)
+    : directory_m(std::move(directory)), maxBytes_m(maxBytes) {
+  if (directory_m.empty()) {
+    throw std::runtime_error("InputStagingCache: cache directory must not be empty");
+  }
+  if (maxBytes_m <= 0) {
+    throw std::runtime_error("InputStagingCache: size limit must be positive");
+  }
+  std::error_code ec;
+  fs::create_directories(directory_m, ec);
+  if (ec) {
+    throw std::runtime_error("InputStagingCache: cannot create '" + directory_m +
+                             "': " + ec.message());
+  }
+}
+
+bool InputStagingCache::isRemote(const std::string &url) {
+  const auto scheme = url.find("://");
+  return scheme != std::string::npos && url.compare(0, scheme, "file") != 0;
+}
+
+std::string InputStagingCache::cacheKey(const std::string &url) {
+  const std::string lfn = SlowSiteMonitor::logicalFileName(url);
+  TMD5 md5;
+  md5.Update(reinterpret_cast<const UChar_t *>(lfn.data()),
+             static_cast<UInt_t>(lfn.size()));
+  md5.Final();
+  return md5.AsString();
+}
+
+InputStagingCache::~InputStagingCache() {
+  for (const auto &pin : pins_m) {
+    ::close(pin.second);
+  }
+}
+
+std::string InputStagingCache::entryPath(const std::string &url) const {
+  return directory_m + "/" + cacheKey(url) + kEntryExtension;
+}
+
+std::string InputStagingCache::stage(const std::string &url) {
+  const std::string key = cacheKey(url);
+  const std::string entry = directory_m + "/" + key + kEntryExtension;
+  FileLock entryLock(directory_m + "/" + key + ".lock");
+
+  std::error_code ec;
+  if (fs::exists(entry, ec)) {
+    // Refresh the LRU position; a failure only affects eviction order.
+    fs::last_write_time(entry, fs::file_time_type::clock::now(), ec);
+    pin(entry);
+    ++hits_m;
+    return entry;
+  }
+
+  const std::string partial =
+      directory_m + "/" + key + ".part." + std::to_string(::getpid());
+  if (!copyFile(url, partial)) {
+    fs::remove(partial, ec);
+    RDF_LOG_WARN << "Warning: InputStagingCache: could not stage " << url
+                 << "; reading it remotely";
+    return url;
+  }
+  const auto size = static_cast<Long64_t>(fs::file_size(partial, ec));
+  if (ec || size > maxBytes_m) {
+    fs::remove(partial, ec);
+    RDF_LOG_WARN << "Warning: InputStagingCache: " << url
+                 << " exceeds the cache size limit; reading it remotely";
+    return url;
+  }
+
+  {
+    FileLock cacheLock(directory_m + "/.cache.lock");
+    if (!evictFor(size, entry)) {
+      fs::remove(partial, ec);
+      RDF_LOG_WARN << "Warning: InputStagingCache: no room left by the entries in use for "
+                   << url << "; reading it remotely";
+      return url;
+    }
+    fs::rename(partial, entry);
+  }
+  pin(entry);
+  ++misses_m;
+  return entry;
+}
+
+Long64_t InputStagingCache::cachedBytes() const {
+  Long64_t total = 0;
+  std::error_code ec;
+  for (const auto &entry : fs::directory_iterator(directory_m, ec)) {
+    if (isCacheEntry(entry)) {
+      total += static_cast<Long64_t>(entry.file_size(ec));
+    }
+  }
+  return total;
+}
+
+bool InputStagingCache::copyFile(const std::string &source,
+                                 const std::string &destination) {
+  return TFile::Cp(source.c_str(), destination.c_str(), kFALSE);
+}
+
+void InputStagingCache::pin(const std::string &entry) {
+  if (pins_m.count(entry) != 0) {
+    return;
+  }
+  const int fd = ::open(entry.c_str(), O_RDONLY);
+  if (fd < 0) {
+    throw std::runtime_error("InputStagingCache: cannot open '" + entry + "'");
+  }
+  while (::flock(fd, LOCK_SH) != 0) {
+    if (errno != EINTR) {
+      ::close(fd);
+      throw std::runtime_error("InputStagingCache: cannot pin '" + entry + "'");
+    }
+  }
+  pins_m.emplace(entry, fd);
+}
+
+bool InputStagingCache::evictFor(Long64_t incomingBytes, const std::string &keep) {
+  struct Entry {
+    fs::file_time_type lastUse;
+    Long64_t size;
+    fs::path path;
+  };
+  std::vector<Entry> entries;
+  Long64_t total = 0;
+  std::error_code ec;
+  for (const auto &entry : fs::directory_iterator(directory_m, ec)) {
+    if (!isCacheEntry(entry) || entry.path() == keep) {
+      continue;
+    }
+    const auto size = static_cast<Long64_t>(entry.file_size(ec));
+    entries.push_back({entry.last_write_time(ec), size, entry.path()});
+    total += size;
+  }
+
+  std::sort(entries.begin(), entries.end(),
+            [](const Entry &a, const Entry &b) { return a.lastUse < b.lastUse; });
+  for (const auto &entry : entries) {
+    if (total + incomingBytes <= maxBytes_m) {
+      break;
+    }
+    // Skip entries being staged (key lock held) or pinned by a job (shared
+    // lock on the entry); both are only tried, never waited for.
+    fs::path lockPath = entry.path;
+    lockPath.replace_extension(".lock");
+    const int keyFd = ::open(lockPath.c_str(), O_RDWR | O_CREAT, 0664);
+    if (keyFd < 0) {
+      continue;
+    }
+    if (::flock(keyFd, LOCK_EX | LOCK_NB) != 0) {
+      ::close(keyFd);
+      continue;
+    }
+    const int entryFd = ::open(entry.path.c_str(), O_RDONLY);
+    if (entryFd >= 0 && ::flock(entryFd, LOCK_EX | LOCK_NB) == 0) {
+      if (fs::remove(entry.path, ec)) {
+        total -= entry.size;
+      }
+      fs::remove(lockPath, ec);
+    }
+    if (entryFd >= 0) {
+      ::close(entryFd);
+    }
+    ::close(keyFd);
+  }
+  return total + incomingBytes <= maxBytes_m;
+}
@@ -0,0 +1,488 @@
+#include <JitCache.h>
+#include <AsyncLogger.h>
+#include <RVersion.h>
+#include <TInterpreter.h>
+#include <TMD5.h>
+#include <TSystem.h>
+
+#include <algorithm>
+#include <cctype>
+#include <dlfcn.h>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <unistd.h>
+
+namespace {
+
+std::string md5(const std::string &data) {
+  TMD5 digest;
+  digest.Update(reinterpret_cast<const UChar_t *>(data.data()),
+                static_cast<UInt_t>(data.size()));
+  digest.Final();
+  return digest.AsString();
+}
+
+bool isIdentifierStart(char c) {
+  return std::isalpha(static_cast<unsigned char>(c)) || c == '_';
+}
+
+bool isIdentifierChar(char c) {
+  return std::isalnum(static_cast<unsigned char>(c)) || c == '_';
+}
+
+bool isIdentifier(const std::string &name) {
+  return !name.empty() && isIdentifierStart(name.front()) &&
+         std::all_of(name.begin(), name.end(), isIdentifierChar);
+}
+
+/// Whether @p expression contains the token ``return`` (``\breturn\b``),
+/// not just as part of an identifier such as ``returnValue``.
+bool hasReturnToken(const std::string &expression) {
+  const std::string token = "return";
+  for (auto pos = expression.find(token); pos != std::string::npos;
+       pos = expression.find(token, pos + 1)) {
+    const std::size_t end = pos + token.size();
+    if ((pos == 0 || !isIdentifierChar(expression[pos - 1])) &&
+        (end == expression.size() || !isIdentifierChar(expression[end]))) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/// Name of the library entry point of expression @p key.
+std::string symbolName(const std::string &key) { return "rdfjit_" + key; }
+
+/// Escape @p text for a C++ string literal.
+std::string quoted(const std::string &text) {
+  std::string out = "\"";
+  for (const char c : text) {
+    if (c == '"' || c == '\\') {
+      out += '\\';
+    }
+    out += c;
+  }
+  return out + '"';
+}
+
+/// Write the statement defining @p expr on ``*df`` under ``*name``.
+void writeDefine(std::ostream &out, const JitCache::Expression &expr) {
+  out << "  *df = df->Define(*name, [](";
+  for (std::size_t i = 0; i < expr.columns.size(); ++i) {
+    out << (i ? ", " : "") << "const " << expr.types[i] << " &" << expr.columns[i];
+  }
+  // Like RDataFrame, an expression containing "return" is a function body.
+  const bool body = hasReturnToken(expr.expression);
+  out << ") {\n    " << (body ? "" : "return ") << expr.expression << (body ? "\n" : ";\n")
+      << "  }, {";
+  for (std::size_t i = 0; i < expr.columns.size(); ++i) {
+    out << (i ? ", " : "") << quoted(expr.columns[i]);
+  }
+  out << "});\n";
+}
+
+const char *kSourceHeader = "#include <ROOT/RDataFrame.hxx>\n"
+                            "#include <ROOT/RVec.hxx>\n"
+                            "#include <Math/Vector4D.h>\n"
+                            "#include <TMath.h>\n"
+                            "#include <cmath>\n"
+                            "#include <string>\n";
+
+/// Entry points registered by compiled-in translation units.
+std::map<std::string, JitCache::DefineFn> &compiledRegistry() {
+  static std::map<std::string, JitCache::DefineFn> registry;
+  return registry;
+}
+
+/// Functions registered by compiled-in translation units.
+std::map<std::string, void *> &compiledFunctions() {
+  static std::map<std::string, void *> registry;
+  return registry;
+}
+
+/// Functions declared to the JIT compiler by this process, by key; Cling
+/// rejects a second definition of the same symbol.
+std::map<std::string, void *> &declaredFunctions() {
+  static std::map<std::string, void *> registry;
+  return registry;
+}
+
+std::mutex &functionMutex() {
+  static std::mutex mutex;
+  return mutex;
+}
+
+/// Compiled-in or already declared address of function @p key, or nullptr.
+void *knownFunction(const std::string &key) {
+  std::lock_guard<std::mutex> lock(functionMutex());
+  for (const auto *registry : {&compiledFunctions(), &declaredFunctions()}) {
+    const auto it = registry->find(key);
+    if (it != registry->end()) {
+      return it->second;
+    }
+  }
+  return nullptr;
+}
+
+/// Declare @p function to the JIT compiler (once per process).
+void *declare(const JitCache::Function &function) {
+  std::lock_guard<std::mutex> lock(functionMutex());
+  void *&address = declaredFunctions()[function.key];
+  if (!address) {
+    if (!gInterpreter->Declare(function.source.c_str())) {
+      declaredFunctions().erase(function.key);
+      return nullptr;
+    }
+    address = reinterpret_cast<void *>(
+        gInterpreter->Calc(("reinterpret_cast<long>(&" + symbolName(function.key) + ")").c_str()));
+  }
+  return address;
+}
+
+/// Replace every occurrence of JitCache::kFunctionName in @p source by @p symbol.
+std::string renamed(const std::string &source, const std::string &symbol) {
+  const std::string placeholder = JitCache::kFunctionName;
+  std::string out;
+  std::size_t begin = 0;
+  for (std::size_t at = source.find(placeholder); at != std::string::npos;
+       at = source.find(placeholder, begin)) {
+    out.append(source, begin, at - begin);
+    out += symbol;
+    begin = at + placeholder.size();
+  }
+  return out.append(source, begin, std::string::npos);
+}
+
+} // namespace
+
+JitCache::JitCache(std::string directory, bool build)
+    : directory_m(std::move(directory)), build_m(build) {
+  if (directory_m.empty()) {
+    build_m = false;
+    return;
+  }
+  if (build_m) {
+    std::filesystem::create_directories(directory_m);
+  }
+  const std::filesystem::path indexPath = std::filesystem::path(directory_m) / kIndexFile;
+  if (!std::filesystem::exists(indexPath)) {
+    return;
+  }
+  std::ifstream index(indexPath);
+  if (!index) {
+    throw std::runtime_error("JitCache: cannot read '" + indexPath.string() + "'");
+  }
+  std::string key;
+  std::string library;
+  while (index >> key >> library) {
+    index_m[key] = library;
+  }
+}
+
+std::vector<std::string>
+JitCache::inputColumns(const std::string &expression,
+                       const std::vector<std::string> &available) {
+  const std::set<std::string> columns(available.begin(), available.end());
+  std::vector<std::string> used;
+  std::size_t i = 0;
+  while (i < expression.size()) {
+    const char c = expression[i];
+    if (c == '"' || c == '\'') {
+      // Skip the literal, honouring escapes.
+      for (++i; i < expression.size() && expression[i] != c; ++i) {
+        if (expression[i] == '\\') {
+          ++i;
+        }
+      }
+      ++i;
+      continue;
+    }
+    if (!isIdentifierStart(c)) {
+      ++i;
+      continue;
+    }
+    const std::size_t begin = i;
+    while (i < expression.size() && isIdentifierChar(expression[i])) {
+      ++i;
+    }
+    const std::string token = expression.substr(begin, i - begin);
+    const bool member =
+        (begin >= 1 && expression[begin - 1] == '.') ||
+        (begin >= 2 && (expression.compare(begin - 2, 2, "->") == 0 ||
+                        expression.compare(begin - 2, 2, "::") == 0));
+    if (!member && columns.count(token) &&
+        std::find(used.begin(), used.end(), token) == used.end()) {
+      used.push_back(token);
+    }
+  }
+  return used;
+}
+
+JitCache::Expression JitCache::describe(ROOT::RDF::RNode &df, const std::string &expression) {
+  Expression result;
+  result.expression = expression;
+  auto available = df.GetColumnNames();
+  // The implicit columns are not listed but can be read like any other.
+  available.push_back("rdfentry_");
+  available.push_back("rdfslot_");
+  // Columns such as friend branches ("tree.x") are rewritten by RDataFrame
+  // before compilation; leave those expressions to the JIT compiler.
+  for (const auto &column : available) {
+    if (!isIdentifier(column) && expression.find(column) != std::string::npos) {
+      return result;
+    }
+  }
+  result.columns = inputColumns(expression, available);
+  std::string content = std::string(ROOT_RELEASE) + '\n' + expression + '\n';
+  for (const auto &column : result.columns) {
+    result.types.push_back(df.GetColumnType(column));
+    content += column + ':' + result.types.back() + '\n';
+  }
+  result.key = md5(content);
+  return result;
+}
+
+JitCache::Function JitCache::describeFunction(const std::string &source) {
+  Function function;
+  function.key = md5(std::string(ROOT_RELEASE) + '\n' + source);
+  function.source = renamed(source, symbolName(function.key));
+  return function;
+}
+
+std::string JitCache::generateSource(const std::vector<Expression> &expressions,
+                                     const std::vector<Function> &functions) {
+  std::ostringstream out;
+  out << "// Generated by JitCache; do not edit.\n"
+      << kSourceHeader << "\nusing namespace ROOT::VecOps;\n";
+  for (const auto &expr : expressions) {
+    out << "\nextern \"C\" void " << symbolName(expr.key)
+        << "(ROOT::RDF::RNode *df, const std::string *name) {\n";
+    writeDefine(out, expr);
+    out << "}\n";
+  }
+  for (const auto &function : functions) {
+    out << '\n' << function.source << '\n';
+  }
+  return out.str();
+}
+
+std::string JitCache::generateTranslationUnit(const std::vector<Expression> &expressions,
+                                              const std::vector<Function> &functions) {
+  std::ostringstream out;
+  out << "// Generated by JitCache (jitExportFile) for ROOT " << ROOT_RELEASE
+      << "; do not edit.\n"
+      << "#include <JitCache.h>\n"
+      << kSourceHeader << "\nusing namespace ROOT::VecOps;\n\nnamespace {\n";
+  for (const auto &expr : expressions) {
+    out << "\nvoid " << symbolName(expr.key)
+        << "(ROOT::RDF::RNode *df, const std::string *name) {\n";
+    writeDefine(out, expr);
+    out << "}\n";
+  }
+  out << "\n} // namespace\n";
+  for (const auto &function : functions) {
+    out << '\n' << function.source << '\n';
+  }
+  out << "\nnamespace {\n\nconst bool registered = [] {\n";
+  for (const auto &expr : expressions) {
+    out << "  JitCache::registerCompiled(" << quoted(expr.key) << ", &"
+        << symbolName(expr.key) << ");\n";
+  }
+  for (const auto &function : functions) {
+    out << "  JitCache::registerCompiled(" << quoted(function.key)
+        << ", reinterpret_cast<void *>(&" << symbolName(function.key) << "));\n";
+  }
+  out << "  return true;\n}();\n\n} // namespace\n";
+  return out.str();
+}
+
+std::size_t JitCache::exportTranslationUnit(const std::string &path) const {
+  std::ofstream out(path);
+  if (!out) {
+    throw std::runtime_error("JitCache: cannot write '" + path + "'");
+  }
+  out << generateTranslationUnit(defined_m, definedFunctions_m);
+  return defined_m.size() + definedFunctions_m.size();
+}
+
+void JitCache::registerCompiled(const std::string &key, DefineFn fn) {
+  compiledRegistry()[key] = fn;
+}
+
+void JitCache::registerCompiled(const std::string &key, void *function) {
+  std::lock_guard<std::mutex> lock(functionMutex());
+  compiledFunctions()[key] = function;
+}
+
+std::size_t JitCache::compiledCount() {
+  std::lock_guard<std::mutex> lock(functionMutex());
+  return compiledRegistry().size() + compiledFunctions().size();
+}
+
+JitCache::DefineFn JitCache::lookup(const std::string &key) {
+  const auto compiled = compiledRegistry().find(key);
+  if (compiled != compiledRegistry().end()) {
+    return compiled->second;
+  }
+  return reinterpret_cast<DefineFn>(lookupLibrary(key, symbolName(key)));
+}
+
+void *JitCache::lookupLibrary(const std::string &key, const std::string &symbol) {
+  const auto entry = index_m.find(key);
+  if (entry == index_m.end()) {
+    return nullptr;
+  }
+  void *&handle = libraries_m[entry->second];
+  if (!handle) {
+    const std::string path = (std::filesystem::path(directory_m) / entry->second).string();
+    handle = dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+    if (!handle) {
+      RDF_LOG_WARN << "JitCache: cannot load '" << path << "': " << dlerror();
+      index_m.erase(entry);
+      return nullptr;
+    }
+  }
+  return dlsym(handle, symbol.c_str());
+}
+
+void *JitCache::declareFunction(const std::string &source) {
+  const Function function = describeFunction(source);
+  if (void *address = knownFunction(function.key)) {
+    return address;
+  }
+  return declare(function);
+}
+
+void *JitCache::function(const std::string &source) {
+  const Function function = describeFunction(source);
+  if (definedFunctionKeys_m.insert(function.key).second) {
+    definedFunctions_m.push_back(function);
+  }
+  void *address = knownFunction(function.key);
+  if (!address) {
+    address = lookupLibrary(function.key, symbolName(function.key));
+  }
+  if (address) {
+    ++hits_m;
+    return address;
+  }
+  if (missedFunctionKeys_m.insert(function.key).second) {
+    missedFunctions_m.push_back(function);
+  }
+  return declare(function);
+}
+
+ROOT::RDF::RNode JitCache::define(ROOT::RDF::RNode df, const std::string &name,
+                                  const std::string &expression) {
+  const Expression expr = describe(df, expression);
+  if (!expr.key.empty()) {
+    if (definedKeys_m.insert(expr.key).second) {
+      defined_m.push_back(expr);
+    }
+    if (DefineFn fn = lookup(expr.key)) {
+      fn(&df, &name);
+      ++hits_m;
+      return df;
+    }
+    if (missedKeys_m.insert(expr.key).second) {
+      missed_m.push_back(expr);
+    }
+  }
+  return df.Define(name, expression);
+}
+
+bool JitCache::compile(const std::vector<Expression> &expressions,
+                       const std::vector<Function> &functions) {
+  std::string keys;
+  for (const auto &expr : expressions) {
+    keys += expr.key;
+  }
+  for (const auto &function : functions) {
+    keys += function.key;
+  }
+  const std::string stem = "rdfjit_" + md5(keys);
+  const std::filesystem::path directory(directory_m);
+  const std::filesystem::path source = directory / (stem + ".cxx");
+  {
+    std::ofstream out(source);
+    if (!out) {
+      throw std::runtime_error("JitCache: cannot write '" + source.string() + "'");
+    }
+    out << generateSource(expressions, functions);
+  }
+  // ACLiC: keep the library, optimise, force the build and do not load it.
+  const std::string library = stem + "." + gSystem->GetSoExt();
+  if (!gSystem->CompileMacro(source.c_str(), "kOfc", (directory / stem).c_str(),
+                             directory_m.c_str())) {
+    return false;
+  }
+
+  // Register the library only once it is complete, so that concurrent
+  // readers never see a key without its library.
+  const std::filesystem::path indexPath = directory / kIndexFile;
+  const std::string tmpPath = indexPath.string() + ".tmp." + std::to_string(getpid());
+  {
+    std::ofstream index(tmpPath);
+    if (!index) {
+      throw std::runtime_error("JitCache: cannot write '" + tmpPath + "'");
+    }
+    for (const auto &expr : expressions) {
+      index_m[expr.key] = library;
+    }
+    for (const auto &function : functions) {
+      index_m[function.key] = library;
+    }
+    for (const auto &[key, file] : index_m) {
+      index << key << ' ' << file << '\n';
+    }
+  }
+  std::filesystem::rename(tmpPath, indexPath);
+  return true;
+}
+
+std::size_t JitCache::build() {
+  if (!build_m) {
+    throw std::runtime_error("JitCache: cache '" + directory_m +
+                             "' was not opened for building (set jitCacheBuild=true).");
+  }
+  std::vector<Expression> pending;
+  for (const auto &expr : missed_m) {
+    if (!index_m.count(expr.key)) {
+      pending.push_back(expr);
+    }
+  }
+  std::vector<Function> pendingFunctions;
+  for (const auto &function : missedFunctions_m) {
+    if (!index_m.count(function.key)) {
+      pendingFunctions.push_back(function);
+    }
+  }
+  if (pending.empty() && pendingFunctions.empty()) {
+    return 0;
+  }
+  std::size_t added = 0;
+  if (compile(pending, pendingFunctions)) {
+    added = pending.size() + pendingFunctions.size();
+  } else {
+    for (const auto &expr : pending) {
+      if (compile({expr}, {})) {
+        ++added;
+      } else {
+        RDF_LOG_WARN << "JitCache: expression is left to the JIT compiler: "
+                     << expr.expression;
+      }
+    }
+    for (const auto &function : pendingFunctions) {
+      if (compile({}, {function})) {
+        ++added;
+      } else {
+        RDF_LOG_WARN << "JitCache: function " << function.key << " is left to the JIT compiler";
+      }
+    }
+  }
+  return added;
+}
@@ -1,7 +1,12 @@
 #include <ManagerFactory.h>
+#include <ArrowOutputSink.h>
 #include <ConfigurationManager.h>
 #include <DataManager.h>
+#include <MpiRuntime.h>
+#include <RNTupleOutputSink.h>
+#include <RootOutputSink.h>
 #include <SystematicManager.h>
+#include <stdexcept>
 
 std::unique_ptr<IConfigurationProvider> ManagerFactory::createConfigurationManager(
     const std::string& configFile) {
@@ -14,5 +19,26 @@ std::unique_ptr<ISystematicManager> ManagerFactory::createSystematicManager() {
 
 std::unique_ptr<IDataFrameProvider> ManagerFactory::createDataManager(
     IConfigurationProvider& configProvider) {
+    // An MPI rank reads its slice of the input and writes to its own files.
+    MpiRuntime::configure(configProvider);
     return std::make_unique<DataManager>(configProvider);
-} 
\ No newline at end of file
+} 
+
+std::unique_ptr<IOutputSink> ManagerFactory::createOutputSink(
+    const IConfigurationProvider& configProvider, OutputChannel channel) {
+    const std::string key =
+        channel == OutputChannel::Meta ? "metaOutputFormat" : "skimOutputFormat";
+    const std::string format = configProvider.get(key);
+    if (format.empty() || format == "root") {
+        return std::make_unique<RootOutputSink>(
+            RootOutputSink::snapshotSettingsFromConfig(configProvider, channel));
+    }
+    if (format == "rntuple") {
+        return RNTupleOutputSink::fromConfig(configProvider);
+    }
+    if (format == "parquet" || format == "arrow" || format == "training") {
+        return ArrowOutputSink::fromConfig(configProvider, format);
+    }
+    throw std::runtime_error("ManagerFactory: invalid " + key + " '" + format +
+                             "'. Valid values are 'root', 'rntuple', 'parquet', 'arrow' or 'training'.");
+}
@@ -0,0 +1,346 @@
+#include <MetricsService.h>
+#include <JsonString.h>
+#include <api/IConfigurationProvider.h>
+#include <api/IDataFrameProvider.h>
+#include <api/ILogger.h>
+#include <ROOT/RDF/RActionImpl.hxx>
+#include <TFile.h>
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+#include <unistd.h>
+
+namespace {
+
+std::int64_t steadyNs() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+double unixSeconds() {
+  return std::chrono::duration<double>(
+             std::chrono::system_clock::now().time_since_epoch())
+      .count();
+}
+
+/**
+ * @brief Counts the entries of every slot and records the input file it
+ *        reads, for the metrics writer thread.
+ */
+class MetricsAction : public ROOT::Detail::RDF::RActionImpl<MetricsAction> {
+public:
+  using Result_t = ULong64_t;
+
+  explicit MetricsAction(std::shared_ptr<MetricsService::Progress> progress)
+      : progress_m(std::move(progress)), result_m(std::make_shared<Result_t>(0)) {}
+
+  MetricsAction(MetricsAction &&) = default;
+  MetricsAction(const MetricsAction &) = delete;
+
+  std::shared_ptr<Result_t> GetResultPtr() const { return result_m; }
+
+  void Initialize() { progress_m->startNs.store(steadyNs()); }
+  void InitTask(TTreeReader *, unsigned int) {}
+
+  void Exec(unsigned int slot, ULong64_t) {
+    auto &entries = progress_m->slots[slot].entries;
+    entries.store(entries.load(std::memory_order_relaxed) + 1,
+                  std::memory_order_relaxed);
+  }
+
+  ROOT::RDF::SampleCallback_t GetSampleCallback() {
+    auto progress = progress_m;
+    return [progress](unsigned int slot, const ROOT::RDF::RSampleInfo &info) {
+      std::lock_guard<std::mutex> lock(progress->filesMutex);
+      progress->files[slot] = info.AsString();
+    };
+  }
+
+  void Finalize() {
+    *result_m = 0;
+    for (const auto &slot : progress_m->slots) {
+      *result_m += slot.entries.load();
+    }
+    progress_m->endNs.store(steadyNs());
+  }
+
+  std::string GetActionName() const { return "MetricsMonitor"; }
+
+private:
+  std::shared_ptr<MetricsService::Progress> progress_m;
+  std::shared_ptr<Result_t> result_m;
+};
+
+/// Label value in the Prometheus text format.
+std::string promLabel(const std::string &value) {
+  std::string out;
+  for (const char c : value) {
+    if (c == '\\' || c == '"') {
+      out += '\\';
+      out += c;
+    } else if (c == '\n') {
+      out += "\\n";
+    } else {
+      out += c;
+    }
+  }
+  return out;
+}
+
+const char *stateName(MetricsService::State state) {
+  switch (state) {
+  case MetricsService::State::Setup:
+    return "setup";
+  case MetricsService::State::Running:
+    return "running";
+  case MetricsService::State::Finished:
+    return "finished";
+  }
+  return "setup";
+}
+
+} // namespace
+
+MetricsService::~MetricsService() { stopWriter(); }
+
+void MetricsService::initialize(ManagerContext &ctx) {
+  ctx_m = &ctx;
+  path_m = ctx.config.get("metricsFile");
+  if (path_m.empty()) {
+    throw std::runtime_error("MetricsService: metricsFile is not set");
+  }
+  const std::string format = ctx.config.get("metricsFormat");
+  if (format == "prometheus") {
+    prometheus_m = true;
+  } else if (!format.empty() && format != "json") {
+    throw std::runtime_error("MetricsService: metricsFormat '" + format +
+                             "' is not json or prometheus");
+  }
+  const std::string interval = ctx.config.get("metricsInterval");
+  if (!interval.empty()) {
+    std::size_t end = 0;
+    double seconds = 0.0;
+    try {
+      seconds = std::stod(interval, &end);
+    } catch (const std::exception &) {
+      end = 0;
+    }
+    if (end != interval.size() || !(seconds > 0.0)) {
+      throw std::runtime_error("MetricsService: invalid metricsInterval '" +
+                               interval + "'");
+    }
+    interval_m = std::chrono::milliseconds(
+        std::max<long long>(1, static_cast<long long>(seconds * 1000.0)));
+  }
+
+  // Booked before any filter, so that every entry of the loop is counted.
+  auto df = ctx.data.getDataFrame();
+  progress_m = std::make_shared<Progress>(df.GetNSlots());
+  result_m = df.Book<ULong64_t>(MetricsAction(progress_m), {"rdfentry_"});
+
+  previousTime_m = std::chrono::steady_clock::now();
+  previousSlotEntries_m.assign(progress_m->slots.size(), 0);
+  bytesAtStart_m = TFile::GetFileBytesRead();
+  previousBytes_m = bytesAtStart_m;
+
+  stop_m = false;
+  writer_m = std::thread(&MetricsService::writerLoop, this);
+}
+
+void MetricsService::finalize(ROOT::RDF::RNode &) {
+  stopWriter();
+  if (!progress_m) {
+    return;
+  }
+  // Metrics are monitoring only: failing to write them must not fail the job.
+  try {
+    write(snapshot());
+  } catch (const std::exception &e) {
+    ctx_m->logger.log(ILogger::Level::Warn,
+                      std::string("MetricsService: final metrics not written: ") + e.what());
+  }
+}
+
+MetricsService::Snapshot MetricsService::snapshot() {
+  std::lock_guard<std::mutex> lock(snapshotMutex_m);
+  Snapshot snap;
+  const auto now = std::chrono::steady_clock::now();
+  const double interval =
+      std::chrono::duration<double>(now - previousTime_m).count();
+  previousTime_m = now;
+  snap.timestamp = unixSeconds();
+
+  const std::int64_t startNs = progress_m->startNs.load();
+  const std::int64_t endNs = progress_m->endNs.load();
+  if (endNs != 0) {
+    snap.state = State::Finished;
+  } else if (startNs != 0) {
+    snap.state = State::Running;
+  }
+
+  snap.slotEventsPerSecond.reserve(progress_m->slots.size());
+  std::uint64_t intervalEntries = 0;
+  for (std::size_t slot = 0; slot < progress_m->slots.size(); ++slot) {
+    const std::uint64_t entries = progress_m->slots[slot].entries.load();
+    const std::uint64_t delta = entries - previousSlotEntries_m[slot];
+    previousSlotEntries_m[slot] = entries;
+    snap.entries += entries;
+    intervalEntries += delta;
+    snap.slotEventsPerSecond.push_back(interval > 0.0 ? delta / interval : 0.0);
+  }
+  snap.eventsPerSecond = interval > 0.0 ? intervalEntries / interval : 0.0;
+
+  if (startNs != 0) {
+    snap.loopSeconds = static_cast<double>((endNs != 0 ? endNs : steadyNs()) - startNs) * 1e-9;
+    snap.meanEventsPerSecond =
+        snap.loopSeconds > 0.0 ? static_cast<double>(snap.entries) / snap.loopSeconds : 0.0;
+  }
+  if (snap.entries > lastEntries_m) {
+    lastEntries_m = snap.entries;
+    lastProgress_m = snap.timestamp;
+  }
+  snap.lastProgress = lastProgress_m;
+
+  const Long64_t bytes = TFile::GetFileBytesRead();
+  snap.bytesRead = static_cast<std::uint64_t>(std::max<Long64_t>(0, bytes - bytesAtStart_m));
+  snap.readMBPerSecond =
+      interval > 0.0 ? static_cast<double>(bytes - previousBytes_m) / 1.0e6 / interval : 0.0;
+  previousBytes_m = bytes;
+  snap.rssMB = currentRssMegabytes();
+
+  std::lock_guard<std::mutex> filesLock(progress_m->filesMutex);
+  snap.slotFiles = progress_m->files;
+  return snap;
+}
+
+void MetricsService::write(const Snapshot &snapshot) const {
+  const std::filesystem::path path(path_m);
+  if (path.has_parent_path()) {
+    std::filesystem::create_directories(path.parent_path());
+  }
+  const std::string tmp = path_m + ".tmp." + std::to_string(getpid());
+  {
+    std::ofstream out(tmp, std::ios::trunc);
+    out << (prometheus_m ? formatPrometheus(snapshot) : formatJson(snapshot));
+    if (!out) {
+      std::remove(tmp.c_str());
+      throw std::runtime_error("MetricsService: cannot write '" + tmp + "'");
+    }
+  }
+  std::filesystem::rename(tmp, path);
+}
+
+std::string MetricsService::formatJson(const Snapshot &snapshot) {
+  std::ostringstream out;
+  out << std::fixed << std::setprecision(3);
+  out << "{\n  \"state\": \"" << stateName(snapshot.state) << "\",\n"
+      << "  \"timestamp\": " << snapshot.timestamp << ",\n"
+      << "  \"last_progress\": " << snapshot.lastProgress << ",\n"
+      << "  \"event_loop_s\": " << snapshot.loopSeconds << ",\n"
+      << "  \"entries\": " << snapshot.entries << ",\n"
+      << "  \"events_per_s\": " << snapshot.eventsPerSecond << ",\n"
+      << "  \"mean_events_per_s\": " << snapshot.meanEventsPerSecond << ",\n"
+      << "  \"slot_events_per_s\": [";
+  for (std::size_t i = 0; i < snapshot.slotEventsPerSecond.size(); ++i) {
+    out << (i ? ", " : "") << snapshot.slotEventsPerSecond[i];
+  }
+  out << "],\n"
+      << "  \"bytes_read\": " << snapshot.bytesRead << ",\n"
+      << "  \"read_mb_per_s\": " << snapshot.readMBPerSecond << ",\n"
+      << "  \"rss_mb\": " << snapshot.rssMB << ",\n"
+      << "  \"input_files\": [";
+  for (std::size_t i = 0; i < snapshot.slotFiles.size(); ++i) {
+    out << (i ? ", " : "") << jsonString(snapshot.slotFiles[i]);
+  }
+  out << "]\n}\n";
+  return out.str();
+}
+
+std::string MetricsService::formatPrometheus(const Snapshot &snapshot) {
+  std::ostringstream out;
+  out << std::fixed << std::setprecision(3);
+  const auto metric = [&out](const char *name, const char *type, const char *help) {
+    out << "# HELP " << name << ' ' << help << "\n# TYPE " << name << ' ' << type << '\n';
+  };
+  metric("rdf_job_state", "gauge", "1 for the current state of the job.");
+  for (const State state : {State::Setup, State::Running, State::Finished}) {
+    out << "rdf_job_state{state=\"" << stateName(state) << "\"} "
+        << (state == snapshot.state ? 1 : 0) << '\n';
+  }
+  metric("rdf_entries_processed_total", "counter", "Entries processed by the event loop.");
+  out << "rdf_entries_processed_total " << snapshot.entries << '\n';
+  metric("rdf_events_per_second", "gauge", "Entries per second over the last interval.");
+  out << "rdf_events_per_second " << snapshot.eventsPerSecond << '\n';
+  metric("rdf_slot_events_per_second", "gauge", "Entries per second of each slot.");
+  for (std::size_t i = 0; i < snapshot.slotEventsPerSecond.size(); ++i) {
+    out << "rdf_slot_events_per_second{slot=\"" << i << "\"} "
+        << snapshot.slotEventsPerSecond[i] << '\n';
+  }
+  metric("rdf_read_bytes_total", "counter", "Bytes read from input files.");
+  out << "rdf_read_bytes_total " << snapshot.bytesRead << '\n';
+  metric("rdf_read_megabytes_per_second", "gauge", "Input read rate over the last interval.");
+  out << "rdf_read_megabytes_per_second " << snapshot.readMBPerSecond << '\n';
+  metric("rdf_resident_memory_megabytes", "gauge", "Resident set size of the process.");
+  out << "rdf_resident_memory_megabytes " << snapshot.rssMB << '\n';
+  metric("rdf_last_progress_timestamp_seconds", "gauge", "Unix time of the last processed entry.");
+  out << "rdf_last_progress_timestamp_seconds " << snapshot.lastProgress << '\n';
+  metric("rdf_slot_input_file_info", "gauge", "Input file read by each slot.");
+  for (std::size_t i = 0; i < snapshot.slotFiles.size(); ++i) {
+    if (!snapshot.slotFiles[i].empty()) {
+      out << "rdf_slot_input_file_info{slot=\"" << i << "\",file=\""
+          << promLabel(snapshot.slotFiles[i]) << "\"} 1\n";
+    }
+  }
+  return out.str();
+}
+
+double MetricsService::currentRssMegabytes() {
+  std::ifstream statm("/proc/self/statm");
+  unsigned long long size = 0;
+  unsigned long long resident = 0;
+  if (!(statm >> size >> resident)) {
+    return 0.0;
+  }
+  return static_cast<double>(resident) * static_cast<double>(sysconf(_SC_PAGESIZE)) /
+         (1024.0 * 1024.0);
+}
+
+std::unordered_map<std::string, std::string>
+MetricsService::collectProvenanceEntries() const {
+  return {{"service.metrics.file", path_m},
+          {"service.metrics.format", prometheus_m ? "prometheus" : "json"}};
+}
+
+void MetricsService::writerLoop() {
+  std::unique_lock<std::mutex> lock(writerMutex_m);
+  while (!stop_m) {
+    writerWake_m.wait_for(lock, interval_m, [this] { return stop_m; });
+    if (stop_m) {
+      break;
+    }
+    lock.unlock();
+    try {
+      write(snapshot());
+    } catch (const std::exception &e) {
+      ctx_m->logger.log(ILogger::Level::Warn,
+                        std::string("MetricsService: metrics not written: ") + e.what());
+    }
+    lock.lock();
+  }
+}
+
+void MetricsService::stopWriter() {
+  {
+    std::lock_guard<std::mutex> lock(writerMutex_m);
+    stop_m = true;
+  }
+  writerWake_m.notify_all();
+  if (writer_m.joinable()) {
+    writer_m.join();
+  }
+}
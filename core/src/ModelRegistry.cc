@@ -0,0 +1,65 @@
+#include <ModelRegistry.h>
+
+#include <TMD5.h>
+
+#include <array>
+#include <filesystem>
+#include <fstream>
+#include <system_error>
+
+ModelRegistry &ModelRegistry::instance() {
+  static ModelRegistry registry;
+  return registry;
+}
+
+std::string ModelRegistry::contentHash(const std::string &file) {
+  std::lock_guard<std::mutex> lock(mutex_m);
+  return contentHashLocked(file);
+}
+
+std::string ModelRegistry::contentHashLocked(const std::string &file) {
+  namespace fs = std::filesystem;
+  std::error_code ec;
+  const auto size = fs::file_size(file, ec);
+  if (ec) {
+    return "";
+  }
+  const auto mtime = fs::last_write_time(file, ec);
+  if (ec) {
+    return "";
+  }
+  const std::int64_t stamp = mtime.time_since_epoch().count();
+  if (auto it = digests_m.find(file);
+      it != digests_m.end() && it->second.size == size && it->second.mtime == stamp) {
+    return it->second.digest;
+  }
+
+  std::ifstream in(file, std::ios::binary);
+  if (!in) {
+    return "";
+  }
+  TMD5 md5;
+  std::array<char, 1 << 16> buf{};
+  while (in.read(buf.data(), static_cast<std::streamsize>(buf.size())) || in.gcount() > 0) {
+    md5.Update(reinterpret_cast<const UChar_t *>(buf.data()), static_cast<UInt_t>(in.gcount()));
+  }
+  md5.Final();
+  std::string digest = md5.AsString();
+  digests_m[file] = FileDigest{size, stamp, digest};
+  return digest;
+}
+
+void ModelRegistry::clear() {
+  std::lock_guard<std::mutex> lock(mutex_m);
+  entries_m.clear();
+}
+
+std::size_t ModelRegistry::loads() const {
+  std::lock_guard<std::mutex> lock(mutex_m);
+  return loads_m;
+}
+
+std::size_t ModelRegistry::hits() const {
+  std::lock_guard<std::mutex> lock(mutex_m);
+  return hits_m;
+}
@@ -0,0 +1,280 @@
+#include <MpiRuntime.h>
+#include <api/IConfigurationProvider.h>
+#include <AsyncLogger.h>
+#include <OutputMerger.h>
+#include <TBufferFile.h>
+#include <TH1.h>
+#include <TNamed.h>
+#include <algorithm>
+#include <cstdlib>
+#include <filesystem>
+#include <memory>
+#include <stdexcept>
+#include <unistd.h>
+#include <vector>
+
+#if defined(HAS_MPI)
+#include <mpi.h>
+#endif
+
+namespace {
+
+struct State {
+  bool active = false;
+  int rank = 0;
+  int size = 1;
+};
+
+State &state() {
+  static State instance;
+  return instance;
+}
+
+bool isTrue(const std::string &value) {
+  return value == "1" || value == "true" || value == "True";
+}
+
+#if defined(HAS_MPI)
+
+constexpr int kSizeTag = 1;
+constexpr int kDataTag = 2;
+/// Bytes per MPI message; MPI counts are ints.
+constexpr std::uint64_t kChunk = 1u << 30;
+
+std::vector<char> serialize(const OutputMerger::Contents &contents) {
+  TBufferFile buffer(TBuffer::kWrite);
+  buffer.WriteInt(static_cast<Int_t>(contents.size()));
+  for (const auto &[path, object] : contents) {
+    buffer.WriteTString(TString(path.c_str()));
+    buffer.WriteObject(object.get());
+  }
+  return std::vector<char>(buffer.Buffer(), buffer.Buffer() + buffer.Length());
+}
+
+OutputMerger::Contents deserialize(std::vector<char> &data) {
+  TBufferFile buffer(TBuffer::kRead, static_cast<Int_t>(data.size()), data.data(), kFALSE);
+  Int_t count = 0;
+  buffer.ReadInt(count);
+  OutputMerger::Contents contents;
+  for (Int_t i = 0; i < count; ++i) {
+    TString path;
+    buffer.ReadTString(path);
+    std::unique_ptr<TObject> object(buffer.ReadObject(TObject::Class()));
+    if (!object) {
+      throw std::runtime_error("MpiRuntime: cannot read '" + std::string(path.Data()) +
+                               "' sent by another rank");
+    }
+    if (auto *hist = dynamic_cast<TH1 *>(object.get())) {
+      hist->SetDirectory(nullptr);
+    }
+    contents[path.Data()] = std::move(object);
+  }
+  return contents;
+}
+
+void send(const std::vector<char> &data, int destination) {
+  std::uint64_t size = data.size();
+  MPI_Send(&size, 1, MPI_UINT64_T, destination, kSizeTag, MPI_COMM_WORLD);
+  for (std::uint64_t offset = 0; offset < size; offset += kChunk) {
+    MPI_Send(data.data() + offset, static_cast<int>(std::min(kChunk, size - offset)),
+             MPI_BYTE, destination, kDataTag, MPI_COMM_WORLD);
+  }
+}
+
+std::vector<char> receive(int source) {
+  std::uint64_t size = 0;
+  MPI_Recv(&size, 1, MPI_UINT64_T, source, kSizeTag, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+  std::vector<char> data(size);
+  for (std::uint64_t offset = 0; offset < size; offset += kChunk) {
+    MPI_Recv(data.data() + offset, static_cast<int>(std::min(kChunk, size - offset)),
+             MPI_BYTE, source, kDataTag, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+  }
+  return data;
+}
+
+/// Whether every rank succeeded; collective.
+bool allSucceeded(const std::string &error) {
+  int ok = error.empty() ? 1 : 0;
+  MPI_Allreduce(MPI_IN_PLACE, &ok, 1, MPI_INT, MPI_MIN, MPI_COMM_WORLD);
+  return ok == 1;
+}
+
+void finalizeAtExit() {
+  int finalized = 0;
+  MPI_Finalized(&finalized);
+  if (!finalized) {
+    MPI_Finalize();
+  }
+}
+
+#endif
+
+} // namespace
+
+void MpiRuntime::configure(IConfigurationProvider &config) {
+  if (!isTrue(config.get("mpi"))) {
+    return;
+  }
+#if !defined(HAS_MPI)
+  throw std::runtime_error("MpiRuntime: mpi=true requires a build with -DUSE_MPI=ON");
+#else
+  auto &current = state();
+  if (!current.active) {
+    int initialized = 0;
+    MPI_Initialized(&initialized);
+    if (!initialized) {
+      int provided = 0;
+      MPI_Init_thread(nullptr, nullptr, MPI_THREAD_FUNNELED, &provided);
+      std::atexit(finalizeAtExit);
+    }
+    MPI_Comm_rank(MPI_COMM_WORLD, &current.rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &current.size);
+    current.active = true;
+  }
+  if (current.size < 2 || !config.get("mpiMetaFile").empty()) {
+    return;
+  }
+
+  const std::string saveFile = config.get("saveFile");
+  const std::string metaFile = config.get("metaFile");
+  const std::string target = metaFile.empty() ? saveFile : metaFile;
+  const bool skim = isTrue(config.get("enableSkim"));
+  if (skim && target == saveFile) {
+    throw std::runtime_error("MpiRuntime: with mpi=true and enableSkim, metaFile must "
+                             "differ from saveFile (skims are written per rank)");
+  }
+
+  std::string scratch = config.get("mpiScratchDir");
+  if (scratch.empty()) {
+    const char *tmpdir = std::getenv("TMPDIR");
+    scratch = tmpdir && *tmpdir ? tmpdir : "/tmp";
+  }
+  std::filesystem::create_directories(scratch);
+  const std::filesystem::path name = std::filesystem::path(target).filename();
+  const std::string local =
+      (std::filesystem::path(scratch) /
+       (name.stem().string() + ".rank" + std::to_string(current.rank) + "." +
+        std::to_string(getpid()) + name.extension().string()))
+          .string();
+
+  config.set("mpiMetaFile", target);
+  config.set("metaFile", local);
+  if (skim) {
+    config.set("saveFile", rankPath(saveFile, current.rank));
+  }
+  if (current.rank == 0) {
+    RDF_LOG_INFO << "MPI: " << current.size << " ranks; meta outputs are reduced into "
+                 << target;
+  }
+#endif
+}
+
+bool MpiRuntime::active() { return state().active; }
+
+int MpiRuntime::rank() { return state().rank; }
+
+int MpiRuntime::size() { return state().size; }
+
+std::pair<std::uint64_t, std::uint64_t>
+MpiRuntime::partition(std::uint64_t first, std::uint64_t last, int rank, int size) {
+  if (size < 1 || rank < 0 || rank >= size) {
+    throw std::invalid_argument("MpiRuntime::partition: rank " + std::to_string(rank) +
+                                " is not in [0, " + std::to_string(size) + ")");
+  }
+  const std::uint64_t entries = last > first ? last - first : 0;
+  const std::uint64_t base = entries / size;
+  const std::uint64_t extra = entries % size;
+  const std::uint64_t r = static_cast<std::uint64_t>(rank);
+  const std::uint64_t begin = first + r * base + std::min(r, extra);
+  return {begin, begin + base + (r < extra ? 1 : 0)};
+}
+
+std::string MpiRuntime::rankPath(const std::string &path, int rank) {
+  const std::filesystem::path file(path);
+  return (file.parent_path() /
+          (file.stem().string() + ".rank" + std::to_string(rank) + file.extension().string()))
+      .string();
+}
+
+void MpiRuntime::reduceOutputs(const IConfigurationProvider &config) {
+  const std::string target = config.get("mpiMetaFile");
+  if (target.empty()) {
+    return;
+  }
+#if defined(HAS_MPI)
+  const int rank = state().rank;
+  const int size = state().size;
+  const std::string local = config.get("metaFile");
+  // A rank that fails keeps taking part in every message and collective,
+  // so that the others do not wait for it forever; all ranks then agree on
+  // the outcome and throw together.
+  std::string error;
+  OutputMerger::Contents contents;
+  try {
+    if (std::filesystem::exists(local)) {
+      contents = OutputMerger::read(local);
+      std::filesystem::remove(local);
+    }
+  } catch (const std::exception &e) {
+    error = e.what();
+    contents.clear();
+  }
+
+  // Binomial tree: at step s, ranks that are multiples of 2s add the
+  // results of rank + s, which then leaves the reduction.
+  for (int step = 1; step < size; step *= 2) {
+    if (rank % (2 * step) != 0) {
+      std::vector<char> data;
+      try {
+        data = serialize(contents);
+      } catch (const std::exception &e) {
+        error = e.what();
+        data = serialize({});
+      }
+      send(data, rank - step);
+      contents.clear();
+      break;
+    }
+    if (rank + step < size) {
+      std::vector<char> data = receive(rank + step);
+      if (!error.empty()) {
+        continue;
+      }
+      try {
+        OutputMerger::Contents other = deserialize(data);
+        OutputMerger::add(contents, other);
+      } catch (const std::exception &e) {
+        error = e.what();
+        contents.clear();
+      }
+    }
+  }
+
+  bool ok = allSucceeded(error);
+  if (ok && rank == 0) {
+    try {
+      const bool hasProvenance =
+          std::any_of(contents.begin(), contents.end(), [](const auto &entry) {
+            return entry.first.rfind("provenance/", 0) == 0;
+          });
+      if (hasProvenance) {
+        contents["provenance/mpi.ranks"] =
+            std::make_unique<TNamed>("mpi.ranks", std::to_string(size).c_str());
+      }
+      OutputMerger::write(target, contents);
+      RDF_LOG_INFO << "MPI: reduced the meta outputs of " << size << " ranks into " << target;
+    } catch (const std::exception &e) {
+      error = e.what();
+    }
+  }
+  // Also keeps every rank from exiting before the reduced output exists.
+  if (ok) {
+    ok = allSucceeded(error);
+  }
+  if (!ok) {
+    throw std::runtime_error(
+        "MpiRuntime: reducing the meta outputs into '" + target + "' failed" +
+        (error.empty() ? " on another rank" : ": " + error));
+  }
+#endif
+}
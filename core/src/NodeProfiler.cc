@@ -0,0 +1,216 @@
+#include <NodeProfiler.h>
+#include <JsonString.h>
+
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <unistd.h>
+#include <yaml-cpp/yaml.h>
+
+namespace {
+
+/// True when @p name is @p column or one of its "<column>_<syst>Up/Down" variants.
+bool isColumnOrVariation(const std::string &name, const std::string &column) {
+  if (name == column) {
+    return true;
+  }
+  const auto endsWith = [&name](const std::string &suffix) {
+    return name.size() >= suffix.size() &&
+           name.compare(name.size() - suffix.size(), suffix.size(), suffix) == 0;
+  };
+  return name.size() > column.size() + 1 && name.compare(0, column.size(), column) == 0 &&
+         name[column.size()] == '_' && (endsWith("Up") || endsWith("Down"));
+}
+
+} // namespace
+
+bool NodeProfiler::trackAllocations() {
+  trackAllocations_m = true;
+  return AllocationTracker::enable();
+}
+
+NodeProfiler::SlotTasks NodeProfiler::taskTotals() const {
+  SlotTasks total;
+  for (const auto &slot : tasks_m) {
+    total.entries += slot.entries;
+    total.counts += slot.counts;
+  }
+  return total;
+}
+
+void NodeProfiler::resetAllocations() {
+  for (auto &slot : tasks_m) {
+    slot = SlotTasks{};
+  }
+  for (auto &node : nodes_m) {
+    for (auto &slot : node.slots) {
+      slot.allocations = 0;
+      slot.bytes = 0;
+    }
+  }
+}
+
+void NodeProfiler::attribute(const std::vector<std::string> &columns,
+                             const std::string &owner) {
+  for (auto &node : nodes_m) {
+    if (node.owner != kDefaultOwner) {
+      continue;
+    }
+    for (const auto &column : columns) {
+      if (isColumnOrVariation(node.name, column)) {
+        node.owner = owner;
+        break;
+      }
+    }
+  }
+}
+
+std::vector<NodeProfiler::Entry> NodeProfiler::entries() const {
+  std::vector<Entry> result;
+  result.reserve(nodes_m.size());
+  for (const auto &node : nodes_m) {
+    Entry entry{node.name, node.kind, node.owner};
+    for (const auto &slot : node.slots) {
+      entry.calls += slot.calls;
+      entry.nanoseconds += slot.nanoseconds;
+      entry.allocations += slot.allocations;
+      entry.bytes += slot.bytes;
+    }
+    result.push_back(std::move(entry));
+  }
+  std::stable_sort(result.begin(), result.end(), [](const Entry &a, const Entry &b) {
+    return a.nanoseconds > b.nanoseconds;
+  });
+  return result;
+}
+
+std::map<std::string, std::uint64_t> NodeProfiler::ownerTotals() const {
+  std::map<std::string, std::uint64_t> totals;
+  for (const auto &entry : entries()) {
+    totals[entry.owner] += entry.nanoseconds;
+  }
+  return totals;
+}
+
+std::map<std::string, AllocationTracker::Counts> NodeProfiler::ownerAllocations() const {
+  std::map<std::string, AllocationTracker::Counts> totals;
+  AllocationTracker::Counts nodes;
+  for (const auto &entry : entries()) {
+    const AllocationTracker::Counts counts{entry.allocations, entry.bytes};
+    totals[entry.owner] += counts;
+    nodes += counts;
+  }
+  if (trackAllocations_m) {
+    // Tasks include the nodes they ran; what is left happened outside them.
+    const auto tasks = taskTotals().counts;
+    totals["framework"] = AllocationTracker::Counts{
+        tasks.allocations > nodes.allocations ? tasks.allocations - nodes.allocations : 0,
+        tasks.bytes > nodes.bytes ? tasks.bytes - nodes.bytes : 0};
+  }
+  return totals;
+}
+
+void NodeProfiler::writeReport(const std::string &path) const {
+  const auto times = ownerTotals();
+  const auto allocations = ownerAllocations();
+  const auto tasks = taskTotals();
+  const double events = static_cast<double>(std::max<std::uint64_t>(tasks.entries, 1));
+  const auto writeAllocations = [events](std::ostream &out,
+                                         const AllocationTracker::Counts &counts) {
+    out << "\"allocations\": " << counts.allocations << ", \"bytes\": " << counts.bytes
+        << ", \"allocations_per_event\": " << counts.allocations / events
+        << ", \"bytes_per_event\": " << counts.bytes / events;
+  };
+
+  std::ostringstream out;
+  out << "{\n  \"slots\": " << nSlots_m << ",\n";
+  if (trackAllocations_m) {
+    out << "  \"events\": " << tasks.entries << ",\n  \"allocations\": {";
+    writeAllocations(out, tasks.counts);
+    out << "},\n";
+  }
+  out << "  \"owners\": {";
+  bool first = true;
+  // Same owners as ownerTotals(), plus "framework" with allocation tracking.
+  for (const auto &[owner, counts] : allocations) {
+    const auto time = times.find(owner);
+    out << (first ? "\n" : ",\n") << "    " << jsonString(owner) << ": {\"ns\": "
+        << (time != times.end() ? time->second : 0);
+    if (trackAllocations_m) {
+      out << ", ";
+      writeAllocations(out, counts);
+    }
+    out << "}";
+    first = false;
+  }
+  out << (first ? "" : "\n  ") << "},\n  \"nodes\": [";
+  first = true;
+  for (const auto &entry : entries()) {
+    const double perCall =
+        entry.calls > 0 ? static_cast<double>(entry.nanoseconds) / entry.calls : 0.0;
+    out << (first ? "\n" : ",\n") << "    {\"name\": " << jsonString(entry.name)
+        << ", \"kind\": " << jsonString(entry.kind)
+        << ", \"owner\": " << jsonString(entry.owner) << ", \"calls\": " << entry.calls
+        << ", \"ns\": " << entry.nanoseconds << ", \"ns_per_call\": " << perCall;
+    if (trackAllocations_m) {
+      out << ", \"allocations\": " << entry.allocations << ", \"bytes\": " << entry.bytes;
+    }
+    out << "}";
+    first = false;
+  }
+  out << (first ? "" : "\n  ") << "]\n}\n";
+
+  // Write to a temporary file first so readers never see a partial report.
+  const std::string tmpPath = path + ".tmp." + std::to_string(getpid());
+  {
+    std::ofstream file(tmpPath);
+    if (!file) {
+      throw std::runtime_error("NodeProfiler: cannot write '" + path + "'");
+    }
+    file << out.str();
+  }
+  std::filesystem::rename(tmpPath, path);
+}
+
+double NodeProfiler::readEventCost(const std::string &path) {
+  YAML::Node root;
+  try {
+    root = YAML::LoadFile(path);
+  } catch (const YAML::Exception &e) {
+    throw std::runtime_error("NodeProfiler: cannot read '" + path + "': " + e.what());
+  }
+  double nanoseconds = 0.0;
+  std::uint64_t events = 0;
+  if (root["nodes"] && root["nodes"].IsSequence()) {
+    for (const auto &node : root["nodes"]) {
+      nanoseconds += node["ns"].as<double>(0.0);
+      events = std::max(events, node["calls"].as<std::uint64_t>(0));
+    }
+  }
+  return events > 0 ? nanoseconds / static_cast<double>(events) : 0.0;
+}
+
+unsigned int NodeProfiler::tasksPerWorkerHint(double eventCostNs, std::uint64_t entries,
+                                              unsigned int workers, double targetSeconds) {
+  constexpr unsigned int kDefaultHint = 10;
+  constexpr double kMaxHint = 100000.0;
+  if (!(eventCostNs > 0.0) || entries == 0 || workers == 0 || !(targetSeconds > 0.0)) {
+    return kDefaultHint;
+  }
+  const double tasks = std::ceil(eventCostNs * 1e-9 * static_cast<double>(entries) / targetSeconds);
+  const double hint = std::ceil(tasks / workers);
+  return static_cast<unsigned int>(std::clamp(hint, static_cast<double>(kDefaultHint), kMaxHint));
+}
+
+unsigned int NodeProfiler::capTasksPerWorker(unsigned int hint, std::uint64_t entries,
+                                             unsigned int workers, std::uint64_t minEntries) {
+  if (entries == 0 || workers == 0 || minEntries == 0) {
+    return hint;
+  }
+  const std::uint64_t maxHint = entries / (minEntries * workers);
+  return static_cast<unsigned int>(
+      std::max<std::uint64_t>(1, std::min<std::uint64_t>(hint, maxHint)));
+}
@@ -0,0 +1,252 @@
+#include <OutputMerger.h>
+#include <plots.h>
+#include <TDirectory.h>
+#include <TFile.h>
+#include <TH1.h>
+#include <THnBase.h>
+#include <TKey.h>
+#include <TNamed.h>
+#include <TROOT.h>
+#include <TTree.h>
+#include <TVectorD.h>
+#include <ROOT/TSeq.hxx>
+#include <ROOT/TThreadExecutor.hxx>
+#include <algorithm>
+#include <filesystem>
+#include <set>
+#include <stdexcept>
+#include <yaml-cpp/yaml.h>
+
+namespace {
+
+/// Read the objects of @p dir into @p contents under @p prefix.
+void readDirectory(TDirectory &dir, const std::string &prefix,
+                   const std::string &path, OutputMerger::Contents &contents) {
+  // Keys are listed with the highest cycle first.
+  std::set<std::string> seen;
+  for (TObject *obj : *dir.GetListOfKeys()) {
+    auto *key = static_cast<TKey *>(obj);
+    const std::string name = key->GetName();
+    if (!seen.insert(name).second) {
+      continue;
+    }
+    const std::string keyPath = prefix + name;
+    TClass *cls = TClass::GetClass(key->GetClassName());
+    if (cls && cls->InheritsFrom(TDirectory::Class())) {
+      auto *subdir = dir.GetDirectory(name.c_str());
+      if (subdir) {
+        readDirectory(*subdir, keyPath + "/", path, contents);
+      }
+      continue;
+    }
+    if (cls && cls->InheritsFrom(TTree::Class())) {
+      // Bookkeeping trees (e.g. CounterService's per-file totals) are
+      // copied into memory and concatenated by mergeObject.
+      auto *tree = dir.Get<TTree>(name.c_str());
+      if (!tree) {
+        throw std::runtime_error("OutputMerger: cannot read '" + keyPath +
+                                 "' from '" + path + "'");
+      }
+      std::unique_ptr<TTree> copy;
+      {
+        TDirectory::TContext context(nullptr);
+        copy.reset(tree->CloneTree(-1));
+      }
+      if (!copy) {
+        throw std::runtime_error("OutputMerger: cannot copy the tree '" + keyPath +
+                                 "' from '" + path + "'");
+      }
+      copy->SetDirectory(nullptr);
+      contents[keyPath] = std::move(copy);
+      continue;
+    }
+    std::unique_ptr<TObject> object(key->ReadObj());
+    if (!object) {
+      throw std::runtime_error("OutputMerger: cannot read '" + keyPath +
+                               "' from '" + path + "'");
+    }
+    if (auto *hist = dynamic_cast<TH1 *>(object.get())) {
+      hist->SetDirectory(nullptr);
+    }
+    contents[keyPath] = std::move(object);
+  }
+}
+
+/// Add @p from to @p into; objects without a merge rule keep @p into.
+void mergeObject(const std::string &path, TObject &into, const TObject &from) {
+  if (into.IsA() != from.IsA()) {
+    throw std::runtime_error("OutputMerger: '" + path + "' is a " + into.ClassName() +
+                             " in one input and a " + from.ClassName() +
+                             " in another.");
+  }
+  if (auto *hist = dynamic_cast<TH1 *>(&into)) {
+    if (!hist->Add(static_cast<const TH1 *>(&from))) {
+      throw std::runtime_error("OutputMerger: cannot add the histograms '" + path +
+                               "'; their binnings differ.");
+    }
+  } else if (auto *sparse = dynamic_cast<THnBase *>(&into)) {
+    const auto &other = static_cast<const THnBase &>(from);
+    bool consistent = other.GetNdimensions() == sparse->GetNdimensions();
+    for (Int_t d = 0; consistent && d < sparse->GetNdimensions(); ++d) {
+      consistent = other.GetAxis(d)->GetNbins() == sparse->GetAxis(d)->GetNbins();
+    }
+    if (!consistent) {
+      throw std::runtime_error("OutputMerger: cannot add the histograms '" + path +
+                               "'; their binnings differ.");
+    }
+    sparse->Add(&other);
+  } else if (auto *vec = dynamic_cast<TVectorD *>(&into)) {
+    const auto &other = static_cast<const TVectorD &>(from);
+    if (other.GetNrows() != vec->GetNrows()) {
+      throw std::runtime_error("OutputMerger: cannot add the vectors '" + path +
+                               "'; their lengths differ.");
+    }
+    *vec += other;
+  } else if (auto *tree = dynamic_cast<TTree *>(&into)) {
+    // CopyEntries sets the branch addresses of its source.
+    auto *other = const_cast<TTree *>(static_cast<const TTree *>(&from));
+    bool sameBranches = other->GetNbranches() == tree->GetNbranches();
+    for (TObject *branch : *tree->GetListOfBranches()) {
+      sameBranches = sameBranches && other->GetBranch(branch->GetName()) != nullptr;
+    }
+    if (!sameBranches) {
+      throw std::runtime_error("OutputMerger: cannot concatenate the trees '" + path +
+                               "'; their branches differ.");
+    }
+    tree->CopyEntries(other);
+  }
+}
+
+} // namespace
+
+OutputMerger::OutputMerger(std::size_t partialMerges) : partialMerges_m(partialMerges) {}
+
+void OutputMerger::merge(const std::string &output,
+                         const std::vector<std::string> &inputs) const {
+  if (inputs.empty()) {
+    throw std::runtime_error("OutputMerger: no input files to merge into '" +
+                             output + "'");
+  }
+  ROOT::EnableThreadSafety();
+
+  std::size_t nPartial = partialMerges_m;
+  if (nPartial == 0) {
+    nPartial = ROOT::IsImplicitMTEnabled() ? ROOT::GetThreadPoolSize() : 1;
+  }
+  nPartial = std::max<std::size_t>(1, std::min(nPartial, inputs.size()));
+
+  // Input i goes to partial merge i % nPartial; each holds one merged set
+  // and the file being added to it.
+  std::vector<Contents> partials(nPartial);
+  const auto mergeStripe = [&](unsigned int stripe) {
+    for (std::size_t i = stripe; i < inputs.size(); i += nPartial) {
+      Contents contents = read(inputs[i]);
+      add(partials[stripe], contents);
+    }
+  };
+  if (nPartial > 1 && ROOT::IsImplicitMTEnabled()) {
+    ROOT::TThreadExecutor pool;
+    pool.Foreach(mergeStripe, ROOT::TSeqU(nPartial));
+  } else {
+    for (unsigned int stripe = 0; stripe < nPartial; ++stripe) {
+      mergeStripe(stripe);
+    }
+  }
+  // Stripe 0 starts with the first input, so it keeps the first copies.
+  treeReduceSlots(partials, [](Contents &into, Contents &from) { add(into, from); });
+
+  Contents &merged = partials[0];
+  const bool hasProvenance = std::any_of(merged.begin(), merged.end(), [](const auto &entry) {
+    return entry.first.rfind("provenance/", 0) == 0;
+  });
+  if (hasProvenance) {
+    merged["provenance/merge.input_files"] = std::make_unique<TNamed>(
+        "merge.input_files", std::to_string(inputs.size()).c_str());
+  }
+  write(output, merged);
+}
+
+OutputMerger::Contents OutputMerger::read(const std::string &path) {
+  std::unique_ptr<TFile> file(TFile::Open(path.c_str(), "READ"));
+  if (!file || file->IsZombie()) {
+    throw std::runtime_error("OutputMerger: cannot open '" + path + "'");
+  }
+  Contents contents;
+  readDirectory(*file, "", path, contents);
+  return contents;
+}
+
+void OutputMerger::add(Contents &into, Contents &from) {
+  std::vector<std::pair<TObject *, Contents::iterator>> pairs;
+  for (auto it = from.begin(); it != from.end(); ++it) {
+    auto target = into.find(it->first);
+    if (target == into.end()) {
+      into.emplace(it->first, std::move(it->second));
+    } else {
+      pairs.emplace_back(target->second.get(), it);
+    }
+  }
+  const auto mergePair = [&](unsigned int i) {
+    mergeObject(pairs[i].second->first, *pairs[i].first, *pairs[i].second->second);
+  };
+  if (pairs.size() > 1 && ROOT::IsImplicitMTEnabled()) {
+    ROOT::TThreadExecutor pool;
+    pool.Foreach(mergePair, ROOT::TSeqU(pairs.size()));
+  } else {
+    for (unsigned int i = 0; i < pairs.size(); ++i) {
+      mergePair(i);
+    }
+  }
+  from.clear();
+}
+
+void OutputMerger::write(const std::string &output, const Contents &contents) {
+  const std::filesystem::path parent = std::filesystem::path(output).parent_path();
+  if (!parent.empty()) {
+    std::filesystem::create_directories(parent);
+  }
+  TFile file(output.c_str(), "RECREATE");
+  if (file.IsZombie()) {
+    throw std::runtime_error("OutputMerger: cannot create '" + output + "'");
+  }
+  for (const auto &[path, object] : contents) {
+    const auto slash = path.rfind('/');
+    TDirectory *dir = &file;
+    if (slash != std::string::npos) {
+      dir = file.mkdir(path.substr(0, slash).c_str(), "", true);
+    }
+    dir->WriteTObject(object.get(), path.substr(slash + 1).c_str());
+  }
+  file.Close();
+}
+
+std::map<std::string, std::vector<std::string>>
+OutputMerger::manifestOutputs(const std::vector<std::string> &manifests,
+                              const std::string &role) {
+  std::map<std::string, std::vector<std::string>> groups;
+  for (const auto &manifest : manifests) {
+    YAML::Node root;
+    try {
+      root = YAML::LoadFile(manifest);
+    } catch (const YAML::Exception &e) {
+      throw std::runtime_error("OutputMerger: cannot parse manifest '" + manifest +
+                               "': " + e.what());
+    }
+    const YAML::Node section = root[role];
+    if (!section || !section.IsMap() || !section["output_file"]) {
+      continue;
+    }
+    std::filesystem::path file = section["output_file"].as<std::string>();
+    if (file.empty()) {
+      continue;
+    }
+    if (file.is_relative()) {
+      file = std::filesystem::path(manifest).parent_path() / file;
+    }
+    groups[file.filename().string()].push_back(file.string());
+  }
+  for (auto &[basename, files] : groups) {
+    std::sort(files.begin(), files.end());
+  }
+  return groups;
+}
@@ -1,4 +1,5 @@
 #include <PlottingUtility.h>
+#include <ProvenanceService.h>
 
 #include <TCanvas.h>
 #include <TDirectory.h>
@@ -9,14 +10,21 @@
 #include <TMatrixD.h>
 #include <TMatrixDSym.h>
 #include <TMatrixDSymEigen.h>
+#include <THnSparse.h>
 #include <TPad.h>
 #include <TLine.h>
 #include <TROOT.h>
 
-#include <functional>
-#include <future>
-#include <mutex>
+#include <algorithm>
+#include <atomic>
 #include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <thread>
 
 namespace {
 constexpr double kMinDenominator = 1e-12;
@@ -28,6 +36,9 @@ constexpr double kLegendY1 = 0.68;
 constexpr double kLegendX2 = 0.88;
 constexpr double kLegendY2 = 0.88;
 
+/// Bump when the rendering changes, so skipUnchanged redraws every plot.
+constexpr int kPlotStyleVersion = 1;
+
 TH1* getHistogram(TFile& file, const PlotProcessConfig& process) {
   if (process.directory.empty()) {
     return dynamic_cast<TH1*>(file.Get(process.histogramName.c_str()));
@@ -40,22 +51,123 @@ TH1* getHistogram(TFile& file, const PlotProcessConfig& process) {
   return dynamic_cast<TH1*>(directory->Get(process.histogramName.c_str()));
 }
 
-double getNormalizationScale(TFile& file, const PlotProcessConfig& process) {
-  if (process.normalizationHistogram.empty()) {
-    return process.scale;
+/**
+ * Input histograms and normalisations of a batch of requests, detached from
+ * their files.  Filled once before rendering and only read afterwards, so
+ * the rendering threads share it without locking.
+ */
+class HistogramCache {
+public:
+  void load(const std::vector<const PlotRequest*>& requests) {
+    std::map<std::string, std::vector<const PlotRequest*>> byFile;
+    for (const auto* request : requests) {
+      byFile[request->metaFile].push_back(request);
+    }
+    for (const auto& [metaFile, fileRequests] : byFile) {
+      TFile file(metaFile.c_str(), "READ");
+      if (file.IsZombie()) {
+        unreadable_m.insert(metaFile);
+        continue;
+      }
+      for (const auto* request : fileRequests) {
+        for (const auto& process : request->processes) {
+          const std::string key = histogramKey(metaFile, process);
+          if (histograms_m.count(key) == 0) {
+            const TH1* source = getHistogram(file, process);
+            std::unique_ptr<TH1> hist;
+            if (source) {
+              hist.reset(static_cast<TH1*>(source->Clone()));
+              hist->SetDirectory(nullptr);
+            }
+            histograms_m.emplace(key, std::move(hist));
+          }
+          if (!process.normalizationHistogram.empty()) {
+            const std::string normKey = metaFile + '\n' + process.normalizationHistogram;
+            if (normalizations_m.count(normKey) == 0) {
+              auto* normHist =
+                  dynamic_cast<TH1*>(file.Get(process.normalizationHistogram.c_str()));
+              if (normHist) {
+                normalizations_m.emplace(normKey, normHist->GetBinContent(1));
+              }
+            }
+          }
+        }
+      }
+    }
+  }
+
+  bool readable(const std::string& metaFile) const { return unreadable_m.count(metaFile) == 0; }
+
+  const TH1* histogram(const std::string& metaFile, const PlotProcessConfig& process) const {
+    const auto it = histograms_m.find(histogramKey(metaFile, process));
+    return it == histograms_m.end() ? nullptr : it->second.get();
+  }
+
+  double normalizationScale(const std::string& metaFile, const PlotProcessConfig& process) const {
+    if (process.normalizationHistogram.empty()) {
+      return process.scale;
+    }
+    const auto it = normalizations_m.find(metaFile + '\n' + process.normalizationHistogram);
+    if (it == normalizations_m.end() || std::abs(it->second) < kMinDenominator) {
+      return process.scale;
+    }
+    return process.scale / it->second;
+  }
+
+  /// Hash of the style of @p request and the contents of its inputs.
+  std::string inputHash(const PlotRequest& request) const {
+    std::ostringstream out;
+    out.precision(17);
+    out << "v" << kPlotStyleVersion << '\n'
+        << request.outputFile << '\n' << request.title << '\n' << request.xAxisTitle << '\n'
+        << request.yAxisTitle << '\n' << request.logY << request.drawRatio << '\n';
+    for (const auto& process : request.processes) {
+      out << process.directory << '\n' << process.histogramName << '\n'
+          << process.legendLabel << '\n' << process.color << ' ' << process.isData << ' '
+          << normalizationScale(request.metaFile, process) << '\n';
+      const TH1* hist = histogram(request.metaFile, process);
+      if (!hist) {
+        out << "missing\n";
+        continue;
+      }
+      const TAxis* axis = hist->GetXaxis();
+      out << hist->ClassName() << ' ' << axis->GetNbins();
+      for (int b = 1; b <= axis->GetNbins() + 1; ++b) {
+        out << ' ' << axis->GetBinLowEdge(b);
+      }
+      for (int b = 0; b <= axis->GetNbins() + 1; ++b) {
+        out << ' ' << hist->GetBinContent(b) << ' ' << hist->GetBinError(b);
+      }
+      out << '\n';
+    }
+    return ProvenanceService::hashString(out.str());
   }
-  auto* normHist = dynamic_cast<TH1*>(file.Get(process.normalizationHistogram.c_str()));
-  if (!normHist) {
-    return process.scale;
+
+private:
+  static std::string histogramKey(const std::string& metaFile, const PlotProcessConfig& process) {
+    return metaFile + '\n' + process.directory + '\n' + process.histogramName;
   }
 
-  const double norm = normHist->GetBinContent(1);
-  if (std::abs(norm) < kMinDenominator) {
-    return process.scale;
+  std::map<std::string, std::unique_ptr<TH1>> histograms_m;
+  std::map<std::string, double> normalizations_m;
+  std::set<std::string> unreadable_m;
+};
+
+std::string stampPath(const PlotRequest& request) { return request.outputFile + ".hash"; }
+
+/// Whether the output of @p request exists and was written from @p hash.
+bool upToDate(const PlotRequest& request, const std::string& hash) {
+  if (!std::filesystem::exists(request.outputFile)) {
+    return false;
   }
-  return process.scale / norm;
+  std::ifstream stamp(stampPath(request));
+  std::string recorded;
+  return static_cast<bool>(std::getline(stamp, recorded)) && recorded == hash;
 }
 
+PlotResult renderStackPlot(const PlotRequest& request, const HistogramCache& cache,
+                           const std::string& skipHash);
+
 // Mutex to protect ROOT GUI/IO (TCanvas/TPad/SaveAs) which is not safe to run concurrently
 static std::mutex gCanvasMutex;
 
@@ -122,65 +234,68 @@ RatioSummary PlottingUtility::computeRatioSummary(const TH1D& loHist,
   return summary;
 }
 
-PCAResult PlottingUtility::computePCAEnvelope(const TH1D& nominal,
-                                              const std::vector<const TH1D*>& variations,
-                                              const std::string& baseName) {
-  PCAResult result;
-  const int binCount = nominal.GetNbinsX();
-  if (variations.empty() || binCount <= 0) {
-    return result;
+PCAAccumulator::PCAAccumulator(int binCount)
+    : binCount_m(std::max(0, binCount)), mean_m(binCount_m, 0.0),
+      comoment_m(static_cast<size_t>(binCount_m) * binCount_m, 0.0) {}
+
+void PCAAccumulator::add(const double* contents) {
+  ++count_m;
+  const double n = static_cast<double>(count_m);
+  std::vector<double> delta(binCount_m);
+  for (int b = 0; b < binCount_m; ++b) {
+    delta[b] = contents[b] - mean_m[b];
+    mean_m[b] += delta[b] / n;
   }
-
-  const int nVariations = static_cast<int>(variations.size());
-  TMatrixD counts(nVariations, binCount);
-  for (int v = 0; v < nVariations; ++v) {
-    if (!variations[v] || variations[v]->GetNbinsX() != binCount) {
-      return result;
-    }
-    for (int b = 0; b < binCount; ++b) {
-      counts(v, b) = variations[v]->GetBinContent(b + 1);
+  // C += delta * (x - mean_new)^T; only the upper triangle is updated.
+  for (int i = 0; i < binCount_m; ++i) {
+    double* row = &comoment_m[static_cast<size_t>(i) * binCount_m];
+    for (int j = i; j < binCount_m; ++j) {
+      row[j] += delta[i] * (contents[j] - mean_m[j]);
     }
   }
+}
 
-  std::vector<double> means(binCount, 0.0);
-  std::vector<double> stddev(binCount, 0.0);
-  for (int b = 0; b < binCount; ++b) {
-    for (int v = 0; v < nVariations; ++v) {
-      means[b] += counts(v, b);
-    }
-    means[b] /= static_cast<double>(nVariations);
-    for (int v = 0; v < nVariations; ++v) {
-      const double delta = counts(v, b) - means[b];
-      stddev[b] += delta * delta;
-    }
-    if (nVariations > 1) {
-      stddev[b] = std::sqrt(stddev[b] / static_cast<double>(nVariations - 1));
-    } else {
-      stddev[b] = 0.0;
-    }
+bool PCAAccumulator::add(const TH1& variation) {
+  if (variation.GetNbinsX() != binCount_m) {
+    return false;
+  }
+  std::vector<double> contents(binCount_m);
+  for (int b = 0; b < binCount_m; ++b) {
+    contents[b] = variation.GetBinContent(b + 1);
+  }
+  add(contents.data());
+  return true;
+}
+
+PCAResult PCAAccumulator::finalize(const TH1D& nominal, const std::string& baseName,
+                                   int maxComponents) const {
+  PCAResult result;
+  const int binCount = binCount_m;
+  if (count_m == 0 || binCount <= 0 || nominal.GetNbinsX() != binCount) {
+    return result;
   }
 
-  TMatrixD standardized(nVariations, binCount);
-  for (int v = 0; v < nVariations; ++v) {
+  const double dof = static_cast<double>(count_m) - 1.0;
+  std::vector<double> stddev(binCount, 0.0);
+  if (count_m > 1) {
     for (int b = 0; b < binCount; ++b) {
-      if (stddev[b] < kMinDenominator) {
-        standardized(v, b) = 0.0;
-      } else {
-        standardized(v, b) = (counts(v, b) - means[b]) / stddev[b];
-      }
+      stddev[b] = std::sqrt(std::max(0.0, comoment_m[static_cast<size_t>(b) * binCount + b] / dof));
     }
   }
 
+  // Correlation matrix: covariance of the standardised variations.
   TMatrixDSym covariance(binCount);
   covariance.Zero();
-  if (nVariations > 1) {
+  if (count_m > 1) {
     for (int i = 0; i < binCount; ++i) {
-      for (int j = 0; j < binCount; ++j) {
-        double accum = 0.0;
-        for (int v = 0; v < nVariations; ++v) {
-          accum += standardized(v, i) * standardized(v, j);
+      for (int j = i; j < binCount; ++j) {
+        if (stddev[i] < kMinDenominator || stddev[j] < kMinDenominator) {
+          continue;
         }
-        covariance(i, j) = accum / static_cast<double>(nVariations - 1);
+        const double value =
+            comoment_m[static_cast<size_t>(i) * binCount + j] / dof / (stddev[i] * stddev[j]);
+        covariance(i, j) = value;
+        covariance(j, i) = value;
       }
     }
   }
@@ -200,10 +315,13 @@ PCAResult PlottingUtility::computePCAEnvelope(const TH1D& nominal,
     }
   }
 
+  // Eigenvalues come sorted in decreasing order.
+  const int components =
+      maxComponents > 0 ? std::min(maxComponents, binCount) : binCount;
   std::vector<double> uncert(binCount, 0.0);
   for (int b = 0; b < binCount; ++b) {
     double variance = 0.0;
-    for (int i = 0; i < binCount; ++i) {
+    for (int i = 0; i < components; ++i) {
       const double lambda = std::max(0.0, eigenValues[i]);
       variance += eigenVectors(b, i) * eigenVectors(b, i) * lambda;
     }
@@ -222,9 +340,9 @@ PCAResult PlottingUtility::computePCAEnvelope(const TH1D& nominal,
   result.down->SetDirectory(nullptr);
 
   for (int b = 0; b < binCount; ++b) {
-    result.mean->SetBinContent(b + 1, means[b]);
-    result.up->SetBinContent(b + 1, means[b] + uncert[b]);
-    result.down->SetBinContent(b + 1, means[b] - uncert[b]);
+    result.mean->SetBinContent(b + 1, mean_m[b]);
+    result.up->SetBinContent(b + 1, mean_m[b] + uncert[b]);
+    result.down->SetBinContent(b + 1, mean_m[b] - uncert[b]);
     result.mean->SetBinError(b + 1, 0.0);
     result.up->SetBinError(b + 1, 0.0);
     result.down->SetBinError(b + 1, 0.0);
@@ -233,10 +351,99 @@ PCAResult PlottingUtility::computePCAEnvelope(const TH1D& nominal,
   return result;
 }
 
+PCAResult PlottingUtility::computePCAEnvelope(const TH1D& nominal,
+                                              const std::vector<const TH1D*>& variations,
+                                              const std::string& baseName,
+                                              int maxComponents) {
+  const int binCount = nominal.GetNbinsX();
+  if (variations.empty() || binCount <= 0) {
+    return PCAResult{};
+  }
+
+  PCAAccumulator accumulator(binCount);
+  for (const auto* variation : variations) {
+    if (!variation || !accumulator.add(*variation)) {
+      return PCAResult{};
+    }
+  }
+  return accumulator.finalize(nominal, baseName, maxComponents);
+}
+
+PCAResult PlottingUtility::computePCAEnvelope(const THnSparse& histogram, int variationAxis,
+                                              int observableAxis, int nominalBin,
+                                              const std::string& baseName,
+                                              int maxComponents) {
+  const int dimensions = histogram.GetNdimensions();
+  if (variationAxis < 0 || variationAxis >= dimensions || observableAxis < 0 ||
+      observableAxis >= dimensions || variationAxis == observableAxis) {
+    return PCAResult{};
+  }
+  const TAxis* observable = histogram.GetAxis(observableAxis);
+  const int binCount = observable->GetNbins();
+  const int variationBins = histogram.GetAxis(variationAxis)->GetNbins();
+  if (binCount <= 0 || nominalBin < 1 || nominalBin > variationBins) {
+    return PCAResult{};
+  }
+
+  // One flat row of observable bins per variation bin, filled in one pass
+  // over the stored bins.
+  std::vector<double> rows(static_cast<size_t>(variationBins) * binCount, 0.0);
+  std::vector<bool> filled(variationBins, false);
+  std::vector<Int_t> coords(dimensions);
+  for (Long64_t i = 0; i < histogram.GetNbins(); ++i) {
+    const double content = histogram.GetBinContent(i, coords.data());
+    const int v = coords[variationAxis];
+    const int o = coords[observableAxis];
+    if (v < 1 || v > variationBins || o < 1 || o > binCount) {
+      continue;
+    }
+    rows[static_cast<size_t>(v - 1) * binCount + (o - 1)] += content;
+    filled[v - 1] = filled[v - 1] || content != 0.0;
+  }
+
+  PCAAccumulator accumulator(binCount);
+  for (int v = 1; v <= variationBins; ++v) {
+    if (v != nominalBin && filled[v - 1]) {
+      accumulator.add(&rows[static_cast<size_t>(v - 1) * binCount]);
+    }
+  }
+  if (accumulator.count() == 0) {
+    return PCAResult{};
+  }
+
+  const std::string nominalName = baseName + "_nominal";
+  std::unique_ptr<TH1D> nominal;
+  if (observable->GetXbins()->GetSize() > 0) {
+    nominal = std::make_unique<TH1D>(nominalName.c_str(), observable->GetTitle(), binCount,
+                                     observable->GetXbins()->GetArray());
+  } else {
+    nominal = std::make_unique<TH1D>(nominalName.c_str(), observable->GetTitle(), binCount,
+                                     observable->GetXmin(), observable->GetXmax());
+  }
+  nominal->SetDirectory(nullptr);
+  return accumulator.finalize(*nominal, baseName, maxComponents);
+}
+
 PlotResult PlottingUtility::makeStackPlot(const PlotRequest& request) const {
+  HistogramCache cache;
+  cache.load({&request});
+  return renderStackPlot(request, cache, "");
+}
+
+std::string PlottingUtility::inputHash(const PlotRequest& request) {
+  HistogramCache cache;
+  cache.load({&request});
+  return cache.inputHash(request);
+}
+
+namespace {
+
+/// Draw @p request from @p cache; with @p skipHash set, an output that is
+/// up to date with it is kept and the hash is recorded after drawing.
+PlotResult renderStackPlot(const PlotRequest& request, const HistogramCache& cache,
+                           const std::string& skipHash) {
   PlotResult result;
-  TFile file(request.metaFile.c_str(), "READ");
-  if (file.IsZombie()) {
+  if (!cache.readable(request.metaFile)) {
     result.message = "Unable to open meta file: " + request.metaFile;
     return result;
   }
@@ -249,7 +456,7 @@ PlotResult PlottingUtility::makeStackPlot(const PlotRequest& request) const {
 
   for (size_t processIndex = 0; processIndex < request.processes.size(); ++processIndex) {
     const auto& process = request.processes[processIndex];
-    TH1* source = getHistogram(file, process);
+    const TH1* source = cache.histogram(request.metaFile, process);
     if (!source) {
       result.message = "Missing histogram '" + process.histogramName + "'";
       return result;
@@ -262,7 +469,7 @@ PlotResult PlottingUtility::makeStackPlot(const PlotRequest& request) const {
       return result;
     }
     hist->SetDirectory(nullptr);
-    hist->Scale(getNormalizationScale(file, process));
+    hist->Scale(cache.normalizationScale(request.metaFile, process));
     hist->SetLineColor(process.color);
     hist->SetMarkerColor(process.color);
 
@@ -303,6 +510,11 @@ PlotResult PlottingUtility::makeStackPlot(const PlotRequest& request) const {
   if (dataHist) {
     result.dataIntegral = dataHist->Integral();
   }
+  if (!skipHash.empty() && upToDate(request, skipHash)) {
+    result.success = true;
+    result.skipped = true;
+    return result;
+  }
 
   // Serialize all ROOT GUI/IO operations (TCanvas/TPad/SaveAs) because they are not
   // safe to run concurrently even when ROOT thread-safety is enabled.
@@ -418,7 +630,7 @@ PlotResult PlottingUtility::makeStackPlot(const PlotRequest& request) const {
         mcRel->Draw("E2");
       }
 
-      auto ratio = computeRatioHistogram(*dataHist, *mcSum, "ratio_hist");
+      auto ratio = PlottingUtility::computeRatioHistogram(*dataHist, *mcSum, "ratio_hist");
       if (ratio) {
         ratio->SetStats(false);
         ratio->GetYaxis()->SetTitle("Data/MC");
@@ -506,17 +718,46 @@ PlotResult PlottingUtility::makeStackPlot(const PlotRequest& request) const {
     canvas.SaveAs(request.outputFile.c_str());
   }
 
+  if (!skipHash.empty()) {
+    std::ofstream(stampPath(request)) << skipHash << "\n";
+  }
   result.success = true;
   return result;
 }
 
+} // namespace
+
 std::vector<PlotResult>
 PlottingUtility::makeStackPlots(const std::vector<PlotRequest>& requests,
                                 bool parallel) const {
+  PlotBatchOptions options;
+  options.parallel = parallel;
+  return makeStackPlots(requests, options);
+}
+
+std::vector<PlotResult>
+PlottingUtility::makeStackPlots(const std::vector<PlotRequest>& requests,
+                                const PlotBatchOptions& options) const {
+  std::vector<const PlotRequest*> pointers;
+  pointers.reserve(requests.size());
+  for (const auto& request : requests) {
+    pointers.push_back(&request);
+  }
+  HistogramCache cache;
+  cache.load(pointers);
+
   std::vector<PlotResult> results(requests.size());
-  if (!parallel || requests.size() < 2) {
+  auto renderOne = [&](size_t i) {
+    const std::string hash = options.skipUnchanged ? cache.inputHash(requests[i]) : "";
+    results[i] = renderStackPlot(requests[i], cache, hash);
+  };
+
+  unsigned int workers = options.maxWorkers > 0 ? options.maxWorkers
+                                                : std::max(1u, std::thread::hardware_concurrency());
+  workers = static_cast<unsigned int>(std::min<size_t>(workers, requests.size()));
+  if (!options.parallel || workers < 2) {
     for (size_t i = 0; i < requests.size(); ++i) {
-      results[i] = makeStackPlot(requests[i]);
+      renderOne(i);
     }
     return results;
   }
@@ -526,15 +767,19 @@ PlottingUtility::makeStackPlots(const std::vector<PlotRequest>& requests,
     return true;
   }();
   (void)threadSafetyEnabled;
-  std::vector<std::future<PlotResult>> futures;
-  futures.reserve(requests.size());
-  for (size_t i = 0; i < requests.size(); ++i) {
-    futures.emplace_back(std::async(std::launch::async, [this, request = std::cref(requests[i])]() {
-      return makeStackPlot(request.get());
-    }));
-  }
-  for (size_t i = 0; i < futures.size(); ++i) {
-    results[i] = futures[i].get();
+  // Workers take the next request until none is left.
+  std::atomic<size_t> next{0};
+  std::vector<std::thread> pool;
+  pool.reserve(workers);
+  for (unsigned int w = 0; w < workers; ++w) {
+    pool.emplace_back([&]() {
+      for (size_t i = next++; i < requests.size(); i = next++) {
+        renderOne(i);
+      }
+    });
+  }
+  for (auto& thread : pool) {
+    thread.join();
   }
   return results;
 }
@@ -5,22 +5,246 @@
 
 #include <GitVersion.h>
 
+#include <ROOT/RDF/RActionImpl.hxx>
+#include <ROOT/TTreeProcessorMT.hxx>
 #include <TDirectory.h>
 #include <TFile.h>
 #include <TMD5.h>
 #include <TNamed.h>
 #include <TObject.h>
+#include <TTreeCacheUnzip.h>
 #include <RVersion.h>
 
+#define XXH_INLINE_ALL
+#include <xxhash.h>
+
 #include <algorithm>
 #include <array>
+#include <atomic>
 #include <cstdio>
 #include <cstdlib>
+#include <fcntl.h>
+#include <filesystem>
 #include <fstream>
+#include <iomanip>
+#include <map>
+#include <mutex>
+#include <optional>
 #include <sstream>
+#include <stdexcept>
 #include <string>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
 #include <vector>
 
+namespace {
+
+/**
+ * @brief Counts the entries of every slot and timestamps the start and end
+ *        of the event loop.
+ *
+ * RDataFrame initializes its actions once the computation graph has been
+ * jitted, just before the first entry, and finalizes them after the last.
+ */
+class LoopMonitorAction
+    : public ROOT::Detail::RDF::RActionImpl<LoopMonitorAction> {
+public:
+    using Result_t = ProvenanceService::LoopStatistics;
+
+    explicit LoopMonitorAction(unsigned int nSlots)
+        : slots_m(nSlots), result_m(std::make_shared<Result_t>()) {}
+
+    LoopMonitorAction(LoopMonitorAction&&) = default;
+    LoopMonitorAction(const LoopMonitorAction&) = delete;
+
+    std::shared_ptr<Result_t> GetResultPtr() const { return result_m; }
+
+    void Initialize() { result_m->start = PhaseTimer::Sample::now(); }
+    void InitTask(TTreeReader*, unsigned int) {}
+
+    void Exec(unsigned int slot, ULong64_t) { ++slots_m[slot].entries; }
+
+    void Finalize() {
+        result_m->end = PhaseTimer::Sample::now();
+        result_m->slotEntries.clear();
+        for (const auto& slot : slots_m) {
+            result_m->slotEntries.push_back(slot.entries);
+        }
+    }
+
+    std::string GetActionName() const { return "LoopMonitor"; }
+
+private:
+    /// One cache line per slot, so that slots do not share counters.
+    struct alignas(64) SlotCount {
+        std::uint64_t entries = 0;
+    };
+    std::vector<SlotCount> slots_m;
+    std::shared_ptr<Result_t> result_m;
+};
+
+/// Block size of XXH3 file fingerprints.
+constexpr std::uint64_t kHashBlockSize = std::uint64_t(64) << 20;
+
+std::string hex64(std::uint64_t value) {
+    std::ostringstream out;
+    out << std::hex << std::setw(16) << std::setfill('0') << value;
+    return out.str();
+}
+
+/// "xxh3:<digest>" of @p path: one block is hashed directly, several are
+/// hashed in parallel and their digests hashed again, seeded with the size.
+std::string xxh3File(const std::string& path) {
+    const int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return "<not found>";
+    }
+    struct stat info {};
+    if (fstat(fd, &info) != 0) {
+        close(fd);
+        return "<not found>";
+    }
+    const auto size = static_cast<std::uint64_t>(info.st_size);
+    const std::uint64_t nBlocks = std::max<std::uint64_t>(1, (size + kHashBlockSize - 1) / kHashBlockSize);
+    std::vector<std::uint64_t> digests(nBlocks);
+    std::atomic<std::uint64_t> nextBlock{0};
+    std::atomic<bool> failed{false};
+    const auto worker = [&]() {
+        std::vector<char> buf(std::min(size, kHashBlockSize));
+        for (std::uint64_t block; (block = nextBlock++) < nBlocks;) {
+            const std::uint64_t offset = block * kHashBlockSize;
+            const std::uint64_t length = std::min(kHashBlockSize, size - offset);
+            std::uint64_t done = 0;
+            while (done < length) {
+                const ssize_t n = pread(fd, buf.data() + done, length - done,
+                                        static_cast<off_t>(offset + done));
+                if (n <= 0) {
+                    failed = true;
+                    return;
+                }
+                done += static_cast<std::uint64_t>(n);
+            }
+            digests[block] = XXH3_64bits(buf.data(), length);
+        }
+    };
+    const unsigned nThreads = static_cast<unsigned>(std::min<std::uint64_t>(
+        nBlocks, std::max(1u, std::min(8u, std::thread::hardware_concurrency()))));
+    std::vector<std::thread> threads;
+    for (unsigned i = 1; i < nThreads; ++i) {
+        threads.emplace_back(worker);
+    }
+    worker();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    close(fd);
+    if (failed) {
+        return "<not found>";
+    }
+    const std::uint64_t digest =
+        nBlocks == 1 ? digests[0]
+                     : XXH3_64bits_withSeed(digests.data(), digests.size() * sizeof(std::uint64_t), size);
+    return "xxh3:" + hex64(digest);
+}
+
+/**
+ * @brief Fingerprints memoized in a sidecar file, one tab-separated
+ *        "algorithm size mtime path digest" line per file.
+ *
+ * The file is read once per process; every new fingerprint is merged with
+ * the entries other jobs wrote meanwhile and written back atomically.
+ */
+class FileHashCache {
+public:
+    struct Key {
+        std::string path;
+        std::uintmax_t size;
+        std::int64_t mtime;
+        std::string algorithm;
+    };
+
+    static FileHashCache& get(const std::string& file) {
+        static std::mutex mutex;
+        static std::map<std::string, std::unique_ptr<FileHashCache>> caches;
+        std::lock_guard<std::mutex> lock(mutex);
+        auto& cache = caches[file];
+        if (!cache) {
+            cache.reset(new FileHashCache(file));
+        }
+        return *cache;
+    }
+
+    std::optional<std::string> find(const Key& key) {
+        std::lock_guard<std::mutex> lock(mutex_m);
+        auto it = entries_m.find(entryKey(key));
+        if (it == entries_m.end()) {
+            return std::nullopt;
+        }
+        return it->second;
+    }
+
+    void store(const Key& key, const std::string& digest) {
+        std::lock_guard<std::mutex> lock(mutex_m);
+        load();
+        entries_m[entryKey(key)] = digest;
+        const std::filesystem::path parent = std::filesystem::path(file_m).parent_path();
+        std::error_code ec;
+        if (!parent.empty()) {
+            std::filesystem::create_directories(parent, ec);
+        }
+        // A cache that cannot be written only costs the hashing next time.
+        const std::string tmpPath = file_m + ".tmp." + std::to_string(getpid());
+        {
+            std::ofstream out(tmpPath);
+            if (!out) {
+                return;
+            }
+            for (const auto& [k, v] : entries_m) {
+                out << k << '\t' << v << '\n';
+            }
+        }
+        std::filesystem::rename(tmpPath, file_m, ec);
+        if (ec) {
+            std::filesystem::remove(tmpPath, ec);
+        }
+    }
+
+private:
+    explicit FileHashCache(std::string file) : file_m(std::move(file)) { load(); }
+
+    /// "algorithm size mtime" + path, the line without its digest.
+    static std::string entryKey(const Key& key) {
+        return key.algorithm + '\t' + std::to_string(key.size) + '\t' +
+               std::to_string(key.mtime) + '\t' + key.path;
+    }
+
+    void load() {
+        std::ifstream in(file_m);
+        std::string line;
+        while (std::getline(in, line)) {
+            // Lines of paths containing tabs are ignored.
+            const auto tab = line.rfind('\t');
+            if (tab == std::string::npos || std::count(line.begin(), line.end(), '\t') != 4) {
+                continue;
+            }
+            entries_m.emplace(line.substr(0, tab), line.substr(tab + 1));
+        }
+    }
+
+    std::string file_m;
+    std::mutex mutex_m;
+    std::map<std::string, std::string> entries_m;
+};
+
+std::string formatFixed(double value, int precision) {
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(precision) << value;
+    return out.str();
+}
+
+} // namespace
+
 // ---------------------------------------------------------------------------
 // Static helpers
 // ---------------------------------------------------------------------------
@@ -54,16 +278,20 @@ std::string ProvenanceService::hashString(const std::string& data) {
     return std::string(md5.AsString());
 }
 
-std::string ProvenanceService::hashFile(const std::string& path) {
+std::string ProvenanceService::computeFileHash(const std::string& path,
+                                               HashAlgorithm algorithm) {
     if (path.empty()) {
         return "<empty path>";
     }
+    if (algorithm == HashAlgorithm::XXH3) {
+        return xxh3File(path);
+    }
     std::ifstream file(path, std::ios::binary);
     if (!file.is_open()) {
         return "<not found>";
     }
     TMD5 md5;
-    std::array<char, 8192> buf{};
+    std::array<char, 1 << 16> buf{};
     while (file.read(buf.data(), static_cast<std::streamsize>(buf.size()))) {
         md5.Update(reinterpret_cast<const UChar_t*>(buf.data()),
                    static_cast<UInt_t>(file.gcount()));
@@ -76,6 +304,30 @@ std::string ProvenanceService::hashFile(const std::string& path) {
     return std::string(md5.AsString());
 }
 
+std::string ProvenanceService::hashFile(const std::string& path, HashAlgorithm algorithm,
+                                        const std::string& cacheFile) {
+    namespace fs = std::filesystem;
+    std::error_code ec;
+    const auto size = fs::file_size(path, ec);
+    const auto mtime = ec ? fs::file_time_type{} : fs::last_write_time(path, ec);
+    if (cacheFile.empty() || ec) {
+        return computeFileHash(path, algorithm);
+    }
+
+    FileHashCache::Key key{fs::absolute(path).lexically_normal().string(), size,
+                           static_cast<std::int64_t>(mtime.time_since_epoch().count()),
+                           algorithm == HashAlgorithm::XXH3 ? "xxh3" : "md5"};
+    auto& cache = FileHashCache::get(cacheFile);
+    if (auto digest = cache.find(key)) {
+        return *digest;
+    }
+    std::string digest = computeFileHash(path, algorithm);
+    if (digest.front() != '<') {
+        cache.store(key, digest);
+    }
+    return digest;
+}
+
 std::string ProvenanceService::serializeConfigMap(
     const std::unordered_map<std::string, std::string>& configMap) {
     // Sort by key for deterministic output
@@ -120,6 +372,15 @@ void ProvenanceService::initialize(ManagerContext& ctx) {
 
     collectBuildInfo();
     collectRuntimeInfo(ctx.config);
+
+    bytesReadAtStart_m = TFile::GetFileBytesRead();
+    readCallsAtStart_m = TFile::GetFileReadCalls();
+    startTime_m = std::chrono::steady_clock::now();
+
+    // Booked before any filter, so that every entry of the loop is counted.
+    auto df = ctx.data.getDataFrame();
+    loopStatistics_m =
+        df.Book<ULong64_t>(LoopMonitorAction(df.GetNSlots()), {"rdfentry_"});
 }
 
 void ProvenanceService::finalize(ROOT::RDF::RNode& /*df*/) {
@@ -127,6 +388,9 @@ void ProvenanceService::finalize(ROOT::RDF::RNode& /*df*/) {
         return;
     }
 
+    collectReadStatistics();
+    collectLoopStatistics();
+
     // Resolve the meta output file path
     const std::string fileName =
         ctx_m->metaSink.resolveOutputFile(ctx_m->config, OutputChannel::Meta);
@@ -193,10 +457,78 @@ ProvenanceService::getProvenance() const {
     return provenance_m;
 }
 
+void ProvenanceService::recordPhase(const std::string& name, double wallSeconds,
+                                    double cpuSeconds) {
+    provenance_m["timing." + name + ".wall_s"] = formatFixed(wallSeconds, 3);
+    provenance_m["timing." + name + ".cpu_s"] = formatFixed(cpuSeconds, 3);
+}
+
+void ProvenanceService::markEventLoopTrigger() {
+    loopTrigger_m = PhaseTimer::Sample::now();
+    loopTriggerMarked_m = true;
+}
+
 // ---------------------------------------------------------------------------
 // Private helpers
 // ---------------------------------------------------------------------------
 
+void ProvenanceService::collectReadStatistics() {
+    const Long64_t bytesRead = TFile::GetFileBytesRead() - bytesReadAtStart_m;
+    const Int_t readCalls = TFile::GetFileReadCalls() - readCallsAtStart_m;
+    const double elapsed = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - startTime_m).count();
+
+    provenance_m["io.bytes_read"] = std::to_string(bytesRead);
+    provenance_m["io.read_calls"] = std::to_string(readCalls);
+    std::ostringstream rate;
+    rate << std::fixed << std::setprecision(3)
+         << (elapsed > 0.0 ? static_cast<double>(bytesRead) / 1.0e6 / elapsed : 0.0);
+    provenance_m["io.read_rate_mb_s"] = rate.str();
+}
+
+void ProvenanceService::collectLoopStatistics() {
+    provenance_m["memory.peak_rss_mb"] =
+        formatFixed(PhaseTimer::peakRssMegabytes(), 1);
+
+    // Never start the event loop from here: a job that did not run it has
+    // no loop statistics.
+    if (!loopStatistics_m || !loopStatistics_m.IsReady()) {
+        return;
+    }
+    const LoopStatistics& loop = *loopStatistics_m;
+    const auto recordSpan = [this](const std::string& name,
+                                   const PhaseTimer::Sample& begin,
+                                   const PhaseTimer::Sample& end) {
+        const double wall =
+            std::chrono::duration<double>(end.wall - begin.wall).count();
+        recordPhase(name, wall, end.cpuSeconds - begin.cpuSeconds);
+        return wall;
+    };
+    if (loopTriggerMarked_m) {
+        recordSpan("jit", loopTrigger_m, loop.start);
+    }
+    const double loopSeconds = recordSpan("event_loop", loop.start, loop.end);
+
+    std::uint64_t events = 0;
+    std::uint64_t busiest = 0;
+    std::string slotEntries;
+    for (const std::uint64_t entries : loop.slotEntries) {
+        events += entries;
+        busiest = std::max(busiest, entries);
+        slotEntries += (slotEntries.empty() ? "" : ",") + std::to_string(entries);
+    }
+    provenance_m["throughput.events"] = std::to_string(events);
+    provenance_m["throughput.events_per_s"] = formatFixed(
+        loopSeconds > 0.0 ? static_cast<double>(events) / loopSeconds : 0.0,
+        1);
+    provenance_m["executor.slot_entries"] = slotEntries;
+    const double mean = loop.slotEntries.empty()
+        ? 0.0
+        : static_cast<double>(events) / static_cast<double>(loop.slotEntries.size());
+    provenance_m["executor.load_imbalance"] =
+        formatFixed(mean > 0.0 ? static_cast<double>(busiest) / mean : 1.0, 3);
+}
+
 void ProvenanceService::collectBuildInfo() {
     // Values injected by CMake via GitVersion.h
     provenance_m["framework.git_hash"]        = RDFANALYZER_GIT_HASH;
@@ -235,24 +567,93 @@ void ProvenanceService::collectRuntimeInfo(const IConfigurationProvider& config)
     }
     provenance_m["env.container_tag"] = containerTag;
 
+    // -----------------------------------------------------------------------
+    // Host and grid site, to aggregate throughput per site
+    // -----------------------------------------------------------------------
+    std::array<char, 256> hostname{};
+    provenance_m["env.hostname"] =
+        gethostname(hostname.data(), hostname.size() - 1) == 0 ? hostname.data()
+                                                               : "unknown";
+    std::string site = "unknown";
+    for (const char* var : {"CMS_LOCAL_SITE", "GLIDEIN_CMSSite", "OSG_SITE_NAME",
+                            "SITE_NAME"}) {
+        const char* val = std::getenv(var);
+        if (val && *val) {
+            site = val;
+            break;
+        }
+    }
+    provenance_m["env.site"] = site;
+
     // -----------------------------------------------------------------------
     // ROOT implicit MT thread pool size
     // -----------------------------------------------------------------------
     provenance_m["executor.num_threads"] =
         std::to_string(ROOT::GetThreadPoolSize());
 
+    // -----------------------------------------------------------------------
+    // Task granularity, basket decompression and plugin thread pool
+    // -----------------------------------------------------------------------
+    provenance_m["executor.tasks_per_worker"] =
+        std::to_string(ROOT::TTreeProcessorMT::GetTasksPerWorkerHint());
+    const std::string minEntries = config.get("minEntriesPerTask");
+    provenance_m["executor.min_entries_per_task"] =
+        minEntries.empty() ? "default" : minEntries;
+    provenance_m["executor.parallel_unzip"] =
+        TTreeCacheUnzip::IsParallelUnzip() ? "true" : "false";
+    const std::string pluginPool = config.get("pluginThreadPool");
+    provenance_m["executor.plugin_thread_pool"] =
+        pluginPool.empty() ? "separate" : pluginPool;
+
+    // -----------------------------------------------------------------------
+    // Input read-ahead settings (see configureTreeReadAhead())
+    // -----------------------------------------------------------------------
+    for (const char* key : {"treeCacheSize", "treeCacheSizeFactor",
+                            "treeCacheLearnEntries", "treeCachePrefetch",
+                            "asyncOpenFiles"}) {
+        const std::string value = config.get(key);
+        provenance_m[std::string("io.") + key] = value.empty() ? "default" : value;
+    }
+
     // -----------------------------------------------------------------------
     // Configuration hash (deterministic serialisation of the config map)
     // -----------------------------------------------------------------------
     const auto& configMap = config.getConfigMap();
     provenance_m["config.hash"] = hashString(serializeConfigMap(configMap));
 
+    // -----------------------------------------------------------------------
+    // Dataset name, to aggregate throughput per dataset
+    // -----------------------------------------------------------------------
+    std::string dataset = "unknown";
+    for (const char* key : {"sample", "name", "sample_type", "type", "process"}) {
+        const std::string value = config.get(key);
+        if (!value.empty()) {
+            dataset = value;
+            break;
+        }
+    }
+    provenance_m["dataset.name"] = dataset;
+
+    // -----------------------------------------------------------------------
+    // File fingerprints: XXH3 unless provenanceHashAlgorithm=md5, memoized in
+    // provenanceHashCache when set.
+    // -----------------------------------------------------------------------
+    const std::string algorithmName = config.get("provenanceHashAlgorithm");
+    if (!algorithmName.empty() && algorithmName != "xxh3" && algorithmName != "md5") {
+        throw std::runtime_error("ProvenanceService: invalid provenanceHashAlgorithm '" +
+                                 algorithmName + "'; expected xxh3 or md5");
+    }
+    const HashAlgorithm hashAlgorithm =
+        algorithmName == "md5" ? HashAlgorithm::MD5 : HashAlgorithm::XXH3;
+    const std::string hashCache = config.get("provenanceHashCache");
+    provenance_m["file.hash_algorithm"] = hashAlgorithm == HashAlgorithm::MD5 ? "md5" : "xxh3";
+
     // -----------------------------------------------------------------------
     // File-list hash (the file referenced by "fileList")
     // -----------------------------------------------------------------------
     const auto fileListIt = configMap.find("fileList");
     if (fileListIt != configMap.end() && !fileListIt->second.empty()) {
-        provenance_m["filelist.hash"] = hashFile(fileListIt->second);
+        provenance_m["filelist.hash"] = hashFile(fileListIt->second, hashAlgorithm, hashCache);
     }
 
     // -----------------------------------------------------------------------
@@ -260,15 +661,15 @@ void ProvenanceService::collectRuntimeInfo(const IConfigurationProvider& config)
     // (model files, correction files, etc.)
     // Skip well-known output or already-handled keys.
     // -----------------------------------------------------------------------
-    static const std::array<const char*, 4> kSkipKeys = {
-        "saveFile", "metaFile", "fileList", "saveConfig"};
+    static const std::array<const char*, 5> kSkipKeys = {
+        "saveFile", "metaFile", "fileList", "saveConfig", "provenanceHashCache"};
     for (const auto& [key, value] : configMap) {
         bool skip = false;
         for (const char* sk : kSkipKeys) {
             if (key == sk) { skip = true; break; }
         }
         if (!skip && looksLikeFilePath(value)) {
-            provenance_m["file.hash." + key] = hashFile(value);
+            provenance_m["file.hash." + key] = hashFile(value, hashAlgorithm, hashCache);
         }
     }
 }
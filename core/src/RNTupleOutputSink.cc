@@ -0,0 +1,47 @@
+#include <RNTupleOutputSink.h>
+#include <api/IConfigurationProvider.h>
+#include <memory>
+#include <stdexcept>
+#include <ROOT/RSnapshotOptions.hxx>
+
+RNTupleOutputSink::RNTupleOutputSink(
+    ROOT::RCompressionSetting::EAlgorithm::EValues algorithm, int level)
+    : algorithm_m(algorithm), level_m(level) {
+  if (level_m < 0 || level_m > 9) {
+    throw std::invalid_argument(
+        "RNTupleOutputSink: compression level must be between 0 and 9");
+  }
+}
+
+std::unique_ptr<RNTupleOutputSink>
+RNTupleOutputSink::fromConfig(const IConfigurationProvider& configProvider) {
+  auto algorithm = ROOT::RCompressionSetting::EAlgorithm::kZSTD;
+  const std::string algorithmName = configProvider.get("rntupleCompression");
+  if (!algorithmName.empty()) {
+    algorithm = parseCompressionAlgorithm(algorithmName);
+  }
+
+  int level = 5;
+  const std::string levelStr = configProvider.get("rntupleCompressionLevel");
+  if (!levelStr.empty()) {
+    try {
+      level = std::stoi(levelStr);
+    } catch (const std::exception&) {
+      throw std::runtime_error("RNTupleOutputSink: invalid rntupleCompressionLevel '" +
+                               levelStr + "'");
+    }
+  }
+  return std::make_unique<RNTupleOutputSink>(algorithm, level);
+}
+
+ROOT::RDF::RSnapshotOptions RNTupleOutputSink::makeSnapshotOptions() const {
+#if defined(HAS_RNTUPLE_SNAPSHOT)
+  ROOT::RDF::RSnapshotOptions options;
+  options.fOutputFormat = ROOT::RDF::ESnapshotOutputFormat::kRNTuple;
+  options.fCompressionAlgorithm = algorithm_m;
+  options.fCompressionLevel = level_m;
+  return options;
+#else
+  throw std::runtime_error("RNTupleOutputSink: RNTuple output requires ROOT 6.36 or newer");
+#endif
+}
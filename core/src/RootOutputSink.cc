@@ -1,12 +1,24 @@
 #include <RootOutputSink.h>
+#include <AsyncLogger.h>
 #include <api/IConfigurationProvider.h>
 #include <api/IDataFrameProvider.h>
 #include <api/ISystematicManager.h>
 #include <filesystem>
+#include <cstdint>
 #include <fnmatch.h>
+#include <functions.h>
 #include <iostream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <type_traits>
+#include <unordered_map>
 #include <unordered_set>
+#include <utility>
 #include <ROOT/RSnapshotOptions.hxx>
+#include <TBranch.h>
+#include <TFile.h>
+#include <TTree.h>
 
 static std::string makeMetaFileName(const std::string& saveFile) {
   if (saveFile.empty()) {
@@ -52,6 +64,228 @@ static std::vector<std::string> parseSaveColumns(const IConfigurationProvider& c
   return saveVector;
 }
 
+/// Storage hints of one saveConfig line: "<pattern> [type=<t>] [mantissa=<n>|float16] [bits]".
+struct StorageHint {
+  std::string pattern;
+  std::string type;
+  int mantissaBits = 0;
+  bool bits = false;
+};
+
+static std::vector<StorageHint> parseStorageHints(const IConfigurationProvider& configProvider) {
+  const auto& configMap = configProvider.getConfigMap();
+  auto it = configMap.find("saveConfig");
+  if (it == configMap.end()) {
+    return {};
+  }
+  std::vector<StorageHint> hints;
+  for (const auto& line : configProvider.parseVectorConfig(it->second)) {
+    std::istringstream tokens(line.substr(0, line.find('#')));
+    StorageHint hint;
+    tokens >> hint.pattern;
+    bool hasHint = false;
+    for (std::string token; tokens >> token;) {
+      hasHint = true;
+      if (token.rfind("type=", 0) == 0) {
+        hint.type = token.substr(5);
+      } else if (token.rfind("mantissa=", 0) == 0) {
+        try {
+          hint.mantissaBits = std::stoi(token.substr(9));
+        } catch (const std::exception&) {
+          hint.mantissaBits = -1;
+        }
+        if (hint.mantissaBits < 1 || hint.mantissaBits > 23) {
+          throw std::runtime_error("RootOutputSink: saveConfig hint '" + token +
+                                   "' must keep 1 to 23 mantissa bits");
+        }
+      } else if (token == "float16") {
+        hint.mantissaBits = 10;
+      } else if (token == "bits") {
+        hint.bits = true;
+      } else {
+        throw std::runtime_error("RootOutputSink: unknown saveConfig hint '" + token +
+                                 "' for '" + hint.pattern + "'");
+      }
+    }
+    if (hasHint) {
+      hints.push_back(std::move(hint));
+    }
+  }
+  return hints;
+}
+
+namespace {
+
+template <typename T> struct TypeTag {
+  using type = T;
+};
+
+/// Call @p f with the TypeTag of the arithmetic column type @p name.
+template <typename F> bool visitArithmeticType(const std::string& name, F&& f) {
+  if (name == "float" || name == "Float_t") {
+    f(TypeTag<float>{});
+  } else if (name == "double" || name == "Double_t") {
+    f(TypeTag<double>{});
+  } else if (name == "int" || name == "Int_t") {
+    f(TypeTag<int>{});
+  } else if (name == "unsigned int" || name == "UInt_t") {
+    f(TypeTag<unsigned int>{});
+  } else if (name == "short" || name == "Short_t") {
+    f(TypeTag<short>{});
+  } else if (name == "unsigned short" || name == "UShort_t") {
+    f(TypeTag<unsigned short>{});
+  } else if (name == "char" || name == "Char_t") {
+    f(TypeTag<char>{});
+  } else if (name == "unsigned char" || name == "UChar_t") {
+    f(TypeTag<unsigned char>{});
+  } else if (name == "long long" || name == "Long64_t") {
+    f(TypeTag<Long64_t>{});
+  } else if (name == "unsigned long long" || name == "ULong64_t") {
+    f(TypeTag<ULong64_t>{});
+  } else if (name == "long" || name == "Long_t") {
+    f(TypeTag<long>{});
+  } else if (name == "unsigned long" || name == "ULong_t") {
+    f(TypeTag<unsigned long>{});
+  } else {
+    return false;
+  }
+  return true;
+}
+
+/// Call @p f with the TypeTag of a ``type=`` hint target.
+template <typename F> bool visitNarrowTarget(const std::string& name, F&& f) {
+  if (name == "int8") {
+    f(TypeTag<std::int8_t>{});
+  } else if (name == "uint8") {
+    f(TypeTag<std::uint8_t>{});
+  } else if (name == "int16") {
+    f(TypeTag<std::int16_t>{});
+  } else if (name == "uint16") {
+    f(TypeTag<std::uint16_t>{});
+  } else if (name == "int32") {
+    f(TypeTag<std::int32_t>{});
+  } else if (name == "uint32") {
+    f(TypeTag<std::uint32_t>{});
+  } else if (name == "float") {
+    f(TypeTag<float>{});
+  } else {
+    return false;
+  }
+  return true;
+}
+
+/// Element type of an RVec column type, or empty for scalars.
+std::string rvecElementType(const std::string& type) {
+  for (const std::string prefix : {"ROOT::VecOps::RVec<", "ROOT::RVec<", "RVec<"}) {
+    if (type.size() > prefix.size() && type.rfind(prefix, 0) == 0 && type.back() == '>') {
+      return type.substr(prefix.size(), type.size() - prefix.size() - 1);
+    }
+  }
+  return "";
+}
+
+/// Convert @p value, throwing if an integer target cannot hold it exactly.
+template <typename To, typename From> To narrowValue(From value, const std::string& column) {
+  const To narrowed = static_cast<To>(value);
+  if constexpr (std::is_integral_v<To>) {
+    if (static_cast<From>(narrowed) != value || (value < From{}) != (narrowed < To{})) {
+      throw std::runtime_error("RootOutputSink: value of '" + column +
+                               "' does not fit its saveConfig type hint");
+    }
+  }
+  return narrowed;
+}
+
+template <typename From, typename To>
+ROOT::RDF::RNode redefineNarrowed(ROOT::RDF::RNode df, const std::string& column, bool vector) {
+  if (vector) {
+    return df.Redefine(
+        column,
+        [column](const ROOT::VecOps::RVec<From>& values) {
+          ROOT::VecOps::RVec<To> out(values.size());
+          for (std::size_t i = 0; i < values.size(); ++i) {
+            out[i] = narrowValue<To>(values[i], column);
+          }
+          return out;
+        },
+        {column});
+  }
+  return df.Redefine(
+      column, [column](From value) { return narrowValue<To>(value, column); }, {column});
+}
+
+} // namespace
+
+/**
+ * Redefine the columns written by @p spec according to the saveConfig
+ * storage hints.  Snapshot writes the redefined types, so the narrowed
+ * columns keep their names.
+ */
+static ROOT::RDF::RNode applyStorageHints(ROOT::RDF::RNode df,
+                                          const IConfigurationProvider& configProvider,
+                                          const OutputSpec& spec) {
+  const auto hints = parseStorageHints(configProvider);
+  if (hints.empty()) {
+    return df;
+  }
+  const auto columns = spec.columns.empty() ? df.GetColumnNames() : spec.columns;
+  for (const auto& column : columns) {
+    for (const auto& hint : hints) {
+      if (fnmatch(hint.pattern.c_str(), column.c_str(), 0) != 0) {
+        continue;
+      }
+      std::string type = df.GetColumnType(column);
+      std::string element = rvecElementType(type);
+      const bool vector = !element.empty();
+      auto unsupported = [&](const std::string& what) {
+        return std::runtime_error("RootOutputSink: saveConfig hint " + what +
+                                  " is not supported for '" + column + "' of type " + type);
+      };
+
+      if (!hint.type.empty()) {
+        bool narrowed = false;
+        visitArithmeticType(vector ? element : type, [&](auto from) {
+          visitNarrowTarget(hint.type, [&](auto to) {
+            using From = typename decltype(from)::type;
+            using To = typename decltype(to)::type;
+            df = redefineNarrowed<From, To>(df, column, vector);
+            narrowed = true;
+          });
+        });
+        if (!narrowed) {
+          throw unsupported("type=" + hint.type);
+        }
+        type = df.GetColumnType(column);
+        element = rvecElementType(type);
+      }
+      if (hint.mantissaBits > 0) {
+        const int bits = hint.mantissaBits;
+        if ((vector ? element : type) != "float" && (vector ? element : type) != "Float_t") {
+          throw unsupported("mantissa");
+        }
+        if (vector) {
+          df = df.Redefine(
+              column,
+              [bits](const ROOT::VecOps::RVec<float>& values) {
+                return ROOT::VecOps::Map(values, [bits](float v) { return truncateMantissa(v, bits); });
+              },
+              {column});
+        } else {
+          df = df.Redefine(column, [bits](float v) { return truncateMantissa(v, bits); }, {column});
+        }
+      }
+      if (hint.bits) {
+        if (!vector || (element != "bool" && element != "Bool_t")) {
+          throw unsupported("bits");
+        }
+        df = df.Redefine(column, packBits, {column});
+      }
+      break; // the first matching line with hints wins
+    }
+  }
+  return df;
+}
+
 static void expandSystematicColumns(std::vector<std::string>& columns,
                                     const ISystematicManager* systematicManager) {
   if (!systematicManager) {
@@ -67,7 +301,195 @@ static void expandSystematicColumns(std::vector<std::string>& columns,
   }
 }
 
-void RootOutputSink::writeDataFrame(ROOT::RDF::RNode& df, const OutputSpec& spec) {
+static int parseSnapshotInt(const std::unordered_map<std::string, std::string>& entry,
+                            const std::string& key, int defaultValue) {
+  auto it = entry.find(key);
+  if (it == entry.end() || it->second.empty()) {
+    return defaultValue;
+  }
+  try {
+    return std::stoi(it->second);
+  } catch (const std::exception&) {
+    throw std::runtime_error("RootOutputSink: invalid snapshotOptions " + key +
+                             " '" + it->second + "'");
+  }
+}
+
+static std::vector<std::string> splitPatterns(const std::string& value) {
+  std::vector<std::string> patterns;
+  std::size_t start = 0;
+  while (start <= value.size()) {
+    const auto end = value.find(',', start);
+    std::string pattern = value.substr(start, end == std::string::npos ? std::string::npos : end - start);
+    pattern.erase(0, pattern.find_first_not_of(" \t"));
+    pattern.erase(pattern.find_last_not_of(" \t") + 1);
+    if (!pattern.empty()) {
+      patterns.push_back(pattern);
+    }
+    if (end == std::string::npos) {
+      break;
+    }
+    start = end + 1;
+  }
+  return patterns;
+}
+
+static void validateCompressionLevel(int level) {
+  if (level < 0 || level > 9) {
+    throw std::runtime_error(
+        "RootOutputSink: compression level must be between 0 and 9");
+  }
+}
+
+/**
+ * Rewrite the staged snapshot into the final output file, applying the
+ * per-column compression overrides. TTree::CloneTree copies the branch
+ * compression settings of the source, so setting them on the staged tree and
+ * cloning without the "fast" option recompresses each branch with its own
+ * algorithm.
+ */
+static void rewriteWithColumnCompression(const std::string& stagingFile,
+                                         const OutputSpec& spec,
+                                         const SnapshotSettings& settings) {
+  std::unique_ptr<TFile> input(TFile::Open(stagingFile.c_str(), "READ"));
+  if (!input || input->IsZombie()) {
+    throw std::runtime_error("RootOutputSink: cannot reopen staged snapshot " + stagingFile);
+  }
+  auto* tree = input->Get<TTree>(spec.treeName.c_str());
+  if (!tree) {
+    throw std::runtime_error("RootOutputSink: staged snapshot has no tree " + spec.treeName);
+  }
+  for (auto* obj : *tree->GetListOfBranches()) {
+    auto* branch = static_cast<TBranch*>(obj);
+    for (const auto& columnOverride : settings.columnCompression) {
+      if (fnmatch(columnOverride.pattern.c_str(), branch->GetName(), 0) == 0) {
+        branch->SetCompressionSettings(
+            ROOT::CompressionSettings(columnOverride.algorithm, columnOverride.level));
+        break;
+      }
+    }
+  }
+
+  TFile output(spec.outputFile.c_str(), "RECREATE", "",
+               ROOT::CompressionSettings(settings.compressionAlgorithm,
+                                         settings.compressionLevel));
+  if (output.IsZombie()) {
+    throw std::runtime_error("RootOutputSink: cannot create " + spec.outputFile);
+  }
+  TTree* clone = tree->CloneTree(-1, "");
+  if (!clone) {
+    throw std::runtime_error("RootOutputSink: failed to clone " + spec.treeName);
+  }
+  clone->Write();
+  output.Close();
+  input->Close();
+  std::filesystem::remove(stagingFile);
+}
+
+RootOutputSink::RootOutputSink(SnapshotSettings settings)
+    : settings_m(std::move(settings)) {
+  validateCompressionLevel(settings_m.compressionLevel);
+  for (const auto& columnOverride : settings_m.columnCompression) {
+    validateCompressionLevel(columnOverride.level);
+  }
+}
+
+ROOT::RCompressionSetting::EAlgorithm::EValues
+RootOutputSink::parseCompressionAlgorithm(const std::string& name) {
+  using EAlgorithm = ROOT::RCompressionSetting::EAlgorithm;
+  if (name == "zstd") {
+    return EAlgorithm::kZSTD;
+  }
+  if (name == "lz4") {
+    return EAlgorithm::kLZ4;
+  }
+  if (name == "lzma") {
+    return EAlgorithm::kLZMA;
+  }
+  if (name == "zlib") {
+    return EAlgorithm::kZLIB;
+  }
+  throw std::runtime_error("RootOutputSink: invalid compression '" + name +
+                           "'. Valid values are 'zstd', 'lz4', 'lzma' or 'zlib'.");
+}
+
+SnapshotSettings
+RootOutputSink::snapshotSettingsFromConfig(const IConfigurationProvider& configProvider,
+                                           OutputChannel channel) {
+  SnapshotSettings settings;
+  const std::string optionsFile = configProvider.get("snapshotOptions");
+  if (optionsFile.empty()) {
+    return settings;
+  }
+
+  const std::string channelName = channel == OutputChannel::Meta ? "meta" : "skim";
+  const auto entries = configProvider.parseMultiKeyConfig(optionsFile, {"channel"});
+  bool channelEntrySeen = false;
+  std::vector<std::unordered_map<std::string, std::string>> columnEntries;
+  for (const auto& entry : entries) {
+    const std::string& entryChannel = entry.at("channel");
+    if (entryChannel != "skim" && entryChannel != "meta") {
+      throw std::runtime_error("RootOutputSink: invalid snapshotOptions channel '" +
+                               entryChannel + "'. Valid values are 'skim' or 'meta'.");
+    }
+    if (entryChannel != channelName) {
+      continue;
+    }
+    if (entry.count("columns")) {
+      columnEntries.push_back(entry);
+      continue;
+    }
+    if (channelEntrySeen) {
+      throw std::runtime_error("RootOutputSink: snapshotOptions has more than one '" +
+                               channelName + "' entry without columns");
+    }
+    channelEntrySeen = true;
+
+    auto compressionIt = entry.find("compression");
+    if (compressionIt != entry.end()) {
+      settings.compressionAlgorithm = parseCompressionAlgorithm(compressionIt->second);
+    }
+    settings.compressionLevel = parseSnapshotInt(entry, "level", settings.compressionLevel);
+    settings.autoFlush = parseSnapshotInt(entry, "autoFlush", settings.autoFlush);
+    settings.splitLevel = parseSnapshotInt(entry, "splitLevel", settings.splitLevel);
+    settings.basketSize = parseSnapshotInt(entry, "basketSize", settings.basketSize);
+  }
+
+  // Column overrides inherit the channel level, so resolve them last.
+  for (const auto& entry : columnEntries) {
+    auto compressionIt = entry.find("compression");
+    if (compressionIt == entry.end()) {
+      throw std::runtime_error("RootOutputSink: snapshotOptions column entry '" +
+                               entry.at("columns") + "' requires a compression");
+    }
+    const auto algorithm = parseCompressionAlgorithm(compressionIt->second);
+    const int level = parseSnapshotInt(entry, "level", settings.compressionLevel);
+    for (const auto& pattern : splitPatterns(entry.at("columns"))) {
+      settings.columnCompression.push_back({pattern, algorithm, level});
+    }
+  }
+  return settings;
+}
+
+ROOT::RDF::RSnapshotOptions RootOutputSink::makeSnapshotOptions() const {
+  ROOT::RDF::RSnapshotOptions options;
+  options.fCompressionAlgorithm = settings_m.compressionAlgorithm;
+  options.fCompressionLevel = settings_m.compressionLevel;
+  options.fAutoFlush = settings_m.autoFlush;
+  options.fSplitLevel = settings_m.splitLevel;
+  if (settings_m.basketSize > 0) {
+#if defined(HAS_SNAPSHOT_BASKET_SIZE)
+    options.fBasketSize = settings_m.basketSize;
+#else
+    RDF_LOG_WARN << "Warning: snapshotOptions basketSize requires ROOT 6.34 or newer; "
+                    "using the TTree default.";
+#endif
+  }
+  return options;
+}
+
+RootOutputSink::PendingSnapshot
+RootOutputSink::bookSnapshot(ROOT::RDF::RNode& df, const OutputSpec& spec, bool lazy) {
   if (spec.outputFile.empty()) {
     throw std::runtime_error("RootOutputSink: outputFile is empty");
   }
@@ -75,33 +497,176 @@ void RootOutputSink::writeDataFrame(ROOT::RDF::RNode& df, const OutputSpec& spec
     throw std::runtime_error("RootOutputSink: treeName is empty");
   }
 
-  std::cout << "Executing Snapshot" << std::endl;
-  std::cout << "Tree: " << spec.treeName << std::endl;
-  std::cout << "SaveFile: " << spec.outputFile << std::endl;
+  RDF_LOG_INFO << (lazy ? "Booking Snapshot" : "Executing Snapshot");
+  RDF_LOG_INFO << "Tree: " << spec.treeName;
+  RDF_LOG_INFO << "SaveFile: " << spec.outputFile;
 
   const std::filesystem::path outputPath(spec.outputFile);
   if (outputPath.has_parent_path()) {
     std::filesystem::create_directories(outputPath.parent_path());
   }
 
-  ROOT::RDF::RSnapshotOptions options;
-  options.fCompressionAlgorithm = ROOT::RCompressionSetting::EAlgorithm::kZSTD;
-  options.fCompressionLevel = 5;  // 505 ZSTD compression level, good balance between speed and size
+  ROOT::RDF::RSnapshotOptions options = makeSnapshotOptions();
+  options.fLazy = lazy;
+
+  // Snapshot applies one compression setting to the whole file, so per-column
+  // overrides are written to a staging file and recompressed branch by branch.
+  PendingSnapshot pending{spec,
+                          settings_m.columnCompression.empty()
+                              ? spec.outputFile
+                              : spec.outputFile + ".staging",
+                          {}};
 
   if (spec.columns.empty()) {
-    df.Snapshot(spec.treeName, spec.outputFile, ".*", options);
+    pending.result = df.Snapshot(spec.treeName, pending.snapshotFile, ".*", options);
   } else {
-    df.Snapshot(spec.treeName, spec.outputFile, spec.columns, options);
+    pending.result = df.Snapshot(spec.treeName, pending.snapshotFile, spec.columns, options);
   }
+  return pending;
+}
 
-  std::cout << "Done Saving" << std::endl;
+void RootOutputSink::completeSnapshot(PendingSnapshot& pending) {
+  // Runs the event loop only if the lazy Snapshot has not been executed yet.
+  pending.result.GetValue();
+  if (pending.snapshotFile != pending.spec.outputFile) {
+    rewriteWithColumnCompression(pending.snapshotFile, pending.spec, settings_m);
+  }
+  auto friendIt = pendingFriends_m.find(pending.spec.outputFile);
+  if (friendIt != pendingFriends_m.end()) {
+    const std::string friendConfig = pending.spec.outputFile + ".friend.yaml";
+    writeFriendTreeConfig(friendConfig, {friendIt->second});
+    RDF_LOG_INFO << "Friend tree config: " << friendConfig;
+    pendingFriends_m.erase(friendIt);
+  }
+  auto manifestIt = pendingManifests_m.find(pending.spec.outputFile);
+  if (manifestIt != pendingManifests_m.end()) {
+    manifestIt->second.write(SkimColumnManifest::pathFor(pending.spec.outputFile));
+    pendingManifests_m.erase(manifestIt);
+  }
+  RDF_LOG_INFO << "Done Saving " << pending.spec.outputFile;
 }
 
-void RootOutputSink::writeDataFrame(ROOT::RDF::RNode& df,
-                                    const IConfigurationProvider& configProvider,
-                                    const IDataFrameProvider*,
-                                    const ISystematicManager* systematicManager,
-                                    OutputChannel channel) {
+std::vector<std::string>
+RootOutputSink::applyFriendMode(ROOT::RDF::RNode& df,
+                                const IConfigurationProvider& configProvider,
+                                const std::string& outputFile, const std::string& treeName,
+                                std::vector<std::string> columns) {
+  const std::string format = configProvider.get("skimOutputFormat");
+  if (!format.empty() && format != "root") {
+    throw std::runtime_error("RootOutputSink: skimFriendMode requires skimOutputFormat=root");
+  }
+  const auto definedNames = df.GetDefinedColumnNames();
+  const std::unordered_set<std::string> defined(definedNames.begin(), definedNames.end());
+  FriendTreeSpec spec;
+  spec.alias = configProvider.get("skimFriendAlias");
+  if (spec.alias.empty()) {
+    spec.alias = "friend";
+  }
+  spec.treeName = treeName;
+  spec.files = {std::filesystem::absolute(outputFile).string()};
+  spec.indexBranches = configProvider.splitString(configProvider.get("skimFriendIndex"), ",");
+  if (spec.indexBranches.empty()) {
+    // An entry-aligned friend is joined entry by entry with the unfiltered
+    // input, so the skim must hold exactly one row per input entry.
+    std::string reason;
+    if (const auto filters = df.GetFilterNames(); !filters.empty()) {
+      reason = "the skim is filtered (" + filters.front() + ")";
+    } else if (!configProvider.get("firstEntry").empty() &&
+               !configProvider.get("lastEntry").empty()) {
+      reason = "firstEntry/lastEntry is set";
+    } else if (!configProvider.get("previewFraction").empty()) {
+      reason = "previewFraction is set";
+    } else if (const std::string preSkip = configProvider.get("goldenJsonPreSkip");
+               preSkip == "1" || preSkip == "true" || preSkip == "True") {
+      reason = "goldenJsonPreSkip is set";
+    }
+    if (!reason.empty()) {
+      throw std::runtime_error("RootOutputSink: skimFriendMode without skimFriendIndex writes an "
+                               "entry-aligned friend, but " + reason +
+                               "; set skimFriendIndex (e.g. run,event)");
+    }
+  }
+
+  // Without a saveConfig every defined column is written.
+  const std::vector<std::string>& candidates = columns.empty() ? definedNames : columns;
+  std::vector<std::string> written = spec.indexBranches;
+  std::unordered_set<std::string> seen(written.begin(), written.end());
+  for (const auto& column : candidates) {
+    if (defined.count(column) && seen.insert(column).second) {
+      written.push_back(column);
+    }
+  }
+  if (written.size() == spec.indexBranches.size()) {
+    throw std::runtime_error("RootOutputSink: skimFriendMode found no defined columns to write");
+  }
+  RDF_LOG_INFO << "Friend skim: writing " << written.size() - spec.indexBranches.size()
+               << " defined columns";
+  pendingFriends_m[outputFile] = std::move(spec);
+  return written;
+}
+
+void RootOutputSink::setColumnManifest(SkimColumnManifest manifest) {
+  columnManifest_m = std::move(manifest);
+}
+
+std::vector<std::string>
+RootOutputSink::applyColumnManifest(ROOT::RDF::RNode& df, const std::string& outputFile,
+                                    const std::string& treeName,
+                                    std::vector<std::string> columns) {
+  if (columns.empty()) {
+    columns = df.GetColumnNames();
+  }
+  SkimColumnManifest manifest;
+  manifest.treeName = treeName;
+  manifest.base = columnManifest_m->base;
+  manifest.indexColumns = columnManifest_m->indexColumns;
+  for (const auto& column : columns) {
+    const auto* entry = columnManifest_m->find(column);
+    manifest.columns[column] = entry ? *entry : SkimColumnManifest::Entry{"input", ""};
+  }
+  for (const auto& column : manifest.indexColumns) {
+    manifest.columns.emplace(column, SkimColumnManifest::Entry{"input", ""});
+  }
+
+  if (manifest.base.empty()) {
+    manifest.writtenColumns = columns;
+  } else {
+    const auto baseManifest =
+        SkimColumnManifest::read(SkimColumnManifest::pathFor(manifest.base));
+    const auto changed = manifest.changedColumns(baseManifest);
+    const std::unordered_set<std::string> changedSet(changed.begin(), changed.end());
+    const std::unordered_set<std::string> indexSet(manifest.indexColumns.begin(),
+                                                   manifest.indexColumns.end());
+    manifest.writtenColumns = manifest.indexColumns;
+    for (const auto& column : columns) {
+      if (changedSet.count(column) && !indexSet.count(column)) {
+        manifest.writtenColumns.push_back(column);
+      }
+    }
+    RDF_LOG_INFO << "Incremental skim: writing "
+                 << manifest.writtenColumns.size() - manifest.indexColumns.size() << " of "
+                 << columns.size() << " columns changed since " << manifest.base;
+    for (const auto& column : manifest.writtenColumns) {
+      if (!indexSet.count(column)) {
+        RDF_LOG_INFO << "  " << column;
+      }
+    }
+  }
+
+  std::vector<std::string> written = manifest.writtenColumns;
+  pendingManifests_m[outputFile] = std::move(manifest);
+  return written;
+}
+
+void RootOutputSink::writeDataFrame(ROOT::RDF::RNode& df, const OutputSpec& spec) {
+  auto pending = bookSnapshot(df, spec, false);
+  completeSnapshot(pending);
+}
+
+OutputSpec RootOutputSink::resolveSpec(ROOT::RDF::RNode& df,
+                                       const IConfigurationProvider& configProvider,
+                                       const ISystematicManager* systematicManager,
+                                       OutputChannel channel) {
   const auto& configMap = configProvider.getConfigMap();
 
   const std::string saveTree = configProvider.get("saveTree");
@@ -118,11 +683,61 @@ void RootOutputSink::writeDataFrame(ROOT::RDF::RNode& df,
   expandSystematicColumns(columns, systematicManager);
 
   if (columns.empty() && configMap.find("saveConfig") == configMap.end()) {
-    std::cout << "Warning: No 'saveConfig' provided. Snapshotting full dataframe." << std::endl;
+    RDF_LOG_WARN << "Warning: No 'saveConfig' provided. Snapshotting full dataframe.";
+  }
+
+  const std::string friendMode = configProvider.get("skimFriendMode");
+  if (channel == OutputChannel::Skim &&
+      (friendMode == "1" || friendMode == "true" || friendMode == "True")) {
+    columns = applyFriendMode(df, configProvider, outputFile, saveTree, std::move(columns));
   }
 
-  OutputSpec spec{outputFile, saveTree, columns};
-  writeDataFrame(df, spec);
+  if (columnManifest_m && channel == OutputChannel::Skim) {
+    columns = applyColumnManifest(df, outputFile, saveTree, std::move(columns));
+  }
+
+  return OutputSpec{outputFile, saveTree, columns};
+}
+
+void RootOutputSink::writeDataFrame(ROOT::RDF::RNode& df,
+                                    const IConfigurationProvider& configProvider,
+                                    const IDataFrameProvider*,
+                                    const ISystematicManager* systematicManager,
+                                    OutputChannel channel) {
+  const OutputSpec spec = resolveSpec(df, configProvider, systematicManager, channel);
+  ROOT::RDF::RNode node = applyStorageHints(df, configProvider, spec);
+  writeDataFrame(node, spec);
+}
+
+void RootOutputSink::bookDataFrame(ROOT::RDF::RNode& df,
+                                   const IConfigurationProvider& configProvider,
+                                   const IDataFrameProvider*,
+                                   const ISystematicManager* systematicManager,
+                                   OutputChannel channel) {
+  const OutputSpec spec = resolveSpec(df, configProvider, systematicManager, channel);
+  ROOT::RDF::RNode node = applyStorageHints(df, configProvider, spec);
+  pending_m.push_back(bookSnapshot(node, spec, true));
+}
+
+void RootOutputSink::bookDataFrame(ROOT::RDF::RNode& df, const OutputSpec& spec) {
+  pending_m.push_back(bookSnapshot(df, spec, true));
+}
+
+void RootOutputSink::flush() {
+  for (auto& pending : pending_m) {
+    completeSnapshot(pending);
+  }
+  pending_m.clear();
+}
+
+bool RootOutputSink::bookedColumns(std::vector<std::string>& columns) const {
+  for (const auto& pending : pending_m) {
+    if (pending.spec.columns.empty()) {
+      return false;
+    }
+    columns.insert(columns.end(), pending.spec.columns.begin(), pending.spec.columns.end());
+  }
+  return true;
 }
 
 std::string RootOutputSink::resolveOutputFile(const IConfigurationProvider& configProvider,
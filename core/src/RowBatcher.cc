@@ -0,0 +1,118 @@
+#include <RowBatcher.h>
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+RowBatcher::RowBatcher(std::size_t rowSize, std::size_t nOutputs, std::size_t batchSize,
+                       std::size_t nSlots, Evaluate evaluate,
+                       std::chrono::microseconds timeout)
+    : rowSize_m(rowSize), nOutputs_m(nOutputs), batchSize_m(std::max<std::size_t>(batchSize, 1)),
+      nSlots_m(std::max<std::size_t>(nSlots, 1)),
+      target_m(std::min(batchSize_m, nSlots_m)), evaluate_m(std::move(evaluate)),
+      timeout_m(timeout) {
+  if (!evaluate_m) {
+    throw std::invalid_argument("RowBatcher: no evaluation function");
+  }
+  std::lock_guard<std::mutex> lock(mutex_m);
+  filling_m = nextBatch();
+}
+
+RowBatcher::Batch *RowBatcher::nextBatch() {
+  if (!free_m.empty()) {
+    Batch *batch = free_m.back();
+    free_m.pop_back();
+    return batch;
+  }
+  batches_m.push_back(std::make_unique<Batch>());
+  Batch *batch = batches_m.back().get();
+  batch->rows.assign(batchSize_m * rowSize_m, 0.0f);
+  batch->outputs.assign(batchSize_m * nOutputs_m, 0.0f);
+  return batch;
+}
+
+void RowBatcher::infer(const float *row, std::size_t size, float *outputs) {
+  if (size > rowSize_m) {
+    throw std::invalid_argument("RowBatcher: row of " + std::to_string(size) +
+                                " values exceeds the row size " +
+                                std::to_string(rowSize_m));
+  }
+  std::unique_lock<std::mutex> lock(mutex_m);
+  Batch &batch = *filling_m;
+  const std::size_t index = batch.size++;
+  if (index == 0) {
+    batch.firstRow = std::chrono::steady_clock::now();
+  }
+  float *target = batch.rows.data() + index * rowSize_m;
+  std::copy_n(row, size, target);
+  std::fill(target + size, target + rowSize_m, 0.0f);
+  ++waiting_m;
+
+  if (batch.size >= target_m || waiting_m >= nSlots_m) {
+    launch(batch, lock, false);
+  } else {
+    const auto deadline = batch.firstRow + timeout_m;
+    while (!batch.launched) {
+      if (done_m.wait_until(lock, deadline) == std::cv_status::timeout && !batch.launched) {
+        launch(batch, lock, true);
+      }
+    }
+    done_m.wait(lock, [&batch]() { return batch.done; });
+  }
+
+  --waiting_m;
+  const std::exception_ptr error = batch.error;
+  if (!error) {
+    std::copy_n(batch.outputs.data() + index * nOutputs_m, nOutputs_m, outputs);
+  }
+  if (--batch.readers == 0) {
+    batch.size = 0;
+    batch.launched = false;
+    batch.done = false;
+    batch.error = nullptr;
+    free_m.push_back(&batch);
+  }
+  lock.unlock();
+  if (error) {
+    std::rethrow_exception(error);
+  }
+}
+
+void RowBatcher::launch(Batch &batch, std::unique_lock<std::mutex> &lock, bool timedOut) {
+  if (timedOut) {
+    target_m = batch.size;
+    fullBatches_m = 0;
+  } else if (++fullBatches_m % kGrowthInterval == 0) {
+    target_m = std::min({target_m + 1, batchSize_m, nSlots_m});
+  }
+  batch.launched = true;
+  batch.readers = batch.size;
+  filling_m = nextBatch();
+  // Rows left over from the previous use of the buffer are zeroed, so the
+  // evaluation always sees a zero-padded batch.
+  std::fill(batch.rows.begin() + static_cast<std::ptrdiff_t>(batch.size * rowSize_m),
+            batch.rows.end(), 0.0f);
+  done_m.notify_all();
+  lock.unlock();
+  try {
+    evaluate_m(batch.rows.data(), batch.size, batch.outputs.data());
+  } catch (...) {
+    batch.error = std::current_exception();
+  }
+  lock.lock();
+  batch.done = true;
+  ++launched_m;
+  evaluatedRows_m += batch.size;
+  done_m.notify_all();
+}
+
+std::uint64_t RowBatcher::batches() const {
+  std::lock_guard<std::mutex> lock(mutex_m);
+  return launched_m;
+}
+
+std::uint64_t RowBatcher::rows() const {
+  std::lock_guard<std::mutex> lock(mutex_m);
+  return evaluatedRows_m;
+}
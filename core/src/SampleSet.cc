@@ -0,0 +1,124 @@
+#include <SampleSet.h>
+#include <api/IConfigurationProvider.h>
+
+#include <filesystem>
+#include <set>
+#include <stdexcept>
+
+float SampleSet::parseFloat(const std::string &name, const std::string &value) {
+  std::size_t pos = 0;
+  float result = 0.0f;
+  try {
+    result = std::stof(value, &pos);
+  } catch (const std::logic_error &) {
+    pos = 0;
+  }
+  if (pos == 0 || pos != value.size()) {
+    throw std::runtime_error("SampleSet: constant '" + name + "' has the invalid float value '" +
+                             value + "'");
+  }
+  return result;
+}
+
+int SampleSet::parseInt(const std::string &name, const std::string &value) {
+  std::size_t pos = 0;
+  int result = 0;
+  try {
+    result = std::stoi(value, &pos);
+  } catch (const std::logic_error &) {
+    pos = 0;
+  }
+  if (pos == 0 || pos != value.size()) {
+    throw std::runtime_error("SampleSet: constant '" + name + "' has the invalid int value '" +
+                             value + "'");
+  }
+  return result;
+}
+
+SampleSet SampleSet::fromConfig(const IConfigurationProvider &configProvider) {
+  const std::string sampleConfig = configProvider.get("sampleConfig");
+  if (sampleConfig.empty()) {
+    return SampleSet();
+  }
+  std::vector<SampleSpec> samples;
+  std::set<std::string> names;
+  for (const auto &entry : configProvider.parseMultiKeyConfig(sampleConfig, {"name", "fileList"})) {
+    SampleSpec sample;
+    sample.name = entry.at("name");
+    if (!names.insert(sample.name).second) {
+      throw std::runtime_error("SampleSet: duplicate sample '" + sample.name + "' in " +
+                               sampleConfig);
+    }
+    for (const auto &file : configProvider.splitString(entry.at("fileList"), ",")) {
+      if (!file.empty()) {
+        sample.files.push_back(file);
+      }
+    }
+    if (sample.files.empty()) {
+      throw std::runtime_error("SampleSet: sample '" + sample.name + "' has no files");
+    }
+    try {
+      if (auto it = entry.find("floatConfig"); it != entry.end() && !it->second.empty()) {
+        for (const auto &[name, value] : configProvider.parsePairBasedConfig(it->second)) {
+          sample.floatConstants[name] = parseFloat(name, value);
+        }
+      }
+      if (auto it = entry.find("intConfig"); it != entry.end() && !it->second.empty()) {
+        for (const auto &[name, value] : configProvider.parsePairBasedConfig(it->second)) {
+          sample.intConstants[name] = parseInt(name, value);
+        }
+      }
+    } catch (const std::runtime_error &e) {
+      throw std::runtime_error("SampleSet: invalid constant of sample '" + sample.name +
+                               "': " + e.what());
+    }
+    samples.push_back(std::move(sample));
+  }
+  if (samples.empty()) {
+    throw std::runtime_error("SampleSet: no samples in " + sampleConfig);
+  }
+  return SampleSet(std::move(samples));
+}
+
+SampleSet::SampleSet(std::vector<SampleSpec> samples) : samples_m(std::move(samples)) {}
+
+std::vector<std::string> SampleSet::names() const {
+  std::vector<std::string> result;
+  result.reserve(samples_m.size());
+  for (const auto &sample : samples_m) {
+    result.push_back(sample.name);
+  }
+  return result;
+}
+
+std::vector<std::string> SampleSet::files() const {
+  std::vector<std::string> result;
+  for (const auto &sample : samples_m) {
+    result.insert(result.end(), sample.files.begin(), sample.files.end());
+  }
+  return result;
+}
+
+std::vector<int> SampleSet::fileSamples() const {
+  std::vector<int> result;
+  for (std::size_t i = 0; i < samples_m.size(); ++i) {
+    result.insert(result.end(), samples_m[i].files.size(), static_cast<int>(i));
+  }
+  return result;
+}
+
+int SampleSet::sampleOfFile(const std::string &url) const {
+  const std::string name = std::filesystem::path(url).filename().string();
+  int byName = -1;
+  for (std::size_t i = 0; i < samples_m.size(); ++i) {
+    for (const auto &file : samples_m[i].files) {
+      if (file == url) {
+        return static_cast<int>(i);
+      }
+      if (byName < 0 && std::filesystem::path(file).filename().string() == name) {
+        byName = static_cast<int>(i);
+      }
+    }
+  }
+  return byName;
+}
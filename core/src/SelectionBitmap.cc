@@ -0,0 +1,313 @@
+#include <SelectionBitmap.h>
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <unistd.h>
+
+namespace {
+
+constexpr char kMagic[8] = {'R', 'D', 'F', 'S', 'E', 'L', '1', '\0'};
+
+template <typename T> void put(std::string &out, const T &value) {
+  out.append(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+template <typename T> void putVector(std::string &out, const std::vector<T> &values) {
+  out.append(reinterpret_cast<const char *>(values.data()), values.size() * sizeof(T));
+}
+
+/// Reads fixed-size values from a serialized bitmap.
+class Reader {
+public:
+  explicit Reader(const std::string &data) : data_m(data) {}
+
+  template <typename T> T get() {
+    T value;
+    read(&value, sizeof(T));
+    return value;
+  }
+
+  template <typename T> std::vector<T> getVector(std::size_t n) {
+    if (n > (data_m.size() - pos_m) / sizeof(T)) {
+      fail();
+    }
+    std::vector<T> values(n);
+    read(values.data(), n * sizeof(T));
+    return values;
+  }
+
+  bool done() const { return pos_m == data_m.size(); }
+
+  [[noreturn]] static void fail() {
+    throw std::runtime_error("SelectionBitmap: malformed serialized bitmap");
+  }
+
+private:
+  void read(void *to, std::size_t n) {
+    if (n > data_m.size() - pos_m) {
+      fail();
+    }
+    std::memcpy(to, data_m.data() + pos_m, n);
+    pos_m += n;
+  }
+
+  const std::string &data_m;
+  std::size_t pos_m = 0;
+};
+
+} // namespace
+
+std::uint32_t SelectionBitmap::Chunk::cardinality() const {
+  switch (kind) {
+  case Kind::Array:
+    return static_cast<std::uint32_t>(values.size());
+  case Kind::Bitmap: {
+    std::uint32_t n = 0;
+    for (const std::uint64_t word : bits) {
+      n += static_cast<std::uint32_t>(__builtin_popcountll(word));
+    }
+    return n;
+  }
+  case Kind::Runs: {
+    std::uint32_t n = 0;
+    for (std::size_t i = 0; i + 1 < values.size(); i += 2) {
+      n += static_cast<std::uint32_t>(values[i + 1]) - values[i] + 1;
+    }
+    return n;
+  }
+  }
+  return 0;
+}
+
+SelectionBitmap::Chunk SelectionBitmap::makeChunk(std::uint64_t key,
+                                                  const std::vector<std::uint16_t> &runs) {
+  Chunk chunk;
+  chunk.key = key;
+  std::uint32_t cardinality = 0;
+  for (std::size_t i = 0; i < runs.size(); i += 2) {
+    cardinality += static_cast<std::uint32_t>(runs[i + 1]) - runs[i] + 1;
+  }
+  const std::size_t arrayBytes = 2 * static_cast<std::size_t>(cardinality);
+  const std::size_t runBytes = 2 * runs.size();
+  const std::size_t bitmapBytes = 8 * kBitmapWords;
+
+  if (runBytes <= arrayBytes && runBytes <= bitmapBytes) {
+    chunk.kind = Kind::Runs;
+    chunk.values = runs;
+  } else if (arrayBytes <= bitmapBytes) {
+    chunk.kind = Kind::Array;
+    chunk.values.reserve(cardinality);
+    for (std::size_t i = 0; i < runs.size(); i += 2) {
+      for (std::uint32_t low = runs[i]; low <= runs[i + 1]; ++low) {
+        chunk.values.push_back(static_cast<std::uint16_t>(low));
+      }
+    }
+  } else {
+    chunk.kind = Kind::Bitmap;
+    chunk.bits.assign(kBitmapWords, 0);
+    for (std::size_t i = 0; i < runs.size(); i += 2) {
+      for (std::uint32_t low = runs[i]; low <= runs[i + 1]; ++low) {
+        chunk.bits[low / 64] |= std::uint64_t(1) << (low % 64);
+      }
+    }
+  }
+  return chunk;
+}
+
+SelectionBitmap SelectionBitmap::fromRanges(const EntryRangeSet &entries) {
+  SelectionBitmap bitmap;
+  std::uint64_t key = 0;
+  std::vector<std::uint16_t> runs;
+  const auto flush = [&]() {
+    if (!runs.empty()) {
+      bitmap.chunks_m.push_back(makeChunk(key, runs));
+      runs.clear();
+    }
+  };
+  for (const auto &[first, last] : entries.ranges()) {
+    // Split [first, last) at chunk boundaries.
+    for (ULong64_t begin = first; begin < last;) {
+      const std::uint64_t beginKey = begin >> kChunkBits;
+      const ULong64_t chunkEnd = (beginKey + 1) << kChunkBits;
+      const ULong64_t end = std::min<ULong64_t>(last, chunkEnd);
+      if (beginKey != key) {
+        flush();
+        key = beginKey;
+      }
+      runs.push_back(static_cast<std::uint16_t>(begin & 0xFFFF));
+      runs.push_back(static_cast<std::uint16_t>((end - 1) & 0xFFFF));
+      begin = end;
+    }
+  }
+  flush();
+  return bitmap;
+}
+
+EntryRangeSet SelectionBitmap::toRanges() const {
+  EntryRangeSet entries;
+  for (const auto &chunk : chunks_m) {
+    const ULong64_t base = static_cast<ULong64_t>(chunk.key) << kChunkBits;
+    switch (chunk.kind) {
+    case Kind::Array:
+      for (const std::uint16_t low : chunk.values) {
+        entries.add(base + low);
+      }
+      break;
+    case Kind::Bitmap:
+      for (std::uint32_t word = 0; word < kBitmapWords; ++word) {
+        for (std::uint64_t bits = chunk.bits[word]; bits != 0; bits &= bits - 1) {
+          entries.add(base + 64 * word + static_cast<ULong64_t>(__builtin_ctzll(bits)));
+        }
+      }
+      break;
+    case Kind::Runs:
+      for (std::size_t i = 0; i + 1 < chunk.values.size(); i += 2) {
+        entries.add(base + chunk.values[i], base + chunk.values[i + 1] + 1);
+      }
+      break;
+    }
+  }
+  return entries;
+}
+
+bool SelectionBitmap::contains(ULong64_t entry) const {
+  const std::uint64_t key = entry >> kChunkBits;
+  const auto low = static_cast<std::uint16_t>(entry & 0xFFFF);
+  auto it = std::lower_bound(chunks_m.begin(), chunks_m.end(), key,
+                             [](const Chunk &chunk, std::uint64_t k) { return chunk.key < k; });
+  if (it == chunks_m.end() || it->key != key) {
+    return false;
+  }
+  switch (it->kind) {
+  case Kind::Array:
+    return std::binary_search(it->values.begin(), it->values.end(), low);
+  case Kind::Bitmap:
+    return (it->bits[low / 64] >> (low % 64)) & 1;
+  case Kind::Runs:
+    for (std::size_t i = 0; i + 1 < it->values.size(); i += 2) {
+      if (low < it->values[i]) {
+        return false;
+      }
+      if (low <= it->values[i + 1]) {
+        return true;
+      }
+    }
+    return false;
+  }
+  return false;
+}
+
+ULong64_t SelectionBitmap::size() const {
+  ULong64_t n = 0;
+  for (const auto &chunk : chunks_m) {
+    n += chunk.cardinality();
+  }
+  return n;
+}
+
+std::string SelectionBitmap::serialize() const {
+  std::string out(kMagic, sizeof(kMagic));
+  put(out, static_cast<std::uint64_t>(chunks_m.size()));
+  for (const auto &chunk : chunks_m) {
+    put(out, chunk.key);
+    put(out, static_cast<std::uint8_t>(chunk.kind));
+    if (chunk.kind == Kind::Bitmap) {
+      put(out, static_cast<std::uint32_t>(chunk.bits.size()));
+      putVector(out, chunk.bits);
+    } else {
+      put(out, static_cast<std::uint32_t>(chunk.values.size()));
+      putVector(out, chunk.values);
+    }
+  }
+  return out;
+}
+
+SelectionBitmap SelectionBitmap::deserialize(const std::string &data) {
+  Reader in(data);
+  char magic[sizeof(kMagic)];
+  for (char &c : magic) {
+    c = in.get<char>();
+  }
+  if (std::memcmp(magic, kMagic, sizeof(kMagic)) != 0) {
+    Reader::fail();
+  }
+  SelectionBitmap bitmap;
+  const auto nChunks = in.get<std::uint64_t>();
+  for (std::uint64_t i = 0; i < nChunks; ++i) {
+    Chunk chunk;
+    chunk.key = in.get<std::uint64_t>();
+    const auto kind = in.get<std::uint8_t>();
+    const auto n = in.get<std::uint32_t>();
+    if (kind == static_cast<std::uint8_t>(Kind::Bitmap)) {
+      if (n != kBitmapWords) {
+        Reader::fail();
+      }
+      chunk.kind = Kind::Bitmap;
+      chunk.bits = in.getVector<std::uint64_t>(n);
+    } else if (kind == static_cast<std::uint8_t>(Kind::Array) ||
+               kind == static_cast<std::uint8_t>(Kind::Runs)) {
+      chunk.kind = static_cast<Kind>(kind);
+      if (chunk.kind == Kind::Runs && n % 2 != 0) {
+        Reader::fail();
+      }
+      chunk.values = in.getVector<std::uint16_t>(n);
+    } else {
+      Reader::fail();
+    }
+    if (!bitmap.chunks_m.empty() && bitmap.chunks_m.back().key >= chunk.key) {
+      Reader::fail();
+    }
+    bitmap.chunks_m.push_back(std::move(chunk));
+  }
+  if (!in.done()) {
+    Reader::fail();
+  }
+  return bitmap;
+}
+
+void SelectionBitmap::write(const std::string &path, ULong64_t fileEntries) const {
+  std::string out;
+  put(out, static_cast<std::uint64_t>(fileEntries));
+  out += serialize();
+  const std::filesystem::path parent = std::filesystem::path(path).parent_path();
+  if (!parent.empty()) {
+    std::filesystem::create_directories(parent);
+  }
+  // Write to a temporary file first so readers never see a partial bitmap.
+  const std::string tmpPath = path + ".tmp." + std::to_string(getpid());
+  {
+    std::ofstream file(tmpPath, std::ios::binary);
+    if (!file) {
+      throw std::runtime_error("SelectionBitmap: cannot write '" + path + "'");
+    }
+    file.write(out.data(), static_cast<std::streamsize>(out.size()));
+  }
+  std::filesystem::rename(tmpPath, path);
+}
+
+std::optional<SelectionBitmap> SelectionBitmap::read(const std::string &path,
+                                                     ULong64_t fileEntries) {
+  std::ifstream file(path, std::ios::binary);
+  if (!file) {
+    return std::nullopt;
+  }
+  const std::string data((std::istreambuf_iterator<char>(file)),
+                         std::istreambuf_iterator<char>());
+  std::uint64_t entries = 0;
+  if (data.size() < sizeof(entries)) {
+    throw std::runtime_error("SelectionBitmap: malformed bitmap file '" + path + "'");
+  }
+  std::memcpy(&entries, data.data(), sizeof(entries));
+  if (entries != fileEntries) {
+    return std::nullopt;
+  }
+  try {
+    return deserialize(data.substr(sizeof(entries)));
+  } catch (const std::runtime_error &) {
+    throw std::runtime_error("SelectionBitmap: malformed bitmap file '" + path + "'");
+  }
+}
@@ -0,0 +1,113 @@
+#include <SkimColumnManifest.h>
+#include <JsonString.h>
+
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <unistd.h>
+#include <yaml-cpp/yaml.h>
+
+namespace {
+
+std::string jsonList(const std::vector<std::string> &values) {
+  std::string out = "[";
+  for (std::size_t i = 0; i < values.size(); ++i) {
+    out += (i == 0 ? "" : ", ") + jsonString(values[i]);
+  }
+  return out + "]";
+}
+
+std::vector<std::string> readList(const YAML::Node &node) {
+  std::vector<std::string> values;
+  if (node && node.IsSequence()) {
+    for (const auto &value : node) {
+      values.push_back(value.as<std::string>());
+    }
+  }
+  return values;
+}
+
+} // namespace
+
+std::string SkimColumnManifest::pathFor(const std::string &skimFile) {
+  return skimFile + ".columns.json";
+}
+
+SkimColumnManifest SkimColumnManifest::read(const std::string &path) {
+  if (!std::filesystem::exists(path)) {
+    throw std::runtime_error("SkimColumnManifest: '" + path + "' not found");
+  }
+  YAML::Node root;
+  try {
+    root = YAML::LoadFile(path);
+  } catch (const YAML::Exception &e) {
+    throw std::runtime_error("SkimColumnManifest: cannot parse '" + path +
+                             "': " + e.what());
+  }
+  if (!root.IsMap() || !root["columns"] || !root["columns"].IsMap()) {
+    throw std::runtime_error("SkimColumnManifest: '" + path +
+                             "' has no 'columns' map");
+  }
+
+  SkimColumnManifest manifest;
+  if (root["tree"]) {
+    manifest.treeName = root["tree"].as<std::string>();
+  }
+  if (root["base"]) {
+    manifest.base = root["base"].as<std::string>();
+  }
+  manifest.indexColumns = readList(root["index"]);
+  manifest.writtenColumns = readList(root["written"]);
+  for (const auto &column : root["columns"]) {
+    const YAML::Node &entry = column.second;
+    manifest.columns[column.first.as<std::string>()] =
+        Entry{entry["producer"] ? entry["producer"].as<std::string>() : "",
+              entry["hash"] ? entry["hash"].as<std::string>() : ""};
+  }
+  return manifest;
+}
+
+void SkimColumnManifest::write(const std::string &path) const {
+  std::ostringstream out;
+  out << "{\n  \"tree\": " << jsonString(treeName) << ",\n  \"base\": "
+      << jsonString(base) << ",\n  \"index\": " << jsonList(indexColumns)
+      << ",\n  \"written\": " << jsonList(writtenColumns) << ",\n  \"columns\": {";
+  bool first = true;
+  for (const auto &[name, entry] : columns) {
+    out << (first ? "\n" : ",\n") << "    " << jsonString(name)
+        << ": {\"producer\": " << jsonString(entry.producer)
+        << ", \"hash\": " << jsonString(entry.hash) << "}";
+    first = false;
+  }
+  out << (first ? "" : "\n  ") << "}\n}\n";
+
+  // Write to a temporary file first so readers never see a partial manifest.
+  const std::string tmpPath = path + ".tmp." + std::to_string(getpid());
+  {
+    std::ofstream file(tmpPath);
+    if (!file) {
+      throw std::runtime_error("SkimColumnManifest: cannot write '" + path + "'");
+    }
+    file << out.str();
+  }
+  std::filesystem::rename(tmpPath, path);
+}
+
+std::vector<std::string>
+SkimColumnManifest::changedColumns(const SkimColumnManifest &base) const {
+  std::vector<std::string> changed;
+  for (const auto &[name, entry] : columns) {
+    const Entry *baseEntry = base.find(name);
+    if (!baseEntry || *baseEntry != entry) {
+      changed.push_back(name);
+    }
+  }
+  return changed;
+}
+
+const SkimColumnManifest::Entry *
+SkimColumnManifest::find(const std::string &column) const {
+  auto it = columns.find(column);
+  return it == columns.end() ? nullptr : &it->second;
+}
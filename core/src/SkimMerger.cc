@@ -0,0 +1,117 @@
+#include <SkimMerger.h>
+#include <TFile.h>
+#include <TFileMerger.h>
+#include <TROOT.h>
+#include <ROOT/TSeq.hxx>
+#include <ROOT/TThreadExecutor.hxx>
+#include <filesystem>
+#include <memory>
+#include <stdexcept>
+
+namespace {
+
+/// Output name of part @p index of @p count.
+std::string partOutput(const std::string &output, std::size_t index, std::size_t count) {
+  if (count == 1) {
+    return output;
+  }
+  const std::filesystem::path path(output);
+  const std::string name =
+      path.stem().string() + "_" + std::to_string(index) + path.extension().string();
+  return (path.parent_path() / name).string();
+}
+
+} // namespace
+
+SkimMerger::SkimMerger(std::uint64_t targetBytes) : targetBytes_m(targetBytes) {}
+
+std::vector<SkimMerger::Part>
+SkimMerger::plan(const std::string &output, const std::vector<std::string> &inputs,
+                 const std::vector<std::uint64_t> &sizes) const {
+  if (inputs.empty()) {
+    throw std::runtime_error("SkimMerger: no input files to merge into '" + output + "'");
+  }
+  if (sizes.size() != inputs.size()) {
+    throw std::runtime_error("SkimMerger: got " + std::to_string(sizes.size()) +
+                             " sizes for " + std::to_string(inputs.size()) + " inputs");
+  }
+  std::vector<Part> parts(1);
+  for (std::size_t i = 0; i < inputs.size(); ++i) {
+    Part *part = &parts.back();
+    if (targetBytes_m > 0 && !part->inputs.empty() &&
+        part->inputBytes + sizes[i] > targetBytes_m) {
+      part = &parts.emplace_back();
+    }
+    part->inputs.push_back(inputs[i]);
+    part->inputBytes += sizes[i];
+  }
+  for (std::size_t i = 0; i < parts.size(); ++i) {
+    parts[i].output = partOutput(output, i, parts.size());
+  }
+  return parts;
+}
+
+std::vector<SkimMerger::Part>
+SkimMerger::merge(const std::string &output, const std::vector<std::string> &inputs) const {
+  if (inputs.empty()) {
+    throw std::runtime_error("SkimMerger: no input files to merge into '" + output + "'");
+  }
+  ROOT::EnableThreadSafety();
+
+  // Sizes (also of remote files) and compression settings of every input.
+  std::vector<std::uint64_t> sizes;
+  std::vector<int> compression;
+  for (const auto &input : inputs) {
+    std::unique_ptr<TFile> file(TFile::Open(input.c_str(), "READ"));
+    if (!file || file->IsZombie()) {
+      throw std::runtime_error("SkimMerger: cannot open '" + input + "'");
+    }
+    sizes.push_back(static_cast<std::uint64_t>(file->GetSize()));
+    compression.push_back(file->GetCompressionSettings());
+  }
+
+  std::vector<Part> parts = plan(output, inputs, sizes);
+  std::size_t first = 0;
+  for (auto &part : parts) {
+    part.compression = compression[first];
+    part.fastCopy = true;
+    for (std::size_t i = first; i < first + part.inputs.size(); ++i) {
+      part.fastCopy = part.fastCopy && compression[i] == part.compression;
+    }
+    first += part.inputs.size();
+  }
+
+  const std::filesystem::path parent = std::filesystem::path(output).parent_path();
+  if (!parent.empty()) {
+    std::filesystem::create_directories(parent);
+  }
+  if (parts.size() > 1 && ROOT::IsImplicitMTEnabled()) {
+    ROOT::TThreadExecutor pool;
+    pool.Foreach([&](unsigned int i) { mergePart(parts[i]); }, ROOT::TSeqU(parts.size()));
+  } else {
+    for (auto &part : parts) {
+      mergePart(part);
+    }
+  }
+  return parts;
+}
+
+void SkimMerger::mergePart(Part &part) {
+  // Not local: the inputs are read in place rather than copied first.
+  TFileMerger merger(false, false);
+  merger.SetPrintLevel(0);
+  merger.SetFastMethod(part.fastCopy);
+  if (!merger.OutputFile(part.output.c_str(), "RECREATE", part.compression)) {
+    throw std::runtime_error("SkimMerger: cannot create '" + part.output + "'");
+  }
+  for (const auto &input : part.inputs) {
+    if (!merger.AddFile(input.c_str(), false)) {
+      throw std::runtime_error("SkimMerger: cannot add '" + input + "' to '" +
+                               part.output + "'");
+    }
+  }
+  if (!merger.Merge()) {
+    throw std::runtime_error("SkimMerger: merging " + std::to_string(part.inputs.size()) +
+                             " file(s) into '" + part.output + "' failed");
+  }
+}
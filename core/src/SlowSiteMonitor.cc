@@ -0,0 +1,323 @@
+#include <SlowSiteMonitor.h>
+#include <AsyncLogger.h>
+#include <JsonString.h>
+
+#include <TFile.h>
+#include <yaml-cpp/yaml.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <unistd.h>
+
+namespace {
+
+constexpr double kBytesPerMB = 1024.0 * 1024.0;
+
+double monotonicSeconds() {
+  return std::chrono::duration<double>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+/// Redirector with a single trailing slash, matching siteOf().
+std::string normalizeRedirector(const std::string &redirector) {
+  std::string base = redirector;
+  while (!base.empty() && base.back() == '/') {
+    base.pop_back();
+  }
+  return base + "/";
+}
+
+} // namespace
+
+SlowSiteMonitor::SlowSiteMonitor(double thresholdMBs, double windowSeconds)
+    : thresholdMBs_m(thresholdMBs), windowSeconds_m(windowSeconds) {
+  if (thresholdMBs_m <= 0.0) {
+    throw std::runtime_error("SlowSiteMonitor: threshold must be positive");
+  }
+  if (windowSeconds_m < 0.0) {
+    throw std::runtime_error("SlowSiteMonitor: window must not be negative");
+  }
+}
+
+std::string SlowSiteMonitor::siteOf(const std::string &url) {
+  const std::string scheme = "root://";
+  if (url.compare(0, scheme.size(), scheme) != 0) {
+    return "";
+  }
+  const auto hostEnd = url.find('/', scheme.size());
+  if (hostEnd == std::string::npos) {
+    return url + "/";
+  }
+  return url.substr(0, hostEnd + 1);
+}
+
+std::string SlowSiteMonitor::logicalFileName(const std::string &url) {
+  const std::string site = siteOf(url);
+  if (site.empty()) {
+    return url;
+  }
+  const auto pathBegin = url.find_first_not_of('/', site.size());
+  if (pathBegin == std::string::npos) {
+    return "/";
+  }
+  return "/" + url.substr(pathBegin);
+}
+
+void SlowSiteMonitor::loadRedirectors(const std::string &path) {
+  if (path.empty() || !std::filesystem::exists(path)) {
+    return;
+  }
+  YAML::Node root;
+  try {
+    root = YAML::LoadFile(path);
+  } catch (const YAML::Exception &e) {
+    RDF_LOG_WARN << "Warning: SlowSiteMonitor: cannot parse '" << path
+                 << "': " << e.what();
+    return;
+  }
+  if (!root.IsMap()) {
+    return;
+  }
+  std::unordered_map<std::string, std::vector<std::string>> redirectors;
+  for (const auto &entry : root) {
+    if (!entry.second.IsSequence()) {
+      continue;
+    }
+    auto &ranked = redirectors[entry.first.as<std::string>()];
+    for (const auto &redirector : entry.second) {
+      ranked.push_back(redirector.as<std::string>());
+    }
+  }
+  setRedirectors(std::move(redirectors));
+}
+
+void SlowSiteMonitor::setRedirectors(
+    std::unordered_map<std::string, std::vector<std::string>> redirectors) {
+  std::lock_guard<std::mutex> lock(mutex_m);
+  redirectors_m = std::move(redirectors);
+}
+
+bool SlowSiteMonitor::recordRead(const std::string &url, Long64_t bytes,
+                                 double seconds) {
+  std::lock_guard<std::mutex> lock(mutex_m);
+  return recordReadLocked(url, bytes, seconds);
+}
+
+bool SlowSiteMonitor::recordReadLocked(const std::string &url, Long64_t bytes,
+                                       double seconds) {
+  const std::string site = siteOf(url);
+  if (site.empty()) {
+    return true;
+  }
+  SiteStats &stats = sites_m[site];
+  stats.files.insert(url);
+  if (bytes > 0 && seconds > 0.0) {
+    stats.bytes += bytes;
+    stats.seconds += seconds;
+  }
+  if (stats.slow || stats.bytes <= 0 || stats.seconds <= 0.0) {
+    return true;
+  }
+
+  const double throughput = stats.bytes / kBytesPerMB / stats.seconds;
+  if (throughput >= thresholdMBs_m) {
+    stats.belowSeconds = 0.0;
+    return true;
+  }
+  stats.belowSeconds += std::max(seconds, 0.0);
+  if (stats.belowSeconds < windowSeconds_m) {
+    return true;
+  }
+
+  stats.slow = true;
+  RDF_LOG_WARN << "Warning: slow XRootD site " << site << ": throughput "
+               << throughput << " MB/s < threshold " << thresholdMBs_m
+               << " MB/s for " << stats.belowSeconds << " s of reading";
+  return false;
+}
+
+void SlowSiteMonitor::onSample(unsigned int slot, const std::string &url) {
+  onSample(slot, url, monotonicSeconds(), TFile::GetFileBytesRead());
+}
+
+void SlowSiteMonitor::onSample(unsigned int slot, const std::string &url,
+                               double timeSeconds, Long64_t totalBytesRead) {
+  std::lock_guard<std::mutex> lock(mutex_m);
+  if (slot >= blocks_m.size()) {
+    blocks_m.resize(slot + 1);
+  }
+  OpenBlock &block = blocks_m[slot];
+  if (block.open) {
+    closeBlockLocked(block, timeSeconds, totalBytesRead);
+  }
+  block.url = url;
+  block.startSeconds = timeSeconds;
+  block.startBytes = totalBytesRead;
+  block.open = true;
+  ++openBlocks_m;
+}
+
+void SlowSiteMonitor::closeAll() {
+  closeAll(monotonicSeconds(), TFile::GetFileBytesRead());
+}
+
+void SlowSiteMonitor::closeAll(double timeSeconds, Long64_t totalBytesRead) {
+  std::lock_guard<std::mutex> lock(mutex_m);
+  for (auto &block : blocks_m) {
+    if (block.open) {
+      closeBlockLocked(block, timeSeconds, totalBytesRead);
+    }
+  }
+}
+
+void SlowSiteMonitor::closeBlockLocked(OpenBlock &block, double timeSeconds,
+                                       Long64_t totalBytesRead) {
+  const Long64_t bytes = std::max<Long64_t>(totalBytesRead - block.startBytes, 0);
+  const Long64_t share = bytes / std::max(openBlocks_m, 1u);
+  block.open = false;
+  --openBlocks_m;
+  recordReadLocked(block.url, share, timeSeconds - block.startSeconds);
+}
+
+void SlowSiteMonitor::markSlow(const std::string &site) {
+  std::lock_guard<std::mutex> lock(mutex_m);
+  sites_m[normalizeRedirector(site)].slow = true;
+}
+
+bool SlowSiteMonitor::isSlow(const std::string &site) const {
+  std::lock_guard<std::mutex> lock(mutex_m);
+  const auto it = sites_m.find(site);
+  return it != sites_m.end() && it->second.slow;
+}
+
+std::vector<std::string> SlowSiteMonitor::slowSites() const {
+  std::lock_guard<std::mutex> lock(mutex_m);
+  std::vector<std::string> slow;
+  for (const auto &[site, stats] : sites_m) {
+    if (stats.slow) {
+      slow.push_back(site);
+    }
+  }
+  std::sort(slow.begin(), slow.end());
+  return slow;
+}
+
+double SlowSiteMonitor::throughputMBs(const std::string &site) const {
+  std::lock_guard<std::mutex> lock(mutex_m);
+  const auto it = sites_m.find(site);
+  if (it == sites_m.end() || it->second.bytes <= 0 || it->second.seconds <= 0.0) {
+    return -1.0;
+  }
+  return it->second.bytes / kBytesPerMB / it->second.seconds;
+}
+
+std::string SlowSiteMonitor::failoverUrl(const std::string &url) const {
+  std::lock_guard<std::mutex> lock(mutex_m);
+  return failoverUrlLocked(url);
+}
+
+std::string SlowSiteMonitor::failoverUrlLocked(const std::string &url) const {
+  const std::string site = siteOf(url);
+  const auto siteIt = sites_m.find(site);
+  if (site.empty() || siteIt == sites_m.end() || !siteIt->second.slow) {
+    return url;
+  }
+  const std::string lfn = logicalFileName(url);
+  const auto rankedIt = redirectors_m.find(lfn);
+  if (rankedIt == redirectors_m.end()) {
+    return "";
+  }
+  for (const auto &redirector : rankedIt->second) {
+    const std::string candidate = normalizeRedirector(redirector);
+    const auto candidateIt = sites_m.find(candidate);
+    if (candidate == site ||
+        (candidateIt != sites_m.end() && candidateIt->second.slow)) {
+      continue;
+    }
+    return candidate + lfn;
+  }
+  return "";
+}
+
+void SlowSiteMonitor::writeReport(const std::string &path) const {
+  std::lock_guard<std::mutex> lock(mutex_m);
+  std::vector<std::string> sites;
+  for (const auto &entry : sites_m) {
+    sites.push_back(entry.first);
+  }
+  std::sort(sites.begin(), sites.end());
+
+  std::ostringstream out;
+  out << "{\n  \"threshold_mbs\": " << thresholdMBs_m
+      << ",\n  \"window_s\": " << windowSeconds_m << ",\n  \"slow_sites\": [";
+  bool first = true;
+  for (const auto &site : sites) {
+    if (sites_m.at(site).slow) {
+      out << (first ? "" : ", ") << jsonString(site);
+      first = false;
+    }
+  }
+  out << "],\n  \"sites\": {";
+  first = true;
+  for (const auto &site : sites) {
+    const SiteStats &stats = sites_m.at(site);
+    const double throughput = stats.seconds > 0.0
+                                  ? stats.bytes / kBytesPerMB / stats.seconds
+                                  : -1.0;
+    out << (first ? "\n" : ",\n") << "    " << jsonString(site)
+        << ": {\"bytes\": " << stats.bytes << ", \"seconds\": " << stats.seconds
+        << ", \"throughput_mbs\": " << throughput
+        << ", \"slow\": " << (stats.slow ? "true" : "false") << "}";
+    first = false;
+  }
+  out << (first ? "" : "\n  ") << "},\n  \"failover\": {";
+  first = true;
+  for (const auto &site : sites) {
+    const SiteStats &stats = sites_m.at(site);
+    if (!stats.slow) {
+      continue;
+    }
+    for (const auto &file : stats.files) {
+      out << (first ? "\n" : ",\n") << "    " << jsonString(file) << ": "
+          << jsonString(failoverUrlLocked(file));
+      first = false;
+    }
+  }
+  out << (first ? "" : "\n  ") << "}\n}\n";
+
+  // Write to a temporary file first so readers never see a partial report.
+  const std::string tmpPath = path + ".tmp." + std::to_string(getpid());
+  {
+    std::ofstream file(tmpPath);
+    if (!file) {
+      throw std::runtime_error("SlowSiteMonitor: cannot write '" + path + "'");
+    }
+    file << out.str();
+  }
+  std::filesystem::rename(tmpPath, path);
+}
+
+std::vector<std::string>
+SlowSiteMonitor::readReportedSlowSites(const std::string &path) {
+  std::vector<std::string> slow;
+  if (path.empty() || !std::filesystem::exists(path)) {
+    return slow;
+  }
+  try {
+    const YAML::Node root = YAML::LoadFile(path);
+    for (const auto &site : root["slow_sites"]) {
+      slow.push_back(site.as<std::string>());
+    }
+  } catch (const YAML::Exception &e) {
+    RDF_LOG_WARN << "Warning: SlowSiteMonitor: cannot parse '" << path
+                 << "': " << e.what();
+  }
+  return slow;
+}
@@ -0,0 +1,190 @@
+#include <SparseProjector.h>
+
+#include <ROOT/TSeq.hxx>
+#include <ROOT/TThreadExecutor.hxx>
+#include <TAxis.h>
+#include <TDirectory.h>
+#include <TFile.h>
+#include <TH1D.h>
+#include <THnBase.h>
+#include <TROOT.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <iterator>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace {
+
+/// Projections with the same projected axis and the same selected axes.
+struct ProjectionGroup {
+  int axis;
+  std::vector<int> fixedAxes;
+  /// Outputs by the linear index of their selected bins.
+  std::unordered_map<std::uint64_t, std::vector<std::size_t>> outputs;
+};
+
+/// Contents and squared errors of one output, flow bins included.
+struct Accumulator {
+  std::vector<double> sums;
+  std::vector<double> sumw2;
+};
+
+std::unique_ptr<TH1D> makeHistogram(const std::string &name, const TAxis &axis) {
+  std::unique_ptr<TH1D> hist;
+  if (axis.GetXbins()->GetSize() > 0) {
+    hist = std::make_unique<TH1D>(name.c_str(), axis.GetTitle(), axis.GetNbins(),
+                                  axis.GetXbins()->GetArray());
+  } else {
+    hist = std::make_unique<TH1D>(name.c_str(), axis.GetTitle(), axis.GetNbins(),
+                                  axis.GetXmin(), axis.GetXmax());
+  }
+  hist->SetDirectory(nullptr);
+  return hist;
+}
+
+} // namespace
+
+std::vector<std::unique_ptr<TH1D>>
+SparseProjector::project(const THnBase &hist, const std::vector<SparseProjection> &projections) {
+  const Int_t dim = hist.GetNdimensions();
+  std::vector<std::uint64_t> extent(dim);
+  for (Int_t d = 0; d < dim; ++d) {
+    extent[d] = static_cast<std::uint64_t>(hist.GetAxis(d)->GetNbins() + 2);
+  }
+
+  std::vector<ProjectionGroup> groups;
+  std::vector<Accumulator> accumulators(projections.size());
+  for (std::size_t p = 0; p < projections.size(); ++p) {
+    const auto &projection = projections[p];
+    if (projection.axis < 0 || projection.axis >= dim) {
+      throw std::runtime_error("SparseProjector: projection '" + projection.name +
+                               "' uses missing axis " + std::to_string(projection.axis) +
+                               " of '" + hist.GetName() + "'");
+    }
+    auto fixed = projection.fixedBins;
+    std::sort(fixed.begin(), fixed.end());
+    std::vector<int> fixedAxes;
+    std::uint64_t key = 0;
+    std::uint64_t stride = 1;
+    for (const auto &[axis, bin] : fixed) {
+      if (axis < 0 || axis >= dim || axis == projection.axis ||
+          (!fixedAxes.empty() && fixedAxes.back() == axis) || bin < 0 ||
+          static_cast<std::uint64_t>(bin) >= extent[axis]) {
+        throw std::runtime_error("SparseProjector: projection '" + projection.name +
+                                 "' has an invalid selection (axis " + std::to_string(axis) +
+                                 ", bin " + std::to_string(bin) + ") for '" +
+                                 hist.GetName() + "'");
+      }
+      fixedAxes.push_back(axis);
+      key += static_cast<std::uint64_t>(bin) * stride;
+      stride *= extent[axis];
+    }
+    auto group = std::find_if(groups.begin(), groups.end(), [&](const ProjectionGroup &g) {
+      return g.axis == projection.axis && g.fixedAxes == fixedAxes;
+    });
+    if (group == groups.end()) {
+      groups.push_back({projection.axis, fixedAxes, {}});
+      group = std::prev(groups.end());
+    }
+    group->outputs[key].push_back(p);
+    accumulators[p].sums.assign(extent[projection.axis], 0.0);
+    accumulators[p].sumw2.assign(extent[projection.axis], 0.0);
+  }
+
+  // One pass over the filled bins.
+  std::vector<Int_t> coords(dim);
+  for (Long64_t i = 0; i < hist.GetNbins(); ++i) {
+    const double content = hist.GetBinContent(i, coords.data());
+    const double error2 = hist.GetBinError2(i);
+    if (content == 0 && error2 == 0) {
+      continue;
+    }
+    for (const auto &group : groups) {
+      std::uint64_t key = 0;
+      std::uint64_t stride = 1;
+      for (const int axis : group.fixedAxes) {
+        key += static_cast<std::uint64_t>(coords[axis]) * stride;
+        stride *= extent[axis];
+      }
+      const auto outputs = group.outputs.find(key);
+      if (outputs == group.outputs.end()) {
+        continue;
+      }
+      const Int_t bin = coords[group.axis];
+      for (const std::size_t p : outputs->second) {
+        accumulators[p].sums[bin] += content;
+        accumulators[p].sumw2[bin] += error2;
+      }
+    }
+  }
+
+  std::vector<std::unique_ptr<TH1D>> result;
+  result.reserve(projections.size());
+  for (std::size_t p = 0; p < projections.size(); ++p) {
+    auto out = makeHistogram(projections[p].name, *hist.GetAxis(projections[p].axis));
+    out->Sumw2();
+    for (std::size_t bin = 0; bin < accumulators[p].sums.size(); ++bin) {
+      out->SetBinContent(static_cast<Int_t>(bin), accumulators[p].sums[bin]);
+      out->SetBinError(static_cast<Int_t>(bin), std::sqrt(accumulators[p].sumw2[bin]));
+    }
+    result.push_back(std::move(out));
+  }
+  return result;
+}
+
+std::vector<std::vector<std::unique_ptr<TH1D>>>
+SparseProjector::project(const std::vector<const THnBase *> &hists,
+                         const std::vector<std::vector<SparseProjection>> &projections) {
+  if (hists.size() != projections.size()) {
+    throw std::runtime_error("SparseProjector: got " + std::to_string(hists.size()) +
+                             " histograms but " + std::to_string(projections.size()) +
+                             " projection lists");
+  }
+  std::vector<std::vector<std::unique_ptr<TH1D>>> results(hists.size());
+  const auto projectOne = [&](unsigned int i) {
+    TDirectory::TContext context(nullptr);
+    results[i] = project(*hists[i], projections[i]);
+  };
+  if (hists.size() > 1 && ROOT::IsImplicitMTEnabled()) {
+    ROOT::EnableThreadSafety();
+    ROOT::TThreadExecutor pool;
+    pool.Foreach(projectOne, ROOT::TSeqU(hists.size()));
+  } else {
+    for (unsigned int i = 0; i < hists.size(); ++i) {
+      projectOne(i);
+    }
+  }
+  return results;
+}
+
+std::map<std::string, std::vector<std::unique_ptr<TH1D>>>
+SparseProjector::projectFile(
+    const std::string &path,
+    const std::map<std::string, std::vector<SparseProjection>> &projections) {
+  std::unique_ptr<TFile> file(TFile::Open(path.c_str(), "READ"));
+  if (!file || file->IsZombie()) {
+    throw std::runtime_error("SparseProjector: cannot open " + path);
+  }
+  std::vector<std::unique_ptr<THnBase>> owned;
+  std::vector<const THnBase *> hists;
+  std::vector<std::vector<SparseProjection>> requests;
+  for (const auto &[name, list] : projections) {
+    std::unique_ptr<THnBase> hist(file->Get<THnBase>(name.c_str()));
+    if (!hist) {
+      throw std::runtime_error("SparseProjector: no THnBase '" + name + "' in " + path);
+    }
+    hists.push_back(hist.get());
+    owned.push_back(std::move(hist));
+    requests.push_back(list);
+  }
+  auto results = project(hists, requests);
+  std::map<std::string, std::vector<std::unique_ptr<TH1D>>> byName;
+  std::size_t i = 0;
+  for (const auto &entry : projections) {
+    byName.emplace(entry.first, std::move(results[i++]));
+  }
+  return byName;
+}
@@ -71,13 +71,25 @@ resolveVariationLabels(ISystematicManager &sysMgr, IDataFrameProvider &dataMgr,
 
 bool hasUsableSystematicColumns(IDataFrameProvider &dataMgr, ISystematicManager &sysMgr,
                                  const std::string &variable, const std::vector<std::string> &variationLabels) {
-  auto df = dataMgr.getDataFrame();
-  const auto existingColumns = df.GetColumnNames();
-  std::unordered_set<std::string> colSet(existingColumns.begin(), existingColumns.end());
+  // Resolve before listing columns: resolving defines deferred variations.
+  std::vector<std::string> variationColumns;
   for (const auto &label : variationLabels) {
     if (label == "Nominal") continue;
     if (!sysMgr.isVariableAffectedBySystematic(variable, label)) continue;
-    if (colSet.count(sysMgr.getVariationColumnName(variable, label))) return true;
+    variationColumns.push_back(sysMgr.getVariationColumnName(variable, label));
+  }
+  auto df = dataMgr.getDataFrame();
+  const auto existingColumns = df.GetColumnNames();
+  std::unordered_set<std::string> colSet(existingColumns.begin(), existingColumns.end());
+  if (const auto *bundle = sysMgr.getVariationBundle(variable); bundle && colSet.count(bundle->column)) {
+    for (const auto &label : bundle->variationLabels) {
+      if (label != "Nominal" &&
+          std::find(variationLabels.begin(), variationLabels.end(), label) != variationLabels.end())
+        return true;
+    }
+  }
+  for (const auto &column : variationColumns) {
+    if (colSet.count(column)) return true;
   }
   return false;
 }
@@ -135,19 +147,36 @@ definePackedInputBundle(IDataFrameProvider &dataMgr, ISystematicManager &sysMgr,
     dataMgr.DefineVector(bundleColumnName, {}, "Float_t", sysMgr);
     return spec;
   }
+  if (nFeatures == 1) {
+    // A registered variation bundle already has the packed layout.
+    const std::string view =
+        defineVariationBundleView(dataMgr, sysMgr, inputFeatures[0], variationLabels, bundleColumnName);
+    if (!view.empty()) {
+      if (view != bundleColumnName) {
+        auto df = dataMgr.getDataFrame();
+        dataMgr.setDataFrame(df.Alias(bundleColumnName, view));
+      }
+      spec.resolvedColumnNames = {view};
+      return spec;
+    }
+  }
+  std::vector<std::vector<std::string>> varColumns(nVariations);
+  for (std::size_t v = 0; v < nVariations; ++v) {
+    for (const auto &feat : inputFeatures) {
+      varColumns[v].push_back(sysMgr.getVariationColumnName(feat, variationLabels[v]));
+    }
+  }
   const auto existingCols = [&]() {
     auto f = dataMgr.getDataFrame();
     const auto cols = f.GetColumnNames();
     return std::unordered_set<std::string>(cols.begin(), cols.end());
   }();
-  std::vector<std::vector<std::string>> varColumns(nVariations);
   for (std::size_t v = 0; v < nVariations; ++v) {
     auto &cols = varColumns[v];
-    cols.reserve(nFeatures);
-    for (const auto &feat : inputFeatures) {
-      const std::string resolved = sysMgr.getVariationColumnName(feat, variationLabels[v]);
-      cols.push_back(existingCols.count(resolved) ? resolved : sysMgr.getVariationColumnName(feat, "Nominal"));
-      spec.resolvedColumnNames.push_back(cols.back());
+    for (std::size_t i = 0; i < nFeatures; ++i) {
+      const auto &feat = inputFeatures[i];
+      if (!existingCols.count(cols[i])) cols[i] = sysMgr.getVariationColumnName(feat, "Nominal");
+      spec.resolvedColumnNames.push_back(cols[i]);
     }
   }
   std::vector<std::string> varBundleNames;
@@ -238,11 +267,13 @@ defineSelectionMaskBundle(IDataFrameProvider &dataMgr, ISystematicManager &sysMg
   }
   std::vector<std::string> resolvedCols;
   resolvedCols.reserve(variationLabels.size());
+  const auto colNames = resolveVariationColumns(sysMgr, selectionColumn, variationLabels);
   auto df = dataMgr.getDataFrame();
   const auto existingColumns = df.GetColumnNames();
   std::unordered_set<std::string> colSet(existingColumns.begin(), existingColumns.end());
-  for (const auto &label : variationLabels) {
-    const std::string colName = sysMgr.getVariationColumnName(selectionColumn, label);
+  for (std::size_t v = 0; v < variationLabels.size(); ++v) {
+    const auto &label = variationLabels[v];
+    const std::string &colName = colNames[v];
     if (colSet.count(colName)) {
       resolvedCols.push_back(colName);
       spec.resolvedColumnNames.push_back(colName);
@@ -332,3 +363,134 @@ fanOutMultiOutputResultBundle(IDataFrameProvider &dataMgr, ISystematicManager &s
   }
   return specs;
 }
+
+std::string
+defineVariationBundleView(IDataFrameProvider &dataMgr, ISystematicManager &sysMgr,
+                          const std::string &variable, const std::vector<std::string> &variationLabels,
+                          const std::string &viewColumnName) {
+  const auto *bundle = sysMgr.getVariationBundle(variable);
+  if (!bundle) return "";
+  if (bundle->variationLabels == variationLabels) return bundle->column;
+
+  const auto &registered = bundle->variationLabels;
+  const auto nominalIt = std::find(registered.begin(), registered.end(), "Nominal");
+  std::vector<std::size_t> blocks;
+  blocks.reserve(variationLabels.size());
+  for (const auto &label : variationLabels) {
+    const auto it = std::find(registered.begin(), registered.end(), label);
+    if (it != registered.end()) {
+      blocks.push_back(static_cast<std::size_t>(it - registered.begin()));
+    } else if (nominalIt != registered.end()) {
+      blocks.push_back(static_cast<std::size_t>(nominalIt - registered.begin()));
+    } else {
+      throw std::runtime_error("defineVariationBundleView: bundle '" + bundle->column + "' of '" + variable +
+                               "' has neither variation '" + label + "' nor a Nominal block.");
+    }
+  }
+
+  auto df = dataMgr.getDataFrame();
+  const auto existingColumns = df.GetColumnNames();
+  if (std::find(existingColumns.begin(), existingColumns.end(), viewColumnName) == existingColumns.end()) {
+    const std::size_t nBlocks = registered.size();
+    df = df.Define(viewColumnName, [blocks, nBlocks](const ROOT::VecOps::RVec<float> &source) -> ROOT::VecOps::RVec<float> {
+      const std::size_t blockSize = source.size() / nBlocks;
+      ROOT::VecOps::RVec<float> out(blocks.size() * blockSize);
+      for (std::size_t k = 0; k < blocks.size(); ++k)
+        std::copy_n(source.begin() + blocks[k] * blockSize, blockSize, out.begin() + k * blockSize);
+      return out;
+    }, {bundle->column});
+    dataMgr.setDataFrame(df);
+  }
+  return viewColumnName;
+}
+
+void fanOutVectorResultBundle(IDataFrameProvider &dataMgr, const std::string &bundleColumnName,
+                              const std::vector<std::string> &outputColumnNames) {
+  const std::size_t nBlocks = outputColumnNames.size();
+  auto df = dataMgr.getDataFrame();
+  const auto existingColumns = df.GetColumnNames();
+  std::unordered_set<std::string> colSet(existingColumns.begin(), existingColumns.end());
+  for (std::size_t k = 0; k < nBlocks; ++k) {
+    const auto &outColName = outputColumnNames[k];
+    if (outColName.empty() || colSet.count(outColName)) continue;
+    df = df.Define(outColName, [k, nBlocks](const ROOT::VecOps::RVec<float> &bundle) -> ROOT::VecOps::RVec<float> {
+      const std::size_t blockSize = bundle.size() / nBlocks;
+      return ROOT::VecOps::RVec<float>(bundle.begin() + k * blockSize, bundle.begin() + (k + 1) * blockSize);
+    }, {bundleColumnName});
+    colSet.insert(outColName);
+  }
+  dataMgr.setDataFrame(df);
+}
+
+ScaledBundleStep makeScaledBundleStep(const ResolvedSystematicBundleOptions &bundle,
+                                      const std::string &inputPtColumn,
+                                      const std::string &inputMassColumn) {
+  ScaledBundleStep step;
+  step.inputPtColumn = inputPtColumn;
+  step.sfBundleColumn = makeBundleColumnName(bundle.bundleTag, "sf");
+  step.ptBundleColumn = makeBundleColumnName(bundle.bundleTag, "pt");
+  step.fanOutOutputs = bundle.fanOutOutputs;
+  if (!inputMassColumn.empty()) {
+    step.inputMassColumn = inputMassColumn;
+    step.massBundleColumn = makeBundleColumnName(bundle.bundleTag, "mass");
+  }
+  step.variationLabels = {"Nominal"};
+  step.ptColumns = {""};
+  step.massColumns = {""};
+  return step;
+}
+
+void addScaledBundleSource(ScaledBundleStep &step, const std::string &source,
+                           const std::string &upPtColumn, const std::string &downPtColumn,
+                           const std::string &upMassColumn, const std::string &downMassColumn) {
+  step.sources.push_back(source);
+  step.variationLabels.push_back(source + "Up");
+  step.variationLabels.push_back(source + "Down");
+  step.ptColumns.push_back(upPtColumn);
+  step.ptColumns.push_back(downPtColumn);
+  step.massColumns.push_back(upMassColumn);
+  step.massColumns.push_back(downMassColumn);
+}
+
+void defineScaledBundles(IDataFrameProvider &dataMgr, ISystematicManager &sysMgr,
+                         const ScaledBundleStep &step) {
+  const bool relative = step.relativeUncertainties;
+  auto applyBundle = [relative](const ROOT::VecOps::RVec<float> &nominal,
+                                const ROOT::VecOps::RVec<float> &sf) -> ROOT::VecOps::RVec<float> {
+    const std::size_t n = nominal.size();
+    ROOT::VecOps::RVec<float> out(n + (relative ? 2 * sf.size() : sf.size()));
+    std::copy(nominal.begin(), nominal.end(), out.begin());
+    if (n == 0) return out;
+    if (!relative) {
+      for (std::size_t j = 0; j < sf.size(); ++j)
+        out[n + j] = nominal[j % n] * sf[j];
+      return out;
+    }
+    for (std::size_t j = 0; j < sf.size(); ++j) {
+      const std::size_t source = j / n;
+      const std::size_t i = j % n;
+      out[n + 2 * source * n + i] = nominal[i] * (1.0f + sf[j]);
+      out[n + (2 * source + 1) * n + i] = nominal[i] * (1.0f - sf[j]);
+    }
+    return out;
+  };
+
+  std::set<std::string> bundleColumns;
+  auto defineBundle = [&](const std::string &input, const std::string &bundleColumn,
+                          const std::vector<std::string> &fanOutColumns) {
+    dataMgr.setDataFrame(dataMgr.defineColumn(dataMgr.getDataFrame(), bundleColumn, applyBundle,
+                                              {input, step.sfBundleColumn}));
+    sysMgr.registerVariationBundle(input, bundleColumn, step.variationLabels);
+    if (step.fanOutOutputs)
+      fanOutVectorResultBundle(dataMgr, bundleColumn, fanOutColumns);
+    bundleColumns.insert(bundleColumn);
+  };
+  defineBundle(step.inputPtColumn, step.ptBundleColumn, step.ptColumns);
+  if (!step.massBundleColumn.empty() && !step.inputMassColumn.empty())
+    defineBundle(step.inputMassColumn, step.massBundleColumn, step.massColumns);
+
+  if (!step.fanOutOutputs) {
+    for (const auto &source : step.sources)
+      sysMgr.registerSystematic(source, bundleColumns);
+  }
+}
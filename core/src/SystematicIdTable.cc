@@ -0,0 +1,71 @@
+#include <SystematicIdTable.h>
+
+namespace {
+
+bool endsWith(const std::string &value, const std::string &suffix) {
+  return value.size() >= suffix.size() &&
+         value.compare(value.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+} // namespace
+
+std::string SystematicIdTable::normalize(const std::string &label) {
+  if (endsWith(label, "Up")) {
+    return label.substr(0, label.size() - 2);
+  }
+  if (endsWith(label, "Down")) {
+    return label.substr(0, label.size() - 4);
+  }
+  return label;
+}
+
+SystematicIdTable::Id SystematicIdTable::internSystematic(const std::string &name) {
+  const std::string normalized = normalize(name);
+  const Id existing = variation(normalized + "Up").systematic;
+  if (existing != npos) {
+    return existing;
+  }
+  const auto id = static_cast<Id>(systematics_m.size());
+  systematics_m.push_back(normalized);
+  // A label always names the systematic it normalizes to: "aUp" is the Up
+  // variation of "a", even if a systematic "aUpUp" was interned as "aUp".
+  labels_m[normalized + "Up"] = {id, Direction::Up};
+  labels_m[normalized + "Down"] = {id, Direction::Down};
+  if (normalize(normalized) == normalized) {
+    labels_m.emplace(normalized, Variation{id, Direction::None});
+  }
+  return id;
+}
+
+SystematicIdTable::Id SystematicIdTable::internVariable(const std::string &name) {
+  const auto [it, inserted] = variableIds_m.emplace(name, static_cast<Id>(variables_m.size()));
+  if (inserted) {
+    variables_m.push_back(name);
+  }
+  return it->second;
+}
+
+SystematicIdTable::Variation SystematicIdTable::variation(const std::string &label) const {
+  const auto it = labels_m.find(label);
+  return it == labels_m.end() ? Variation{} : it->second;
+}
+
+SystematicIdTable::Id SystematicIdTable::systematicId(const std::string &name) const {
+  // The Up label of a systematic exists whether or not its name is a label.
+  return variation(normalize(name) + "Up").systematic;
+}
+
+std::vector<SystematicIdTable::Variation>
+SystematicIdTable::variations(const std::vector<std::string> &labels) const {
+  std::vector<Variation> result;
+  result.reserve(labels.size());
+  for (const auto &label : labels) {
+    result.push_back(variation(label));
+  }
+  return result;
+}
+
+SystematicIdTable::Id SystematicIdTable::variableId(const std::string &name) const {
+  const auto it = variableIds_m.find(name);
+  return it == variableIds_m.end() ? npos : it->second;
+}
@@ -1,26 +1,50 @@
 #include <SystematicManager.h>
+#include <AsyncLogger.h>
+#include <JsonString.h>
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <numeric>
 #include <set>
+#include <sstream>
+#include <stdexcept>
 #include <string>
+#include <unistd.h>
 #include <unordered_map>
 #include <unordered_set>
+#include <utility>
 #include <vector>
 #include <api/IDataFrameProvider.h>
+#include <yaml-cpp/yaml.h>
 
 namespace {
 
-bool endsWith(const std::string &value, const std::string &suffix) {
-  return value.size() >= suffix.size() &&
-         value.compare(value.size() - suffix.size(), suffix.size(), suffix) == 0;
+double sumOf(const std::vector<double> &bins) {
+  return std::accumulate(bins.begin(), bins.end(), 0.0);
 }
 
-std::string normalizeSystematicName(const std::string &syst) {
-  if (endsWith(syst, "Up")) {
-    return syst.substr(0, syst.size() - 2);
+/// Normalization and shape effect of one varied histogram.
+SystematicImpact variationImpact(const std::vector<double> &nominal,
+                                 double nominalSum,
+                                 const std::vector<double> &varied) {
+  SystematicImpact impact;
+  const double variedSum = sumOf(varied);
+  impact.normalization = std::fabs(variedSum / nominalSum - 1.0);
+  if (variedSum == 0.0) {
+    impact.shape = 1.0;
+    return impact;
   }
-  if (endsWith(syst, "Down")) {
-    return syst.substr(0, syst.size() - 4);
+  const std::size_t n = std::max(nominal.size(), varied.size());
+  double distance = 0.0;
+  for (std::size_t i = 0; i < n; ++i) {
+    const double nom = i < nominal.size() ? nominal[i] / nominalSum : 0.0;
+    const double var = i < varied.size() ? varied[i] / variedSum : 0.0;
+    distance += std::fabs(var - nom);
   }
-  return syst;
+  impact.shape = 0.5 * distance;
+  return impact;
 }
 
 } // namespace
@@ -32,10 +56,25 @@ std::string normalizeSystematicName(const std::string &syst) {
  */
 void SystematicManager::registerSystematic(
     const std::string &syst, const std::set<std::string> &affectedVariables) {
-  const std::string normalizedSyst = normalizeSystematicName(syst);
+  const std::string normalizedSyst = SystematicIdTable::normalize(syst);
+  if (prunedSystematics_m.count(normalizedSyst) != 0) {
+    return;
+  }
+  const auto systId = ids_m.internSystematic(normalizedSyst);
+  if (variablesBySystematic_m.size() <= systId) {
+    variablesBySystematic_m.resize(systId + 1);
+  }
   for (const auto &var : affectedVariables) {
-    systematicToVariableMap_m[normalizedSyst].insert(var);
+    variablesBySystematic_m[systId].insert(var);
     variableToSystematicMap_m[var].insert(normalizedSyst);
+    const auto varId = ids_m.internVariable(var);
+    if (affected_m.size() <= varId) {
+      affected_m.resize(varId + 1);
+    }
+    if (affected_m[varId].size() <= systId) {
+      affected_m[varId].resize(ids_m.systematicCount(), false);
+    }
+    affected_m[varId][systId] = true;
   }
   systematics_m.insert(normalizedSyst);
 }
@@ -48,12 +87,30 @@ void SystematicManager::registerVariationColumns(
     return;
   }
 
-  const std::string normalizedSyst = normalizeSystematicName(systematicName);
+  const std::string normalizedSyst = SystematicIdTable::normalize(systematicName);
+  if (prunedSystematics_m.count(normalizedSyst) != 0) {
+    return;
+  }
   registerSystematic(normalizedSyst, {variable});
   variationColumnMap_m[variable][normalizedSyst + "Up"] = upColumn;
   variationColumnMap_m[variable][normalizedSyst + "Down"] = downColumn;
 }
 
+void SystematicManager::registerVariationBundle(
+    const std::string &variable, const std::string &bundleColumn,
+    const std::vector<std::string> &variationLabels) {
+  if (variable.empty() || bundleColumn.empty() || variationLabels.empty()) {
+    return;
+  }
+  variationBundles_m[variable] = {bundleColumn, variationLabels};
+}
+
+const SystematicVariationBundle *
+SystematicManager::getVariationBundle(const std::string &variable) const {
+  const auto it = variationBundles_m.find(variable);
+  return it == variationBundles_m.end() ? nullptr : &it->second;
+}
+
 /**
  * @brief Get the set of all registered systematics
  * @return Reference to the set of systematic names
@@ -70,10 +127,23 @@ const std::set<std::string> &SystematicManager::getSystematics() const {
 const std::set<std::string> &
 SystematicManager::getVariablesForSystematic(const std::string &syst) const {
   static const std::set<std::string> empty;
-  auto it = systematicToVariableMap_m.find(normalizeSystematicName(syst));
-  return it != systematicToVariableMap_m.end() ? it->second : empty;
+  const auto systId = ids_m.variation(syst).systematic;
+  return systId < variablesBySystematic_m.size() ? variablesBySystematic_m[systId] : empty;
+}
+
+bool SystematicManager::isVariableAffectedBySystematic(const std::string &variable,
+                                                       const std::string &syst) const {
+  return isVariableAffected(ids_m.variableId(variable), ids_m.variation(syst).systematic);
 }
 
+bool SystematicManager::isVariableAffected(SystematicIdTable::Id variable,
+                                           SystematicIdTable::Id systematic) const {
+  return variable < affected_m.size() && systematic < affected_m[variable].size() &&
+         affected_m[variable][systematic];
+}
+
+const SystematicIdTable &SystematicManager::getSystematicIds() const { return ids_m; }
+
 /**
  * @brief Get the set of systematics affecting a given variable
  * @param var Name of the variable
@@ -88,6 +158,15 @@ SystematicManager::getSystematicsForVariable(const std::string &var) const {
 
 std::string SystematicManager::getVariationColumnName(
     const std::string &variable, const std::string &syst) const {
+  std::string column = resolveVariationColumnName(variable, syst);
+  if (columnMaterializer_m && column != variable) {
+    columnMaterializer_m(column);
+  }
+  return column;
+}
+
+std::string SystematicManager::resolveVariationColumnName(
+    const std::string &variable, const std::string &syst) const {
   auto varIt = variationColumnMap_m.find(variable);
   if (varIt != variationColumnMap_m.end()) {
     auto explicitIt = varIt->second.find(syst);
@@ -102,6 +181,11 @@ std::string SystematicManager::getVariationColumnName(
   return variable;
 }
 
+void SystematicManager::setColumnMaterializer(
+    std::function<void(const std::string &)> materializer) {
+  columnMaterializer_m = std::move(materializer);
+}
+
 /**
  * @brief Register existing systematics from configuration and column list
  * @param systConfig Vector of systematic names from configuration
@@ -285,4 +369,130 @@ SystematicValidationResult SystematicManager::autoRegisterSystematics(
  */
 bool SystematicManager::isBranchNameMaterialized(const std::string &branchName) const {
   return materializedSystLists_m.count(branchName) != 0;
-}
\ No newline at end of file
+}
+
+void SystematicManager::recordSystematicImpact(
+    const std::string &syst, const std::vector<double> &nominal,
+    const std::vector<double> &up, const std::vector<double> &down) {
+  if (sumOf(nominal) == 0.0) {
+    return;
+  }
+  const SystematicImpact impact = measureImpact(nominal, up, down);
+  SystematicImpact &recorded = impacts_m[SystematicIdTable::normalize(syst)];
+  recorded.normalization = std::max(recorded.normalization, impact.normalization);
+  recorded.shape = std::max(recorded.shape, impact.shape);
+}
+
+SystematicImpact
+SystematicManager::measureImpact(const std::vector<double> &nominal,
+                                 const std::vector<double> &up,
+                                 const std::vector<double> &down) {
+  const double nominalSum = sumOf(nominal);
+  if (nominalSum == 0.0) {
+    return {};
+  }
+  const SystematicImpact upImpact = variationImpact(nominal, nominalSum, up);
+  const SystematicImpact downImpact = variationImpact(nominal, nominalSum, down);
+  return {std::max(upImpact.normalization, downImpact.normalization),
+          std::max(upImpact.shape, downImpact.shape)};
+}
+
+const std::map<std::string, SystematicImpact> &
+SystematicManager::getSystematicImpacts() const {
+  return impacts_m;
+}
+
+std::vector<std::string>
+SystematicManager::selectPrunableSystematics(double normThreshold,
+                                             double shapeThreshold) const {
+  std::vector<std::string> prunable;
+  for (const auto &[syst, impact] : impacts_m) {
+    if (impact.normalization < normThreshold && impact.shape < shapeThreshold) {
+      prunable.push_back(syst);
+    }
+  }
+  return prunable;
+}
+
+void SystematicManager::writePruningReport(const std::string &path,
+                                           double normThreshold,
+                                           double shapeThreshold) const {
+  const std::vector<std::string> pruned =
+      selectPrunableSystematics(normThreshold, shapeThreshold);
+  double merged = 0.0;
+  for (const auto &syst : pruned) {
+    const double norm = impacts_m.at(syst).normalization;
+    merged += norm * norm;
+  }
+
+  std::ostringstream out;
+  out << "{\n  \"norm_threshold\": " << normThreshold
+      << ",\n  \"shape_threshold\": " << shapeThreshold
+      << ",\n  \"impacts\": {";
+  bool first = true;
+  for (const auto &[syst, impact] : impacts_m) {
+    out << (first ? "\n" : ",\n") << "    " << jsonString(syst)
+        << ": {\"normalization\": " << impact.normalization
+        << ", \"shape\": " << impact.shape << "}";
+    first = false;
+  }
+  out << (first ? "" : "\n  ") << "},\n  \"pruned\": [";
+  for (std::size_t i = 0; i < pruned.size(); ++i) {
+    out << (i > 0 ? ", " : "") << jsonString(pruned[i]);
+  }
+  out << "],\n  \"merged_normalization\": " << std::sqrt(merged) << "\n}\n";
+
+  // Write to a temporary file first so readers never see a partial report.
+  const std::string tmpPath = path + ".tmp." + std::to_string(getpid());
+  {
+    std::ofstream file(tmpPath);
+    if (!file) {
+      throw std::runtime_error("SystematicManager: cannot write '" + path + "'");
+    }
+    file << out.str();
+  }
+  std::filesystem::rename(tmpPath, path);
+}
+
+std::vector<std::string>
+SystematicManager::readPrunedSystematics(const std::string &path) {
+  std::vector<std::string> pruned;
+  if (path.empty() || !std::filesystem::exists(path)) {
+    return pruned;
+  }
+  try {
+    const YAML::Node root = YAML::LoadFile(path);
+    for (const auto &syst : root["pruned"]) {
+      pruned.push_back(syst.as<std::string>());
+    }
+  } catch (const YAML::Exception &e) {
+    RDF_LOG_WARN << "Warning: SystematicManager: cannot parse '" << path
+                 << "': " << e.what();
+  }
+  return pruned;
+}
+
+void SystematicManager::setPrunedSystematics(
+    const std::vector<std::string> &systematics) {
+  for (const auto &syst : systematics) {
+    const std::string normalizedSyst = SystematicIdTable::normalize(syst);
+    prunedSystematics_m.insert(normalizedSyst);
+    systematics_m.erase(normalizedSyst);
+    const auto systId = ids_m.systematicId(normalizedSyst);
+    if (systId < variablesBySystematic_m.size()) {
+      for (const auto &var : variablesBySystematic_m[systId]) {
+        variableToSystematicMap_m[var].erase(normalizedSyst);
+        affected_m[ids_m.variableId(var)][systId] = false;
+      }
+      variablesBySystematic_m[systId].clear();
+    }
+    for (auto &[variable, columns] : variationColumnMap_m) {
+      columns.erase(normalizedSyst + "Up");
+      columns.erase(normalizedSyst + "Down");
+    }
+  }
+}
+
+const std::set<std::string> &SystematicManager::getPrunedSystematics() const {
+  return prunedSystematics_m;
+}
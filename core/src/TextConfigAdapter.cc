@@ -2,10 +2,6 @@
 #include <fstream>
 #include <stdexcept>
 
-std::string TextConfigAdapter::stripComment(const std::string &line) const {
-  return line.substr(0, line.find("#"));
-}
-
 std::string_view TextConfigAdapter::trim(std::string_view s) const {
   size_t first = s.find_first_not_of(" \t\n\r");
   size_t last = s.find_last_not_of(" \t\n\r");
@@ -15,59 +11,61 @@ std::string_view TextConfigAdapter::trim(std::string_view s) const {
   return s.substr(first, last - first + 1);
 }
 
-std::pair<std::string, std::string>
-TextConfigAdapter::parsePair(const std::string &line, bool stripComments) const {
-  std::string processedLine = stripComments ? stripComment(line) : line;
-  auto splitIndex = processedLine.find("=");
-  if (splitIndex == std::string::npos) {
-    return {"", ""};
+std::pair<std::string_view, std::string_view>
+TextConfigAdapter::parsePair(std::string_view line) const {
+  auto splitIndex = line.find('=');
+  if (splitIndex == std::string_view::npos) {
+    return {};
   }
-  auto key = std::string(trim(processedLine.substr(0, splitIndex)));
-  auto value = std::string(trim(processedLine.substr(splitIndex + 1)));
-  return {key, value};
+  return {trim(line.substr(0, splitIndex)), trim(line.substr(splitIndex + 1))};
 }
 
-std::vector<std::string>
-TextConfigAdapter::splitString(std::string_view input,
-                               std::string_view delimiter) const {
-  std::vector<std::string> splitStringVector;
-  size_t pos = 0, prev = 0;
-  while ((pos = input.find(delimiter, prev)) != std::string_view::npos) {
-    auto token = trim(input.substr(prev, pos - prev));
-    if (!token.empty()) {
-      splitStringVector.emplace_back(token);
-    }
-    prev = pos + delimiter.size();
+namespace {
+
+/// Whole contents of @p configFile in one buffer; throws naming @p caller.
+std::string readConfigFile(const std::string &configFile, const char *caller) {
+  std::ifstream file(configFile, std::ios::binary | std::ios::ate);
+  if (!file.is_open()) {
+    throw std::runtime_error("Error: Configuration file '" + configFile +
+                             "' could not be opened in " + caller + ".");
   }
-  auto token = trim(input.substr(prev));
-  if (!token.empty()) {
-    splitStringVector.emplace_back(token);
+  std::string buffer(static_cast<std::size_t>(file.tellg()), '\0');
+  file.seekg(0);
+  file.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+  return buffer;
+}
+
+/// Calls @p onLine with each line of @p buffer, comments removed.
+template <typename OnLine> void forEachLine(std::string_view buffer, OnLine &&onLine) {
+  std::size_t start = 0;
+  while (start <= buffer.size()) {
+    std::size_t end = buffer.find('\n', start);
+    if (end == std::string_view::npos) {
+      end = buffer.size();
+    }
+    std::string_view line = buffer.substr(start, end - start);
+    onLine(line.substr(0, line.find('#')));
+    start = end + 1;
   }
-  return splitStringVector;
 }
 
+} // namespace
+
 std::unordered_map<std::string, std::string>
 TextConfigAdapter::parsePairBasedConfig(const std::string &configFile) const {
   std::unordered_map<std::string, std::string> configMap;
-  std::ifstream file(configFile);
-  if (file.is_open()) {
-    std::string line;
-    while (std::getline(file, line)) {
-      auto [key, value] = parsePair(line, true);
-      if (!key.empty()) {
-        if (configMap.find(key) != configMap.end()) {
-          throw std::runtime_error(
-              "Error: Key " + key + " already exists in config " + configFile +
-              ". Do not use the same key twice in the same config.");
-        }
-        configMap.emplace(key, value);
-      }
+  const std::string buffer = readConfigFile(configFile, "parsePairBasedConfig");
+  forEachLine(buffer, [&](std::string_view line) {
+    auto [key, value] = parsePair(line);
+    if (key.empty()) {
+      return;
     }
-    file.close();
-  } else {
-    throw std::runtime_error("Error: Configuration file '" + configFile +
-                             "' could not be opened in parsePairBasedConfig.");
-  }
+    if (!configMap.emplace(key, value).second) {
+      throw std::runtime_error(
+          "Error: Key " + std::string(key) + " already exists in config " + configFile +
+          ". Do not use the same key twice in the same config.");
+    }
+  });
   return configMap;
 }
 
@@ -76,68 +74,51 @@ TextConfigAdapter::parseMultiKeyConfig(
     const std::string &configFile,
     const std::vector<std::string> &requiredEntryKeys) const {
   std::vector<std::unordered_map<std::string, std::string>> parsedConfig;
-
-  std::ifstream file(configFile);
-  if (!file.is_open()) {
-    throw std::runtime_error("Error: Configuration file '" + configFile +
-                             "' could not be opened in parseMultiKeyConfig.");
-    return parsedConfig;
-  }
-
-  std::string line;
-  while (std::getline(file, line)) {
-    line = trim(line.substr(0, line.find("#")));
+  const std::string buffer = readConfigFile(configFile, "parseMultiKeyConfig");
+  forEachLine(buffer, [&](std::string_view rawLine) {
+    const std::string_view line = trim(rawLine);
     if (line.empty()) {
-      continue;
+      return;
     }
 
     std::unordered_map<std::string, std::string> entryKeys;
-    auto splitEntry = splitString(line, " ");
-    for (auto &pair : splitEntry) {
-      auto [key, value] = parsePair(pair, false);
+    std::size_t prev = 0;
+    while (prev <= line.size()) {
+      std::size_t pos = line.find(' ', prev);
+      if (pos == std::string_view::npos) {
+        pos = line.size();
+      }
+      auto [key, value] = parsePair(line.substr(prev, pos - prev));
       if (!key.empty() && !value.empty()) {
-        if (entryKeys.find(key) != entryKeys.end()) {
+        if (!entryKeys.emplace(key, value).second) {
           throw std::runtime_error(
-              "Error: Key " + key + " already exists in entry " + line +
-              " in config " + configFile +
+              "Error: Key " + std::string(key) + " already exists in entry " +
+              std::string(line) + " in config " + configFile +
               ". Do not use the same key twice in the same entry.");
         }
-        entryKeys[key] = value;
       }
+      prev = pos + 1;
     }
 
-    bool allEntryKeysFound = true;
     for (const auto &entryKey : requiredEntryKeys) {
       if (entryKeys.find(entryKey) == entryKeys.end()) {
-        allEntryKeysFound = false;
-        break;
+        return;
       }
     }
-    if (allEntryKeysFound) {
-      parsedConfig.push_back(entryKeys);
-    }
-  }
-
-  file.close();
+    parsedConfig.push_back(std::move(entryKeys));
+  });
   return parsedConfig;
 }
 
 std::vector<std::string>
 TextConfigAdapter::parseVectorConfig(const std::string &configFile) const {
   std::vector<std::string> configVector;
-  std::ifstream file(configFile);
-  if (file.is_open()) {
-    std::string line;
-    while (std::getline(file, line)) {
-      line = trim(line.substr(0, line.find("#")));
-      if (!line.empty()) {
-        configVector.push_back(line);
-      }
+  const std::string buffer = readConfigFile(configFile, "parseVectorConfig");
+  forEachLine(buffer, [&](std::string_view rawLine) {
+    const std::string_view line = trim(rawLine);
+    if (!line.empty()) {
+      configVector.emplace_back(line);
     }
-    file.close();
-  } else {
-    throw std::runtime_error("Error: Configuration file '" + configFile +
-                             "' could not be opened in parseVectorConfig.");
-  }
+  });
   return configVector;
 }
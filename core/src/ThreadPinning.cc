@@ -0,0 +1,143 @@
+#include <ThreadPinning.h>
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <sched.h>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+
+std::atomic<ThreadPinning *> ThreadPinning::active_s{nullptr};
+
+namespace {
+
+/// CPU the calling thread is pinned to (-1: not pinned).
+thread_local int pinnedCpu = -1;
+
+/// CPUs of the process affinity mask.
+std::set<int> allowedCpus() {
+  std::set<int> cpus;
+  cpu_set_t mask;
+  CPU_ZERO(&mask);
+  if (sched_getaffinity(0, sizeof(mask), &mask) == 0) {
+    for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+      if (CPU_ISSET(cpu, &mask)) {
+        cpus.insert(cpu);
+      }
+    }
+  }
+  return cpus;
+}
+
+} // namespace
+
+std::vector<int> ThreadPinning::parseCpuList(const std::string &list) {
+  std::vector<int> cpus;
+  std::stringstream ranges(list);
+  for (std::string range; std::getline(ranges, range, ',');) {
+    range.erase(0, range.find_first_not_of(" \t\n"));
+    range.erase(range.find_last_not_of(" \t\n") + 1);
+    if (range.empty()) {
+      continue;
+    }
+    try {
+      const auto dash = range.find('-');
+      const int first = std::stoi(range.substr(0, dash));
+      const int last = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+      for (int cpu = first; cpu <= last; ++cpu) {
+        cpus.push_back(cpu);
+      }
+    } catch (const std::exception &) {
+      throw std::runtime_error("ThreadPinning: invalid CPU list '" + list + "'");
+    }
+  }
+  return cpus;
+}
+
+std::vector<ThreadPinning::Node> ThreadPinning::readTopology() {
+  const std::set<int> allowed = allowedCpus();
+  std::vector<Node> nodes;
+  const std::filesystem::path root("/sys/devices/system/node");
+  std::error_code ec;
+  for (const auto &entry : std::filesystem::directory_iterator(root, ec)) {
+    const std::string name = entry.path().filename().string();
+    if (name.rfind("node", 0) != 0 ||
+        name.find_first_not_of("0123456789", 4) != std::string::npos || name.size() == 4) {
+      continue;
+    }
+    std::ifstream cpulist(entry.path() / "cpulist");
+    std::string list;
+    if (!cpulist || !std::getline(cpulist, list)) {
+      continue;
+    }
+    Node node;
+    node.id = std::stoi(name.substr(4));
+    for (const int cpu : parseCpuList(list)) {
+      if (allowed.count(cpu)) {
+        node.cpus.push_back(cpu);
+      }
+    }
+    if (!node.cpus.empty()) {
+      nodes.push_back(std::move(node));
+    }
+  }
+  if (nodes.empty()) {
+    nodes.push_back(Node{0, std::vector<int>(allowed.begin(), allowed.end())});
+  }
+  std::sort(nodes.begin(), nodes.end(),
+            [](const Node &a, const Node &b) { return a.id < b.id; });
+  return nodes;
+}
+
+ThreadPinning::ThreadPinning(std::vector<Node> topology) : topology_m(std::move(topology)) {
+  const std::set<int> original = allowedCpus();
+  originalCpus_m.assign(original.begin(), original.end());
+  for (const auto &node : topology_m) {
+    for (const int cpu : node.cpus) {
+      cpus_m.push_back(cpu);
+      nodes_m.push_back(node.id);
+    }
+  }
+  if (cpus_m.empty()) {
+    throw std::runtime_error("ThreadPinning: no CPUs to pin threads to");
+  }
+}
+
+ThreadPinning::~ThreadPinning() {
+  ThreadPinning *self = this;
+  active_s.compare_exchange_strong(self, nullptr);
+}
+
+void ThreadPinning::activate(ThreadPinning *pinning) {
+  active_s.store(pinning, std::memory_order_release);
+}
+
+void ThreadPinning::pin(unsigned int slot) {
+  // RDataFrame keeps a thread on the same slot, so this is usually a no-op.
+  const int cpu = cpuOfSlot(slot);
+  if (cpu == pinnedCpu) {
+    return;
+  }
+  cpu_set_t mask;
+  CPU_ZERO(&mask);
+  CPU_SET(cpu, &mask);
+  if (sched_setaffinity(0, sizeof(mask), &mask) == 0) {
+    pinnedCpu = cpu;
+    pinned_m.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+void ThreadPinning::unpin() const {
+  if (pinnedCpu < 0 || originalCpus_m.empty()) {
+    return;
+  }
+  cpu_set_t mask;
+  CPU_ZERO(&mask);
+  for (const int cpu : originalCpus_m) {
+    CPU_SET(cpu, &mask);
+  }
+  if (sched_setaffinity(0, sizeof(mask), &mask) == 0) {
+    pinnedCpu = -1;
+  }
+}
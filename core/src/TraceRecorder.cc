@@ -0,0 +1,145 @@
+#include <TraceRecorder.h>
+#include <JsonString.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <unistd.h>
+
+namespace {
+
+/// Microseconds of the steady clock, the time unit of the trace format.
+double micros(TraceRecorder::Clock::time_point time) {
+  return std::chrono::duration<double, std::micro>(time.time_since_epoch()).count();
+}
+
+} // namespace
+
+TraceRecorder &TraceRecorder::instance() {
+  static TraceRecorder recorder;
+  return recorder;
+}
+
+void TraceRecorder::enable() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_m);
+    mainThread_m = std::this_thread::get_id();
+    if (std::find(threads_m.begin(), threads_m.end(), mainThread_m) == threads_m.end()) {
+      threads_m.insert(threads_m.begin(), mainThread_m);
+    }
+  }
+  enabled_m.store(true, std::memory_order_relaxed);
+}
+
+void TraceRecorder::record(std::string name, const char *category, Clock::time_point begin,
+                           Clock::time_point end,
+                           std::vector<std::pair<std::string, std::string>> args) {
+  if (!enabled()) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(mutex_m);
+  events_m.push_back(
+      Event{std::move(name), category, threadTrack(), begin, end, std::move(args)});
+}
+
+void TraceRecorder::recordSlot(unsigned int slot, std::string name, const char *category,
+                               Clock::time_point begin, Clock::time_point end,
+                               std::vector<std::pair<std::string, std::string>> args) {
+  if (!enabled()) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(mutex_m);
+  events_m.push_back(Event{std::move(name), category, kSlotTrackBase + slot, begin, end,
+                           std::move(args)});
+}
+
+std::uint32_t TraceRecorder::threadTrack() {
+  const auto id = std::this_thread::get_id();
+  const auto it = std::find(threads_m.begin(), threads_m.end(), id);
+  if (it != threads_m.end()) {
+    return static_cast<std::uint32_t>(it - threads_m.begin());
+  }
+  threads_m.push_back(id);
+  return static_cast<std::uint32_t>(threads_m.size() - 1);
+}
+
+std::vector<TraceRecorder::Event> TraceRecorder::events() const {
+  std::lock_guard<std::mutex> lock(mutex_m);
+  return events_m;
+}
+
+std::string TraceRecorder::trackName(std::uint32_t track) const {
+  if (track >= kSlotTrackBase) {
+    return "slot " + std::to_string(track - kSlotTrackBase);
+  }
+  std::lock_guard<std::mutex> lock(mutex_m);
+  if (track < threads_m.size() && threads_m[track] == mainThread_m) {
+    return "main";
+  }
+  return "thread " + std::to_string(track);
+}
+
+void TraceRecorder::clear() {
+  std::lock_guard<std::mutex> lock(mutex_m);
+  events_m.clear();
+}
+
+void TraceRecorder::writeChromeTrace(const std::string &path) const {
+  const auto recorded = events();
+  const int pid = static_cast<int>(getpid());
+
+  std::ostringstream out;
+  out << std::fixed << std::setprecision(3);
+  out << "{\n  \"displayTimeUnit\": \"ms\",\n  \"traceEvents\": [\n";
+  out << "    {\"name\": \"process_name\", \"ph\": \"M\", \"pid\": " << pid
+      << ", \"tid\": 0, \"args\": {\"name\": \"RDFAnalyzer\"}}";
+
+  // Name the tracks; slots sort after the threads.
+  std::set<std::uint32_t> tracks;
+  for (const auto &event : recorded) {
+    tracks.insert(event.track);
+  }
+  for (const std::uint32_t track : tracks) {
+    out << ",\n    {\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": " << pid
+        << ", \"tid\": " << track << ", \"args\": {\"name\": " << jsonString(trackName(track))
+        << "}},\n    {\"name\": \"thread_sort_index\", \"ph\": \"M\", \"pid\": " << pid
+        << ", \"tid\": " << track << ", \"args\": {\"sort_index\": " << track << "}}";
+  }
+
+  for (const auto &event : recorded) {
+    out << ",\n    {\"name\": " << jsonString(event.name)
+        << ", \"cat\": " << jsonString(event.category) << ", \"ph\": \"X\", \"pid\": " << pid
+        << ", \"tid\": " << event.track << ", \"ts\": " << micros(event.begin)
+        << ", \"dur\": " << std::max(0.0, micros(event.end) - micros(event.begin));
+    if (!event.args.empty()) {
+      out << ", \"args\": {";
+      for (std::size_t i = 0; i < event.args.size(); ++i) {
+        out << (i ? ", " : "") << jsonString(event.args[i].first) << ": "
+            << jsonString(event.args[i].second);
+      }
+      out << "}";
+    }
+    out << "}";
+  }
+  out << "\n  ]\n}\n";
+
+  const std::filesystem::path target(path);
+  if (target.has_parent_path()) {
+    std::filesystem::create_directories(target.parent_path());
+  }
+  // Write to a temporary file first so readers never see a partial trace.
+  const std::string tmpPath = path + ".tmp." + std::to_string(pid);
+  {
+    std::ofstream file(tmpPath);
+    if (!file) {
+      throw std::runtime_error("TraceRecorder: cannot write '" + path + "'");
+    }
+    file << out.str();
+  }
+  std::filesystem::rename(tmpPath, path);
+}
@@ -0,0 +1,116 @@
+#include <TraceService.h>
+#include <api/IConfigurationProvider.h>
+#include <api/IDataFrameProvider.h>
+#include <ROOT/RDF/RActionImpl.hxx>
+#include <stdexcept>
+
+namespace {
+
+/**
+ * @brief Records every task of the event loop as a span on the track of its
+ *        slot.
+ *
+ * RDataFrame initializes its actions once the computation graph has been
+ * jitted, just before the first entry, and calls InitTask() and
+ * FinalizeTask() on the thread of the slot around each task.
+ */
+class TraceTaskAction : public ROOT::Detail::RDF::RActionImpl<TraceTaskAction> {
+public:
+  using Result_t = ULong64_t;
+
+  explicit TraceTaskAction(std::shared_ptr<TraceService::Loop> loop)
+      : loop_m(std::move(loop)), result_m(std::make_shared<Result_t>(0)) {}
+
+  TraceTaskAction(TraceTaskAction &&) = default;
+  TraceTaskAction(const TraceTaskAction &) = delete;
+
+  std::shared_ptr<Result_t> GetResultPtr() const { return result_m; }
+
+  void Initialize() {
+    auto &recorder = TraceRecorder::instance();
+    loop_m->start = TraceRecorder::Clock::now();
+    if (loop_m->triggerMarked) {
+      recorder.record("jit", "jit", loop_m->trigger, loop_m->start);
+      loop_m->triggerMarked = false;
+    }
+  }
+
+  void InitTask(TTreeReader *, unsigned int slot) {
+    auto &task = loop_m->slots[slot];
+    task.begin = TraceRecorder::Clock::now();
+    task.entries = 0;
+  }
+
+  void Exec(unsigned int slot, ULong64_t) { ++loop_m->slots[slot].entries; }
+
+  ROOT::RDF::SampleCallback_t GetSampleCallback() {
+    auto loop = loop_m;
+    return [loop](unsigned int slot, const ROOT::RDF::RSampleInfo &info) {
+      loop->slots[slot].file = info.AsString();
+    };
+  }
+
+  void FinalizeTask(unsigned int slot) {
+    auto &task = loop_m->slots[slot];
+    task.total += task.entries;
+    std::vector<std::pair<std::string, std::string>> args{
+        {"entries", std::to_string(task.entries)}};
+    if (!task.file.empty()) {
+      args.emplace_back("input", task.file);
+    }
+    TraceRecorder::instance().recordSlot(slot, "task", "task", task.begin,
+                                         TraceRecorder::Clock::now(), std::move(args));
+  }
+
+  void Finalize() {
+    *result_m = 0;
+    for (const auto &task : loop_m->slots) {
+      *result_m += task.total;
+    }
+    TraceRecorder::instance().record("event_loop", "loop", loop_m->start,
+                                     TraceRecorder::Clock::now(),
+                                     {{"entries", std::to_string(*result_m)}});
+  }
+
+  std::string GetActionName() const { return "TraceTasks"; }
+
+private:
+  std::shared_ptr<TraceService::Loop> loop_m;
+  std::shared_ptr<Result_t> result_m;
+};
+
+} // namespace
+
+void TraceService::initialize(ManagerContext &ctx) {
+  path_m = ctx.config.get("traceFile");
+  if (path_m.empty()) {
+    throw std::runtime_error("TraceService: traceFile is not set");
+  }
+  auto &recorder = TraceRecorder::instance();
+  if (!recorder.enabled()) {
+    recorder.enable();
+  }
+
+  // Booked before any filter, so that every entry of a task is counted.
+  auto df = ctx.data.getDataFrame();
+  loop_m = std::make_shared<Loop>(df.GetNSlots());
+  result_m = df.Book<ULong64_t>(TraceTaskAction(loop_m), {"rdfentry_"});
+}
+
+void TraceService::finalize(ROOT::RDF::RNode &) {}
+
+void TraceService::markEventLoopTrigger() {
+  if (loop_m) {
+    loop_m->trigger = TraceRecorder::Clock::now();
+    loop_m->triggerMarked = true;
+  }
+}
+
+void TraceService::write() const {
+  TraceRecorder::instance().writeChromeTrace(path_m);
+}
+
+std::unordered_map<std::string, std::string>
+TraceService::collectProvenanceEntries() const {
+  return {{"service.trace.file", path_m}};
+}
@@ -0,0 +1,281 @@
+#include <TrainingShuffler.h>
+#include <api/IConfigurationProvider.h>
+
+#include <algorithm>
+#include <numeric>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+
+constexpr std::size_t kAppend = static_cast<std::size_t>(-1);
+
+/// Empty column of the same type as @p data.
+ColumnChunker::Data emptyLike(const ColumnChunker::Data &data) {
+  return std::visit(
+      [](const auto &values) -> ColumnChunker::Data {
+        return std::decay_t<decltype(values)>();
+      },
+      data);
+}
+
+/// Make @p rows an empty chunk with the columns of @p like.
+void resetLike(ColumnChunker::Chunk &rows, const ColumnChunker::Chunk &like) {
+  rows.columns = like.columns;
+  rows.dtypes = like.dtypes;
+  rows.offsets.assign(like.columns.size(), {});
+  rows.data.clear();
+  for (const auto &data : like.data) {
+    rows.data.push_back(emptyLike(data));
+  }
+  rows.rows = 0;
+}
+
+/// Values of a label column as integers.
+std::vector<std::int64_t> labelsOf(const ColumnChunker::Data &data) {
+  return std::visit(
+      [](const auto &values) {
+        std::vector<std::int64_t> labels(values.size());
+        std::transform(values.begin(), values.end(), labels.begin(),
+                       [](auto value) { return static_cast<std::int64_t>(value); });
+        return labels;
+      },
+      data);
+}
+
+std::size_t parseCount(const IConfigurationProvider &configProvider, const std::string &key,
+                       std::size_t fallback) {
+  const std::string value = configProvider.get(key);
+  if (value.empty()) {
+    return fallback;
+  }
+  try {
+    std::size_t end = 0;
+    const auto parsed = std::stoull(value, &end);
+    if (end == value.size() && parsed > 0) {
+      return static_cast<std::size_t>(parsed);
+    }
+  } catch (const std::exception &) {
+  }
+  throw std::runtime_error("TrainingSettings: invalid " + key + " '" + value + "'");
+}
+
+/// "label:fraction,label:fraction" of trainingClassFractions.
+std::map<std::int64_t, double> parseFractions(const std::string &value) {
+  std::map<std::int64_t, double> fractions;
+  std::stringstream entries(value);
+  std::string entry;
+  while (std::getline(entries, entry, ',')) {
+    if (entry.find_first_not_of(" \t") == std::string::npos) {
+      continue;
+    }
+    const auto colon = entry.find(':');
+    try {
+      if (colon == std::string::npos) {
+        throw std::invalid_argument(entry);
+      }
+      const double fraction = std::stod(entry.substr(colon + 1));
+      if (!(fraction >= 0.0 && fraction <= 1.0)) {
+        throw std::invalid_argument(entry);
+      }
+      fractions[std::stoll(entry.substr(0, colon))] = fraction;
+    } catch (const std::exception &) {
+      throw std::runtime_error("TrainingSettings: invalid trainingClassFractions entry '" +
+                               entry + "'; expected label:fraction with a fraction in [0, 1]");
+    }
+  }
+  return fractions;
+}
+
+} // namespace
+
+TrainingSettings TrainingSettings::fromConfig(const IConfigurationProvider &configProvider,
+                                              std::size_t chunkRows) {
+  TrainingSettings settings;
+  settings.labelColumn = configProvider.get("trainingLabelColumn");
+  if (settings.labelColumn.empty()) {
+    throw std::runtime_error("TrainingSettings: skimOutputFormat=training requires "
+                             "trainingLabelColumn");
+  }
+  settings.weightColumn = configProvider.get("trainingWeightColumn");
+  settings.chunkRows = chunkRows;
+  settings.shuffleRows = parseCount(configProvider, "trainingShuffleRows", settings.shuffleRows);
+  settings.classFractions = parseFractions(configProvider.get("trainingClassFractions"));
+  const std::string seed = configProvider.get("trainingSeed");
+  if (!seed.empty()) {
+    try {
+      settings.seed = std::stoull(seed);
+    } catch (const std::exception &) {
+      throw std::runtime_error("TrainingSettings: invalid trainingSeed '" + seed + "'");
+    }
+  }
+  return settings;
+}
+
+TrainingShuffler::TrainingShuffler(TrainingSettings settings, unsigned int nSlots, Emit emit)
+    : settings_m(std::move(settings)), slots_m(std::max(nSlots, 1u)), emit_m(std::move(emit)) {
+  if (settings_m.chunkRows == 0 || settings_m.shuffleRows == 0) {
+    throw std::invalid_argument("TrainingShuffler: chunk and shuffle buffer sizes must be positive");
+  }
+  if (settings_m.labelColumn.empty()) {
+    throw std::invalid_argument("TrainingShuffler: label column is empty");
+  }
+  for (const auto &[label, fraction] : settings_m.classFractions) {
+    if (!(fraction >= 0.0 && fraction <= 1.0)) {
+      throw std::invalid_argument("TrainingShuffler: fraction of class " + std::to_string(label) +
+                                  " is outside [0, 1]");
+    }
+  }
+  slotRows_m = (settings_m.shuffleRows + slots_m.size() - 1) / slots_m.size();
+  for (std::size_t s = 0; s < slots_m.size(); ++s) {
+    slots_m[s].rng.seed(settings_m.seed + s);
+  }
+}
+
+double TrainingShuffler::fraction(std::int64_t label) const {
+  const auto it = settings_m.classFractions.find(label);
+  return it == settings_m.classFractions.end() ? 1.0 : it->second;
+}
+
+void TrainingShuffler::initialise(Slot &slot, const ColumnChunker::Chunk &chunk) const {
+  for (std::size_t c = 0; c < chunk.columns.size(); ++c) {
+    if (!chunk.offsets[c].empty()) {
+      throw std::runtime_error("TrainingShuffler: RVec column '" + chunk.columns[c] +
+                               "' is not supported");
+    }
+  }
+  resetLike(slot.buffer, chunk);
+  resetLike(slot.out, chunk);
+  slot.initialised = true;
+}
+
+void TrainingShuffler::add(ColumnChunker::Chunk &&chunk) {
+  Slot &slot = slots_m.at(chunk.slot);
+  if (!slot.initialised) {
+    initialise(slot, chunk);
+  }
+  const auto labelIt = std::find(chunk.columns.begin(), chunk.columns.end(), settings_m.labelColumn);
+  if (labelIt == chunk.columns.end()) {
+    throw std::runtime_error("TrainingShuffler: chunk lacks the label column '" +
+                             settings_m.labelColumn + "'");
+  }
+  const auto labels = labelsOf(chunk.data[labelIt - chunk.columns.begin()]);
+
+  std::uniform_real_distribution<double> uniform(0.0, 1.0);
+  std::uniform_int_distribution<std::size_t> pick(0, slotRows_m - 1);
+  std::vector<Placement> placements;
+  placements.reserve(chunk.rows);
+  std::size_t buffered = slot.buffer.rows;
+  for (std::size_t row = 0; row < chunk.rows; ++row) {
+    ClassCount &count = slot.counts[labels[row]];
+    ++count.seen;
+    const double keep = fraction(labels[row]);
+    if (keep < 1.0 && !(uniform(slot.rng) < keep)) {
+      continue;
+    }
+    ++count.kept;
+    if (buffered < slotRows_m) {
+      placements.push_back({row, kAppend});
+      ++buffered;
+    } else {
+      placements.push_back({row, pick(slot.rng)});
+    }
+  }
+
+  // Apply the placements in runs that at most fill the pending chunk.
+  std::size_t begin = 0;
+  while (begin < placements.size()) {
+    std::size_t room = settings_m.chunkRows - slot.out.rows;
+    std::size_t end = begin;
+    while (end < placements.size() && (placements[end].target == kAppend || room > 0)) {
+      if (placements[end].target != kAppend) {
+        --room;
+      }
+      ++end;
+    }
+    place(slot, chunk, {placements.begin() + begin, placements.begin() + end});
+    if (slot.out.rows == settings_m.chunkRows) {
+      emitOut(slot, chunk.slot);
+    }
+    begin = end;
+  }
+}
+
+void TrainingShuffler::place(Slot &slot, ColumnChunker::Chunk &chunk,
+                             const std::vector<Placement> &placements) {
+  for (std::size_t c = 0; c < chunk.data.size(); ++c) {
+    std::visit(
+        [&](auto &buffer) {
+          using Vector = std::decay_t<decltype(buffer)>;
+          const auto &in = std::get<Vector>(chunk.data[c]);
+          auto &out = std::get<Vector>(slot.out.data[c]);
+          for (const auto &placement : placements) {
+            if (placement.target == kAppend) {
+              buffer.push_back(in[placement.row]);
+            } else {
+              out.push_back(buffer[placement.target]);
+              buffer[placement.target] = in[placement.row];
+            }
+          }
+        },
+        slot.buffer.data[c]);
+  }
+  for (const auto &placement : placements) {
+    ++(placement.target == kAppend ? slot.buffer.rows : slot.out.rows);
+  }
+}
+
+void TrainingShuffler::emitOut(Slot &slot, unsigned int slotIndex) {
+  ColumnChunker::Chunk chunk = std::move(slot.out);
+  chunk.slot = slotIndex;
+  resetLike(slot.out, chunk);
+  emit_m(std::move(chunk));
+}
+
+void TrainingShuffler::drain() {
+  for (std::size_t s = 0; s < slots_m.size(); ++s) {
+    Slot &slot = slots_m[s];
+    if (!slot.initialised) {
+      continue;
+    }
+    std::vector<std::size_t> order(slot.buffer.rows);
+    std::iota(order.begin(), order.end(), std::size_t{0});
+    std::shuffle(order.begin(), order.end(), slot.rng);
+    for (std::size_t begin = 0; begin < order.size();) {
+      const std::size_t end =
+          std::min(order.size(), begin + (settings_m.chunkRows - slot.out.rows));
+      for (std::size_t c = 0; c < slot.buffer.data.size(); ++c) {
+        std::visit(
+            [&](const auto &buffer) {
+              auto &out = std::get<std::decay_t<decltype(buffer)>>(slot.out.data[c]);
+              for (std::size_t i = begin; i < end; ++i) {
+                out.push_back(buffer[order[i]]);
+              }
+            },
+            slot.buffer.data[c]);
+      }
+      slot.out.rows += end - begin;
+      if (slot.out.rows == settings_m.chunkRows) {
+        emitOut(slot, static_cast<unsigned int>(s));
+      }
+      begin = end;
+    }
+    if (slot.out.rows > 0) {
+      emitOut(slot, static_cast<unsigned int>(s));
+    }
+    ColumnChunker::Chunk empty;
+    resetLike(empty, slot.buffer);
+    slot.buffer = std::move(empty);
+  }
+}
+
+std::map<std::int64_t, TrainingShuffler::ClassCount> TrainingShuffler::classCounts() const {
+  std::map<std::int64_t, ClassCount> counts;
+  for (const auto &slot : slots_m) {
+    for (const auto &[label, count] : slot.counts) {
+      counts[label].seen += count.seen;
+      counts[label].kept += count.kept;
+    }
+  }
+  return counts;
+}
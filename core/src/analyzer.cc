@@ -2,21 +2,37 @@
 #include <ManagerFactory.h>
 #include <ConfigurationManager.h>
 #include <DataManager.h>
-#include <DefaultLogger.h>
+#include <AsyncLogger.h>
 #include <NullOutputSink.h>
 #include <RootOutputSink.h>
+#include <CheckpointService.h>
 #include <CounterService.h>
+#include <CutflowManager.h>
 #include <ProvenanceService.h>
 #include <NDHistogramManager.h>
+#include <SkimColumnManifest.h>
 #include <functions.h>
 #include <util.h>
 #include <algorithm>
+#include <cmath>
+#include <ctime>
+#include <fstream>
+#include <fnmatch.h>
+#include <future>
+#include <iostream>
+#include <map>
 #include <memory>
 #include <queue>
 #include <sstream>
 #include <stdexcept>
 #include <SystematicManager.h>
+#include <api/ICheckpointParticipant.h>
 #include <api/ManagerContext.h> // for wiring plugins and services
+#include <ModelRegistry.h>
+#include <MetricsService.h>
+#include <MpiRuntime.h>
+#include <TraceService.h>
+#include <WeightManager.h>
 
 // Dependency-injected constructor (shared_ptr plugin map)
 Analyzer::Analyzer(
@@ -33,17 +49,26 @@ Analyzer::Analyzer(
       logger_m(std::move(logger)),
       skimSink_m(std::move(skimSink)),
       metaSink_m(std::move(metaSink)),
-      managerContext_m{*configProvider_m, *dataFrameProvider_m, *systematicManager_m, *logger_m, *skimSink_m, *metaSink_m},
+      managerContext_m{*configProvider_m, *dataFrameProvider_m, *systematicManager_m, *logger_m, *skimSink_m, *metaSink_m, &ModelRegistry::instance()},
       plugins(std::move(plugins))
 {
     if (!configProvider_m || !dataFrameProvider_m || !systematicManager_m || !logger_m || !skimSink_m || !metaSink_m) {
         throw std::invalid_argument("Analyzer: Core dependencies must be non-null");
     }
     verbosityLevel_m = 1;
+    configureLogging();
+    configureTracing();
     if (auto* dataManager = dynamic_cast<DataManager*>(dataFrameProvider_m.get())) {
         dataManager->finalizeSetup(*configProvider_m);
     }
-    wirePluginManagers();
+    configureSystematicPruning();
+    configureDeferredVariations();
+    configurePluginGates();
+    phaseTimer_m.lap("config");
+    {
+        PhaseTimer::Scope phase(phaseTimer_m, "plugin_setup");
+        wirePluginManagers();
+    }
     //initialize();
 }
 
@@ -62,17 +87,26 @@ Analyzer::Analyzer(
       logger_m(std::move(logger)),
       skimSink_m(std::move(skimSink)),
       metaSink_m(std::move(metaSink)),
-      managerContext_m{*configProvider_m, *dataFrameProvider_m, *systematicManager_m, *logger_m, *skimSink_m, *metaSink_m}
+      managerContext_m{*configProvider_m, *dataFrameProvider_m, *systematicManager_m, *logger_m, *skimSink_m, *metaSink_m, &ModelRegistry::instance()}
 {
     if (!configProvider_m || !dataFrameProvider_m || !systematicManager_m || !logger_m || !skimSink_m || !metaSink_m) {
         throw std::invalid_argument("Analyzer: Core dependencies must be non-null");
     }
     for (auto& kv : uniquePlugins) { plugins.emplace(kv.first, std::move(kv.second)); }
     verbosityLevel_m = 1;
+    configureLogging();
+    configureTracing();
     if (auto* dataManager = dynamic_cast<DataManager*>(dataFrameProvider_m.get())) {
         dataManager->finalizeSetup(*configProvider_m);
     }
-    wirePluginManagers();
+    configureSystematicPruning();
+    configureDeferredVariations();
+    configurePluginGates();
+    phaseTimer_m.lap("config");
+    {
+        PhaseTimer::Scope phase(phaseTimer_m, "plugin_setup");
+        wirePluginManagers();
+    }
     //initialize();
 }
 
@@ -81,18 +115,27 @@ Analyzer::Analyzer(std::string configFile,
         : configProvider_m(ManagerFactory::createConfigurationManager(configFile)),
             dataFrameProvider_m(ManagerFactory::createDataManager(*configProvider_m)),
             systematicManager_m(ManagerFactory::createSystematicManager()),
-            logger_m(std::make_unique<DefaultLogger>()),
-    skimSink_m(std::make_unique<RootOutputSink>()),
-            metaSink_m(std::make_unique<RootOutputSink>()),            managerContext_m{*configProvider_m, *dataFrameProvider_m, *systematicManager_m, *logger_m, *skimSink_m, *metaSink_m},            plugins(std::move(plugins))
+            logger_m(std::make_unique<ProcessLogger>()),
+    skimSink_m(ManagerFactory::createOutputSink(*configProvider_m, OutputChannel::Skim)),
+            metaSink_m(ManagerFactory::createOutputSink(*configProvider_m, OutputChannel::Meta)),            managerContext_m{*configProvider_m, *dataFrameProvider_m, *systematicManager_m, *logger_m, *skimSink_m, *metaSink_m, &ModelRegistry::instance()},            plugins(std::move(plugins))
 {
         if (!configProvider_m || !dataFrameProvider_m || !systematicManager_m) {
         throw std::invalid_argument("Analyzer: Core dependencies must be non-null");
     }
     verbosityLevel_m = 1;
+    configureLogging();
+    configureTracing();
     if (auto* dataManager = dynamic_cast<DataManager*>(dataFrameProvider_m.get())) {
         dataManager->finalizeSetup(*configProvider_m);
     }
-    wirePluginManagers();
+    configureSystematicPruning();
+    configureDeferredVariations();
+    configurePluginGates();
+    phaseTimer_m.lap("config");
+    {
+        PhaseTimer::Scope phase(phaseTimer_m, "plugin_setup");
+        wirePluginManagers();
+    }
     //initialize();
 }
 
@@ -102,19 +145,28 @@ Analyzer::Analyzer(std::string configFile,
         : configProvider_m(ManagerFactory::createConfigurationManager(configFile)),
             dataFrameProvider_m(ManagerFactory::createDataManager(*configProvider_m)),
             systematicManager_m(ManagerFactory::createSystematicManager()),
-            logger_m(std::make_unique<DefaultLogger>()),
-    skimSink_m(std::make_unique<RootOutputSink>()),
-            metaSink_m(std::make_unique<RootOutputSink>()),            managerContext_m{*configProvider_m, *dataFrameProvider_m, *systematicManager_m, *logger_m, *skimSink_m, *metaSink_m}
+            logger_m(std::make_unique<ProcessLogger>()),
+    skimSink_m(ManagerFactory::createOutputSink(*configProvider_m, OutputChannel::Skim)),
+            metaSink_m(ManagerFactory::createOutputSink(*configProvider_m, OutputChannel::Meta)),            managerContext_m{*configProvider_m, *dataFrameProvider_m, *systematicManager_m, *logger_m, *skimSink_m, *metaSink_m, &ModelRegistry::instance()}
 {
         if (!configProvider_m || !dataFrameProvider_m || !systematicManager_m) {
         throw std::invalid_argument("Analyzer: Core dependencies must be non-null");
     }
     for (auto& kv : uniquePlugins) { plugins.emplace(kv.first, std::move(kv.second)); }
     verbosityLevel_m = 1;
+    configureLogging();
+    configureTracing();
     if (auto* dataManager = dynamic_cast<DataManager*>(dataFrameProvider_m.get())) {
         dataManager->finalizeSetup(*configProvider_m);
     }
-    wirePluginManagers();
+    configureSystematicPruning();
+    configureDeferredVariations();
+    configurePluginGates();
+    phaseTimer_m.lap("config");
+    {
+        PhaseTimer::Scope phase(phaseTimer_m, "plugin_setup");
+        wirePluginManagers();
+    }
     //initialize();
 }
 
@@ -183,9 +235,55 @@ void Analyzer::wirePluginManagers() {
     for (const auto& role : order) {
         auto& plugin = plugins.at(role);
         if (!plugin) continue;
-        std::cout << "Wiring plugin for role: " << role << std::endl;
+        RDF_LOG_INFO << "Wiring plugin for role: " << role;
+        NodeProfiler::OwnerScope scope(dataFrameProvider_m->nodeProfiler(), role);
+        DataManager::GateScope gate(dynamic_cast<DataManager*>(dataFrameProvider_m.get()),
+                                    pluginGate(role));
         plugin->setContext(managerContext_m);
-        plugin->setupFromConfigFile();
+    }
+
+    // Plugins whose setup only loads files (concurrentSetup()) start as soon
+    // as their dependencies are set up; the others run inline, in order.
+    const std::string parallelFlag = configProvider_m->get("parallelPluginSetup");
+    const bool parallelSetup =
+        parallelFlag != "0" && parallelFlag != "false" && parallelFlag != "False";
+    std::unordered_map<std::string, std::shared_future<void>> setupDone;
+    for (const auto& role : order) {
+        auto& plugin = plugins.at(role);
+        if (!plugin) continue;
+        std::vector<std::shared_future<void>> deps;
+        for (const auto& dep : plugin->getDependencies()) {
+            auto it = setupDone.find(dep);
+            if (it != setupDone.end()) deps.push_back(it->second);
+        }
+        if (parallelSetup && plugin->concurrentSetup()) {
+            IPluggableManager* p = plugin.get();
+            setupDone[role] = std::async(std::launch::async, [p, deps, role]() {
+                for (const auto& dep : deps) dep.get();
+                TraceRecorder::Span span("plugin", role + ".setup");
+                p->setupFromConfigFile();
+            }).share();
+            continue;
+        }
+        std::promise<void> done;
+        try {
+            for (const auto& dep : deps) dep.get();
+            NodeProfiler::OwnerScope scope(dataFrameProvider_m->nodeProfiler(), role);
+            DataManager::GateScope gate(dynamic_cast<DataManager*>(dataFrameProvider_m.get()),
+                                        pluginGate(role));
+            TraceRecorder::Span span("plugin", role + ".setup");
+            plugin->setupFromConfigFile();
+            done.set_value();
+        } catch (...) {
+            done.set_exception(std::current_exception());
+        }
+        setupDone[role] = done.get_future().share();
+    }
+    // Rethrow the first failure in topological order once every task ended.
+    for (auto& [role, done] : setupDone) done.wait();
+    for (const auto& role : order) {
+        auto it = setupDone.find(role);
+        if (it != setupDone.end()) it->second.get();
     }
 
     initializeServices(managerContext_m);
@@ -196,8 +294,15 @@ void Analyzer::wirePluginManagers() {
     for (const auto& role : order) {
         auto& plugin = plugins.at(role);
         if (!plugin) continue;
+        NodeProfiler::OwnerScope scope(dataFrameProvider_m->nodeProfiler(), role);
+        DataManager::GateScope gate(dynamic_cast<DataManager*>(dataFrameProvider_m.get()),
+                                    pluginGate(role));
+        TraceRecorder::Span span("plugin", role + ".initialize");
         plugin->initialize();
     }
+    for (const auto& role : order) {
+        gatePluginColumns(role);
+    }
 }
 
 Analyzer *Analyzer::addPlugin(const std::string &role, std::shared_ptr<IPluggableManager> plugin) {
@@ -209,14 +314,20 @@ Analyzer *Analyzer::addPlugin(const std::string &role, std::shared_ptr<IPluggabl
                 "' which is not registered.");
         }
     }
-    plugin->setContext(managerContext_m);
-    plugin->setupFromConfigFile();
-    plugin->initialize();
+    {
+        NodeProfiler::OwnerScope scope(dataFrameProvider_m->nodeProfiler(), role);
+        DataManager::GateScope gate(dynamic_cast<DataManager*>(dataFrameProvider_m.get()),
+                                    pluginGate(role));
+        plugin->setContext(managerContext_m);
+        plugin->setupFromConfigFile();
+        plugin->initialize();
+    }
     if (provenanceService_m) {
         provenanceService_m->addEntry("plugin." + role, plugin->type());
     }
     plugins.emplace(role, std::move(plugin));
     pluginOrder_m.push_back(role);
+    gatePluginColumns(role);
     return this;
 }
 
@@ -247,15 +358,55 @@ void Analyzer::initializeServices(ManagerContext& ctx) {
 
     const auto& configMap = configProvider_m->getConfigMap();
     auto it = configMap.find("enableCounters");
+    bool countersEnabled = false;
     if (it != configMap.end()) {
         const auto& val = it->second;
-        const bool enabled = (val == "1" || val == "true" || val == "True");
-        if (enabled) {
+        countersEnabled = (val == "1" || val == "true" || val == "True");
+        if (countersEnabled) {
             auto service = std::make_unique<CounterService>();
             service->initialize(ctx);
             services_m.emplace_back(std::move(service));
         }
     }
+
+    if (!configProvider_m->get("metricsFile").empty()) {
+        auto service = std::make_unique<MetricsService>();
+        service->initialize(ctx);
+        services_m.emplace_back(std::move(service));
+    }
+
+    if (!configProvider_m->get("traceFile").empty()) {
+        auto service = std::make_unique<TraceService>();
+        service->initialize(ctx);
+        traceService_m = service.get();
+        services_m.emplace_back(std::move(service));
+    }
+
+    if (!configProvider_m->get("checkpointFile").empty()) {
+        auto service = std::make_unique<CheckpointService>();
+        service->initialize(ctx);
+        if (service->resuming() && countersEnabled) {
+            logger_m->log(ILogger::Level::Warn,
+                          "Analyzer: counters only cover the entries processed "
+                          "after resuming from the checkpoint.");
+        }
+        checkpointService_m = service.get();
+        services_m.emplace_back(std::move(service));
+    }
+}
+
+void Analyzer::bookCheckpoints() {
+    if (!checkpointService_m) {
+        return;
+    }
+    for (const auto& role : pluginOrder_m) {
+        auto it = plugins.find(role);
+        if (it == plugins.end() || !it->second) continue;
+        if (auto* participant = dynamic_cast<ICheckpointParticipant*>(it->second.get())) {
+            participant->bookCheckpoint(*checkpointService_m);
+        }
+    }
+    checkpointService_m->arm();
 }
 
 Analyzer *Analyzer::DefineVector(std::string name, const std::vector<std::string> &columns, std::string type) {
@@ -289,6 +440,19 @@ Analyzer *Analyzer::setTaskMetadata(const std::string& key, const std::string& v
     return this;
 }
 
+// Content hash of a plugin's provenance entries ("plugin.<role>.config_hash").
+static std::string pluginConfigHash(
+    const std::unordered_map<std::string, std::string>& entries) {
+    // Serialize sorted entries for deterministic hashing.
+    std::vector<std::pair<std::string, std::string>> sorted(entries.begin(), entries.end());
+    std::sort(sorted.begin(), sorted.end());
+    std::ostringstream oss;
+    for (const auto& [k, v] : sorted) {
+        oss << k << '=' << v << '\n';
+    }
+    return ProvenanceService::hashString(oss.str());
+}
+
 void Analyzer::collectAndRegisterProvenance(ROOT::RDF::RNode& df) {
     if (provenanceService_m) {
         // Task-level metadata (injected via setTaskMetadata())
@@ -309,17 +473,8 @@ void Analyzer::collectAndRegisterProvenance(ROOT::RDF::RNode& df) {
                 provenanceService_m->addEntry("plugin." + role + "." + k, v);
             }
 
-            // Serialize sorted entries for deterministic hashing.
-            std::vector<std::pair<std::string, std::string>> sorted(
-                entries.begin(), entries.end());
-            std::sort(sorted.begin(), sorted.end());
-            std::ostringstream oss;
-            for (const auto& [k, v] : sorted) {
-                oss << k << '=' << v << '\n';
-            }
-            provenanceService_m->addEntry(
-                "plugin." + role + ".config_hash",
-                ProvenanceService::hashString(oss.str()));
+            provenanceService_m->addEntry("plugin." + role + ".config_hash",
+                                          pluginConfigHash(entries));
         }
 
         // Collect structured provenance contributions from non-provenance services.
@@ -333,6 +488,168 @@ void Analyzer::collectAndRegisterProvenance(ROOT::RDF::RNode& df) {
         }
     }
 
+    // Systematic pruning decisions (two-pass mode).
+    if (provenanceService_m) {
+        auto* systematicManager =
+            dynamic_cast<SystematicManager*>(systematicManager_m.get());
+        if (systematicManager && !systematicPruningInput_m.empty()) {
+            std::string pruned;
+            for (const auto& syst : systematicManager->getPrunedSystematics()) {
+                pruned += (pruned.empty() ? "" : ",") + syst;
+            }
+            provenanceService_m->addEntry("systematic_pruning.input",
+                                          systematicPruningInput_m);
+            provenanceService_m->addEntry("systematic_pruning.pruned", pruned);
+        }
+        if (systematicManager && !systematicPruningReport_m.empty()) {
+            std::string pruned;
+            for (const auto& syst : systematicManager->selectPrunableSystematics(
+                     systematicPruningNormThreshold_m,
+                     systematicPruningShapeThreshold_m)) {
+                pruned += (pruned.empty() ? "" : ",") + syst;
+            }
+            provenanceService_m->addEntry("systematic_pruning.report",
+                                          systematicPruningReport_m);
+            provenanceService_m->addEntry(
+                "systematic_pruning.fraction",
+                std::to_string(systematicPruningFraction_m));
+            provenanceService_m->addEntry(
+                "systematic_pruning.norm_threshold",
+                std::to_string(systematicPruningNormThreshold_m));
+            provenanceService_m->addEntry(
+                "systematic_pruning.shape_threshold",
+                std::to_string(systematicPruningShapeThreshold_m));
+            provenanceService_m->addEntry("systematic_pruning.pruned", pruned);
+        }
+    }
+
+    // Variation columns dropped by dead-column elimination.
+    if (provenanceService_m && !deadVariationColumns_m.empty()) {
+        std::string dead;
+        for (const auto& column : deadVariationColumns_m) {
+            dead += (dead.empty() ? "" : ",") + column;
+        }
+        provenanceService_m->addEntry("deferred_variations.dead", dead);
+        provenanceService_m->addEntry("deferred_variations.dead_count",
+                                      std::to_string(deadVariationColumns_m.size()));
+    }
+
+    // Memory of the histogram slot accumulators, reported by the event loop.
+    if (provenanceService_m) {
+        if (auto histogramManager = getPlugin<NDHistogramManager>("histogramManager")) {
+            for (const auto& [k, v] : histogramManager->collectMemoryEntries()) {
+                provenanceService_m->addEntry("histogram_memory." + k, v);
+            }
+        }
+    }
+
+    // Time spent in the Define/Filter callables of each owner.
+    if (provenanceService_m) {
+        if (const NodeProfiler* profiler = dataFrameProvider_m->nodeProfiler()) {
+            provenanceService_m->addEntry("node_profile.nodes",
+                                          std::to_string(profiler->size()));
+            for (const auto& [owner, nanoseconds] : profiler->ownerTotals()) {
+                provenanceService_m->addEntry("node_profile." + owner + "_ns",
+                                              std::to_string(nanoseconds));
+            }
+            if (profiler->tracksAllocations()) {
+                for (const auto& [owner, counts] : profiler->ownerAllocations()) {
+                    provenanceService_m->addEntry("node_profile." + owner + "_allocations",
+                                                  std::to_string(counts.allocations));
+                    provenanceService_m->addEntry("node_profile." + owner + "_bytes",
+                                                  std::to_string(counts.bytes));
+                }
+            }
+        }
+    }
+
+    // Boolean columns gating the columns of each plugin.
+    if (provenanceService_m) {
+        for (const auto& [role, gate] : pluginGates_m) {
+            provenanceService_m->addEntry("plugin_gate." + role, gate);
+        }
+    }
+
+    // Selection cache of the named preselection blocks.
+    if (provenanceService_m) {
+        for (const auto& cache : selectionCaches_m) {
+            provenanceService_m->addEntry("selection_cache." + cache.name, cache.status);
+            provenanceService_m->addEntry("selection_cache." + cache.name + ".key", cache.key);
+        }
+    }
+
+    // Order the preselection blocks were applied in.
+    if (provenanceService_m) {
+        for (std::size_t i = 0; i < preselectionOrders_m.size(); ++i) {
+            provenanceService_m->addEntry("filter_order.block" + std::to_string(i),
+                                          preselectionOrders_m[i]);
+        }
+    }
+
+    // Expressions taken from, and missing in, the JIT cache.
+    if (provenanceService_m) {
+        auto* dataManager = dynamic_cast<DataManager*>(dataFrameProvider_m.get());
+        if (const JitCache* cache = dataManager ? dataManager->getJitCache() : nullptr) {
+            provenanceService_m->addEntry("jit_cache.hits", std::to_string(cache->hits()));
+            provenanceService_m->addEntry("jit_cache.misses",
+                                          std::to_string(cache->missed().size()));
+        }
+    }
+
+    // NUMA topology the job ran on, and the thread pinning applied to it.
+    if (provenanceService_m) {
+        auto* dataManager = dynamic_cast<DataManager*>(dataFrameProvider_m.get());
+        const ThreadPinning* pinning =
+            dataManager ? dataManager->getThreadPinning() : nullptr;
+        // A pinned main thread sees only its own CPU, so reuse the topology
+        // read before the event loop when there is one.
+        const auto topology =
+            pinning ? pinning->topology() : ThreadPinning::readTopology();
+        std::size_t cpus = 0;
+        for (const auto& node : topology) {
+            provenanceService_m->addEntry("topology.node" + std::to_string(node.id) + "_cpus",
+                                          std::to_string(node.cpus.size()));
+            cpus += node.cpus.size();
+        }
+        provenanceService_m->addEntry("topology.numa_nodes",
+                                      std::to_string(topology.size()));
+        provenanceService_m->addEntry("topology.cpus", std::to_string(cpus));
+        provenanceService_m->addEntry("topology.pinned", pinning ? "true" : "false");
+        if (pinning) {
+            provenanceService_m->addEntry("topology.pinned_threads",
+                                          std::to_string(pinning->pinnedThreads()));
+        }
+    }
+
+    // Preview runs are flagged so their outputs are not mistaken for full ones.
+    if (provenanceService_m) {
+        auto* dataManager = dynamic_cast<DataManager*>(dataFrameProvider_m.get());
+        if (dataManager && dataManager->isPreview()) {
+            provenanceService_m->addEntry("preview", "true");
+            provenanceService_m->addEntry("preview.fraction",
+                                          configProvider_m->get("previewFraction"));
+            provenanceService_m->addEntry(
+                "preview.entries_selected",
+                std::to_string(dataManager->previewSelectedEntries()));
+            provenanceService_m->addEntry(
+                "preview.entries_total",
+                std::to_string(dataManager->previewTotalEntries()));
+            provenanceService_m->addEntry("preview.scale",
+                                          std::to_string(dataManager->previewScale()));
+            // Only the histograms are scaled; counters and cutflows keep the
+            // counts of the entries read.
+            provenanceService_m->addEntry("preview.scaled_outputs", "histograms");
+        }
+    }
+
+    // Wall and CPU time of the job phases recorded so far.
+    if (provenanceService_m) {
+        for (const auto& phase : phaseTimer_m.phases()) {
+            provenanceService_m->recordPhase(phase.name, phase.wallSeconds,
+                                             phase.cpuSeconds);
+        }
+    }
+
     // ProvenanceService finalizes last so it captures all contributions.
     if (provenanceService_m) {
         provenanceService_m->finalize(df);
@@ -340,21 +657,68 @@ void Analyzer::collectAndRegisterProvenance(ROOT::RDF::RNode& df) {
 }
 
 Analyzer *Analyzer::save() {
+    if (preselectionOpen_m) {
+        throw std::runtime_error(
+            "Analyzer::save(): preselection block still open; call endPreselection()");
+    }
+    if (runDry()) {
+        return this;
+    }
+    if (checkpointService_m) {
+        throw std::runtime_error(
+            "Analyzer::save(): skims are not checkpointed; unset checkpointFile "
+            "or use run() without enableSkim.");
+    }
     auto df = dataFrameProvider_m->getDataFrame();
 
     // Pre-execution hook
     for (const auto& role : pluginOrder_m) {
         auto it = plugins.find(role);
         if (it != plugins.end() && it->second) {
+            NodeProfiler::OwnerScope scope(dataFrameProvider_m->nodeProfiler(), role);
+            DataManager::GateScope gate(dynamic_cast<DataManager*>(dataFrameProvider_m.get()),
+                                        pluginGate(role));
+            TraceRecorder::Span span("plugin", role + ".execute");
             it->second->execute();
         }
     }
 
-    skimSink_m->writeDataFrame(df,
-                               *configProvider_m,
-                               dataFrameProvider_m.get(),
-                               systematicManager_m.get(),
-                               OutputChannel::Skim);
+    checkDeferredNormalization(true);
+    if (materializeSkimVariations()) {
+        df = dataFrameProvider_m->getDataFrame();
+    }
+    reportDeadVariationColumns();
+
+    if (provenanceService_m) {
+        provenanceService_m->markEventLoopTrigger();
+    }
+    if (traceService_m) {
+        traceService_m->markEventLoopTrigger();
+    }
+    const auto snapshotStart = PhaseTimer::Sample::now();
+    configureSkimColumnManifest(df);
+    skimSink_m->bookDataFrame(df,
+                              *configProvider_m,
+                              dataFrameProvider_m.get(),
+                              systematicManager_m.get(),
+                              OutputChannel::Skim);
+    pruneInputBranches(true);
+    // Run the skim's event loop and complete the writes booked by plugins
+    // (e.g. RegionManager region skims), which share it.
+    skimSink_m->flush();
+    phaseTimer_m.add("snapshot", snapshotStart, PhaseTimer::Sample::now());
+
+    if (auto* dataManager = dynamic_cast<DataManager*>(dataFrameProvider_m.get())) {
+        dataManager->unpinMainThread();
+        dataManager->reportSlowSites();
+        dataManager->writeSelectionCache();
+        dataManager->buildJitCache();
+        dataManager->exportJitExpressions();
+    }
+    reportNodeProfile();
+    reportFilterProfile();
+
+    const auto finalizeStart = PhaseTimer::Sample::now();
 
     // Finalize all non-provenance services (e.g. CounterService).
     // ProvenanceService is finalized last so it captures contributions from
@@ -369,6 +733,7 @@ Analyzer *Analyzer::save() {
     for (const auto& role : pluginOrder_m) {
         auto it = plugins.find(role);
         if (it != plugins.end() && it->second) {
+            TraceRecorder::Span span("plugin", role + ".finalize");
             it->second->finalize();
         }
     }
@@ -378,44 +743,349 @@ Analyzer *Analyzer::save() {
             it->second->reportMetadata();
         }
     }
+    phaseTimer_m.add("finalize", finalizeStart, PhaseTimer::Sample::now());
 
     // Collect structured provenance contributions from plugins and services,
     // then finalize ProvenanceService so it writes all collected entries.
     collectAndRegisterProvenance(df);
 
+    if (traceService_m) {
+        traceService_m->write();
+    }
+
+    // Messages of the job are on screen (and in captured stdout) on return.
+    AsyncLogger::instance().flush();
     return this;
 }
 
 Analyzer *Analyzer::run() {
+    if (runDry()) {
+        return this;
+    }
+    auto df = dataFrameProvider_m->getDataFrame();
+    const unsigned int runsBefore = df.GetNRuns();
+    const bool skimBooked = prepareRun(df);
+    completeRun(df, skimBooked, runsBefore);
+    return this;
+}
+
+void Analyzer::runAll(const std::vector<Analyzer*>& analyzers) {
+    for (std::size_t i = 0; i < analyzers.size(); ++i) {
+        if (!analyzers[i]) {
+            throw std::invalid_argument("Analyzer::runAll(): null analyzer");
+        }
+        if (std::find(analyzers.begin(), analyzers.begin() + i, analyzers[i]) !=
+            analyzers.begin() + i) {
+            throw std::invalid_argument("Analyzer::runAll(): analyzer listed twice");
+        }
+    }
+
+    struct Pending {
+        ROOT::RDF::RNode df;
+        unsigned int runsBefore;
+        bool skimBooked;
+    };
+    std::vector<Analyzer*> running;
+    for (auto* analyzer : analyzers) {
+        if (!analyzer->runDry()) {
+            running.push_back(analyzer);
+        }
+    }
+    if (running.empty()) {
+        return;
+    }
+
+    std::vector<Pending> pending;
+    std::vector<ROOT::RDF::RResultHandle> handles;
+    for (auto* analyzer : running) {
+        auto df = analyzer->dataFrameProvider_m->getDataFrame();
+        const unsigned int runsBefore = df.GetNRuns();
+        const bool skimBooked = analyzer->prepareRun(df);
+        // Running any result of a graph fills every result booked on it.
+        handles.emplace_back(df.Count());
+        pending.push_back({df, runsBefore, skimBooked});
+    }
+
+    const auto loopStart = PhaseTimer::Sample::now();
+    ROOT::RDF::RunGraphs(handles);
+    const auto loopEnd = PhaseTimer::Sample::now();
+
+    for (std::size_t i = 0; i < running.size(); ++i) {
+        running[i]->phaseTimer_m.add("run_graphs", loopStart, loopEnd);
+        running[i]->completeRun(pending[i].df, pending[i].skimBooked, pending[i].runsBefore);
+    }
+}
+
+GraphCost Analyzer::estimateCost() const {
+    GraphCost cost;
     auto df = dataFrameProvider_m->getDataFrame();
+    cost.definedColumns = df.GetDefinedColumnNames().size();
+    cost.slots = std::max(1u, df.GetNSlots());
+    cost.systematics = systematicManager_m->getSystematics().size();
+    if (auto* dataManager = dynamic_cast<DataManager*>(dataFrameProvider_m.get())) {
+        cost.jitExpressions = dataManager->getJitExpressionCount();
+        const auto* jitCache = dataManager->getJitCache();
+        cost.jitCompiled = jitCache ? jitCache->missed().size() : cost.jitExpressions;
+    }
+    for (const auto& role : pluginOrder_m) {
+        auto it = plugins.find(role);
+        if (it != plugins.end() && it->second) {
+            it->second->estimateCost(cost);
+        }
+    }
+    return cost;
+}
+
+bool Analyzer::runDry() {
+    const auto& cfgMap = configProvider_m->getConfigMap();
+    const auto dryIt = cfgMap.find("dryRun");
+    if (dryIt == cfgMap.end() ||
+        (dryIt->second != "1" && dryIt->second != "true" && dryIt->second != "True")) {
+        return false;
+    }
+    if (preselectionOpen_m) {
+        throw std::runtime_error(
+            "Analyzer: preselection block still open; call endPreselection()");
+    }
+
+    // Book what the plugins would fill; the graph is never run.
+    for (const auto& role : pluginOrder_m) {
+        auto it = plugins.find(role);
+        if (it != plugins.end() && it->second) {
+            DataManager::GateScope gate(dynamic_cast<DataManager*>(dataFrameProvider_m.get()),
+                                        pluginGate(role));
+            it->second->execute();
+        }
+    }
+
+    auto cost = estimateCost();
+    cost.checkBudgets(*configProvider_m);
+    RDF_LOG_INFO << "Dry run: " << cost.definedColumns << " defined columns, "
+                 << cost.jitExpressions << " string expressions (" << cost.jitCompiled
+                 << " JIT-compiled), " << cost.histograms.size() << " histograms with "
+                 << cost.histogramCells() << " cells over " << cost.systematics
+                 << " systematics, " << cost.histogramBytes() / 1e6 << " MB of histograms in "
+                 << cost.slots << " slots, " << cost.models << " ML models";
+    for (const auto& warning : cost.warnings) {
+        RDF_LOG_WARN << "Warning: dry run: " << warning;
+    }
+
+    const auto reportIt = cfgMap.find("dryRunReport");
+    if (reportIt != cfgMap.end() && !reportIt->second.empty()) {
+        std::ofstream report(reportIt->second);
+        if (!(report << cost.toJson())) {
+            throw std::runtime_error("Analyzer: cannot write dry-run report " +
+                                     reportIt->second);
+        }
+    }
+    AsyncLogger::instance().flush();
+    return true;
+}
+
+bool Analyzer::prepareRun(ROOT::RDF::RNode& df) {
+    if (preselectionOpen_m) {
+        throw std::runtime_error(
+            "Analyzer::run(): preselection block still open; call endPreselection()");
+    }
 
     // Pre-execution hook
     for (const auto& role : pluginOrder_m) {
         auto it = plugins.find(role);
         if (it != plugins.end() && it->second) {
+            NodeProfiler::OwnerScope scope(dataFrameProvider_m->nodeProfiler(), role);
+            DataManager::GateScope gate(dynamic_cast<DataManager*>(dataFrameProvider_m.get()),
+                                        pluginGate(role));
+            TraceRecorder::Span span("plugin", role + ".execute");
             it->second->execute();
         }
     }
 
-    // Conditionally write a skim when enableSkim=1/true/True is set in config
+    // Conditionally write a skim when enableSkim=1/true/True is set in config.
+    // The skim is booked lazily so it is written by the same event loop that
+    // fills the histograms below.
     const auto& cfgMap = configProvider_m->getConfigMap();
     const auto skimIt = cfgMap.find("enableSkim");
+    bool skimBooked = false;
     if (skimIt != cfgMap.end()) {
         const auto& val = skimIt->second;
         if (val == "1" || val == "true" || val == "True") {
-            skimSink_m->writeDataFrame(df,
-                                       *configProvider_m,
-                                       dataFrameProvider_m.get(),
-                                       systematicManager_m.get(),
-                                       OutputChannel::Skim);
+            if (checkpointService_m) {
+                throw std::runtime_error(
+                    "Analyzer::run(): skims are not checkpointed; enableSkim "
+                    "cannot be combined with checkpointFile.");
+            }
+            if (materializeSkimVariations()) {
+                df = dataFrameProvider_m->getDataFrame();
+            }
+            configureSkimColumnManifest(df);
+            skimSink_m->bookDataFrame(df,
+                                      *configProvider_m,
+                                      dataFrameProvider_m.get(),
+                                      systematicManager_m.get(),
+                                      OutputChannel::Skim);
+            skimBooked = true;
         }
     }
 
+    // Fail before the event loop rather than after it.
+    checkDeferredNormalization(skimBooked);
+
+    // Every consumer has been booked; variations still deferred are dead.
+    reportDeadVariationColumns();
+
+    // Checkpoint the booked results while the event loop runs.
+    bookCheckpoints();
+
+    pruneInputBranches(skimBooked);
+
+    if (provenanceService_m) {
+        provenanceService_m->markEventLoopTrigger();
+    }
+    if (traceService_m) {
+        traceService_m->markEventLoopTrigger();
+    }
+    return skimBooked;
+}
+
+std::vector<WeightManager*> Analyzer::deferredNormalizationManagers() const {
+    std::vector<WeightManager*> weightManagers;
+    for (const auto& [role, plugin] : plugins) {
+        auto* weightManager = dynamic_cast<WeightManager*>(plugin.get());
+        if (weightManager && weightManager->hasDeferredNormalization()) {
+            weightManagers.push_back(weightManager);
+        }
+    }
+    return weightManagers;
+}
+
+CounterService* Analyzer::weightCounters() const {
+    for (const auto& service : services_m) {
+        if (auto* counterService = dynamic_cast<CounterService*>(service.get())) {
+            if (!counterService->weightBranch().empty()) {
+                return counterService;
+            }
+        }
+    }
+    return nullptr;
+}
+
+void Analyzer::checkDeferredNormalization(bool writesSkim) const {
+    if (deferredNormalizationManagers().empty()) {
+        return;
+    }
+    if (!weightCounters()) {
+        throw std::runtime_error(
+            "Analyzer: deferred normalization needs the sum of weights of "
+            "CounterService; set enableCounters=true and counterWeightBranch.");
+    }
+    if (checkpointService_m && checkpointService_m->resuming()) {
+        throw std::runtime_error(
+            "Analyzer: deferred normalization is not available when resuming "
+            "from a checkpoint, as the counters miss the entries processed before.");
+    }
+    // The factor divides by the sum of weights this job read.  Outputs of
+    // jobs that each read part of a sample are added when merged, so each
+    // would be normalized to its own part instead of to the sample.
+    const std::string sampleJobs = configProvider_m->get("sampleJobs");
+    const bool entryRange =
+        !configProvider_m->get("firstEntry").empty() || !configProvider_m->get("lastEntry").empty();
+    if (entryRange || MpiRuntime::size() > 1 ||
+        (!sampleJobs.empty() && sampleJobs != "0" && sampleJobs != "1")) {
+        throw std::runtime_error(
+            "Analyzer: deferred normalization needs the whole sample in one job, "
+            "but this job reads part of it (an entry range, an MPI rank or one of "
+            "sampleJobs jobs); normalize with addNormalization() instead.");
+    }
+    if (writesSkim) {
+        throw std::runtime_error(
+            "Analyzer: deferred normalization scales histograms and cutflows only; "
+            "the weights of a skim would stay unnormalized.");
+    }
+}
+
+bool Analyzer::applyDeferredNormalization() {
+    const std::vector<WeightManager*> weightManagers = deferredNormalizationManagers();
+    if (weightManagers.empty()) {
+        return false;
+    }
+    CounterService* counters = weightCounters();
+    if (!counters) {
+        throw std::runtime_error(
+            "Analyzer: deferred normalization needs the sum of weights of "
+            "CounterService; set enableCounters=true and counterWeightBranch.");
+    }
+
+    // The counters read every entry in the same event loop as the outputs.
+    const double sumWeights = counters->totals().sumw;
+    double scale = 1.0;
+    for (auto* weightManager : weightManagers) {
+        scale *= weightManager->resolveDeferredNormalization(sumWeights);
+    }
+    for (const auto& [role, plugin] : plugins) {
+        if (auto* histogramManager = dynamic_cast<NDHistogramManager*>(plugin.get())) {
+            histogramManager->setOutputScale(scale);
+        } else if (auto* cutflowManager = dynamic_cast<CutflowManager*>(plugin.get())) {
+            cutflowManager->setWeightScale(scale);
+        }
+    }
+    logger_m->log(ILogger::Level::Info,
+                  "Analyzer: deferred normalization " + std::to_string(scale) +
+                      " (sum of " + counters->weightBranch() + " = " +
+                      std::to_string(sumWeights) + ")");
+    return true;
+}
+
+void Analyzer::applyOutputScales() {
+    if (applyDeferredNormalization()) {
+        return;
+    }
+    // A preview run reads a sample of the input; scale the histograms to
+    // full statistics.  Counters and cutflows stay raw counts of the entries
+    // read, so their efficiencies remain valid.  A deferred normalization
+    // divides by the sum of weights of the sample read, which already
+    // accounts for it.
+    auto* dataManager = dynamic_cast<DataManager*>(dataFrameProvider_m.get());
+    if (!dataManager || !dataManager->isPreview()) {
+        return;
+    }
+    for (const auto& [role, plugin] : plugins) {
+        if (auto* histogramManager = dynamic_cast<NDHistogramManager*>(plugin.get())) {
+            histogramManager->setOutputScale(dataManager->previewScale());
+        }
+    }
+}
+
+void Analyzer::completeRun(ROOT::RDF::RNode& df, bool skimBooked, unsigned int runsBefore) {
+    applyOutputScales();
+
     // Save ND histograms (uses internally tracked histInfo / regionNames)
     if (auto histogramManager = getPlugin<NDHistogramManager>("histogramManager")) {
+        PhaseTimer::Scope phase(phaseTimer_m, "histogram_writing");
         histogramManager->saveHists();
     }
 
+    // Complete the booked skim; this only starts the event loop when no
+    // histogram triggered it.
+    const auto flushStart = PhaseTimer::Sample::now();
+    skimSink_m->flush();
+    if (skimBooked) {
+        phaseTimer_m.add("snapshot", flushStart, PhaseTimer::Sample::now());
+    }
+
+    writeSystematicPruningReport();
+
+    if (auto* dataManager = dynamic_cast<DataManager*>(dataFrameProvider_m.get())) {
+        dataManager->unpinMainThread();
+        dataManager->reportSlowSites();
+        dataManager->writeSelectionCache();
+        dataManager->buildJitCache();
+        dataManager->exportJitExpressions();
+    }
+    reportNodeProfile();
+    reportFilterProfile();
+
+    const auto finalizeStart = PhaseTimer::Sample::now();
+
     // Finalize all non-provenance services (e.g. CounterService).
     // ProvenanceService is finalized last so it captures contributions from
     // plugins and other services.
@@ -429,6 +1099,7 @@ Analyzer *Analyzer::run() {
     for (const auto& role : pluginOrder_m) {
         auto it = plugins.find(role);
         if (it != plugins.end() && it->second) {
+            TraceRecorder::Span span("plugin", role + ".finalize");
             it->second->finalize();
         }
     }
@@ -438,14 +1109,419 @@ Analyzer *Analyzer::run() {
             it->second->reportMetadata();
         }
     }
+    phaseTimer_m.add("finalize", finalizeStart, PhaseTimer::Sample::now());
 
     // Collect structured provenance contributions from plugins and services,
     // then finalize ProvenanceService so it writes all collected entries.
     collectAndRegisterProvenance(df);
 
+    // Under MPI every rank wrote its own meta file; rank 0 writes the sum.
+    MpiRuntime::reduceOutputs(*configProvider_m);
+
+    warnOnRepeatedEventLoops(df, runsBefore);
+    if (traceService_m) {
+        traceService_m->write();
+    }
+    AsyncLogger::instance().flush();
+}
+
+void Analyzer::configureSystematicPruning() {
+    systematicPruningInput_m = configProvider_m->get("systematicPruningInput");
+    systematicPruningReport_m = configProvider_m->get("systematicPruningReport");
+    if (systematicPruningInput_m.empty() && systematicPruningReport_m.empty()) {
+        return;
+    }
+    auto* systematicManager =
+        dynamic_cast<SystematicManager*>(systematicManager_m.get());
+    if (!systematicManager) {
+        throw std::runtime_error(
+            "Analyzer: systematic pruning requires the default SystematicManager");
+    }
+
+    if (!systematicPruningInput_m.empty()) {
+        const auto pruned =
+            SystematicManager::readPrunedSystematics(systematicPruningInput_m);
+        systematicManager->setPrunedSystematics(pruned);
+        RDF_LOG_INFO << "Systematic pruning: dropping " << pruned.size()
+                     << " systematics listed in " << systematicPruningInput_m;
+    }
+
+    if (systematicPruningReport_m.empty()) {
+        return;
+    }
+    const auto readDouble = [this](const std::string& key, double fallback) {
+        const std::string value = configProvider_m->get(key);
+        return value.empty() ? fallback : std::stod(value);
+    };
+    systematicPruningNormThreshold_m =
+        readDouble("systematicPruningNormThreshold", systematicPruningNormThreshold_m);
+    systematicPruningShapeThreshold_m =
+        readDouble("systematicPruningShapeThreshold", systematicPruningShapeThreshold_m);
+    systematicPruningFraction_m =
+        readDouble("systematicPruningFraction", systematicPruningFraction_m);
+    if (systematicPruningFraction_m <= 0.0 || systematicPruningFraction_m > 1.0) {
+        throw std::runtime_error(
+            "Analyzer: systematicPruningFraction must be in (0, 1]");
+    }
+
+    // Sample the first pass evenly over the input instead of taking its
+    // head, so the measured impacts are not biased towards the first files.
+    const auto stride = static_cast<ULong64_t>(
+        std::llround(1.0 / systematicPruningFraction_m));
+    if (stride > 1) {
+        auto df = dataFrameProvider_m->getDataFrame();
+        dataFrameProvider_m->setDataFrame(df.Filter(
+            [stride](ULong64_t entry) { return entry % stride == 0; },
+            {"rdfentry_"}, "systematicPruningSample"));
+    }
+    RDF_LOG_INFO << "Systematic pruning pass: processing 1/" << stride
+                 << " of the entries, report -> " << systematicPruningReport_m;
+}
+
+void Analyzer::writeSystematicPruningReport() {
+    if (systematicPruningReport_m.empty()) {
+        return;
+    }
+    auto* systematicManager =
+        dynamic_cast<SystematicManager*>(systematicManager_m.get());
+    if (!systematicManager) {
+        return;
+    }
+    systematicManager->writePruningReport(systematicPruningReport_m,
+                                          systematicPruningNormThreshold_m,
+                                          systematicPruningShapeThreshold_m);
+    const auto pruned = systematicManager->selectPrunableSystematics(
+        systematicPruningNormThreshold_m, systematicPruningShapeThreshold_m);
+    RDF_LOG_INFO << "Systematic pruning: " << pruned.size() << " of "
+                 << systematicManager->getSystematicImpacts().size()
+                 << " measured systematics below threshold";
+}
+
+void Analyzer::configureDeferredVariations() {
+    auto* dataManager = dynamic_cast<DataManager*>(dataFrameProvider_m.get());
+    auto* systematicManager =
+        dynamic_cast<SystematicManager*>(systematicManager_m.get());
+    if (!dataManager || !systematicManager ||
+        !dataManager->isDeferVariationColumnsEnabled()) {
+        return;
+    }
+    systematicManager->setColumnMaterializer(
+        [dataManager](const std::string& column) {
+            dataManager->materializeColumn(column);
+        });
+}
+
+bool Analyzer::materializeSkimVariations() {
+    auto* dataManager = dynamic_cast<DataManager*>(dataFrameProvider_m.get());
+    if (!dataManager || (dataManager->getPendingColumns().empty() &&
+                         dataManager->getFoldedConstants().empty())) {
+        return false;
+    }
+    const auto& configMap = configProvider_m->getConfigMap();
+    const auto saveIt = configMap.find("saveConfig");
+    if (saveIt == configMap.end()) {
+        // The full dataframe is written, including every variation.
+        dataManager->materializeAllColumns();
+        return true;
+    }
+    // Same column selection as the output sink: globs match pending names,
+    // plain names request themselves (folded constants) and their registered
+    // variations.
+    auto pending = dataManager->getPendingColumns();
+    const auto folded = dataManager->getFoldedConstants();
+    pending.insert(pending.end(), folded.begin(), folded.end());
+    for (auto column : configProvider_m->parseVectorConfig(saveIt->second)) {
+        column = column.substr(0, column.find(' '));
+        if (column.empty()) {
+            continue;
+        }
+        if (column.find_first_of("*?") != std::string::npos) {
+            for (const auto& name : pending) {
+                if (fnmatch(column.c_str(), name.c_str(), 0) == 0) {
+                    dataManager->materializeColumn(name);
+                }
+            }
+            continue;
+        }
+        dataManager->materializeColumn(column);
+        for (const auto& syst : systematicManager_m->getSystematicsForVariable(column)) {
+            dataManager->materializeColumn(column + "_" + syst + "Up");
+            dataManager->materializeColumn(column + "_" + syst + "Down");
+        }
+    }
+    return true;
+}
+
+void Analyzer::reportDeadVariationColumns() {
+    auto* dataManager = dynamic_cast<DataManager*>(dataFrameProvider_m.get());
+    if (!dataManager || !dataManager->isDeferVariationColumnsEnabled()) {
+        return;
+    }
+    deadVariationColumns_m = dataManager->getPendingColumns();
+    RDF_LOG_INFO << "Dead-column elimination: " << deadVariationColumns_m.size()
+                 << " of " << dataManager->getDeferredColumnCount()
+                 << " variation columns have no consumer and were not defined";
+    for (const auto& column : deadVariationColumns_m) {
+        RDF_LOG_INFO << "  " << column;
+    }
+}
+
+void Analyzer::pruneInputBranches(bool skimBooked) {
+    auto* dataManager = dynamic_cast<DataManager*>(dataFrameProvider_m.get());
+    if (!dataManager || !dataManager->isInputBranchPruningEnabled()) {
+        return;
+    }
+    if (skimBooked) {
+        std::vector<std::string> columns;
+        if (!skimSink_m->bookedColumns(columns)) {
+            RDF_LOG_INFO << "Input branch pruning skipped: the skim writes every column";
+            return;
+        }
+        dataManager->recordColumnsRead(columns);
+    }
+    dataManager->pruneUnreadBranches();
+}
+
+void Analyzer::configureSkimColumnManifest(ROOT::RDF::RNode& df) {
+    const std::string manifestFlag = configProvider_m->get("skimColumnManifest");
+    auto* dataManager = dynamic_cast<DataManager*>(dataFrameProvider_m.get());
+    const std::string base = dataManager ? dataManager->getIncrementalSkimBase() : "";
+    if (base.empty() && manifestFlag != "1" && manifestFlag != "true" &&
+        manifestFlag != "True") {
+        return;
+    }
+    const std::string format = configProvider_m->get("skimOutputFormat");
+    auto* rootSink = dynamic_cast<RootOutputSink*>(skimSink_m.get());
+    if (!rootSink || (!format.empty() && format != "root")) {
+        throw std::runtime_error(
+            "Analyzer: skim column manifests require skimOutputFormat=root");
+    }
+
+    SkimColumnManifest manifest;
+    manifest.base = base;
+    const std::string index = configProvider_m->get("incrementalSkimIndex");
+    manifest.indexColumns = configProvider_m->splitString(index.empty() ? "run,event" : index, ",");
+    if (!base.empty() && manifest.indexColumns.empty()) {
+        throw std::runtime_error("Analyzer: incrementalSkimBase requires incrementalSkimIndex columns");
+    }
+
+    // Producer of each plugin column; systematic variations ("<column>_<syst>Up")
+    // are attributed through the longest produced-column prefix.
+    std::map<std::string, SkimColumnManifest::Entry> produced;
+    for (const auto& [role, plugin] : plugins) {
+        if (!plugin) continue;
+        const SkimColumnManifest::Entry entry{role, pluginConfigHash(plugin->collectProvenanceEntries())};
+        for (const auto& column : plugin->getProducedColumns()) {
+            produced[column] = entry;
+        }
+    }
+    // Prefixes of a column sort before it, the longest one first.
+    auto producerOf = [&produced](const std::string& column) -> const SkimColumnManifest::Entry* {
+        for (auto it = produced.upper_bound(column); it != produced.begin();) {
+            --it;
+            if (column == it->first || column.rfind(it->first + "_", 0) == 0) {
+                return &it->second;
+            }
+            if (it->first.empty() || it->first[0] != column[0]) {
+                break;
+            }
+        }
+        return nullptr;
+    };
+
+    const auto force = configProvider_m->splitString(configProvider_m->get("incrementalSkimForce"), ",");
+    const std::string forcedHash = "forced-" + std::to_string(std::time(nullptr));
+    for (const auto& column : df.GetDefinedColumnNames()) {
+        const auto* entry = producerOf(column);
+        auto& recorded = manifest.columns[column];
+        recorded = entry ? *entry : SkimColumnManifest::Entry{"analysis", ""};
+        for (const auto& pattern : force) {
+            if (fnmatch(pattern.c_str(), column.c_str(), 0) == 0) {
+                recorded.hash = forcedHash;
+                break;
+            }
+        }
+    }
+    rootSink->setColumnManifest(std::move(manifest));
+}
+
+void Analyzer::reportNodeProfile() {
+    auto* dataManager = dynamic_cast<DataManager*>(dataFrameProvider_m.get());
+    if (!dataManager || !dataManager->nodeProfiler()) {
+        return;
+    }
+    for (const auto& role : pluginOrder_m) {
+        auto it = plugins.find(role);
+        if (it != plugins.end() && it->second) {
+            dataManager->nodeProfiler()->attribute(it->second->getProducedColumns(), role);
+        }
+    }
+    dataManager->reportNodeProfile();
+}
+
+void Analyzer::configureLogging() {
+    auto& logger = AsyncLogger::instance();
+    const std::string level = configProvider_m->get("logLevel");
+    if (!level.empty()) {
+        logger.setLevel(AsyncLogger::parseLevel(level));
+    }
+    const std::string rateLimit = configProvider_m->get("logRateLimit");
+    if (!rateLimit.empty()) {
+        double perSecond = 0;
+        try {
+            perSecond = std::stod(rateLimit);
+        } catch (const std::exception&) {
+            throw std::runtime_error("Analyzer: logRateLimit '" + rateLimit +
+                                     "' is not a number of messages per second");
+        }
+        logger.setRateLimit(perSecond);
+    }
+}
+
+void Analyzer::configureTracing() {
+    if (!configProvider_m->get("traceFile").empty()) {
+        TraceRecorder::instance().enable();
+    }
+}
+
+void Analyzer::configurePluginGates() {
+    for (const auto& entry : configProvider_m->getList("pluginGates")) {
+        const auto colon = entry.find(':');
+        if (colon == std::string::npos || colon == 0 || colon + 1 == entry.size()) {
+            throw std::runtime_error("Analyzer: pluginGates entry '" + entry +
+                                     "' is not of the form <role>:<column>");
+        }
+        pluginGates_m[entry.substr(0, colon)] = entry.substr(colon + 1);
+    }
+}
+
+std::string Analyzer::pluginGate(const std::string& role) const {
+    auto it = pluginGates_m.find(role);
+    return it == pluginGates_m.end() ? std::string() : it->second;
+}
+
+void Analyzer::gatePluginColumns(const std::string& role) {
+    auto* dataManager = dynamic_cast<DataManager*>(dataFrameProvider_m.get());
+    auto it = plugins.find(role);
+    if (!dataManager || it == plugins.end() || !it->second || !pluginGates_m.count(role)) {
+        return;
+    }
+    dataManager->gateColumns(it->second->getProducedColumns(), pluginGate(role));
+}
+
+Analyzer *Analyzer::gatePlugin(const std::string& role, const std::string& gateColumn) {
+    pluginGates_m[role] = gateColumn;
+    gatePluginColumns(role);
+    return this;
+}
+
+Analyzer *Analyzer::beginPreselection(const std::string& name, const std::string& version) {
+    if (preselectionOpen_m) {
+        throw std::runtime_error(
+            "Analyzer::beginPreselection(): a preselection block is already open");
+    }
+    if (!filterProfile_m) {
+        filterProfilePath_m = configProvider_m->get("filterProfile");
+        if (!filterProfilePath_m.empty()) {
+            filterProfilePrevious_m = FilterProfile::read(filterProfilePath_m);
+            filterProfile_m = std::make_unique<FilterProfile>(
+                dataFrameProvider_m->getDataFrame().GetNSlots());
+        }
+    }
+    preselectionOpen_m = true;
+    preselectionName_m = name;
+    preselectionVersion_m = version;
+    return this;
+}
+
+Analyzer *Analyzer::endPreselection() {
+    if (!preselectionOpen_m) {
+        throw std::runtime_error(
+            "Analyzer::endPreselection(): no preselection block is open");
+    }
+    // The cached entries are filtered on before the block, which then only
+    // evaluates its cuts on them; a recording is booked after it.
+    useSelectionCache(preselection_m);
+    std::string applied;
+    if (filterProfile_m) {
+        dataFrameProvider_m->Filter(filterProfile_m->start(), {"rdfslot_"});
+    }
+    for (const std::size_t i : FilterProfile::order(preselection_m, filterProfilePrevious_m)) {
+        const std::string& name = preselection_m[i];
+        if (filterProfile_m) {
+            dataFrameProvider_m->Filter(filterProfile_m->wrap(name), {"rdfslot_", name});
+        } else {
+            dataFrameProvider_m->Filter(passCut, {name});
+        }
+        applied += (applied.empty() ? "" : ",") + name.substr(5);
+    }
+    preselectionOrders_m.push_back(applied);
+    if (auto* dataManager = dynamic_cast<DataManager*>(dataFrameProvider_m.get())) {
+        dataManager->recordSelectionCache();
+    }
+    preselection_m.clear();
+    preselectionOpen_m = false;
     return this;
 }
 
+void Analyzer::useSelectionCache(const std::vector<std::string>& filters) {
+    const std::string directory = configProvider_m->get("selectionCacheDir");
+    auto* dataManager = dynamic_cast<DataManager*>(dataFrameProvider_m.get());
+    if (directory.empty() || preselectionName_m.empty() || !dataManager) {
+        return;
+    }
+    // The declared filters, not the applied order, define the selection.
+    std::unordered_map<std::string, std::string> entries;
+    entries["preselection.name"] = preselectionName_m;
+    entries["preselection.version"] = preselectionVersion_m;
+    std::string declared;
+    for (const auto& filter : filters) {
+        declared += (declared.empty() ? "" : ",") + filter.substr(5);
+    }
+    entries["preselection.filters"] = declared;
+    const auto keys = configProvider_m->getList("selectionCacheKeys");
+    if (keys.empty()) {
+        for (const auto& [key, value] : configProvider_m->getConfigMap()) {
+            entries["config." + key] = value;
+        }
+    } else {
+        for (const auto& key : keys) {
+            entries["config." + key] = configProvider_m->get(key);
+        }
+    }
+    const std::string key = pluginConfigHash(entries);
+    if (preselectionVersion_m.empty()) {
+        RDF_LOG_INFO << "Selection cache not used for preselection '" << preselectionName_m
+                     << "': the block has no version (see beginPreselection())";
+        selectionCaches_m.push_back({preselectionName_m, key, "unused"});
+        return;
+    }
+    // Counters and other results booked before the block are upstream of
+    // the cache's filter and still see every entry.
+    const std::string status = dataManager->useSelectionCache(directory, key);
+    selectionCaches_m.push_back({preselectionName_m, key, status.empty() ? "unused" : status});
+}
+
+void Analyzer::reportFilterProfile() {
+    if (!filterProfile_m) {
+        return;
+    }
+    filterProfile_m->write(filterProfilePath_m, filterProfilePrevious_m);
+    RDF_LOG_INFO << "Wrote the profile of " << filterProfile_m->measured().size()
+                 << " preselection filters to " << filterProfilePath_m;
+}
+
+void Analyzer::warnOnRepeatedEventLoops(ROOT::RDF::RNode& df,
+                                        unsigned int runsBefore) const {
+    const unsigned int runs = df.GetNRuns() - runsBefore;
+    if (runs > 1) {
+        RDF_LOG_WARN << "Warning: Analyzer::run() executed " << runs
+                     << " event loops; the input was read " << runs
+                     << " times. Book every result before the first one is"
+                     << " read to share a single event loop.";
+    }
+}
+
 ROOT::RDF::RNode Analyzer::getDF() {
     return dataFrameProvider_m->getDataFrame();
 }
@@ -7,10 +7,17 @@
  * directories, splitting strings, and setting up ROOT data structures such as
  * TChain and RDataFrame.
  */
+#include <algorithm>
+#include <AsyncLogger.h>
+#include <atomic>
 #include <cstdlib>
 #include <dlfcn.h>
+#include <filesystem>
+#include <fstream>
+#include <future>
 #include <iostream>
 #include <memory>
+#include <sstream>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -18,13 +25,21 @@
 #include <ROOT/RDFHelpers.hxx>
 #include <ROOT/RDataFrame.hxx>
 #include <TChain.h>
+#include <TEnv.h>
+#include <TFile.h>
+#include <TKey.h>
+#include <TMD5.h>
 #include <TROOT.h>
+#include <TTreeCache.h>
+#include <TTreeCacheUnzip.h>
 
 #include <dirent.h>
+#include <unistd.h>
 
 #include <yaml-cpp/yaml.h>
 
 #include <functions.h>
+#include <SampleSet.h>
 #include <plots.h>
 #include <util.h>
 
@@ -47,6 +62,11 @@ getTreeList(const IConfigurationProvider &configProvider) {
  */
 static std::vector<std::string>
 getFileList(const IConfigurationProvider &configProvider) {
+  // A multi-sample job chains the files of all its samples.
+  const SampleSet samples = SampleSet::fromConfig(configProvider);
+  if (!samples.empty()) {
+    return samples.files();
+  }
   return configProvider.getList("fileList");
 }
 
@@ -120,24 +140,31 @@ static bool matchesGlobs(const std::string &name,
 }
 
 /**
- * @brief Recursively scan a directory for ROOT files matching glob patterns
- * @param chain TChain to add matching files to
- * @param directory Directory to scan
+ * @brief Files and subdirectories found in one directory.
+ */
+struct DirectoryListing {
+  std::vector<std::string> files;
+  std::vector<std::string> subdirectories;
+};
+
+/**
+ * @brief List one directory level: ROOT files matching the globs, and the
+ * subdirectories to descend into (names without a '.').
+ * @param directory Directory to list
  * @param globs List of glob patterns to match (include)
  * @param antiglobs List of glob patterns to exclude
- * @param base Whether this is the base (top-level) directory
- * @return Number of files found and added to the chain
+ * @return Listing; empty if the directory cannot be opened
  */
-static int scanDirectory(TChain &chain, const std::string &directory,
-                         const std::vector<std::string> &globs,
-                         const std::vector<std::string> &antiglobs, bool base) {
-  int filesFound = 0;
+static DirectoryListing listDirectory(const std::string &directory,
+                                      const std::vector<std::string> &globs,
+                                      const std::vector<std::string> &antiglobs) {
+  DirectoryListing listing;
   DIR *dr = opendir(directory.c_str());
   if (dr == nullptr) {
-    // Directory does not exist or cannot be opened; return 0 files found.
+    // Directory does not exist or cannot be opened; return no files.
     // Do not throw here so that higher-level logic can decide how to proceed
     // (for example unit tests that operate without input files).
-    return filesFound;
+    return listing;
   }
   struct dirent *en;
   while ((en = readdir(dr)) != NULL) {
@@ -145,16 +172,265 @@ static int scanDirectory(TChain &chain, const std::string &directory,
     std::string fullName = directory + "/" + name;
     if (name.find(".root") != std::string::npos) {
       if (matchesGlobs(name, globs, antiglobs, fullName)) {
-        chain.Add(fullName.c_str());
-        filesFound++;
+        listing.files.push_back(fullName);
       }
     } else if (!name.empty() && name.find(".") == std::string::npos) {
-      filesFound += scanDirectory(chain, directory + "/" + name + "/", globs,
-                                  antiglobs, false);
+      listing.subdirectories.push_back(fullName);
     }
   }
   closedir(dr);
-  return filesFound;
+  std::sort(listing.files.begin(), listing.files.end());
+  std::sort(listing.subdirectories.begin(), listing.subdirectories.end());
+  return listing;
+}
+
+/**
+ * @brief Modification time of a directory in filesystem clock ticks, or -1
+ * if it cannot be read.
+ */
+static long long directoryModificationTime(const std::string &directory) {
+  std::error_code ec;
+  const auto time = std::filesystem::last_write_time(directory, ec);
+  if (ec) {
+    return -1;
+  }
+  return static_cast<long long>(time.time_since_epoch().count());
+}
+
+/**
+ * @brief Result of a directory scan: matching files and every directory
+ * visited (with its modification time, for cache validation).
+ */
+struct DirectoryScan {
+  std::vector<std::string> files;
+  std::vector<std::pair<std::string, long long>> directories;
+};
+
+/**
+ * @brief Recursively scan a directory tree, listing each level in parallel.
+ *
+ * Directories of one depth are listed by up to @p threads concurrent workers;
+ * the results are merged in sorted order so the file order does not depend on
+ * scheduling.
+ */
+static DirectoryScan scanDirectoryTree(const std::string &directory,
+                                       const std::vector<std::string> &globs,
+                                       const std::vector<std::string> &antiglobs,
+                                       unsigned int threads) {
+  DirectoryScan result;
+  std::vector<std::string> level{directory};
+  threads = std::max(1u, threads);
+  while (!level.empty()) {
+    std::vector<DirectoryListing> listings(level.size());
+    std::vector<long long> modificationTimes(level.size(), -1);
+    std::atomic<std::size_t> next{0};
+    auto worker = [&]() {
+      for (std::size_t i = next.fetch_add(1); i < level.size(); i = next.fetch_add(1)) {
+        modificationTimes[i] = directoryModificationTime(level[i]);
+        listings[i] = listDirectory(level[i], globs, antiglobs);
+      }
+    };
+    const std::size_t workers = std::min<std::size_t>(threads, level.size());
+    std::vector<std::future<void>> futures;
+    for (std::size_t w = 1; w < workers; ++w) {
+      futures.push_back(std::async(std::launch::async, worker));
+    }
+    worker();
+    for (auto &future : futures) {
+      future.get();
+    }
+
+    std::vector<std::string> nextLevel;
+    for (std::size_t i = 0; i < level.size(); ++i) {
+      result.directories.emplace_back(level[i], modificationTimes[i]);
+      result.files.insert(result.files.end(), listings[i].files.begin(),
+                          listings[i].files.end());
+      nextLevel.insert(nextLevel.end(), listings[i].subdirectories.begin(),
+                       listings[i].subdirectories.end());
+    }
+    level = std::move(nextLevel);
+  }
+  return result;
+}
+
+/**
+ * @brief Path of the file-list cache entry for a directory and glob set.
+ */
+static std::string fileListCachePath(const std::string &cacheDirectory,
+                                     const std::string &directory,
+                                     const std::vector<std::string> &globs,
+                                     const std::vector<std::string> &antiglobs) {
+  std::ostringstream key;
+  key << directory << '\n';
+  for (const auto &glob : globs) {
+    key << "glob:" << glob << '\n';
+  }
+  for (const auto &glob : antiglobs) {
+    key << "antiglob:" << glob << '\n';
+  }
+  const std::string keyString = key.str();
+  TMD5 md5;
+  md5.Update(reinterpret_cast<const UChar_t *>(keyString.data()),
+             static_cast<UInt_t>(keyString.size()));
+  md5.Final();
+  return cacheDirectory + "/filelist_" + md5.AsString() + ".txt";
+}
+
+/**
+ * @brief Read a file-list cache entry.
+ *
+ * The entry is valid only if every directory recorded in it still has the
+ * recorded modification time, i.e. no file was added or removed since the
+ * scan.
+ *
+ * @return true and fills @p files when the entry exists and is valid
+ */
+static bool readFileListCache(const std::string &cachePath,
+                              std::vector<std::string> &files) {
+  std::ifstream in(cachePath);
+  if (!in.is_open()) {
+    return false;
+  }
+  std::vector<std::string> cachedFiles;
+  bool sawDirectory = false;
+  std::string line;
+  while (std::getline(in, line)) {
+    if (line.empty() || line[0] == '#') {
+      continue;
+    }
+    const auto tab = line.find('\t');
+    if (tab == std::string::npos) {
+      return false;
+    }
+    const std::string kind = line.substr(0, tab);
+    const std::string rest = line.substr(tab + 1);
+    if (kind == "F") {
+      cachedFiles.push_back(rest);
+    } else if (kind == "D") {
+      const auto pathTab = rest.find('\t');
+      if (pathTab == std::string::npos) {
+        return false;
+      }
+      long long cachedTime = 0;
+      try {
+        cachedTime = std::stoll(rest.substr(0, pathTab));
+      } catch (const std::exception &) {
+        return false;
+      }
+      if (directoryModificationTime(rest.substr(pathTab + 1)) != cachedTime) {
+        return false;
+      }
+      sawDirectory = true;
+    } else {
+      return false;
+    }
+  }
+  if (!sawDirectory) {
+    return false;
+  }
+  files = std::move(cachedFiles);
+  return true;
+}
+
+/**
+ * @brief Write a file-list cache entry atomically (write + rename) so that
+ * concurrent jobs never read a partial entry.
+ */
+static void writeFileListCache(const std::string &cachePath,
+                               const DirectoryScan &scanResult) {
+  std::error_code ec;
+  std::filesystem::create_directories(
+      std::filesystem::path(cachePath).parent_path(), ec);
+  const std::string tmpPath =
+      cachePath + ".tmp" + std::to_string(static_cast<long long>(getpid()));
+  {
+    std::ofstream out(tmpPath);
+    if (!out.is_open()) {
+      RDF_LOG_WARN << "Warning: cannot write file-list cache " << cachePath;
+      return;
+    }
+    out << "# file-list cache: D<TAB>mtime<TAB>directory, F<TAB>file\n";
+    for (const auto &[directory, time] : scanResult.directories) {
+      if (time < 0) {
+        // Unreadable directory: do not cache a result that cannot be validated.
+        out.close();
+        std::filesystem::remove(tmpPath, ec);
+        return;
+      }
+      out << "D\t" << time << '\t' << directory << '\n';
+    }
+    for (const auto &file : scanResult.files) {
+      out << "F\t" << file << '\n';
+    }
+  }
+  std::filesystem::rename(tmpPath, cachePath, ec);
+  if (ec) {
+    std::filesystem::remove(tmpPath, ec);
+  }
+}
+
+std::vector<std::string>
+discoverRootFiles(const std::string &directory,
+                  const std::vector<std::string> &globs,
+                  const std::vector<std::string> &antiglobs,
+                  unsigned int threads, const std::string &cacheDirectory) {
+  RDF_LOG_INFO << "Checking " << directory;
+  std::string cachePath;
+  if (!cacheDirectory.empty()) {
+    cachePath = fileListCachePath(cacheDirectory, directory, globs, antiglobs);
+    std::vector<std::string> cachedFiles;
+    if (readFileListCache(cachePath, cachedFiles)) {
+      RDF_LOG_INFO << "Using cached file list " << cachePath;
+      return cachedFiles;
+    }
+  }
+
+  DirectoryScan scanResult = scanDirectoryTree(directory, globs, antiglobs, threads);
+  if (!cachePath.empty()) {
+    writeFileListCache(cachePath, scanResult);
+  }
+  return std::move(scanResult.files);
+}
+
+/**
+ * @brief Load per-file entry counts from the ``entryIndex`` sidecar.
+ *
+ * The sidecar is the JSON index written by the law partitioning step
+ * (``{"tree": ..., "files": {url: {"entries": n, "clusters": [...]}}}``).
+ * It is parsed with yaml-cpp, which reads JSON.
+ *
+ * @param configProvider Configuration provider containing ``entryIndex``
+ * @param treeName Name of the tree the counts must refer to
+ * @return Map from file name to entry count (empty if no usable index)
+ */
+static std::unordered_map<std::string, Long64_t>
+loadEntryIndex(const IConfigurationProvider &configProvider,
+               const std::string &treeName) {
+  std::unordered_map<std::string, Long64_t> entries;
+  const std::string indexPath = configProvider.get("entryIndex");
+  if (indexPath.empty()) {
+    return entries;
+  }
+  try {
+    const YAML::Node index = YAML::LoadFile(indexPath);
+    if (index["tree"] && index["tree"].as<std::string>() != treeName) {
+      RDF_LOG_WARN << "Warning: entryIndex " << indexPath << " describes tree '"
+                   << index["tree"].as<std::string>() << "', not '" << treeName
+                   << "'; ignoring it.";
+      return entries;
+    }
+    for (const auto &file : index["files"]) {
+      const Long64_t n = file.second["entries"].as<Long64_t>();
+      if (n > 0) {
+        entries.emplace(file.first.as<std::string>(), n);
+      }
+    }
+  } catch (const std::exception &e) {
+    RDF_LOG_WARN << "Warning: cannot read entryIndex " << indexPath << ": "
+                 << e.what();
+    entries.clear();
+  }
+  return entries;
 }
 
 /**
@@ -164,6 +440,10 @@ static int scanDirectory(TChain &chain, const std::string &directory,
  * If threads > 1, enables that many threads.
  * If threads = 1, runs single-threaded.
  * If threads < 1 or not specified, enables maximum number of threads.
+ *
+ * ``treeParallelUnzip`` (``true``, ``false`` or ``force``) sets whether the
+ * TTreeCache decompresses the baskets it prefetched on ROOT's thread pool
+ * (TTreeCacheUnzip::SetParallelUnzip); unset keeps ROOT's default.
  */
 static void setupROOTThreads(const IConfigurationProvider &configProvider) {
   int threads = -1;
@@ -177,7 +457,7 @@ static void setupROOTThreads(const IConfigurationProvider &configProvider) {
       try {
         threads = std::stoi(value);
       } catch (const std::exception &) {
-        std::cout << "Invalid threads value '" << value << "', defaulting to auto" << std::endl;
+        RDF_LOG_WARN << "Invalid threads value '" << value << "', defaulting to auto";
         threads = 0;
       }
     }
@@ -185,36 +465,54 @@ static void setupROOTThreads(const IConfigurationProvider &configProvider) {
 
   if (threads > 1) {
     ROOT::EnableImplicitMT(threads);
-    std::cout << "Running with " << threads << " threads" << std::endl;
+    RDF_LOG_INFO << "Running with " << threads << " threads";
   } else if (threads == 1) {
-    std::cout << "Running with 1 thread" << std::endl;
+    RDF_LOG_INFO << "Running with 1 thread";
   } else {
     ROOT::EnableImplicitMT();
-    std::cout << "Running with maximum number of threads" << std::endl;
+    RDF_LOG_INFO << "Running with maximum number of threads";
+  }
+
+  const std::string unzip = configProvider.get("treeParallelUnzip");
+  if (unzip == "true" || unzip == "1") {
+    TTreeCacheUnzip::SetParallelUnzip(TTreeCacheUnzip::kEnable);
+  } else if (unzip == "false" || unzip == "0") {
+    TTreeCacheUnzip::SetParallelUnzip(TTreeCacheUnzip::kDisable);
+  } else if (unzip == "force") {
+    TTreeCacheUnzip::SetParallelUnzip(TTreeCacheUnzip::kForce);
+  } else if (!unzip.empty()) {
+    throw std::runtime_error("setupROOTThreads: invalid treeParallelUnzip '" + unzip +
+                             "' (expected true, false or force)");
+  }
+  if (!unzip.empty()) {
+    RDF_LOG_INFO << "Parallel basket decompression: " << unzip;
   }
 }
 
 /**
- * @brief Scan a directory for ROOT files matching globs and add them to a
- * TChain
+ * @brief Scan a directory tree for ROOT files matching globs and add them to
+ * a TChain
  *
- * This function is not recursive by default. It only checks one directory level
- * unless base is false.
+ * Files are added without being opened; TChain reads their entry counts when
+ * the event loop reaches them.
  *
  * @param chain TChain to add files to
  * @param directory Directory to scan
  * @param globs List of substrings to match (include)
  * @param antiglobs List of substrings to exclude
- * @param base If true, only scan the top-level directory
+ * @param base If true, warn when no file is found
  * @return Number of files found and added
  */
 int scan(TChain &chain, const std::string &directory,
          const std::vector<std::string> &globs,
          const std::vector<std::string> &antiglobs, bool base) {
-  std::cout << "Checking " << directory << std::endl;
-  int filesFound = scanDirectory(chain, directory, globs, antiglobs, base);
+  const auto files = discoverRootFiles(directory, globs, antiglobs);
+  for (const auto &file : files) {
+    chain.Add(file.c_str());
+  }
+  const int filesFound = static_cast<int>(files.size());
   if (filesFound == 0 && base) {
-    std::cout << "Warning: No files found for TChain in directory " << directory << std::endl;
+    RDF_LOG_WARN << "Warning: No files found for TChain in directory " << directory;
     // Proceed without throwing so tests and non-file-based workflows can continue
   }
   return filesFound;
@@ -249,21 +547,55 @@ makeTChain(const IConfigurationProvider &configProvider) {
   std::vector<std::string> antiGlobs =
       configProvider.getList("antiglobs", {"FAIL"});
 
+  // Known entry counts let TChain skip opening files to count entries.
+  const auto indexedEntries = loadEntryIndex(
+      configProvider, treeListVec.empty() ? std::string() : treeListVec.front());
+  auto addFile = [&indexedEntries](TChain &chain, const std::string &file,
+                                   bool mainTree) {
+    if (mainTree) {
+      auto it = indexedEntries.find(file);
+      if (it != indexedEntries.end()) {
+        chain.Add(file.c_str(), it->second);
+        return;
+      }
+    }
+    chain.Add(file.c_str());
+  };
+
   int fileNum = 0;
   auto fileListVec = getFileList(configProvider);
   if (!fileListVec.empty()) {
     fileNum = fileListVec.size();
     for (const auto &file : fileListVec) {
-      std::cout << "Adding file " << file << std::endl;
-      for (auto &chain : tchainVector) {
-        chain->Add(file.c_str());
+      RDF_LOG_INFO << "Adding file " << file;
+      for (std::size_t i = 0; i < tchainVector.size(); ++i) {
+        addFile(*tchainVector[i], file, i == 0);
       }
     }
   } else {
     std::string directory = getDirectory(configProvider);
     if (!directory.empty()) {
-      for (auto &chain : tchainVector) {
-        fileNum = scan(*(tchainVector[0].get()), directory, globs, antiGlobs);
+      unsigned int discoveryThreads = 8;
+      const std::string threadsValue = configProvider.get("fileDiscoveryThreads");
+      if (!threadsValue.empty()) {
+        try {
+          discoveryThreads = static_cast<unsigned int>(std::max(1, std::stoi(threadsValue)));
+        } catch (const std::exception &) {
+          throw std::runtime_error("Error: invalid fileDiscoveryThreads '" +
+                                   threadsValue + "'");
+        }
+      }
+      const auto files =
+          discoverRootFiles(directory, globs, antiGlobs, discoveryThreads,
+                            configProvider.get("fileListCache"));
+      if (files.empty()) {
+        RDF_LOG_WARN << "Warning: No files found for TChain in directory " << directory;
+      }
+      fileNum = files.size();
+      for (std::size_t i = 0; i < tchainVector.size(); ++i) {
+        for (const auto &file : files) {
+          addFile(*tchainVector[i], file, i == 0);
+        }
       }
     } else {
       throw std::runtime_error(
@@ -275,10 +607,117 @@ makeTChain(const IConfigurationProvider &configProvider) {
   for (int i = 1; i < tchainVector.size(); i++) {
     tchainVector[0]->AddFriend(tchainVector[i].get());
   }
-  std::cout << fileNum << " files found" << std::endl;
+  RDF_LOG_INFO << fileNum << " files found";
   return tchainVector;
 }
 
+std::vector<std::string> getChainFileNames(const TChain &chain) {
+  std::vector<std::string> files;
+  const TObjArray *elements = chain.GetListOfFiles();
+  if (!elements) {
+    return files;
+  }
+  files.reserve(elements->GetEntriesFast());
+  for (const TObject *element : *elements) {
+    files.emplace_back(element->GetTitle());
+  }
+  return files;
+}
+
+/**
+ * @brief Read an optional integer config value.
+ * @return @p defaultValue when the key is absent
+ * @throws std::runtime_error when the value is not an integer
+ */
+static long long getIntegerOption(const IConfigurationProvider &configProvider,
+                                  const std::string &key,
+                                  long long defaultValue) {
+  const std::string value = configProvider.get(key);
+  if (value.empty()) {
+    return defaultValue;
+  }
+  try {
+    return std::stoll(value);
+  } catch (const std::exception &) {
+    throw std::runtime_error("Error: invalid " + key + " '" + value + "'");
+  }
+}
+
+void configureTreeReadAhead(const IConfigurationProvider &configProvider,
+                            TChain &chain, bool openAhead) {
+  const long long cacheSize = getIntegerOption(configProvider, "treeCacheSize", -1);
+  if (cacheSize >= 0) {
+    chain.SetCacheSize(cacheSize);
+  }
+
+  const std::string sizeFactor = configProvider.get("treeCacheSizeFactor");
+  if (!sizeFactor.empty()) {
+    try {
+      gEnv->SetValue("TTreeCache.Size", std::stod(sizeFactor));
+    } catch (const std::exception &) {
+      throw std::runtime_error("Error: invalid treeCacheSizeFactor '" +
+                               sizeFactor + "'");
+    }
+  }
+
+  const long long learnEntries =
+      getIntegerOption(configProvider, "treeCacheLearnEntries", -1);
+  if (learnEntries > 0) {
+    TTreeCache::SetLearnEntries(static_cast<Int_t>(learnEntries));
+    chain.SetCacheLearnEntries(static_cast<Int_t>(learnEntries));
+  }
+
+  const std::string prefetch = configProvider.get("treeCachePrefetch");
+  if (prefetch == "1" || prefetch == "true" || prefetch == "True") {
+    gEnv->SetValue("TFile.AsyncPrefetching", 1);
+  }
+
+  const long long asyncOpen = getIntegerOption(configProvider, "asyncOpenFiles", 0);
+  if (openAhead && asyncOpen > 0) {
+    // TFile::Open() picks up a pending asynchronous open of the same name.
+    const auto files = getChainFileNames(chain);
+    const std::size_t n = std::min<std::size_t>(files.size(), asyncOpen);
+    for (std::size_t i = 0; i < n; ++i) {
+      TFile::AsyncOpen(files[i].c_str());
+    }
+  }
+}
+
+bool isRNTupleInput(const IConfigurationProvider &configProvider,
+                    const TChain &chain) {
+  const std::string format = configProvider.get("inputFormat");
+  if (format.empty() || format == "ttree") {
+    return false;
+  }
+  if (format == "rntuple") {
+    return true;
+  }
+  if (format != "auto") {
+    throw std::runtime_error("Error: invalid inputFormat '" + format +
+                             "'. Valid values are 'ttree', 'rntuple' or 'auto'.");
+  }
+
+  const auto files = getChainFileNames(chain);
+  if (files.empty()) {
+    return false;
+  }
+  std::unique_ptr<TFile> file(TFile::Open(files.front().c_str(), "READ"));
+  if (!file || file->IsZombie()) {
+    RDF_LOG_WARN << "Warning: cannot open " << files.front()
+                 << " to detect the input format; assuming TTree.";
+    return false;
+  }
+  const TKey *key = file->GetKey(chain.GetName());
+  if (!key) {
+    return false;
+  }
+  const std::string className = key->GetClassName();
+  const bool rntuple = className.find("RNTuple") != std::string::npos;
+  RDF_LOG_INFO << "Detected " << (rntuple ? "RNTuple" : "TTree") << " input '"
+               << chain.GetName() << "'";
+  return rntuple;
+}
+
 /**
  * @brief Parse a friend-tree YAML configuration file into a list of specs.
  *
@@ -326,8 +765,7 @@ parseFriendTreeConfig(const std::string &configFile) {
       continue;
     }
     if (!entry["alias"]) {
-      std::cerr << "Warning: friend tree entry missing required 'alias' field; skipping."
-                << std::endl;
+      RDF_LOG_WARN << "Warning: friend tree entry missing required 'alias' field; skipping.";
       continue;
     }
 
@@ -374,3 +812,27 @@ parseFriendTreeConfig(const std::string &configFile) {
   return specs;
 }
 
+void writeFriendTreeConfig(const std::string &configFile,
+                           const std::vector<FriendTreeSpec> &specs) {
+  YAML::Emitter out;
+  out << YAML::BeginMap << YAML::Key << "friends" << YAML::Value << YAML::BeginSeq;
+  for (const auto &spec : specs) {
+    out << YAML::BeginMap;
+    out << YAML::Key << "alias" << YAML::Value << spec.alias;
+    out << YAML::Key << "treeName" << YAML::Value << spec.treeName;
+    out << YAML::Key << "fileList" << YAML::Value << spec.files;
+    if (!spec.indexBranches.empty()) {
+      out << YAML::Key << "indexBranches" << YAML::Value << YAML::Flow
+          << spec.indexBranches;
+    }
+    out << YAML::EndMap;
+  }
+  out << YAML::EndSeq << YAML::EndMap;
+
+  std::ofstream file(configFile);
+  if (!file) {
+    throw std::runtime_error("Cannot write friend tree config '" + configFile + "'");
+  }
+  file << out.c_str() << "\n";
+}
+
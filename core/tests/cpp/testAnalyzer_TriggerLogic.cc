@@ -8,6 +8,7 @@
 #include <CorrectionManager.h>
 //#include <NDHistogramManager.h>
 #include <test_util.h>
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <unordered_map>
@@ -169,6 +170,44 @@ TEST_F(AnalyzerTriggerLogicTest, MCTriggers) {
     EXPECT_EQ(result.GetValue(), 2UL);
 }
 
+TEST_F(AnalyzerTriggerLogicTest, TriggerMaskEncodesOneBitPerPath) {
+    auto config4 = ManagerFactory::createConfigurationManager("cfg/test_data_config.txt");
+    auto data4 = ManagerFactory::createDataManager(*config4);
+    auto bdt4 = std::make_unique<BDTManager>(*config4);
+    auto corr4 = std::make_unique<CorrectionManager>(*config4);
+    auto trig4 = std::make_unique<TriggerManager>(*config4);
+    auto syst4 = ManagerFactory::createSystematicManager();
+    config4->set("type", "test_sample");
+    Analyzer analyzer(
+        std::move(config4),
+        std::move(data4),
+        makeTestPluginMap(std::move(bdt4), std::move(corr4), std::move(trig4)),
+        std::move(syst4),
+        std::make_unique<DefaultLogger>(),
+        std::make_unique<NullOutputSink>(),
+        std::make_unique<NullOutputSink>());
+    analyzer.Define("trigger1", []() { return true; });
+    analyzer.Define("trigger2", []() { return false; });
+    analyzer.Define("trigger3", []() { return true; });
+    analyzer.Define("veto1", []() { return false; });
+    analyzer.Define("veto2", []() { return false; });
+
+    auto triggerPlugin = analyzer.getPlugin<TriggerManager>("trigger");
+    triggerPlugin->applyAllTriggers();
+
+    // Bit i corresponds to the i-th path of the group: trigger1 and trigger3.
+    auto df = analyzer.getDF();
+    auto triggerMasks = df.Take<std::uint64_t>("test_group_triggerMask");
+    auto vetoMasks = df.Take<std::uint64_t>("test_group_vetoMask");
+    ASSERT_EQ(triggerMasks->size(), 2UL);
+    for (const auto mask : *triggerMasks) {
+        EXPECT_EQ(mask, 0b101ULL);
+    }
+    for (const auto mask : *vetoMasks) {
+        EXPECT_EQ(mask, 0ULL);
+    }
+}
+
 int main(int argc, char **argv) {
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
@@ -0,0 +1,214 @@
+/**
+ * @file testAsyncLogger.cc
+ * @brief Unit tests for AsyncLogger – ordering, flushing, level filtering,
+ *        rate limiting and overflow of the ring buffer.
+ */
+
+#include <gtest/gtest.h>
+
+#include <AsyncLogger.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <condition_variable>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace {
+
+/// Sink recording every message, optionally blocking until released.
+struct RecordingSink {
+  std::mutex mutex;
+  std::vector<std::pair<ILogger::Level, std::string>> messages;
+  std::condition_variable cv;
+  bool blocked = false;
+
+  AsyncLogger::Sink sink() {
+    return [this](ILogger::Level level, const std::string &message) {
+      std::unique_lock<std::mutex> lock(mutex);
+      cv.wait(lock, [this] { return !blocked; });
+      messages.emplace_back(level, message);
+    };
+  }
+
+  void release() {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      blocked = false;
+    }
+    cv.notify_all();
+  }
+
+  std::vector<std::string> texts() {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<std::string> out;
+    for (const auto &entry : messages) {
+      out.push_back(entry.second);
+    }
+    return out;
+  }
+};
+
+} // namespace
+
+TEST(AsyncLoggerTest, FlushWritesMessagesInOrder) {
+  RecordingSink sink;
+  AsyncLogger logger(128, sink.sink());
+  for (int i = 0; i < 100; ++i) {
+    logger.log(ILogger::Level::Info, "message " + std::to_string(i));
+  }
+  logger.flush();
+
+  const auto texts = sink.texts();
+  ASSERT_EQ(texts.size(), 100u);
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_EQ(texts[i], "message " + std::to_string(i));
+  }
+}
+
+TEST(AsyncLoggerTest, ConcurrentProducersKeepPerThreadOrder) {
+  RecordingSink sink;
+  AsyncLogger logger(1024, sink.sink());
+  constexpr int kThreads = 8;
+  constexpr int kMessages = 2000;
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kThreads; ++t) {
+    threads.emplace_back([&logger, t] {
+      for (int i = 0; i < kMessages; ++i) {
+        // Warn never drops, so every message must arrive.
+        logger.log(ILogger::Level::Warn, std::to_string(t) + " " + std::to_string(i));
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  logger.flush();
+
+  const auto texts = sink.texts();
+  ASSERT_EQ(texts.size(), static_cast<size_t>(kThreads * kMessages));
+  std::vector<int> next(kThreads, 0);
+  for (const auto &text : texts) {
+    const auto space = text.find(' ');
+    const int thread = std::stoi(text.substr(0, space));
+    const int index = std::stoi(text.substr(space + 1));
+    EXPECT_EQ(index, next[thread]);
+    next[thread] = index + 1;
+  }
+}
+
+TEST(AsyncLoggerTest, LevelFiltersMessages) {
+  RecordingSink sink;
+  AsyncLogger logger(16, sink.sink());
+  logger.setLevel(ILogger::Level::Warn);
+  logger.log(ILogger::Level::Debug, "debug");
+  logger.log(ILogger::Level::Info, "info");
+  logger.log(ILogger::Level::Warn, "warn");
+  logger.log(ILogger::Level::Error, "error");
+  logger.flush();
+
+  EXPECT_EQ(sink.texts(), (std::vector<std::string>{"warn", "error"}));
+  EXPECT_EQ(logger.dropped(), 0u);
+}
+
+TEST(AsyncLoggerTest, ErrorIsWrittenBeforeLogReturns) {
+  RecordingSink sink;
+  AsyncLogger logger(16, sink.sink());
+  logger.log(ILogger::Level::Info, "before");
+  logger.log(ILogger::Level::Error, "failure");
+  EXPECT_EQ(sink.texts(), (std::vector<std::string>{"before", "failure"}));
+}
+
+TEST(AsyncLoggerTest, RateLimitDropsInfoButNotWarnings) {
+  RecordingSink sink;
+  AsyncLogger logger(1024, sink.sink());
+  logger.setRateLimit(1, 10);
+  for (int i = 0; i < 100; ++i) {
+    logger.log(ILogger::Level::Info, "info");
+  }
+  logger.log(ILogger::Level::Warn, "warn");
+  logger.flush();
+
+  const auto texts = sink.texts();
+  const auto infos = std::count(texts.begin(), texts.end(), "info");
+  EXPECT_GE(infos, 10);
+  EXPECT_LE(infos, 11);
+  EXPECT_EQ(std::count(texts.begin(), texts.end(), "warn"), 1);
+  EXPECT_EQ(logger.dropped(), static_cast<std::uint64_t>(100 - infos));
+}
+
+TEST(AsyncLoggerTest, FullRingDropsInfoAndReportsIt) {
+  RecordingSink sink;
+  sink.blocked = true;
+  AsyncLogger logger(4, sink.sink());
+  for (int i = 0; i < 100; ++i) {
+    logger.log(ILogger::Level::Info, "info");
+  }
+  EXPECT_GT(logger.dropped(), 0u);
+  sink.release();
+  logger.flush();
+
+  // The drop report is written once the ring is empty.
+  std::vector<std::string> texts;
+  for (int attempt = 0; attempt < 1000; ++attempt) {
+    texts = sink.texts();
+    if (!texts.empty() && texts.back().find("dropped") != std::string::npos) {
+      break;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  ASSERT_FALSE(texts.empty());
+  EXPECT_NE(texts.back().find(std::to_string(logger.dropped()) + " messages dropped"),
+            std::string::npos);
+  EXPECT_EQ(texts.size() - 1 + logger.dropped(), 100u);
+}
+
+TEST(AsyncLoggerTest, MessagesAfterStopAreWrittenByTheCaller) {
+  RecordingSink sink;
+  AsyncLogger logger(16, sink.sink());
+  logger.log(ILogger::Level::Info, "before");
+  logger.stop();
+  logger.log(ILogger::Level::Info, "after");
+  logger.log(ILogger::Level::Warn, "warning");
+  logger.flush();
+
+  EXPECT_EQ(sink.texts(), (std::vector<std::string>{"before", "after", "warning"}));
+}
+
+TEST(AsyncLoggerTest, IdleWriterWakesForNewMessages) {
+  RecordingSink sink;
+  AsyncLogger logger(16, sink.sink());
+  for (int i = 0; i < 20; ++i) {
+    // Let the writer fall asleep between messages.
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    logger.log(ILogger::Level::Info, "message " + std::to_string(i));
+    logger.flush();
+    ASSERT_EQ(sink.texts().size(), static_cast<std::size_t>(i + 1));
+  }
+}
+
+TEST(AsyncLoggerTest, LogLineFormatsOnlyEnabledLevels) {
+  RecordingSink sink;
+  AsyncLogger logger(16, sink.sink());
+  logger.setLevel(ILogger::Level::Info);
+  LogLine(ILogger::Level::Debug, logger) << "value " << 1;
+  LogLine(ILogger::Level::Info, logger) << "value " << 42;
+  logger.flush();
+
+  EXPECT_EQ(sink.texts(), (std::vector<std::string>{"value 42"}));
+}
+
+TEST(AsyncLoggerTest, ParseLevel) {
+  EXPECT_EQ(AsyncLogger::parseLevel("trace"), ILogger::Level::Trace);
+  EXPECT_EQ(AsyncLogger::parseLevel("DEBUG"), ILogger::Level::Debug);
+  EXPECT_EQ(AsyncLogger::parseLevel("Info"), ILogger::Level::Info);
+  EXPECT_EQ(AsyncLogger::parseLevel("warning"), ILogger::Level::Warn);
+  EXPECT_EQ(AsyncLogger::parseLevel("error"), ILogger::Level::Error);
+  EXPECT_THROW(AsyncLogger::parseLevel("verbose"), std::invalid_argument);
+}
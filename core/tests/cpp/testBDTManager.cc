@@ -149,6 +149,59 @@ TEST_F(BDTManagerTest, ApplyBDT_Valid) {
   EXPECT_NEAR(result->at(1), sigmoid(0.9f + 0.5f), 1e-6);
 }
 
+/**
+ * @brief Test that block evaluation reproduces per-event BDT scores
+ *
+ * The two block BDTs are scored in one batch, including for the shifted
+ * variation of feature1.
+ */
+TEST_F(BDTManagerTest, ApplyAllBDTs_BlockEvaluationMatchesPerEvent) {
+  configManager->set("bdtConfig", "cfg/bdts_block.txt");
+  BDTManager blockManager(*configManager);
+  EXPECT_EQ(blockManager.getBlockSize("block_bdt"), 4u);
+  EXPECT_EQ(blockManager.getBlockSize("block_bdt_all"), 8u);
+  EXPECT_EQ(blockManager.getBlockSize("event_bdt"), 0u);
+
+  for (const bool mt : {false, true}) {
+    if (mt) {
+      ROOT::EnableImplicitMT(2);
+    }
+    {
+      SystematicManager systematics;
+      systematics.registerSystematic("shift", {"feature1"});
+      DataManager blockData(64);
+      ManagerContext ctx{*configManager, blockData, systematics, *logger, *skimSink, *metaSink};
+      blockManager.setContext(ctx);
+
+      blockData.Define("feature1", [](ULong64_t i) -> float { return static_cast<float>(i % 2); }, {"rdfentry_"}, systematics);
+      blockData.Define("feature1_shiftUp", [](ULong64_t i) -> float { return static_cast<float>((i + 1) % 2); }, {"rdfentry_"}, systematics);
+      blockData.Define("feature1_shiftDown", [](ULong64_t i) -> float { return static_cast<float>(i % 2); }, {"rdfentry_"}, systematics);
+      blockData.Define("feature2", [](ULong64_t) -> float { return 2.0f; }, {"rdfentry_"}, systematics);
+      blockData.Define("feature3", [](ULong64_t) -> float { return 3.0f; }, {"rdfentry_"}, systematics);
+      blockData.Define("run_number", [](ULong64_t i) -> bool { return i % 3 != 0; }, {"rdfentry_"}, systematics);
+      blockData.Define("run_number2", [](ULong64_t) -> bool { return true; }, {"rdfentry_"}, systematics);
+      blockManager.applyAllBDTs();
+
+      auto df = blockData.getDataFrame();
+      auto absDiff = [](float a, float b) { return std::abs(a - b); };
+      auto nominal = df.Define("diffNominal", absDiff, {"block_bdt", "event_bdt"}).Max<float>("diffNominal");
+      auto shifted = df.Define("diffShift", absDiff, {"block_bdt_shiftUp", "event_bdt_shiftUp"}).Max<float>("diffShift");
+      auto disabled = df.Filter([](ULong64_t i) { return i % 3 == 0; }, {"rdfentry_"}).Max<float>("block_bdt");
+      auto all = df.Take<float>("block_bdt_all");
+      auto sigmoid = [](float x) { return 1.0f / (1.0f + std::exp(-x)); };
+      EXPECT_LT(*nominal, 1e-6f);
+      EXPECT_LT(*shifted, 1e-6f);
+      EXPECT_FLOAT_EQ(*disabled, -1.0f);
+      ASSERT_EQ(all->size(), 64u);
+      EXPECT_NEAR(all->at(0), sigmoid(0.1f + 0.5f), 1e-6);
+      EXPECT_NEAR(all->at(1), sigmoid(0.9f + 0.5f), 1e-6);
+    }
+    if (mt) {
+      ROOT::DisableImplicitMT();
+    }
+  }
+}
+
 // Const correctness
 TEST_F(BDTManagerTest, ConstCorrectness) {
   const BDTManager* constManager = bdtManager.get();
@@ -0,0 +1,71 @@
+/**
+ * @file testBlockKernel.cc
+ * @brief Unit tests for BlockKernel – defining columns from kernels that
+ *        process blocks of events.
+ */
+
+#include <gtest/gtest.h>
+
+#include <BlockKernel.h>
+
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+ROOT::RDF::RNode makeFrame() {
+  ROOT::RDF::RNode df = ROOT::RDataFrame(10);
+  return df.Define("x", [](ULong64_t entry) { return static_cast<float>(entry); }, {"rdfentry_"})
+      .Define("v", [](ULong64_t entry) { return ROOT::VecOps::RVec<double>(entry % 3, 0.5); },
+              {"rdfentry_"});
+}
+
+std::vector<std::int64_t> blockSizes;
+
+/// x + sum(v), recording the size of each block.
+void sumKernel(std::int64_t n, const double *const *inputs, const std::int64_t *const *offsets,
+               double *output) {
+  blockSizes.push_back(n);
+  EXPECT_EQ(offsets[0], nullptr);
+  for (std::int64_t i = 0; i < n; ++i) {
+    double sum = inputs[0][i];
+    for (std::int64_t j = offsets[1][i]; j < offsets[1][i + 1]; ++j) {
+      sum += inputs[1][j];
+    }
+    output[i] = sum;
+  }
+}
+
+} // namespace
+
+TEST(BlockKernelTest, CallsTheKernelOncePerBlock) {
+  blockSizes.clear();
+  auto df = BlockKernel::define(makeFrame().Filter([](float x) { return x >= 2.f; }, {"x"}), "y",
+                                &sumKernel, {"x", "v"}, 3);
+  EXPECT_EQ(blockSizes, (std::vector<std::int64_t>{3, 3, 2}));
+
+  auto y = df.Take<double>("y");
+  auto x = df.Take<float>("x");
+  ASSERT_EQ(y->size(), 8u);
+  for (std::size_t i = 0; i < y->size(); ++i) {
+    EXPECT_DOUBLE_EQ((*y)[i], (*x)[i] + 0.5 * (static_cast<int>((*x)[i]) % 3));
+  }
+  // Only the block pass calls the kernel.
+  EXPECT_EQ(blockSizes.size(), 3u);
+}
+
+TEST(BlockKernelTest, ConvertsTheOutputType) {
+  auto df = BlockKernel::define(makeFrame(), "big", &sumKernel, {"x", "v"}, 4, "bool");
+  EXPECT_EQ(df.GetColumnType("big"), "bool");
+  EXPECT_EQ(*df.Filter([](bool big) { return big; }, {"big"}).Count(), 9u);
+  EXPECT_THROW(BlockKernel::define(makeFrame(), "s", &sumKernel, {"x", "v"}, 4, "string"),
+               std::runtime_error);
+
+  const auto results = BlockKernel::evaluate(makeFrame().Filter([](float x) { return x < 5.f; },
+                                                                {"x"}),
+                                             &sumKernel, {"x", "v"}, 4);
+  ASSERT_EQ(results->size(), 5u);
+  EXPECT_DOUBLE_EQ((*results)[4], 4.5);
+}
@@ -0,0 +1,196 @@
+/**
+ * @file testCheckpointService.cc
+ * @brief Unit tests for CheckpointService – entry-range bookkeeping, payload
+ *        merging, and writing and resuming a checkpoint.
+ */
+
+#include <gtest/gtest.h>
+
+#include <CheckpointService.h>
+#include <ConfigurationManager.h>
+#include <DataManager.h>
+#include <DefaultLogger.h>
+#include <EntryRangeSet.h>
+#include <NullOutputSink.h>
+#include <SystematicManager.h>
+
+#include <TFile.h>
+#include <THnSparse.h>
+#include <TObjString.h>
+#include <TVectorD.h>
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+const std::string kConfigPath =
+    std::string(TEST_SOURCE_DIR) + "/aux/test_checkpoint_config.txt";
+const std::string kCheckpointPath =
+    std::string(TEST_SOURCE_DIR) + "/aux/test_checkpoint.root";
+
+void writeConfig(ULong64_t every) {
+  std::ofstream out(kConfigPath);
+  out << "checkpointFile=" << kCheckpointPath << "\n";
+  out << "checkpointEvery=" << every << "\n";
+}
+
+std::unique_ptr<TObject> encodeCount(ULong64_t &count) {
+  auto payload = std::make_unique<TVectorD>(1);
+  (*payload)[0] = static_cast<double>(count);
+  return payload;
+}
+
+/// Core dependencies of one run on an in-memory dataframe.
+struct Run {
+  explicit Run(ULong64_t nEntries) : config(kConfigPath), data(nEntries) {}
+
+  ConfigurationManager config;
+  DataManager data;
+  SystematicManager systematics;
+  DefaultLogger logger;
+  NullOutputSink skimSink;
+  NullOutputSink metaSink;
+  ManagerContext ctx{config, data, systematics, logger, skimSink, metaSink};
+};
+
+class CheckpointServiceTest : public ::testing::Test {
+protected:
+  void SetUp() override { TearDown(); }
+  void TearDown() override {
+    std::remove(kConfigPath.c_str());
+    std::remove(kCheckpointPath.c_str());
+  }
+};
+
+} // namespace
+
+TEST(EntryRangeSetTest, CoalescesAdjacentAndOverlappingRanges) {
+  EntryRangeSet set;
+  for (ULong64_t entry = 0; entry < 10; ++entry) {
+    set.add(entry);
+  }
+  set.add(20, 30);
+  set.add(15, 21);
+  set.add(10);
+  ASSERT_EQ(set.ranges().size(), 2u);
+  EXPECT_EQ(set.ranges()[0], EntryRangeSet::Range(0, 11));
+  EXPECT_EQ(set.ranges()[1], EntryRangeSet::Range(15, 30));
+  EXPECT_EQ(set.size(), 26u);
+  EXPECT_TRUE(set.contains(10));
+  EXPECT_FALSE(set.contains(11));
+  EXPECT_TRUE(set.contains(29));
+  EXPECT_FALSE(set.contains(30));
+}
+
+TEST(EntryRangeSetTest, TextFormRoundTrips) {
+  EntryRangeSet set;
+  set.add(0, 1000);
+  set.add(2000, 2500);
+  EXPECT_EQ(set.toString(), "0-1000,2000-2500");
+  EXPECT_EQ(EntryRangeSet::fromString(set.toString()).ranges(), set.ranges());
+  EXPECT_TRUE(EntryRangeSet::fromString("").empty());
+  EXPECT_THROW(EntryRangeSet::fromString("0-10,abc"), std::runtime_error);
+  EXPECT_THROW(EntryRangeSet::fromString("5"), std::runtime_error);
+}
+
+TEST(CheckpointServiceMergeTest, AddsHistogramsAndVectors) {
+  const Int_t nbins[1] = {4};
+  const Double_t xmin[1] = {0.0};
+  const Double_t xmax[1] = {4.0};
+  THnSparseF into("into", "", 1, nbins, xmin, xmax);
+  THnSparseF from("from", "", 1, nbins, xmin, xmax);
+  const Double_t x[1] = {1.5};
+  into.Fill(x, 2.0);
+  from.Fill(x, 3.0);
+  CheckpointService::mergePayload(into, from);
+  const Int_t bin[1] = {2};
+  EXPECT_DOUBLE_EQ(into.GetBinContent(bin), 5.0);
+
+  TVectorD sum(2);
+  TVectorD part(2);
+  part[1] = 4.0;
+  CheckpointService::mergePayload(sum, part);
+  EXPECT_DOUBLE_EQ(sum[1], 4.0);
+
+  TVectorD shorter(1);
+  EXPECT_THROW(CheckpointService::mergePayload(sum, shorter), std::runtime_error);
+  EXPECT_THROW(CheckpointService::mergePayload(into, sum), std::runtime_error);
+}
+
+TEST_F(CheckpointServiceTest, ReadsProcessedEntriesOnlyFromCheckpoints) {
+  EXPECT_TRUE(CheckpointService::readProcessedEntries(kCheckpointPath).empty());
+  {
+    TFile file(kCheckpointPath.c_str(), "RECREATE");
+    TVectorD unrelated(1);
+    file.WriteTObject(&unrelated, "unrelated");
+  }
+  EXPECT_THROW(CheckpointService::readProcessedEntries(kCheckpointPath),
+               std::runtime_error);
+}
+
+TEST_F(CheckpointServiceTest, ResumedRunSkipsCheckpointedEntries) {
+  writeConfig(30);
+
+  // First run: snapshots after 30, 60 and 90 entries.  The service is not
+  // finalized, as if the job had been preempted after the loop.
+  {
+    Run run(100);
+    CheckpointService service;
+    service.initialize(run.ctx);
+    EXPECT_FALSE(service.resuming());
+    auto count = run.data.getDataFrame().Count();
+    service.watch("count", count, encodeCount);
+    service.arm();
+    EXPECT_EQ(*count, 100u);
+    service.writeCheckpoint();
+  }
+  const EntryRangeSet processed =
+      CheckpointService::readProcessedEntries(kCheckpointPath);
+  EXPECT_EQ(processed.toString(), "0-90");
+
+  // Second run: only the last 10 entries are processed, and the restored
+  // count covers the others.
+  Run run(100);
+  run.data.skipEntries(processed);
+  CheckpointService service;
+  service.initialize(run.ctx);
+  ASSERT_TRUE(service.resuming());
+  EXPECT_EQ(service.resumedEntries().size(), 90u);
+  const auto *restored = dynamic_cast<const TVectorD *>(service.restored("count"));
+  ASSERT_NE(restored, nullptr);
+  EXPECT_DOUBLE_EQ((*restored)[0], 90.0);
+
+  auto count = run.data.getDataFrame().Count();
+  service.watch("count", count, encodeCount);
+  service.arm();
+  EXPECT_EQ(*count, 10u);
+
+  // A complete run removes the checkpoint.
+  auto df = run.data.getDataFrame();
+  service.finalize(df);
+  EXPECT_FALSE(std::filesystem::exists(kCheckpointPath));
+}
+
+TEST_F(CheckpointServiceTest, RejectsCheckpointOfOtherResults) {
+  writeConfig(10);
+  {
+    TFile file(kCheckpointPath.c_str(), "RECREATE");
+    TObjString entries("0-5");
+    file.WriteTObject(&entries, CheckpointService::kEntriesKey);
+    TVectorD orphan(1);
+    file.WriteTObject(&orphan, "orphan");
+  }
+
+  Run run(10);
+  CheckpointService service;
+  service.initialize(run.ctx);
+  auto count = run.data.getDataFrame().Count();
+  service.watch("count", count, encodeCount);
+  EXPECT_THROW(service.watch("count", count, encodeCount), std::runtime_error);
+  EXPECT_THROW(service.arm(), std::runtime_error);
+}
@@ -0,0 +1,74 @@
+/**
+ * @file testColumnChunker.cc
+ * @brief Unit tests for ColumnChunker – collecting scalar columns of the
+ *        event loop into typed, row-aligned chunks.
+ */
+
+#include <gtest/gtest.h>
+
+#include <ColumnChunker.h>
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+ROOT::RDF::RNode makeFrame() {
+  ROOT::RDF::RNode df = ROOT::RDataFrame(10);
+  return df.Define("x", [](ULong64_t entry) { return static_cast<float>(entry); }, {"rdfentry_"})
+      .Define("n", [](ULong64_t entry) { return static_cast<int>(2 * entry); }, {"rdfentry_"})
+      .Define("odd", [](ULong64_t entry) { return entry % 2 == 1; }, {"rdfentry_"})
+      .Define("v", [](ULong64_t entry) { return ROOT::VecOps::RVec<float>(entry, 1.f); },
+              {"rdfentry_"});
+}
+
+} // namespace
+
+TEST(ColumnChunkerTest, DeliversRowAlignedChunks) {
+  std::vector<ColumnChunker::Chunk> chunks;
+  ColumnChunker chunker(makeFrame().Filter([](float x) { return x > 0.f; }, {"x"}),
+                        {"x", "n", "odd"}, 4,
+                        [&chunks](ColumnChunker::Chunk &&chunk) { chunks.push_back(std::move(chunk)); });
+  EXPECT_TRUE(chunks.empty());
+  EXPECT_EQ(chunker.run(), 9u);
+
+  ASSERT_EQ(chunks.size(), 3u);
+  EXPECT_EQ(chunks[0].rows, 4u);
+  EXPECT_EQ(chunks[2].rows, 1u);
+  EXPECT_EQ(chunks[0].dtypes, (std::vector<std::string>{"float32", "int32", "bool"}));
+
+  const auto &x = std::get<std::vector<float>>(chunks[1].data[0]);
+  const auto &n = std::get<std::vector<std::int32_t>>(chunks[1].data[1]);
+  const auto &odd = std::get<std::vector<std::uint8_t>>(chunks[1].data[2]);
+  ASSERT_EQ(x.size(), 4u);
+  for (std::size_t i = 0; i < x.size(); ++i) {
+    EXPECT_EQ(n[i], static_cast<std::int32_t>(2 * x[i]));
+    EXPECT_EQ(odd[i], static_cast<std::uint8_t>(static_cast<int>(x[i]) % 2));
+  }
+}
+
+TEST(ColumnChunkerTest, FlattensVectorColumnsWithOffsets) {
+  std::vector<ColumnChunker::Chunk> chunks;
+  ColumnChunker chunker(makeFrame(), {"v", "x"}, 5,
+                        [&chunks](ColumnChunker::Chunk &&chunk) { chunks.push_back(std::move(chunk)); });
+  EXPECT_EQ(chunker.run(), 10u);
+  ASSERT_EQ(chunks.size(), 2u);
+  // Rows 5..9 hold 5..9 values.
+  const auto &offsets = chunks[1].offsets[0];
+  EXPECT_EQ(offsets, (std::vector<std::int64_t>{0, 5, 11, 18, 26, 35}));
+  EXPECT_EQ(std::get<std::vector<float>>(chunks[1].data[0]).size(), 35u);
+  EXPECT_TRUE(chunks[1].offsets[1].empty());
+}
+
+TEST(ColumnChunkerTest, RejectsMissingAndNonNumericColumns) {
+  auto noop = [](ColumnChunker::Chunk &&) {};
+  auto df = makeFrame().Define("label", []() { return std::string("a"); });
+  EXPECT_THROW(ColumnChunker(df, {"missing"}, 4, noop), std::runtime_error);
+  EXPECT_THROW(ColumnChunker(df, {"x", "label"}, 4, noop), std::runtime_error);
+  EXPECT_EQ(ColumnChunker::dtypeOf("ULong64_t"), "uint64");
+  EXPECT_EQ(ColumnChunker::dtypeOf("ROOT::VecOps::RVec<Float_t>"), "float32");
+  EXPECT_TRUE(ColumnChunker::isVector("ROOT::VecOps::RVec<float>"));
+  EXPECT_FALSE(ColumnChunker::isVector("float"));
+  EXPECT_EQ(ColumnChunker::dtypeOf("std::string"), "");
+}
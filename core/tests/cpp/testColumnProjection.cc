@@ -7,6 +7,7 @@
 #include <ROOT/RVec.hxx>
 
 #include <string>
+#include <tuple>
 
 namespace {
 
@@ -15,6 +16,12 @@ struct TestClassification {
   bool enabled = false;
 };
 
+struct TestFitResult {
+  double chi2 = 0.0;
+  int ndf = 0;
+  float mass = 0.0f;
+};
+
 using FloatVec = ROOT::VecOps::RVec<Float_t>;
 
 } // namespace
@@ -90,6 +97,39 @@ TEST(ColumnProjection, SizeProjectionCountsCollectionEntries) {
   EXPECT_EQ(counts->at(1), 4);
 }
 
+TEST(ColumnProjection, FusedProjectionPacksAllMembersInOnePass) {
+  ChangeToTestSourceDir();
+
+  Analyzer analyzer("cfg/test_data_config.txt");
+  analyzer.Define("fit", []() { return TestFitResult{3.5, 4, 2.0f}; }, {});
+
+  namespace column = rdfanalysis::column;
+  column::defineFusedProjection<TestFitResult>(
+      analyzer, "fit", "fit_packed",
+      column::memberProjection("fit_chi2", &TestFitResult::chi2),
+      column::memberProjection("fit_ndf", &TestFitResult::ndf),
+      column::projectedColumn<TestFitResult>(
+          "fit_mass2",
+          [](const TestFitResult &fit) { return fit.mass * fit.mass; }));
+
+  auto df = analyzer.getDF();
+  auto chi2 = df.Take<double>("fit_chi2");
+  auto ndf = df.Take<int>("fit_ndf");
+  auto mass2 = df.Take<float>("fit_mass2");
+  auto ndfFromPacked = df.Define("ndf_direct",
+                                 [](const std::tuple<double, int, float> &packed) {
+                                   return std::get<1>(packed);
+                                 },
+                                 {"fit_packed"})
+                           .Take<int>("ndf_direct");
+
+  ASSERT_EQ(chi2->size(), 2UL);
+  EXPECT_DOUBLE_EQ(chi2->at(0), 3.5);
+  EXPECT_EQ(ndf->at(1), 4);
+  EXPECT_FLOAT_EQ(mass2->at(0), 4.0f);
+  EXPECT_EQ(ndfFromPacked->at(0), 4);
+}
+
 int main(int argc, char **argv) {
   ::testing::InitGoogleTest(&argc, argv);
   return RUN_ALL_TESTS();
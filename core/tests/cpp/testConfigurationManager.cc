@@ -15,6 +15,7 @@
 #include <fstream>
 #include <gtest/gtest.h>
 #include <iostream>
+#include <unistd.h>
 
 /**
  * @brief Test fixture for ConfigurationManager tests
@@ -949,4 +950,38 @@ TEST_F(BaseConfigSetup, ImmutabilityAfterSetOperations) {
   auto newMap = config->getConfigMap();
   EXPECT_EQ(newMap.at("testKey"), "testValue");
   EXPECT_EQ(newMap.at("saveFile"), "/home/user/outDir/output.root");
-}
\ No newline at end of file
+}
+
+/**
+ * @brief Test reading a compiled config
+ *
+ * The compiled file answers get() and the parse calls like the sources,
+ * also after the sources it was compiled from are no longer readable.
+ */
+TEST_F(BaseConfigSetup, CompiledConfigMatchesSources) {
+  const auto output = std::filesystem::temp_directory_path() /
+                      ("rdf_compiled_config_" + std::to_string(getpid()) + ".rdfcfg");
+  const CompiledConfig compiled = config->compile(output.string());
+  EXPECT_EQ(compiled.source, "cfg/config.txt");
+  ASSERT_EQ(compiled.multiKeys.count("cfg/bdts.txt"), 1u);
+  // Model files named inside multi-key entries are data, not sub-configs.
+  EXPECT_EQ(compiled.multiKeys.count("aux/test_bdt.txt"), 0u);
+  ASSERT_TRUE(CompiledConfig::isCompiled(output.string()));
+  EXPECT_FALSE(CompiledConfig::isCompiled("cfg/config.txt"));
+
+  // Run from another directory, so that the relative sources do not resolve.
+  const auto cwd = std::filesystem::current_path();
+  std::filesystem::current_path(std::filesystem::temp_directory_path());
+  ConfigurationManager loaded(output.string());
+  EXPECT_EQ(loaded.getConfigMap(), config->getConfigMap());
+  EXPECT_EQ(loaded.get("saveTree"), "Events");
+  const auto bdts = loaded.parseMultiKeyConfig(loaded.get("bdtConfig"), {"file", "name"});
+  const auto floats = loaded.parsePairBasedConfig(loaded.get("floatConfig"));
+  const auto triggers = loaded.parseVectorConfig(loaded.get("triggerConfig"));
+  std::filesystem::current_path(cwd);
+
+  EXPECT_EQ(bdts, config->parseMultiKeyConfig("cfg/bdts.txt", {"file", "name"}));
+  EXPECT_EQ(floats, config->parsePairBasedConfig("cfg/floats.txt"));
+  EXPECT_EQ(triggers, config->parseVectorConfig("cfg/triggers.txt"));
+  std::filesystem::remove(output);
+}
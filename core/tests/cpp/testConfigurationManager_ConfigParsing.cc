@@ -13,6 +13,7 @@
 #include <string>
 #include <vector>
 #include <fstream>
+#include <chrono>
 #include <filesystem>
 
 class BaseConfigSetup : public ::testing::Test {
@@ -210,4 +211,26 @@ TEST_F(BaseConfigSetup, ParsePairBasedConfigPreservesYamlSequenceValues) {
   EXPECT_EQ(map.at("goldenJsonFiles"), "[cfg/24_B_golden.json, cfg/24_C_golden.json]");
 
   std::remove(tempFile.c_str());
-}
\ No newline at end of file
+}
+
+// Parsed sub-configs are reused until the file changes; required keys still
+// filter each call.
+TEST_F(BaseConfigSetup, ParsedConfigsAreReusedUntilTheFileChanges) {
+  std::string tempFile = (std::filesystem::current_path() / "temp_cached.txt").string();
+  std::ofstream(tempFile) << "name=a file=x.json\nname=b\n";
+  EXPECT_EQ(config->parseMultiKeyConfig(tempFile, {"name", "file"}).size(), 1u);
+  EXPECT_EQ(config->parseMultiKeyConfig(tempFile, {"name"}).size(), 2u);
+
+  // Same size, new contents and modification time.
+  std::ofstream(tempFile) << "name=c file=y.json\nname=d\n";
+  std::filesystem::last_write_time(
+      tempFile, std::filesystem::last_write_time(tempFile) + std::chrono::seconds(2));
+  auto entries = config->parseMultiKeyConfig(tempFile, {"name", "file"});
+  ASSERT_EQ(entries.size(), 1u);
+  EXPECT_EQ(entries[0].at("name"), "c");
+
+  // A copy shares the cache and sees the same contents.
+  ConfigurationManager copy = *config;
+  EXPECT_EQ(copy.parseVectorConfig(tempFile).size(), 2u);
+  std::remove(tempFile.c_str());
+}
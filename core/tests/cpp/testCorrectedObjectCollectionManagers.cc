@@ -16,6 +16,10 @@
 
 #include "../plugins/CorrectedObjectCollectionManagers/CorrectedObjectCollectionManagers.h"
 
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+
 namespace {
 
 ManagerContext makeContext(IConfigurationProvider &cfg,
@@ -149,6 +153,94 @@ TEST_F(CorrectedObjectCollectionManagersTest, JetWrapperPropagatesMassVariations
   EXPECT_NE(affected.find("CorrectedJets"), affected.end());
 }
 
+TEST_F(CorrectedObjectCollectionManagersTest, JetWrapperDefinesCrossCleanedCollection) {
+  config->set("correctedJetCollectionConfig", "cfg/test_corrected_jets_cleaned.txt");
+
+  DataManager dm(1);
+  const auto defineJetColumn = [&dm, this](const std::string &name, float first,
+                                           float second) {
+    dm.Define(
+        name,
+        [first, second](ULong64_t) -> ROOT::VecOps::RVec<Float_t> {
+          return {first, second};
+        },
+        {"rdfentry_"}, *systematics);
+  };
+  defineJetColumn("Jet_pt", 100.0f, 60.0f);
+  defineJetColumn("Jet_eta", 1.2f, -1.0f);
+  defineJetColumn("Jet_phi", 0.4f, 2.0f);
+  defineJetColumn("Jet_mass", 20.0f, 10.0f);
+  defineJetColumn("Jet_pt_corr_nominal", 110.0f, 66.0f);
+  defineJetColumn("Jet_mass_corr_nominal", 22.0f, 11.0f);
+  defineJetColumn("Jet_pt_jes_total_up", 120.0f, 72.0f);
+  defineJetColumn("Jet_pt_jes_total_down", 100.0f, 60.0f);
+  dm.Define(
+      "CleaningLeptons",
+      [](ULong64_t) -> PhysicsObjectCollection {
+        return PhysicsObjectCollection(ROOT::VecOps::RVec<Float_t>{30.0f},
+                                       ROOT::VecOps::RVec<Float_t>{1.25f},
+                                       ROOT::VecOps::RVec<Float_t>{0.45f},
+                                       ROOT::VecOps::RVec<Float_t>{0.0f},
+                                       ROOT::VecOps::RVec<bool>{true});
+      },
+      {"rdfentry_"}, *systematics);
+
+  JetEnergyScaleManager jetManager;
+  auto jetContext = context(dm);
+  jetManager.setContext(jetContext);
+  jetManager.setupFromConfigFile();
+  jetManager.setJetColumns("Jet_pt", "Jet_eta", "Jet_phi", "Jet_mass");
+  jetManager.addVariation("jes_total", "Jet_pt_jes_total_up", "Jet_pt_jes_total_down");
+
+  CorrectedJetCollectionManager wrapper(jetManager);
+  wrapper.setContext(jetContext);
+  wrapper.setupFromConfigFile();
+  wrapper.execute();
+
+  auto nominal = dm.getDataFrame().Take<PhysicsObjectCollection>("CleanedJets");
+  auto up = dm.getDataFrame().Take<PhysicsObjectCollection>("CleanedJets_jes_totalUp");
+
+  ASSERT_EQ(nominal.GetValue()[0].size(), 1u);
+  EXPECT_EQ(nominal.GetValue()[0].index(0), 1);
+  EXPECT_NEAR(static_cast<float>(nominal.GetValue()[0].at(0).Pt()), 66.0f, 0.01f);
+  ASSERT_EQ(up.GetValue()[0].size(), 1u);
+  EXPECT_NEAR(static_cast<float>(up.GetValue()[0].at(0).Pt()), 72.0f, 0.01f);
+
+  const auto produced = wrapper.getProducedColumns();
+  EXPECT_NE(std::find(produced.begin(), produced.end(), "CleanedJets"), produced.end());
+  EXPECT_NE(std::find(produced.begin(), produced.end(), "CleanedJets_jes_totalDown"),
+            produced.end());
+  EXPECT_EQ(wrapper.collectProvenanceEntries().at("overlap_reference_collection"),
+            "CleaningLeptons");
+}
+
+TEST_F(CorrectedObjectCollectionManagersTest, JetWrapperRejectsInvalidOverlapDeltaR) {
+  const std::string configFile = "test_corrected_jets_bad_delta_r.txt";
+  for (const std::string deltaR : {"0.4cm", "abc", "-0.4"}) {
+    {
+      std::ifstream in("cfg/test_corrected_jets_cleaned.txt");
+      std::ofstream out(configFile);
+      std::string line;
+      while (std::getline(in, line)) {
+        out << (line.rfind("overlapDeltaR=", 0) == 0 ? "overlapDeltaR=" + deltaR : line)
+            << "\n";
+      }
+    }
+    config->set("correctedJetCollectionConfig", configFile);
+
+    DataManager dm(1);
+    JetEnergyScaleManager jetManager;
+    auto jetContext = context(dm);
+    jetManager.setContext(jetContext);
+    jetManager.setupFromConfigFile();
+
+    CorrectedJetCollectionManager wrapper(jetManager);
+    wrapper.setContext(jetContext);
+    EXPECT_THROW(wrapper.setupFromConfigFile(), std::runtime_error) << deltaR;
+  }
+  std::remove(configFile.c_str());
+}
+
 TEST_F(CorrectedObjectCollectionManagersTest, ElectronWrapperRegistersCollectionSystematics) {
   config->set("correctedElectronCollectionConfig", "cfg/test_corrected_electrons.txt");
 
@@ -11,10 +11,13 @@
 
 #include <ConfigurationManager.h>
 #include <test_util.h>
+#include <CorrectionCompiler.h>
 #include <CorrectionManager.h>
+#include <CorrectionSnapshotCache.h>
 #include <DataManager.h>
 #include <ROOT/RDataFrame.hxx>
 #include <ROOT/RVec.hxx>
+#include <filesystem>
 #include <fstream>
 #include <gtest/gtest.h>
 #include <stdexcept>
@@ -25,6 +28,8 @@
 #include <DefaultLogger.h>
 #include <NullOutputSink.h>
 #include <api/ManagerContext.h>
+#include <ModelRegistry.h>
+#include <cstdio>
 #include <ROOT/TThreadExecutor.hxx>
 #include <ROOT/RDF/RCutFlowReport.hxx>
 #include <ROOT/RDF/RInterface.hxx>
@@ -598,6 +603,134 @@ TEST_F(CorrectionManagerTest, ApplyVectorCorrectionSupportsMixedScalarAndRVecInp
   setContextFor(*dataManager);
 }
 
+/**
+ * @brief Test that block evaluation matches the per-object evaluation path
+ *
+ * Uses the same inputs as ApplyVectorCorrectionBasic plus an empty event and
+ * requests both paths on the same dataframe.
+ */
+TEST_F(CorrectionManagerTest, ApplyVectorCorrectionBlockEvaluationMatchesDefault) {
+  auto testDataManager = std::make_unique<DataManager>(2);
+  setContextFor(*testDataManager);
+
+  testDataManager->Define(
+      "float_arg",
+      [](ULong64_t entry) -> ROOT::VecOps::RVec<double> {
+        if (entry == 0) {
+          return {0.5, 1.5};
+        }
+        return {};
+      },
+      {"rdfentry_"}, *systematicManager);
+  testDataManager->Define(
+      "int_arg",
+      [](ULong64_t entry) -> ROOT::VecOps::RVec<double> {
+        if (entry == 0) {
+          return {1.0, 2.0};
+        }
+        return {};
+      },
+      {"rdfentry_"}, *systematicManager);
+
+  correctionManager->applyCorrectionVec("test_correction", {"A"});
+  correctionManager->applyCorrectionVec("test_correction", {"A"}, {},
+                                        "test_correction_A_block", true);
+  correctionManager->applyCorrectionVec("test_correction", {"B"}, {},
+                                        "test_correction_B_block", true);
+
+  auto df = testDataManager->getDataFrame();
+  auto reference = df.Take<ROOT::VecOps::RVec<Float_t>>("test_correction_A");
+  auto blockA = df.Take<ROOT::VecOps::RVec<Float_t>>("test_correction_A_block");
+  auto blockB = df.Take<ROOT::VecOps::RVec<Float_t>>("test_correction_B_block");
+  ASSERT_EQ(blockA->size(), 2u);
+  ASSERT_EQ((*blockA)[0].size(), 2u);
+  EXPECT_EQ((*blockA)[1].size(), 0u);
+  for (size_t i = 0; i < (*reference)[0].size(); ++i) {
+    EXPECT_FLOAT_EQ((*blockA)[0][i], (*reference)[0][i]);
+  }
+  ASSERT_EQ((*blockB)[0].size(), 2u);
+  EXPECT_NEAR((*blockB)[0][0], 0.5f, 1e-6f);
+  EXPECT_NEAR((*blockB)[0][1], 0.8f, 1e-6f);
+
+  setContextFor(*dataManager);
+}
+
+/**
+ * @brief Test that a bundled evaluation concatenates the argument sets
+ * variation-major
+ *
+ * Same inputs as ApplyVectorCorrectionBlockEvaluationMatchesDefault; the
+ * bundle holds the "A" block followed by the "B" block.
+ */
+TEST_F(CorrectionManagerTest, ApplyVectorCorrectionBundleIsVariationMajor) {
+  auto testDataManager = std::make_unique<DataManager>(2);
+  setContextFor(*testDataManager);
+
+  testDataManager->Define(
+      "float_arg",
+      [](ULong64_t entry) -> ROOT::VecOps::RVec<double> {
+        if (entry == 0) {
+          return {0.5, 1.5};
+        }
+        return {};
+      },
+      {"rdfentry_"}, *systematicManager);
+  testDataManager->Define(
+      "int_arg",
+      [](ULong64_t entry) -> ROOT::VecOps::RVec<double> {
+        if (entry == 0) {
+          return {1.0, 2.0};
+        }
+        return {};
+      },
+      {"rdfentry_"}, *systematicManager);
+
+  correctionManager->applyCorrectionVecBundle("test_correction", {{"A"}, {"B"}},
+                                              {}, "test_correction_bundle");
+
+  auto df = testDataManager->getDataFrame();
+  auto bundle = df.Take<ROOT::VecOps::RVec<Float_t>>("test_correction_bundle");
+  ASSERT_EQ(bundle->size(), 2u);
+  ASSERT_EQ((*bundle)[0].size(), 4u);
+  EXPECT_NEAR((*bundle)[0][0], 0.1f, 1e-6f);
+  EXPECT_NEAR((*bundle)[0][1], 0.4f, 1e-6f);
+  EXPECT_NEAR((*bundle)[0][2], 0.5f, 1e-6f);
+  EXPECT_NEAR((*bundle)[0][3], 0.8f, 1e-6f);
+  EXPECT_EQ((*bundle)[1].size(), 0u);
+
+  EXPECT_THROW(correctionManager->applyCorrectionVecBundle(
+                   "test_correction", {}, {}, "test_correction_empty"),
+               std::runtime_error);
+
+  setContextFor(*dataManager);
+}
+
+/**
+ * @brief Test that block evaluation rejects a missing string argument
+ */
+TEST_F(CorrectionManagerTest, ApplyVectorCorrectionBlockEvaluationThrowsForMissingStringArg) {
+  auto testDataManager = std::make_unique<DataManager>(1);
+  setContextFor(*testDataManager);
+
+  testDataManager->Define(
+      "float_arg",
+      []() -> ROOT::VecOps::RVec<double> { return {0.5}; }, {},
+      *systematicManager);
+  testDataManager->Define(
+      "int_arg",
+      []() -> ROOT::VecOps::RVec<double> { return {1.0}; }, {},
+      *systematicManager);
+
+  EXPECT_THROW(
+      {
+        correctionManager->applyCorrectionVec("test_correction", {}, {},
+                                              "test_correction_block", true);
+      },
+      std::runtime_error);
+
+  setContextFor(*dataManager);
+}
+
 int main(int argc, char **argv) {
   ::testing::InitGoogleTest(&argc, argv);
   return RUN_ALL_TESTS();
@@ -745,6 +878,203 @@ TEST_F(CorrectionManagerTest, RegisterCorrection_ProgrammaticCppRegistration) {
   EXPECT_NEAR(result->at(1), 0.4f, 1e-6f);
 }
 
+/**
+ * @brief Managers sharing a ModelRegistry parse a correction file once; a
+ * copy under another path is shared, a file with new contents is reloaded.
+ */
+TEST_F(CorrectionManagerTest, RegisterCorrection_SharesParsedCorrectionSet) {
+  ModelRegistry registry;
+  ManagerContext ctx{*configManager, *dataManager, *systematicManager, *logger, *skimSink,
+                     *metaSink, &registry};
+  CorrectionManager other(*configManager);
+  correctionManager->setContext(ctx);
+  other.setContext(ctx);
+
+  correctionManager->registerCorrection("first", "aux/correction.json", "test_correction",
+                                        {"float_arg", "int_arg"});
+  other.registerCorrection("second", "aux/correction.json", "test_correction",
+                           {"float_arg", "int_arg"});
+  EXPECT_EQ(registry.loads(), 1u);
+  EXPECT_EQ(registry.hits(), 1u);
+
+  const std::string copy = "registry_copy_" + std::to_string(getpid()) + ".json";
+  {
+    std::ifstream src("aux/correction.json", std::ios::binary);
+    std::ofstream dst(copy, std::ios::binary);
+    dst << src.rdbuf();
+  }
+  other.registerCorrection("third", copy, "test_correction", {"float_arg", "int_arg"});
+  EXPECT_EQ(registry.loads(), 1u);
+  EXPECT_EQ(registry.hits(), 2u);
+
+  std::ofstream(copy, std::ios::app) << "\n";
+  other.registerCorrection("fourth", copy, "test_correction", {"float_arg", "int_arg"});
+  EXPECT_EQ(registry.loads(), 2u);
+  std::remove(copy.c_str());
+}
+
+/**
+ * @brief Only the registered corrections of a file are parsed, and each load
+ * is reported with its resident memory.
+ */
+TEST_F(CorrectionManagerTest, RegisterCorrection_ParsesOnlyRequestedCorrections) {
+  ModelRegistry registry;
+  ManagerContext ctx{*configManager, *dataManager, *systematicManager, *logger, *skimSink,
+                     *metaSink, &registry};
+  correctionManager->setContext(ctx);
+  correctionManager->registerCorrection("selected", "aux/correction.json", "test_correction",
+                                        {"float_arg", "int_arg"});
+
+  auto parsed = registry.get<correction::CorrectionSet>(
+      "aux/correction.json", "selected;test_correction",
+      []() -> std::unique_ptr<correction::CorrectionSet> {
+        throw std::runtime_error("the selected set was not shared");
+      });
+  EXPECT_EQ(parsed->size(), 1u);
+  EXPECT_EQ(registry.loads(), 1u);
+
+  const auto &loaded = correctionManager->loadedCorrections();
+  ASSERT_FALSE(loaded.empty());
+  EXPECT_EQ(loaded.back().file, "aux/correction.json");
+  EXPECT_EQ(loaded.back().corrections, std::vector<std::string>{"test_correction"});
+  EXPECT_GE(loaded.back().residentMB, 0.0);
+  EXPECT_EQ(correctionManager->collectProvenanceEntries().count("resident_mb.aux/correction.json"),
+            1u);
+
+  EXPECT_THROW(correctionManager->registerCorrection("missing", "aux/correction.json",
+                                                     "no_such_correction", {"float_arg"}),
+               std::runtime_error);
+}
+
+/**
+ * @brief Compiled corrections agree with correctionlib, directly and as
+ * correction columns.
+ */
+TEST_F(CorrectionManagerTest, CompiledCorrectionsMatchCorrectionlib) {
+  correctionManager->setCompileCorrections(true);
+  correctionManager->registerCorrection("compiled_sf", "aux/correction.json", "test_correction",
+                                        {"float_arg", "int_arg"});
+  correctionManager->registerCorrection("compiled_binned", "aux/correction.json",
+                                        "test_correction2", {"float_arg", "int_arg"});
+  correctionManager->registerCorrection("compiled_btag", "aux/btag_fixedwp.json",
+                                        "btag_fixedwp", {"int_arg", "float_arg"});
+
+  const auto compiled = correctionManager->getCompiledCorrection("compiled_sf");
+  ASSERT_NE(compiled, nullptr);
+  EXPECT_EQ(correctionManager->getCompiledCorrection("compiled_sf"), compiled);
+  const auto reference = correctionManager->getCorrection("compiled_sf");
+  for (const double x : {-1.0, 0.0, 0.5, 1.0, 1.5, 3.0}) {
+    for (const int i : {0, 1, 2, 3}) {
+      for (const std::string s : {"A", "B"}) {
+        std::vector<correction::Variable::Type> args{x, i, s};
+        EXPECT_DOUBLE_EQ(compiled->evaluate(args), reference->evaluate(args));
+      }
+    }
+  }
+
+  const auto binned = correctionManager->getCompiledCorrection("compiled_binned");
+  ASSERT_NE(binned, nullptr);
+  for (const double x : {-10.0, 0.0, 1.0, 2.0, 3.99, 4.0, 10.0}) {
+    for (const int i : {0, 1, 2}) {
+      std::vector<correction::Variable::Type> args{x, i};
+      EXPECT_DOUBLE_EQ(binned->evaluate(args),
+                       correctionManager->getCorrection("compiled_binned")->evaluate(args));
+    }
+  }
+
+  const auto btag = correctionManager->getCompiledCorrection("compiled_btag");
+  ASSERT_NE(btag, nullptr);
+  for (const std::string systematic : {"central", "up"}) {
+    for (const std::string wp : {"L", "M"}) {
+      for (const int flavor : {0, 4, 5}) {
+        std::vector<correction::Variable::Type> args{systematic, wp, flavor, 60.0};
+        EXPECT_DOUBLE_EQ(btag->evaluate(args),
+                         correctionManager->getCorrection("compiled_btag")->evaluate(args));
+      }
+    }
+  }
+  std::vector<correction::Variable::Type> unknown{std::string("central"), std::string("T"), 5,
+                                                  60.0};
+  EXPECT_THROW(btag->evaluate(unknown), std::runtime_error);
+
+  dataManager->Define("float_arg",
+                      [](ULong64_t i) -> double { return i == 0 ? 0.5 : 1.5; },
+                      {"rdfentry_"}, *systematicManager);
+  dataManager->Define("int_arg",
+                      [](ULong64_t i) -> double { return i == 0 ? 1 : 2; },
+                      {"rdfentry_"}, *systematicManager);
+  correctionManager->applyCorrection("compiled_sf", {"A"});
+  auto result = dataManager->getDataFrame().Take<float>("compiled_sf_A");
+  ASSERT_EQ(result->size(), 2u);
+  EXPECT_NEAR(result->at(0), 0.1f, 1e-6f);
+  EXPECT_NEAR(result->at(1), 0.4f, 1e-6f);
+
+  // Corrections registered before compilation was enabled stay interpreted.
+  EXPECT_EQ(correctionManager->getCompiledCorrection("test_correction"), nullptr);
+  EXPECT_THROW(CorrectionCompiler::generate(
+                   CorrectionSnapshotCache::readJson("aux/correction.json"), "missing"),
+               std::runtime_error);
+}
+
+/**
+ * @brief A compiled correction with only string inputs has no numeric
+ * features and is evaluated once per event.
+ */
+TEST_F(CorrectionManagerTest, CompiledStringOnlyCorrectionAppliesPerEvent) {
+  const auto path = std::filesystem::temp_directory_path() / "string_only_correction.json";
+  {
+    std::ofstream out(path);
+    out << R"({"schema_version": 2, "corrections": [{
+      "name": "string_only", "version": 1,
+      "inputs": [{"name": "systematic", "type": "string"}],
+      "output": {"name": "sf", "type": "real"},
+      "data": {"nodetype": "category", "input": "systematic",
+               "content": [{"key": "A", "value": 1.5}, {"key": "B", "value": 2.5}]}}]})";
+  }
+  correctionManager->setCompileCorrections(true);
+  correctionManager->registerCorrection("string_only_sf", path.string(), "string_only", {});
+  ASSERT_NE(correctionManager->getCompiledCorrection("string_only_sf"), nullptr);
+
+  correctionManager->applyCorrection("string_only_sf", {"B"});
+  auto result = dataManager->getDataFrame().Take<float>("string_only_sf_B");
+  ASSERT_EQ(result->size(), 2u);
+  EXPECT_FLOAT_EQ(result->at(0), 2.5f);
+  EXPECT_FLOAT_EQ(result->at(1), 2.5f);
+  std::filesystem::remove(path);
+}
+
+/**
+ * @brief A correction snapshot keeps the requested corrections and those
+ * stacked by requested compound corrections, and is written only once.
+ */
+TEST(CorrectionSnapshotCacheTest, SnapshotKeepsRequestedCorrections) {
+  ChangeToTestSourceDir();
+  const std::string dir = "correction_snapshots_" + std::to_string(getpid());
+  const CorrectionSnapshotCache cache(dir);
+  const std::string digest = ModelRegistry::instance().contentHash("aux/correction.json");
+  ASSERT_FALSE(digest.empty());
+
+  const std::string path = cache.snapshot("aux/correction.json", digest, {"test_correction"});
+  auto pruned = CorrectionSnapshotCache::load(path);
+  auto full = correction::CorrectionSet::from_file("aux/correction.json");
+  ASSERT_EQ(pruned->size(), 1u);
+  EXPECT_DOUBLE_EQ(pruned->at("test_correction")->evaluate({0.5, 1, std::string("A")}),
+                   full->at("test_correction")->evaluate({0.5, 1, std::string("A")}));
+  EXPECT_EQ(cache.snapshot("aux/correction.json", digest, {"test_correction"}), path);
+  EXPECT_NE(cache.snapshot("aux/correction.json", digest, {}), path);
+
+  const std::string jerc = "aux/mock_jet_jerc.json";
+  const std::string jercDigest = ModelRegistry::instance().contentHash(jerc);
+  auto compound = CorrectionSnapshotCache::load(cache.snapshot(
+      jerc, jercDigest, {"Summer22_22Sep2023_V3_MC_L1L2L3Res_AK4PFPuppi"}));
+  EXPECT_EQ(compound->size(), 3u);
+  EXPECT_EQ(compound->compound().size(), 1u);
+
+  EXPECT_THROW(cache.snapshot("aux/correction.json", digest, {"no_such_correction"}),
+               std::runtime_error);
+  std::filesystem::remove_all(dir);
+}
+
 /**
  * @brief Test programmatic registration combined with explicit input/output branches.
  *
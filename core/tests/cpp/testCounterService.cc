@@ -5,16 +5,20 @@
 #include <DataManager.h>
 #include <DefaultLogger.h>
 #include <NullOutputSink.h>
+#include <OutputMerger.h>
 #include <RootOutputSink.h>
 #include <SystematicManager.h>
 
 #include <TFile.h>
 #include <TH1D.h>
+#include <TTree.h>
 #include <RtypesCore.h>
 
+#include <cmath>
 #include <cstdio>
 #include <fstream>
 #include <string>
+#include <vector>
 
 namespace {
 std::string writeConfig(const std::string& path, const std::string& metaFile) {
@@ -88,6 +92,159 @@ TEST(CounterServiceTest, UsesPreFilterDataFrameForIntWeightHistogram) {
   std::remove(metaPath.c_str());
 }
 
+TEST(CounterServiceTest, WritesWeightSumsAndSignHistogramFromOneAction) {
+  const std::string cfgPath = std::string(TEST_SOURCE_DIR) + "/aux/test_counter_sums_config.txt";
+  const std::string metaPath = std::string(TEST_SOURCE_DIR) + "/aux/test_counter_sums_meta.root";
+
+  std::remove(cfgPath.c_str());
+  std::remove(metaPath.c_str());
+
+  writeConfig(cfgPath, metaPath);
+  ConfigurationManager config(cfgPath);
+
+  DataManager dataManager(6);
+  SystematicManager systematicManager;
+  DefaultLogger logger;
+  NullOutputSink skimSink;
+  RootOutputSink metaSink;
+
+  // intCode exists at initialize(), so the histogram shares the counters action
+  dataManager.Define("intCode",
+                     [](ULong64_t entry) { return static_cast<Int_t>(entry % 3); },
+                     {"rdfentry_"},
+                     systematicManager);
+  dataManager.Define("genWeight",
+                     [](ULong64_t entry) { return (entry % 2 == 0) ? 1.0f : -2.0f; },
+                     {"rdfentry_"},
+                     systematicManager);
+
+  ManagerContext ctx{config, dataManager, systematicManager, logger, skimSink, metaSink};
+  CounterService service;
+  service.initialize(ctx);
+
+  auto df = dataManager.getDataFrame();
+  service.onPreFilter(df);
+  service.finalize(df);
+
+  TFile file(metaPath.c_str(), "READ");
+  ASSERT_FALSE(file.IsZombie());
+
+  auto* weightSum = dynamic_cast<TH1D*>(file.Get("counter_weightSum_TestSample"));
+  ASSERT_NE(weightSum, nullptr);
+  EXPECT_DOUBLE_EQ(weightSum->GetBinContent(1), -3.0);
+  EXPECT_DOUBLE_EQ(weightSum->GetBinError(1), std::sqrt(15.0));
+
+  auto* signSum = dynamic_cast<TH1D*>(file.Get("counter_weightSignSum_TestSample"));
+  ASSERT_NE(signSum, nullptr);
+  EXPECT_DOUBLE_EQ(signSum->GetBinContent(1), 0.0);
+
+  // Codes 0, 1, 2 each get one entry of weight 1 and one of weight -2.
+  auto* intSign = dynamic_cast<TH1D*>(file.Get("counter_intWeightSignSum_TestSample"));
+  ASSERT_NE(intSign, nullptr);
+  auto* intSum = dynamic_cast<TH1D*>(file.Get("counter_intWeightSum_TestSample"));
+  ASSERT_NE(intSum, nullptr);
+  for (const double code : {0.0, 1.0, 2.0}) {
+    EXPECT_DOUBLE_EQ(intSign->GetBinContent(intSign->FindBin(code)), 0.0);
+    EXPECT_DOUBLE_EQ(intSum->GetBinContent(intSum->FindBin(code)), -1.0);
+    EXPECT_DOUBLE_EQ(intSum->GetBinError(intSum->FindBin(code)), std::sqrt(5.0));
+  }
+  EXPECT_DOUBLE_EQ(intSum->GetEntries(), 6.0);
+
+  // An in-memory source reads no files, so there is no per-file breakdown.
+  EXPECT_EQ(file.Get("counter_files_TestSample"), nullptr);
+
+  file.Close();
+
+  std::remove(cfgPath.c_str());
+  std::remove(metaPath.c_str());
+}
+
+TEST(CounterServiceTest, PerFileTotalsSurviveOutputMerge) {
+  const std::string aux = std::string(TEST_SOURCE_DIR) + "/aux/";
+  std::vector<std::string> metaPaths;
+  std::vector<std::string> scratch;
+  for (int job = 0; job < 2; ++job) {
+    const std::string tag = "counter_merge_" + std::to_string(job);
+    const std::string inputPath = aux + tag + "_input.root";
+    const std::string cfgPath = aux + tag + "_cfg.txt";
+    const std::string metaPath = aux + tag + "_meta.root";
+    std::remove(metaPath.c_str());
+    {
+      TFile input(inputPath.c_str(), "RECREATE");
+      TTree tree("Events", "Events");
+      Float_t genWeight = job + 1.0f;
+      tree.Branch("genWeight", &genWeight, "genWeight/F");
+      for (int i = 0; i < 3; ++i) {
+        tree.Fill();
+      }
+      input.Write();
+    }
+    {
+      std::ofstream out(cfgPath);
+      out << "enableCounters=true\n";
+      out << "counterWeightBranch=genWeight\n";
+      out << "metaFile=" << metaPath << "\n";
+      out << "sample=TestSample\n";
+      out << "fileList=" << inputPath << "\n";
+    }
+
+    ConfigurationManager config(cfgPath);
+    DataManager dataManager(config);
+    SystematicManager systematicManager;
+    DefaultLogger logger;
+    NullOutputSink skimSink;
+    RootOutputSink metaSink;
+    ManagerContext ctx{config, dataManager, systematicManager, logger, skimSink, metaSink};
+    CounterService service;
+    service.initialize(ctx);
+    auto df = dataManager.getDataFrame();
+    service.onPreFilter(df);
+    service.finalize(df);
+
+    metaPaths.push_back(metaPath);
+    scratch.insert(scratch.end(), {inputPath, cfgPath, metaPath});
+  }
+
+  const std::string mergedPath = aux + "counter_merge_merged.root";
+  OutputMerger().merge(mergedPath, metaPaths);
+  scratch.push_back(mergedPath);
+
+  {
+    TFile merged(mergedPath.c_str(), "READ");
+    ASSERT_FALSE(merged.IsZombie());
+    auto* weightSum = merged.Get<TH1D>("counter_weightSum_TestSample");
+    ASSERT_NE(weightSum, nullptr);
+    EXPECT_DOUBLE_EQ(weightSum->GetBinContent(1), 9.0);
+
+    // One row per input file of each job.
+    auto* files = merged.Get<TTree>("counter_files_TestSample");
+    ASSERT_NE(files, nullptr);
+    ASSERT_EQ(files->GetEntries(), 2);
+    Double_t sumw = 0.0;
+    ULong64_t entries = 0;
+    files->SetBranchAddress("weightSum", &sumw);
+    files->SetBranchAddress("entries", &entries);
+    double totalSumw = 0.0;
+    for (Long64_t i = 0; i < files->GetEntries(); ++i) {
+      files->GetEntry(i);
+      EXPECT_EQ(entries, 3u);
+      totalSumw += sumw;
+    }
+    EXPECT_DOUBLE_EQ(totalSumw, 9.0);
+  }
+
+  for (const auto& path : scratch) {
+    std::remove(path.c_str());
+  }
+}
+
+TEST(CounterServiceTest, CounterActionStripsTreeFromSampleName) {
+  EXPECT_EQ(CounterAction::fileOf("root://eos.cern.ch//store/a.root/Events"),
+            "root://eos.cern.ch//store/a.root");
+  EXPECT_EQ(CounterAction::fileOf("/data/b.root/dir/Events"), "/data/b.root");
+  EXPECT_EQ(CounterAction::fileOf("/data/c.parquet"), "/data/c.parquet");
+}
+
 // ---------------------------------------------------------------------------
 // collectProvenanceEntries() – returns service runtime settings
 // ---------------------------------------------------------------------------
@@ -3,9 +3,12 @@
  * @brief Unit tests for the CutflowManager plugin.
  *
  * Tests cover: addCut() mechanics, sequential cutflow counts,
- * N-1 counts, empty-cut behaviour, lifecycle hooks, and error handling.
+ * N-1 counts, cut-mask tallies, pattern counts, weighted cutflows,
+ * checkpoint resumption, empty-cut behaviour, lifecycle hooks, and error
+ * handling.
  */
 
+#include <CheckpointService.h>
 #include <ConfigurationManager.h>
 #include <CutflowManager.h>
 #include <DataManager.h>
@@ -14,10 +17,16 @@
 #include <NullOutputSink.h>
 #include <RegionManager.h>
 #include <SystematicManager.h>
+#include <WeightManager.h>
 #include <api/ManagerContext.h>
 #include <gtest/gtest.h>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
 #include <stdexcept>
+#include <string>
 #include <test_util.h>
+#include <vector>
 
 // ---------------------------------------------------------------------------
 // Helpers
@@ -577,6 +586,443 @@ TEST_F(CutflowManagerTest, CollectProvenanceEntriesContainsCuts) {
   EXPECT_NE(cuts.find("pass_pt"), std::string::npos);
 }
 
+// ---------------------------------------------------------------------------
+// CutflowTally: counts derived from cut masks
+// ---------------------------------------------------------------------------
+
+TEST(CutflowTallyTest, DerivedCountsMatchBruteForce) {
+  // Every mask of 4 cuts, mask m filled (m + 1) times.
+  const std::size_t nCuts = 4;
+  CutflowTally tally(nCuts, true);
+  for (std::uint64_t m = 0; m < 16; ++m) {
+    for (std::uint64_t k = 0; k <= m; ++k) tally.fill(m);
+  }
+
+  std::vector<ULong64_t> cumulative(nCuts, 0), nMinusOne(nCuts, 0);
+  ULong64_t total = 0;
+  for (std::uint64_t m = 0; m < 16; ++m) {
+    const ULong64_t weight = m + 1;
+    total += weight;
+    for (std::size_t j = 0; j < nCuts; ++j) {
+      const std::uint64_t prefix = (std::uint64_t{1} << (j + 1)) - 1;
+      if ((m & prefix) == prefix) cumulative[j] += weight;
+      if ((m | (std::uint64_t{1} << j)) == 15) nMinusOne[j] += weight;
+    }
+  }
+
+  EXPECT_EQ(tally.total, total);
+  EXPECT_EQ(tally.cumulativeCounts(), cumulative);
+  EXPECT_EQ(tally.nMinusOneCounts(), nMinusOne);
+  ASSERT_EQ(tally.patterns.size(), 16u);
+  for (std::uint64_t m = 0; m < 16; ++m) {
+    EXPECT_EQ(tally.patterns[m], m + 1);
+  }
+}
+
+TEST(CutflowTallyTest, MergeAddsSlotCounters) {
+  CutflowTally a(2, false), b(2, false);
+  a.fill(0b11);
+  a.fill(0b01);
+  b.fill(0b10);
+  b.fill(0b11);
+  a.merge(b);
+
+  EXPECT_EQ(a.total, 4ULL);
+  EXPECT_EQ(a.cumulativeCounts(), (std::vector<ULong64_t>{3, 2}));
+  EXPECT_EQ(a.nMinusOneCounts(), (std::vector<ULong64_t>{3, 3}));
+  EXPECT_TRUE(a.patterns.empty());
+}
+
+TEST(CutflowTallyTest, WeightSumsFollowCounts) {
+  // Two cuts, two weights; weight 1 is twice weight 0.
+  CutflowTally tally(2, false, 2);
+  const double w0[] = {1.0, 2.0};
+  const double w1[] = {0.5, 1.0};
+  const double w2[] = {-2.0, -4.0};
+  tally.fill(0b11, w0);
+  tally.fill(0b01, w1);
+  tally.fill(0b10, w2);
+
+  EXPECT_DOUBLE_EQ(tally.totalSumW[0], -0.5);
+  EXPECT_DOUBLE_EQ(tally.totalSumW2[0], 5.25);
+  EXPECT_EQ(tally.cumulativeSums(0, false), (std::vector<double>{1.5, 1.0}));
+  EXPECT_EQ(tally.cumulativeSums(0, true), (std::vector<double>{1.25, 1.0}));
+  EXPECT_EQ(tally.nMinusOneSums(0, false), (std::vector<double>{-1.0, 1.5}));
+  EXPECT_EQ(tally.cumulativeSums(1, false), (std::vector<double>{3.0, 2.0}));
+  EXPECT_EQ(tally.nMinusOneSums(1, true), (std::vector<double>{20.0, 5.0}));
+
+  CutflowTally other(2, false, 2);
+  other.fill(0b11, w0);
+  tally.merge(other);
+  EXPECT_EQ(tally.cumulativeSums(0, false), (std::vector<double>{2.5, 2.0}));
+}
+
+TEST(CutflowTallyTest, SixtyFourCutsUseFullWord) {
+  CutflowTally tally(64, false);
+  tally.fill(~std::uint64_t{0});
+  tally.fill(~(std::uint64_t{1} << 63));
+
+  EXPECT_EQ(tally.cumulativeCounts()[62], 2ULL);
+  EXPECT_EQ(tally.cumulativeCounts()[63], 1ULL);
+  EXPECT_EQ(tally.nMinusOneCounts()[63], 2ULL);
+  EXPECT_EQ(tally.nMinusOneCounts()[0], 1ULL);
+}
+
+// ---------------------------------------------------------------------------
+// Pattern counts
+// ---------------------------------------------------------------------------
+
+TEST_F(CutflowManagerTest, PatternCountsOneEventPerMask) {
+  // 8 events; cut k passes when bit k of the entry number is set, so every
+  // pass/fail pattern of the three cuts occurs exactly once.
+  auto dm = std::make_unique<DataManager>(8);
+  auto mgr = makeMgr(*dm);
+  for (int k = 0; k < 3; ++k) {
+    dm->Define("pass_bit" + std::to_string(k),
+               [k](ULong64_t i) { return ((i >> k) & 1) != 0; },
+               {"rdfentry_"}, *systematicManager);
+  }
+  for (int k = 0; k < 3; ++k) {
+    mgr->addCut("bit" + std::to_string(k), "pass_bit" + std::to_string(k));
+  }
+  mgr->enablePatternCounts();
+
+  mgr->execute();
+  mgr->finalize();
+
+  ASSERT_EQ(mgr->getPatternCounts().size(), 8u);
+  for (ULong64_t count : mgr->getPatternCounts()) {
+    EXPECT_EQ(count, 1ULL);
+  }
+  EXPECT_EQ(mgr->getCutflowCounts()[2].second, 1ULL);
+  EXPECT_EQ(mgr->getNMinusOneCounts()[0].second, 2ULL);
+}
+
+TEST_F(CutflowManagerTest, PatternCountsEmptyByDefault) {
+  auto dm = std::make_unique<DataManager>(4);
+  auto mgr = makeMgr(*dm);
+  dm->Define("pass_cut", [](ULong64_t) { return true; }, {"rdfentry_"},
+             *systematicManager);
+  mgr->addCut("cut", "pass_cut");
+
+  mgr->execute();
+  mgr->finalize();
+
+  EXPECT_TRUE(mgr->getPatternCounts().empty());
+}
+
+TEST_F(CutflowManagerTest, PatternCountsRejectTooManyCuts) {
+  auto dm = std::make_unique<DataManager>(4);
+  auto mgr = makeMgr(*dm);
+  for (std::size_t k = 0; k <= CutflowManager::kMaxPatternCuts; ++k) {
+    const std::string column = "pass_c" + std::to_string(k);
+    dm->Define(column, [](ULong64_t) { return true; }, {"rdfentry_"},
+               *systematicManager);
+    mgr->addCut("c" + std::to_string(k), column);
+  }
+  mgr->enablePatternCounts();
+
+  EXPECT_THROW(mgr->execute(), std::runtime_error);
+}
+
+// ---------------------------------------------------------------------------
+// More cuts than fit in one mask word: Filter/Count fallback
+// ---------------------------------------------------------------------------
+
+TEST_F(CutflowManagerTest, MoreCutsThanMaskBitsFallBackToFilterChains) {
+  // 5 events; all cuts pass except the last, which keeps entries 0-2.
+  auto dm = std::make_unique<DataManager>(5);
+  auto mgr = makeMgr(*dm);
+  const std::size_t nCuts = CutflowManager::kMaxMaskedCuts + 1;
+  for (std::size_t k = 0; k < nCuts; ++k) {
+    const std::string column = "pass_c" + std::to_string(k);
+    if (k + 1 < nCuts) {
+      dm->Define(column, [](ULong64_t) { return true; }, {"rdfentry_"},
+                 *systematicManager);
+    } else {
+      dm->Define(column, [](ULong64_t i) { return i < 3; }, {"rdfentry_"},
+                 *systematicManager);
+    }
+  }
+  for (std::size_t k = 0; k < nCuts; ++k) {
+    mgr->addCut("c" + std::to_string(k), "pass_c" + std::to_string(k));
+  }
+
+  mgr->execute();
+  mgr->finalize();
+
+  EXPECT_EQ(mgr->getTotalCount(), 5ULL);
+  ASSERT_EQ(mgr->getCutflowCounts().size(), nCuts);
+  EXPECT_EQ(mgr->getCutflowCounts()[nCuts - 2].second, 5ULL);
+  EXPECT_EQ(mgr->getCutflowCounts()[nCuts - 1].second, 3ULL);
+  EXPECT_EQ(mgr->getNMinusOneCounts()[0].second, 3ULL);
+  EXPECT_EQ(mgr->getNMinusOneCounts()[nCuts - 1].second, 5ULL);
+}
+
+// ---------------------------------------------------------------------------
+// Weighted cutflows
+// ---------------------------------------------------------------------------
+
+TEST_F(CutflowManagerTest, WeightedCutflowSumsWeightsPerCut) {
+  // 4 events with weight i + 1; cutA: i >= 1, cutB: i % 2 == 1.
+  auto dm = std::make_unique<DataManager>(4);
+  auto mgr = makeMgr(*dm);
+  dm->Define("w", [](ULong64_t i) { return static_cast<double>(i + 1); },
+             {"rdfentry_"}, *systematicManager);
+  dm->Define("pass_cutA", [](ULong64_t i) { return i >= 1; }, {"rdfentry_"},
+             *systematicManager);
+  dm->Define("pass_cutB", [](ULong64_t i) { return i % 2 == 1; },
+             {"rdfentry_"}, *systematicManager);
+  mgr->addCut("cutA", "pass_cutA");
+  mgr->addCut("cutB", "pass_cutB");
+  mgr->addWeight("w", "w");
+
+  mgr->execute();
+  mgr->finalize();
+
+  ASSERT_EQ(mgr->getWeightedCutflows().size(), 1u);
+  const auto &cutflow = mgr->getWeightedCutflows()[0];
+  EXPECT_EQ(cutflow.label, "w");
+  EXPECT_DOUBLE_EQ(cutflow.totalSumW, 10.0);
+  EXPECT_DOUBLE_EQ(cutflow.totalSumW2, 30.0);
+  ASSERT_EQ(cutflow.sumW.size(), 2u);
+  EXPECT_DOUBLE_EQ(cutflow.sumW[0], 9.0);   // 2 + 3 + 4
+  EXPECT_DOUBLE_EQ(cutflow.sumW[1], 6.0);   // 2 + 4
+  EXPECT_DOUBLE_EQ(cutflow.sumW2[1], 20.0);
+  EXPECT_DOUBLE_EQ(cutflow.nMinusOneSumW[0], 6.0); // cutB only: 2 + 4
+  EXPECT_DOUBLE_EQ(cutflow.nMinusOneSumW[1], 9.0); // cutA only
+  // Raw counts come from the same action.
+  EXPECT_EQ(mgr->getCutflowCounts()[1].second, 2ULL);
+}
+
+TEST_F(CutflowManagerTest, WeightScaleAppliesToWeightedCutflowsOnly) {
+  auto dm = std::make_unique<DataManager>(4);
+  auto mgr = makeMgr(*dm);
+  dm->Define("w", [](ULong64_t i) { return static_cast<double>(i + 1); },
+             {"rdfentry_"}, *systematicManager);
+  dm->Define("pass_cutA", [](ULong64_t i) { return i >= 1; }, {"rdfentry_"},
+             *systematicManager);
+  mgr->addCut("cutA", "pass_cutA");
+  mgr->addWeight("w", "w");
+  mgr->setWeightScale(0.5);
+
+  mgr->execute();
+  mgr->finalize();
+
+  const auto &cutflow = mgr->getWeightedCutflows()[0];
+  EXPECT_DOUBLE_EQ(cutflow.totalSumW, 5.0);
+  EXPECT_DOUBLE_EQ(cutflow.totalSumW2, 7.5);
+  EXPECT_DOUBLE_EQ(cutflow.sumW[0], 4.5);
+  EXPECT_DOUBLE_EQ(cutflow.sumW2[0], 7.25);
+  EXPECT_EQ(mgr->getCutflowCounts()[0].second, 3ULL);
+}
+
+TEST_F(CutflowManagerTest, WeightedCutflowFromWeightManagerVariations) {
+  auto dm = std::make_unique<DataManager>(4);
+  auto mgr = makeMgr(*dm);
+  auto wm = std::make_unique<WeightManager>();
+  auto ctx = makeContext(*config, *dm, *systematicManager, *logger, *skimSink,
+                         *metaSink);
+  wm->setContext(ctx);
+
+  dm->Define("pu_sf", [](ULong64_t) { return 1.0; }, {"rdfentry_"},
+             *systematicManager);
+  dm->Define("pu_sf_up", [](ULong64_t) { return 1.5; }, {"rdfentry_"},
+             *systematicManager);
+  dm->Define("pu_sf_down", [](ULong64_t) { return 0.5; }, {"rdfentry_"},
+             *systematicManager);
+  wm->addScaleFactor("pu", "pu_sf");
+  wm->addWeightVariation("pu", "pu_sf_up", "pu_sf_down");
+  wm->defineNominalWeight("weight_nominal");
+  wm->defineVariedWeight("pu", "up", "weight_pu_up");
+  wm->defineVariedWeight("pu", "down", "weight_pu_down");
+
+  dm->Define("pass_cut", [](ULong64_t i) { return i < 2; }, {"rdfentry_"},
+             *systematicManager);
+  mgr->addCut("cut", "pass_cut");
+  mgr->bindToWeightManager(*wm, {"pu"});
+
+  mgr->execute();
+  mgr->finalize();
+
+  const auto &cutflows = mgr->getWeightedCutflows();
+  ASSERT_EQ(cutflows.size(), 3u);
+  EXPECT_EQ(cutflows[0].label, "nominal");
+  EXPECT_EQ(cutflows[1].label, "puUp");
+  EXPECT_EQ(cutflows[2].label, "puDown");
+  EXPECT_DOUBLE_EQ(cutflows[0].sumW[0], 2.0);
+  EXPECT_DOUBLE_EQ(cutflows[1].sumW[0], 3.0);
+  EXPECT_DOUBLE_EQ(cutflows[2].sumW[0], 1.0);
+}
+
+TEST_F(CutflowManagerTest, BindToWeightManagerRejectsUndefinedColumns) {
+  auto dm = std::make_unique<DataManager>(4);
+  auto mgr = makeMgr(*dm);
+  WeightManager wm;
+  EXPECT_THROW(mgr->bindToWeightManager(wm), std::runtime_error);
+}
+
+TEST_F(CutflowManagerTest, AddWeightRejectsDuplicateLabel) {
+  auto dm = std::make_unique<DataManager>(4);
+  auto mgr = makeMgr(*dm);
+  mgr->addWeight("w", "w1");
+  EXPECT_THROW(mgr->addWeight("w", "w2"), std::runtime_error);
+}
+
+TEST_F(CutflowManagerTest, WeightColumnMustBeDouble) {
+  auto dm = std::make_unique<DataManager>(4);
+  auto mgr = makeMgr(*dm);
+  dm->Define("w_float", [](ULong64_t) { return 1.0f; }, {"rdfentry_"},
+             *systematicManager);
+  dm->Define("pass_cut", [](ULong64_t) { return true; }, {"rdfentry_"},
+             *systematicManager);
+  mgr->addCut("cut", "pass_cut");
+  mgr->addWeight("w", "w_float");
+  EXPECT_THROW(mgr->execute(), std::runtime_error);
+}
+
+TEST_F(CutflowManagerTest, RegionWeightedCutflow) {
+  // region "r": i >= 2 → events 2, 3 with weights 3, 4.
+  auto dm = std::make_unique<DataManager>(4);
+  auto cfm = makeMgr(*dm);
+  auto rm  = makeRegionMgr(*dm, *config, *systematicManager, *logger,
+                            *skimSink, *metaSink);
+  dm->Define("w", [](ULong64_t i) { return static_cast<double>(i + 1); },
+             {"rdfentry_"}, *systematicManager);
+  dm->Define("pass_r", [](ULong64_t i) { return i >= 2; }, {"rdfentry_"},
+             *systematicManager);
+  dm->Define("pass_cut", [](ULong64_t i) { return i != 3; }, {"rdfentry_"},
+             *systematicManager);
+  rm->declareRegion("r", "pass_r");
+  cfm->addCut("cut", "pass_cut");
+  cfm->addWeight("w", "w");
+  cfm->bindToRegionManager(rm.get());
+
+  cfm->execute();
+  cfm->finalize();
+
+  const auto &cutflows = cfm->getRegionWeightedCutflows("r");
+  ASSERT_EQ(cutflows.size(), 1u);
+  EXPECT_DOUBLE_EQ(cutflows[0].totalSumW, 7.0);
+  EXPECT_DOUBLE_EQ(cutflows[0].sumW[0], 3.0);
+  EXPECT_THROW(cfm->getRegionWeightedCutflows("unknown"), std::runtime_error);
+}
+
+// ---------------------------------------------------------------------------
+// Region membership mode: all region cutflows from one action
+// ---------------------------------------------------------------------------
+
+TEST_F(CutflowManagerTest, RegionMembershipModeMatchesFilterBranches) {
+  // Same events and regions as RegionCutflowMultipleRegionsTwoCuts, plus an
+  // overlapping root region "late" (i >= 6) and a weight of i + 1.
+  auto dm = std::make_unique<DataManager>(10);
+  auto cfm = makeMgr(*dm);
+  auto rm  = makeRegionMgr(*dm, *config, *systematicManager, *logger,
+                            *skimSink, *metaSink);
+
+  dm->Define("pass_presel", [](ULong64_t i) { return i >= 1; },
+             {"rdfentry_"}, *systematicManager);
+  dm->Define("pass_signal", [](ULong64_t i) { return i < 5; },
+             {"rdfentry_"}, *systematicManager);
+  dm->Define("pass_late",   [](ULong64_t i) { return i >= 6; },
+             {"rdfentry_"}, *systematicManager);
+  dm->Define("pass_cutA",   [](ULong64_t i) { return i % 2 == 0; },
+             {"rdfentry_"}, *systematicManager);
+  dm->Define("pass_cutB",   [](ULong64_t i) { return i < 7; },
+             {"rdfentry_"}, *systematicManager);
+  dm->Define("w", [](ULong64_t i) { return static_cast<double>(i + 1); },
+             {"rdfentry_"}, *systematicManager);
+
+  rm->declareRegion("presel", "pass_presel");
+  rm->declareRegion("signal", "pass_signal", "presel");
+  rm->declareRegion("late",   "pass_late");
+  rm->setMembershipMode();
+
+  cfm->addCut("cutA", "pass_cutA");
+  cfm->addCut("cutB", "pass_cutB");
+  cfm->addWeight("w", "w");
+  cfm->bindToRegionManager(rm.get());
+
+  cfm->execute();
+  cfm->finalize();
+
+  EXPECT_EQ(cfm->getTotalCount(), 10ULL);
+  EXPECT_EQ(cfm->getRegionTotalCount("presel"), 9ULL);
+  EXPECT_EQ(cfm->getRegionCutflowCounts("presel")[0].second, 4ULL);
+  EXPECT_EQ(cfm->getRegionCutflowCounts("presel")[1].second, 3ULL);
+  EXPECT_EQ(cfm->getRegionTotalCount("signal"), 4ULL);
+  EXPECT_EQ(cfm->getRegionCutflowCounts("signal")[0].second, 2ULL);
+  EXPECT_EQ(cfm->getRegionCutflowCounts("signal")[1].second, 2ULL);
+
+  // "late": events 6-9. cutA: 6, 8; cutA+cutB: 6. N-1 without cutA (cutB
+  // only): 6; without cutB (cutA only): 6, 8.
+  EXPECT_EQ(cfm->getRegionTotalCount("late"), 4ULL);
+  EXPECT_EQ(cfm->getRegionCutflowCounts("late")[1].second, 1ULL);
+  EXPECT_EQ(cfm->getRegionNMinusOneCounts("late")[0].second, 1ULL);
+  EXPECT_EQ(cfm->getRegionNMinusOneCounts("late")[1].second, 2ULL);
+  EXPECT_DOUBLE_EQ(cfm->getRegionWeightedCutflows("late")[0].sumW[0], 16.0);
+}
+
+// ---------------------------------------------------------------------------
+// Checkpoints
+// ---------------------------------------------------------------------------
+
+TEST_F(CutflowManagerTest, ResumedCutflowAddsCheckpointedTallies) {
+  const std::string cfgPath = "aux/test_cutflow_checkpoint_config.txt";
+  const std::string checkpointPath = "aux/test_cutflow_checkpoint.root";
+  std::remove(checkpointPath.c_str());
+  {
+    std::ofstream out(cfgPath);
+    out << "checkpointFile=" << checkpointPath << "\n";
+    out << "checkpointEvery=4\n";
+  }
+  ConfigurationManager checkpointConfig(cfgPath);
+
+  // 10 events; cutA passes even indices, weight w = index + 1.
+  const auto runCutflow = [&](DataManager &dm, ManagerContext &ctx,
+                              CheckpointService &service) {
+    service.initialize(ctx);
+    auto mgr = makeMgr(dm);
+    dm.Define("pass_cutA", [](ULong64_t i) { return i % 2 == 0; },
+              {"rdfentry_"}, *systematicManager);
+    dm.Define("w", [](ULong64_t i) { return static_cast<double>(i + 1); },
+              {"rdfentry_"}, *systematicManager);
+    mgr->addCut("cutA", "pass_cutA");
+    mgr->addWeight("w", "w");
+    mgr->execute();
+    mgr->bookCheckpoint(service);
+    service.arm();
+    mgr->finalize();
+    return mgr;
+  };
+
+  // Preempted run: the checkpoint holds the tallies of entries 0-7.
+  {
+    DataManager dm(10);
+    auto ctx = makeContext(checkpointConfig, dm, *systematicManager, *logger,
+                           *skimSink, *metaSink);
+    CheckpointService service;
+    runCutflow(dm, ctx, service);
+    service.writeCheckpoint();
+  }
+
+  DataManager dm(10);
+  dm.skipEntries(CheckpointService::readProcessedEntries(checkpointPath));
+  auto ctx = makeContext(checkpointConfig, dm, *systematicManager, *logger,
+                         *skimSink, *metaSink);
+  CheckpointService service;
+  auto mgr = runCutflow(dm, ctx, service);
+
+  EXPECT_EQ(mgr->getTotalCount(), 10ULL);
+  EXPECT_EQ(mgr->getCutflowCounts()[0].second, 5ULL);
+  ASSERT_EQ(mgr->getWeightedCutflows().size(), 1u);
+  EXPECT_DOUBLE_EQ(mgr->getWeightedCutflows()[0].totalSumW, 55.0);
+  EXPECT_DOUBLE_EQ(mgr->getWeightedCutflows()[0].sumW[0], 25.0);
+
+  std::remove(checkpointPath.c_str());
+  std::remove(cfgPath.c_str());
+}
+
 int main(int argc, char **argv) {
   ::testing::InitGoogleTest(&argc, argv);
   return RUN_ALL_TESTS();
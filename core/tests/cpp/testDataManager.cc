@@ -13,9 +13,15 @@
 #include <test_util.h>
 #include <DataManager.h>
 #include <ManagerFactory.h>
+#include <SampleSet.h>
+#include <SkimColumnManifest.h>
 #include <ROOT/RDataFrame.hxx>
 #include <TChain.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <filesystem>
+#include <fstream>
 #include <gtest/gtest.h>
 #include <memory>
 #include <string>
@@ -149,6 +155,30 @@ TEST_F(DataManagerTest, SetDataFrameUpdatesNode) {
   }
 }
 
+/**
+ * @brief The column index follows Define/Redefine and is rebuilt after
+ * setDataFrame().
+ */
+TEST_F(DataManagerTest, ColumnIndexTracksDefinedColumns) {
+  EXPECT_FALSE(dataManager->hasColumn("indexed_col"));
+  dataManager->Define("indexed_col", []() { return 7; }, {}, *systematicManager);
+  EXPECT_TRUE(dataManager->hasColumn("indexed_col"));
+  EXPECT_EQ(dataManager->columnType("indexed_col"), "int");
+
+  dataManager->Redefine("indexed_col", []() { return 7.5; });
+  EXPECT_EQ(dataManager->columnType("indexed_col"), "double");
+
+  // Defining an existing column again is a no-op.
+  EXPECT_NO_THROW(
+      dataManager->Define("indexed_col", []() { return 1; }, {}, *systematicManager));
+
+  auto df = dataManager->getDataFrame().Define("outside_col", []() { return 1; });
+  dataManager->setDataFrame(df);
+  EXPECT_TRUE(dataManager->hasColumn("outside_col"));
+  EXPECT_TRUE(dataManager->hasColumn("indexed_col"));
+  EXPECT_FALSE(dataManager->hasColumn("missing_col"));
+}
+
 /**
  * @brief Test getChain returns a valid TChain pointer
  *
@@ -160,6 +190,36 @@ TEST_F(DataManagerTest, GetChainReturnsValidPointer) {
   // Optionally check chain properties if needed
 }
 
+/**
+ * @brief Test input-format selection
+ *
+ * The test inputs are TTrees: auto-detection must keep the TTree path and an
+ * unknown inputFormat value must be rejected.
+ */
+TEST_F(DataManagerTest, InputFormatAutoDetectsTTreeAndRejectsUnknown) {
+  auto config = ManagerFactory::createConfigurationManager("cfg/test_data_config.txt");
+  config->set("inputFormat", "auto");
+  auto manager = ManagerFactory::createDataManager(*config);
+  EXPECT_FALSE(dynamic_cast<DataManager*>(manager.get())->isRNTupleInput());
+
+  config->set("inputFormat", "parquet");
+  EXPECT_THROW(ManagerFactory::createDataManager(*config), std::runtime_error);
+}
+
+/**
+ * @brief Test that lumi-section pre-skipping is a no-op without an input chain
+ *
+ * An in-memory DataManager has no TChain to attach an entry list to, so the
+ * mask must report that it was not applied and leave all entries in place.
+ */
+TEST_F(DataManagerTest, ApplyLumiSectionMaskWithoutChainIsNoOp) {
+  DataManager inMemory(5);
+  const auto kept = inMemory.applyLumiSectionMask(
+      [](unsigned int, unsigned int) { return false; });
+  EXPECT_EQ(kept, -1);
+  EXPECT_EQ(inMemory.getDataFrame().Count().GetValue(), 5ULL);
+}
+
 /**
  * @brief Test DefineVector creates a vector column
  *
@@ -180,6 +240,87 @@ TEST_F(DataManagerTest, DefineVectorCreatesVectorColumn) {
   });
 }
 
+/**
+ * @brief Test DefineVector results for typed-kernel and JIT-fallback inputs
+ *
+ * Homogeneous Int_t scalars and Float_t RVecs use precompiled kernels, while
+ * a Float_t/Int_t mix falls back to JIT; all must produce the same values.
+ */
+TEST_F(DataManagerTest, DefineVectorTypedKernelsAndFallbackAgree) {
+  DataManager local(1);
+  local.Define("i1", []() { return 1; }, {}, *systematicManager);
+  local.Define("i2", []() { return 2; }, {}, *systematicManager);
+  local.Define("f1", []() { return 3.5f; }, {}, *systematicManager);
+  local.Define("v1", []() { return ROOT::VecOps::RVec<float>{1.f, 2.f}; }, {},
+               *systematicManager);
+  local.Define("v2", []() { return ROOT::VecOps::RVec<float>{3.f}; }, {},
+               *systematicManager);
+
+  local.DefineVector("ints", {"i1", "i2"}, "Float_t", *systematicManager);
+  local.DefineVector("mixed", {"i1", "f1"}, "Float_t", *systematicManager);
+  local.DefineVector("concat", {"v1", "v2"}, "Double_t", *systematicManager);
+  local.DefineVector("empty", {}, "Float_t", *systematicManager);
+
+  auto df = local.getDataFrame();
+  auto ints = df.Take<ROOT::VecOps::RVec<Float_t>>("ints");
+  auto mixed = df.Take<ROOT::VecOps::RVec<Float_t>>("mixed");
+  auto concat = df.Take<ROOT::VecOps::RVec<Double_t>>("concat");
+  auto empty = df.Take<ROOT::VecOps::RVec<Float_t>>("empty");
+
+  ASSERT_EQ((*ints)[0].size(), 2u);
+  EXPECT_FLOAT_EQ((*ints)[0][0], 1.0f);
+  EXPECT_FLOAT_EQ((*ints)[0][1], 2.0f);
+  ASSERT_EQ((*mixed)[0].size(), 2u);
+  EXPECT_FLOAT_EQ((*mixed)[0][1], 3.5f);
+  ASSERT_EQ((*concat)[0].size(), 3u);
+  EXPECT_DOUBLE_EQ((*concat)[0][2], 3.0);
+  EXPECT_TRUE((*empty)[0].empty());
+}
+
+/**
+ * @brief Test DefineFeatureVector shares one feature block between inputs
+ *
+ * With the features of both models declared, one block is built; the
+ * inputs are a slice and a gather of it with the DefineVector values.
+ */
+TEST_F(DataManagerTest, DefineFeatureVectorSharesFeatureBlock) {
+  DataManager local(1);
+  local.Define("a", []() { return 1.0f; }, {}, *systematicManager);
+  local.Define("b", []() { return 2; }, {}, *systematicManager);
+  local.Define("c", []() { return 3.0; }, {}, *systematicManager);
+
+  local.declareFeatures({"a", "b"});
+  local.declareFeatures({"c", "a"});
+  local.DefineFeatureVector("input_first", {"a", "b"}, *systematicManager);
+  local.DefineFeatureVector("input_second", {"c", "a"}, *systematicManager);
+  local.DefineFeatureVector("input_tail", {"b", "c"}, *systematicManager);
+
+  ASSERT_EQ(local.getFeatureBlocks().size(), 1u);
+  EXPECT_EQ(local.getFeatureBlocks()[0], (std::vector<std::string>{"a", "b", "c"}));
+
+  auto df = local.getDataFrame();
+  auto first = df.Take<ROOT::VecOps::RVec<Float_t>>("input_first");
+  auto second = df.Take<ROOT::VecOps::RVec<Float_t>>("input_second");
+  auto tail = df.Take<ROOT::VecOps::RVec<Float_t>>("input_tail");
+  const auto values = [](const ROOT::VecOps::RVec<Float_t> &v) {
+    return std::vector<Float_t>(v.begin(), v.end());
+  };
+  EXPECT_EQ(values((*first)[0]), (std::vector<Float_t>{1.0f, 2.0f}));
+  EXPECT_EQ(values((*second)[0]), (std::vector<Float_t>{3.0f, 1.0f}));
+  EXPECT_EQ(values((*tail)[0]), (std::vector<Float_t>{2.0f, 3.0f}));
+
+  // A slice owns its values rather than pointing into the shared block.
+  auto aliased = df.Define("tail_in_block",
+                           [](const ROOT::VecOps::RVec<Float_t> &slice,
+                              const ROOT::VecOps::RVec<Float_t> &block) {
+                             return slice.data() >= block.data() &&
+                                    slice.data() < block.data() + block.size();
+                           },
+                           {"input_tail", "__features_0"})
+                     .Take<bool>("tail_in_block");
+  EXPECT_FALSE((*aliased)[0]);
+}
+
 /**
  * @brief Test Filter_m applies a filter to the dataframe
  *
@@ -238,6 +379,73 @@ TEST_F(DataManagerTest, RedefineUpdatesColumn) {
   }
 }
 
+/**
+ * @brief Test that deferred variation columns are only defined on request
+ *
+ * Variants created by Define() stay pending until a systematic lookup
+ * requests them; requesting a dependent variant defines its inputs too.
+ */
+TEST_F(DataManagerTest, DeferredVariationsDefinedOnlyWhenRequested) {
+  auto *dm = dynamic_cast<DataManager *>(dataManager.get());
+  ASSERT_NE(dm, nullptr);
+  dm->setDeferVariationColumns(true);
+  dm->Define("deferX", []() { return 1.0f; }, {}, *systematicManager);
+  dm->Define("deferX_shiftUp", []() { return 2.0f; }, {}, *systematicManager);
+  dm->Define("deferX_shiftDown", []() { return 0.5f; }, {}, *systematicManager);
+  systematicManager->registerSystematic("shift", {"deferX"});
+
+  dm->Define("deferY", [](float x) { return 2.0f * x; }, {"deferX"}, *systematicManager);
+  dm->Define("deferZ", [](float y) { return y + 1.0f; }, {"deferY"}, *systematicManager);
+
+  auto pending = dm->getPendingColumns();
+  EXPECT_EQ(pending, (std::vector<std::string>{"deferY_shiftDown", "deferY_shiftUp",
+                                               "deferZ_shiftDown", "deferZ_shiftUp"}));
+  EXPECT_EQ(dm->getDeferredColumnCount(), 4u);
+
+  systematicManager->setColumnMaterializer(
+      [dm](const std::string &column) { dm->materializeColumn(column); });
+  EXPECT_EQ(systematicManager->getVariationColumnName("deferZ", "shiftUp"), "deferZ_shiftUp");
+
+  pending = dm->getPendingColumns();
+  EXPECT_EQ(pending, (std::vector<std::string>{"deferY_shiftDown", "deferZ_shiftDown"}));
+  auto df = dm->getDataFrame();
+  auto values = df.Take<float>("deferZ_shiftUp");
+  ASSERT_FALSE(values->empty());
+  EXPECT_FLOAT_EQ(values->at(0), 5.0f);
+  const auto colNames = df.GetColumnNames();
+  EXPECT_EQ(std::find(colNames.begin(), colNames.end(), "deferZ_shiftDown"), colNames.end());
+
+  dm->materializeAllColumns();
+  EXPECT_TRUE(dm->getPendingColumns().empty());
+}
+
+/**
+ * @brief A variant whose inputs are all nominal aliases the nominal column
+ *
+ * The Down side of a one-sided systematic resolves to the nominal column,
+ * so Define() registers the nominal column as its variation and only adds
+ * an alias; dependent Defines see the nominal column again.
+ */
+TEST_F(DataManagerTest, NominalInputVariantsAliasTheNominalColumn) {
+  dataManager->Define("oneX", []() { return 1.0f; }, {}, *systematicManager);
+  dataManager->Define("oneX_tiltUp", []() { return 3.0f; }, {}, *systematicManager);
+  systematicManager->registerVariationColumns("oneX", "tilt", "oneX_tiltUp", "oneX");
+
+  dataManager->Define("oneY", [](float x) { return 2.0f * x; }, {"oneX"}, *systematicManager);
+  dataManager->Define("oneZ", [](float y) { return y + 1.0f; }, {"oneY"}, *systematicManager);
+
+  EXPECT_EQ(systematicManager->getVariationColumnName("oneY", "tiltUp"), "oneY_tiltUp");
+  EXPECT_EQ(systematicManager->getVariationColumnName("oneY", "tiltDown"), "oneY");
+  EXPECT_EQ(systematicManager->getVariationColumnName("oneZ", "tiltDown"), "oneZ");
+
+  auto df = dataManager->getDataFrame();
+  auto up = df.Take<float>("oneZ_tiltUp");
+  auto down = df.Take<float>("oneZ_tiltDown");
+  ASSERT_FALSE(up->empty());
+  EXPECT_FLOAT_EQ(up->at(0), 7.0f);
+  EXPECT_FLOAT_EQ(down->at(0), 3.0f);
+}
+
 /**
  * @brief Test makeSystList creates systematic variation columns
  *
@@ -328,6 +536,44 @@ TEST_F(DataManagerTest, RegisterConstantsCreatesColumns) {
   EXPECT_NE(std::find(colNames.begin(), colNames.end(), "int1"), colNames.end());
 }
 
+/**
+ * @brief With foldConstants, constants become literals in JIT expressions
+ * and are only defined as columns when read as one.
+ */
+TEST_F(DataManagerTest, FoldedConstantsDefinedOnlyWhenRead) {
+  auto dm = dynamic_cast<DataManager*>(dataManager.get());
+  dm->setFoldConstants(true);
+  configManager->set("floatConfigDM", "cfg/floats.txt");
+  configManager->set("intConfigDM", "cfg/ints.txt");
+  dm->registerConstants(*configManager, "floatConfigDM", "intConfigDM");
+  EXPECT_EQ(dm->getFoldedConstants(),
+            (std::vector<std::string>{"float1", "float2", "float3", "int1", "int2", "int3"}));
+  EXPECT_FLOAT_EQ(dm->getConstant<float>("float2"), 2.7f);
+  EXPECT_EQ(dm->getConstant<int>("int3"), 30);
+  EXPECT_THROW(dm->getConstant<float>("missing"), std::runtime_error);
+
+  dm->setDataFrame(dm->defineExpression(dm->getDataFrame(), "scaled", "float1 * int1"));
+  auto colNames = dm->getDataFrame().GetColumnNames();
+  EXPECT_EQ(std::find(colNames.begin(), colNames.end(), "float1"), colNames.end());
+  EXPECT_FLOAT_EQ(*dm->getDataFrame().Max<Float_t>("scaled"), 15.0f);
+  // Names inside string and character literals are not constants.
+  dm->setDataFrame(dm->defineExpression(
+      dm->getDataFrame(), "quoted", "Int_t(std::string(\"int1\").size()) + int1"));
+  EXPECT_EQ(*dm->getDataFrame().Max<Int_t>("quoted"), 14);
+
+  const float cut = dm->getConstant<float>("float3");
+  dm->Define("captured", [cut](Float_t x) { return x + cut; }, {"scaled"}, *systematicManager);
+  dm->Define("read", [](Int_t x) { return x + 1; }, {"int2"}, *systematicManager);
+  EXPECT_EQ(*dm->getDataFrame().Max<Int_t>("read"), 21);
+  EXPECT_FLOAT_EQ(*dm->getDataFrame().Max<Float_t>("captured"), 18.14f);
+  EXPECT_TRUE(dm->hasColumn("float2"));
+  EXPECT_EQ(dm->getFoldedConstants(), (std::vector<std::string>{"float1", "float3", "int1", "int3"}));
+
+  dm->materializeAllColumns();
+  EXPECT_TRUE(dm->getFoldedConstants().empty());
+  EXPECT_EQ(*dm->getDataFrame().Max<Int_t>("int1"), 10);
+}
+
 /**
  * @brief Test registerAliases registers aliases from config
  *
@@ -493,6 +739,438 @@ TEST_F(DataManagerTest, AttachFriendTreeNoSourceSkipsGracefully) {
   });
 }
 
+/**
+ * @brief discoverRootFiles() lists nested directories in parallel, applies
+ * globs and antiglobs, and reuses the file-list cache until a directory
+ * changes.
+ */
+TEST(FileDiscoveryTest, ParallelScanMatchesGlobsAndUsesCache) {
+  namespace fs = std::filesystem;
+  const fs::path root = fs::temp_directory_path() /
+                        ("file_discovery_test_" + std::to_string(getpid()));
+  const fs::path cacheDir = root / "cache.d";
+  fs::remove_all(root);
+  for (const auto *sub : {"a", "b", "b/c"}) {
+    fs::create_directories(root / "data" / sub);
+  }
+  for (const auto *file : {"a/x.root", "b/y.root", "b/c/z.root", "b/FAIL.root",
+                           "b/c/notes.txt"}) {
+    std::ofstream(root / "data" / file) << "";
+  }
+
+  const std::string directory = (root / "data").string();
+  const std::vector<std::string> globs{".root"};
+  const std::vector<std::string> antiglobs{"FAIL"};
+  const auto files =
+      discoverRootFiles(directory, globs, antiglobs, 4, cacheDir.string());
+  ASSERT_EQ(files.size(), 3u);
+  EXPECT_EQ(files[0], directory + "/a/x.root");
+  EXPECT_EQ(files[1], directory + "/b/y.root");
+  EXPECT_EQ(files[2], directory + "/b/c/z.root");
+  ASSERT_FALSE(fs::is_empty(cacheDir));
+
+  // A cached list is returned as long as no visited directory changed.
+  EXPECT_EQ(discoverRootFiles(directory, globs, antiglobs, 1, cacheDir.string()),
+            files);
+
+  // Adding a file bumps the directory mtime and invalidates the cache.
+  std::ofstream(root / "data" / "a" / "w.root") << "";
+  fs::last_write_time(root / "data" / "a",
+                      fs::last_write_time(root / "data" / "a") +
+                          std::chrono::seconds(1));
+  const auto rescanned =
+      discoverRootFiles(directory, globs, antiglobs, 4, cacheDir.string());
+  EXPECT_EQ(rescanned.size(), 4u);
+
+  fs::remove_all(root);
+}
+
+/**
+ * @brief firstEntry/lastEntry restrict the event loop through an entry list,
+ * and entryIndex entry counts are used without changing the result.
+ */
+TEST(EntryRangeTest, EntryRangeUsesEntryListAndIndexedCounts) {
+  namespace fs = std::filesystem;
+  const fs::path root = fs::temp_directory_path() /
+                        ("entry_range_test_" + std::to_string(getpid()));
+  fs::remove_all(root);
+  fs::create_directories(root);
+  const std::string inputFile = (root / "input.root").string();
+  {
+    ROOT::RDataFrame(100)
+        .Define("x", [](ULong64_t i) { return static_cast<int>(i); }, {"rdfentry_"})
+        .Snapshot("Events", inputFile, {"x"});
+  }
+  const std::string indexFile = (root / "index.json").string();
+  std::ofstream(indexFile) << "{\"version\": 1, \"tree\": \"Events\", "
+                              "\"files\": {\"" << inputFile
+                           << "\": {\"entries\": 100, \"clusters\": [0, 100]}}}";
+  const std::string configFile = (root / "config.txt").string();
+  std::ofstream(configFile) << "fileList=" << inputFile << "\n"
+                            << "threads=1\nbatch=True\n"
+                            << "firstEntry=20\nlastEntry=50\n"
+                            << "entryIndex=" << indexFile << "\n";
+
+  ConfigurationManager config(configFile);
+  DataManager manager(config);
+  auto df = manager.getDataFrame();
+  EXPECT_EQ(*df.Count(), 30ULL);
+  EXPECT_EQ(*df.Min<int>("x"), 20);
+  EXPECT_EQ(*df.Max<int>("x"), 49);
+
+  fs::remove_all(root);
+}
+
+/**
+ * @brief previewFraction keeps whole, evenly spaced clusters of every file
+ * and reports the scale to full statistics.
+ */
+TEST(EntryRangeTest, PreviewSamplesClustersOfEveryFile) {
+  namespace fs = std::filesystem;
+  const fs::path root = fs::temp_directory_path() /
+                        ("preview_test_" + std::to_string(getpid()));
+  fs::remove_all(root);
+  fs::create_directories(root);
+  ROOT::RDF::RSnapshotOptions options;
+  options.fAutoFlush = 10; // clusters of 10 entries
+  std::vector<std::string> files;
+  for (const auto *name : {"a.root", "b.root"}) {
+    files.push_back((root / name).string());
+    ROOT::RDataFrame(100)
+        .Define("x", [](ULong64_t i) { return static_cast<int>(i); }, {"rdfentry_"})
+        .Snapshot("Events", files.back(), {"x"}, options);
+  }
+  const std::string configFile = (root / "config.txt").string();
+  std::ofstream(configFile) << "fileList=" << files[0] << "," << files[1] << "\n"
+                            << "threads=1\nbatch=True\npreviewFraction=0.2\n";
+
+  ConfigurationManager config(configFile);
+  DataManager manager(config);
+  ASSERT_TRUE(manager.isPreview());
+  EXPECT_EQ(manager.previewTotalEntries(), 200);
+  EXPECT_EQ(manager.previewSelectedEntries(), 40);
+  EXPECT_DOUBLE_EQ(manager.previewScale(), 5.0);
+  auto df = manager.getDataFrame();
+  EXPECT_EQ(*df.Count(), 40ULL);
+  // Whole clusters: the kept x values come in complete decades.
+  EXPECT_EQ(*df.Filter([](int x) { return x % 10 == 0; }, {"x"}).Count(), 4ULL);
+
+  // The same files give the same sample; a small fraction keeps one
+  // cluster per file.
+  TChain chain("Events");
+  for (const auto &file : files) {
+    chain.Add(file.c_str());
+  }
+  const auto sample = DataManager::samplePreviewClusters(chain, 0.01, 0, 200);
+  EXPECT_EQ(sample.size(), 20ULL);
+  EXPECT_EQ(sample.ranges().size(), 2u);
+  EXPECT_EQ(DataManager::samplePreviewClusters(chain, 0.2, 0, 200).ranges(),
+            DataManager::samplePreviewClusters(chain, 0.2, 0, 200).ranges());
+
+  std::ofstream(configFile) << "fileList=" << files[0] << "\n"
+                            << "threads=1\nbatch=True\npreviewFraction=1.5\n";
+  ConfigurationManager invalid(configFile);
+  EXPECT_THROW(DataManager bad(invalid), std::runtime_error);
+
+  fs::remove_all(root);
+}
+
+/**
+ * @brief pruneUnreadBranches keeps the branches read by typed and string
+ * definitions (also those made directly on the RNode, through an alias), the
+ * sizes of read arrays and keepInputBranches, and disables the rest on the
+ * main chain.
+ */
+TEST(InputBranchPruningTest, DisablesBranchesNothingReads) {
+  namespace fs = std::filesystem;
+  const fs::path root = fs::temp_directory_path() /
+                        ("branch_pruning_test_" + std::to_string(getpid()));
+  fs::remove_all(root);
+  fs::create_directories(root);
+  const std::string inputFile = (root / "input.root").string();
+  {
+    ROOT::RDataFrame(10)
+        .Define("x", [](ULong64_t i) { return static_cast<int>(i); }, {"rdfentry_"})
+        .Define("y", [](ULong64_t i) { return static_cast<float>(2 * i); }, {"rdfentry_"})
+        .Define("z", [](ULong64_t i) { return static_cast<int>(3 * i); }, {"rdfentry_"})
+        .Define("unused", [] { return 1.0f; })
+        .Define("Obj_pt", [] { return ROOT::RVecF{1.0f, 2.0f}; })
+        .Define("Keep_me", [] { return 3; })
+        .Snapshot("Events", inputFile, {"x", "y", "z", "unused", "Obj_pt", "Keep_me"});
+  }
+  const std::string reportFile = (root / "branches.txt").string();
+  const std::string configFile = (root / "config.txt").string();
+  std::ofstream(configFile) << "fileList=" << inputFile << "\n"
+                            << "threads=1\nbatch=True\n"
+                            << "pruneInputBranches=true\n"
+                            << "keepInputBranches=Keep_*\n"
+                            << "inputBranchReport=" << reportFile << "\n";
+
+  ConfigurationManager config(configFile);
+  DataManager manager(config);
+  SystematicManager systematics;
+  EXPECT_TRUE(manager.isInputBranchPruningEnabled());
+  manager.Define("x2", [](int x) { return 2 * x; }, {"x"}, systematics);
+  manager.DefineVector("ptVec", {"Obj_pt"}, "Float_t", systematics);
+  manager.updateDataFrame(manager.defineExpression(manager.getDataFrame(), "y3", "y * 3.f"),
+                          {"y3"});
+  manager.setDataFrame(manager.getDataFrame().Alias("zAlias", "z").Define(
+      "z2", [](int z) { return 2 * z; }, {"zAlias"}));
+
+  const auto read = manager.getReadInputBranches();
+  for (const char *name : {"x", "y", "z", "Obj_pt", "Keep_me"}) {
+    EXPECT_NE(std::find(read.begin(), read.end(), name), read.end()) << name;
+  }
+  EXPECT_EQ(std::find(read.begin(), read.end(), "unused"), read.end());
+
+  EXPECT_GE(manager.pruneUnreadBranches(), 1u);
+  EXPECT_FALSE(manager.getChain()->GetBranchStatus("unused"));
+  EXPECT_TRUE(manager.getChain()->GetBranchStatus("x"));
+  EXPECT_TRUE(manager.getChain()->GetBranchStatus("z"));
+
+  auto df = manager.getDataFrame();
+  EXPECT_EQ(*df.Sum<int>("x2"), 90);
+  EXPECT_FLOAT_EQ(*df.Sum<float>("y3"), 270.0f);
+  EXPECT_EQ(*df.Sum<int>("z2"), 270);
+
+  std::ifstream report(reportFile);
+  std::vector<std::string> listed;
+  for (std::string line; std::getline(report, line);) {
+    listed.push_back(line);
+  }
+  EXPECT_EQ(listed, read);
+
+  fs::remove_all(root);
+}
+
+/**
+ * @brief sampleConfig chains the files of several samples into one event
+ * loop, defines sampleIndex and per-sample constants.
+ */
+TEST(SampleSetTest, SamplesShareOneEventLoop) {
+  namespace fs = std::filesystem;
+  const fs::path root = fs::temp_directory_path() /
+                        ("sampleset_test_" + std::to_string(getpid()));
+  fs::remove_all(root);
+  fs::create_directories(root);
+  std::vector<std::string> files;
+  for (const auto &[name, entries] :
+       std::vector<std::pair<std::string, int>>{{"a.root", 10}, {"b.root", 20}, {"c.root", 5}}) {
+    files.push_back((root / name).string());
+    ROOT::RDataFrame(entries)
+        .Define("x", [](ULong64_t i) { return static_cast<int>(i); }, {"rdfentry_"})
+        .Snapshot("Events", files.back(), {"x"});
+  }
+  const std::string ttbarFloats = (root / "ttbar_floats.txt").string();
+  std::ofstream(ttbarFloats) << "xsec=2.5\n";
+  const std::string globalFloats = (root / "floats.txt").string();
+  std::ofstream(globalFloats) << "xsec=1.0\nlumi=3.0\n";
+  const std::string sampleConfig = (root / "samples.txt").string();
+  std::ofstream(sampleConfig) << "name=ttbar fileList=" << files[0] << "," << files[2]
+                              << " floatConfig=" << ttbarFloats << "\n"
+                              << "name=wjets fileList=" << files[1] << "\n";
+  const std::string configFile = (root / "config.txt").string();
+  std::ofstream(configFile) << "sampleConfig=" << sampleConfig << "\n"
+                            << "floatConfig=" << globalFloats << "\n"
+                            << "threads=1\nbatch=True\n";
+
+  ConfigurationManager config(configFile);
+  DataManager manager(config);
+  ASSERT_EQ(manager.samples().size(), 2u);
+  EXPECT_EQ(manager.samples().names(), (std::vector<std::string>{"ttbar", "wjets"}));
+  manager.registerConstants(config);
+  auto df = manager.getDataFrame();
+  EXPECT_EQ(*df.Count(), 35ULL);
+  auto ttbar = df.Filter([](Float_t index) { return index == 0.0f; }, {SampleSet::kIndexColumn});
+  auto wjets = df.Filter([](Float_t index) { return index == 1.0f; }, {SampleSet::kIndexColumn});
+  EXPECT_EQ(*ttbar.Count(), 15ULL);
+  EXPECT_EQ(*wjets.Count(), 20ULL);
+  EXPECT_FLOAT_EQ(*ttbar.Min<Float_t>("xsec"), 2.5f);
+  EXPECT_FLOAT_EQ(*wjets.Max<Float_t>("xsec"), 1.0f);
+  EXPECT_FLOAT_EQ(*df.Min<Float_t>("lumi"), 3.0f);
+
+  // A duplicate sample name is rejected.
+  std::ofstream(sampleConfig) << "name=ttbar fileList=" << files[0] << "\n"
+                              << "name=ttbar fileList=" << files[1] << "\n";
+  ConfigurationManager duplicate(configFile);
+  EXPECT_THROW(SampleSet::fromConfig(duplicate), std::runtime_error);
+
+  // So is a constant that is not a complete number.
+  std::ofstream(ttbarFloats) << "xsec=2.5pb\n";
+  std::ofstream(sampleConfig) << "name=ttbar fileList=" << files[0]
+                              << " floatConfig=" << ttbarFloats << "\n";
+  ConfigurationManager badConstant(configFile);
+  EXPECT_THROW(SampleSet::fromConfig(badConstant), std::runtime_error);
+
+  // Files are matched to their sample by URL, else by file name.
+  const SampleSet samples({{"ttbar", {files[0], files[2]}, {}, {}}, {"wjets", {files[1]}, {}, {}}});
+  EXPECT_EQ(samples.sampleOfFile(files[2]), 0);
+  EXPECT_EQ(samples.sampleOfFile("root://cache//store/b.root"), 1);
+  EXPECT_EQ(samples.sampleOfFile("d.root"), -1);
+
+  fs::remove_all(root);
+}
+
+/**
+ * @brief Lumi-section pre-skipping of real files keeps exactly the entries of
+ * certified sections, in every file of the chain.
+ */
+TEST(LumiSectionMaskTest, KeepsCertifiedSectionsOfEveryFile) {
+  namespace fs = std::filesystem;
+  const fs::path root = fs::temp_directory_path() /
+                        ("lumi_mask_test_" + std::to_string(getpid()));
+  fs::remove_all(root);
+  fs::create_directories(root);
+  // Two runs in two files, ten entries per lumi section.
+  std::vector<std::string> files;
+  for (const UInt_t run : {1u, 2u}) {
+    files.push_back((root / ("run" + std::to_string(run) + ".root")).string());
+    ROOT::RDataFrame(50)
+        .Define("run", [run]() { return run; })
+        .Define("luminosityBlock",
+                [](ULong64_t i) { return static_cast<UInt_t>(i / 10 + 1); }, {"rdfentry_"})
+        .Snapshot("Events", files.back(), {"run", "luminosityBlock"});
+  }
+  const std::string configFile = (root / "config.txt").string();
+  std::ofstream(configFile) << "fileList=" << files[0] << "," << files[1] << "\n"
+                            << "threads=1\nbatch=True\n";
+
+  ConfigurationManager config(configFile);
+  DataManager manager(config);
+  const auto isCertified = [](unsigned int run, unsigned int lumi) {
+    return (run == 1 && lumi == 2) || (run == 2 && lumi >= 4);
+  };
+  EXPECT_EQ(manager.applyLumiSectionMask(isCertified), 30);
+
+  auto df = manager.getDataFrame();
+  auto count = df.Count();
+  auto uncertified = df.Filter([&isCertified](UInt_t run, UInt_t lumi) {
+                         return !isCertified(run, lumi);
+                       }, {"run", "luminosityBlock"}).Count();
+  auto run2 = df.Filter([](UInt_t run) { return run == 2; }, {"run"}).Count();
+  EXPECT_EQ(*count, 30ULL);
+  EXPECT_EQ(*uncertified, 0ULL);
+  EXPECT_EQ(*run2, 20ULL);
+
+  fs::remove_all(root);
+}
+
+/**
+ * @brief Columns defined inside a GateScope are computed only where the gate
+ *        passes and are zero elsewhere.
+ */
+TEST(DataManagerGateTest, GatedColumnsSkipEntriesFailingTheGate) {
+  DataManager data(10);
+  SystematicManager systematics;
+  data.Define("pass_even", [](ULong64_t entry) { return entry % 2 == 0; }, {"rdfentry_"},
+              systematics);
+
+  std::atomic<int> calls{0};
+  {
+    DataManager::GateScope gate(&data, "pass_even");
+    data.Define("expensive",
+                [&calls](ULong64_t entry) {
+                  ++calls;
+                  return static_cast<float>(entry) + 1.0f;
+                },
+                {"rdfentry_"}, systematics);
+  }
+  data.Define("ungated", [](ULong64_t entry) { return static_cast<float>(entry); },
+              {"rdfentry_"}, systematics);
+
+  auto df = data.getDataFrame();
+  auto gatedSum = df.Sum<float>("expensive");
+  auto ungatedSum = df.Sum<float>("ungated");
+  EXPECT_FLOAT_EQ(*gatedSum, 1.0f + 3.0f + 5.0f + 7.0f + 9.0f);
+  EXPECT_FLOAT_EQ(*ungatedSum, 45.0f);
+  EXPECT_EQ(calls.load(), 5);
+}
+
+/**
+ * @brief Columns registered with gateColumns() are gated wherever they are
+ *        defined; a gate that is not defined yet is ignored.
+ */
+TEST(DataManagerGateTest, RegisteredColumnsAreGatedOutsideScope) {
+  DataManager data(4);
+  SystematicManager systematics;
+  data.gateColumns({"early", "late"}, "pass_first");
+
+  data.Define("early", [](ULong64_t entry) { return static_cast<int>(entry) + 1; },
+              {"rdfentry_"}, systematics);
+  data.Define("pass_first", [](ULong64_t entry) { return entry == 0; }, {"rdfentry_"},
+              systematics);
+  data.Define("late", [](ULong64_t entry) { return static_cast<int>(entry) + 1; },
+              {"rdfentry_"}, systematics);
+
+  EXPECT_EQ(data.defineGate("late"), "pass_first");
+  EXPECT_EQ(data.defineGate("other"), "");
+
+  auto df = data.getDataFrame();
+  auto earlySum = df.Sum<int>("early");
+  auto lateSum = df.Sum<int>("late");
+  EXPECT_EQ(*earlySum, 1 + 2 + 3 + 4);
+  EXPECT_EQ(*lateSum, 1);
+}
+
+/**
+ * @brief readSkimLayers attaches the base of an incremental skim, so columns
+ * the increment did not rewrite are read from the base.
+ */
+TEST(SkimLayerTest, IncrementalSkimReadsUnchangedColumnsFromBase) {
+  namespace fs = std::filesystem;
+  const fs::path root = fs::temp_directory_path() /
+                        ("skim_layer_test_" + std::to_string(getpid()));
+  fs::remove_all(root);
+  fs::create_directories(root);
+  const std::string baseFile = (root / "base.root").string();
+  const std::string deltaFile = (root / "delta.root").string();
+  // The increment stores its events in reverse order: the layers are matched
+  // on the index, not on the entry number.
+  ROOT::RDataFrame(10)
+      .Define("event", [](ULong64_t i) { return static_cast<int>(i); }, {"rdfentry_"})
+      .Define("a", [](ULong64_t i) { return static_cast<int>(100 + i); }, {"rdfentry_"})
+      .Define("b", [](ULong64_t i) { return static_cast<int>(200 + i); }, {"rdfentry_"})
+      .Snapshot("Events", baseFile, {"event", "a", "b"});
+  ROOT::RDataFrame(10)
+      .Define("event", [](ULong64_t i) { return static_cast<int>(9 - i); }, {"rdfentry_"})
+      .Define("b", [](ULong64_t i) { return static_cast<int>(309 - i); }, {"rdfentry_"})
+      .Snapshot("Events", deltaFile, {"event", "b"});
+
+  SkimColumnManifest base;
+  base.indexColumns = {"event"};
+  base.writtenColumns = {"event", "a", "b"};
+  base.columns["event"] = {"input", ""};
+  base.columns["a"] = {"analysis", ""};
+  base.columns["b"] = {"corrections", "h1"};
+  base.write(SkimColumnManifest::pathFor(baseFile));
+  SkimColumnManifest delta = base;
+  delta.base = "base.root"; // relative to the increment
+  delta.writtenColumns = {"event", "b"};
+  delta.columns["b"].hash = "h2";
+  delta.write(SkimColumnManifest::pathFor(deltaFile));
+
+  const std::string configFile = (root / "config.txt").string();
+  std::ofstream(configFile) << "fileList=" << deltaFile << "\n"
+                            << "threads=1\nbatch=True\n"
+                            << "readSkimLayers=true\n"
+                            << "incrementalSkimBase=" << deltaFile << "\n";
+
+  ConfigurationManager config(configFile);
+  DataManager manager(config);
+  EXPECT_EQ(manager.getIncrementalSkimBase(), deltaFile);
+  auto df = manager.getDataFrame();
+  auto rows = df.Take<int>("event");
+  auto a = df.Take<int>("a");
+  auto b = df.Take<int>("b");
+  ASSERT_EQ(rows->size(), 10u);
+  for (std::size_t i = 0; i < rows->size(); ++i) {
+    EXPECT_EQ((*a)[i], 100 + (*rows)[i]); // from the base
+    EXPECT_EQ((*b)[i], 300 + (*rows)[i]); // from the increment
+  }
+
+  fs::remove_all(root);
+}
+
 int main(int argc, char **argv) {
   ::testing::InitGoogleTest(&argc, argv);
   return RUN_ALL_TESTS();
@@ -0,0 +1,147 @@
+/**
+ * @file testDatasetOverlapManager.cc
+ * @brief Unit tests for DatasetOverlapManager – removing events owned by a
+ *        higher-priority primary dataset by trigger rule or event list.
+ */
+
+#include <ConfigurationManager.h>
+#include <DataManager.h>
+#include <DatasetOverlapManager.h>
+#include <DefaultLogger.h>
+#include <ManagerFactory.h>
+#include <NullOutputSink.h>
+#include <SystematicManager.h>
+#include <api/ManagerContext.h>
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <test_util.h>
+
+namespace {
+
+const std::string kVetoPath = "aux/test_dataset_overlap_veto.keys";
+const std::string kRecordPath = "aux/test_dataset_overlap_record.keys";
+
+} // namespace
+
+class DatasetOverlapManagerTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    ChangeToTestSourceDir();
+    config = ManagerFactory::createConfigurationManager(
+        "cfg/test_dataset_overlap_config.txt");
+    systematicManager = std::make_unique<SystematicManager>();
+    logger = std::make_unique<DefaultLogger>();
+    skimSink = std::make_unique<NullOutputSink>();
+    metaSink = std::make_unique<NullOutputSink>();
+  }
+
+  std::unique_ptr<DatasetOverlapManager> makeManager(DataManager &dm) {
+    auto mgr = std::make_unique<DatasetOverlapManager>();
+    ManagerContext ctx{*config, dm, *systematicManager, *logger, *skimSink, *metaSink};
+    mgr->setContext(ctx);
+    mgr->setupFromConfigFile();
+    return mgr;
+  }
+
+  /// Entry i fires HLT_DoubleMu for bit 0, HLT_SingleMu for bit 1 and
+  /// HLT_Ele for bit 2; HLT_DoubleMuMass is not in the input.
+  void defineEvents(DataManager &dm) {
+    dm.Define("HLT_DoubleMu", [](ULong64_t i) { return (i & 1) != 0; }, {"rdfentry_"},
+              *systematicManager);
+    dm.Define("HLT_SingleMu", [](ULong64_t i) { return (i & 2) != 0; }, {"rdfentry_"},
+              *systematicManager);
+    dm.Define("HLT_Ele", [](ULong64_t i) { return (i & 4) != 0; }, {"rdfentry_"},
+              *systematicManager);
+    dm.Define("run", [](ULong64_t) -> unsigned int { return 355100; }, {"rdfentry_"},
+              *systematicManager);
+    dm.Define("luminosityBlock", [](ULong64_t i) -> unsigned int { return 1 + i / 4; },
+              {"rdfentry_"}, *systematicManager);
+    dm.Define("event", [](ULong64_t i) -> ULong64_t { return 1000 + i; }, {"rdfentry_"},
+              *systematicManager);
+  }
+
+  std::unique_ptr<IConfigurationProvider> config;
+  std::unique_ptr<SystematicManager> systematicManager;
+  std::unique_ptr<DefaultLogger> logger;
+  std::unique_ptr<NullOutputSink> skimSink;
+  std::unique_ptr<NullOutputSink> metaSink;
+};
+
+TEST_F(DatasetOverlapManagerTest, ListsTriggersOfHigherPriorityDatasets) {
+  DataManager dm(0);
+  auto mgr = makeManager(dm);
+  EXPECT_TRUE(mgr->higherPriorityTriggers("DoubleMuon").empty());
+  EXPECT_EQ(mgr->higherPriorityTriggers("EGamma"),
+            (std::vector<std::string>{"HLT_DoubleMu", "HLT_DoubleMuMass", "HLT_SingleMu"}));
+  EXPECT_EQ(mgr->datasetTriggers("SingleMuon"), (std::vector<std::string>{"HLT_SingleMu"}));
+}
+
+TEST_F(DatasetOverlapManagerTest, KeepsEventsOwnedByTheDataset) {
+  DataManager dm(8);
+  defineEvents(dm);
+  auto mgr = makeManager(dm);
+  mgr->applyDatasetOverlap();
+
+  // SingleMuon keeps the entries firing HLT_SingleMu but not HLT_DoubleMu.
+  auto entries = dm.getDataFrame().Take<ULong64_t>("rdfentry_");
+  EXPECT_EQ(*entries, (std::vector<ULong64_t>{2, 6}));
+}
+
+TEST_F(DatasetOverlapManagerTest, VetoesAndRecordsEventKeys) {
+  DatasetOverlapManager::writeEventKeys(
+      kVetoPath, {DatasetOverlapManager::eventKey(355100, 2, 1006)});
+  config->set("datasetOverlapVeto", kVetoPath);
+  config->set("datasetOverlapRecord", kRecordPath);
+
+  DataManager dm(8);
+  defineEvents(dm);
+  auto mgr = makeManager(dm);
+  mgr->applyDatasetOverlap();
+  EXPECT_EQ(dm.getDataFrame().Count().GetValue(), 1ULL);
+  mgr->finalize();
+
+  EXPECT_EQ(DatasetOverlapManager::readEventKeys({kRecordPath}),
+            (std::vector<DatasetOverlapManager::EventKey>{
+                DatasetOverlapManager::eventKey(355100, 1, 1002)}));
+  std::remove(kVetoPath.c_str());
+  std::remove(kRecordPath.c_str());
+}
+
+TEST_F(DatasetOverlapManagerTest, VetoMatchesTheFullEventKey) {
+  // Same event number as entry 6 in another lumi block and run.
+  DatasetOverlapManager::writeEventKeys(kVetoPath,
+                                        {DatasetOverlapManager::eventKey(355100, 1, 1006),
+                                         DatasetOverlapManager::eventKey(355101, 2, 1006)});
+  config->set("datasetOverlapVeto", kVetoPath);
+
+  DataManager dm(8);
+  defineEvents(dm);
+  auto mgr = makeManager(dm);
+  mgr->applyDatasetOverlap();
+  auto entries = dm.getDataFrame().Take<ULong64_t>("rdfentry_");
+  EXPECT_EQ(*entries, (std::vector<ULong64_t>{2, 6}));
+  std::remove(kVetoPath.c_str());
+}
+
+TEST_F(DatasetOverlapManagerTest, DoesNothingForMC) {
+  config->set("type", "mc");
+  DataManager dm(8);
+  defineEvents(dm);
+  auto mgr = makeManager(dm);
+  mgr->applyDatasetOverlap();
+  EXPECT_EQ(dm.getDataFrame().Count().GetValue(), 8ULL);
+}
+
+TEST_F(DatasetOverlapManagerTest, RejectsUnlistedDatasetAndMalformedKeyFiles) {
+  config->set("primaryDataset", "MuonEG");
+  DataManager dm(8);
+  defineEvents(dm);
+  auto mgr = makeManager(dm);
+  EXPECT_THROW(mgr->applyDatasetOverlap(), std::runtime_error);
+
+  std::ofstream(kVetoPath, std::ios::binary) << "not a key file";
+  EXPECT_THROW(DatasetOverlapManager::readEventKeys({kVetoPath}), std::runtime_error);
+  std::remove(kVetoPath.c_str());
+}
@@ -0,0 +1,126 @@
+/**
+ * @file testFilePrefetcher.cc
+ * @brief Unit tests for FilePrefetcher – the rolling look-ahead window,
+ *        skipping of local and already opened files, and warm-up reads.
+ */
+
+#include <gtest/gtest.h>
+
+#include <FilePrefetcher.h>
+
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace {
+
+/// Records the prefetches instead of opening XRootD files.
+class RecordingPrefetcher : public FilePrefetcher {
+public:
+  using FilePrefetcher::FilePrefetcher;
+  ~RecordingPrefetcher() override { stop(); }
+
+  std::vector<std::string> opened() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return opens;
+  }
+  std::vector<std::string> warmed() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return warms;
+  }
+  std::vector<std::string> calls() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return log;
+  }
+
+protected:
+  void openAhead(const std::string &url) override {
+    std::lock_guard<std::mutex> lock(mutex);
+    opens.push_back(url);
+    log.push_back("open " + url);
+  }
+  Long64_t warm(const std::string &url, Long64_t bytes) override {
+    std::lock_guard<std::mutex> lock(mutex);
+    warms.push_back(url);
+    log.push_back("warm " + url);
+    return bytes;
+  }
+
+private:
+  std::mutex mutex;
+  std::vector<std::string> opens;
+  std::vector<std::string> warms;
+  std::vector<std::string> log;
+};
+
+std::vector<std::string> remoteFiles(int n) {
+  std::vector<std::string> files;
+  for (int i = 0; i < n; ++i) {
+    files.push_back("root://site.example.org//store/data/f" + std::to_string(i) + ".root");
+  }
+  return files;
+}
+
+} // namespace
+
+TEST(FilePrefetcherTest, WindowMovesWithTheCurrentFile) {
+  const auto files = remoteFiles(6);
+  RecordingPrefetcher prefetcher(files, 2, 0);
+
+  prefetcher.onFileStarted(files[0]);
+  prefetcher.wait();
+  EXPECT_EQ(prefetcher.opened(), (std::vector<std::string>{files[1], files[2]}));
+
+  prefetcher.onFileStarted(files[1]);
+  prefetcher.wait();
+  EXPECT_EQ(prefetcher.opened(), (std::vector<std::string>{files[1], files[2], files[3]}));
+  EXPECT_TRUE(prefetcher.warmed().empty());
+  EXPECT_EQ(prefetcher.prefetched(), 3u);
+}
+
+TEST(FilePrefetcherTest, EachFileIsQueuedOnceWhenSlotsStartFilesOutOfOrder) {
+  const auto files = remoteFiles(5);
+  RecordingPrefetcher prefetcher(files, 1, 0);
+
+  prefetcher.onFileStarted(files[2]);
+  prefetcher.onFileStarted(files[0]);
+  prefetcher.onFileStarted(files[3]);
+  prefetcher.onFileStarted(files[4]);
+  prefetcher.onFileStarted("root://site.example.org//store/data/unknown.root");
+  prefetcher.wait();
+
+  EXPECT_EQ(prefetcher.opened(), (std::vector<std::string>{files[3], files[4]}));
+}
+
+TEST(FilePrefetcherTest, SkipsLocalAndAlreadyOpenedFiles) {
+  std::vector<std::string> files = remoteFiles(4);
+  files[2] = "/tmp/staged.root";
+  RecordingPrefetcher prefetcher(files, 3, 0, 2);
+
+  prefetcher.onFileStarted(files[0]);
+  prefetcher.wait();
+
+  EXPECT_EQ(prefetcher.opened(), (std::vector<std::string>{files[3]}));
+}
+
+TEST(FilePrefetcherTest, WarmsEachPrefetchedFile) {
+  const auto files = remoteFiles(3);
+  RecordingPrefetcher prefetcher(files, 2, 4096);
+
+  prefetcher.onFileStarted(files[0]);
+  prefetcher.wait();
+
+  EXPECT_EQ(prefetcher.warmed(), (std::vector<std::string>{files[1], files[2]}));
+  EXPECT_EQ(prefetcher.warmedBytes(), 2 * 4096);
+}
+
+TEST(FilePrefetcherTest, StartsTheOpenAfterTheWarmUpRead) {
+  const auto files = remoteFiles(2);
+  RecordingPrefetcher prefetcher(files, 1, 4096);
+
+  prefetcher.onFileStarted(files[0]);
+  prefetcher.wait();
+
+  EXPECT_EQ(prefetcher.calls(),
+            (std::vector<std::string>{"warm " + files[1], "open " + files[1]}));
+}
@@ -0,0 +1,193 @@
+/**
+ * @file testFilterProfile.cc
+ * @brief Unit tests for FilterProfile – counting preselection filters per
+ *        slot, saving the profile and ordering filters from it, and the
+ *        order an Analyzer applies from a profile.
+ */
+
+#include <gtest/gtest.h>
+
+#include <DataManager.h>
+#include <FilterProfile.h>
+#include <SystematicManager.h>
+#include <analyzer.h>
+
+#include <TFile.h>
+#include <TTree.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <thread>
+
+namespace {
+
+const std::string kProfilePath =
+    std::string(TEST_SOURCE_DIR) + "/aux/test_filter_profile.json";
+
+FilterProfile::Stats stats(std::uint64_t calls, std::uint64_t passed,
+                           std::uint64_t nanoseconds) {
+  FilterProfile::Stats result;
+  result.calls = calls;
+  result.passed = passed;
+  result.nanoseconds = nanoseconds;
+  return result;
+}
+
+} // namespace
+
+TEST(FilterProfileTest, CountsCallsAndPassesOfAppliedFilters) {
+  DataManager data(100);
+  SystematicManager systematics;
+  FilterProfile profile(data.getDataFrame().GetNSlots());
+
+  data.Define("pass_even", [](ULong64_t entry) { return entry % 2 == 0; }, {"rdfentry_"},
+              systematics);
+  data.Define("pass_small", [](ULong64_t entry) { return entry < 10; }, {"rdfentry_"},
+              systematics);
+  data.Filter(profile.start(), {"rdfslot_"});
+  data.Filter(profile.wrap("pass_even"), {"rdfslot_", "pass_even"});
+  data.Filter(profile.wrap("pass_small"), {"rdfslot_", "pass_small"});
+
+  EXPECT_EQ(*data.getDataFrame().Count(), 5u);
+
+  const auto measured = profile.measured();
+  ASSERT_EQ(measured.size(), 2u);
+  EXPECT_EQ(measured.at("pass_even").calls, 100u);
+  EXPECT_EQ(measured.at("pass_even").passed, 50u);
+  // Only the events passing the first filter reach the second one.
+  EXPECT_EQ(measured.at("pass_small").calls, 50u);
+  EXPECT_EQ(measured.at("pass_small").passed, 5u);
+}
+
+TEST(FilterProfileTest, OrdersCheapRejectingFiltersFirst) {
+  const std::vector<std::string> names{"pass_mlScore", "pass_trigger", "pass_neverRejects"};
+  std::map<std::string, FilterProfile::Stats> profile;
+  profile["pass_mlScore"] = stats(1000, 500, 5000000);   // 5000 ns, rejects half
+  profile["pass_trigger"] = stats(1000, 100, 50000);     // 50 ns, rejects 90 %
+  profile["pass_neverRejects"] = stats(1000, 1000, 1000); // 1 ns, never rejects
+
+  const auto order = FilterProfile::order(names, profile);
+  ASSERT_EQ(order.size(), 3u);
+  EXPECT_EQ(order[0], 1u);
+  EXPECT_EQ(order[1], 0u);
+  EXPECT_EQ(order[2], 2u);
+}
+
+TEST(FilterProfileTest, KeepsDeclaredOrderWithoutCompleteProfile) {
+  const std::vector<std::string> names{"pass_a", "pass_b"};
+  std::map<std::string, FilterProfile::Stats> profile;
+  profile["pass_b"] = stats(10, 1, 10);
+  EXPECT_EQ(FilterProfile::order(names, profile), (std::vector<std::size_t>{0, 1}));
+
+  // A filter that was never reached has no usable measurement.
+  profile["pass_a"] = stats(0, 0, 0);
+  EXPECT_EQ(FilterProfile::order(names, profile), (std::vector<std::size_t>{0, 1}));
+}
+
+TEST(FilterProfileTest, WritesAndReadsProfile) {
+  std::remove(kProfilePath.c_str());
+  EXPECT_TRUE(FilterProfile::read(kProfilePath).empty());
+
+  DataManager data(20);
+  SystematicManager systematics;
+  FilterProfile profile(data.getDataFrame().GetNSlots());
+  data.Define("pass_low", [](ULong64_t entry) { return entry < 4; }, {"rdfentry_"},
+              systematics);
+  data.Define("pass_unreached", [](ULong64_t) { return true; }, {"rdfentry_"}, systematics);
+  data.Filter(profile.start(), {"rdfslot_"});
+  data.Filter(profile.wrap("pass_low"), {"rdfslot_", "pass_low"});
+  data.Filter([](ULong64_t) { return false; }, {"rdfentry_"});
+  data.Filter(profile.wrap("pass_unreached"), {"rdfslot_", "pass_unreached"});
+  EXPECT_EQ(*data.getDataFrame().Count(), 0u);
+
+  // The unreached filter keeps its previous counters.
+  std::map<std::string, FilterProfile::Stats> previous;
+  previous["pass_unreached"] = stats(7, 3, 70);
+  previous["pass_other"] = stats(1, 1, 1);
+  profile.write(kProfilePath, previous);
+
+  const auto read = FilterProfile::read(kProfilePath);
+  ASSERT_EQ(read.size(), 3u);
+  EXPECT_EQ(read.at("pass_low").calls, 20u);
+  EXPECT_EQ(read.at("pass_low").passed, 4u);
+  EXPECT_EQ(read.at("pass_unreached").calls, 7u);
+  EXPECT_EQ(read.at("pass_unreached").passed, 3u);
+  EXPECT_EQ(read.at("pass_unreached").nanoseconds, 70u);
+  EXPECT_EQ(read.at("pass_other").calls, 1u);
+
+  std::remove(kProfilePath.c_str());
+}
+
+TEST(FilterProfileTest, RejectsMalformedProfile) {
+  {
+    std::ofstream out(kProfilePath);
+    out << "{ filters: [unterminated";
+  }
+  EXPECT_THROW(FilterProfile::read(kProfilePath), std::runtime_error);
+  std::remove(kProfilePath.c_str());
+}
+
+// The cut reading an expensive column is cheap itself; the column is only
+// computed when the cut reads it, so its time belongs to the cut and the
+// next run applies the other cut first.
+TEST(FilterProfileTest, AnalyzerAppliesFiltersInProfiledOrder) {
+  const std::string input = std::string(TEST_SOURCE_DIR) + "/aux/filter_profile_input.root";
+  const std::string cfgPath = std::string(TEST_SOURCE_DIR) + "/aux/filter_profile_cfg.txt";
+  const std::string metaPath = std::string(TEST_SOURCE_DIR) + "/aux/filter_profile_meta.root";
+  std::remove(kProfilePath.c_str());
+  {
+    TFile file(input.c_str(), "RECREATE");
+    TTree tree("Events", "Events");
+    Int_t x = 0;
+    tree.Branch("x", &x, "x/I");
+    for (x = 0; x < 200; ++x) {
+      tree.Fill();
+    }
+    tree.Write();
+  }
+  {
+    std::ofstream out(cfgPath);
+    out << "fileList=" << input << "\n";
+    out << "threads=1\n";
+    out << "metaFile=" << metaPath << "\n";
+    out << "filterProfile=" << kProfilePath << "\n";
+  }
+
+  // Number of entries the expensive column is computed for.
+  const auto runJob = [&]() {
+    auto computed = std::make_shared<std::atomic<int>>(0);
+    Analyzer analyzer(cfgPath);
+    analyzer.Define("slowScore",
+                    [computed](Int_t x) {
+                      ++*computed;
+                      std::this_thread::sleep_for(std::chrono::microseconds(50));
+                      return static_cast<float>(x);
+                    },
+                    {"x"});
+    analyzer.beginPreselection()
+        ->Filter("lowScore", [](float score) { return score < 100.0f; }, {"slowScore"})
+        ->Filter("even", [](Int_t x) { return x % 2 == 0; }, {"x"})
+        ->endPreselection();
+    auto selected = analyzer.getDF().Count();
+    analyzer.run();
+    EXPECT_EQ(*selected, 50u);
+    return computed->load();
+  };
+
+  // Declared order: every entry reaches the expensive cut.
+  EXPECT_EQ(runJob(), 200);
+  const auto profile = FilterProfile::read(kProfilePath);
+  ASSERT_EQ(profile.size(), 2u);
+  EXPECT_GT(profile.at("pass_lowScore").costNs(), 10 * profile.at("pass_even").costNs());
+  // Profiled order: only the even entries do.
+  EXPECT_EQ(runJob(), 100);
+
+  std::remove(kProfilePath.c_str());
+  std::remove(input.c_str());
+  std::remove(cfgPath.c_str());
+  std::remove(metaPath.c_str());
+}
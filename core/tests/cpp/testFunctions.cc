@@ -0,0 +1,100 @@
+/**
+ * @file testFunctions.cc
+ * @brief Unit tests for the vectorized kinematic helpers in functions.h.
+ *
+ * Each whole-RVec kernel is checked against the scalar helper it replaces.
+ */
+
+#include <functions.h>
+#include <gtest/gtest.h>
+
+#include <ROOT/RVec.hxx>
+#include <cmath>
+
+using ROOT::VecOps::RVec;
+
+namespace {
+
+class VectorizedKinematicsTest : public ::testing::Test {
+protected:
+    RVec<Float_t> pt_   = {40.f, 25.f, 60.f, 15.f};
+    RVec<Float_t> eta_  = {0.3f, -1.2f, 2.1f, -0.4f};
+    RVec<Float_t> phi_  = {3.0f, -3.0f, 0.5f, -1.4f};
+    RVec<Float_t> mass_ = {4.f, 0.1f, 10.f, 0.f};
+    RVec<Float_t> lepEta_ = {0.35f, 2.0f};
+    RVec<Float_t> lepPhi_ = {-3.1f, 0.6f};
+};
+
+} // namespace
+
+TEST_F(VectorizedKinematicsTest, DeltaPhiAndDeltaRMatchScalar) {
+    RVec<Float_t> otherEta = {-0.3f, 1.0f, 2.0f, 0.4f};
+    RVec<Float_t> otherPhi = {-3.0f, 2.9f, 0.7f, 1.4f};
+    const auto dPhi = EvalDeltaPhiVec(phi_, otherPhi);
+    const auto dR = EvalDeltaRVec(eta_, phi_, otherEta, otherPhi);
+    ASSERT_EQ(dR.size(), 4u);
+    for (std::size_t i = 0; i < 4; ++i) {
+        EXPECT_NEAR(dPhi[i], EvalDeltaPhi<Float_t>(phi_[i], otherPhi[i]), 1e-5f);
+        EXPECT_NEAR(dR[i],
+                    EvalDeltaR<Float_t>(eta_[i], phi_[i], otherEta[i], otherPhi[i]),
+                    1e-5f);
+    }
+    EXPECT_THROW(EvalDeltaRVec(eta_, phi_, lepEta_, lepPhi_), std::runtime_error);
+}
+
+TEST_F(VectorizedKinematicsTest, DeltaRMatrixAndMinDeltaR) {
+    const auto matrix = EvalDeltaRMatrix(eta_, phi_, lepEta_, lepPhi_);
+    const auto closest = EvalMinDeltaR(eta_, phi_, lepEta_, lepPhi_);
+    ASSERT_EQ(matrix.size(), 8u);
+    ASSERT_EQ(closest.size(), 4u);
+    for (std::size_t i = 0; i < 4; ++i) {
+        Float_t best = 1e9f;
+        for (std::size_t j = 0; j < 2; ++j) {
+            const Float_t expected =
+                EvalDeltaR<Float_t>(eta_[i], phi_[i], lepEta_[j], lepPhi_[j]);
+            EXPECT_NEAR(matrix[i * 2 + j], expected, 1e-5f);
+            best = std::min(best, expected);
+        }
+        EXPECT_NEAR(closest[i], best, 1e-5f);
+    }
+    const auto noLeptons = EvalMinDeltaR(eta_, phi_, RVec<Float_t>{}, RVec<Float_t>{});
+    EXPECT_EQ(noLeptons, RVec<Float_t>(4, -9999.f));
+}
+
+TEST_F(VectorizedKinematicsTest, BulkCartesianComponentsMatchLorentzVector) {
+    const auto px = EvalPx(pt_, phi_);
+    const auto py = EvalPy(pt_, phi_);
+    const auto pz = EvalPz(pt_, eta_);
+    const auto e = EvalEnergy(pt_, eta_, mass_);
+    for (std::size_t i = 0; i < pt_.size(); ++i) {
+        const auto v = getPtEtaPhiMVector(pt_[i], eta_[i], phi_[i], mass_[i]);
+        EXPECT_NEAR(px[i], v.Px(), 1e-3f);
+        EXPECT_NEAR(py[i], v.Py(), 1e-3f);
+        EXPECT_NEAR(pz[i], v.Pz(), 1e-3f);
+        EXPECT_NEAR(e[i], v.E(), 1e-2f);
+    }
+}
+
+TEST_F(VectorizedKinematicsTest, PairMassesAndTotalSum) {
+    RVec<Int_t> first = {0, 1, 2, 0};
+    RVec<Int_t> second = {1, 3, 3, 9};
+    const auto masses = EvalPairMass(pt_, eta_, phi_, mass_, first, second);
+    ASSERT_EQ(masses.size(), 4u);
+    for (std::size_t k = 0; k < 3; ++k) {
+        const auto i = first[k], j = second[k];
+        const auto sum = sumLorentzVec(
+            getPtEtaPhiMVector(pt_[i], eta_[i], phi_[i], mass_[i]),
+            getPtEtaPhiMVector(pt_[j], eta_[j], phi_[j], mass_[j]));
+        EXPECT_NEAR(masses[k], sum.M(), 1e-2f * sum.M());
+    }
+    EXPECT_EQ(masses[3], -9999.f);
+
+    auto total = getPtEtaPhiMVector(pt_[0], eta_[0], phi_[0], mass_[0]);
+    for (std::size_t i = 1; i < pt_.size(); ++i) {
+        total = total + getPtEtaPhiMVector(pt_[i], eta_[i], phi_[i], mass_[i]);
+    }
+    const auto bulk = sumLorentzVecs(pt_, eta_, phi_, mass_);
+    EXPECT_NEAR(bulk.Px(), total.Px(), 1e-3f);
+    EXPECT_NEAR(bulk.Pz(), total.Pz(), 1e-2f);
+    EXPECT_NEAR(bulk.M(), total.M(), 1e-2f * total.M());
+}
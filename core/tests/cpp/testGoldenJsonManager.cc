@@ -18,6 +18,7 @@
 #include <gtest/gtest.h>
 #include <cstdio>
 #include <fstream>
+#include <functional>
 #include <stdexcept>
 #include <test_util.h>
 
@@ -192,6 +193,87 @@ TEST_F(GoldenJsonManagerTest, ApplyFiltersDataEvents) {
   EXPECT_EQ(count.GetValue(), 3ULL);
 }
 
+TEST_F(GoldenJsonManagerTest, ApplyHandlesRepeatedAndAlternatingLumis) {
+  // Runs of identical (run, lumi) pairs exercise the per-slot cache; the
+  // alternation between valid and invalid pairs checks that it is refreshed.
+  auto dm = std::make_unique<DataManager>(8);
+  auto mgr = makeManager(*configData, *dm);
+
+  dm->Define(
+      "run",
+      [](ULong64_t i) -> unsigned int { return i < 6 ? 355100 : 362760; },
+      {"rdfentry_"}, *systematicManager);
+  dm->Define(
+      "luminosityBlock",
+      [](ULong64_t i) -> unsigned int {
+        if (i < 3) return 50;   // valid
+        if (i < 5) return 101;  // gap
+        if (i == 5) return 50;  // valid again
+        return 700;             // merged range across the two files
+      },
+      {"rdfentry_"}, *systematicManager);
+
+  mgr->applyGoldenJson();
+
+  EXPECT_EQ(dm->getDataFrame().Count().GetValue(), 6ULL);
+}
+
+TEST_F(GoldenJsonManagerTest, ApplyWithPreSkipKeepsPerEventFilter) {
+  // With goldenJsonPreSkip=true but no input chain, pre-skipping cannot be
+  // applied and the per-event filter alone must give the same result.
+  auto configPreSkip = ManagerFactory::createConfigurationManager(
+      "cfg/test_golden_json_config_preskip.txt");
+  auto dm = std::make_unique<DataManager>(4);
+  auto mgr = makeManager(*configPreSkip, *dm);
+
+  dm->Define(
+      "run", [](ULong64_t i) -> unsigned int { return i < 2 ? 355100 : 999999; },
+      {"rdfentry_"}, *systematicManager);
+  dm->Define(
+      "luminosityBlock", [](ULong64_t) -> unsigned int { return 10; },
+      {"rdfentry_"}, *systematicManager);
+
+  mgr->applyGoldenJson();
+
+  EXPECT_EQ(dm->getDataFrame().Count().GetValue(), 2ULL);
+}
+
+TEST_F(GoldenJsonManagerTest, PreSkipGoesThroughTheProviderInterface) {
+  // A provider overriding the lumi-mask hook receives the certified mask.
+  struct RecordingDataManager : DataManager {
+    using DataManager::DataManager;
+    Long64_t applyLumiSectionMask(
+        const std::function<bool(unsigned int, unsigned int)> &isCertified,
+        const std::string &, const std::string &) override {
+      ++calls;
+      certified = isCertified(355100, 10);
+      uncertified = !isCertified(999999, 10);
+      return -1;
+    }
+    int calls = 0;
+    bool certified = false;
+    bool uncertified = false;
+  };
+  auto configPreSkip = ManagerFactory::createConfigurationManager(
+      "cfg/test_golden_json_config_preskip.txt");
+  RecordingDataManager dm(4);
+  auto mgr = makeManager(*configPreSkip, dm);
+
+  dm.Define(
+      "run", [](ULong64_t i) -> unsigned int { return i < 2 ? 355100 : 999999; },
+      {"rdfentry_"}, *systematicManager);
+  dm.Define(
+      "luminosityBlock", [](ULong64_t) -> unsigned int { return 10; },
+      {"rdfentry_"}, *systematicManager);
+
+  mgr->applyGoldenJson();
+
+  EXPECT_EQ(dm.calls, 1);
+  EXPECT_TRUE(dm.certified);
+  EXPECT_TRUE(dm.uncertified);
+  EXPECT_EQ(dm.getDataFrame().Count().GetValue(), 2ULL);
+}
+
 // ---------------------------------------------------------------------------
 // applyGoldenJson() – MC sample (filter must be skipped)
 // ---------------------------------------------------------------------------
@@ -0,0 +1,263 @@
+/**
+ * @file testGpuPipeline.cc
+ * @brief Unit tests for GpuPipeline – the fused JES, working-point, weight
+ *        and histogram stages (host implementation, and the device one when
+ *        built with CUDA).
+ */
+
+#include <gtest/gtest.h>
+
+#include <ConfigurationManager.h>
+#include <DataManager.h>
+#include <DefaultLogger.h>
+#include <GpuPipeline.h>
+#include <ManagerFactory.h>
+#include <NullOutputSink.h>
+#include <SystematicManager.h>
+#include <api/ManagerContext.h>
+#include <test_util.h>
+
+#include <TH2D.h>
+
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+ROOT::RDF::RNode makeFrame() {
+  ROOT::RDF::RNode df = ROOT::RDataFrame(11);
+  return df
+      .Define("Jet_pt",
+              [](ULong64_t entry) {
+                ROOT::VecOps::RVec<float> pt;
+                for (ULong64_t j = 0; j < entry % 4; ++j) pt.push_back(5.f + 40.f * j + entry);
+                return pt;
+              },
+              {"rdfentry_"})
+      .Define("Jet_eta",
+              [](ULong64_t entry) {
+                ROOT::VecOps::RVec<double> eta;
+                for (ULong64_t j = 0; j < entry % 4; ++j) eta.push_back((j % 2 ? -1.0 : 1.0) * 0.7);
+                return eta;
+              },
+              {"rdfentry_"})
+      .Define("Jet_score",
+              [](ULong64_t entry) {
+                ROOT::VecOps::RVec<float> score;
+                for (ULong64_t j = 0; j < entry % 4; ++j) score.push_back(((j + entry) % 5) * 0.2f);
+                return score;
+              },
+              {"rdfentry_"})
+      .Define("genWeight", [](ULong64_t entry) { return 0.5 + entry; }, {"rdfentry_"})
+      .Define("puWeight", [](ULong64_t entry) { return entry % 2 ? 2.f : 0.5f; }, {"rdfentry_"});
+}
+
+GpuPipeline::Config makeConfig() {
+  GpuPipeline::Config config;
+  config.jetPt = "Jet_pt";
+  config.jetEta = "Jet_eta";
+  config.jetScore = "Jet_score";
+  config.weights = {"genWeight", "puWeight"};
+  // Negative eta: 1.0 at 10 GeV to 1.2 at 100 GeV; positive eta: 0.9.
+  config.jes = GpuPipeline::CorrectionGrid{{-5.f, 0.f, 5.f}, {10.f, 100.f}, {1.0f, 1.2f, 0.9f, 0.9f}};
+  config.wpThresholds = {0.3f, 0.5f, 0.7f};
+  config.ptBins = 10;
+  config.ptMin = 0.0;
+  config.ptMax = 150.0;
+  config.blockSize = 3;
+  config.device = GpuPipeline::deviceSupport();
+  return config;
+}
+
+/// The correction of makeConfig(), computed directly.
+double expectedScale(double eta, double pt) {
+  if (eta >= 0.0) return 0.9;
+  const double t = std::log(pt / 10.0) / std::log(10.0);
+  return t <= 0.0 ? 1.0 : (t >= 1.0 ? 1.2 : 1.0 + 0.2 * t);
+}
+
+int expectedCategory(float score) {
+  return score >= 0.7f ? 3 : (score >= 0.5f ? 2 : (score >= 0.3f ? 1 : 0));
+}
+
+} // namespace
+
+TEST(GpuPipelineTest, MatchesADirectComputation) {
+  GpuPipeline pipeline(makeConfig());
+  auto df = pipeline.book(makeFrame().Filter([](ULong64_t entry) { return entry != 4; },
+                                             {"rdfentry_"}));
+
+  auto pt = df.Take<ROOT::VecOps::RVec<float>>("Jet_pt");
+  auto eta = df.Take<ROOT::VecOps::RVec<double>>("Jet_eta");
+  auto score = df.Take<ROOT::VecOps::RVec<float>>("Jet_score");
+  auto gen = df.Take<double>("genWeight");
+  auto pu = df.Take<float>("puWeight");
+  auto correctedPt = df.Take<ROOT::VecOps::RVec<Float_t>>("GpuPipeline_jetPt");
+  auto category = df.Take<ROOT::VecOps::RVec<Int_t>>("GpuPipeline_jetCategory");
+  auto weight = df.Take<double>("GpuPipeline_weight");
+  ASSERT_EQ(weight->size(), 10u);
+
+  TH2D expected("expected", "", 10, 0.0, 150.0, 4, -0.5, 3.5);
+  expected.Sumw2();
+  for (std::size_t i = 0; i < weight->size(); ++i) {
+    const double w = (*gen)[i] * (*pu)[i];
+    EXPECT_NEAR((*weight)[i], w, 1e-6 * w);
+    ASSERT_EQ((*correctedPt)[i].size(), (*pt)[i].size());
+    ASSERT_EQ((*category)[i].size(), (*pt)[i].size());
+    for (std::size_t j = 0; j < (*pt)[i].size(); ++j) {
+      const double corrected = (*pt)[i][j] * expectedScale((*eta)[i][j], (*pt)[i][j]);
+      EXPECT_NEAR((*correctedPt)[i][j], corrected, 1e-4 * corrected);
+      EXPECT_EQ((*category)[i][j], expectedCategory((*score)[i][j]));
+      expected.Fill(corrected, expectedCategory((*score)[i][j]), w);
+    }
+  }
+
+  const auto hist = pipeline.histogram("jets");
+  // The pipeline ran in the event loop of the Take()s.
+  EXPECT_EQ(df.GetNRuns(), 1u);
+  ASSERT_EQ(hist->GetNcells(), expected.GetNcells());
+  for (Int_t bin = 0; bin < expected.GetNcells(); ++bin) {
+    EXPECT_NEAR(hist->GetBinContent(bin), expected.GetBinContent(bin), 1e-6) << "bin " << bin;
+    EXPECT_NEAR(hist->GetBinError(bin), expected.GetBinError(bin), 1e-6) << "bin " << bin;
+  }
+}
+
+TEST(GpuPipelineTest, BookingAgainReplacesTheHistogram) {
+  GpuPipeline pipeline(makeConfig());
+  EXPECT_THROW(pipeline.histogram("none"), std::runtime_error);
+  pipeline.book(makeFrame());
+  const double first = pipeline.histogram("first")->GetSumOfWeights();
+  EXPECT_GT(first, 0.0);
+  pipeline.book(makeFrame());
+  EXPECT_DOUBLE_EQ(pipeline.histogram("second")->GetSumOfWeights(), first);
+}
+
+TEST(GpuPipelineTest, KeepsDoubleWeights) {
+  GpuPipeline::Config config = makeConfig();
+  config.weights = {"tiny"};
+  GpuPipeline pipeline(config);
+  // 1 + 1e-12 is 1 in float.
+  auto df = pipeline.book(makeFrame().Define("tiny", [] { return 1.0 + 1e-12; }));
+  auto weight = df.Take<double>("GpuPipeline_weight");
+  for (const double w : *weight) {
+    EXPECT_EQ(w, 1.0 + 1e-12);
+  }
+  const auto hist = pipeline.histogram("jets");
+  double jets = 0.0;
+  for (Int_t bin = 0; bin < hist->GetNcells(); ++bin) {
+    jets += hist->GetBinContent(bin);
+  }
+  // 0 + 1 + 2 + 3 + 0 + 1 + 2 + 3 + 0 + 1 + 2 jets, each of weight 1 + 1e-12.
+  EXPECT_NEAR(jets, 15.0 * (1.0 + 1e-12), 1e-14);
+  EXPECT_NE(jets, 15.0);
+}
+
+TEST(GpuPipelineTest, RejectsJetColumnsOfDifferentLengths) {
+  GpuPipeline::Config config = makeConfig();
+  config.jetScore = "short";
+  GpuPipeline pipeline(config);
+  auto df = makeFrame().Define("short", [] { return ROOT::VecOps::RVec<float>{0.5f}; });
+  pipeline.book(df);
+  EXPECT_THROW(pipeline.histogram("jets"), std::runtime_error);
+
+  GpuPipeline::Config scalar = makeConfig();
+  scalar.jetEta = "genWeight";
+  GpuPipeline other(scalar);
+  EXPECT_THROW(other.book(makeFrame()), std::runtime_error);
+}
+
+TEST(GpuPipelineTest, ValidatesTheConfiguration) {
+  GpuPipeline::Config config = makeConfig();
+  config.jes.values.pop_back();
+  EXPECT_THROW(GpuPipeline{config}, std::runtime_error);
+
+  config = makeConfig();
+  config.jes.ptNodes = {100.f, 10.f};
+  EXPECT_THROW(GpuPipeline{config}, std::runtime_error);
+
+  config = makeConfig();
+  config.wpThresholds = {0.5f, 0.3f};
+  EXPECT_THROW(GpuPipeline{config}, std::runtime_error);
+
+  config = makeConfig();
+  config.ptMax = config.ptMin;
+  EXPECT_THROW(GpuPipeline{config}, std::runtime_error);
+
+#ifndef USE_CUDA
+  config = makeConfig();
+  config.device = true;
+  EXPECT_THROW(GpuPipeline{config}, std::runtime_error);
+#endif
+}
+
+TEST(GpuPipelineTest, TabulatesACorrectionChain) {
+  auto cset = correction::CorrectionSet::from_file("aux/mock_jet_jerc.json");
+  const auto grid = GpuPipeline::CorrectionGrid::tabulate(
+      {cset->at("Summer22_22Sep2023_V3_MC_L1FastJet_AK4PFPuppi"),
+       cset->at("Summer22_22Sep2023_V3_MC_L2Relative_AK4PFPuppi"),
+       cset->at("Summer22_22Sep2023_V3_MC_L3Absolute_AK4PFPuppi")},
+      "JetEta", "JetPt", {-5.f, 0.f, 5.f}, {15.f, 50.f, 500.f},
+      {{"JetArea", 0.5}, {"Rho", 20.0}});
+  ASSERT_EQ(grid.values.size(), 6u);
+  for (const float value : grid.values) {
+    EXPECT_NEAR(value, 1.05 * 0.98, 1e-6);
+  }
+
+  EXPECT_THROW(GpuPipeline::CorrectionGrid::tabulate(
+                   {cset->at("Summer22_22Sep2023_V3_MC_L1FastJet_AK4PFPuppi")}, "JetEta",
+                   "JetPt", {-5.f, 5.f}, {15.f}, {{"JetArea", 0.5}}),
+               std::runtime_error);
+}
+
+TEST(GpuPipelineTest, RunsAsAPluginFromTheConfiguration) {
+  ChangeToTestSourceDir();
+  auto config = ManagerFactory::createConfigurationManager("cfg/test_data_config_minimal.txt");
+  config->set("gpuPipelineJetPt", "Jet_pt");
+  config->set("gpuPipelineJetEta", "Jet_eta");
+  config->set("gpuPipelineJetScore", "Jet_score");
+  config->set("gpuPipelineWeights", "genWeight,puWeight");
+  config->set("gpuPipelineWpThresholds", "0.3,0.5,0.7");
+  config->set("gpuPipelinePtBins", "10");
+  config->set("gpuPipelinePtMax", "150");
+  config->set("gpuPipelineBlockSize", "4");
+  config->set("gpuPipelineDevice", GpuPipeline::deviceSupport() ? "true" : "false");
+  SystematicManager systematics;
+  DefaultLogger logger;
+  NullOutputSink skimSink;
+  NullOutputSink metaSink;
+  DataManager dm(0);
+  dm.setDataFrame(makeFrame());
+  ManagerContext ctx{*config, dm, systematics, logger, skimSink, metaSink};
+
+  // The reference: the same pipeline configured in code.
+  GpuPipeline::Config reference = makeConfig();
+  reference.jes = GpuPipeline::CorrectionGrid::identity();
+  GpuPipeline direct(reference);
+  direct.book(makeFrame());
+
+  // The keys replace every column, threshold and binning setting.
+  GpuPipeline::Config placeholder = reference;
+  placeholder.jetPt = placeholder.jetEta = placeholder.jetScore = "missing";
+  placeholder.weights.clear();
+  placeholder.wpThresholds.clear();
+  placeholder.ptBins = 1;
+  placeholder.ptMax = 1.0;
+  placeholder.blockSize = 1;
+  auto plugin = std::make_shared<GpuPipeline>(placeholder);
+  plugin->setContext(ctx);
+  plugin->setupFromConfigFile();
+  plugin->execute();
+  plugin->execute();
+  auto weight = dm.getDataFrame().Sum<double>("GpuPipeline_weight");
+  EXPECT_GT(*weight, 0.0);
+  const auto hist = plugin->histogram("plugin");
+  const auto expected = direct.histogram("direct");
+  for (Int_t bin = 0; bin < expected->GetNcells(); ++bin) {
+    EXPECT_NEAR(hist->GetBinContent(bin), expected->GetBinContent(bin), 1e-9) << "bin " << bin;
+  }
+
+  config->set("gpuPipelineBlockSize", "many");
+  EXPECT_THROW(plugin->setupFromConfigFile(), std::runtime_error);
+}
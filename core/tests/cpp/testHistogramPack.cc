@@ -0,0 +1,159 @@
+/**
+ * @file testHistogramPack.cc
+ * @brief Unit tests for HistogramPack – round trips through the binary
+ *        format, streaming merges and conversion back to ROOT histograms.
+ */
+
+#include <gtest/gtest.h>
+
+#include <HistogramPack.h>
+
+#include <TFile.h>
+#include <TH1F.h>
+#include <TH2D.h>
+#include <THnSparse.h>
+
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+const std::string kDir = std::string(TEST_SOURCE_DIR) + "/aux/histogram_pack";
+
+/// One job output: a filled TH1F with the given bin content.
+TH1F jobHistogram(double content) {
+  TH1F hist("mass", "", 4, 0.0, 4.0);
+  hist.SetDirectory(nullptr);
+  hist.SetBinContent(2, content);
+  hist.SetBinError(2, 0.5 * content);
+  hist.SetBinContent(5, 1.0); // overflow
+  return hist;
+}
+
+class HistogramPackTest : public ::testing::Test {
+protected:
+  void SetUp() override { std::filesystem::create_directories(kDir); }
+  void TearDown() override { std::filesystem::remove_all(kDir); }
+};
+
+} // namespace
+
+TEST_F(HistogramPackTest, StoresFilledBinsWithSharedSchemas) {
+  HistogramPack pack;
+  pack.add("Nominal/mass", jobHistogram(2.0));
+  pack.add("Nominal_SR/mass", jobHistogram(3.0));
+
+  ASSERT_EQ(pack.schemas().size(), 1u);
+  ASSERT_EQ(pack.histograms().size(), 2u);
+  const auto &hist = pack.histograms()[0];
+  EXPECT_EQ(hist.bins, (std::vector<std::uint64_t>{2, 5}));
+  EXPECT_DOUBLE_EQ(hist.sums[0], 2.0);
+  EXPECT_DOUBLE_EQ(hist.sumw2[0], 1.0);
+  EXPECT_THROW(pack.add("Nominal/mass", jobHistogram(1.0)), std::runtime_error);
+}
+
+TEST_F(HistogramPackTest, RoundTripsThroughTheFile) {
+  HistogramPack pack;
+  pack.add("Nominal/mass", jobHistogram(2.0));
+  TH2D hist2("pt_eta", "", 3, 0.0, 3.0, 2, -1.0, 1.0);
+  hist2.SetDirectory(nullptr);
+  hist2.Fill(1.5, 0.5, 2.0);
+  pack.add("pt_eta", hist2);
+
+  const std::string path = kDir + "/job.rdfh";
+  pack.write(path);
+  const HistogramPack read = HistogramPack::read(path);
+
+  ASSERT_EQ(read.histograms().size(), 2u);
+  EXPECT_EQ(read.schemas(), pack.schemas());
+  for (std::size_t i = 0; i < 2; ++i) {
+    EXPECT_EQ(read.histograms()[i].name, pack.histograms()[i].name);
+    EXPECT_EQ(read.histograms()[i].bins, pack.histograms()[i].bins);
+    EXPECT_EQ(read.histograms()[i].sums, pack.histograms()[i].sums);
+    EXPECT_EQ(read.histograms()[i].sumw2, pack.histograms()[i].sumw2);
+  }
+}
+
+TEST_F(HistogramPackTest, MergeAddsSortedBins) {
+  HistogramPack a;
+  a.add("Nominal/mass", jobHistogram(2.0));
+  HistogramPack b;
+  TH1F other = jobHistogram(3.0);
+  other.SetBinContent(1, 4.0);
+  b.add("Nominal/mass", other);
+  b.add("Nominal/extra", jobHistogram(1.0));
+
+  a.merge(b);
+  ASSERT_EQ(a.histograms().size(), 2u);
+  const auto &mass = a.histograms()[0];
+  EXPECT_EQ(mass.bins, (std::vector<std::uint64_t>{1, 2, 5}));
+  EXPECT_DOUBLE_EQ(mass.sums[0], 4.0);
+  EXPECT_DOUBLE_EQ(mass.sums[1], 5.0);
+  EXPECT_DOUBLE_EQ(mass.sumw2[1], 1.0 + 2.25);
+  EXPECT_DOUBLE_EQ(mass.sums[2], 2.0);
+  EXPECT_EQ(a.histograms()[1].name, "Nominal/extra");
+
+  HistogramPack rebinned;
+  rebinned.add("Nominal/mass", TH1F("mass", "", 8, 0.0, 4.0));
+  EXPECT_THROW(a.merge(rebinned), std::runtime_error);
+}
+
+TEST_F(HistogramPackTest, ScaleMultipliesSumsAndSquares) {
+  HistogramPack pack;
+  pack.add("Nominal/mass", jobHistogram(2.0));
+  pack.scale(3.0);
+
+  const auto &hist = pack.histograms()[0];
+  EXPECT_DOUBLE_EQ(hist.sums[0], 6.0);
+  EXPECT_DOUBLE_EQ(hist.sumw2[0], 9.0);
+  EXPECT_DOUBLE_EQ(hist.sums[1], 3.0);
+}
+
+TEST_F(HistogramPackTest, MergeFilesWritesRootHistograms) {
+  std::vector<std::string> inputs;
+  for (int job = 0; job < 3; ++job) {
+    HistogramPack pack;
+    pack.add("Nominal/mass", jobHistogram(job + 1.0));
+    inputs.push_back(kDir + "/job_" + std::to_string(job) + ".rdfh");
+    pack.write(inputs.back());
+  }
+  const std::string output = kDir + "/merged.root";
+  HistogramPack::mergeFiles(output, inputs);
+
+  TFile file(output.c_str(), "READ");
+  auto *hist = file.Get<TH1F>("Nominal/mass");
+  ASSERT_NE(hist, nullptr);
+  EXPECT_DOUBLE_EQ(hist->GetBinContent(2), 6.0);
+  EXPECT_NEAR(hist->GetBinError(2), std::sqrt(0.25 + 1.0 + 2.25), 1e-6);
+  EXPECT_DOUBLE_EQ(hist->GetBinContent(5), 3.0);
+}
+
+TEST_F(HistogramPackTest, ConvertsSparseHistograms) {
+  const Int_t nbins[2] = {4, 3};
+  const Double_t xmin[2] = {0.0, 0.0};
+  const Double_t xmax[2] = {4.0, 3.0};
+  THnSparseF sparse("h", "", 2, nbins, xmin, xmax);
+  sparse.Sumw2();
+  const Double_t x[2] = {2.5, 1.5};
+  sparse.Fill(x, 3.0);
+
+  HistogramPack pack;
+  pack.add("Nominal/h", sparse);
+  ASSERT_EQ(pack.histograms()[0].bins, (std::vector<std::uint64_t>{3 + 6 * 2}));
+
+  const auto back = pack.toTHnSparse(pack.histograms()[0]);
+  const Int_t coords[2] = {3, 2};
+  EXPECT_DOUBLE_EQ(back->GetBinContent(coords), 3.0);
+  EXPECT_THROW(pack.toTH1(pack.histograms()[0]), std::runtime_error);
+}
+
+TEST_F(HistogramPackTest, RejectsOtherFiles) {
+  const std::string path = kDir + "/not_a_pack.rdfh";
+  std::ofstream(path) << "ROOT file";
+  EXPECT_THROW(HistogramPack::read(path), std::runtime_error);
+}
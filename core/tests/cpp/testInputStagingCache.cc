@@ -0,0 +1,152 @@
+/**
+ * @file testInputStagingCache.cc
+ * @brief Unit tests for InputStagingCache – content-addressed entries, LRU
+ *        eviction under the size limit, pinning of staged entries and
+ *        fallbacks to the remote URL.
+ */
+
+#include <gtest/gtest.h>
+
+#include <InputStagingCache.h>
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <string>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+/// Serves "remote" files from an in-memory map instead of XRootD.
+class FakeRemoteCache : public InputStagingCache {
+public:
+  using InputStagingCache::InputStagingCache;
+
+  std::map<std::string, std::string> contents;
+  unsigned int copies = 0;
+
+protected:
+  bool copyFile(const std::string &source, const std::string &destination) override {
+    const auto it = contents.find(source);
+    if (it == contents.end()) {
+      return false;
+    }
+    std::ofstream out(destination, std::ios::binary);
+    out << it->second;
+    ++copies;
+    return true;
+  }
+};
+
+const std::string kFileA = "root://site-a.example.org//store/data/a.root";
+const std::string kFileAOtherSite = "root://site-b.example.org//store/data/a.root";
+const std::string kFileB = "root://site-a.example.org//store/data/b.root";
+const std::string kFileC = "root://site-a.example.org//store/data/c.root";
+
+} // namespace
+
+class InputStagingCacheTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    directory = (fs::temp_directory_path() / "input_staging_cache_test").string();
+    fs::remove_all(directory);
+  }
+  void TearDown() override { fs::remove_all(directory); }
+
+  std::string directory;
+};
+
+TEST_F(InputStagingCacheTest, DetectsRemoteUrls) {
+  EXPECT_TRUE(InputStagingCache::isRemote(kFileA));
+  EXPECT_TRUE(InputStagingCache::isRemote("https://example.org/file.root"));
+  EXPECT_FALSE(InputStagingCache::isRemote("/data/file.root"));
+  EXPECT_FALSE(InputStagingCache::isRemote("file:///data/file.root"));
+}
+
+TEST_F(InputStagingCacheTest, CopiesOnceAndServesRereadsLocally) {
+  FakeRemoteCache cache(directory, 1024);
+  cache.contents[kFileA] = std::string(100, 'a');
+  cache.contents[kFileAOtherSite] = std::string(100, 'a');
+
+  const std::string first = cache.stage(kFileA);
+  EXPECT_EQ(first, cache.entryPath(kFileA));
+  EXPECT_TRUE(fs::exists(first));
+  EXPECT_EQ(cache.misses(), 1u);
+
+  // The same logical file through another redirector is the same entry.
+  EXPECT_EQ(cache.stage(kFileAOtherSite), first);
+  EXPECT_EQ(cache.copies, 1u);
+  EXPECT_EQ(cache.hits(), 1u);
+
+  // A second cache object (another job) on the same directory reuses it.
+  FakeRemoteCache other(directory, 1024);
+  EXPECT_EQ(other.stage(kFileA), first);
+  EXPECT_EQ(other.copies, 0u);
+}
+
+TEST_F(InputStagingCacheTest, EvictsLeastRecentlyUsedEntries) {
+  const std::map<std::string, std::string> contents = {
+      {kFileA, std::string(100, 'a')},
+      {kFileB, std::string(100, 'b')},
+      {kFileC, std::string(100, 'c')}};
+  {
+    FakeRemoteCache previousJob(directory, 250);
+    previousJob.contents = contents;
+    previousJob.stage(kFileA);
+    previousJob.stage(kFileB);
+  }
+  // Make A the most recently used entry.
+  fs::last_write_time(fs::path(directory) / (InputStagingCache::cacheKey(kFileB) + ".root"),
+                      fs::file_time_type::clock::now() - std::chrono::hours(1));
+
+  FakeRemoteCache cache(directory, 250);
+  cache.contents = contents;
+  cache.stage(kFileA);
+  cache.stage(kFileC);
+  EXPECT_TRUE(fs::exists(cache.entryPath(kFileA)));
+  EXPECT_FALSE(fs::exists(cache.entryPath(kFileB)));
+  EXPECT_TRUE(fs::exists(cache.entryPath(kFileC)));
+  EXPECT_LE(cache.cachedBytes(), 250);
+
+  // The lock file goes with the evicted entry.
+  EXPECT_FALSE(fs::exists(fs::path(directory) / (InputStagingCache::cacheKey(kFileB) + ".lock")));
+  EXPECT_TRUE(fs::exists(fs::path(directory) / (InputStagingCache::cacheKey(kFileC) + ".lock")));
+}
+
+TEST_F(InputStagingCacheTest, KeepsEntriesPinnedByARunningJob) {
+  auto runningJob = std::make_unique<FakeRemoteCache>(directory, 250);
+  runningJob->contents[kFileA] = std::string(100, 'a');
+  runningJob->contents[kFileB] = std::string(100, 'b');
+  runningJob->contents[kFileC] = std::string(100, 'c');
+  const std::string stagedA = runningJob->stage(kFileA);
+  const std::string stagedB = runningJob->stage(kFileB);
+
+  // Making room would delete files the running job staged but has not opened
+  // yet, so the third file is read remotely, by this job or another one.
+  EXPECT_EQ(runningJob->stage(kFileC), kFileC);
+  FakeRemoteCache otherJob(directory, 250);
+  otherJob.contents[kFileC] = std::string(100, 'c');
+  EXPECT_EQ(otherJob.stage(kFileC), kFileC);
+  EXPECT_TRUE(fs::exists(stagedA));
+  EXPECT_TRUE(fs::exists(stagedB));
+  EXPECT_FALSE(fs::exists(otherJob.entryPath(kFileC)));
+
+  // Once the running job ends its entries become evictable.
+  runningJob.reset();
+  EXPECT_EQ(otherJob.stage(kFileC), otherJob.entryPath(kFileC));
+  EXPECT_LE(otherJob.cachedBytes(), 250);
+}
+
+TEST_F(InputStagingCacheTest, FallsBackToRemoteUrl) {
+  FakeRemoteCache cache(directory, 50);
+  cache.contents[kFileA] = std::string(100, 'a');
+
+  // Larger than the whole cache.
+  EXPECT_EQ(cache.stage(kFileA), kFileA);
+  // Copy failure.
+  EXPECT_EQ(cache.stage(kFileB), kFileB);
+  EXPECT_EQ(cache.cachedBytes(), 0);
+}
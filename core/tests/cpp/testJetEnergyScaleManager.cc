@@ -17,6 +17,7 @@
 #include <PhysicsObjectCollection.h>
 #include <SystematicManager.h>
 #include <api/ManagerContext.h>
+#include <algorithm>
 #include <gtest/gtest.h>
 #include <stdexcept>
 #include <test_util.h>
@@ -460,6 +461,44 @@ TEST_F(JetEnergyScaleManagerTest, ChainedCorrectionStepsApplySequentially) {
     EXPECT_FLOAT_EQ(massJesUp.GetValue()[0][0], 0.5f);
   }
 
+TEST_F(JetEnergyScaleManagerTest, FusedCorrectionChainMatchesSequentialSteps) {
+  auto dm = std::make_unique<DataManager>(1);
+  auto mgr = makeMgr(*dm);
+  auto cm = std::make_unique<CorrectionManager>(*config);
+  auto ctx = makeContext(*config, *dm, *systematicManager, *logger,
+                         *skimSink, *metaSink);
+  cm->setContext(ctx);
+  cm->registerCorrection("jec_like", "aux/correction.json", "test_correction",
+                         {"Jet_pt_raw", "Jet_bin"});
+  cm->registerCorrection("jes_like", "aux/correction.json", "test_correction",
+                         {"Jet_pt_corr_jec", "Jet_bin"});
+
+  defineRVecColumn(*dm, "Jet_pt_raw", [](ULong64_t) { return 0.5f; });
+  defineRVecColumn(*dm, "Jet_mass_raw", [](ULong64_t) { return 10.0f; });
+  defineRVecColumn(*dm, "Jet_bin", [](ULong64_t) { return 1.0f; });
+
+  mgr->setJetColumns("Jet_pt", "Jet_eta", "Jet_phi", "Jet_mass");
+  mgr->setFusedCorrections(true);
+  mgr->applyCorrectionlib(*cm, "jec_like", {"A"}, "Jet_pt_raw",
+                          "Jet_pt_corr_jec", true, "Jet_mass_raw",
+                          "Jet_mass_corr_jec", {"Jet_pt_raw", "Jet_bin"});
+  mgr->applyCorrectionlib(*cm, "jes_like", {"B"}, "Jet_pt_corr_jec",
+                          "Jet_pt_jes_up", true, "Jet_mass_corr_jec",
+                          "Jet_mass_jes_up", {"Jet_pt_corr_jec", "Jet_bin"});
+  mgr->execute();
+
+  auto df = dm->getDataFrame();
+  EXPECT_TRUE(dm->hasColumn("_jes_fused_factor_Jet_pt_jes_up"));
+  auto ptJesUp = df.Take<ROOT::VecOps::RVec<Float_t>>("Jet_pt_jes_up");
+  auto massJesUp = df.Take<ROOT::VecOps::RVec<Float_t>>("Jet_mass_jes_up");
+  // Intermediate columns stay available on request.
+  auto ptJec = df.Take<ROOT::VecOps::RVec<Float_t>>("Jet_pt_corr_jec");
+  EXPECT_NEAR(ptJesUp.GetValue()[0][0], 0.025f, 1e-6f);
+  EXPECT_NEAR(massJesUp.GetValue()[0][0], 0.5f, 1e-5f);
+  EXPECT_NEAR(ptJec.GetValue()[0][0], 0.05f, 1e-6f);
+  EXPECT_EQ(mgr->collectProvenanceEntries().at("fused_corrections"), "true");
+}
+
 // ---------------------------------------------------------------------------
 // Systematic variation registration
 // ---------------------------------------------------------------------------
@@ -841,6 +880,96 @@ TEST_F(JetEnergyScaleManagerTest, ApplySystematicSetEmptyPrefixThrows) {
       std::invalid_argument);
 }
 
+TEST_F(JetEnergyScaleManagerTest, BundledSystematicSetMatchesPerSourceColumns) {
+  auto dm = std::make_unique<DataManager>(1);
+  auto mgr = makeMgr(*dm);
+  auto cm = std::make_unique<CorrectionManager>(*config);
+  auto ctx = makeContext(*config, *dm, *systematicManager, *logger,
+                         *skimSink, *metaSink);
+  cm->setContext(ctx);
+  cm->registerCorrection("jes_unc", "aux/jes_sources.json", "jes_sources",
+                         {"Jet_pt"});
+
+  dm->Define("Jet_pt",
+             [](ULong64_t) { return ROOT::VecOps::RVec<Float_t>{10.f, 20.f}; },
+             {"rdfentry_"}, *systematicManager);
+  dm->Define("Jet_mass",
+             [](ULong64_t) { return ROOT::VecOps::RVec<Float_t>{1.f, 2.f}; },
+             {"rdfentry_"}, *systematicManager);
+  mgr->setJetColumns("Jet_pt", "Jet_eta", "Jet_phi", "Jet_mass");
+  SystematicBundleOptions options;
+  options.mode = SystematicBundleMode::Auto;
+  options.bundleTag = "jes";
+  mgr->setSystematicBundleOptions(options);
+  mgr->registerSystematicSources("reduced", {"Total", "Flavor"});
+  mgr->applySystematicSet(*cm, "jes_unc", "reduced", "Jet_pt", "Jet_pt_jes",
+                          true, {"Jet_pt"});
+  mgr->execute();
+
+  auto df = dm->getDataFrame();
+  auto ptBundle = df.Take<ROOT::VecOps::RVec<Float_t>>(
+      makeBundleColumnName("jes", "pt"));
+  const std::vector<float> expected{10.f, 20.f, 11.f, 22.f, 9.f,
+                                    18.f, 10.5f, 21.f, 9.5f, 19.f};
+  ASSERT_EQ(ptBundle.GetValue()[0].size(), expected.size());
+  for (std::size_t i = 0; i < expected.size(); ++i)
+    EXPECT_NEAR(ptBundle.GetValue()[0][i], expected[i], 1e-4f);
+
+  auto totalUp = df.Take<ROOT::VecOps::RVec<Float_t>>("Jet_pt_jes_Total_up");
+  auto flavorDownMass =
+      df.Take<ROOT::VecOps::RVec<Float_t>>("Jet_mass_jes_Flavor_down");
+  EXPECT_NEAR(totalUp.GetValue()[0][1], 22.f, 1e-4f);
+  EXPECT_NEAR(flavorDownMass.GetValue()[0][1], 1.9f, 1e-4f);
+
+  // One SF bundle replaces the per-source SF columns.
+  const auto columns = df.GetColumnNames();
+  EXPECT_EQ(std::find(columns.begin(), columns.end(), "jes_unc_Total_up"),
+            columns.end());
+  ASSERT_NE(systematicManager->getVariationBundle("Jet_mass"), nullptr);
+  EXPECT_EQ(systematicManager->getSystematics().count("Flavor"), 1u);
+}
+
+TEST_F(JetEnergyScaleManagerTest, PerSourceUncertaintyCorrectionsShareOnePass) {
+  auto dm = std::make_unique<DataManager>(1);
+  auto mgr = makeMgr(*dm);
+  auto cm = std::make_unique<CorrectionManager>(*config);
+  auto ctx = makeContext(*config, *dm, *systematicManager, *logger,
+                         *skimSink, *metaSink);
+  cm->setContext(ctx);
+  cm->registerCorrection("jes_Total", "aux/jes_source_uncertainties.json",
+                         "Total_unc", {"Jet_pt"});
+  cm->registerCorrection("jes_Flavor", "aux/jes_source_uncertainties.json",
+                         "Flavor_unc", {"Jet_pt"});
+
+  dm->Define("Jet_pt",
+             [](ULong64_t) { return ROOT::VecOps::RVec<Float_t>{10.f, 20.f}; },
+             {"rdfentry_"}, *systematicManager);
+  mgr->setJetColumns("Jet_pt", "Jet_eta", "Jet_phi", "");
+  SystematicBundleOptions options;
+  options.mode = SystematicBundleMode::Auto;
+  options.bundleTag = "jes";
+  mgr->setSystematicBundleOptions(options);
+  mgr->registerSystematicSources("reduced", {"Total", "Flavor"});
+  mgr->applySystematicSet(*cm, "jes_{source}", "reduced", "Jet_pt",
+                          "Jet_pt_jes", false);
+  mgr->execute();
+
+  auto df = dm->getDataFrame();
+  // One uncertainty block per source, not per direction.
+  auto sfBundle = df.Take<ROOT::VecOps::RVec<Float_t>>(
+      makeBundleColumnName("jes", "sf"));
+  auto ptBundle = df.Take<ROOT::VecOps::RVec<Float_t>>(
+      makeBundleColumnName("jes", "pt"));
+  EXPECT_EQ(sfBundle.GetValue()[0].size(), 4u);
+  const std::vector<float> expected{10.f, 20.f, 11.f, 24.f, 9.f,
+                                    16.f, 10.5f, 21.f, 9.5f, 19.f};
+  ASSERT_EQ(ptBundle.GetValue()[0].size(), expected.size());
+  for (std::size_t i = 0; i < expected.size(); ++i)
+    EXPECT_NEAR(ptBundle.GetValue()[0][i], expected[i], 1e-4f);
+  auto totalDown = df.Take<ROOT::VecOps::RVec<Float_t>>("Jet_pt_jes_Total_down");
+  EXPECT_NEAR(totalDown.GetValue()[0][1], 16.f, 1e-4f);
+}
+
 // ---------------------------------------------------------------------------
 // propagateMET validation
 // ---------------------------------------------------------------------------
@@ -1083,6 +1212,55 @@ TEST_F(JetEnergyScaleManagerTest, ChainedMETPropagationSteps) {
   EXPECT_FLOAT_EQ(ptJesUp.GetValue()[0], 84.0f);
 }
 
+TEST_F(JetEnergyScaleManagerTest, METVariationsShareNominalPropagation) {
+  // Variations propagated from the nominal MET reuse its x/y vector and the
+  // jet directions instead of recomputing them.
+  // MET_pt = 100, MET_phi = 0; jets at phi = 0 with raw pT {50, 30},
+  // nominal {60, 30}, up {66, 30}, down {54, 30}.
+  auto dm = std::make_unique<DataManager>(1);
+  auto mgr = makeMgr(*dm);
+
+  dm->Define("MET_pt",  [](ULong64_t) -> Float_t { return 100.0f; },
+             {"rdfentry_"}, *systematicManager);
+  dm->Define("MET_phi", [](ULong64_t) -> Float_t { return 0.0f; },
+             {"rdfentry_"}, *systematicManager);
+  dm->Define("Jet_phi",
+             [](ULong64_t) -> ROOT::VecOps::RVec<Float_t> { return {0.0f, 0.0f}; },
+             {"rdfentry_"}, *systematicManager);
+  dm->Define("Jet_pt_raw",
+             [](ULong64_t) -> ROOT::VecOps::RVec<Float_t> { return {50.0f, 30.0f}; },
+             {"rdfentry_"}, *systematicManager);
+  dm->Define("Jet_pt_nom",
+             [](ULong64_t) -> ROOT::VecOps::RVec<Float_t> { return {60.0f, 30.0f}; },
+             {"rdfentry_"}, *systematicManager);
+  dm->Define("Jet_pt_up",
+             [](ULong64_t) -> ROOT::VecOps::RVec<Float_t> { return {66.0f, 30.0f}; },
+             {"rdfentry_"}, *systematicManager);
+  dm->Define("Jet_pt_down",
+             [](ULong64_t) -> ROOT::VecOps::RVec<Float_t> { return {54.0f, 30.0f}; },
+             {"rdfentry_"}, *systematicManager);
+
+  mgr->setJetColumns("Jet_pt", "Jet_eta", "Jet_phi", "Jet_mass");
+  mgr->propagateMET("MET_pt", "MET_phi", "Jet_pt_raw", "Jet_pt_nom",
+                    "MET_pt_nom", "MET_phi_nom");
+  mgr->propagateMET("MET_pt_nom", "MET_phi_nom", "Jet_pt_nom", "Jet_pt_up",
+                    "MET_pt_up", "MET_phi_up");
+  mgr->propagateMET("MET_pt_nom", "MET_phi_nom", "Jet_pt_nom", "Jet_pt_down",
+                    "MET_pt_down", "MET_phi_down");
+  mgr->execute();
+
+  EXPECT_TRUE(dm->hasColumn("_jesmet_dir_Jet_phi"));
+  EXPECT_TRUE(dm->hasColumn("_jesmet_xy_MET_pt_MET_phi"));
+  EXPECT_FALSE(dm->hasColumn("_jesmet_xy_MET_pt_nom_MET_phi_nom"));
+
+  auto ptNom  = dm->getDataFrame().Take<Float_t>("MET_pt_nom");
+  auto ptUp   = dm->getDataFrame().Take<Float_t>("MET_pt_up");
+  auto ptDown = dm->getDataFrame().Take<Float_t>("MET_pt_down");
+  EXPECT_FLOAT_EQ(ptNom.GetValue()[0],  90.0f);
+  EXPECT_FLOAT_EQ(ptUp.GetValue()[0],   84.0f);
+  EXPECT_FLOAT_EQ(ptDown.GetValue()[0], 96.0f);
+}
+
 // ---------------------------------------------------------------------------
 // collectProvenanceEntries – new fields
 // ---------------------------------------------------------------------------
@@ -1489,6 +1667,41 @@ TEST_F(JetEnergyScaleManagerTest, CollectionDefinePropagatesSystematicVariations
   EXPECT_NEAR(down.GetValue()[0][0], 92.0f, 0.01f);
 }
 
+TEST_F(JetEnergyScaleManagerTest, DeltaPropagationReusesUnchangedJets) {
+  auto dm = std::make_unique<DataManager>(1);
+  auto mgr = makeMgr(*dm);
+
+  defineJetCollection(*dm, *systematicManager, "goodJets", 100.0f);
+  defineRVecColumn(*dm, "Jet_pt_jec",    [](ULong64_t) { return 100.0f; });
+  defineRVecColumn(*dm, "Jet_pt_jes_up", [](ULong64_t) { return 108.0f; });
+  // The down variation leaves the jet untouched.
+  defineRVecColumn(*dm, "Jet_pt_jes_dn", [](ULong64_t) { return 100.0f; });
+
+  mgr->setInputJetCollection("goodJets");
+  mgr->defineCollectionOutput("Jet_pt_jec", "goodJets_jec");
+  mgr->addVariation("jesTest", "Jet_pt_jes_up", "Jet_pt_jes_dn");
+  mgr->defineVariationCollections("goodJets_jec", "goodJets");
+  mgr->setDeltaPropagation(true);
+  EXPECT_TRUE(mgr->isDeltaPropagationEnabled());
+  mgr->execute();
+
+  auto df = dm->getDataFrame();
+  auto upChanged =
+      df.Take<ROOT::VecOps::RVec<bool>>("goodJets_jec_jesTestUp_changed");
+  auto dnChanged =
+      df.Take<ROOT::VecOps::RVec<bool>>("goodJets_jec_jesTestDown_changed");
+  auto up = df.Take<PhysicsObjectCollection>("goodJets_jesTestUp");
+  auto dn = df.Take<PhysicsObjectCollection>("goodJets_jesTestDown");
+
+  ASSERT_EQ(upChanged.GetValue()[0].size(), 1u);
+  EXPECT_TRUE(upChanged.GetValue()[0][0]);
+  EXPECT_FALSE(dnChanged.GetValue()[0][0]);
+  EXPECT_NEAR(static_cast<float>(up.GetValue()[0].at(0).Pt()), 108.0f, 0.01f);
+  EXPECT_NEAR(static_cast<float>(up.GetValue()[0].at(0).Eta()), 1.0f, 0.01f);
+  EXPECT_NEAR(static_cast<float>(dn.GetValue()[0].at(0).Pt()), 100.0f, 0.01f);
+  EXPECT_EQ(mgr->collectProvenanceEntries().at("delta_propagation"), "true");
+}
+
 // ---------------------------------------------------------------------------
 // collectProvenanceEntries – PhysicsObjectCollection fields
 // ---------------------------------------------------------------------------
@@ -0,0 +1,170 @@
+/**
+ * @file testJitCache.cc
+ * @brief Unit tests for JitCache – finding the inputs of string
+ *        expressions, and compiling and reusing cached definitions.
+ */
+
+#include <gtest/gtest.h>
+
+#include <DataManager.h>
+#include <JitCache.h>
+
+#include <filesystem>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+const std::string kDir = std::string(TEST_SOURCE_DIR) + "/aux/jit_cache";
+
+ROOT::RDF::RNode makeFrame() {
+  ROOT::RDF::RNode df = ROOT::RDataFrame(10);
+  return df.Define("x", [](ULong64_t entry) { return static_cast<float>(entry); },
+                   {"rdfentry_"})
+      .Define("jets", [](ULong64_t entry) { return ROOT::VecOps::RVec<float>(entry % 3, 1.5f); },
+              {"rdfentry_"});
+}
+
+class JitCacheTest : public ::testing::Test {
+protected:
+  void SetUp() override { std::filesystem::remove_all(kDir); }
+  void TearDown() override { std::filesystem::remove_all(kDir); }
+};
+
+} // namespace
+
+TEST(JitCacheColumnsTest, FindsColumnsInOrderOfFirstUse) {
+  const std::vector<std::string> available{"x", "jets", "y", "size"};
+  EXPECT_EQ(JitCache::inputColumns("jets.size() > 0 ? x * y : x", available),
+            (std::vector<std::string>{"jets", "x", "y"}));
+  // Members, qualified names and string literals are not columns.
+  EXPECT_EQ(JitCache::inputColumns("ROOT::VecOps::size(jets) + jets->y", available),
+            (std::vector<std::string>{"jets"}));
+  EXPECT_EQ(JitCache::inputColumns("std::string(\"x\") == \"y\\\"\"", available),
+            std::vector<std::string>{});
+}
+
+TEST(JitCacheColumnsTest, KeyDependsOnExpressionAndTypes) {
+  auto df = makeFrame();
+  const auto a = JitCache::describe(df, "x * 2.f");
+  const auto b = JitCache::describe(df, "x * 3.f");
+  EXPECT_EQ(a.columns, std::vector<std::string>{"x"});
+  EXPECT_EQ(a.types, std::vector<std::string>{"float"});
+  EXPECT_FALSE(a.key.empty());
+  EXPECT_NE(a.key, b.key);
+  EXPECT_EQ(a.key, JitCache::describe(df, "x * 2.f").key);
+
+  const std::string source = JitCache::generateSource({a});
+  EXPECT_NE(source.find("extern \"C\" void rdfjit_" + a.key), std::string::npos);
+  EXPECT_NE(source.find("const float &x"), std::string::npos);
+  EXPECT_NE(source.find("return x * 2.f;"), std::string::npos);
+
+  // An identifier containing "return" does not make the expression a body.
+  ROOT::RDF::RNode withReturnValue = df.Define("returnValue", [](float x) { return x; }, {"x"});
+  const auto c = JitCache::describe(withReturnValue, "returnValue + 1.f");
+  EXPECT_NE(JitCache::generateSource({c}).find("return returnValue + 1.f;"),
+            std::string::npos);
+}
+
+TEST_F(JitCacheTest, MissesAreJitCompiledAndCannotBuildReadOnly) {
+  JitCache cache(kDir, false);
+  auto df = cache.define(makeFrame(), "y", "x * 2.f");
+  EXPECT_EQ(*df.Sum<float>("y"), 90.0f);
+  EXPECT_EQ(cache.hits(), 0u);
+  ASSERT_EQ(cache.missed().size(), 1u);
+  EXPECT_THROW(cache.build(), std::runtime_error);
+}
+
+TEST_F(JitCacheTest, BuiltExpressionsAreReusedByLaterJobs) {
+  const std::string concat = "ROOT::VecOps::RVec<float> out(jets);\n"
+                             "out.push_back(x);\nreturn out;";
+  {
+    JitCache cache(kDir, true);
+    auto df = cache.define(makeFrame(), "y", "x * 2.f");
+    df = cache.define(df, "all", concat);
+    ASSERT_EQ(cache.missed().size(), 2u);
+    EXPECT_EQ(cache.build(), 2u);
+    // Everything is cached now.
+    EXPECT_EQ(cache.build(), 0u);
+    EXPECT_TRUE(std::filesystem::exists(kDir + "/" + JitCache::kIndexFile));
+  }
+
+  JitCache cache(kDir, false);
+  auto df = cache.define(makeFrame(), "y", "x * 2.f");
+  df = cache.define(df, "all", concat);
+  EXPECT_EQ(cache.hits(), 2u);
+  EXPECT_TRUE(cache.missed().empty());
+  EXPECT_EQ(df.GetColumnType("y"), "float");
+  EXPECT_EQ(*df.Sum<float>("y"), 90.0f);
+  EXPECT_EQ(*df.Define("n", [](const ROOT::VecOps::RVec<float> &v) { return v.size(); },
+                       {"all"})
+                 .Sum<std::size_t>("n"),
+            19u);
+}
+
+TEST_F(JitCacheTest, DataManagerRoutesExpressionsThroughTheCache) {
+  DataManager data(4);
+  EXPECT_EQ(data.getJitCache(), nullptr);
+  data.enableJitCache(kDir, false);
+  ASSERT_NE(data.getJitCache(), nullptr);
+  auto df = data.defineExpression(data.getDataFrame(), "twice", "2 * rdfentry_");
+  EXPECT_EQ(*df.Sum<ULong64_t>("twice"), 12u);
+  EXPECT_EQ(data.getJitCache()->missed().size(), 1u);
+  // A read-only cache is never built.
+  data.buildJitCache();
+}
+
+namespace {
+void defineDoubled(ROOT::RDF::RNode *df, const std::string *name) {
+  *df = df->Define(*name, [](const float &x) { return 2.f * x; }, {"x"});
+}
+} // namespace
+
+TEST_F(JitCacheTest, CompiledExpressionsNeedNoCacheDirectory) {
+  auto frame = makeFrame();
+  const auto expr = JitCache::describe(frame, "x + x");
+  const std::string unit = JitCache::generateTranslationUnit({expr});
+  EXPECT_NE(unit.find("#include <JitCache.h>"), std::string::npos);
+  EXPECT_NE(unit.find("JitCache::registerCompiled(\"" + expr.key + "\", &rdfjit_" + expr.key),
+            std::string::npos);
+
+  JitCache::registerCompiled(expr.key, &defineDoubled);
+  EXPECT_GE(JitCache::compiledCount(), 1u);
+  JitCache cache("", false);
+  auto df = cache.define(frame, "y", "x + x");
+  EXPECT_EQ(cache.hits(), 1u);
+  EXPECT_EQ(*df.Sum<float>("y"), 90.0f);
+  EXPECT_THROW(cache.build(), std::runtime_error);
+
+  const std::string exported = std::string(TEST_SOURCE_DIR) + "/aux/test_jit_export.cc";
+  EXPECT_EQ(cache.exportTranslationUnit(exported), 1u);
+  EXPECT_TRUE(std::filesystem::exists(exported));
+  std::filesystem::remove(exported);
+}
+
+TEST_F(JitCacheTest, FunctionsAreDeclaredOnceAndBuiltIntoTheCache) {
+  const std::string source = "namespace rdfjit_function_detail { double scale() { return 3.0; } }\n"
+                             "extern \"C\" double rdfjit_function(double x) {\n"
+                             "  return rdfjit_function_detail::scale() * x;\n}\n";
+  using Fn = double (*)(double);
+  const auto function = JitCache::describeFunction(source);
+  EXPECT_EQ(function.source.find(JitCache::kFunctionName + std::string("(")), std::string::npos);
+  EXPECT_NE(function.source.find("rdfjit_" + function.key + "_detail"), std::string::npos);
+
+  JitCache cache(kDir, true);
+  auto fn = reinterpret_cast<Fn>(cache.function(source));
+  ASSERT_NE(fn, nullptr);
+  EXPECT_DOUBLE_EQ(fn(2.0), 6.0);
+  ASSERT_EQ(cache.missedFunctions().size(), 1u);
+  // Declared once per process: a second job gets the same function.
+  EXPECT_EQ(reinterpret_cast<Fn>(JitCache::declareFunction(source)), fn);
+  EXPECT_EQ(cache.build(), 1u);
+  EXPECT_EQ(cache.build(), 0u);
+
+  JitCache reader(kDir, false);
+  EXPECT_EQ(reinterpret_cast<Fn>(reader.function(source)), fn);
+  EXPECT_EQ(reader.hits(), 1u);
+  EXPECT_TRUE(reader.missedFunctions().empty());
+  EXPECT_EQ(JitCache::declareFunction("extern \"C\" double rdfjit_function( {"), nullptr);
+}
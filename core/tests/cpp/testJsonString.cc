@@ -0,0 +1,21 @@
+/**
+ * @file testJsonString.cc
+ * @brief Unit tests for jsonString – quoting of strings in JSON reports.
+ */
+
+#include <gtest/gtest.h>
+
+#include <JsonString.h>
+
+#include <string>
+
+TEST(JsonStringTest, QuotesPlainText) {
+  EXPECT_EQ(jsonString("root://site//store/file.root"), "\"root://site//store/file.root\"");
+  EXPECT_EQ(jsonString(""), "\"\"");
+}
+
+TEST(JsonStringTest, EscapesQuotesBackslashesAndControlCharacters) {
+  EXPECT_EQ(jsonString("a\"b\\c"), "\"a\\\"b\\\\c\"");
+  EXPECT_EQ(jsonString("line\nnext\ttab"), "\"line\\nnext\\ttab\"");
+  EXPECT_EQ(jsonString(std::string("bell\x07", 5)), "\"bell\\u0007\"");
+}
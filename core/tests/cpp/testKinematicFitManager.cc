@@ -27,6 +27,7 @@
 #ifndef M_PI
 #define M_PI 3.14159265358979323846
 #endif
+#include <array>
 #include <cmath>
 #include <gtest/gtest.h>
 #include <memory>
@@ -311,6 +312,290 @@ TEST_F(KinematicFitTest, PtConstraintZeroMET_WithMassConstraint) {
   EXPECT_LT(fp[2].pt, 20.0);
 }
 
+/// Run the same particles and constraints through KinematicFit and
+/// FixedKinematicFit and require identical results up to rounding.
+template <int NP, int NC, typename Setup>
+static void expectFixedMatchesDynamic(Setup setup) {
+  KinematicFit dynamic;
+  FixedKinematicFit<NP, NC> fixed;
+  setup(dynamic);
+  setup(fixed);
+  const auto expected = dynamic.fit();
+  const auto actual = fixed.fit();
+  EXPECT_EQ(actual.converged, expected.converged);
+  EXPECT_EQ(actual.nIterations, expected.nIterations);
+  EXPECT_NEAR(actual.chi2, expected.chi2, 1e-6 * (1.0 + expected.chi2));
+  for (int i = 0; i < NP; ++i) {
+    EXPECT_NEAR(actual.fittedParticles[i].pt, expected.fittedParticles[i].pt, 1e-6);
+    EXPECT_NEAR(actual.fittedParticles[i].eta, expected.fittedParticles[i].eta, 1e-8);
+    EXPECT_NEAR(actual.fittedParticles[i].phi, expected.fittedParticles[i].phi, 1e-8);
+  }
+}
+
+TEST_F(KinematicFitTest, FixedSize_TwoBodyMatchesDynamicFit) {
+  expectFixedMatchesDynamic<2, 1>([](auto &fitter) {
+    fitter.addParticle({52.0, 0.3, 0.5, 0.106, 0.05, 0.01, 0.01});
+    fitter.addParticle({52.0, -0.3, 0.5 + M_PI, 0.106, 0.05, 0.01, 0.01});
+    fitter.addMassConstraint(0, 1, 91.2);
+  });
+}
+
+TEST_F(KinematicFitTest, FixedSize_FourBodyMatchesDynamicFit) {
+  expectFixedMatchesDynamic<4, 2>([](auto &fitter) {
+    fitter.addParticle({48.0,  0.4,  1.0, 0.106, 0.03, 0.005, 0.005});
+    fitter.addParticle({48.0, -0.4,  1.0 + M_PI, 0.106, 0.03, 0.005, 0.005});
+    fitter.addParticle({65.0,  1.0,  0.0, 4.18, 0.10, 0.05, 0.05});
+    fitter.addParticle({65.0, -1.0,  M_PI, 4.18, 0.10, 0.05, 0.05});
+    fitter.addMassConstraint(0, 1, 91.2, 2.495);
+    fitter.addMassConstraint(2, 3, 125.0);
+  });
+}
+
+TEST_F(KinematicFitTest, FixedSize_SixBodyMatchesDynamicFit) {
+  // Semileptonic tt̄: hadronic W and top, leptonic W and top.  Four
+  // constraints exercise the Cholesky solve against Gaussian elimination.
+  expectFixedMatchesDynamic<6, 4>([](auto &fitter) {
+    fitter.addParticle({70.0,  0.2,  0.3, 4.18,  0.10, 0.05, 0.05});  // b (hadronic)
+    fitter.addParticle({50.0,  0.8,  1.2, 0.0,   0.10, 0.05, 0.05});  // light jet 1
+    fitter.addParticle({45.0, -0.1,  2.0, 0.0,   0.10, 0.05, 0.05});  // light jet 2
+    fitter.addParticle({60.0, -0.6, -2.0, 4.18,  0.10, 0.05, 0.05});  // b (leptonic)
+    fitter.addParticle({42.0, -0.3, -1.0, 0.106, 0.02, 0.001, 0.001}); // lepton
+    fitter.addParticle({38.0,  0.0, -2.6, 0.0,   0.20, 100.0, 0.05}); // neutrino
+    fitter.addMassConstraint(1, 2, 80.4, 2.085);
+    fitter.addThreeBodyMassConstraint(0, 1, 2, 173.3, 1.4);
+    fitter.addMassConstraint(4, 5, 80.4, 2.085);
+    fitter.addThreeBodyMassConstraint(3, 4, 5, 173.3, 1.4);
+  });
+}
+
+TEST_F(KinematicFitTest, FixedSize_PtConstraintMatchesDynamicFit) {
+  expectFixedMatchesDynamic<3, 2>([](auto &fitter) {
+    fitter.addParticle({50.0,  0.5,  0.0, 0.0, 0.10, 0.05, 0.05});
+    fitter.addParticle({45.0, -0.5,  M_PI, 0.0, 0.10, 0.05, 0.05});
+    fitter.addParticle({20.0,  0.0, -1.0, 0.0, 0.20, 100.0, 0.05});
+    fitter.addPtConstraint(2, 0.0);
+    fitter.addMassConstraint(0, 1, 91.2);
+  });
+}
+
+TEST_F(KinematicFitTest, FixedSize_RejectsWrongParticleOrConstraintCount) {
+  FixedKinematicFit<2, 1> fitter;
+  fitter.addParticle({45.0, 0.5, 1.0, 0.106, 0.02, 0.001, 0.001});
+  fitter.addParticle({40.0, -0.5, -2.0, 0.106, 0.02, 0.001, 0.001});
+  EXPECT_THROW(fitter.addParticle({40.0, 0.0, 0.0, 0.0, 0.1, 0.1, 0.1}),
+               std::runtime_error);
+  EXPECT_THROW(fitter.fit(), std::runtime_error);
+  fitter.addMassConstraint(0, 1, 91.2);
+  EXPECT_THROW(fitter.addPtConstraint(0, 0.0), std::runtime_error);
+  EXPECT_NO_THROW(fitter.fit());
+}
+
+/// Fit each lane's particles with FixedKinematicFit and require the
+/// BatchedKinematicFit lane results to agree up to rounding (vectorised code
+/// may contract multiply-adds differently).
+template <int NP, int NC, int L, typename Particles, typename Constraints>
+static void expectBatchedMatchesFixed(Particles particles, Constraints constraints,
+                                      int nLanes = L) {
+  BatchedKinematicFit<NP, NC, L> batched;
+  constraints(batched);
+  for (int lane = 0; lane < nLanes; ++lane) {
+    for (int i = 0; i < NP; ++i) {
+      batched.setParticle(lane, i, particles(lane, i));
+    }
+  }
+  std::array<typename BatchedKinematicFit<NP, NC, L>::Result, L> results{};
+  batched.fit(results, 50, 1e-6, nLanes);
+
+  for (int lane = 0; lane < nLanes; ++lane) {
+    FixedKinematicFit<NP, NC> fixed;
+    for (int i = 0; i < NP; ++i) {
+      fixed.addParticle(particles(lane, i));
+    }
+    constraints(fixed);
+    const auto expected = fixed.fit(50, 1e-6);
+    const auto &actual = results[lane];
+    EXPECT_EQ(actual.converged, expected.converged) << "lane " << lane;
+    EXPECT_EQ(actual.nIterations, expected.nIterations) << "lane " << lane;
+    EXPECT_NEAR(actual.chi2, expected.chi2, 1e-6 * (1.0 + expected.chi2)) << "lane " << lane;
+    for (int i = 0; i < NP; ++i) {
+      EXPECT_NEAR(actual.fittedParticles[i].pt, expected.fittedParticles[i].pt, 1e-6);
+      EXPECT_NEAR(actual.fittedParticles[i].eta, expected.fittedParticles[i].eta, 1e-8);
+      EXPECT_NEAR(actual.fittedParticles[i].phi, expected.fittedParticles[i].phi, 1e-8);
+      EXPECT_EQ(actual.fittedParticles[i].mass, expected.fittedParticles[i].mass);
+    }
+  }
+}
+
+TEST_F(KinematicFitTest, Batched_EightLanesMatchFixedFit) {
+  // Lanes start at different distances from the Z mass, so they converge
+  // after different numbers of iterations.
+  expectBatchedMatchesFixed<2, 1, 8>(
+      [](int lane, int i) -> KinFitParticle {
+        const double pt = 35.0 + 4.0 * lane;
+        return i == 0 ? KinFitParticle{pt, 0.3, 0.5, 0.106, 0.05, 0.01, 0.01}
+                      : KinFitParticle{pt + lane, -0.3 - 0.1 * lane, 0.5 + M_PI, 0.106,
+                                       0.05, 0.01, 0.01};
+      },
+      [](auto &fitter) { fitter.addMassConstraint(0, 1, 91.2); });
+}
+
+TEST_F(KinematicFitTest, Batched_SixBodyPartialBatchMatchesFixedFit) {
+  const KinFitParticle base[6] = {
+      {70.0,  0.2,  0.3, 4.18,  0.10, 0.05, 0.05},
+      {50.0,  0.8,  1.2, 0.0,   0.10, 0.05, 0.05},
+      {45.0, -0.1,  2.0, 0.0,   0.10, 0.05, 0.05},
+      {60.0, -0.6, -2.0, 4.18,  0.10, 0.05, 0.05},
+      {42.0, -0.3, -1.0, 0.106, 0.02, 0.001, 0.001},
+      {38.0,  0.0, -2.6, 0.0,   0.20, 100.0, 0.05}};
+  expectBatchedMatchesFixed<6, 4, 4>(
+      [&base](int lane, int i) {
+        KinFitParticle p = base[i];
+        p.pt *= 1.0 + 0.05 * lane;  // e.g. nominal and jet-energy variations
+        return p;
+      },
+      [](auto &fitter) {
+        fitter.addMassConstraint(1, 2, 80.4, 2.085);
+        fitter.addThreeBodyMassConstraint(0, 1, 2, 173.3, 1.4);
+        fitter.addMassConstraint(4, 5, 80.4, 2.085);
+        fitter.addThreeBodyMassConstraint(3, 4, 5, 173.3, 1.4);
+      },
+      /*nLanes=*/3);
+}
+
+TEST_F(KinematicFitTest, Batched_SingularLaneDoesNotStopOtherLanes) {
+  // Lane 1 has two massless particles at rest: D = 0, so W is singular and
+  // the lane stops at once, as FixedKinematicFit does.
+  expectBatchedMatchesFixed<2, 1, 4>(
+      [](int lane, int i) -> KinFitParticle {
+        if (lane == 1) return {0.0, 0.0, 0.0, 0.0, 0.05, 0.01, 0.01};
+        return i == 0 ? KinFitParticle{45.0 + lane, 0.5, 1.0, 0.106, 0.02, 0.001, 0.001}
+                      : KinFitParticle{40.0, -0.5, -2.0, 0.106, 0.02, 0.001, 0.001};
+      },
+      [](auto &fitter) { fitter.addMassConstraint(0, 1, 91.2); });
+}
+
+TEST_F(KinematicFitTest, Batched_RejectsBadLaneOrConstraintCount) {
+  BatchedKinematicFit<2, 1, 4> fitter;
+  std::array<BatchedKinematicFit<2, 1, 4>::Result, 4> results{};
+  EXPECT_THROW(fitter.setParticle(4, 0, {}), std::out_of_range);
+  EXPECT_THROW(fitter.setParticle(0, 2, {}), std::out_of_range);
+  EXPECT_THROW(fitter.fit(results), std::runtime_error);
+  fitter.addMassConstraint(0, 1, 91.2);
+  EXPECT_THROW(fitter.addPtConstraint(0, 0.0), std::runtime_error);
+  EXPECT_THROW(fitter.fit(results, 50, 1e-6, 0), std::out_of_range);
+  EXPECT_THROW(fitter.fit(results, 50, 1e-6, 5), std::out_of_range);
+}
+
+// ─── Warm-start tests ────────────────────────────────────────────────────────
+
+/// ZH with the jets of lane @p lane scaled by 1 + 0.03 * lane (lane 0 is the
+/// nominal, the others stand for jet-energy variations).
+static KinFitParticle zhParticle(int lane, int i) {
+  static const KinFitParticle base[4] = {
+      {48.0,  0.4,  1.0,        0.106, 0.03, 0.005, 0.005},
+      {48.0, -0.4,  1.0 + M_PI, 0.106, 0.03, 0.005, 0.005},
+      {65.0,  1.0,  0.0,        4.18,  0.10, 0.05,  0.05},
+      {60.0, -1.0,  M_PI,       4.18,  0.10, 0.05,  0.05}};
+  KinFitParticle p = base[i];
+  if (i >= 2) p.pt *= 1.0 + 0.03 * lane;
+  return p;
+}
+
+/// Start point of lane @p lane: the nominal fit moved by the lane's shift.
+static KinFitParticle zhWarmStart(const FixedKinematicFit<4, 2>::Result &nominal,
+                                  int lane, int i) {
+  KinFitParticle start = nominal.fittedParticles[i];
+  start.pt += zhParticle(lane, i).pt - zhParticle(0, i).pt;
+  return start;
+}
+
+template <typename Fitter>
+static void addZhConstraints(Fitter &fitter) {
+  fitter.addMassConstraint(0, 1, 91.2, 2.495);
+  fitter.addMassConstraint(2, 3, 125.0);
+}
+
+TEST_F(KinematicFitTest, WarmStart_VariationFromNominalFitMatchesColdFit) {
+  FixedKinematicFit<4, 2> nominalFit;
+  for (int i = 0; i < 4; ++i) nominalFit.addParticle(zhParticle(0, i));
+  addZhConstraints(nominalFit);
+  const auto nominal = nominalFit.fit();
+  ASSERT_TRUE(nominal.converged);
+
+  for (int lane = 1; lane <= 2; ++lane) {
+    KinematicFit cold;
+    KinematicFit warm;
+    for (int i = 0; i < 4; ++i) {
+      cold.addParticle(zhParticle(lane, i));
+      warm.addParticle(zhParticle(lane, i));
+      warm.setStart(i, zhWarmStart(nominal, lane, i));
+    }
+    addZhConstraints(cold);
+    addZhConstraints(warm);
+    const auto expected = cold.fit();
+    const auto actual = warm.fit(5, 1e-6);
+    ASSERT_TRUE(expected.converged);
+    EXPECT_TRUE(actual.converged) << "lane " << lane;
+    EXPECT_LE(actual.nIterations, expected.nIterations) << "lane " << lane;
+    EXPECT_NEAR(actual.chi2, expected.chi2, 1e-2 * (1.0 + expected.chi2)) << "lane " << lane;
+    // The fit only projects onto the constraints, so the start moves the
+    // solution at second order in the shift: far inside the resolution.
+    for (int i = 0; i < 4; ++i) {
+      const auto &p = zhParticle(lane, i);
+      EXPECT_NEAR(actual.fittedParticles[i].pt, expected.fittedParticles[i].pt,
+                  0.05 * p.sigPt * p.pt);
+      EXPECT_NEAR(actual.fittedParticles[i].eta, expected.fittedParticles[i].eta, 0.05 * p.sigEta);
+      EXPECT_EQ(actual.fittedParticles[i].mass, expected.fittedParticles[i].mass);
+    }
+  }
+}
+
+TEST_F(KinematicFitTest, Batched_WarmStartMatchesFixedFit) {
+  FixedKinematicFit<4, 2> nominalFit;
+  for (int i = 0; i < 4; ++i) nominalFit.addParticle(zhParticle(0, i));
+  addZhConstraints(nominalFit);
+  const auto nominal = nominalFit.fit();
+
+  BatchedKinematicFit<4, 2, 4> batched;
+  addZhConstraints(batched);
+  for (int lane = 0; lane < 3; ++lane) {
+    for (int i = 0; i < 4; ++i) {
+      batched.setParticle(lane, i, zhParticle(lane, i));
+      batched.setStart(lane, i, zhWarmStart(nominal, lane, i));
+    }
+  }
+  std::array<BatchedKinematicFit<4, 2, 4>::Result, 4> results{};
+  batched.fit(results, 5, 1e-6, 3);
+
+  for (int lane = 0; lane < 3; ++lane) {
+    FixedKinematicFit<4, 2> fixed;
+    for (int i = 0; i < 4; ++i) fixed.addParticle(zhParticle(lane, i));
+    for (int i = 0; i < 4; ++i) fixed.setStart(i, zhWarmStart(nominal, lane, i));
+    addZhConstraints(fixed);
+    const auto expected = fixed.fit(5, 1e-6);
+    EXPECT_EQ(results[lane].converged, expected.converged) << "lane " << lane;
+    EXPECT_EQ(results[lane].nIterations, expected.nIterations) << "lane " << lane;
+    EXPECT_NEAR(results[lane].chi2, expected.chi2, 1e-6 * (1.0 + expected.chi2));
+    for (int i = 0; i < 4; ++i) {
+      EXPECT_NEAR(results[lane].fittedParticles[i].pt, expected.fittedParticles[i].pt, 1e-6);
+    }
+  }
+  // The nominal lane starts at its own solution.
+  EXPECT_EQ(results[0].nIterations, 2);
+}
+
+TEST_F(KinematicFitTest, SetStart_RejectsUnknownParticle) {
+  KinematicFit dynamic;
+  FixedKinematicFit<2, 1> fixed;
+  BatchedKinematicFit<2, 1, 4> batched;
+  dynamic.addParticle(zhParticle(0, 0));
+  fixed.addParticle(zhParticle(0, 0));
+  EXPECT_THROW(dynamic.setStart(1, {}), std::out_of_range);
+  EXPECT_THROW(fixed.setStart(1, {}), std::out_of_range);
+  EXPECT_THROW(batched.setStart(4, 0, {}), std::out_of_range);
+  EXPECT_THROW(batched.setStart(0, 2, {}), std::out_of_range);
+}
+
 // ─── KinematicFitManager configuration tests ─────────────────────────────────
 
 class KinematicFitManagerTest : public ::testing::Test {
@@ -1019,6 +1304,106 @@ TEST_F(KinematicFitManagerTest, ParseUseGpu_InvalidValue_Throws) {
       std::runtime_error);
 }
 
+// ─── Block-mode tests ────────────────────────────────────────────────────────
+
+TEST_F(KinematicFitManagerTest, ParseBlockMode_SetsFlagAndLanes) {
+  auto blockCfgMgr = ManagerFactory::createConfigurationManager(
+      "cfg/test_kinfit_block_config.txt");
+  KinematicFitManager blockMgr(*blockCfgMgr);
+
+  EXPECT_FALSE(blockMgr.getFitConfig("zhFitScalar").blockMode);
+  const auto &cfg = blockMgr.getFitConfig("zhFitBlock");
+  EXPECT_TRUE(cfg.blockMode);
+  EXPECT_EQ(cfg.blockLanes, 4);
+  EXPECT_FALSE(cfg.useGPU);
+  EXPECT_FALSE(cfg.warmStart);
+
+  const auto &warmCfg = blockMgr.getFitConfig("zhFitWarm");
+  EXPECT_TRUE(warmCfg.warmStart);
+  EXPECT_EQ(warmCfg.warmStartMaxIterations, 10);
+  EXPECT_EQ(warmCfg.maxIterations, 200);
+}
+
+TEST_F(KinematicFitManagerTest, ApplyFit_BlockMode_FitsNominalAndVariations) {
+  // zhFitScalar and zhFitBlock are the same fit; the block-mode one also
+  // fits the jes variation of jet1_pt in the same call.
+  defineParticleColumns();
+  dataManager->Define("jet1_pt_jesUp",   [](ULong64_t) -> float { return 72.0f; }, {"rdfentry_"}, *systematicManager);
+  dataManager->Define("jet1_pt_jesDown", [](ULong64_t) -> float { return 58.0f; }, {"rdfentry_"}, *systematicManager);
+  systematicManager->registerSystematic("jes", {"jet1_pt"});
+
+  auto blockCfgMgr = ManagerFactory::createConfigurationManager(
+      "cfg/test_kinfit_block_config.txt");
+  KinematicFitManager blockMgr(*blockCfgMgr);
+  ManagerContext ctx{*blockCfgMgr, *dataManager, *systematicManager,
+                     *logger, *skimSink, *metaSink};
+  blockMgr.setContext(ctx);
+  blockMgr.applyFit("zhFitScalar");
+  blockMgr.applyFit("zhFitBlock");
+
+  EXPECT_TRUE(systematicManager->isVariableAffectedBySystematic("zhFitBlock_chi2", "jes"));
+
+  auto df = dataManager->getDataFrame();
+  auto scalarChi2 = df.Take<Float_t>("zhFitScalar_chi2");
+  auto blockChi2  = df.Take<Float_t>("zhFitBlock_chi2");
+  auto upChi2     = df.Take<Float_t>("zhFitBlock_chi2_jesUp");
+  auto downChi2   = df.Take<Float_t>("zhFitBlock_chi2_jesDown");
+  auto nominalPt  = df.Take<Float_t>("zhFitBlock_bjet1_pt_fitted");
+  auto upPt       = df.Take<Float_t>("zhFitBlock_bjet1_pt_fitted_jesUp");
+  ASSERT_EQ(scalarChi2->size(), blockChi2->size());
+  for (std::size_t i = 0; i < blockChi2->size(); ++i) {
+    EXPECT_NEAR((*blockChi2)[i], (*scalarChi2)[i], 1e-4f * (1.0f + (*scalarChi2)[i]));
+    EXPECT_GE((*upChi2)[i], 0.0f);
+    EXPECT_GE((*downChi2)[i], 0.0f);
+    EXPECT_NE((*upChi2)[i], (*blockChi2)[i]);
+    EXPECT_GT((*upPt)[i], (*nominalPt)[i]);
+  }
+}
+
+TEST_F(KinematicFitManagerTest, ApplyFit_WarmStart_MatchesColdBlockFit) {
+  // zhFitWarm is zhFitBlock with its jes variations started from the
+  // nominal fit of the event.
+  defineParticleColumns();
+  dataManager->Define("jet1_pt_jesUp",   [](ULong64_t) -> float { return 68.0f; }, {"rdfentry_"}, *systematicManager);
+  dataManager->Define("jet1_pt_jesDown", [](ULong64_t) -> float { return 62.0f; }, {"rdfentry_"}, *systematicManager);
+  systematicManager->registerSystematic("jes", {"jet1_pt"});
+
+  auto blockCfgMgr = ManagerFactory::createConfigurationManager(
+      "cfg/test_kinfit_block_config.txt");
+  KinematicFitManager blockMgr(*blockCfgMgr);
+  ManagerContext ctx{*blockCfgMgr, *dataManager, *systematicManager,
+                     *logger, *skimSink, *metaSink};
+  blockMgr.setContext(ctx);
+  blockMgr.applyFit("zhFitBlock");
+  blockMgr.applyFit("zhFitWarm");
+
+  auto df = dataManager->getDataFrame();
+  for (const std::string suffix : {"", "_jesUp", "_jesDown"}) {
+    auto cold = df.Take<Float_t>("zhFitBlock_chi2" + suffix);
+    auto warm = df.Take<Float_t>("zhFitWarm_chi2" + suffix);
+    auto converged = df.Take<bool>("zhFitWarm_converged" + suffix);
+    auto coldPt = df.Take<Float_t>("zhFitBlock_bjet1_pt_fitted" + suffix);
+    auto warmPt = df.Take<Float_t>("zhFitWarm_bjet1_pt_fitted" + suffix);
+    ASSERT_EQ(cold->size(), warm->size());
+    for (std::size_t i = 0; i < warm->size(); ++i) {
+      EXPECT_TRUE((*converged)[i]) << suffix;
+      EXPECT_NEAR((*warm)[i], (*cold)[i], 1e-2f * (1.0f + (*cold)[i])) << suffix;
+      EXPECT_NEAR((*warmPt)[i], (*coldPt)[i], 0.1f) << suffix;
+    }
+  }
+}
+
+TEST_F(KinematicFitManagerTest, ParseWarmStart_WithoutBlockMode_Throws) {
+  // warmStart needs the nominal and its variations in one block.
+  EXPECT_THROW(
+      {
+        auto mgr = ManagerFactory::createConfigurationManager(
+            "cfg/test_kinfit_warm_invalid_config.txt");
+        KinematicFitManager km(*mgr);
+      },
+      std::runtime_error);
+}
+
 #ifndef USE_CUDA
 TEST_F(KinematicFitManagerTest, ApplyFit_UseGpuTrue_WithoutCuda_Throws) {
   // When the build does NOT include CUDA, calling applyFit on a fit with
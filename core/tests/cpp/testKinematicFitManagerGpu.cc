@@ -106,6 +106,18 @@ TEST(KinematicFitManagerGpuIntegrationTest, GpuFitMatchesCpuReference) {
   }
 }
 
+TEST(KinematicFitManagerGpuIntegrationTest, BatchSettingsAreParsed) {
+  ChangeToTestSourceDir();
+
+  auto gpuConfig = ManagerFactory::createConfigurationManager("cfg/test_gpu_config.txt");
+  auto gpuManager = std::make_unique<KinematicFitManager>(*gpuConfig);
+
+  const auto &cfg = gpuManager->getFitConfig("wjFitGPU");
+  EXPECT_TRUE(cfg.useGPU);
+  EXPECT_EQ(cfg.gpuBatchSize, 64);
+  EXPECT_EQ(cfg.gpuBatchWaitMicroseconds, 100);
+}
+
 int main(int argc, char **argv) {
   ::testing::InitGoogleTest(&argc, argv);
   return RUN_ALL_TESTS();
@@ -1,7 +1,8 @@
 /**
  * @file testLeptonPhotonEnergyManagers.cc
  * @brief Unit tests for ElectronEnergyScaleManager, PhotonEnergyScaleManager,
- *        TauEnergyScaleManager, and MuonRochesterManager plugins.
+ *        TauEnergyScaleManager, and MuonRochesterManager plugins, and the
+ *        ObjectEnergyCorrectionPass combining them.
  *
  * Tests cover: column registration, correction steps, systematic variation
  * registration, PhysicsObjectCollection integration, lifecycle hooks, and
@@ -9,20 +10,24 @@
  */
 
 #include <ConfigurationManager.h>
+#include <CounterRng.h>
 #include <DataManager.h>
 #include <DefaultLogger.h>
 #include <ElectronEnergyScaleManager.h>
 #include <ManagerFactory.h>
 #include <MuonRochesterManager.h>
 #include <NullOutputSink.h>
+#include <ObjectEnergyCorrectionPass.h>
 #include <PhotonEnergyScaleManager.h>
 #include <PhysicsObjectCollection.h>
 #include <SystematicManager.h>
 #include <TauEnergyScaleManager.h>
 #include <api/ManagerContext.h>
+#include <cmath>
 #include <gtest/gtest.h>
 #include <stdexcept>
 #include <test_util.h>
+#include <vector>
 
 // ---------------------------------------------------------------------------
 // Shared helpers
@@ -220,6 +225,46 @@ TEST_F(ElectronEnergyScaleManagerTest, CorrectionAppliesSF) {
   EXPECT_NEAR(result.GetValue()[0][0], 55.0f, 0.01f);
 }
 
+// Correctness: bundled systematic set defines one pT bundle for all sources
+TEST_F(ElectronEnergyScaleManagerTest, BundledSystematicSetDefinesVariationMajorBundle) {
+  auto dm  = std::make_unique<DataManager>(1);
+  auto mgr = makeMgr(*dm);
+  auto cm  = std::make_unique<CorrectionManager>(*config);
+  auto ctx = makeContext(*config, *dm, *systematicManager, *logger,
+                         *skimSink, *metaSink);
+  cm->setContext(ctx);
+  cm->registerCorrection("ele_scale", "aux/jes_sources.json", "jes_sources",
+                         {"Electron_pt"});
+
+  defineRVecColumn(*dm, "Electron_pt", [](ULong64_t) { return 50.0f; },
+                   *systematicManager);
+  mgr->setObjectColumns("Electron_pt", "Electron_eta", "Electron_phi", "");
+  SystematicBundleOptions options;
+  options.mode = SystematicBundleMode::Auto;
+  mgr->setSystematicBundleOptions(options);
+  mgr->registerSystematicSources("scale", {"Total", "Flavor"});
+  mgr->applySystematicSet(*cm, "ele_scale", "scale", "Electron_pt",
+                          "Electron_pt_scale", false, {"Electron_pt"});
+  mgr->execute();
+
+  const auto *bundle = systematicManager->getVariationBundle("Electron_pt");
+  ASSERT_NE(bundle, nullptr);
+  EXPECT_EQ(bundle->column, makeBundleColumnName("Electron_pt_scale", "pt"));
+  EXPECT_EQ(bundle->variationLabels,
+            (std::vector<std::string>{"Nominal", "TotalUp", "TotalDown",
+                                      "FlavorUp", "FlavorDown"}));
+  auto df = dm->getDataFrame();
+  auto values = df.Take<ROOT::VecOps::RVec<Float_t>>(bundle->column);
+  ASSERT_EQ(values.GetValue()[0].size(), 5u);
+  EXPECT_NEAR(values.GetValue()[0][0], 50.0f, 1e-4f);
+  EXPECT_NEAR(values.GetValue()[0][1], 55.0f, 1e-4f);
+  EXPECT_NEAR(values.GetValue()[0][4], 47.5f, 1e-4f);
+  auto fannedOut =
+      df.Take<ROOT::VecOps::RVec<Float_t>>("Electron_pt_scale_Total_down");
+  EXPECT_NEAR(fannedOut.GetValue()[0][0], 45.0f, 1e-4f);
+  ASSERT_EQ(mgr->getVariations().size(), 2u);
+}
+
 // Correctness: collection output has corrected pT
 TEST_F(ElectronEnergyScaleManagerTest, CollectionOutputHasCorrectedPt) {
   auto dm  = std::make_unique<DataManager>(1);
@@ -929,6 +974,186 @@ TEST_F(MuonRochesterManagerTest, ReportMetadataIncludesRochesterColumns) {
   EXPECT_NO_THROW(mgr->reportMetadata());
 }
 
+// Rochester-layout corrections go through the typed per-event kernel; every
+// muon of the collection gets its own scale factor.
+TEST_F(MuonRochesterManagerTest, RochesterKernelEvaluatesEveryMuon) {
+  auto dm  = std::make_unique<DataManager>(1);
+  auto mgr = makeMgr(*dm);
+  auto cm  = std::make_unique<CorrectionManager>(*config);
+  auto ctx = makeContext(*config, *dm, *systematicManager, *logger,
+                         *skimSink, *metaSink);
+  cm->setContext(ctx);
+  const std::vector<std::string> inputs = {
+      "Muon_charge", "Muon_eta", "Muon_phi", "Muon_pt",
+      "Muon_genPt",  "Muon_nLayers", "Muon_u1", "Muon_u2"};
+  cm->registerCorrection("rochester", "aux/mock_muon_rochester.json",
+                         "mock_rochester", inputs);
+
+  dm->Define(
+      "Muon_pt",
+      [](ULong64_t) -> ROOT::VecOps::RVec<Float_t> { return {20.0f, 40.0f}; },
+      {"rdfentry_"}, *systematicManager);
+  dm->Define(
+      "Muon_charge",
+      [](ULong64_t) -> ROOT::VecOps::RVec<Float_t> { return {1.0f, -1.0f}; },
+      {"rdfentry_"}, *systematicManager);
+  for (const auto &col : {"Muon_eta", "Muon_phi", "Muon_genPt",
+                          "Muon_nLayers", "Muon_u1", "Muon_u2"}) {
+    dm->Define(
+        col,
+        [](ULong64_t) -> ROOT::VecOps::RVec<Float_t> { return {0.5f, 0.5f}; },
+        {"rdfentry_"}, *systematicManager);
+  }
+
+  mgr->setObjectColumns("Muon_pt", "Muon_eta", "Muon_phi", "Muon_mass");
+  mgr->setRochesterInputColumns("Muon_charge", "Muon_genPt", "Muon_nLayers",
+                                "Muon_u1", "Muon_u2");
+  mgr->applyRochesterCorrection(*cm, "rochester", "Muon_pt", "Muon_pt_roc");
+  mgr->execute();
+
+  auto result = dm->getDataFrame()
+                    .Take<ROOT::VecOps::RVec<Float_t>>("Muon_pt_roc");
+  ASSERT_EQ(result.GetValue()[0].size(), 2u);
+  EXPECT_NEAR(result.GetValue()[0][0], 20.0f * 1.03f, 1e-4f);
+  EXPECT_NEAR(result.GetValue()[0][1], 40.0f * 1.03f, 1e-4f);
+}
+
+// ===========================================================================
+// ObjectEnergyCorrectionPass tests
+// ===========================================================================
+
+class ObjectEnergyCorrectionPassTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    ChangeToTestSourceDir();
+    config = ManagerFactory::createConfigurationManager(
+        "cfg/test_data_config_minimal.txt");
+    systematicManager = std::make_unique<SystematicManager>();
+    logger = std::make_unique<DefaultLogger>();
+    skimSink = std::make_unique<NullOutputSink>();
+    metaSink = std::make_unique<NullOutputSink>();
+    dm = std::make_unique<DataManager>(1);
+    ctx = std::make_unique<ManagerContext>(makeContext(
+        *config, *dm, *systematicManager, *logger, *skimSink, *metaSink));
+  }
+
+  template <typename Manager> std::shared_ptr<Manager> makeMgr() {
+    auto mgr = std::make_shared<Manager>();
+    mgr->setContext(*ctx);
+    mgr->setupFromConfigFile();
+    return mgr;
+  }
+
+  void defineVector(const std::string &name, ROOT::VecOps::RVec<Float_t> values) {
+    dm->Define(name, [values](ULong64_t) { return values; }, {"rdfentry_"},
+               *systematicManager);
+  }
+
+  std::unique_ptr<IConfigurationProvider> config;
+  std::unique_ptr<SystematicManager> systematicManager;
+  std::unique_ptr<DefaultLogger> logger;
+  std::unique_ptr<NullOutputSink> skimSink;
+  std::unique_ptr<NullOutputSink> metaSink;
+  std::unique_ptr<DataManager> dm;
+  std::unique_ptr<ManagerContext> ctx;
+};
+
+// Electrons and photons enter one MET; "escale" is shared by both types.
+TEST_F(ObjectEnergyCorrectionPassTest, CombinedMETSumsAllTypesAndVariations) {
+  const float halfPi = static_cast<float>(M_PI / 2);
+  const float pi = static_cast<float>(M_PI);
+  defineVector("Electron_pt", {40.0f, 20.0f});
+  defineVector("Electron_phi", {0.0f, halfPi});
+  defineVector("Electron_eta", {0.0f, 0.0f});
+  defineVector("electron_sf", {1.1f, 1.1f});
+  defineVector("Electron_pt_up", {45.0f, 23.0f});
+  defineVector("Electron_pt_down", {43.0f, 21.0f});
+  defineVector("Photon_pt", {30.0f});
+  defineVector("Photon_phi", {pi});
+  defineVector("Photon_eta", {0.0f});
+  defineVector("Photon_pt_corr", {33.0f});
+  defineVector("Photon_pt_scaleUp", {34.0f});
+  defineVector("Photon_pt_scaleDown", {32.0f});
+  defineVector("Photon_pt_resUp", {33.5f});
+  defineVector("Photon_pt_resDown", {32.5f});
+  dm->Define("MET_pt", [](ULong64_t) { return 50.0f; }, {"rdfentry_"}, *systematicManager);
+  dm->Define("MET_phi", [](ULong64_t) { return 0.0f; }, {"rdfentry_"}, *systematicManager);
+
+  auto ele = makeMgr<ElectronEnergyScaleManager>();
+  ele->setObjectColumns("Electron_pt", "Electron_eta", "Electron_phi", "");
+  ele->applyCorrection("Electron_pt", "electron_sf", "Electron_pt_corr");
+  ele->addVariation("escale", "Electron_pt_up", "Electron_pt_down");
+  auto pho = makeMgr<PhotonEnergyScaleManager>();
+  pho->setObjectColumns("Photon_pt", "Photon_eta", "Photon_phi", "");
+  pho->addVariation("escale", "Photon_pt_scaleUp", "Photon_pt_scaleDown");
+  pho->addVariation("pres", "Photon_pt_resUp", "Photon_pt_resDown");
+
+  ObjectEnergyCorrectionPass pass;
+  pass.setContext(*ctx);
+  pass.addObjects(ele, "Electron_pt_corr");
+  pass.addObjects(pho, "Photon_pt_corr");
+  pass.propagateMET("MET_pt", "MET_phi", "MET_pt_corr", "MET_phi_corr");
+  EXPECT_EQ(pass.getVariationNames(), (std::vector<std::string>{"escale", "pres"}));
+  // Executes the electron correction too.
+  pass.execute();
+
+  auto df = dm->getDataFrame();
+  const auto met = [&df](const std::string &suffix) {
+    const float pt = df.Take<Float_t>("MET_pt_corr" + suffix).GetValue()[0];
+    const float phi = df.Take<Float_t>("MET_phi_corr" + suffix).GetValue()[0];
+    return std::make_pair(pt * std::cos(phi), pt * std::sin(phi));
+  };
+  // Nominal: electrons +4 along x and +2 along y, photon +3 along -x.
+  EXPECT_NEAR(met("").first, 49.0f, 1e-3f);
+  EXPECT_NEAR(met("").second, -2.0f, 1e-3f);
+  EXPECT_NEAR(met("_escaleUp").first, 49.0f, 1e-3f);
+  EXPECT_NEAR(met("_escaleUp").second, -3.0f, 1e-3f);
+  EXPECT_NEAR(met("_escaleDown").first, 49.0f, 1e-3f);
+  EXPECT_NEAR(met("_escaleDown").second, -1.0f, 1e-3f);
+  // Only the photon carries "pres"; the electrons keep their nominal shift.
+  EXPECT_NEAR(met("_presUp").first, 49.5f, 1e-3f);
+  EXPECT_NEAR(met("_presUp").second, -2.0f, 1e-3f);
+  EXPECT_NEAR(met("_presDown").first, 48.5f, 1e-3f);
+
+  EXPECT_EQ(systematicManager->getVariationColumnName("MET_pt_corr", "presUp"),
+            "MET_pt_corr_presUp");
+  EXPECT_EQ(systematicManager->getVariationColumnName("MET_phi_corr", "escaleDown"),
+            "MET_phi_corr_escaleDown");
+}
+
+// The threshold is tested on the reference pT, as in
+// ObjectEnergyManagerBase::propagateMET(): the third electron is corrected
+// above it but stays out of MET.
+TEST_F(ObjectEnergyCorrectionPassTest, ThresholdSkipsSoftObjects) {
+  defineVector("Electron_pt", {40.0f, 5.0f, 9.0f});
+  defineVector("Electron_phi", {0.0f, 0.0f, 0.0f});
+  defineVector("Electron_eta", {0.0f, 0.0f, 0.0f});
+  defineVector("Electron_pt_corr", {42.0f, 6.0f, 11.0f});
+  dm->Define("MET_pt", [](ULong64_t) { return 50.0f; }, {"rdfentry_"}, *systematicManager);
+  dm->Define("MET_phi", [](ULong64_t) { return 0.0f; }, {"rdfentry_"}, *systematicManager);
+
+  auto ele = makeMgr<ElectronEnergyScaleManager>();
+  ele->setObjectColumns("Electron_pt", "Electron_eta", "Electron_phi", "");
+  ObjectEnergyCorrectionPass pass;
+  pass.setContext(*ctx);
+  pass.addObjects(ele, "Electron_pt_corr", 10.0f);
+  pass.propagateMET("MET_pt", "MET_phi", "MET_pt_corr", "MET_phi_corr");
+  pass.execute();
+
+  auto pt = dm->getDataFrame().Take<Float_t>("MET_pt_corr");
+  EXPECT_NEAR(pt.GetValue()[0], 48.0f, 1e-3f);
+}
+
+TEST_F(ObjectEnergyCorrectionPassTest, InvalidArgumentsThrow) {
+  ObjectEnergyCorrectionPass pass;
+  EXPECT_THROW(pass.addObjects(nullptr, "pt"), std::invalid_argument);
+  auto ele = std::make_shared<ElectronEnergyScaleManager>();
+  EXPECT_THROW(pass.addObjects(ele, "Electron_pt_corr"), std::invalid_argument);
+  EXPECT_THROW(pass.propagateMET("MET_pt", "", "out_pt", "out_phi"),
+               std::invalid_argument);
+  EXPECT_THROW(pass.execute(), std::runtime_error);
+}
+
 // ===========================================================================
 // Reproducible Gaussian column tests (shared for all object types via
 // ElectronEnergyScaleManager as the representative concrete class)
@@ -1120,6 +1345,74 @@ TEST_F(ReproducibleGaussianTest, EmptySizeColumnThrows) {
       std::invalid_argument);
 }
 
+TEST_F(ReproducibleGaussianTest, ColumnMatchesCounterRng) {
+  // The column holds exactly the counter-based normals of the event, so a
+  // value can be reproduced outside the event loop.
+  auto dm = std::make_unique<DataManager>(3);
+  auto sm = std::make_unique<SystematicManager>();
+
+  defineUIntColumn(*dm, "run",  321, *sm);
+  defineUIntColumn(*dm, "lumi", 7, *sm);
+  defineULong64Column(*dm, "evt", 9000000000ULL, *sm);
+  defineRVecColumn(*dm, "Electron_pt",
+                   [](ULong64_t i) { return static_cast<Float_t>(20.0f + i); },
+                   *sm);
+
+  auto mgr = makeMgr(*dm, *sm);
+  mgr->setObjectColumns("Electron_pt", "Electron_eta", "Electron_phi", "");
+  mgr->defineReproducibleGaussian("Electron_u1", "Electron_pt",
+                                   "run", "lumi", "evt", "eer_u1");
+  mgr->execute();
+
+  auto r = dm->getDataFrame().Take<ROOT::VecOps::RVec<float>>("Electron_u1");
+  for (const auto &values : r.GetValue()) {
+    std::vector<float> expected(values.size());
+    counter_rng::fillNormals(counter_rng::saltKey("eer_u1"), 321, 7,
+                             9000000000ULL, expected.data(), expected.size());
+    for (std::size_t obj = 0; obj < values.size(); ++obj)
+      EXPECT_EQ(values[obj], expected[obj]);
+  }
+}
+
+// ---------------------------------------------------------------------------
+// CounterRng
+// ---------------------------------------------------------------------------
+
+TEST(CounterRngTest, PhiloxMatchesReferenceVectors) {
+  // Known-answer vectors of Random123's philox4x32_10.
+  const counter_rng::Counter zero =
+      counter_rng::philox4x32({0, 0, 0, 0}, {0, 0});
+  EXPECT_EQ(zero, (counter_rng::Counter{0x6627e8d5u, 0xe169c58du,
+                                         0xbc57ac4cu, 0x9b00dbd8u}));
+  const counter_rng::Counter pi = counter_rng::philox4x32(
+      {0x243f6a88u, 0x85a308d3u, 0x13198a2eu, 0x03707344u},
+      {0xa4093822u, 0x299f31d0u});
+  EXPECT_EQ(pi, (counter_rng::Counter{0xd16cfe09u, 0x94fdccebu,
+                                       0x5001e420u, 0x24126ea1u}));
+}
+
+TEST(CounterRngTest, ObjectValueIndependentOfCollectionSize) {
+  std::vector<float> all(150), first(5);
+  counter_rng::fillNormals(42, 1, 2, 3, all.data(), all.size());
+  counter_rng::fillNormals(42, 1, 2, 3, first.data(), first.size());
+  for (std::size_t i = 0; i < first.size(); ++i)
+    EXPECT_EQ(first[i], all[i]);
+}
+
+TEST(CounterRngTest, NormalsHaveUnitMoments) {
+  const std::size_t n = 200000;
+  std::vector<float> values(n);
+  counter_rng::fillNormals(counter_rng::saltKey("moments"), 1, 1, 1,
+                           values.data(), n);
+  double sum = 0.0, sum2 = 0.0;
+  for (float v : values) {
+    sum += v;
+    sum2 += static_cast<double>(v) * v;
+  }
+  EXPECT_NEAR(sum / n, 0.0, 0.01);
+  EXPECT_NEAR(sum2 / n, 1.0, 0.02);
+}
+
 int main(int argc, char **argv) {
   ::testing::InitGoogleTest(&argc, argv);
   return RUN_ALL_TESTS();
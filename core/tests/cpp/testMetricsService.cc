@@ -0,0 +1,138 @@
+/**
+ * @file testMetricsService.cc
+ * @brief Unit tests for MetricsService – live metrics written during and
+ *        after the event loop.
+ */
+
+#include <gtest/gtest.h>
+
+#include <ConfigurationManager.h>
+#include <DataManager.h>
+#include <DefaultLogger.h>
+#include <MetricsService.h>
+#include <NullOutputSink.h>
+#include <SystematicManager.h>
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+std::string readFile(const std::string &path) {
+  std::ifstream in(path);
+  std::stringstream content;
+  content << in.rdbuf();
+  return content.str();
+}
+
+} // namespace
+
+class MetricsServiceTest : public ::testing::Test {
+protected:
+  std::string cfgPath;
+  std::string metricsPath;
+
+  void SetUp() override {
+    const std::string base = std::string(TEST_SOURCE_DIR) + "/aux/metrics_test_";
+    cfgPath = base + "config.txt";
+    metricsPath = base + "metrics.json";
+    cleanup();
+  }
+  void TearDown() override { cleanup(); }
+  void cleanup() {
+    std::remove(cfgPath.c_str());
+    std::remove(metricsPath.c_str());
+  }
+
+  void writeConfig(const std::string &extra) {
+    std::ofstream out(cfgPath);
+    out << "sample=MetricsTest\n";
+    out << "fileList=\n";
+    out << "metricsFile=" << metricsPath << "\n";
+    out << extra;
+  }
+};
+
+TEST_F(MetricsServiceTest, FinalSnapshotCountsEveryEntry) {
+  writeConfig("metricsInterval=0.05\n");
+
+  ConfigurationManager config(cfgPath);
+  DataManager dataManager(1000);
+  SystematicManager systematicManager;
+  DefaultLogger logger;
+  NullOutputSink skimSink;
+  NullOutputSink metaSink;
+  ManagerContext ctx{config, dataManager, systematicManager, logger, skimSink, metaSink};
+
+  MetricsService svc;
+  svc.initialize(ctx);
+  auto df = dataManager.getDataFrame();
+  // Filters added after the service do not hide entries from it.
+  auto count = df.Filter([](ULong64_t entry) { return entry % 2 == 0; }, {"rdfentry_"}).Count();
+  EXPECT_EQ(count.GetValue(), 500u);
+  svc.finalize(df);
+
+  const std::string json = readFile(metricsPath);
+  EXPECT_NE(json.find("\"state\": \"finished\""), std::string::npos) << json;
+  EXPECT_NE(json.find("\"entries\": 1000,"), std::string::npos) << json;
+  EXPECT_NE(json.find("\"rss_mb\": "), std::string::npos);
+  EXPECT_EQ(json.find("\"last_progress\": 0.000"), std::string::npos) << json;
+}
+
+TEST_F(MetricsServiceTest, SnapshotBeforeTheLoopReportsSetup) {
+  writeConfig("");
+
+  ConfigurationManager config(cfgPath);
+  DataManager dataManager(10);
+  SystematicManager systematicManager;
+  DefaultLogger logger;
+  NullOutputSink skimSink;
+  NullOutputSink metaSink;
+  ManagerContext ctx{config, dataManager, systematicManager, logger, skimSink, metaSink};
+
+  MetricsService svc;
+  svc.initialize(ctx);
+  const auto snapshot = svc.snapshot();
+  EXPECT_EQ(snapshot.state, MetricsService::State::Setup);
+  EXPECT_EQ(snapshot.entries, 0u);
+  EXPECT_EQ(snapshot.slotEventsPerSecond.size(), snapshot.slotFiles.size());
+  EXPECT_GT(MetricsService::currentRssMegabytes(), 0.0);
+}
+
+TEST_F(MetricsServiceTest, PrometheusFormat) {
+  MetricsService::Snapshot snapshot;
+  snapshot.state = MetricsService::State::Running;
+  snapshot.entries = 42;
+  snapshot.slotEventsPerSecond = {10.0, 20.0};
+  snapshot.slotFiles = {"root://eos//store/a \"1\".root/Events", ""};
+
+  const std::string text = MetricsService::formatPrometheus(snapshot);
+  EXPECT_NE(text.find("# TYPE rdf_entries_processed_total counter\n"), std::string::npos);
+  EXPECT_NE(text.find("rdf_entries_processed_total 42\n"), std::string::npos);
+  EXPECT_NE(text.find("rdf_job_state{state=\"running\"} 1\n"), std::string::npos);
+  EXPECT_NE(text.find("rdf_job_state{state=\"setup\"} 0\n"), std::string::npos);
+  EXPECT_NE(text.find("rdf_slot_events_per_second{slot=\"1\"} 20.000\n"), std::string::npos);
+  EXPECT_NE(text.find("file=\"root://eos//store/a \\\"1\\\".root/Events\"} 1\n"),
+            std::string::npos)
+      << text;
+  // Slots that have not read a file yet have no file series.
+  EXPECT_EQ(text.find("rdf_slot_input_file_info{slot=\"1\""), std::string::npos);
+}
+
+TEST_F(MetricsServiceTest, InvalidConfigurationThrows) {
+  writeConfig("metricsFormat=xml\n");
+
+  ConfigurationManager config(cfgPath);
+  DataManager dataManager(10);
+  SystematicManager systematicManager;
+  DefaultLogger logger;
+  NullOutputSink skimSink;
+  NullOutputSink metaSink;
+  ManagerContext ctx{config, dataManager, systematicManager, logger, skimSink, metaSink};
+
+  MetricsService svc;
+  EXPECT_THROW(svc.initialize(ctx), std::runtime_error);
+}
@@ -0,0 +1,66 @@
+/**
+ * @file testMpiRuntime.cc
+ * @brief Unit tests for MpiRuntime – slicing a job between ranks and the
+ *        single-process behaviour of mpi=true.
+ */
+
+#include <gtest/gtest.h>
+
+#include <ConfigurationManager.h>
+#include <MpiRuntime.h>
+
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+const std::string kConfigPath =
+    std::string(TEST_SOURCE_DIR) + "/aux/test_mpi_runtime.txt";
+
+} // namespace
+
+TEST(MpiRuntimeTest, PartitionCoversTheRangeInRankOrder) {
+  std::uint64_t next = 100;
+  for (int rank = 0; rank < 7; ++rank) {
+    const auto [first, last] = MpiRuntime::partition(100, 150, rank, 7);
+    EXPECT_EQ(first, next);
+    // 50 entries over 7 ranks: the first rank gets the extra entry.
+    EXPECT_EQ(last - first, rank < 1 ? 8u : 7u);
+    next = last;
+  }
+  EXPECT_EQ(next, 150u);
+
+  // More ranks than entries leaves the last ranks empty.
+  const auto empty = MpiRuntime::partition(0, 2, 3, 4);
+  EXPECT_EQ(empty.first, empty.second);
+  EXPECT_THROW(MpiRuntime::partition(0, 10, 4, 4), std::invalid_argument);
+}
+
+TEST(MpiRuntimeTest, RankPathKeepsDirectoryAndExtension) {
+  EXPECT_EQ(MpiRuntime::rankPath("out/skim.root", 3), "out/skim.rank3.root");
+  EXPECT_EQ(MpiRuntime::rankPath("skim.root", 0), "skim.rank0.root");
+}
+
+TEST(MpiRuntimeTest, LeavesConfigWithoutMpiUnchanged) {
+  std::ofstream(kConfigPath) << "saveFile=skim.root\nmetaFile=meta.root\n";
+  ConfigurationManager config(kConfigPath);
+  MpiRuntime::configure(config);
+  EXPECT_EQ(config.get("metaFile"), "meta.root");
+  EXPECT_TRUE(config.get("mpiMetaFile").empty());
+  EXPECT_EQ(MpiRuntime::size(), 1);
+  // Not distributed: nothing to reduce.
+  EXPECT_NO_THROW(MpiRuntime::reduceOutputs(config));
+
+  config.set("mpi", "true");
+#if defined(HAS_MPI)
+  // A single process is one rank and writes its outputs directly.
+  MpiRuntime::configure(config);
+  EXPECT_TRUE(MpiRuntime::active());
+  EXPECT_EQ(config.get("metaFile"), "meta.root");
+#else
+  EXPECT_THROW(MpiRuntime::configure(config), std::runtime_error);
+#endif
+  std::remove(kConfigPath.c_str());
+}
@@ -1,14 +1,25 @@
 #include <ConfigurationManager.h>
 #include <test_util.h>
 #include <DataManager.h>
+#include <GraphCost.h>
 #include <ManagerFactory.h>
 #include <NDHistogramManager.h>
+#include <RegionManager.h>
 #include <api/IPluggableManager.h>
 #include <ROOT/RDataFrame.hxx>
+#include <TFile.h>
 #include <TH1D.h>
 #include <TH2D.h>
 #include <TH3D.h>
+#include <TKey.h>
+#include <WeightManager.h>
 #include <gtest/gtest.h>
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <map>
 #include <memory>
 #include <string>
 #include <vector>
@@ -449,4 +460,365 @@ TEST_F(NDHistogramManagerTest, ExecuteAndFinalizeAreNoOps) {
 
 TEST_F(NDHistogramManagerTest, GetDependenciesReturnsEmpty) {
   EXPECT_TRUE(histogramManager->getDependencies().empty());
-}
\ No newline at end of file
+}
+TEST_F(NDHistogramManagerTest, SharedValueAxisFillsPrecomputedBins) {
+  DataManager dm(5);
+  ManagerContext ctx{*configManager, dm, *systematicManager, *logger, *skimSink, *metaSink};
+  dm.Define("x", [](ULong64_t e) { return static_cast<float>(e) - 0.5f; }, {"rdfentry_"}, *systematicManager);
+  dm.Define("w", []() { return 1.0f; }, {}, *systematicManager);
+  dm.Define("w2", []() { return 2.0f; }, {}, *systematicManager);
+
+  NDHistogramManager manager(*configManager);
+  manager.setContext(ctx);
+
+  std::vector<histInfo> infos = {histInfo("x_w", "x", "x", "w", 3, 0.0, 3.0),
+                                 histInfo("x_w2", "x", "x", "w2", 3, 0.0, 3.0)};
+  std::vector<selectionInfo> selection;
+  std::vector<std::vector<std::string>> regionNames = {{"all"}};
+  manager.bookND(infos, selection, "", regionNames);
+
+  const auto columns = dm.getDataFrame().GetColumnNames();
+  EXPECT_NE(std::find(columns.begin(), columns.end(), "x__bin0"), columns.end());
+  ASSERT_EQ(manager.GetHistos().size(), 2u);
+
+  // x = -0.5 (underflow), 0.5, 1.5, 2.5, 3.5 (overflow).
+  std::unique_ptr<TH1D> first(manager.GetHistos()[0]->Projection(4));
+  std::unique_ptr<TH1D> second(manager.GetHistos()[1]->Projection(4));
+  for (int bin = 1; bin <= 3; ++bin) {
+    EXPECT_DOUBLE_EQ(first->GetBinContent(bin), 1.0);
+    EXPECT_DOUBLE_EQ(second->GetBinContent(bin), 2.0);
+  }
+}
+
+TEST_F(NDHistogramManagerTest, EstimateCostCountsBookedCells) {
+  DataManager dm(5);
+  ManagerContext ctx{*configManager, dm, *systematicManager, *logger, *skimSink, *metaSink};
+  dm.Define("cost_x", [](ULong64_t e) { return static_cast<float>(e); }, {"rdfentry_"}, *systematicManager);
+  dm.Define("cost_w", []() { return 1.0f; }, {}, *systematicManager);
+
+  NDHistogramManager manager(*configManager);
+  manager.setContext(ctx);
+  std::vector<histInfo> infos = {histInfo("cost_x", "cost_x", "x", "cost_w", 8, 0.0, 8.0)};
+  std::vector<selectionInfo> selection;
+  std::vector<std::vector<std::string>> regionNames = {{"all"}};
+  manager.bookND(infos, selection, "", regionNames);
+
+  GraphCost cost;
+  manager.estimateCost(cost);
+  ASSERT_EQ(cost.histograms.size(), 1u);
+  EXPECT_EQ(cost.histograms[0].name.rfind("cost_x", 0), 0u);
+
+  // Every axis of the booked histogram with under- and overflow.
+  std::uint64_t cells = 1;
+  const auto &histogram = manager.GetHistos()[0];
+  for (int axis = 0; axis < histogram->GetNdimensions(); ++axis) {
+    cells *= histogram->GetAxis(axis)->GetNbins() + 2;
+  }
+  EXPECT_EQ(cost.histograms[0].cells, cells);
+  // Small enough for the dense storage: content and variance per cell.
+  EXPECT_EQ(cost.histograms[0].bytesPerSlot, cells * 16);
+
+  EXPECT_TRUE(cost.checkBudgets(*configManager));
+  configManager->set("costBudgetHistogramCells", std::to_string(cells - 1));
+  EXPECT_FALSE(cost.checkBudgets(*configManager));
+  ASSERT_EQ(cost.warnings.size(), 1u);
+  EXPECT_NE(cost.toJson().find("\"name\": \"cost_x"), std::string::npos);
+}
+
+TEST_F(NDHistogramManagerTest, VariableWidthBinsBookWithEdges) {
+  DataManager dm(4);
+  ManagerContext ctx{*configManager, dm, *systematicManager, *logger, *skimSink, *metaSink};
+  dm.Define("pt", [](ULong64_t e) { return 25.0f * static_cast<float>(e + 1); }, {"rdfentry_"}, *systematicManager);
+  dm.Define("w", []() { return 1.0f; }, {}, *systematicManager);
+
+  NDHistogramManager manager(*configManager);
+  manager.setContext(ctx);
+
+  histInfo info("pt", "pt", "p_{T}", "w", std::vector<float>{20.f, 40.f, 80.f, 200.f});
+  EXPECT_EQ(info.bins(), 3);
+  manager.BookSingleHistogram(info);
+  ASSERT_EQ(manager.GetHistos().size(), 1u);
+
+  // pt = 25, 50, 75, 100.
+  std::unique_ptr<TH1D> projection(manager.GetHistos()[0]->Projection(4));
+  EXPECT_DOUBLE_EQ(projection->GetXaxis()->GetBinUpEdge(2), 80.0);
+  EXPECT_DOUBLE_EQ(projection->GetBinContent(1), 1.0);
+  EXPECT_DOUBLE_EQ(projection->GetBinContent(2), 2.0);
+  EXPECT_DOUBLE_EQ(projection->GetBinContent(3), 1.0);
+
+  EXPECT_THROW(histInfo("bad", "pt", "pt", "w", std::vector<float>{1.f}), std::runtime_error);
+}
+
+// ---------------------------------------------------------------------------
+// Region axis
+// ---------------------------------------------------------------------------
+
+TEST_F(NDHistogramManagerTest, RegionAxisFusesChannelIntoOneHistogram) {
+  DataManager dm(4);
+  ManagerContext ctx{*configManager, dm, *systematicManager, *logger, *skimSink, *metaSink};
+  dm.Define("x", [](ULong64_t e) { return static_cast<double>(e); }, {"rdfentry_"}, *systematicManager);
+  dm.Define("w", []() { return 1.0; }, {}, *systematicManager);
+  dm.Define("ch", [](ULong64_t e) { return static_cast<float>(e % 2); }, {"rdfentry_"}, *systematicManager);
+  dm.Define("pass_a", [](ULong64_t e) { return e < 2; }, {"rdfentry_"}, *systematicManager);
+  dm.Define("pass_b", [](ULong64_t e) { return e % 2 == 0 && e < 3; }, {"rdfentry_"}, *systematicManager);
+
+  RegionManager rm;
+  rm.setContext(ctx);
+  rm.setupFromConfigFile();
+  rm.declareRegion("a", "pass_a");
+  rm.declareRegion("b", "pass_b");
+
+  NDHistogramManager manager(*configManager);
+  manager.setContext(ctx);
+  manager.bindToRegionManager(&rm);
+
+  std::vector<histInfo> infos = {histInfo("x", "x", "x", "w", 4, 0.0, 4.0)};
+  std::vector<selectionInfo> selection = {selectionInfo("ch", 2, 0.0, 2.0, {"ee", "mm"})};
+  std::vector<std::vector<std::string>> regionNames = {{"ee", "mm"}};
+  manager.bookND(infos, selection, "", regionNames);
+
+  ASSERT_EQ(manager.GetHistos().size(), 1u);
+  EXPECT_EQ(regionNames[0], (std::vector<std::string>{"a_ee", "a_mm", "b_ee", "b_mm"}));
+
+  // Entry 0: a_ee, b_ee; entry 1: a_mm; entry 2: b_ee; entry 3: no region.
+  std::unique_ptr<TH1D> perRegion(manager.GetHistos()[0]->Projection(0));
+  EXPECT_DOUBLE_EQ(perRegion->GetBinContent(1), 1.0);
+  EXPECT_DOUBLE_EQ(perRegion->GetBinContent(2), 1.0);
+  EXPECT_DOUBLE_EQ(perRegion->GetBinContent(3), 2.0);
+  EXPECT_DOUBLE_EQ(perRegion->GetBinContent(4), 0.0);
+}
+
+TEST_F(NDHistogramManagerTest, RegionAxisSkipsCollectionVariable) {
+  DataManager dm(2);
+  ManagerContext ctx{*configManager, dm, *systematicManager, *logger, *skimSink, *metaSink};
+  dm.Define("pass", []() { return true; }, {}, *systematicManager);
+  dm.Define("jets", []() { return ROOT::VecOps::RVec<Float_t>{1.f, 2.f}; }, {}, *systematicManager);
+  dm.Define("w", []() { return 1.0; }, {}, *systematicManager);
+
+  RegionManager rm;
+  rm.setContext(ctx);
+  rm.setupFromConfigFile();
+  rm.declareRegion("all", "pass");
+
+  NDHistogramManager manager(*configManager);
+  manager.setContext(ctx);
+  manager.bindToRegionManager(&rm);
+
+  // Booked as without a RegionManager: every jet of both entries is filled.
+  histInfo info("jets", "jets", "jets", "w", 4, 0.0, 4.0);
+  manager.BookSingleHistogram(info);
+  ASSERT_EQ(manager.GetHistos().size(), 1u);
+  std::unique_ptr<TH1D> projection(manager.GetHistos()[0]->Projection(4));
+  EXPECT_DOUBLE_EQ(projection->GetBinContent(2), 2.0);
+  EXPECT_DOUBLE_EQ(projection->GetBinContent(3), 2.0);
+}
+
+TEST_F(NDHistogramManagerTest, VariationPlanSkipsUnlistedVariationsPerRegion) {
+  const std::string planPath = "variation_plan_test.txt";
+  {
+    std::ofstream plan(planPath);
+    plan << "region=a systematics=Nominal,jes\n";
+  }
+  configManager->set("histogramVariationPlan", planPath);
+
+  DataManager dm(2);
+  ManagerContext ctx{*configManager, dm, *systematicManager, *logger, *skimSink, *metaSink};
+  for (const std::string name : {"x", "x_jesUp", "x_jesDown", "x_puUp", "x_puDown"}) {
+    dm.Define(name, []() { return 1.0; }, {}, *systematicManager);
+  }
+  dm.Define("w", []() { return 1.0; }, {}, *systematicManager);
+  dm.Define("ch", []() { return 0.5f; }, {}, *systematicManager);
+  dm.Define("pass", []() { return true; }, {}, *systematicManager);
+  systematicManager->registerSystematic("jes", {"x"});
+  systematicManager->registerSystematic("pu", {"x"});
+
+  RegionManager rm;
+  rm.setContext(ctx);
+  rm.setupFromConfigFile();
+  rm.declareRegion("a", "pass");
+  rm.declareRegion("b", "pass");
+
+  NDHistogramManager manager(*configManager);
+  manager.setContext(ctx);
+  manager.setupFromConfigFile();
+  manager.bindToRegionManager(&rm);
+
+  std::vector<histInfo> infos = {histInfo("x", "x", "x", "w", 4, 0.0, 4.0)};
+  std::vector<selectionInfo> selection = {selectionInfo("ch", 1, 0.0, 1.0, {"all"})};
+  std::vector<std::vector<std::string>> regionNames = {{"all"}};
+  manager.bookND(infos, selection, "", regionNames);
+  ASSERT_EQ(manager.GetHistos().size(), 1u);
+
+  // Region axis (0): a, b; systematic axis (3): Nominal, jesUp, jesDown,
+  // puUp, puDown.  Region a only fills the variations its plan lists; b is
+  // not in the plan and fills all of them.
+  std::unique_ptr<TH2D> cells(manager.GetHistos()[0]->Projection(3, 0));
+  for (int syst = 1; syst <= 5; ++syst) {
+    EXPECT_DOUBLE_EQ(cells->GetBinContent(1, syst), syst <= 3 ? 2.0 : 0.0) << syst;
+    EXPECT_DOUBLE_EQ(cells->GetBinContent(2, syst), 2.0) << syst;
+  }
+  std::remove(planPath.c_str());
+}
+
+// ---------------------------------------------------------------------------
+// Parallel saveHists
+// ---------------------------------------------------------------------------
+
+namespace {
+
+/// Bin contents of every histogram in @p path, keyed by "<dir>/<name>;<cycle>".
+std::map<std::string, std::vector<double>> readSavedHistograms(const std::string &path) {
+  std::map<std::string, std::vector<double>> contents;
+  std::unique_ptr<TFile> file(TFile::Open(path.c_str(), "READ"));
+  if (!file) {
+    return contents;
+  }
+  std::function<void(TDirectory *, const std::string &)> walk =
+      [&](TDirectory *dir, const std::string &prefix) {
+        for (TObject *object : *dir->GetListOfKeys()) {
+          auto *key = static_cast<TKey *>(object);
+          const std::string name = prefix + key->GetName();
+          if (key->IsFolder()) {
+            walk(dir->GetDirectory(key->GetName()), name + "/");
+            continue;
+          }
+          std::unique_ptr<TH1> hist(key->ReadObject<TH1>());
+          std::vector<double> bins;
+          for (int b = 0; b <= hist->GetNbinsX() + 1; ++b) {
+            bins.push_back(hist->GetBinContent(b));
+            bins.push_back(hist->GetBinError(b));
+          }
+          contents[name + ";" + std::to_string(key->GetCycle())] = bins;
+        }
+      };
+  walk(file.get(), "");
+  return contents;
+}
+
+} // namespace
+
+TEST_F(NDHistogramManagerTest, ParallelSaveHistsMatchesSerialOutput) {
+  // Each save uses a fresh manager whose event loop has not run yet, so the
+  // parallel save also starts the loop (first, before any serial save).
+  const std::string output = configManager->get("saveFile");
+  const auto save = [&](bool parallel) {
+    if (parallel) {
+      ROOT::EnableImplicitMT(4);
+    }
+    DataManager dm(1);
+    SystematicManager systematics;
+    ManagerContext ctx{*configManager, dm, systematics, *logger, *skimSink, *metaSink};
+    NDHistogramManager manager(*configManager);
+    manager.setContext(ctx);
+
+    dm.Define("par_sel", []() { return 1.0; }, {}, systematics);
+    dm.Define("par_x", []() { return 3.5; }, {}, systematics);
+    dm.Define("par_y", []() { return 7.5; }, {}, systematics);
+    dm.Define("par_w", []() { return 2.0; }, {}, systematics);
+
+    std::vector<histInfo> infos;
+    for (int i = 0; i < 8; ++i) {
+      const std::string name = "par_hist" + std::to_string(i);
+      infos.emplace_back(name.c_str(), i % 2 ? "par_x" : "par_y", "label", "par_w", 10, 0.0, 10.0);
+    }
+    std::vector<selectionInfo> selection = {selectionInfo("par_sel", 5, 0.0, 5.0)};
+    std::vector<std::vector<std::string>> regionNames = {{"par_region1", "par_region2"}};
+    regionNames.push_back(systematics.makeSystList("Systematic", dm));
+    manager.bookND(infos, selection, "", regionNames);
+    std::vector<std::vector<histInfo>> fullHistList = {infos};
+
+    std::filesystem::remove(output);
+    manager.saveHists(fullHistList, regionNames);
+    ROOT::DisableImplicitMT();
+    auto contents = readSavedHistograms(output);
+    std::filesystem::remove(output);
+    return contents;
+  };
+
+  const auto parallel = save(true);
+  const auto serial = save(false);
+  EXPECT_FALSE(serial.empty());
+  EXPECT_EQ(serial, parallel);
+}
+
+TEST_F(NDHistogramManagerTest, PruningSkipsHistogramsWithoutVariations) {
+  for (const std::string name : {"pr_x", "pr_x_jesUp", "pr_x_jesDown"}) {
+    dataManager->Define(name, []() { return 3.5; }, {}, *systematicManager);
+  }
+  dataManager->Define("pr_y", []() { return 7.5; }, {}, *systematicManager);
+  dataManager->Define("pr_w", []() { return 1.0; }, {}, *systematicManager);
+  dataManager->Define("pr_sel", []() { return 1.0; }, {}, *systematicManager);
+  systematicManager->registerSystematic("jes", {"pr_x"});
+
+  // pr_x is filled for jes (without any effect); pr_y is booked nominal-only.
+  std::vector<histInfo> infos = {histInfo("pr_varied", "pr_x", "x", "pr_w", 10, 0.0, 10.0),
+                                 histInfo("pr_free", "pr_y", "y", "pr_w", 10, 0.0, 10.0)};
+  std::vector<selectionInfo> selection = {selectionInfo("pr_sel", 5, 0.0, 5.0)};
+  std::vector<std::vector<std::string>> regionNames = {{"pr_region"}};
+  histogramManager->bookND(infos, selection, "", regionNames);
+  std::vector<std::vector<histInfo>> fullHistList = {infos};
+  const std::string output = configManager->get("saveFile");
+
+  // Impacts are only measured in a pruning pass.
+  histogramManager->saveHists(fullHistList, regionNames);
+  EXPECT_TRUE(systematicManager->getSystematicImpacts().empty());
+
+  configManager->set("systematicPruningReport", "pruning_report_test.json");
+  histogramManager->saveHists(fullHistList, regionNames);
+  std::filesystem::remove(output);
+  const auto &impacts = systematicManager->getSystematicImpacts();
+  ASSERT_EQ(impacts.count("jes"), 1u);
+  EXPECT_DOUBLE_EQ(impacts.at("jes").normalization, 0.0);
+  EXPECT_DOUBLE_EQ(impacts.at("jes").shape, 0.0);
+  EXPECT_EQ(systematicManager->selectPrunableSystematics(0.01, 0.01),
+            std::vector<std::string>{"jes"});
+}
+
+TEST_F(NDHistogramManagerTest, WeightVectorIsSavedAsOneHistogramPerLabel) {
+  dataManager->Define("wv_sel", []() { return 0.5; }, {}, *systematicManager);
+  dataManager->Define("wv_x", []() { return 3.5; }, {}, *systematicManager);
+  dataManager->Define("wv_sf", []() { return 2.0; }, {}, *systematicManager);
+  dataManager->Define(
+      "wv_factors", []() { return ROOT::VecOps::RVec<float>{1.0f, 1.5f, 0.5f}; }, {},
+      *systematicManager);
+
+  const std::vector<std::string> labels = {"Nominal", "pdf_1", "pdf_2"};
+  WeightManager weights;
+  ManagerContext ctx{*configManager, *dataManager, *systematicManager, *logger, *skimSink, *metaSink};
+  weights.setContext(ctx);
+  weights.setupFromConfigFile();
+  weights.addScaleFactor("sf", "wv_sf");
+  weights.addWeightVectorVariation("pdf", "wv_factors", labels);
+  weights.defineNominalWeight("wv_weight_nominal");
+  weights.defineVariedWeightVector("pdf", "wv_weight_pdf");
+  weights.execute();
+  histogramManager->registerWeightVector("wv_weight_pdf", labels);
+
+  std::vector<histInfo> infos = {
+      histInfo("wv_hist", "wv_x", "label", "wv_weight_pdf", 10, 0.0, 10.0)};
+  std::vector<selectionInfo> selection = {selectionInfo("wv_sel", 1, 0.0, 1.0)};
+  std::vector<std::vector<std::string>> regionNames = {{"wv_region"}};
+  histogramManager->bookND(infos, selection, "", regionNames);
+  std::vector<std::vector<histInfo>> fullHistList = {infos};
+
+  const std::string output = configManager->get("saveFile");
+  std::filesystem::remove(output);
+  histogramManager->saveHists(fullHistList, regionNames);
+  const auto saved = readSavedHistograms(output);
+  std::filesystem::remove(output);
+
+  // Nominal weight 2 times each factor, in bin 4 of the value axis.
+  const auto content = [&saved](const std::string &name) {
+    for (const auto &[key, bins] : saved) {
+      if (key.size() > name.size() + 3 &&
+          key.compare(key.size() - name.size() - 3, name.size() + 3, "/" + name + ";1") == 0) {
+        return bins[2 * 4];
+      }
+    }
+    ADD_FAILURE() << name << " was not saved";
+    return 0.0;
+  };
+  EXPECT_DOUBLE_EQ(content("wv_hist"), 2.0);
+  EXPECT_DOUBLE_EQ(content("wv_hist_pdf_1"), 3.0);
+  EXPECT_DOUBLE_EQ(content("wv_hist_pdf_2"), 1.0);
+}
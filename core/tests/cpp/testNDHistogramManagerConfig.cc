@@ -11,12 +11,59 @@
 #include <string>
 #include <vector>
 #include <fstream>
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <numeric>
 #include <plots.h>
 #include <SystematicManager.h>
 #include <DefaultLogger.h>
 #include <NullOutputSink.h>
 #include <api/ManagerContext.h>
 
+namespace {
+
+/// Host-side HistDeviceSink standing in for the GPU storage.
+class HostHistSink : public HistDeviceSink {
+public:
+  explicit HostHistSink(std::size_t cells) : bins_m(2 * cells, 0.0) {}
+
+  std::size_t cells() const override { return bins_m.size() / 2; }
+
+  void add(const std::uint64_t *cells, const float *weights, std::size_t n) override {
+    ++batches;
+    for (std::size_t i = 0; i < n; ++i) {
+      const double w = weights[i];
+      bins_m[2 * cells[i]] += w;
+      bins_m[2 * cells[i] + 1] += w * w;
+    }
+  }
+
+  void download(double *interleaved) override {
+    std::copy(bins_m.begin(), bins_m.end(), interleaved);
+  }
+
+  std::size_t batches = 0;
+
+private:
+  std::vector<double> bins_m;
+};
+
+/// Expect @p result to hold the same bins as @p expected.
+void expectSameBins(THnSparseF &expected, THnSparseF &result) {
+  ASSERT_EQ(result.GetNbins(), expected.GetNbins());
+  std::vector<Int_t> idx(expected.GetNdimensions());
+  for (Long64_t bin = 0; bin < expected.GetNbins(); ++bin) {
+    const Double_t content = expected.GetBinContent(bin, idx.data());
+    const Long64_t match = result.GetBin(idx.data(), false);
+    ASSERT_GE(match, 0) << "bin " << bin;
+    EXPECT_DOUBLE_EQ(result.GetBinContent(match), content) << "bin " << bin;
+    EXPECT_DOUBLE_EQ(result.GetBinError2(match), expected.GetBinError2(bin)) << "bin " << bin;
+  }
+}
+
+} // namespace
+
 class NDHistogramManagerConfigTest : public ::testing::Test {
 protected:
   void SetUp() override {
@@ -357,6 +404,50 @@ TEST_F(NDHistogramManagerConfigTest, InvalidBackendThrows) {
   EXPECT_THROW(histogramManager->setupFromConfigFile(), std::runtime_error);
 }
 
+TEST_F(NDHistogramManagerConfigTest, PerHistogramBackendOverride) {
+  dataManager->Define("var1", []() { return 5.0f; }, {}, *systematicManager);
+  dataManager->Define("w1", []() { return 1.0f; }, {}, *systematicManager);
+
+  configManager->set("histogramConfig", "cfg/test_histograms_backend.txt");
+  histogramManager->setupFromConfigFile();
+
+  const auto &configs = histogramManager->getConfigHistograms();
+  ASSERT_EQ(configs.size(), 2u);
+  EXPECT_EQ(configs[0].backend, "boost");
+  EXPECT_TRUE(configs[1].backend.empty());
+
+  EXPECT_NO_THROW(histogramManager->bookConfigHistograms());
+  EXPECT_EQ(histogramManager->GetHistos().size(), 2u);
+}
+
+TEST_F(NDHistogramManagerConfigTest, BoostCollapsedAxesMatchFullHistogram) {
+  // Only the value axis has more than one bin, so BHnMulti uses a static 1D
+  // accumulator.  A fill outside the single channel bin must be dropped.
+  histFillInfo fillInfo;
+  fillInfo.name = "boost_collapsed";
+  fillInfo.title = "boost_collapsed";
+  fillInfo.nSlots = 2;
+  fillInfo.nbins = {1, 1, 1, 1, 10};
+  fillInfo.xmin = {0.0, 0.0, 0.0, 0.0, 0.0};
+  fillInfo.xmax = {1.0, 1.0, 1.0, 1.0, 10.0};
+  BHnMulti action(fillInfo);
+
+  const ROOT::VecOps::RVec<Float_t> zero{0.0f};
+  const ROOT::VecOps::RVec<Int_t> nFills{1};
+  action.Exec(0, {3.5f}, {2.0f}, zero, zero, zero, zero, nFills);
+  action.Exec(1, {3.5f}, {0.5f}, zero, zero, zero, zero, nFills);
+  action.Exec(1, {3.5f}, {4.0f}, zero, zero, zero, {1.5f}, nFills);
+  action.Finalize();
+
+  auto result = action.GetResultPtr();
+  EXPECT_EQ(result->GetNbins(), 1);
+  const Double_t coords[5] = {0.5, 0.5, 0.5, 0.5, 3.5};
+  const Long64_t bin = result->GetBin(coords, false);
+  ASSERT_GE(bin, 0);
+  EXPECT_DOUBLE_EQ(result->GetBinContent(bin), 2.5);
+  EXPECT_DOUBLE_EQ(result->GetBinError2(bin), 2.0 * 2.0 + 0.5 * 0.5);
+}
+
 // ── Dense / sparse auto-selection tests ───────────────────────────────────────
 
 TEST_F(NDHistogramManagerConfigTest, EstimateDenseMemorySmallHistogram) {
@@ -403,6 +494,506 @@ TEST_F(NDHistogramManagerConfigTest, RootBackendAutoSelectsDense) {
   EXPECT_EQ(histogramManager->GetHistos().size(), 4u);
 }
 
+TEST_F(NDHistogramManagerConfigTest, RootDenseAccumulatorMergesSlotsIntoSparseResult) {
+  // Drive THnMulti directly: two slots fill the same bin and one fills an
+  // underflow bin, which the dense-to-sparse conversion drops.
+  histFillInfo fillInfo;
+  fillInfo.name = "dense_direct";
+  fillInfo.title = "dense_direct";
+  fillInfo.nSlots = 2;
+  fillInfo.nbins = {2, 2, 2, 2, 10};
+  fillInfo.xmin = {0.0, 0.0, 0.0, 0.0, 0.0};
+  fillInfo.xmax = {2.0, 2.0, 2.0, 2.0, 10.0};
+  THnMulti action(fillInfo);
+
+  const ROOT::VecOps::RVec<Float_t> one{0.5f};
+  const ROOT::VecOps::RVec<Int_t> nFills{1};
+  action.Exec(0, {3.5f}, {2.0f}, one, one, one, one, nFills);
+  action.Exec(1, {3.5f}, {0.5f}, one, one, one, one, nFills);
+  action.Exec(1, {-1.0f}, {4.0f}, one, one, one, one, nFills);
+  action.Finalize();
+
+  auto result = action.GetResultPtr();
+  EXPECT_EQ(result->GetNbins(), 1);
+  const Double_t coords[5] = {0.5, 0.5, 0.5, 0.5, 3.5};
+  const Long64_t bin = result->GetBin(coords, false);
+  ASSERT_GE(bin, 0);
+  EXPECT_DOUBLE_EQ(result->GetBinContent(bin), 2.5);
+  EXPECT_DOUBLE_EQ(result->GetBinError2(bin), 2.0 * 2.0 + 0.5 * 0.5);
+}
+
+TEST_F(NDHistogramManagerConfigTest, THnMultiScalarFillMatchesSingleElementVectors) {
+  histFillInfo fillInfo;
+  fillInfo.name = "scalar_fill";
+  fillInfo.title = "scalar_fill";
+  fillInfo.nSlots = 1;
+  fillInfo.nbins = {2, 2, 2, 1, 10};
+  fillInfo.xmin = {0.0, 0.0, 0.0, 0.0, 0.0};
+  fillInfo.xmax = {2.0, 2.0, 2.0, 1.0, 10.0};
+  THnMulti vectorAction(fillInfo);
+  THnMulti scalarAction(fillInfo);
+
+  const ROOT::VecOps::RVec<Float_t> nominal{0.0f};
+  const ROOT::VecOps::RVec<Int_t> nFills{1};
+  vectorAction.Exec(0, {3.5f}, {2.0f}, nominal, {1.5f}, {0.5f}, {1.5f}, nFills);
+  vectorAction.Exec(0, {7.5f}, {0.0f}, nominal, {1.5f}, {0.5f}, {1.5f}, nFills);
+  scalarAction.Exec(0, 3.5f, 2.0f, 1.5f, 0.5f, 1.5f);
+  scalarAction.Exec(0, 7.5f, 0.0f, 1.5f, 0.5f, 1.5f);
+  vectorAction.Finalize();
+  scalarAction.Finalize();
+
+  auto expected = vectorAction.GetResultPtr();
+  auto result = scalarAction.GetResultPtr();
+  ASSERT_EQ(result->GetNbins(), 1);
+  ASSERT_EQ(expected->GetNbins(), 1);
+  const Double_t coords[5] = {1.5, 0.5, 1.5, 0.0, 3.5};
+  EXPECT_DOUBLE_EQ(result->GetBinContent(result->GetBin(coords, false)),
+                   expected->GetBinContent(expected->GetBin(coords, false)));
+  EXPECT_DOUBLE_EQ(result->GetBinContent(result->GetBin(coords, false)), 2.0);
+}
+
+TEST_F(NDHistogramManagerConfigTest, THnMultiWeightVectorFillsOneSystematicBinPerEntry) {
+  // Dense storage with the systematic axis innermost: the three weights land
+  // in adjacent cells; the sparse fallback must agree.
+  histFillInfo fillInfo;
+  fillInfo.name = "weight_vector";
+  fillInfo.title = "weight_vector";
+  fillInfo.nSlots = 1;
+  fillInfo.nbins = {2, 2, 2, 3, 10};
+  fillInfo.xmin = {0.0, 0.0, 0.0, 0.0, 0.0};
+  fillInfo.xmax = {2.0, 2.0, 2.0, 3.0, 10.0};
+  fillInfo.weightVector = true;
+  THnMulti dense(fillInfo);
+
+  fillInfo.nbins = {200, 200, 200, 3, 200};
+  fillInfo.xmax = {200.0, 200.0, 200.0, 3.0, 200.0};
+  THnMulti sparse(fillInfo);
+
+  const ROOT::VecOps::RVec<Float_t> weights{1.0f, 0.0f, 3.0f, 4.0f};
+  dense.Exec(0, 3.5f, weights, 1.5f, 0.5f, 1.5f);
+  dense.Exec(0, 3.5f, weights, 1.5f, 0.5f, 1.5f);
+  sparse.Exec(0, 3.5f, weights, 1.5f, 0.5f, 1.5f);
+  dense.Finalize();
+  sparse.Finalize();
+
+  for (auto result : {dense.GetResultPtr(), sparse.GetResultPtr()}) {
+    // The zero weight fills nothing; the fourth has no systematic bin.
+    EXPECT_EQ(result->GetNbins(), 2);
+  }
+  auto result = dense.GetResultPtr();
+  const Double_t first[5] = {1.5, 0.5, 1.5, 0.5, 3.5};
+  const Double_t third[5] = {1.5, 0.5, 1.5, 2.5, 3.5};
+  EXPECT_DOUBLE_EQ(result->GetBinContent(result->GetBin(first, false)), 2.0);
+  EXPECT_DOUBLE_EQ(result->GetBinContent(result->GetBin(third, false)), 6.0);
+  EXPECT_DOUBLE_EQ(result->GetBinError2(result->GetBin(third, false)), 18.0);
+}
+
+TEST_F(NDHistogramManagerConfigTest, THnMultiFlushesSparseSlotsAboveMemoryCeiling) {
+  // Sparse storage; the ceiling leaves room for three bins per slot.
+  histFillInfo fillInfo;
+  fillInfo.name = "sparse_ceiling";
+  fillInfo.title = "sparse_ceiling";
+  fillInfo.nSlots = 2;
+  fillInfo.nbins = {100, 100, 100, 100, 100};
+  fillInfo.xmin = {0.0, 0.0, 0.0, 0.0, 0.0};
+  fillInfo.xmax = {100.0, 100.0, 100.0, 100.0, 100.0};
+  const std::size_t bytesPerBin = estimateSparseBytesPerBin(fillInfo.nbins);
+  fillInfo.memoryCeilingBytes = 2 * 3 * bytesPerBin;
+  fillInfo.memoryReport = std::make_shared<HistMemoryReport>();
+  THnMulti action(fillInfo);
+
+  const ROOT::VecOps::RVec<Float_t> one{0.5f};
+  const ROOT::VecOps::RVec<Int_t> nFills{1};
+  for (int i = 0; i < 10; ++i) {
+    action.Exec(0, {i + 0.5f}, {1.0f}, one, one, one, one, nFills);
+  }
+  action.Exec(1, {0.5f}, {2.0f}, one, one, one, one, nFills);
+  action.Finalize();
+
+  // Flushed and remaining slot contents all reach the result.
+  auto result = action.GetResultPtr();
+  EXPECT_EQ(result->GetNbins(), 10);
+  const Double_t coords[5] = {0.5, 0.5, 0.5, 0.5, 0.5};
+  EXPECT_DOUBLE_EQ(result->GetBinContent(result->GetBin(coords, false)), 3.0);
+
+  const HistMemoryReport &report = *fillInfo.memoryReport;
+  EXPECT_EQ(report.name, "sparse_ceiling");
+  EXPECT_FALSE(report.dense);
+  EXPECT_EQ(report.flushes, 2u); // at the 4th and 8th bin of slot 0
+  ASSERT_EQ(report.slotFilledBins.size(), 2u);
+  EXPECT_EQ(report.slotFilledBins[0], 4);
+  EXPECT_EQ(report.slotFilledBins[1], 1);
+  EXPECT_EQ(report.slotBytes[0], 4 * bytesPerBin);
+  EXPECT_EQ(report.totalBytes(), 5 * bytesPerBin);
+}
+
+TEST_F(NDHistogramManagerConfigTest, THnMultiSpillsSparseSlotsToDiskRuns) {
+  // Same ceiling as above, but slots over it are spilled to runs on disk.
+  const std::string spillDir = ::testing::TempDir() + "/thnmulti_spill";
+  histFillInfo fillInfo;
+  fillInfo.name = "sparse_spill";
+  fillInfo.title = "sparse_spill";
+  fillInfo.nSlots = 2;
+  fillInfo.nbins = {100, 100, 100, 100, 100};
+  fillInfo.xmin = {0.0, 0.0, 0.0, 0.0, 0.0};
+  fillInfo.xmax = {100.0, 100.0, 100.0, 100.0, 100.0};
+  fillInfo.memoryCeilingBytes = 2 * 3 * estimateSparseBytesPerBin(fillInfo.nbins);
+  fillInfo.spillDirectory = spillDir;
+  fillInfo.memoryReport = std::make_shared<HistMemoryReport>();
+  THnMulti action(fillInfo);
+
+  // Slot 0 spills at its 4th, 8th and 12th bin; the last run holds bins 0
+  // and 1 again.
+  const ROOT::VecOps::RVec<Float_t> one{0.5f};
+  const ROOT::VecOps::RVec<Int_t> nFills{1};
+  for (int i = 0; i < 14; ++i) {
+    action.Exec(0, {(i % 10) + 0.5f}, {1.0f}, one, one, one, one, nFills);
+  }
+  action.Exec(1, {0.5f}, {2.0f}, one, one, one, one, nFills);
+  action.Finalize();
+
+  // Runs, remaining slot contents and repeated bins are merged.
+  auto result = action.GetResultPtr();
+  EXPECT_EQ(result->GetNbins(), 10);
+  const Double_t first[5] = {0.5, 0.5, 0.5, 0.5, 0.5};
+  const Double_t third[5] = {2.5, 0.5, 0.5, 0.5, 0.5};
+  EXPECT_DOUBLE_EQ(result->GetBinContent(result->GetBin(first, false)), 4.0);
+  EXPECT_DOUBLE_EQ(result->GetBinError2(result->GetBin(first, false)), 6.0);
+  EXPECT_DOUBLE_EQ(result->GetBinContent(result->GetBin(third, false)), 2.0);
+  EXPECT_DOUBLE_EQ(result->GetEntries(), 15.0);
+
+  const HistMemoryReport &report = *fillInfo.memoryReport;
+  EXPECT_EQ(report.flushes, 0u);
+  EXPECT_EQ(report.spills, 3u);
+  EXPECT_EQ(report.spilledBytes, 12 * sizeof(HistSpillRuns::Cell));
+  EXPECT_EQ(report.slotFilledBins[0], 4);
+
+  // The runs are removed once merged.
+  std::size_t left = 0;
+  for (const auto &entry : std::filesystem::directory_iterator(spillDir)) {
+    (void)entry;
+    ++left;
+  }
+  EXPECT_EQ(left, 0u);
+}
+
+TEST_F(NDHistogramManagerConfigTest, THnMultiSkipsMaskedChannelSystematicCells) {
+  // Two regions on the channel axis, Nominal/Up/Down on the systematic
+  // axis; the Up variation is not needed in the second region.
+  histFillInfo fillInfo;
+  fillInfo.name = "cell_mask";
+  fillInfo.title = "cell_mask";
+  fillInfo.nSlots = 1;
+  fillInfo.nbins = {2, 1, 1, 3, 10};
+  fillInfo.xmin = {0.5, 0.0, 0.0, 0.0, 0.0};
+  fillInfo.xmax = {2.5, 1.0, 1.0, 3.0, 10.0};
+  fillInfo.weight_hasSystematic = true;
+  fillInfo.hasSystematic = true;
+  fillInfo.cellMask = {1, 1, 1, 0, 1, 1};
+  THnMulti action(fillInfo);
+
+  const ROOT::VecOps::RVec<Float_t> half{0.5f};
+  const ROOT::VecOps::RVec<Float_t> systs{0.0f, 1.0f, 2.0f};
+  const ROOT::VecOps::RVec<Int_t> nFills{1, 1, 1};
+  for (const Float_t region : {1.0f, 2.0f}) {
+    action.Exec(0, {0.5f, 0.5f, 0.5f}, {1.0f, 2.0f, 3.0f}, systs, half, half, {region}, nFills);
+  }
+  action.Finalize();
+
+  auto result = action.GetResultPtr();
+  EXPECT_EQ(result->GetNbins(), 5);
+  const Double_t skipped[5] = {2.0, 0.5, 0.5, 1.5, 0.5};
+  const Double_t kept[5] = {1.0, 0.5, 0.5, 1.5, 0.5};
+  EXPECT_EQ(result->GetBin(skipped, false), -1);
+  EXPECT_DOUBLE_EQ(result->GetBinContent(result->GetBin(kept, false)), 2.0);
+
+  fillInfo.cellMask = {1, 1, 1};
+  EXPECT_THROW(THnMulti{fillInfo}, std::runtime_error);
+}
+
+TEST_F(NDHistogramManagerConfigTest, THnMultiPromotesDenselyFilledSparseSlots) {
+  // Too large for dense slots over 8 slots; slot 0 is promoted at its third
+  // filled bin, slot 1 stays sparse.
+  histFillInfo fillInfo;
+  fillInfo.name = "sparse_promotion";
+  fillInfo.title = "sparse_promotion";
+  fillInfo.nSlots = 8;
+  fillInfo.nbins = {2, 2, 2, 3, 2000};
+  fillInfo.xmin = {0.0, 0.0, 0.0, 0.0, 0.0};
+  fillInfo.xmax = {2.0, 2.0, 2.0, 3.0, 2000.0};
+  ASSERT_GT(estimateDenseMemoryBytes(fillInfo.nbins, 8, 16), kDenseMemoryThresholdBytes);
+  const std::size_t cells = estimateDenseMemoryBytes(fillInfo.nbins, 1, 1);
+  fillInfo.densePromotionFraction = 2.5 / static_cast<Double_t>(cells);
+  ASSERT_EQ(densePromotionBins(fillInfo.nbins, 8, fillInfo.densePromotionFraction, 0), 3);
+  fillInfo.memoryReport = std::make_shared<HistMemoryReport>();
+  THnMulti action(fillInfo);
+
+  const ROOT::VecOps::RVec<Float_t> one{0.5f};
+  const ROOT::VecOps::RVec<Int_t> nFills{1};
+  for (int i = 0; i < 4; ++i) {
+    action.Exec(0, {i + 0.5f}, {1.0f}, one, one, one, one, nFills);
+  }
+  action.Exec(0, {0.5f}, {2.0f}, one, one, one, one, nFills);
+  action.Exec(1, {0.5f}, {4.0f}, one, one, one, one, nFills);
+
+  // The promoted slot hands out its bins like a dense one.
+  EXPECT_EQ(action.PartialUpdate(0).GetNbins(), 4);
+  EXPECT_EQ(action.PartialUpdate(1).GetNbins(), 1);
+  action.Finalize();
+
+  auto result = action.GetResultPtr();
+  EXPECT_EQ(result->GetNbins(), 4);
+  const Double_t coords[5] = {0.5, 0.5, 0.5, 0.5, 0.5};
+  const Long64_t bin = result->GetBin(coords, false);
+  EXPECT_DOUBLE_EQ(result->GetBinContent(bin), 7.0);
+  EXPECT_DOUBLE_EQ(result->GetBinError2(bin), 1.0 + 4.0 + 16.0);
+
+  const HistMemoryReport &report = *fillInfo.memoryReport;
+  EXPECT_FALSE(report.dense);
+  EXPECT_EQ(report.promotions, 1u);
+  EXPECT_EQ(report.slotFilledBins[0], 4);
+  EXPECT_EQ(report.slotBytes[0], cells * 16);
+  EXPECT_EQ(report.slotFilledBins[1], 1);
+
+  // Without promotion, a slot over its share of the ceiling, or a zero
+  // fraction, keeps the sparse storage.
+  EXPECT_EQ(densePromotionBins(fillInfo.nbins, 8, 0.0, 0), 0);
+  EXPECT_EQ(densePromotionBins(fillInfo.nbins, 8, 0.5, 8 * cells * 16 - 1), 0);
+  EXPECT_EQ(densePromotionBins(fillInfo.nbins, 8, -1.0, 0),
+            static_cast<Long64_t>(std::ceil(
+                16.0 / estimateSparseBytesPerBin(fillInfo.nbins) * cells)));
+}
+
+TEST_F(NDHistogramManagerConfigTest, THnMultiSelectsCanonicalFillLayout) {
+  histFillInfo fillInfo;
+  fillInfo.name = "layout";
+  fillInfo.title = "layout";
+  fillInfo.nSlots = 1;
+  fillInfo.nbins = {3, 1, 1, 1, 10};
+  fillInfo.xmin = {0.5, 0.0, 0.0, 0.0, 0.0};
+  fillInfo.xmax = {3.5, 1.0, 1.0, 1.0, 10.0};
+  // The multi-fill loop ignores the systematic flags.
+  fillInfo.channel_hasMultiFill = true;
+  fillInfo.weight_hasSystematic = true;
+  THnMulti action(fillInfo);
+  EXPECT_EQ(action.fillFlags(), THnFill::kChannelMulti);
+
+  // Both channel entries are filled with the single weight.
+  const ROOT::VecOps::RVec<Float_t> half{0.5f};
+  action.Exec(0, {2.5f, 2.5f}, {1.5f}, half, half, half, {1.0f, 3.0f},
+              ROOT::VecOps::RVec<Int_t>{2});
+  action.Finalize();
+  auto result = action.GetResultPtr();
+  EXPECT_EQ(result->GetNbins(), 2);
+  for (const Double_t channel : {1.0, 3.0}) {
+    const Double_t coords[5] = {channel, 0.5, 0.5, 0.5, 2.5};
+    const Long64_t bin = result->GetBin(coords, false);
+    ASSERT_GE(bin, 0);
+    EXPECT_DOUBLE_EQ(result->GetBinContent(bin), 1.5);
+  }
+}
+
+TEST_F(NDHistogramManagerConfigTest, THnMultiGeneralLayoutFollowsVariations) {
+  histFillInfo fillInfo;
+  fillInfo.name = "general";
+  fillInfo.title = "general";
+  fillInfo.nSlots = 1;
+  fillInfo.nbins = {1, 1, 1, 2, 10};
+  fillInfo.xmin = {0.0, 0.0, 0.0, 0.0, 0.0};
+  fillInfo.xmax = {1.0, 1.0, 1.0, 2.0, 10.0};
+  fillInfo.weight_hasSystematic = true;
+  THnMulti action(fillInfo);
+  EXPECT_EQ(THnFill::path(action.fillFlags()), THnFill::Path::General);
+
+  // One fill per variation, each with its own weight.
+  const ROOT::VecOps::RVec<Float_t> half{0.5f};
+  action.Exec(0, {2.5f, 3.5f}, {1.0f, 2.0f}, {0.5f, 1.5f}, half, half, half,
+              ROOT::VecOps::RVec<Int_t>{1, 1});
+  action.Finalize();
+  auto result = action.GetResultPtr();
+  const Double_t nominal[5] = {0.5, 0.5, 0.5, 0.5, 2.5};
+  const Double_t varied[5] = {0.5, 0.5, 0.5, 1.5, 3.5};
+  EXPECT_DOUBLE_EQ(result->GetBinContent(result->GetBin(nominal, false)), 1.0);
+  EXPECT_DOUBLE_EQ(result->GetBinContent(result->GetBin(varied, false)), 2.0);
+}
+
+TEST_F(NDHistogramManagerConfigTest, THnMultiBinIndexValuesMatchRawValues) {
+  histFillInfo fillInfo;
+  fillInfo.name = "raw";
+  fillInfo.title = "raw";
+  fillInfo.nSlots = 1;
+  fillInfo.nbins = {1, 1, 1, 1, 10};
+  fillInfo.xmin = {0.0, 0.0, 0.0, 0.0, 0.0};
+  fillInfo.xmax = {1.0, 1.0, 1.0, 1.0, 10.0};
+  THnMulti raw(fillInfo);
+  fillInfo.name = "binned";
+  fillInfo.title = "binned";
+  fillInfo.value_isBinIndex = true;
+  THnMulti binned(fillInfo);
+
+  const ROOT::VecOps::RVec<Float_t> half{0.5f};
+  const ROOT::VecOps::RVec<Int_t> nFills{1};
+  for (const Float_t value : {-1.0f, 0.0f, 2.5f, 9.99f, 10.0f, 42.0f}) {
+    const auto bin = static_cast<Float_t>(uniformAxisBin(value, 10, 0.0, 10.0, 10.0));
+    raw.Exec(0, {value}, {1.0f}, half, half, half, half, nFills);
+    binned.Exec(0, {bin}, {1.0f}, half, half, half, half, nFills);
+  }
+  raw.Finalize();
+  binned.Finalize();
+
+  auto rawResult = raw.GetResultPtr();
+  auto binnedResult = binned.GetResultPtr();
+  for (int bin = 0; bin <= 11; ++bin) {
+    const Double_t coords[5] = {0.5, 0.5, 0.5, 0.5, bin - 0.5};
+    const Long64_t rawBin = rawResult->GetBin(coords, false);
+    const Long64_t binnedBin = binnedResult->GetBin(coords, false);
+    EXPECT_DOUBLE_EQ(rawBin < 0 ? 0.0 : rawResult->GetBinContent(rawBin),
+                     binnedBin < 0 ? 0.0 : binnedResult->GetBinContent(binnedBin))
+        << "bin " << bin;
+  }
+}
+
+TEST_F(NDHistogramManagerConfigTest, VariableAxisLookupMatchesBinarySearch) {
+  std::vector<Double_t> edges;
+  for (int i = 0; i <= 30; ++i) {
+    edges.push_back(20.0 * std::pow(150.0, i / 30.0));
+  }
+  const VariableAxisLookup lookup(edges);
+  EXPECT_EQ(lookup.nbins(), 30);
+  std::vector<Double_t> probes = {0.0, 19.9, 3000.0, 1.0e6, std::nan("")};
+  for (const Double_t edge : edges) {
+    probes.push_back(edge);
+    probes.push_back(std::nextafter(edge, 0.0));
+  }
+  for (int i = 0; i < 10000; ++i) {
+    probes.push_back(10.0 + i * 0.31);
+  }
+  for (const Double_t x : probes) {
+    Int_t expected = static_cast<Int_t>(edges.size());
+    if (x < edges.front()) {
+      expected = 0;
+    } else if (x < edges.back()) {
+      expected = static_cast<Int_t>(std::upper_bound(edges.begin(), edges.end(), x) - edges.begin());
+    }
+    EXPECT_EQ(lookup.findBin(x), expected) << "x=" << x;
+  }
+  EXPECT_THROW(VariableAxisLookup({1.0}), std::runtime_error);
+  EXPECT_THROW(VariableAxisLookup({1.0, 3.0, 2.0}), std::runtime_error);
+}
+
+TEST_F(NDHistogramManagerConfigTest, THnMultiFillsVariableWidthValueAxis) {
+  histFillInfo fillInfo;
+  fillInfo.name = "variable";
+  fillInfo.title = "variable";
+  fillInfo.nSlots = 1;
+  fillInfo.nbins = {1, 1, 1, 1, 4};
+  fillInfo.xmin = {0.0, 0.0, 0.0, 0.0, 20.0};
+  fillInfo.xmax = {1.0, 1.0, 1.0, 1.0, 1000.0};
+  fillInfo.valueEdges = {20.0, 30.0, 50.0, 100.0, 1000.0};
+  THnMulti action(fillInfo);
+
+  const ROOT::VecOps::RVec<Float_t> half{0.5f};
+  const ROOT::VecOps::RVec<Int_t> nFills{1};
+  for (const Float_t value : {25.0f, 30.0f, 49.0f, 99.0f, 500.0f}) {
+    action.Exec(0, {value}, {1.0f}, half, half, half, half, nFills);
+  }
+  action.Finalize();
+
+  auto result = action.GetResultPtr();
+  const TAxis *valueAxis = result->GetAxis(4);
+  EXPECT_DOUBLE_EQ(valueAxis->GetBinLowEdge(3), 50.0);
+  const double expected[4] = {1.0, 2.0, 1.0, 1.0};
+  for (int bin = 1; bin <= 4; ++bin) {
+    const Int_t idx[5] = {1, 1, 1, 1, bin};
+    EXPECT_DOUBLE_EQ(result->GetBinContent(result->GetBin(idx, false)), expected[bin - 1])
+        << "bin " << bin;
+  }
+  fillInfo.valueEdges = {20.0, 1000.0};
+  EXPECT_THROW(THnMulti mismatched(fillInfo), std::runtime_error);
+}
+
+TEST_F(NDHistogramManagerConfigTest, THnMultiDeviceStorageMatchesDenseAccumulator) {
+  // The host sink receives the staged (bin, weight) batches a GPU buffer
+  // would; the result must equal the dense per-slot accumulators'.
+  histFillInfo fillInfo;
+  fillInfo.name = "device";
+  fillInfo.title = "device";
+  fillInfo.nSlots = 2;
+  fillInfo.nbins = {2, 2, 2, 3, 10};
+  fillInfo.xmin = {0.0, 0.0, 0.0, 0.0, 0.0};
+  fillInfo.xmax = {2.0, 2.0, 2.0, 3.0, 10.0};
+  THnMulti dense(fillInfo);
+  auto sink = std::make_shared<HostHistSink>(4 * 4 * 4 * 5 * 12);
+  fillInfo.deviceSink = sink;
+  THnMulti device(fillInfo);
+  EXPECT_THROW(device.PartialUpdate(0), std::runtime_error);
+
+  const ROOT::VecOps::RVec<Float_t> syst{0.5f, 1.5f};
+  const ROOT::VecOps::RVec<Float_t> one{1.5f};
+  const ROOT::VecOps::RVec<Int_t> nFills{1, 1};
+  for (THnMulti *action : {&dense, &device}) {
+    action->Exec(0, {3.5f, 4.5f}, {2.0f, 0.5f}, syst, one, one, one, nFills);
+    action->Exec(1, {3.5f, -1.0f}, {0.5f, 4.0f}, syst, one, one, one, nFills);
+    action->Exec(1, 7.5f, 3.0f, 0.5f, 1.5f, 0.5f);
+  }
+  EXPECT_EQ(sink->batches, 0u);
+  dense.Finalize();
+  device.Finalize();
+  EXPECT_EQ(sink->batches, 2u);
+  expectSameBins(*dense.GetResultPtr(), *device.GetResultPtr());
+
+  fillInfo.deviceSink = std::make_shared<HostHistSink>(1);
+  EXPECT_THROW(THnMulti mismatched(fillInfo), std::runtime_error);
+}
+
+TEST_F(NDHistogramManagerConfigTest, THnMultiDeviceStorageFillsWeightVectors) {
+  histFillInfo fillInfo;
+  fillInfo.name = "device_weight_vector";
+  fillInfo.title = "device_weight_vector";
+  fillInfo.nSlots = 1;
+  fillInfo.nbins = {2, 2, 2, 3, 10};
+  fillInfo.xmin = {0.0, 0.0, 0.0, 0.0, 0.0};
+  fillInfo.xmax = {2.0, 2.0, 2.0, 3.0, 10.0};
+  fillInfo.weightVector = true;
+  THnMulti dense(fillInfo);
+  fillInfo.deviceSink = std::make_shared<HostHistSink>(4 * 4 * 4 * 5 * 12);
+  THnMulti device(fillInfo);
+
+  const ROOT::VecOps::RVec<Float_t> weights{1.0f, 0.0f, 3.0f, 4.0f};
+  for (THnMulti *action : {&dense, &device}) {
+    action->Exec(0, 3.5f, weights, 1.5f, 0.5f, 1.5f);
+    action->Exec(0, 8.5f, weights, 0.5f, 0.5f, 1.5f);
+    action->Finalize();
+  }
+  EXPECT_EQ(device.GetResultPtr()->GetNbins(), 4);
+  expectSameBins(*dense.GetResultPtr(), *device.GetResultPtr());
+}
+
+#ifndef USE_CUDA
+TEST_F(NDHistogramManagerConfigTest, GpuBackendNeedsCudaBuild) {
+  configManager->set("histogramBackend", "gpu");
+  EXPECT_THROW(histogramManager->setupFromConfigFile(), std::runtime_error);
+}
+#endif
+
+TEST_F(NDHistogramManagerConfigTest, TreeReduceSlotsMergesEverySlotOnce) {
+  for (std::size_t n : {1u, 2u, 5u, 8u}) {
+    std::vector<std::vector<int>> slots(n);
+    for (std::size_t i = 0; i < n; ++i) {
+      slots[i] = {static_cast<int>(i)};
+    }
+    treeReduceSlots(slots, [](std::vector<int>& into, std::vector<int>& from) {
+      into.insert(into.end(), from.begin(), from.end());
+      from.clear();
+    });
+    std::vector<int> merged = slots[0];
+    std::sort(merged.begin(), merged.end());
+    std::vector<int> expected(n);
+    std::iota(expected.begin(), expected.end(), 0);
+    EXPECT_EQ(merged, expected) << "n=" << n;
+  }
+}
+
 TEST_F(NDHistogramManagerConfigTest, BoostBackendAutoSelectsDenseForSmallHist) {
   // For a small histogram that fits within kDenseMemoryThresholdBytes, BHnMulti
   // auto-selects weight_storage (dense) on Boost >= 1.76, or uses weight_storage
@@ -0,0 +1,218 @@
+/**
+ * @file testNodeProfiler.cc
+ * @brief Unit tests for NodeProfiler – timing Define and Filter callables
+ *        per slot, attributing them to owners, counting their heap
+ *        allocations, and writing the report.
+ */
+
+#include <gtest/gtest.h>
+
+#include <DataManager.h>
+#include <NodeProfiler.h>
+#include <AllocationTracker.h>
+#include <SystematicManager.h>
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+const std::string kReportPath =
+    std::string(TEST_SOURCE_DIR) + "/aux/test_node_profile.json";
+
+const NodeProfiler::Entry *findEntry(const std::vector<NodeProfiler::Entry> &entries,
+                                     const std::string &name) {
+  for (const auto &entry : entries) {
+    if (entry.name == name) {
+      return &entry;
+    }
+  }
+  return nullptr;
+}
+
+// Keeps the allocations below observable, so they are not elided.
+std::vector<int> *volatile allocationSink = nullptr;
+
+} // namespace
+
+TEST(NodeProfilerTest, DisabledByDefault) {
+  DataManager data(10);
+  EXPECT_EQ(data.nodeProfiler(), nullptr);
+  SystematicManager systematics;
+  data.Define("x", []() { return 1.0f; }, {}, systematics);
+  EXPECT_EQ(*data.getDataFrame().Sum<float>("x"), 10.0f);
+  data.reportNodeProfile();
+}
+
+TEST(NodeProfilerTest, CountsCallsPerNodeAndOwner) {
+  DataManager data(100);
+  data.enableNodeProfiling(kReportPath);
+  NodeProfiler *profiler = data.nodeProfiler();
+  ASSERT_NE(profiler, nullptr);
+
+  SystematicManager systematics;
+  data.Define("x", [](ULong64_t entry) { return static_cast<float>(entry); },
+              {"rdfentry_"}, systematics);
+  data.Define("x_scaleUp", [](float x) { return 1.1f * x; }, {"x"}, systematics);
+  data.Define("x_scaleDown", [](float x) { return 0.9f * x; }, {"x"}, systematics);
+  systematics.registerSystematic("scale", {"x"});
+  {
+    NodeProfiler::OwnerScope scope(profiler, "correctionManager");
+    data.Define("y", [](float x) { return 2.0f * x; }, {"x"}, systematics);
+  }
+  EXPECT_EQ(profiler->owner(), NodeProfiler::kDefaultOwner);
+  data.Filter([](float y) { return y < 100.0f; }, {"y"});
+  // Callables relying on the default columns are not instrumented.
+  auto unary = [](float value) { return value; };
+  EXPECT_FALSE(NodeProfiler::canWrap<decltype(unary)>(0));
+  EXPECT_TRUE(NodeProfiler::canWrap<decltype(unary)>(1));
+
+  auto sumUp = data.getDataFrame().Sum<float>("y_scaleUp");
+  EXPECT_EQ(*data.getDataFrame().Count(), 50u);
+  EXPECT_GT(*sumUp, 0.0f);
+
+  const auto entries = profiler->entries();
+  EXPECT_EQ(entries.size(), 7u);
+  const auto *x = findEntry(entries, "x");
+  ASSERT_NE(x, nullptr);
+  EXPECT_EQ(x->calls, 100u);
+  EXPECT_EQ(x->owner, NodeProfiler::kDefaultOwner);
+  const auto *y = findEntry(entries, "y");
+  ASSERT_NE(y, nullptr);
+  EXPECT_EQ(y->owner, "correctionManager");
+  EXPECT_EQ(y->kind, "define");
+  const auto *yUp = findEntry(entries, "y_scaleUp");
+  ASSERT_NE(yUp, nullptr);
+  EXPECT_EQ(yUp->owner, "correctionManager");
+  EXPECT_EQ(yUp->calls, 50u);
+  const auto *filter = findEntry(entries, "filter(y)");
+  ASSERT_NE(filter, nullptr);
+  EXPECT_EQ(filter->kind, "filter");
+  EXPECT_EQ(filter->calls, 100u);
+
+  // Columns a plugin declares, and their variations, move to the plugin.
+  profiler->attribute({"x", "y"}, "jetManager");
+  const auto attributed = profiler->entries();
+  EXPECT_EQ(findEntry(attributed, "x")->owner, "jetManager");
+  EXPECT_EQ(findEntry(attributed, "x_scaleUp")->owner, "jetManager");
+  EXPECT_EQ(findEntry(attributed, "y")->owner, "correctionManager");
+  EXPECT_EQ(findEntry(attributed, "filter(y)")->owner, NodeProfiler::kDefaultOwner);
+  EXPECT_EQ(profiler->ownerTotals().size(), 3u);
+
+  data.reportNodeProfile();
+  std::ifstream in(kReportPath);
+  ASSERT_TRUE(in.good());
+  std::stringstream report;
+  report << in.rdbuf();
+  EXPECT_NE(report.str().find("\"owners\""), std::string::npos);
+  EXPECT_NE(report.str().find("\"name\": \"filter(y)\""), std::string::npos);
+  std::remove(kReportPath.c_str());
+}
+
+TEST(NodeProfilerTest, EventCostSetsTaskSplitting) {
+  std::ofstream(kReportPath)
+      << "{\n  \"slots\": 2,\n  \"owners\": {},\n  \"nodes\": [\n"
+         "    {\"name\": \"x\", \"kind\": \"define\", \"owner\": \"analysis\", \"calls\": 1000, "
+         "\"ns\": 3000000, \"ns_per_call\": 3000},\n"
+         "    {\"name\": \"fit\", \"kind\": \"define\", \"owner\": \"kinFit\", \"calls\": 200, "
+         "\"ns\": 7000000, \"ns_per_call\": 35000}\n  ]\n}\n";
+  // 10 ms over the 1000 events every entry reaches.
+  EXPECT_DOUBLE_EQ(NodeProfiler::readEventCost(kReportPath), 10000.0);
+  std::remove(kReportPath.c_str());
+
+  // 1e7 events at 10 us on 8 workers: 100 s, 50 tasks of 2 s -> 7 per worker,
+  // raised to ROOT's default of 10.
+  EXPECT_EQ(NodeProfiler::tasksPerWorkerHint(10000.0, 10000000, 8, 2.0), 10u);
+  // At 1 ms per event: 10000 s, 5000 tasks -> 625 per worker.
+  EXPECT_EQ(NodeProfiler::tasksPerWorkerHint(1e6, 10000000, 8, 2.0), 625u);
+  EXPECT_EQ(NodeProfiler::tasksPerWorkerHint(0.0, 10000000, 8, 2.0), 10u);
+  EXPECT_THROW(NodeProfiler::readEventCost(kReportPath), std::runtime_error);
+}
+
+TEST(NodeProfilerTest, CapsTasksPerWorkerAtMinimumTaskSize) {
+  // 1M entries on 8 workers with at least 10000 per task: 100 tasks, 12 per worker.
+  EXPECT_EQ(NodeProfiler::capTasksPerWorker(625, 1000000, 8, 10000), 12u);
+  EXPECT_EQ(NodeProfiler::capTasksPerWorker(10, 1000000, 8, 10000), 10u);
+  // Too few entries for even one task per worker of that size.
+  EXPECT_EQ(NodeProfiler::capTasksPerWorker(10, 5000, 8, 10000), 1u);
+  EXPECT_EQ(NodeProfiler::capTasksPerWorker(10, 1000000, 8, 0), 10u);
+}
+
+TEST(NodeProfilerTest, CountsThreadAllocations) {
+  if (!AllocationTracker::enable()) {
+    GTEST_SKIP() << "core is built without -DPROFILE_ALLOCATIONS=ON";
+  }
+  const auto before = AllocationTracker::threadCounts();
+  allocationSink = new std::vector<int>(256);
+  delete allocationSink;
+  const auto counted = AllocationTracker::threadCounts() - before;
+  EXPECT_EQ(counted.allocations, 2u);
+  EXPECT_GE(counted.bytes, 256u * sizeof(int));
+  AllocationTracker::disable();
+}
+
+TEST(NodeProfilerTest, CountsAllocationsPerNode) {
+  if (!AllocationTracker::enable()) {
+    GTEST_SKIP() << "core is built without -DPROFILE_ALLOCATIONS=ON";
+  }
+  DataManager data(100);
+  data.enableAllocationProfiling(kReportPath);
+  NodeProfiler *profiler = data.nodeProfiler();
+  ASSERT_NE(profiler, nullptr);
+  EXPECT_TRUE(profiler->tracksAllocations());
+
+  SystematicManager systematics;
+  data.Define("x", [](ULong64_t entry) { return static_cast<float>(entry); },
+              {"rdfentry_"}, systematics);
+  {
+    NodeProfiler::OwnerScope scope(profiler, "jetManager");
+    data.Define("jets",
+                [](float x) { return ROOT::VecOps::RVec<float>(64, x); }, {"x"},
+                systematics);
+  }
+  data.DefineVector("pair", {"x", "x"}, "Float_t", systematics);
+  EXPECT_EQ(*data.getDataFrame().Count(), 100u);
+
+  const auto entries = profiler->entries();
+  const auto *x = findEntry(entries, "x");
+  ASSERT_NE(x, nullptr);
+  EXPECT_EQ(x->allocations, 0u);
+  const auto *jets = findEntry(entries, "jets");
+  ASSERT_NE(jets, nullptr);
+  EXPECT_GE(jets->allocations, 100u);
+  EXPECT_GE(jets->bytes, 100u * 64u * sizeof(float));
+  const auto *pair = findEntry(entries, "pair");
+  ASSERT_NE(pair, nullptr);
+  EXPECT_EQ(pair->kind, "define_vector");
+  EXPECT_EQ(pair->calls, 100u);
+
+  EXPECT_EQ(profiler->taskTotals().entries, 100u);
+  EXPECT_GE(profiler->taskTotals().counts.allocations, jets->allocations);
+  const auto owners = profiler->ownerAllocations();
+  EXPECT_EQ(owners.count("framework"), 1u);
+  EXPECT_EQ(owners.at("jetManager").allocations, jets->allocations);
+
+  data.reportNodeProfile();
+  std::ifstream in(kReportPath);
+  ASSERT_TRUE(in.good());
+  std::stringstream report;
+  report << in.rdbuf();
+  EXPECT_NE(report.str().find("\"bytes_per_event\""), std::string::npos);
+  EXPECT_NE(report.str().find("\"framework\""), std::string::npos);
+
+  // A second event loop is counted on its own, not added to the first.
+  const auto firstLoop = jets->allocations;
+  EXPECT_EQ(*data.getDataFrame().Count(), 100u);
+  EXPECT_EQ(profiler->taskTotals().entries, 100u);
+  const auto secondEntries = profiler->entries();
+  const auto *secondLoop = findEntry(secondEntries, "jets");
+  ASSERT_NE(secondLoop, nullptr);
+  EXPECT_GE(secondLoop->allocations, 100u);
+  EXPECT_LE(secondLoop->allocations, firstLoop);
+  std::remove(kReportPath.c_str());
+  AllocationTracker::disable();
+}
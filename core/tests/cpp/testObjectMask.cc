@@ -0,0 +1,191 @@
+/**
+ * @file testObjectMask.cc
+ * @brief Unit tests for ObjectMask – the bit-packed per-object selection
+ *        mask – and the collection constructors and filters taking it.
+ */
+
+#include <gtest/gtest.h>
+
+#include <ObjectMask.h>
+#include <PhysicsObjectCollection.h>
+
+#include <ROOT/RVec.hxx>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+using ROOT::VecOps::RVec;
+
+namespace {
+
+/// Pseudo-random boolean mask of @p n objects.
+RVec<bool> scatteredBools(std::size_t n, unsigned seed) {
+  RVec<bool> mask(n);
+  for (std::size_t i = 0; i < n; ++i) {
+    mask[i] = ((i * 2654435761u + seed) >> 7) % 3 == 0;
+  }
+  return mask;
+}
+
+std::vector<Int_t> indices(const ObjectMask &mask) {
+  const auto idx = mask.indices();
+  return {idx.begin(), idx.end()};
+}
+
+} // namespace
+
+TEST(ObjectMask, FromBoolsRoundTrips) {
+  for (const std::size_t n : {0u, 1u, 63u, 64u, 65u, 130u}) {
+    const auto bools = scatteredBools(n, 11);
+    const auto mask = ObjectMask::fromBools(bools);
+    EXPECT_EQ(mask.size(), n);
+    const auto unpacked = mask.toBools();
+    ASSERT_EQ(unpacked.size(), n);
+    std::size_t expected = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+      expected += bools[i];
+      EXPECT_EQ(mask.test(i), bools[i]) << n << " " << i;
+      EXPECT_EQ(unpacked[i], bools[i]) << n << " " << i;
+    }
+    EXPECT_EQ(mask.count(), expected) << n;
+  }
+}
+
+TEST(ObjectMask, SelectionHelpers) {
+  const RVec<float> pt{10.f, 35.f, 50.f, 25.f};
+  const RVec<float> eta{0.5f, -2.6f, 2.0f, -1.0f};
+  const RVec<int> id{6, 2, 7, 4};
+
+  const auto mask = ObjectMask::above(pt, 20.f) & ObjectMask::absBelow(eta, 2.4f) &
+                    ObjectMask::hasBits(id, 2);
+  EXPECT_EQ(indices(mask), (std::vector<Int_t>{2}));
+  EXPECT_EQ(indices(ObjectMask::below(pt, 30.f) | ObjectMask::above(pt, 40.f)),
+            (std::vector<Int_t>{0, 2, 3}));
+  EXPECT_EQ(ObjectMask::where(pt, [](float v) { return v < 0.f; }).count(), 0u);
+
+  // Thresholds of another type convert to the value type.
+  const RVec<UChar_t> flags{6, 2, 7, 4};
+  EXPECT_EQ(indices(ObjectMask::above(pt, 30) & ObjectMask::absBelow(eta, 2.4) &
+                    ObjectMask::hasBits(flags, 2)),
+            (std::vector<Int_t>{2}));
+  EXPECT_EQ(indices(ObjectMask::below(id, 5.0)), (std::vector<Int_t>{1, 3}));
+}
+
+TEST(ObjectMask, ComplementKeepsBitsPastSizeClear) {
+  const ObjectMask none(70);
+  const auto all = ~none;
+  EXPECT_EQ(all.count(), 70u);
+  EXPECT_EQ(all, ObjectMask(70, true));
+  EXPECT_TRUE((all ^ all).none());
+  EXPECT_EQ((~ObjectMask::fromBools(scatteredBools(70, 3))).count(),
+            70u - ObjectMask::fromBools(scatteredBools(70, 3)).count());
+}
+
+TEST(ObjectMask, WordOperatorsMatchElementwise) {
+  const std::size_t n = 150;
+  const auto a = scatteredBools(n, 1);
+  const auto b = scatteredBools(n, 5);
+  const auto ma = ObjectMask::fromBools(a);
+  const auto mb = ObjectMask::fromBools(b);
+  const auto both = (ma & mb).toBools();
+  const auto either = (ma | mb).toBools();
+  for (std::size_t i = 0; i < n; ++i) {
+    EXPECT_EQ(both[i], a[i] && b[i]);
+    EXPECT_EQ(either[i], a[i] || b[i]);
+  }
+}
+
+TEST(ObjectMask, SetAndForEachInOrder) {
+  ObjectMask mask(200);
+  mask.set(199);
+  mask.set(3);
+  mask.set(64);
+  mask.set(64, false);
+  mask.set(65);
+  std::vector<std::size_t> seen;
+  mask.forEach([&seen](std::size_t i) { seen.push_back(i); });
+  EXPECT_EQ(seen, (std::vector<std::size_t>{3, 65, 199}));
+  EXPECT_TRUE(mask.any());
+}
+
+TEST(ObjectMask, RejectsOutOfRangeAndSizeMismatch) {
+  ObjectMask mask(4);
+  EXPECT_THROW(mask.test(4), std::out_of_range);
+  EXPECT_THROW(mask.set(4), std::out_of_range);
+  EXPECT_THROW(mask &= ObjectMask(5), std::runtime_error);
+}
+
+// ---------------------------------------------------------------------------
+// Collections
+// ---------------------------------------------------------------------------
+
+class ObjectMaskCollectionTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    for (std::size_t i = 0; i < 80; ++i) {
+      pt_.push_back(10.f + i);
+      eta_.push_back(-2.f + 0.05f * i);
+      phi_.push_back(-3.f + 0.07f * i);
+      mass_.push_back(0.1f * i);
+      objects_.push_back(static_cast<int>(i) * 10);
+    }
+    bools_ = scatteredBools(pt_.size(), 7);
+  }
+
+  RVec<Float_t> pt_, eta_, phi_, mass_;
+  std::vector<int> objects_;
+  RVec<bool> bools_;
+};
+
+TEST_F(ObjectMaskCollectionTest, ConstructorMatchesBoolMask) {
+  const PhysicsObjectCollection expected(pt_, eta_, phi_, mass_, bools_);
+  const PhysicsObjectCollection actual(pt_, eta_, phi_, mass_, ObjectMask::fromBools(bools_));
+  ASSERT_EQ(actual.size(), expected.size());
+  for (std::size_t i = 0; i < actual.size(); ++i) {
+    EXPECT_EQ(actual.index(i), expected.index(i));
+    EXPECT_EQ(actual.at(i), expected.at(i));
+  }
+
+  const SoAPhysicsObjectCollection<> soa(pt_, eta_, phi_, mass_, ObjectMask::fromBools(bools_));
+  ASSERT_EQ(soa.size(), expected.size());
+  for (std::size_t i = 0; i < soa.size(); ++i) {
+    EXPECT_EQ(soa.indices()[i], expected.index(i));
+  }
+
+  EXPECT_THROW(PhysicsObjectCollection(pt_, eta_, phi_, mass_, ObjectMask(3)),
+               std::runtime_error);
+}
+
+TEST_F(ObjectMaskCollectionTest, WithFilterMatchesBoolMask) {
+  const PhysicsObjectCollection all(pt_, eta_, phi_, mass_, ObjectMask(pt_.size(), true));
+  const auto expected = all.withFilter(bools_);
+  const auto actual = all.withFilter(ObjectMask::fromBools(bools_));
+  ASSERT_EQ(actual.size(), expected.size());
+  for (std::size_t i = 0; i < actual.size(); ++i) {
+    EXPECT_EQ(actual.index(i), expected.index(i));
+  }
+  EXPECT_THROW(all.withFilter(ObjectMask(1)), std::runtime_error);
+}
+
+TEST_F(ObjectMaskCollectionTest, TypedCollectionAndViewKeepObjects) {
+  const auto mask = ObjectMask::fromBools(bools_);
+  const TypedPhysicsObjectCollection<int> typed(pt_, eta_, phi_, mass_, mask, objects_);
+  const TypedPhysicsObjectView<int> view(pt_, eta_, phi_, mass_, mask, objects_);
+  ASSERT_EQ(typed.size(), mask.count());
+  ASSERT_EQ(view.size(), mask.count());
+  for (std::size_t i = 0; i < typed.size(); ++i) {
+    EXPECT_EQ(typed.object(i), typed.index(i) * 10);
+    EXPECT_EQ(view.object(i), view.index(i) * 10);
+  }
+
+  const auto central = ObjectMask::absBelow(typed.getValue(eta_), 1.0f);
+  const auto typedCentral = typed.withFilter(central);
+  const auto viewCentral = view.withFilter(central);
+  ASSERT_EQ(typedCentral.size(), central.count());
+  ASSERT_EQ(viewCentral.size(), central.count());
+  for (std::size_t i = 0; i < typedCentral.size(); ++i) {
+    EXPECT_LT(std::abs(eta_[typedCentral.index(i)]), 1.0f);
+    EXPECT_EQ(typedCentral.object(i), typedCentral.index(i) * 10);
+    EXPECT_EQ(viewCentral.index(i), typedCentral.index(i));
+  }
+}
@@ -14,6 +14,11 @@
 #include <api/ManagerContext.h>
 #include <SystematicManager.h>
 #include <ROOT/TThreadExecutor.hxx>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <ModelRegistry.h>
 
 class OnnxManagerTest : public ::testing::Test {
 protected:
@@ -111,12 +116,14 @@ TEST_F(OnnxManagerTest, GetRunVar_Invalid) {
 // All model names
 TEST_F(OnnxManagerTest, GetAllModelNames) {
   const auto &names = onnxManager->getAllModelNames();
-  EXPECT_EQ(names.size(), 5);
+  EXPECT_EQ(names.size(), 8);
   EXPECT_TRUE(std::find(names.begin(), names.end(), "test_model") != names.end());
   EXPECT_TRUE(std::find(names.begin(), names.end(), "test_model2") != names.end());
   EXPECT_TRUE(std::find(names.begin(), names.end(), "test_model_multi") != names.end());
   EXPECT_TRUE(std::find(names.begin(), names.end(), "test_model_padded") != names.end());
   EXPECT_TRUE(std::find(names.begin(), names.end(), "test_model_fixed_batch") != names.end());
+  EXPECT_TRUE(std::find(names.begin(), names.end(), "test_model_batched") != names.end());
+  EXPECT_TRUE(std::find(names.begin(), names.end(), "test_model_per_slot") != names.end());
 }
 
 // Base class interface
@@ -159,6 +166,42 @@ TEST_F(OnnxManagerTest, ApplyModel_Valid) {
   EXPECT_NE(result->at(1), -1.0f);
 }
 
+/**
+ * @brief Test that a single RVec<float> feature is bound without a packing copy
+ *
+ * The packed input is an alias of the feature column and the outputs match
+ * the scalar-feature path.
+ */
+TEST_F(OnnxManagerTest, ApplyModel_SingleVectorFeatureBoundInPlace) {
+  auto featureValue = [](ULong64_t i, int k) { return static_cast<float>(i + 1) * (k + 1); };
+  dataManager->Define("feature1", [featureValue](ULong64_t i) { return featureValue(i, 0); }, {"rdfentry_"}, *systematicManager);
+  dataManager->Define("feature2", [featureValue](ULong64_t i) { return featureValue(i, 1); }, {"rdfentry_"}, *systematicManager);
+  dataManager->Define("feature3", [featureValue](ULong64_t i) { return featureValue(i, 2); }, {"rdfentry_"}, *systematicManager);
+  dataManager->Define("run_number", [](ULong64_t) -> bool { return true; }, {"rdfentry_"}, *systematicManager);
+  onnxManager->applyModel("test_model");
+  auto scalarResult = dataManager->getDataFrame().Take<float>("test_model");
+
+  DataManager vectorData(2);
+  setContextFor(vectorData);
+  vectorData.Define("featureVec",
+                    [featureValue](ULong64_t i) {
+                      return ROOT::VecOps::RVec<float>{featureValue(i, 0), featureValue(i, 1),
+                                                       featureValue(i, 2)};
+                    },
+                    {"rdfentry_"}, *systematicManager);
+  vectorData.Define("run_number", [](ULong64_t) -> bool { return true; }, {"rdfentry_"}, *systematicManager);
+  onnxManager->setModelFeatures("test_model", {"featureVec"});
+  onnxManager->applyModel("test_model");
+
+  auto df = vectorData.getDataFrame();
+  EXPECT_TRUE(df.HasColumn("input_test_model"));
+  auto vectorResult = df.Take<float>("test_model");
+  ASSERT_EQ(vectorResult->size(), scalarResult->size());
+  for (size_t i = 0; i < vectorResult->size(); ++i) {
+    EXPECT_FLOAT_EQ(vectorResult->at(i), scalarResult->at(i)) << "entry " << i;
+  }
+}
+
 /**
  * @brief Test that model returns -1 when runVar is false
  */
@@ -189,7 +232,7 @@ TEST_F(OnnxManagerTest, ConstCorrectness) {
     EXPECT_TRUE(model != nullptr);
     EXPECT_EQ(features.size(), 3);
     EXPECT_EQ(runVar, "run_number");
-    EXPECT_EQ(names.size(), 5);
+    EXPECT_EQ(names.size(), 6);
     EXPECT_TRUE(std::find(names.begin(), names.end(), "test_model") != names.end());
     EXPECT_TRUE(std::find(names.begin(), names.end(), "test_model2") != names.end());
     EXPECT_TRUE(std::find(names.begin(), names.end(), "test_model_multi") != names.end());
@@ -428,6 +471,144 @@ TEST_F(OnnxManagerTest, ApplyModel_FixedBatchSystematicBundleSupportsSingleVecto
   EXPECT_FLOAT_EQ(down->at(1), -6.0f);
 }
 
+/**
+ * @brief Test that batchSize is parsed from the model config and defaults to 0
+ */
+TEST_F(OnnxManagerTest, GetBatchSize_ConfiguredAndDefault) {
+  EXPECT_EQ(onnxManager->getBatchSize("test_model_batched"), 4);
+  EXPECT_EQ(onnxManager->getBatchSize("test_model"), 0);
+  EXPECT_EQ(onnxManager->getBatchSize("nonexistent_model"), 0);
+}
+
+/**
+ * @brief Test that batched inference matches per-event inference
+ *
+ * With a single slot every event is evaluated as a batch of one row.
+ */
+TEST_F(OnnxManagerTest, ApplyModel_BatchedMatchesPerEvent) {
+  DataManager batchData(10);
+  setContextFor(batchData);
+  batchData.Define("feature1", [](ULong64_t i) -> float { return static_cast<float>(i); }, {"rdfentry_"}, *systematicManager);
+  batchData.Define("feature2", [](ULong64_t i) -> float { return 2.0f * i; }, {"rdfentry_"}, *systematicManager);
+  batchData.Define("feature3", [](ULong64_t) -> float { return 3.0f; }, {"rdfentry_"}, *systematicManager);
+  batchData.Define("run_number", [](ULong64_t i) -> bool { return i != 5; }, {"rdfentry_"}, *systematicManager);
+
+  onnxManager->applyModel("test_model");
+  onnxManager->applyModel("test_model_batched");
+
+  auto df = batchData.getDataFrame();
+  auto perEvent = df.Take<float>("test_model");
+  auto batched = df.Take<float>("test_model_batched");
+  ASSERT_EQ(perEvent->size(), 10);
+  ASSERT_EQ(batched->size(), 10);
+  for (size_t i = 0; i < 10; ++i) {
+    EXPECT_FLOAT_EQ(batched->at(i), perEvent->at(i)) << "entry " << i;
+  }
+  EXPECT_EQ(batched->at(5), -1.0f);
+}
+
+/**
+ * @brief Test that batched inference honours ROOT implicit multithreading
+ */
+TEST_F(OnnxManagerTest, ApplyModel_BatchedWithImplicitMT) {
+  ROOT::EnableImplicitMT(2);
+  {
+    DataManager batchData(64);
+    setContextFor(batchData);
+    batchData.Define("feature1", [](ULong64_t i) -> float { return static_cast<float>(i % 7); }, {"rdfentry_"}, *systematicManager);
+    batchData.Define("feature2", [](ULong64_t) -> float { return 2.0f; }, {"rdfentry_"}, *systematicManager);
+    batchData.Define("feature3", [](ULong64_t) -> float { return 3.0f; }, {"rdfentry_"}, *systematicManager);
+    batchData.Define("run_number", [](ULong64_t) -> bool { return true; }, {"rdfentry_"}, *systematicManager);
+
+    onnxManager->applyModel("test_model");
+    onnxManager->applyModel("test_model_batched");
+
+    auto df = batchData.getDataFrame();
+    auto diff = df.Define("absDiff",
+                          [](float a, float b) { return std::abs(a - b); },
+                          {"test_model", "test_model_batched"})
+                    .Max<float>("absDiff");
+    EXPECT_LT(*diff, 1e-5f);
+  }
+  ROOT::DisableImplicitMT();
+}
+
+/**
+ * @brief Test that per-slot sessions give the shared-session results
+ *
+ * With implicit MT each worker thread creates its own session on first use.
+ */
+TEST_F(OnnxManagerTest, ApplyModel_SessionPerSlotMatchesShared) {
+  EXPECT_FALSE(onnxManager->getSessionPool("test_model")->isPerSlot());
+  EXPECT_TRUE(onnxManager->getSessionPool("test_model_per_slot")->isPerSlot());
+  EXPECT_FALSE(onnxManager->usesGlobalThreadPool());
+  EXPECT_THROW(onnxManager->getSessionPool("nonexistent_model"), std::runtime_error);
+
+  ROOT::EnableImplicitMT(2);
+  {
+    DataManager slotData(64);
+    setContextFor(slotData);
+    slotData.Define("feature1", [](ULong64_t i) -> float { return static_cast<float>(i % 5); }, {"rdfentry_"}, *systematicManager);
+    slotData.Define("feature2", [](ULong64_t) -> float { return 2.0f; }, {"rdfentry_"}, *systematicManager);
+    slotData.Define("feature3", [](ULong64_t) -> float { return 3.0f; }, {"rdfentry_"}, *systematicManager);
+    slotData.Define("run_number", [](ULong64_t) -> bool { return true; }, {"rdfentry_"}, *systematicManager);
+
+    onnxManager->applyModel("test_model");
+    onnxManager->applyModel("test_model_per_slot");
+
+    auto df = slotData.getDataFrame();
+    auto diff = df.Define("absDiff",
+                          [](float a, float b) { return std::abs(a - b); },
+                          {"test_model", "test_model_per_slot"})
+                    .Max<float>("absDiff");
+    EXPECT_LT(*diff, 1e-5f);
+    const auto nSessions = onnxManager->getSessionPool("test_model_per_slot")->getSessionCount();
+    EXPECT_GE(nSessions, 1u);
+    EXPECT_LE(nSessions, static_cast<std::size_t>(ROOT::GetThreadPoolSize()) + 1);
+  }
+  ROOT::DisableImplicitMT();
+}
+
+/**
+ * @brief Test that shared cross-slot batching reproduces per-event inference
+ */
+TEST_F(OnnxManagerTest, ApplyModel_SharedBatchMatchesPerEvent) {
+  EXPECT_EQ(onnxManager->getBatchSize("test_model_shared_batch"), 4);
+  EXPECT_EQ(onnxManager->getBatchSize("test_model"), 0);
+  EXPECT_EQ(onnxManager->getSharedBatchCount("test_model_shared_batch"), 0u);
+
+  for (const bool mt : {false, true}) {
+    if (mt) {
+      ROOT::EnableImplicitMT(2);
+    }
+    {
+      DataManager batchData(64);
+      setContextFor(batchData);
+      batchData.Define("feature1", [](ULong64_t i) -> float { return static_cast<float>(i % 7); }, {"rdfentry_"}, *systematicManager);
+      batchData.Define("feature2", [](ULong64_t i) -> float { return static_cast<float>(i % 3); }, {"rdfentry_"}, *systematicManager);
+      batchData.Define("feature3", [](ULong64_t) -> float { return 3.0f; }, {"rdfentry_"}, *systematicManager);
+      batchData.Define("run_number", [](ULong64_t i) -> bool { return i % 4 != 0; }, {"rdfentry_"}, *systematicManager);
+
+      onnxManager->applyModel("test_model");
+      onnxManager->applyModel("test_model_shared_batch");
+
+      auto df = batchData.getDataFrame();
+      auto diff = df.Define("absDiff",
+                            [](float a, float b) { return std::abs(a - b); },
+                            {"test_model", "test_model_shared_batch"})
+                      .Max<float>("absDiff");
+      EXPECT_LT(*diff, 1e-5f);
+      const auto nBatches = onnxManager->getSharedBatchCount("test_model_shared_batch");
+      EXPECT_GE(nBatches, 1u);
+      // 48 of the 64 entries run the model.
+      EXPECT_LE(nBatches, 48u);
+    }
+    if (mt) {
+      ROOT::DisableImplicitMT();
+    }
+  }
+}
+
 /**
  * @brief Test that useCuda defaults to false for models without the useCuda config key
  */
@@ -487,3 +668,103 @@ TEST_F(OnnxManagerTest, ExecuteAndFinalizeAreNoOps) {
 TEST_F(OnnxManagerTest, GetDependenciesReturnsEmpty) {
   EXPECT_TRUE(onnxManager->getDependencies().empty());
 }
+
+TEST_F(OnnxManagerTest, OptimizedModelsAreCachedAndReused) {
+  const auto dir = std::filesystem::temp_directory_path() / "rdf_onnx_optimized_test";
+  std::filesystem::remove_all(dir);
+  configManager->set("onnxOptimizedModelDir", dir.string());
+
+  ModelRegistry::instance().clear();
+  OnnxManager writer(*configManager);
+  std::size_t nCached = 0;
+  for (const auto &entry : std::filesystem::directory_iterator(dir)) {
+    EXPECT_EQ(entry.path().extension(), ".onnx");
+    ++nCached;
+  }
+  EXPECT_GT(nCached, 0u);
+
+  // A new manager loads the optimized graphs instead of the original files.
+  ModelRegistry::instance().clear();
+  OnnxManager reader(*configManager);
+  EXPECT_EQ(std::distance(std::filesystem::directory_iterator(dir),
+                          std::filesystem::directory_iterator{}),
+            static_cast<std::ptrdiff_t>(nCached));
+  EXPECT_EQ(reader.getModelInputNames("test_model"), writer.getModelInputNames("test_model"));
+  EXPECT_EQ(reader.getModelOutputNames("test_model"), writer.getModelOutputNames("test_model"));
+
+  configManager->set("onnxOptimizedModelDir", "");
+  std::filesystem::remove_all(dir);
+}
+
+TEST_F(OnnxManagerTest, ReducedPrecisionLoadsConvertedCopy) {
+  const auto dir = std::filesystem::temp_directory_path() / "rdf_onnx_precision_test";
+  std::filesystem::remove_all(dir);
+  std::filesystem::create_directories(dir);
+  const std::string onnxConfig = (dir / "onnx_int8.txt").string();
+  {
+    std::ofstream out(onnxConfig);
+    out << "file=cfg/test_model.onnx name=int8_model inputVariables=feature1,feature2,feature3 "
+           "runVar=run_number precision=int8\n";
+  }
+  const std::string previousConfig = configManager->get("onnxConfig");
+  configManager->set("onnxConfig", onnxConfig);
+  configManager->set("onnxConvertedModelDir", dir.string());
+
+  EXPECT_THROW(OnnxManager{*configManager}, std::runtime_error);
+
+  // Any model stored under the converted name is loaded in place of the original.
+  const std::string converted =
+      OnnxManager::convertedModelFile(dir.string(), "cfg/test_model.onnx", "int8");
+  EXPECT_EQ(std::filesystem::path(converted).parent_path(), dir);
+  std::filesystem::copy_file("cfg/test_model.onnx", converted);
+  OnnxManager manager(*configManager);
+  const auto provenance = manager.collectProvenanceEntries();
+  ASSERT_EQ(provenance.count("int8_model.precision"), 1u);
+  EXPECT_EQ(provenance.at("int8_model.precision"), "int8");
+  EXPECT_EQ(onnxManager->collectProvenanceEntries().at("test_model.precision"), "fp32");
+
+  configManager->set("onnxConfig", previousConfig);
+  configManager->set("onnxConvertedModelDir", "");
+  std::filesystem::remove_all(dir);
+}
+
+TEST_F(OnnxManagerTest, ModelsAreWarmedUpUnlessDisabled) {
+  EXPECT_TRUE(onnxManager->getWarmedUp("test_model"));
+  EXPECT_FALSE(onnxManager->getWarmedUp("nonexistent_model"));
+
+  const auto dir = std::filesystem::temp_directory_path() / "rdf_onnx_warmup_test";
+  std::filesystem::create_directories(dir);
+  const std::string onnxConfig = (dir / "onnx_cold.txt").string();
+  {
+    std::ofstream out(onnxConfig);
+    out << "file=cfg/test_model.onnx name=cold_model inputVariables=feature1,feature2,feature3 "
+           "runVar=run_number warmup=false\n";
+  }
+  const std::string previousConfig = configManager->get("onnxConfig");
+  configManager->set("onnxConfig", onnxConfig);
+
+  OnnxManager manager(*configManager);
+  EXPECT_FALSE(manager.getWarmedUp("cold_model"));
+  EXPECT_NO_THROW(manager.getModel("cold_model"));
+
+  configManager->set("onnxConfig", previousConfig);
+  std::filesystem::remove_all(dir);
+}
+
+TEST_F(OnnxManagerTest, SharedBatchSizeKeyIsRejected) {
+  const auto dir = std::filesystem::temp_directory_path() / "rdf_onnx_batch_key_test";
+  std::filesystem::create_directories(dir);
+  const std::string onnxConfig = (dir / "onnx_shared_batch.txt").string();
+  {
+    std::ofstream out(onnxConfig);
+    out << "file=cfg/test_model.onnx name=shared_model inputVariables=feature1,feature2,feature3 "
+           "runVar=run_number sharedBatchSize=4\n";
+  }
+  const std::string previousConfig = configManager->get("onnxConfig");
+  configManager->set("onnxConfig", onnxConfig);
+
+  EXPECT_THROW(OnnxManager{*configManager}, std::runtime_error);
+
+  configManager->set("onnxConfig", previousConfig);
+  std::filesystem::remove_all(dir);
+}
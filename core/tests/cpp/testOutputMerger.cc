@@ -0,0 +1,150 @@
+/**
+ * @file testOutputMerger.cc
+ * @brief Unit tests for OutputMerger – merging histogram, cutflow and
+ *        provenance outputs, and reading output files from manifests.
+ */
+
+#include <gtest/gtest.h>
+
+#include <OutputMerger.h>
+
+#include <TFile.h>
+#include <TH1D.h>
+#include <THnSparse.h>
+#include <TNamed.h>
+#include <TTree.h>
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+const std::string kDir = std::string(TEST_SOURCE_DIR) + "/aux/output_merger";
+
+/// Write one job output: a cutflow, a sparse histogram and provenance.
+std::string writeJobOutput(int job) {
+  const std::string path = kDir + "/job_" + std::to_string(job) + "_meta.root";
+  TFile file(path.c_str(), "RECREATE");
+  TH1D cutflow("cutflow", "", 2, 0.0, 2.0);
+  cutflow.SetBinContent(1, 10.0 * (job + 1));
+  cutflow.SetBinContent(2, job + 1.0);
+  file.WriteTObject(&cutflow, "cutflow");
+
+  const Int_t nbins[2] = {4, 4};
+  const Double_t xmin[2] = {0.0, 0.0};
+  const Double_t xmax[2] = {4.0, 4.0};
+  THnSparseF hist("h", "", 2, nbins, xmin, xmax);
+  const Double_t x[2] = {0.5 + job, 1.5};
+  hist.Fill(x, 1.0);
+  file.mkdir("Nominal")->WriteTObject(&hist, "h");
+
+  TNamed entry("task.job", std::to_string(job).c_str());
+  file.mkdir("provenance")->WriteTObject(&entry, "task.job");
+  return path;
+}
+
+/// Write a file with a tree "files" of @p entries entries of @p branch.
+std::string writeTreeOutput(const std::string &name, const std::string &branch,
+                            int entries) {
+  const std::string path = kDir + "/" + name;
+  TFile file(path.c_str(), "RECREATE");
+  TTree tree("files", "");
+  Double_t value = 0.0;
+  tree.Branch(branch.c_str(), &value);
+  for (int i = 0; i < entries; ++i) {
+    value = i;
+    tree.Fill();
+  }
+  tree.Write();
+  return path;
+}
+
+class OutputMergerTest : public ::testing::Test {
+protected:
+  void SetUp() override { std::filesystem::create_directories(kDir); }
+  void TearDown() override { std::filesystem::remove_all(kDir); }
+};
+
+} // namespace
+
+TEST_F(OutputMergerTest, AddsHistogramsAndKeepsFirstProvenance) {
+  std::vector<std::string> inputs;
+  for (int job = 0; job < 3; ++job) {
+    inputs.push_back(writeJobOutput(job));
+  }
+  const std::string output = kDir + "/merged/out_meta.root";
+  OutputMerger(2).merge(output, inputs);
+
+  TFile merged(output.c_str(), "READ");
+  ASSERT_FALSE(merged.IsZombie());
+  auto *cutflow = merged.Get<TH1D>("cutflow");
+  ASSERT_NE(cutflow, nullptr);
+  EXPECT_DOUBLE_EQ(cutflow->GetBinContent(1), 60.0);
+  EXPECT_DOUBLE_EQ(cutflow->GetBinContent(2), 6.0);
+
+  auto *hist = merged.Get<THnSparseF>("Nominal/h");
+  ASSERT_NE(hist, nullptr);
+  EXPECT_EQ(hist->GetNbins(), 3);
+  EXPECT_DOUBLE_EQ(hist->GetSumw(), 3.0);
+
+  auto *job = merged.Get<TNamed>("provenance/task.job");
+  ASSERT_NE(job, nullptr);
+  EXPECT_STREQ(job->GetTitle(), "0");
+  auto *count = merged.Get<TNamed>("provenance/merge.input_files");
+  ASSERT_NE(count, nullptr);
+  EXPECT_STREQ(count->GetTitle(), "3");
+}
+
+TEST_F(OutputMergerTest, ConcatenatesTrees) {
+  const std::string first = writeTreeOutput("a.root", "weightSum", 2);
+  const std::string second = writeTreeOutput("b.root", "weightSum", 3);
+  const std::string output = kDir + "/merged_trees.root";
+  OutputMerger(2).merge(output, {first, second});
+
+  TFile merged(output.c_str(), "READ");
+  auto *tree = merged.Get<TTree>("files");
+  ASSERT_NE(tree, nullptr);
+  EXPECT_EQ(tree->GetEntries(), 5);
+
+  const std::string other = writeTreeOutput("c.root", "entries", 1);
+  EXPECT_THROW(OutputMerger().merge(kDir + "/out.root", {first, other}),
+               std::runtime_error);
+}
+
+TEST_F(OutputMergerTest, RejectsMismatchedObjects) {
+  const std::string first = writeJobOutput(0);
+  const std::string mismatched = kDir + "/mismatched.root";
+  {
+    TFile file(mismatched.c_str(), "RECREATE");
+    TNamed cutflow("cutflow", "not a histogram");
+    file.WriteTObject(&cutflow, "cutflow");
+  }
+  EXPECT_THROW(OutputMerger().merge(kDir + "/out.root", {first, mismatched}),
+               std::runtime_error);
+  EXPECT_THROW(OutputMerger().merge(kDir + "/out.root", {}), std::runtime_error);
+}
+
+TEST_F(OutputMergerTest, GroupsManifestOutputsByBasename) {
+  std::vector<std::string> manifests;
+  for (int job = 0; job < 2; ++job) {
+    const std::string jobDir = kDir + "/job_" + std::to_string(job);
+    std::filesystem::create_directories(jobDir);
+    manifests.push_back(jobDir + "/output_manifest.yaml");
+    std::ofstream out(manifests.back());
+    out << "manifest_version: 1\n"
+        << "histograms:\n  output_file: out_meta.root\n"
+        << "cutflow: null\n";
+  }
+  const auto groups = OutputMerger::manifestOutputs(manifests, "histograms");
+  ASSERT_EQ(groups.size(), 1u);
+  const auto &files = groups.at("out_meta.root");
+  ASSERT_EQ(files.size(), 2u);
+  EXPECT_EQ(files[0], kDir + "/job_0/out_meta.root");
+  EXPECT_EQ(files[1], kDir + "/job_1/out_meta.root");
+  EXPECT_TRUE(OutputMerger::manifestOutputs(manifests, "cutflow").empty());
+}
@@ -12,9 +12,12 @@
  *  - Edge cases: empty input, out-of-bounds indices, mismatched sizes.
  *  - cacheFeature / getCachedFeature / hasCachedFeature.
  *  - removeOverlap / deltaR.
- *  - makePairs / makeCrossPairs / makeTriplets combinatoric builders.
+ *  - makePairs / makeCrossPairs / makeTriplets combinatoric builders,
+ *    including their SlotArena overloads.
+ *  - forEachPair / forEachTriplet pre-cuts and best-candidate reductions.
  *  - TypedPhysicsObjectCollection<T> user-defined object type.
  *  - PhysicsObjectVariationMap systematic variation map.
+ *  - SoAPhysicsObjectCollection layout, typed feature slots and conversions.
  */
 
 #include <PhysicsObjectCollection.h>
@@ -22,7 +25,10 @@
 #include <gtest/gtest.h>
 
 #include <ROOT/RVec.hxx>
+#include <algorithm>
+#include <array>
 #include <cmath>
+#include <type_traits>
 #include <vector>
 
 using ROOT::VecOps::RVec;
@@ -435,6 +441,52 @@ TEST_F(PhysicsObjectCollectionOverlapTest, CachedFeaturesNotCopied) {
     EXPECT_FALSE(clean.hasCachedFeature("n"));
 }
 
+TEST_F(PhysicsObjectCollectionOverlapTest, SortedSweepMatchesPairwiseCheck) {
+    // 40 x 30 objects exceed kOverlapSweepMinPairs; include objects exactly
+    // at the ΔR threshold in η and pairs across the φ = ±π boundary.
+    RVec<Float_t> jpt, jeta, jphi, jmass;
+    for (int i = 0; i < 40; ++i) {
+        jpt.push_back(20.f + i);
+        jeta.push_back(-2.4f + 0.12f * i);
+        jphi.push_back(-3.1f + 0.155f * i);
+        jmass.push_back(5.f);
+    }
+    RVec<Float_t> lpt, leta, lphi, lmass;
+    for (int j = 0; j < 30; ++j) {
+        lpt.push_back(10.f + j);
+        leta.push_back(2.3f - 0.16f * j);
+        lphi.push_back(3.12f - 0.21f * j);
+        lmass.push_back(0.f);
+    }
+    leta.push_back(-2.4f + 0.4f);
+    lphi.push_back(-3.1f);
+    lpt.push_back(15.f);
+    lmass.push_back(0.f);
+    PhysicsObjectCollection jets(jpt, jeta, jphi, jmass, RVec<bool>(jpt.size(), true));
+    PhysicsObjectCollection leptons(lpt, leta, lphi, lmass, RVec<bool>(lpt.size(), true));
+    ASSERT_GT(jets.size() * leptons.size(), PhysicsObjectCollection::kOverlapSweepMinPairs);
+
+    for (float deltaRMin : {0.f, 0.2f, 0.4f, 1.5f}) {
+        std::vector<Int_t> expected;
+        for (std::size_t i = 0; i < jets.size(); ++i) {
+            bool overlaps = false;
+            for (std::size_t j = 0; j < leptons.size(); ++j) {
+                overlaps = overlaps ||
+                           PhysicsObjectCollection::deltaR(jets.at(i), leptons.at(j)) < deltaRMin;
+            }
+            if (!overlaps) {
+                expected.push_back(jets.index(i));
+            }
+        }
+        const auto clean = jets.removeOverlap(leptons, deltaRMin);
+        ASSERT_EQ(clean.size(), expected.size()) << "deltaR " << deltaRMin;
+        for (std::size_t k = 0; k < clean.size(); ++k) {
+            EXPECT_EQ(clean.index(k), expected[k]);
+            EXPECT_EQ(clean.at(k), jets.at(static_cast<std::size_t>(expected[k])));
+        }
+    }
+}
+
 // ---------------------------------------------------------------------------
 // makePairs
 // ---------------------------------------------------------------------------
@@ -475,6 +527,22 @@ TEST_F(PhysicsObjectCollectionPairsTest, PairP4IsSumOfIndividuals) {
                          static_cast<float>(expected.M()),  1e-3f));
 }
 
+TEST_F(PhysicsObjectCollectionPairsTest, ArenaPairsMatchHeapPairs) {
+    SlotArena arena;
+    SlotArena::Scope scope(arena);
+    auto heapPairs = makePairs(col_);
+    auto arenaPairs = makePairs(col_, arena);
+    ASSERT_EQ(arenaPairs.size(), heapPairs.size());
+    for (std::size_t k = 0; k < heapPairs.size(); ++k) {
+        EXPECT_EQ(arenaPairs[k].first, heapPairs[k].first);
+        EXPECT_EQ(arenaPairs[k].second, heapPairs[k].second);
+        EXPECT_EQ(arenaPairs[k].p4, heapPairs[k].p4);
+    }
+    EXPECT_EQ(makeCrossPairs(col_, col_, arena).size(), 9u);
+    EXPECT_EQ(makeTriplets(col_, arena).size(), 1u);
+    EXPECT_GT(arena.bytesInUse(), 0u);
+}
+
 TEST(PhysicsObjectCollectionPairs, EmptyCollectionGivesNoPairs) {
     PhysicsObjectCollection empty;
     EXPECT_TRUE(makePairs(empty).empty());
@@ -739,6 +807,44 @@ TEST(PhysicsObjectVariationMap, EmptyMapHasNoEntries) {
     EXPECT_TRUE(varMap.empty());
 }
 
+TEST(PhysicsObjectVariationMap, SharedKeysGiveSlotAccess) {
+    RVec<Float_t> eta = {0.f}, phi = {0.f}, mass = {0.f};
+    RVec<bool> mask = {true};
+    const auto keys = std::make_shared<const PhysicsObjectVariationMap::Keys>(
+        std::vector<std::string>{"nominal", "JEC_up", "JEC_down"});
+    const std::size_t up = keys->slot("JEC_up");
+    ASSERT_EQ(up, 1u);
+    EXPECT_EQ(keys->slot("JER_up"), PhysicsObjectVariationMap::Keys::npos);
+
+    PhysicsObjectVariationMap varMap(keys);
+    EXPECT_TRUE(varMap.empty());
+    varMap.set(0, PhysicsObjectCollection(RVec<Float_t>{40.f}, eta, phi, mass, mask));
+    varMap.set(up, PhysicsObjectCollection(RVec<Float_t>{44.f}, eta, phi, mass, mask));
+
+    EXPECT_EQ(varMap.size(), 2u);
+    EXPECT_TRUE(approxEq(varMap.get(up).at(0).Pt(), 44.f, 1e-3f));
+    EXPECT_EQ(&varMap.get(up), &varMap.at("JEC_up"));
+    EXPECT_EQ(varMap.count("JEC_down"), 0u);
+    EXPECT_EQ(varMap.find("JEC_down"), varMap.end());
+    EXPECT_THROW(varMap.get(2), std::out_of_range);
+    EXPECT_THROW(varMap.set(3, PhysicsObjectCollection()), std::out_of_range);
+    EXPECT_THROW(varMap.at("JER_up"), std::out_of_range);
+
+    // Iteration visits the filled slots in slot order.
+    std::vector<std::string> names;
+    for (const auto &[name, col] : varMap) {
+        names.push_back(name);
+        EXPECT_EQ(col.size(), 1u);
+    }
+    EXPECT_EQ(names, (std::vector<std::string>{"nominal", "JEC_up"}));
+
+    // Adding a name leaves the shared table untouched.
+    varMap["JER_up"] = PhysicsObjectCollection();
+    EXPECT_EQ(keys->size(), 3u);
+    EXPECT_EQ(varMap.keys().slot("JER_up"), 3u);
+    EXPECT_EQ(varMap.size(), 3u);
+}
+
 // ---------------------------------------------------------------------------
 // withFilter – sub-collection creation from boolean mask
 // ---------------------------------------------------------------------------
@@ -870,6 +976,102 @@ TEST_F(PhysicsObjectCollectionCorrectionTest, CorrectedPtOutOfRangeThrows) {
     EXPECT_THROW(col.withCorrectedPt(shortPt), std::out_of_range);
 }
 
+// ---------------------------------------------------------------------------
+// Delta propagation – changedObjects / withVariedKinematics / makePairs
+// ---------------------------------------------------------------------------
+
+TEST_F(PhysicsObjectCollectionCorrectionTest, ChangedObjectsFlagsMovedObjects) {
+    PhysicsObjectCollection col(pt_, eta_, phi_, mass_, mask_);
+    // Only the object at full index 2 (second selected) moves.
+    RVec<Float_t> variedPt = {12.f, 30.f, 55.f, 25.f};
+    auto changed = col.changedObjects(pt_, variedPt);
+    ASSERT_EQ(changed.size(), 2u);
+    EXPECT_FALSE(changed[0]);
+    EXPECT_TRUE(changed[1]);
+
+    RVec<Float_t> variedMass = {0.f, 1.f, 0.f, 0.f};
+    changed = col.changedObjects(pt_, pt_, mass_, variedMass);
+    EXPECT_TRUE(changed[0]);
+    EXPECT_FALSE(changed[1]);
+}
+
+TEST_F(PhysicsObjectCollectionCorrectionTest, VariedKinematicsRebuildsOnlyChanged) {
+    PhysicsObjectCollection col(pt_, eta_, phi_, mass_, mask_);
+    RVec<Float_t> variedPt = {10.f, 30.f, 55.f, 20.f};
+    auto changed = col.changedObjects(pt_, variedPt);
+    auto varied = col.withVariedKinematics(changed, variedPt);
+    ASSERT_EQ(varied.size(), 2u);
+    EXPECT_EQ(varied.at(0), col.at(0));
+    EXPECT_TRUE(approxEq(varied.at(1).Pt(), 55.f));
+    EXPECT_TRUE(approxEq(varied.at(1).Eta(), -1.5f, 1e-3f));
+    EXPECT_EQ(varied.index(1), 2);
+
+    EXPECT_THROW(col.withVariedKinematics(RVec<bool>{true}, variedPt),
+                 std::runtime_error);
+}
+
+TEST_F(PhysicsObjectCollectionCorrectionTest, DeltaPairsReuseNominalPairs) {
+    RVec<bool> all = {true, true, true, true};
+    PhysicsObjectCollection col(pt_, eta_, phi_, mass_, all);
+    const auto nominalPairs = makePairs(col);
+
+    RVec<Float_t> variedPt = {10.f, 30.f, 50.f, 25.f};
+    auto changed = col.changedObjects(pt_, variedPt);
+    auto varied = col.withVariedKinematics(changed, variedPt);
+    const auto pairs = makePairs(varied, changed, nominalPairs);
+    const auto reference = makePairs(varied);
+    ASSERT_EQ(pairs.size(), reference.size());
+    for (std::size_t k = 0; k < pairs.size(); ++k) {
+        EXPECT_TRUE(approxEq(pairs[k].p4.M(), reference[k].p4.M(), 1e-3f));
+        EXPECT_EQ(pairs[k].first, reference[k].first);
+        EXPECT_EQ(pairs[k].second, reference[k].second);
+    }
+    // The (0, 1) pair contains no changed object and is reused verbatim.
+    EXPECT_EQ(pairs[0].p4, nominalPairs[0].p4);
+
+    RVec<bool> none(4, false);
+    int calls = 0;
+    const float nominalHT = 110.f;
+    EXPECT_EQ(reuseNominalIfUnchanged(none, nominalHT,
+                                      [&] { ++calls; return 0.f; }),
+              nominalHT);
+    EXPECT_EQ(calls, 0);
+    EXPECT_EQ(reuseNominalIfUnchanged(changed, nominalHT,
+                                      [&] { ++calls; return 115.f; }),
+              115.f);
+    EXPECT_EQ(calls, 1);
+}
+
+TEST_F(PhysicsObjectCollectionCorrectionTest, VariationsShareUnchangedStorage) {
+    PhysicsObjectCollection col(pt_, eta_, phi_, mass_, mask_);
+    col.cacheObjectFeature("btag", RVec<Float_t>{0.2f, 0.9f});
+    col.cacheFeature<float>("ht", 80.f);
+
+    // Nothing moves: the variation is the nominal storage.
+    const auto unchanged = col.withVariedKinematics(RVec<bool>(2, false), pt_);
+    EXPECT_EQ(&unchanged.vectors(), &col.vectors());
+    EXPECT_EQ(&unchanged.indices(), &col.indices());
+
+    // One object moves: only the 4-vectors are copied, the nominal is intact.
+    RVec<Float_t> variedPt = {10.f, 30.f, 55.f, 20.f};
+    const auto varied =
+        col.withVariedKinematics(col.changedObjects(pt_, variedPt), variedPt);
+    EXPECT_NE(&varied.vectors(), &col.vectors());
+    EXPECT_EQ(&varied.indices(), &col.indices());
+    EXPECT_TRUE(approxEq(col.at(1).Pt(), 50.f));
+    EXPECT_TRUE(approxEq(varied.at(1).Pt(), 55.f));
+
+    // Object features survive a kinematic variation, derived ones do not.
+    const auto corrected = col.withCorrectedPt(variedPt);
+    EXPECT_EQ(&corrected.indices(), &col.indices());
+    for (const auto *c : {&varied, &corrected}) {
+        ASSERT_TRUE(c->hasCachedFeature("btag"));
+        EXPECT_FLOAT_EQ(c->getCachedFeature<RVec<Float_t>>("btag")[1], 0.9f);
+        EXPECT_FALSE(c->hasCachedFeature("ht"));
+    }
+    EXPECT_FALSE(col.withFilter(RVec<bool>{true, true}).hasCachedFeature("btag"));
+}
+
 // ---------------------------------------------------------------------------
 // TypedPhysicsObjectCollection – withFilter/withCorrectedKinematics/withCorrectedPt
 // ---------------------------------------------------------------------------
@@ -915,3 +1117,299 @@ TEST_F(TypedPhysicsObjectCollectionTest, WithCorrectedPtPreservesObjects) {
     EXPECT_TRUE(approxEq(corrected.object(0).btagScore, 0.8f));
     EXPECT_TRUE(approxEq(corrected.object(1).btagScore, 0.9f));
 }
+
+// ---------------------------------------------------------------------------
+// TypedPhysicsObjectView – non-owning typed collection
+// ---------------------------------------------------------------------------
+
+TEST_F(TypedPhysicsObjectCollectionTest, ViewMatchesOwningCollection) {
+    TypedPhysicsObjectView<TestJetInfo> view(pt_, eta_, phi_, mass_, mask_, allInfo_);
+    TypedPhysicsObjectCollection<TestJetInfo> col(pt_, eta_, phi_, mass_, mask_, allInfo_);
+    ASSERT_EQ(view.size(), col.size());
+    for (std::size_t i = 0; i < col.size(); ++i) {
+        EXPECT_EQ(view.index(i), col.index(i));
+        EXPECT_TRUE(approxEq(view.p4(i).Pt(), col.at(i).Pt()));
+        EXPECT_EQ(&view.object(i), &allInfo_[view.index(i)]);
+    }
+    const auto copy = view.toCollection();
+    ASSERT_EQ(copy.size(), 2u);
+    EXPECT_TRUE(approxEq(copy.at(1).Pt(), 50.f));
+    EXPECT_EQ(copy.object(1).flavour, 4);
+    EXPECT_THROW(view.object(2), std::out_of_range);
+
+    TypedPhysicsObjectView<TestJetInfo> indexed(pt_, eta_, phi_, mass_, RVec<Int_t>{2, 99},
+                                                allInfo_);
+    ASSERT_EQ(indexed.size(), 1u);
+    EXPECT_EQ(indexed.object(0).flavour, 4);
+}
+
+TEST_F(TypedPhysicsObjectCollectionTest, ViewFiltersAndCorrectsWithoutCopies) {
+    TypedPhysicsObjectView<TestJetInfo> view(pt_, eta_, phi_, mass_, mask_, allInfo_);
+    RVec<Float_t> corrPt = {11.f, 33.f, 55.f, 22.f};
+    auto corrected = view.withCorrectedPt(corrPt).withFilter(RVec<bool>{false, true});
+    ASSERT_EQ(corrected.size(), 1u);
+    EXPECT_EQ(corrected.index(0), 2);
+    EXPECT_TRUE(approxEq(corrected.pt(0), 55.f));
+    EXPECT_TRUE(approxEq(corrected.eta(0), -1.5f));
+    EXPECT_EQ(&corrected.object(0), &allInfo_[2]);
+    EXPECT_THROW(view.withFilter(RVec<bool>{true}), std::runtime_error);
+
+    RVec<Float_t> shortPt = {1.f};
+    EXPECT_THROW(view.withCorrectedPt(shortPt), std::out_of_range);
+}
+
+TEST_F(TypedPhysicsObjectCollectionTest, ViewKinematicsAreCopyOnWrite) {
+    TypedPhysicsObjectView<TestJetInfo> view(pt_, eta_, phi_, mass_, mask_, allInfo_);
+    auto changed = view;
+    changed.setKinematics(0, 40.f, 0.5f, 0.1f, 1.f);
+    EXPECT_TRUE(approxEq(changed.pt(0), 40.f));
+    EXPECT_TRUE(approxEq(changed.pt(1), 50.f));
+    EXPECT_TRUE(approxEq(view.pt(0), 30.f));
+    EXPECT_TRUE(approxEq(pt_[1], 30.f));
+
+    auto copy = changed;
+    copy.setKinematics(1, 60.f, 0.f, 0.f, 0.f);
+    EXPECT_TRUE(approxEq(changed.pt(1), 50.f));
+    EXPECT_TRUE(approxEq(copy.pt(1), 60.f));
+
+    auto kept = changed.withFilter(RVec<bool>{true, false});
+    ASSERT_EQ(kept.size(), 1u);
+    EXPECT_TRUE(approxEq(kept.mass(0), 1.f));
+    EXPECT_TRUE(approxEq(changed.withCorrectedKinematics(pt_, eta_, phi_, mass_).pt(0), 30.f));
+}
+
+// A view of any temporary kinematic array does not compile.
+using TestJetView = TypedPhysicsObjectView<TestJetInfo>;
+static_assert(std::is_constructible_v<TestJetView, RVec<Float_t> &, RVec<Float_t> &,
+                                      RVec<Float_t> &, RVec<Float_t> &, RVec<bool> &,
+                                      std::vector<TestJetInfo> &>);
+static_assert(!std::is_constructible_v<TestJetView, RVec<Float_t> &, RVec<Float_t>,
+                                       RVec<Float_t> &, RVec<Float_t> &, RVec<bool> &,
+                                       std::vector<TestJetInfo> &>);
+static_assert(!std::is_constructible_v<TestJetView, RVec<Float_t> &, RVec<Float_t> &,
+                                       RVec<Float_t>, RVec<Float_t> &, RVec<bool> &,
+                                       std::vector<TestJetInfo> &>);
+static_assert(!std::is_constructible_v<TestJetView, RVec<Float_t> &, RVec<Float_t> &,
+                                       RVec<Float_t> &, RVec<Float_t>, RVec<bool> &,
+                                       std::vector<TestJetInfo> &>);
+
+// ---------------------------------------------------------------------------
+// Lazy combinatorics with pre-cuts
+// ---------------------------------------------------------------------------
+
+class PhysicsObjectCollectionLazyCombinatoricsTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        RVec<Float_t> pt   = {60.f, 45.f, 40.f, 35.f, 30.f, 25.f};
+        RVec<Float_t> eta  = {0.1f, -0.8f, 1.2f, 0.4f, -1.6f, 2.0f};
+        RVec<Float_t> phi  = {0.3f, 2.4f, -1.9f, 1.1f, -0.6f, 2.9f};
+        RVec<Float_t> mass = {5.f,  8.f,  4.f,  6.f,  3.f,  5.f};
+        col_ = PhysicsObjectCollection(pt, eta, phi, mass,
+                                       RVec<bool>(6, true));
+        charges_ = {1, -1, 1, -1, 1, -1};
+    }
+
+    static float deltaRAt(const PhysicsObjectCollection &col, std::size_t i,
+                          std::size_t j) {
+        return PhysicsObjectCollection::deltaR(col.at(i), col.at(j));
+    }
+
+    PhysicsObjectCollection col_;
+    RVec<Int_t> charges_;
+};
+
+TEST_F(PhysicsObjectCollectionLazyCombinatoricsTest, NoCutsVisitsAllCombinations) {
+    std::size_t nPairs = 0;
+    const auto pairs = makePairs(col_);
+    forEachPair(col_, [&](const ObjectPair &pair) {
+        EXPECT_EQ(pair.first, pairs[nPairs].first);
+        EXPECT_EQ(pair.second, pairs[nPairs].second);
+        ++nPairs;
+    });
+    EXPECT_EQ(nPairs, pairs.size());
+
+    std::size_t nTriplets = 0;
+    forEachTriplet(col_, [&](const ObjectTriplet &) { ++nTriplets; });
+    EXPECT_EQ(nTriplets, makeTriplets(col_).size());
+    EXPECT_EQ(nTriplets, 20u);
+}
+
+TEST_F(PhysicsObjectCollectionLazyCombinatoricsTest, CutsMatchFilteredFullList) {
+    CombinatoricCuts cuts;
+    cuts.minMass = 60.f;
+    cuts.maxMass = 200.f;
+    cuts.minDeltaR = 0.8f;
+    cuts.totalCharge = 1;
+    cuts.charges = charges_;
+
+    std::vector<std::array<std::size_t, 3>> expected;
+    for (const auto &t : makeTriplets(col_)) {
+        const float m = static_cast<float>(t.p4.M());
+        const bool pass = m >= cuts.minMass && m <= cuts.maxMass &&
+                          deltaRAt(col_, t.first, t.second) >= cuts.minDeltaR &&
+                          deltaRAt(col_, t.first, t.third) >= cuts.minDeltaR &&
+                          deltaRAt(col_, t.second, t.third) >= cuts.minDeltaR &&
+                          charges_[t.first] + charges_[t.second] +
+                                  charges_[t.third] == 1;
+        if (pass) {
+            expected.push_back({t.first, t.second, t.third});
+        }
+    }
+    std::vector<std::array<std::size_t, 3>> visited;
+    forEachTriplet(col_, [&](const ObjectTriplet &t) {
+        visited.push_back({t.first, t.second, t.third});
+    }, cuts);
+    EXPECT_FALSE(expected.empty());
+    EXPECT_EQ(visited, expected);
+
+    // Opposite-sign pairs only.
+    CombinatoricCuts osCuts;
+    osCuts.totalCharge = 0;
+    osCuts.charges = charges_;
+    forEachPair(col_, [&](const ObjectPair &p) {
+        EXPECT_EQ(charges_[p.first] + charges_[p.second], 0);
+    }, osCuts);
+}
+
+TEST_F(PhysicsObjectCollectionLazyCombinatoricsTest, BestCandidatesMatchBruteForce) {
+    const float target = 172.5f;
+    const auto triplets = makeTriplets(col_);
+    const auto closest = std::min_element(
+        triplets.begin(), triplets.end(), [&](const auto &a, const auto &b) {
+            return std::abs(a.p4.M() - target) < std::abs(b.p4.M() - target);
+        });
+    const auto best = bestTripletByMass(col_, target);
+    ASSERT_TRUE(best.has_value());
+    EXPECT_EQ(best->first, closest->first);
+    EXPECT_EQ(best->second, closest->second);
+    EXPECT_EQ(best->third, closest->third);
+
+    const auto pairs = makePairs(col_);
+    const auto hardest = std::max_element(
+        pairs.begin(), pairs.end(),
+        [](const auto &a, const auto &b) { return a.p4.Pt() < b.p4.Pt(); });
+    const auto bestPt = highestPtPair(col_);
+    ASSERT_TRUE(bestPt.has_value());
+    EXPECT_EQ(bestPt->first, hardest->first);
+    EXPECT_EQ(bestPt->second, hardest->second);
+
+    const auto bestW = bestPairByMass(col_, 80.4f);
+    ASSERT_TRUE(bestW.has_value());
+    const auto bestCross = bestCrossPairByMass(col_, col_, 80.4f);
+    ASSERT_TRUE(bestCross.has_value());
+    EXPECT_LE(std::abs(bestCross->p4.M() - 80.4f),
+              std::abs(bestW->p4.M() - 80.4f) + 1e-4f);
+    EXPECT_TRUE(highestPtTriplet(col_).has_value());
+}
+
+TEST_F(PhysicsObjectCollectionLazyCombinatoricsTest, NoPassingCandidateGivesNullopt) {
+    CombinatoricCuts cuts;
+    cuts.maxMass = 1.f;
+    EXPECT_FALSE(bestPairByMass(col_, 91.f, cuts).has_value());
+    EXPECT_FALSE(highestPtTriplet(col_, cuts).has_value());
+    EXPECT_FALSE(bestTripletByMass(PhysicsObjectCollection(), 172.5f).has_value());
+}
+
+TEST_F(PhysicsObjectCollectionLazyCombinatoricsTest, ChargeSizeMismatchThrows) {
+    CombinatoricCuts cuts;
+    cuts.totalCharge = 0;
+    cuts.charges = {1, -1};
+    EXPECT_THROW(forEachPair(col_, [](const ObjectPair &) {}, cuts),
+                 std::runtime_error);
+    EXPECT_THROW(forEachCrossPair(col_, col_, [](const ObjectPair &) {}, cuts),
+                 std::runtime_error);
+}
+
+// ---------------------------------------------------------------------------
+// SoAPhysicsObjectCollection
+// ---------------------------------------------------------------------------
+
+namespace {
+enum SoATestSlot : std::size_t { kBTag = 0, kNLeptons = 1 };
+using SoATestCollection = SoAPhysicsObjectCollection<RVec<Float_t>, int>;
+} // namespace
+
+TEST_F(PhysicsObjectCollectionTest, SoAMatchesArrayOfStructures) {
+    PhysicsObjectCollection aos(pt_, eta_, phi_, mass_, mask_);
+    SoATestCollection soa(pt_, eta_, phi_, mass_, mask_);
+    ASSERT_EQ(soa.size(), aos.size());
+    for (std::size_t i = 0; i < soa.size(); ++i) {
+        EXPECT_EQ(soa.index(i), aos.index(i));
+        EXPECT_TRUE(approxEq(soa.pt()[i], aos.at(i).Pt()));
+        EXPECT_TRUE(approxEq(soa.px()[i], aos.at(i).Px()));
+        EXPECT_TRUE(approxEq(soa.py()[i], aos.at(i).Py()));
+        EXPECT_TRUE(approxEq(soa.pz()[i], aos.at(i).Pz()));
+        EXPECT_TRUE(approxEq(soa.energy()[i], aos.at(i).E()));
+    }
+
+    auto back = soa.toCollection();
+    ASSERT_EQ(back.size(), aos.size());
+    EXPECT_EQ(back.indices(), aos.indices());
+    EXPECT_TRUE(approxEq(back.at(1).Pt(), 50.f));
+
+    SoATestCollection fromAos(aos);
+    EXPECT_TRUE(approxEq(fromAos.eta()[0], 1.0f));
+    EXPECT_TRUE(approxEq(fromAos.phi()[1], 1.0f));
+}
+
+TEST_F(PhysicsObjectCollectionTest, SoAIndexConstructorSkipsOutOfRange) {
+    RVec<Int_t> idx = {3, -1, 0, 7};
+    SoATestCollection soa(pt_, eta_, phi_, mass_, idx);
+    ASSERT_EQ(soa.size(), 2u);
+    EXPECT_EQ(soa.index(0), 3);
+    EXPECT_EQ(soa.index(1), 0);
+    EXPECT_THROW(soa.index(2), std::out_of_range);
+    EXPECT_THROW(soa.p4(2), std::out_of_range);
+}
+
+TEST_F(PhysicsObjectCollectionTest, SoATypedFeatureSlots) {
+    SoATestCollection soa(pt_, eta_, phi_, mass_, mask_);
+    EXPECT_FALSE(soa.hasFeature<kBTag>());
+    EXPECT_THROW(soa.feature<kBTag>(), std::runtime_error);
+
+    soa.cacheFeature<kBTag>(soa.getValue(btag_));
+    soa.cacheFeature<kNLeptons>(2);
+    EXPECT_TRUE(soa.hasFeature<kBTag>());
+    ASSERT_EQ(soa.feature<kBTag>().size(), 2u);
+    EXPECT_TRUE(approxEq(soa.feature<kBTag>()[0], 0.8f));
+    EXPECT_EQ(soa.feature<kNLeptons>(), 2);
+
+    // Feature slots are not propagated to derived collections.
+    auto filtered = soa.withFilter(RVec<bool>{false, true});
+    EXPECT_FALSE(filtered.hasFeature<kBTag>());
+}
+
+TEST_F(PhysicsObjectCollectionTest, SoAFilterOverlapAndCorrections) {
+    SoATestCollection soa(pt_, eta_, phi_, mass_, mask_);
+
+    auto filtered = soa.withFilter(RVec<bool>{false, true});
+    ASSERT_EQ(filtered.size(), 1u);
+    EXPECT_EQ(filtered.index(0), 2);
+    EXPECT_THROW(soa.withFilter(RVec<bool>{true}), std::runtime_error);
+
+    // A single "lepton" on top of object 1 removes it.
+    SoAPhysicsObjectCollection<> lepton(
+        RVec<Float_t>{25.f}, RVec<Float_t>{1.05f}, RVec<Float_t>{-0.45f},
+        RVec<Float_t>{0.f}, RVec<bool>{true});
+    auto cleaned = soa.removeOverlap(lepton, 0.4f);
+    ASSERT_EQ(cleaned.size(), 1u);
+    EXPECT_EQ(cleaned.index(0), 2);
+
+    PhysicsObjectCollection aos(pt_, eta_, phi_, mass_, mask_);
+    RVec<Float_t> corrPt = {11.f, 30.f, 55.f, 22.f};
+    auto ptCorrected = soa.withCorrectedPt(corrPt);
+    auto aosCorrected = aos.withCorrectedPt(corrPt);
+    ASSERT_EQ(ptCorrected.size(), 2u);
+    for (std::size_t i = 0; i < 2; ++i) {
+        EXPECT_TRUE(approxEq(ptCorrected.pt()[i], aosCorrected.at(i).Pt()));
+        EXPECT_TRUE(approxEq(ptCorrected.px()[i], aosCorrected.at(i).Px()));
+        EXPECT_TRUE(approxEq(ptCorrected.pz()[i], aosCorrected.at(i).Pz(), 1e-3f));
+        EXPECT_TRUE(approxEq(ptCorrected.energy()[i], aosCorrected.at(i).E(), 1e-3f));
+    }
+    // Unchanged objects keep their components bit for bit.
+    EXPECT_EQ(ptCorrected.px()[0], soa.px()[0]);
+
+    auto kinCorrected = soa.withCorrectedKinematics(corrPt, eta_, phi_, mass_);
+    EXPECT_TRUE(approxEq(kinCorrected.pt()[1], 55.f));
+    EXPECT_THROW(soa.withCorrectedPt(RVec<Float_t>{1.f}), std::out_of_range);
+}
@@ -5,6 +5,7 @@
 #include <RtypesCore.h>
 #include <TFile.h>
 #include <TH1D.h>
+#include <THnSparse.h>
 #include <TROOT.h>
 #include <TCanvas.h>
 #include <TLegend.h>
@@ -13,6 +14,8 @@
 #include <cstdio>
 #include <filesystem>
 #include <string>
+#include <memory>
+#include <vector>
 #include <cstdlib>
 #include <algorithm>
 #include <cctype>
@@ -521,3 +524,124 @@ TEST(PlottingUtilityTest, ComputesPCAEnvelope) {
     }
   }
 }
+
+TEST(PlottingUtilityTest, BatchSkipsUnchangedPlots) {
+  gROOT->SetBatch(true);
+
+  const std::string baseDir = std::string(TEST_SOURCE_DIR) + "/aux";
+  const std::string metaPath = baseDir + "/test_plotting_batch_meta.root";
+  std::vector<PlotRequest> requests;
+  for (int i = 0; i < 4; ++i) {
+    // .root output does not need the image library
+    const std::string out = baseDir + "/test_plotting_batch_" + std::to_string(i) + ".root";
+    std::remove(out.c_str());
+    std::remove((out + ".hash").c_str());
+    requests.push_back(createTestPlotRequest(metaPath, out, i % 2 == 1));
+  }
+  writeTestMetaFile(metaPath);
+
+  PlotBatchOptions options;
+  options.parallel = true;
+  options.maxWorkers = 2;
+  options.skipUnchanged = true;
+
+  PlottingUtility utility;
+  auto results = utility.makeStackPlots(requests, options);
+  ASSERT_EQ(results.size(), requests.size());
+  for (const auto& result : results) {
+    EXPECT_TRUE(result.success) << result.message;
+    EXPECT_FALSE(result.skipped);
+    EXPECT_DOUBLE_EQ(result.mcIntegral, 10.0);
+  }
+  EXPECT_NE(PlottingUtility::inputHash(requests[0]), PlottingUtility::inputHash(requests[1]));
+
+  results = utility.makeStackPlots(requests, options);
+  for (const auto& result : results) {
+    EXPECT_TRUE(result.success) << result.message;
+    EXPECT_TRUE(result.skipped);
+    EXPECT_DOUBLE_EQ(result.dataIntegral, 8.0);
+  }
+
+  // A style change redraws only that plot
+  requests[2].title = "Changed";
+  results = utility.makeStackPlots(requests, options);
+  EXPECT_TRUE(results[0].skipped);
+  EXPECT_FALSE(results[2].skipped);
+
+  // Missing inputs fail without touching the other plots
+  requests[3].metaFile = baseDir + "/does_not_exist.root";
+  results = utility.makeStackPlots(requests, options);
+  EXPECT_FALSE(results[3].success);
+  EXPECT_TRUE(results[1].success);
+
+  for (const auto& request : requests) {
+    std::remove(request.outputFile.c_str());
+    std::remove((request.outputFile + ".hash").c_str());
+  }
+  std::remove(metaPath.c_str());
+}
+
+TEST(PlottingUtilityTest, PCAEnvelopeFromSparseMatchesHistograms) {
+  // Variation axis: bin 1 nominal, bins 2-4 variations; observable: 3 bins.
+  const Int_t bins[3] = {4, 3, 2};
+  const Double_t xmin[3] = {0.0, 0.0, 0.0};
+  const Double_t xmax[3] = {4.0, 3.0, 2.0};
+  THnSparseD sparse("sparse", "sparse", 3, bins, xmin, xmax);
+  const double contents[4][3] = {{10, 20, 30}, {9, 19, 33}, {11, 22, 29}, {10, 18, 31}};
+
+  std::vector<std::unique_ptr<TH1D>> owned;
+  std::vector<const TH1D*> variations;
+  for (int v = 0; v < 4; ++v) {
+    if (v > 0) {
+      owned.push_back(std::make_unique<TH1D>(("v" + std::to_string(v)).c_str(), "", 3, 0.0, 3.0));
+      owned.back()->SetDirectory(nullptr);
+      variations.push_back(owned.back().get());
+    }
+    for (int o = 0; o < 3; ++o) {
+      // Split each content over the extra axis, which the sparse path sums
+      for (int extra = 0; extra < 2; ++extra) {
+        const Double_t x[3] = {v + 0.5, o + 0.5, extra + 0.5};
+        sparse.Fill(x, contents[v][o] / 2.0);
+      }
+      if (v > 0) {
+        owned.back()->SetBinContent(o + 1, contents[v][o]);
+      }
+    }
+  }
+  TH1D nominal("nominal_pca", "", 3, 0.0, 3.0);
+  nominal.SetDirectory(nullptr);
+
+  const auto fromHists = PlottingUtility::computePCAEnvelope(nominal, variations, "h");
+  const auto fromSparse = PlottingUtility::computePCAEnvelope(sparse, 0, 1, 1, "s");
+  ASSERT_NE(fromHists.up, nullptr);
+  ASSERT_NE(fromSparse.up, nullptr);
+  for (int b = 1; b <= 3; ++b) {
+    EXPECT_NEAR(fromSparse.mean->GetBinContent(b), fromHists.mean->GetBinContent(b), 1e-9);
+    EXPECT_NEAR(fromSparse.up->GetBinContent(b), fromHists.up->GetBinContent(b), 1e-9);
+    EXPECT_NEAR(fromSparse.down->GetBinContent(b), fromHists.down->GetBinContent(b), 1e-9);
+  }
+
+  // Truncation keeps the leading component only and narrows the envelope
+  const auto truncated = PlottingUtility::computePCAEnvelope(nominal, variations, "t", 1);
+  ASSERT_NE(truncated.up, nullptr);
+  for (int b = 1; b <= 3; ++b) {
+    EXPECT_LE(truncated.up->GetBinContent(b), fromHists.up->GetBinContent(b) + 1e-9);
+  }
+  double explained = 0.0;
+  for (double fraction : fromHists.explainedVariance) {
+    explained += fraction;
+  }
+  EXPECT_NEAR(explained, 1.0, 1e-9);
+
+  // Streaming accumulation equals the batch result
+  PCAAccumulator accumulator(3);
+  for (const auto* variation : variations) {
+    ASSERT_TRUE(accumulator.add(*variation));
+  }
+  EXPECT_EQ(accumulator.count(), 3u);
+  TH1D wrongBinning("wrong", "", 2, 0.0, 2.0);
+  EXPECT_FALSE(accumulator.add(wrongBinning));
+  const auto streamed = accumulator.finalize(nominal, "a");
+  ASSERT_NE(streamed.up, nullptr);
+  EXPECT_NEAR(streamed.up->GetBinContent(2), fromHists.up->GetBinContent(2), 1e-12);
+}
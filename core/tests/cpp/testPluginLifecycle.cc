@@ -4,9 +4,13 @@
 #include <api/ManagerContext.h>
 #include <analyzer.h>
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <memory>
 #include <stdexcept>
 #include <string>
+#include <thread>
 #include <vector>
 
 // ---------------------------------------------------------------------------
@@ -171,6 +175,105 @@ TEST(PluginLifecycle, DependencyExecutedBeforeDependentDuringRun) {
         << "Base must execute before Derived";
 }
 
+TEST(PluginLifecycle, RunAllExecutesAndFinalizesAfterOneEventLoop) {
+    CallLog log;
+
+    std::unordered_map<std::string, std::shared_ptr<IPluggableManager>> plugins;
+    plugins["base"] = std::make_shared<MockPlugin>("Base", log);
+
+    Analyzer analyzer(exampleCfg(), std::move(plugins));
+    log.calls.clear();
+    const unsigned int runsBefore = analyzer.getDF().GetNRuns();
+
+    ASSERT_NO_THROW(Analyzer::runAll({&analyzer}));
+
+    EXPECT_EQ(analyzer.getDF().GetNRuns(), runsBefore + 1);
+    const auto& c = log.calls;
+    auto it_execute = std::find(c.begin(), c.end(), "Base::execute");
+    auto it_finalize = std::find(c.begin(), c.end(), "Base::finalize");
+    ASSERT_NE(it_execute, c.end()) << "Base::execute not called";
+    ASSERT_NE(it_finalize, c.end()) << "Base::finalize not called";
+    EXPECT_LT(it_execute, it_finalize);
+}
+
+TEST(PluginLifecycle, RunAllRejectsNullAndRepeatedAnalyzers) {
+    Analyzer analyzer(exampleCfg());
+    EXPECT_THROW(Analyzer::runAll({&analyzer, nullptr}), std::invalid_argument);
+    EXPECT_THROW(Analyzer::runAll({&analyzer, &analyzer}), std::invalid_argument);
+}
+
+/**
+ * Plugin whose setup may run on a worker thread; it records whether all of
+ * its dependencies had finished their setup when its own setup started.
+ */
+class ConcurrentSetupPlugin : public IPluggableManager {
+public:
+    explicit ConcurrentSetupPlugin(std::vector<ConcurrentSetupPlugin*> deps = {},
+                                   bool fail = false)
+        : deps_(std::move(deps)), fail_(fail) {}
+
+    void setContext(ManagerContext&) override {}
+    std::string type() const override { return "ConcurrentSetup"; }
+    bool concurrentSetup() const override { return true; }
+    void setupFromConfigFile() override {
+        for (const auto* dep : deps_) {
+            if (!dep->setUp) depsReady = false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        if (fail_) throw std::runtime_error("setup failed");
+        setUp = true;
+    }
+
+    std::atomic<bool> setUp{false};
+    std::atomic<bool> depsReady{true};
+
+private:
+    std::vector<ConcurrentSetupPlugin*> deps_;
+    bool fail_;
+};
+
+class RoleDependentPlugin : public ConcurrentSetupPlugin {
+public:
+    RoleDependentPlugin(std::vector<std::string> roles, std::vector<ConcurrentSetupPlugin*> deps)
+        : ConcurrentSetupPlugin(std::move(deps)), roles_(std::move(roles)) {}
+    std::vector<std::string> getDependencies() const override { return roles_; }
+
+private:
+    std::vector<std::string> roles_;
+};
+
+TEST(PluginLifecycle, ConcurrentSetupWaitsForDependencies) {
+    auto a = std::make_shared<ConcurrentSetupPlugin>();
+    auto b = std::make_shared<ConcurrentSetupPlugin>();
+    auto c = std::make_shared<RoleDependentPlugin>(std::vector<std::string>{"a", "b"},
+                                                   std::vector<ConcurrentSetupPlugin*>{a.get(), b.get()});
+    CallLog log;
+    auto serial = std::make_shared<MockPlugin>("Serial", log, std::vector<std::string>{"c"});
+
+    std::unordered_map<std::string, std::shared_ptr<IPluggableManager>> plugins;
+    plugins["a"] = a;
+    plugins["b"] = b;
+    plugins["c"] = c;
+    plugins["serial"] = serial;
+    ASSERT_NO_THROW(Analyzer(exampleCfg(), std::move(plugins)));
+
+    EXPECT_TRUE(a->setUp);
+    EXPECT_TRUE(b->setUp);
+    EXPECT_TRUE(c->setUp);
+    EXPECT_TRUE(c->depsReady) << "c started before its dependencies were set up";
+    EXPECT_NE(std::find(log.calls.begin(), log.calls.end(), "Serial::setupFromConfigFile"),
+              log.calls.end());
+}
+
+TEST(PluginLifecycle, ConcurrentSetupFailureThrowsAtConstruction) {
+    std::unordered_map<std::string, std::shared_ptr<IPluggableManager>> plugins;
+    plugins["ok"] = std::make_shared<ConcurrentSetupPlugin>();
+    plugins["bad"] = std::make_shared<ConcurrentSetupPlugin>(
+        std::vector<ConcurrentSetupPlugin*>{}, true);
+
+    EXPECT_THROW(Analyzer(exampleCfg(), std::move(plugins)), std::runtime_error);
+}
+
 // ---------------------------------------------------------------------------
 // 5. Missing dependency throws at construction / addPlugin time
 // ---------------------------------------------------------------------------
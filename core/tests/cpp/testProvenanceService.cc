@@ -10,6 +10,7 @@
 #include <DataManager.h>
 #include <DefaultLogger.h>
 #include <NullOutputSink.h>
+#include <PhaseTimer.h>
 #include <ProvenanceService.h>
 #include <RootOutputSink.h>
 #include <SystematicManager.h>
@@ -18,7 +19,9 @@
 #include <TFile.h>
 #include <TNamed.h>
 
+#include <chrono>
 #include <cstdio>
+#include <filesystem>
 #include <fstream>
 #include <string>
 
@@ -93,6 +96,9 @@ TEST_F(ProvenanceServiceTest, RequiredKeysWrittenToMetaFile) {
         "root.version",
         "config.hash",
         "executor.num_threads",
+        "executor.tasks_per_worker",
+        "executor.parallel_unzip",
+        "executor.plugin_thread_pool",
     };
 
     for (const auto& key : requiredKeys) {
@@ -181,6 +187,36 @@ TEST_F(ProvenanceServiceTest, GetProvenanceReturnsAllEntries) {
     svc.finalize(df);
 }
 
+// ---------------------------------------------------------------------------
+// Test: read-ahead settings and read statistics are recorded
+// ---------------------------------------------------------------------------
+TEST_F(ProvenanceServiceTest, RecordsReadAheadSettingsAndReadRate) {
+    writeMinimalConfig(cfgPath, metaPath);
+
+    ConfigurationManager config(cfgPath);
+    config.set("treeCacheSize", "50000000");
+    DataManager dataManager(3);
+    SystematicManager systematicManager;
+    DefaultLogger logger;
+    NullOutputSink skimSink;
+    RootOutputSink metaSink;
+
+    ManagerContext ctx{config, dataManager, systematicManager, logger,
+                       skimSink, metaSink};
+
+    ProvenanceService svc;
+    svc.initialize(ctx);
+    auto df = dataManager.getDataFrame();
+    svc.finalize(df);
+
+    const auto& prov = svc.getProvenance();
+    EXPECT_EQ(prov.at("io.treeCacheSize"), "50000000");
+    EXPECT_EQ(prov.at("io.treeCachePrefetch"), "default");
+    EXPECT_NE(prov.find("io.bytes_read"), prov.end());
+    EXPECT_NE(prov.find("io.read_calls"), prov.end());
+    EXPECT_NE(prov.find("io.read_rate_mb_s"), prov.end());
+}
+
 // ---------------------------------------------------------------------------
 // Test: finalize() is graceful when no meta output file is configured
 // ---------------------------------------------------------------------------
@@ -226,6 +262,45 @@ TEST(ProvenanceService, HashStringIsPublicStaticAndDeterministic) {
     EXPECT_EQ(hash1.size(), 32u);
 }
 
+// ---------------------------------------------------------------------------
+// Test: hashFile() fingerprints, MD5 compatibility and the sidecar cache
+// ---------------------------------------------------------------------------
+TEST(ProvenanceService, HashFileAlgorithmsAndCache) {
+    using Algorithm = ProvenanceService::HashAlgorithm;
+    const auto dir = std::filesystem::temp_directory_path() / "rdf_provenance_hash_test";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+    const std::string file = (dir / "model.json").string();
+    {
+        std::ofstream out(file);
+        out << "hello world";
+    }
+
+    const std::string xxh3 = ProvenanceService::hashFile(file, Algorithm::XXH3);
+    EXPECT_EQ(xxh3.rfind("xxh3:", 0), 0u);
+    EXPECT_EQ(xxh3.size(), 5u + 16u);
+    EXPECT_EQ(xxh3, ProvenanceService::hashFile(file, Algorithm::XXH3));
+    EXPECT_EQ(ProvenanceService::hashFile(file, Algorithm::MD5),
+              ProvenanceService::hashString("hello world"));
+    EXPECT_EQ(ProvenanceService::hashFile((dir / "missing").string(), Algorithm::XXH3),
+              "<not found>");
+    EXPECT_EQ(ProvenanceService::hashFile("", Algorithm::MD5), "<empty path>");
+
+    // The cache answers for an unchanged file without reading it again.
+    const std::string cache = (dir / "cache" / "hashes.txt").string();
+    EXPECT_EQ(ProvenanceService::hashFile(file, Algorithm::XXH3, cache), xxh3);
+    std::string line;
+    {
+        std::ifstream in(cache);
+        ASSERT_TRUE(std::getline(in, line));
+    }
+    ASSERT_EQ(line.substr(line.rfind('\t') + 1), xxh3);
+    EXPECT_EQ(ProvenanceService::hashFile(file, Algorithm::XXH3, cache), xxh3);
+    EXPECT_NE(ProvenanceService::hashFile(file, Algorithm::MD5, cache), xxh3);
+
+    std::filesystem::remove_all(dir);
+}
+
 // ---------------------------------------------------------------------------
 // Test: recordDatasetManifestProvenance stores all three fields
 // ---------------------------------------------------------------------------
@@ -263,3 +338,98 @@ TEST_F(ProvenanceServiceTest, RecordDatasetManifestProvenance) {
     auto df = dataManager.getDataFrame();
     svc.finalize(df);
 }
+
+// ---------------------------------------------------------------------------
+// Test: event-loop timing, throughput and slot balance are recorded
+// ---------------------------------------------------------------------------
+TEST_F(ProvenanceServiceTest, RecordsTimingAndThroughput) {
+    writeMinimalConfig(cfgPath, metaPath);
+
+    ConfigurationManager config(cfgPath);
+    DataManager dataManager(40);
+    SystematicManager systematicManager;
+    DefaultLogger logger;
+    NullOutputSink skimSink;
+    RootOutputSink metaSink;
+
+    ManagerContext ctx{config, dataManager, systematicManager, logger,
+                       skimSink, metaSink};
+
+    ProvenanceService svc;
+    svc.initialize(ctx);
+    svc.recordPhase("config", 1.5, 0.25);
+
+    auto df = dataManager.getDataFrame();
+    svc.markEventLoopTrigger();
+    EXPECT_EQ(*df.Filter([](ULong64_t entry) { return entry % 2 == 0; },
+                         {"rdfentry_"})
+                   .Count(),
+              20u);
+    svc.finalize(df);
+
+    const auto& prov = svc.getProvenance();
+    EXPECT_EQ(prov.at("timing.config.wall_s"), "1.500");
+    EXPECT_EQ(prov.at("timing.config.cpu_s"), "0.250");
+    EXPECT_NE(prov.find("timing.jit.wall_s"), prov.end());
+    EXPECT_NE(prov.find("timing.event_loop.cpu_s"), prov.end());
+    // Every entry read counts, not only those passing the filter.
+    EXPECT_EQ(prov.at("throughput.events"), "40");
+    EXPECT_NE(prov.find("throughput.events_per_s"), prov.end());
+    EXPECT_FALSE(prov.at("executor.slot_entries").empty());
+    EXPECT_GE(std::stod(prov.at("executor.load_imbalance")), 1.0);
+    EXPECT_GT(std::stod(prov.at("memory.peak_rss_mb")), 0.0);
+    EXPECT_EQ(prov.at("dataset.name"), "ProvenanceTest");
+    EXPECT_FALSE(prov.at("env.site").empty());
+    EXPECT_FALSE(prov.at("env.hostname").empty());
+}
+
+// ---------------------------------------------------------------------------
+// Test: finalize() without an event loop records no loop statistics
+// ---------------------------------------------------------------------------
+TEST_F(ProvenanceServiceTest, NoLoopStatisticsWithoutEventLoop) {
+    writeMinimalConfig(cfgPath, metaPath);
+
+    ConfigurationManager config(cfgPath);
+    DataManager dataManager(3);
+    SystematicManager systematicManager;
+    DefaultLogger logger;
+    NullOutputSink skimSink;
+    RootOutputSink metaSink;
+
+    ManagerContext ctx{config, dataManager, systematicManager, logger,
+                       skimSink, metaSink};
+
+    ProvenanceService svc;
+    svc.initialize(ctx);
+    auto df = dataManager.getDataFrame();
+    svc.finalize(df);
+
+    const auto& prov = svc.getProvenance();
+    EXPECT_EQ(df.GetNRuns(), 0u) << "finalize() must not start the event loop";
+    EXPECT_EQ(prov.find("throughput.events"), prov.end());
+    EXPECT_EQ(prov.find("timing.event_loop.wall_s"), prov.end());
+    EXPECT_NE(prov.find("memory.peak_rss_mb"), prov.end());
+}
+
+// ---------------------------------------------------------------------------
+// Test: PhaseTimer accumulates repeated phases in first-seen order
+// ---------------------------------------------------------------------------
+TEST(PhaseTimer, AccumulatesPhasesInOrder) {
+    PhaseTimer timer;
+    timer.lap("config");
+    PhaseTimer::Sample begin = PhaseTimer::Sample::now();
+    PhaseTimer::Sample end = begin;
+    end.wall += std::chrono::milliseconds(500);
+    end.cpuSeconds += 0.5;
+    timer.add("finalize", begin, end);
+    timer.add("finalize", begin, end);
+    { PhaseTimer::Scope scope(timer, "config"); }
+
+    const auto& phases = timer.phases();
+    ASSERT_EQ(phases.size(), 2u);
+    EXPECT_EQ(phases[0].name, "config");
+    EXPECT_EQ(phases[1].name, "finalize");
+    EXPECT_DOUBLE_EQ(phases[1].wallSeconds, 1.0);
+    EXPECT_DOUBLE_EQ(phases[1].cpuSeconds, 1.0);
+    EXPECT_GE(PhaseTimer::cpuTime(), 0.0);
+}
@@ -4,7 +4,7 @@
  *
  * Tests cover: declareRegion() mechanics, hierarchy building, filter chaining,
  * validation (cycles, missing parents, duplicates), empty region list,
- * lifecycle hooks, and error handling.
+ * the region membership word, lifecycle hooks, and error handling.
  */
 
 #include <ConfigurationManager.h>
@@ -13,9 +13,14 @@
 #include <ManagerFactory.h>
 #include <NullOutputSink.h>
 #include <RegionManager.h>
+#include <RootOutputSink.h>
 #include <SystematicManager.h>
 #include <api/ManagerContext.h>
 #include <gtest/gtest.h>
+#include <TFile.h>
+#include <TTree.h>
+#include <cstdint>
+#include <cstdio>
 #include <stdexcept>
 #include <test_util.h>
 
@@ -458,6 +463,136 @@ TEST_F(RegionManagerTest, GetFilterChainSiblingRegionsAreIndependent) {
   EXPECT_EQ(controlChain[1], "pass_control");
 }
 
+// ---------------------------------------------------------------------------
+// Region skims
+// ---------------------------------------------------------------------------
+
+TEST_F(RegionManagerTest, AddRegionSkimForUnknownRegionThrows) {
+  auto dm = std::make_unique<DataManager>(1);
+  auto mgr = makeMgr(*dm);
+  EXPECT_THROW(mgr->addRegionSkim("nonexistent"), std::runtime_error);
+}
+
+TEST_F(RegionManagerTest, RegionSkimsShareOneEventLoop) {
+  // 10 events (0-9). signal: i < 3 → 3 events; control: i >= 6 → 4 events.
+  config->set("saveFile", "aux/region_skim_test.root");
+  auto dm = std::make_unique<DataManager>(10);
+  RootOutputSink rootSkimSink;
+  auto mgr = std::make_unique<RegionManager>();
+  ManagerContext ctx{*config, *dm, *systematicManager, *logger, rootSkimSink,
+                     *metaSink};
+  mgr->setContext(ctx);
+
+  dm->Define("pass_signal",  [](ULong64_t i) { return i < 3; },  {"rdfentry_"},
+             *systematicManager);
+  dm->Define("pass_control", [](ULong64_t i) { return i >= 6; }, {"rdfentry_"},
+             *systematicManager);
+  dm->Define("x", [](ULong64_t i) { return float(i); }, {"rdfentry_"},
+             *systematicManager);
+
+  mgr->declareRegion("signal",  "pass_signal");
+  mgr->declareRegion("control", "pass_control");
+  mgr->addRegionSkim("signal", {"x"});
+  mgr->addRegionSkim("control", {"x", "pass_control"});
+  EXPECT_THROW(mgr->addRegionSkim("signal"), std::runtime_error);
+
+  const std::string signalFile  = mgr->getRegionSkimFile("signal");
+  const std::string controlFile = mgr->getRegionSkimFile("control");
+  EXPECT_EQ(signalFile, "aux/region_skim_test_signal.root");
+
+  mgr->execute();
+  EXPECT_EQ(rootSkimSink.pendingSnapshots(), 2u);
+  auto df = dm->getDataFrame();
+  EXPECT_EQ(*df.Count(), 10ULL);
+  rootSkimSink.flush();
+  EXPECT_EQ(df.GetNRuns(), 1u);
+
+  {
+    TFile f(signalFile.c_str(), "READ");
+    auto *tree = f.Get<TTree>("Events");
+    ASSERT_NE(tree, nullptr);
+    EXPECT_EQ(tree->GetEntries(), 3);
+    EXPECT_NE(tree->GetBranch("x"), nullptr);
+    EXPECT_EQ(tree->GetBranch("pass_control"), nullptr);
+  }
+  {
+    TFile f(controlFile.c_str(), "READ");
+    auto *tree = f.Get<TTree>("Events");
+    ASSERT_NE(tree, nullptr);
+    EXPECT_EQ(tree->GetEntries(), 4);
+    EXPECT_NE(tree->GetBranch("pass_control"), nullptr);
+  }
+  std::remove(signalFile.c_str());
+  std::remove(controlFile.c_str());
+}
+
+// ---------------------------------------------------------------------------
+// Region membership word
+// ---------------------------------------------------------------------------
+
+TEST_F(RegionManagerTest, DeclareRegionWithNonBoolColumnThrows) {
+  auto dm = std::make_unique<DataManager>(2);
+  auto mgr = makeMgr(*dm);
+  dm->Define("n_r", [](ULong64_t i) { return static_cast<int>(i); },
+             {"rdfentry_"}, *systematicManager);
+  EXPECT_THROW(mgr->declareRegion("r", "n_r"), std::runtime_error);
+}
+
+TEST_F(RegionManagerTest, MembershipWordMatchesFilterChains) {
+  // Same layout as SiblingRegionsDontInterfere, plus an overlapping root
+  // region "odd" reusing no column of the others.
+  auto dm = std::make_unique<DataManager>(12);
+  auto mgr = makeMgr(*dm);
+
+  dm->Define("pass_presel",  [](ULong64_t i) { return i >= 2; },  {"rdfentry_"},
+             *systematicManager);
+  dm->Define("pass_signal",  [](ULong64_t i) { return i < 6; },   {"rdfentry_"},
+             *systematicManager);
+  dm->Define("pass_control", [](ULong64_t i) { return i >= 8; },  {"rdfentry_"},
+             *systematicManager);
+  dm->Define("pass_odd",     [](ULong64_t i) { return i % 2 == 1; },
+             {"rdfentry_"}, *systematicManager);
+
+  mgr->declareRegion("presel",  "pass_presel");
+  mgr->declareRegion("signal",  "pass_signal",  "presel");
+  mgr->declareRegion("control", "pass_control", "presel");
+  mgr->declareRegion("odd",     "pass_odd");
+  EXPECT_EQ(mgr->getRegionIndex("control"), 2u);
+  EXPECT_THROW(mgr->getRegionIndex("unknown"), std::runtime_error);
+
+  const std::string column = mgr->ensureMembershipColumn();
+  EXPECT_EQ(column, RegionManager::kMembershipColumn);
+  EXPECT_EQ(mgr->ensureMembershipColumn(), column); // defined once
+
+  auto words = dm->getDataFrame().Take<std::uint64_t>(column);
+  ASSERT_EQ(words->size(), 12u);
+  for (ULong64_t i = 0; i < 12; ++i) {
+    const std::uint64_t expected = (i >= 2 ? 1u : 0u) |
+                                   (i >= 2 && i < 6 ? 2u : 0u) |
+                                   (i >= 8 ? 4u : 0u) |
+                                   (i % 2 == 1 ? 8u : 0u);
+    EXPECT_EQ((*words)[i], expected) << "entry " << i;
+  }
+}
+
+TEST_F(RegionManagerTest, MembershipWordRejectsTooManyRegions) {
+  auto dm = std::make_unique<DataManager>(1);
+  auto mgr = makeMgr(*dm);
+  dm->Define("pass_r", [](ULong64_t) { return true; }, {"rdfentry_"},
+             *systematicManager);
+  for (std::size_t r = 0; r <= RegionManager::kMaxMembershipRegions; ++r) {
+    mgr->declareRegion("r" + std::to_string(r), "pass_r");
+  }
+  EXPECT_THROW(mgr->ensureMembershipColumn(), std::runtime_error);
+}
+
+TEST_F(RegionManagerTest, MembershipModeFlag) {
+  RegionManager mgr;
+  EXPECT_FALSE(mgr.isMembershipMode());
+  mgr.setMembershipMode();
+  EXPECT_TRUE(mgr.isMembershipMode());
+}
+
 int main(int argc, char **argv) {
   ::testing::InitGoogleTest(&argc, argv);
   return RUN_ALL_TESTS();
@@ -6,15 +6,31 @@
 
 #include <gtest/gtest.h>
 
+#include <ArrowOutputSink.h>
 #include <ConfigurationManager.h>
 #include <DataManager.h>
+#include <ManagerFactory.h>
+#include <RNTupleOutputSink.h>
 #include <RootOutputSink.h>
+#include <SkimColumnManifest.h>
 #include <SystematicManager.h>
+#include <functions.h>
+#include <util.h>
 
+#include <ROOT/RDataFrame.hxx>
 #include <TFile.h>
 #include <TTree.h>
 
+#if defined(HAS_ARROW_OUTPUT)
+#include <arrow/api.h>
+#include <arrow/io/file.h>
+#include <arrow/ipc/reader.h>
+#include <parquet/arrow/reader.h>
+#endif
+
+#include <algorithm>
 #include <cstdio>
+#include <filesystem>
 #include <fstream>
 #include <memory>
 #include <string>
@@ -163,3 +179,498 @@ TEST_F(RootOutputSinkTest, GlobPatternWithNoMatchDoesNotThrow) {
   ASSERT_NO_THROW(
       sink.writeDataFrame(df, config, dm.get(), &sm, OutputChannel::Skim));
 }
+
+/// Output format keys select the sink per channel and configure RNTuple compression
+TEST_F(RootOutputSinkTest, OutputFormatSelectsSinkPerChannel) {
+  writeSaveConfigFile(saveConfigPath, {"Muon_pt"});
+  writeAnalysisConfig(cfgPath, outputPath, saveConfigPath);
+
+  ConfigurationManager config(cfgPath);
+  config.set("skimOutputFormat", "rntuple");
+  config.set("rntupleCompression", "lz4");
+  config.set("rntupleCompressionLevel", "4");
+
+  auto skimSink = ManagerFactory::createOutputSink(config, OutputChannel::Skim);
+  auto* rntupleSink = dynamic_cast<RNTupleOutputSink*>(skimSink.get());
+  ASSERT_NE(rntupleSink, nullptr);
+  EXPECT_EQ(rntupleSink->compressionAlgorithm(),
+            ROOT::RCompressionSetting::EAlgorithm::kLZ4);
+  EXPECT_EQ(rntupleSink->compressionLevel(), 4);
+
+  auto metaSink = ManagerFactory::createOutputSink(config, OutputChannel::Meta);
+  EXPECT_EQ(dynamic_cast<RNTupleOutputSink*>(metaSink.get()), nullptr);
+  EXPECT_NE(dynamic_cast<RootOutputSink*>(metaSink.get()), nullptr);
+
+  config.set("metaOutputFormat", "hdf5");
+  EXPECT_THROW(ManagerFactory::createOutputSink(config, OutputChannel::Meta),
+               std::runtime_error);
+}
+
+/// snapshotOptions sets channel-wide Snapshot options and per-branch compression
+TEST_F(RootOutputSinkTest, SnapshotOptionsApplyPerChannelAndColumn) {
+  const std::string optionsPath =
+      std::string(TEST_SOURCE_DIR) + "/aux/root_output_sink_test_snapshot.txt";
+  {
+    std::ofstream out(optionsPath);
+    out << "channel=skim compression=lzma level=6 autoFlush=1000 splitLevel=0\n";
+    out << "channel=skim columns=Electron_* compression=lz4 level=4\n";
+    out << "channel=meta compression=zlib level=1\n";
+  }
+  writeSaveConfigFile(saveConfigPath, {"Electron_*", "Muon_pt"});
+  writeAnalysisConfig(cfgPath, outputPath, saveConfigPath);
+
+  ConfigurationManager config(cfgPath);
+  config.set("snapshotOptions", optionsPath);
+
+  const auto skim =
+      RootOutputSink::snapshotSettingsFromConfig(config, OutputChannel::Skim);
+  EXPECT_EQ(skim.compressionAlgorithm, ROOT::RCompressionSetting::EAlgorithm::kLZMA);
+  EXPECT_EQ(skim.compressionLevel, 6);
+  EXPECT_EQ(skim.autoFlush, 1000);
+  EXPECT_EQ(skim.splitLevel, 0);
+  ASSERT_EQ(skim.columnCompression.size(), 1u);
+  EXPECT_EQ(skim.columnCompression[0].pattern, "Electron_*");
+
+  const auto meta =
+      RootOutputSink::snapshotSettingsFromConfig(config, OutputChannel::Meta);
+  EXPECT_EQ(meta.compressionAlgorithm, ROOT::RCompressionSetting::EAlgorithm::kZLIB);
+  EXPECT_TRUE(meta.columnCompression.empty());
+
+  auto dm = makeDataManager();
+  SystematicManager sm;
+  auto sink = ManagerFactory::createOutputSink(config, OutputChannel::Skim);
+  auto df = dm->getDataFrame();
+  ASSERT_NO_THROW(
+      sink->writeDataFrame(df, config, dm.get(), &sm, OutputChannel::Skim));
+  EXPECT_FALSE(std::ifstream(outputPath + ".staging").good());
+
+  TFile f(outputPath.c_str(), "READ");
+  ASSERT_FALSE(f.IsZombie());
+  auto* tree = dynamic_cast<TTree*>(f.Get("Events"));
+  ASSERT_NE(tree, nullptr);
+  EXPECT_EQ(tree->GetEntries(), 5);
+  ASSERT_NE(tree->GetBranch("Electron_pt"), nullptr);
+  ASSERT_NE(tree->GetBranch("Muon_pt"), nullptr);
+  EXPECT_EQ(tree->GetBranch("Electron_pt")->GetCompressionSettings(),
+            ROOT::CompressionSettings(ROOT::RCompressionSetting::EAlgorithm::kLZ4, 4));
+  EXPECT_EQ(tree->GetBranch("Muon_pt")->GetCompressionSettings(),
+            ROOT::CompressionSettings(ROOT::RCompressionSetting::EAlgorithm::kLZMA, 6));
+  f.Close();
+  std::remove(optionsPath.c_str());
+
+  config.set("snapshotOptions", optionsPath);
+  {
+    std::ofstream out(optionsPath);
+    out << "channel=skim columns=Muon_pt\n";
+  }
+  EXPECT_THROW(RootOutputSink::snapshotSettingsFromConfig(config, OutputChannel::Skim),
+               std::runtime_error);
+  std::remove(optionsPath.c_str());
+}
+
+/// A booked skim is written by the event loop of another result; flush() does not rerun it
+TEST_F(RootOutputSinkTest, BookedSnapshotSharesEventLoop) {
+  writeSaveConfigFile(saveConfigPath, {"Muon_pt"});
+  writeAnalysisConfig(cfgPath, outputPath, saveConfigPath);
+
+  ConfigurationManager config(cfgPath);
+  auto dm = makeDataManager();
+  SystematicManager sm;
+
+  RootOutputSink sink;
+  auto df = dm->getDataFrame();
+  ASSERT_NO_THROW(
+      sink.bookDataFrame(df, config, dm.get(), &sm, OutputChannel::Skim));
+  EXPECT_EQ(sink.pendingSnapshots(), 1u);
+  EXPECT_EQ(df.GetNRuns(), 0u);
+
+  auto count = df.Count();
+  EXPECT_EQ(count.GetValue(), 5u);
+  EXPECT_EQ(df.GetNRuns(), 1u);
+
+  sink.flush();
+  EXPECT_EQ(sink.pendingSnapshots(), 0u);
+  EXPECT_EQ(df.GetNRuns(), 1u);
+
+  TFile f(outputPath.c_str(), "READ");
+  ASSERT_FALSE(f.IsZombie());
+  auto* tree = dynamic_cast<TTree*>(f.Get("Events"));
+  ASSERT_NE(tree, nullptr);
+  EXPECT_EQ(tree->GetEntries(), 5);
+  EXPECT_NE(tree->GetBranch("Muon_pt"), nullptr);
+  f.Close();
+}
+
+/// parquet/arrow formats select ArrowOutputSink, configured from the arrow* keys
+TEST_F(RootOutputSinkTest, ArrowFormatsSelectArrowSink) {
+  writeSaveConfigFile(saveConfigPath, {"Electron_*", "Muon_pt"});
+  writeAnalysisConfig(cfgPath, outputPath, saveConfigPath);
+
+  ConfigurationManager config(cfgPath);
+  config.set("skimOutputFormat", "parquet");
+  config.set("arrowRowGroupSize", "2");
+  config.set("arrowDictionary", "false");
+  config.set("arrowCompression", "lz4");
+
+  auto sink = ManagerFactory::createOutputSink(config, OutputChannel::Skim);
+  auto* arrowSink = dynamic_cast<ArrowOutputSink*>(sink.get());
+  ASSERT_NE(arrowSink, nullptr);
+  EXPECT_EQ(arrowSink->arrowSettings().format, ArrowSettings::Format::Parquet);
+  EXPECT_EQ(arrowSink->arrowSettings().rowGroupSize, 2u);
+  EXPECT_FALSE(arrowSink->arrowSettings().dictionary);
+  EXPECT_EQ(arrowSink->arrowSettings().compression, "lz4");
+
+  config.set("metaOutputFormat", "arrow");
+  auto metaSink = ManagerFactory::createOutputSink(config, OutputChannel::Meta);
+  ASSERT_NE(dynamic_cast<ArrowOutputSink*>(metaSink.get()), nullptr);
+  EXPECT_EQ(dynamic_cast<ArrowOutputSink*>(metaSink.get())->arrowSettings().format,
+            ArrowSettings::Format::Ipc);
+
+  EXPECT_EQ(ArrowOutputSink::datasetPath("out/skim.root", ArrowSettings::Format::Parquet),
+            "out/skim.parquet");
+  EXPECT_EQ(ArrowOutputSink::datasetPath("skim.root", ArrowSettings::Format::Ipc),
+            "skim.arrow");
+
+  config.set("arrowCompression", "brotli");
+  EXPECT_THROW(ManagerFactory::createOutputSink(config, OutputChannel::Skim),
+               std::runtime_error);
+  config.set("arrowCompression", "snappy");
+  EXPECT_THROW(ManagerFactory::createOutputSink(config, OutputChannel::Meta),
+               std::runtime_error);
+  config.set("arrowCompression", "zstd");
+  config.set("arrowRowGroupSize", "0");
+  EXPECT_THROW(ManagerFactory::createOutputSink(config, OutputChannel::Skim),
+               std::runtime_error);
+}
+
+/// training selects a Parquet ArrowOutputSink with the training* settings
+TEST_F(RootOutputSinkTest, TrainingFormatSelectsShuffledParquetSink) {
+  writeSaveConfigFile(saveConfigPath, {"Muon_pt"});
+  writeAnalysisConfig(cfgPath, outputPath, saveConfigPath);
+
+  ConfigurationManager config(cfgPath);
+  config.set("skimOutputFormat", "training");
+  EXPECT_THROW(ManagerFactory::createOutputSink(config, OutputChannel::Skim),
+               std::runtime_error);
+
+  config.set("trainingLabelColumn", "isSignal");
+  config.set("trainingClassFractions", "0:0.5");
+  config.set("arrowRowGroupSize", "1000");
+  auto sink = ManagerFactory::createOutputSink(config, OutputChannel::Skim);
+  auto* arrowSink = dynamic_cast<ArrowOutputSink*>(sink.get());
+  ASSERT_NE(arrowSink, nullptr);
+  EXPECT_EQ(arrowSink->arrowSettings().format, ArrowSettings::Format::Parquet);
+  ASSERT_TRUE(arrowSink->arrowSettings().training.has_value());
+  EXPECT_EQ(arrowSink->arrowSettings().training->labelColumn, "isSignal");
+  EXPECT_EQ(arrowSink->arrowSettings().training->chunkRows, 1000u);
+  EXPECT_DOUBLE_EQ(arrowSink->arrowSettings().training->classFractions.at(0), 0.5);
+
+  ArrowSettings ipc;
+  ipc.format = ArrowSettings::Format::Ipc;
+  ipc.training = arrowSink->arrowSettings().training;
+  EXPECT_THROW(ArrowOutputSink{ipc}, std::invalid_argument);
+}
+
+/// The Parquet dataset holds the selected columns; without Arrow the write throws
+TEST_F(RootOutputSinkTest, ArrowSinkWritesDataset) {
+  writeSaveConfigFile(saveConfigPath, {"Electron_*", "Muon_pt"});
+  writeAnalysisConfig(cfgPath, outputPath, saveConfigPath);
+
+  ConfigurationManager config(cfgPath);
+  auto dm = makeDataManager();
+  SystematicManager sm;
+  ArrowSettings settings;
+  settings.rowGroupSize = 2;
+  ArrowOutputSink sink(settings);
+  auto df = dm->getDataFrame();
+  const std::string dataset =
+      ArrowOutputSink::datasetPath(outputPath, ArrowSettings::Format::Parquet);
+
+#if defined(HAS_ARROW_OUTPUT)
+  ASSERT_NO_THROW(sink.writeDataFrame(df, config, dm.get(), &sm, OutputChannel::Skim));
+  EXPECT_TRUE(std::filesystem::exists(dataset + "/part-0.parquet"));
+#else
+  EXPECT_THROW(sink.writeDataFrame(df, config, dm.get(), &sm, OutputChannel::Skim),
+               std::runtime_error);
+#endif
+  std::filesystem::remove_all(dataset);
+}
+
+/// Arrow IPC record batches hold the scalar and RVec columns of every entry
+TEST_F(RootOutputSinkTest, ArrowIpcSinkWritesScalarAndVectorColumns) {
+  writeSaveConfigFile(saveConfigPath, {"n", "v"});
+  writeAnalysisConfig(cfgPath, outputPath, saveConfigPath);
+
+  ConfigurationManager config(cfgPath);
+  auto dm = std::make_unique<DataManager>(5);
+  SystematicManager sm;
+  dm->Define("n", [](ULong64_t entry) { return static_cast<int>(entry); }, {"rdfentry_"}, sm);
+  dm->Define("v",
+             [](ULong64_t entry) {
+               return ROOT::VecOps::RVec<float>(entry % 3, static_cast<float>(entry));
+             },
+             {"rdfentry_"}, sm);
+  ArrowSettings settings;
+  settings.format = ArrowSettings::Format::Ipc;
+  settings.compression = "none";
+  settings.rowGroupSize = 2;
+  ArrowOutputSink sink(settings);
+  auto df = dm->getDataFrame();
+  const std::string dataset =
+      ArrowOutputSink::datasetPath(outputPath, ArrowSettings::Format::Ipc);
+
+#if defined(HAS_ARROW_OUTPUT)
+  ASSERT_NO_THROW(sink.writeDataFrame(df, config, dm.get(), &sm, OutputChannel::Skim));
+  auto file = arrow::io::ReadableFile::Open(dataset + "/part-0.arrow").ValueOrDie();
+  auto reader = arrow::ipc::RecordBatchFileReader::Open(file).ValueOrDie();
+  EXPECT_EQ(reader->num_record_batches(), 3);
+  int entry = 0;
+  for (int b = 0; b < reader->num_record_batches(); ++b) {
+    const auto batch = reader->ReadRecordBatch(b).ValueOrDie();
+    const auto& n = static_cast<const arrow::Int32Array&>(*batch->GetColumnByName("n"));
+    const auto& v = static_cast<const arrow::LargeListArray&>(*batch->GetColumnByName("v"));
+    const auto& values = static_cast<const arrow::FloatArray&>(*v.values());
+    for (int64_t i = 0; i < batch->num_rows(); ++i, ++entry) {
+      EXPECT_EQ(n.Value(i), entry);
+      ASSERT_EQ(v.value_length(i), entry % 3);
+      for (int64_t k = 0; k < v.value_length(i); ++k) {
+        EXPECT_FLOAT_EQ(values.Value(v.value_offset(i) + k), static_cast<float>(entry));
+      }
+    }
+  }
+  EXPECT_EQ(entry, 5);
+#else
+  EXPECT_THROW(sink.writeDataFrame(df, config, dm.get(), &sm, OutputChannel::Skim),
+               std::runtime_error);
+#endif
+  std::filesystem::remove_all(dataset);
+}
+
+/// The training dataset holds every kept row once, shuffled and down-sampled
+TEST_F(RootOutputSinkTest, TrainingSinkWritesShuffledParquet) {
+  writeSaveConfigFile(saveConfigPath, {"x", "isSignal"});
+  writeAnalysisConfig(cfgPath, outputPath, saveConfigPath);
+
+  ConfigurationManager config(cfgPath);
+  auto dm = std::make_unique<DataManager>(100);
+  SystematicManager sm;
+  dm->Define("x", [](ULong64_t entry) { return static_cast<float>(entry); }, {"rdfentry_"},
+             sm);
+  dm->Define("isSignal", [](ULong64_t entry) { return static_cast<int>(entry % 2); },
+             {"rdfentry_"}, sm);
+  ArrowSettings settings;
+  settings.rowGroupSize = 16;
+  TrainingSettings training;
+  training.labelColumn = "isSignal";
+  training.chunkRows = 16;
+  training.shuffleRows = 32;
+  training.classFractions = {{0, 0.0}};
+  settings.training = training;
+  ArrowOutputSink sink(settings);
+  auto df = dm->getDataFrame();
+  const std::string dataset =
+      ArrowOutputSink::datasetPath(outputPath, ArrowSettings::Format::Parquet);
+
+#if defined(HAS_ARROW_OUTPUT)
+  ASSERT_NO_THROW(sink.writeDataFrame(df, config, dm.get(), &sm, OutputChannel::Skim));
+  std::vector<float> xs;
+  for (const auto& entry : std::filesystem::directory_iterator(dataset)) {
+    auto file = arrow::io::ReadableFile::Open(entry.path().string()).ValueOrDie();
+    std::unique_ptr<parquet::arrow::FileReader> reader;
+    ASSERT_TRUE(parquet::arrow::OpenFile(file, arrow::default_memory_pool(), &reader).ok());
+    std::shared_ptr<arrow::Table> table;
+    ASSERT_TRUE(reader->ReadTable(&table).ok());
+    const auto labels = table->GetColumnByName("isSignal");
+    const auto values = table->GetColumnByName("x");
+    ASSERT_NE(labels, nullptr);
+    ASSERT_NE(values, nullptr);
+    for (const auto& chunk : labels->chunks()) {
+      const auto& array = static_cast<const arrow::Int32Array&>(*chunk);
+      for (int64_t i = 0; i < array.length(); ++i) {
+        EXPECT_EQ(array.Value(i), 1);
+      }
+    }
+    for (const auto& chunk : values->chunks()) {
+      const auto& array = static_cast<const arrow::FloatArray&>(*chunk);
+      for (int64_t i = 0; i < array.length(); ++i) {
+        xs.push_back(array.Value(i));
+      }
+    }
+  }
+  ASSERT_EQ(xs.size(), 50u);
+  EXPECT_FALSE(std::is_sorted(xs.begin(), xs.end()));
+  std::sort(xs.begin(), xs.end());
+  for (std::size_t i = 0; i < xs.size(); ++i) {
+    EXPECT_FLOAT_EQ(xs[i], static_cast<float>(2 * i + 1));
+  }
+#else
+  EXPECT_THROW(sink.writeDataFrame(df, config, dm.get(), &sm, OutputChannel::Skim),
+               std::runtime_error);
+#endif
+  std::filesystem::remove_all(dataset);
+}
+
+/// An incremental skim writes only the index and the columns whose producer changed
+TEST_F(RootOutputSinkTest, IncrementalSkimWritesChangedColumns) {
+  const std::string deltaPath =
+      std::string(TEST_SOURCE_DIR) + "/aux/root_output_sink_test_delta.root";
+  writeSaveConfigFile(saveConfigPath, {"Electron_pt", "Muon_pt", "event"});
+  writeAnalysisConfig(cfgPath, outputPath, saveConfigPath);
+
+  auto dm = makeDataManager();
+  SystematicManager sm;
+  dm->Define("event", []() { return 7u; }, {}, sm);
+  auto df = dm->getDataFrame();
+
+  SkimColumnManifest manifest;
+  manifest.indexColumns = {"event"};
+  manifest.columns["Electron_pt"] = {"electronCorrections", "h1"};
+  manifest.columns["Muon_pt"] = {"muonCorrections", "h2"};
+  {
+    ConfigurationManager config(cfgPath);
+    RootOutputSink sink;
+    sink.setColumnManifest(manifest);
+    ASSERT_NO_THROW(
+        sink.writeDataFrame(df, config, dm.get(), &sm, OutputChannel::Skim));
+  }
+  const auto written = SkimColumnManifest::read(SkimColumnManifest::pathFor(outputPath));
+  EXPECT_TRUE(written.base.empty());
+  EXPECT_EQ(written.writtenColumns.size(), 3u);
+  ASSERT_NE(written.find("event"), nullptr);
+  EXPECT_EQ(written.find("event")->producer, "input");
+
+  writeAnalysisConfig(cfgPath, deltaPath, saveConfigPath);
+  manifest.base = outputPath;
+  manifest.columns["Muon_pt"].hash = "h3";
+  {
+    ConfigurationManager config(cfgPath);
+    RootOutputSink sink;
+    sink.setColumnManifest(manifest);
+    ASSERT_NO_THROW(
+        sink.writeDataFrame(df, config, dm.get(), &sm, OutputChannel::Skim));
+  }
+
+  TFile f(deltaPath.c_str(), "READ");
+  ASSERT_FALSE(f.IsZombie());
+  auto* tree = dynamic_cast<TTree*>(f.Get("Events"));
+  ASSERT_NE(tree, nullptr);
+  EXPECT_NE(tree->GetBranch("event"), nullptr);
+  EXPECT_NE(tree->GetBranch("Muon_pt"), nullptr);
+  EXPECT_EQ(tree->GetBranch("Electron_pt"), nullptr); // unchanged, read from the base
+  f.Close();
+
+  const auto delta = SkimColumnManifest::read(SkimColumnManifest::pathFor(deltaPath));
+  EXPECT_EQ(delta.base, outputPath);
+  EXPECT_EQ(delta.writtenColumns, (std::vector<std::string>{"event", "Muon_pt"}));
+  EXPECT_NE(delta.find("Electron_pt"), nullptr);
+
+  std::remove(deltaPath.c_str());
+  std::remove(SkimColumnManifest::pathFor(deltaPath).c_str());
+  std::remove(SkimColumnManifest::pathFor(outputPath).c_str());
+}
+
+/// skimFriendMode writes only defined columns and a friend config for later runs
+TEST_F(RootOutputSinkTest, FriendModeWritesDefinedColumnsOnly) {
+  const std::string inputPath =
+      std::string(TEST_SOURCE_DIR) + "/aux/root_output_sink_test_input.root";
+  {
+    TFile input(inputPath.c_str(), "RECREATE");
+    TTree tree("Events", "");
+    float jetPt = 0.0f;
+    tree.Branch("Jet_pt", &jetPt);
+    for (int i = 0; i < 4; ++i) {
+      jetPt = 10.0f * i;
+      tree.Fill();
+    }
+    tree.Write();
+  }
+
+  writeSaveConfigFile(saveConfigPath, {"*"});
+  writeAnalysisConfig(cfgPath, outputPath, saveConfigPath);
+  ConfigurationManager config(cfgPath);
+  config.set("skimFriendMode", "true");
+  config.set("skimFriendAlias", "scores");
+
+  ROOT::RDataFrame rdf("Events", inputPath);
+  ROOT::RDF::RNode df = rdf.Define("Jet_score", [](float pt) { return pt / 100.0f; }, {"Jet_pt"});
+  SystematicManager sm;
+  RootOutputSink sink;
+  ASSERT_NO_THROW(sink.writeDataFrame(df, config, nullptr, &sm, OutputChannel::Skim));
+
+  {
+    TFile f(outputPath.c_str(), "READ");
+    ASSERT_FALSE(f.IsZombie());
+    auto* tree = dynamic_cast<TTree*>(f.Get("Events"));
+    ASSERT_NE(tree, nullptr);
+    EXPECT_EQ(tree->GetEntries(), 4);
+    EXPECT_NE(tree->GetBranch("Jet_score"), nullptr);
+    EXPECT_EQ(tree->GetBranch("Jet_pt"), nullptr); // input branch, not copied
+  }
+
+  const std::string friendConfig = outputPath + ".friend.yaml";
+  const auto specs = parseFriendTreeConfig(friendConfig);
+  ASSERT_EQ(specs.size(), 1u);
+  EXPECT_EQ(specs[0].alias, "scores");
+  EXPECT_EQ(specs[0].treeName, "Events");
+  ASSERT_EQ(specs[0].files.size(), 1u);
+  EXPECT_EQ(specs[0].files[0], std::filesystem::absolute(outputPath).string());
+  EXPECT_TRUE(specs[0].indexBranches.empty());
+
+  // A filtered skim cannot be joined entry by entry.
+  ROOT::RDF::RNode filtered = df.Filter([](float pt) { return pt > 15.0f; }, {"Jet_pt"});
+  EXPECT_THROW(sink.writeDataFrame(filtered, config, nullptr, &sm, OutputChannel::Skim),
+               std::runtime_error);
+
+  std::remove(friendConfig.c_str());
+  std::remove(inputPath.c_str());
+}
+
+/// saveConfig storage hints narrow types, round mantissas and pack bool vectors
+TEST_F(RootOutputSinkTest, StorageHintsNarrowColumns) {
+  writeSaveConfigFile(saveConfigPath, {"Electron_pt mantissa=2", "nMuon type=uint8",
+                                       "Muon_isTight bits", "Muon_pt"});
+  writeAnalysisConfig(cfgPath, outputPath, saveConfigPath);
+
+  ConfigurationManager config(cfgPath);
+  auto dm = makeDataManager();
+  SystematicManager sm;
+  dm->Define("nMuon", []() { return 3; }, {}, sm);
+  dm->Define("Muon_isTight", []() { return ROOT::VecOps::RVec<bool>{true, false, true}; }, {}, sm);
+
+  RootOutputSink sink;
+  auto df = dm->getDataFrame();
+  ASSERT_NO_THROW(sink.writeDataFrame(df, config, dm.get(), &sm, OutputChannel::Skim));
+
+  ROOT::RDataFrame skim("Events", outputPath);
+  EXPECT_EQ(skim.GetColumnType("nMuon"), "UChar_t");
+  EXPECT_EQ(skim.GetColumnType("Muon_pt"), "Float_t");
+  // 30 = 1.875 * 2^4 rounds to 2 * 2^4 with two mantissa bits.
+  EXPECT_FLOAT_EQ(skim.Take<float>("Electron_pt").GetValue().at(0), 32.0f);
+  EXPECT_FLOAT_EQ(skim.Take<float>("Muon_pt").GetValue().at(0), 20.0f);
+
+  const auto packed =
+      skim.Take<ROOT::VecOps::RVec<UChar_t>>("Muon_isTight").GetValue().at(0);
+  ASSERT_EQ(packed.size(), 1u);
+  EXPECT_EQ(packed[0], 5u);
+  const auto flags = unpackBits(packed, 3);
+  ASSERT_EQ(flags.size(), 3u);
+  EXPECT_TRUE(flags[0]);
+  EXPECT_FALSE(flags[1]);
+  EXPECT_TRUE(flags[2]);
+}
+
+/// A type hint whose target cannot hold a value fails the write
+TEST_F(RootOutputSinkTest, StorageHintOverflowThrows) {
+  writeSaveConfigFile(saveConfigPath, {"nMuon type=int8"});
+  writeAnalysisConfig(cfgPath, outputPath, saveConfigPath);
+
+  ConfigurationManager config(cfgPath);
+  auto dm = makeDataManager();
+  SystematicManager sm;
+  dm->Define("nMuon", []() { return 300; }, {}, sm);
+
+  RootOutputSink sink;
+  auto df = dm->getDataFrame();
+  EXPECT_THROW(sink.writeDataFrame(df, config, dm.get(), &sm, OutputChannel::Skim),
+               std::runtime_error);
+}
@@ -0,0 +1,120 @@
+/**
+ * @file testRowBatcher.cc
+ * @brief Unit tests for RowBatcher – per-row outputs, zero padding, batching
+ *        across concurrent slots and error propagation.
+ */
+
+#include <gtest/gtest.h>
+
+#include <RowBatcher.h>
+
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace {
+
+/// Sum of each row, plus the number of rows of its batch.
+RowBatcher::Evaluate sumRows(std::size_t rowSize, std::size_t batchSize,
+                             std::atomic<int> *paddingErrors = nullptr) {
+  return [rowSize, batchSize, paddingErrors](const float *rows, std::size_t nRows,
+                                             float *outputs) {
+    for (std::size_t r = 0; r < batchSize; ++r) {
+      float sum = 0.0f;
+      for (std::size_t i = 0; i < rowSize; ++i) {
+        sum += rows[r * rowSize + i];
+      }
+      if (r < nRows) {
+        outputs[2 * r] = sum;
+        outputs[2 * r + 1] = static_cast<float>(nRows);
+      } else if (sum != 0.0f && paddingErrors) {
+        ++*paddingErrors;
+      }
+    }
+  };
+}
+
+} // namespace
+
+TEST(RowBatcherTest, SingleSlotEvaluatesEachRowAtOnce) {
+  RowBatcher batcher(3, 2, 16, 1, sumRows(3, 16), std::chrono::seconds(10));
+  const std::vector<float> row = {1.0f, 2.0f};
+  float outputs[2] = {0.0f, 0.0f};
+
+  const auto start = std::chrono::steady_clock::now();
+  batcher.infer(row.data(), row.size(), outputs);
+  batcher.infer(row.data(), row.size(), outputs);
+
+  EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(5));
+  EXPECT_FLOAT_EQ(outputs[0], 3.0f);
+  EXPECT_FLOAT_EQ(outputs[1], 1.0f);
+  EXPECT_EQ(batcher.batches(), 2u);
+  EXPECT_EQ(batcher.rows(), 2u);
+}
+
+TEST(RowBatcherTest, BatchesRowsOfConcurrentSlots) {
+  constexpr std::size_t kSlots = 4;
+  constexpr int kRowsPerSlot = 200;
+  std::atomic<int> paddingErrors{0};
+  RowBatcher batcher(2, 2, kSlots, kSlots, sumRows(2, kSlots, &paddingErrors),
+                     std::chrono::milliseconds(50));
+  std::atomic<int> wrong{0};
+  std::vector<std::thread> slots;
+  for (std::size_t s = 0; s < kSlots; ++s) {
+    slots.emplace_back([&, s]() {
+      for (int i = 0; i < kRowsPerSlot; ++i) {
+        // Rows of varying length, so stale values would show in the padding.
+        const std::vector<float> row = i % 2 == 0
+                                           ? std::vector<float>{float(s), float(i)}
+                                           : std::vector<float>{float(s + i)};
+        float outputs[2];
+        batcher.infer(row.data(), row.size(), outputs);
+        if (outputs[0] != float(s + i)) {
+          ++wrong;
+        }
+      }
+    });
+  }
+  for (auto &slot : slots) {
+    slot.join();
+  }
+
+  EXPECT_EQ(wrong.load(), 0);
+  EXPECT_EQ(paddingErrors.load(), 0);
+  EXPECT_EQ(batcher.rows(), kSlots * kRowsPerSlot);
+  EXPECT_LT(batcher.batches(), kSlots * kRowsPerSlot);
+}
+
+TEST(RowBatcherTest, ErrorsReachEverySlotOfTheBatch) {
+  RowBatcher batcher(1, 1, 2, 2,
+                     [](const float *, std::size_t, float *) {
+                       throw std::runtime_error("model failed");
+                     },
+                     std::chrono::seconds(10));
+  std::atomic<int> errors{0};
+  std::vector<std::thread> slots;
+  for (int s = 0; s < 2; ++s) {
+    slots.emplace_back([&]() {
+      const float row = 1.0f;
+      float output = 0.0f;
+      try {
+        batcher.infer(&row, 1, &output);
+      } catch (const std::runtime_error &) {
+        ++errors;
+      }
+    });
+  }
+  for (auto &slot : slots) {
+    slot.join();
+  }
+  EXPECT_EQ(errors.load(), 2);
+}
+
+TEST(RowBatcherTest, RejectsRowsLongerThanTheRowSize) {
+  RowBatcher batcher(2, 2, 4, 1, sumRows(2, 4));
+  const std::vector<float> row = {1.0f, 2.0f, 3.0f};
+  float outputs[2];
+  EXPECT_THROW(batcher.infer(row.data(), row.size(), outputs), std::invalid_argument);
+}
@@ -0,0 +1,176 @@
+/**
+ * @file testSelectionBitmap.cc
+ * @brief Unit tests for SelectionBitmap – the compressed per-file record of
+ *        the entries passing a cached preselection.
+ */
+
+#include <gtest/gtest.h>
+
+#include <SelectionBitmap.h>
+#include <analyzer.h>
+
+#include <TFile.h>
+#include <TTree.h>
+
+#include <atomic>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+const std::string kBitmapPath =
+    std::string(TEST_SOURCE_DIR) + "/aux/test_selection_bitmap.sel";
+
+/// Every tenth entry of [0, n), plus a contiguous block past the first chunk.
+EntryRangeSet mixedEntries(ULong64_t n) {
+  EntryRangeSet entries;
+  for (ULong64_t entry = 0; entry < n; entry += 10) {
+    entries.add(entry);
+  }
+  entries.add(200000, 300000);
+  return entries;
+}
+
+} // namespace
+
+TEST(SelectionBitmapTest, RoundTripsRangesThroughEveryContainer) {
+  // Every tenth entry of the first chunk fills a bitmap container, every
+  // hundredth of the second an array, and the block past them runs.
+  EntryRangeSet entries = mixedEntries(65536);
+  for (ULong64_t entry = 65536; entry < 131072; entry += 100) {
+    entries.add(entry);
+  }
+  const auto bitmap = SelectionBitmap::fromRanges(entries);
+
+  EXPECT_EQ(bitmap.size(), entries.size());
+  EXPECT_EQ(bitmap.toRanges().toString(), entries.toString());
+  EXPECT_TRUE(bitmap.contains(0));
+  EXPECT_FALSE(bitmap.contains(5));
+  EXPECT_TRUE(bitmap.contains(65636));
+  EXPECT_FALSE(bitmap.contains(65637));
+  EXPECT_TRUE(bitmap.contains(299999));
+  EXPECT_FALSE(bitmap.contains(300000));
+
+  const auto copy = SelectionBitmap::deserialize(bitmap.serialize());
+  EXPECT_EQ(copy.toRanges().toString(), entries.toString());
+}
+
+TEST(SelectionBitmapTest, StoresContiguousEntriesAsRuns) {
+  EntryRangeSet entries;
+  entries.add(0, 1000000);
+  const auto bitmap = SelectionBitmap::fromRanges(entries);
+
+  EXPECT_EQ(bitmap.size(), 1000000u);
+  // One run per 2^16 chunk rather than a bit or two bytes per entry.
+  EXPECT_LT(bitmap.serialize().size(), 512u);
+}
+
+TEST(SelectionBitmapTest, EmptyBitmapRoundTrips) {
+  const auto bitmap = SelectionBitmap::fromRanges(EntryRangeSet());
+  EXPECT_TRUE(bitmap.empty());
+  EXPECT_EQ(SelectionBitmap::deserialize(bitmap.serialize()).size(), 0u);
+}
+
+TEST(SelectionBitmapTest, RejectsMalformedData) {
+  std::string data = SelectionBitmap::fromRanges(mixedEntries(1000)).serialize();
+  EXPECT_THROW(SelectionBitmap::deserialize(data.substr(0, data.size() - 1)),
+               std::runtime_error);
+  EXPECT_THROW(SelectionBitmap::deserialize("not a bitmap"), std::runtime_error);
+}
+
+TEST(SelectionBitmapTest, ReadsOnlyBitmapsOfTheSameFile) {
+  std::remove(kBitmapPath.c_str());
+  EXPECT_FALSE(SelectionBitmap::read(kBitmapPath, 1000).has_value());
+
+  const EntryRangeSet entries = mixedEntries(1000);
+  SelectionBitmap::fromRanges(entries).write(kBitmapPath, 1000);
+
+  const auto bitmap = SelectionBitmap::read(kBitmapPath, 1000);
+  ASSERT_TRUE(bitmap.has_value());
+  EXPECT_EQ(bitmap->toRanges().toString(), entries.toString());
+  // A file with another entry count is not the file the bitmap was taken from.
+  EXPECT_FALSE(SelectionBitmap::read(kBitmapPath, 999).has_value());
+
+  std::ofstream(kBitmapPath, std::ios::binary) << "x";
+  EXPECT_THROW(SelectionBitmap::read(kBitmapPath, 1000), std::runtime_error);
+  std::remove(kBitmapPath.c_str());
+}
+
+// A recorded preselection is read back by the next run with the same key:
+// the block's cuts are then evaluated on the cached entries only, while
+// results booked before the block still see every entry.
+TEST(SelectionCacheTest, RestrictsOnlyTheNodesAfterTheBlock) {
+  const std::string dir = std::string(TEST_SOURCE_DIR) + "/aux/selection_cache";
+  const std::string input = std::string(TEST_SOURCE_DIR) + "/aux/selection_cache_input.root";
+  const std::string cfgPath = std::string(TEST_SOURCE_DIR) + "/aux/selection_cache_cfg.txt";
+  const std::string metaPath = std::string(TEST_SOURCE_DIR) + "/aux/selection_cache_meta.root";
+  std::filesystem::remove_all(dir);
+  {
+    TFile file(input.c_str(), "RECREATE");
+    TTree tree("Events", "Events");
+    Int_t x = 0;
+    tree.Branch("x", &x, "x/I");
+    for (x = 0; x < 100; ++x) {
+      tree.Fill();
+    }
+    tree.Write();
+  }
+  {
+    std::ofstream out(cfgPath);
+    out << "fileList=" << input << "\n";
+    out << "threads=1\n";
+    out << "metaFile=" << metaPath << "\n";
+    out << "selectionCacheDir=" << dir << "\n";
+  }
+
+  struct Counts {
+    ULong64_t all;
+    ULong64_t selected;
+    int evaluated;
+  };
+  const auto runJob = [&](const std::string &version, int below) {
+    auto evaluated = std::make_shared<std::atomic<int>>(0);
+    Analyzer analyzer(cfgPath);
+    auto all = analyzer.getDF().Count();
+    analyzer.beginPreselection("sel", version)
+        ->Filter("odd",
+                 [evaluated](Int_t x) {
+                   ++*evaluated;
+                   return x % 2 == 1;
+                 },
+                 {"x"})
+        ->Filter("below", [below](Int_t x) { return x < below; }, {"x"})
+        ->endPreselection();
+    auto selected = analyzer.getDF().Count();
+    analyzer.run();
+    return Counts{*all, *selected, evaluated->load()};
+  };
+
+  // Recorded, then read back: 25 odd entries below 50.
+  const Counts first = runJob("v1", 50);
+  EXPECT_EQ(first.all, 100u);
+  EXPECT_EQ(first.selected, 25u);
+  EXPECT_EQ(first.evaluated, 100);
+  const Counts cached = runJob("v1", 50);
+  EXPECT_EQ(cached.all, 100u);
+  EXPECT_EQ(cached.selected, 25u);
+  EXPECT_EQ(cached.evaluated, 25);
+
+  // A changed cut with a new version gets its own key.
+  const Counts changed = runJob("v2", 80);
+  EXPECT_EQ(changed.selected, 40u);
+  EXPECT_EQ(changed.evaluated, 100);
+  EXPECT_EQ(runJob("v2", 80).evaluated, 40);
+
+  // Blocks without a version are never cached.
+  EXPECT_EQ(runJob("", 50).evaluated, 100);
+  EXPECT_EQ(runJob("", 50).evaluated, 100);
+
+  std::filesystem::remove_all(dir);
+  std::remove(input.c_str());
+  std::remove(cfgPath.c_str());
+  std::remove(metaPath.c_str());
+}
@@ -0,0 +1,70 @@
+/**
+ * @file testSkimColumnManifest.cc
+ * @brief Unit tests for SkimColumnManifest – JSON round trip and detection
+ *        of the columns an incremental skim rewrites.
+ */
+
+#include <gtest/gtest.h>
+
+#include <SkimColumnManifest.h>
+
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+const std::string kPath =
+    std::string(TEST_SOURCE_DIR) + "/aux/skim_column_manifest_test.columns.json";
+
+SkimColumnManifest makeManifest() {
+  SkimColumnManifest manifest;
+  manifest.base = "/store/skims/v1/skim_0.root";
+  manifest.indexColumns = {"run", "event"};
+  manifest.writtenColumns = {"run", "event", "Muon_pt_corr"};
+  manifest.columns["Muon_pt_corr"] = {"muonCorrections", "abc"};
+  manifest.columns["Jet_pt_corr"] = {"jetCorrections", "def"};
+  manifest.columns["event"] = {"input", ""};
+  return manifest;
+}
+
+} // namespace
+
+TEST(SkimColumnManifestTest, PathIsNextToSkim) {
+  EXPECT_EQ(SkimColumnManifest::pathFor("out/skim.root"), "out/skim.root.columns.json");
+}
+
+TEST(SkimColumnManifestTest, WriteReadRoundTrip) {
+  const auto manifest = makeManifest();
+  manifest.write(kPath);
+  const auto read = SkimColumnManifest::read(kPath);
+  std::remove(kPath.c_str());
+
+  EXPECT_EQ(read.treeName, "Events");
+  EXPECT_EQ(read.base, manifest.base);
+  EXPECT_EQ(read.indexColumns, manifest.indexColumns);
+  EXPECT_EQ(read.writtenColumns, manifest.writtenColumns);
+  EXPECT_EQ(read.columns, manifest.columns);
+}
+
+TEST(SkimColumnManifestTest, ChangedColumnsComparesProducerAndHash) {
+  const auto base = makeManifest();
+  auto current = base;
+  EXPECT_TRUE(current.changedColumns(base).empty());
+
+  current.columns["Jet_pt_corr"].hash = "xyz";
+  current.columns["Muon_pt_corr"].producer = "muonScale";
+  current.columns["Tau_pt_corr"] = {"tauCorrections", "ghi"};
+  EXPECT_EQ(current.changedColumns(base),
+            (std::vector<std::string>{"Jet_pt_corr", "Muon_pt_corr", "Tau_pt_corr"}));
+}
+
+TEST(SkimColumnManifestTest, ReadRejectsMissingOrMalformedFile) {
+  EXPECT_THROW(SkimColumnManifest::read(kPath), std::runtime_error);
+
+  std::ofstream(kPath) << "{\"tree\": \"Events\"}\n";
+  EXPECT_THROW(SkimColumnManifest::read(kPath), std::runtime_error);
+  std::remove(kPath.c_str());
+}
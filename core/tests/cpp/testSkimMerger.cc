@@ -0,0 +1,107 @@
+/**
+ * @file testSkimMerger.cc
+ * @brief Unit tests for SkimMerger – splitting inputs by target size and
+ *        fast-copy merging of skim trees.
+ */
+
+#include <gtest/gtest.h>
+
+#include <SkimMerger.h>
+
+#include <TFile.h>
+#include <TTree.h>
+
+#include <filesystem>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+const std::string kDir = std::string(TEST_SOURCE_DIR) + "/aux/skim_merger";
+
+/// Write a skim with @p entries entries of one branch.
+std::string writeSkim(const std::string &name, int entries, int compression) {
+  const std::string path = kDir + "/" + name;
+  TFile file(path.c_str(), "RECREATE", "", compression);
+  TTree tree("Events", "");
+  float pt = 0.0f;
+  tree.Branch("pt", &pt);
+  for (int i = 0; i < entries; ++i) {
+    pt = static_cast<float>(i);
+    tree.Fill();
+  }
+  tree.Write();
+  return path;
+}
+
+Long64_t countEntries(const std::string &path) {
+  TFile file(path.c_str(), "READ");
+  auto *tree = file.Get<TTree>("Events");
+  return tree ? tree->GetEntries() : -1;
+}
+
+class SkimMergerTest : public ::testing::Test {
+protected:
+  void SetUp() override { std::filesystem::create_directories(kDir); }
+  void TearDown() override { std::filesystem::remove_all(kDir); }
+};
+
+} // namespace
+
+TEST(SkimMergerPlanTest, SplitsInputsInOrderAtTargetSize) {
+  const std::vector<std::string> inputs{"a.root", "b.root", "c.root", "d.root"};
+  const auto parts = SkimMerger(100).plan("out/skim.root", inputs, {40, 50, 120, 10});
+  ASSERT_EQ(parts.size(), 3u);
+  EXPECT_EQ(parts[0].output, "out/skim_0.root");
+  EXPECT_EQ(parts[0].inputs, (std::vector<std::string>{"a.root", "b.root"}));
+  EXPECT_EQ(parts[0].inputBytes, 90u);
+  // An input above the target is written on its own.
+  EXPECT_EQ(parts[1].inputs, (std::vector<std::string>{"c.root"}));
+  EXPECT_EQ(parts[2].output, "out/skim_2.root");
+
+  const auto single = SkimMerger().plan("out/skim.root", inputs, {40, 50, 120, 10});
+  ASSERT_EQ(single.size(), 1u);
+  EXPECT_EQ(single[0].output, "out/skim.root");
+  EXPECT_EQ(single[0].inputs.size(), 4u);
+
+  EXPECT_THROW(SkimMerger().plan("skim.root", {}, {}), std::runtime_error);
+  EXPECT_THROW(SkimMerger().plan("skim.root", inputs, {1}), std::runtime_error);
+}
+
+TEST_F(SkimMergerTest, FastCopiesInputsWithMatchingCompression) {
+  const std::vector<std::string> inputs{writeSkim("job_0.root", 100, 505),
+                                        writeSkim("job_1.root", 50, 505)};
+  const auto parts = SkimMerger().merge(kDir + "/merged/skim.root", inputs);
+  ASSERT_EQ(parts.size(), 1u);
+  EXPECT_TRUE(parts[0].fastCopy);
+  EXPECT_EQ(parts[0].compression, 505);
+  EXPECT_EQ(countEntries(parts[0].output), 150);
+
+  TFile merged(parts[0].output.c_str(), "READ");
+  EXPECT_EQ(merged.GetCompressionSettings(), 505);
+}
+
+TEST_F(SkimMergerTest, RecompressesMismatchedInputsAndSplitsOutputs) {
+  const std::vector<std::string> inputs{writeSkim("job_0.root", 100, 505),
+                                        writeSkim("job_1.root", 100, 101),
+                                        writeSkim("job_2.root", 100, 505)};
+  const auto single = SkimMerger().merge(kDir + "/skim.root", inputs);
+  ASSERT_EQ(single.size(), 1u);
+  EXPECT_FALSE(single[0].fastCopy);
+  EXPECT_EQ(countEntries(single[0].output), 300);
+
+  // A target of one byte puts every input in its own output.
+  const auto parts = SkimMerger(1).merge(kDir + "/split/skim.root", inputs);
+  ASSERT_EQ(parts.size(), 3u);
+  for (std::size_t i = 0; i < parts.size(); ++i) {
+    EXPECT_EQ(parts[i].output, kDir + "/split/skim_" + std::to_string(i) + ".root");
+    EXPECT_TRUE(parts[i].fastCopy);
+    EXPECT_EQ(countEntries(parts[i].output), 100);
+  }
+  EXPECT_EQ(parts[1].compression, 101);
+
+  EXPECT_THROW(SkimMerger().merge(kDir + "/skim.root", {kDir + "/missing.root"}),
+               std::runtime_error);
+}
@@ -0,0 +1,116 @@
+/**
+ * @file testSlotArena.cc
+ * @brief Unit tests for SlotArena.
+ *
+ * Covers:
+ *  - Alignment and chunk growth of allocate().
+ *  - reset() merging chunks into one.
+ *  - Scope nesting and rewinding, keeping allocations made before a scope.
+ *  - beginEntry() resetting only on a new entry.
+ *  - ArenaVector and per-thread local() arenas.
+ */
+
+#include <SlotArena.h>
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <thread>
+
+TEST(SlotArenaTest, AllocationsAreAlignedAndGrowChunks) {
+    SlotArena arena(128);
+    auto *c = static_cast<char *>(arena.allocate(3, 1));
+    auto *d = static_cast<double *>(arena.allocate(sizeof(double), alignof(double)));
+    EXPECT_NE(c, nullptr);
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(d) % alignof(double), 0u);
+    EXPECT_EQ(arena.chunkCount(), 1u);
+
+    arena.allocate(1000);
+    EXPECT_EQ(arena.chunkCount(), 2u);
+    EXPECT_GE(arena.capacity(), 1128u);
+}
+
+TEST(SlotArenaTest, ResetMergesChunks) {
+    SlotArena arena(64);
+    for (int i = 0; i < 10; ++i) {
+        arena.allocate(100);
+    }
+    ASSERT_GT(arena.chunkCount(), 1u);
+    const auto capacity = arena.capacity();
+
+    arena.reset();
+    EXPECT_EQ(arena.chunkCount(), 1u);
+    EXPECT_EQ(arena.capacity(), capacity);
+    EXPECT_EQ(arena.bytesInUse(), 0u);
+
+    // The same workload now fits in the merged chunk.
+    for (int i = 0; i < 10; ++i) {
+        arena.allocate(100);
+    }
+    EXPECT_EQ(arena.chunkCount(), 1u);
+}
+
+TEST(SlotArenaTest, ScopesRewindAndOutermostResets) {
+    SlotArena arena;
+    {
+        SlotArena::Scope outer(arena);
+        arena.allocate(256);
+        const auto used = arena.bytesInUse();
+        {
+            SlotArena::Scope inner(arena);
+            arena.allocate(512);
+            EXPECT_GT(arena.bytesInUse(), used);
+        }
+        EXPECT_EQ(arena.bytesInUse(), used);
+        EXPECT_EQ(arena.generation(), 0u);
+    }
+    EXPECT_EQ(arena.bytesInUse(), 0u);
+    EXPECT_EQ(arena.generation(), 1u);
+}
+
+TEST(SlotArenaTest, ScopeKeepsEarlierAllocations) {
+    SlotArena arena(64);
+    arena.beginEntry(1);
+    auto *kept = static_cast<int *>(arena.allocate(sizeof(int), alignof(int)));
+    *kept = 42;
+    const auto used = arena.bytesInUse();
+    {
+        SlotArena::Scope scope(arena);
+        arena.allocate(4096); // forces a new chunk
+        EXPECT_EQ(arena.chunkCount(), 2u);
+    }
+    EXPECT_EQ(arena.chunkCount(), 1u);
+    EXPECT_EQ(arena.bytesInUse(), used);
+    EXPECT_EQ(*kept, 42);
+    EXPECT_EQ(arena.allocate(sizeof(int), alignof(int)),
+              static_cast<void *>(kept + 1));
+}
+
+TEST(SlotArenaTest, BeginEntryResetsOnNewEntryOnly) {
+    SlotArena arena;
+    arena.beginEntry(7);
+    arena.allocate(64);
+    arena.beginEntry(7);
+    EXPECT_GT(arena.bytesInUse(), 0u);
+    arena.beginEntry(8);
+    EXPECT_EQ(arena.bytesInUse(), 0u);
+}
+
+TEST(SlotArenaTest, ArenaVectorUsesArenaMemory) {
+    SlotArena arena;
+    SlotArena::Scope scope(arena);
+    ArenaVector<int> values(scope.allocator<int>());
+    for (int i = 0; i < 100; ++i) {
+        values.push_back(i);
+    }
+    EXPECT_EQ(values[99], 99);
+    EXPECT_GE(arena.bytesInUse(), 100 * sizeof(int));
+}
+
+TEST(SlotArenaTest, LocalArenaIsPerThread) {
+    SlotArena *mainArena = &SlotArena::local();
+    SlotArena *otherArena = nullptr;
+    std::thread worker([&otherArena] { otherArena = &SlotArena::local(); });
+    worker.join();
+    EXPECT_NE(mainArena, otherArena);
+    EXPECT_EQ(mainArena, &SlotArena::local());
+}
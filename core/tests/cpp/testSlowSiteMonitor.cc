@@ -0,0 +1,112 @@
+/**
+ * @file testSlowSiteMonitor.cc
+ * @brief Unit tests for SlowSiteMonitor – per-site throughput tracking,
+ *        failover URL selection and the slow-site report.
+ */
+
+#include <gtest/gtest.h>
+
+#include <SlowSiteMonitor.h>
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+namespace {
+
+constexpr Long64_t kMB = 1024 * 1024;
+
+const std::string kSlow = "root://slow.example.org/";
+const std::string kFast = "root://fast.example.org/";
+const std::string kLfn = "/store/data/file1.root";
+
+} // namespace
+
+TEST(SlowSiteMonitorTest, SplitsUrlIntoSiteAndLogicalFileName) {
+  EXPECT_EQ(SlowSiteMonitor::siteOf(kSlow + "/" + kLfn), kSlow);
+  EXPECT_EQ(SlowSiteMonitor::logicalFileName(kSlow + "/" + kLfn), kLfn);
+  EXPECT_EQ(SlowSiteMonitor::siteOf("/data/local.root"), "");
+  EXPECT_EQ(SlowSiteMonitor::logicalFileName("/data/local.root"), "/data/local.root");
+}
+
+TEST(SlowSiteMonitorTest, FlagsSiteOnlyAfterSustainedSlowReads) {
+  SlowSiteMonitor monitor(1.0, 30.0);
+  const std::string url = kSlow + "/" + kLfn;
+
+  // 0.5 MB/s, but only 20 s below threshold so far.
+  EXPECT_TRUE(monitor.recordRead(url, 10 * kMB, 20.0));
+  EXPECT_FALSE(monitor.isSlow(kSlow));
+  // Another 20 s below threshold crosses the 30 s window.
+  EXPECT_FALSE(monitor.recordRead(url, 10 * kMB, 20.0));
+  EXPECT_TRUE(monitor.isSlow(kSlow));
+  EXPECT_NEAR(monitor.throughputMBs(kSlow), 0.5, 1e-9);
+
+  // Fast site and local files are never flagged.
+  EXPECT_TRUE(monitor.recordRead(kFast + "/" + kLfn, 100 * kMB, 10.0));
+  EXPECT_TRUE(monitor.recordRead("/data/local.root", 1, 100.0));
+  EXPECT_EQ(monitor.slowSites(), std::vector<std::string>{kSlow});
+}
+
+TEST(SlowSiteMonitorTest, RecoveryResetsTheWindow) {
+  SlowSiteMonitor monitor(1.0, 30.0);
+  const std::string url = kSlow + "/" + kLfn;
+  monitor.recordRead(url, 10 * kMB, 20.0);
+  // A fast read lifts the rolling throughput back above 1 MB/s.
+  monitor.recordRead(url, 100 * kMB, 1.0);
+  monitor.recordRead(url, 1 * kMB, 20.0);
+  EXPECT_FALSE(monitor.isSlow(kSlow));
+}
+
+TEST(SlowSiteMonitorTest, OnSampleAttributesBlocksPerSlot) {
+  SlowSiteMonitor monitor(1.0, 10.0);
+  const std::string slowUrl = kSlow + "/" + kLfn;
+  const std::string fastUrl = kFast + "/" + kLfn;
+
+  // Two slots read concurrently; the 20 MB read in [0, 20] s is shared.
+  monitor.onSample(0, slowUrl, 0.0, 0);
+  monitor.onSample(1, fastUrl, 0.0, 0);
+  monitor.onSample(0, fastUrl, 20.0, 20 * kMB);
+  EXPECT_TRUE(monitor.isSlow(kSlow));
+  EXPECT_NEAR(monitor.throughputMBs(kSlow), 0.5, 1e-9);
+
+  monitor.closeAll(21.0, 60 * kMB);
+  EXPECT_FALSE(monitor.isSlow(kFast));
+}
+
+TEST(SlowSiteMonitorTest, FailoverUsesNextRankedRedirectorThatIsNotSlow) {
+  SlowSiteMonitor monitor(1.0, 0.0);
+  monitor.setRedirectors({{kLfn, {kSlow, "root://slower.example.org", kFast}}});
+  monitor.markSlow("root://slower.example.org");
+  const std::string url = kSlow + "/" + kLfn;
+  EXPECT_EQ(monitor.failoverUrl(url), url);
+
+  monitor.recordRead(url, 1, 10.0);
+  ASSERT_TRUE(monitor.isSlow(kSlow));
+  EXPECT_EQ(monitor.failoverUrl(url), kFast + "/" + kLfn);
+  EXPECT_EQ(monitor.failoverUrl(kSlow + "//store/data/unknown.root"), "");
+}
+
+TEST(SlowSiteMonitorTest, ReportRoundTripsSlowSites) {
+  const std::string redirectorsPath = "test_slow_site_redirectors.json";
+  const std::string reportPath = "test_slow_sites.json";
+  {
+    std::ofstream out(redirectorsPath);
+    out << "{\"" << kLfn << "\": [\"" << kSlow << "\", \"" << kFast << "\"]}\n";
+  }
+
+  SlowSiteMonitor monitor(1.0, 0.0);
+  monitor.loadRedirectors(redirectorsPath);
+  monitor.recordRead(kSlow + "/" + kLfn, 1, 10.0);
+  monitor.writeReport(reportPath);
+
+  EXPECT_EQ(SlowSiteMonitor::readReportedSlowSites(reportPath),
+            std::vector<std::string>{kSlow});
+  std::ifstream in(reportPath);
+  const std::string report((std::istreambuf_iterator<char>(in)),
+                           std::istreambuf_iterator<char>());
+  EXPECT_NE(report.find("\"" + kFast + "/" + kLfn + "\""), std::string::npos);
+
+  EXPECT_TRUE(SlowSiteMonitor::readReportedSlowSites("missing_report.json").empty());
+  std::remove(redirectorsPath.c_str());
+  std::remove(reportPath.c_str());
+}
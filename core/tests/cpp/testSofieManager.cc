@@ -4,6 +4,8 @@
 #include <DataManager.h>
 #include <ROOT/RDataFrame.hxx>
 #include <ROOT/RVec.hxx>
+#include <atomic>
+#include <cmath>
 #include <gtest/gtest.h>
 #include <memory>
 #include <string>
@@ -25,6 +27,36 @@ std::vector<float> mockSofieInference(const std::vector<float>& input) {
   return {sum};
 }
 
+// Mock pointer-based SOFIE session: outputs (sum, product) of each row
+class MockSumProductSession : public SofieSession {
+public:
+  MockSumProductSession(std::size_t nFeatures, std::size_t batchSize)
+      : nFeatures_m(nFeatures), batchSize_m(batchSize) {}
+
+  void infer(const float *input, float *output) override {
+    for (std::size_t row = 0; row < batchSize_m; ++row) {
+      float sum = 0.0f;
+      float product = 1.0f;
+      for (std::size_t i = 0; i < nFeatures_m; ++i) {
+        sum += input[row * nFeatures_m + i];
+        product *= input[row * nFeatures_m + i];
+      }
+      output[2 * row] = sum;
+      output[2 * row + 1] = product;
+    }
+  }
+
+private:
+  std::size_t nFeatures_m;
+  std::size_t batchSize_m;
+};
+
+SofieSessionFactory mockSumProductFactory(std::size_t batchSize) {
+  return [batchSize]() -> std::unique_ptr<SofieSession> {
+    return std::make_unique<MockSumProductSession>(3, batchSize);
+  };
+}
+
 class SofieManagerTest : public ::testing::Test {
 protected:
   void SetUp() override {
@@ -282,6 +314,115 @@ TEST_F(SofieManagerTest, ThreadSafetyWithROOTImplicitMT) {
   }
 }
 
+/**
+ * @brief Test that multi-output session models define per-output columns
+ */
+TEST_F(SofieManagerTest, ApplyModel_SessionMultiOutput) {
+  std::vector<std::string> features = {"feature1", "feature2", "feature3"};
+  sofieManager->registerSessionModel("sum_product", mockSumProductFactory(1), features,
+                                     "run_number", 2);
+  EXPECT_EQ(sofieManager->getSessionPool("sum_product")->getOutputCount(), 2u);
+  EXPECT_THROW(sofieManager->getSessionPool("nonexistent_model"), std::runtime_error);
+
+  dataManager->Define("feature1", [](ULong64_t i) -> float { return static_cast<float>(i + 1); }, {"rdfentry_"}, *systematicManager);
+  dataManager->Define("feature2", [](ULong64_t) -> float { return 2.0f; }, {"rdfentry_"}, *systematicManager);
+  dataManager->Define("feature3", [](ULong64_t) -> float { return 3.0f; }, {"rdfentry_"}, *systematicManager);
+  dataManager->Define("run_number", [](ULong64_t i) -> bool { return i == 0; }, {"rdfentry_"}, *systematicManager);
+  sofieManager->applyModel("sum_product");
+
+  auto df = dataManager->getDataFrame();
+  auto sums = df.Take<float>("sum_product_output0");
+  auto products = df.Take<float>("sum_product_output1");
+  auto outputs = df.Take<ROOT::VecOps::RVec<float>>("sum_product_outputs");
+  ASSERT_EQ(sums->size(), 2u);
+  EXPECT_FLOAT_EQ(sums->at(0), 6.0f);
+  EXPECT_FLOAT_EQ(products->at(0), 6.0f);
+  EXPECT_FLOAT_EQ(sums->at(1), -1.0f);
+  EXPECT_FLOAT_EQ(products->at(1), -1.0f);
+  EXPECT_EQ(outputs->at(0).size(), 2u);
+
+  // getModel() evaluates through the same sessions.
+  const auto direct = (*sofieManager->getModel("sum_product"))({1.0f, 2.0f, 4.0f});
+  ASSERT_EQ(direct.size(), 2u);
+  EXPECT_FLOAT_EQ(direct[0], 7.0f);
+  EXPECT_FLOAT_EQ(direct[1], 8.0f);
+}
+
+/**
+ * @brief Test that batched session models match per-event evaluation
+ */
+TEST_F(SofieManagerTest, ApplyModel_BatchedSessionMatchesPerEvent) {
+  std::vector<std::string> features = {"feature1", "feature2", "feature3"};
+  sofieManager->registerSessionModel("per_event", mockSumProductFactory(1), features,
+                                     "run_number", 2);
+  sofieManager->registerSessionModel("batched", mockSumProductFactory(4), features,
+                                     "run_number", 2, 4);
+  EXPECT_EQ(sofieManager->getSessionPool("batched")->getBatchSize(), 4u);
+
+  ROOT::EnableImplicitMT(2);
+  {
+    DataManager batchData(30);
+    setContextFor(batchData);
+    batchData.Define("feature1", [](ULong64_t i) -> float { return static_cast<float>(i % 5); }, {"rdfentry_"}, *systematicManager);
+    batchData.Define("feature2", [](ULong64_t i) -> float { return static_cast<float>(i % 3); }, {"rdfentry_"}, *systematicManager);
+    batchData.Define("feature3", [](ULong64_t) -> float { return 3.0f; }, {"rdfentry_"}, *systematicManager);
+    batchData.Define("run_number", [](ULong64_t i) -> bool { return i % 4 != 1; }, {"rdfentry_"}, *systematicManager);
+    sofieManager->applyModel("per_event");
+    sofieManager->applyModel("batched");
+
+    auto df = batchData.getDataFrame();
+    auto absDiff = [](float a, float b) { return std::abs(a - b); };
+    auto diff0 = df.Define("diff0", absDiff, {"per_event_output0", "batched_output0"}).Max<float>("diff0");
+    auto diff1 = df.Define("diff1", absDiff, {"per_event_output1", "batched_output1"}).Max<float>("diff1");
+    EXPECT_FLOAT_EQ(*diff0, 0.0f);
+    EXPECT_FLOAT_EQ(*diff1, 0.0f);
+  }
+  ROOT::DisableImplicitMT();
+}
+
+/**
+ * @brief Test that variations leaving the model input unchanged reuse the
+ *        nominal output instead of running the model
+ */
+TEST_F(SofieManagerTest, ApplyModel_VariationsWithUnchangedInputReuseNominal) {
+  auto nCalls = std::make_shared<std::atomic<int>>(0);
+  auto inferenceFunc = std::make_shared<SofieInferenceFunction>(
+      [nCalls](const std::vector<float> &input) -> std::vector<float> {
+        ++*nCalls;
+        return mockSofieInference(input);
+      });
+  sofieManager->registerModel("counted", inferenceFunc, {"feature1", "feature2", "feature3"},
+                              "run_number");
+  systematicManager->registerSystematic("shift", {"feature1"});
+  systematicManager->registerSystematic("weightOnly", {"eventWeight"});
+
+  DataManager variationData(30);
+  setContextFor(variationData);
+  variationData.Define("feature1", [](ULong64_t) -> float { return 1.0f; }, {"rdfentry_"}, *systematicManager);
+  // Up changes odd entries only; Down never changes the input.
+  variationData.Define("feature1_shiftUp", [](ULong64_t i) -> float { return i % 2 ? 5.0f : 1.0f; }, {"rdfentry_"}, *systematicManager);
+  variationData.Define("feature1_shiftDown", [](ULong64_t) -> float { return 1.0f; }, {"rdfentry_"}, *systematicManager);
+  variationData.Define("feature2", [](ULong64_t) -> float { return 2.0f; }, {"rdfentry_"}, *systematicManager);
+  variationData.Define("feature3", [](ULong64_t) -> float { return 3.0f; }, {"rdfentry_"}, *systematicManager);
+  variationData.Define("eventWeight", [](ULong64_t) -> float { return 1.0f; }, {"rdfentry_"}, *systematicManager);
+  variationData.Define("run_number", [](ULong64_t) -> bool { return true; }, {"rdfentry_"}, *systematicManager);
+  sofieManager->applyModel("counted");
+
+  EXPECT_EQ(systematicManager->getVariationColumnName("counted", "weightOnlyUp"), "counted");
+  auto df = variationData.getDataFrame();
+  auto nominal = df.Take<float>("counted");
+  auto up = df.Take<float>(systematicManager->getVariationColumnName("counted", "shiftUp"));
+  auto down = df.Take<float>(systematicManager->getVariationColumnName("counted", "shiftDown"));
+  ASSERT_EQ(up->size(), 30u);
+  for (std::size_t i = 0; i < up->size(); ++i) {
+    EXPECT_FLOAT_EQ(nominal->at(i), 6.0f);
+    EXPECT_FLOAT_EQ(up->at(i), i % 2 ? 10.0f : 6.0f);
+    EXPECT_FLOAT_EQ(down->at(i), 6.0f);
+  }
+  // 30 nominal evaluations plus the 15 entries whose Up input differs.
+  EXPECT_EQ(nCalls->load(), 45);
+}
+
 // Test manual registration
 TEST_F(SofieManagerTest, ManualRegistration) {
   // Create a fresh manager
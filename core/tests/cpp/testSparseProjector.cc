@@ -0,0 +1,122 @@
+/**
+ * @file testSparseProjector.cc
+ * @brief Unit tests for SparseProjector – one-pass projections checked
+ *        against THnBase::Projection, and parallel projection of several
+ *        histograms.
+ */
+
+#include <gtest/gtest.h>
+
+#include <SparseProjector.h>
+
+#include <ROOT/RDataFrame.hxx>
+#include <TH1D.h>
+#include <THnSparse.h>
+
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+/// Observable x region x systematic, filled with a deterministic pattern.
+std::unique_ptr<THnSparseD> makeSparse(const std::string &name, double weightScale) {
+  const Int_t nbins[3] = {10, 3, 4};
+  const Double_t xmin[3] = {0.0, 0.0, 0.0};
+  const Double_t xmax[3] = {10.0, 3.0, 4.0};
+  auto hist = std::make_unique<THnSparseD>(name.c_str(), "", 3, nbins, xmin, xmax);
+  hist->Sumw2();
+  for (int i = 0; i < 500; ++i) {
+    const Double_t x[3] = {(i * 7 % 120) / 10.0 - 1.0, static_cast<double>(i % 3) + 0.5,
+                           static_cast<double>(i % 4) + 0.5};
+    hist->Fill(x, weightScale * (1.0 + 0.01 * i));
+  }
+  return hist;
+}
+
+/// THnBase::Projection of @p axis with the other axes restricted to single bins.
+std::unique_ptr<TH1D> reference(THnSparseD &hist, int axis,
+                                const std::vector<std::pair<int, int>> &fixedBins) {
+  for (const auto &[fixedAxis, bin] : fixedBins) {
+    hist.GetAxis(fixedAxis)->SetRange(bin, bin);
+  }
+  std::unique_ptr<TH1D> projection(hist.Projection(axis, "E"));
+  projection->SetDirectory(nullptr);
+  for (const auto &[fixedAxis, bin] : fixedBins) {
+    hist.GetAxis(fixedAxis)->SetRange();
+  }
+  return projection;
+}
+
+void expectSameBins(const TH1D &actual, const TH1D &expected, bool flow) {
+  ASSERT_EQ(actual.GetNbinsX(), expected.GetNbinsX());
+  const int first = flow ? 0 : 1;
+  const int last = flow ? actual.GetNbinsX() + 1 : actual.GetNbinsX();
+  for (int b = first; b <= last; ++b) {
+    EXPECT_NEAR(actual.GetBinContent(b), expected.GetBinContent(b), 1e-9) << "bin " << b;
+    EXPECT_NEAR(actual.GetBinError(b), expected.GetBinError(b), 1e-9) << "bin " << b;
+  }
+}
+
+} // namespace
+
+TEST(SparseProjectorTest, MatchesThnProjectionForEverySelection) {
+  auto hist = makeSparse("h", 1.0);
+  std::vector<SparseProjection> projections;
+  for (int region = 1; region <= 3; ++region) {
+    for (int syst = 1; syst <= 4; ++syst) {
+      projections.push_back({"x_r" + std::to_string(region) + "_s" + std::to_string(syst), 0,
+                             {{1, region}, {2, syst}}});
+    }
+  }
+  projections.push_back({"x_r2", 0, {{1, 2}}});
+
+  const auto shapes = SparseProjector::project(*hist, projections);
+  ASSERT_EQ(shapes.size(), projections.size());
+  for (std::size_t p = 0; p < projections.size(); ++p) {
+    EXPECT_EQ(std::string(shapes[p]->GetName()), projections[p].name);
+    const auto expected = reference(*hist, 0, projections[p].fixedBins);
+    expectSameBins(*shapes[p], *expected, true);
+  }
+}
+
+TEST(SparseProjectorTest, KeepsFlowBinsOfTheProjectedAxis) {
+  auto hist = makeSparse("h", 1.0);
+  const auto shapes = SparseProjector::project(*hist, {{"all", 0, {}}});
+  const auto expected = reference(*hist, 0, {});
+  EXPECT_GT(shapes[0]->GetBinContent(0), 0.0);
+  EXPECT_GT(shapes[0]->GetBinContent(11), 0.0);
+  expectSameBins(*shapes[0], *expected, true);
+}
+
+TEST(SparseProjectorTest, RejectsInvalidSelections) {
+  auto hist = makeSparse("h", 1.0);
+  EXPECT_THROW(SparseProjector::project(*hist, {{"bad", 3, {}}}), std::runtime_error);
+  EXPECT_THROW(SparseProjector::project(*hist, {{"bad", 0, {{0, 1}}}}), std::runtime_error);
+  EXPECT_THROW(SparseProjector::project(*hist, {{"bad", 0, {{1, 6}}}}), std::runtime_error);
+  EXPECT_THROW(SparseProjector::project(*hist, {{"bad", 0, {{1, 1}, {1, 2}}}}),
+               std::runtime_error);
+}
+
+TEST(SparseProjectorTest, ParallelProjectionMatchesSerial) {
+  std::vector<std::unique_ptr<THnSparseD>> owned;
+  std::vector<const THnBase *> hists;
+  std::vector<std::vector<SparseProjection>> projections;
+  for (int i = 0; i < 6; ++i) {
+    owned.push_back(makeSparse("h" + std::to_string(i), i + 1.0));
+    hists.push_back(owned.back().get());
+    projections.push_back({{"sr", 0, {{1, 1}, {2, 1}}}, {"cr", 0, {{1, 2}}}});
+  }
+  const auto serial = SparseProjector::project(hists, projections);
+  ROOT::EnableImplicitMT(4);
+  const auto parallel = SparseProjector::project(hists, projections);
+  ROOT::DisableImplicitMT();
+
+  ASSERT_EQ(parallel.size(), serial.size());
+  for (std::size_t i = 0; i < serial.size(); ++i) {
+    for (std::size_t p = 0; p < serial[i].size(); ++p) {
+      expectSameBins(*parallel[i][p], *serial[i][p], true);
+    }
+  }
+}
@@ -227,6 +227,90 @@ TEST_F(SystematicBundleTest, FanOutMultiOutput) {
   EXPECT_FLOAT_EQ((*b)[1], 2.0f);
 }
 
+TEST_F(SystematicBundleTest, RegisteredBundleViewReordersBlocks) {
+  dataManager->Define("pt_bundle", [](ULong64_t) {
+    // Two objects: Nominal, bUp, bDown.
+    return ROOT::VecOps::RVec<float>{1.f, 2.f, 11.f, 12.f, -1.f, -2.f};
+  }, {"rdfentry_"}, *systematicManager);
+  systematicManager->registerVariationBundle("pt", "pt_bundle", {"Nominal", "bUp", "bDown"});
+  ASSERT_NE(systematicManager->getVariationBundle("pt"), nullptr);
+  EXPECT_EQ(systematicManager->getVariationBundle("eta"), nullptr);
+
+  EXPECT_EQ(defineVariationBundleView(*dataManager, *systematicManager, "pt",
+                                      {"Nominal", "bUp", "bDown"}, "__pt_same"),
+            "pt_bundle");
+  EXPECT_EQ(defineVariationBundleView(*dataManager, *systematicManager, "eta",
+                                      {"Nominal"}, "__eta_view"),
+            "");
+
+  // aUp is not in the bundle and takes the Nominal block.
+  const auto view = defineVariationBundleView(*dataManager, *systematicManager, "pt",
+                                              {"Nominal", "aUp", "bDown", "bUp"}, "__pt_view");
+  EXPECT_EQ(view, "__pt_view");
+  auto df = dataManager->getDataFrame();
+  auto result = df.Take<ROOT::VecOps::RVec<float>>(view);
+  const std::vector<float> expected{1.f, 2.f, 1.f, 2.f, -1.f, -2.f, 11.f, 12.f};
+  ASSERT_EQ((*result)[0].size(), expected.size());
+  for (std::size_t i = 0; i < expected.size(); ++i) EXPECT_FLOAT_EQ((*result)[0][i], expected[i]);
+  EXPECT_TRUE(hasUsableSystematicColumns(*dataManager, *systematicManager, "pt", {"Nominal", "bUp"}));
+  EXPECT_FALSE(hasUsableSystematicColumns(*dataManager, *systematicManager, "pt", {"Nominal", "aUp"}));
+}
+
+TEST_F(SystematicBundleTest, FanOutVectorBundleSlicesBlocks) {
+  dataManager->Define("pt_bundle", [](ULong64_t) {
+    return ROOT::VecOps::RVec<float>{1.f, 2.f, 11.f, 12.f, -1.f, -2.f};
+  }, {"rdfentry_"}, *systematicManager);
+  fanOutVectorResultBundle(*dataManager, "pt_bundle", {"", "pt_b_up", "pt_b_down"});
+  auto df = dataManager->getDataFrame();
+  auto up = df.Take<ROOT::VecOps::RVec<float>>("pt_b_up");
+  auto dn = df.Take<ROOT::VecOps::RVec<float>>("pt_b_down");
+  ASSERT_EQ((*up)[0].size(), 2u);
+  EXPECT_FLOAT_EQ((*up)[0][1], 12.f);
+  EXPECT_FLOAT_EQ((*dn)[0][0], -1.f);
+}
+
+TEST_F(SystematicBundleTest, PackedInputUsesRegisteredBundle) {
+  registerSystematic("b", {"pt"});
+  dataManager->Define("pt", [](ULong64_t) { return ROOT::VecOps::RVec<float>{1.f, 2.f}; },
+                      {"rdfentry_"}, *systematicManager);
+  dataManager->Define("pt_bundle", [](ULong64_t) {
+    return ROOT::VecOps::RVec<float>{1.f, 2.f, 11.f, 12.f, -1.f, -2.f};
+  }, {"rdfentry_"}, *systematicManager);
+  systematicManager->registerVariationBundle("pt", "pt_bundle", {"Nominal", "bUp", "bDown"});
+  auto labels = resolveVariationLabels(*systematicManager, *dataManager, ISystematicManager::CANONICAL_SYST_BRANCH_NAME);
+  ASSERT_EQ(labels, (std::vector<std::string>{"Nominal", "bUp", "bDown"}));
+  auto spec = definePackedInputBundle(*dataManager, *systematicManager, {"pt"}, labels, "__syst_pt", true);
+  EXPECT_EQ(spec.resolvedColumnNames, std::vector<std::string>{"pt_bundle"});
+  auto df = dataManager->getDataFrame();
+  auto result = df.Take<ROOT::VecOps::RVec<float>>("__syst_pt");
+  ASSERT_EQ((*result)[0].size(), 6u);
+  EXPECT_FLOAT_EQ((*result)[0][3], 12.f);
+}
+
+TEST_F(SystematicBundleTest, ScaledBundlesWithoutFanOutRegisterBundleColumns) {
+  dataManager->Define("pt", [](ULong64_t) { return ROOT::VecOps::RVec<float>{10.f, 20.f}; },
+                      {"rdfentry_"}, *systematicManager);
+  dataManager->Define("pt_sf", [](ULong64_t) {
+    return ROOT::VecOps::RVec<float>{1.1f, 1.2f, 0.9f, 0.8f};
+  }, {"rdfentry_"}, *systematicManager);
+  ResolvedSystematicBundleOptions bundle;
+  bundle.bundleTag = "pt";
+  bundle.fanOutOutputs = false;
+  ScaledBundleStep step = makeScaledBundleStep(bundle, "pt", "");
+  step.sfBundleColumn = "pt_sf";
+  addScaledBundleSource(step, "b", "pt_b_up", "pt_b_down", "", "");
+  defineScaledBundles(*dataManager, *systematicManager, step);
+
+  // The per-source names are never defined, so only the bundle is registered.
+  EXPECT_EQ(systematicManager->getVariablesForSystematic("b"),
+            std::set<std::string>{step.ptBundleColumn});
+  auto df = dataManager->getDataFrame();
+  auto result = df.Take<ROOT::VecOps::RVec<float>>(step.ptBundleColumn);
+  const std::vector<float> expected{10.f, 20.f, 11.f, 24.f, 9.f, 16.f};
+  ASSERT_EQ((*result)[0].size(), expected.size());
+  for (std::size_t i = 0; i < expected.size(); ++i) EXPECT_FLOAT_EQ((*result)[0][i], expected[i]);
+}
+
 int main(int argc, char **argv) {
   ::testing::InitGoogleTest(&argc, argv);
   return RUN_ALL_TESTS();
@@ -1,6 +1,7 @@
 #include <SystematicManager.h>
 #include <test_util.h>
 #include <gtest/gtest.h>
+#include <cstdio>
 #include <set>
 #include <string>
 #include <vector>
@@ -460,6 +461,106 @@ TEST_F(SystematicManagerTest, AutoRegisterSystematics_DoesNotAffectManualRegistr
   EXPECT_NE(systs.find("jes"),  systs.end());
 }
 
+// ---------------------------------------------------------------------------
+// Systematic pruning by impact
+// ---------------------------------------------------------------------------
+
+TEST_F(SystematicManagerTest, MeasureImpactNormalizationAndShape) {
+  const std::vector<double> nominal = {10.0, 10.0};
+  // +10% normalization, same shape.
+  auto impact = SystematicManager::measureImpact(nominal, {11.0, 11.0}, {9.0, 9.0});
+  EXPECT_NEAR(impact.normalization, 0.1, 1e-12);
+  EXPECT_NEAR(impact.shape, 0.0, 1e-12);
+
+  // Same normalization, shape moved by 10% of the yield between bins.
+  impact = SystematicManager::measureImpact(nominal, {12.0, 8.0}, {10.0, 10.0});
+  EXPECT_NEAR(impact.normalization, 0.0, 1e-12);
+  EXPECT_NEAR(impact.shape, 0.1, 1e-12);
+}
+
+TEST_F(SystematicManagerTest, RecordImpactKeepsLargestEffect) {
+  systematicManager->recordSystematicImpact("jes", {10.0}, {10.5}, {9.5});
+  systematicManager->recordSystematicImpact("jesUp", {10.0}, {10.1}, {9.9});
+  // Empty nominal histograms carry no information.
+  systematicManager->recordSystematicImpact("jes", {0.0}, {5.0}, {5.0});
+
+  const auto &impacts = systematicManager->getSystematicImpacts();
+  ASSERT_EQ(impacts.size(), 1u);
+  EXPECT_NEAR(impacts.at("jes").normalization, 0.05, 1e-12);
+}
+
+TEST_F(SystematicManagerTest, PruningReportRoundTripsAndDropsSystematics) {
+  const std::string reportPath = "test_systematic_pruning.json";
+  systematicManager->recordSystematicImpact("jes", {10.0, 10.0}, {11.0, 11.0}, {9.0, 9.0});
+  systematicManager->recordSystematicImpact("tiny", {10.0, 10.0},
+                                            {10.001, 10.001}, {9.999, 9.999});
+  EXPECT_EQ(systematicManager->selectPrunableSystematics(1e-3, 1e-3),
+            std::vector<std::string>{"tiny"});
+  systematicManager->writePruningReport(reportPath, 1e-3, 1e-3);
+
+  const auto pruned = SystematicManager::readPrunedSystematics(reportPath);
+  EXPECT_EQ(pruned, std::vector<std::string>{"tiny"});
+  EXPECT_TRUE(SystematicManager::readPrunedSystematics("missing_report.json").empty());
+
+  SystematicManager fullRun;
+  fullRun.registerSystematic("tiny", {"weight"});
+  fullRun.setPrunedSystematics(pruned);
+  fullRun.registerSystematic("tinyUp", {"pt"});
+  fullRun.registerVariationColumns("pt", "tiny", "pt_tiny_up", "pt_tiny_dn");
+  fullRun.registerSystematic("jes", {"pt"});
+
+  EXPECT_EQ(fullRun.getSystematics(), std::set<std::string>{"jes"});
+  EXPECT_TRUE(fullRun.getSystematicsForVariable("weight").empty());
+  EXPECT_EQ(fullRun.getVariationColumnName("pt", "tinyUp"), "pt");
+  EXPECT_EQ(fullRun.getPrunedSystematics(), std::set<std::string>{"tiny"});
+  std::remove(reportPath.c_str());
+}
+
+TEST_F(SystematicManagerTest, SystematicIdsAreDenseAndResolveLabels) {
+  systematicManager->registerSystematic("jes", {"pt", "mass"});
+  systematicManager->registerSystematic("jerUp", {"pt"});
+  systematicManager->registerSystematic("jesDown", {"eta"});
+
+  const auto &ids = systematicManager->getSystematicIds();
+  EXPECT_EQ(ids.systematicCount(), 2u);
+  EXPECT_EQ(ids.variableCount(), 3u);
+  EXPECT_EQ(ids.systematicName(0), "jes");
+  EXPECT_EQ(ids.systematicName(1), "jer");
+
+  const auto nominal = ids.variation("jes");
+  const auto up = ids.variation("jesUp");
+  const auto down = ids.variation("jesDown");
+  EXPECT_EQ(nominal.systematic, 0u);
+  EXPECT_EQ(up.systematic, 0u);
+  EXPECT_EQ(down.systematic, 0u);
+  EXPECT_EQ(nominal.direction, SystematicIdTable::Direction::None);
+  EXPECT_EQ(up.direction, SystematicIdTable::Direction::Up);
+  EXPECT_EQ(down.direction, SystematicIdTable::Direction::Down);
+  EXPECT_EQ(ids.variation("jer").systematic, 1u);
+  EXPECT_EQ(ids.variation("unknownUp").systematic, SystematicIdTable::npos);
+  EXPECT_EQ(ids.variableId("unknown"), SystematicIdTable::npos);
+
+  const auto pt = ids.variableId("pt");
+  EXPECT_TRUE(systematicManager->isVariableAffected(pt, up.systematic));
+  EXPECT_TRUE(systematicManager->isVariableAffected(pt, ids.variation("jerDown").systematic));
+  EXPECT_FALSE(systematicManager->isVariableAffected(ids.variableId("eta"), 1));
+  EXPECT_FALSE(systematicManager->isVariableAffected(SystematicIdTable::npos, 0));
+  EXPECT_TRUE(systematicManager->isVariableAffectedBySystematic("eta", "jesUp"));
+  EXPECT_EQ(systematicManager->getVariablesForSystematic("jesDown"),
+            (std::set<std::string>{"eta", "mass", "pt"}));
+}
+
+TEST_F(SystematicManagerTest, PruningClearsInternedLookups) {
+  systematicManager->registerSystematic("jes", {"pt"});
+  systematicManager->registerSystematic("tiny", {"pt", "weight"});
+  systematicManager->setPrunedSystematics({"tinyUp"});
+
+  EXPECT_FALSE(systematicManager->isVariableAffectedBySystematic("pt", "tiny"));
+  EXPECT_FALSE(systematicManager->isVariableAffectedBySystematic("weight", "tinyDown"));
+  EXPECT_TRUE(systematicManager->getVariablesForSystematic("tiny").empty());
+  EXPECT_TRUE(systematicManager->isVariableAffectedBySystematic("pt", "jesUp"));
+}
+
 int main(int argc, char **argv) {
   ::testing::InitGoogleTest(&argc, argv);
   return RUN_ALL_TESTS();
@@ -11,7 +11,7 @@
  *  - Per-event weight column definition (product of per-jet SFs).
  *  - addVariation / registerSystematicSources / applySystematicSet.
  *  - defineVariationCollections and PhysicsObjectVariationMap.
- *  - defineFractionHistograms input validation.
+ *  - defineFractionHistograms input validation and in-run filling.
  *  - defineUnfilteredCollection.
  *  - setupFromConfigFile / setRole / configuredCorrections.
  *  - registerWeightsWithWeightManager.
@@ -19,6 +19,7 @@
  */
 
 #include <ConfigurationManager.h>
+#include <CorrectionManager.h>
 #include <DataManager.h>
 #include <DefaultLogger.h>
 #include "../plugins/TaggerWorkingPointManager/TaggerWorkingPointManager.h"
@@ -29,6 +30,8 @@
 #include <SystematicManager.h>
 #include <api/ManagerContext.h>
 #include <gtest/gtest.h>
+#include <cstdio>
+#include <fstream>
 #include <stdexcept>
 #include <test_util.h>
 
@@ -586,6 +589,79 @@ TEST_F(TaggerWorkingPointManagerTest,
   EXPECT_FLOAT_EQ(result[0], 1.0f);
 }
 
+TEST_F(TaggerWorkingPointManagerTest, FixedWPSweepReusesReferenceForUnaffectedFlavours) {
+  // Jet 0: b jet in category 1 (pass L, fail M); jet 1: light jet in
+  // category 2 (pass M).  The "up" variation only changes b jets, so the
+  // light jet keeps its central SF instead of the payload's 2.0.
+  auto dm = std::make_unique<DataManager>(1);
+  auto mgr = makeMgr(*dm);
+  auto cm = std::make_unique<CorrectionManager>(*config);
+  auto ctx = makeContext(*config, *dm, *systematicManager, *logger,
+                         *skimSink, *metaSink);
+  cm->setContext(ctx);
+  cm->registerCorrection("btag_sf", "aux/btag_fixedwp.json", "btag_fixedwp",
+                         {"Jet_hadronFlavour", "Jet_pt"});
+
+  mgr->setObjectColumns("Jet_pt", "Jet_eta", "Jet_phi", "Jet_mass");
+  mgr->setTaggerColumn("Jet_btag");
+  mgr->addWorkingPoint("L", 0.20f);
+  mgr->addWorkingPoint("M", 0.50f);
+  mgr->setInputObjectCollection("goodJets");
+
+  dm->Define(
+      "goodJets",
+      [](ULong64_t) -> PhysicsObjectCollection {
+        ROOT::VecOps::RVec<Float_t> pt{50.f, 50.f};
+        ROOT::VecOps::RVec<Float_t> zero{0.f, 0.f};
+        ROOT::VecOps::RVec<bool> mask{true, true};
+        return PhysicsObjectCollection(pt, zero, zero, zero, mask);
+      },
+      {"rdfentry_"}, *systematicManager);
+  dm->Define("Jet_pt",
+             [](ULong64_t) -> ROOT::VecOps::RVec<Float_t> { return {50.f, 50.f}; },
+             {"rdfentry_"}, *systematicManager);
+  dm->Define("Jet_hadronFlavour",
+             [](ULong64_t) -> ROOT::VecOps::RVec<Int_t> { return {5, 0}; },
+             {"rdfentry_"}, *systematicManager);
+  dm->Define("Jet_btag",
+             [](ULong64_t) -> ROOT::VecOps::RVec<Float_t> { return {0.30f, 0.60f}; },
+             {"rdfentry_"}, *systematicManager);
+  dm->Define("eff_L",
+             [](ULong64_t) -> ROOT::VecOps::RVec<Float_t> { return {0.70f, 0.70f}; },
+             {"rdfentry_"}, *systematicManager);
+  dm->Define("eff_M",
+             [](ULong64_t) -> ROOT::VecOps::RVec<Float_t> { return {0.40f, 0.40f}; },
+             {"rdfentry_"}, *systematicManager);
+
+  mgr->defineFixedWorkingPointWeights(
+      *cm, "btag_sf",
+      {{"central", "btag_w", {}}, {"up", "btag_w_up", {5}}},
+      {"Jet_hadronFlavour", "Jet_pt"}, {"eff_L", "eff_M"},
+      "Jet_hadronFlavour");
+  mgr->execute();
+
+  auto nominal = dm->getDataFrame().Take<Float_t>("btag_w").GetValue();
+  auto up = dm->getDataFrame().Take<Float_t>("btag_w_up").GetValue();
+  ASSERT_EQ(nominal.size(), 1u);
+  ASSERT_EQ(up.size(), 1u);
+  const float bNominal = (1.05f * 0.70f - 0.95f * 0.40f) / (0.70f - 0.40f);
+  const float bUp = (1.10f * 0.70f - 1.00f * 0.40f) / (0.70f - 0.40f);
+  EXPECT_NEAR(nominal[0], bNominal * 0.95f, 1e-5f);
+  EXPECT_NEAR(up[0], bUp * 0.95f, 1e-5f);
+}
+
+TEST_F(TaggerWorkingPointManagerTest, FixedWPSweepReferenceMustCoverAllFlavours) {
+  auto dm = std::make_unique<DataManager>(1);
+  auto mgr = makeMgr(*dm);
+  auto cm = std::make_unique<CorrectionManager>(*config);
+  mgr->addWorkingPoint("L", 0.20f);
+  mgr->setInputObjectCollection("goodJets");
+  EXPECT_THROW(mgr->defineFixedWorkingPointWeights(
+                   *cm, "btag_sf", {{"up", "btag_w_up", {5}}},
+                   {"Jet_hadronFlavour", "Jet_pt"}, {"eff_L"}, "Jet_hadronFlavour"),
+               std::invalid_argument);
+}
+
 // ---------------------------------------------------------------------------
 // addVariation / registerSystematicSources
 // ---------------------------------------------------------------------------
@@ -779,6 +855,61 @@ TEST_F(TaggerWorkingPointManagerTest, FractionHistWithoutTaggerColumnThrows) {
                std::runtime_error);
 }
 
+TEST_F(TaggerWorkingPointManagerTest, FractionHistogramsFilledAlongsideAnalysis) {
+  // The maps are booked in the same run as a WP collection.  Jet 0 (pt 30,
+  // |eta| 0.5, b, score 0.4) lands in (pt0, eta0, b) with category 2; jet 1
+  // (pt 70, eta -2.0, light, score 0.01) in (pt1, eta1, light) with category 0.
+  auto dm = std::make_unique<DataManager>(1);
+  auto mgr = makeMgr(*dm);
+
+  mgr->setObjectColumns("Jet_pt", "Jet_eta", "Jet_phi", "Jet_mass");
+  mgr->setTaggerColumn("Jet_btag");
+  mgr->addWorkingPoint("loose",  0.05f);
+  mgr->addWorkingPoint("medium", 0.30f);
+  mgr->setInputObjectCollection("goodJets");
+
+  dm->Define(
+      "goodJets",
+      [](ULong64_t) -> PhysicsObjectCollection {
+        ROOT::VecOps::RVec<Float_t> pt{30.f, 70.f}, eta{0.5f, -2.0f},
+            phi{0.f, 0.f}, mass{0.f, 0.f};
+        ROOT::VecOps::RVec<bool> mask{true, true};
+        return PhysicsObjectCollection(pt, eta, phi, mass, mask);
+      },
+      {"rdfentry_"}, *systematicManager);
+  dm->Define(
+      "Jet_btag",
+      [](ULong64_t) -> ROOT::VecOps::RVec<Float_t> { return {0.4f, 0.01f}; },
+      {"rdfentry_"}, *systematicManager);
+  dm->Define(
+      "Jet_hadronFlavour",
+      [](ULong64_t) -> ROOT::VecOps::RVec<Int_t> { return {5, 0}; },
+      {"rdfentry_"}, *systematicManager);
+
+  mgr->defineFractionHistograms("frac", {20.f, 50.f, 100.f}, {0.f, 1.5f, 2.4f},
+                                "Jet_hadronFlavour");
+  mgr->defineWorkingPointCollection("pass_medium", "goodJets_bmedium");
+  mgr->execute();
+
+  auto df = dm->getDataFrame();
+  auto scoreB = df.Take<ROOT::VecOps::RVec<Float_t>>("_frac_score_frac_pt0_eta0_b");
+  auto scoreLight =
+      df.Take<ROOT::VecOps::RVec<Float_t>>("_frac_score_frac_pt1_eta1_light");
+  auto scoreEmpty =
+      df.Take<ROOT::VecOps::RVec<Float_t>>("_frac_score_frac_pt0_eta0_light");
+  auto catB = df.Take<ROOT::VecOps::RVec<Float_t>>("_frac_cat_frac_cat_pt0_eta0_b");
+  auto selected = df.Take<PhysicsObjectCollection>("goodJets_bmedium");
+
+  ASSERT_EQ(scoreB.GetValue()[0].size(), 1u);
+  EXPECT_FLOAT_EQ(scoreB.GetValue()[0][0], 0.4f);
+  ASSERT_EQ(scoreLight.GetValue()[0].size(), 1u);
+  EXPECT_FLOAT_EQ(scoreLight.GetValue()[0][0], 0.01f);
+  EXPECT_TRUE(scoreEmpty.GetValue()[0].empty());
+  ASSERT_EQ(catB.GetValue()[0].size(), 1u);
+  EXPECT_FLOAT_EQ(catB.GetValue()[0][0], 2.f);
+  EXPECT_EQ(selected.GetValue()[0].size(), 1u);
+}
+
 // ---------------------------------------------------------------------------
 // execute(): systematic registration
 // ---------------------------------------------------------------------------
@@ -955,6 +1086,54 @@ TEST_F(TaggerWorkingPointManagerTest, MultiScoreWPCategoryColumnPassAll) {
   EXPECT_EQ(cat[0][0], 2);
 }
 
+TEST_F(TaggerWorkingPointManagerTest, MultiScoreWPCategoryNonMonotonicThresholds) {
+  // CvsB thresholds {0.5, 0.3, 0.6} are not ascending: an object failing the
+  // first CvsB threshold stays in category 0 even if it passes a later one.
+  auto dm = std::make_unique<DataManager>(1);
+  auto mgr = makeMgr(*dm);
+
+  mgr->setObjectColumns("Jet_pt", "Jet_eta", "Jet_phi", "Jet_mass");
+  mgr->setTaggerColumns({"Jet_CvsL", "Jet_CvsB"});
+  mgr->addWorkingPoint("loose",  {0.1f, 0.5f});
+  mgr->addWorkingPoint("medium", {0.2f, 0.3f});
+  mgr->addWorkingPoint("tight",  {0.3f, 0.6f});
+
+  dm->Define("Jet_CvsL",
+             [](ULong64_t) -> ROOT::VecOps::RVec<Float_t> { return {0.35f, 0.25f}; },
+             {"rdfentry_"}, *systematicManager);
+  dm->Define("Jet_CvsB",
+             [](ULong64_t) -> ROOT::VecOps::RVec<Float_t> { return {0.40f, 0.55f}; },
+             {"rdfentry_"}, *systematicManager);
+
+  mgr->execute();
+
+  auto cat = dm->getDataFrame()
+                  .Take<ROOT::VecOps::RVec<Int_t>>("Jet_pt_wp_category")
+                  .GetValue();
+  ASSERT_EQ(cat.size(), 1u);
+  ASSERT_EQ(cat[0].size(), 2u);
+  EXPECT_EQ(cat[0][0], 0);
+  EXPECT_EQ(cat[0][1], 2);
+}
+
+TEST_F(TaggerWorkingPointManagerTest, MultiScoreWPMissingThresholdThrows) {
+  auto dm = std::make_unique<DataManager>(1);
+  auto mgr = makeMgr(*dm);
+
+  mgr->setObjectColumns("Jet_pt", "Jet_eta", "Jet_phi", "Jet_mass");
+  mgr->setTaggerColumns({"Jet_CvsL", "Jet_CvsB"});
+  mgr->addWorkingPoint("loose", 0.042f);
+
+  dm->Define("Jet_CvsL",
+             [](ULong64_t) -> ROOT::VecOps::RVec<Float_t> { return {0.06f}; },
+             {"rdfentry_"}, *systematicManager);
+  dm->Define("Jet_CvsB",
+             [](ULong64_t) -> ROOT::VecOps::RVec<Float_t> { return {0.20f}; },
+             {"rdfentry_"}, *systematicManager);
+
+  EXPECT_THROW(mgr->execute(), std::runtime_error);
+}
+
 TEST_F(TaggerWorkingPointManagerTest, MultiScoreWPCollectionFilter) {
   // Jet with CvsL=0.06, CvsB=0.20 → passes loose, fails medium.
   // defineWorkingPointCollection("pass_loose") should include it.
@@ -1056,6 +1235,46 @@ TEST_F(TaggerWorkingPointManagerTest, ConfiguredCorrectionsEmptyByDefault) {
   EXPECT_TRUE(mgr.getConfiguredCorrections().empty());
 }
 
+TEST_F(TaggerWorkingPointManagerTest, InvalidFractionEdgeNamesTheKey) {
+  const std::string path = "cfg/tagger_invalid_edges.txt";
+  {
+    std::ofstream out(path);
+    out << "type=fraction_histograms outputPrefix=frac ptBinEdges=20,3O,50 "
+           "etaBinEdges=0,2.4\n";
+  }
+  config->set("taggerConfig", path);
+  auto dm = std::make_unique<DataManager>(1);
+  try {
+    makeMgr(*dm);
+    ADD_FAILURE() << "the invalid edge was accepted";
+  } catch (const std::invalid_argument &e) {
+    EXPECT_NE(std::string(e.what()).find("ptBinEdges"), std::string::npos) << e.what();
+    EXPECT_NE(std::string(e.what()).find("3O"), std::string::npos) << e.what();
+  }
+  std::remove(path.c_str());
+}
+
+TEST_F(TaggerWorkingPointManagerTest, FractionCorrectionWaitsForTaggerMapDir) {
+  const std::string path = "cfg/tagger_fraction_correction.txt";
+  {
+    std::ofstream out(path);
+    out << "type=fraction_correction outputPrefix=frac "
+           "inputColumns=Jet_pt,Jet_eta,Jet_pt_wp_category\n";
+  }
+  config->set("taggerConfig", path);
+  auto dm = std::make_unique<DataManager>(1);
+  auto mgr = makeMgr(*dm);
+  std::remove(path.c_str());
+
+  // Without maps of an earlier run, nothing is registered.
+  EXPECT_EQ(mgr->efficiencyMapFile("frac"), "");
+  CorrectionManager cm(*config);
+  EXPECT_NO_THROW(mgr->applyConfiguredCorrections(cm));
+
+  config->set("taggerMapDir", "maps");
+  EXPECT_EQ(mgr->efficiencyMapFile("frac"), "maps/frac.json");
+}
+
 // ---------------------------------------------------------------------------
 // Feature: WeightManager integration
 // ---------------------------------------------------------------------------
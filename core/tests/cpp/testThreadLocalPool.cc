@@ -0,0 +1,47 @@
+/**
+ * @file testThreadLocalPool.cc
+ * @brief Unit tests for ThreadLocalPool – one object per thread and per pool.
+ */
+
+#include <gtest/gtest.h>
+
+#include <ThreadLocalPool.h>
+
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+TEST(ThreadLocalPoolTest, ReturnsOneObjectPerThread) {
+  ThreadLocalPool<int> pool;
+  int created = 0;
+  auto make = [&created]() { return std::make_unique<int>(++created); };
+
+  int &first = pool.local(make);
+  EXPECT_EQ(&pool.local(make), &first);
+
+  int *other = nullptr;
+  std::thread thread([&]() { other = &pool.local(make); });
+  thread.join();
+
+  EXPECT_NE(other, &first);
+  EXPECT_EQ(created, 2);
+  EXPECT_EQ(pool.size(), 2u);
+}
+
+TEST(ThreadLocalPoolTest, PoolsOfTheSameTypeDoNotShareObjects) {
+  auto make = []() { return std::make_unique<int>(0); };
+  ThreadLocalPool<int> a;
+  ThreadLocalPool<int> b;
+  a.local(make) = 1;
+  b.local(make) = 2;
+  EXPECT_EQ(a.local(make), 1);
+  EXPECT_EQ(b.local(make), 2);
+}
+
+TEST(ThreadLocalPoolTest, RetriesAfterAFailedCreation) {
+  ThreadLocalPool<int> pool;
+  EXPECT_THROW(pool.local([]() -> std::unique_ptr<int> { throw std::runtime_error("no"); }),
+               std::runtime_error);
+  EXPECT_EQ(pool.local([]() { return std::make_unique<int>(3); }), 3);
+}
@@ -0,0 +1,85 @@
+/**
+ * @file testThreadPinning.cc
+ * @brief Unit tests for ThreadPinning.
+ *
+ * Covers:
+ *  - Parsing of kernel CPU lists.
+ *  - Node-major mapping of slots to CPUs.
+ *  - pinSlot() only acting on the active instance.
+ *  - unpin() restoring the affinity mask.
+ */
+
+#include <ThreadPinning.h>
+#include <gtest/gtest.h>
+
+#include <sched.h>
+#include <stdexcept>
+#include <thread>
+
+TEST(ThreadPinningTest, ParsesCpuLists) {
+    EXPECT_EQ(ThreadPinning::parseCpuList("0-3,8,10-11\n"),
+              (std::vector<int>{0, 1, 2, 3, 8, 10, 11}));
+    EXPECT_TRUE(ThreadPinning::parseCpuList("").empty());
+    EXPECT_THROW(ThreadPinning::parseCpuList("0-x"), std::runtime_error);
+}
+
+TEST(ThreadPinningTest, SlotsFillOneNodeBeforeTheNext) {
+    ThreadPinning pinning({{0, {0, 1}}, {1, {4, 5}}});
+    EXPECT_EQ(pinning.cpuOfSlot(0), 0);
+    EXPECT_EQ(pinning.cpuOfSlot(1), 1);
+    EXPECT_EQ(pinning.cpuOfSlot(2), 4);
+    EXPECT_EQ(pinning.nodeOfSlot(1), 0);
+    EXPECT_EQ(pinning.nodeOfSlot(3), 1);
+    // More slots than CPUs wrap around.
+    EXPECT_EQ(pinning.cpuOfSlot(5), 1);
+    EXPECT_THROW(ThreadPinning({{0, {}}}), std::runtime_error);
+}
+
+TEST(ThreadPinningTest, TopologyCoversAllowedCpus) {
+    const auto topology = ThreadPinning::readTopology();
+    ASSERT_FALSE(topology.empty());
+    for (const auto &node : topology) {
+        EXPECT_FALSE(node.cpus.empty());
+    }
+}
+
+TEST(ThreadPinningTest, PinSlotUsesActiveInstance) {
+    ThreadPinning pinning(ThreadPinning::readTopology());
+    std::thread([&] { ThreadPinning::pinSlot(0); }).join();
+    EXPECT_EQ(pinning.pinnedThreads(), 0u);
+
+    ThreadPinning::activate(&pinning);
+    int cpu = -1;
+    std::thread([&] {
+        ThreadPinning::pinSlot(0);
+        ThreadPinning::pinSlot(0);
+        cpu = sched_getcpu();
+    }).join();
+    EXPECT_EQ(pinning.pinnedThreads(), 1u);
+    EXPECT_EQ(cpu, pinning.cpuOfSlot(0));
+    ThreadPinning::activate(nullptr);
+}
+
+TEST(ThreadPinningTest, UnpinRestoresTheOriginalMask) {
+    cpu_set_t original;
+    CPU_ZERO(&original);
+    ASSERT_EQ(sched_getaffinity(0, sizeof(original), &original), 0);
+    ThreadPinning pinning(ThreadPinning::readTopology());
+    ThreadPinning::activate(&pinning);
+    int pinnedCpus = 0;
+    bool restored = false;
+    std::thread([&] {
+        ThreadPinning::pinSlot(0);
+        cpu_set_t mask;
+        CPU_ZERO(&mask);
+        sched_getaffinity(0, sizeof(mask), &mask);
+        pinnedCpus = CPU_COUNT(&mask);
+        pinning.unpin();
+        CPU_ZERO(&mask);
+        sched_getaffinity(0, sizeof(mask), &mask);
+        restored = CPU_EQUAL(&mask, &original);
+    }).join();
+    ThreadPinning::activate(nullptr);
+    EXPECT_EQ(pinnedCpus, 1);
+    EXPECT_TRUE(restored);
+}
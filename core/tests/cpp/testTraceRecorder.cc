@@ -0,0 +1,179 @@
+/**
+ * @file testTraceRecorder.cc
+ * @brief Unit tests for TraceRecorder and TraceService – spans, tracks and
+ *        the Chrome trace export of the job timeline.
+ */
+
+#include <gtest/gtest.h>
+
+#include <ConfigurationManager.h>
+#include <DataManager.h>
+#include <DefaultLogger.h>
+#include <NullOutputSink.h>
+#include <SystematicManager.h>
+#include <TraceRecorder.h>
+#include <TraceService.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+namespace {
+
+std::string readFile(const std::string &path) {
+  std::ifstream in(path);
+  std::stringstream content;
+  content << in.rdbuf();
+  return content.str();
+}
+
+std::size_t countOf(const std::string &text, const std::string &needle) {
+  std::size_t count = 0;
+  for (auto pos = text.find(needle); pos != std::string::npos;
+       pos = text.find(needle, pos + needle.size())) {
+    ++count;
+  }
+  return count;
+}
+
+} // namespace
+
+TEST(TraceRecorderTest, DisabledRecorderRecordsNothing) {
+  TraceRecorder recorder;
+  { TraceRecorder::Span span("phase", "config", recorder); }
+  recorder.record("setup", "plugin", TraceRecorder::Clock::now(), TraceRecorder::Clock::now());
+  EXPECT_TRUE(recorder.events().empty());
+}
+
+TEST(TraceRecorderTest, SpansGetOneTrackPerThread) {
+  TraceRecorder recorder;
+  recorder.enable();
+  { TraceRecorder::Span span("phase", "config", recorder); }
+  std::thread worker([&recorder] { TraceRecorder::Span span("plugin", "setup", recorder); });
+  worker.join();
+  const auto now = TraceRecorder::Clock::now();
+  recorder.recordSlot(3, "task", "task", now, now, {{"entries", "10"}});
+
+  const auto events = recorder.events();
+  ASSERT_EQ(events.size(), 3u);
+  EXPECT_EQ(events[0].name, "config");
+  EXPECT_EQ(recorder.trackName(events[0].track), "main");
+  EXPECT_NE(events[1].track, events[0].track);
+  EXPECT_EQ(recorder.trackName(events[1].track), "thread 1");
+  EXPECT_EQ(recorder.trackName(events[2].track), "slot 3");
+  EXPECT_LE(events[0].begin, events[0].end);
+
+  recorder.clear();
+  EXPECT_TRUE(recorder.events().empty());
+}
+
+TEST(TraceRecorderTest, WritesChromeTraceJson) {
+  const std::string path = std::string(TEST_SOURCE_DIR) + "/aux/trace_test_recorder.json";
+  TraceRecorder recorder;
+  recorder.enable();
+  const auto begin = TraceRecorder::Clock::now();
+  recorder.record("plugin \"a\".setup", "plugin", begin, begin + std::chrono::milliseconds(2));
+  recorder.recordSlot(0, "task", "task", begin, begin + std::chrono::milliseconds(1),
+                      {{"input", "file.root/Events"}});
+  recorder.writeChromeTrace(path);
+
+  const std::string json = readFile(path);
+  std::remove(path.c_str());
+  EXPECT_EQ(json.rfind("{\n  \"displayTimeUnit\": \"ms\",\n  \"traceEvents\": [", 0), 0u);
+  EXPECT_EQ(countOf(json, "\"ph\": \"X\""), 2u);
+  EXPECT_NE(json.find("\"name\": \"plugin \\\"a\\\".setup\""), std::string::npos) << json;
+  EXPECT_NE(json.find("\"dur\": 2000.000"), std::string::npos) << json;
+  EXPECT_NE(json.find("\"args\": {\"name\": \"main\"}"), std::string::npos);
+  EXPECT_NE(json.find("\"args\": {\"name\": \"slot 0\"}"), std::string::npos);
+  EXPECT_NE(json.find("\"args\": {\"input\": \"file.root/Events\"}"), std::string::npos);
+  EXPECT_EQ(json.substr(json.size() - 5), "\n  ]\n}\n");
+}
+
+class TraceServiceTest : public ::testing::Test {
+protected:
+  std::string cfgPath;
+  std::string tracePath;
+
+  void SetUp() override {
+    const std::string base = std::string(TEST_SOURCE_DIR) + "/aux/trace_test_";
+    cfgPath = base + "config.txt";
+    tracePath = base + "trace.json";
+    cleanup();
+    TraceRecorder::instance().clear();
+  }
+  void TearDown() override {
+    cleanup();
+    TraceRecorder::instance().disable();
+    TraceRecorder::instance().clear();
+  }
+  void cleanup() {
+    std::remove(cfgPath.c_str());
+    std::remove(tracePath.c_str());
+  }
+};
+
+TEST_F(TraceServiceTest, RecordsJitLoopAndTasks) {
+  {
+    std::ofstream out(cfgPath);
+    out << "sample=TraceTest\nfileList=\ntraceFile=" << tracePath << "\n";
+  }
+  ConfigurationManager config(cfgPath);
+  DataManager dataManager(1000);
+  SystematicManager systematicManager;
+  DefaultLogger logger;
+  NullOutputSink skimSink;
+  NullOutputSink metaSink;
+  ManagerContext ctx{config, dataManager, systematicManager, logger, skimSink, metaSink};
+
+  TraceService svc;
+  svc.initialize(ctx);
+  EXPECT_TRUE(TraceRecorder::instance().enabled());
+  auto df = dataManager.getDataFrame();
+  auto count = df.Filter([](ULong64_t entry) { return entry < 10; }, {"rdfentry_"}).Count();
+  svc.markEventLoopTrigger();
+  EXPECT_EQ(count.GetValue(), 10u);
+  svc.finalize(df);
+  svc.write();
+
+  const auto events = TraceRecorder::instance().events();
+  const auto has = [&events](const std::string &name) {
+    return std::any_of(events.begin(), events.end(),
+                       [&name](const TraceRecorder::Event &e) { return e.name == name; });
+  };
+  EXPECT_TRUE(has("jit"));
+  EXPECT_TRUE(has("event_loop"));
+  std::uint64_t taskEntries = 0;
+  for (const auto &event : events) {
+    if (event.name == "task") {
+      EXPECT_GE(event.track, TraceRecorder::kSlotTrackBase);
+      taskEntries += std::stoull(event.args.at(0).second);
+    }
+  }
+  // The tasks cover every entry, not only those passing the filter.
+  EXPECT_EQ(taskEntries, 1000u);
+
+  const std::string json = readFile(tracePath);
+  EXPECT_NE(json.find("\"cat\": \"task\""), std::string::npos) << json;
+  EXPECT_EQ(svc.collectProvenanceEntries().at("service.trace.file"), tracePath);
+}
+
+TEST_F(TraceServiceTest, MissingTraceFileThrows) {
+  {
+    std::ofstream out(cfgPath);
+    out << "sample=TraceTest\nfileList=\n";
+  }
+  ConfigurationManager config(cfgPath);
+  DataManager dataManager(10);
+  SystematicManager systematicManager;
+  DefaultLogger logger;
+  NullOutputSink skimSink;
+  NullOutputSink metaSink;
+  ManagerContext ctx{config, dataManager, systematicManager, logger, skimSink, metaSink};
+
+  TraceService svc;
+  EXPECT_THROW(svc.initialize(ctx), std::runtime_error);
+}
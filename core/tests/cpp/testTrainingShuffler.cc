@@ -0,0 +1,205 @@
+/**
+ * @file testTrainingShuffler.cc
+ * @brief Unit tests for TrainingShuffler – the per-slot shuffle buffer and
+ *        class down-sampling of the training output.
+ */
+
+#include <gtest/gtest.h>
+
+#include <ConfigurationManager.h>
+#include <TrainingShuffler.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+/// Chunk of @p rows rows of slot @p slot: "x" counts from @p first, "label"
+/// is x % 3 and "w" is x / 2.
+ColumnChunker::Chunk makeChunk(unsigned int slot, int first, std::size_t rows) {
+  ColumnChunker::Chunk chunk;
+  chunk.columns = {"x", "label", "w"};
+  chunk.dtypes = {"int32", "int32", "float32"};
+  chunk.offsets.assign(3, {});
+  std::vector<std::int32_t> x, label;
+  std::vector<float> w;
+  for (std::size_t i = 0; i < rows; ++i) {
+    const int value = first + static_cast<int>(i);
+    x.push_back(value);
+    label.push_back(value % 3);
+    w.push_back(value / 2.f);
+  }
+  chunk.data = {x, label, w};
+  chunk.rows = rows;
+  chunk.slot = slot;
+  return chunk;
+}
+
+TrainingSettings makeSettings(std::size_t chunkRows, std::size_t shuffleRows) {
+  TrainingSettings settings;
+  settings.labelColumn = "label";
+  settings.chunkRows = chunkRows;
+  settings.shuffleRows = shuffleRows;
+  return settings;
+}
+
+/// Rows of the emitted chunks as (x, label, w) tuples, checking the sizes.
+struct Collected {
+  std::vector<ColumnChunker::Chunk> chunks;
+
+  std::vector<int> xs() const {
+    std::vector<int> all;
+    for (const auto &chunk : chunks) {
+      const auto &x = std::get<std::vector<std::int32_t>>(chunk.data[0]);
+      const auto &label = std::get<std::vector<std::int32_t>>(chunk.data[1]);
+      const auto &w = std::get<std::vector<float>>(chunk.data[2]);
+      EXPECT_EQ(x.size(), chunk.rows);
+      for (std::size_t i = 0; i < chunk.rows; ++i) {
+        // Columns stay aligned through the shuffle.
+        EXPECT_EQ(label[i], x[i] % 3);
+        EXPECT_FLOAT_EQ(w[i], x[i] / 2.f);
+        all.push_back(x[i]);
+      }
+    }
+    return all;
+  }
+};
+
+} // namespace
+
+TEST(TrainingShufflerTest, EmitsEveryRowOnceInShuffledChunks) {
+  Collected out;
+  TrainingShuffler shuffler(makeSettings(16, 40), 2,
+                            [&out](ColumnChunker::Chunk &&chunk) { out.chunks.push_back(std::move(chunk)); });
+  for (int c = 0; c < 10; ++c) {
+    shuffler.add(makeChunk(c % 2, c * 25, 25));
+  }
+  // Only rows evicted from the full buffers are emitted before drain().
+  for (const auto &chunk : out.chunks) {
+    EXPECT_EQ(chunk.rows, 16u);
+  }
+  shuffler.drain();
+
+  const auto xs = out.xs();
+  ASSERT_EQ(xs.size(), 250u);
+  EXPECT_EQ(std::set<int>(xs.begin(), xs.end()).size(), 250u);
+  EXPECT_FALSE(std::is_sorted(xs.begin(), xs.end()));
+  std::map<unsigned int, std::size_t> partial;
+  for (const auto &chunk : out.chunks) {
+    EXPECT_LE(chunk.rows, 16u);
+    EXPECT_TRUE(chunk.offsets[0].empty());
+    partial[chunk.slot] += chunk.rows < 16u;
+  }
+  // At most the last chunk of each slot is partial.
+  EXPECT_LE(partial[0], 1u);
+  EXPECT_LE(partial[1], 1u);
+}
+
+TEST(TrainingShufflerTest, SplitsTheBufferBetweenSlots) {
+  Collected out;
+  TrainingShuffler shuffler(makeSettings(5, 20), 2,
+                            [&out](ColumnChunker::Chunk &&chunk) { out.chunks.push_back(std::move(chunk)); });
+  shuffler.add(makeChunk(0, 0, 15));
+  shuffler.add(makeChunk(1, 15, 15));
+  // Each slot buffers 10 rows, so 5 rows of each are evicted before drain().
+  ASSERT_EQ(out.chunks.size(), 2u);
+  EXPECT_EQ(out.chunks[0].rows, 5u);
+  EXPECT_EQ(out.chunks[1].rows, 5u);
+  shuffler.drain();
+  EXPECT_EQ(out.xs().size(), 30u);
+}
+
+TEST(TrainingShufflerTest, DownSamplesClasses) {
+  auto settings = makeSettings(64, 128);
+  settings.classFractions = {{0, 0.0}, {1, 0.25}};
+  Collected out;
+  TrainingShuffler shuffler(settings, 1,
+                            [&out](ColumnChunker::Chunk &&chunk) { out.chunks.push_back(std::move(chunk)); });
+  for (int c = 0; c < 30; ++c) {
+    shuffler.add(makeChunk(0, c * 100, 100));
+  }
+  shuffler.drain();
+
+  std::map<int, std::size_t> perClass;
+  for (const int x : out.xs()) {
+    ++perClass[x % 3];
+  }
+  const auto counts = shuffler.classCounts();
+  EXPECT_EQ(counts.at(0).seen, 1000u);
+  EXPECT_EQ(counts.at(0).kept, 0u);
+  EXPECT_EQ(perClass.count(0), 0u);
+  EXPECT_EQ(counts.at(1).kept, perClass[1]);
+  EXPECT_NEAR(static_cast<double>(perClass[1]), 250.0, 60.0);
+  EXPECT_EQ(counts.at(2).kept, 1000u);
+  EXPECT_EQ(perClass[2], 1000u);
+}
+
+TEST(TrainingShufflerTest, SameSeedSameOrder) {
+  const auto run = [](std::uint64_t seed) {
+    auto settings = makeSettings(8, 20);
+    settings.seed = seed;
+    Collected out;
+    TrainingShuffler shuffler(settings, 1,
+                              [&out](ColumnChunker::Chunk &&chunk) { out.chunks.push_back(std::move(chunk)); });
+    for (int c = 0; c < 5; ++c) {
+      shuffler.add(makeChunk(0, c * 10, 10));
+    }
+    shuffler.drain();
+    return out.xs();
+  };
+  EXPECT_EQ(run(7), run(7));
+  EXPECT_NE(run(7), run(8));
+}
+
+TEST(TrainingShufflerTest, RejectsInvalidInput) {
+  EXPECT_THROW(TrainingShuffler(makeSettings(0, 4), 1, {}), std::invalid_argument);
+  auto settings = makeSettings(4, 4);
+  settings.classFractions = {{1, 1.5}};
+  EXPECT_THROW(TrainingShuffler(settings, 1, {}), std::invalid_argument);
+
+  TrainingShuffler shuffler(makeSettings(4, 4), 1, [](ColumnChunker::Chunk &&) {});
+  auto noLabel = makeChunk(0, 0, 3);
+  noLabel.columns[1] = "other";
+  EXPECT_THROW(shuffler.add(std::move(noLabel)), std::runtime_error);
+
+  TrainingShuffler vectors(makeSettings(4, 4), 1, [](ColumnChunker::Chunk &&) {});
+  auto withOffsets = makeChunk(0, 0, 3);
+  withOffsets.offsets[2] = {0, 1, 2, 3};
+  EXPECT_THROW(vectors.add(std::move(withOffsets)), std::runtime_error);
+}
+
+TEST(TrainingShufflerTest, SettingsFromConfig) {
+  const std::string path = "test_training_shuffler.cfg";
+  {
+    std::ofstream cfg(path);
+    cfg << "trainingLabelColumn=isSignal\n"
+        << "trainingWeightColumn=weight\n"
+        << "trainingShuffleRows=1000\n"
+        << "trainingClassFractions=0:0.2, 1:1\n"
+        << "trainingSeed=42\n";
+  }
+  ConfigurationManager config(path);
+  const auto settings = TrainingSettings::fromConfig(config, 128);
+  EXPECT_EQ(settings.labelColumn, "isSignal");
+  EXPECT_EQ(settings.weightColumn, "weight");
+  EXPECT_EQ(settings.chunkRows, 128u);
+  EXPECT_EQ(settings.shuffleRows, 1000u);
+  EXPECT_EQ(settings.classFractions, (std::map<std::int64_t, double>{{0, 0.2}, {1, 1.0}}));
+  EXPECT_EQ(settings.seed, 42u);
+
+  config.set("trainingClassFractions", "0:2");
+  EXPECT_THROW(TrainingSettings::fromConfig(config, 128), std::runtime_error);
+  config.set("trainingClassFractions", "");
+  config.set("trainingShuffleRows", "0");
+  EXPECT_THROW(TrainingSettings::fromConfig(config, 128), std::runtime_error);
+  config.set("trainingShuffleRows", "");
+  config.set("trainingLabelColumn", "");
+  EXPECT_THROW(TrainingSettings::fromConfig(config, 128), std::runtime_error);
+  std::remove(path.c_str());
+}
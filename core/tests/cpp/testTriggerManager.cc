@@ -165,4 +165,92 @@ TEST_F(TriggerManagerTest, ExecuteAndFinalizeAreNoOps) {
 
 TEST_F(TriggerManagerTest, GetDependenciesReturnsEmpty) {
   EXPECT_TRUE(triggerManager->getDependencies().empty());
-}
\ No newline at end of file
+}
+// ---------------------------------------------------------------------------
+// Trigger-object matching
+// ---------------------------------------------------------------------------
+
+using ROOT::VecOps::RVec;
+
+TEST(TriggerMatchTest, KernelMatchesByDeltaRTypeAndFilterBits) {
+  // Offline muons; the second sits next to phi = +-pi.
+  const RVec<Float_t> eta = {0.5f, -1.0f, 2.0f};
+  const RVec<Float_t> phi = {1.0f, 3.12f, -2.0f};
+  // Trigger objects: a muon near muon 0 (bits 0b011), an electron on top of
+  // muon 2, and a muon across the phi boundary from muon 1 (bits 0b100).
+  const RVec<Float_t> trigEta = {0.52f, 2.0f, -1.02f};
+  const RVec<Float_t> trigPhi = {1.03f, -2.0f, -3.13f};
+  const RVec<Int_t> trigId = {13, 11, 13};
+  const RVec<Int_t> trigBits = {0b011, 0b111, 0b100};
+  // Path 0 needs bit 0, path 1 bits 0 and 1, path 2 bit 2.
+  const std::vector<std::uint64_t> required = {0b001, 0b011, 0b100};
+
+  const auto masks = TriggerManager::matchTriggerObjects(
+      eta, phi, trigEta, trigPhi, trigId, trigBits, 13, required, 0.1f);
+  ASSERT_EQ(masks.size(), 3u);
+  EXPECT_EQ(masks[0], 0b011u);
+  EXPECT_EQ(masks[1], 0b100u);
+  EXPECT_EQ(masks[2], 0u);
+
+  const auto tight = TriggerManager::matchTriggerObjects(
+      eta, phi, trigEta, trigPhi, trigId, trigBits, 13, required, 0.01f);
+  EXPECT_EQ(tight[0], 0u);
+  EXPECT_THROW(TriggerManager::matchTriggerObjects(eta, RVec<Float_t>{1.f}, trigEta,
+                                                   trigPhi, trigId, trigBits, 13,
+                                                   required, 0.1f),
+               std::runtime_error);
+}
+
+TEST_F(TriggerManagerTest, DefineTriggerMatchFlagsNeedsContext) {
+  EXPECT_THROW(triggerManager->defineTriggerMatchFlags("Muon_trigMatch", "HLT_IsoMu24",
+                                                       "Muon_matchedIsoMu24"),
+               std::runtime_error);
+}
+
+TEST_F(TriggerManagerTest, DefineTriggerMatchDefinesMasksAndFlags) {
+  auto dataManager = std::make_unique<DataManager>(1);
+  auto systematicManager = std::make_unique<SystematicManager>();
+  auto logger = std::make_unique<DefaultLogger>();
+  auto skimSink = std::make_unique<NullOutputSink>();
+  auto metaSink = std::make_unique<NullOutputSink>();
+  ManagerContext ctx{*configManager, *dataManager, *systematicManager,
+                     *logger, *skimSink, *metaSink};
+  triggerManager->setContext(ctx);
+
+  dataManager->Define("Muon_eta", [] { return RVec<Float_t>{0.5f, -1.0f}; }, {},
+                      *systematicManager);
+  dataManager->Define("Muon_phi", [] { return RVec<Float_t>{1.0f, 0.0f}; }, {},
+                      *systematicManager);
+  dataManager->Define("TrigObj_eta", [] { return RVec<Float_t>{0.5f}; }, {},
+                      *systematicManager);
+  dataManager->Define("TrigObj_phi", [] { return RVec<Float_t>{1.0f}; }, {},
+                      *systematicManager);
+  dataManager->Define("TrigObj_id", [] { return RVec<Int_t>{13}; }, {},
+                      *systematicManager);
+  dataManager->Define("TrigObj_filterBits", [] { return RVec<Int_t>{0b10}; }, {},
+                      *systematicManager);
+
+  TriggerMatchSpec spec;
+  spec.name = "Muon_trigMatch";
+  spec.etaColumn = "Muon_eta";
+  spec.phiColumn = "Muon_phi";
+  spec.triggerObjectId = 13;
+  spec.paths = {{"HLT_IsoMu24", 0b10}, {"HLT_Mu50", 0b01}};
+  EXPECT_EQ(triggerManager->defineTriggerMatch(spec), "Muon_trigMatch");
+  EXPECT_THROW(triggerManager->defineTriggerMatch(spec), std::runtime_error);
+  EXPECT_EQ(triggerManager->getTriggerMatchBit("Muon_trigMatch", "HLT_Mu50"), 1u);
+  EXPECT_THROW(triggerManager->getTriggerMatchBit("Muon_trigMatch", "HLT_Mu8"),
+               std::runtime_error);
+  triggerManager->defineTriggerMatchFlags("Muon_trigMatch", "HLT_IsoMu24",
+                                          "Muon_matchedIsoMu24");
+
+  auto df = dataManager->getDataFrame();
+  auto masks = df.Take<RVec<std::uint64_t>>("Muon_trigMatch");
+  auto flags = df.Take<RVec<bool>>("Muon_matchedIsoMu24");
+  ASSERT_EQ(masks->size(), 1u);
+  ASSERT_EQ(masks->at(0).size(), 2u);
+  EXPECT_EQ(masks->at(0)[0], 0b01u);
+  EXPECT_EQ(masks->at(0)[1], 0u);
+  EXPECT_TRUE(flags->at(0)[0]);
+  EXPECT_FALSE(flags->at(0)[1]);
+}
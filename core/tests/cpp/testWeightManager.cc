@@ -7,7 +7,11 @@
  * lifecycle hooks, and error handling.
  */
 
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
 #include <ConfigurationManager.h>
+#include <analyzer.h>
 #include <DataManager.h>
 #include <DefaultLogger.h>
 #include <ManagerFactory.h>
@@ -17,6 +21,7 @@
 #include <api/ManagerContext.h>
 #include <gtest/gtest.h>
 #include <stdexcept>
+#include <string>
 #include <test_util.h>
 
 // ---------------------------------------------------------------------------
@@ -143,6 +148,68 @@ TEST_F(WeightManagerTest, MultipleNormalizationFactorsAreMultiplied) {
   EXPECT_DOUBLE_EQ(mgr.getTotalNormalization(), 3.0 * 0.5 * 0.8);
 }
 
+TEST_F(WeightManagerTest, DeferredNormalizationIsDividedByTheSumOfWeights) {
+  WeightManager mgr;
+  mgr.addNormalization("filter", 0.8);
+  EXPECT_FALSE(mgr.hasDeferredNormalization());
+  mgr.addDeferredNormalization("xsec", 2.0);
+  mgr.addDeferredNormalization("lumi", 50.0);
+  EXPECT_TRUE(mgr.hasDeferredNormalization());
+  // The weights keep only the immediate normalizations.
+  EXPECT_DOUBLE_EQ(mgr.getTotalNormalization(), 0.8);
+  EXPECT_DOUBLE_EQ(mgr.getDeferredNormalization(), 1.0);
+
+  EXPECT_DOUBLE_EQ(mgr.resolveDeferredNormalization(400.0), 0.25);
+  EXPECT_DOUBLE_EQ(mgr.getDeferredNormalization(), 0.25);
+  const auto entries = mgr.collectProvenanceEntries();
+  EXPECT_EQ(entries.at("deferred_normalizations"), "xsec:2,lumi:50");
+  EXPECT_EQ(entries.count("deferred_normalization_factor"), 1u);
+
+  EXPECT_THROW(mgr.resolveDeferredNormalization(0.0), std::runtime_error);
+  EXPECT_THROW(mgr.addDeferredNormalization("", 1.0), std::invalid_argument);
+}
+
+// Merged outputs are sums, so two jobs that each normalize to their own half
+// of a sample would both be normalized wrongly: the Analyzer must refuse
+// them before the event loop and resolve the factor only for a whole sample.
+TEST_F(WeightManagerTest, DeferredNormalizationNeedsTheWholeSample) {
+  const std::string cfgPath = std::string(TEST_SOURCE_DIR) + "/aux/deferred_norm_cfg.txt";
+  const std::string metaPath = std::string(TEST_SOURCE_DIR) + "/aux/deferred_norm_meta.root";
+  const auto runJob = [&](const std::string &split) {
+    {
+      std::ofstream out(cfgPath);
+      out << "fileList=test_data/dummy.root\n";
+      out << "enableCounters=true\n";
+      out << "counterWeightBranch=genWeight\n";
+      out << "sample=TestSample\n";
+      out << "metaFile=" << metaPath << "\n";
+      out << "threads=1\n";
+      out << split;
+    }
+    Analyzer analyzer(cfgPath);
+    analyzer.Define("genWeight", [](Int_t dummy) { return 2.0f * dummy; }, {"dummy"});
+    auto mgr = WeightManager::create(analyzer);
+    mgr->addDeferredNormalization("xsec", 8.0);
+    analyzer.run();
+    return mgr->getDeferredNormalization();
+  };
+
+  // test_data/dummy.root holds two entries; each partial job reads one.
+  EXPECT_THROW(runJob("firstEntry=0\nlastEntry=1\n"), std::runtime_error);
+  EXPECT_THROW(runJob("firstEntry=1\nlastEntry=2\n"), std::runtime_error);
+  // The same two files split by the law planner.
+  EXPECT_THROW(runJob("sampleJobs=2\n"), std::runtime_error);
+  EXPECT_THROW(runJob("enableSkim=true\nsaveFile=aux/deferred_norm_skim.root\n"),
+               std::runtime_error);
+
+  // Sum of weights 2 + 2 over the whole sample.
+  EXPECT_DOUBLE_EQ(runJob(""), 2.0);
+
+  std::remove(cfgPath.c_str());
+  std::remove(metaPath.c_str());
+  std::remove("aux/deferred_norm_skim.root");
+}
+
 TEST_F(WeightManagerTest, AddNormalizationWithEmptyNameThrows) {
   WeightManager mgr;
   EXPECT_THROW(mgr.addNormalization("", 1.0), std::invalid_argument);
@@ -411,6 +478,46 @@ TEST_F(WeightManagerTest, GetWeightColumnAfterDefineVariedWeight) {
   EXPECT_EQ(mgr->getWeightColumn("sf1", "down"), "w_sf1_down");
 }
 
+TEST_F(WeightManagerTest, WeightVectorScalesNominalAndPadsMissingEntries) {
+  // 2 events; nominal = 2.0; factors = [0.5, 1.5] and [] (no PDF weights).
+  auto dm = std::make_unique<DataManager>(2);
+  auto mgr = makeMgr(*dm);
+
+  dm->Define("sf1", [](ULong64_t) { return 2.0; }, {"rdfentry_"}, *systematicManager);
+  dm->Define("pdf_factors",
+             [](ULong64_t i) {
+               return i == 0 ? ROOT::VecOps::RVec<float>{0.5f, 1.5f}
+                             : ROOT::VecOps::RVec<float>{};
+             },
+             {"rdfentry_"}, *systematicManager);
+
+  mgr->addScaleFactor("sf1", "sf1");
+  mgr->addWeightVectorVariation("pdf", "pdf_factors", {"pdf_0", "pdf_1"});
+  mgr->defineNominalWeight("weight_nominal");
+  mgr->defineVariedWeightVector("pdf", "weight_pdf");
+  mgr->execute();
+
+  EXPECT_EQ(mgr->getWeightVectorColumn("pdf"), "weight_pdf");
+  EXPECT_EQ(mgr->getWeightVectorLabels("pdf").size(), 2u);
+  EXPECT_THROW(mgr->getWeightVectorLabels("scale"), std::runtime_error);
+
+  auto weights =
+      dm->getDataFrame().Take<ROOT::VecOps::RVec<Float_t>>("weight_pdf").GetValue();
+  ASSERT_EQ(weights.size(), 2u);
+  ASSERT_EQ(weights[0].size(), 2u);
+  EXPECT_FLOAT_EQ(weights[0][0], 1.0f);
+  EXPECT_FLOAT_EQ(weights[0][1], 3.0f);
+  ASSERT_EQ(weights[1].size(), 2u);
+  EXPECT_FLOAT_EQ(weights[1][0], 2.0f);
+  EXPECT_FLOAT_EQ(weights[1][1], 2.0f);
+}
+
+TEST_F(WeightManagerTest, AddWeightVectorVariationWithoutLabelsThrows) {
+  WeightManager mgr;
+  EXPECT_THROW(mgr.addWeightVectorVariation("pdf", "LHEPdfWeight", {}),
+               std::invalid_argument);
+}
+
 TEST_F(WeightManagerTest, VariationCanReplaceDifferentComponentName) {
   auto dm = std::make_unique<DataManager>(2);
   auto mgr = makeMgr(*dm);
@@ -457,6 +564,103 @@ TEST_F(WeightManagerTest, VariationCanReplaceDifferentComponentName) {
   EXPECT_DOUBLE_EQ(downValues[1], 0.85 * 1.2);
 }
 
+TEST_F(WeightManagerTest, FusedProductHandlesMixedTypesAndSharedComplement) {
+  auto dm = std::make_unique<DataManager>(2);
+  auto mgr = makeMgr(*dm);
+
+  dm->Define("pu_nominal",
+             [](ULong64_t i) { return i == 0 ? 0.5f : 2.0f; },
+             {"rdfentry_"}, *systematicManager);
+  dm->Define("id_nominal",
+             [](ULong64_t i) { return i == 0 ? 0.25 : 4.0; },
+             {"rdfentry_"}, *systematicManager);
+  dm->Define("pu_up",
+             [](ULong64_t i) { return i == 0 ? 0.75f : 2.5f; },
+             {"rdfentry_"}, *systematicManager);
+  dm->Define("pu_down",
+             [](ULong64_t i) { return i == 0 ? 0.25f : 1.5f; },
+             {"rdfentry_"}, *systematicManager);
+
+  mgr->addNormalization("lumi", 2.0);
+  mgr->addScaleFactor("pu", "pu_nominal");
+  mgr->addScaleFactor("id", "id_nominal");
+  mgr->addWeightVariation("pu", "pu", "pu_up", "pu_down");
+  mgr->defineNominalWeight("w_nom");
+  mgr->defineVariedWeight("pu", "up", "w_pu_up");
+  mgr->defineVariedWeight("pu", "down", "w_pu_down");
+
+  mgr->execute();
+
+  auto df = dm->getDataFrame();
+  auto nominal = df.Take<double>("w_nom");
+  auto up = df.Take<double>("w_pu_up");
+  auto down = df.Take<double>("w_pu_down");
+
+  // All factors are exact binary fractions, so every order gives equal results.
+  EXPECT_EQ(nominal.GetValue(), (std::vector<double>{0.25, 16.0}));
+  EXPECT_EQ(up.GetValue(), (std::vector<double>{0.375, 20.0}));
+  EXPECT_EQ(down.GetValue(), (std::vector<double>{0.125, 12.0}));
+
+  // Both pu variations share one product of the remaining factors.
+  const auto columns = df.GetDefinedColumnNames();
+  EXPECT_EQ(std::count(columns.begin(), columns.end(), "w_nom_wm_excl_pu_"), 1);
+}
+
+TEST_F(WeightManagerTest, VariedWeightReplacesEveryFactorOfTheComponent) {
+  auto dm = std::make_unique<DataManager>(1);
+  auto mgr = makeMgr(*dm);
+
+  dm->Define("sf_a", [](ULong64_t) { return 0.5; }, {"rdfentry_"}, *systematicManager);
+  dm->Define("sf_b", [](ULong64_t) { return 0.25; }, {"rdfentry_"}, *systematicManager);
+  dm->Define("sf_id", [](ULong64_t) { return 4.0; }, {"rdfentry_"}, *systematicManager);
+  dm->Define("sf_up", [](ULong64_t) { return 2.0; }, {"rdfentry_"}, *systematicManager);
+  dm->Define("sf_down", [](ULong64_t) { return 1.0; }, {"rdfentry_"}, *systematicManager);
+
+  // Two factors share the component name "trig"; each is replaced.
+  mgr->addScaleFactor("trig", "sf_a");
+  mgr->addScaleFactor("trig", "sf_b");
+  mgr->addScaleFactor("id", "sf_id");
+  mgr->addWeightVariation("trig", "trig", "sf_up", "sf_down");
+  mgr->defineNominalWeight("w_nom");
+  mgr->defineVariedWeight("trig", "up", "w_trig_up");
+  mgr->defineVariedWeight("trig", "down", "w_trig_down");
+
+  mgr->execute();
+
+  auto df = dm->getDataFrame();
+  EXPECT_DOUBLE_EQ(df.Take<double>("w_nom").GetValue()[0], 0.5);
+  EXPECT_DOUBLE_EQ(df.Take<double>("w_trig_up").GetValue()[0], 16.0);
+  EXPECT_DOUBLE_EQ(df.Take<double>("w_trig_down").GetValue()[0], 4.0);
+}
+
+TEST_F(WeightManagerTest, FactorsAddedLaterReachLaterVariedWeights) {
+  auto dm = std::make_unique<DataManager>(1);
+  auto mgr = makeMgr(*dm);
+
+  dm->Define("pu_nominal", [](ULong64_t) { return 0.5; }, {"rdfentry_"}, *systematicManager);
+  dm->Define("id_nominal", [](ULong64_t) { return 4.0; }, {"rdfentry_"}, *systematicManager);
+  dm->Define("pu_up", [](ULong64_t) { return 2.0; }, {"rdfentry_"}, *systematicManager);
+  dm->Define("pu_down", [](ULong64_t) { return 1.0; }, {"rdfentry_"}, *systematicManager);
+  dm->Define("btag_nominal", [](ULong64_t) { return 0.25; }, {"rdfentry_"},
+             *systematicManager);
+
+  mgr->addScaleFactor("pu", "pu_nominal");
+  mgr->addScaleFactor("id", "id_nominal");
+  mgr->addWeightVariation("pu", "pu", "pu_up", "pu_down");
+  mgr->defineVariedWeight("pu", "up", "w_pu_up");
+
+  // Factors added after the first varied weight must reach later ones.
+  mgr->addScaleFactor("btag", "btag_nominal");
+  mgr->addNormalization("lumi", 2.0);
+  mgr->defineVariedWeight("pu", "down", "w_pu_down");
+
+  mgr->execute();
+
+  auto df = dm->getDataFrame();
+  EXPECT_DOUBLE_EQ(df.Take<double>("w_pu_up").GetValue()[0], 8.0);
+  EXPECT_DOUBLE_EQ(df.Take<double>("w_pu_down").GetValue()[0], 2.0);
+}
+
 // ---------------------------------------------------------------------------
 // reportMetadata does not throw after a full run
 // ---------------------------------------------------------------------------
@@ -291,10 +291,50 @@ def run_test() -> int:
         if len(region_names) == 0:
             raise AssertionError("bookNDHistograms returned no region metadata")
 
+        # In-memory export runs the event loop for the booked histogram.
+        hist_arrays = analyzer.getNDHistogramArrays("hist")
+        exported = hist_arrays.get("h_pt_scaled_unit_test")
+        if exported is None:
+            raise AssertionError(f"getNDHistogramArrays returned {list(hist_arrays)}")
+        if exported["bins"].dtype != "uint64" or len(exported["sums"]) != len(exported["bins"]):
+            raise AssertionError("getNDHistogramArrays returned malformed bin arrays")
+        if not (exported["bins"][1:] > exported["bins"][:-1]).all() or exported["sums"].sum() <= 0:
+            raise AssertionError("getNDHistogramArrays bins are unsorted or empty")
+
         analyzer.clearNDHistograms("hist")
 
         analyzer.Filter("selected_high_pt", "pass_high_pt_copy", ["pass_high_pt_copy"])
         _ = analyzer.makeSystList("pt_scaled")
+
+        # Block kernel: the same scaling, called once per block of events.
+        block_sig = numba.types.void(
+            numba.types.int64,
+            numba.types.CPointer(numba.types.CPointer(numba.types.float64)),
+            numba.types.CPointer(numba.types.CPointer(numba.types.int64)),
+            numba.types.CPointer(numba.types.float64),
+        )
+
+        @numba.cfunc(block_sig)
+        def scale_block(n, inputs, offsets, out):
+            pt = numba.carray(inputs[0], n)
+            for i in range(n):
+                out[i] = 2.0 * pt[i]
+
+        analyzer.DefineFromBlockPointer("pt_scaled_block", scale_block.address, ["pt"], 2)
+
+        # Chunked NumPy export runs its own event loop over the same graph.
+        arrays = analyzer.AsArrays(["pt_scaled", "pass_high_pt", "pt_scaled_block"])
+        if arrays["pt_scaled_block"].tolist() != arrays["pt_scaled"].tolist():
+            raise AssertionError("DefineFromBlockPointer disagrees with DefineFromPointer")
+        if sorted(arrays["pt_scaled"].tolist()) not in ([60.0], [60.0, 100.0]):
+            raise AssertionError(f"AsArrays returned {arrays['pt_scaled'].tolist()}")
+        if arrays["pass_high_pt"].dtype != bool or not arrays["pass_high_pt"].all():
+            raise AssertionError("AsArrays did not export pass_high_pt as a bool array")
+        streamed = []
+        rows = analyzer.IterateArrays(["pt_scaled"], 1, streamed.append)
+        if rows != len(arrays["pt_scaled"]) or len(streamed) != rows:
+            raise AssertionError(f"IterateArrays delivered {rows} row(s) in {len(streamed)} chunk(s)")
+
         analyzer.save()
 
         _assert_output(uproot, output_file)
@@ -0,0 +1,164 @@
+#!/usr/bin/env python3
+"""
+Integration test of Analyzer.runAsync() in the RDFAnalyzerCore Python bindings.
+
+This test validates that:
+1. The future resolves to the analyzer once the run is over.
+2. The progress callback reports the entries read, ending with all of them.
+3. An error of the event loop, or of the progress callback, becomes the
+   exception of the future.
+4. A second run of the same analyzer is rejected while the first is running.
+
+Exit codes:
+  0: success
+  1: failure
+ 77: skipped due to missing runtime prerequisites (uproot/module)
+"""
+import sys
+import tempfile
+from pathlib import Path
+
+
+SKIP_EXIT_CODE = 77
+
+
+def _add_module_path() -> None:
+    repo_root = Path(__file__).resolve().parents[2]
+    module_path = repo_root / "build" / "python"
+    sys.path.insert(0, str(module_path))
+
+
+def _require_imports():
+    _add_module_path()
+
+    try:
+        import rdfanalyzer  # type: ignore
+    except Exception as exc:
+        print(f"SKIP: unable to import rdfanalyzer: {exc}")
+        sys.exit(SKIP_EXIT_CODE)
+
+    try:
+        import uproot  # type: ignore
+    except Exception as exc:
+        print(f"SKIP: unable to import uproot: {exc}")
+        sys.exit(SKIP_EXIT_CODE)
+
+    return rdfanalyzer, uproot
+
+
+def _write_input_root(uproot_module, input_file: Path) -> None:
+    import numpy as np
+    arr = np.array([10.0, 30.0, 50.0, 70.0], dtype="float64")
+    with uproot_module.recreate(str(input_file)) as f:
+        f["Events"] = {"pt": arr}
+
+
+def _write_analysis_config(config_path: Path, input_file: Path, output_file: Path, save_config: Path) -> None:
+    content = "\n".join(
+        [
+            f"fileList={input_file}",
+            f"saveFile={output_file}",
+            "saveTree=Events",
+            "threads=1",
+            f"saveConfig={save_config}",
+        ]
+    )
+    config_path.write_text(content + "\n")
+
+
+def _make_analyzer(rdfanalyzer, workdir: Path, name: str):
+    save_config = workdir / "save_columns.txt"
+    save_config.write_text("pt\n")
+    config_file = workdir / f"{name}.txt"
+    _write_analysis_config(config_file, workdir / "input.root", workdir / f"{name}.root", save_config)
+    analyzer = rdfanalyzer.Analyzer(str(config_file))
+    # As in test_python_bindings.py: a no-op when the input file is read.
+    analyzer.Define("pt", "30.0", [])
+    return analyzer
+
+
+def _check_result_and_progress(rdfanalyzer, workdir: Path) -> None:
+    entries = len(_make_analyzer(rdfanalyzer, workdir, "count").AsArrays(["pt"])["pt"])
+
+    analyzer = _make_analyzer(rdfanalyzer, workdir, "result")
+    reports = []
+    future = analyzer.runAsync(progress=reports.append, interval=0.01)
+    if future.result(timeout=120) is not analyzer:
+        raise AssertionError("runAsync future did not resolve to the analyzer")
+    if not reports or reports[-1] != entries:
+        raise AssertionError(f"Expected the last progress report to be {entries}, got {reports}")
+    if reports != sorted(reports):
+        raise AssertionError(f"Progress reports decreased: {reports}")
+
+
+def _check_second_run_is_rejected(rdfanalyzer, workdir: Path) -> None:
+    analyzer = _make_analyzer(rdfanalyzer, workdir, "busy")
+    # Slow enough that the second calls below happen while the loop runs.
+    analyzer.Define("slow", "(gSystem->Sleep(500), 1)", [])
+    analyzer.Filter("slow", "slow > 0", ["slow"])
+    future = analyzer.runAsync()
+    for second in (lambda: analyzer.runAsync(), analyzer.run, analyzer.save):
+        try:
+            second()
+        except RuntimeError as exc:
+            if "already running" not in str(exc):
+                raise AssertionError(f"Unexpected error for a second run: {exc}")
+        else:
+            raise AssertionError("A second run of a running analyzer was not rejected")
+    future.result(timeout=120)
+    # Once the first run is over, the analyzer is free again.
+    analyzer.runAsync().result(timeout=120)
+
+
+def _check_errors_reach_the_future(rdfanalyzer, workdir: Path) -> None:
+    analyzer = _make_analyzer(rdfanalyzer, workdir, "error")
+    analyzer.Define("broken", '(throw std::runtime_error("broken column"), 1)', [])
+    analyzer.Filter("broken", "broken > 0", ["broken"])
+    error = analyzer.runAsync().exception(timeout=120)
+    if not isinstance(error, RuntimeError) or "broken column" not in str(error):
+        raise AssertionError(f"Expected the event loop error in the future, got {error!r}")
+
+    def failing_progress(entries):
+        raise ValueError(f"progress failed at {entries}")
+
+    analyzer = _make_analyzer(rdfanalyzer, workdir, "progress_error")
+    error = analyzer.runAsync(progress=failing_progress, interval=0.01).exception(timeout=120)
+    if not isinstance(error, ValueError) or "progress failed" not in str(error):
+        raise AssertionError(f"Expected the progress error in the future, got {error!r}")
+
+
+def run_test() -> int:
+    rdfanalyzer, uproot = _require_imports()
+
+    with tempfile.TemporaryDirectory(prefix="rdf_pybind_async_test_") as tmpdir:
+        workdir = Path(tmpdir)
+        _write_input_root(uproot, workdir / "input.root")
+
+        _check_result_and_progress(rdfanalyzer, workdir)
+        _check_second_run_is_rejected(rdfanalyzer, workdir)
+        _check_errors_reach_the_future(rdfanalyzer, workdir)
+
+    print("PASS: Python bindings runAsync future, progress, errors and run claim")
+    return 0
+
+
+def test_run_async() -> None:
+    """Entry point for pytest."""
+    import pytest
+
+    try:
+        run_test()
+    except SystemExit as exc:
+        if exc.code == SKIP_EXIT_CODE:
+            pytest.skip("rdfanalyzer or uproot is not available")
+        raise
+
+
+if __name__ == "__main__":
+    try:
+        sys.exit(run_test())
+    except SystemExit:
+        raise
+    except Exception as exc:
+        print(f"FAIL: {exc}")
+        sys.exit(1)
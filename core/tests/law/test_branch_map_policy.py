@@ -259,6 +259,17 @@ class TestBranchingPolicyFromConfigStr(unittest.TestCase):
         with self.assertRaises(BranchMapGenerationError):
             BranchingPolicy.from_config_str("dims")
 
+    def test_merge_target_size(self):
+        p = BranchingPolicy.from_config_str("merge_target_size=2GB")
+        self.assertEqual(p.merge_target_size, 2 << 30)
+        self.assertEqual(p.validate(), [])
+        p = BranchingPolicy.from_config_str("merge_target_size=none")
+        self.assertIsNone(p.merge_target_size)
+
+    def test_bad_merge_target_size_raises(self):
+        with self.assertRaises(BranchMapGenerationError):
+            BranchingPolicy.from_config_str("merge_target_size=2 parsecs")
+
 
 # ===========================================================================
 # generate_branch_map – dataset-only (legacy parity)
@@ -284,6 +284,65 @@ class TestFullAnalysisDAGRequires(unittest.TestCase):
         self.assertEqual(reqs[0].kwargs["skim_name"], "reqDAG")
         self.assertEqual(reqs[0].kwargs["submit_config"], "hist_config.txt")
 
+    def test_fused_skim_runs_in_histfill_without_skim_stage(self):
+        class HistFillTask:
+            def __init__(self, **kwargs):
+                self.kwargs = kwargs
+
+        mock_analysis_tasks_module = types.ModuleType("analysis_tasks")
+        mock_analysis_tasks_module.HistFillTask = HistFillTask
+
+        task = self._make_task(
+            skip_skim=False,
+            skip_histfill=False,
+            skip_merge=True,
+            skip_plots=True,
+            skip_fits=True,
+            fuse_skim=True,
+            persist_skim=True,
+            exe="analysis.exe",
+            submit_config="submit_config.txt",
+            dataset_manifest="datasets.yaml",
+        )
+        with patch.dict(sys.modules, {"analysis_tasks": mock_analysis_tasks_module}):
+            reqs = task.requires()
+
+        self.assertFalse(task._skim_stage_enabled)
+        self.assertEqual(len(reqs), 1)
+        self.assertNotIn("skim_name", reqs[0].kwargs)
+        self.assertTrue(reqs[0].kwargs["fuse_skim"])
+        self.assertTrue(reqs[0].kwargs["persist_skim"])
+
+    def test_fused_skim_falls_back_when_hist_config_differs(self):
+        class HistFillTask:
+            def __init__(self, **kwargs):
+                self.kwargs = kwargs
+
+        mock_analysis_tasks_module = types.ModuleType("analysis_tasks")
+        mock_analysis_tasks_module.HistFillTask = HistFillTask
+
+        task = self._make_task(
+            skip_skim=False,
+            skip_histfill=False,
+            skip_merge=True,
+            skip_plots=True,
+            skip_fits=True,
+            fuse_skim=True,
+            exe="analysis.exe",
+            submit_config="submit_config.txt",
+            hist_config="hist_config.txt",
+            dataset_manifest="datasets.yaml",
+        )
+        with patch.dict(sys.modules, {"analysis_tasks": mock_analysis_tasks_module}):
+            reqs = task.requires()
+
+        self.assertFalse(task._skim_fused)
+        self.assertTrue(task._skim_stage_enabled)
+        self.assertEqual(len(reqs), 1)
+        self.assertNotIn("fuse_skim", reqs[0].kwargs)
+        self.assertEqual(reqs[0].kwargs["skim_name"], "reqDAG")
+        self.assertEqual(reqs[0].kwargs["submit_config"], "hist_config.txt")
+
     def test_merge_uses_hist_output_directory_by_default(self):
         import dag_tasks
 
@@ -337,6 +396,71 @@ class TestFullAnalysisDAGRequires(unittest.TestCase):
             os.path.join(dag_tasks.WORKSPACE, "histRun_reqDAG", "outputs"),
         )
 
+    def test_tagger_map_task_included_after_merge(self):
+        import dag_tasks
+
+        task = self._make_task(
+            skip_skim=False,
+            skip_histfill=False,
+            skip_merge=False,
+            skip_plots=True,
+            skip_fits=True,
+            exe="analysis.exe",
+            submit_config="submit_config.txt",
+            dataset_manifest="datasets.yaml",
+            tagger_maps="deepjet_frac",
+        )
+        reqs = task.requires()
+        self.assertEqual(len(reqs), 1)
+        self.assertEqual(type(reqs[0]).__name__, "TaggerEfficiencyMapTask")
+        self.assertEqual(
+            reqs[0].merge_input_dir,
+            os.path.join(dag_tasks.WORKSPACE, "histRun_reqDAG", "outputs"),
+        )
+        self.assertEqual(
+            reqs[0].output()["deepjet_frac"].path,
+            os.path.join(dag_tasks.tagger_map_dir("reqDAG"), "deepjet_frac.json"),
+        )
+
+    def test_tagger_map_task_not_included_when_merge_skipped(self):
+        task = self._make_task(
+            skip_merge=True,
+            skip_plots=True,
+            skip_fits=True,
+            tagger_maps="deepjet_frac",
+        )
+        types_ = [type(r).__name__ for r in task.requires()]
+        self.assertNotIn("TaggerEfficiencyMapTask", types_)
+
+    def test_histfill_consumes_maps_of_earlier_run(self):
+        import dag_tasks
+
+        class HistFillTask:
+            def __init__(self, **kwargs):
+                self.kwargs = kwargs
+
+        mock_analysis_tasks_module = types.ModuleType("analysis_tasks")
+        mock_analysis_tasks_module.HistFillTask = HistFillTask
+
+        task = self._make_task(
+            skip_histfill=False,
+            skip_merge=True,
+            skip_plots=True,
+            skip_fits=True,
+            exe="analysis.exe",
+            submit_config="submit_config.txt",
+            dataset_manifest="datasets.yaml",
+            tagger_maps_from="previousRun",
+        )
+        with patch.dict(sys.modules, {"analysis_tasks": mock_analysis_tasks_module}):
+            reqs = task.requires()
+
+        self.assertEqual(len(reqs), 1)
+        self.assertEqual(
+            reqs[0].kwargs["tagger_map_dir"],
+            dag_tasks.tagger_map_dir("previousRun"),
+        )
+
 
 @unittest.skipUnless(_LAW_AVAILABLE, _SKIP_MSG)
 class TestFullAnalysisDAGRun(unittest.TestCase):
@@ -0,0 +1,139 @@
+#!/usr/bin/env python3
+"""
+Tests for incremental_merge.IncrementalMerger.
+
+The merge function is replaced by one that adds the numbers stored in plain
+text files, so the merge trees are checked without ROOT.
+"""
+
+from __future__ import annotations
+
+import json
+import os
+import sys
+import tempfile
+import unittest
+
+_REPO_ROOT = os.path.abspath(os.path.join(os.path.dirname(__file__), "..", "..", ".."))
+_LAW_DIR = os.path.join(_REPO_ROOT, "core", "python", "law")
+if _LAW_DIR not in sys.path:
+    sys.path.insert(0, _LAW_DIR)
+
+from incremental_merge import STATE_FILE, IncrementalMerger, job_signature
+
+
+def _write(path: str, value: int) -> str:
+    os.makedirs(os.path.dirname(path), exist_ok=True)
+    with open(path, "w") as fh:
+        fh.write(str(value))
+    return path
+
+
+def _read(path: str) -> int:
+    with open(path) as fh:
+        return int(fh.read())
+
+
+class _AddingMerge:
+    """Merge function adding the inputs; records the input counts."""
+
+    def __init__(self):
+        self.calls = []
+
+    def __call__(self, output_path, input_paths):
+        self.calls.append(len(input_paths))
+        _write(output_path, sum(_read(p) for p in input_paths))
+
+
+class TestIncrementalMerger(unittest.TestCase):
+    def setUp(self):
+        self._tmp = tempfile.TemporaryDirectory()
+        self.tmp = self._tmp.name
+        self.state_dir = os.path.join(self.tmp, "state")
+        self.out_dir = os.path.join(self.tmp, "merged")
+        self.merge = _AddingMerge()
+
+    def tearDown(self):
+        self._tmp.cleanup()
+
+    def _job(self, merger, index, value, basename="hists.root", signature="v1"):
+        path = _write(os.path.join(self.tmp, f"job_{index}", basename), value)
+        return merger.fold(f"job_{index}", {basename: path}, signature)
+
+    def test_running_result_matches_full_merge(self):
+        merger = IncrementalMerger(self.state_dir, self.merge, fan_in=3)
+        for i in range(20):
+            self._job(merger, i, i + 1)
+            published = merger.publish(self.out_dir)
+            self.assertEqual(_read(published["hists.root"]), sum(range(1, i + 2)))
+
+        # 20 jobs with fan-in 3: six level-1, two level-2 partials.
+        self.assertEqual(merger.stats(), {"jobs": 20, "partials": 8, "depth": 2})
+        self.assertLessEqual(max(self.merge.calls), 3 * 2)
+
+    def test_refolding_the_same_signature_is_a_no_op(self):
+        merger = IncrementalMerger(self.state_dir, self.merge, fan_in=2)
+        self.assertTrue(self._job(merger, 0, 5))
+        self.assertTrue(self._job(merger, 1, 7))
+        calls = len(self.merge.calls)
+        self.assertFalse(self._job(merger, 1, 7))
+        self.assertEqual(len(self.merge.calls), calls)
+        self.assertEqual(_read(merger.publish(self.out_dir)["hists.root"]), 12)
+
+    def test_resubmitted_job_replaces_its_contribution(self):
+        merger = IncrementalMerger(self.state_dir, self.merge, fan_in=2)
+        for i in range(8):
+            self._job(merger, i, 1)
+        calls = len(self.merge.calls)
+        self._job(merger, 3, 10, signature="v2")
+        # Only the partials above job_3 (levels 1 to 3) are rebuilt.
+        self.assertEqual(len(self.merge.calls) - calls, 3)
+        self.assertEqual(_read(merger.publish(self.out_dir)["hists.root"]), 17)
+
+    def test_variations_form_separate_trees(self):
+        merger = IncrementalMerger(self.state_dir, self.merge, fan_in=2)
+        for i in range(3):
+            nominal = _write(os.path.join(self.tmp, f"job_{i}", "h.root"), 1)
+            up = _write(os.path.join(self.tmp, f"job_{i}", "h_jesUp.root"), 2)
+            merger.fold(f"job_{i}", {"h.root": nominal, "h_jesUp.root": up}, "v1")
+        published = merger.publish(self.out_dir)
+        self.assertEqual(_read(published["h.root"]), 3)
+        self.assertEqual(_read(published["h_jesUp.root"]), 6)
+
+        # A rerun that no longer writes the variation drops it.
+        nominal = _write(os.path.join(self.tmp, "job_0", "h.root"), 1)
+        merger.fold("job_0", {"h.root": nominal}, "v2")
+        self.assertEqual(_read(merger.publish(self.out_dir)["h_jesUp.root"]), 4)
+
+    def test_resumes_from_saved_state(self):
+        merger = IncrementalMerger(self.state_dir, self.merge, fan_in=2)
+        for i in range(5):
+            self._job(merger, i, i)
+        self.assertTrue(os.path.isfile(os.path.join(self.state_dir, STATE_FILE)))
+
+        resumed = IncrementalMerger(self.state_dir, self.merge, fan_in=2)
+        self.assertEqual(resumed.job_ids, [f"job_{i}" for i in range(5)])
+        self.assertFalse(self._job(resumed, 4, 4))
+        self._job(resumed, 5, 5)
+        self.assertEqual(_read(resumed.publish(self.out_dir)["hists.root"]), 15)
+
+        with self.assertRaises(RuntimeError):
+            IncrementalMerger(self.state_dir, self.merge, fan_in=4)
+
+    def test_rejects_fan_in_below_two(self):
+        with self.assertRaises(ValueError):
+            IncrementalMerger(self.state_dir, self.merge, fan_in=1)
+
+    def test_job_signature_tracks_manifest_and_files(self):
+        manifest = os.path.join(self.tmp, "job", "output_manifest.yaml")
+        data = _write(os.path.join(self.tmp, "job", "hists.root"), 1)
+        with open(manifest, "w") as fh:
+            json.dump({"histograms": "hists.root"}, fh)
+        first = job_signature(manifest, [data])
+        self.assertEqual(job_signature(manifest, [data]), first)
+        _write(data, 12345)
+        self.assertNotEqual(job_signature(manifest, [data]), first)
+
+
+if __name__ == "__main__":
+    unittest.main()
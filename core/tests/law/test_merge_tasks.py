@@ -4,7 +4,8 @@ Tests for the merge_tasks law module.
 
 These tests verify:
   - Module structure and imports
-  - Helper functions (_find_hadd, _run_hadd, _group_files_by_basename)
+  - Helper functions (_find_hadd, _run_hadd, _run_merge, _run_skim_merge,
+    _group_files_by_basename)
   - MergeMixin parameter defaults and derived properties
   - MergeSkims / MergeHistograms / MergeCutflows / MergeMetadata output paths
   - MergeAll requires logic based on schema presence
@@ -308,6 +309,93 @@ class TestRunHadd(unittest.TestCase):
             self.assertTrue(os.path.isdir(os.path.join(tmpdir, "deep", "nested")))
 
 
+class TestRunMerge(unittest.TestCase):
+    """Tests for _run_merge."""
+
+    def _import(self):
+        import merge_tasks
+        return merge_tasks
+
+    def test_raises_on_empty_inputs(self):
+        mod = self._import()
+        with self.assertRaises(ValueError):
+            mod._run_merge("/tmp/out.root", [])
+
+    def test_calls_rdfmerge_when_built(self):
+        mod = self._import()
+        with patch.object(mod, "_find_merge_tool", return_value="/opt/rdfmerge"), \
+             patch("subprocess.run") as mock_run:
+            mock_run.return_value = MagicMock(returncode=0, stderr="")
+            mod._run_merge("/out/merged.root", ["/a/f.root", "/b/f.root"])
+            cmd = mock_run.call_args[0][0]
+            self.assertEqual(cmd, ["/opt/rdfmerge", "-o", "/out/merged.root",
+                                   "/a/f.root", "/b/f.root"])
+
+    def test_raises_on_nonzero_exit(self):
+        mod = self._import()
+        with patch.object(mod, "_find_merge_tool", return_value="/opt/rdfmerge"), \
+             patch("subprocess.run") as mock_run:
+            mock_run.return_value = MagicMock(returncode=1, stderr="rdfmerge: error")
+            with self.assertRaises(RuntimeError):
+                mod._run_merge("/out/merged.root", ["/in.root"])
+
+    def test_falls_back_to_hadd(self):
+        mod = self._import()
+        with patch.object(mod, "_find_merge_tool", return_value=None), \
+             patch.object(mod, "_run_hadd") as mock_hadd:
+            mod._run_merge("/out/merged.root", ["/in.root"])
+            mock_hadd.assert_called_once_with("/out/merged.root", ["/in.root"])
+
+
+class TestRunSkimMerge(unittest.TestCase):
+    """Tests for _run_skim_merge."""
+
+    def _import(self):
+        import merge_tasks
+        return merge_tasks
+
+    def test_raises_on_empty_inputs(self):
+        mod = self._import()
+        with self.assertRaises(ValueError):
+            mod._run_skim_merge("/tmp/skim.root", [])
+
+    def test_passes_target_size_and_returns_outputs(self):
+        mod = self._import()
+        stdout = (
+            "rdfmerge: merged 2 file(s) into /out/skim_0.root (fast copy)\n"
+            "rdfmerge: merged 1 file(s) into /out/skim_1.root (recompressed)\n"
+        )
+        with patch.object(mod, "_find_merge_tool", return_value="/opt/rdfmerge"), \
+             patch("subprocess.run") as mock_run:
+            mock_run.return_value = MagicMock(returncode=0, stdout=stdout, stderr="")
+            outputs = mod._run_skim_merge(
+                "/out/skim.root", ["/a.root", "/b.root", "/c.root"], 1024
+            )
+            cmd = mock_run.call_args[0][0]
+            self.assertEqual(cmd, ["/opt/rdfmerge", "--skim", "-o", "/out/skim.root",
+                                   "--target-size", "1024",
+                                   "/a.root", "/b.root", "/c.root"])
+        self.assertEqual(outputs, ["/out/skim_0.root", "/out/skim_1.root"])
+
+    def test_raises_on_nonzero_exit(self):
+        mod = self._import()
+        with patch.object(mod, "_find_merge_tool", return_value="/opt/rdfmerge"), \
+             patch("subprocess.run") as mock_run:
+            mock_run.return_value = MagicMock(returncode=1, stdout="", stderr="boom")
+            with self.assertRaises(RuntimeError):
+                mod._run_skim_merge("/out/skim.root", ["/in.root"])
+
+    def test_falls_back_to_hadd_keeping_compression(self):
+        mod = self._import()
+        with patch.object(mod, "_find_merge_tool", return_value=None), \
+             patch.object(mod, "_run_hadd") as mock_hadd:
+            outputs = mod._run_skim_merge("/out/skim.root", ["/in.root"], 1024)
+            mock_hadd.assert_called_once_with(
+                "/out/skim.root", ["/in.root"], keep_compression=True
+            )
+        self.assertEqual(outputs, ["/out/skim.root"])
+
+
 # ===========================================================================
 # Tests requiring law/luigi
 # ===========================================================================
@@ -489,7 +577,7 @@ class TestMergeSkimsTask(unittest.TestCase):
             self.assertIn("skim", str(ctx.exception).lower())
 
     def test_run_merges_and_writes_manifest(self):
-        """MergeSkims.run() calls hadd and writes merged manifest."""
+        """MergeSkims.run() calls the skim merge and writes merged manifest."""
         mod = self._import()
         with tempfile.TemporaryDirectory() as tmpdir:
             out_dir = os.path.join(tmpdir, "output")
@@ -501,16 +589,18 @@ class TestMergeSkimsTask(unittest.TestCase):
                 Path(os.path.join(job_dir, "skim.root")).touch()
 
             task = mod.MergeSkims(
-                name="r", input_dir=tmpdir, output_dir=out_dir
+                name="r", input_dir=tmpdir, output_dir=out_dir,
+                branching_policy="merge_target_size=1GB",
             )
 
-            # Mock hadd so we don't need ROOT; mock publish_message
-            with patch.object(mod, "_run_hadd") as mock_hadd, \
+            # Mock the merge so we don't need ROOT; mock publish_message
+            with patch.object(mod, "_run_skim_merge") as mock_hadd, \
                  patch.object(task, "publish_message", return_value=None):
-                # Make hadd appear to create the output file
-                def fake_hadd(out_path, in_paths):
+                # Make the merge appear to create the output file
+                def fake_hadd(out_path, in_paths, target_bytes):
                     Path(out_path).parent.mkdir(parents=True, exist_ok=True)
                     Path(out_path).touch()
+                    return [out_path]
                 mock_hadd.side_effect = fake_hadd
                 task.run()
 
@@ -524,9 +614,11 @@ class TestMergeSkimsTask(unittest.TestCase):
             with open(groups_json) as fh:
                 groups = json.load(fh)
             self.assertIn("skim.root", groups)
+            self.assertEqual(len(groups["skim.root"]), 1)
 
-            # hadd must have been called once (one group: skim.root)
+            # Merged once (one group: skim.root) with the policy's target size
             mock_hadd.assert_called_once()
+            self.assertEqual(mock_hadd.call_args[0][2], 1 << 30)
 
     def test_run_handles_systematic_variations(self):
         """MergeSkims groups systematic variation files separately."""
@@ -570,7 +662,7 @@ class TestMergeHistogramsTask(unittest.TestCase):
         self.assertEqual(task.output().path, expected)
 
     def test_run_merges_and_writes_manifest(self):
-        """MergeHistograms.run() calls hadd and writes merged manifest."""
+        """MergeHistograms.run() calls the merge tool and writes merged manifest."""
         mod = self._import()
         with tempfile.TemporaryDirectory() as tmpdir:
             out_dir = os.path.join(tmpdir, "output")
@@ -580,7 +672,7 @@ class TestMergeHistogramsTask(unittest.TestCase):
                 Path(os.path.join(job_dir, "histograms.root")).touch()
 
             task = mod.MergeHistograms(name="r", input_dir=tmpdir, output_dir=out_dir)
-            with patch.object(mod, "_run_hadd") as mock_hadd, \
+            with patch.object(mod, "_run_merge") as mock_hadd, \
                  patch.object(task, "publish_message", return_value=None):
                 def fake_hadd(out_path, in_paths):
                     Path(out_path).parent.mkdir(parents=True, exist_ok=True)
@@ -609,7 +701,7 @@ class TestMergeCutflowsTask(unittest.TestCase):
         self.assertEqual(task.output().path, expected)
 
     def test_run_merges_and_writes_manifest(self):
-        """MergeCutflows.run() calls hadd and writes merged manifest."""
+        """MergeCutflows.run() calls the merge tool and writes merged manifest."""
         mod = self._import()
         with tempfile.TemporaryDirectory() as tmpdir:
             out_dir = os.path.join(tmpdir, "output")
@@ -619,7 +711,7 @@ class TestMergeCutflowsTask(unittest.TestCase):
                 Path(os.path.join(job_dir, "cutflow.root")).touch()
 
             task = mod.MergeCutflows(name="r", input_dir=tmpdir, output_dir=out_dir)
-            with patch.object(mod, "_run_hadd") as mock_hadd, \
+            with patch.object(mod, "_run_merge") as mock_hadd, \
                  patch.object(task, "publish_message", return_value=None):
                 def fake_hadd(out_path, in_paths):
                     Path(out_path).parent.mkdir(parents=True, exist_ok=True)
@@ -885,6 +977,71 @@ class TestMergeAllTask(unittest.TestCase):
                 self.assertEqual(sub.framework_hash, "fw_hash_test")
 
 
+@unittest.skipUnless(_LAW_AVAILABLE, _SKIP_MSG)
+class TestStreamingMergeTask(unittest.TestCase):
+    """Tests for StreamingMerge polling, folding and final outputs."""
+
+    def _import(self):
+        import merge_tasks
+        return merge_tasks
+
+    def test_output_path(self):
+        mod = self._import()
+        task = mod.StreamingMerge(name="myRun")
+        expected = os.path.join(mod.WORKSPACE, "mergeRun_myRun", "streaming_merge.json")
+        self.assertEqual(task.output().path, expected)
+
+    def test_run_folds_jobs_and_completes_merge_tasks(self):
+        """StreamingMerge.run() writes the MergeHistograms/MergeCutflows/
+        MergeMetadata outputs, so those tasks are complete afterwards."""
+        mod = self._import()
+        with tempfile.TemporaryDirectory() as tmpdir:
+            in_dir = os.path.join(tmpdir, "jobs")
+            out_dir = os.path.join(tmpdir, "output")
+            for i in range(5):
+                job_dir = os.path.join(in_dir, f"job_{i}")
+                _make_full_manifest(job_dir)
+                Path(os.path.join(job_dir, "histograms.root")).touch()
+                Path(os.path.join(job_dir, "cutflow.root")).touch()
+
+            task = mod.StreamingMerge(
+                name="r", input_dir=in_dir, output_dir=out_dir,
+                expected_jobs=5, fan_in=2,
+            )
+            with patch.object(mod, "_run_merge") as mock_merge, \
+                 patch.object(task, "publish_message", return_value=None):
+                def fake_merge(out_path, in_paths):
+                    Path(out_path).parent.mkdir(parents=True, exist_ok=True)
+                    Path(out_path).touch()
+                mock_merge.side_effect = fake_merge
+                task.run()
+
+            self.assertTrue(os.path.isfile(task.output().path))
+            for cls in (mod.MergeHistograms, mod.MergeCutflows, mod.MergeMetadata):
+                sub = cls(name="r", input_dir=in_dir, output_dir=out_dir)
+                self.assertTrue(os.path.isfile(sub.output().path), cls.__name__)
+            self.assertTrue(os.path.isfile(os.path.join(out_dir, "histograms", "histograms.root")))
+            with open(task.output().path) as fh:
+                summary = json.load(fh)
+            self.assertEqual(summary["n_jobs"], 5)
+            self.assertEqual(summary["merge_trees"]["histograms"]["partials"], 3)
+
+    def test_incomplete_run_fails_after_idle_timeout(self):
+        mod = self._import()
+        with tempfile.TemporaryDirectory() as tmpdir:
+            job_dir = os.path.join(tmpdir, "job_0")
+            _make_histogram_manifest(job_dir)
+            Path(os.path.join(job_dir, "histograms.root")).touch()
+
+            task = mod.StreamingMerge(
+                name="r", input_dir=tmpdir, output_dir=os.path.join(tmpdir, "out"),
+                expected_jobs=2, poll_interval=0.01, idle_timeout=0.05,
+            )
+            with patch.object(task, "publish_message", return_value=None):
+                with self.assertRaises(RuntimeError):
+                    task.run()
+
+
 @unittest.skipUnless(_LAW_AVAILABLE, _SKIP_MSG)
 class TestLawCfgRegistration(unittest.TestCase):
     """Verify that merge_tasks is registered in law.cfg."""
@@ -937,6 +1094,7 @@ class TestMergeTasksModuleImports(unittest.TestCase):
             merge_tasks.MergeCutflows,
             merge_tasks.MergeMetadata,
             merge_tasks.MergeAll,
+            merge_tasks.StreamingMerge,
         ):
             self.assertEqual(
                 cls.task_namespace, "",
@@ -951,6 +1109,7 @@ class TestMergeTasksModuleImports(unittest.TestCase):
             merge_tasks.MergeCutflows,
             merge_tasks.MergeMetadata,
             merge_tasks.MergeAll,
+            merge_tasks.StreamingMerge,
         ):
             self.assertTrue(
                 issubclass(cls, law.Task),
@@ -965,6 +1124,7 @@ class TestMergeTasksModuleImports(unittest.TestCase):
             merge_tasks.MergeCutflows,
             merge_tasks.MergeMetadata,
             merge_tasks.MergeAll,
+            merge_tasks.StreamingMerge,
         ):
             self.assertTrue(
                 issubclass(cls, merge_tasks.MergeMixin),
@@ -0,0 +1,110 @@
+from __future__ import annotations
+
+import os
+import sys
+import tempfile
+import unittest
+
+_REPO_ROOT = os.path.abspath(os.path.join(os.path.dirname(__file__), "..", "..", ".."))
+_LAW_DIR = os.path.join(_REPO_ROOT, "core", "python", "law")
+_CORE_PYTHON = os.path.join(_REPO_ROOT, "core", "python")
+for _p in (_CORE_PYTHON, _LAW_DIR):
+    if _p not in sys.path:
+        sys.path.insert(0, _p)
+
+from output_cache import OutputCache, job_cache_key
+
+
+def _write(path: str, text: str) -> str:
+    os.makedirs(os.path.dirname(path), exist_ok=True)
+    with open(path, "w") as fh:
+        fh.write(text)
+    return path
+
+
+class TestJobCacheKey(unittest.TestCase):
+    def setUp(self):
+        self._tmp = tempfile.TemporaryDirectory()
+        self.tmp = self._tmp.name
+        self.exe = _write(os.path.join(self.tmp, "analysis"), "binary")
+        _write(os.path.join(self.tmp, "cfg", "hists.txt"), "name=pt bins=10\n")
+        _write(os.path.join(self.tmp, "cfg", "sf.txt"), "file=sf.json\n")
+        _write(os.path.join(self.tmp, "cfg", "sf.json"), "{}")
+
+    def tearDown(self):
+        self._tmp.cleanup()
+
+    def _job(self, name: str, **overrides) -> str:
+        config = {
+            "fileList": "root://eos//store/a.root,root://eos//store/b.root",
+            "histogramConfig": os.path.join(self.tmp, "cfg", "hists.txt"),
+            "correctionConfig": os.path.join(self.tmp, "cfg", "sf.txt"),
+            "saveFile": os.path.join(self.tmp, name, "out.root"),
+            "__orig_saveFile": "out.root",
+            "threads": "4",
+        }
+        config.update(overrides)
+        text = "".join(f"{k}={v}\n" for k, v in config.items())
+        return _write(os.path.join(self.tmp, name, "submit_config.txt"), text)
+
+    def test_output_locations_do_not_change_the_key(self):
+        self.assertEqual(
+            job_cache_key(self._job("run1"), self.exe),
+            job_cache_key(self._job("run2"), self.exe),
+        )
+
+    def test_inputs_config_and_code_change_the_key(self):
+        base = job_cache_key(self._job("run1"), self.exe)
+        self.assertNotEqual(base, job_cache_key(self._job("a", threads="8"), self.exe))
+        self.assertNotEqual(
+            base, job_cache_key(self._job("b", fileList="root://eos//store/a.root"), self.exe)
+        )
+        self.assertNotEqual(base, job_cache_key(self._job("c"), self.exe, {"framework_hash": "x"}))
+
+        _write(self.exe, "rebuilt")
+        self.assertNotEqual(base, job_cache_key(self._job("d"), self.exe))
+
+    def test_referenced_file_contents_change_the_key(self):
+        base = job_cache_key(self._job("run1"), self.exe)
+        _write(os.path.join(self.tmp, "cfg", "sf.json"), '{"v": 2}')
+        self.assertNotEqual(base, job_cache_key(self._job("run1"), self.exe))
+
+
+class TestOutputCache(unittest.TestCase):
+    def test_store_then_restore_links_outputs(self):
+        with tempfile.TemporaryDirectory() as tmp:
+            cache = OutputCache(os.path.join(tmp, "cache"))
+            out = os.path.join(tmp, "run1", "out")
+            _write(os.path.join(out, "skim.root"), "data")
+            _write(os.path.join(out, "sub", "meta.root"), "meta")
+
+            restored = os.path.join(tmp, "run2", "out")
+            self.assertFalse(cache.restore("ab" * 32, restored))
+            cache.store("ab" * 32, out)
+            self.assertTrue(cache.restore("ab" * 32, restored))
+
+            with open(os.path.join(restored, "sub", "meta.root")) as fh:
+                self.assertEqual(fh.read(), "meta")
+            self.assertEqual(
+                os.stat(os.path.join(out, "skim.root")).st_ino,
+                os.stat(os.path.join(restored, "skim.root")).st_ino,
+            )
+
+    def test_first_store_wins(self):
+        with tempfile.TemporaryDirectory() as tmp:
+            cache = OutputCache(os.path.join(tmp, "cache"))
+            first = os.path.join(tmp, "first")
+            second = os.path.join(tmp, "second")
+            _write(os.path.join(first, "skim.root"), "first")
+            _write(os.path.join(second, "skim.root"), "second")
+
+            cache.store("cd" * 32, first)
+            cache.store("cd" * 32, second)
+
+            with open(os.path.join(cache.entry_path("cd" * 32), "skim.root")) as fh:
+                self.assertEqual(fh.read(), "first")
+            self.assertEqual(os.listdir(os.path.dirname(cache.entry_path("cd" * 32))), ["cd" * 32])
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -1,7 +1,9 @@
 from __future__ import annotations
 
+import json
 import os
 import sys
+import tempfile
 import unittest
 from unittest.mock import patch
 
@@ -40,3 +42,63 @@ class TestPartitionUtils(unittest.TestCase):
             partition_utils._make_partitions([], mode="bad", files_per_job=1, entries_per_job=1)
         self.assertIn("file_group", str(ctx.exception))
         self.assertIn("entry_range", str(ctx.exception))
+
+
+class TestCostModel(unittest.TestCase):
+    def _write_job(self, jobs_dir, dataset, job, config, wall_time_s):
+        job_dir = os.path.join(jobs_dir, dataset, job)
+        os.makedirs(job_dir)
+        with open(os.path.join(job_dir, "submit_config.txt"), "w") as fh:
+            for key, value in config.items():
+                fh.write(f"{key}={value}\n")
+        with open(os.path.join(job_dir, "job.perf.json"), "w") as fh:
+            json.dump({"wall_time_s": wall_time_s}, fh)
+
+    def test_config_key_ignores_per_job_keys(self):
+        template = {"threads": "4", "saveFile": "out.root"}
+        job = dict(template, saveFile="jobs/a/skim.root", firstEntry="0", lastEntry="10")
+        self.assertEqual(
+            partition_utils._config_cost_key(template),
+            partition_utils._config_cost_key(job),
+        )
+        self.assertNotEqual(
+            partition_utils._config_cost_key(template),
+            partition_utils._config_cost_key(dict(template, threads="8")),
+        )
+
+    def test_load_job_costs_sums_jobs_per_dataset_and_config(self):
+        with tempfile.TemporaryDirectory() as run_dir:
+            jobs_dir = os.path.join(run_dir, "jobs")
+            ranged = {"configHash": "abc", "firstEntry": "0", "lastEntry": "1000"}
+            self._write_job(jobs_dir, "ttH", "job_0", ranged, 10.0)
+            self._write_job(jobs_dir, "ttH", "job_1", ranged, 30.0)
+            self._write_job(jobs_dir, "DY", "job_0", dict(ranged, configHash="def"), 1.0)
+            # No entry range and no entryIndex: the event count is unknown.
+            self._write_job(jobs_dir, "DY", "job_1", {"configHash": "def"}, 1.0)
+
+            costs = partition_utils._load_job_costs([run_dir])
+
+        self.assertEqual(costs, {("ttH", "abc"): (2000, 40.0), ("DY", "def"): (1000, 1.0)})
+
+    def test_whole_file_jobs_count_entries_from_entry_index(self):
+        with tempfile.TemporaryDirectory() as tmp:
+            index_path = os.path.join(tmp, "ds.entry_index.json")
+            partition_utils._save_entry_index(index_path, {
+                "version": partition_utils.ENTRY_INDEX_VERSION,
+                "tree": "Events",
+                "files": {"a.root": {"entries": 300, "clusters": [0, 300]},
+                          "b.root": {"entries": 200, "clusters": [0, 200]}},
+            })
+            config = {"configHash": "abc", "fileList": "a.root,b.root", "entryIndex": index_path}
+            self._write_job(os.path.join(tmp, "jobs"), "ds", "job_0", config, 5.0)
+
+            costs = partition_utils._load_job_costs([os.path.join(tmp, "jobs")])
+
+        self.assertEqual(costs, {("ds", "abc"): (500, 5.0)})
+
+    def test_entries_for_target_uses_measured_rate_or_fallback(self):
+        costs = {("ttH", "abc"): (2000, 40.0)}
+        self.assertEqual(partition_utils._entries_for_target(costs, "ttH", "abc", 3600, 100), 180000)
+        self.assertEqual(partition_utils._entries_for_target(costs, "ttH", "other", 3600, 100), 100)
+        self.assertEqual(partition_utils._entries_for_target(costs, "DY", "abc", 3600, 100), 100)
+        self.assertEqual(partition_utils._entries_for_target(costs, "ttH", "abc", 0, 100), 100)
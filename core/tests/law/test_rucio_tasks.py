@@ -484,6 +484,43 @@ class TestMakePartitions(unittest.TestCase):
         self.assertEqual(len(a_parts), 2)
         self.assertEqual(len(b_parts), 1)
 
+    def test_entry_range_index_aligns_to_clusters_and_persists(self):
+        """With an index, ranges end on cluster boundaries and files are queried once."""
+        import json
+        import tempfile
+        import unittest.mock as mock
+        mod = self._import()
+
+        clusters = (250, [0, 60, 120, 180, 240, 250])
+        with tempfile.TemporaryDirectory() as tmp:
+            index_path = os.path.join(tmp, "ds.entry_index.json")
+            with mock.patch.object(mod, "_query_tree_clusters", return_value=clusters) as q:
+                parts = mod._make_partitions(
+                    ["root://x//a.root"],
+                    mode="entry_range",
+                    files_per_job=50,
+                    entries_per_job=100,
+                    index_path=index_path,
+                )
+                self.assertEqual(q.call_count, 1)
+            ranges = [(p["first_entry"], p["last_entry"]) for p in parts]
+            self.assertEqual(ranges, [(0, 120), (120, 240), (240, 250)])
+
+            with open(index_path) as fh:
+                index = json.load(fh)
+            self.assertEqual(index["files"]["root://x//a.root"]["entries"], 250)
+
+            with mock.patch.object(mod, "_query_tree_clusters") as q:
+                again = mod._make_partitions(
+                    ["root://x//a.root"],
+                    mode="entry_range",
+                    files_per_job=50,
+                    entries_per_job=100,
+                    index_path=index_path,
+                )
+                q.assert_not_called()
+            self.assertEqual(again, parts)
+
     # ------------------------------------------------------------------
     # invalid mode
     # ------------------------------------------------------------------
@@ -9,6 +9,7 @@ or CMS/ATLAS software environment.  They verify:
   * workflow_executors.py imports and class hierarchy
   * DaskWorkflow structure (workflow_type, proxy class, parameters)
   * _run_analysis_job helper (success + failure paths)
+  * entry-range splitting of one job over several Dask workers
   * RunNANOJobs task construction, output path, branch map, and executor config
   * RunOpenDataJobs task construction, output path, and executor config
   * law.cfg contains the required executor sections
@@ -234,6 +235,66 @@ class TestRunAnalysisJob(unittest.TestCase):
             self.assertEqual(Path(config_path).read_text(), f"fileList={original_url}\n")
 
 
+# ===========================================================================
+# Entry-range splitting (--dask-ranges)
+# ===========================================================================
+
+@unittest.skipUnless(_LAW_AVAILABLE, _SKIP_MSG)
+class TestJobRanges(unittest.TestCase):
+    """Splitting one job into cluster-aligned entry ranges."""
+
+    def _write_index(self, tmpdir):
+        import json
+        index_path = os.path.join(tmpdir, "entry_index.json")
+        Path(index_path).write_text(json.dumps({
+            "version": 1,
+            "tree": "Events",
+            "files": {
+                "a.root": {"entries": 400, "clusters": [0, 100, 200, 300, 400]},
+                "b.root": {"entries": 200, "clusters": [0, 100, 200]},
+            },
+        }))
+        return index_path
+
+    def test_ranges_follow_chain_clusters(self):
+        from workflow_executors import _plan_job_ranges
+        with tempfile.TemporaryDirectory() as tmpdir:
+            cfg = {
+                "fileList": "a.root,b.root",
+                "treeList": "Events",
+                "entryIndex": self._write_index(tmpdir),
+            }
+            self.assertEqual(
+                _plan_job_ranges(cfg, 3), [(0, 200), (200, 400), (400, 600)]
+            )
+            # A job that is already an entry range is split within it.
+            cfg.update(firstEntry="100", lastEntry="500")
+            self.assertEqual(_plan_job_ranges(cfg, 2), [(100, 300), (300, 500)])
+            # Not enough clusters, or nothing to split.
+            self.assertEqual(_plan_job_ranges(dict(cfg, firstEntry="0", lastEntry="100"), 2), [])
+            self.assertEqual(_plan_job_ranges(cfg, 1), [])
+            self.assertEqual(_plan_job_ranges({"sampleConfig": "s.yaml"}, 4), [])
+
+    def test_range_output_path(self):
+        from workflow_executors import _range_output_path
+        self.assertEqual(_range_output_path("out/meta.root", "range3"), "out/meta.range3.root")
+
+    def test_unsplittable_job_runs_whole(self):
+        from workflow_executors import _run_analysis_job_ranges
+        with tempfile.TemporaryDirectory() as tmpdir:
+            Path(os.path.join(tmpdir, "submit_config.txt")).write_text("batch=true\n")
+            exe = os.path.join(tmpdir, "myexe.sh")
+            Path(exe).write_text("#!/bin/sh\nexit 0\n")
+            os.chmod(exe, stat.S_IRWXU)
+            result = _run_analysis_job_ranges(exe_path=exe, job_dir=tmpdir, n_ranges=4)
+            self.assertEqual(result, f"done:{tmpdir}")
+
+    def test_dask_ranges_not_forwarded_to_branches(self):
+        import workflow_executors
+        self.assertTrue(hasattr(workflow_executors.DaskWorkflow, "dask_ranges"))
+        self.assertIn("dask_ranges", workflow_executors.DaskWorkflow.exclude_params_branch)
+
+
 # ===========================================================================
 # law.cfg executor sections
 # ===========================================================================
@@ -0,0 +1,73 @@
+"""
+Tests for core/python/convert_onnx_precision.py.
+
+Covers:
+- Naming of the converted copies (content digest and precision)
+- Rejection of unknown precisions and missing models
+- Reuse of an existing copy
+- int8 quantization of a real model when onnxruntime is installed
+"""
+from __future__ import annotations
+
+import hashlib
+import os
+import sys
+
+import pytest
+
+_HERE = os.path.dirname(os.path.abspath(__file__))
+if _HERE not in sys.path:
+    sys.path.insert(0, _HERE)
+
+from convert_onnx_precision import convert, converted_model_path, main, model_digest
+
+_TEST_MODEL = os.path.join(_HERE, "..", "cpp", "cfg", "test_model.onnx")
+
+
+def _model(tmp_path, content=b"not really onnx"):
+    path = tmp_path / "model.onnx"
+    path.write_bytes(content)
+    return str(path)
+
+
+def test_digest_is_md5_of_contents(tmp_path):
+    path = _model(tmp_path)
+    assert model_digest(path) == hashlib.md5(b"not really onnx").hexdigest()
+
+
+def test_converted_path_depends_on_contents_and_precision(tmp_path):
+    path = _model(tmp_path)
+    int8 = converted_model_path(path, "int8", "cache")
+    fp16 = converted_model_path(path, "fp16", "cache")
+    assert int8 == os.path.join("cache", model_digest(path) + ".int8.onnx")
+    assert fp16 != int8
+
+    _model(tmp_path, b"retrained")
+    assert converted_model_path(path, "int8", "cache") != int8
+
+
+def test_unknown_precision_and_missing_model(tmp_path):
+    with pytest.raises(ValueError):
+        converted_model_path(_model(tmp_path), "int4", "cache")
+    with pytest.raises(FileNotFoundError):
+        converted_model_path(str(tmp_path / "missing.onnx"), "int8", "cache")
+    assert main(["--precision", "int8", str(tmp_path / "missing.onnx")]) == 1
+
+
+def test_existing_copy_is_reused(tmp_path):
+    path = _model(tmp_path)
+    out_dir = str(tmp_path / "cache")
+    existing = converted_model_path(path, "int8", out_dir)
+    os.makedirs(out_dir)
+    with open(existing, "wb") as fh:
+        fh.write(b"converted")
+    assert convert(path, "int8", out_dir) == existing
+    with open(existing, "rb") as fh:
+        assert fh.read() == b"converted"
+
+
+def test_int8_quantization_of_test_model(tmp_path):
+    pytest.importorskip("onnxruntime.quantization")
+    out = convert(_TEST_MODEL, "int8", str(tmp_path))
+    assert os.path.exists(out)
+    assert os.listdir(tmp_path) == [os.path.basename(out)]
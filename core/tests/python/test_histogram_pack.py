@@ -0,0 +1,77 @@
+from __future__ import annotations
+
+import os
+import sys
+from pathlib import Path
+
+import pytest
+
+_HERE = os.path.dirname(os.path.abspath(__file__))
+if _HERE not in sys.path:
+    sys.path.insert(0, _HERE)
+
+from histogram_pack import PackedHistogram, merge_packs, read_pack, write_pack
+
+_EDGES = [[0.0, 1.0, 2.0, 3.0, 4.0]]
+
+
+def _write_job(path: Path, bins, sums, sumw2) -> str:
+    write_pack(str(path), {
+        "Nominal/mass": [_EDGES, bins, sums, sumw2],
+        "pt_eta": [[[0.0, 1.0], [-1.0, 0.0, 1.0]], [4], [1.0], [1.0]],
+    })
+    return str(path)
+
+
+def test_read_pack_maps_arrays_and_shared_schemas(tmp_path):
+    path = _write_job(tmp_path / "job.rdfh", [2, 5], [2.0, 1.0], [1.0, 0.0])
+    with read_pack(path) as pack:
+        assert len(pack.schemas) == 2
+        mass = pack.histograms["Nominal/mass"]
+        assert list(mass.bins) == [2, 5]
+        assert list(mass.sums) == [2.0, 1.0]
+        assert mass.dense() == ([0.0, 2.0, 0.0, 0.0], [0.0, 1.0, 0.0, 0.0])
+        assert mass.dense(flow=True)[0][5] == 1.0
+        assert list(pack.histograms["pt_eta"].axes[1]) == [-1.0, 0.0, 1.0]
+
+
+def test_merge_packs_adds_sorted_bins(tmp_path):
+    inputs = [
+        _write_job(tmp_path / "a.rdfh", [2, 5], [2.0, 1.0], [1.0, 0.0]),
+        _write_job(tmp_path / "b.rdfh", [1, 2], [4.0, 3.0], [0.0, 2.25]),
+    ]
+    merge_packs(str(tmp_path / "merged.rdfh"), inputs)
+    with read_pack(str(tmp_path / "merged.rdfh")) as pack:
+        mass = pack.histograms["Nominal/mass"]
+        assert list(mass.bins) == [1, 2, 5]
+        assert list(mass.sums) == [4.0, 5.0, 1.0]
+        assert list(mass.sumw2) == [0.0, 3.25, 0.0]
+        assert list(pack.histograms["pt_eta"].sums) == [2.0]
+
+
+def test_merge_packs_rejects_different_binnings(tmp_path):
+    first = _write_job(tmp_path / "a.rdfh", [2], [1.0], [1.0])
+    second = str(tmp_path / "b.rdfh")
+    write_pack(second, {"Nominal/mass": [[[0.0, 2.0, 4.0]], [1], [1.0], [1.0]]})
+    with pytest.raises(ValueError):
+        merge_packs(str(tmp_path / "merged.rdfh"), [first, second])
+
+
+def test_read_pack_rejects_other_files(tmp_path):
+    path = tmp_path / "hists.root"
+    path.write_bytes(b"root\0\0\0\0" + b"\0" * 32)
+    with pytest.raises(ValueError):
+        read_pack(str(path))
+
+
+def test_to_boost_places_bins_with_first_axis_fastest():
+    bh = pytest.importorskip("boost_histogram")
+    # Bin 7 of a (1 + 2) x (2 + 2) layout is (x=1, y=2).
+    packed = PackedHistogram("pt_eta", [[0.0, 1.0], [-1.0, 0.0, 1.0]], [0, 7], [2.0, 3.0], [4.0, 9.0])
+    hist = packed.to_boost()
+    assert isinstance(hist, bh.Histogram)
+    view = hist.view(flow=True)
+    assert view.value[1, 2] == 3.0
+    assert view.variance[1, 2] == 9.0
+    assert view.value[0, 0] == 2.0
+    assert hist.sum(flow=True).value == 5.0
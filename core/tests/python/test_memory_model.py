@@ -0,0 +1,64 @@
+from __future__ import annotations
+
+import os
+import sys
+from pathlib import Path
+
+_HERE = os.path.dirname(os.path.abspath(__file__))
+if _HERE not in sys.path:
+    sys.path.insert(0, _HERE)
+
+import memory_model
+from memory_model import MemoryModel
+
+
+def _write_histograms(tmp_path: Path) -> Path:
+    path = tmp_path / "histograms.txt"
+    path.write_text(
+        "# comment\n"
+        "name=pt variable=jet_pt weight=w bins=98 lowerBound=0 upperBound=500 label=Jet pT [GeV]\n"
+        "name=m variable=mass weight=w bins=8 lowerBound=0 upperBound=1 "
+        "channelVariable=ch channelBins=2 channelLowerBound=0 channelUpperBound=2\n"
+    )
+    return path
+
+
+def test_parse_histogram_config_keeps_values_with_spaces(tmp_path):
+    specs = memory_model.parse_histogram_config(_write_histograms(tmp_path))
+    assert len(specs) == 2
+    assert specs[0]["label"] == "Jet pT [GeV]"
+    assert specs[1]["channelBins"] == "2"
+
+
+def test_histogram_bins_counts_all_axes_with_flow_bins():
+    assert memory_model.histogram_bins({"bins": "98"}) == 100
+    assert memory_model.histogram_bins({"bins": "8", "channelVariable": "ch", "channelBins": "2"}) == 40
+    assert memory_model.histogram_bins({"bins": "3", "binEdges": "0,1,10"}) == 4
+
+
+def test_static_estimate_scales_with_histograms_and_threads(tmp_path):
+    _write_histograms(tmp_path)
+    model = MemoryModel.from_config({"histogramConfig": "histograms.txt"}, tmp_path, margin=1.0)
+    per_thread = memory_model.PER_THREAD_MB + 140 * memory_model.SPARSE_BYTES_PER_BIN / 1e6
+    assert abs(model.per_thread_mb - per_thread) < 1e-9
+    assert abs(model.estimate_mb("ttH", 4) - (memory_model.BASE_MB + 4 * per_thread)) < 1e-9
+
+
+def test_observed_peak_replaces_static_estimate():
+    records = [
+        {"dataset": "ttH", "peak_rss_mb": 3000.0, "threads": 2},
+        {"dataset": "ttH", "peak_rss_mb": 2500.0, "threads": 2},
+        {"dataset": "DY", "peak_rss_mb": 0.0, "threads": 2},
+    ]
+    model = MemoryModel.from_config({}, Path("."), records, margin=1.0)
+    assert model.observed == {"ttH": (3000.0, 2)}
+    assert model.estimate_mb("ttH", 4) == 3000.0 + 2 * memory_model.PER_THREAD_MB
+    assert model.estimate_mb("DY", 1) == memory_model.BASE_MB + memory_model.PER_THREAD_MB
+
+
+def test_plan_uses_the_cores_its_memory_holds():
+    model = MemoryModel(base_mb=5000.0, per_thread_mb=100.0, margin=1.0)
+    # 5100 MB hold three 2000 MB cores, so the job gets three threads.
+    assert model.plan("ttH", threads=1, max_threads=8, memory_per_core_mb=2000) == (3, 5300)
+    assert model.plan("ttH", threads=1, max_threads=2, memory_per_core_mb=2000) == (2, 5200)
+    assert model.plan("ttH", threads=4, max_threads=8, memory_per_core_mb=2000) == (4, 5400)
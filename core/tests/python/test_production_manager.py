@@ -25,7 +25,10 @@ from production_manager import (
     ProductionManager,
     ProductionConfig,
     Job,
-    JobStatus
+    JobStatus,
+    create_from_rucio,
+    group_files_by_site,
+    job_sites,
 )
 
 
@@ -91,6 +94,37 @@ class TestProductionConfig(unittest.TestCase):
             self.assertIsNone(config.x509)
 
 
+def _site(name):
+    return f"root://xrootd-cms.infn.it//store/test/xrootd/{name}/"
+
+
+class TestSitePlacement(unittest.TestCase):
+    """Test grouping of files by replica site"""
+
+    def test_group_files_by_site(self):
+        site_redirectors = {
+            "/store/a.root": [_site("T2_A")],
+            "/store/b.root": [_site("T2_A"), _site("T2_B")],
+            "/store/c.root": [_site("T2_B")],
+            "/store/d.root": [_site("T2_A"), _site("T2_B")],
+        }
+        files = ["/store/d.root", "/store/c.root", "/store/b.root", "/store/a.root", "/store/e.root"]
+        # T2_A and T2_B hold three files each; ties go to the first name.
+        self.assertEqual(
+            group_files_by_site(files, site_redirectors, files_per_job=2),
+            ["/store/e.root", "/store/a.root,/store/b.root", "/store/d.root", "/store/c.root"],
+        )
+
+    def test_job_sites_prefers_best_coverage(self):
+        site_redirectors = {
+            "/store/a.root": [_site("T2_A"), _site("T2_B")],
+            "/store/b.root": [_site("T2_B"), _site("T2_C")],
+        }
+        self.assertEqual(job_sites(["/store/a.root", "/store/b.root"], site_redirectors), ["T2_B"])
+        self.assertEqual(job_sites(["/store/a.root"], site_redirectors), ["T2_A", "T2_B"])
+        self.assertEqual(job_sites(["/store/x.root"], site_redirectors), [])
+
+
 class TestProductionManager(unittest.TestCase):
     """Test ProductionManager"""
     
@@ -167,6 +201,67 @@ class TestProductionManager(unittest.TestCase):
         self.assertIn('__orig_metaFile=', cfg_text)
         self.assertIn('output_0_meta_0.root', cfg_text)
 
+    def test_generate_jobs_records_replica_sites(self):
+        """Jobs record the sites holding their files and ship site_redirectors.json"""
+        manager = ProductionManager(self.config)
+        site_redirectors = {
+            "/store/a.root": [_site("T2_A"), _site("T2_B")],
+            "/store/b.root": [_site("T2_B")],
+        }
+        manager.generate_jobs(
+            ["root://host//store/a.root,root://host//store/b.root", "/store/c.root"],
+            site_redirectors=site_redirectors,
+        )
+        self.assertEqual(manager.jobs[0].sites, ["T2_B"])
+        self.assertEqual(manager.jobs[1].sites, [])
+        with open(self.work_dir / "job_0" / "site_redirectors.json") as f:
+            self.assertEqual(json.load(f), site_redirectors)
+
+        restored = ProductionManager(self.config)
+        self.assertEqual(restored.jobs[0].sites, ["T2_B"])
+
+    def test_create_from_rucio_groups_jobs_by_site(self):
+        """The Rucio files become per-site jobs; probe_sites orders their sites"""
+        self.config.probe_sites = True
+        manager = ProductionManager(self.config)
+        site_redirectors = {
+            "/store/a.root": [_site("T2_A"), _site("T2_B")],
+            "/store/b.root": [_site("T2_A"), _site("T2_B")],
+            "/store/c.root": [_site("T2_C")],
+        }
+        result = {
+            "groups": {0: "root://r//store/a.root,root://r//store/b.root", 1: "root://r//store/c.root"},
+            "site_redirectors": site_redirectors,
+        }
+        with patch("rucio_discovery.query_rucio", return_value=result) as query, \
+                patch("xrootd_site_selector.rank_redirectors",
+                      return_value=[(_site("T2_B"), 1.0), (_site("T2_A"), 2.0)]):
+            count = create_from_rucio(manager, "/A/B/NANOAODSIM", files_per_job=5, client=object())
+        self.assertEqual(query.call_args[0][0], "/A/B/NANOAODSIM")
+        self.assertEqual(count, 2)
+        self.assertEqual(manager.jobs[0].sites, ["T2_B", "T2_A"])
+        self.assertEqual(manager.jobs[1].sites, ["T2_C"])
+
+    def test_plan_resources_from_observed_peak(self):
+        """The memory model sets per-job requests and threads from finished jobs"""
+        with open(self.config.base_config, 'a') as f:
+            f.write("sample=ttH\n")
+        manager = ProductionManager(self.config)
+        manager.generate_jobs(["a.root", "b.root"])
+        manager.jobs[1].attempts = 1
+        manager.jobs[1].request_memory_mb = 8000
+
+        records = [{'dataset': 'ttH', 'peak_rss_mb': 4000.0, 'threads': 1}]
+        manager.plan_resources([0, 1], records=records)
+
+        # 4000 MB x 1.2 margin + two extra threads hold three 2000 MB cores.
+        self.assertEqual(manager.jobs[0].request_cpus, 3)
+        self.assertEqual(manager.jobs[0].request_memory_mb, 5160)
+        self.assertEqual(manager.jobs[1].request_memory_mb, 12000)
+        cfg_text = (self.work_dir / 'job_0' / 'job_config.txt').read_text()
+        self.assertIn('threads=3\n', cfg_text)
+        self.assertNotIn('threads=1\n', cfg_text)
+
     def test_generate_jobs_writes_float_int_files(self):
         """When extra_config contains inline float/int content, files are created."""
         manager = ProductionManager(self.config)
@@ -388,6 +483,31 @@ class TestProductionManager(unittest.TestCase):
         # exe should be copied
         self.assertTrue((test_dir / exe_path.name).exists())        
 
+    def test_jit_cache_is_filled_by_test_job_and_shipped(self):
+        """Batch jobs read the shipped JIT cache; the test job builds it."""
+        with open(self.config.base_config, 'a') as f:
+            f.write("jitCacheDir=jit_cache\n")
+        manager = ProductionManager(self.config)
+        manager.generate_jobs(["fileA.root"])
+
+        from submission_backend import read_config
+        cache_dir = (Path(self.tmpdir) / 'jit_cache').resolve()
+        job_cfg = read_config(str(self.work_dir / 'job_0' / 'job_config.txt'))
+        self.assertEqual(job_cfg.get('jitCacheDir'), 'aux/jit_cache')
+        self.assertEqual(job_cfg.get('jitCacheBuild'), 'False')
+        self.assertEqual(job_cfg.get('__orig_jitCacheDir'), str(cache_dir))
+
+        test_dir = manager.create_test_job(0)
+        test_cfg = read_config(str(test_dir / 'submit_config.txt'))
+        self.assertEqual(test_cfg.get('jitCacheDir'), str(cache_dir))
+        self.assertEqual(test_cfg.get('jitCacheBuild'), 'True')
+
+        cache_dir.mkdir()
+        (cache_dir / 'index.txt').write_text('abc rdfjit_abc.so\n')
+        manager._prepare_shared_inputs()
+        shipped = self.work_dir / 'shared_inputs' / 'aux' / 'jit_cache' / 'index.txt'
+        self.assertTrue(shipped.exists())
+
     def test_create_test_job_includes_x509(self):
         """create_test_job copies configured x509 proxy into the test dir"""
         manager = ProductionManager(self.config)
@@ -487,6 +607,53 @@ class TestProductionManager(unittest.TestCase):
             # Should not resubmit (already exceeded max)
             self.assertEqual(count, 0)
 
+    def test_speculate_straggler_and_keep_first_finished_copy(self):
+        """A straggler gets a duplicate away from its site; the duplicate wins"""
+        manager = ProductionManager(self.config)
+        manager.generate_jobs([f"file{i}.root" for i in range(10)])
+        for job in manager.jobs.values():
+            job.status = JobStatus.COMPLETED
+            job.start_time = 1000.0
+            job.completion_time = 1600.0
+        straggler = manager.jobs[9]
+        straggler.status = JobStatus.RUNNING
+        straggler.condor_job_id = "100.9"
+        straggler.run_site = "T2_Slow"
+        (self.work_dir / "condor_submit.sub").write_text(
+            "transfer_input_files = job_$(Process)/job_config.txt\nqueue 10\n")
+
+        with patch('production_manager.subprocess.run') as mock_run:
+            mock_run.return_value = MagicMock(returncode=0, stdout="1 job(s) submitted to cluster 200.\n")
+            duplicated = manager.speculate_stragglers(records=[], now=1000.0 + 3000.0)
+        self.assertEqual(duplicated, [9])
+        self.assertEqual(straggler.speculative_condor_id, "200.0")
+        spec_dir = self.work_dir / "job_9" / "speculative"
+        self.assertIn("output_9_9.spec.root", (spec_dir / "job_config.txt").read_text())
+        self.assertIn('=!= "T2_Slow"', (spec_dir / "condor_submit.sub").read_text())
+
+        # Duplicated once only.
+        with patch('production_manager.subprocess.run') as mock_run:
+            self.assertEqual(manager.speculate_stragglers(records=[], now=1e6), [])
+            mock_run.assert_not_called()
+
+        self.output_dir.mkdir(parents=True, exist_ok=True)
+        for path in (straggler.output_path, straggler.meta_output_path):
+            base, ext = os.path.splitext(path)
+            Path(base + ".spec" + ext).write_text("data")
+        queue = json.dumps([{"ClusterId": 100, "ProcId": 9, "JobStatus": 2}])
+        with patch('production_manager.subprocess.run') as mock_run:
+            mock_run.return_value = MagicMock(returncode=0, stdout=queue)
+            manager.update_status()
+            mock_run.assert_called_with(["condor_rm", "100.9"], capture_output=True, text=True)
+        self.assertEqual(straggler.speculation_winner, "speculative")
+        self.assertEqual(straggler.status, JobStatus.COMPLETED)
+        self.assertIsNone(straggler.speculative_condor_id)
+        self.assertTrue(os.path.exists(straggler.output_path))
+        self.assertFalse(os.path.exists(straggler.output_path.replace(".root", ".spec.root")))
+
+        restored = ProductionManager(self.config)
+        self.assertEqual(restored.jobs[9].speculation_winner, "speculative")
+
 
 class TestProductionManagerCLI(unittest.TestCase):
     """Test command-line interface"""
@@ -96,3 +96,111 @@ def test_list_productions_finds_state_files(tmp_path, monkeypatch, capsys):
     captured = capsys.readouterr()
     assert "myProd" in captured.out
     assert "Total jobs: 2" in captured.out
+
+
+def _performance_manager():
+    JobStatus = production_monitor.JobStatus
+    jobs = {
+        0: SimpleNamespace(job_id=0, status=JobStatus.VALIDATED, meta_output_path="m0.root"),
+        1: SimpleNamespace(job_id=1, status=JobStatus.COMPLETED, meta_output_path="m1.root"),
+        2: SimpleNamespace(job_id=2, status=JobStatus.COMPLETED, meta_output_path="m2.root"),
+        3: SimpleNamespace(job_id=3, status=JobStatus.RUNNING, meta_output_path="m3.root"),
+    }
+    return SimpleNamespace(jobs=jobs)
+
+
+_PROVENANCE = {
+    "m0.root": {"env.site": "T2_A", "dataset.name": "ttbar",
+                "throughput.events": "1000", "timing.event_loop.wall_s": "10.000",
+                "io.bytes_read": "5000000", "memory.peak_rss_mb": "900.0",
+                "executor.load_imbalance": "1.200"},
+    "m1.root": {"env.site": "T2_A", "dataset.name": "wjets",
+                "throughput.events": "3000", "timing.event_loop.wall_s": "10.000",
+                "io.bytes_read": "15000000", "memory.peak_rss_mb": "1100.0",
+                "executor.load_imbalance": "1.000"},
+}
+
+
+def _load_provenance(path):
+    if path not in _PROVENANCE:
+        raise FileNotFoundError(path)
+    return _PROVENANCE[path]
+
+
+def test_collect_job_performance_reads_finished_jobs():
+    records = production_monitor.collect_job_performance(
+        _performance_manager(), loader=_load_provenance)
+    # Job 2 has no readable meta file and job 3 is still running.
+    assert sorted(r["job_id"] for r in records) == [0, 1]
+    record = next(r for r in records if r["job_id"] == 0)
+    assert record["site"] == "T2_A"
+    assert record["events"] == 1000
+    assert record["event_loop_s"] == 10.0
+
+
+def test_aggregate_throughput_per_site_and_dataset():
+    records = production_monitor.collect_job_performance(
+        _performance_manager(), loader=_load_provenance)
+
+    per_site = production_monitor.aggregate_throughput(records, "site")
+    assert list(per_site) == ["T2_A"]
+    site = per_site["T2_A"]
+    assert site["jobs"] == 2
+    assert site["events"] == 4000
+    assert site["events_per_s"] == 200.0
+    assert site["read_mb_per_s"] == 1.0
+    assert site["max_peak_rss_mb"] == 1100.0
+    assert abs(site["mean_load_imbalance"] - 1.1) < 1e-9
+
+    per_dataset = production_monitor.aggregate_throughput(records, "dataset")
+    assert per_dataset["ttbar"]["events_per_s"] == 100.0
+    assert per_dataset["wjets"]["events_per_s"] == 300.0
+
+
+def _write_metrics(directory, job, **fields):
+    import json
+    record = {
+        "state": "running",
+        "timestamp": 1000.0,
+        "last_progress": 1000.0,
+        "entries": 500,
+        "events_per_s": 50.0,
+        "read_mb_per_s": 2.5,
+        "rss_mb": 900.0,
+        "input_files": ["root://site//a.root/Events", "", "root://site//a.root/Events"],
+    }
+    record.update(fields)
+    (directory / f"{job}.json").write_text(json.dumps(record))
+
+
+def test_read_live_metrics_skips_unreadable_files(tmp_path):
+    _write_metrics(tmp_path, "job_0")
+    (tmp_path / "job_1.json").write_text("{ partial")
+    (tmp_path / "job_2.prom").write_text("rdf_entries_processed_total 3\n")
+    records = production_monitor.read_live_metrics(tmp_path)
+    assert [r["job"] for r in records] == ["job_0"]
+    assert records[0]["entries"] == 500
+
+
+def test_classify_live_job():
+    running = {"state": "running", "timestamp": 1000.0, "last_progress": 990.0}
+    assert production_monitor.classify_live_job(running, 1010.0, 600) == "running"
+    # The writer still updates the file, but no entry was processed.
+    stalled = {"state": "running", "timestamp": 1000.0, "last_progress": 100.0}
+    assert production_monitor.classify_live_job(stalled, 1010.0, 600) == "stalled"
+    # The file itself is no longer rewritten.
+    assert production_monitor.classify_live_job(running, 5000.0, 600) == "dead"
+    setup = {"state": "setup", "timestamp": 1000.0, "last_progress": 0.0}
+    assert production_monitor.classify_live_job(setup, 1010.0, 600) == "setup"
+    finished = {"state": "finished", "timestamp": 0.0}
+    assert production_monitor.classify_live_job(finished, 1e9, 600) == "finished"
+
+
+def test_print_live_counts_problem_jobs(tmp_path, capsys):
+    _write_metrics(tmp_path, "job_0")
+    _write_metrics(tmp_path, "job_1", last_progress=10.0)
+    problems = production_monitor.print_live(tmp_path, stall_seconds=600, now=1005.0)
+    out = capsys.readouterr().out
+    assert problems == 1
+    assert "stalled" in out
+    assert out.count("root://site//a.root/Events") == 2  # once per job
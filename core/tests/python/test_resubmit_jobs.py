@@ -24,6 +24,38 @@ class TestResubmitJobs(unittest.TestCase):
         self.assertIn("+MaxRuntime=200", result)
         self.assertIn("queue 1", result)
 
+    def test_checkpoint_is_added_to_transfer_input_files(self):
+        with tempfile.TemporaryDirectory() as tmpdir:
+            job_dir = os.path.join(tmpdir, "job_2")
+            os.makedirs(job_dir)
+            with open(os.path.join(job_dir, "submit_config.txt"), "w") as fh:
+                fh.write("threads=1\ncheckpointFile=checkpoint.root\n")
+            self.assertIsNone(resubmit_jobs.find_job_checkpoint(tmpdir, 2))
+
+            checkpoint = os.path.join(job_dir, "checkpoint.root")
+            with open(checkpoint, "w") as fh:
+                fh.write("")
+            self.assertEqual(resubmit_jobs.find_job_checkpoint(tmpdir, 2), checkpoint)
+
+            submit = "transfer_input_files = job_2/submit_config.txt\nqueue 1\n"
+            result = resubmit_jobs.add_transfer_input_file(submit, checkpoint)
+            self.assertIn(f"transfer_input_files = job_2/submit_config.txt, {checkpoint}\n", result)
+            result = resubmit_jobs.add_transfer_input_file("queue 1\n", checkpoint)
+            self.assertEqual(result, f"transfer_input_files = {checkpoint}\nqueue 1\n")
+
+    def test_checkpoint_directory_is_transferred(self):
+        with tempfile.TemporaryDirectory() as tmpdir:
+            job_dir = os.path.join(tmpdir, "job_0")
+            os.makedirs(os.path.join(job_dir, "checkpoint"))
+            with open(os.path.join(job_dir, "submit_config.txt"), "w") as fh:
+                fh.write("checkpointFile=checkpoint/checkpoint.root\n")
+            self.assertIsNone(resubmit_jobs.find_job_checkpoint(tmpdir, 0))
+
+            with open(os.path.join(job_dir, "checkpoint", "checkpoint.root"), "w") as fh:
+                fh.write("")
+            self.assertEqual(resubmit_jobs.find_job_checkpoint(tmpdir, 0),
+                             os.path.join(job_dir, "checkpoint"))
+
     def test_main_dry_run_skips_missing_jobs(self):
         with tempfile.TemporaryDirectory() as tmpdir:
             submit_path = os.path.join(tmpdir, "condor_submit.sub")
@@ -0,0 +1,118 @@
+import os
+import sys
+import unittest
+
+_REPO_ROOT = os.path.abspath(os.path.join(os.path.dirname(__file__), "..", "..", ".."))
+_CORE_PYTHON = os.path.join(_REPO_ROOT, "core", "python")
+if _CORE_PYTHON not in sys.path:
+    sys.path.insert(0, _CORE_PYTHON)
+
+from speculative_execution import (
+    RunningJob,
+    RuntimeModel,
+    StragglerPolicy,
+    find_stragglers,
+    speculative_config,
+    speculative_path,
+    speculative_submit,
+)
+
+
+class TestRuntimeModel(unittest.TestCase):
+    def test_prefers_measured_throughput_for_known_event_counts(self):
+        records = [
+            {'dataset': 'ttH', 'events': 1000, 'event_loop_s': 10.0},
+            {'dataset': 'ttH', 'events': 3000, 'event_loop_s': 30.0},
+        ]
+        model = RuntimeModel.from_jobs([('ttH', 400.0)], records)
+        self.assertAlmostEqual(model.predict('ttH', events=5000), 50.0)
+        # Without an event count the dataset's median wall time is used.
+        self.assertAlmostEqual(model.predict('ttH'), 400.0)
+
+    def test_falls_back_to_all_jobs_then_none(self):
+        model = RuntimeModel.from_jobs([('a', 100.0), ('a', 300.0), ('b', 200.0)])
+        self.assertAlmostEqual(model.predict('a'), 200.0)
+        self.assertAlmostEqual(model.predict('unseen'), 200.0)
+        self.assertIsNone(RuntimeModel().predict('a'))
+
+
+class TestFindStragglers(unittest.TestCase):
+    def setUp(self):
+        self.model = RuntimeModel.from_jobs([('ttH', 1000.0)] * 5)
+        self.policy = StragglerPolicy(slowdown=2.0, min_elapsed_s=60.0,
+                                      tail_fraction=0.9, max_fraction=0.02)
+
+    def test_picks_slowest_jobs_past_the_slowdown(self):
+        running = [
+            RunningJob(1, 2500.0, 'ttH'),
+            RunningJob(2, 1500.0, 'ttH'),
+            RunningJob(3, 4000.0, 'ttH'),
+        ]
+        stragglers = find_stragglers(running, self.model, n_jobs=100, n_done=97,
+                                     policy=self.policy)
+        self.assertEqual(stragglers, [3, 1])
+
+    def test_waits_for_the_tail_and_respects_the_budget(self):
+        running = [RunningJob(i, 5000.0, 'ttH') for i in range(5)]
+        self.assertEqual(find_stragglers(running, self.model, 100, 80, policy=self.policy), [])
+        self.assertEqual(len(find_stragglers(running, self.model, 100, 95, policy=self.policy)), 2)
+        self.assertEqual(
+            find_stragglers(running, self.model, 100, 95, n_speculating=2, policy=self.policy), [])
+
+    def test_skips_young_jobs_and_jobs_without_prediction(self):
+        running = [RunningJob(1, 30.0, 'ttH')]
+        self.assertEqual(find_stragglers(running, self.model, 10, 10, policy=self.policy), [])
+        self.assertEqual(
+            find_stragglers([RunningJob(2, 5000.0, 'ttH')], RuntimeModel(), 10, 10,
+                            policy=self.policy), [])
+
+
+class TestSpeculativeFiles(unittest.TestCase):
+    def test_config_outputs_get_the_infix(self):
+        text = ("saveFile=/out/output_3_3.root\n"
+                "__orig_metaFile=root://eos//out/output_3_meta_3.root\n"
+                "cut=pt>20 && eta<2.4\n")
+        result = speculative_config(text)
+        self.assertIn("saveFile=/out/output_3_3.spec.root\n", result)
+        self.assertIn("__orig_metaFile=root://eos//out/output_3_meta_3.spec.root\n", result)
+        self.assertIn("cut=pt>20 && eta<2.4\n", result)
+        self.assertEqual(speculative_path("a/b.root"), "a/b.spec.root")
+
+    def test_submit_queues_one_duplicate_away_from_the_site(self):
+        template = (
+            "transfer_input_files = /w/job_$(Process)/job_config.txt,/w/shared_inputs\n"
+            'environment = "CONDOR_PROC=$(Process)"\n'
+            "+RequestCpus=1\n"
+            "+MaxRuntime=3600\n"
+            'requirements = (Arch) && stringListMember(TARGET.GLIDEIN_CMSSite, "T2_A")\n'
+            "rank = 1\n"
+            "+RequestCpus=4\n"
+            "queue 2\n"
+            "requirements = (Arch)\n"
+            "rank = 0\n"
+            "queue 1\n"
+        )
+        result = speculative_submit(template, 7, exclude_site="T2_A", request_cpus=4)
+        self.assertIn("/w/job_7/speculative/job_config.txt,/w/shared_inputs", result)
+        self.assertIn('CONDOR_PROC=7', result)
+        self.assertIn('requirements = (Arch) && (TARGET.GLIDEIN_CMSSite =!= "T2_A")\n', result)
+        self.assertNotIn("stringListMember", result)
+        self.assertNotIn("rank", result)
+        self.assertEqual(result.count("+RequestCpus"), 1)
+        self.assertIn("+RequestCpus=4\n", result)
+        self.assertTrue(result.endswith("queue 1\n"))
+        self.assertEqual(result.count("queue"), 1)
+
+    def test_submit_strips_the_site_list_wherever_it_is(self):
+        for requirements, expected in (
+                ('stringListMember(TARGET.GLIDEIN_CMSSite, "T2_A") && (Arch)', '(Arch) && '),
+                ('stringListMember(TARGET.GLIDEIN_CMSSite, "T2_A")', '')):
+            template = f"requirements = {requirements}\nqueue 1\n"
+            result = speculative_submit(template, 0, exclude_site="T2_A")
+            self.assertNotIn("stringListMember", result)
+            self.assertIn(f'requirements = {expected}(TARGET.GLIDEIN_CMSSite =!= "T2_A")\n',
+                          result)
+
+
+if __name__ == "__main__":
+    unittest.main()
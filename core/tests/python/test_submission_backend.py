@@ -1,5 +1,5 @@
 import os
-from core.python.submission_backend import ensure_xrootd_redirector, generate_condor_submit, generate_condor_runscript, stage_outputs_blocks
+from core.python.submission_backend import ensure_xrootd_redirector, generate_condor_submit, generate_condor_runscript, site_queue_blocks, stage_outputs_blocks
 
 
 def test_ensure_xrootd_redirector_preserves_absolute_local_paths():
@@ -47,6 +47,67 @@ def test_generate_condor_submit_sets_want_os(tmp_path):
     assert 'MY.WantOS = "el8"' in sub
 
 
+def test_generate_condor_submit_ranks_replica_sites(tmp_path):
+    sub = generate_condor_submit(
+        main_dir=str(tmp_path),
+        jobs=3,
+        exe_relpath="bin/fakeexe",
+        config_file="submit_config.txt",
+        job_sites=[["T2_A", "T2_B"], ["T2_A", "T2_B"], []],
+    )
+    assert 'rank = ifThenElse(TARGET.GLIDEIN_CMSSite =?= "T2_A", 2, ifThenElse(TARGET.GLIDEIN_CMSSite =?= "T2_B", 1, 0))\nqueue 2\n' in sub
+    assert "rank = 0\nqueue 1\n" in sub
+    assert sub.count("requirements = ") == 2
+    assert "stringListMember" not in sub
+
+
+def test_generate_condor_submit_sets_per_job_resources(tmp_path):
+    sub = generate_condor_submit(
+        main_dir=str(tmp_path),
+        jobs=3,
+        exe_relpath="bin/fakeexe",
+        config_file="submit_config.txt",
+        job_resources=[(2, 4000), (2, 4000), (4, 9000)],
+    )
+    assert "+RequestCpus=2\n+RequestMemory=4000\nqueue 2\n" in sub
+    assert "+RequestCpus=4\n+RequestMemory=9000\nqueue 1\n" in sub
+    assert sub.count("requirements = ") == 1
+
+
+def test_generate_condor_submit_transfers_and_remaps_outputs(tmp_path):
+    sub = generate_condor_submit(
+        main_dir=str(tmp_path),
+        jobs=1,
+        exe_relpath="bin/fakeexe",
+        config_file="job_config.txt",
+        output_remaps={"metrics.json": f"{tmp_path}/metrics/job_$(Process).json"},
+    )
+    assert "transfer_output_files = job_config.txt,metrics.json\n" in sub
+    assert f'transfer_output_remaps = "metrics.json = {tmp_path}/metrics/job_$(Process).json"\n' in sub
+
+
+def test_generate_condor_submit_returns_checkpoints_on_eviction(tmp_path):
+    sub = generate_condor_submit(
+        main_dir=str(tmp_path),
+        jobs=1,
+        exe_relpath="bin/fakeexe",
+        config_file="job_config.txt",
+        checkpoint_dir="checkpoint",
+    )
+    assert "WhenToTransferOutput=ON_EXIT_OR_EVICT\n" in sub
+    assert "transfer_output_files = job_config.txt,checkpoint\n" in sub
+    assert f'transfer_output_remaps = "checkpoint = {tmp_path}/job_$(Process)/checkpoint"\n' in sub
+
+    sub = generate_condor_submit(
+        main_dir=str(tmp_path), jobs=1, exe_relpath="bin/fakeexe", config_file="job_config.txt")
+    assert "WhenToTransferOutput=On_Exit\n" in sub
+
+
+def test_site_queue_blocks_require_restricts_sites():
+    blocks = site_queue_blocks([["T2_A", "T2_B"]], "BASE", site_placement="require")
+    assert 'requirements = BASE && stringListMember(TARGET.GLIDEIN_CMSSite, "T2_A,T2_B")\n' in blocks
+
+
 def test_generate_condor_submit_sets_x86_v2_requirements(tmp_path):
     sub = generate_condor_submit(
         main_dir=str(tmp_path),
@@ -287,6 +348,15 @@ def test_xrootd_optimize_block_reads_runtime_blacklist():
     assert "xrdBlacklist" in block
 
 
+def test_xrootd_optimize_block_blacklists_reported_slow_sites():
+    """Sites in the C++ slow-site report of an earlier attempt are avoided."""
+    from core.python.submission_backend import xrootd_optimize_block
+    block = xrootd_optimize_block()
+    assert "slowSiteReport" in block
+    assert "slow_sites.json" in block
+    compile(block.split("<< 'XRDPY'\n", 1)[1].rsplit("XRDPY", 1)[0], "xrd-opt", "exec")
+
+
 def test_xrootd_optimize_block_filters_site_specific_redirectors():
     from core.python.submission_backend import xrootd_optimize_block
     block = xrootd_optimize_block()
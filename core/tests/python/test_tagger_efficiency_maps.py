@@ -0,0 +1,124 @@
+"""
+Tests for core/python/tagger_efficiency_maps.py.
+
+Covers:
+- Fractions and working-point efficiencies of the built payload
+- Mirroring of the |eta| binning onto signed eta
+- Flavour split and the light-flavour default
+- Neutral values for empty bins
+- Summing the counts of several files and rejecting mismatched binnings
+- read_category_counts error paths
+"""
+from __future__ import annotations
+
+import os
+import sys
+
+import pytest
+
+_HERE = os.path.dirname(os.path.abspath(__file__))
+if _HERE not in sys.path:
+    sys.path.insert(0, _HERE)
+
+from tagger_efficiency_maps import (
+    CategoryCounts,
+    _accumulate,
+    build_payload,
+    read_category_counts,
+)
+
+
+def _counts(flavours=("",), abseta_edges=(0.0, 1.5, 2.4)):
+    # 2 pT bins x 2 |eta| bins; 2 working points -> 3 categories.
+    cells = {
+        "": [10.0, 6.0, 4.0],
+        "b": [2.0, 3.0, 5.0],
+        "c": [5.0, 3.0, 2.0],
+        "light": [8.0, 1.0, 1.0],
+    }
+    return CategoryCounts(
+        prefix="frac",
+        pt_edges=[20.0, 50.0, 100.0],
+        abseta_edges=list(abseta_edges),
+        flavours=list(flavours),
+        counts=[[[list(cells[f]) for f in flavours] for _ in range(2)] for _ in range(2)],
+    )
+
+
+def _correction(payload, name):
+    return next(c for c in payload["corrections"] if c["name"] == name)
+
+
+def _leaf_values(node):
+    return {item["key"]: item["value"] for item in node["content"]}
+
+
+def test_payload_has_fraction_and_efficiency_corrections():
+    payload = build_payload(_counts())
+    assert payload["schema_version"] == 2
+    names = [c["name"] for c in payload["corrections"]]
+    assert names == ["frac_fractions", "frac_efficiency"]
+    inputs = [i["name"] for i in _correction(payload, "frac_fractions")["inputs"]]
+    assert inputs == ["pt", "eta", "category"]
+
+
+def test_fractions_and_efficiencies():
+    payload = build_payload(_counts())
+    frac = _correction(payload, "frac_fractions")["data"]["content"][0]["content"][0]
+    assert _leaf_values(frac) == pytest.approx({0: 0.5, 1: 0.3, 2: 0.2})
+    eff = _correction(payload, "frac_efficiency")["data"]["content"][0]["content"][0]
+    # WP 1 passed by categories 1 and 2, WP 2 by category 2 only.
+    assert _leaf_values(eff) == pytest.approx({1: 0.5, 2: 0.2})
+
+
+def test_eta_binning_is_mirrored():
+    payload = build_payload(_counts())
+    eta_node = _correction(payload, "frac_fractions")["data"]["content"][0]
+    assert eta_node["edges"] == [-2.4, -1.5, 0.0, 1.5, 2.4]
+    assert len(eta_node["content"]) == 4
+
+
+def test_eta_binning_with_gap_around_zero():
+    payload = build_payload(_counts(abseta_edges=(0.5, 1.5, 2.4)))
+    eta_node = _correction(payload, "frac_fractions")["data"]["content"][0]
+    assert eta_node["edges"] == [-2.4, -1.5, -0.5, 0.5, 1.5, 2.4]
+    assert len(eta_node["content"]) == 5
+
+
+def test_flavour_split_uses_light_as_default():
+    payload = build_payload(_counts(flavours=("b", "c", "light")))
+    corr = _correction(payload, "frac_efficiency")
+    assert [i["name"] for i in corr["inputs"]] == ["pt", "eta", "flavour", "working_point"]
+    flav = corr["data"]["content"][0]["content"][0]
+    keys = [item["key"] for item in flav["content"]]
+    assert keys == [5, 4]
+    b_leaf = flav["content"][0]["value"]
+    assert _leaf_values(b_leaf) == pytest.approx({1: 0.8, 2: 0.5})
+    assert _leaf_values(flav["default"]) == pytest.approx({1: 0.2, 2: 0.1})
+
+
+def test_empty_bins_are_neutral():
+    counts = _counts()
+    counts.counts[1][1][0] = [0.0, 0.0, 0.0]
+    payload = build_payload(counts)
+    eff = _correction(payload, "frac_efficiency")["data"]["content"][1]["content"][3]
+    assert _leaf_values(eff) == {1: 1.0, 2: 1.0}
+
+
+def test_accumulate_sums_counts():
+    total = _counts()
+    _accumulate(total, _counts())
+    assert total.counts[0][0][0] == [20.0, 12.0, 8.0]
+
+
+def test_accumulate_rejects_different_binning():
+    total = _counts()
+    other = _counts(abseta_edges=(0.0, 1.0, 2.4))
+    with pytest.raises(ValueError, match="different"):
+        _accumulate(total, other)
+
+
+def test_read_category_counts_missing_file(tmp_path):
+    pytest.importorskip("uproot")
+    with pytest.raises(FileNotFoundError):
+        read_category_counts(str(tmp_path / "missing.root"), "frac")
@@ -331,3 +331,75 @@ class TestParseOpendataConfig:
         samples, recids, lumi = _parse_opendata_config(str(path))
         assert lumi == 1.0  # default from DatasetManifest
 
+
+# ---------------------------------------------------------------------------
+# Dry-run cost report
+# ---------------------------------------------------------------------------
+
+class TestDryRunConfig:
+
+    def _fake_executable(self, tmp_path, warnings):
+        """A stand-in for the analysis executable: checks the dry-run keys of
+        its config and writes a cost report to dryRunReport."""
+        exe = tmp_path / "analysis"
+        exe.write_text(textwrap.dedent(f"""\
+            #!/usr/bin/env python3
+            import json, sys
+            cfg = dict(l.split("=", 1) for l in open(sys.argv[1]).read().split())
+            assert cfg["dryRun"] == "true" and cfg["threads"] == "4"
+            json.dump({{"defined_columns": 12, "jit_expressions": 3,
+                        "jit_compiled": 1, "systematics": 2, "slots": 4,
+                        "models": 1, "histogram_cells": 400,
+                        "histogram_bytes_per_slot": 6400,
+                        "histogram_bytes": 25600, "histograms": [],
+                        "warnings": {warnings!r}}}, open(cfg["dryRunReport"], "w"))
+        """))
+        exe.chmod(0o755)
+        return str(exe)
+
+    def test_report_is_returned_and_copy_removed(self, tmp_path):
+        from validate_config import dry_run_config, format_cost_report
+
+        config = _write(tmp_path, "submit.txt", "threads=4\ndryRun=false\n")
+        report = dry_run_config(self._fake_executable(tmp_path, []), str(config))
+        assert report["defined_columns"] == 12
+        assert report["warnings"] == []
+        assert "400 cells" in format_cost_report(report)
+        assert sorted(p.name for p in tmp_path.iterdir()) == ["analysis", "submit.txt"]
+
+    def test_yaml_config_is_copied_as_yaml(self, tmp_path):
+        from validate_config import dry_run_config
+
+        exe = tmp_path / "analysis"
+        exe.write_text(textwrap.dedent("""\
+            #!/usr/bin/env python3
+            import json, sys, yaml
+            assert sys.argv[1].endswith(".yaml")
+            cfg = yaml.safe_load(open(sys.argv[1]))
+            assert cfg["dryRun"] == "true" and cfg["threads"] == 4
+            json.dump({"warnings": [], "threads": cfg["threads"]},
+                      open(cfg["dryRunReport"], "w"))
+        """))
+        exe.chmod(0o755)
+        config = _write(tmp_path, "submit.yaml", "threads: 4\ndryRun: false\n")
+        report = dry_run_config(str(exe), config)
+        assert report["threads"] == 4
+        assert sorted(p.name for p in tmp_path.iterdir()) == ["analysis", "submit.yaml"]
+
+    def test_budget_warnings_are_reported(self, tmp_path):
+        from validate_config import dry_run_config
+
+        config = _write(tmp_path, "submit.txt", "threads=4\n")
+        exe = self._fake_executable(tmp_path, ["histogram cells 400 exceeds costBudgetHistogramCells=100"])
+        report = dry_run_config(exe, str(config))
+        assert len(report["warnings"]) == 1
+
+    def test_failing_executable_raises(self, tmp_path):
+        from validate_config import ValidationError, dry_run_config
+
+        config = _write(tmp_path, "submit.txt", "threads=4\n")
+        exe = tmp_path / "analysis"
+        exe.write_text("#!/bin/sh\nexit 3\n")
+        exe.chmod(0o755)
+        with pytest.raises(ValidationError, match="exit 3"):
+            dry_run_config(str(exe), str(config))
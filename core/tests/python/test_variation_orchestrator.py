@@ -430,6 +430,28 @@ class TestGetVariationPlan:
 # ---------------------------------------------------------------------------
 
 
+class TestWriteBookingPlan:
+    def test_lines_per_region(self, tmp_path):
+        orch = TestGetVariationPlan()._make_orch()
+        path = tmp_path / "plan.txt"
+        plan = orch.write_booking_plan(
+            str(path), ["signal", "qcd"], ["signal_region", "control"]
+        )
+        # jet_energy and btag only apply in signal_region; lumi is datacard-only.
+        assert plan == {"signal_region": ["JES", "JER", "btag"], "control": []}
+        assert path.read_text().splitlines() == [
+            "region=signal_region systematics=Nominal,JES,JER,btag",
+            "region=control systematics=Nominal",
+        ]
+
+    def test_union_of_output_usages(self, tmp_path):
+        orch = TestGetVariationPlan()._make_orch()
+        plan = orch.write_booking_plan(
+            str(tmp_path / "plan.txt"), ["qcd"], ["control"], ["histogram", "datacard"]
+        )
+        assert plan == {"control": ["lumi"]}
+
+
 class TestValidateCoverage:
     def _make_orch(self) -> VariationOrchestrator:
         group = _make_group(
@@ -0,0 +1,57 @@
+/**
+ * @file rdfconfig.cc
+ * @brief Compile an analysis configuration into one binary file.
+ *
+ * Usage:
+ *   rdfconfig -o config.rdfcfg config.yaml
+ *
+ * Resolves the sub-configs the configuration references and writes them,
+ * parsed, with the top-level keys into a compiled config (see
+ * CompiledConfig).  Jobs given the compiled file as their configuration read
+ * it instead of parsing the sources.  validate_config.py --compile runs this
+ * tool after a successful validation.
+ */
+#include <ConfigurationManager.h>
+#include <exception>
+#include <iostream>
+#include <string>
+
+namespace {
+
+int usage(const char *argv0) {
+  std::cerr << "Usage:\n"
+            << "  " << argv0 << " -o OUTPUT CONFIG\n";
+  return 2;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  std::string output;
+  std::string input;
+  for (int i = 1; i < argc; ++i) {
+    const std::string arg = argv[i];
+    if (arg == "-o" && i + 1 < argc) {
+      output = argv[++i];
+    } else if (input.empty() && !arg.empty() && arg[0] != '-') {
+      input = arg;
+    } else {
+      return usage(argv[0]);
+    }
+  }
+  if (output.empty() || input.empty()) {
+    return usage(argv[0]);
+  }
+
+  try {
+    const auto compiled = ConfigurationManager(input).compile(output);
+    std::cout << "rdfconfig: compiled " << input << " (" << compiled.top.size()
+              << " keys, " << compiled.pairs.size() + compiled.multiKeys.size() +
+                                  compiled.vectors.size()
+              << " sub-config parses) into " << output << std::endl;
+  } catch (const std::exception &e) {
+    std::cerr << "rdfconfig: " << e.what() << std::endl;
+    return 1;
+  }
+  return 0;
+}
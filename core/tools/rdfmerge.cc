@@ -0,0 +1,156 @@
+/**
+ * @file rdfmerge.cc
+ * @brief Parallel merge of per-job histogram, cutflow, meta and skim outputs.
+ *
+ * Usage:
+ *   rdfmerge [-j N] [-p N] -o merged.root job_0/out_meta.root job_1/out_meta.root ...
+ *   rdfmerge [-j N] [-p N] --role histograms --output-dir merged/ job_*/output_manifest.yaml
+ *   rdfmerge [-j N] --skim [--target-size BYTES] -o skim.root job_0/skim.root ...
+ *   rdfmerge --pack -o merged.rdfh job_0/hists.rdfh job_1/hists.rdfh ...
+ *
+ * The first form merges the listed files.  The second reads the
+ * OutputManifest files, takes the output file of the given role
+ * (histograms, cutflow or metadata) of every job and writes one merged file
+ * per basename into the output directory.
+ *
+ * --skim merges skim trees with SkimMerger instead: baskets are copied
+ * without recompression when the compression settings match, and the
+ * inputs are split into outputs of about --target-size bytes (skim_0.root,
+ * skim_1.root, ...), merged in parallel.  One line per output is printed.
+ *
+ * --pack merges histogram packs (histogramPackFile, see HistogramPack) by
+ * adding their bin arrays, one input at a time.  An output ending in .root
+ * is written as a ROOT histogram file instead, which also converts a single
+ * pack for plotting or create_datacards.py.
+ *
+ * -j sets the number of threads (default: all cores), -p the number of
+ * partial merges the inputs are striped over (default: one per thread).
+ */
+#include <HistogramPack.h>
+#include <OutputMerger.h>
+#include <SkimMerger.h>
+#include <TROOT.h>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <filesystem>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+int usage(const char *argv0) {
+  std::cerr << "Usage:\n"
+            << "  " << argv0 << " [-j N] [-p N] -o OUTPUT INPUT...\n"
+            << "  " << argv0 << " [-j N] [-p N] --role ROLE --output-dir DIR MANIFEST...\n"
+            << "  " << argv0 << " [-j N] --skim [--target-size BYTES] -o OUTPUT INPUT...\n"
+            << "  " << argv0 << " --pack -o OUTPUT INPUT...\n";
+  return 2;
+}
+
+/// Parse the non-negative integer @p value of @p option.
+std::uint64_t parseCount(const std::string &option, const std::string &value) {
+  std::size_t end = 0;
+  std::uint64_t count = 0;
+  try {
+    if (value.empty() || value[0] == '-') {
+      throw std::invalid_argument(value);
+    }
+    count = std::stoull(value, &end);
+  } catch (const std::logic_error &) {
+    end = 0;
+  }
+  if (end == 0 || end != value.size()) {
+    throw std::invalid_argument("invalid value '" + value + "' for " + option);
+  }
+  return count;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  unsigned int threads = 0;
+  std::size_t partialMerges = 0;
+  std::string output;
+  std::string role;
+  std::string outputDir;
+  bool skim = false;
+  bool pack = false;
+  std::uint64_t targetBytes = 0;
+  std::vector<std::string> inputs;
+  try {
+    for (int i = 1; i < argc; ++i) {
+      const std::string arg = argv[i];
+      const bool hasValue = i + 1 < argc;
+      if (arg == "-j" && hasValue) {
+        threads = static_cast<unsigned int>(parseCount(arg, argv[++i]));
+      } else if (arg == "-p" && hasValue) {
+        partialMerges = parseCount(arg, argv[++i]);
+      } else if (arg == "-o" && hasValue) {
+        output = argv[++i];
+      } else if (arg == "--role" && hasValue) {
+        role = argv[++i];
+      } else if (arg == "--output-dir" && hasValue) {
+        outputDir = argv[++i];
+      } else if (arg == "--skim") {
+        skim = true;
+      } else if (arg == "--pack") {
+        pack = true;
+      } else if (arg == "--target-size" && hasValue) {
+        targetBytes = parseCount(arg, argv[++i]);
+      } else if (!arg.empty() && arg[0] == '-') {
+        return usage(argv[0]);
+      } else {
+        inputs.push_back(arg);
+      }
+    }
+    if (inputs.empty() || output.empty() == role.empty() || role.empty() != outputDir.empty() ||
+        (skim && output.empty()) || (!skim && targetBytes > 0) ||
+        (pack && (skim || output.empty()))) {
+      return usage(argv[0]);
+    }
+
+    if (pack) {
+      HistogramPack::mergeFiles(output, inputs);
+      std::cout << "rdfmerge: merged " << inputs.size() << " pack(s) into " << output
+                << std::endl;
+      return 0;
+    }
+    if (threads != 1) {
+      ROOT::EnableImplicitMT(threads);
+    }
+    if (skim) {
+      for (const auto &part : SkimMerger(targetBytes).merge(output, inputs)) {
+        std::cout << "rdfmerge: merged " << part.inputs.size() << " file(s) into "
+                  << part.output << (part.fastCopy ? " (fast copy)" : " (recompressed)")
+                  << std::endl;
+      }
+      return 0;
+    }
+    const OutputMerger merger(partialMerges);
+    if (!output.empty()) {
+      merger.merge(output, inputs);
+      std::cout << "rdfmerge: merged " << inputs.size() << " file(s) into " << output
+                << std::endl;
+      return 0;
+    }
+    const auto groups = OutputMerger::manifestOutputs(inputs, role);
+    if (groups.empty()) {
+      std::cerr << "rdfmerge: no manifest lists a '" << role << "' output file"
+                << std::endl;
+      return 1;
+    }
+    for (const auto &[basename, files] : groups) {
+      const std::string merged = (std::filesystem::path(outputDir) / basename).string();
+      merger.merge(merged, files);
+      std::cout << "rdfmerge: merged " << files.size() << " file(s) into " << merged
+                << std::endl;
+    }
+  } catch (const std::exception &e) {
+    std::cerr << "rdfmerge: " << e.what() << std::endl;
+    return 1;
+  }
+  return 0;
+}